@@ -0,0 +1,144 @@
+#pragma once
+
+#include "AthiVegam/Math/Vector.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace AthiVegam::Ai
+{
+	// Runs AI agents' updates at their own rates within a
+	// per-frame budget, instead of every agent every frame
+	// in App::Update(). Each agent asks for a frequency,
+	// slowed the further it is from the viewer; agents
+	// that are due run on the job workers, most overdue
+	// first, until the budget is spent, and the rest wait
+	// for the next frame, more overdue. Agents added
+	// together are staggered so they don't fall due on
+	// the same frame.
+	//
+	// Priority counts as that many intervals overdue, so
+	// important agents go first without starving the
+	// others. Updates run concurrently unless marked for
+	// the main thread; each should only touch its own
+	// agent. Main thread.
+	class UpdateScheduler
+	{
+	  public:
+		struct Settings
+		{
+			// Of wall time per Update(), across workers.
+			float budgetMs = 2.0f;
+			// Agents within nearDistance of the viewer
+			// run at their frequency, slowing linearly to
+			// minRateScale of it at farDistance and
+			// beyond.
+			float nearDistance = 20.0f;
+			float farDistance = 100.0f;
+			float minRateScale = 0.1f;
+		};
+
+		using AgentId = uint32_t;
+		static constexpr AgentId InvalidAgent = ~0u;
+
+		// Given the seconds since the agent last ran.
+		using Function = std::function<void(float deltaTime)>;
+
+		struct Agent
+		{
+			Function update;
+			// Updates per second, near the viewer.
+			float frequency = 10.0f;
+			float priority = 0.0f;
+			Math::Vec3 position;
+			// E.g. for agents that change the world.
+			bool mainThread = false;
+		};
+
+		struct Stats
+		{
+			// Of the last Update().
+			uint32_t due = 0;
+			uint32_t updated = 0;
+			double updateMs = 0.0;
+			// Seconds the most overdue agent has waited
+			// past its time.
+			float maxLateness = 0.0f;
+		};
+
+		UpdateScheduler();
+		explicit UpdateScheduler(const Settings& settings);
+
+		UpdateScheduler(const UpdateScheduler&) = delete;
+		UpdateScheduler&
+		operator=(const UpdateScheduler&) = delete;
+
+		// Not from within Update().
+		AgentId Add(const Agent& agent);
+		void Remove(AgentId agent);
+		void SetPosition(AgentId agent,
+		                 const Math::Vec3& position);
+		void SetPriority(AgentId agent, float priority);
+		// Where rates are measured from, e.g. the camera.
+		inline void SetViewer(const Math::Vec3& viewer)
+		{
+			m_viewer = viewer;
+		}
+
+		// Once per frame, from App::Update().
+		void Update(float deltaTime);
+
+		inline const Stats& GetStats() const
+		{
+			return m_stats;
+		}
+		inline uint32_t GetCount() const { return m_count; }
+
+	  private:
+		struct Slot
+		{
+			Agent agent;
+			// Scheduler time of the last update and of the
+			// next.
+			double last = 0.0;
+			double next = 0.0;
+			bool alive = false;
+		};
+
+		struct Due
+		{
+			float urgency;
+			AgentId agent;
+		};
+
+		// Seconds between the agent's updates from where
+		// it stands.
+		double GetInterval(const Slot& slot) const;
+		void Run(AgentId agent);
+		// Takes agents from list, in order, until it ends or
+		// the deadline passes.
+		void RunList(
+		    const std::vector<Due>& list,
+		    std::atomic<uint32_t>& next,
+		    std::chrono::steady_clock::time_point deadline);
+
+	  private:
+		Settings m_settings;
+		std::vector<Slot> m_slots;
+		std::vector<AgentId> m_free;
+		uint32_t m_count = 0;
+		uint32_t m_added = 0;
+		Math::Vec3 m_viewer;
+		double m_time = 0.0;
+		Stats m_stats;
+
+		// Scratch of Update().
+		std::vector<Due> m_due;
+		std::vector<Due> m_mainDue;
+		std::atomic<uint32_t> m_next{0};
+		std::atomic<uint32_t> m_updated{0};
+	};
+} // namespace AthiVegam::Ai
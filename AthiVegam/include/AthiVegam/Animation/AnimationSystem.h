@@ -0,0 +1,138 @@
+#pragma once
+
+#include "AthiVegam/Animation/Pose.h"
+#include "AthiVegam/Math/Matrix.h"
+#include "AthiVegam/Math/Vector.h"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	class Skeleton;
+}
+
+namespace AthiVegam::Managers
+{
+	class JobManager;
+}
+
+namespace AthiVegam::Animation
+{
+	class Clip;
+
+	// Plays layered clips on characters and builds their
+	// skinning palettes (see Graphics::Skinning). Each
+	// character is evaluated on its own, so Update() spreads
+	// them over the job system. Distant characters update
+	// every 2nd, 4th or 8th frame, staggered so each frame
+	// takes an even share; their clocks still advance by
+	// every frame's time.
+	//
+	// Clips and skeletons must outlive the characters using
+	// them. Main thread, or one thread at a time; Update()
+	// itself runs characters on any job thread.
+	class AnimationSystem
+	{
+	  public:
+		using CharacterId = uint32_t;
+		static constexpr CharacterId InvalidCharacter =
+		    0xFFFFFFFF;
+		static constexpr uint32_t MaxLayers = 4;
+
+		struct Settings
+		{
+			// Past each distance from the eye, a character
+			// updates half as often.
+			std::array<float, 3> lodDistances{20.0f, 40.0f,
+			                                  80.0f};
+			// Characters per job.
+			uint32_t batchSize = 4;
+		};
+
+		// Layer 0 is the base pose; later layers blend over
+		// it by weight, or add to it if their clip is
+		// additive. Layers without a clip are skipped.
+		struct Layer
+		{
+			const Clip* clip = nullptr;
+			float time = 0.0f;
+			float speed = 1.0f;
+			float weight = 1.0f;
+			// Past the end, wraps around instead of holding
+			// the last frame.
+			bool loop = true;
+		};
+
+		AnimationSystem();
+		explicit AnimationSystem(const Settings& settings);
+
+		CharacterId Create(const Graphics::Skeleton& skeleton);
+		void Destroy(CharacterId character);
+
+		void SetLayer(CharacterId character, uint32_t index,
+		              const Layer& layer);
+		const Layer& GetLayer(CharacterId character,
+		                      uint32_t index) const;
+		// Per-bone weights of a blended layer, multiplying
+		// its weight, e.g. to play a clip on the upper body
+		// only. Bones past its end, or all of them when
+		// empty, blend fully.
+		void SetLayerMask(CharacterId character,
+		                  uint32_t index,
+		                  std::span<const float> boneWeights);
+		// Where the character is, for its update rate.
+		void SetPosition(CharacterId character,
+		                 const Math::Vec3& position);
+
+		// Advances every character by deltaTime and
+		// evaluates the ones due this frame.
+		void Update(float deltaTime, const Math::Vec3& eye);
+		void Update(float deltaTime, const Math::Vec3& eye,
+		            Managers::JobManager& jobs);
+
+		// Model-space skinning matrices as of the
+		// character's last evaluation.
+		std::span<const Math::Mat4>
+		GetPalette(CharacterId character) const;
+		// Frames between the character's evaluations.
+		uint32_t GetUpdateInterval(CharacterId character) const;
+		// Characters the last Update() evaluated.
+		inline uint32_t GetEvaluatedCount() const
+		{
+			return static_cast<uint32_t>(m_due.size());
+		}
+
+	  private:
+		struct Character
+		{
+			const Graphics::Skeleton* skeleton = nullptr;
+			std::array<Layer, MaxLayers> layers{};
+			std::array<std::vector<float>, MaxLayers> masks;
+			Math::Vec3 position;
+			// Time since the last evaluation.
+			float pendingTime = 0.0f;
+			uint32_t interval = 1;
+			bool alive = false;
+			bool evaluated = false;
+
+			Pose pose;
+			Pose scratch;
+			std::vector<Math::Mat4> locals;
+			std::vector<Math::Mat4> palette;
+		};
+
+		// Picks the characters due this frame.
+		void Schedule(float deltaTime, const Math::Vec3& eye);
+		void Evaluate(Character& character) const;
+
+	  private:
+		Settings m_settings;
+		std::vector<Character> m_characters;
+		std::vector<CharacterId> m_freeIds;
+		std::vector<CharacterId> m_due;
+		uint32_t m_frame = 0;
+	};
+} // namespace AthiVegam::Animation
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "AthiVegam/Animation/Pose.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace AthiVegam::Animation
+{
+	// Uncompressed frames of an animation, as imported:
+	// frameCount frames of boneCount local transforms,
+	// frame after frame.
+	struct RawClip
+	{
+		float sampleRate = 30.0f;
+		uint32_t frameCount = 0;
+		uint32_t boneCount = 0;
+		std::vector<Transform> frames;
+	};
+
+	// A clip compressed for playback. Each bone's
+	// translation, rotation and scale is a track of its
+	// own from which key reduction drops every frame that
+	// interpolating its neighbours reproduces within a
+	// tolerance, so a still track keeps one key. Rotations
+	// are stored in 6 bytes as their three smallest
+	// components; translations and scales in 6 bytes
+	// within the bounds of their track.
+	//
+	// Built once, then sampled from any number of threads.
+	class Clip
+	{
+	  public:
+		struct Settings
+		{
+			// In model units, and in quaternion component
+			// error, about half the angle in radians.
+			float translationTolerance = 0.001f;
+			float rotationTolerance = 0.0005f;
+			float scaleTolerance = 0.001f;
+			// With a transform per bone, e.g. the bind pose,
+			// the clip becomes additive: it stores each
+			// frame's difference from it, for AddAdditive().
+			std::span<const Transform> additiveReference;
+		};
+
+		Clip() = default;
+		explicit Clip(const RawClip& raw);
+		Clip(const RawClip& raw, const Settings& settings);
+
+		// Writes the pose at time seconds, clamped to the
+		// clip, into out, which must have GetBoneCount()
+		// bones.
+		void Sample(float time, Pose& out) const;
+
+		inline float GetDuration() const
+		{
+			return m_frameCount > 1
+			           ? static_cast<float>(m_frameCount - 1)
+			                 / m_sampleRate
+			           : 0.0f;
+		}
+		inline uint32_t GetBoneCount() const
+		{
+			return static_cast<uint32_t>(m_tracks.size() / 3);
+		}
+		inline bool IsAdditive() const { return m_additive; }
+		// Keys kept over all tracks, and the bytes they and
+		// the tracks take.
+		inline uint32_t GetKeyCount() const
+		{
+			return static_cast<uint32_t>(m_frames.size());
+		}
+		size_t GetSize() const;
+
+	  private:
+		struct Track
+		{
+			uint32_t firstKey = 0;
+			uint32_t keyCount = 0;
+			// Bounds of translation and scale keys.
+			float min[3] = {};
+			float extent[3] = {};
+		};
+		struct PackedKey
+		{
+			uint16_t values[3];
+		};
+
+		void AddVectorTrack(std::span<const Math::Vec3> values,
+		                    float tolerance);
+		void AddRotationTrack(
+		    std::span<const Math::Quat> values,
+		    float tolerance);
+		Math::Vec3 SampleVector(const Track& track,
+		                        float frame) const;
+		Math::Quat SampleRotation(const Track& track,
+		                          float frame) const;
+		// Index of the track's last key at or before frame.
+		uint32_t FindKey(const Track& track,
+		                 float frame) const;
+
+	  private:
+		float m_sampleRate = 30.0f;
+		uint32_t m_frameCount = 0;
+		bool m_additive = false;
+		// Translation, rotation and scale of each bone.
+		std::vector<Track> m_tracks;
+		// Frame of every key, and its value.
+		std::vector<uint16_t> m_frames;
+		std::vector<PackedKey> m_keys;
+	};
+} // namespace AthiVegam::Animation
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "AthiVegam/Math/Matrix.h"
+#include "AthiVegam/Math/Quaternion.h"
+#include "AthiVegam/Math/Vector.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace AthiVegam::Animation
+{
+	// A bone's transform relative to its parent.
+	struct Transform
+	{
+		Math::Vec3 translation;
+		Math::Quat rotation;
+		Math::Vec3 scale{1.0f, 1.0f, 1.0f};
+	};
+
+	// Local transforms of every bone of a skeleton, stored
+	// as one array per component so the kernels below work
+	// on four bones per SIMD instruction. Arrays are padded
+	// to a multiple of four bones with identities.
+	class Pose
+	{
+	  public:
+		// Component arrays, in storage order.
+		enum Stream : uint32_t
+		{
+			TranslationX,
+			TranslationY,
+			TranslationZ,
+			RotationX,
+			RotationY,
+			RotationZ,
+			RotationW,
+			ScaleX,
+			ScaleY,
+			ScaleZ,
+			StreamCount
+		};
+
+		Pose() = default;
+		explicit Pose(uint32_t boneCount);
+
+		// Every bone becomes the identity.
+		void Resize(uint32_t boneCount);
+		void SetIdentity();
+
+		inline uint32_t GetBoneCount() const
+		{
+			return m_boneCount;
+		}
+		// Bones including the padding.
+		inline uint32_t GetPaddedCount() const
+		{
+			return m_paddedCount;
+		}
+
+		inline float* GetStream(Stream stream)
+		{
+			return m_data.data()
+			       + size_t{stream} * m_paddedCount;
+		}
+		inline const float* GetStream(Stream stream) const
+		{
+			return m_data.data()
+			       + size_t{stream} * m_paddedCount;
+		}
+
+		void Set(uint32_t bone, const Transform& transform);
+		Transform Get(uint32_t bone) const;
+
+		// The bones' local matrices, GetBoneCount() of
+		// them, for Graphics::Skeleton::ComputePalette().
+		void ToMatrices(std::span<Math::Mat4> out) const;
+
+	  private:
+		uint32_t m_boneCount = 0;
+		uint32_t m_paddedCount = 0;
+		std::vector<float> m_data;
+	};
+
+	// out = a blended towards b by weight: translations
+	// and scales lerp, rotations nlerp along the shorter
+	// arc. With a mask, bone i blends by weight * mask[i];
+	// the mask holds GetPaddedCount() weights. out may be
+	// a or b.
+	void Blend(const Pose& a, const Pose& b, float weight,
+	           Pose& out, const float* mask = nullptr);
+	// out = base with weight of the additive delta applied
+	// (see Clip): translations add, scales multiply and
+	// rotations compose in the base's frame. out may be
+	// base or delta.
+	void AddAdditive(const Pose& base, const Pose& delta,
+	                 float weight, Pose& out);
+} // namespace AthiVegam::Animation
@@ -1,5 +1,11 @@
 #pragma once
 
+#include "EngineConfig.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
 namespace AthiVegam
 {
 	class App
@@ -7,9 +13,31 @@ namespace AthiVegam
 	  public:
 		virtual ~App() = default;
 
+		// Queried once before the engine initializes.
+		virtual EngineConfig GetEngineConfig() const
+		{
+			return {};
+		}
+
 		virtual void Initialize(){};
 		virtual void Shutdown(){};
-		virtual void Update(){};
-		virtual void Render(){};
+		// Called at EngineConfig::tickRate with the fixed
+		// tick length in seconds.
+		virtual void Update(float deltaTime){};
+		// alpha in [0, 1) is how far the frame lies between
+		// the last two updates, for interpolating state.
+		// Never called on a dedicated server.
+		virtual void Render(float alpha){};
+
+		// Apps built as a game module (see GameModule.h):
+		// when the module is rebuilt, the running App saves
+		// what it needs, e.g. with Core::Serial, and the
+		// reloaded one gets it in place of Initialize().
+		// Engine resources the state names, such as handles,
+		// stay alive across the reload. Apps that save
+		// nothing are shut down and the reloaded one
+		// initialized.
+		virtual void SaveState(std::vector<uint8_t>& state){};
+		virtual void LoadState(std::span<const uint8_t> state){};
 	};
 } // namespace AthiVegam
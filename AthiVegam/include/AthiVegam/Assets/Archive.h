@@ -0,0 +1,131 @@
+#pragma once
+
+#include "AthiVegam/Assets/AssetId.h"
+#include "AthiVegam/Core/File.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace AthiVegam::Assets
+{
+	// On-disk layout of an asset archive, as written by
+	// tools/pack.py. Little-endian:
+	//
+	//   Header
+	//   Entry[entryCount]         sorted by id
+	//   uint32_t[chunkCount]      stored chunk sizes
+	//   per entry, Alignment apart: its stored chunks
+	//
+	// Entries are cut into ChunkSize pieces compressed on
+	// their own with LZ4, so one entry is one sequential
+	// read and its chunks decompress in parallel. Chunks
+	// that do not shrink are stored as they are.
+	namespace ArchiveFormat
+	{
+		constexpr uint32_t Magic = 0x52415641; // "AVAR"
+		constexpr uint32_t Version = 1;
+		// Sector and page aligned, for direct reads.
+		constexpr uint32_t Alignment = 4096;
+		constexpr uint32_t ChunkSize = 64 << 10;
+		// Set in a stored chunk size for an uncompressed
+		// chunk.
+		constexpr uint32_t ChunkUncompressed = 1u << 31;
+
+		enum class EntryType : uint32_t
+		{
+			// A file as it was.
+			Raw,
+			// A MeshPackFormat::MeshHeader and its blobs.
+			Mesh,
+			// A KTX2 file (see Ktx2.h), smallest levels
+			// first, so streaming a level in reads a prefix
+			// of its chunks.
+			Texture,
+			// Pages of a Graphics::VirtualTexture, one per
+			// chunk after the first.
+			VirtualTexture
+		};
+
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t entryCount;
+			uint32_t chunkCount;
+		};
+
+		struct Entry
+		{
+			uint64_t id;
+			// Of the first chunk, from the start of the file.
+			uint64_t offset;
+			// All chunks as stored, and decompressed.
+			uint64_t storedSize;
+			uint64_t size;
+			uint32_t firstChunk;
+			uint32_t chunkCount;
+			EntryType type;
+			uint32_t reserved;
+		};
+
+		static_assert(sizeof(Header) == 16);
+		static_assert(sizeof(Entry) == 48);
+	} // namespace ArchiveFormat
+
+	// An open asset archive. Open() reads the table of
+	// contents; entries are then read in two steps, so
+	// the read and the decompression can run on different
+	// threads. All const members are thread safe.
+	class Archive
+	{
+	  public:
+		using Entry = ArchiveFormat::Entry;
+
+		Archive() = default;
+
+		bool Open(const std::string& path);
+		void Close();
+		inline bool IsOpen() const { return m_file.IsOpen(); }
+		inline const auto& GetPath() const { return m_path; }
+
+		inline std::span<const Entry> GetEntries() const
+		{
+			return m_entries;
+		}
+		const Entry* Find(AssetId id) const;
+
+		// One read of all of the entry's chunks into stored.
+		bool Read(const Entry& entry,
+		          std::vector<uint8_t>& stored) const;
+		// One read of count chunks from chunk first on.
+		bool ReadChunks(const Entry& entry, uint32_t first,
+		                uint32_t count,
+		                std::vector<uint8_t>& stored) const;
+		// Decompresses chunk i of the entry from what Read()
+		// returned into its place in out, which holds
+		// entry.size bytes. After ReadChunks(), first is the
+		// chunk it started at, and out starts there too.
+		bool DecompressChunk(const Entry& entry, uint32_t i,
+		                     const uint8_t* stored,
+		                     uint8_t* out,
+		                     uint32_t first = 0) const;
+		// Decompressed bytes in count chunks from first on.
+		static uint64_t GetChunksSize(const Entry& entry,
+		                              uint32_t first,
+		                              uint32_t count);
+		// Both steps on the calling thread.
+		bool Load(const Entry& entry,
+		          std::vector<uint8_t>& out) const;
+
+	  private:
+		std::string m_path;
+		Core::File m_file;
+		std::vector<Entry> m_entries;
+		std::vector<uint32_t> m_chunkSizes;
+		// Where each chunk starts within its entry's stored
+		// data.
+		std::vector<uint64_t> m_chunkOffsets;
+	};
+} // namespace AthiVegam::Assets
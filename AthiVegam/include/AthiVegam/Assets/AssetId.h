@@ -0,0 +1,23 @@
+#pragma once
+
+#include "AthiVegam/Core/StringId.h"
+
+#include <cstdint>
+#include <string_view>
+
+namespace AthiVegam::Assets
+{
+	// Core::StringId of an asset's name: its path below
+	// the cooked asset root with '/' separators and without
+	// extension, e.g. "props/rock". The cook tools hash names
+	// the same way, so ids are stable across builds.
+	enum class AssetId : uint64_t
+	{
+	};
+
+	constexpr AssetId MakeAssetId(std::string_view name)
+	{
+		return AssetId{static_cast<uint64_t>(
+		    Core::MakeStringId(name))};
+	}
+} // namespace AthiVegam::Assets
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Assets::ImageWriter
+{
+	// RGBA8 pixels, rows packed.
+	struct Image
+	{
+		const uint8_t* pixels = nullptr;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		// The first row is the bottom one, as glReadPixels
+		// returns them.
+		bool bottomUp = false;
+	};
+
+	// An 8-bit PNG, RGB unless alpha is kept. Each row takes
+	// the filter with the smallest residuals, and the data
+	// is deflated with fixed Huffman codes.
+	std::vector<uint8_t> EncodePng(const Image& image,
+	                               bool alpha = false);
+
+	// An uncompressed scanline OpenEXR of half-float RGB.
+	// The pixels are taken to be sRGB encoded and stored
+	// linear.
+	std::vector<uint8_t> EncodeExr(const Image& image);
+} // namespace AthiVegam::Assets::ImageWriter
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Texture.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace AthiVegam::Assets::Ktx2
+{
+	struct Level
+	{
+		// From the start of the file.
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	struct Info
+	{
+		Graphics::TextureDesc desc;
+		std::array<Level, Graphics::Texture::MaxLevels> levels;
+	};
+
+	// The header and level index take this many bytes from
+	// the start of the file.
+	constexpr size_t HeaderSize = 80;
+	constexpr size_t GetIndexSize(uint32_t levelCount)
+	{
+		return HeaderSize + levelCount * 3 * sizeof(uint64_t);
+	}
+
+	// Reads the header and level index of a KTX2 file of
+	// fileSize bytes, of which data holds the first size.
+	// Only plain 2D textures in a Graphics::TextureFormat
+	// are taken; supercompressed (Basis, zstd) files and
+	// arrays, cube maps and 3D textures fail, logged under
+	// name.
+	bool Parse(const uint8_t* data, size_t size,
+	           uint64_t fileSize, Info& info,
+	           std::string_view name);
+
+	// How much of the file holds levels level and up. Mip
+	// streaming reads this much for a level; KTX2 stores
+	// the smallest levels first, so it grows with every
+	// finer level.
+	uint64_t GetPrefixSize(const Info& info, uint32_t level);
+} // namespace AthiVegam::Assets::Ktx2
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AthiVegam::Assets::Lz4
+{
+	// Decodes one raw LZ4 block (no frame header), as
+	// written by tools/pack.py or LZ4_compress_*().
+	// Returns false unless the block is well formed and
+	// decodes to exactly dstSize bytes; never reads or
+	// writes out of bounds.
+	bool Decompress(const uint8_t* src, size_t srcSize,
+	                uint8_t* dst, size_t dstSize);
+
+	// Largest block Compress() writes for srcSize bytes.
+	constexpr size_t GetMaxCompressedSize(size_t srcSize)
+	{
+		return srcSize + srcSize / 255 + 16;
+	}
+	// Encodes src as one raw LZ4 block into dst, which
+	// must hold GetMaxCompressedSize(srcSize) bytes, and
+	// returns its size. Greedy and single-pass: fast
+	// rather than small, for data written at runtime.
+	size_t Compress(const uint8_t* src, size_t srcSize,
+	                uint8_t* dst);
+} // namespace AthiVegam::Assets::Lz4
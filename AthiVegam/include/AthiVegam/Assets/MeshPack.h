@@ -0,0 +1,129 @@
+#pragma once
+
+#include "AthiVegam/Assets/AssetId.h"
+#include "AthiVegam/Core/MappedFile.h"
+#include "AthiVegam/Graphics/Meshlet.h"
+#include "AthiVegam/Graphics/VertexLayout.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace AthiVegam::Assets
+{
+	// On-disk layout of a mesh pack, as written by
+	// tools/cookmeshes.py. Little-endian, used in place:
+	//
+	//   PackHeader
+	//   PackEntry[meshCount]      manifest, sorted by id
+	//   per mesh, Alignment apart:
+	//     MeshHeader
+	//     vertices                interleaved, aligned
+	//     indices                 uint32_t, aligned
+	//     meshlets                Graphics::Meshlet, aligned,
+	//                             dense meshes only
+	namespace MeshPackFormat
+	{
+		constexpr uint32_t Magic = 0x504D5641; // "AVMP"
+		constexpr uint32_t Version = 1;
+		constexpr uint32_t Alignment = 16;
+
+		struct PackHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t meshCount;
+			uint32_t reserved;
+		};
+
+		struct PackEntry
+		{
+			uint64_t id;
+			// Of the MeshHeader, from the start of the file.
+			uint64_t offset;
+			// Header and both blobs.
+			uint64_t size;
+		};
+
+		struct Attribute
+		{
+			uint8_t location;
+			// A Graphics::VertexFormat.
+			uint8_t format;
+			uint16_t offset;
+		};
+
+		struct MeshHeader
+		{
+			uint32_t vertexCount;
+			uint32_t elementCount;
+			uint32_t stride;
+			uint32_t attributeCount;
+			Attribute attributes
+			    [Graphics::VertexLayout::MaxAttributes];
+			// From the start of the MeshHeader.
+			uint32_t vertexOffset;
+			uint32_t indexOffset;
+			// 0 for meshes not split into meshlets; packs
+			// cooked before meshlets had them reserved.
+			uint32_t meshletCount;
+			uint32_t meshletOffset;
+		};
+
+		static_assert(sizeof(PackHeader) == 16);
+		static_assert(sizeof(PackEntry) == 24);
+		static_assert(sizeof(MeshHeader) == 64);
+	} // namespace MeshPackFormat
+
+	// A memory-mapped mesh pack. Finding a mesh is a binary
+	// search of the manifest and a few bounds checks; the
+	// returned view points straight into the mapping, ready
+	// to be copied to the GPU, and stays valid while the
+	// pack is open.
+	class MeshPack
+	{
+	  public:
+		struct MeshView
+		{
+			Graphics::VertexLayout layout;
+			const void* vertices = nullptr;
+			uint32_t vertexCount = 0;
+			const uint32_t* indices = nullptr;
+			uint32_t elementCount = 0;
+			const Graphics::Meshlet* meshlets = nullptr;
+			uint32_t meshletCount = 0;
+		};
+
+		MeshPack() = default;
+
+		bool Open(const std::string& path);
+		void Close();
+		inline bool IsOpen() const { return m_file.IsOpen(); }
+		inline const auto& GetPath() const { return m_path; }
+
+		inline auto GetEntries() const { return m_entries; }
+		bool Contains(AssetId id) const;
+		// False, with an error logged, for ids not in the
+		// pack and for malformed meshes.
+		bool Find(AssetId id, MeshView& view) const;
+
+		// Checks a MeshHeader and its blobs wherever they
+		// were loaded, e.g. from an Archive; the view points
+		// into data.
+		static bool ParseMesh(AssetId id, const uint8_t* data,
+		                      size_t size, MeshView& view);
+
+		// Hints the OS to read the mesh in, e.g. a frame or
+		// two before Find() for it.
+		void Prefetch(AssetId id) const;
+
+	  private:
+		const MeshPackFormat::PackEntry*
+		FindEntry(AssetId id) const;
+
+	  private:
+		std::string m_path;
+		Core::MappedFile m_file;
+		std::span<const MeshPackFormat::PackEntry> m_entries;
+	};
+} // namespace AthiVegam::Assets
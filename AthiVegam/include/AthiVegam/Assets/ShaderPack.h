@@ -0,0 +1,79 @@
+#pragma once
+
+#include "AthiVegam/Assets/AssetId.h"
+#include "AthiVegam/Core/MappedFile.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace AthiVegam::Assets
+{
+	// On-disk layout of a shader pack, as written by
+	// tools/cookshaders.py. Little-endian, used in place:
+	//
+	//   PackHeader
+	//   PackEntry[shaderCount]    manifest, sorted by id
+	//   per stage, Alignment apart:
+	//     GLSL source             includes resolved,
+	//                             NUL-terminated
+	namespace ShaderPackFormat
+	{
+		constexpr uint32_t Magic = 0x50535641; // "AVSP"
+		constexpr uint32_t Version = 1;
+		constexpr uint32_t Alignment = 16;
+
+		struct PackHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t shaderCount;
+			uint32_t reserved;
+		};
+
+		struct PackEntry
+		{
+			// MakeAssetId() of the stage's path, e.g.
+			// "shaders/Quad.vert".
+			uint64_t id;
+			// From the start of the file.
+			uint64_t offset;
+			// Without the terminator.
+			uint64_t size;
+		};
+
+		static_assert(sizeof(PackHeader) == 16);
+		static_assert(sizeof(PackEntry) == 24);
+	} // namespace ShaderPackFormat
+
+	// A memory-mapped shader pack: shader stages cooked
+	// offline, so startup compiles them without reading and
+	// preprocessing files. Sources point into the mapping
+	// and stay valid while the pack is open.
+	class ShaderPack
+	{
+	  public:
+		ShaderPack() = default;
+
+		bool Open(const std::string& path);
+		void Close();
+		inline bool IsOpen() const { return m_file.IsOpen(); }
+		inline const auto& GetPath() const { return m_path; }
+
+		inline auto GetEntries() const { return m_entries; }
+		bool Contains(AssetId id) const;
+		// False for ids not in the pack, and with an error
+		// logged for malformed entries.
+		bool Find(AssetId id, std::string_view& source) const;
+
+	  private:
+		const ShaderPackFormat::PackEntry*
+		FindEntry(AssetId id) const;
+
+	  private:
+		std::string m_path;
+		Core::MappedFile m_file;
+		std::span<const ShaderPackFormat::PackEntry> m_entries;
+	};
+} // namespace AthiVegam::Assets
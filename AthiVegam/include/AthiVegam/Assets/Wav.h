@@ -0,0 +1,77 @@
+#pragma once
+
+#include "AthiVegam/Core/File.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace AthiVegam::Assets
+{
+	// Decodes a WAV file piece by piece to stereo float
+	// frames: 16, 24 and 32-bit PCM, 32-bit float and IMA
+	// ADPCM, which stores 4 bits a sample and suits music
+	// that is streamed rather than loaded whole. Mono is
+	// copied to both channels; files with more than two
+	// channels fail.
+	class WavReader
+	{
+	  public:
+		WavReader() = default;
+		~WavReader() = default;
+
+		WavReader(const WavReader&) = delete;
+		WavReader& operator=(const WavReader&) = delete;
+
+		bool Open(const std::string& path);
+		void Close();
+		inline bool IsOpen() const { return m_file.IsOpen(); }
+
+		inline uint32_t GetSampleRate() const
+		{
+			return m_sampleRate;
+		}
+		inline uint64_t GetFrameCount() const
+		{
+			return m_frameCount;
+		}
+
+		// Decodes up to frameCount frames into out, two
+		// floats each, and returns how many were; fewer at
+		// the end of the data or on a read error.
+		uint32_t Read(float* out, uint32_t frameCount);
+		// Back to the first frame.
+		void Rewind();
+
+	  private:
+		enum class Encoding : uint8_t
+		{
+			Pcm,
+			Float,
+			ImaAdpcm
+		};
+
+		bool DecodeBlock();
+
+	  private:
+		Core::File m_file;
+		std::string m_path;
+		Encoding m_encoding = Encoding::Pcm;
+		uint32_t m_channels = 0;
+		uint32_t m_sampleRate = 0;
+		uint32_t m_bytesPerSample = 0;
+		uint32_t m_blockAlign = 0;
+		uint32_t m_framesPerBlock = 0;
+		uint64_t m_dataOffset = 0;
+		uint64_t m_dataSize = 0;
+		uint64_t m_frameCount = 0;
+
+		uint64_t m_frame = 0;
+		std::vector<uint8_t> m_bytes;
+		// ADPCM: the current block, decoded; m_blockFrame
+		// frames of it are used.
+		std::vector<float> m_block;
+		uint32_t m_blockFrames = 0;
+		uint32_t m_blockFrame = 0;
+	};
+} // namespace AthiVegam::Assets
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "AthiVegam/EngineConfig.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace AthiVegam::Core
+{
+	// Deferred logging for high-volume messages. While
+	// recording, VEGAM_TRACE and VEGAM_DEBUG store their
+	// call site's id and raw arguments in a lock-free ring
+	// owned by the calling thread; formatting happens later
+	// on a background thread, or offline with
+	// tools/decodelog.py when writing to a file. Arguments
+	// must be arithmetic, enums, pointers or strings;
+	// strings are copied, up to MaxStringLength bytes.
+	namespace BinaryLog
+	{
+		enum class ArgType : uint8_t
+		{
+			Int64,
+			UInt64,
+			Double,
+			Bool,
+			String,
+			Pointer
+		};
+
+		// One per log statement, defined by the macros.
+		struct Site
+		{
+			const char* file;
+			uint32_t line;
+			// spdlog::level::level_enum value.
+			uint8_t level;
+			std::atomic<uint32_t> id{0};
+			const char* format = nullptr;
+		};
+
+		static constexpr uint32_t MaxRecordSize = 512;
+		static constexpr uint32_t MaxStringLength = 128;
+
+		// Format writes the messages to the engine logger;
+		// File writes them undecoded to path.
+		bool Start(BinaryLogMode mode,
+		           const std::string& path = {});
+		// Writes what is still queued and stops recording.
+		void Stop();
+
+		namespace Detail
+		{
+			extern std::atomic<bool> recording;
+
+			uint32_t Register(Site& site, const char* format);
+
+			// Encodes a record's arguments on the stack.
+			class RecordWriter
+			{
+			  public:
+				template <typename T>
+				inline void Add(const T& value)
+				{
+					using U = std::decay_t<T>;
+					if constexpr (std::is_same_v<U, bool>)
+					{
+						Put(ArgType::Bool,
+						    static_cast<uint8_t>(value));
+					}
+					else if constexpr (std::is_same_v<U, char>)
+					{
+						PutString(std::string_view(&value, 1));
+					}
+					else if constexpr (std::is_enum_v<U>)
+					{
+						Add(static_cast<
+						    std::underlying_type_t<U>>(value));
+					}
+					else if constexpr (std::is_integral_v<U>
+					                   && std::is_signed_v<U>)
+					{
+						Put(ArgType::Int64,
+						    static_cast<int64_t>(value));
+					}
+					else if constexpr (std::is_integral_v<U>)
+					{
+						Put(ArgType::UInt64,
+						    static_cast<uint64_t>(value));
+					}
+					else if constexpr (
+					    std::is_floating_point_v<U>)
+					{
+						Put(ArgType::Double,
+						    static_cast<double>(value));
+					}
+					else if constexpr (std::is_convertible_v<
+					                       const T&,
+					                       std::string_view>)
+					{
+						PutString(std::string_view(value));
+					}
+					else
+					{
+						static_assert(std::is_pointer_v<U>,
+						              "Type not supported by "
+						              "the binary log");
+						Put(ArgType::Pointer,
+						    reinterpret_cast<uint64_t>(
+						        static_cast<const void*>(
+						            value)));
+					}
+				}
+
+				inline const uint8_t* GetData() const
+				{
+					return m_data;
+				}
+				inline uint32_t GetSize() const
+				{
+					return m_size;
+				}
+				inline bool HasOverflowed() const
+				{
+					return m_overflowed;
+				}
+
+			  private:
+				template <typename T>
+				inline void Put(ArgType type, T value)
+				{
+					if (!Reserve(1 + sizeof(T)))
+					{
+						return;
+					}
+					m_data[m_size++] =
+					    static_cast<uint8_t>(type);
+					std::memcpy(m_data + m_size, &value,
+					            sizeof(T));
+					m_size += sizeof(T);
+				}
+
+				inline void PutString(std::string_view text)
+				{
+					const auto length =
+					    static_cast<uint16_t>(std::min<size_t>(
+					        text.size(), MaxStringLength));
+					if (!Reserve(1 + sizeof(length) + length))
+					{
+						return;
+					}
+					m_data[m_size++] = static_cast<uint8_t>(
+					    ArgType::String);
+					std::memcpy(m_data + m_size, &length,
+					            sizeof(length));
+					m_size += sizeof(length);
+					std::memcpy(m_data + m_size, text.data(),
+					            length);
+					m_size += length;
+				}
+
+				inline bool Reserve(uint32_t bytes)
+				{
+					m_overflowed |=
+					    m_size + bytes > MaxRecordSize;
+					return !m_overflowed;
+				}
+
+			  private:
+				uint8_t m_data[MaxRecordSize];
+				uint32_t m_size = 0;
+				bool m_overflowed = false;
+			};
+
+			void Commit(uint32_t site,
+			            const RecordWriter& writer);
+		} // namespace Detail
+
+		inline bool IsRecording()
+		{
+			return Detail::recording.load(
+			    std::memory_order_relaxed);
+		}
+
+		template <typename... Args>
+		inline void Write(Site& site, const char* format,
+		                  const Args&... args)
+		{
+			auto id = site.id.load(std::memory_order_acquire);
+			if (id == 0)
+			{
+				id = Detail::Register(site, format);
+			}
+
+			Detail::RecordWriter writer;
+			(writer.Add(args), ...);
+			Detail::Commit(id, writer);
+		}
+	} // namespace BinaryLog
+} // namespace AthiVegam::Core
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "AthiVegam/Core/StringId.h"
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace AthiVegam::Core
+{
+	// Named tuning knob, set from the command line
+	// (+name=value), a config file or the ImGui console
+	// (see CVars). Define them at namespace scope, where
+	// they register before main():
+	//
+	//   Core::CVar<bool> depthSort("r.depthSort", false,
+	//                              "Sort draws by depth");
+	//
+	// Get() is a relaxed atomic load, as cheap as reading a
+	// plain variable, and may run on any thread. Values are
+	// set on the main thread.
+	class CVarBase
+	{
+	  public:
+		enum class Type : uint8_t
+		{
+			Bool,
+			Int,
+			Float
+		};
+
+		CVarBase(const CVarBase&) = delete;
+		CVarBase& operator=(const CVarBase&) = delete;
+		// Variables of an unloaded game module (see
+		// GameModule) leave the list.
+		~CVarBase();
+
+		inline const char* GetName() const { return m_name; }
+		inline StringId GetId() const { return m_id; }
+		inline const char* GetDescription() const
+		{
+			return m_description;
+		}
+		inline Type GetType() const { return m_type; }
+		inline CVarBase* GetNext() const { return m_next; }
+
+		// Parses value as the variable's type: 0, 1, true,
+		// false, on or off for bools, and decimal or 0x hex
+		// for ints. False if it does not parse.
+		bool Set(std::string_view value);
+		std::string ToString() const;
+		inline void Reset() { SetBits(m_default); }
+		inline bool IsDefault() const
+		{
+			return GetBits() == m_default;
+		}
+
+		// Counts sets; 0 until the first. Code applying a
+		// variable to other state keeps the version it last
+		// applied: Changed() is true once per change since.
+		inline uint32_t GetVersion() const
+		{
+			return m_version.load(std::memory_order_acquire);
+		}
+		inline bool Changed(uint32_t& seen) const
+		{
+			const auto version = GetVersion();
+			if (version == seen)
+			{
+				return false;
+			}
+			seen = version;
+			return true;
+		}
+
+	  protected:
+		CVarBase(const char* name, const char* description,
+		         Type type, uint32_t bits);
+
+		inline uint32_t GetBits() const
+		{
+			return m_bits.load(std::memory_order_relaxed);
+		}
+		void SetBits(uint32_t bits);
+
+	  private:
+		const char* m_name;
+		StringId m_id;
+		const char* m_description;
+		Type m_type;
+		uint32_t m_default;
+		std::atomic<uint32_t> m_bits;
+		std::atomic<uint32_t> m_version{0};
+		CVarBase* m_next;
+	};
+
+	// bool, int32_t or float.
+	template <typename T>
+	class CVar : public CVarBase
+	{
+		static_assert(std::is_same_v<T, bool>
+		                  || std::is_same_v<T, int32_t>
+		                  || std::is_same_v<T, float>,
+		              "CVars are bool, int32_t or float");
+
+	  public:
+		CVar(const char* name, T value,
+		     const char* description)
+		    : CVarBase(name, description, GetTypeOf(),
+		               ToBits(value))
+		{
+		}
+
+		inline T Get() const { return FromBits(GetBits()); }
+		inline void Set(T value) { SetBits(ToBits(value)); }
+		using CVarBase::Set;
+
+	  private:
+		static constexpr Type GetTypeOf()
+		{
+			if constexpr (std::is_same_v<T, bool>)
+			{
+				return Type::Bool;
+			}
+			else if constexpr (std::is_same_v<T, int32_t>)
+			{
+				return Type::Int;
+			}
+			else
+			{
+				return Type::Float;
+			}
+		}
+		static inline uint32_t ToBits(T value)
+		{
+			if constexpr (std::is_same_v<T, bool>)
+			{
+				return value ? 1 : 0;
+			}
+			else
+			{
+				return std::bit_cast<uint32_t>(value);
+			}
+		}
+		static inline T FromBits(uint32_t bits)
+		{
+			if constexpr (std::is_same_v<T, bool>)
+			{
+				return bits != 0;
+			}
+			else
+			{
+				return std::bit_cast<T>(bits);
+			}
+		}
+	};
+
+	namespace CVars
+	{
+		// nullptr if no variable has the name.
+		CVarBase* Find(StringId id);
+		inline CVarBase* Find(std::string_view name)
+		{
+			return Find(MakeStringId(name));
+		}
+		// First of every registered variable; walk the rest
+		// with CVarBase::GetNext().
+		CVarBase* GetFirst();
+
+		// Logs unknown names and values that do not parse.
+		bool Set(std::string_view name,
+		         std::string_view value);
+		// One console line: "name value" sets the variable,
+		// "name" logs its value and description. Blank lines
+		// and lines starting with # are ignored.
+		bool Execute(std::string_view line);
+		// Executes each line of a text file; false if it
+		// cannot be opened.
+		bool LoadFile(const std::string& path);
+
+		// ImGui window listing, filtering and editing every
+		// variable, with a command line.
+		void DrawPanel();
+	} // namespace CVars
+} // namespace AthiVegam::Core
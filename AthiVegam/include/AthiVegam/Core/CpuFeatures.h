@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) \
+    || defined(__i386__)
+#define AV_CPU_X86
+#endif
+
+// Marks a kernel using instructions above the build's
+// baseline; only call it through SelectKernel(). MSVC
+// compiles any intrinsic without a flag.
+#if defined(AV_CPU_X86) \
+    && (defined(__GNUC__) || defined(__clang__))
+#define AV_TARGET_AVX2 __attribute__((target("avx2")))
+#define AV_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define AV_TARGET_AVX2
+#define AV_TARGET_AVX512
+#endif
+
+namespace AthiVegam::Core
+{
+	// What the CPU running us supports, as SDL reports it;
+	// AVX and up only where the OS saves the registers.
+	struct CpuFeatures
+	{
+		bool sse2 = false;
+		bool sse41 = false;
+		bool avx = false;
+		bool avx2 = false;
+		bool avx512f = false;
+		bool neon = false;
+		uint32_t cores = 1;
+		uint32_t cacheLine = 64;
+	};
+
+	// Detected on first use; any thread.
+	const CpuFeatures& GetCpuFeatures();
+	void LogCpuFeatures();
+
+	// One implementation of a kernel per instruction set;
+	// null where there is none. baseline is built for the
+	// build's own target, so is SSE2 on x64 and NEON on
+	// ARM64, which every such CPU has.
+	template <typename Fn>
+	struct Kernels
+	{
+		Fn baseline = nullptr;
+		Fn avx2 = nullptr;
+		Fn avx512 = nullptr;
+	};
+
+	// The best of kernels this CPU runs. Select once and
+	// keep the pointer:
+	//
+	//   const auto mix = Core::SelectKernel<MixFn>(
+	//       {.baseline = Mix, .avx2 = MixAvx2});
+	template <typename Fn>
+	Fn SelectKernel(const Kernels<Fn>& kernels)
+	{
+		const auto& cpu = GetCpuFeatures();
+		if (kernels.avx512 && cpu.avx512f)
+		{
+			return kernels.avx512;
+		}
+		if (kernels.avx2 && cpu.avx2)
+		{
+			return kernels.avx2;
+		}
+		return kernels.baseline;
+	}
+} // namespace AthiVegam::Core
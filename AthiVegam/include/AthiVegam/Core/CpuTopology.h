@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Core
+{
+	// Logical CPUs by core kind. Where every core is alike,
+	// or the OS doesn't say, all are performance CPUs.
+	struct CpuTopology
+	{
+		std::vector<uint32_t> performance;
+		std::vector<uint32_t> efficiency;
+
+		inline bool IsHybrid() const
+		{
+			return !performance.empty()
+			       && !efficiency.empty();
+		}
+	};
+
+	// Detected on first use; any thread.
+	const CpuTopology& GetCpuTopology();
+
+	enum class ThreadClass : uint8_t
+	{
+		// Frame-critical: main, render, audio and input.
+		// Performance cores, with raised priority where
+		// the OS allows it.
+		Latency,
+		// Job workers: performance cores.
+		Worker,
+		// Streaming, logging, capture: efficiency cores,
+		// with lowered priority.
+		Background,
+	};
+
+	// Places the calling thread. Off hybrid CPUs only the
+	// priority changes. The "cpu.threadPlacement" CVar
+	// turns it off.
+	void SetThreadClass(ThreadClass threadClass);
+} // namespace AthiVegam::Core
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "AthiVegam/Core/FlatHashMap.h"
+#include "AthiVegam/Log.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace AthiVegam::Core
+{
+	using EventTypeId = uint32_t;
+
+	// Ids are handed out on first use and are stable for
+	// the rest of the run.
+	EventTypeId RegisterEventType();
+
+	template <typename T>
+	inline EventTypeId GetEventTypeId()
+	{
+		static const EventTypeId id = RegisterEventType();
+		return id;
+	}
+
+	// Typed events. Publish() appends to a contiguous queue
+	// per event type, and Dispatch() hands each subscriber
+	// its type's whole batch as one span, in publishing
+	// order: one call per subscriber per batch rather than
+	// one per event. Events published while dispatching
+	// wait for the next Dispatch(). Main thread only.
+	class EventBus
+	{
+	  public:
+		using SubscriptionId = uint32_t;
+		template <typename T>
+		using Handler =
+		    std::function<void(std::span<const T>)>;
+
+		EventBus() = default;
+		EventBus(const EventBus&) = delete;
+		EventBus& operator=(const EventBus&) = delete;
+
+		template <typename T>
+		void Publish(const T& event)
+		{
+			static_assert(std::is_trivially_copyable_v<T>,
+			              "Events must be trivially copyable");
+			GetQueue<T>().events.push_back(event);
+		}
+
+		// Subscribers added while dispatching get the next
+		// batch on.
+		template <typename T>
+		SubscriptionId Subscribe(Handler<T> handler)
+		{
+			VEGAM_ASSERT(handler, "Subscribers need a handler");
+			auto& queue = GetQueue<T>();
+			auto& list = queue.dispatching ? queue.added
+			                               : queue.subscribers;
+			const auto id = ++m_nextId;
+			list.push_back({id, std::move(handler)});
+			m_subscriptions.emplace(id, GetEventTypeId<T>());
+			return id;
+		}
+
+		// Safe from a handler, its own included.
+		void Unsubscribe(SubscriptionId id);
+
+		// Delivers the queued events of every type, in the
+		// order the types were first used.
+		void Dispatch();
+		template <typename T>
+		void Dispatch()
+		{
+			GetQueue<T>().Dispatch();
+		}
+
+		// Drops the queued events, delivering nothing.
+		void Clear();
+
+	  private:
+		struct QueueBase
+		{
+			virtual ~QueueBase() = default;
+			virtual void Dispatch() = 0;
+			virtual void Unsubscribe(SubscriptionId id) = 0;
+			virtual void Clear() = 0;
+		};
+
+		template <typename T>
+		struct Queue final : QueueBase
+		{
+			struct Subscriber
+			{
+				// 0 once unsubscribed.
+				SubscriptionId id;
+				Handler<T> handler;
+			};
+
+			std::vector<T> events;
+			// The batch being delivered.
+			std::vector<T> batch;
+			std::vector<Subscriber> subscribers;
+			// Subscribed while dispatching.
+			std::vector<Subscriber> added;
+			bool dispatching = false;
+			bool removed = false;
+
+			void Dispatch() override
+			{
+				VEGAM_ASSERT(!dispatching,
+				             "Dispatch from its own handler");
+				if (events.empty())
+				{
+					return;
+				}
+				batch.swap(events);
+				dispatching = true;
+				const std::span<const T> span(batch);
+				for (const auto& subscriber : subscribers)
+				{
+					if (subscriber.id != 0)
+					{
+						subscriber.handler(span);
+					}
+				}
+				dispatching = false;
+				batch.clear();
+				Compact();
+			}
+
+			void Unsubscribe(SubscriptionId id) override
+			{
+				for (auto* list : {&subscribers, &added})
+				{
+					for (auto& subscriber : *list)
+					{
+						if (subscriber.id == id)
+						{
+							// The handler may be running.
+							subscriber.id = 0;
+							removed = true;
+						}
+					}
+				}
+				if (!dispatching)
+				{
+					Compact();
+				}
+			}
+
+			void Compact()
+			{
+				if (removed)
+				{
+					std::erase_if(subscribers,
+					              [](const Subscriber& s) {
+						              return s.id == 0;
+					              });
+					removed = false;
+				}
+				for (auto& subscriber : added)
+				{
+					if (subscriber.id != 0)
+					{
+						subscribers.push_back(
+						    std::move(subscriber));
+					}
+				}
+				added.clear();
+			}
+
+			void Clear() override { events.clear(); }
+		};
+
+		template <typename T>
+		Queue<T>& GetQueue()
+		{
+			const auto type = GetEventTypeId<T>();
+			if (type >= m_queues.size())
+			{
+				m_queues.resize(type + 1);
+			}
+			auto& queue = m_queues[type];
+			if (!queue)
+			{
+				queue = std::make_unique<Queue<T>>();
+				m_order.push_back(type);
+			}
+			return static_cast<Queue<T>&>(*queue);
+		}
+
+	  private:
+		// By event type id.
+		std::vector<std::unique_ptr<QueueBase>> m_queues;
+		// Type ids in the order their queues were made.
+		std::vector<EventTypeId> m_order;
+		FlatHashMap<SubscriptionId, EventTypeId>
+		    m_subscriptions;
+		SubscriptionId m_nextId = 0;
+	};
+} // namespace AthiVegam::Core
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+// The engine's events, published by VegamWindow while
+// pumping SDL's and delivered by Engine::GetEventBus()
+// right after, before the frame's ticks.
+namespace AthiVegam::Core
+{
+	// The window closing, or the app asked to quit; the
+	// engine quits once delivered.
+	struct QuitRequested
+	{
+	};
+
+	// In window coordinates, and the drawable in pixels.
+	struct WindowResized
+	{
+		int width;
+		int height;
+		int drawableWidth;
+		int drawableHeight;
+	};
+
+	struct WindowFocusChanged
+	{
+		bool focused;
+	};
+
+	struct WindowMinimized
+	{
+		// False once restored or maximized.
+		bool minimized;
+	};
+
+	// Relative motion of the mouse, in pixels.
+	struct MouseMoved
+	{
+		float dx;
+		float dy;
+	};
+
+	// Fractional on high-resolution wheels and touchpads.
+	struct MouseWheel
+	{
+		float x;
+		float y;
+	};
+
+	struct ControllerConnected
+	{
+		int deviceIndex;
+	};
+
+	struct ControllerDisconnected
+	{
+		int instanceId;
+	};
+} // namespace AthiVegam::Core
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace AthiVegam::Core
+{
+	// Read-only file for positional reads. ReadAt() never
+	// moves a shared file position, so several threads may
+	// read one File at once.
+	class File
+	{
+	  public:
+		File() = default;
+		~File();
+
+		File(const File&) = delete;
+		File& operator=(const File&) = delete;
+
+		bool Open(const std::string& path);
+		void Close();
+
+		inline bool IsOpen() const { return m_isOpen; }
+		inline uint64_t GetSize() const { return m_size; }
+
+		// Reads exactly size bytes at offset into dst.
+		bool ReadAt(uint64_t offset, void* dst,
+		            size_t size) const;
+
+	  private:
+		bool m_isOpen = false;
+		uint64_t m_size = 0;
+#ifdef AV_PLATFORM_WINDOWS
+		void* m_handle = nullptr;
+#else
+		int m_fd = -1;
+#endif // AV_PLATFORM_WINDOWS
+	};
+} // namespace AthiVegam::Core
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace AthiVegam::Core
+{
+	// Polls the modification times of a set of files on a
+	// background thread and queues the paths that changed.
+	// Polling keeps it portable and cheap for the few dozen
+	// files an editor session edits; an editor saving a
+	// file in several writes is reported once per interval.
+	class FileWatcher
+	{
+	  public:
+		FileWatcher() = default;
+		~FileWatcher();
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		// onChange runs on the watcher thread after changes
+		// were queued, e.g. to wake an idle main loop.
+		bool Start(std::chrono::milliseconds interval,
+		           std::function<void()> onChange = {});
+		void Stop();
+		inline bool IsRunning() const
+		{
+			return m_thread.joinable();
+		}
+
+		// Any thread. Paths are compared as given.
+		void Watch(const std::string& path);
+		void Unwatch(const std::string& path);
+
+		// Paths changed since the last call, each once.
+		std::vector<std::string> TakeChanges();
+
+	  private:
+		void Run();
+
+	  private:
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_stopRequested = false;
+		std::chrono::milliseconds m_interval{};
+		std::function<void()> m_onChange;
+		// Last seen write time per path; the minimum for
+		// files that did not exist.
+		std::unordered_map<std::string,
+		                   std::filesystem::file_time_type>
+		    m_files;
+		std::vector<std::string> m_changes;
+	};
+} // namespace AthiVegam::Core
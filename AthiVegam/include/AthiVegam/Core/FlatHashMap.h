@@ -0,0 +1,466 @@
+#pragma once
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace AthiVegam::Core
+{
+	// Open-addressing hash map storing its entries in one
+	// flat array, with Robin Hood linear probing: an entry
+	// further from its home slot takes the place of one
+	// closer to its own, which keeps probe runs short, and
+	// erasing shifts the run back instead of leaving
+	// tombstones. A lookup touches one or two cache lines
+	// where std::unordered_map chases a node per entry.
+	//
+	// Inserting and erasing invalidate iterators and
+	// pointers to entries. Entries are std::pair<K, V>;
+	// never modify a key through an iterator. Hashes are
+	// remixed, so identity hashes such as std::hash<int>
+	// are fine.
+	template <typename K, typename V,
+	          typename Hash = std::hash<K>,
+	          typename KeyEqual = std::equal_to<K>,
+	          typename Allocator =
+	              std::allocator<std::pair<K, V>>>
+	class FlatHashMap
+	{
+	  public:
+		using value_type = std::pair<K, V>;
+
+		template <bool Const>
+		class Iterator
+		{
+		  public:
+			using Value =
+			    std::conditional_t<Const, const value_type,
+			                       value_type>;
+
+			Iterator() = default;
+			Iterator(Value* entries, const uint8_t* distances,
+			         size_t index, size_t end)
+			    : m_entries(entries), m_distances(distances),
+			      m_index(index), m_end(end)
+			{
+				Skip();
+			}
+			// iterator to const_iterator.
+			template <bool C = Const,
+			          typename = std::enable_if_t<C>>
+			Iterator(const Iterator<false>& other)
+			    : m_entries(other.m_entries),
+			      m_distances(other.m_distances),
+			      m_index(other.m_index), m_end(other.m_end)
+			{
+			}
+
+			inline Value& operator*() const
+			{
+				return m_entries[m_index];
+			}
+			inline Value* operator->() const
+			{
+				return &m_entries[m_index];
+			}
+			inline Iterator& operator++()
+			{
+				++m_index;
+				Skip();
+				return *this;
+			}
+			inline bool operator==(const Iterator& other) const
+			{
+				return m_index == other.m_index;
+			}
+
+		  private:
+			friend class FlatHashMap;
+			friend class Iterator<true>;
+
+			inline void Skip()
+			{
+				while (m_index < m_end
+				       && m_distances[m_index] == 0)
+				{
+					++m_index;
+				}
+			}
+
+			Value* m_entries = nullptr;
+			const uint8_t* m_distances = nullptr;
+			size_t m_index = 0;
+			size_t m_end = 0;
+		};
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+
+		FlatHashMap() = default;
+		explicit FlatHashMap(const Allocator& allocator)
+		    : m_allocator(allocator)
+		{
+		}
+		~FlatHashMap()
+		{
+			clear();
+			Deallocate();
+		}
+
+		FlatHashMap(const FlatHashMap& other)
+		    : m_hash(other.m_hash), m_equal(other.m_equal),
+		      m_allocator(other.m_allocator)
+		{
+			reserve(other.size());
+			for (const auto& entry : other)
+			{
+				try_emplace(entry.first, entry.second);
+			}
+		}
+		FlatHashMap(FlatHashMap&& other) noexcept
+		{
+			Swap(other);
+		}
+		FlatHashMap& operator=(FlatHashMap other) noexcept
+		{
+			Swap(other);
+			return *this;
+		}
+
+		inline size_t size() const { return m_size; }
+		inline bool empty() const { return m_size == 0; }
+		inline size_t capacity() const { return m_capacity; }
+
+		inline iterator begin()
+		{
+			return {m_entries, m_distances, 0, m_capacity};
+		}
+		inline iterator end()
+		{
+			return {m_entries, m_distances, m_capacity,
+			        m_capacity};
+		}
+		inline const_iterator begin() const
+		{
+			return {m_entries, m_distances, 0, m_capacity};
+		}
+		inline const_iterator end() const
+		{
+			return {m_entries, m_distances, m_capacity,
+			        m_capacity};
+		}
+
+		iterator find(const K& key)
+		{
+			return {m_entries, m_distances, Find(key),
+			        m_capacity};
+		}
+		const_iterator find(const K& key) const
+		{
+			return {m_entries, m_distances, Find(key),
+			        m_capacity};
+		}
+		inline bool contains(const K& key) const
+		{
+			return Find(key) != m_capacity;
+		}
+
+		// Constructs the value from args only if key is
+		// absent.
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(const K& key,
+		                                      Args&&... args)
+		{
+			if (const auto index = Find(key);
+			    index != m_capacity)
+			{
+				return {MakeIterator(index), false};
+			}
+			if ((m_size + 1) * 8 > m_capacity * 7)
+			{
+				Rehash(m_capacity == 0 ? MinCapacity
+				                       : m_capacity * 2);
+			}
+			auto index = Insert(value_type(
+			    std::piecewise_construct,
+			    std::forward_as_tuple(key),
+			    std::forward_as_tuple(
+			        std::forward<Args>(args)...)));
+			if (index == Rehashed)
+			{
+				index = Find(key);
+			}
+			return {MakeIterator(index), true};
+		}
+		template <typename... Args>
+		inline std::pair<iterator, bool>
+		emplace(const K& key, Args&&... args)
+		{
+			return try_emplace(key,
+			                   std::forward<Args>(args)...);
+		}
+		template <typename M>
+		std::pair<iterator, bool>
+		insert_or_assign(const K& key, M&& value)
+		{
+			if (const auto index = Find(key);
+			    index != m_capacity)
+			{
+				m_entries[index].second = std::forward<M>(value);
+				return {MakeIterator(index), false};
+			}
+			return try_emplace(key, std::forward<M>(value));
+		}
+		inline V& operator[](const K& key)
+		{
+			return try_emplace(key).first->second;
+		}
+
+		size_t erase(const K& key)
+		{
+			const auto index = Find(key);
+			if (index == m_capacity)
+			{
+				return 0;
+			}
+			EraseAt(index);
+			return 1;
+		}
+		// Invalidates it and every other iterator.
+		inline void erase(const_iterator it)
+		{
+			EraseAt(it.m_index);
+		}
+
+		void clear()
+		{
+			for (size_t i = 0; i < m_capacity; ++i)
+			{
+				if (m_distances[i] != 0)
+				{
+					m_entries[i].~value_type();
+					m_distances[i] = 0;
+				}
+			}
+			m_size = 0;
+		}
+		// Room for count entries without rehashing.
+		void reserve(size_t count)
+		{
+			auto capacity = m_capacity == 0 ? MinCapacity
+			                                : m_capacity;
+			while (count * 8 > capacity * 7)
+			{
+				capacity *= 2;
+			}
+			if (capacity > m_capacity)
+			{
+				Rehash(capacity);
+			}
+		}
+
+	  private:
+		static constexpr size_t MinCapacity = 16;
+		// Distances are stored plus one, 0 meaning empty; a
+		// run this long forces a rehash.
+		static constexpr uint8_t MaxDistance = 255;
+		// Insert() result when the entry's slot is unknown.
+		static constexpr size_t Rehashed = SIZE_MAX;
+
+		using EntryAllocator = typename std::allocator_traits<
+		    Allocator>::template rebind_alloc<value_type>;
+		using ByteAllocator = typename std::allocator_traits<
+		    Allocator>::template rebind_alloc<uint8_t>;
+
+		inline iterator MakeIterator(size_t index)
+		{
+			iterator it;
+			it.m_entries = m_entries;
+			it.m_distances = m_distances;
+			it.m_index = index;
+			it.m_end = m_capacity;
+			return it;
+		}
+
+		// Fibonacci hashing: the top bits of the product
+		// depend on every bit of the hash.
+		inline size_t GetHome(const K& key) const
+		{
+			const auto hash = static_cast<uint64_t>(m_hash(key));
+			return static_cast<size_t>(
+			    (hash * 0x9E3779B97F4A7C15ull) >> m_shift);
+		}
+
+		size_t Find(const K& key) const
+		{
+			if (m_size == 0)
+			{
+				return m_capacity;
+			}
+			auto index = GetHome(key);
+			for (uint32_t distance = 1;; ++distance)
+			{
+				// Entries past here are closer to home than
+				// key would be.
+				if (m_distances[index] < distance)
+				{
+					return m_capacity;
+				}
+				if (m_equal(m_entries[index].first, key))
+				{
+					return index;
+				}
+				index = (index + 1) & (m_capacity - 1);
+			}
+		}
+
+		// Key must be absent and a slot free. Returns the
+		// slot the entry landed in.
+		size_t Insert(value_type&& entry)
+		{
+			auto index = GetHome(entry.first);
+			uint32_t distance = 1;
+			auto placed = m_capacity;
+			for (;; ++distance)
+			{
+				if (distance == MaxDistance)
+				{
+					// Clustered; spread out and start over.
+					// A sparse table clustering means many
+					// keys share one hash.
+					VEGAM_ASSERT(m_size * 4 >= m_capacity,
+					             "FlatHashMap hash collides");
+					Rehash(m_capacity * 2);
+					Insert(std::move(entry));
+					return Rehashed;
+				}
+				if (m_distances[index] == 0)
+				{
+					new (&m_entries[index])
+					    value_type(std::move(entry));
+					m_distances[index] =
+					    static_cast<uint8_t>(distance);
+					++m_size;
+					return placed == m_capacity ? index
+					                            : placed;
+				}
+				if (m_distances[index] < distance)
+				{
+					// Rob the richer entry and carry it on.
+					std::swap(entry, m_entries[index]);
+					const auto robbed = m_distances[index];
+					m_distances[index] =
+					    static_cast<uint8_t>(distance);
+					distance = robbed;
+					if (placed == m_capacity)
+					{
+						placed = index;
+					}
+				}
+				index = (index + 1) & (m_capacity - 1);
+			}
+		}
+
+		void EraseAt(size_t index)
+		{
+			const auto mask = m_capacity - 1;
+			auto next = (index + 1) & mask;
+			while (m_distances[next] > 1)
+			{
+				m_entries[index] = std::move(m_entries[next]);
+				m_distances[index] =
+				    static_cast<uint8_t>(m_distances[next] - 1);
+				index = next;
+				next = (next + 1) & mask;
+			}
+			m_entries[index].~value_type();
+			m_distances[index] = 0;
+			--m_size;
+		}
+
+		void Rehash(size_t capacity)
+		{
+			auto* entries = m_entries;
+			auto* distances = m_distances;
+			const auto oldCapacity = m_capacity;
+
+			EntryAllocator entryAllocator(m_allocator);
+			ByteAllocator byteAllocator(m_allocator);
+			m_entries = std::allocator_traits<
+			    EntryAllocator>::allocate(entryAllocator,
+			                              capacity);
+			m_distances = std::allocator_traits<
+			    ByteAllocator>::allocate(byteAllocator,
+			                             capacity);
+			std::fill_n(m_distances, capacity, uint8_t{0});
+			m_capacity = capacity;
+			m_shift = 64 - std::countr_zero(capacity);
+			m_size = 0;
+
+			for (size_t i = 0; i < oldCapacity; ++i)
+			{
+				if (distances[i] != 0)
+				{
+					Insert(std::move(entries[i]));
+					entries[i].~value_type();
+				}
+			}
+			if (oldCapacity > 0)
+			{
+				std::allocator_traits<EntryAllocator>::
+				    deallocate(entryAllocator, entries,
+				               oldCapacity);
+				std::allocator_traits<ByteAllocator>::
+				    deallocate(byteAllocator, distances,
+				               oldCapacity);
+			}
+		}
+
+		void Deallocate()
+		{
+			if (m_capacity == 0)
+			{
+				return;
+			}
+			EntryAllocator entryAllocator(m_allocator);
+			ByteAllocator byteAllocator(m_allocator);
+			std::allocator_traits<EntryAllocator>::deallocate(
+			    entryAllocator, m_entries, m_capacity);
+			std::allocator_traits<ByteAllocator>::deallocate(
+			    byteAllocator, m_distances, m_capacity);
+			m_entries = nullptr;
+			m_distances = nullptr;
+			m_capacity = 0;
+		}
+
+		void Swap(FlatHashMap& other) noexcept
+		{
+			std::swap(m_entries, other.m_entries);
+			std::swap(m_distances, other.m_distances);
+			std::swap(m_capacity, other.m_capacity);
+			std::swap(m_size, other.m_size);
+			std::swap(m_shift, other.m_shift);
+			std::swap(m_hash, other.m_hash);
+			std::swap(m_equal, other.m_equal);
+			std::swap(m_allocator, other.m_allocator);
+		}
+
+	  private:
+		value_type* m_entries = nullptr;
+		uint8_t* m_distances = nullptr;
+		size_t m_capacity = 0;
+		size_t m_size = 0;
+		uint32_t m_shift = 64;
+		[[no_unique_address]] Hash m_hash;
+		[[no_unique_address]] KeyEqual m_equal;
+		[[no_unique_address]] Allocator m_allocator;
+	};
+} // namespace AthiVegam::Core
@@ -0,0 +1,15 @@
+#pragma once
+
+namespace AthiVegam::Core::FloatEnv
+{
+	// Pins the calling thread's floating-point environment
+	// to the IEEE defaults: round to nearest, denormals
+	// kept rather than flushed to zero. Threads start that
+	// way, but drivers and audio or SIMD libraries may
+	// change it, and a simulation that must match across
+	// machines (see EngineConfig::deterministic) cannot
+	// tell. Job workers set it when they start.
+	void SetDeterministic();
+	// Whether the calling thread still has it.
+	bool IsDeterministic();
+} // namespace AthiVegam::Core::FloatEnv
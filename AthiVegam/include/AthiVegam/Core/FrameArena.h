@@ -0,0 +1,132 @@
+#pragma once
+
+#include "AthiVegam/Core/Memory.h"
+#include "AthiVegam/Core/VirtualArena.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace AthiVegam::Core
+{
+	// Scratch memory for transient, per-frame data. Any
+	// thread may allocate; allocation is a bump of an atomic
+	// offset, and nothing is freed individually. There are
+	// two buffers: memory allocated during a frame stays
+	// valid until the end of the next frame's
+	// Engine::Render(), so the render thread may read what
+	// the main thread recorded. Objects are never destroyed,
+	// so only store trivially destructible data or destroy
+	// it yourself.
+	//
+	// Each buffer is a VirtualArena, so it commits more
+	// memory in place as frames need it; only a frame
+	// outgrowing its reservation falls back to the heap.
+	class FrameArena
+	{
+	  public:
+		static constexpr size_t DefaultAlignment =
+		    alignof(std::max_align_t);
+
+		FrameArena() = default;
+		~FrameArena() = default;
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		// Commits capacity bytes per buffer up front, out
+		// of reserve.
+		void Initialize(size_t capacity, size_t reserve,
+		                bool largePages = false);
+		void Shutdown();
+
+		void* Allocate(size_t size,
+		               size_t alignment = DefaultAlignment);
+		template <typename T>
+		inline T* Allocate(size_t count)
+		{
+			return static_cast<T*>(
+			    Allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		// Starts a new frame: the buffer used two frames ago
+		// is reset and becomes current. Main thread, while
+		// no other thread allocates.
+		void NextFrame();
+
+		// Bytes allocated in the current frame.
+		size_t GetUsed() const;
+		// Committed to the current buffer.
+		size_t GetCapacity() const;
+
+	  private:
+		struct Buffer
+		{
+			using Block =
+			    Memory::Vector<std::byte, Memory::Tag::Core>;
+
+			VirtualArena memory;
+			std::vector<Block> overflow;
+			size_t overflowSize = 0;
+		};
+
+		void* AllocateOverflow(Buffer& buffer, size_t size,
+		                       size_t alignment);
+		void Reset(Buffer& buffer);
+
+	  private:
+		std::array<Buffer, 2> m_buffers;
+		uint32_t m_current = 0;
+		std::mutex m_overflowMutex;
+	};
+
+	// STL allocator drawing from a FrameArena;
+	// deallocation is a no-op. Containers using it must
+	// not outlive the arena's memory (see FrameArena).
+	template <typename T>
+	class FrameAllocator
+	{
+	  public:
+		using value_type = T;
+
+		explicit FrameAllocator(FrameArena& arena) noexcept
+		    : m_arena(&arena)
+		{
+		}
+		template <typename U>
+		FrameAllocator(const FrameAllocator<U>& other) noexcept
+		    : m_arena(other.GetArena())
+		{
+		}
+
+		inline T* allocate(size_t count)
+		{
+			auto* memory = m_arena->Allocate<T>(count);
+			if (!memory)
+			{
+				throw std::bad_alloc();
+			}
+			return memory;
+		}
+		inline void deallocate(T*, size_t) noexcept {}
+
+		inline FrameArena* GetArena() const { return m_arena; }
+
+		template <typename U>
+		inline bool
+		operator==(const FrameAllocator<U>& other) const
+		{
+			return m_arena == other.GetArena();
+		}
+
+	  private:
+		FrameArena* m_arena;
+	};
+
+	template <typename T>
+	using FrameVector = std::vector<T, FrameAllocator<T>>;
+} // namespace AthiVegam::Core
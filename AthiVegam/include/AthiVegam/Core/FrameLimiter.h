@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+
+namespace AthiVegam::Core
+{
+	// Caps the frame rate by waiting out the rest of each
+	// frame. Most of the wait is a sleep; the last stretch
+	// spins, because sleeps overshoot by up to a scheduler
+	// quantum. The spin length adapts to the overshoot
+	// measured so far, so it stays short where sleeping is
+	// precise and grows where it is not.
+	class FrameLimiter
+	{
+	  public:
+		using Clock = std::chrono::steady_clock;
+
+		FrameLimiter() = default;
+		~FrameLimiter() = default;
+
+		// Blocks until 1 / frameRate seconds after the
+		// previous call's deadline. A rate of 0 or less does
+		// not wait.
+		void Wait(double frameRate);
+
+	  private:
+		using Duration = std::chrono::duration<double>;
+
+		Clock::time_point m_deadline;
+		bool m_started = false;
+		// Running estimate of how late sleeps wake up.
+		double m_sleepOvershoot = 0.001;
+	};
+} // namespace AthiVegam::Core
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace AthiVegam::Core
+{
+	// Log-linear histogram in the style of HdrHistogram:
+	// values below 64 have a bucket each, larger ones 32
+	// buckets per power of two, so any value is known to
+	// within about 3%. Values saturate at 2^32 - 1.
+	// Recording is an index computation and an increment.
+	class Histogram
+	{
+	  public:
+		static constexpr uint32_t SubBucketBits = 5;
+		static constexpr uint32_t SubBucketCount =
+		    1u << SubBucketBits;
+		static constexpr uint32_t BucketCount =
+		    2 * SubBucketCount
+		    + (31 - SubBucketBits) * SubBucketCount;
+
+		// A non-empty bucket, for storing sparsely.
+		struct Bucket
+		{
+			uint32_t index = 0;
+			uint32_t count = 0;
+		};
+
+		void Record(uint64_t value);
+		void Clear();
+
+		inline uint64_t GetCount() const { return m_count; }
+		inline uint64_t GetMax() const { return m_max; }
+		// Upper bound of the bucket holding the percentile
+		// of recorded values; 0 when empty.
+		uint64_t GetPercentile(double percent) const;
+
+		std::vector<Bucket> GetBuckets() const;
+		void Add(std::span<const Bucket> buckets);
+
+		static uint32_t GetIndex(uint64_t value);
+		static uint64_t GetUpperBound(uint32_t index);
+
+	  private:
+		std::array<uint32_t, BucketCount> m_counts{};
+		uint64_t m_count = 0;
+		uint64_t m_max = 0;
+	};
+} // namespace AthiVegam::Core
@@ -1,18 +1,80 @@
 #pragma once
 
+#include "AthiVegam/Graphics/ImGuiRenderer.h"
+#include "external/imgui/imgui.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
 typedef union SDL_Event SDL_Event;
 
 namespace AthiVegam::Core
 {
+	// The ImGui overlay. Nothing here runs until Create();
+	// frames without visible UI call Skip() instead of
+	// rendering. The UI is only rebuilt after input or once
+	// the refresh interval has passed; other frames draw the
+	// previous draw data again, which the renderer still
+	// has uploaded.
 	class ImGuiWindow
 	{
 	  public:
-		void Create();
+		using Clock = std::chrono::steady_clock;
+
+		void Create(Clock::duration refreshInterval);
 		void Shutdown();
+		inline bool IsCreated() const { return m_created; }
 
 		void HandleSDLEvent(SDL_Event& e);
 
-		void BeginRender();
+		// Returns true if ImGui is recording a new frame, in
+		// which case the UI must be drawn before EndRender()
+		// or CaptureRender().
+		bool BeginRender();
 		void EndRender();
+		// No UI this frame.
+		void Skip();
+
+		// Render thread mode: the frame's draw data is cloned
+		// so the render thread can draw it while ImGui builds
+		// the next frame. SwapFrames() must only be called
+		// while the render thread is idle.
+		void CaptureRender();
+		void SwapFrames();
+		void RenderCaptured();
+
+	  private:
+		struct DrawSnapshot
+		{
+			ImDrawData data;
+			std::vector<ImDrawList*> lists;
+		};
+
+		enum class FrameState : uint8_t
+		{
+			Skipped,
+			Reused,
+			Built
+		};
+
+		void ReleaseSnapshots();
+
+	  private:
+		Graphics::ImGuiRenderer m_renderer;
+		std::array<DrawSnapshot, 2> m_snapshots;
+		uint32_t m_captureSnapshot = 0;
+		uint32_t m_renderSnapshot = 0;
+
+		bool m_created = false;
+		bool m_building = false;
+		// Frames to rebuild regardless of the interval; a
+		// widget may settle a frame after the input.
+		uint32_t m_dirtyFrames = 0;
+		Clock::duration m_refreshInterval{};
+		Clock::time_point m_lastBuild{};
+		FrameState m_captureState = FrameState::Skipped;
+		FrameState m_renderState = FrameState::Skipped;
 	};
 } // namespace AthiVegam::Core
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AthiVegam::Core
+{
+	// A JSON document read whole into a tree, for tools
+	// reading what the engine writes: profiler captures,
+	// benchmark results. Lookups on the wrong type return
+	// an empty value rather than failing, so optional
+	// fields read as their fallback.
+	class Json
+	{
+	  public:
+		enum class Type : uint8_t
+		{
+			Null,
+			Bool,
+			Number,
+			String,
+			Array,
+			Object
+		};
+
+		// False on malformed text, with the reason and
+		// byte offset in error.
+		static bool Parse(std::string_view text, Json& value,
+		                  std::string& error);
+
+		inline Type GetType() const { return m_type; }
+		inline bool IsNull() const
+		{
+			return m_type == Type::Null;
+		}
+		inline bool IsNumber() const
+		{
+			return m_type == Type::Number;
+		}
+
+		bool GetBool(bool fallback = false) const;
+		double GetNumber(double fallback = 0.0) const;
+		// Empty unless a string.
+		const std::string& GetString() const;
+
+		// Elements of an array, or values of an object,
+		// in document order; empty otherwise.
+		inline std::span<const Json> GetChildren() const
+		{
+			return m_children;
+		}
+		// Of an object's member.
+		inline const std::string& GetKey() const
+		{
+			return m_key;
+		}
+		// The member named key of an object; a null value
+		// if there is none.
+		const Json& operator[](std::string_view key) const;
+
+	  private:
+		friend class JsonParser;
+
+		Type m_type = Type::Null;
+		bool m_bool = false;
+		double m_number = 0.0;
+		std::string m_string;
+		std::string m_key;
+		std::vector<Json> m_children;
+	};
+} // namespace AthiVegam::Core
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct SDL_Window;
+
+namespace AthiVegam::Core
+{
+	// Thread with a second GL context sharing objects with
+	// the window's, so textures, buffers and shader
+	// programs can be created and filled without holding up
+	// the GL thread. A job's GL work is fenced and flushed
+	// when it returns; its done callback runs on the GL
+	// thread once the fence has signalled, so the objects
+	// it hands over are complete.
+	//
+	// Vertex arrays and framebuffers are not shared between
+	// contexts, nor is bindless residency: jobs create
+	// buffers and leave those to their done callback, or to
+	// MeshUploadQueue for meshes. See
+	// EngineConfig::loaderThread.
+	class LoaderThread
+	{
+	  public:
+		using Job = std::function<void()>;
+
+		LoaderThread() = default;
+		~LoaderThread();
+
+		LoaderThread(const LoaderThread&) = delete;
+		LoaderThread& operator=(const LoaderThread&) = delete;
+
+		// With the window's context current on the calling
+		// thread, which it stays.
+		bool Start(SDL_Window* window);
+		// Waits for the running job; jobs not yet run are
+		// dropped, and done callbacks destroyed uncalled.
+		void Stop();
+
+		// Any thread. Without a running loader thread both
+		// run on the next Update(), on the GL thread.
+		void Submit(Job job, Job done = {});
+
+		// GL thread, once per frame: runs the done callbacks
+		// of finished jobs.
+		void Update();
+
+		inline bool IsRunning() const
+		{
+			return m_thread.joinable();
+		}
+		// Submitted and not yet done.
+		size_t GetPendingCount();
+
+	  private:
+		struct Entry
+		{
+			Job job;
+			Job done;
+			// GLsync of the finished job.
+			void* fence = nullptr;
+		};
+
+		void Run();
+
+	  private:
+		SDL_Window* m_window = nullptr;
+		void* m_context = nullptr;
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::vector<Entry> m_jobs;
+		// Oldest first, so fences signal in order.
+		std::vector<Entry> m_finished;
+		size_t m_pending = 0;
+		bool m_stopRequested = false;
+	};
+} // namespace AthiVegam::Core
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace AthiVegam::Core
+{
+	// Read-only memory mapping of a whole file. Opening
+	// reads nothing; the OS pages the file in as it is
+	// touched and may drop clean pages again under memory
+	// pressure, so mapped assets cost no heap copies.
+	class MappedFile
+	{
+	  public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// Fails for missing and empty files.
+		bool Open(const std::string& path);
+		void Close();
+
+		inline bool IsOpen() const { return m_data != nullptr; }
+		inline const uint8_t* GetData() const
+		{
+			return m_data;
+		}
+		inline size_t GetSize() const { return m_size; }
+
+		// Asks the OS to start reading the range in ahead of
+		// the first touch. Only a hint.
+		void Prefetch(size_t offset, size_t size) const;
+
+	  private:
+		const uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+#ifdef AV_PLATFORM_WINDOWS
+		// The file and mapping HANDLEs.
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#endif // AV_PLATFORM_WINDOWS
+	};
+} // namespace AthiVegam::Core
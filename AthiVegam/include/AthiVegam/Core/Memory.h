@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace AthiVegam::Core
+{
+	// Tagged allocation and per-tag memory statistics. CPU
+	// memory allocated through Allocate(), New() or
+	// TaggedAllocator is counted under its tag; GPU memory
+	// is only counted, by the code creating the buffers
+	// reporting their sizes through TrackGpu().
+	namespace Memory
+	{
+		enum class Tag : uint8_t
+		{
+			General,
+			Core,
+			Render,
+			Assets,
+			Input,
+			Editor,
+			Scene,
+			Count
+		};
+
+		const char* GetTagName(Tag tag);
+
+		struct Stats
+		{
+			size_t live = 0;
+			size_t peak = 0;
+			size_t allocations = 0;
+		};
+
+		// Backs Allocate() and Free(). Implementations must
+		// be thread-safe.
+		class Allocator
+		{
+		  public:
+			virtual ~Allocator() = default;
+			virtual void* Allocate(size_t size,
+			                       size_t alignment) = 0;
+			virtual void Free(void* memory, size_t size,
+			                  size_t alignment) = 0;
+		};
+
+		// Replaces the allocator; nullptr restores the
+		// default aligned operator new. Only call while
+		// nothing allocated through the previous one is
+		// alive, i.e. before the engine initializes.
+		void SetAllocator(Allocator* allocator);
+
+		constexpr size_t DefaultAlignment =
+		    alignof(std::max_align_t);
+
+		void* Allocate(size_t size, Tag tag,
+		               size_t alignment = DefaultAlignment);
+		// size, tag and alignment must match the allocation.
+		void Free(void* memory, size_t size, Tag tag,
+		          size_t alignment = DefaultAlignment);
+
+		template <typename T, typename... Args>
+		inline T* New(Tag tag, Args&&... args)
+		{
+			return new (Allocate(sizeof(T), tag, alignof(T)))
+			    T(std::forward<Args>(args)...);
+		}
+		template <typename T>
+		inline void Delete(T* object, Tag tag)
+		{
+			if (object)
+			{
+				object->~T();
+				Free(object, sizeof(T), tag, alignof(T));
+			}
+		}
+
+		// Positive when GPU memory is created, negative
+		// when it is released.
+		void TrackGpu(Tag tag, int64_t bytes);
+		// The same for CPU memory mapped from the OS
+		// directly, e.g. by a VirtualArena.
+		void TrackCpu(Tag tag, int64_t bytes);
+
+		Stats GetStats(Tag tag);
+		Stats GetGpuStats(Tag tag);
+
+		// STL allocator counting under a fixed tag.
+		template <typename T, Tag AllocTag>
+		class TaggedAllocator
+		{
+		  public:
+			using value_type = T;
+
+			template <typename U>
+			struct rebind
+			{
+				using other = TaggedAllocator<U, AllocTag>;
+			};
+
+			TaggedAllocator() noexcept = default;
+			template <typename U>
+			TaggedAllocator(
+			    const TaggedAllocator<U, AllocTag>&) noexcept
+			{
+			}
+
+			inline T* allocate(size_t count)
+			{
+				return static_cast<T*>(Memory::Allocate(
+				    sizeof(T) * count, AllocTag, alignof(T)));
+			}
+			inline void deallocate(T* memory,
+			                       size_t count) noexcept
+			{
+				Memory::Free(memory, sizeof(T) * count,
+				             AllocTag, alignof(T));
+			}
+
+			template <typename U>
+			inline bool operator==(
+			    const TaggedAllocator<U, AllocTag>&) const
+			{
+				return true;
+			}
+		};
+
+		template <typename T, Tag AllocTag>
+		using Vector =
+		    std::vector<T, TaggedAllocator<T, AllocTag>>;
+	} // namespace Memory
+} // namespace AthiVegam::Core
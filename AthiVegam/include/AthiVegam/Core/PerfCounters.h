@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace AthiVegam::Core
+{
+	// Hardware counters of the calling thread, read
+	// through perf_event_open on Linux, for the profiler to
+	// sample per zone. Each thread opens its counters on
+	// its first Read(); they count user-mode events only,
+	// which the default perf_event_paranoid allows. Reading
+	// is a syscall, about a microsecond, so zones are only
+	// sampled while the "profile.perfCounters" CVar is on.
+	// Elsewhere, and where the kernel or the CPU refuses,
+	// Read() fails.
+	namespace PerfCounters
+	{
+		enum class Counter : uint8_t
+		{
+			Cycles,
+			Instructions,
+			// Last-level cache misses.
+			CacheMisses,
+			BranchMisses,
+			Count
+		};
+
+		using Values =
+		    std::array<uint64_t, (size_t)Counter::Count>;
+
+		const char* GetName(Counter counter);
+
+		// The CVar; any thread.
+		bool IsEnabled();
+		// The calling thread's counts so far. False if
+		// disabled or unavailable.
+		bool Read(Values& values);
+	} // namespace PerfCounters
+} // namespace AthiVegam::Core
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace AthiVegam::Core
+{
+	// ImGui overlay with frame times, the render manager's
+	// counters, the job threads' time and memory per tag.
+	// Drawn by VegamWindow while ImGui records the frame.
+	class PerformanceHud
+	{
+	  public:
+		using Clock = std::chrono::steady_clock;
+
+		PerformanceHud() = default;
+		~PerformanceHud() = default;
+
+		// Once per frame, whether or not the UI is built:
+		// records the time since the previous call.
+		void RecordFrame();
+		// Draws the panels if visible.
+		void Draw();
+
+		inline void SetVisible(bool visible)
+		{
+			m_visible = visible;
+		}
+		inline void ToggleVisible() { m_visible = !m_visible; }
+		inline bool IsVisible() const { return m_visible; }
+
+		static constexpr uint32_t HistorySize = 240;
+
+	  private:
+		void DrawFrameTimes();
+		void DrawRenderStats();
+		void DrawJobs();
+		void DrawMemory();
+
+	  private:
+		// Frame times in ms, oldest first from m_next.
+		std::array<float, HistorySize> m_frameTimes{};
+		uint32_t m_next = 0;
+		uint32_t m_count = 0;
+		Clock::time_point m_lastFrame;
+		bool m_started = false;
+		bool m_visible = true;
+		bool m_showDemoWindow = false;
+	};
+} // namespace AthiVegam::Core
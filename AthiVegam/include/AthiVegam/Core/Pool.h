@@ -0,0 +1,217 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace AthiVegam::Core
+{
+	struct PoolStats
+	{
+		// Objects alive now.
+		size_t live = 0;
+		// Slots carved out of chunks so far; the pool's
+		// high-water mark.
+		size_t capacity = 0;
+		// Create() calls over the pool's lifetime.
+		size_t allocations = 0;
+	};
+
+	// Small per-thread index used to pick a pool's cache.
+	// Threads past the cache count share a locked free list.
+	uint32_t GetThreadCacheIndex();
+
+	// Fixed-size object pool. Objects live in chunks of
+	// ChunkSize slots that are never returned to the heap
+	// before the pool dies, so pooled objects stay close
+	// together and a create or destroy is a free-list pop or
+	// push. Each thread works on its own cache of free
+	// slots and only locks to trade a batch with the shared
+	// list. Debug builds poison destroyed objects.
+	//
+	// Objects still alive when the pool is destroyed are not
+	// destructed.
+	template <typename T, size_t ChunkSize = 64>
+	class Pool
+	{
+	  public:
+		static constexpr uint32_t MaxThreadCaches = 64;
+
+		Pool() = default;
+		~Pool() = default;
+
+		Pool(const Pool&) = delete;
+		Pool& operator=(const Pool&) = delete;
+
+		template <typename... Args>
+		T* Create(Args&&... args)
+		{
+			auto* node = Pop();
+			return new (node->storage)
+			    T(std::forward<Args>(args)...);
+		}
+
+		void Destroy(T* object)
+		{
+			if (!object)
+			{
+				return;
+			}
+			object->~T();
+			auto* node = reinterpret_cast<Node*>(object);
+#ifdef AV_CONFIG_DEBUG
+			std::memset(node->storage, PoisonByte, sizeof(T));
+#endif // AV_CONFIG_DEBUG
+			Push(node);
+		}
+
+		PoolStats GetStats() const
+		{
+			PoolStats stats;
+			size_t frees = 0;
+			for (const auto& cache : m_caches)
+			{
+				stats.allocations += cache.allocations.load(
+				    std::memory_order_relaxed);
+				frees +=
+				    cache.frees.load(std::memory_order_relaxed);
+			}
+			{
+				std::lock_guard lock(m_mutex);
+				stats.allocations += m_sharedAllocations;
+				frees += m_sharedFrees;
+				stats.capacity = m_capacity;
+			}
+			stats.live = stats.allocations - frees;
+			return stats;
+		}
+
+	  private:
+		static constexpr uint8_t PoisonByte = 0xDD;
+		static constexpr uint32_t CacheBatch = 32;
+
+		union Node
+		{
+			Node* next;
+			alignas(T) std::byte storage[sizeof(T)];
+		};
+
+		// Written only by the owning thread; padded so
+		// threads do not share cache lines.
+		struct alignas(64) Cache
+		{
+			Node* head = nullptr;
+			uint32_t count = 0;
+			std::atomic<size_t> allocations{0};
+			std::atomic<size_t> frees{0};
+		};
+
+		Node* Pop()
+		{
+			const auto index = GetThreadCacheIndex();
+			if (index >= MaxThreadCaches)
+			{
+				std::lock_guard lock(m_mutex);
+				++m_sharedAllocations;
+				return PopShared();
+			}
+
+			auto& cache = m_caches[index];
+			if (!cache.head)
+			{
+				std::lock_guard lock(m_mutex);
+				for (uint32_t i = 0; i < CacheBatch; ++i)
+				{
+					auto* node = PopShared();
+					node->next = cache.head;
+					cache.head = node;
+				}
+				cache.count = CacheBatch;
+			}
+
+			auto* node = cache.head;
+			cache.head = node->next;
+			--cache.count;
+			cache.allocations.store(
+			    cache.allocations.load(
+			        std::memory_order_relaxed)
+			        + 1,
+			    std::memory_order_relaxed);
+			return node;
+		}
+
+		void Push(Node* node)
+		{
+			const auto index = GetThreadCacheIndex();
+			if (index >= MaxThreadCaches)
+			{
+				std::lock_guard lock(m_mutex);
+				++m_sharedFrees;
+				node->next = m_freeList;
+				m_freeList = node;
+				return;
+			}
+
+			auto& cache = m_caches[index];
+			node->next = cache.head;
+			cache.head = node;
+			++cache.count;
+			cache.frees.store(
+			    cache.frees.load(std::memory_order_relaxed) + 1,
+			    std::memory_order_relaxed);
+
+			// Hand a batch back so one thread freeing what
+			// others create does not hoard slots.
+			if (cache.count >= CacheBatch * 2)
+			{
+				std::lock_guard lock(m_mutex);
+				for (uint32_t i = 0; i < CacheBatch; ++i)
+				{
+					auto* freed = cache.head;
+					cache.head = freed->next;
+					freed->next = m_freeList;
+					m_freeList = freed;
+				}
+				cache.count -= CacheBatch;
+			}
+		}
+
+		// Caller holds m_mutex.
+		Node* PopShared()
+		{
+			if (!m_freeList)
+			{
+				auto chunk =
+				    std::make_unique<Node[]>(ChunkSize);
+				for (size_t i = 0; i < ChunkSize; ++i)
+				{
+					chunk[i].next = m_freeList;
+					m_freeList = &chunk[i];
+				}
+				m_chunks.push_back(std::move(chunk));
+				m_capacity += ChunkSize;
+			}
+
+			auto* node = m_freeList;
+			m_freeList = node->next;
+			return node;
+		}
+
+	  private:
+		std::array<Cache, MaxThreadCaches> m_caches;
+
+		mutable std::mutex m_mutex;
+		Node* m_freeList = nullptr;
+		std::vector<std::unique_ptr<Node[]>> m_chunks;
+		size_t m_capacity = 0;
+		size_t m_sharedAllocations = 0;
+		size_t m_sharedFrees = 0;
+	};
+} // namespace AthiVegam::Core
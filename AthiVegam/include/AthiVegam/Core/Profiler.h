@@ -0,0 +1,170 @@
+#pragma once
+
+#include "AthiVegam/Core/PerfCounters.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace AthiVegam::Core
+{
+	// Lightweight CPU instrumentation. A scope records one
+	// zone when it closes into a lock-free ring owned by the
+	// recording thread; once per frame the main thread
+	// drains every ring, keeping the last frame for the
+	// profiler panel. Zone names are not copied and must
+	// outlive the frame, so use literals.
+	//
+	// VEGAM_PROFILE_SCOPE compiles to nothing in Shipping
+	// builds.
+	namespace Profiler
+	{
+		struct Zone
+		{
+			const char* name;
+			uint64_t start;
+			uint64_t end;
+			uint32_t depth;
+			// Hardware counts within the zone, zero unless
+			// PerfCounters are enabled and available.
+			PerfCounters::Values counters{};
+		};
+
+		struct ThreadZones
+		{
+			std::string threadName;
+			std::vector<Zone> zones;
+			// Zones lost because the ring was full.
+			uint32_t dropped = 0;
+		};
+
+		// Ticks of the performance counter.
+		uint64_t Now();
+		double TicksToMs(uint64_t ticks);
+
+		// Label for the calling thread in the panel.
+		void SetThreadName(std::string name);
+
+		void Record(const char* name, uint64_t start,
+		            uint64_t end, uint32_t depth,
+		            const PerfCounters::Values& counters = {});
+
+		// Main thread, once per frame: drains the rings into
+		// GetLastFrame().
+		void EndFrame();
+		const std::vector<ThreadZones>& GetLastFrame();
+
+		// Latest resolved GPU zones on the CPU clock, from
+		// Graphics::GpuProfiler. Any thread.
+		void SetGpuZones(const std::vector<Zone>& zones);
+
+		// ImGui window with the last frame's zones.
+		void DrawPanel();
+
+		// Writes the next frameCount frames of CPU and GPU
+		// zones to a Chrome trace JSON file (chrome://tracing
+		// or Perfetto). Files are written on a background
+		// thread. Returns false if a capture is running or
+		// the file cannot be opened.
+		bool StartCapture(const std::string& path,
+		                  uint32_t frameCount);
+		bool IsCapturing();
+		// Finishes any capture in progress.
+		void Shutdown();
+
+		struct HitchSettings
+		{
+			// Where traces are written; empty disables
+			// hitch capture.
+			std::string directory;
+			// Frames of zones kept, and written, per hitch.
+			float historySeconds = 5.0f;
+			// A hitch is a frame over this multiple of the
+			// median of recent frames and over minimumMs.
+			float medianMultiple = 2.0f;
+			float minimumMs = 20.0f;
+		};
+
+		// Keeps the last historySeconds of zones and
+		// context events; when a frame hitches, writes
+		// them to a trace file in the directory, like
+		// StartCapture(). At most one trace per history
+		// window. Main thread.
+		void SetHitchCapture(const HitchSettings& settings);
+		uint32_t GetHitchCount();
+
+		struct BudgetStatus
+		{
+			std::string zone;
+			float budgetMs = 0.0f;
+			// Of the last frame and the worst frame.
+			float lastMs = 0.0f;
+			float worstMs = 0.0f;
+			// Frames over budget among the last
+			// BudgetWindow, and since the budget was set.
+			uint32_t windowViolations = 0;
+			uint64_t totalViolations = 0;
+		};
+
+		constexpr uint32_t BudgetWindow = 300;
+
+		// Every frame, the time spent in zones named zone,
+		// summed over their scopes on every thread, is
+		// checked against milliseconds. Violations are
+		// logged, at most once per window per zone, and
+		// shown in the profiler panel. 0 removes the budget.
+		void SetBudget(const std::string& zone,
+		               float milliseconds);
+		std::vector<BudgetStatus> GetBudgets();
+		// Frames over any budget, for benchmark runs to
+		// fail on.
+		uint64_t GetBudgetViolations();
+
+		// Context for hitch traces: something that may
+		// explain a slow frame, e.g. a shader compile, shown
+		// as an instant event. category must be a literal.
+		// Dropped unless hitch capture is on. Any thread.
+		bool IsRecordingEvents();
+		void AddEvent(const char* category, std::string detail);
+
+		class Scope
+		{
+		  public:
+			explicit Scope(const char* name);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		  private:
+			const char* m_name;
+			uint64_t m_start;
+			PerfCounters::Values m_counters;
+			bool m_counted;
+		};
+	} // namespace Profiler
+} // namespace AthiVegam::Core
+
+#define VEGAM_PROFILE_CONCAT_IMPL(a, b) a##b
+#define VEGAM_PROFILE_CONCAT(a, b) VEGAM_PROFILE_CONCAT_IMPL(a, b)
+
+#ifndef AV_CONFIG_SHIPPING
+#define VEGAM_PROFILE_SCOPE(name)                          \
+	::AthiVegam::Core::Profiler::Scope                     \
+	VEGAM_PROFILE_CONCAT(profileScope, __LINE__)(name)
+// Formats the detail with fmt (see Log.h) only while
+// events are recorded.
+#define VEGAM_PROFILE_EVENT(category, ...)                 \
+	do                                                     \
+	{                                                      \
+		if (::AthiVegam::Core::Profiler::                  \
+		        IsRecordingEvents())                       \
+		{                                                  \
+			::AthiVegam::Core::Profiler::AddEvent(         \
+			    category, fmt::format(__VA_ARGS__));       \
+		}                                                  \
+	} while (false)
+#else
+#define VEGAM_PROFILE_SCOPE(name)
+#define VEGAM_PROFILE_EVENT(category, ...)
+#endif // AV_CONFIG_SHIPPING
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace AthiVegam::Core
+{
+	// Executes frame N's render commands and presents it
+	// while the main thread updates and records frame N+1.
+	// Owns the window's GL context while running.
+	class RenderThread
+	{
+	  public:
+		RenderThread() = default;
+		~RenderThread();
+
+		bool Start();
+		void Stop();
+
+		// Waits for the previous frame to finish, then hands
+		// the recorded frame to the render thread.
+		void SubmitFrame();
+
+		inline bool IsRunning() const
+		{
+			return m_thread.joinable();
+		}
+
+	  private:
+		void Run();
+
+	  private:
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_framePending = false;
+		bool m_stopRequested = false;
+	};
+} // namespace AthiVegam::Core
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+namespace AthiVegam::Core
+{
+	// Fixed-capacity FIFO in one array, for queues owned by
+	// a single thread; see SpscQueue to hand items between
+	// two. Never allocates, unlike std::queue's deque.
+	template <typename T, uint32_t Capacity>
+	class RingBuffer
+	{
+		static_assert((Capacity & (Capacity - 1)) == 0,
+		              "Capacity must be a power of two");
+
+	  public:
+		// Returns false when full.
+		bool Push(T item)
+		{
+			if (Full())
+			{
+				return false;
+			}
+			m_items[m_tail++ & Mask] = std::move(item);
+			return true;
+		}
+
+		// Oldest item; the buffer must not be empty.
+		inline T& Front() { return m_items[m_head & Mask]; }
+		inline const T& Front() const
+		{
+			return m_items[m_head & Mask];
+		}
+		// Newest item; the buffer must not be empty.
+		inline T& Back()
+		{
+			return m_items[(m_tail - 1) & Mask];
+		}
+		// Items by age, 0 being the oldest.
+		inline T& operator[](uint32_t index)
+		{
+			return m_items[(m_head + index) & Mask];
+		}
+		inline const T& operator[](uint32_t index) const
+		{
+			return m_items[(m_head + index) & Mask];
+		}
+
+		// Drops the oldest item; it is overwritten by a
+		// later Push(), not destroyed.
+		inline void Pop() { ++m_head; }
+		inline void Clear() { m_head = m_tail = 0; }
+
+		inline uint32_t Size() const { return m_tail - m_head; }
+		inline bool Empty() const { return m_head == m_tail; }
+		inline bool Full() const { return Size() == Capacity; }
+
+	  private:
+		static constexpr uint32_t Mask = Capacity - 1;
+
+		// Free-running; wrap-around is harmless because
+		// Capacity divides 2^32.
+		uint32_t m_head = 0;
+		uint32_t m_tail = 0;
+		std::array<T, Capacity> m_items{};
+	};
+} // namespace AthiVegam::Core
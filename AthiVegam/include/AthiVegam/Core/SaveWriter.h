@@ -0,0 +1,92 @@
+#pragma once
+
+#include "AthiVegam/Managers/JobManager.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace AthiVegam::Core
+{
+	// Writes save games and autosaves off the main thread.
+	// The caller copies the state it saves into the
+	// serialize function, e.g. the result of
+	// Ecs::SceneSnapshot::Capture(); a job worker runs it,
+	// compresses the bytes with LZ4, and writes them next
+	// to the file before renaming over it, so a crash
+	// mid-write leaves the previous save whole. The main
+	// thread only pays for the copy.
+	//
+	// Writes run one at a time, in order. A write queued
+	// for a path that already has one waiting replaces it,
+	// so a slow disk drops stale autosaves instead of
+	// falling behind. Main thread.
+	class SaveWriter
+	{
+	  public:
+		// Fills data with the file's contents; runs on a
+		// worker, so must not touch live state.
+		using Serialize =
+		    std::function<void(std::vector<uint8_t>& data)>;
+
+		struct Stats
+		{
+			// Of the last write.
+			size_t bytes = 0;
+			size_t storedBytes = 0;
+			double serializeMs = 0.0;
+			double compressMs = 0.0;
+			double writeMs = 0.0;
+			// Since the start.
+			uint32_t writes = 0;
+			uint32_t failures = 0;
+		};
+
+		SaveWriter() = default;
+		// Finishes the writes queued.
+		~SaveWriter();
+
+		SaveWriter(const SaveWriter&) = delete;
+		SaveWriter& operator=(const SaveWriter&) = delete;
+
+		void Write(const std::string& path,
+		           Serialize serialize);
+		// Blocks until every queued write is on disk, e.g.
+		// before quitting.
+		void Wait();
+		bool IsWriting() const;
+		Stats GetStats() const;
+
+		// Reads a file Write() wrote into data, as it was
+		// serialized. False if it is missing or malformed.
+		static bool Read(const std::string& path,
+		                 std::vector<uint8_t>& data);
+
+	  private:
+		struct Pending
+		{
+			std::string path;
+			Serialize serialize;
+		};
+
+		// On a worker, until the queue is empty.
+		void Drain();
+		bool WriteFile(const Pending& pending,
+		               Stats& stats);
+
+	  private:
+		Managers::JobCounter m_jobs;
+		mutable std::mutex m_mutex;
+		std::deque<Pending> m_pending;
+		// A worker is draining the queue.
+		bool m_writing = false;
+		Stats m_stats;
+		// Reused by the worker from write to write.
+		std::vector<uint8_t> m_data;
+		std::vector<uint8_t> m_compressed;
+	};
+} // namespace AthiVegam::Core
@@ -0,0 +1,558 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Lists a struct's serialized members, inside the struct:
+//
+//   struct Spawn
+//   {
+//       Math::Vec3 position;
+//       std::string prefab;
+//       VEGAM_SERIAL_FIELDS(&Spawn::position, &Spawn::prefab)
+//   };
+//
+// A field is identified by its place in the list: new
+// fields go at the end, and fields are never removed,
+// reordered or changed in type. Data written before a
+// field existed reads it as the default.
+#define VEGAM_SERIAL_FIELDS(...)                            \
+	static constexpr auto GetSerialFields()                 \
+	{                                                       \
+		return std::tuple{__VA_ARGS__};                     \
+	}
+
+namespace AthiVegam::Core::Serial
+{
+	// Versioned little-endian binary format, read in place
+	// from memory or a Core::MappedFile:
+	//
+	//   Header
+	//   root table
+	//
+	// A table is a struct with VEGAM_SERIAL_FIELDS: a field
+	// count, then each field's offset from the table,
+	// followed by the fields. Fields are tables, trivially
+	// copyable values stored as they are in memory, strings
+	// (length, bytes, terminator) and std::vectors: a count
+	// and the elements for trivially copyable ones,
+	// otherwise a count and an offset per element from the
+	// array.
+	constexpr uint32_t Magic = 0x42535641; // "AVSB"
+	constexpr uint16_t FormatVersion = 1;
+	// Of the buffer start and of any stored value.
+	constexpr size_t MaxAlignment = 16;
+
+	struct Header
+	{
+		uint32_t magic;
+		uint16_t formatVersion;
+		uint16_t reserved;
+		// Chosen by the caller of Save().
+		uint32_t schemaVersion;
+		uint32_t rootOffset;
+		uint64_t size;
+	};
+
+	static_assert(sizeof(Header) == 24);
+	static_assert(std::endian::native == std::endian::little,
+	              "Serial data is read in place");
+
+	template <typename T>
+	concept Reflected = requires { T::GetSerialFields(); };
+
+	template <typename T>
+	inline constexpr bool IsVector = false;
+	template <typename E, typename A>
+	inline constexpr bool IsVector<std::vector<E, A>> = true;
+
+	template <typename T>
+	concept Value = std::is_trivially_copyable_v<T>
+	                && !Reflected<T> && !std::is_pointer_v<T>;
+
+	template <typename T>
+	class View;
+	template <typename T>
+	class ArrayView;
+
+	// What reading a T in place gives: values by copy,
+	// std::string_view for strings, std::span for vectors
+	// of values, and views for tables and other vectors.
+	template <typename T>
+	struct ViewOf
+	{
+		using Type = T;
+	};
+	template <>
+	struct ViewOf<std::string>
+	{
+		using Type = std::string_view;
+	};
+	template <typename E, typename A>
+	struct ViewOf<std::vector<E, A>>
+	{
+		using Type = std::conditional_t<Value<E>,
+		                                std::span<const E>,
+		                                ArrayView<E>>;
+	};
+	template <Reflected T>
+	struct ViewOf<T>
+	{
+		using Type = View<T>;
+	};
+	template <typename T>
+	using ViewType = typename ViewOf<T>::Type;
+
+	namespace Detail
+	{
+		// Appends to a growing buffer; offsets are from its
+		// start, so alignment holds once it is stored at a
+		// MaxAlignment boundary.
+		class Writer
+		{
+		  public:
+			explicit Writer(std::vector<uint8_t>& buffer)
+			    : m_buffer(buffer)
+			{
+			}
+
+			inline size_t GetSize() const
+			{
+				return m_buffer.size();
+			}
+			void Align(size_t alignment);
+			// Zero-filled; returns the offset.
+			size_t Reserve(size_t size);
+			size_t Append(const void* data, size_t size);
+			void WriteAt(size_t offset, uint32_t value);
+
+		  private:
+			std::vector<uint8_t>& m_buffer;
+		};
+
+		inline uint32_t ReadU32(const uint8_t* data, size_t size,
+		                        size_t offset)
+		{
+			uint32_t value = 0;
+			if (offset <= size && size - offset >= 4)
+			{
+				std::memcpy(&value, data + offset, 4);
+			}
+			return value;
+		}
+
+		template <typename T, auto Member>
+		consteval size_t FindField()
+		{
+			constexpr auto fields = T::GetSerialFields();
+			size_t index = 0;
+			size_t found = SIZE_MAX;
+			std::apply(
+			    [&](auto... members) {
+				    (
+				        [&](auto member) {
+					        if constexpr (std::is_same_v<
+					                          decltype(member),
+					                          decltype(Member)>)
+					        {
+						        if (member == Member)
+						        {
+							        found = index;
+						        }
+					        }
+					        ++index;
+				        }(members),
+				        ...);
+			    },
+			    fields);
+			return found;
+		}
+
+		template <typename T>
+		size_t WriteValue(Writer& writer, const T& value);
+
+		template <Reflected T>
+		size_t WriteTable(Writer& writer, const T& value)
+		{
+			constexpr auto fields = T::GetSerialFields();
+			constexpr auto count =
+			    std::tuple_size_v<decltype(fields)>;
+			writer.Align(4);
+			const auto table = writer.Reserve(4 + 4 * count);
+			writer.WriteAt(table, static_cast<uint32_t>(count));
+			uint32_t index = 0;
+			std::apply(
+			    [&](auto... members) {
+				    ((writer.WriteAt(
+				          table + 4 + 4 * index++,
+				          static_cast<uint32_t>(
+				              WriteValue(writer, value.*members)
+				              - table))),
+				     ...);
+			    },
+			    fields);
+			return table;
+		}
+
+		template <typename T>
+		size_t WriteValue(Writer& writer, const T& value)
+		{
+			if constexpr (Reflected<T>)
+			{
+				return WriteTable(writer, value);
+			}
+			else if constexpr (std::is_same_v<T, std::string>)
+			{
+				writer.Align(4);
+				const auto length =
+				    static_cast<uint32_t>(value.size());
+				const auto offset = writer.Append(&length, 4);
+				writer.Append(value.data(), value.size());
+				writer.Append("", 1);
+				return offset;
+			}
+			else if constexpr (IsVector<T>)
+			{
+				using E = typename T::value_type;
+				const auto count =
+				    static_cast<uint32_t>(value.size());
+				writer.Align(4);
+				const auto offset = writer.Append(&count, 4);
+				if constexpr (Value<E>)
+				{
+					static_assert(alignof(E) <= MaxAlignment);
+					writer.Align(alignof(E));
+					writer.Append(value.data(),
+					              value.size() * sizeof(E));
+				}
+				else
+				{
+					const auto offsets =
+					    writer.Reserve(4 * value.size());
+					for (uint32_t i = 0; i < count; ++i)
+					{
+						writer.WriteAt(
+						    offsets + 4 * i,
+						    static_cast<uint32_t>(
+						        WriteValue(writer, value[i])
+						        - offset));
+					}
+				}
+				return offset;
+			}
+			else
+			{
+				static_assert(Value<T>,
+				              "Serialized types must be trivially "
+				              "copyable, strings, vectors or "
+				              "have VEGAM_SERIAL_FIELDS");
+				static_assert(alignof(T) <= MaxAlignment);
+				writer.Align(alignof(T));
+				return writer.Append(&value, sizeof(T));
+			}
+		}
+
+		// The T at offset, or its default if out of bounds.
+		template <typename T>
+		ViewType<T> ReadValue(const uint8_t* data, size_t size,
+		                      size_t offset)
+		{
+			if constexpr (Reflected<T>)
+			{
+				return View<T>(data, size, offset);
+			}
+			else if constexpr (std::is_same_v<T, std::string>)
+			{
+				const auto length = ReadU32(data, size, offset);
+				if (offset > size
+				    || size - offset < 5 + size_t{length})
+				{
+					return {};
+				}
+				return {reinterpret_cast<const char*>(data)
+				            + offset + 4,
+				        length};
+			}
+			else if constexpr (IsVector<T>)
+			{
+				using E = typename T::value_type;
+				const auto count = ReadU32(data, size, offset);
+				if constexpr (Value<E>)
+				{
+					const auto start = (offset + 4 + alignof(E) - 1)
+					                   & ~(alignof(E) - 1);
+					if (offset > size || start > size
+					    || (size - start) / sizeof(E) < count)
+					{
+						return {};
+					}
+					return {reinterpret_cast<const E*>(data
+					                                   + start),
+					        count};
+				}
+				else
+				{
+					if (offset > size || size - offset < 4
+					    || (size - offset - 4) / 4 < count)
+					{
+						return {};
+					}
+					return ArrayView<E>(data, size, offset,
+					                    count);
+				}
+			}
+			else
+			{
+				T value{};
+				if (offset <= size && size - offset >= sizeof(T))
+				{
+					std::memcpy(&value, data + offset, sizeof(T));
+				}
+				return value;
+			}
+		}
+
+		// budget bounds the elements allocated, so corrupt
+		// offsets aliasing one array cannot multiply it.
+		template <typename T>
+		void LoadValue(const ViewType<T>& view, T& value,
+		               size_t& budget);
+		template <Reflected T>
+		void LoadTable(const View<T>& view, T& value,
+		               size_t& budget);
+	} // namespace Detail
+
+	// A table read in place. Get() checks every offset
+	// against the buffer, so truncated or corrupt data gives
+	// defaults rather than reading out of bounds. Views
+	// point into the buffer and do not own it.
+	template <typename T>
+	class View
+	{
+	  public:
+		View() = default;
+		View(const uint8_t* data, size_t size, size_t offset)
+		    : m_data(data), m_size(size), m_offset(offset)
+		{
+		}
+
+		inline bool IsEmpty() const { return m_data == nullptr; }
+		inline size_t GetBufferSize() const { return m_size; }
+
+		// view.Get<&Spawn::prefab>()
+		template <auto Member>
+		auto Get() const
+		{
+			constexpr auto index = Detail::FindField<T, Member>();
+			static_assert(index != SIZE_MAX,
+			              "Not in VEGAM_SERIAL_FIELDS");
+			return GetField<index>();
+		}
+
+		// False for fields added after the data was written.
+		template <size_t Index>
+		bool HasField() const
+		{
+			return GetOffset(Index) != 0;
+		}
+
+		template <size_t Index>
+		auto GetField() const
+		{
+			constexpr auto member =
+			    std::get<Index>(T::GetSerialFields());
+			using M = std::remove_cvref_t<
+			    decltype(std::declval<T&>().*member)>;
+			const auto relative = GetOffset(Index);
+			if (relative == 0)
+			{
+				if constexpr (Value<M>)
+				{
+					static const T defaults{};
+					return defaults.*member;
+				}
+				else
+				{
+					return ViewType<M>{};
+				}
+			}
+			return Detail::ReadValue<M>(m_data, m_size,
+			                            m_offset + relative);
+		}
+
+	  private:
+		inline uint32_t GetOffset(size_t index) const
+		{
+			const auto count =
+			    Detail::ReadU32(m_data, m_size, m_offset);
+			return index < count
+			           ? Detail::ReadU32(m_data, m_size,
+			                             m_offset + 4 + 4 * index)
+			           : 0;
+		}
+
+	  private:
+		const uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+		size_t m_offset = 0;
+	};
+
+	// A vector of tables, strings or vectors, read in place.
+	template <typename T>
+	class ArrayView
+	{
+	  public:
+		ArrayView() = default;
+		ArrayView(const uint8_t* data, size_t size,
+		          size_t offset, uint32_t count)
+		    : m_data(data), m_size(size), m_offset(offset),
+		      m_count(count)
+		{
+		}
+
+		inline size_t size() const { return m_count; }
+		inline bool empty() const { return m_count == 0; }
+		ViewType<T> operator[](size_t index) const
+		{
+			const auto relative = Detail::ReadU32(
+			    m_data, m_size, m_offset + 4 + 4 * index);
+			return Detail::ReadValue<T>(m_data, m_size,
+			                            m_offset + relative);
+		}
+
+	  private:
+		const uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+		size_t m_offset = 0;
+		uint32_t m_count = 0;
+	};
+
+	// Replaces buffer's contents with root, reusing its
+	// capacity. schemaVersion is stored for the reader to
+	// check, e.g. to migrate old saves.
+	template <Reflected T>
+	void Save(const T& root, std::vector<uint8_t>& buffer,
+	          uint32_t schemaVersion = 0)
+	{
+		buffer.clear();
+		Detail::Writer writer(buffer);
+		writer.Reserve(sizeof(Header));
+		const auto rootOffset = Detail::WriteTable(writer, root);
+		const Header header{Magic, FormatVersion, 0,
+		                    schemaVersion,
+		                    static_cast<uint32_t>(rootOffset),
+		                    buffer.size()};
+		std::memcpy(buffer.data(), &header, sizeof(header));
+	}
+
+	// Checks the header; false, with an error logged, for
+	// anything but this format. data must stay valid and be
+	// MaxAlignment aligned, as mappings and heap blocks are.
+	bool OpenHeader(const uint8_t* data, size_t size,
+	                Header& header);
+
+	template <Reflected T>
+	bool Open(const uint8_t* data, size_t size, View<T>& root,
+	          uint32_t* schemaVersion = nullptr)
+	{
+		Header header;
+		if (!OpenHeader(data, size, header))
+		{
+			return false;
+		}
+		if (schemaVersion != nullptr)
+		{
+			*schemaVersion = header.schemaVersion;
+		}
+		root = View<T>(data, header.size, header.rootOffset);
+		return true;
+	}
+
+	// Copies a view into value. Fields missing from the
+	// data keep value's contents.
+	template <Reflected T>
+	void Load(const View<T>& view, T& value)
+	{
+		auto budget = view.GetBufferSize();
+		Detail::LoadTable(view, value, budget);
+	}
+
+	namespace Detail
+	{
+		template <Reflected T>
+		void LoadTable(const View<T>& view, T& value,
+		               size_t& budget)
+		{
+			constexpr auto fields = T::GetSerialFields();
+			[&]<size_t... I>(std::index_sequence<I...>) {
+				((view.template HasField<I>()
+				      ? LoadValue(view.template GetField<I>(),
+				                  value.*std::get<I>(fields),
+				                  budget)
+				      : void()),
+				 ...);
+			}(std::make_index_sequence<
+			    std::tuple_size_v<decltype(fields)>>{});
+		}
+
+		template <typename T>
+		void LoadValue(const ViewType<T>& view, T& value,
+		               size_t& budget)
+		{
+			if constexpr (Reflected<T>)
+			{
+				LoadTable(view, value, budget);
+			}
+			else if constexpr (Value<T>)
+			{
+				value = view;
+			}
+			else if (view.size() > budget)
+			{
+				value = {};
+				budget = 0;
+			}
+			else if constexpr (std::is_same_v<T, std::string>)
+			{
+				budget -= view.size();
+				value.assign(view);
+			}
+			else if constexpr (Value<typename T::value_type>)
+			{
+				budget -= view.size();
+				value.assign(view.begin(), view.end());
+			}
+			else
+			{
+				budget -= view.size();
+				value.resize(view.size());
+				for (size_t i = 0; i < view.size(); ++i)
+				{
+					LoadValue(view[i], value[i], budget);
+				}
+			}
+		}
+	} // namespace Detail
+
+	template <Reflected T>
+	bool Load(const uint8_t* data, size_t size, T& value,
+	          uint32_t* schemaVersion = nullptr)
+	{
+		View<T> root;
+		if (!Open(data, size, root, schemaVersion))
+		{
+			return false;
+		}
+		Load(root, value);
+		return true;
+	}
+} // namespace AthiVegam::Core::Serial
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace AthiVegam::Core
+{
+	// Index plus generation. A handle whose object was
+	// removed stops resolving instead of aliasing the next
+	// object in its slot.
+	struct SlotHandle
+	{
+		uint32_t index = UINT32_MAX;
+		uint32_t generation = 0;
+
+		inline bool IsValid() const
+		{
+			return index != UINT32_MAX;
+		}
+		inline bool operator==(const SlotHandle&) const =
+		    default;
+	};
+
+	// Objects kept packed in one array, found by stable
+	// handles. Removing moves the last object into the
+	// hole, so iterating touches only live objects,
+	// back to back. Lookups go through one indirection
+	// table; use Graphics::ResourcePool instead where
+	// objects must not move.
+	template <typename T,
+	          typename Allocator = std::allocator<T>>
+	class SlotMap
+	{
+	  public:
+		template <typename... Args>
+		SlotHandle Insert(Args&&... args)
+		{
+			uint32_t index;
+			if (m_freeHead != UINT32_MAX)
+			{
+				index = m_freeHead;
+				m_freeHead = m_slots[index].target;
+			}
+			else
+			{
+				index = static_cast<uint32_t>(m_slots.size());
+				m_slots.push_back({});
+			}
+			auto& slot = m_slots[index];
+			slot.target = static_cast<uint32_t>(m_values.size());
+			m_values.emplace_back(std::forward<Args>(args)...);
+			m_owners.push_back(index);
+			return {index, slot.generation};
+		}
+
+		// Null if the handle is stale. Valid until the next
+		// insert or remove.
+		T* Get(SlotHandle handle)
+		{
+			if (!Contains(handle))
+			{
+				return nullptr;
+			}
+			return &m_values[m_slots[handle.index].target];
+		}
+		const T* Get(SlotHandle handle) const
+		{
+			return const_cast<SlotMap*>(this)->Get(handle);
+		}
+		inline bool Contains(SlotHandle handle) const
+		{
+			return handle.index < m_slots.size()
+			       && m_slots[handle.index].generation
+			              == handle.generation;
+		}
+
+		// False if the handle is stale.
+		bool Remove(SlotHandle handle)
+		{
+			if (!Contains(handle))
+			{
+				return false;
+			}
+			auto& slot = m_slots[handle.index];
+			const auto target = slot.target;
+			const auto last =
+			    static_cast<uint32_t>(m_values.size() - 1);
+			if (target != last)
+			{
+				m_values[target] = std::move(m_values[last]);
+				m_owners[target] = m_owners[last];
+				m_slots[m_owners[target]].target = target;
+			}
+			m_values.pop_back();
+			m_owners.pop_back();
+
+			++slot.generation;
+			slot.target = m_freeHead;
+			m_freeHead = handle.index;
+			return true;
+		}
+
+		void Clear()
+		{
+			for (uint32_t i = 0; i < m_owners.size(); ++i)
+			{
+				auto& slot = m_slots[m_owners[i]];
+				++slot.generation;
+				slot.target = m_freeHead;
+				m_freeHead = m_owners[i];
+			}
+			m_values.clear();
+			m_owners.clear();
+		}
+		void Reserve(size_t count)
+		{
+			m_values.reserve(count);
+			m_owners.reserve(count);
+			m_slots.reserve(count);
+		}
+
+		inline size_t Size() const { return m_values.size(); }
+		inline bool Empty() const { return m_values.empty(); }
+
+		// Live objects, packed, in no particular order.
+		inline T* begin() { return m_values.data(); }
+		inline T* end()
+		{
+			return m_values.data() + m_values.size();
+		}
+		inline const T* begin() const
+		{
+			return m_values.data();
+		}
+		inline const T* end() const
+		{
+			return m_values.data() + m_values.size();
+		}
+		// Handle of the object at a position in the packed
+		// array, e.g. while iterating.
+		inline SlotHandle GetHandle(size_t position) const
+		{
+			const auto index = m_owners[position];
+			return {index, m_slots[index].generation};
+		}
+
+	  private:
+		struct Slot
+		{
+			// Position in m_values while live, next free
+			// slot once removed.
+			uint32_t target = UINT32_MAX;
+			uint32_t generation = 0;
+		};
+
+		template <typename U>
+		using Rebind = typename std::allocator_traits<
+		    Allocator>::template rebind_alloc<U>;
+
+		std::vector<T, Allocator> m_values;
+		// Slot of each value.
+		std::vector<uint32_t, Rebind<uint32_t>> m_owners;
+		std::vector<Slot, Rebind<Slot>> m_slots;
+		uint32_t m_freeHead = UINT32_MAX;
+	};
+} // namespace AthiVegam::Core
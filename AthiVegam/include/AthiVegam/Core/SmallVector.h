@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace AthiVegam::Core
+{
+	// Vector keeping its first N elements inline, so short
+	// lists live inside their owner and cost no
+	// allocation. Past N it moves to the heap like
+	// std::vector and stays there. Growing or moving the
+	// vector invalidates pointers to its elements.
+	template <typename T, size_t N,
+	          typename Allocator = std::allocator<T>>
+	class SmallVector
+	{
+		static_assert(N > 0, "Use std::vector for N == 0");
+
+	  public:
+		using value_type = T;
+		using iterator = T*;
+		using const_iterator = const T*;
+
+		SmallVector() = default;
+		explicit SmallVector(const Allocator& allocator)
+		    : m_allocator(allocator)
+		{
+		}
+		SmallVector(std::initializer_list<T> items)
+		{
+			reserve(items.size());
+			for (const auto& item : items)
+			{
+				push_back(item);
+			}
+		}
+		~SmallVector()
+		{
+			clear();
+			Deallocate();
+		}
+
+		SmallVector(const SmallVector& other)
+		    : m_allocator(other.m_allocator)
+		{
+			reserve(other.m_size);
+			std::uninitialized_copy(other.begin(), other.end(),
+			                        m_data);
+			m_size = other.m_size;
+		}
+		SmallVector(SmallVector&& other) noexcept
+		    : m_allocator(std::move(other.m_allocator))
+		{
+			MoveFrom(other);
+		}
+		SmallVector& operator=(const SmallVector& other)
+		{
+			if (this != &other)
+			{
+				clear();
+				reserve(other.m_size);
+				std::uninitialized_copy(other.begin(),
+				                        other.end(), m_data);
+				m_size = other.m_size;
+			}
+			return *this;
+		}
+		SmallVector& operator=(SmallVector&& other) noexcept
+		{
+			if (this != &other)
+			{
+				clear();
+				Deallocate();
+				MoveFrom(other);
+			}
+			return *this;
+		}
+
+		inline T* data() { return m_data; }
+		inline const T* data() const { return m_data; }
+		inline size_t size() const { return m_size; }
+		inline size_t capacity() const { return m_capacity; }
+		inline bool empty() const { return m_size == 0; }
+		// True while the elements are in the inline buffer.
+		inline bool IsInline() const
+		{
+			return m_data == GetInline();
+		}
+
+		inline T* begin() { return m_data; }
+		inline T* end() { return m_data + m_size; }
+		inline const T* begin() const { return m_data; }
+		inline const T* end() const { return m_data + m_size; }
+
+		inline T& operator[](size_t index)
+		{
+			return m_data[index];
+		}
+		inline const T& operator[](size_t index) const
+		{
+			return m_data[index];
+		}
+		inline T& front() { return m_data[0]; }
+		inline T& back() { return m_data[m_size - 1]; }
+		inline const T& back() const
+		{
+			return m_data[m_size - 1];
+		}
+
+		template <typename... Args>
+		T& emplace_back(Args&&... args)
+		{
+			if (m_size == m_capacity)
+			{
+				// Build first: args may refer to an element.
+				T item(std::forward<Args>(args)...);
+				Grow(m_capacity * 2);
+				return *new (m_data + m_size++)
+				    T(std::move(item));
+			}
+			return *new (m_data + m_size++)
+			    T(std::forward<Args>(args)...);
+		}
+		inline void push_back(const T& item)
+		{
+			emplace_back(item);
+		}
+		inline void push_back(T&& item)
+		{
+			emplace_back(std::move(item));
+		}
+		inline void pop_back() { m_data[--m_size].~T(); }
+
+		// Removes the element at it by moving the last one
+		// into its place; order is not kept.
+		void SwapErase(T* it)
+		{
+			if (it != &back())
+			{
+				*it = std::move(back());
+			}
+			pop_back();
+		}
+		T* erase(T* it)
+		{
+			std::move(it + 1, end(), it);
+			pop_back();
+			return it;
+		}
+
+		void reserve(size_t capacity)
+		{
+			if (capacity > m_capacity)
+			{
+				Grow(capacity);
+			}
+		}
+		void resize(size_t size)
+		{
+			reserve(size);
+			while (m_size < size)
+			{
+				new (m_data + m_size++) T();
+			}
+			while (m_size > size)
+			{
+				pop_back();
+			}
+		}
+		void clear()
+		{
+			std::destroy(begin(), end());
+			m_size = 0;
+		}
+
+	  private:
+		using Traits = std::allocator_traits<Allocator>;
+
+		inline T* GetInline()
+		{
+			return std::launder(
+			    reinterpret_cast<T*>(m_inline));
+		}
+		inline const T* GetInline() const
+		{
+			return std::launder(
+			    reinterpret_cast<const T*>(m_inline));
+		}
+
+		void Grow(size_t capacity)
+		{
+			auto* data = Traits::allocate(m_allocator, capacity);
+			std::uninitialized_move(begin(), end(), data);
+			std::destroy(begin(), end());
+			Deallocate();
+			m_data = data;
+			m_capacity = capacity;
+		}
+
+		void Deallocate()
+		{
+			if (!IsInline())
+			{
+				Traits::deallocate(m_allocator, m_data,
+				                   m_capacity);
+				m_data = GetInline();
+				m_capacity = N;
+			}
+		}
+
+		// Steals other's heap block, or moves its inline
+		// elements one by one.
+		void MoveFrom(SmallVector& other)
+		{
+			if (other.IsInline())
+			{
+				std::uninitialized_move(other.begin(),
+				                        other.end(), m_data);
+				m_size = other.m_size;
+				other.clear();
+				return;
+			}
+			m_data = other.m_data;
+			m_size = other.m_size;
+			m_capacity = other.m_capacity;
+			other.m_data = other.GetInline();
+			other.m_size = 0;
+			other.m_capacity = N;
+		}
+
+	  private:
+		T* m_data = GetInline();
+		size_t m_size = 0;
+		size_t m_capacity = N;
+		[[no_unique_address]] Allocator m_allocator;
+		alignas(T) std::byte m_inline[sizeof(T) * N];
+	};
+} // namespace AthiVegam::Core
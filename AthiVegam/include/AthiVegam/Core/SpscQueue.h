@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace AthiVegam::Core
+{
+	// Fixed-capacity single-producer, single-consumer
+	// ring. Each side owns one index and only reads the
+	// other's, so neither push nor pop takes a lock.
+	template <typename T, uint32_t Capacity>
+	class SpscQueue
+	{
+		static_assert((Capacity & (Capacity - 1)) == 0,
+		              "Capacity must be a power of two");
+
+	  public:
+		// Producer only. Returns false when full.
+		bool Push(const T& item)
+		{
+			const auto tail =
+			    m_tail.load(std::memory_order_relaxed);
+			if (tail - m_head.load(std::memory_order_acquire)
+			    >= Capacity)
+			{
+				return false;
+			}
+
+			m_items[tail & Mask] = item;
+			m_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer only. The oldest item, or null when
+		// empty; valid until the next Pop().
+		const T* Front() const
+		{
+			const auto head =
+			    m_head.load(std::memory_order_relaxed);
+			if (head == m_tail.load(std::memory_order_acquire))
+			{
+				return nullptr;
+			}
+			return &m_items[head & Mask];
+		}
+
+		// Consumer only, after a successful Front().
+		void Pop()
+		{
+			m_head.store(
+			    m_head.load(std::memory_order_relaxed) + 1,
+			    std::memory_order_release);
+		}
+
+	  private:
+		static constexpr uint32_t Mask = Capacity - 1;
+
+		alignas(64) std::atomic<uint32_t> m_head{0};
+		alignas(64) std::atomic<uint32_t> m_tail{0};
+		std::array<T, Capacity> m_items{};
+	};
+} // namespace AthiVegam::Core
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+
+namespace AthiVegam::Core
+{
+	// Wall time of each startup phase, measured from
+	// process start, logged once the first frame is done.
+	// Phases run as jobs may overlap others; each reports
+	// when it started, so the overlap shows.
+	class StartupTimer
+	{
+	  public:
+		using Clock = std::chrono::steady_clock;
+
+		// Times a phase until Next() or destruction. Any
+		// thread. Names must be string literals.
+		class Scope
+		{
+		  public:
+			explicit Scope(const char* name);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+			// Ends this phase and starts the next one.
+			void Next(const char* name);
+
+		  private:
+			const char* m_name;
+			Clock::time_point m_start;
+		};
+
+		// Logs every phase and the time to the first frame.
+		// Only the first call reports.
+		static void Report();
+	};
+} // namespace AthiVegam::Core
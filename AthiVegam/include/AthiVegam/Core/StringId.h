@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace AthiVegam::Core
+{
+	// 64-bit FNV-1a hash of a name, for keys that are
+	// compared and hashed as integers. "color"_sid hashes at
+	// compile time; Intern() hashes at run time and keeps
+	// the string so GetString() can name the id in logs and
+	// tools.
+	enum class StringId : uint64_t
+	{
+	};
+
+	constexpr StringId MakeStringId(std::string_view name)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (auto c : name)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 1099511628211ull;
+		}
+		return StringId{hash};
+	}
+
+	// Thread-safe. Logs an error if two interned strings
+	// share an id.
+	StringId Intern(std::string_view name);
+	// Empty for ids never interned, e.g. literals only
+	// used as "name"_sid.
+	std::string_view GetString(StringId id);
+
+	// Ids are already well mixed.
+	struct StringIdHash
+	{
+		inline size_t operator()(StringId id) const
+		{
+			return static_cast<size_t>(id);
+		}
+	};
+
+	namespace Literals
+	{
+		consteval StringId operator""_sid(const char* name,
+		                                  size_t size)
+		{
+			return MakeStringId({name, size});
+		}
+	} // namespace Literals
+} // namespace AthiVegam::Core
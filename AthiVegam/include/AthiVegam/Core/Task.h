@@ -0,0 +1,276 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace AthiVegam::Managers
+{
+	class JobManager;
+}
+
+namespace AthiVegam::Core
+{
+	template <typename T>
+	class Task;
+
+	namespace Coroutines
+	{
+		namespace Detail
+		{
+			// Detached tasks, destroyed if still suspended at
+			// shutdown.
+			void AddRoot(std::coroutine_handle<> handle);
+			void RemoveRoot(std::coroutine_handle<> handle);
+
+			template <typename Promise>
+			struct FinalAwaiter
+			{
+				inline bool await_ready() const noexcept
+				{
+					return false;
+				}
+				std::coroutine_handle<> await_suspend(
+				    std::coroutine_handle<Promise> handle) noexcept
+				{
+					auto& promise = handle.promise();
+					if (promise.detached)
+					{
+						RemoveRoot(handle);
+						handle.destroy();
+						return std::noop_coroutine();
+					}
+					if (promise.continuation)
+					{
+						return promise.continuation;
+					}
+					return std::noop_coroutine();
+				}
+				inline void await_resume() const noexcept {}
+			};
+
+			struct PromiseBase
+			{
+				std::coroutine_handle<> continuation;
+				std::exception_ptr exception;
+				bool detached = false;
+
+				inline std::suspend_always initial_suspend()
+				{
+					return {};
+				}
+				inline void unhandled_exception()
+				{
+					if (detached)
+					{
+						// Nobody is left to rethrow it to.
+						std::terminate();
+					}
+					exception = std::current_exception();
+				}
+			};
+
+			template <typename T>
+			struct Promise : PromiseBase
+			{
+				std::optional<T> value;
+
+				Task<T> get_return_object();
+				inline FinalAwaiter<Promise> final_suspend()
+				    noexcept
+				{
+					return {};
+				}
+				template <typename U>
+				inline void return_value(U&& result)
+				{
+					value.emplace(std::forward<U>(result));
+				}
+			};
+
+			template <>
+			struct Promise<void> : PromiseBase
+			{
+				Task<void> get_return_object();
+				inline FinalAwaiter<Promise> final_suspend()
+				    noexcept
+				{
+					return {};
+				}
+				inline void return_void() {}
+			};
+		} // namespace Detail
+	} // namespace Coroutines
+
+	// Coroutine doing work that spans frames, threads or
+	// GPU work without callbacks:
+	//
+	//   Core::Task<> FadeIn(Assets::AssetId id)
+	//   {
+	//       auto mesh = co_await assets.LoadMesh(id, 1.0f);
+	//       for (int i = 0; i < 30; ++i)
+	//       {
+	//           SetAlpha(mesh, i / 30.0f);
+	//           co_await Core::Coroutines::NextFrame();
+	//       }
+	//   }
+	//   Core::Coroutines::Spawn(FadeIn(id));
+	//
+	// Tasks start when awaited, or when spawned, and
+	// resume their awaiter as they finish. Awaiting one
+	// rethrows what it threw.
+	template <typename T = void>
+	class [[nodiscard]] Task
+	{
+	  public:
+		using promise_type = Coroutines::Detail::Promise<T>;
+		using Handle = std::coroutine_handle<promise_type>;
+
+		Task() = default;
+		explicit Task(Handle handle) : m_handle(handle) {}
+		~Task()
+		{
+			if (m_handle)
+			{
+				m_handle.destroy();
+			}
+		}
+
+		Task(Task&& other) noexcept
+		    : m_handle(std::exchange(other.m_handle, {}))
+		{
+		}
+		Task& operator=(Task&& other) noexcept
+		{
+			if (this != &other)
+			{
+				if (m_handle)
+				{
+					m_handle.destroy();
+				}
+				m_handle = std::exchange(other.m_handle, {});
+			}
+			return *this;
+		}
+
+		inline bool IsDone() const
+		{
+			return !m_handle || m_handle.done();
+		}
+		// Gives up ownership of the coroutine.
+		inline Handle Release()
+		{
+			return std::exchange(m_handle, {});
+		}
+
+		inline bool await_ready() const { return IsDone(); }
+		std::coroutine_handle<> await_suspend(
+		    std::coroutine_handle<> awaiter)
+		{
+			m_handle.promise().continuation = awaiter;
+			return m_handle;
+		}
+		T await_resume()
+		{
+			auto& promise = m_handle.promise();
+			if (promise.exception)
+			{
+				std::rethrow_exception(promise.exception);
+			}
+			if constexpr (!std::is_void_v<T>)
+			{
+				return std::move(*promise.value);
+			}
+		}
+
+	  private:
+		Handle m_handle;
+	};
+
+	namespace Coroutines
+	{
+		namespace Detail
+		{
+			template <typename T>
+			inline Task<T> Promise<T>::get_return_object()
+			{
+				return Task<T>(
+				    std::coroutine_handle<Promise>::from_promise(
+				        *this));
+			}
+
+			inline Task<void> Promise<void>::get_return_object()
+			{
+				return Task<void>(
+				    std::coroutine_handle<Promise>::from_promise(
+				        *this));
+			}
+
+			// Main thread resumes them from Update().
+			void ResumeNextFrame(std::coroutine_handle<> handle);
+			void ResumeWhen(std::coroutine_handle<> handle,
+			                std::function<bool()> ready);
+			void ResumeOnJob(Managers::JobManager& jobs,
+			                 std::coroutine_handle<> handle);
+		} // namespace Detail
+
+		// Starts a task that nobody awaits; it is destroyed
+		// when it finishes, or at Shutdown().
+		void Spawn(Task<void> task);
+
+		// Main thread, once per frame: resumes what waits on
+		// the next frame or a condition.
+		void Update();
+		// Destroys spawned tasks still suspended, after
+		// waiting for those running on job workers.
+		void Shutdown();
+		// Spawned and not finished.
+		size_t GetRunningCount();
+
+		// Resumes on the main thread in the next Update().
+		struct NextFrame
+		{
+			inline bool await_ready() const { return false; }
+			inline void await_suspend(
+			    std::coroutine_handle<> handle) const
+			{
+				Detail::ResumeNextFrame(handle);
+			}
+			inline void await_resume() const {}
+		};
+
+		// Resumes on the main thread in the first Update()
+		// in which ready() returns true; ready() is polled
+		// there, so keep it cheap.
+		struct WaitUntil
+		{
+			std::function<bool()> ready;
+
+			inline bool await_ready() const { return ready(); }
+			inline void await_suspend(
+			    std::coroutine_handle<> handle)
+			{
+				Detail::ResumeWhen(handle, std::move(ready));
+			}
+			inline void await_resume() const {}
+		};
+
+		// Continues on a job worker; co_await NextFrame()
+		// to get back to the main thread.
+		struct ResumeOn
+		{
+			Managers::JobManager& jobs;
+
+			inline bool await_ready() const { return false; }
+			inline void await_suspend(
+			    std::coroutine_handle<> handle) const
+			{
+				Detail::ResumeOnJob(jobs, handle);
+			}
+			inline void await_resume() const {}
+		};
+	} // namespace Coroutines
+} // namespace AthiVegam::Core
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "AthiVegam/Managers/JobManager.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AthiVegam::Core
+{
+	// Stages of a frame with the resources they read and
+	// write. A stage runs after the last stage registered
+	// before it that writes anything it touches, and a
+	// writer also waits for the readers before it, so the
+	// graph keeps the meaning of the registration order
+	// while independent stages run concurrently on the job
+	// system. Resources are plain names.
+	//
+	// Main-thread stages (window, GL, app callbacks by
+	// default) run on the thread calling Execute(); the rest
+	// are scheduled as jobs.
+	class TaskGraph
+	{
+	  public:
+		using StageFunction = std::function<void()>;
+
+		enum class Affinity
+		{
+			MainThread,
+			Any
+		};
+
+		TaskGraph() = default;
+		~TaskGraph() = default;
+
+		TaskGraph(const TaskGraph&) = delete;
+		TaskGraph& operator=(const TaskGraph&) = delete;
+
+		void AddStage(std::string name,
+		              std::initializer_list<std::string_view>
+		                  reads,
+		              std::initializer_list<std::string_view>
+		                  writes,
+		              StageFunction function,
+		              Affinity affinity = Affinity::Any);
+		// For resource lists built at run time.
+		void AddStage(std::string name,
+		              std::vector<std::string> reads,
+		              std::vector<std::string> writes,
+		              StageFunction function,
+		              Affinity affinity = Affinity::Any);
+		// Extra ordering between two registered stages,
+		// for dependencies no resource expresses.
+		bool AddDependency(std::string_view before,
+		                   std::string_view after);
+
+		// Runs every stage once and returns when all are
+		// done. The calling thread runs main-thread stages
+		// and helps with jobs while waiting.
+		void Execute(Managers::JobManager& jobs);
+
+		inline size_t GetStageCount() const
+		{
+			return m_stages.size();
+		}
+
+	  private:
+		struct Stage
+		{
+			std::string name;
+			std::vector<std::string> reads;
+			std::vector<std::string> writes;
+			StageFunction function;
+			Affinity affinity;
+			std::vector<uint32_t> dependents;
+			uint32_t dependencyCount = 0;
+		};
+
+		int32_t FindStage(std::string_view name) const;
+		void Compile();
+		void AddEdge(uint32_t before, uint32_t after);
+		void MakeReady(uint32_t stage);
+		void RunStage(uint32_t stage);
+
+	  private:
+		std::vector<Stage> m_stages;
+		std::vector<std::pair<uint32_t, uint32_t>>
+		    m_explicitEdges;
+		bool m_compiled = false;
+
+		// Per-execution state.
+		Managers::JobManager* m_jobs = nullptr;
+		Managers::JobCounter m_jobCounter;
+		std::unique_ptr<std::atomic<uint32_t>[]> m_remaining;
+		std::atomic<uint32_t> m_completed{0};
+		std::mutex m_mainMutex;
+		std::vector<uint32_t> m_mainReady;
+	};
+} // namespace AthiVegam::Core
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "AthiVegam/Core/Histogram.h"
+#include "AthiVegam/Core/Serialize.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace AthiVegam::Core
+{
+	// Field performance data for live builds. Per section
+	// of a session (a level, a menu) it aggregates CPU and
+	// GPU frame times into Histograms, counts hitches and
+	// keeps the CPU and GPU memory high-water marks. A
+	// section's report is written to the spool directory
+	// and handed to the uploader on a background thread,
+	// and stays spooled until the uploader takes it, so
+	// reports of sessions that ended offline go out with
+	// the next. EndFrame() costs a few hundred nanoseconds
+	// and never blocks.
+	namespace Telemetry
+	{
+		constexpr uint32_t SchemaVersion = 1;
+
+		struct Report
+		{
+			std::string session;
+			std::string section;
+			std::string build;
+			// Seconds since the Unix epoch.
+			uint64_t startTime = 0;
+			float seconds = 0.0f;
+			uint32_t frames = 0;
+			// Frames over HitchMultiple times the median
+			// and over HitchMinimumMs.
+			uint32_t hitches = 0;
+			// Microseconds.
+			std::vector<Histogram::Bucket> cpuFrameTimes;
+			std::vector<Histogram::Bucket> gpuFrameTimes;
+			uint64_t cpuMemoryPeak = 0;
+			uint64_t gpuMemoryPeak = 0;
+
+			VEGAM_SERIAL_FIELDS(&Report::session,
+			                    &Report::section,
+			                    &Report::build,
+			                    &Report::startTime,
+			                    &Report::seconds,
+			                    &Report::frames,
+			                    &Report::hitches,
+			                    &Report::cpuFrameTimes,
+			                    &Report::gpuFrameTimes,
+			                    &Report::cpuMemoryPeak,
+			                    &Report::gpuMemoryPeak)
+		};
+
+		constexpr float HitchMultiple = 2.0f;
+		constexpr float HitchMinimumMs = 33.0f;
+
+		// Takes a serialized Report (see Core::Serial);
+		// returns false to keep it for a later attempt.
+		// Called on the telemetry thread.
+		using Uploader =
+		    std::function<bool(const std::vector<uint8_t>&)>;
+
+		// Main thread. Starts a session and its first
+		// section, and a thread that uploads what is
+		// spooled.
+		void Start(const std::string& spoolDirectory,
+		           std::string build,
+		           std::string section = "Startup");
+		// Reports the section and waits for the thread,
+		// which gives up on uploads still failing.
+		void Stop();
+		bool IsRunning();
+
+		// Any time; the thread retries spooled reports with
+		// it.
+		void SetUploader(Uploader uploader);
+
+		// Main thread: reports the current section and
+		// starts the next, e.g. when a level loads.
+		void BeginSection(std::string name);
+		// Main thread, once per rendered frame.
+		void EndFrame();
+	} // namespace Telemetry
+} // namespace AthiVegam::Core
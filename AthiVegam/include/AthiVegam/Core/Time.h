@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace AthiVegam::Core
+{
+	enum class TimeDomain : uint8_t
+	{
+		// Drives the simulation's ticks; paused and slowed
+		// down with the game.
+		Game,
+		// Menus and HUD animation, which carry on while the
+		// game is paused.
+		Ui,
+		// Wall-clock time, never scaled.
+		Real,
+		Count,
+	};
+
+	// One frame's clocks, taken once at its start, so
+	// reading them costs nothing and every system sees the
+	// same time for the whole frame.
+	struct TimeSnapshot
+	{
+		static constexpr size_t DomainCount =
+		    static_cast<size_t>(TimeDomain::Count);
+
+		// steady_clock nanoseconds at the start of the
+		// frame.
+		uint64_t now = 0;
+		uint64_t frame = 0;
+		// Seconds each domain has run.
+		std::array<double, DomainCount> time{};
+		// Since the previous frame, scaled.
+		std::array<float, DomainCount> delta{};
+		// The same, averaged over recent frames, for
+		// animation that should not jitter with the frame
+		// time.
+		std::array<float, DomainCount> smoothedDelta{};
+
+		inline double Time(TimeDomain domain) const
+		{
+			return time[static_cast<size_t>(domain)];
+		}
+		inline float Delta(TimeDomain domain) const
+		{
+			return delta[static_cast<size_t>(domain)];
+		}
+		inline float SmoothedDelta(TimeDomain domain) const
+		{
+			return smoothedDelta[static_cast<size_t>(domain)];
+		}
+	};
+
+	// The engine's clock: a monotonic high-resolution
+	// clock advanced once per frame into a TimeSnapshot,
+	// with a scale per domain for pausing and slow motion.
+	// Main thread, except Now().
+	class Time
+	{
+	  public:
+		using Clock = std::chrono::steady_clock;
+
+		Time();
+
+		// steady_clock nanoseconds; from any thread.
+		static uint64_t Now();
+		static double Seconds(uint64_t from, uint64_t to);
+
+		// Advances every domain by the time since the last
+		// call, times its scale. Once per frame, first.
+		const TimeSnapshot& BeginFrame();
+		// Drops the time since the last BeginFrame(), e.g.
+		// after sleeping until an event.
+		void Resync();
+
+		inline const TimeSnapshot& GetSnapshot() const
+		{
+			return m_snapshot;
+		}
+
+		// 0 pauses, below 1 slows down; Real stays at 1.
+		void SetScale(TimeDomain domain, float scale);
+		float GetScale(TimeDomain domain) const;
+		// Keeps the scale for when unpaused.
+		void SetPaused(TimeDomain domain, bool paused);
+		bool IsPaused(TimeDomain domain) const;
+
+		// Weight of the newest frame in smoothedDelta, from
+		// 1 for none to near 0 for heavy smoothing.
+		void SetSmoothing(float weight);
+
+	  private:
+		TimeSnapshot m_snapshot;
+		std::array<float, TimeSnapshot::DomainCount> m_scales;
+		std::array<bool, TimeSnapshot::DomainCount> m_paused{};
+		float m_smoothing = 0.1f;
+		// Of real time, before scaling.
+		float m_smoothedReal = 0.0f;
+		uint64_t m_previous = 0;
+	};
+} // namespace AthiVegam::Core
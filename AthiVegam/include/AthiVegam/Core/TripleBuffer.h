@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace AthiVegam::Core
+{
+	// Hands the latest value from one writer thread to one
+	// reader thread. Each side owns a buffer and they swap
+	// through a shared middle one with a single atomic
+	// exchange, so neither ever waits; values the reader
+	// did not get to in time are skipped.
+	template <typename T>
+	class TripleBuffer
+	{
+	  public:
+		// Writer only. The buffer to fill before Publish().
+		T& Back() { return m_buffers[m_back]; }
+
+		void Publish()
+		{
+			m_back = m_middle.exchange(
+			             m_back | Fresh, std::memory_order_acq_rel)
+			         & Index;
+		}
+
+		// Reader only. Moves to the latest published value,
+		// if there is a new one; returns whether there was.
+		bool Update()
+		{
+			if (!(m_middle.load(std::memory_order_relaxed)
+			      & Fresh))
+			{
+				return false;
+			}
+			m_front = m_middle.exchange(
+			              m_front, std::memory_order_acq_rel)
+			          & Index;
+			return true;
+		}
+
+		// Reader only.
+		const T& Front() const { return m_buffers[m_front]; }
+
+	  private:
+		static constexpr uint8_t Index = 3;
+		static constexpr uint8_t Fresh = 4;
+
+		std::array<T, 3> m_buffers{};
+		uint8_t m_front = 0;
+		alignas(64) std::atomic<uint8_t> m_middle{1};
+		alignas(64) uint8_t m_back = 2;
+	};
+} // namespace AthiVegam::Core
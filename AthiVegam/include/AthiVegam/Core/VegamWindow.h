@@ -1,8 +1,29 @@
 #pragma once
 
+#include "AthiVegam/Core/EventBus.h"
+#include "AthiVegam/Core/PerformanceHud.h"
+#include "AthiVegam/EngineConfig.h"
+#include "AthiVegam/Graphics/DynamicResolution.h"
+#include "AthiVegam/Graphics/FrameReadback.h"
+#include "AthiVegam/Graphics/HdrPipeline.h"
+#include "AthiVegam/Graphics/RenderTarget.h"
+#include "AthiVegam/Graphics/ScreenCapture.h"
+#include "AthiVegam/Graphics/SortKey.h"
+#include "AthiVegam/Graphics/TemporalUpscaler.h"
 #include "ImGuiWindow.h"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
 struct SDL_Window;
+struct SDL_WindowEvent;
 using SDL_GLContext = void*;
 
 namespace AthiVegam::Core
@@ -13,15 +34,122 @@ namespace AthiVegam::Core
 		VegamWindow();
 		~VegamWindow();
 
-		bool Create();
+		bool Create(const EngineConfig& config);
 		void Shutdown();
 
+		// Publishes SDL's events to the engine's event bus
+		// as those of Core/Events.h.
 		void PumpEvents();
+		// Blocks until an event is queued or timeoutMs has
+		// passed; returns whether an event is waiting.
+		bool WaitForEvent(int timeoutMs);
+
+		// Minimized or without input focus.
+		inline bool IsInBackground() const
+		{
+			return m_minimized || !m_hasFocus;
+		}
+
+		// In screen coordinates; the drawable is larger in
+		// pixels on high-DPI displays (WindowDesc::highDpi).
+		// Both are cached from resize events, so any thread
+		// may call them.
+		void GetSize(int& w, int& h) const;
+		void GetDrawableSize(int& w, int& h) const;
 
-		void GetSize(int& w, int& h);
+		// Resizes closer together than this, as while
+		// dragging the window's border, are handled as one.
+		static constexpr std::chrono::milliseconds
+		    ResizeDebounce{150};
+		// Called on the GL thread at the start of the first
+		// frame after the drawable size settles, with the
+		// new size in pixels; reallocate render targets
+		// that follow the window size here. Set it before
+		// the render thread starts.
+		using ResizeCallback =
+		    std::function<void(int width, int height)>;
+		inline void SetResizeCallback(ResizeCallback callback)
+		{
+			m_resizeCallback = std::move(callback);
+		}
 		void BeginRender();
 		void EndRender();
 
+		// Render thread mode: EndRecording() finishes the
+		// frame's CPU work on the main thread, RenderFrame()
+		// issues its GL work and presents on the render
+		// thread.
+		void EndRecording();
+		void SwapFrames();
+		void RenderFrame();
+
+		// Headless (see EngineConfig::headless): frames are
+		// rendered into an offscreen target and never shown.
+		inline bool IsHeadless() const { return m_headless; }
+		// Every presented frame is read back asynchronously
+		// and handed to callback a few frames later, on the
+		// GL thread. Set it before the render thread starts,
+		// e.g. in App::Initialize(); null stops capturing.
+		inline void SetFrameReadback(
+		    Graphics::FrameReadback::Callback callback)
+		{
+			m_frameCallback = std::move(callback);
+		}
+		// Screenshots and frame sequences, read back the
+		// same way and written by a thread of their own.
+		// Requests may come from any thread.
+		inline Graphics::ScreenCapture& GetScreenCapture()
+		{
+			return m_screenCapture;
+		}
+
+		// The scene's dynamic resolution (see
+		// EngineConfig::dynamicResolutionMs), or null when
+		// it renders at full resolution. GL thread.
+		inline Graphics::DynamicResolution*
+		GetDynamicResolution()
+		{
+			return m_dynamicResolution ? &*m_dynamicResolution
+			                           : nullptr;
+		}
+
+		// The HDR scene pipeline (see EngineConfig::hdr), or
+		// null when the scene renders for display directly.
+		// GL thread.
+		inline Graphics::HdrPipeline* GetHdrPipeline()
+		{
+			return m_hdrPipeline ? &*m_hdrPipeline : nullptr;
+		}
+
+		// The scene's temporal upscaler (see
+		// EngineConfig::temporalUpscaling), or null. Jitter
+		// the projection with it while recording.
+		inline Graphics::TemporalUpscaler*
+		GetTemporalUpscaler()
+		{
+			return m_temporalUpscaler ? &*m_temporalUpscaler
+			                          : nullptr;
+		}
+
+		// Secondary windows drawn with the main GL context,
+		// so every GL object is shared, for e.g. an editor's
+		// scene and game views. Submit to one with
+		// RenderManager::SubmitToViewport(); its window is
+		// cleared and presented with the main window in the
+		// same frame. Main thread. Returns the viewport id,
+		// or 0 if none could be created.
+		static constexpr uint32_t MaxViewports =
+		    1u << Graphics::SortKey::ViewportBits;
+		uint32_t CreateViewport(const WindowDesc& desc);
+		// Commands still recorded for it draw into the main
+		// window.
+		void DestroyViewport(uint32_t viewport);
+		SDL_Window* GetViewportWindow(uint32_t viewport);
+
+		// Binds the GL context to the calling thread, or
+		// releases it so another thread can bind it.
+		bool MakeContextCurrent(bool current);
+
 		inline SDL_Window* GetSDLWindow()
 		{
 			return m_sdlWindow;
@@ -30,10 +158,94 @@ namespace AthiVegam::Core
 		{
 			return m_glContext;
 		}
+		inline PerformanceHud& GetPerformanceHud()
+		{
+			return m_performanceHud;
+		}
+
+		// Toggles the ImGui overlay, if created (see
+		// EngineConfig::imgui).
+		inline void SetUiEnabled(bool enabled)
+		{
+			m_uiEnabled = enabled;
+		}
+		inline bool IsUiEnabled() const { return m_uiEnabled; }
+		// Records the app's ImGui windows each frame, over
+		// the scene and after the HUD; keeps the UI shown
+		// while set. Called on the main thread.
+		inline void SetUiCallback(std::function<void()> callback)
+		{
+			m_uiCallback = std::move(callback);
+		}
+
+	  private:
+		void SetContextAttributes(const WindowDesc& desc);
+		void OnWindowEvent(const SDL_WindowEvent& event,
+		                   EventBus& events);
+		void UpdateSize();
+		// Reallocates what follows the drawable size once
+		// it settled; GL thread.
+		void ApplyResize(int w, int h);
+		void SetSwapInterval(VSync vsync);
+		void CheckFrameErrors();
+		void BindRenderTarget();
+		bool BeginUpscaledScene(int w, int h);
+		// Upscales the scene and tonemaps it, if HDR, to
+		// the display before the UI draws over it.
+		void ResolveRenderTarget();
+		void BindViewport(uint32_t viewport);
+		void Present();
+		void DestroyRetiredViewports();
+		bool IsUiVisible() const;
+		void DrawUi();
 
 	  private:
 		SDL_Window* m_sdlWindow;
 		SDL_GLContext m_glContext;
 		ImGuiWindow m_imguiWindow;
+		PerformanceHud m_performanceHud;
+		bool m_uiEnabled = false;
+		std::function<void()> m_uiCallback;
+		bool m_hasFocus = true;
+		bool m_minimized = false;
+		bool m_debugOutput = false;
+		bool m_headless = false;
+		Graphics::RenderTarget m_offscreen;
+		Graphics::FrameReadback m_readback;
+		Graphics::FrameReadback::Callback m_frameCallback;
+		Graphics::ScreenCapture m_screenCapture;
+		std::optional<Graphics::DynamicResolution>
+		    m_dynamicResolution;
+		// The scene of this frame renders into it.
+		bool m_scaledScene = false;
+		std::optional<Graphics::HdrPipeline> m_hdrPipeline;
+		bool m_hdrScene = false;
+		std::optional<Graphics::TemporalUpscaler>
+		    m_temporalUpscaler;
+		float m_upscalingScale = 1.0f;
+		bool m_upscaledScene = false;
+		// GL encodes sRGB on writing the display.
+		bool m_srgb = false;
+		uint64_t m_presentedFrames = 0;
+
+		// Window and drawable size, width in the high half.
+		// Written by the main thread's events.
+		std::atomic<uint64_t> m_size{0};
+		std::atomic<uint64_t> m_drawableSize{0};
+		// steady_clock time of the last size change.
+		std::atomic<int64_t> m_resizeTime{0};
+		// The drawable size render targets were last sized
+		// for; GL thread.
+		int m_targetWidth = 0;
+		int m_targetHeight = 0;
+		ResizeCallback m_resizeCallback;
+
+		// Index 0 stands for the main window.
+		std::mutex m_viewportsMutex;
+		std::array<SDL_Window*, MaxViewports> m_viewports{};
+		// Drawn into this frame; GL thread.
+		std::array<bool, MaxViewports> m_viewportsDrawn{};
+		// Destroyed between frames, on the main thread.
+		std::vector<SDL_Window*> m_retiredViewports;
 	};
 } // namespace AthiVegam::Core
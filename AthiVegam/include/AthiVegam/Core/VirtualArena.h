@@ -0,0 +1,110 @@
+#pragma once
+
+#include "AthiVegam/Core/Memory.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace AthiVegam::Core
+{
+	// Linear allocation from a range of address space
+	// reserved up front and committed as allocation reaches
+	// it, so the arena grows in place: nothing moves, and
+	// nothing is copied. Any thread may allocate; an
+	// allocation is a bump of an atomic offset, plus a lock
+	// only when it crosses into uncommitted memory.
+	//
+	// With large pages, memory is committed in 2 MB pages
+	// where the OS has them to give, so long linear walks
+	// take a TLB miss per 2 MB instead of per 4 KB. On
+	// Linux that is explicit huge pages (MAP_HUGETLB) if
+	// some are set aside, else transparent huge pages; on
+	// Windows MEM_LARGE_PAGES needs the lock-memory
+	// privilege and whole ranges committed at once, so the
+	// arena commits its reservation up front. Either way it
+	// falls back to normal pages.
+	class VirtualArena
+	{
+	  public:
+		struct Settings
+		{
+			// Address space, the most the arena holds.
+			size_t reserve = size_t(1) << 30;
+			// Committed at Initialize().
+			size_t commit = 0;
+			// Granularity of committing, rounded up to
+			// pages.
+			size_t commitStep = size_t(1) << 20;
+			bool largePages = false;
+			// Counts committed memory in the tag's stats.
+			Memory::Tag tag = Memory::Tag::General;
+		};
+
+		static constexpr size_t DefaultAlignment =
+		    alignof(std::max_align_t);
+
+		VirtualArena() = default;
+		~VirtualArena();
+
+		VirtualArena(const VirtualArena&) = delete;
+		VirtualArena& operator=(const VirtualArena&) = delete;
+
+		bool Initialize();
+		bool Initialize(const Settings& settings);
+		void Shutdown();
+
+		// nullptr once the reservation is used up.
+		void* Allocate(size_t size,
+		               size_t alignment = DefaultAlignment);
+		template <typename T>
+		inline T* Allocate(size_t count)
+		{
+			return static_cast<T*>(
+			    Allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		// Frees everything at once, keeping the memory
+		// committed. While no other thread allocates.
+		void Reset();
+		// Returns committed memory beyond keep bytes to the
+		// OS. While no other thread allocates.
+		void Trim(size_t keep);
+
+		inline std::byte* GetBase() const { return m_base; }
+		inline size_t GetUsed() const
+		{
+			return m_offset.load(std::memory_order_relaxed);
+		}
+		inline size_t GetCommitted() const
+		{
+			return m_committed.load(std::memory_order_relaxed);
+		}
+		inline size_t GetReserved() const { return m_reserved; }
+		inline bool HasLargePages() const
+		{
+			return m_largePages;
+		}
+
+		// Of the OS, 0 where large pages are unavailable.
+		static size_t GetPageSize();
+		static size_t GetLargePageSize();
+
+	  private:
+		bool Commit(size_t end);
+
+	  private:
+		std::byte* m_base = nullptr;
+		size_t m_reserved = 0;
+		// Of the mapping, which may start before m_base.
+		std::byte* m_mapping = nullptr;
+		size_t m_mappingSize = 0;
+		size_t m_step = 0;
+		Memory::Tag m_tag = Memory::Tag::General;
+		bool m_largePages = false;
+		std::atomic<size_t> m_offset{0};
+		std::atomic<size_t> m_committed{0};
+		std::mutex m_commitMutex;
+	};
+} // namespace AthiVegam::Core
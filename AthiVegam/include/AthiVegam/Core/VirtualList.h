@@ -0,0 +1,152 @@
+#pragma once
+
+#include "AthiVegam/Managers/JobManager.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AthiVegam::Core
+{
+	// A filterable list or tree of tens of thousands of
+	// items for editor panels, such as a scene outliner or
+	// an asset browser. Only the rows in view are handed to
+	// ImGui (see ImGuiListClipper). The search index and
+	// the filtering run on a job worker: the panel keeps
+	// showing the last results until new ones arrive, and a
+	// filter that extends the previous one only searches
+	// its matches.
+	//
+	// Items with a parent form a tree; parents come before
+	// their children. While filtering, matches are shown
+	// with their ancestors, expanded. Main thread, while
+	// ImGui records a frame.
+	class VirtualList
+	{
+	  public:
+		static constexpr uint32_t NoItem = 0xFFFFFFFF;
+
+		struct Item
+		{
+			std::string name;
+			uint32_t parent = NoItem;
+		};
+
+		// Draws the rest of an item's row, after its name,
+		// e.g. following ImGui::SameLine().
+		using RowCallback = std::function<void(uint32_t item)>;
+
+		explicit VirtualList(Managers::JobManager& jobs);
+		// Waits for the filtering in flight.
+		~VirtualList();
+
+		VirtualList(const VirtualList&) = delete;
+		VirtualList& operator=(const VirtualList&) = delete;
+
+		// Indexed on a worker; drawn once indexed. Clears
+		// the selection and collapses the tree.
+		void SetItems(std::vector<Item> items);
+		// Case-insensitive: each space-separated term must
+		// be part of the name.
+		void SetFilter(std::string_view filter);
+
+		// A filter box, then the rows in a child window
+		// filling the space left. True when a click changed
+		// the selection.
+		bool Draw(const char* id, const RowCallback& row = {});
+
+		inline uint32_t GetSelected() const
+		{
+			return m_selected;
+		}
+		inline void SetSelected(uint32_t item)
+		{
+			m_selected = item;
+		}
+		// Rows of the results drawn.
+		inline size_t GetRowCount() const
+		{
+			return m_rows.size();
+		}
+		// Indexing or filtering on a worker.
+		inline bool IsBusy() const { return m_inFlight; }
+
+	  private:
+		struct Index
+		{
+			std::vector<Item> items;
+			// Lowercase names, back to back.
+			std::string names;
+			std::vector<uint32_t> nameOffsets;
+			// The tree, in item order; NoItem ends a chain.
+			uint32_t firstRoot = NoItem;
+			std::vector<uint32_t> firstChild;
+			std::vector<uint32_t> nextSibling;
+		};
+
+		struct Result
+		{
+			std::shared_ptr<const Index> index;
+			// Lowercase.
+			std::string query;
+			// Items whose name matches, ascending.
+			std::vector<uint32_t> matches;
+			// Per item, a match or an ancestor of one; empty
+			// without a query, when every item is.
+			std::vector<uint8_t> shown;
+		};
+
+		struct Request
+		{
+			// Indexed first when not empty.
+			std::vector<Item> items;
+			std::shared_ptr<const Index> index;
+			std::string query;
+			// A result whose matches include the query's.
+			std::shared_ptr<const Result> base;
+		};
+
+		struct Row
+		{
+			uint32_t item;
+			uint32_t depth;
+		};
+
+		// On a worker.
+		static std::shared_ptr<const Index>
+		BuildIndex(std::vector<Item> items);
+		static std::shared_ptr<Result> Filter(Request& request);
+
+		void Poll();
+		// Starts the next job if none is in flight and the
+		// items or the query changed.
+		void Schedule();
+		void BuildRows();
+
+	  private:
+		Managers::JobManager& m_jobs;
+		Managers::JobCounter m_counter;
+
+		// The worker's result, for Poll().
+		std::mutex m_mutex;
+		std::shared_ptr<Result> m_finished;
+
+		bool m_inFlight = false;
+		bool m_itemsChanged = false;
+		std::vector<Item> m_pendingItems;
+		// Lowercase.
+		std::string m_query;
+
+		std::shared_ptr<const Result> m_result;
+		std::vector<uint8_t> m_expanded;
+		std::vector<Row> m_rows;
+		bool m_rowsDirty = false;
+		uint32_t m_selected = NoItem;
+		std::array<char, 256> m_filterText{};
+	};
+} // namespace AthiVegam::Core
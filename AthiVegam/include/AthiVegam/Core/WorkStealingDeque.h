@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace AthiVegam::Core
+{
+	// Fixed-capacity Chase-Lev deque. The owning thread
+	// pushes and pops at the bottom without contention;
+	// other threads steal from the top with a single CAS.
+	// Follows Le et al., "Correct and Efficient
+	// Work-Stealing for Weak Memory Models" (PPoPP 2013).
+	template <typename T, uint32_t Capacity>
+	class WorkStealingDeque
+	{
+		static_assert((Capacity & (Capacity - 1)) == 0,
+		              "Capacity must be a power of two");
+
+	  public:
+		// Owner only. Returns false when full.
+		bool Push(T item)
+		{
+			const auto bottom =
+			    m_bottom.load(std::memory_order_relaxed);
+			const auto top =
+			    m_top.load(std::memory_order_acquire);
+			if (bottom - top >= Capacity)
+			{
+				return false;
+			}
+
+			m_items[bottom & Mask].store(
+			    item, std::memory_order_relaxed);
+			std::atomic_thread_fence(
+			    std::memory_order_release);
+			m_bottom.store(bottom + 1,
+			               std::memory_order_relaxed);
+			return true;
+		}
+
+		// Owner only, newest first.
+		bool Pop(T& item)
+		{
+			const auto bottom =
+			    m_bottom.load(std::memory_order_relaxed) - 1;
+			m_bottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(
+			    std::memory_order_seq_cst);
+			auto top = m_top.load(std::memory_order_relaxed);
+
+			if (top > bottom)
+			{
+				// Empty.
+				m_bottom.store(bottom + 1,
+				               std::memory_order_relaxed);
+				return false;
+			}
+
+			item = m_items[bottom & Mask].load(
+			    std::memory_order_relaxed);
+			if (top == bottom)
+			{
+				// Last item; race the thieves for it.
+				const auto won = m_top.compare_exchange_strong(
+				    top, top + 1, std::memory_order_seq_cst,
+				    std::memory_order_relaxed);
+				m_bottom.store(bottom + 1,
+				               std::memory_order_relaxed);
+				return won;
+			}
+			return true;
+		}
+
+		// Any thread, oldest first. May fail spuriously when
+		// racing another thief or the owner.
+		bool Steal(T& item)
+		{
+			auto top = m_top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(
+			    std::memory_order_seq_cst);
+			const auto bottom =
+			    m_bottom.load(std::memory_order_acquire);
+			if (top >= bottom)
+			{
+				return false;
+			}
+
+			item = m_items[top & Mask].load(
+			    std::memory_order_relaxed);
+			return m_top.compare_exchange_strong(
+			    top, top + 1, std::memory_order_seq_cst,
+			    std::memory_order_relaxed);
+		}
+
+		inline bool IsEmpty() const
+		{
+			return m_bottom.load(std::memory_order_relaxed)
+			       <= m_top.load(std::memory_order_relaxed);
+		}
+		// A snapshot while other threads are at it.
+		inline uint32_t Size() const
+		{
+			const auto size =
+			    m_bottom.load(std::memory_order_relaxed)
+			    - m_top.load(std::memory_order_relaxed);
+			return size > 0 ? static_cast<uint32_t>(size) : 0;
+		}
+
+	  private:
+		static constexpr int64_t Mask = Capacity - 1;
+
+		// Separate cache lines so thieves hammering the top
+		// don't slow down the owner.
+		alignas(64) std::atomic<int64_t> m_top{0};
+		alignas(64) std::atomic<int64_t> m_bottom{0};
+		std::array<std::atomic<T>, Capacity> m_items{};
+	};
+} // namespace AthiVegam::Core
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "AthiVegam/Ecs/Component.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace AthiVegam::Ecs
+{
+	// Fixed-size block of one archetype's entities: their
+	// ids, then one tightly packed array per component.
+	struct Chunk
+	{
+		std::byte* data = nullptr;
+		uint32_t count = 0;
+	};
+
+	// Every entity with exactly the same set of components,
+	// stored in chunks. All chunks but the last are full:
+	// removing a row moves the archetype's last row into
+	// it, so iteration never skips holes.
+	class Archetype
+	{
+	  public:
+		static constexpr size_t ChunkSize = 16 * 1024;
+		static constexpr size_t ChunkAlignment = 64;
+
+		struct Location
+		{
+			uint32_t chunk;
+			uint32_t row;
+		};
+
+		explicit Archetype(const ComponentMask& mask);
+		~Archetype();
+
+		Archetype(const Archetype&) = delete;
+		Archetype& operator=(const Archetype&) = delete;
+
+		inline const ComponentMask& GetMask() const
+		{
+			return m_mask;
+		}
+		inline const std::vector<ComponentId>&
+		GetComponents() const
+		{
+			return m_components;
+		}
+		inline bool Has(ComponentId id) const
+		{
+			return m_mask.test(id);
+		}
+		// Entities per chunk.
+		inline uint32_t GetCapacity() const
+		{
+			return m_capacity;
+		}
+		inline uint32_t GetCount() const { return m_count; }
+		// Every component is trivially copyable.
+		inline bool IsTrivial() const { return m_trivial; }
+		inline size_t GetChunkCount() const
+		{
+			return m_chunks.size();
+		}
+		inline Chunk& GetChunk(size_t index)
+		{
+			return m_chunks[index];
+		}
+
+		inline Entity* GetEntities(const Chunk& chunk) const
+		{
+			return reinterpret_cast<Entity*>(chunk.data);
+		}
+		// The component must be part of the archetype.
+		inline void* GetColumn(const Chunk& chunk,
+		                       ComponentId id) const
+		{
+			return chunk.data + m_offsets[m_columns[id]];
+		}
+		template <typename T>
+		inline std::remove_reference_t<T>*
+		GetColumn(const Chunk& chunk) const
+		{
+			return static_cast<std::remove_reference_t<T>*>(
+			    GetColumn(chunk, GetComponentId<T>()));
+		}
+		inline void* Get(Location location,
+		                 ComponentId id) const
+		{
+			const auto& info = GetComponentInfo(id);
+			return static_cast<std::byte*>(GetColumn(
+			           m_chunks[location.chunk], id))
+			       + info.size * location.row;
+		}
+
+		// Appends a row for the entity; its components are
+		// left unconstructed.
+		Location Allocate(Entity entity);
+		// Appends up to count rows to one chunk, for bulk
+		// copies, and lowers count to the rows appended.
+		// Entities and components are left unset.
+		Location AllocateRun(uint32_t& count);
+		// Default-constructs every component of a row.
+		void Construct(Location location);
+		// Removes a row, destroying its components unless
+		// they were already relocated out, and returns the
+		// entity moved into its place, if any.
+		Entity Remove(Location location, bool destroy);
+		void Clear();
+		// Grows or shrinks a trivial archetype to count
+		// rows without touching their bytes, for restoring
+		// copied chunks.
+		void Resize(uint32_t count);
+
+		// Archetypes one component away, cached by the
+		// Registry as entities move between them.
+		uint32_t FindEdge(ComponentId id, bool add) const;
+		void SetEdge(ComponentId id, bool add,
+		             uint32_t archetype);
+
+		static constexpr uint32_t NoEdge = ~0u;
+
+	  private:
+		void Destroy(Chunk& chunk, uint32_t row);
+
+	  private:
+		ComponentMask m_mask;
+		std::vector<ComponentId> m_components;
+		// Byte offset of each column in a chunk; column i
+		// holds m_components[i].
+		std::vector<uint32_t> m_offsets;
+		std::array<uint8_t, MaxComponents> m_columns{};
+		bool m_trivial = true;
+		uint32_t m_capacity = 0;
+
+		std::vector<Chunk> m_chunks;
+		uint32_t m_count = 0;
+
+		struct Edge
+		{
+			ComponentId id;
+			bool add;
+			uint32_t archetype;
+		};
+		std::vector<Edge> m_edges;
+	};
+} // namespace AthiVegam::Ecs
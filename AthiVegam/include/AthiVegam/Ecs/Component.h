@@ -0,0 +1,88 @@
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace AthiVegam::Ecs
+{
+	// Index into the Registry's entity table and the
+	// generation of that slot when the entity was created.
+	// Generation 0 is never issued, so a default Entity is
+	// "no entity".
+	struct Entity
+	{
+		uint32_t index = 0;
+		uint32_t generation = 0;
+
+		constexpr bool IsValid() const
+		{
+			return generation != 0;
+		}
+		constexpr bool operator==(const Entity&) const =
+		    default;
+	};
+
+	using ComponentId = uint16_t;
+
+	constexpr ComponentId MaxComponents = 128;
+	using ComponentMask = std::bitset<MaxComponents>;
+
+	// How chunk storage creates, relocates and destroys a
+	// component type it only knows by id.
+	struct ComponentInfo
+	{
+		size_t size;
+		size_t alignment;
+		void (*construct)(void* memory);
+		// Move-constructs into dst and destroys src.
+		void (*relocate)(void* dst, void* src);
+		void (*destroy)(void* memory);
+		// Trivially copyable types are relocated with
+		// memcpy and never destroyed.
+		bool trivial;
+	};
+
+	// Ids are handed out on first use, in no particular
+	// order, and are stable for the rest of the run.
+	ComponentId RegisterComponent(const ComponentInfo& info);
+	const ComponentInfo& GetComponentInfo(ComponentId id);
+
+	// Any movable, default-constructible type can be a
+	// component; empty types work as tags.
+	template <typename T>
+	inline ComponentId GetComponentId()
+	{
+		using Type = std::remove_cvref_t<T>;
+		static_assert(std::is_move_constructible_v<Type>
+		                  && std::is_default_constructible_v<
+		                      Type>,
+		              "Components must be default "
+		              "constructible and movable");
+
+		static const ComponentId id = RegisterComponent(
+		    {sizeof(Type), alignof(Type),
+		     [](void* memory) { new (memory) Type(); },
+		     [](void* dst, void* src) {
+			     auto* from = static_cast<Type*>(src);
+			     new (dst) Type(std::move(*from));
+			     from->~Type();
+		     },
+		     [](void* memory) {
+			     static_cast<Type*>(memory)->~Type();
+		     },
+		     std::is_trivially_copyable_v<Type>});
+		return id;
+	}
+
+	template <typename... Ts>
+	inline ComponentMask MakeComponentMask()
+	{
+		ComponentMask mask;
+		(mask.set(GetComponentId<Ts>()), ...);
+		return mask;
+	}
+} // namespace AthiVegam::Ecs
@@ -0,0 +1,301 @@
+#pragma once
+
+#include "AthiVegam/Core/FlatHashMap.h"
+#include "AthiVegam/Ecs/Archetype.h"
+#include "AthiVegam/Ecs/Component.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Managers/JobManager.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace AthiVegam::Ecs
+{
+	// Entities and their components, stored by archetype
+	// in chunks (see Archetype) so that iterating a set of
+	// components walks contiguous arrays. Adding or
+	// removing a component moves the entity to another
+	// archetype; lookups from an Entity go through a
+	// generational table.
+	//
+	// Structural changes (Create, Destroy, Add, Remove)
+	// are main-thread only and not allowed while a ForEach
+	// is running. Iteration and Get() may run on any thread
+	// as long as no two writers touch the same component.
+	class Registry
+	{
+	  public:
+		Registry();
+		~Registry();
+
+		Registry(const Registry&) = delete;
+		Registry& operator=(const Registry&) = delete;
+
+		Entity Create();
+		// Constructs the components in place, without
+		// passing through intermediate archetypes.
+		template <typename... Ts>
+		Entity Create(Ts&&... components)
+		{
+			const auto entity = AllocateRecord();
+			auto& record = m_records[entity.index];
+			record.archetype = FindOrCreateArchetype(
+			    MakeComponentMask<Ts...>());
+			auto& archetype = *m_archetypes[record.archetype];
+			const auto location = archetype.Allocate(entity);
+			(new (archetype.Get(location,
+			                    GetComponentId<Ts>()))
+			     std::remove_cvref_t<Ts>(
+			         std::forward<Ts>(components)),
+			 ...);
+			record.chunk = location.chunk;
+			record.row = location.row;
+			return entity;
+		}
+		void Destroy(Entity entity);
+		bool IsAlive(Entity entity) const;
+		void Clear();
+
+		// Replaces the component if the entity has one.
+		template <typename T>
+		T& Add(Entity entity, T value)
+		{
+			auto* component = static_cast<T*>(
+			    AddComponent(entity, GetComponentId<T>()));
+			*component = std::move(value);
+			return *component;
+		}
+		template <typename T>
+		T& Add(Entity entity)
+		{
+			return *static_cast<T*>(
+			    AddComponent(entity, GetComponentId<T>()));
+		}
+		template <typename T>
+		void Remove(Entity entity)
+		{
+			RemoveComponent(entity, GetComponentId<T>());
+		}
+		template <typename T>
+		bool Has(Entity entity) const
+		{
+			return GetComponent(entity, GetComponentId<T>())
+			       != nullptr;
+		}
+		// nullptr if the entity is dead or lacks T. Valid
+		// until the next structural change.
+		template <typename T>
+		T* Get(Entity entity) const
+		{
+			return static_cast<T*>(
+			    GetComponent(entity, GetComponentId<T>()));
+		}
+
+		// Calls function(Ts&...) or function(Entity, Ts&...)
+		// for every entity with at least the components Ts,
+		// chunk by chunk. Use const Ts for read-only access.
+		template <typename... Ts, typename F>
+		void ForEach(F&& function)
+		{
+			IterationScope scope(*this);
+			const auto mask = MakeComponentMask<Ts...>();
+			for (auto& archetype : m_archetypes)
+			{
+				if ((archetype->GetMask() & mask) != mask)
+				{
+					continue;
+				}
+				for (size_t i = 0;
+				     i < archetype->GetChunkCount(); ++i)
+				{
+					RunChunk<Ts...>(*archetype,
+					                archetype->GetChunk(i),
+					                function);
+				}
+			}
+		}
+
+		// As ForEach, with chunks spread over the job
+		// system; returns once all have run. function is
+		// called concurrently and must only write the
+		// entity it was given.
+		template <typename... Ts, typename F>
+		void ParallelForEach(Managers::JobManager& jobs,
+		                     F&& function)
+		{
+			IterationScope scope(*this);
+			const auto mask = MakeComponentMask<Ts...>();
+			std::vector<std::pair<Archetype*, Chunk*>> chunks;
+			for (auto& archetype : m_archetypes)
+			{
+				if ((archetype->GetMask() & mask) != mask)
+				{
+					continue;
+				}
+				for (size_t i = 0;
+				     i < archetype->GetChunkCount(); ++i)
+				{
+					chunks.emplace_back(
+					    archetype.get(),
+					    &archetype->GetChunk(i));
+				}
+			}
+
+			jobs.ParallelFor(
+			    static_cast<uint32_t>(chunks.size()), 1,
+			    [&](uint32_t i) {
+				    RunChunk<Ts...>(*chunks[i].first,
+				                    *chunks[i].second,
+				                    function);
+			    });
+		}
+
+		// Calls function(count, entities, Ts*...) once per
+		// matching chunk, for code that processes whole
+		// columns at a time.
+		template <typename... Ts, typename F>
+		void ForEachChunk(F&& function)
+		{
+			IterationScope scope(*this);
+			const auto mask = MakeComponentMask<Ts...>();
+			for (auto& archetype : m_archetypes)
+			{
+				if ((archetype->GetMask() & mask) != mask)
+				{
+					continue;
+				}
+				for (size_t i = 0;
+				     i < archetype->GetChunkCount(); ++i)
+				{
+					auto& chunk = archetype->GetChunk(i);
+					function(
+					    chunk.count,
+					    static_cast<const Entity*>(
+					        archetype->GetEntities(chunk)),
+					    archetype->template GetColumn<Ts>(
+					        chunk)...);
+				}
+			}
+		}
+
+		inline uint32_t GetCount() const { return m_count; }
+		inline size_t GetArchetypeCount() const
+		{
+			return m_archetypes.size();
+		}
+
+	  private:
+		friend class RollbackBuffer;
+		friend class SceneSnapshot;
+
+		static constexpr uint32_t Dead = ~0u;
+
+		// Entity slot; archetype 0 holds entities without
+		// components. A free slot keeps the generation its
+		// next entity will get.
+		struct Record
+		{
+			uint32_t archetype = Dead;
+			uint32_t chunk = 0;
+			uint32_t row = 0;
+			uint32_t generation = 1;
+		};
+
+		// Counts running iterations, which structural
+		// changes assert against.
+		class IterationScope
+		{
+		  public:
+			inline explicit IterationScope(Registry& registry)
+			    : m_registry(registry)
+			{
+				m_registry.m_iterating.fetch_add(
+				    1, std::memory_order_relaxed);
+			}
+			inline ~IterationScope()
+			{
+				m_registry.m_iterating.fetch_sub(
+				    1, std::memory_order_relaxed);
+			}
+
+		  private:
+			Registry& m_registry;
+		};
+
+		template <typename... Ts, typename F>
+		static void RunChunk(Archetype& archetype,
+		                     Chunk& chunk, F& function)
+		{
+			RunRows<Ts...>(chunk.count,
+			               archetype.GetEntities(chunk),
+			               function,
+			               archetype.template GetColumn<Ts>(
+			                   chunk)...);
+		}
+		template <typename... Ts, typename F>
+		static void
+		RunRows(uint32_t count, const Entity* entities,
+		        F& function,
+		        std::remove_reference_t<Ts>*... columns)
+		{
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				if constexpr (std::is_invocable_v<F&, Entity,
+				                                  Ts&...>)
+				{
+					function(entities[i], columns[i]...);
+				}
+				else
+				{
+					function(columns[i]...);
+				}
+			}
+		}
+
+		// A live entity whose record is not placed in any
+		// archetype yet.
+		Entity AllocateRecord();
+		void Free(uint32_t index);
+		uint32_t FindOrCreateArchetype(
+		    const ComponentMask& mask);
+		uint32_t GetNeighbour(uint32_t archetype,
+		                      ComponentId id, bool add);
+		// Moves the entity's components into another
+		// archetype, default-constructing the new ones.
+		void Move(Entity entity, uint32_t archetype);
+		// Updates the record of the entity an archetype
+		// moved into a removed row.
+		void FixMoved(Entity moved,
+		              Archetype::Location location);
+
+		void* AddComponent(Entity entity, ComponentId id);
+		void RemoveComponent(Entity entity, ComponentId id);
+		void* GetComponent(Entity entity,
+		                   ComponentId id) const;
+
+		inline void AssertStructural() const
+		{
+			VEGAM_ASSERT(m_iterating.load(
+			                 std::memory_order_relaxed)
+			                 == 0,
+			             "Structural change during ECS "
+			             "iteration");
+		}
+
+	  private:
+		std::vector<std::unique_ptr<Archetype>> m_archetypes;
+		Core::FlatHashMap<ComponentMask, uint32_t>
+		    m_archetypeIndex;
+
+		std::vector<Record> m_records;
+		std::vector<uint32_t> m_freeRecords;
+		uint32_t m_count = 0;
+
+		std::atomic<uint32_t> m_iterating{0};
+	};
+} // namespace AthiVegam::Ecs
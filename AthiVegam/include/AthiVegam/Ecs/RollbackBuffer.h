@@ -0,0 +1,73 @@
+#pragma once
+
+#include "AthiVegam/Ecs/Registry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Ecs
+{
+	// The last few ticks of a Registry, whole, for rollback
+	// netcode (see Net::Rollback). Saving copies every
+	// chunk as it is, and the entity table; restoring
+	// copies them back, so either costs a memcpy of the
+	// registry. Once the ring has gone round, slots reuse
+	// their buffers and neither allocates.
+	//
+	// Every component must be trivially copyable; unlike
+	// SceneSnapshot, bytes are only ever copied within one
+	// run, so handles and pointers stay valid.
+	class RollbackBuffer
+	{
+	  public:
+		static constexpr uint64_t NoTick = ~0ull;
+
+		explicit RollbackBuffer(uint32_t capacity);
+
+		RollbackBuffer(const RollbackBuffer&) = delete;
+		RollbackBuffer&
+		operator=(const RollbackBuffer&) = delete;
+
+		// Replaces the oldest state held, or the one of the
+		// same tick.
+		void Save(const Registry& registry, uint64_t tick);
+		// Puts the registry back as it was saved at tick;
+		// entities created since are gone and destroyed
+		// ones are back, with their handles. False if the
+		// tick is not held.
+		bool Restore(Registry& registry, uint64_t tick) const;
+		bool Has(uint64_t tick) const;
+		// Forgets every state.
+		void Clear();
+
+		inline uint32_t GetCapacity() const
+		{
+			return static_cast<uint32_t>(m_states.size());
+		}
+		// Bytes held across every slot.
+		size_t GetMemoryUsage() const;
+
+	  private:
+		struct State
+		{
+			uint64_t tick = NoTick;
+			std::vector<Registry::Record> records;
+			std::vector<uint32_t> freeRecords;
+			uint32_t count = 0;
+			// Rows of each archetype, in registry order;
+			// archetypes created since have none.
+			std::vector<uint32_t> rows;
+			// Every chunk, ChunkSize bytes each, archetype
+			// after archetype.
+			std::vector<std::byte> chunks;
+		};
+
+		// GetCapacity() if the tick is not held.
+		uint32_t FindSlot(uint64_t tick) const;
+
+	  private:
+		std::vector<State> m_states;
+		uint32_t m_next = 0;
+	};
+} // namespace AthiVegam::Ecs
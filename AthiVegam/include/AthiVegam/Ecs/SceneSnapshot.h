@@ -0,0 +1,90 @@
+#pragma once
+
+#include "AthiVegam/Ecs/Component.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace AthiVegam::Ecs
+{
+	class Registry;
+
+	// Saves a Registry's entities column by column and
+	// restores them with bulk copies into fresh chunks, so
+	// loading a cooked level costs about as much as reading
+	// the file. Component ids change from run to run, so
+	// each snapshotted type is given a stable name; other
+	// components are left out of snapshots.
+	//
+	// Components are copied as raw bytes. Fields that only
+	// mean something at runtime, such as resource handles,
+	// should be rebuilt by the type's resolve function from
+	// stable ones, e.g. an Assets::AssetId resolved through
+	// the AssetManager.
+	class SceneSnapshot
+	{
+	  public:
+		// Called on each run of restored components, with
+		// the context passed to Load().
+		using Resolve = void (*)(void* components,
+		                         uint32_t count,
+		                         void* context);
+
+		// Data saved with a type of a different size loses
+		// that component, so rename a type whose layout
+		// changes.
+		template <typename T>
+		void AddType(std::string_view name,
+		             Resolve resolve = nullptr)
+		{
+			static_assert(std::is_trivially_copyable_v<T>,
+			              "Snapshotted components are copied "
+			              "as bytes");
+			AddType(GetComponentId<T>(), name, resolve);
+		}
+		void AddType(ComponentId id, std::string_view name,
+		             Resolve resolve = nullptr);
+
+		// The snapshotted components of a registry, copied
+		// out for Serialize().
+		struct Captured;
+
+		void Save(const Registry& registry,
+		          std::vector<uint8_t>& data) const;
+		// Save() in two halves, for saving in the
+		// background: Capture() copies the columns on the
+		// thread that owns the registry, and Serialize()
+		// builds the data from the copy on any thread, e.g.
+		// within a Core::SaveWriter job.
+		std::shared_ptr<const Captured>
+		Capture(const Registry& registry) const;
+		static void Serialize(const Captured& captured,
+		                      std::vector<uint8_t>& data);
+		// Replaces everything in the registry. Entities keep
+		// their handles, so components referring to other
+		// entities need no fix-up. data must stay valid only
+		// for the call, e.g. a Core::MappedFile. False, with
+		// the registry left empty, for malformed data.
+		bool Load(Registry& registry, const uint8_t* data,
+		          size_t size, void* context = nullptr) const;
+
+	  private:
+		struct Type
+		{
+			ComponentId id;
+			std::string name;
+			Resolve resolve;
+		};
+
+		const Type* Find(ComponentId id) const;
+		const Type* Find(std::string_view name) const;
+
+	  private:
+		std::vector<Type> m_types;
+	};
+} // namespace AthiVegam::Ecs
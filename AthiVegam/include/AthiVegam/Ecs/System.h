@@ -0,0 +1,53 @@
+#pragma once
+
+#include "AthiVegam/Core/TaskGraph.h"
+#include "AthiVegam/Ecs/Registry.h"
+#include "AthiVegam/Managers/JobManager.h"
+
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace AthiVegam::Ecs
+{
+	// TaskGraph resource name of a component type.
+	template <typename T>
+	inline std::string GetComponentResource()
+	{
+		return "Ecs." + std::to_string(GetComponentId<T>());
+	}
+
+	// Adds a stage running function over every entity with
+	// the components Ts, spread over the job system (see
+	// Registry::ParallelForEach). Const components are
+	// declared as reads and the rest as writes, so systems
+	// touching different components run concurrently while
+	// those sharing one keep their registration order.
+	//
+	// Systems also read "World", which the engine's
+	// App.Update writes: structural changes belong there,
+	// or in other stages writing "World".
+	template <typename... Ts, typename F>
+	void AddSystem(Core::TaskGraph& graph, Registry& registry,
+	               Managers::JobManager& jobs, std::string name,
+	               F function)
+	{
+		std::vector<std::string> reads{"World"};
+		std::vector<std::string> writes;
+		((std::is_const_v<std::remove_reference_t<Ts>>
+		      ? reads
+		      : writes)
+		     .push_back(GetComponentResource<Ts>()),
+		 ...);
+
+		graph.AddStage(
+		    std::move(name), std::move(reads),
+		    std::move(writes),
+		    [&registry, &jobs,
+		     function = std::move(function)]() mutable {
+			    registry.ParallelForEach<Ts...>(jobs,
+			                                    function);
+		    });
+	}
+} // namespace AthiVegam::Ecs
@@ -1,11 +1,27 @@
 #pragma once
 
 #include "App.h"
+#include "Core/EventBus.h"
+#include "Core/FrameArena.h"
+#include "Core/FrameLimiter.h"
+#include "Core/LoaderThread.h"
+#include "Core/RenderThread.h"
+#include "Core/TaskGraph.h"
+#include "Core/Time.h"
 #include "Core/VegamWindow.h"
+#include "Managers/AssetManager.h"
+#include "Managers/AudioManager.h"
+#include "Managers/FileManager.h"
+#include "Managers/JobManager.h"
 #include "Managers/LogManager.h"
 #include "Managers/RenderManager.h"
+#include "Managers/ResourceManager.h"
+#include "Physics/PhysicsWorld.h"
 
+#include <atomic>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace AthiVegam
 {
@@ -28,20 +44,130 @@ namespace AthiVegam
 		Engine& operator=(Engine&&) = delete;
 
 		// Engine Methods
+		void SetCommandLine(int argc, char** argv);
+		inline const std::vector<std::string>&
+		GetArguments() const
+		{
+			return m_arguments;
+		}
 		void Run(std::unique_ptr<App> app);
 		void Quit();
-		void Update();
-		void Render();
+
+		// Starts SDL subsystems (SDL_INIT_* flags) the first
+		// time a feature needs them; the engine itself only
+		// brings up video at startup. Main thread. Returns
+		// false if one failed to start.
+		bool InitSubsystem(uint32_t sdlFlags);
+		void Update(float deltaTime);
+		void Render(float alpha);
+
+		// Render-on-demand mode (see EngineConfig). A
+		// redraw request runs one more frame and may come
+		// from any thread; while animating, frames run
+		// continuously.
+		inline void RequestRedraw()
+		{
+			m_redrawRequested.store(true,
+			                        std::memory_order_relaxed);
+		}
+		inline void SetAnimating(bool animating)
+		{
+			m_animating = animating;
+		}
 
 		// Getters for Managers
+		inline Managers::FileManager& GetFileManager()
+		{
+			return m_fileManager;
+		}
+		inline Managers::JobManager& GetJobManager()
+		{
+			return m_jobManager;
+		}
 		inline Managers::RenderManager& GetRenderManager()
 		{
 			return m_renderManager;
 		}
+		inline Managers::ResourceManager&
+		GetResourceManager()
+		{
+			return m_resourceManager;
+		}
+		inline Managers::AssetManager& GetAssetManager()
+		{
+			return m_assetManager;
+		}
+		inline Managers::AudioManager& GetAudioManager()
+		{
+			return m_audioManager;
+		}
+		// Stepped once per tick after App::Update().
+		inline Physics::PhysicsWorld& GetPhysicsWorld()
+		{
+			return m_physicsWorld;
+		}
+		// Scratch memory valid until the end of the next
+		// frame's Render().
+		inline Core::FrameArena& GetFrameArena()
+		{
+			return m_frameArena;
+		}
 		inline Core::VegamWindow& GetWindow()
 		{
 			return m_window;
 		}
+		// Delivers each frame's events right after pumping
+		// the window's, before the ticks; the window's are
+		// in Core/Events.h. Apps may publish their own.
+		inline Core::EventBus& GetEventBus()
+		{
+			return m_eventBus;
+		}
+		// GL resource creation off the GL thread (see
+		// EngineConfig::loaderThread).
+		inline Core::LoaderThread& GetLoaderThread()
+		{
+			return m_loaderThread;
+		}
+		inline const EngineConfig& GetConfig() const
+		{
+			return m_config;
+		}
+
+		// Per-frame stages. The engine registers
+		// "Input.Update" (writes "Input"), "App.Update"
+		// (reads "Input", writes "World") and
+		// "Physics.Step" (writes "World") for each tick, and
+		// "Window.BeginRender", "App.Render" (reads "World")
+		// and "Window.EndRender", all writing "Frame", for
+		// each frame. Servers get neither "Input.Update" nor
+		// any render stages. Apps may add stages from
+		// App::Initialize().
+		inline Core::TaskGraph& GetUpdateGraph()
+		{
+			return m_updateGraph;
+		}
+		inline Core::TaskGraph& GetRenderGraph()
+		{
+			return m_renderGraph;
+		}
+		// Taken at the start of each frame. Game time drives
+		// the ticks: scaling it slows them down, and pausing
+		// it stops them, while Ui and Real time carry on.
+		inline Core::Time& GetTime() { return m_time; }
+		inline const Core::TimeSnapshot& GetTimeSnapshot() const
+		{
+			return m_time.GetSnapshot();
+		}
+		// Of a tick, in game time.
+		inline float GetDeltaTime() const
+		{
+			return m_deltaTime;
+		}
+		inline float GetAlpha() const { return m_alpha; }
+		// Ticks run so far; the simulation clock of
+		// deterministic games.
+		inline uint64_t GetTick() const { return m_tick; }
 
 	  private:
 		// Singleton for now
@@ -51,17 +177,52 @@ namespace AthiVegam
 		void Shutdown();
 
 		void GetInfo();
+		// The loop of EngineConfig::server.
+		void RunServer();
+		void BuildFrameGraphs();
+		// The engine's own handlers of Core/Events.h.
+		void SubscribeToEvents();
+		void ParseCommandLine();
+		void StartProfileCapture(uint32_t frameCount);
+		bool IsIdle() const;
 
 	  private:
 		bool m_isRunning;
 		bool m_isInitialized;
+		std::atomic<bool> m_redrawRequested{true};
+		bool m_animating = false;
+		bool m_controllersEnabled = false;
 
 		std::unique_ptr<App> m_app;
+		EngineConfig m_config;
+		std::vector<std::string> m_arguments;
+		uint32_t m_startupCaptureFrames = 0;
 
 		Core::VegamWindow m_window;
+		Core::EventBus m_eventBus;
+		Core::RenderThread m_renderThread;
+		Core::LoaderThread m_loaderThread;
+		Core::FrameLimiter m_frameLimiter;
+		Core::Time m_time;
+		Core::FrameArena m_frameArena;
+		Physics::PhysicsWorld m_physicsWorld;
+
+		Core::TaskGraph m_updateGraph;
+		Core::TaskGraph m_renderGraph;
+		float m_deltaTime = 0.0f;
+		float m_alpha = 0.0f;
+		uint64_t m_tick = 0;
+		// steady_clock nanoseconds at the end of the tick
+		// being simulated.
+		uint64_t m_tickEnd = 0;
 
 		// Managers
 		Managers::LogManager m_logManager;
+		Managers::FileManager m_fileManager;
+		Managers::JobManager m_jobManager;
 		Managers::RenderManager m_renderManager;
+		Managers::ResourceManager m_resourceManager;
+		Managers::AssetManager m_assetManager;
+		Managers::AudioManager m_audioManager;
 	};
 } // namespace AthiVegam
@@ -0,0 +1,402 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace AthiVegam
+{
+	enum class VSync
+	{
+		Off,
+		On,
+		// Syncs unless a frame is late, then tears instead
+		// of waiting a whole refresh. Falls back to On where
+		// the driver lacks it.
+		Adaptive
+	};
+
+	enum class WindowMode
+	{
+		Windowed,
+		// Fullscreen at the desktop resolution without a
+		// mode switch.
+		Borderless,
+		// Exclusive fullscreen at the window size; lets the
+		// driver flip instead of composite.
+		Fullscreen
+	};
+
+	// Window and GL context created by VegamWindow::Create().
+	// All of it is applied before the window exists, as
+	// some platforms fix the pixel format at creation.
+	struct WindowDesc
+	{
+		std::string title = "AthiVegamGame";
+		int width = 800;
+		int height = 600;
+		WindowMode mode = WindowMode::Windowed;
+		bool resizable = true;
+		// Create the window hidden, for headless runs such
+		// as benchmarks. GL still renders into its back
+		// buffer.
+		bool hidden = false;
+		// Full resolution drawable on high-DPI displays;
+		// see VegamWindow::GetDrawableSize().
+		bool highDpi = false;
+
+		// OpenGL context version. 4.3+ enables the
+		// multi-draw-indirect path in RenderManager.
+		int glMajorVersion = 4;
+		int glMinorVersion = 1;
+#ifdef AV_CONFIG_RELEASE
+		bool debugContext = false;
+#else
+		bool debugContext = true;
+#endif // AV_CONFIG_RELEASE
+		// KHR_no_error: GL errors become undefined behavior
+		// and the driver skips validating every call.
+		// Overrides debugContext.
+#ifdef AV_CONFIG_SHIPPING
+		bool noErrorContext = true;
+#else
+		bool noErrorContext = false;
+#endif // AV_CONFIG_SHIPPING
+		// sRGB-capable default framebuffer, with
+		// GL_FRAMEBUFFER_SRGB enabled.
+		bool srgb = false;
+		// Samples per pixel of the default framebuffer; 0
+		// disables multisampling.
+		int msaaSamples = 0;
+
+		// Swap interval set when the context is created.
+		VSync vsync = VSync::On;
+
+		// Count GL calls and the time spent in them (see
+		// Graphics::GLCallCounter). Ignored in Shipping.
+#ifdef AV_CONFIG_PROFILE
+		bool countGLCalls = true;
+#else
+		bool countGLCalls = false;
+#endif // AV_CONFIG_PROFILE
+	};
+
+	// Minimum level of a log sink; Off disables the sink.
+	enum class LogLevel
+	{
+		Trace,
+		Debug,
+		Info,
+		Warn,
+		Error,
+		Fatal,
+		Off
+	};
+
+	// What an async log call does when the queue is full.
+	enum class LogOverflow
+	{
+		Block,
+		DropOldest
+	};
+
+	// See Core::BinaryLog.
+	enum class BinaryLogMode
+	{
+		Off,
+		// Formatted to the engine log on a background
+		// thread.
+		Format,
+		// Written undecoded; read with tools/decodelog.py.
+		File
+	};
+
+	// A directory or .avar archive mounted into the
+	// FileManager at a virtual path.
+	struct MountConfig
+	{
+		std::string point;
+		std::string path;
+	};
+
+	// Options an App can request before the engine brings up
+	// its subsystems. See App::GetEngineConfig().
+	struct EngineConfig
+	{
+		WindowDesc window;
+		// No display needed: the window stays hidden, frames
+		// go to an offscreen framebuffer of the window's size
+		// (see VegamWindow::SetFrameReadback()), vsync is
+		// ignored and controllers are off. Set by
+		// --headless.
+		bool headless = false;
+		// Dedicated server: no window, GL context, ImGui,
+		// input, audio or assets. Only the update graph runs,
+		// App::Render() never does, and the main thread
+		// sleeps until the next tick is due. Set by --server,
+		// and by default in Server builds.
+#ifdef AV_CONFIG_SERVER
+		bool server = true;
+#else
+		bool server = false;
+#endif // AV_CONFIG_SERVER
+
+		// App::Update() runs at this fixed rate in Hz,
+		// independent of the frame rate; events are pumped
+		// once per frame and reach the update they fall in
+		// (see Input::InputQueue). A frame runs at most
+		// maxUpdatesPerFrame updates and drops the rest of
+		// the backlog, so a long stall cannot spiral.
+		double tickRate = 60.0;
+		uint32_t maxUpdatesPerFrame = 8;
+		// Lockstep and rollback games (see Net::Rollback):
+		// App::Update() must give the same results on every
+		// machine and every re-simulation. Ticks that fall
+		// behind are caught up later rather than dropped,
+		// so the tick count follows wall time; the
+		// floating-point environment is pinned (see
+		// Core::FloatEnv) and asserted every tick; and
+		// renderOnDemand is off. Set by --deterministic.
+		bool deterministic = false;
+
+		// Frame rate cap in Hz on top of vsync; 0 means
+		// uncapped. While the window is minimized or out of
+		// focus the cap is backgroundFrameRate instead.
+		double maxFrameRate = 0.0;
+		double backgroundFrameRate = 10.0;
+		// Frames the GPU may fall behind the CPU before the
+		// GL thread waits on a fence, 1 to 4; fewer frames
+		// queued means less input latency. 0 leaves it to the
+		// driver. See RenderManager::SetMaxFramesInFlight().
+		uint32_t maxFramesInFlight = 0;
+
+		// Only run a frame when input arrives, a redraw is
+		// requested, the app is animating or uploads are in
+		// flight (see Engine::RequestRedraw()). Otherwise the
+		// main thread blocks on the event queue, waking every
+		// idleTimeoutMs to look for requests. Time spent idle
+		// is not simulated.
+		bool renderOnDemand = false;
+		int idleTimeoutMs = 250;
+
+		// Run GL submission on a dedicated render thread so
+		// Update() of frame N+1 overlaps rendering frame N.
+		// The GL context belongs to the render thread between
+		// App::Initialize() and App::Shutdown(): GL resources
+		// must be created and destroyed in those two, and
+		// App::Render() may only record render commands.
+		bool renderThread = false;
+		// Give Engine::GetLoaderThread() a GL context of its
+		// own, shared with the window's, so its jobs create
+		// and upload GL resources off the GL thread. Without
+		// it, jobs run on the GL thread between frames.
+		bool loaderThread = false;
+
+		// Committed to each of the two frame arena buffers
+		// up front (see Core::FrameArena); frames needing
+		// more commit it, up to frameArenaReserve.
+		size_t frameArenaSize = 4 << 20;
+		size_t frameArenaReserve = size_t(256) << 20;
+		// Backs the frame arena with 2 MB pages where the OS
+		// has them (see Core::VirtualArena).
+		bool frameArenaLargePages = false;
+
+		// ImGui overlay. Without it no ImGui context is
+		// created, and frames never touch ImGui.
+#ifdef AV_CONFIG_SHIPPING
+		bool imgui = false;
+#else
+		bool imgui = true;
+#endif // AV_CONFIG_SHIPPING
+		// Without input, the UI is rebuilt at most this
+		// often; frames in between draw the previous
+		// frame's draw data again. 0 rebuilds every frame.
+		uint32_t uiRefreshMs = 100;
+
+		// Frame times, render counters and memory per tag
+		// in an ImGui overlay; F10 toggles it.
+		bool showPerformanceHud = true;
+
+		// Frames written by a profile capture, started with
+		// F11 or the --profile-capture[=frames] command-line
+		// flag. Not available in Shipping builds.
+		uint32_t profileCaptureFrames = 300;
+		// Flushes recorded by --render-capture=<path> for
+		// replay (see Graphics::FrameCapture). Not available
+		// in Shipping builds.
+		uint32_t renderCaptureFlushes = 60;
+		// Frames over hitchMultiple times the median and
+		// over hitchMinimumMs write the last
+		// hitchHistorySeconds of profiler zones to a trace
+		// in hitchCaptureDirectory (see
+		// Core::Profiler::SetHitchCapture); empty, the
+		// default, disables it. --hitch-capture[=directory]
+		// enables it. Not available in Shipping builds.
+		std::string hitchCaptureDirectory;
+		// Field frame-time and memory reports (see
+		// Core::Telemetry) are spooled here, for the
+		// uploader the game sets; empty, the default,
+		// disables telemetry. Windowed runs only.
+		std::string telemetryDirectory;
+		float hitchMultiple = 2.0f;
+		float hitchMinimumMs = 20.0f;
+		float hitchHistorySeconds = 5.0f;
+
+		// Per-tick input is written to inputRecordPath, or
+		// read back from inputReplayPath instead of the
+		// devices, quitting when it runs out. Set by the
+		// --record-input=path and --replay-input=path flags;
+		// empty paths disable either.
+		std::string inputRecordPath;
+		std::string inputReplayPath;
+
+		// Log calls only queue the message; a background
+		// thread formats and writes it. With logQueueSize
+		// messages waiting, logOverflow decides whether the
+		// caller waits or the oldest message is dropped.
+		// Fatal messages are always written synchronously.
+		bool asyncLogging = true;
+		size_t logQueueSize = 8192;
+		LogOverflow logOverflow = LogOverflow::DropOldest;
+		// Log sinks, each with its own level. The file sink
+		// rotates through logFileCount files of up to
+		// logFileMaxSize bytes and is off while logFilePath
+		// is empty. The panel sink feeds the HUD's Log
+		// window. The crash ring keeps the last
+		// crashLogLines messages in memory and writes them
+		// to crashLogPath when an assert or a fatal signal
+		// fires; other sinks flush only errors right away.
+		LogLevel consoleLogLevel = LogLevel::Info;
+		std::string logFilePath;
+		LogLevel fileLogLevel = LogLevel::Trace;
+		size_t logFileMaxSize = 8 << 20;
+		uint32_t logFileCount = 3;
+		LogLevel panelLogLevel = LogLevel::Info;
+		LogLevel crashLogLevel = LogLevel::Info;
+		uint32_t crashLogLines = 256;
+		std::string crashLogPath = "CrashLog.txt";
+
+		// Deferred formatting for VEGAM_TRACE and
+		// VEGAM_DEBUG; --binary-log[=path] selects File.
+		BinaryLogMode binaryLog = BinaryLogMode::Off;
+		std::string binaryLogPath = "Log.avlog";
+
+		// Open game controllers. Starting SDL's controller
+		// subsystem enumerates devices, which delays startup
+		// on some platforms; tools can turn it off.
+		bool controllers = true;
+		// Further SDL_INIT_* flags to start with the engine,
+		// e.g. SDL_INIT_AUDIO for apps using SDL audio.
+		// Engine::InitSubsystem() starts them later instead.
+		uint32_t sdlSubsystems = 0;
+
+		// Controllers are sampled this many times a second
+		// on an input thread, e.g. 1000 for high refresh
+		// rates; 0 samples them on the main thread once per
+		// tick.
+		uint32_t controllerSampleRate = 0;
+
+		// JobManager workers; 0 means one per core besides
+		// the main thread.
+		uint32_t workerThreads = 0;
+
+		// Linked shader programs are cached here so later
+		// launches skip compiling. Empty disables the cache.
+		std::string shaderCacheDirectory = "ShaderCache";
+		// Log of the pipelines drawn, read at startup and
+		// written back at shutdown when "r.recordPipelines"
+		// added any; RenderManager::RequestPipelineWarmup()
+		// draws them ahead. Empty disables it.
+		std::string pipelineLog = "pipelines.bin";
+
+		// Shaders from ResourceManager::CreateShaderFromFiles()
+		// are recompiled when their files change, checked
+		// every shaderWatchIntervalMs.
+#ifdef AV_CONFIG_SHIPPING
+		bool shaderHotReload = false;
+#else
+		bool shaderHotReload = true;
+#endif // AV_CONFIG_SHIPPING
+		uint32_t shaderWatchIntervalMs = 250;
+		// Meshes and textures the AssetManager streams are
+		// re-cooked from their sources below
+		// assetSourceRoot when those change (see
+		// AssetManager::EnableHotReload()); empty disables
+		// it.
+		std::string assetSourceRoot;
+		std::string assetCookCommand = "python3 tools/cook.py";
+		uint32_t assetWatchIntervalMs = 500;
+		// Shader pack from "cli.py cookshaders" that
+		// CreateShaderFromFiles() reads stages from; empty
+		// reads the files.
+#ifdef AV_CONFIG_SHIPPING
+		std::string shaderPack = "shaders.avsp";
+#else
+		std::string shaderPack;
+#endif // AV_CONFIG_SHIPPING
+
+		// Cull multi-draw batches on the GPU (see
+		// RenderManager::SetGpuCullingEnabled()). Raises the
+		// requested GL context to 4.3 if the window asks for
+		// less.
+		bool gpuCulling = false;
+
+		// Render the scene at a resolution scaled each frame
+		// to keep its GPU time under this many milliseconds,
+		// then upscale it to the window; 0 renders at full
+		// resolution. The scale stays at or above
+		// minResolutionScale. See Graphics::DynamicResolution.
+		float dynamicResolutionMs = 0.0f;
+		float minResolutionScale = 0.5f;
+
+		// Render the scene in half float, with bloom, and
+		// tonemap it for display (see Graphics::HdrPipeline).
+		// Without temporal upscaling it takes the place of
+		// dynamic resolution, which is then ignored. Raises
+		// the requested GL context to 4.3 like gpuCulling.
+		bool hdr = false;
+
+		// Render the scene jittered below the display
+		// resolution and reconstruct it over frames (see
+		// Graphics::TemporalUpscaler); the app jitters its
+		// projection and writes motion vectors. Renders at
+		// upscalingScale, or at the dynamic resolution's
+		// scale if that is on. Raises the requested GL
+		// context to 4.3 like gpuCulling.
+		bool temporalUpscaling = false;
+		float upscalingScale = 0.67f;
+
+		// GL thread time per frame spent staging meshes
+		// created with ResourceManager::CreateMeshAsync().
+		double meshUploadBudgetMs = 2.0;
+
+		// Threads reading assets for the AssetManager. They
+		// mostly wait on storage, so a few suffice.
+		uint32_t assetIoThreads = 2;
+
+		// Mounted into the FileManager at startup, in
+		// order, so later ones win; paths ending in .avar
+		// mount archives, others directories. The shader
+		// pack and the AssetManager's packs and archives
+		// are found in the mounted directories.
+		std::vector<MountConfig> mounts;
+		// Threads serving FileManager::ReadAsync().
+		uint32_t fileIoThreads = 1;
+
+		// Core::CVar values, one "name value" per line, read
+		// at startup if the file exists; +name=value
+		// command-line arguments override them. Set by
+		// --config=path; empty skips the file.
+		std::string cvarConfigPath = "Engine.cfg";
+
+		// Open an audio device for the AudioManager, at
+		// audioSampleRate Hz mixing audioBufferFrames frames
+		// per callback; smaller buffers lower the latency
+		// and raise the risk of glitches. Off when
+		// headless.
+		bool audio = true;
+		uint32_t audioSampleRate = 48000;
+		uint32_t audioBufferFrames = 512;
+	};
+} // namespace AthiVegam
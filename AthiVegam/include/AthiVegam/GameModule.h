@@ -0,0 +1,96 @@
+#pragma once
+
+#include "AthiVegam/App.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+// Symbols a game module exports; Main.h defines them
+// when AV_GAME_MODULE_LIBRARY is.
+#if defined(AV_PLATFORM_WINDOWS)
+#define VEGAM_MODULE_EXPORT extern "C" __declspec(dllexport)
+#else
+#define VEGAM_MODULE_EXPORT                                 \
+	extern "C" __attribute__((visibility("default")))
+#endif
+
+namespace AthiVegam
+{
+	// Runs the App of a game module: the game's sources
+	// built as a shared library (premake5 --game-module)
+	// instead of into the executable, which links only the
+	// engine and Main.h. The library's symbols bind to the
+	// engine in the executable, so there is one engine.
+	//
+	// The library is copied aside before it is loaded,
+	// leaving it free to be rebuilt. Once it is, the next
+	// Update() loads the new copy, moves the App's state
+	// across (see App::SaveState()) and unloads the old
+	// one; a build that fails to load keeps the old App
+	// running. Gameplay code changes then cost a build of
+	// the module rather than a relink and restart.
+	class GameModule : public App
+	{
+	  public:
+		using CreateFunction = App* (*)();
+		using DestroyFunction = void (*)(App*);
+
+		// A bare name, such as "ParuguGame", is found next
+		// to the executable with the platform's prefix and
+		// extension.
+		explicit GameModule(std::string path);
+		~GameModule() override;
+
+		GameModule(const GameModule&) = delete;
+		GameModule& operator=(const GameModule&) = delete;
+
+		EngineConfig GetEngineConfig() const override;
+		void Initialize() override;
+		void Shutdown() override;
+		void Update(float deltaTime) override;
+		void Render(float alpha) override;
+
+		inline bool IsLoaded() const { return m_app != nullptr; }
+		// Times the module was reloaded.
+		inline auto GetReloadCount() const
+		{
+			return m_reloadCount;
+		}
+
+		// How often the library is checked for a rebuild.
+		static constexpr std::chrono::milliseconds
+		    CheckInterval{500};
+
+	  private:
+		struct Library
+		{
+			void* handle = nullptr;
+			std::filesystem::path copy;
+			App* app = nullptr;
+			DestroyFunction destroy = nullptr;
+		};
+
+		bool Load(Library& library, std::string& error);
+		static void Unload(Library& library);
+		bool IsRebuilt();
+		void Reload();
+
+	  private:
+		std::string m_path;
+		Library m_library;
+		App* m_app = nullptr;
+		// Reported once logging is up.
+		std::string m_loadError;
+		// Of the build loaded or last tried, and of a newer
+		// one waiting to settle for a check, as the linker
+		// may still be writing it.
+		std::filesystem::file_time_type m_loadedTime{};
+		std::filesystem::file_time_type m_pendingTime{};
+		std::chrono::steady_clock::time_point m_nextCheck{};
+		uint32_t m_reloadCount = 0;
+		uint32_t m_copyCount = 0;
+	};
+} // namespace AthiVegam
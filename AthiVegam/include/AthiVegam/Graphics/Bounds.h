@@ -0,0 +1,48 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Uniform.h"
+#include "AthiVegam/Graphics/VertexLayout.h"
+
+#include <cstdint>
+#include <limits>
+
+namespace AthiVegam::Graphics
+{
+	struct BoundingSphere
+	{
+		Float3 center{0.0f, 0.0f, 0.0f};
+		float radius = 0.0f;
+	};
+
+	// Axis-aligned box. Meshes whose positions can't be
+	// read get Infinite(), which no frustum culls.
+	struct Aabb
+	{
+		Float3 min{0.0f, 0.0f, 0.0f};
+		Float3 max{0.0f, 0.0f, 0.0f};
+
+		static constexpr Aabb Infinite()
+		{
+			constexpr auto inf =
+			    std::numeric_limits<float>::infinity();
+			return {{-inf, -inf, -inf}, {inf, inf, inf}};
+		}
+
+		BoundingSphere GetSphere() const;
+	};
+
+	// Bounds of the Float2-4 positions at location 0;
+	// Infinite() for other formats.
+	Aabb ComputeBounds(const VertexLayout& layout,
+	                   const void* vertexData,
+	                   uint32_t vertexCount);
+
+	// Into the space of a column-major transform such as
+	// RenderCommands::InstanceTransform, scaled by its
+	// largest axis.
+	BoundingSphere Transform(const BoundingSphere& sphere,
+	                         const float matrix[16]);
+	// The box around the transformed box; Infinite()
+	// stays infinite.
+	Aabb Transform(const Aabb& box, const float matrix[16]);
+} // namespace AthiVegam::Graphics
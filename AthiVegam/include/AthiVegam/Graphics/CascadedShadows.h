@@ -0,0 +1,184 @@
+#pragma once
+
+#include "AthiVegam/Math/Matrix.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+namespace AthiVegam::Graphics
+{
+	class FrameGraph;
+
+	// Cascaded shadow maps of a directional light, one
+	// layer of a depth texture array per cascade. Each
+	// cascade is fit to the bounding sphere of its slice
+	// of the view frustum, so its size never changes as
+	// the camera turns, and its origin snaps to whole
+	// texels, so edges don't shimmer as the camera moves.
+	//
+	// Distant cascades are cached: they are fit with a
+	// margin and keep their matrix until the camera leaves
+	// it or the light turns. Their static casters are then
+	// rendered once into a cache; every frame the cache is
+	// copied in and only dynamic casters are drawn on top.
+	//
+	// Passes render through a FrameGraph. GL 4.3, GL
+	// thread only.
+	class CascadedShadows
+	{
+	  public:
+		static constexpr uint32_t MaxCascades = 4;
+		// Uniform block binding of the Shadows block, past
+		// Shader::MaterialConstantsBinding.
+		static constexpr uint32_t ShadowsBinding = 2;
+		// Unit the shadow map is sampled from, past any
+		// material texture set.
+		static constexpr uint32_t ShadowMapUnit = 14;
+
+		struct Settings
+		{
+			uint32_t cascadeCount = 4;
+			int resolution = 2048;
+			// View depth the last cascade ends at.
+			float distance = 100.0f;
+			// Blend of logarithmic (1) and uniform (0)
+			// splits.
+			float splitLambda = 0.75f;
+			// Cascades from this one on are cached;
+			// cascadeCount caches none.
+			uint32_t firstCachedCascade = 2;
+			// Radius cached cascades are grown by, as a
+			// fraction; larger ones re-render less often
+			// at a lower resolution.
+			float cacheMargin = 0.25f;
+			// Distance towards the light casters are kept
+			// from, beyond the cascade's sphere.
+			float casterDistance = 100.0f;
+			// Subtracted from the fragment's depth in the
+			// map, in [0, 1].
+			float depthBias = 0.0005f;
+			// Fragments are moved this many texels along
+			// their normal before the lookup.
+			float normalOffset = 1.5f;
+		};
+
+		enum class Casters : uint8_t
+		{
+			All,
+			Static,
+			Dynamic
+		};
+
+		// What a draw callback renders: the casters of a
+		// kind, depth only, with a column-major
+		// view-projection.
+		struct CasterPass
+		{
+			uint32_t cascade;
+			Casters casters;
+			const float* viewProjection;
+		};
+		using DrawFunction =
+		    std::function<void(const CasterPass&)>;
+
+		CascadedShadows();
+		explicit CascadedShadows(const Settings& settings);
+		~CascadedShadows();
+
+		CascadedShadows(const CascadedShadows&) = delete;
+		CascadedShadows&
+		operator=(const CascadedShadows&) = delete;
+
+		// False without GL 4.3.
+		bool Initialize();
+		void Shutdown();
+		inline bool IsInitialized() const
+		{
+			return m_shadowMap != 0;
+		}
+
+		// Fits the cascades to a camera: its column-major
+		// view and symmetric perspective projection, its
+		// near plane, and the direction the light travels.
+		void Update(const float view[16],
+		            const float projection[16], float zNear,
+		            const Math::Vec3& lightDirection);
+		// Static casters moved or changed; cached cascades
+		// render them again.
+		void InvalidateStatic();
+
+		// Adds the passes rendering the cascades that need
+		// it this frame; draw is called from them.
+		void AddPasses(FrameGraph& graph,
+		               const DrawFunction& draw);
+		// Uploads the Shadows block and binds it and the
+		// shadow map for the frame's shading.
+		void Bind();
+
+		inline uint32_t GetShadowMap() const
+		{
+			return m_shadowMap;
+		}
+		inline const Math::Mat4&
+		GetViewProjection(uint32_t cascade) const
+		{
+			return m_cascades[cascade].viewProjection;
+		}
+		// View depth the cascade ends at.
+		inline float GetSplit(uint32_t cascade) const
+		{
+			return m_cascades[cascade].split;
+		}
+		// Cascades the last AddPasses() drew static
+		// casters into.
+		inline uint32_t GetStaticRenders() const
+		{
+			return m_staticRenders;
+		}
+
+	  private:
+		struct Cascade
+		{
+			Math::Mat4 viewProjection;
+			float split = 0.0f;
+			// World units per texel.
+			float texelSize = 0.0f;
+			// The sphere the matrix was fit to.
+			Math::Vec3 center;
+			float radius = 0.0f;
+			// Cached cascades: whether the cache holds this
+			// matrix's static casters.
+			bool staticValid = false;
+		};
+
+		bool IsCached(uint32_t cascade) const
+		{
+			return cascade >= m_settings.firstCachedCascade;
+		}
+		void Fit(Cascade& cascade, const Math::Vec3& center,
+		         float radius);
+
+	  private:
+		Settings m_settings;
+		std::array<Cascade, MaxCascades> m_cascades;
+		Math::Vec3 m_lightDirection;
+		// Third row of the camera's view, giving -depth.
+		std::array<float, 4> m_viewDepthRow{};
+		uint32_t m_staticRenders = 0;
+
+		uint32_t m_shadowMap = 0;
+		// Static casters of the cached cascades, from the
+		// first on.
+		uint32_t m_staticCache = 0;
+		uint32_t m_constantsBuffer = 0;
+	};
+
+	// GLSL to insert after the #version 430 line of
+	// fragment shaders receiving shadows. Declares the
+	// Shadows block and CascadedShadow(worldPosition,
+	// normal), the lit fraction of a fragment with 3x3
+	// percentage-closer filtering; 1 past the last
+	// cascade.
+	extern const char* CascadedShadowsShaderSource;
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,293 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Uniform.h"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace AthiVegam::Managers
+{
+	class JobManager;
+}
+
+namespace AthiVegam::Graphics
+{
+	// std430, two vec4s.
+	struct PointLight
+	{
+		Float3 position;
+		// Distance at which the light fades out entirely.
+		float radius = 1.0f;
+		Float3 color{1.0f, 1.0f, 1.0f};
+		float intensity = 1.0f;
+	};
+
+	// A box projected onto the surfaces inside it, along
+	// its z axis, in the forward pass instead of as a
+	// draw of its own.
+	struct Decal
+	{
+		// Column-major, placing the unit cube around the
+		// origin in the world.
+		float transform[16] = {1, 0, 0, 0, 0, 1, 0, 0,
+		                       0, 0, 1, 0, 0, 0, 0, 1};
+		// Offset and size in the layer.
+		Float4 uvRect{0.0f, 0.0f, 1.0f, 1.0f};
+		Float4 color{1.0f, 1.0f, 1.0f, 1.0f};
+		// Of the texture array SetDecalTextures() binds.
+		uint32_t layer = 0;
+		// Cosine between the surface normal and the z axis
+		// below which the decal fades out.
+		float normalFade = 0.2f;
+	};
+
+	// std430, five vec4s. Irradiance and, optionally, a
+	// reflection, blended by distance between the probes
+	// reaching a point.
+	struct LightProbe
+	{
+		Float3 position;
+		float radius = 10.0f;
+		// L1 spherical harmonics with the cosine lobe
+		// convolved in, per channel: E(n) = c.x +
+		// dot(c.yzw, n).
+		std::array<Float4, 3> irradiance{};
+		// Of the cube map array SetProbeTextures() binds;
+		// -1 for none.
+		int32_t reflectionLayer = -1;
+		float intensity = 1.0f;
+		// Mip levels of the reflection, spread over
+		// roughness 0 to 1.
+		float reflectionLevels = 0.0f;
+		// Part of the radius the probe fades out over.
+		float falloff = 0.2f;
+	};
+
+	// Clustered forward shading: the view frustum is cut
+	// into screen tiles and exponential depth slices, and
+	// every cluster lists the lights, decals and probes
+	// whose bounding sphere reaches it. Shaders including
+	// ClusteredLightingShaderSource evaluate only their
+	// cluster's, so the cost per pixel follows what is
+	// nearby rather than all of it, and decals need no
+	// draw calls of their own.
+	//
+	// Build() assigns them on the CPU, one depth slice
+	// per job; Upload() and Bind() run on the GL thread
+	// and need GL 4.3 for the shader storage buffers.
+	class ClusteredLighting
+	{
+	  public:
+		static constexpr uint32_t TilesX = 16;
+		static constexpr uint32_t TilesY = 9;
+		static constexpr uint32_t Slices = 24;
+		static constexpr uint32_t ClusterCount =
+		    TilesX * TilesY * Slices;
+		// Further ones reaching a cluster are dropped.
+		static constexpr uint32_t MaxLightsPerCluster = 128;
+		static constexpr uint32_t MaxDecalsPerCluster = 32;
+		static constexpr uint32_t MaxProbesPerCluster = 8;
+		// Shader storage bindings, after GpuCulling's, and
+		// past MaterialTable's draw data.
+		static constexpr uint32_t LightsBinding = 7;
+		static constexpr uint32_t ClustersBinding = 8;
+		static constexpr uint32_t IndicesBinding = 9;
+		static constexpr uint32_t DecalsBinding = 22;
+		static constexpr uint32_t ProbesBinding = 23;
+		// Texture units, past VirtualTexture's.
+		static constexpr uint32_t DecalTextureUnit = 17;
+		static constexpr uint32_t ProbeTextureUnit = 18;
+
+		// What Build() bins; it copies them.
+		struct Contents
+		{
+			std::span<const PointLight> lights;
+			std::span<const Decal> decals;
+			std::span<const LightProbe> probes;
+		};
+
+		// A cluster's run of GetIndices(): its lights, then
+		// its decals, then its probes, each in the order
+		// given.
+		struct Cell
+		{
+			uint32_t offset;
+			uint32_t lights;
+			uint32_t decals;
+			uint32_t probes;
+		};
+
+		ClusteredLighting();
+		~ClusteredLighting();
+
+		ClusteredLighting(const ClusteredLighting&) = delete;
+		ClusteredLighting&
+		operator=(const ClusteredLighting&) = delete;
+
+		// GL thread. False without GL 4.3.
+		bool Initialize();
+		void Shutdown();
+		inline bool IsInitialized() const
+		{
+			return m_lightsBuffer != 0;
+		}
+
+		// Assigns the world-space lights to the clusters of
+		// a view: column-major view and symmetric
+		// perspective projection matrices, the depth range
+		// clusters span and the viewport size in pixels.
+		// Copies the lights.
+		void Build(const float view[16],
+		           const float projection[16], float zNear,
+		           float zFar, int width, int height,
+		           std::span<const PointLight> lights);
+		void Build(const float view[16],
+		           const float projection[16], float zNear,
+		           float zFar, int width, int height,
+		           const Contents& contents);
+		// Builds the slices as jobs.
+		void Build(const float view[16],
+		           const float projection[16], float zNear,
+		           float zFar, int width, int height,
+		           std::span<const PointLight> lights,
+		           Managers::JobManager& jobs);
+		void Build(const float view[16],
+		           const float projection[16], float zNear,
+		           float zFar, int width, int height,
+		           const Contents& contents,
+		           Managers::JobManager& jobs);
+
+		// GL thread. Uploads the last Build() and binds the
+		// buffers for the frame's draws.
+		void Upload();
+		void Bind() const;
+
+		// GL_TEXTURE_2D_ARRAY of Decal::layer, and
+		// GL_TEXTURE_CUBE_MAP_ARRAY of
+		// LightProbe::reflectionLayer, as
+		// ReflectionProbes keeps; Bind() binds them to
+		// their units. 0 for none.
+		inline void SetDecalTextures(uint32_t texture)
+		{
+			m_decalTextures = texture;
+		}
+		inline void SetProbeTextures(uint32_t texture)
+		{
+			m_probeTextures = texture;
+		}
+
+		// As of the last Build(); x and y from the
+		// bottom-left tile, z from the near slice.
+		inline Cell GetCell(uint32_t x, uint32_t y,
+		                    uint32_t z) const
+		{
+			return m_cells[(z * TilesY + y) * TilesX + x];
+		}
+		// Into the lights, decals or probes, by their place
+		// in the cell's run.
+		inline std::span<const uint32_t> GetIndices() const
+		{
+			return m_indices;
+		}
+		// Cluster entries dropped by the limits per
+		// cluster.
+		inline uint32_t GetOverflowCount() const
+		{
+			return m_overflow;
+		}
+
+	  private:
+		// std430 head of the clusters buffer, followed by
+		// the cells.
+		struct Header
+		{
+			float view[16];
+			uint32_t grid[4];
+			// zNear, and the scale and bias from log depth
+			// to slice.
+			float depth[4];
+			float viewport[4];
+		};
+
+		// std430, eight vec4s.
+		struct GpuDecal
+		{
+			float worldToDecal[16];
+			Float4 uvRect;
+			Float4 color;
+			// The z axis in the world, and the fade.
+			Float4 axisFade;
+			uint32_t layer;
+			uint32_t padding[3];
+		};
+
+		// Bounds in view space, depth positive into the
+		// screen: lights, then decals, then probes.
+		struct ViewSphere
+		{
+			float x, y, depth, radius;
+		};
+		// A sphere reaching a slice, and the tiles its
+		// bounds cover there.
+		struct Candidate
+		{
+			uint32_t sphere;
+			uint32_t x0, x1, y0, y1;
+		};
+
+		void Prepare(const float view[16],
+		             const float projection[16], float zNear,
+		             float zFar, int width, int height,
+		             const Contents& contents);
+		void BuildSlice(uint32_t slice);
+		void Finish();
+
+	  private:
+		Header m_header{};
+		float m_xScale = 1.0f;
+		float m_yScale = 1.0f;
+		// Slice boundaries, Slices + 1 of them.
+		std::array<float, Slices + 1> m_sliceDepths{};
+
+		std::vector<PointLight> m_lights;
+		std::vector<GpuDecal> m_decals;
+		std::vector<LightProbe> m_probes;
+		std::vector<ViewSphere> m_spheres;
+		std::vector<Cell> m_cells;
+		std::vector<uint32_t> m_indices;
+		// Per slice, offsets relative to the slice.
+		std::array<std::vector<uint32_t>, Slices> m_sliceIndices;
+		std::array<std::vector<Candidate>, Slices>
+		    m_sliceCandidates;
+		std::array<uint32_t, Slices> m_sliceOverflow{};
+		uint32_t m_overflow = 0;
+
+		uint32_t m_lightsBuffer = 0;
+		size_t m_lightsBufferSize = 0;
+		uint32_t m_clustersBuffer = 0;
+		size_t m_clustersBufferSize = 0;
+		uint32_t m_indicesBuffer = 0;
+		size_t m_indicesBufferSize = 0;
+		uint32_t m_decalsBuffer = 0;
+		size_t m_decalsBufferSize = 0;
+		uint32_t m_probesBuffer = 0;
+		size_t m_probesBufferSize = 0;
+		uint32_t m_decalTextures = 0;
+		uint32_t m_probeTextures = 0;
+	};
+
+	// GLSL to insert after the #version 430 line of
+	// fragment shaders using the lights. Declares the
+	// buffers and textures, and for the fragment's
+	// cluster:
+	//  - ClusteredLighting(worldPosition, normal, albedo)
+	//    sums the diffuse light;
+	//  - ClusteredDecals(worldPosition, normal, albedo)
+	//    blends the decals over the albedo, in order;
+	//  - ClusteredProbes(worldPosition, normal, reflected,
+	//    roughness, irradiance, reflection) blends the
+	//    probes' irradiance and reflections.
+	extern const char* ClusteredLightingShaderSource;
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "AthiVegam/Core/Memory.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	namespace RenderCommands
+	{
+		enum class CommandType : uint8_t;
+	}
+
+	// Linear, bump-allocated stream of POD render commands.
+	// Each command is stored as a small header carrying its
+	// type tag followed by the command payload. Reset()
+	// rewinds the stream but keeps the storage, so in steady
+	// state recording a frame performs no heap allocations.
+	class CommandBuffer
+	{
+	  public:
+		explicit CommandBuffer(
+		    size_t initialCapacity = 64 * 1024);
+
+		template <typename T>
+		uint32_t Push(const T& command)
+		{
+			static_assert(
+			    std::is_trivially_copyable_v<T>,
+			    "Render commands must be trivially "
+			    "copyable");
+			static_assert(alignof(T) <= Alignment,
+			              "Render command over-aligned");
+
+			const auto offset = Allocate(
+			    sizeof(Header) + sizeof(T));
+			Header header{T::Type};
+			std::memcpy(&m_data[offset], &header,
+			            sizeof(Header));
+			std::memcpy(&m_data[offset + sizeof(Header)],
+			            &command, sizeof(T));
+
+			return static_cast<uint32_t>(offset);
+		}
+
+		// Overwrites the command pushed at offset, which
+		// must be of the same type.
+		template <typename T>
+		void Replace(uint32_t offset, const T& command)
+		{
+			std::memcpy(&m_data[offset + sizeof(Header)],
+			            &command, sizeof(T));
+		}
+
+		inline RenderCommands::CommandType
+		GetType(uint32_t offset) const
+		{
+			Header header;
+			std::memcpy(&header, &m_data[offset],
+			            sizeof(Header));
+			return header.type;
+		}
+
+		inline const void* GetPayload(uint32_t offset) const
+		{
+			return &m_data[offset + sizeof(Header)];
+		}
+
+		inline void Reset() { m_head = 0; }
+		inline size_t GetSize() const { return m_head; }
+		inline size_t GetCapacity() const
+		{
+			return m_data.size();
+		}
+
+	  private:
+		static constexpr size_t Alignment = 16;
+
+		struct alignas(Alignment) Header
+		{
+			RenderCommands::CommandType type;
+		};
+
+		size_t Allocate(size_t size);
+
+	  private:
+		Core::Memory::Vector<std::byte,
+		                     Core::Memory::Tag::Render>
+		    m_data;
+		size_t m_head;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "AthiVegam/Graphics/CommandBuffer.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	// A recording of sort-keyed render commands plus the
+	// instance data they reference. A list is only ever
+	// written by one thread, so recording needs no locks;
+	// RenderManager merges all lists by sort key at Flush().
+	class CommandList
+	{
+	  public:
+		struct Entry
+		{
+			uint64_t key;
+			uint32_t offset;
+		};
+
+		template <typename T>
+		inline void Submit(const T& renderCommand)
+		{
+			Submit(renderCommand,
+			       RenderCommands::GetSortKey(renderCommand));
+		}
+
+		template <typename T>
+		inline void Submit(const T& renderCommand,
+		                   uint64_t sortKey)
+		{
+			m_entries.push_back(
+			    {sortKey, m_commands.Push(renderCommand)});
+		}
+
+		// For lists kept across frames (see RetainedList):
+		// overwrites an entry's command, of the same type,
+		// and its key.
+		template <typename T>
+		inline void Replace(uint32_t entry,
+		                    const T& renderCommand,
+		                    uint64_t sortKey)
+		{
+			m_entries[entry].key = sortKey;
+			m_commands.Replace(m_entries[entry].offset,
+			                   renderCommand);
+		}
+		// Moves the last entry into its place; the
+		// command's storage stays until Reset().
+		void EraseEntry(uint32_t entry);
+
+		// Copies per-instance data into the list and returns
+		// the index of the first instance, for use in
+		// RenderMesh::instance or
+		// RenderMeshInstanced::firstInstance. Indices are
+		// local to this list.
+		uint32_t PushInstances(
+		    const RenderCommands::InstanceTransform* transforms,
+		    uint32_t count);
+		// With each instance's draw data; the above gives
+		// them the defaults.
+		uint32_t PushInstances(
+		    const RenderCommands::InstanceTransform* transforms,
+		    const RenderCommands::DrawData* drawData,
+		    uint32_t count);
+
+		void SubmitInstanced(
+		    MeshHandle mesh, ShaderHandle shader,
+		    const RenderCommands::InstanceTransform* transforms,
+		    uint32_t count);
+
+		// Copies a draw's uniform block data into the list,
+		// for use in the command's constants. Offsets are
+		// local to this list. Data must follow std140 rules.
+		RenderCommands::Constants
+		PushConstants(const void* data, uint32_t size);
+		template <typename T>
+		inline RenderCommands::Constants
+		PushConstants(const T& constants)
+		{
+			return PushConstants(
+			    &constants, static_cast<uint32_t>(sizeof(T)));
+		}
+		// Instances pushed earlier, to rewrite them before
+		// the list is flushed.
+		inline RenderCommands::InstanceTransform*
+		MapInstances(uint32_t first)
+		{
+			return m_instances.data() + first;
+		}
+		// Data of constants pushed earlier, to rewrite them
+		// before the list is flushed.
+		inline void*
+		MapConstants(RenderCommands::Constants constants)
+		{
+			return m_constants.data() + constants.offset;
+		}
+
+		void Reset();
+
+		inline const CommandBuffer& GetCommands() const
+		{
+			return m_commands;
+		}
+		inline const auto& GetEntries() const
+		{
+			return m_entries;
+		}
+		inline const auto& GetInstances() const
+		{
+			return m_instances;
+		}
+		// One per instance.
+		inline const auto& GetDrawData() const
+		{
+			return m_drawData;
+		}
+		inline const auto& GetConstants() const
+		{
+			return m_constants;
+		}
+
+	  private:
+		template <typename T>
+		using Vector =
+		    Core::Memory::Vector<T, Core::Memory::Tag::Render>;
+
+		CommandBuffer m_commands;
+		Vector<Entry> m_entries;
+		Vector<RenderCommands::InstanceTransform> m_instances;
+		Vector<RenderCommands::DrawData> m_drawData;
+		Vector<uint8_t> m_constants;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// Compiles and links a single compute shader, named
+	// label in the log and the GPU resource inspector.
+	// Returns 0 on failure, after logging why. GL 4.3.
+	uint32_t CreateComputeProgram(const char* source,
+	                              const char* label);
+	// Unbinds the program if current and zeroes it; 0 is
+	// ignored.
+	void DeleteComputeProgram(uint32_t& program);
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace AthiVegam::Graphics
+{
+	// A linked compute program, the resource behind a
+	// ComputeShaderHandle that Dispatch and
+	// DispatchIndirect commands run. As with Shader, a
+	// uniform block named Constants is bound to
+	// Shader::ConstantsBinding, so PushConstants() data
+	// reaches it. GL 4.3, GL thread only.
+	class ComputeShader
+	{
+	  public:
+		// A failed compile leaves the shader not ready,
+		// after logging why; dispatches of it are skipped.
+		explicit ComputeShader(const std::string& source);
+		~ComputeShader();
+
+		ComputeShader(const ComputeShader&) = delete;
+		ComputeShader&
+		operator=(const ComputeShader&) = delete;
+
+		inline uint32_t GetId() const { return m_programId; }
+		inline bool IsReady() const { return m_programId != 0; }
+		// The local_size the source declares.
+		inline const auto& GetWorkGroupSize() const
+		{
+			return m_workGroupSize;
+		}
+		// Groups covering count invocations along x.
+		inline uint32_t GetGroupCount(uint32_t count) const
+		{
+			return (count + m_workGroupSize[0] - 1)
+			       / m_workGroupSize[0];
+		}
+
+	  private:
+		uint32_t m_programId = 0;
+		std::array<uint32_t, 3> m_workGroupSize{1, 1, 1};
+	};
+} // namespace AthiVegam::Graphics
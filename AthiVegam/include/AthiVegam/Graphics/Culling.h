@@ -0,0 +1,91 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Bounds.h"
+#include "AthiVegam/Graphics/Uniform.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Managers
+{
+	class JobManager;
+}
+
+namespace AthiVegam::Graphics
+{
+	class OcclusionBuffer;
+}
+
+namespace AthiVegam::Graphics
+{
+	// Six planes facing inwards, normalized, as
+	// (normal, distance) with dot(normal, p) + distance
+	// >= 0 inside.
+	struct Frustum
+	{
+		std::array<Float4, 6> planes;
+
+		// From a column-major view-projection matrix with
+		// GL's [-1, 1] clip depth. Spheres in world space
+		// test against the result.
+		static Frustum FromMatrix(const float matrix[16]);
+
+		bool Intersects(const BoundingSphere& sphere) const;
+	};
+
+	// Bounding spheres of the objects an app may draw,
+	// tested against a frustum before anything is
+	// submitted. Spheres are kept as a structure of arrays
+	// so several test per SIMD instruction: 16 or 8 where
+	// the CPU has AVX-512 or AVX2, else 4 with SSE2 or
+	// NEON, in 64-object blocks that jobs take in
+	// parallel.
+	//
+	// Ids stay valid until removed; storage stays dense,
+	// so culling cost follows the live object count.
+	class CullingSet
+	{
+	  public:
+		using ObjectId = uint32_t;
+
+		// Objects per block, one bit each in its mask.
+		static constexpr uint32_t BlockSize = 64;
+		// Blocks per job; smaller sets cull inline.
+		static constexpr uint32_t BlocksPerJob = 16;
+
+		ObjectId Add(const BoundingSphere& sphere);
+		void Update(ObjectId object, const BoundingSphere& sphere);
+		void Remove(ObjectId object);
+		void Clear();
+
+		inline uint32_t GetCount() const { return m_count; }
+
+		// Main thread or a job. Appends the ids of objects
+		// intersecting the frustum to visible, in storage
+		// order; with a finished occlusion buffer, only
+		// those it doesn't hide. With jobs, large sets are
+		// split across the workers.
+		void Cull(const Frustum& frustum,
+		          std::vector<ObjectId>& visible,
+		          Managers::JobManager* jobs = nullptr,
+		          const OcclusionBuffer* occlusion = nullptr);
+
+	  private:
+		void Store(uint32_t slot, const BoundingSphere& sphere);
+
+	  private:
+		// Padded to whole blocks with spheres no frustum
+		// contains.
+		std::vector<float> m_x;
+		std::vector<float> m_y;
+		std::vector<float> m_z;
+		std::vector<float> m_radius;
+		uint32_t m_count = 0;
+
+		std::vector<ObjectId> m_objects;
+		std::vector<uint32_t> m_slots;
+		std::vector<ObjectId> m_freeIds;
+		std::vector<uint64_t> m_masks;
+	};
+} // namespace AthiVegam::Graphics
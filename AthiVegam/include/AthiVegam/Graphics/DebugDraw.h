@@ -0,0 +1,95 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Bounds.h"
+#include "AthiVegam/Math/Matrix.h"
+#include "AthiVegam/Math/Vector.h"
+
+#include <array>
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	class CommandList;
+
+	// Immediate-mode lines for diagnostics, e.g. bounds or
+	// culling frusta. Shapes can be added from any thread
+	// during the update; each thread appends to a buffer
+	// of its own, and Flush() gathers them all into one
+	// instanced line draw for the frame. Nothing is kept
+	// past the flush.
+	//
+	// Compiled out of Release and Shipping builds: every
+	// function is then an empty inline.
+	namespace DebugDraw
+	{
+		using Color = std::array<float, 4>;
+		constexpr Color White{1.0f, 1.0f, 1.0f, 1.0f};
+
+		// One line, as its instance data.
+		struct LineInstance
+		{
+			float from[4];
+			float to[4];
+			float color[4];
+			float padding[4];
+		};
+
+#ifndef AV_CONFIG_RELEASE
+		// GL thread; RenderManager calls both.
+		void Initialize();
+		void Shutdown();
+
+		void Line(const Math::Vec3& from, const Math::Vec3& to,
+		          const Color& color = White);
+		void Box(const Aabb& box, const Color& color = White);
+		// The unit cube from -1 to 1 through transform.
+		void Box(const Math::Mat4& transform,
+		         const Color& color = White);
+		// Three great circles.
+		void Sphere(const Math::Vec3& center, float radius,
+		            const Color& color = White,
+		            uint32_t segments = 24);
+		// The frustum a view-projection sees, from its
+		// inverse.
+		void Frustum(const Math::Mat4& viewProjection,
+		             const Color& color = White);
+
+		// Main thread, once per frame after the update:
+		// submits every thread's lines as one draw to the
+		// render manager's command list of the calling
+		// thread, or to list, and empties the buffers.
+		void Flush(const Math::Mat4& viewProjection,
+		           bool depthTest = true);
+		void Flush(const Math::Mat4& viewProjection,
+		           CommandList& list, bool depthTest = true);
+
+		// Of the last Flush().
+		uint32_t GetLineCount();
+#else
+		inline void Initialize() {}
+		inline void Shutdown() {}
+		inline void Line(const Math::Vec3&, const Math::Vec3&,
+		                 const Color& = White)
+		{
+		}
+		inline void Box(const Aabb&, const Color& = White) {}
+		inline void Box(const Math::Mat4&, const Color& = White)
+		{
+		}
+		inline void Sphere(const Math::Vec3&, float,
+		                   const Color& = White, uint32_t = 24)
+		{
+		}
+		inline void Frustum(const Math::Mat4&,
+		                    const Color& = White)
+		{
+		}
+		inline void Flush(const Math::Mat4&, bool = true) {}
+		inline void Flush(const Math::Mat4&, CommandList&,
+		                  bool = true)
+		{
+		}
+		inline uint32_t GetLineCount() { return 0; }
+#endif // AV_CONFIG_RELEASE
+	} // namespace DebugDraw
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "AthiVegam/Graphics/RenderTarget.h"
+
+#include <array>
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// Renders the scene at a fraction of the display size,
+	// chosen each frame from how long the GPU took on the
+	// frames before, and upscales it for display. The
+	// scene's GPU time is measured with GL_TIME_ELAPSED
+	// queries read a few frames late, so it never stalls.
+	//
+	// The target is allocated once at the display size
+	// times maxScale and the scene renders into its
+	// bottom-left corner, so changing the scale never
+	// reallocates. GL thread only.
+	class DynamicResolution
+	{
+	  public:
+		// Queries in flight; results are read this many
+		// frames late at most.
+		static constexpr uint32_t FrameLatency = 3;
+
+		struct Settings
+		{
+			// GPU time per frame to stay under.
+			float targetMs = 16.0f;
+			// Fraction of targetMs kept free for what
+			// follows the scene, e.g. the UI.
+			float headroom = 0.1f;
+			float minScale = 0.5f;
+			float maxScale = 1.0f;
+			// Scales are multiples of this, so small
+			// timing noise doesn't resize every frame.
+			float step = 0.05f;
+			// Frames with time to spare before the scale
+			// rises one step. It drops at once, as a missed
+			// frame costs more than a soft one.
+			uint32_t raiseFrames = 30;
+			// The scene renders into a target of the
+			// caller's, e.g. TemporalUpscaler's: no target
+			// is allocated, BeginFrame() binds nothing and
+			// EndFrame() takes the place of Resolve().
+			bool externalTarget = false;
+		};
+
+		DynamicResolution();
+		explicit DynamicResolution(const Settings& settings);
+		~DynamicResolution();
+
+		DynamicResolution(const DynamicResolution&) = delete;
+		DynamicResolution&
+		operator=(const DynamicResolution&) = delete;
+
+		void Shutdown();
+
+		// Reallocates the target for a display size. Until
+		// then, a display larger than the last one renders
+		// at no more than the target holds.
+		bool Resize(int displayWidth, int displayHeight);
+		// Reads finished queries, updates the scale, starts
+		// timing the frame and binds the target with a
+		// viewport of the render size. Allocates the target
+		// on first use.
+		bool BeginFrame(int displayWidth, int displayHeight);
+		// Binds the target again, e.g. after drawing to
+		// another window.
+		void Bind() const;
+		// Stops timing and upscales the frame into the
+		// display framebuffer, which is left bound with a
+		// viewport covering it.
+		void Resolve(uint32_t displayFramebuffer);
+		// Stops timing the frame.
+		void EndFrame();
+
+		inline uint32_t GetFramebuffer() const
+		{
+			return m_target.GetId();
+		}
+		inline float GetScale() const { return m_scale; }
+		inline int GetRenderWidth() const
+		{
+			return m_renderWidth;
+		}
+		inline int GetRenderHeight() const
+		{
+			return m_renderHeight;
+		}
+		// Scene GPU time of the last frame measured, in
+		// milliseconds.
+		inline float GetGpuMs() const { return m_gpuMs; }
+
+		inline const Settings& GetSettings() const
+		{
+			return m_settings;
+		}
+		void SetTargetMs(float targetMs);
+
+	  private:
+		void ReadQueries();
+		void UpdateScale(float gpuMs);
+
+	  private:
+		Settings m_settings;
+		RenderTarget m_target;
+		int m_displayWidth = 0;
+		int m_displayHeight = 0;
+		int m_renderWidth = 0;
+		int m_renderHeight = 0;
+		float m_scale = 1.0f;
+		float m_gpuMs = 0.0f;
+		uint32_t m_spareFrames = 0;
+
+		std::array<uint32_t, FrameLatency> m_queries{};
+		std::array<bool, FrameLatency> m_pending{};
+		uint32_t m_frameIndex = 0;
+		bool m_timing = false;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Bounds.h"
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Graphics/Uniform.h"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace AthiVegam::Managers
+{
+	class ResourceManager;
+}
+
+namespace AthiVegam::Graphics
+{
+	class CommandList;
+
+	// A plant as placed in a cell, in world space.
+	struct FoliageInstance
+	{
+		Float3 position{0.0f, 0.0f, 0.0f};
+		// Radians around +y.
+		float yaw = 0.0f;
+		float scale = 1.0f;
+	};
+
+	// One kind of vegetation, in the millions: instances
+	// live per square cell of the ground in a single
+	// storage buffer, quantized to 8 bytes each against
+	// their cell's bounds. Every frame the CPU only tests
+	// cells against the frustum; a compute pass then
+	// scatters the instances of the visible ones,
+	// dropping those outside the frustum, past the last
+	// level's distance or thinned out by the density, and
+	// appends the transforms of the rest to the slice of
+	// the level their distance picks. Each level draws
+	// its slice with one indirect draw whose instance
+	// count the pass wrote, with the shader and instance
+	// layout of a RenderMeshInstanced.
+	//
+	// The r.foliageDensity quality setting thins every
+	// cell evenly without touching the stored instances.
+	//
+	// Draw() records from any thread, showing the last
+	// Cull() before it executes; the rest is GL 4.3, GL
+	// thread only.
+	class Foliage
+	{
+	  public:
+		static constexpr uint32_t MaxLevels = 4;
+
+		struct Level
+		{
+			// Indexed; drawn with the shader and material
+			// below.
+			MeshHandle mesh;
+			// Instances nearer than this, and past the
+			// previous level's, draw with this mesh.
+			float distance = 0.0f;
+		};
+
+		struct Settings
+		{
+			// World units per side of a cell; cell (x, y)
+			// spans [x, x + 1) * cellSize in world x and z.
+			float cellSize = 32.0f;
+			uint32_t maxCells = 1024;
+			// Instances a cell holds; more are dropped.
+			uint32_t cellCapacity = 8192;
+			// Instances each level draws at most per frame.
+			uint32_t maxVisible = 1u << 17;
+			// Range scales are quantized over.
+			float minScale = 0.5f;
+			float maxScale = 2.0f;
+			// Nearest first, by increasing distance; the
+			// first without a mesh ends the chain. The
+			// first level's bounds cull every level.
+			std::array<Level, MaxLevels> levels{};
+			ShaderHandle shader;
+			MaterialHandle material;
+		};
+
+		explicit Foliage(const Settings& settings);
+		~Foliage();
+
+		Foliage(const Foliage&) = delete;
+		Foliage& operator=(const Foliage&) = delete;
+
+		// Compiles the passes and allocates the buffers;
+		// false without GL 4.3.
+		bool Initialize();
+		void Shutdown();
+		inline bool IsInitialized() const
+		{
+			return m_scatterProgram != 0;
+		}
+
+		// Replaces the instances of cell (x, y); those
+		// outside it are clamped to its edges. False when
+		// every cell is taken.
+		bool SetCell(int32_t x, int32_t y,
+		             std::span<const FoliageInstance> instances);
+		void RemoveCell(int32_t x, int32_t y);
+		void Clear();
+
+		// Scatters the visible instances for a
+		// column-major view-projection seen from eye. Call
+		// before the frame's draws.
+		void Cull(const Managers::ResourceManager& resources,
+		          const float viewProjection[16],
+		          const Float3& eye);
+
+		// Records a DrawFoliage command per level that
+		// the last Cull() found ready, with optional
+		// constants from PushConstants().
+		void Draw(
+		    CommandList& list,
+		    RenderCommands::Constants constants = {}) const;
+
+		inline uint32_t GetCellCount() const
+		{
+			return static_cast<uint32_t>(m_cells.size());
+		}
+		inline const Settings& GetSettings() const
+		{
+			return m_settings;
+		}
+
+	  private:
+		struct Cell
+		{
+			int32_t x, y;
+			uint32_t slot;
+			uint32_t count;
+			// Heights the instances are quantized over.
+			float minY, maxY;
+		};
+
+		static uint64_t Key(int32_t x, int32_t y);
+		uint32_t GetLevelCount() const;
+
+	  private:
+		Settings m_settings;
+		std::unordered_map<uint64_t, Cell> m_cells;
+		std::vector<uint32_t> m_freeSlots;
+		// Mesh space, of the first level's mesh; radius 0
+		// until Cull() finds it ready.
+		BoundingSphere m_bounds;
+
+		uint32_t m_scatterProgram = 0;
+		uint32_t m_clampProgram = 0;
+		// The quantized instances, cellCapacity per slot.
+		uint32_t m_instanceBuffer = 0;
+		uint32_t m_cellBuffer = 0;
+		size_t m_cellBufferSize = 0;
+		// InstanceTransforms, maxVisible per level.
+		uint32_t m_visibleBuffer = 0;
+		// A DrawElementsIndirect per level.
+		uint32_t m_argsBuffer = 0;
+		// Levels whose mesh the last Cull() found ready.
+		std::array<bool, MaxLevels> m_ready{};
+		std::vector<uint32_t> m_staging;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Handle.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	class SpriteBatch;
+
+	struct TextStyle
+	{
+		// Line height in the batch's units, e.g. pixels.
+		float size = 16.0f;
+		std::array<float, 4> color{1.0f, 1.0f, 1.0f, 1.0f};
+		int16_t layer = 0;
+	};
+
+	// A TrueType font drawn as signed distance field
+	// glyphs through a SpriteBatch, sharp at any size from
+	// one rasterization. Glyphs are rasterized the first
+	// time they are drawn into cells of an R8 atlas, which
+	// is a cache: once full, the least recently drawn glyph
+	// gives its cell up, though never one drawn since the
+	// last NewFrame(), whose sprites may not have drawn
+	// yet. Preload() the common glyphs to rasterize them
+	// ahead of time.
+	//
+	// GL thread, as glyphs upload when first drawn.
+	class Font
+	{
+	  public:
+		struct Settings
+		{
+			// Atlas width and height in texels.
+			uint32_t atlasSize = 1024;
+			// Line height the distance fields are
+			// rasterized at, in texels.
+			uint32_t glyphSize = 32;
+			// Texels of field around each glyph, the
+			// furthest distance it holds.
+			uint32_t padding = 4;
+		};
+
+		// Layout of one cached glyph, in units of the line
+		// height.
+		struct Glyph
+		{
+			// Bottom-left corner from the pen on the
+			// baseline, y up, and size.
+			float x = 0.0f;
+			float y = 0.0f;
+			float width = 0.0f;
+			float height = 0.0f;
+			float advance = 0.0f;
+			float u0 = 0.0f;
+			float v0 = 0.0f;
+			float u1 = 0.0f;
+			float v1 = 0.0f;
+			// In the font, for kerning.
+			int index = 0;
+			// Atlas cell; NoCell for glyphs without a shape,
+			// such as spaces.
+			uint32_t cell = 0;
+		};
+		static constexpr uint32_t NoCell = 0xFFFFFFFF;
+
+		Font();
+		explicit Font(const Settings& settings);
+		~Font();
+
+		Font(const Font&) = delete;
+		Font& operator=(const Font&) = delete;
+
+		// A .ttf or .otf file's contents, or the file;
+		// creates the atlas.
+		bool Load(std::vector<uint8_t> data);
+		bool LoadFile(const std::string& path);
+		void Unload();
+		inline bool IsLoaded() const
+		{
+			return m_atlas.IsValid();
+		}
+
+		// Call once a frame; glyphs drawn before it may be
+		// evicted again.
+		void NewFrame();
+		// Rasterizes the glyphs of UTF-8 text.
+		void Preload(std::string_view text);
+
+		// nullptr once every cell holds a glyph drawn this
+		// frame.
+		const Glyph* GetGlyph(char32_t codepoint);
+
+		// Adds UTF-8 text to batch with its first baseline
+		// at x, y; '\n' starts a line below. Returns the
+		// width of the widest line.
+		float Draw(SpriteBatch& batch, std::string_view text,
+		           float x, float y, const TextStyle& style);
+		// Width of the widest line, without drawing.
+		float Measure(std::string_view text, float size);
+		// From one baseline to the next.
+		inline float GetLineHeight(float size) const
+		{
+			return m_lineGap * size;
+		}
+
+		inline TextureHandle GetAtlas() const
+		{
+			return m_atlas;
+		}
+		inline uint32_t GetCellCount() const
+		{
+			return static_cast<uint32_t>(m_cells.size());
+		}
+		inline uint32_t GetCachedCount() const
+		{
+			return static_cast<uint32_t>(m_glyphs.size());
+		}
+		inline uint64_t GetEvictionCount() const
+		{
+			return m_evictions;
+		}
+
+	  private:
+		struct FontInfo;
+		// Atlas cells, in a list from most to least
+		// recently drawn.
+		struct Cell
+		{
+			char32_t codepoint = 0;
+			uint64_t lastUsed = 0;
+			uint32_t previous = NoCell;
+			uint32_t next = NoCell;
+		};
+
+		float Layout(std::string_view text,
+		             const TextStyle& style, float x, float y,
+		             SpriteBatch* batch);
+		const Glyph* Rasterize(char32_t codepoint);
+		// A free cell, or the least recently drawn one if
+		// it was not drawn this frame.
+		uint32_t AcquireCell();
+		void Touch(uint32_t cell);
+		void Unlink(uint32_t cell);
+		void PushFront(uint32_t cell);
+
+	  private:
+		Settings m_settings;
+		std::vector<uint8_t> m_data;
+		std::unique_ptr<FontInfo> m_info;
+		float m_scale = 0.0f;
+		// Baseline to baseline, per unit of line height.
+		float m_lineGap = 1.0f;
+
+		TextureHandle m_atlas;
+		uint32_t m_cellSize = 0;
+		uint32_t m_cellsPerRow = 0;
+		std::vector<Cell> m_cells;
+		uint32_t m_head = NoCell;
+		uint32_t m_tail = NoCell;
+		uint32_t m_nextFree = 0;
+		std::vector<uint8_t> m_cellPixels;
+
+		std::unordered_map<char32_t, Glyph> m_glyphs;
+		uint64_t m_frame = 1;
+		uint64_t m_evictions = 0;
+		bool m_warnedFull = false;
+	};
+} // namespace AthiVegam::Graphics
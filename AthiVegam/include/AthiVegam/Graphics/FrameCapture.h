@@ -0,0 +1,132 @@
+#pragma once
+
+#include "AthiVegam/Core/Serialize.h"
+#include "AthiVegam/Graphics/CommandList.h"
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Graphics/IndexType.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Graphics/VertexLayout.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace AthiVegam::Managers
+{
+	class ResourceManager;
+}
+
+namespace AthiVegam::Graphics
+{
+	// Flushes recorded to disk with the meshes and shaders
+	// they draw, so the renderer can be replayed on its
+	// own (see the Replay project) to compare drivers or
+	// renderer changes on identical work. Mesh draws are
+	// captured with their sort keys, instance and constant
+	// data; materials are resolved to their shader and
+	// dropped, and commands naming GL objects directly
+	// (UI, sprites, particles, lines, dispatches) are left
+	// out. Not available in Shipping builds.
+	namespace FrameCapture
+	{
+		constexpr uint32_t SchemaVersion = 1;
+
+		struct CapturedMesh
+		{
+			// As drawn in the capture.
+			MeshHandle handle;
+			VertexLayout layout;
+			IndexType indexType = IndexType::UInt32;
+			uint32_t vertexCount = 0;
+			uint32_t elementCount = 0;
+			std::vector<uint8_t> vertices;
+			std::vector<uint8_t> indices;
+
+			VEGAM_SERIAL_FIELDS(&CapturedMesh::handle,
+			                    &CapturedMesh::layout,
+			                    &CapturedMesh::indexType,
+			                    &CapturedMesh::vertexCount,
+			                    &CapturedMesh::elementCount,
+			                    &CapturedMesh::vertices,
+			                    &CapturedMesh::indices)
+		};
+
+		struct CapturedShader
+		{
+			ShaderHandle handle;
+			std::string vertex;
+			std::string fragment;
+
+			VEGAM_SERIAL_FIELDS(&CapturedShader::handle,
+			                    &CapturedShader::vertex,
+			                    &CapturedShader::fragment)
+		};
+
+		// A RenderMesh, as one instance without a
+		// transform when firstInstance is NoInstance, or a
+		// RenderMeshInstanced.
+		struct CapturedDraw
+		{
+			uint64_t key = 0;
+			MeshHandle mesh;
+			ShaderHandle shader;
+			uint32_t firstInstance = RenderCommands::NoInstance;
+			uint32_t instanceCount = 1;
+			RenderCommands::Constants constants;
+			bool instanced = false;
+		};
+
+		// One recording thread's list; draws address its
+		// instances and constants.
+		struct CapturedList
+		{
+			std::vector<CapturedDraw> draws;
+			std::vector<RenderCommands::InstanceTransform>
+			    instances;
+			std::vector<uint8_t> constants;
+
+			VEGAM_SERIAL_FIELDS(&CapturedList::draws,
+			                    &CapturedList::instances,
+			                    &CapturedList::constants)
+		};
+
+		struct CapturedFlush
+		{
+			std::vector<CapturedList> lists;
+
+			VEGAM_SERIAL_FIELDS(&CapturedFlush::lists)
+		};
+
+		struct Capture
+		{
+			std::vector<CapturedMesh> meshes;
+			std::vector<CapturedShader> shaders;
+			std::vector<CapturedFlush> flushes;
+
+			VEGAM_SERIAL_FIELDS(&Capture::meshes,
+			                    &Capture::shaders,
+			                    &Capture::flushes)
+		};
+
+		// Any thread. Records the next flushes, then writes
+		// them to path.
+		void Request(const std::string& path,
+		             uint32_t flushes);
+		bool IsRecording();
+
+		// GL thread, by RenderManager for every flush while
+		// recording; keys are the finished ones.
+		void
+		BeginFlush(std::span<const CommandList* const> lists);
+		void AddCommand(
+		    uint32_t list, uint64_t key,
+		    RenderCommands::CommandType type,
+		    const void* payload,
+		    const Managers::ResourceManager& resources);
+		void
+		EndFlush(const Managers::ResourceManager& resources);
+
+		bool Load(const std::string& path, Capture& out);
+	} // namespace FrameCapture
+} // namespace AthiVegam::Graphics
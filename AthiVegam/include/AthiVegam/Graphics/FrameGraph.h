@@ -0,0 +1,252 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	// Formats of the textures passes render into.
+	enum class AttachmentFormat : uint8_t
+	{
+		RGBA8,
+		RGBA8Srgb,
+		RGBA16F,
+		RG16F,
+		R11G11B10F,
+		R32F,
+		Depth24Stencil8,
+		Depth32F,
+		COUNT
+	};
+
+	// What a pass finds in an attachment it writes.
+	enum class LoadOp : uint8_t
+	{
+		// The contents of earlier passes.
+		Load,
+		// TransientDesc::clearColor, or depth 1. The
+		// backbuffer clears to the GL clear color.
+		Clear,
+		// Anything; the pass overwrites every pixel.
+		DontCare
+	};
+
+	struct TransientDesc
+	{
+		// 0 follows the backbuffer, times scale.
+		int width = 0;
+		int height = 0;
+		float scale = 1.0f;
+		AttachmentFormat format = AttachmentFormat::RGBA8;
+		std::array<float, 4> clearColor{};
+	};
+
+	// A frame's render passes and the textures they read
+	// and write, declared up front so the graph can see
+	// each transient texture's lifetime. Transients whose
+	// lifetimes don't overlap share a texture: of the same
+	// size and format, or with GL 4.3 any format of the
+	// same view class (e.g. RGBA8 and R32F), through
+	// texture views. Passes contributing to no output are
+	// dropped. Textures and framebuffers are pooled across
+	// frames, so a steady frame creates no GL objects.
+	//
+	// Every frame: declare, Compile(), Execute(), Reset().
+	// GL thread only.
+	class FrameGraph
+	{
+	  public:
+		using ResourceId = uint32_t;
+		static constexpr ResourceId InvalidResource =
+		    0xFFFFFFFF;
+		static constexpr uint32_t MaxColorAttachments = 4;
+		// Frames a pooled texture may go unused before it
+		// is freed.
+		static constexpr uint32_t PoolFrames = 3;
+
+		class PassBuilder
+		{
+		  public:
+			// Sampled by the pass.
+			void Read(ResourceId resource);
+			// Color attachments, in the order given.
+			void WriteColor(ResourceId resource,
+			                LoadOp load = LoadOp::Load);
+			void WriteDepth(ResourceId resource,
+			                LoadOp load = LoadOp::Load);
+			// Kept even when nothing reads what it writes.
+			void SetSideEffects();
+
+		  private:
+			friend class FrameGraph;
+			PassBuilder(FrameGraph& graph, uint32_t pass);
+
+			FrameGraph& m_graph;
+			uint32_t m_pass;
+		};
+
+		class PassContext
+		{
+		  public:
+			// GL texture of a resource the pass reads or
+			// writes; 0 for the backbuffer.
+			uint32_t GetTexture(ResourceId resource) const;
+			// Of the pass's attachments.
+			inline int GetWidth() const { return m_width; }
+			inline int GetHeight() const { return m_height; }
+
+		  private:
+			friend class FrameGraph;
+			PassContext(const FrameGraph& graph, int width,
+			            int height);
+
+			const FrameGraph& m_graph;
+			int m_width;
+			int m_height;
+		};
+
+		using SetupFunction = std::function<void(PassBuilder&)>;
+		using ExecuteFunction =
+		    std::function<void(const PassContext&)>;
+
+		struct Stats
+		{
+			uint32_t passes = 0;
+			uint32_t culledPasses = 0;
+			uint32_t transients = 0;
+			// Pooled textures the transients used.
+			uint32_t textures = 0;
+			// Without and with sharing.
+			size_t requestedBytes = 0;
+			size_t allocatedBytes = 0;
+		};
+
+		FrameGraph();
+		~FrameGraph();
+
+		FrameGraph(const FrameGraph&) = delete;
+		FrameGraph& operator=(const FrameGraph&) = delete;
+
+		// Frees the pooled textures and framebuffers.
+		void Shutdown();
+
+		// What the backbuffer resource renders into: the
+		// window's framebuffer, 0, or e.g. a headless
+		// RenderTarget's.
+		void SetBackbuffer(uint32_t framebuffer, int width,
+		                   int height);
+		ResourceId GetBackbuffer() const { return 0; }
+
+		ResourceId CreateTransient(std::string name,
+		                           const TransientDesc& desc);
+		// A texture the graph doesn't own, e.g. history
+		// kept across frames. Passes writing it are never
+		// dropped. A layer of 0 or more attaches that layer
+		// of a 2D array texture.
+		ResourceId Import(std::string name, uint32_t texture,
+		                  int width, int height,
+		                  AttachmentFormat format,
+		                  int32_t layer = -1);
+		void AddPass(std::string name,
+		             const SetupFunction& setup,
+		             ExecuteFunction execute);
+
+		void Compile();
+		void Execute();
+		// Forgets the frame's passes and resources; pooled
+		// textures stay for the next frame.
+		void Reset();
+
+		inline const Stats& GetStats() const
+		{
+			return m_stats;
+		}
+
+	  private:
+		struct Attachment
+		{
+			ResourceId resource;
+			LoadOp load;
+		};
+
+		struct Pass
+		{
+			std::string name;
+			ExecuteFunction execute;
+			std::vector<ResourceId> reads;
+			std::vector<Attachment> colors;
+			Attachment depth{InvalidResource, LoadOp::Load};
+			bool sideEffects = false;
+			bool alive = false;
+		};
+
+		struct Resource
+		{
+			std::string name;
+			TransientDesc desc;
+			int width = 0;
+			int height = 0;
+			bool imported = false;
+			int32_t layer = -1;
+			// GL texture: the import's, or the one Compile()
+			// gave the transient, from m_pool[pooled].
+			uint32_t texture = 0;
+			uint32_t pooled = 0xFFFFFFFF;
+			// Alive passes using it, first and last.
+			uint32_t first = 0xFFFFFFFF;
+			uint32_t last = 0;
+		};
+
+		// A texture of the pool, with views of it in other
+		// formats of its class.
+		struct PooledTexture
+		{
+			uint32_t texture = 0;
+			int width = 0;
+			int height = 0;
+			AttachmentFormat format = AttachmentFormat::RGBA8;
+			size_t bytes = 0;
+			std::array<uint32_t,
+			           static_cast<size_t>(
+			               AttachmentFormat::COUNT)>
+			    views{};
+			uint32_t lastUsedFrame = 0;
+			bool inUse = false;
+		};
+
+		struct Framebuffer
+		{
+			std::array<uint32_t, MaxColorAttachments + 1>
+			    attachments;
+			std::array<int32_t, MaxColorAttachments + 1> layers;
+			uint32_t framebuffer = 0;
+		};
+
+		void Cull();
+		// Gives the transient a texture of the pool.
+		void Acquire(Resource& resource);
+		void Release(const Resource& resource);
+		uint32_t GetFramebuffer(const Pass& pass);
+		void BeginPass(const Pass& pass, int& width,
+		               int& height);
+		void DestroyTexture(PooledTexture& pooled);
+		void DestroyFramebuffer(Framebuffer& framebuffer);
+
+	  private:
+		std::vector<Pass> m_passes;
+		std::vector<Resource> m_resources;
+		std::vector<PooledTexture> m_pool;
+		std::vector<Framebuffer> m_framebuffers;
+
+		uint32_t m_backbuffer = 0;
+		int m_backbufferWidth = 0;
+		int m_backbufferHeight = 0;
+		uint32_t m_frame = 0;
+		bool m_compiled = false;
+		Stats m_stats;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+typedef struct __GLsync* GLsync;
+
+namespace AthiVegam::Graphics
+{
+	// Reads finished frames back to the CPU without
+	// stalling: each capture copies the framebuffer into
+	// the next of a ring of pixel buffers, and the data is
+	// handed over a few frames later, once its fence has
+	// signalled. GL thread only.
+	class FrameReadback
+	{
+	  public:
+		static constexpr uint32_t SlotCount = 3;
+
+		// RGBA8 pixels, bottom row first, valid only during
+		// the call.
+		using Callback =
+		    std::function<void(const uint8_t* pixels, int width,
+		                       int height, uint64_t frame)>;
+
+		FrameReadback() = default;
+		~FrameReadback() = default;
+
+		FrameReadback(const FrameReadback&) = delete;
+		FrameReadback& operator=(const FrameReadback&) = delete;
+
+		inline void SetCallback(Callback callback)
+		{
+			m_callback = std::move(callback);
+		}
+		inline bool IsEnabled() const
+		{
+			return static_cast<bool>(m_callback);
+		}
+
+		// Queues a copy of the bound read framebuffer. Waits
+		// only if every slot is still in flight.
+		void Capture(int width, int height, uint64_t frame);
+		// Hands finished captures to the callback, oldest
+		// first; with wait, also those still in flight.
+		void Poll(bool wait = false);
+		// Delivers what is in flight, then frees the
+		// buffers.
+		void Destroy();
+
+	  private:
+		struct Slot
+		{
+			uint32_t buffer = 0;
+			size_t size = 0;
+			GLsync fence = nullptr;
+			int width = 0;
+			int height = 0;
+			uint64_t frame = 0;
+		};
+
+		bool Deliver(Slot& slot, bool wait);
+
+	  private:
+		Callback m_callback;
+		std::array<Slot, SlotCount> m_slots;
+		uint32_t m_next = 0;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	// Counts the GL calls a frame makes, per function, and
+	// the CPU time spent inside them, i.e. in the driver.
+	// Install() wraps glad's function pointers for every GL
+	// function the engine calls in a counting, timing
+	// thunk, so the totals show what state caching and
+	// batching save. The thunks cost two clock reads per
+	// call; installing is an EngineConfig choice, on by
+	// default in Profile builds, and compiles out of
+	// Shipping builds.
+	namespace GLCallCounter
+	{
+		struct Function
+		{
+			const char* name = nullptr;
+			uint32_t calls = 0;
+			double milliseconds = 0.0;
+		};
+
+		struct FrameTotals
+		{
+			uint32_t calls = 0;
+			double milliseconds = 0.0;
+		};
+
+#ifndef AV_CONFIG_SHIPPING
+		// Right after gladLoadGL(), before any other
+		// thread may call GL.
+		void Install();
+		bool IsInstalled();
+
+		// Once per frame: publishes the frame's counts and
+		// starts the next.
+		void EndFrame();
+		// Of the last published frame. Any thread.
+		FrameTotals GetFrameTotals();
+		// Functions called in the last published frame,
+		// most time first.
+		std::vector<Function> GetFunctions();
+
+		// ImGui window with the per-function counts.
+		void DrawPanel();
+#else
+		inline void Install() {}
+		inline bool IsInstalled() { return false; }
+		inline void EndFrame() {}
+		inline FrameTotals GetFrameTotals() { return {}; }
+		inline std::vector<Function> GetFunctions()
+		{
+			return {};
+		}
+		inline void DrawPanel() {}
+#endif // AV_CONFIG_SHIPPING
+	} // namespace GLCallCounter
+} // namespace AthiVegam::Graphics
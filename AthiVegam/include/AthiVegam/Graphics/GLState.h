@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// Shadow copy of the fixed-function GL state the engine
+	// touches, for the engine's GL context. Every such
+	// change in the engine goes through here, so setting a
+	// value that is already current issues nothing. Starts
+	// out as a fresh context's defaults.
+	//
+	// Values are GL enums, kept as uint32_t so glad stays
+	// out of the header.
+	class GLState
+	{
+	  public:
+		enum class Capability : uint8_t
+		{
+			Blend,
+			DepthTest,
+			CullFace,
+			ScissorTest,
+			COUNT
+		};
+
+		// Each returns false if the value was current.
+		static bool SetEnabled(Capability capability,
+		                       bool enabled);
+		static bool SetBlendFunc(uint32_t sourceColor,
+		                         uint32_t destinationColor,
+		                         uint32_t sourceAlpha,
+		                         uint32_t destinationAlpha);
+		inline static bool SetBlendFunc(uint32_t source,
+		                                uint32_t destination)
+		{
+			return SetBlendFunc(source, destination, source,
+			                    destination);
+		}
+		static bool SetDepthMask(bool write);
+		// All four channels at once.
+		static bool SetColorMask(bool write);
+		static bool SetDepthFunc(uint32_t func);
+		static bool SetCullFace(uint32_t face);
+		// For both faces.
+		static bool SetPolygonMode(uint32_t mode);
+		// Unknown after Invalidate(), until set again.
+		static uint32_t GetPolygonMode();
+
+		static constexpr uint32_t Unknown = 0xFFFFFFFF;
+
+		// Call after code that changes state directly, e.g.
+		// ImGui draw callbacks; the next set of each value
+		// is issued.
+		static void Invalidate();
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Lod.h"
+#include "AthiVegam/Graphics/Uniform.h"
+
+#include <cstdint>
+#include <span>
+
+namespace AthiVegam::Graphics
+{
+	// Culls the frame's multi-draw-indirect draws on the
+	// GPU. A compute pass reads each draw's bounds and
+	// instance transforms and zeroes the instanceCount of
+	// the indirect entries no instance of which is visible,
+	// so the CPU never touches individual objects.
+	//
+	// Besides the frustum, draws are tested against a Hi-Z
+	// pyramid (the farthest depth of each texel's area,
+	// per mip level) built from a depth texture of the
+	// previous frame, when one is set. Objects coming out
+	// from behind an occluder may then appear a frame
+	// late.
+	//
+	// Draws with levels of detail have their count,
+	// firstIndex and baseVertex set to the level the
+	// largest of their visible instances asks for. Draws
+	// are rebuilt every frame, so there is no hysteresis
+	// or cross-fade here.
+	//
+	// Draws of meshes split into meshlets are culled once
+	// more, meshlet by meshlet, also against each one's
+	// normal cone when back faces are culled anyway; the
+	// indices of those left are compacted into a buffer
+	// the draws then read instead of their arena's.
+	// GL 4.3, GL thread only.
+	class GpuCulling
+	{
+	  public:
+		// A draw's levels as indirect parameters, std430;
+		// levels past its chain have threshold 0, and
+		// draws without levels an all-0 threshold.
+		struct LodLevels
+		{
+			uint32_t counts[LodChain::MaxLevels];
+			uint32_t firstIndices[LodChain::MaxLevels];
+			int32_t baseVertices[LodChain::MaxLevels];
+			// As LodChain::thresholds; the last is unused.
+			float thresholds[LodChain::MaxLevels];
+		};
+
+		// An indirect draw of an arena mesh with
+		// meshlets (see Mesh::GetMeshletBuffer()).
+		struct ClusterDraw
+		{
+			// Index of its entry in the indirect buffer.
+			uint32_t draw = 0;
+			uint32_t meshletBuffer = 0;
+			uint32_t meshletCount = 0;
+			// The mesh's arena's, and where it starts in it.
+			uint32_t indexBuffer = 0;
+			uint32_t firstIndex = 0;
+			bool shortIndices = false;
+			// Whether its pipeline state culls back faces,
+			// so whole meshlets facing away may be too.
+			bool backFaceCulling = false;
+		};
+
+		// Bounds of draws that are never culled.
+		static constexpr Float4 NeverCull{0.0f, 0.0f, 0.0f,
+		                                  -1.0f};
+		// Shader storage bindings of the culling pass.
+		static constexpr uint32_t DrawsBinding = 3;
+		static constexpr uint32_t BoundsBinding = 4;
+		static constexpr uint32_t InstancesBinding = 5;
+		static constexpr uint32_t LodsBinding = 6;
+		// And of the cluster pass, past ParticleSystem's.
+		static constexpr uint32_t MeshletsBinding = 16;
+		static constexpr uint32_t IndicesBinding = 17;
+		static constexpr uint32_t ClusterIndicesBinding = 18;
+		// Unit the pyramid is sampled from, past any
+		// material texture set.
+		static constexpr uint32_t PyramidUnit = 15;
+
+		GpuCulling() = default;
+		~GpuCulling();
+
+		GpuCulling(const GpuCulling&) = delete;
+		GpuCulling& operator=(const GpuCulling&) = delete;
+
+		// Compiles the compute programs; false without GL
+		// 4.3.
+		bool Initialize();
+		void Shutdown();
+		inline bool IsInitialized() const
+		{
+			return m_cullProgram != 0;
+		}
+
+		// Depth texture the pyramid is built from, a
+		// single-sampled GL_TEXTURE_2D; 0 disables
+		// occlusion culling.
+		void SetOcclusionDepth(uint32_t depthTexture,
+		                       int width, int height);
+		// After the frame that wrote the depth texture.
+		void BuildDepthPyramid();
+
+		// Tests drawCount entries of the indirect buffer
+		// against a column-major view-projection. bounds
+		// holds one mesh-space sphere (center, radius) per
+		// draw, applied through every instance transform
+		// from baseInstance on; NeverCull for draws without
+		// transforms.
+		// lods is empty, or holds the levels of each draw.
+		void Cull(const float viewProjection[16],
+		          uint32_t indirectBuffer,
+		          uint32_t instanceBuffer,
+		          std::span<const Float4> bounds,
+		          std::span<const LodLevels> lods = {});
+
+		// After Cull(), with the same view: for each
+		// draw with an instance left, writes the indices of
+		// the meshlets any instance may see to the cluster
+		// index buffer from the entry's firstIndex on, and
+		// sets its count to theirs. Entries come with
+		// their slice of the buffer as firstIndex, of
+		// indexCount indices in all, and without levels of
+		// detail.
+		void CullClusters(const float viewProjection[16],
+		                  uint32_t indirectBuffer,
+		                  uint32_t instanceBuffer,
+		                  std::span<const ClusterDraw> draws,
+		                  uint32_t indexCount);
+		// 32-bit; drawn from in place of the arena's
+		// element buffer by the draws CullClusters() wrote.
+		inline uint32_t GetClusterIndexBuffer() const
+		{
+			return m_clusterIndexBuffer;
+		}
+
+		// As LodSettings::bias.
+		inline void SetLodBias(float bias) { m_lodBias = bias; }
+
+	  private:
+		void DestroyPyramid();
+
+	  private:
+		uint32_t m_cullProgram = 0;
+		uint32_t m_clusterProgram = 0;
+		uint32_t m_pyramidProgram = 0;
+		uint32_t m_boundsBuffer = 0;
+		size_t m_boundsBufferSize = 0;
+		uint32_t m_lodsBuffer = 0;
+		size_t m_lodsBufferSize = 0;
+		uint32_t m_clusterIndexBuffer = 0;
+		size_t m_clusterIndexBufferSize = 0;
+		float m_lodBias = 1.0f;
+
+		uint32_t m_depthTexture = 0;
+		uint32_t m_depthSampler = 0;
+		int m_depthWidth = 0;
+		int m_depthHeight = 0;
+		uint32_t m_pyramid = 0;
+		int m_pyramidLevels = 0;
+		// Whether the pyramid holds a built frame.
+		bool m_pyramidReady = false;
+	};
+} // namespace AthiVegam::Graphics
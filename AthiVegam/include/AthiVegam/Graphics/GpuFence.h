@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <memory>
+
+namespace AthiVegam::Graphics
+{
+	// Awaitable GPU progress for Core::Task coroutines:
+	//
+	//   co_await Graphics::GpuFence();
+	//
+	// resumes on the main thread once the GPU has run every
+	// command submitted before the GL thread next polls, and
+	// GpuFence(sync) once an existing GLsync, e.g. one made
+	// on the loader thread, has signalled. The fence is
+	// deleted once signalled.
+	class GpuFence
+	{
+	  public:
+		GpuFence();
+		// Takes ownership of a GLsync.
+		explicit GpuFence(void* sync);
+
+		inline bool await_ready() const { return false; }
+		void await_suspend(std::coroutine_handle<> handle);
+		inline void await_resume() const {}
+
+		// GL thread, once per frame: inserts fences asked
+		// for and checks those awaited.
+		static void Poll();
+
+	  private:
+		struct State
+		{
+			// Null until the GL thread inserts it.
+			void* sync = nullptr;
+			std::atomic<bool> signalled{false};
+		};
+
+		std::shared_ptr<State> m_state;
+	};
+} // namespace AthiVegam::Graphics
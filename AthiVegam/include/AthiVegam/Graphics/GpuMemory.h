@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// The GPU memory budget. Bytes are counted per
+	// GpuResources type as objects are registered; the
+	// budget comes from the "r.gpuBudgetMB" CVar, else from
+	// GL_NVX_gpu_memory_info or GL_ATI_meminfo. Going over
+	// it, or the driver reporting too little left, makes
+	// ResourceManager evict the finest levels of textures
+	// not drawn lately, rather than have the driver page.
+	namespace GpuMemory
+	{
+		// GL thread, once the context is up.
+		void Initialize();
+		// GL thread, once per frame: polls the driver and
+		// advances GetFrame().
+		void EndFrame();
+
+		// Frames ended so far, the stamp draws leave on the
+		// textures they use. Any thread.
+		uint64_t GetFrame();
+		// Of every GpuResources type. Any thread.
+		size_t GetUsed();
+		// 0 when there is none. Any thread.
+		size_t GetBudget();
+		// Bytes to free to be within the budget and the
+		// driver's reserve, as of the last EndFrame(). Any
+		// thread.
+		size_t GetOverage();
+		// Free video memory the driver reports, or 0 if it
+		// doesn't. GL thread.
+		size_t GetDriverAvailable();
+	} // namespace GpuMemory
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "AthiVegam/Core/Profiler.h"
+
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// GPU zones timed with GL_TIMESTAMP queries. Each frame
+	// in flight has its own set of queries, read back
+	// FrameLatency frames later so reading never stalls;
+	// results that are still not available are dropped.
+	// Timestamps are converted to the CPU profiler's clock
+	// and shown as its "GPU" track.
+	//
+	// GL thread only. Zones may nest but must be opened
+	// between BeginFrame() and EndFrame().
+	namespace GpuProfiler
+	{
+		constexpr uint32_t FrameLatency = 3;
+		constexpr uint32_t MaxZonesPerFrame = 64;
+
+		void Initialize();
+		void Shutdown();
+
+		void BeginFrame();
+		void EndFrame();
+
+		// GPU time of the latest resolved frame, from
+		// BeginFrame() to EndFrame(); 0 before the first.
+		// Any thread.
+		float GetFrameMs();
+
+		class Scope
+		{
+		  public:
+			explicit Scope(const char* name);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		  private:
+			int32_t m_zone;
+		};
+	} // namespace GpuProfiler
+} // namespace AthiVegam::Graphics
+
+#ifndef AV_CONFIG_SHIPPING
+#define VEGAM_PROFILE_GPU_SCOPE(name)                      \
+	::AthiVegam::Graphics::GpuProfiler::Scope              \
+	VEGAM_PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+#else
+#define VEGAM_PROFILE_GPU_SCOPE(name)
+#endif // AV_CONFIG_SHIPPING
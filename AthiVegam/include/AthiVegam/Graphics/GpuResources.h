@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <source_location>
+
+namespace AthiVegam::Graphics
+{
+	// Registry of live GL objects for the resource
+	// inspector: size, creation site, the frame it was last
+	// bound in and how often. Code creating GL objects
+	// registers them; RenderState reports binds.
+	//
+	// Sizes are kept in every build, for the GPU memory
+	// budget (see GpuMemory); binds and the panel compile
+	// to nothing in Shipping builds.
+	namespace GpuResources
+	{
+		enum class Type : uint8_t
+		{
+			VertexArray,
+			Buffer,
+			Program,
+			Texture,
+			Renderbuffer,
+			Framebuffer,
+			Count
+		};
+
+		const char* GetTypeName(Type type);
+
+		// Resources registered on this thread while a scope
+		// is alive are attributed to its site rather than
+		// the GL call; the outermost scope wins, so public
+		// ResourceManager functions name their caller.
+		class SiteScope
+		{
+		  public:
+			explicit SiteScope(std::source_location site);
+			~SiteScope();
+
+			SiteScope(const SiteScope&) = delete;
+			SiteScope& operator=(const SiteScope&) = delete;
+
+		  private:
+			bool m_owner;
+		};
+
+		// owner is the vertex array a buffer is attached
+		// to, whose binds stand for the buffer's. label must
+		// be a literal.
+		void Register(Type type, uint32_t id, size_t bytes,
+		              const char* label, uint32_t owner = 0,
+		              std::source_location site =
+		                  std::source_location::current());
+		void Resize(Type type, uint32_t id, size_t bytes);
+		void Unregister(Type type, uint32_t id);
+		// Of every live resource of the type. Any thread.
+		size_t GetBytes(Type type);
+		// Once per frame, after the frame's draws.
+		void EndFrame();
+
+#ifndef AV_CONFIG_SHIPPING
+		// GL thread, for actual binds only.
+		void MarkBound(Type type, uint32_t id);
+
+		// ImGui window listing every live resource.
+		void DrawPanel();
+#else
+		inline void MarkBound(Type, uint32_t) {}
+		inline void DrawPanel() {}
+#endif // AV_CONFIG_SHIPPING
+	} // namespace GpuResources
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// 32-bit generational handle to a resource owned by a
+	// ResourcePool. The low bits index the pool slot and the
+	// high bits hold the slot generation at creation time, so
+	// a stale handle is detected with a single compare.
+	// A value of 0 is never issued and means "no resource".
+	template <typename T>
+	struct Handle
+	{
+		static constexpr uint32_t IndexBits = 20;
+		static constexpr uint32_t GenerationBits = 12;
+		static constexpr uint32_t IndexMask =
+		    (1u << IndexBits) - 1;
+		static constexpr uint32_t GenerationMask =
+		    (1u << GenerationBits) - 1;
+
+		uint32_t value = 0;
+
+		static constexpr Handle Make(uint32_t index,
+		                             uint32_t generation)
+		{
+			return Handle{(index & IndexMask)
+			              | ((generation & GenerationMask)
+			                 << IndexBits)};
+		}
+
+		constexpr uint32_t GetIndex() const
+		{
+			return value & IndexMask;
+		}
+		constexpr uint32_t GetGeneration() const
+		{
+			return (value >> IndexBits) & GenerationMask;
+		}
+		constexpr bool IsValid() const { return value != 0; }
+
+		constexpr bool operator==(const Handle&) const =
+		    default;
+	};
+
+	class ComputeShader;
+	class Material;
+	class Mesh;
+	class Shader;
+	class Texture;
+
+	using ComputeShaderHandle = Handle<ComputeShader>;
+	using MaterialHandle = Handle<Material>;
+	using MeshHandle = Handle<Mesh>;
+	using ShaderHandle = Handle<Shader>;
+	using TextureHandle = Handle<Texture>;
+} // namespace AthiVegam::Graphics
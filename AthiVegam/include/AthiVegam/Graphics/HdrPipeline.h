@@ -0,0 +1,98 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Graphics/Uniform.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace AthiVegam::Graphics
+{
+	// Renders the scene into a half-float target and
+	// resolves it for display in three steps:
+	//  - compute shaders downsample the bright parts into
+	//    a bloom mip chain, from half size down, each group
+	//    filtering a tile it first loads into shared
+	//    memory;
+	//  - compute shaders add each level, tent filtered,
+	//    into the next larger one;
+	//  - one full-screen pass adds the bloom, applies the
+	//    exposure, an ACES tonemap and the color grade, and
+	//    writes the display framebuffer, which the UI then
+	//    draws over.
+	// Exposure, bloom and grade come from the "r.exposure",
+	// "r.bloom*", "r.contrast" and "r.saturation" CVars.
+	// GL 4.3; GL thread only.
+	class HdrPipeline
+	{
+	  public:
+		// Including the half size level.
+		static constexpr uint32_t MaxBloomLevels = 6;
+
+		HdrPipeline();
+		~HdrPipeline();
+
+		HdrPipeline(const HdrPipeline&) = delete;
+		HdrPipeline& operator=(const HdrPipeline&) = delete;
+
+		// Compiles the programs. False, after logging why,
+		// without GL 4.3 or if they fail to compile.
+		bool Initialize();
+		void Shutdown();
+		inline bool IsInitialized() const
+		{
+			return m_downsampleProgram != 0;
+		}
+
+		// Reallocates the targets for a display size.
+		bool Resize(int displayWidth, int displayHeight);
+		// Binds the scene target with a viewport covering
+		// it, allocating it on first use.
+		bool BeginFrame(int displayWidth, int displayHeight);
+		// Binds the scene target again, e.g. after drawing
+		// to another window.
+		void Bind() const;
+		// Blooms and tonemaps the scene into the display
+		// framebuffer, which is left bound with a viewport
+		// covering it. Encodes sRGB in the shader unless
+		// GL does on writing (WindowDesc::srgb).
+		void Resolve(uint32_t displayFramebuffer,
+		             bool srgbFramebuffer);
+
+		inline uint32_t GetFramebuffer() const
+		{
+			return m_framebuffer;
+		}
+		inline int GetWidth() const { return m_width; }
+		inline int GetHeight() const { return m_height; }
+
+	  private:
+		void DestroyTargets();
+		void Bloom();
+		void Tonemap(uint32_t displayFramebuffer,
+		             bool srgbFramebuffer);
+
+	  private:
+		uint32_t m_framebuffer = 0;
+		// RGBA16F, sampled by the bloom and the tonemap.
+		uint32_t m_color = 0;
+		uint32_t m_depth = 0;
+		// RGBA16F mips from half the scene size down.
+		uint32_t m_bloom = 0;
+		int m_bloomLevels = 0;
+		int m_width = 0;
+		int m_height = 0;
+
+		uint32_t m_downsampleProgram = 0;
+		uint32_t m_upsampleProgram = 0;
+		std::unique_ptr<Shader> m_tonemapShader;
+		// No attributes; the triangle comes from
+		// gl_VertexID.
+		uint32_t m_vao = 0;
+		UniformHandle<float> m_exposureUniform;
+		UniformHandle<float> m_bloomIntensityUniform;
+		UniformHandle<float> m_contrastUniform;
+		UniformHandle<float> m_saturationUniform;
+		UniformHandle<int> m_encodeSrgbUniform;
+	};
+} // namespace AthiVegam::Graphics
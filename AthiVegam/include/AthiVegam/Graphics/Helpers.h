@@ -3,6 +3,14 @@
 namespace AthiVegam::Graphics
 {
 	void CheckOpenGLError();
+
+	// Routes GL_KHR_debug messages to the log through
+	// glDebugMessageCallback, so errors are reported without
+	// polling glGetError. Needs a 4.3+ context; returns
+	// false when debug output is unavailable. Synchronous
+	// output reports from inside the failing call, which
+	// serializes the driver.
+	bool EnableDebugOutput(bool synchronous);
 	//{
 	//	GLenum error = glGetError();
 	//	bool shouldAssert = error != GL_NO_ERROR;
@@ -34,11 +42,13 @@ namespace AthiVegam::Graphics
 	//}
 } // namespace AthiVegam::Graphics
 
+// Synchronous checks only in Debug: Profile builds rely on
+// debug output instead.
 #ifndef VEGAM_CHECK_GL_ERROR
-#ifndef AV_CONFIG_RELEASE
+#if !defined(AV_CONFIG_RELEASE) && !defined(AV_CONFIG_PROFILE)
 #define VEGAM_CHECK_GL_ERROR                               \
 	AthiVegam::Graphics::CheckOpenGLError();
 #else
 #define VEGAM_CHECK_GL_ERROR (void)0
-#endif // AV_CONFIG_RELEASE
+#endif // !AV_CONFIG_RELEASE && !AV_CONFIG_PROFILE
 #endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "AthiVegam/Graphics/CommandBuffer.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct ImDrawData;
+
+namespace AthiVegam::Graphics
+{
+	class Shader;
+	class StreamBuffer;
+
+	// Draws ImGui's draw data as DrawUi render commands,
+	// executed in order by RenderManager::ExecuteOrdered(),
+	// so the UI shares the engine's state cache, draw
+	// counters and GPU profiling. Vertices and indices go
+	// to stream buffers addressed through base vertex and
+	// index offsets, so the VAO is only set up when they
+	// grow. GL thread only.
+	class ImGuiRenderer
+	{
+	  public:
+		ImGuiRenderer();
+		~ImGuiRenderer();
+
+		ImGuiRenderer(const ImGuiRenderer&) = delete;
+		ImGuiRenderer& operator=(const ImGuiRenderer&) = delete;
+
+		// Also builds the font atlas, so NewFrame() needs no
+		// GL context.
+		void Initialize();
+		void Shutdown();
+
+		// With reuse, drawData must be what the previous
+		// call drew; its vertices and indices are not
+		// uploaded again.
+		void Render(const ImDrawData* drawData,
+		            bool reuse = false);
+
+	  private:
+		void Reserve(size_t vertexCount, size_t indexCount);
+		void Upload(const ImDrawData* drawData);
+		void Flush();
+		// Blending, scissor test and fill, without depth
+		// test or culling.
+		void SetUiState();
+
+	  private:
+		std::unique_ptr<Shader> m_shader;
+		std::unique_ptr<StreamBuffer> m_vertices;
+		std::unique_ptr<StreamBuffer> m_indices;
+		uint32_t m_vao = 0;
+		uint32_t m_fontTexture = 0;
+		// Per segment.
+		size_t m_vertexCapacity = 0;
+		size_t m_indexCapacity = 0;
+		bool m_uploaded = false;
+
+		CommandBuffer m_commands;
+		std::vector<uint32_t> m_offsets;
+	};
+} // namespace AthiVegam::Graphics
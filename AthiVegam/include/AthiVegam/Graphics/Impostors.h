@@ -0,0 +1,123 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Bounds.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Graphics/Uniform.h"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	class CommandList;
+	class Mesh;
+	class Shader;
+
+	// Octahedral impostors: meshes rendered ahead of time
+	// from frames x frames directions, spread over the
+	// sphere by an octahedral map, each into a layer of
+	// two array textures: the albedo with its coverage,
+	// and the mesh-space normal with the depth. Far away
+	// an instance draws as one quad facing the camera that
+	// blends the three frames nearest its view direction,
+	// lit by the baked normals and pushed back to the
+	// baked depth. A LodChain takes one as its last level
+	// (see LodChain::impostor).
+	//
+	// Draw() records from any thread, though not while
+	// Bake() or Release() run; the rest is GL 4.3, GL
+	// thread only.
+	class Impostors
+	{
+	  public:
+		// Texture units of the atlases while impostors
+		// draw, as Terrain's.
+		static constexpr uint32_t AlbedoUnit = 12;
+		static constexpr uint32_t NormalDepthUnit = 13;
+
+		struct Settings
+		{
+			// Impostors baked at once, a layer each.
+			uint32_t capacity = 16;
+			// Frames per side of the octahedral grid.
+			uint32_t frames = 8;
+			// Texels per side of a frame; a power of two.
+			uint32_t frameSize = 64;
+			// Direction light travels in, for the built-in
+			// shading.
+			Float3 lightDirection{0.3f, -1.0f, 0.2f};
+		};
+
+		Impostors();
+		explicit Impostors(const Settings& settings);
+		~Impostors();
+
+		Impostors(const Impostors&) = delete;
+		Impostors& operator=(const Impostors&) = delete;
+
+		// Allocates the atlases and compiles the shaders;
+		// false without GL 4.3.
+		bool Initialize();
+		void Shutdown();
+		inline bool IsInitialized() const
+		{
+			return m_framebuffer != 0;
+		}
+
+		// Renders the mesh into a free layer. Positions,
+		// normals and texture coordinates are read at
+		// locations 0, 1 and 2, as tools/cookmeshes.py
+		// lays them out; without normals the faces' are
+		// baked. albedo is a 2D texture sampled by the
+		// coordinates, 0 for white; texels under half
+		// alpha are cut out. LodChain::NoImpostor when
+		// every layer is taken or the mesh is not ready
+		// or unbounded.
+		uint32_t Bake(const Mesh& mesh, uint32_t albedo = 0);
+		void Release(uint32_t impostor);
+
+		// Records instances of an impostor as a
+		// DrawImpostors command with a column-major
+		// view-projection. Each transform places the mesh
+		// as a RenderMesh's would; m[3], zero in affine
+		// transforms, may carry the LodFadeConstants fade
+		// the instance dithers with while its level cross-
+		// fades. Drawn opaque in the sort key layer
+		// renderLayer.
+		void Draw(
+		    CommandList& list, const float viewProjection[16],
+		    uint32_t impostor,
+		    std::span<const RenderCommands::InstanceTransform>
+		        instances,
+		    uint8_t renderLayer = 0) const;
+
+		inline const Settings& GetSettings() const
+		{
+			return m_settings;
+		}
+
+	  private:
+		struct Entry
+		{
+			// Mesh space; the frames are fitted to it.
+			BoundingSphere sphere;
+			bool used = false;
+		};
+
+	  private:
+		Settings m_settings;
+		std::vector<Entry> m_entries;
+
+		uint32_t m_albedo = 0;
+		uint32_t m_normalDepth = 0;
+		uint32_t m_depth = 0;
+		uint32_t m_framebuffer = 0;
+		std::unique_ptr<Shader> m_bakeShader;
+		std::unique_ptr<Shader> m_drawShader;
+		// No attributes besides the instances'; the quad
+		// comes from gl_VertexID.
+		uint32_t m_vao = 0;
+	};
+} // namespace AthiVegam::Graphics
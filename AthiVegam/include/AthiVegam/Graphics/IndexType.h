@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// Width of a mesh's index buffer. Indices are relative
+	// to the mesh's base vertex, so 16 bits suffice for any
+	// mesh of up to 65536 vertices wherever it is stored.
+	enum class IndexType : uint8_t
+	{
+		UInt16,
+		UInt32
+	};
+
+	constexpr uint32_t MaxUInt16IndexedVertices = 1u << 16;
+
+	constexpr IndexType SelectIndexType(uint32_t vertexCount)
+	{
+		return vertexCount <= MaxUInt16IndexedVertices
+		           ? IndexType::UInt16
+		           : IndexType::UInt32;
+	}
+
+	constexpr uint32_t GetIndexSize(IndexType type)
+	{
+		return type == IndexType::UInt16 ? sizeof(uint16_t)
+		                                 : sizeof(uint32_t);
+	}
+
+	// Copies indices into dst in the given width. dst holds
+	// count * GetIndexSize(type) bytes.
+	inline void WriteIndices(const uint32_t* indices,
+	                         uint32_t count, IndexType type,
+	                         void* dst)
+	{
+		if (type == IndexType::UInt32)
+		{
+			auto* out = static_cast<uint32_t*>(dst);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				out[i] = indices[i];
+			}
+			return;
+		}
+
+		auto* out = static_cast<uint16_t*>(dst);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			out[i] = static_cast<uint16_t>(indices[i]);
+		}
+	}
+} // namespace AthiVegam::Graphics
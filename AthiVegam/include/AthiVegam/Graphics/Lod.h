@@ -0,0 +1,118 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Bounds.h"
+#include "AthiVegam/Graphics/Handle.h"
+
+#include <array>
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// Coarser stand-ins for a mesh, e.g. from an offline
+	// simplifier, each taking over once the mesh covers
+	// less of the screen than its threshold. Level 0 is
+	// the mesh itself. For the GPU culling path, every
+	// level must come from the mesh's arena.
+	struct LodChain
+	{
+		static constexpr uint32_t MaxLevels = 4;
+		static constexpr uint32_t NoImpostor = 0xFFFFFFFF;
+
+		// Levels 1 and on, in the order they take over.
+		std::array<MeshHandle, MaxLevels - 1> meshes;
+		// Projected size (see ProjectedSize()) below which
+		// level i + 1 replaces level i; decreasing.
+		std::array<float, MaxLevels - 1> thresholds{};
+		// Coarser levels in use.
+		uint32_t count = 0;
+		// An Impostors id that takes over from the last
+		// mesh below impostorThreshold, as level count + 1.
+		// Only Scene::World draws it; elsewhere, GPU
+		// culling included, the last mesh stays.
+		uint32_t impostor = NoImpostor;
+		float impostorThreshold = 0.0f;
+
+		inline uint32_t GetLastLevel() const
+		{
+			return count + (impostor != NoImpostor ? 1 : 0);
+		}
+		inline bool IsImpostor(uint32_t level) const
+		{
+			return impostor != NoImpostor && level > count;
+		}
+		// The impostor level's is the last mesh.
+		inline MeshHandle GetMesh(MeshHandle base,
+		                          uint32_t level) const
+		{
+			const auto mesh = level < count ? level : count;
+			return mesh == 0 ? base : meshes[mesh - 1];
+		}
+	};
+
+	struct LodSettings
+	{
+		// Fraction a threshold moves by against the
+		// direction of a switch, so objects hovering around
+		// it don't flip levels every frame.
+		float hysteresis = 0.1f;
+		// Scales projected sizes; below 1 favours coarser
+		// levels.
+		float bias = 1.0f;
+		// Frames a switch cross-fades over, drawing both
+		// levels dithered; 0 switches at once.
+		uint32_t fadeFrames = 0;
+	};
+
+	// An object's selection across frames.
+	struct LodState
+	{
+		uint8_t level = 0;
+		// Level fading out, while fade < 1.
+		uint8_t previous = 0;
+		float fade = 1.0f;
+
+		inline bool IsFading() const { return fade < 1.0f; }
+	};
+
+	// std140 constants of a draw in a cross-fade: the
+	// coverage of the level fading in, negated for the
+	// level fading out, or 1.
+	struct LodFadeConstants
+	{
+		float fade = 1.0f;
+		float padding[3] = {};
+	};
+
+	// GLSL to insert right after the #version line of the
+	// fragment stage of shaders drawing cross-faded
+	// levels. Declares the Constants block with LodFade,
+	// so the shader can't have its own, and LodDither(),
+	// which discards the pixels the other level draws.
+	extern const char* LodFadeShaderSource;
+
+	// Scale from world units at unit depth to the
+	// fraction of the viewport height, from a
+	// column-major view-projection: the length of its
+	// second row, as views are rigid.
+	float GetProjectionScale(const float viewProjection[16]);
+
+	// Fraction of the viewport height the world-space
+	// sphere's diameter covers; the largest float once
+	// the camera is inside it.
+	float ProjectedSize(const float viewProjection[16],
+	                    const BoundingSphere& sphere);
+	float ProjectedSize(const float viewProjection[16],
+	                    float projectionScale,
+	                    const BoundingSphere& sphere);
+
+	// Level for a projected size, moving from current
+	// only past the hysteresis band.
+	uint32_t SelectLod(const LodChain& chain, float size,
+	                   uint32_t current, float hysteresis);
+
+	// Selects the object's level for this frame and
+	// advances its cross-fade by one frame.
+	void UpdateLod(const LodChain& chain, float size,
+	               const LodSettings& settings,
+	               LodState& state);
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Graphics/PipelineState.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	struct MaterialDesc
+	{
+		static constexpr uint32_t MaxTextures = 4;
+
+		// Draws whose own shader is invalid use this one,
+		// e.g. a permutation from GetShaderVariant().
+		ShaderHandle shader;
+		PipelineState state;
+		// Bound to the shader's MaterialConstants block
+		// (see Shader::MaterialConstantsBinding); std140.
+		std::vector<uint8_t> constants;
+
+		// Sampled as 2D arrays; slots without a texture,
+		// or whose texture has no level resident yet,
+		// sample white.
+		std::array<TextureHandle, MaxTextures> textures{};
+		std::array<uint32_t, MaxTextures> layers{};
+		// Multiplies every sample.
+		std::array<float, 4> color{1.0f, 1.0f, 1.0f, 1.0f};
+	};
+
+	// Everything a draw needs besides its mesh, as plain
+	// data; the GPU copy lives in the MaterialTable at the
+	// handle's index.
+	class Material
+	{
+	  public:
+		explicit Material(const MaterialDesc& desc)
+		    : m_desc(desc)
+		{
+		}
+
+		inline const auto& GetDesc() const { return m_desc; }
+		inline void SetDesc(const MaterialDesc& desc)
+		{
+			m_desc = desc;
+		}
+
+	  private:
+		MaterialDesc m_desc;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,235 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Material.h"
+#include "AthiVegam/Graphics/PipelineState.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Graphics/ResourcePool.h"
+#include "AthiVegam/Graphics/Texture.h"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	// Every material's textures and constants in one GL
+	// 4.3 storage buffer indexed by material, so draws with
+	// different materials share one multi-draw: each of its
+	// draws finds its material through gl_DrawID.
+	//
+	// With ARB_bindless_texture the records hold texture
+	// handles and nothing is bound per draw. Otherwise each
+	// slot's 2D array is bound to a texture unit and the
+	// records hold layers; draws merge only while their
+	// materials use the same arrays (a "texture set"), so
+	// batching needs materials packed into shared arrays.
+	//
+	// Each material's shader, pipeline state and constants
+	// are snapshotted alongside, so the render thread reads
+	// them without locking. Pipeline states are
+	// deduplicated into small ids that go into the sort
+	// key, so draws sharing one execute together.
+	class MaterialTable
+	{
+	  public:
+		enum class Mode : uint8_t
+		{
+			// Before GL 4.3; material textures are ignored.
+			Unsupported,
+			Arrays,
+			Bindless
+		};
+
+		enum class Stage : uint8_t
+		{
+			Vertex,
+			Fragment
+		};
+
+		static constexpr uint32_t MaxTextures =
+		    MaterialDesc::MaxTextures;
+		static constexpr uint32_t MaterialsBinding = 1;
+		static constexpr uint32_t DrawMaterialsBinding = 2;
+		// Of RenderManager's draw data, past
+		// VirtualTexture's.
+		static constexpr uint32_t DrawDataBinding = 21;
+		// Arrays mode: slot i is bound to this unit + i.
+		static constexpr uint32_t FirstTextureUnit = 1;
+		static constexpr uint32_t NoTextureSet = 0xFFFFFFFF;
+		// Default PipelineState, used by draws without a
+		// material.
+		static constexpr uint32_t DefaultState = 0;
+
+		MaterialTable() = default;
+		~MaterialTable() = default;
+
+		MaterialTable(const MaterialTable&) = delete;
+		MaterialTable& operator=(const MaterialTable&) = delete;
+
+		void Initialize();
+		void Shutdown();
+
+		inline Mode GetMode() const { return m_mode; }
+		// Whether material draws can be multi-drawn, which
+		// takes ARB_shader_draw_parameters.
+		inline bool CanBatch() const
+		{
+			return m_mode != Mode::Unsupported && m_drawId;
+		}
+
+		// GLSL to insert right after the #version line (430
+		// or later) of shaders drawing with materials. The
+		// vertex stage gets AV_DRAW_MATERIAL(), the index of
+		// the draw's material, to pass on flat, and for
+		// instanced draws AV_DRAW_DATA(), the instance's
+		// RenderCommands::DrawData; the fragment stage gets
+		// SampleMaterial(material, slot, uv), and for
+		// BlendMode::WeightedOit AvWeightedOit(color,
+		// output 0, output 1).
+		const std::string& GetShaderHeader(Stage stage) const;
+
+		// GL thread, once per frame: snapshots every
+		// material and mirrors it into the buffers, with
+		// the levels its textures have streamed in since.
+		void Update(ResourcePool<Material>& materials,
+		            const ResourcePool<Texture>& textures);
+
+		// Whether the last Update() saw the material; ones
+		// created since are in the next frame's.
+		inline bool Contains(MaterialHandle material) const
+		{
+			const auto index = material.GetIndex();
+			return material.IsValid()
+			       && index < m_materials.size()
+			       && m_materials[index].handle == material;
+		}
+
+		// Stamps the material as drawn this frame; the next
+		// Update() passes it on to its textures, which
+		// GpuMemory evicts by. GL thread.
+		inline void MarkUsed(MaterialHandle material) const
+		{
+			if (Contains(material))
+			{
+				m_materials[material.GetIndex()].used = true;
+			}
+		}
+
+		// As of the last Update(), for materials it
+		// contains. Always 0 when not in Arrays mode.
+		inline uint32_t
+		GetTextureSet(MaterialHandle material) const
+		{
+			return Contains(material)
+			           ? m_materials[material.GetIndex()].set
+			           : NoTextureSet;
+		}
+		inline uint32_t
+		GetStateId(MaterialHandle material) const
+		{
+			return Contains(material)
+			           ? m_materials[material.GetIndex()].state
+			           : DefaultState;
+		}
+		inline const PipelineState&
+		GetState(uint32_t id) const
+		{
+			return m_states[id];
+		}
+		// The draw's own shader if valid, else its
+		// material's.
+		inline ShaderHandle
+		ResolveShader(ShaderHandle shader,
+		              MaterialHandle material) const
+		{
+			return shader.IsValid() || !Contains(material)
+			           ? shader
+			           : m_materials[material.GetIndex()]
+			                 .shader;
+		}
+		// Range of GetConstantsBuffer(), or NoConstants.
+		inline RenderCommands::Constants
+		GetConstants(MaterialHandle material) const
+		{
+			return Contains(material)
+			           ? m_materials[material.GetIndex()]
+			                 .constants
+			           : RenderCommands::Constants{};
+		}
+		inline uint32_t GetConstantsBuffer() const
+		{
+			return m_constantsBuffer;
+		}
+		// GL_TEXTURE_2D_ARRAY names, one per slot; empty
+		// when bindless.
+		inline std::span<const uint32_t>
+		GetSetTextures(uint32_t set) const
+		{
+			return set < m_sets.size()
+			           ? std::span<const uint32_t>(m_sets[set])
+			           : std::span<const uint32_t>();
+		}
+
+		// The material index of each entry of the frame's
+		// indirect buffer.
+		void
+		UploadDrawMaterials(std::span<const uint32_t> materials);
+
+	  private:
+		// std430 layout of the GLSL Material struct.
+		struct Record
+		{
+			uint32_t handles[MaxTextures][2];
+			uint32_t layers[MaxTextures];
+			// Finest level resident, -1 for none.
+			float minLods[MaxTextures];
+			float color[4];
+		};
+		static_assert(sizeof(Record) == 80);
+
+		using TextureSet = std::array<uint32_t, MaxTextures>;
+
+		// Render thread view of a material.
+		struct Info
+		{
+			MaterialHandle handle;
+			uint32_t set = NoTextureSet;
+			uint32_t state = DefaultState;
+			ShaderHandle shader;
+			RenderCommands::Constants constants;
+			// Drawn since the last Update().
+			mutable bool used = false;
+		};
+
+		uint32_t FindSet(const TextureSet& set);
+		uint32_t FindState(const PipelineState& state);
+		void BuildHeaders();
+		void UpdateRecords(ResourcePool<Material>& materials,
+		                   const ResourcePool<Texture>& textures);
+		void UpdateConstants();
+
+	  private:
+		Mode m_mode = Mode::Unsupported;
+		bool m_drawId = false;
+		std::array<std::string, 2> m_headers;
+
+		std::vector<Record> m_records;
+		uint32_t m_buffer = 0;
+		size_t m_bufferSize = 0;
+		std::vector<Info> m_materials;
+		std::vector<TextureSet> m_sets;
+		// Never shrinks; there are few distinct states.
+		std::vector<PipelineState> m_states{PipelineState{}};
+
+		// Every material's constants, each aligned to
+		// RenderCommands::ConstantsAlignment.
+		std::vector<uint8_t> m_constantData;
+		std::vector<uint8_t> m_uploadedConstants;
+		uint32_t m_constantsBuffer = 0;
+
+		uint32_t m_drawBuffer = 0;
+		size_t m_drawBufferSize = 0;
+	};
+} // namespace AthiVegam::Graphics
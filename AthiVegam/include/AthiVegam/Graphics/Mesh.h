@@ -1,9 +1,20 @@
 #pragma once
 
+#include "AthiVegam/Graphics/Bounds.h"
+#include "AthiVegam/Graphics/IndexType.h"
+#include "AthiVegam/Graphics/Lod.h"
+#include "AthiVegam/Graphics/Meshlet.h"
+#include "AthiVegam/Graphics/StreamBuffer.h"
+#include "AthiVegam/Graphics/VertexLayout.h"
+
 #include <cstdint>
+#include <memory>
+#include <span>
 
 namespace AthiVegam::Graphics
 {
+	class MeshArena;
+
 	class Mesh
 	{
 	  public:
@@ -12,11 +23,55 @@ namespace AthiVegam::Graphics
 		Mesh(float* vertexArray, uint32_t vertexCount,
 		     uint32_t dimensions, uint32_t* elementArray,
 		     uint32_t elementCount);
+		// Interleaved vertices described by the layout;
+		// vertexData holds vertexCount * stride bytes.
+		Mesh(const VertexLayout& layout, const void* vertexData,
+		     uint32_t vertexCount);
+		Mesh(const VertexLayout& layout, const void* vertexData,
+		     uint32_t vertexCount, const uint32_t* elementArray,
+		     uint32_t elementCount);
+		// Sub-allocates the mesh from a shared arena instead
+		// of creating its own VAO and buffers. Vertices use
+		// the arena's layout; the range is returned to the
+		// arena when the mesh is destroyed.
+		Mesh(MeshArena& arena, const void* vertexData,
+		     uint32_t vertexCount, const uint32_t* elementArray,
+		     uint32_t elementCount);
+		// Dynamic mesh whose contents are replaced with
+		// Update(). Storage is a ring of stream buffers, so
+		// updating never waits on draws still in flight.
+		Mesh(uint32_t dimensions, uint32_t maxVertexCount,
+		     uint32_t maxElementCount);
+		Mesh(const VertexLayout& layout,
+		     uint32_t maxVertexCount,
+		     uint32_t maxElementCount);
+		// Placeholder for a mesh uploaded by
+		// MeshUploadQueue. It owns no GL objects and is
+		// skipped by draws until the upload has landed.
+		explicit Mesh(const VertexLayout& layout,
+		              const Aabb& bounds = Aabb::Infinite());
 		~Mesh();
 
+		Mesh(const Mesh&) = delete;
+		Mesh& operator=(const Mesh&) = delete;
+
+		// Trades GL objects and contents with other, e.g. to
+		// swap a hot reloaded mesh in behind a handle. Levels
+		// of detail stay, as they name other meshes. GL
+		// thread.
+		void Swap(Mesh& other);
+
 		void Bind();
 		void Unbind();
 
+		// Dynamic meshes only. Must be called on the thread
+		// that owns the GL context, at most once per frame
+		// before the mesh's draws are flushed.
+		bool Update(const void* vertexData,
+		            uint32_t vertexCount,
+		            const uint32_t* elementArray = nullptr,
+		            uint32_t elementCount = 0);
+
 		inline auto GetVertexCount() const
 		{
 			return m_vertexCount;
@@ -25,12 +80,88 @@ namespace AthiVegam::Graphics
 		{
 			return m_elementCount;
 		}
+		inline auto GetId() const { return m_vao; }
+		inline auto GetBaseVertex() const
+		{
+			return m_baseVertex;
+		}
+		inline auto GetFirstIndex() const
+		{
+			return m_firstIndex;
+		}
+		inline auto GetIndexType() const
+		{
+			return m_indexType;
+		}
+		inline auto GetArena() const { return m_arena; }
+		inline const auto& GetLayout() const
+		{
+			return m_layout;
+		}
+		inline bool IsDynamic() const
+		{
+			return m_vertexStream != nullptr;
+		}
+		inline bool IsReady() const { return m_ready; }
+		// Local bounds of the positions. A placeholder's
+		// are final once it IsReady(); a dynamic mesh's
+		// change with Update(), on the GL thread.
+		inline const auto& GetBounds() const
+		{
+			return m_bounds;
+		}
+		// Coarser levels drawn in this mesh's place; see
+		// ResourceManager::SetMeshLods().
+		inline const auto& GetLods() const { return m_lods; }
+		inline void SetLods(const LodChain& lods)
+		{
+			m_lods = lods;
+		}
+		// Arena meshes only; uploads the meshlets the GPU
+		// culls the mesh's triangles by, replacing any.
+		// GL thread.
+		void SetMeshlets(std::span<const Meshlet> meshlets);
+		// A shader storage buffer of GetMeshletCount()
+		// Meshlets, or 0.
+		inline auto GetMeshletBuffer() const
+		{
+			return m_meshletBuffer;
+		}
+		inline auto GetMeshletCount() const
+		{
+			return m_meshletCount;
+		}
+
+	  private:
+		// Compaction moves arena meshes.
+		friend class MeshArena;
+		// Fills in placeholders once their upload lands.
+		friend class MeshUploadQueue;
 
 	  private:
 		uint32_t m_vertexCount;
 		uint32_t m_elementCount;
 		uint32_t m_vao;
 		uint32_t m_ebo;
-		uint32_t m_positionsVbo;
+		uint32_t m_vbo;
+
+		MeshArena* m_arena;
+		uint32_t m_baseVertex;
+		uint32_t m_firstIndex;
+		// Chosen from the vertex count; element arrays are
+		// always passed in as uint32_t.
+		IndexType m_indexType;
+
+		VertexLayout m_layout;
+		Aabb m_bounds;
+		LodChain m_lods;
+		uint32_t m_meshletBuffer = 0;
+		uint32_t m_meshletCount = 0;
+		uint32_t m_maxVertexCount;
+		uint32_t m_maxElementCount;
+		std::unique_ptr<StreamBuffer> m_vertexStream;
+		std::unique_ptr<StreamBuffer> m_indexStream;
+
+		bool m_ready;
 	};
 } // namespace AthiVegam::Graphics
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "AthiVegam/Graphics/IndexType.h"
+#include "AthiVegam/Graphics/VertexLayout.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	class Mesh;
+
+	// A shared vertex/index buffer pair with a single VAO.
+	// Meshes created in an arena are (offset, count) views
+	// into it, so every draw from the arena can be batched
+	// into one multi-draw without rebinding.
+	//
+	// Freed ranges are reused first-fit. When the remaining
+	// space is too fragmented for an allocation the arena
+	// compacts itself and moves its meshes' offsets.
+	class MeshArena
+	{
+	  public:
+		struct Allocation
+		{
+			uint32_t baseVertex = 0;
+			uint32_t firstIndex = 0;
+			bool valid = false;
+		};
+
+		// A UInt16 arena only takes meshes of up to 65536
+		// vertices; the arena itself can hold more.
+		MeshArena(uint32_t dimensions,
+		          uint32_t vertexCapacity,
+		          uint32_t indexCapacity,
+		          IndexType indexType = IndexType::UInt32);
+		MeshArena(const VertexLayout& layout,
+		          uint32_t vertexCapacity,
+		          uint32_t indexCapacity,
+		          IndexType indexType = IndexType::UInt32);
+		~MeshArena();
+
+		MeshArena(const MeshArena&) = delete;
+		MeshArena& operator=(const MeshArena&) = delete;
+
+		// Called by Mesh; the arena keeps track of its
+		// meshes so compaction can update their offsets.
+		Allocation Allocate(Mesh& owner,
+		                    const void* vertexData,
+		                    uint32_t vertexCount,
+		                    const uint32_t* elementArray,
+		                    uint32_t elementCount);
+		// Reserves the ranges without uploading; fill them
+		// with CopyFrom(). The owner must take the returned
+		// offsets and counts right away.
+		Allocation Reserve(Mesh& owner, uint32_t vertexCount,
+		                   uint32_t elementCount);
+		// GPU-side copy from a staging buffer holding the
+		// vertices and indices (in the arena's index type) at
+		// the given byte offsets.
+		void CopyFrom(uint32_t sourceBuffer,
+		              size_t vertexOffset, size_t indexOffset,
+		              const Allocation& allocation,
+		              uint32_t vertexCount,
+		              uint32_t elementCount);
+		void Free(Mesh& owner);
+		// Called by Mesh::Swap(); the two meshes trade
+		// places in the arena's tracking.
+		void SwapOwners(Mesh& a, Mesh& b);
+
+		// True if the arena has room for the counts, possibly
+		// after compacting.
+		bool CanFit(uint32_t vertexCount,
+		            uint32_t elementCount) const;
+
+		// Moves every mesh down so all free space is at the
+		// end of the buffers.
+		void Compact();
+
+		inline auto GetVao() const { return m_vao; }
+		// Changes as the arena grows.
+		inline auto GetIndexBuffer() const { return m_ebo; }
+		inline const auto& GetLayout() const
+		{
+			return m_layout;
+		}
+		inline auto GetIndexType() const
+		{
+			return m_indexType;
+		}
+		inline auto GetVertexCount() const
+		{
+			return m_vertices.used;
+		}
+		inline auto GetIndexCount() const
+		{
+			return m_indices.used;
+		}
+		inline auto GetMeshCount() const
+		{
+			return static_cast<uint32_t>(m_meshes.size());
+		}
+
+	  private:
+		struct Range
+		{
+			uint32_t offset;
+			uint32_t count;
+		};
+
+		// Holes below head, sorted by offset.
+		struct RangeAllocator
+		{
+			std::vector<Range> holes;
+			uint32_t head = 0;
+			uint32_t capacity = 0;
+			uint32_t used = 0;
+
+			bool Allocate(uint32_t count, uint32_t& offset);
+			void Free(uint32_t offset, uint32_t count);
+		};
+
+		void CreateBuffers(uint32_t& vbo, uint32_t& ebo) const;
+		int64_t GetGpuSize() const;
+		void BindBuffers();
+
+	  private:
+		VertexLayout m_layout;
+		IndexType m_indexType;
+		RangeAllocator m_vertices;
+		RangeAllocator m_indices;
+		std::vector<Mesh*> m_meshes;
+
+		uint32_t m_vao;
+		uint32_t m_vbo;
+		uint32_t m_ebo;
+	};
+} // namespace AthiVegam::Graphics
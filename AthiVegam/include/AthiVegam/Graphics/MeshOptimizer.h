@@ -0,0 +1,59 @@
+#pragma once
+
+#include "AthiVegam/Graphics/VertexLayout.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	// Load-time reordering of indexed triangle lists. Each
+	// pass keeps the rendered result identical; only the
+	// order and sharing of vertices and triangles change.
+	namespace MeshOptimizer
+	{
+		struct Options
+		{
+			// Merge byte-identical vertices.
+			bool weldVertices = true;
+			// Reorder triangles for the post-transform
+			// vertex cache.
+			bool vertexCache = true;
+			// Reorder clusters of triangles so outward
+			// facing ones are drawn first. Needs a float
+			// position at location 0.
+			bool overdraw = true;
+			// Reorder vertices by first use and drop unused
+			// ones.
+			bool vertexFetch = true;
+		};
+
+		// Runs the enabled passes in the order that keeps
+		// each one's gains. vertices holds vertexCount *
+		// stride bytes and may shrink.
+		void Optimize(const VertexLayout& layout,
+		              std::vector<uint8_t>& vertices,
+		              std::vector<uint32_t>& indices,
+		              const Options& options = {});
+
+		// Remaps indices so duplicate vertices share one
+		// index. Leaves the vertices themselves untouched.
+		void WeldVertices(const uint8_t* vertices,
+		                  uint32_t vertexCount, uint32_t stride,
+		                  std::vector<uint32_t>& indices);
+
+		void OptimizeVertexCache(std::vector<uint32_t>& indices,
+		                         uint32_t vertexCount);
+
+		void OptimizeOverdraw(std::vector<uint32_t>& indices,
+		                      const uint8_t* vertices,
+		                      uint32_t vertexCount,
+		                      uint32_t stride,
+		                      uint32_t positionOffset);
+
+		// Returns the new vertex count.
+		uint32_t OptimizeVertexFetch(
+		    std::vector<uint8_t>& vertices, uint32_t stride,
+		    std::vector<uint32_t>& indices);
+	} // namespace MeshOptimizer
+} // namespace AthiVegam::Graphics
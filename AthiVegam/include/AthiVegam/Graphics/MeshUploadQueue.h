@@ -0,0 +1,97 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Graphics/MeshArena.h"
+#include "AthiVegam/Graphics/StreamBuffer.h"
+#include "AthiVegam/Graphics/VertexLayout.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace AthiVegam::Managers
+{
+	class ResourceManager;
+}
+
+namespace AthiVegam::Graphics
+{
+	// Streams static meshes to the GPU in the background.
+	// Any thread may push geometry; the GL thread copies a
+	// time-budgeted share of it into a persistently mapped
+	// staging ring each frame and moves it into the shared
+	// arenas on the GPU. A mesh becomes drawable once the
+	// fence of its batch has signalled.
+	class MeshUploadQueue
+	{
+	  public:
+		struct Request
+		{
+			MeshHandle mesh;
+			VertexLayout layout;
+			std::vector<uint8_t> vertices;
+			std::vector<uint32_t> indices;
+			uint32_t vertexCount = 0;
+		};
+
+		MeshUploadQueue() = default;
+		~MeshUploadQueue() = default;
+
+		MeshUploadQueue(const MeshUploadQueue&) = delete;
+		MeshUploadQueue& operator=(const MeshUploadQueue&) =
+		    delete;
+
+		// stagingSize is the number of bytes that can be
+		// staged per frame.
+		void Initialize(size_t stagingSize);
+		void Shutdown();
+
+		// Thread safe.
+		void Push(Request&& request);
+
+		// GL thread only. Publishes finished batches and
+		// stages pending requests until budgetMs is spent.
+		// At least one request is staged per call.
+		void Process(Managers::ResourceManager& resources,
+		             double budgetMs);
+
+		// Meshes not yet drawable. GL thread only.
+		size_t GetPendingCount();
+
+	  private:
+		struct Copy
+		{
+			Mesh* mesh;
+			MeshHandle handle;
+			size_t vertexOffset;
+			size_t indexOffset;
+		};
+
+		struct Batch
+		{
+			GLsync fence;
+			std::vector<MeshHandle> meshes;
+		};
+
+		void PublishBatches(
+		    Managers::ResourceManager& resources);
+		bool PopRequest(Request& request, size_t available);
+		// Finds space for the mesh in a shared arena, uploading
+		// the data right away when upload is set. Meshes too
+		// big for an arena are created standalone in place.
+		Mesh* Place(Managers::ResourceManager& resources,
+		            const Request& request, bool upload);
+
+		static size_t GetStagedSize(const Request& request);
+
+	  private:
+		std::unique_ptr<StreamBuffer> m_staging;
+		std::mutex m_requestsMutex;
+		std::deque<Request> m_requests;
+		std::vector<Copy> m_copies;
+		std::vector<Batch> m_batches;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Uniform.h"
+
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// A cluster of neighbouring triangles of a mesh, as
+	// tools/cookmeshes.py splits dense meshes into, with
+	// what GpuCulling needs to drop it. Its triangles are
+	// contiguous in the mesh's indices. std430, and the
+	// same layout in a mesh pack.
+	struct Meshlet
+	{
+		static constexpr uint32_t MaxVertices = 64;
+		static constexpr uint32_t MaxTriangles = 124;
+
+		// Mesh-space bounding sphere (center, radius).
+		Float4 sphere;
+		// Axis (xyz) and cutoff (w) of the cone around the
+		// triangles' normals: from a point p, all of them
+		// face away when
+		//   dot(c - p, axis) >= cutoff * |c - p| + radius
+		// for the sphere's center c. A zero axis with a
+		// cutoff of 1 is never back-facing.
+		Float4 cone;
+		// Relative to the mesh's first index.
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		uint32_t reserved[2];
+	};
+
+	static_assert(sizeof(Meshlet) == 48);
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Graphics/Uniform.h"
+#include "AthiVegam/Math/Matrix.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <utility>
+
+typedef struct __GLsync* GLsync;
+
+namespace AthiVegam::Graphics
+{
+	class Shader;
+
+	// Click-to-select: finds the object drawn at a pixel
+	// by rendering object ids into an integer target and
+	// reading the one under the pixel back. The pass only
+	// runs on frames with a request, and a pick matrix
+	// narrows the view to the requested pixel, so the
+	// target is 1x1 and the pass costs the vertices alone.
+	// The id is read into a pixel buffer and handed over
+	// once its fence has signalled, a frame or two later,
+	// so the GL thread never waits on glReadPixels.
+	//
+	// GL thread only.
+	class ObjectPicker
+	{
+	  public:
+		// Where no object is drawn.
+		static constexpr uint32_t NoObject = 0;
+		static constexpr uint32_t SlotCount = 3;
+
+		struct Item
+		{
+			MeshHandle mesh;
+			Math::Mat4 transform;
+			// Anything but NoObject, e.g. an entity.
+			uint32_t id = NoObject;
+		};
+
+		// The id drawn at the requested pixel.
+		using Callback =
+		    std::function<void(uint32_t id, int x, int y)>;
+
+		ObjectPicker();
+		~ObjectPicker();
+
+		ObjectPicker(const ObjectPicker&) = delete;
+		ObjectPicker& operator=(const ObjectPicker&) = delete;
+
+		void Initialize();
+		void Shutdown();
+		inline bool IsInitialized() const
+		{
+			return m_framebuffer != 0;
+		}
+
+		inline void SetCallback(Callback callback)
+		{
+			m_callback = std::move(callback);
+		}
+
+		// A pixel of the view given to Render(), from its
+		// top-left as Input::Mouse reports it. A later
+		// request replaces one not yet rendered.
+		void Request(int x, int y);
+		// At Input::Mouse::X() and Y().
+		void RequestAtMouse();
+		inline bool IsRequested() const
+		{
+			return m_requested;
+		}
+
+		// Once a frame: if a pick was requested, draws the
+		// items' ids as seen through viewProjection on a
+		// view of width by height pixels and starts reading
+		// the result back. Restores the framebuffer and
+		// viewport bound before it.
+		void Render(const Math::Mat4& viewProjection,
+		            int width, int height,
+		            std::span<const Item> items);
+		// Hands finished picks to the callback, oldest
+		// first; with wait, also those still in flight.
+		void Poll(bool wait = false);
+
+	  private:
+		struct Slot
+		{
+			uint32_t buffer = 0;
+			GLsync fence = nullptr;
+			int x = 0;
+			int y = 0;
+		};
+
+		bool Deliver(Slot& slot, bool wait);
+
+	  private:
+		std::unique_ptr<Shader> m_shader;
+		UniformHandle<Math::Mat4> m_transformUniform;
+		UniformHandle<int> m_idUniform;
+		uint32_t m_framebuffer = 0;
+		uint32_t m_color = 0;
+		uint32_t m_depth = 0;
+
+		Callback m_callback;
+		std::array<Slot, SlotCount> m_slots;
+		uint32_t m_next = 0;
+
+		bool m_requested = false;
+		int m_requestX = 0;
+		int m_requestY = 0;
+	};
+} // namespace AthiVegam::Graphics
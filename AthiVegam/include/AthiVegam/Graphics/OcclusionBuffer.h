@@ -0,0 +1,78 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Bounds.h"
+#include "AthiVegam/Graphics/Uniform.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	// A low-resolution depth buffer that the CPU
+	// rasterizes an app's large occluders (walls, floors,
+	// terrain) into each frame. CullingSet then rejects
+	// the objects hidden behind them before anything is
+	// submitted. Occluders are the current frame's, so
+	// nothing lags a frame as the GPU pyramid does (see
+	// GpuCulling).
+	//
+	// Tests are conservative: occluders cover only the
+	// pixels whose centers they contain, objects every
+	// pixel they touch, and occluder triangles crossing
+	// the near plane are dropped. Begin(), AddOccluder()
+	// and Finish() on one thread; IsOccluded() on any
+	// thread afterwards.
+	class OcclusionBuffer
+	{
+	  public:
+		static constexpr int DefaultWidth = 256;
+		static constexpr int DefaultHeight = 128;
+		// Pixels per side of the tiles whose farthest depth
+		// lets most tests skip the pixels.
+		static constexpr int TileSize = 8;
+
+		explicit OcclusionBuffer(int width = DefaultWidth,
+		                         int height = DefaultHeight);
+
+		// Clears the buffer for a column-major
+		// view-projection with GL's [-1, 1] clip depth.
+		void Begin(const float viewProjection[16]);
+		// Triangles of positions, transformed by a
+		// column-major model matrix. Occluders must be
+		// solid: anything behind a triangle is hidden.
+		void AddOccluder(std::span<const Float3> positions,
+		                 std::span<const uint32_t> indices,
+		                 const float transform[16]);
+		// The twelve triangles of a solid box.
+		void AddOccluder(const Aabb& box,
+		                 const float transform[16]);
+		void Finish();
+
+		// Whether every pixel the sphere may cover has an
+		// occluder in front of it.
+		bool IsOccluded(const BoundingSphere& sphere) const;
+
+		inline int GetWidth() const { return m_width; }
+		inline int GetHeight() const { return m_height; }
+		// Window depth per pixel, 1 where nothing was drawn;
+		// bottom row first. For debug views.
+		inline const std::vector<float>& GetDepth() const
+		{
+			return m_depth;
+		}
+
+	  private:
+		void RasterizeTriangle(const Float4& a, const Float4& b,
+		                       const Float4& c);
+
+	  private:
+		int m_width;
+		int m_height;
+		int m_tilesX;
+		int m_tilesY;
+		float m_viewProjection[16] = {};
+		std::vector<float> m_depth;
+		std::vector<float> m_tileFarthest;
+	};
+} // namespace AthiVegam::Graphics
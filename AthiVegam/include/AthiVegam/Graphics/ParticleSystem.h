@@ -0,0 +1,203 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Graphics/PipelineState.h"
+#include "AthiVegam/Graphics/Uniform.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	class CommandList;
+	class Shader;
+
+	// Where and how a burst of particles starts.
+	struct ParticleEmitter
+	{
+		Float3 position{0.0f, 0.0f, 0.0f};
+		// Particles start anywhere in this sphere.
+		float radius = 0.0f;
+		Float3 velocity{0.0f, 0.0f, 0.0f};
+		// Speed added in a random direction, up to this.
+		float spread = 1.0f;
+		// Seconds, picked per particle.
+		float minLifetime = 1.0f;
+		float maxLifetime = 2.0f;
+		// Sizes and colors blend from start to end over
+		// a particle's life.
+		float startSize = 0.1f;
+		float endSize = 0.1f;
+		std::array<float, 4> startColor{1.0f, 1.0f, 1.0f,
+		                                1.0f};
+		std::array<float, 4> endColor{1.0f, 1.0f, 1.0f, 0.0f};
+		// Radians per second, picked per particle.
+		float minSpin = 0.0f;
+		float maxSpin = 0.0f;
+	};
+
+	// Particles that live on the GPU from spawn to death.
+	// A fixed pool in shader storage holds them, with a
+	// list of free slots and two alternating lists of live
+	// ones; compute passes spawn into free slots, move the
+	// live ones and retire the dead, and write the counts
+	// an indirect draw of camera-facing quads reads. With
+	// sorting on, a bitonic sort orders the quads back to
+	// front for alpha blending; its passes are dispatched
+	// indirectly too, sized by the live count. The CPU
+	// only records emitters and never reads a particle.
+	//
+	// Emit() is callable from any thread; Draw() records
+	// from any thread as well, and the draw shows the last
+	// Simulate() before it executes. Everything else is
+	// GL 4.3, GL thread only; the draw also needs shader
+	// storage in vertex shaders, which desktop drivers
+	// have.
+	class ParticleSystem
+	{
+	  public:
+		// Emitters a single dispatch spawns from; more
+		// take more dispatches.
+		static constexpr uint32_t MaxEmitters = 64;
+		// Shader storage bindings of the passes, past
+		// ClusteredLighting's.
+		static constexpr uint32_t ParticlesBinding = 10;
+		static constexpr uint32_t DeadBinding = 11;
+		static constexpr uint32_t AliveBinding = 12;
+		static constexpr uint32_t NextAliveBinding = 13;
+		static constexpr uint32_t StateBinding = 14;
+		static constexpr uint32_t OrderBinding = 15;
+		// Uniform block binding of the emitters, past
+		// CascadedShadows::ShadowsBinding.
+		static constexpr uint32_t EmittersBinding = 3;
+		// Elements a workgroup of the sort orders in
+		// shared memory.
+		static constexpr uint32_t SortBlock = 1024;
+
+		struct Settings
+		{
+			// Particles alive at once; spawns past it are
+			// dropped.
+			uint32_t capacity = 1u << 20;
+			// Back to front, for alpha blending. Additive
+			// and weighted OIT particles don't need it.
+			bool sort = true;
+			Float3 gravity{0.0f, -9.81f, 0.0f};
+			// Fraction of the velocity lost per second.
+			float drag = 0.0f;
+		};
+
+		ParticleSystem();
+		explicit ParticleSystem(const Settings& settings);
+		~ParticleSystem();
+
+		ParticleSystem(const ParticleSystem&) = delete;
+		ParticleSystem&
+		operator=(const ParticleSystem&) = delete;
+
+		// Compiles the passes and allocates the pool;
+		// false without GL 4.3.
+		bool Initialize();
+		void Shutdown();
+		inline bool IsInitialized() const
+		{
+			return m_simulateProgram != 0;
+		}
+
+		// Spawns count particles in the next Simulate().
+		void Emit(const ParticleEmitter& emitter,
+		          uint32_t count);
+		// Spawns what was emitted since the last call and
+		// moves every particle by deltaTime. eye is the
+		// camera position the sort orders by.
+		void Simulate(float deltaTime, const Float3& eye);
+
+		// Records the particles as a DrawParticles command
+		// with column-major view and view-projection
+		// matrices. They draw last among the translucent
+		// draws of the sort key layer renderLayer, or with
+		// BlendMode::WeightedOit in its unsorted OIT run.
+		void Draw(CommandList& list,
+		          const float viewProjection[16],
+		          const float view[16],
+		          TextureHandle texture = {},
+		          uint8_t renderLayer = 0,
+		          BlendMode blend = BlendMode::Alpha) const;
+
+		inline const Settings& GetSettings() const
+		{
+			return m_settings;
+		}
+
+	  private:
+		// Mirrors the State block of the passes.
+		struct State
+		{
+			int32_t deadCount;
+			uint32_t aliveCount[2];
+			uint32_t padding;
+			uint32_t simulateArgs[4];
+			// DrawArraysIndirectCommand.
+			uint32_t drawArgs[4];
+			// Followed by a dispatch per sort level.
+		};
+		// Mirrors the std140 Emitter struct.
+		struct EmitterData
+		{
+			float position[4];
+			float velocity[4];
+			float startColor[4];
+			float endColor[4];
+			// Lifetimes, then sizes.
+			float lifetimeSize[4];
+			float spin[2];
+			// First spawn index of the emitter.
+			uint32_t first;
+			uint32_t padding;
+		};
+		struct PendingEmit
+		{
+			ParticleEmitter emitter;
+			uint32_t count;
+		};
+
+		void Spawn(std::span<const PendingEmit> emits);
+		void Sort();
+		void DispatchIndirect(size_t offset) const;
+
+	  private:
+		Settings m_settings;
+		// Levels of the sort: one sorting each block, then
+		// one merging each doubling of the sorted length.
+		uint32_t m_sortLevels = 0;
+
+		uint32_t m_emitProgram = 0;
+		uint32_t m_prepareProgram = 0;
+		uint32_t m_simulateProgram = 0;
+		uint32_t m_sortProgram = 0;
+		std::unique_ptr<Shader> m_drawShader;
+		std::unique_ptr<Shader> m_drawOitShader;
+		uint32_t m_vao = 0;
+		uint32_t m_defaultTexture = 0;
+
+		uint32_t m_particleBuffer = 0;
+		uint32_t m_deadBuffer = 0;
+		std::array<uint32_t, 2> m_aliveBuffers{};
+		uint32_t m_stateBuffer = 0;
+		uint32_t m_orderBuffer = 0;
+		uint32_t m_emitterBuffer = 0;
+		// Alive list the last Simulate() left the
+		// particles in.
+		uint32_t m_current = 0;
+		uint32_t m_seed = 0;
+
+		std::mutex m_emitMutex;
+		std::vector<PendingEmit> m_emits;
+		std::vector<PendingEmit> m_spawning;
+		std::vector<EmitterData> m_emitterData;
+	};
+} // namespace AthiVegam::Graphics
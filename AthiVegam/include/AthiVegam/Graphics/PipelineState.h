@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	enum class BlendMode : uint8_t
+	{
+		Opaque,
+		// Source alpha over the destination.
+		Alpha,
+		Additive,
+		// Color already multiplied by its alpha.
+		Premultiplied,
+		// Weighted blended order-independent transparency:
+		// drawn unsorted into Graphics::WeightedOit's
+		// targets, without writing depth, by shaders that
+		// write AvWeightedOit() (see MaterialTable).
+		WeightedOit
+	};
+
+	enum class CompareFunc : uint8_t
+	{
+		Less,
+		LessEqual,
+		Equal,
+		Greater,
+		Always
+	};
+
+	enum class CullMode : uint8_t
+	{
+		None,
+		Back,
+		Front
+	};
+
+	// Fixed-function state a material draws with. The
+	// defaults are the state every draw had before
+	// materials, and what draws without one get.
+	struct PipelineState
+	{
+		BlendMode blend = BlendMode::Alpha;
+		bool depthTest = true;
+		bool depthWrite = true;
+		CompareFunc depthFunc = CompareFunc::LessEqual;
+		CullMode cull = CullMode::None;
+
+		constexpr bool
+		operator==(const PipelineState&) const = default;
+	};
+} // namespace AthiVegam::Graphics
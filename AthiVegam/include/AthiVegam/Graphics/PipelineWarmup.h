@@ -0,0 +1,48 @@
+#pragma once
+
+#include "AthiVegam/Graphics/PipelineState.h"
+#include "AthiVegam/Graphics/ResourcePool.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Graphics/VertexLayout.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace AthiVegam::Graphics
+{
+	class RenderState;
+
+	// Drivers often finish a program for the vertex format
+	// and state it is first drawn with, so even a program
+	// from ProgramBinaryCache can hitch on its first draw.
+	// With the "r.recordPipelines" CVar on, every shader,
+	// vertex layout and state that mesh draws combine is
+	// logged; Warm() then draws each combination once
+	// offscreen, e.g. behind a loading screen, so play
+	// doesn't. Shaders are named by their source hash, so
+	// a log collected in one session serves later ones.
+	namespace PipelineWarmup
+	{
+		// Render thread, per mesh draw; a no-op unless
+		// recording.
+		void Record(const Shader& shader,
+		            const VertexLayout& layout,
+		            const PipelineState& state,
+		            bool instanced);
+
+		// Adds a saved log's combinations. A missing file
+		// is an empty log.
+		bool Load(const std::string& path);
+		// Writes every combination recorded or loaded, if
+		// any were recorded since Load().
+		bool Save(const std::string& path);
+		size_t GetCount();
+
+		// GL thread. Draws each combination whose shader is
+		// ready among shaders into a 1x1 target, going
+		// through state. Returns how many were drawn.
+		uint32_t Warm(ResourcePool<Shader>& shaders,
+		              RenderState& state);
+	} // namespace PipelineWarmup
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	// On-disk cache of linked program binaries, keyed by the
+	// shader sources and the driver that produced them. A
+	// missing, stale or rejected entry just means the caller
+	// compiles from source and stores a fresh binary.
+	namespace ProgramBinaryCache
+	{
+		// Reads the cached entries into memory so Load()
+		// does not wait on the disk. Needs no GL context, so
+		// it can run as a job while the context is created;
+		// it must finish before Initialize().
+		void Prefetch(const std::string& directory);
+		// Needs a current GL context. An empty directory or a
+		// driver without binary formats disables the cache.
+		void Initialize(const std::string& directory);
+		void Shutdown();
+		bool IsEnabled();
+
+		// Loads a cached binary into the program. Returns
+		// true if the program is linked and ready to use,
+		// with metadata as stored alongside.
+		bool Load(uint32_t program, const std::string& vertex,
+		          const std::string& fragment,
+		          std::vector<uint8_t>& metadata);
+		// Writes the binary of a successfully linked
+		// program, and the caller's metadata about it, e.g.
+		// its reflection. The program must have been linked
+		// with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+		void Store(uint32_t program, const std::string& vertex,
+		           const std::string& fragment,
+		           std::span<const uint8_t> metadata);
+	} // namespace ProgramBinaryCache
+} // namespace AthiVegam::Graphics
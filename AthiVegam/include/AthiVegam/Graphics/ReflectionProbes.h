@@ -0,0 +1,151 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Math/Vector.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	class RenderState;
+
+	// Environment reflections for ClusteredLighting's
+	// probes: one cube map of radiance per probe, in a
+	// GL_TEXTURE_CUBE_MAP_ARRAY layer, with box-filtered
+	// levels for rougher surfaces.
+	//
+	// Probes start from a baked cache, BC6H-compressed as
+	// SaveCache() wrote it, and dynamic ones are then
+	// relit as the time of day changes, a few faces per
+	// Update() on a fixed schedule, rather than all at
+	// once: the reflection cost per frame stays flat
+	// whatever the probe count. A probe's six faces render
+	// into a scratch cube map and replace its layer
+	// together, so a half-relit probe is never sampled.
+	//
+	// GL 4.3; GL thread only.
+	class ReflectionProbes
+	{
+	  public:
+		struct Settings
+		{
+			// Of a face, a power of two.
+			uint32_t size = 128;
+			uint32_t maxProbes = 32;
+			// Faces rendered per Update().
+			uint32_t facesPerFrame = 1;
+			float zNear = 0.1f;
+			float zFar = 1000.0f;
+		};
+
+		// Draws the scene, lit as it is now, into the bound
+		// framebuffer, with column-major view and
+		// projection matrices. The viewport is set.
+		using FaceRenderer = std::function<void(
+		    const float view[16], const float projection[16])>;
+
+		ReflectionProbes();
+		explicit ReflectionProbes(const Settings& settings);
+		~ReflectionProbes();
+
+		ReflectionProbes(const ReflectionProbes&) = delete;
+		ReflectionProbes&
+		operator=(const ReflectionProbes&) = delete;
+
+		// False, after logging why, without GL 4.3.
+		bool Initialize();
+		void Shutdown();
+		inline bool IsInitialized() const
+		{
+			return m_array != 0;
+		}
+
+		// The layer, for LightProbe::reflectionLayer, or -1
+		// when maxProbes are in use. Black until relit or
+		// loaded. Dynamic probes are relit by Update().
+		int32_t AddProbe(const Math::Vec3& position,
+		                 bool dynamic = true);
+		void SetDynamic(int32_t layer, bool dynamic);
+		void Clear();
+		inline uint32_t GetProbeCount() const
+		{
+			return static_cast<uint32_t>(m_probes.size());
+		}
+
+		inline void SetRenderer(FaceRenderer renderer)
+		{
+			m_renderer = std::move(renderer);
+		}
+
+		// Once per frame: renders the next facesPerFrame
+		// faces of the dynamic probes in turn.
+		void Update();
+		// Relights every probe at once, e.g. to bake.
+		void RenderAll();
+
+		// Compresses every probe's levels to BC6H, through
+		// the driver, into a Core::Serial file. Offline;
+		// the state cache is invalidated.
+		bool SaveCache(const std::string& path,
+		               RenderState& state);
+		// Replaces the probes with a cache's, saved with the
+		// same size, decoding it into the array. False,
+		// with an error logged, otherwise. The state cache
+		// is invalidated.
+		bool LoadCache(const std::string& path,
+		               RenderState& state);
+
+		// For ClusteredLighting::SetProbeTextures().
+		inline uint32_t GetTexture() const { return m_array; }
+		// For LightProbe::reflectionLevels.
+		inline uint32_t GetLevelCount() const
+		{
+			return m_levelCount;
+		}
+
+	  private:
+		struct Probe
+		{
+			Math::Vec3 position;
+			bool dynamic = true;
+		};
+
+		bool CreateTargets();
+		void DestroyTargets();
+		// Black, for a probe added.
+		void ClearLayer(uint32_t layer);
+		void RenderFace(const Probe& probe, uint32_t face);
+		// Filters the scratch cube map's levels and copies
+		// them into the probe's layer.
+		void Finish(uint32_t layer);
+		// Next dynamic probe after m_current; -1 if none.
+		int32_t NextDynamic() const;
+
+	  private:
+		Settings m_settings;
+		uint32_t m_levelCount = 0;
+		std::vector<Probe> m_probes;
+		FaceRenderer m_renderer;
+
+		// RGBA16F, six layers per probe.
+		uint32_t m_array = 0;
+		uint32_t m_scratch = 0;
+		uint32_t m_depth = 0;
+		uint32_t m_framebuffer = 0;
+
+		// The probe being relit and its next face.
+		int32_t m_current = -1;
+		uint32_t m_face = 0;
+
+		// Draws a BC6H face's level into the array.
+		std::unique_ptr<Shader> m_decodeShader;
+		UniformHandle<int> m_decodeLevel;
+		// No attributes; the triangle comes from
+		// gl_VertexID.
+		uint32_t m_vao = 0;
+	};
+} // namespace AthiVegam::Graphics
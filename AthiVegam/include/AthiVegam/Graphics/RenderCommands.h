@@ -1,32 +1,529 @@
 #pragma once
 
-#include <memory>
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Graphics/IndexType.h"
+#include "AthiVegam/Graphics/PipelineState.h"
+#include "AthiVegam/Log.h"
+
+#include <cstdint>
+
+namespace AthiVegam::Managers
+{
+	class ResourceManager;
+}
 
 namespace AthiVegam::Graphics
 {
-	class Mesh;
-	class Shader;
+	class RenderState;
 
 	namespace RenderCommands
 	{
-		class RenderCommand
+		// Tag stored in front of every command in a
+		// CommandBuffer, used to dispatch without virtual
+		// calls.
+		enum class CommandType : uint8_t
+		{
+			RenderMesh,
+			RenderMeshInstanced,
+			MultiDrawIndirect,
+			DrawUi,
+			DrawSprites,
+			DrawParticles,
+			DrawTerrain,
+			DrawImpostors,
+			DrawFoliage,
+			DrawLines,
+			Dispatch,
+			DispatchIndirect,
+			COUNT
+		};
+
+		// Per-instance data consumed by instanced draws as a
+		// column-major mat4 starting at
+		// InstanceTransformLocation.
+		struct InstanceTransform
+		{
+			float m[16];
+		};
+
+		// Per-instance data beside the transform, which
+		// shaders read from a storage buffer through
+		// AV_DRAW_DATA() (see MaterialTable), so draws that
+		// differ only in it still share a multi-draw. std430.
+		struct DrawData
+		{
+			// E.g. the scene object, for picking.
+			uint32_t objectId = 0;
+			uint32_t user = 0;
+			float params[2] = {};
+		};
+		static_assert(sizeof(DrawData) == 16);
+
+		constexpr uint32_t InstanceTransformLocation = 4;
+		// Generic uvec3 attribute, never enabled, through
+		// which draws pass their material and first instance
+		// (see MaterialTable) without a per-program uniform.
+		constexpr uint32_t DrawMaterialLocation = 8;
+		constexpr uint32_t NoInstance = 0xFFFFFFFF;
+
+		// Per-draw constants live in the frame's constant
+		// ring; every push starts on a boundary that
+		// satisfies any GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+		constexpr uint32_t ConstantsAlignment = 256;
+		constexpr uint32_t NoConstants = 0xFFFFFFFF;
+
+		// Slice of the constant ring bound to the shader's
+		// Constants block while a draw executes.
+		struct Constants
+		{
+			uint32_t offset = NoConstants;
+			uint32_t size = 0;
+
+			constexpr bool
+			operator==(const Constants&) const = default;
+		};
+
+		// Compute dispatches draw nothing; draw-only passes
+		// skip them.
+		constexpr bool IsDispatch(CommandType type)
+		{
+			return type == CommandType::Dispatch
+			       || type == CommandType::DispatchIndirect;
+		}
+
+		struct DrawElementsIndirect;
+
+		// Everything a command needs while executing.
+		struct ExecuteContext
+		{
+			RenderState& state;
+			const Managers::ResourceManager& resources;
+			uint32_t instanceBuffer;
+			uint32_t indirectBuffer;
+			uint32_t constantBuffer;
+			// Offset of the executing command's list within
+			// the combined instance data.
+			uint32_t instanceBase;
+			// Byte offset of the executing command's list
+			// within the constant ring.
+			uint32_t constantBase;
+			// CPU copy of the indirect buffer, for stats.
+			const DrawElementsIndirect* indirectDraws;
+		};
+
+		// Layout of GL_DRAW_INDIRECT_BUFFER entries.
+		struct DrawElementsIndirect
 		{
-		  public:
-			virtual void Execute() = 0;
-			virtual ~RenderCommand() = default;
+			uint32_t count;
+			uint32_t instanceCount;
+			uint32_t firstIndex;
+			int32_t baseVertex;
+			uint32_t baseInstance;
+		};
+
+		// Render commands are plain data referring to
+		// resources by handle; stale handles are skipped at
+		// execution time.
+		struct RenderMesh
+		{
+			static constexpr CommandType Type =
+			    CommandType::RenderMesh;
+
+			MeshHandle mesh;
+			ShaderHandle shader;
+			// Optional index into the frame's instance data.
+			// Adjacent RenderMesh commands with the same mesh
+			// and shader and a transform are merged into a
+			// single instanced draw at flush time.
+			uint32_t instance = NoInstance;
+			// Optional, from PushConstants().
+			Constants constants;
+			// Optional; draws with a stale material are
+			// skipped. With an invalid shader, the draw uses
+			// the material's.
+			MaterialHandle material;
+		};
+
+		// Draws instanceCount copies of a mesh using the
+		// frame's instance data starting at firstInstance.
+		struct RenderMeshInstanced
+		{
+			static constexpr CommandType Type =
+			    CommandType::RenderMeshInstanced;
+
+			MeshHandle mesh;
+			ShaderHandle shader;
+			uint32_t firstInstance;
+			uint32_t instanceCount;
+			Constants constants;
+			MaterialHandle material;
+		};
+
+		// Built by RenderManager::Flush() from runs of
+		// arena meshes sharing a shader; drawCount entries of
+		// the frame's indirect buffer starting at firstDraw
+		// are issued with one glMultiDrawElementsIndirect.
+		struct MultiDrawIndirect
+		{
+			static constexpr CommandType Type =
+			    CommandType::MultiDrawIndirect;
+
+			ShaderHandle shader;
+			uint32_t vao;
+			uint32_t firstDraw;
+			uint32_t drawCount;
+			// Shared by every draw, they come from one arena.
+			IndexType indexType;
+			bool instanced;
+			Constants constants;
+			// Whether each draw's material index is in the
+			// frame's draw materials, at the same index as
+			// the draw; their arrays (see MaterialTable) are
+			// textureSet's.
+			bool materials;
+			uint32_t textureSet;
+			// Shared by every draw, like their shader.
+			uint32_t pipelineState;
+			Constants materialConstants;
+			// Bound to the VAO in place of vaoIndexBuffer
+			// for the draws, e.g. the cluster indices of
+			// GpuCulling; 0 keeps the VAO's.
+			uint32_t indexBuffer = 0;
+			uint32_t vaoIndexBuffer = 0;
+		};
+
+		// A UI draw (see Graphics::ImGuiRenderer): indices
+		// from the UI stream buffers, clipped to a scissor
+		// rectangle in framebuffer pixels. Executed in
+		// submission order through
+		// RenderManager::ExecuteOrdered().
+		struct DrawUi
+		{
+			static constexpr CommandType Type =
+			    CommandType::DrawUi;
+
+			uint32_t program;
+			uint32_t vao;
+			uint32_t texture;
+			uint32_t elementCount;
+			// Byte offset into the element buffer.
+			uint32_t indexOffset;
+			int32_t baseVertex;
+			IndexType indexType;
+			int32_t scissor[4];
+		};
+
+		// Quads of a SpriteBatch sharing a texture: a
+		// triangle strip per instance of the frame's
+		// instance data, laid out as SpriteBatch::Instance.
+		// Drawn without depth test or write.
+		struct DrawSprites
+		{
+			static constexpr CommandType Type =
+			    CommandType::DrawSprites;
+
+			uint32_t program;
+			uint32_t vao;
+			// A 2D texture; invalid draws with
+			// defaultTexture. Stale or still streaming
+			// textures skip the draw.
+			TextureHandle texture;
+			uint32_t defaultTexture;
+			uint32_t firstInstance;
+			uint32_t instanceCount;
+			Constants constants;
+			BlendMode blend;
+		};
+
+		// Camera-facing quads of a ParticleSystem, none of
+		// whose data passes through the CPU: particles and
+		// their draw order come from its shader storage,
+		// the instance count from its indirect arguments.
+		// Depth tested without writing.
+		struct DrawParticles
+		{
+			static constexpr CommandType Type =
+			    CommandType::DrawParticles;
+
+			uint32_t program;
+			uint32_t vao;
+			uint32_t particleBuffer;
+			uint32_t orderBuffer;
+			// Holds a DrawArraysIndirectCommand at
+			// argsOffset.
+			uint32_t argsBuffer;
+			uint32_t argsOffset;
+			// As in DrawSprites.
+			TextureHandle texture;
+			uint32_t defaultTexture;
+			Constants constants;
+			BlendMode blend;
 		};
 
-		class RenderMesh : public RenderCommand
+		// The rings of a Terrain: instanced 16-bit indexed
+		// pieces of its own buffers, the instances' first
+		// columns placing them (see Terrain). Heights and
+		// normals are array textures bound to
+		// Terrain::HeightsUnit and NormalsUnit, the levels'
+		// origins a uniform block. Opaque, back faces
+		// culled.
+		struct DrawTerrain
 		{
-		  public:
-			RenderMesh(std::weak_ptr<Mesh> mesh,
-			           std::weak_ptr<Shader> shader);
+			static constexpr CommandType Type =
+			    CommandType::DrawTerrain;
+			static constexpr uint32_t MaxPieces = 6;
 
-			virtual void Execute();
+			struct Piece
+			{
+				uint32_t indexCount;
+				uint32_t firstIndex;
+				uint32_t baseVertex;
+				uint32_t firstInstance;
+				uint32_t instanceCount;
+			};
 
-		  private:
-			std::weak_ptr<Mesh> m_mesh;
-			std::weak_ptr<Shader> m_shader;
+			uint32_t program;
+			uint32_t vao;
+			uint32_t heights;
+			uint32_t normals;
+			uint32_t levelsBuffer;
+			Constants constants;
+			uint32_t pieceCount;
+			Piece pieces[MaxPieces];
 		};
+
+		// Camera-facing quads of an Impostors layer, a
+		// triangle strip per instance of the frame's
+		// instance data (see Impostors::Draw()). The atlases
+		// are bound to Impostors::AlbedoUnit and
+		// NormalDepthUnit. Opaque; the shader cuts out and
+		// writes the depth.
+		struct DrawImpostors
+		{
+			static constexpr CommandType Type =
+			    CommandType::DrawImpostors;
+
+			uint32_t program;
+			uint32_t vao;
+			uint32_t albedo;
+			uint32_t normalDepth;
+			uint32_t firstInstance;
+			uint32_t instanceCount;
+			Constants constants;
+		};
+
+		// A RenderMeshInstanced whose instance count the GPU
+		// wrote (see Foliage): transforms come from
+		// instanceBuffer from firstInstance on, and the
+		// draw from the DrawElementsIndirect at argsOffset
+		// of argsBuffer. Indexed meshes only.
+		struct DrawFoliage
+		{
+			static constexpr CommandType Type =
+			    CommandType::DrawFoliage;
+
+			MeshHandle mesh;
+			ShaderHandle shader;
+			Constants constants;
+			MaterialHandle material;
+			uint32_t instanceBuffer;
+			uint32_t firstInstance;
+			uint32_t argsBuffer;
+			uint32_t argsOffset;
+		};
+
+		// Instanced GL_LINES of two vertices, one line per
+		// instance: its ends and color in the attributes of
+		// the instance transform (see DebugDraw). Alpha
+		// blended, without depth writes.
+		struct DrawLines
+		{
+			static constexpr CommandType Type =
+			    CommandType::DrawLines;
+
+			uint32_t program;
+			uint32_t vao;
+			uint32_t firstInstance;
+			uint32_t instanceCount;
+			Constants constants;
+			bool depthTest;
+		};
+
+		// What a dispatch's writes must be visible to, for
+		// the glMemoryBarrier issued after it; combine with
+		// |. Reads by later dispatches of the same buffers
+		// or images need ShaderStorage or ShaderImage.
+		enum class Barrier : uint32_t
+		{
+			None = 0,
+			ShaderStorage = 1u << 0,
+			ShaderImage = 1u << 1,
+			// Indirect draw and dispatch arguments.
+			Command = 1u << 2,
+			VertexAttrib = 1u << 3,
+			ElementArray = 1u << 4,
+			Uniform = 1u << 5,
+			TextureFetch = 1u << 6,
+			// glBufferSubData, glGetBufferSubData and
+			// mapping.
+			BufferUpdate = 1u << 7,
+			Framebuffer = 1u << 8,
+			All = 0xFFFFFFFF
+		};
+
+		constexpr Barrier operator|(Barrier a, Barrier b)
+		{
+			return static_cast<Barrier>(
+			    static_cast<uint32_t>(a)
+			    | static_cast<uint32_t>(b));
+		}
+		constexpr bool HasBarrier(Barrier barriers,
+		                          Barrier barrier)
+		{
+			return (static_cast<uint32_t>(barriers)
+			        & static_cast<uint32_t>(barrier))
+			       != 0;
+		}
+
+		// A range of a GL buffer bound to a shader storage
+		// binding point; size 0 binds all of it.
+		struct BufferBinding
+		{
+			uint32_t binding;
+			uint32_t buffer;
+			uint32_t offset = 0;
+			uint32_t size = 0;
+		};
+
+		enum class ImageAccess : uint8_t
+		{
+			Read,
+			Write,
+			ReadWrite
+		};
+
+		// Formats an image binding may declare; they must
+		// match the layout qualifier in the shader.
+		enum class ImageFormat : uint8_t
+		{
+			RGBA8,
+			RGBA16F,
+			RGBA32F,
+			R32F,
+			R32UI,
+			RG16F
+		};
+
+		// A level of a GL texture bound to an image unit.
+		// Every layer of an array binds unless layer is
+		// set.
+		struct ImageBinding
+		{
+			static constexpr uint32_t AllLayers = 0xFFFFFFFF;
+
+			uint32_t unit;
+			uint32_t texture;
+			uint32_t level = 0;
+			uint32_t layer = AllLayers;
+			ImageAccess access = ImageAccess::ReadWrite;
+			ImageFormat format = ImageFormat::RGBA8;
+		};
+
+		// What a dispatch binds before it runs, in fixed
+		// arrays so commands stay plain data.
+		struct ComputeBindings
+		{
+			static constexpr uint32_t MaxBuffers = 8;
+			static constexpr uint32_t MaxImages = 4;
+
+			BufferBinding buffers[MaxBuffers];
+			ImageBinding images[MaxImages];
+			uint8_t bufferCount = 0;
+			uint8_t imageCount = 0;
+
+			inline ComputeBindings&
+			Add(const BufferBinding& binding)
+			{
+				VEGAM_ASSERT(bufferCount < MaxBuffers,
+				             "Too many dispatch buffers");
+				buffers[bufferCount++] = binding;
+				return *this;
+			}
+			inline ComputeBindings&
+			Add(const ImageBinding& binding)
+			{
+				VEGAM_ASSERT(imageCount < MaxImages,
+				             "Too many dispatch images");
+				images[imageCount++] = binding;
+				return *this;
+			}
+		};
+
+		// Runs a compute shader over groups work groups,
+		// then issues a memory barrier for barriers.
+		// Executed in sort key order like draws; without
+		// an explicit key, dispatches sort ahead of the
+		// frame's draws in submission order, so the draws
+		// reading their results come after them. The depth
+		// prepass draws before any dispatch. A stale or
+		// unlinked shader skips the dispatch.
+		struct Dispatch
+		{
+			static constexpr CommandType Type =
+			    CommandType::Dispatch;
+
+			ComputeShaderHandle shader;
+			uint32_t groups[3] = {1, 1, 1};
+			Constants constants;
+			ComputeBindings bindings;
+			Barrier barriers = Barrier::None;
+		};
+
+		// As Dispatch, with the group counts read on the
+		// GPU from a DispatchIndirectCommand at argsOffset
+		// of argsBuffer, which must be 4-byte aligned.
+		struct DispatchIndirect
+		{
+			static constexpr CommandType Type =
+			    CommandType::DispatchIndirect;
+
+			ComputeShaderHandle shader;
+			uint32_t argsBuffer;
+			uint32_t argsOffset = 0;
+			Constants constants;
+			ComputeBindings bindings;
+			Barrier barriers = Barrier::None;
+		};
+
+		uint64_t GetSortKey(const RenderMesh& command);
+		uint64_t
+		GetSortKey(const RenderMeshInstanced& command);
+		uint64_t GetSortKey(const DrawFoliage& command);
+		uint64_t GetSortKey(const Dispatch& command);
+		uint64_t GetSortKey(const DispatchIndirect& command);
+
+		void Execute(const RenderMesh& command,
+		             ExecuteContext& context);
+		void Execute(const RenderMeshInstanced& command,
+		             ExecuteContext& context);
+		void Execute(const MultiDrawIndirect& command,
+		             ExecuteContext& context);
+		void Execute(const DrawUi& command,
+		             ExecuteContext& context);
+		void Execute(const DrawSprites& command,
+		             ExecuteContext& context);
+		void Execute(const DrawParticles& command,
+		             ExecuteContext& context);
+		void Execute(const DrawLines& command,
+		             ExecuteContext& context);
+		void Execute(const Dispatch& command,
+		             ExecuteContext& context);
+		void Execute(const DispatchIndirect& command,
+		             ExecuteContext& context);
+
+		// Executes a command payload read back from a
+		// CommandBuffer.
+		void Execute(CommandType type, const void* command,
+		             ExecuteContext& context);
 	} // namespace RenderCommands
 } // namespace AthiVegam::Graphics
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "AthiVegam/Graphics/PipelineState.h"
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace AthiVegam::Graphics
+{
+	// Work issued by the render manager over one frame.
+	struct RenderStats
+	{
+		uint32_t drawCalls = 0;
+		uint64_t triangles = 0;
+		uint32_t stateChanges = 0;
+		uint32_t skippedChanges = 0;
+		uint32_t uniformUploads = 0;
+		uint32_t constantBytes = 0;
+		// With GLCallCounter installed: every GL call of
+		// the frame and the CPU time spent in them.
+		uint32_t glCalls = 0;
+		double glMilliseconds = 0.0;
+	};
+
+	// Shadow copy of the GL bindings touched by render
+	// commands. Transitions to the already bound object are
+	// skipped, so consecutive draws sharing a shader or mesh
+	// don't re-issue glUseProgram / glBindVertexArray.
+	class RenderState
+	{
+	  public:
+		// How SetPipelineState() treats states that
+		// WritesOpaqueDepth().
+		enum class DepthPrepass : uint8_t
+		{
+			Off,
+			// Depth only, colors masked.
+			Depth,
+			// Testing LessEqual against the depth pass,
+			// without writing.
+			Shade
+		};
+
+		RenderState();
+
+		// Draws that can go into a depth pre-pass.
+		static constexpr bool
+		WritesOpaqueDepth(const PipelineState& state)
+		{
+			return state.blend == BlendMode::Opaque
+			       && state.depthTest && state.depthWrite;
+		}
+
+		// Forget the cached bindings. Must be called when GL
+		// state may have been changed behind our back.
+		void Invalidate();
+
+		void UseProgram(uint32_t program);
+		void BindVertexArray(uint32_t vao);
+		// Range of the constant ring bound to
+		// Shader::ConstantsBinding.
+		void BindConstants(uint32_t buffer, uint32_t offset,
+		                   uint32_t size);
+		// Range of a material's constants, bound to
+		// Shader::MaterialConstantsBinding.
+		void BindMaterialConstants(uint32_t buffer,
+		                           uint32_t offset,
+		                           uint32_t size);
+		// Issues only the values that differ from GLState.
+		void SetPipelineState(const PipelineState& state);
+		void SetDepthPrepass(DepthPrepass pass);
+		// GL_TEXTURE_2D on unit 0.
+		void BindTexture(uint32_t texture);
+		// GL_TEXTURE_2D_ARRAY textures on the units from
+		// MaterialTable::FirstTextureUnit; unit 0 stays
+		// active.
+		void BindTextureSet(std::span<const uint32_t> textures);
+		// The draw's material index, or with indirect its
+		// first entry in the draw materials buffer, as
+		// the MaterialTable shader header reads it.
+		void SetDrawMaterial(uint32_t value, bool indirect);
+		// The index of a non-indirect draw's first instance
+		// in the frame's instance data, for its draw data.
+		void SetDrawInstance(uint32_t firstInstance);
+		// Only takes effect with GL_SCISSOR_TEST enabled.
+		void SetScissor(int32_t x, int32_t y, int32_t width,
+		                int32_t height);
+
+		inline void CountDraw(uint64_t triangles)
+		{
+			++m_drawCalls;
+			m_triangles += triangles;
+		}
+
+		inline auto GetStateChanges() const
+		{
+			return m_stateChanges;
+		}
+		inline auto GetSkippedChanges() const
+		{
+			return m_skippedChanges;
+		}
+		inline auto GetDrawCalls() const
+		{
+			return m_drawCalls;
+		}
+		inline auto GetTriangles() const
+		{
+			return m_triangles;
+		}
+		void ResetCounters();
+
+	  private:
+		static constexpr uint32_t Unknown = 0xFFFFFFFF;
+
+		void ApplyDrawMaterial();
+
+		uint32_t m_vao;
+		uint32_t m_constantsBuffer;
+		uint32_t m_constantsOffset;
+		uint32_t m_constantsSize;
+		uint32_t m_materialConstants[3];
+		uint32_t m_texture;
+		std::array<uint32_t, 4> m_textureSet;
+		// Material, indirect flag and first instance.
+		uint32_t m_drawMaterial[3];
+		int32_t m_scissor[4];
+		DepthPrepass m_depthPrepass = DepthPrepass::Off;
+
+		uint32_t m_stateChanges;
+		uint32_t m_skippedChanges;
+		uint32_t m_drawCalls;
+		uint64_t m_triangles;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// An offscreen framebuffer with an RGBA8 color and a
+	// depth renderbuffer. Headless runs render into one in
+	// place of the window's default framebuffer. A sampled
+	// target's color is a texture instead, for drawing it
+	// elsewhere, e.g. in an ImGui image. GL thread only.
+	class RenderTarget
+	{
+	  public:
+		RenderTarget() = default;
+		~RenderTarget();
+
+		RenderTarget(const RenderTarget&) = delete;
+		RenderTarget& operator=(const RenderTarget&) = delete;
+
+		bool Create(int width, int height,
+		            bool sampled = false);
+		void Destroy();
+
+		// Binds it for drawing and reading, and sets the
+		// viewport to cover it.
+		void Bind() const;
+
+		inline uint32_t GetId() const { return m_framebuffer; }
+		inline int GetWidth() const { return m_width; }
+		inline int GetHeight() const { return m_height; }
+		// The color texture of a sampled target, else 0.
+		inline uint32_t GetColorTexture() const
+		{
+			return m_sampled ? m_color : 0;
+		}
+
+	  private:
+		uint32_t m_framebuffer = 0;
+		uint32_t m_color = 0;
+		uint32_t m_depth = 0;
+		int m_width = 0;
+		int m_height = 0;
+		bool m_sampled = false;
+	};
+} // namespace AthiVegam::Graphics
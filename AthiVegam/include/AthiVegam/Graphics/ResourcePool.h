@@ -0,0 +1,194 @@
+#pragma once
+
+#include "AthiVegam/Core/Pool.h"
+#include "AthiVegam/Graphics/Handle.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	// Dense table of resources addressed by generational
+	// handles. Slots live in fixed-size pages so resources
+	// never move once created, and freed slots are recycled
+	// through a free list with their generation bumped.
+	//
+	// Create() and Destroy() need external synchronization,
+	// but the page table never reallocates, so Get() of an
+	// existing handle is safe while another thread creates.
+	template <typename T>
+	class ResourcePool
+	{
+	  public:
+		ResourcePool() { m_pages.reserve(MaxPages); }
+		~ResourcePool() { Clear(); }
+
+		ResourcePool(const ResourcePool&) = delete;
+		ResourcePool& operator=(const ResourcePool&) = delete;
+
+		template <typename... Args>
+		Handle<T> Create(Args&&... args)
+		{
+			uint32_t index;
+			if (!m_freeList.empty())
+			{
+				index = m_freeList.back();
+				m_freeList.pop_back();
+			}
+			else
+			{
+				index = m_slotCount++;
+				if (index / PageSize >= m_pages.size())
+				{
+					m_pages.push_back(
+					    std::make_unique<Page>());
+				}
+			}
+
+			auto& slot = GetSlot(index);
+			new (slot.storage) T(std::forward<Args>(args)...);
+			slot.alive = true;
+			++m_liveCount;
+			++m_allocations;
+
+			return Handle<T>::Make(index, slot.generation);
+		}
+
+		bool Destroy(Handle<T> handle)
+		{
+			auto* slot = Resolve(handle);
+			if (!slot)
+			{
+				return false;
+			}
+
+			DestroySlot(*slot);
+			m_freeList.push_back(handle.GetIndex());
+			return true;
+		}
+
+		inline T* Get(Handle<T> handle) const
+		{
+			auto* slot = Resolve(handle);
+			return slot ? slot->Get() : nullptr;
+		}
+
+		inline bool IsAlive(Handle<T> handle) const
+		{
+			return Resolve(handle) != nullptr;
+		}
+
+		inline size_t GetCount() const
+		{
+			return m_liveCount;
+		}
+
+		inline Core::PoolStats GetStats() const
+		{
+			return {m_liveCount, m_slotCount, m_allocations};
+		}
+
+		template <typename F>
+		void ForEach(F&& func)
+		{
+			for (uint32_t i = 0; i < m_slotCount; ++i)
+			{
+				auto& slot = GetSlot(i);
+				if (slot.alive)
+				{
+					func(Handle<T>::Make(i, slot.generation),
+					     *slot.Get());
+				}
+			}
+		}
+
+		void Clear()
+		{
+			for (uint32_t i = 0; i < m_slotCount; ++i)
+			{
+				auto& slot = GetSlot(i);
+				if (slot.alive)
+				{
+					DestroySlot(slot);
+				}
+			}
+			m_pages.clear();
+			m_freeList.clear();
+			m_slotCount = 0;
+		}
+
+	  private:
+		static constexpr uint32_t PageSize = 256;
+		static constexpr uint32_t MaxPages =
+		    (Handle<T>::IndexMask + 1) / PageSize;
+
+		struct Slot
+		{
+			alignas(T) std::byte storage[sizeof(T)];
+			// Generation 0 is never handed out so that a
+			// zero handle is always invalid.
+			uint32_t generation = 1;
+			bool alive = false;
+
+			inline T* Get()
+			{
+				return std::launder(
+				    reinterpret_cast<T*>(storage));
+			}
+		};
+
+		using Page = std::array<Slot, PageSize>;
+
+		inline Slot& GetSlot(uint32_t index) const
+		{
+			return (*m_pages[index / PageSize])[index
+			                                    % PageSize];
+		}
+
+		inline Slot* Resolve(Handle<T> handle) const
+		{
+			const auto index = handle.GetIndex();
+			if (!handle.IsValid() || index >= m_slotCount)
+			{
+				return nullptr;
+			}
+
+			auto& slot = GetSlot(index);
+			return (slot.alive
+			        && slot.generation
+			               == handle.GetGeneration())
+			           ? &slot
+			           : nullptr;
+		}
+
+		void DestroySlot(Slot& slot)
+		{
+			slot.Get()->~T();
+#ifdef AV_CONFIG_DEBUG
+			std::memset(slot.storage, 0xDD, sizeof(T));
+#endif // AV_CONFIG_DEBUG
+			slot.alive = false;
+			slot.generation =
+			    (slot.generation + 1)
+			    & Handle<T>::GenerationMask;
+			if (slot.generation == 0)
+			{
+				slot.generation = 1;
+			}
+			--m_liveCount;
+		}
+
+	  private:
+		std::vector<std::unique_ptr<Page>> m_pages;
+		std::vector<uint32_t> m_freeList;
+		uint32_t m_slotCount = 0;
+		size_t m_liveCount = 0;
+		size_t m_allocations = 0;
+	};
+} // namespace AthiVegam::Graphics
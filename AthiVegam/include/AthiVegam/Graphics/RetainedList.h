@@ -0,0 +1,124 @@
+#pragma once
+
+#include "AthiVegam/Graphics/CommandList.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	// Draws built once and executed by every flush until
+	// changed, for static content. Register the list with
+	// RenderManager::AddRetainedList() and patch the
+	// entries that change instead of submitting them each
+	// frame: RenderManager only copies the list when its
+	// version moved, so an unchanged list costs nothing to
+	// record. Instance and constant data pushed here stay
+	// valid across frames. Main thread only.
+	class RetainedList
+	{
+	  public:
+		using Id = uint32_t;
+
+		template <typename T>
+		inline Id Add(const T& renderCommand)
+		{
+			return Add(renderCommand,
+			           RenderCommands::GetSortKey(renderCommand));
+		}
+		template <typename T>
+		Id Add(const T& renderCommand, uint64_t sortKey)
+		{
+			const auto id = static_cast<Id>(m_entries.size());
+			m_entries.push_back(static_cast<uint32_t>(
+			    m_list.GetEntries().size()));
+			m_ids.push_back(id);
+			m_list.Submit(renderCommand, sortKey);
+			++m_version;
+			return id;
+		}
+
+		// Replaces a command with one of the same type.
+		// False for removed ids and other types.
+		template <typename T>
+		inline bool Update(Id id, const T& renderCommand)
+		{
+			return Update(
+			    id, renderCommand,
+			    RenderCommands::GetSortKey(renderCommand));
+		}
+		template <typename T>
+		bool Update(Id id, const T& renderCommand,
+		            uint64_t sortKey)
+		{
+			if (!Contains(id))
+			{
+				return false;
+			}
+			const auto entry = m_entries[id];
+			const auto offset =
+			    m_list.GetEntries()[entry].offset;
+			if (m_list.GetCommands().GetType(offset) != T::Type)
+			{
+				return false;
+			}
+			m_list.Replace(entry, renderCommand, sortKey);
+			++m_version;
+			return true;
+		}
+
+		// The command's storage is reclaimed by Clear().
+		void Remove(Id id);
+		inline bool Contains(Id id) const
+		{
+			return id < m_entries.size()
+			       && m_entries[id] != Removed;
+		}
+
+		uint32_t PushInstances(
+		    const RenderCommands::InstanceTransform* transforms,
+		    uint32_t count);
+		uint32_t PushInstances(
+		    const RenderCommands::InstanceTransform* transforms,
+		    const RenderCommands::DrawData* drawData,
+		    uint32_t count);
+		RenderCommands::Constants
+		PushConstants(const void* data, uint32_t size);
+		template <typename T>
+		inline RenderCommands::Constants
+		PushConstants(const T& constants)
+		{
+			return PushConstants(
+			    &constants, static_cast<uint32_t>(sizeof(T)));
+		}
+		// Data pushed earlier, to patch in place.
+		RenderCommands::InstanceTransform*
+		MapInstances(uint32_t first);
+		void* MapConstants(RenderCommands::Constants constants);
+
+		void Clear();
+
+		// Commands, not counting removed ones.
+		inline uint32_t GetCount() const
+		{
+			return static_cast<uint32_t>(m_ids.size());
+		}
+		// Moves with every change.
+		inline uint64_t GetVersion() const { return m_version; }
+		inline const CommandList& GetList() const
+		{
+			return m_list;
+		}
+
+	  private:
+		static constexpr uint32_t Removed = 0xFFFFFFFF;
+
+		CommandList m_list;
+		// Entry of each id in m_list.
+		std::vector<uint32_t> m_entries;
+		// Id of each entry.
+		std::vector<Id> m_ids;
+		uint64_t m_version = 1;
+	};
+} // namespace AthiVegam::Graphics
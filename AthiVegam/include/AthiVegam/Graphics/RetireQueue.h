@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// GL objects whose owners have died, deleted a few
+	// frames later once a fence shows the GPU is done with
+	// them. Deleting an object queued commands still use
+	// can stall the driver, and owners die wherever their
+	// last shared_ptr is dropped, often mid-frame on a
+	// loading thread.
+	//
+	// Retire() may be called from any thread; the rest on
+	// the GL thread. Objects retired after Flush() at
+	// shutdown are never deleted, their context being gone.
+	namespace RetireQueue
+	{
+		// Frames a retired object outlives, besides its
+		// fence: commands recorded before the owner died
+		// may run one frame after it was retired.
+		constexpr uint32_t RetireFrames = 2;
+
+		// Deletes an object on the GL thread.
+		using Release = void (*)(uint64_t object);
+
+		void Retire(Release release, uint64_t object);
+		void RetireBuffer(uint32_t buffer);
+		void RetireVertexArray(uint32_t vao);
+		void RetireTexture(uint32_t texture);
+		// Unbinds the program first if it is current.
+		void RetireProgram(uint32_t program);
+		void RetireShader(uint32_t shader);
+		void RetireSync(void* sync);
+
+		// Once per frame, after the frame's commands: fences
+		// the objects retired since the last call and
+		// deletes those whose fence has signalled.
+		void EndFrame();
+		// Waits for the GPU and deletes everything retired.
+		void Flush();
+
+		// Retired and not yet deleted.
+		size_t GetPendingCount();
+	} // namespace RetireQueue
+} // namespace AthiVegam::Graphics
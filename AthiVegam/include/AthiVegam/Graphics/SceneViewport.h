@@ -0,0 +1,106 @@
+#pragma once
+
+#include "AthiVegam/Graphics/RenderTarget.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// An editor panel showing the scene: the scene renders
+	// into an offscreen target, sized to the panel, that
+	// the panel draws as an ImGui image. The target is
+	// redrawn every frame only while the panel is focused,
+	// animating or invalidated; otherwise at the idle rate,
+	// which still picks up what changes unnoticed, such as
+	// streamed assets. Skipped frames keep the last image.
+	//
+	// Main thread, which draws; not with
+	// EngineConfig::renderThread.
+	class SceneViewport
+	{
+	  public:
+		struct Settings
+		{
+			// Redraws per second while idle.
+			float idleRate = 10.0f;
+		};
+
+		SceneViewport() = default;
+		~SceneViewport() = default;
+
+		SceneViewport(const SceneViewport&) = delete;
+		SceneViewport& operator=(const SceneViewport&) = delete;
+
+		inline void SetSettings(const Settings& settings)
+		{
+			m_settings = settings;
+		}
+		void Destroy();
+
+		// False when the scene need not be drawn this
+		// frame. Otherwise binds the target, resized to the
+		// panel, for the scene to draw into until
+		// EndScene().
+		bool BeginScene();
+		// Binds what was bound before BeginScene().
+		void EndScene();
+
+		// The panel, while ImGui records a frame.
+		void DrawWindow(const char* title);
+
+		// Redraw every frame while set, e.g. while playing.
+		inline void SetAnimating(bool animating)
+		{
+			m_animating = animating;
+		}
+		// Redraw next frame, e.g. after an edit.
+		inline void Invalidate() { m_invalidated = true; }
+
+		inline bool IsFocused() const { return m_focused; }
+		inline bool IsHovered() const { return m_hovered; }
+		// Maps a point in window coordinates, such as the
+		// mouse, onto the image: u and v run from 0 to 1,
+		// left to right and top to bottom. False outside.
+		bool MapToImage(float x, float y, float& u,
+		                float& v) const;
+		// In window coordinates.
+		inline float GetImageWidth() const
+		{
+			return m_imageWidth;
+		}
+		inline float GetImageHeight() const
+		{
+			return m_imageHeight;
+		}
+
+		inline const RenderTarget& GetTarget() const
+		{
+			return m_target;
+		}
+
+	  private:
+		Settings m_settings;
+		RenderTarget m_target;
+
+		// Of the image as last drawn: its top left in
+		// window coordinates, its size and its size in
+		// pixels.
+		float m_imageX = 0.0f;
+		float m_imageY = 0.0f;
+		float m_imageWidth = 0.0f;
+		float m_imageHeight = 0.0f;
+		int m_pixelWidth = 0;
+		int m_pixelHeight = 0;
+		bool m_visible = false;
+		bool m_focused = false;
+		bool m_hovered = false;
+
+		bool m_animating = false;
+		bool m_invalidated = true;
+		std::chrono::steady_clock::time_point m_lastRender;
+
+		int32_t m_previousFramebuffer = 0;
+		int32_t m_previousViewport[4] = {};
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "AthiVegam/Core/RingBuffer.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	// Screenshots and frame sequences written to disk
+	// without a hitch: the window reads requested frames
+	// back through its FrameReadback, this copies the
+	// pixels once their fence has signalled, and a thread
+	// of its own encodes and writes them. The GL thread
+	// only waits if MaxQueued frames are still unwritten.
+	class ScreenCapture
+	{
+	  public:
+		enum class Format : uint8_t
+		{
+			Png,
+			// Half-float linear RGB, from the sRGB frame.
+			Exr
+		};
+
+		// Frames read back but not yet written.
+		static constexpr uint32_t MaxQueued = 4;
+
+		ScreenCapture() = default;
+		~ScreenCapture();
+
+		ScreenCapture(const ScreenCapture&) = delete;
+		ScreenCapture& operator=(const ScreenCapture&) = delete;
+
+		// Any thread: the next presented frame, to path.
+		void Request(std::string path,
+		             Format format = Format::Png);
+		// Any thread: the next count presented frames, to
+		// directory/frame_000000.png and on. Replaces a
+		// sequence still running.
+		void RequestSequence(std::string directory,
+		                     uint32_t count,
+		                     Format format = Format::Png);
+		// Any thread: requests not yet read back.
+		bool IsPending() const;
+
+		// GL thread, as a frame is presented: takes the
+		// requests due, and returns whether to read it back.
+		bool Claim(uint64_t frame);
+		// GL thread, from the FrameReadback callback: queues
+		// a claimed frame for writing.
+		void Deliver(const uint8_t* pixels, int width,
+		             int height, uint64_t frame);
+
+		// Waits until everything queued has been written.
+		void Flush();
+		// Writes what is queued, then stops the writer.
+		void Shutdown();
+
+		inline uint32_t GetWrittenCount() const
+		{
+			return m_written.load(std::memory_order_relaxed);
+		}
+
+	  private:
+		struct Target
+		{
+			std::string path;
+			Format format = Format::Png;
+			uint64_t frame = 0;
+		};
+
+		struct Pending
+		{
+			std::vector<uint8_t> pixels;
+			int width = 0;
+			int height = 0;
+			std::vector<Target> targets;
+		};
+
+		void Run();
+		void Write(const Pending& pending);
+
+	  private:
+		mutable std::mutex m_requestMutex;
+		std::vector<Target> m_requests;
+		std::string m_sequenceDirectory;
+		uint32_t m_sequenceRemaining = 0;
+		uint32_t m_sequenceIndex = 0;
+		Format m_sequenceFormat = Format::Png;
+
+		// Claimed and in flight; GL thread.
+		std::vector<Target> m_claimed;
+
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::condition_variable m_drained;
+		Core::RingBuffer<Pending, MaxQueued> m_queue;
+		// Pixel buffers of written frames, for reuse.
+		std::vector<std::vector<uint8_t>> m_spare;
+		bool m_writing = false;
+		bool m_stop = false;
+		std::atomic<uint32_t> m_written{0};
+	};
+} // namespace AthiVegam::Graphics
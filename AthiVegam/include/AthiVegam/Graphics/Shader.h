@@ -1,46 +1,216 @@
 #pragma once
 
+#include "AthiVegam/Core/FlatHashMap.h"
+#include "AthiVegam/Graphics/ShaderReflection.h"
+#include "AthiVegam/Graphics/Uniform.h"
+#include "AthiVegam/Math/Matrix.h"
+#include "AthiVegam/Math/Vector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 
 namespace AthiVegam::Graphics
 {
 	class Shader
 	{
 	  public:
+		// A uniform block named Constants is bound here at
+		// link time; RenderManager::PushConstants() data is
+		// bound to it for each draw.
+		static constexpr uint32_t ConstantsBinding = 0;
+		// Likewise for a block named MaterialConstants and
+		// the draw's MaterialDesc::constants.
+		static constexpr uint32_t MaterialConstantsBinding =
+		    1;
+
+		enum class CompileMode
+		{
+			Blocking,
+			// Compile and link are only issued; Poll() until
+			// the program is ready.
+			Async
+		};
+
 		Shader(const std::string& vertex,
 		       const std::string& fragment);
+		Shader(const std::string& vertex,
+		       const std::string& fragment, CompileMode mode);
 		~Shader();
 
+		Shader(const Shader&) = delete;
+		Shader& operator=(const Shader&) = delete;
+
+		// Finishes an async compile once the driver is done
+		// with it. Returns true when no longer pending; the
+		// program may still have failed to link, see
+		// IsReady(). Without GL_KHR_parallel_shader_compile
+		// the first poll waits for the compile.
+		bool Poll();
+		inline bool IsPending() const
+		{
+			return m_pending != nullptr;
+		}
+		inline bool IsReady() const { return m_ready; }
+		static bool IsParallelCompileSupported();
+
+		// Exchanges the programs and everything resolved from
+		// them, so a reloaded program takes over in place.
+		// Uniform handles from before must be resolved again.
+		void Swap(Shader& other);
+
+		// Both go through UseProgram(), so binding the
+		// program that is already current is free.
 		void Bind();
 		void Unbind();
 
-		void SetUniformInt(const std::string& name,
+		// Cached glUseProgram for the engine's GL context.
+		// Every program switch in the engine goes through
+		// here; returns false if the program was current.
+		static bool UseProgram(uint32_t program);
+		static uint32_t GetCurrentProgram();
+		// Call when GL may have switched programs behind
+		// the cache's back.
+		static void InvalidateCurrentProgram();
+		// Uniform setter calls since the last call.
+		static uint32_t TakeUniformUploads();
+
+		inline auto GetId() const
+		{
+			return static_cast<uint32_t>(m_programId);
+		}
+		// Of the sources; names the shader across runs,
+		// e.g. in PipelineWarmup's log.
+		inline uint64_t GetSourceHash() const
+		{
+			return m_sourceHash;
+		}
+#ifndef AV_CONFIG_SHIPPING
+		// Kept for Graphics::FrameCapture.
+		inline const std::string& GetVertexSource() const
+		{
+			return m_vertexSource;
+		}
+		inline const std::string& GetFragmentSource() const
+		{
+			return m_fragmentSource;
+		}
+#endif // AV_CONFIG_SHIPPING
+
+		// Of the linked program: its inputs, uniforms and
+		// blocks. Empty until IsReady().
+		inline const ShaderReflection& GetReflection() const
+		{
+			return m_reflection;
+		}
+		// Whether layout feeds every vertex input with the
+		// kind it reads; warns about the first mismatch
+		// once per shader.
+		bool ValidateLayout(const VertexLayout& layout,
+		                    bool instanced) const;
+
+		// Binds a std140 uniform block to a buffer binding
+		// point. Returns false if the program has no block of
+		// that name.
+		bool BindUniformBlock(std::string_view name,
+		                      uint32_t binding);
+
+		// Resolve a uniform once and keep the handle for hot
+		// paths. Invalid if the program has no such active
+		// uniform, in which case setting it is a no-op. Names
+		// the reflection lists resolve without GL.
+		template <typename T>
+		inline UniformHandle<T> GetUniform(UniformName name)
+		{
+			return {GetUniformLocation(name)};
+		}
+
+		void Set(UniformHandle<int> uniform, int value);
+		void Set(UniformHandle<Int2> uniform, Int2 value);
+		void Set(UniformHandle<Int3> uniform, Int3 value);
+		void Set(UniformHandle<Int4> uniform, Int4 value);
+		void Set(UniformHandle<float> uniform, float value);
+		void Set(UniformHandle<Float2> uniform,
+		         Float2 value);
+		void Set(UniformHandle<Float3> uniform,
+		         Float3 value);
+		void Set(UniformHandle<Float4> uniform,
+		         Float4 value);
+		void Set(UniformHandle<Math::Vec3> uniform,
+		         const Math::Vec3& value);
+		void Set(UniformHandle<Math::Vec4> uniform,
+		         const Math::Vec4& value);
+		// A mat4 uniform, uploaded column-major without
+		// transposing.
+		void Set(UniformHandle<Math::Mat4> uniform,
+		         const Math::Mat4& value);
+
+		// Set through glProgramUniform, so the program is not
+		// bound and the GL binding cache stays valid. These
+		// look the name's id up on every call; prefer
+		// handles, or uniform blocks for per-draw data. Pass
+		// runtime strings as UniformName::FromString(name).
+		void SetUniformInt(UniformName name,
 		                   int val);
-		void SetUniformInt2(const std::string& name,
+		void SetUniformInt2(UniformName name,
 		                    int val1, int val2);
-		void SetUniformInt3(const std::string& name,
+		void SetUniformInt3(UniformName name,
 		                    int val1, int val2, int val3);
-		void SetUniformInt4(const std::string& name,
+		void SetUniformInt4(UniformName name,
 		                    int val1, int val2, int val3,
 		                    int val4);
-		void SetUniformFloat(const std::string& name,
+		void SetUniformFloat(UniformName name,
 		                     float val);
-		void SetUniformFloat2(const std::string& name,
+		void SetUniformFloat2(UniformName name,
 		                      float val1, float val2);
-		void SetUniformFloat3(const std::string& name,
+		void SetUniformFloat3(UniformName name,
 		                      float val1, float val2,
 		                      float val3);
-		void SetUniformFloat4(const std::string& name,
+		void SetUniformFloat4(UniformName name,
 		                      float val1, float val2,
 		                      float val3, float val4);
+		void SetUniformFloat3(UniformName name,
+		                      const Math::Vec3& value);
+		void SetUniformFloat4(UniformName name,
+		                      const Math::Vec4& value);
+		void SetUniformMat4(UniformName name,
+		                    const Math::Mat4& value);
 
 	  private:
-		int GetUniformLocation(const std::string& name);
+		void BeginCompile(const std::string& vertex,
+		                  const std::string& fragment);
+		void FinishCompile(const std::string& vertex,
+		                   const std::string& fragment);
+		// Binds the engine's blocks and resolves every
+		// active uniform up front.
+		void ApplyReflection();
+
+		int GetUniformLocation(UniformName name);
 
 	  private:
+		struct PendingSources
+		{
+			std::string vertex;
+			std::string fragment;
+		};
+
 		int m_programId;
-		std::unordered_map<std::string, int>
+		uint32_t m_vertexShaderId;
+		uint32_t m_fragmentShaderId;
+		std::unique_ptr<PendingSources> m_pending;
+		bool m_ready;
+		uint64_t m_sourceHash;
+		ShaderReflection m_reflection;
+#ifndef AV_CONFIG_SHIPPING
+		std::string m_vertexSource;
+		std::string m_fragmentSource;
+#endif // AV_CONFIG_SHIPPING
+		mutable bool m_layoutWarned = false;
+		Core::FlatHashMap<Core::StringId, int,
+		                  Core::StringIdHash>
 		    m_uniformLocations;
 	};
 } // namespace AthiVegam::Graphics
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "AthiVegam/Core/Serialize.h"
+#include "AthiVegam/Graphics/VertexLayout.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	// What a linked program takes: its active vertex
+	// inputs, default-block uniforms (samplers among them),
+	// uniform blocks and storage blocks. Shader reflects
+	// once at link time and keeps it with the cached
+	// program binary, so uniform handles resolve without
+	// asking GL and mesh layouts can be checked against
+	// the inputs.
+	struct ShaderReflection
+	{
+		struct Variable
+		{
+			// Arrays without the "[0]" suffix.
+			std::string name;
+			// GL type, e.g. GL_FLOAT_VEC3; 0 for blocks.
+			uint32_t type = 0;
+			// Array length; for blocks, the data size in
+			// bytes.
+			int32_t size = 0;
+			// Attribute or uniform location, block index;
+			// -1 for uniforms inside blocks.
+			int32_t location = -1;
+
+			VEGAM_SERIAL_FIELDS(&Variable::name,
+			                    &Variable::type,
+			                    &Variable::size,
+			                    &Variable::location)
+		};
+
+		std::vector<Variable> attributes;
+		std::vector<Variable> uniforms;
+		std::vector<Variable> uniformBlocks;
+		// Empty before GL 4.3.
+		std::vector<Variable> storageBlocks;
+
+		VEGAM_SERIAL_FIELDS(&ShaderReflection::attributes,
+		                    &ShaderReflection::uniforms,
+		                    &ShaderReflection::uniformBlocks,
+		                    &ShaderReflection::storageBlocks)
+
+		// GL thread; program must be linked.
+		static ShaderReflection Reflect(uint32_t program);
+
+		static const Variable*
+		Find(std::span<const Variable> variables,
+		     std::string_view name);
+		static bool IsSampler(uint32_t type);
+
+		// A layout feeding every input outside the instance
+		// transform's locations: floats by their component
+		// count, integer inputs as UByte4.
+		VertexLayout MakeVertexLayout() const;
+		// Whether layout, and the instance transform when
+		// instanced, feeds every input with the kind
+		// (float or integer) it reads. Names the first
+		// mismatch in problem.
+		bool Accepts(const VertexLayout& layout,
+		             bool instanced,
+		             std::string* problem = nullptr) const;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "AthiVegam/Core/FlatHashMap.h"
+#include "AthiVegam/Graphics/Handle.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	// One shader source compiled into specialized programs.
+	// The source declares up to 32 features; bit i of a
+	// permutation key compiles the program with
+	// "#define <features[i]> 1", so feature toggles become
+	// preprocessor branches instead of dynamic ones.
+	//
+	// Variants are created lazily through
+	// ResourceManager::GetShaderVariant() and land in the
+	// program binary cache, so later launches load them
+	// without compiling.
+	class ShaderVariants
+	{
+	  public:
+		static constexpr uint32_t MaxFeatures = 32;
+
+		ShaderVariants(std::string vertex,
+		               std::string fragment,
+		               std::vector<std::string> features);
+
+		// Key from feature indices, usually the values of
+		// an app enum listed in the same order as features:
+		// MakeKey(Feature::Skinned, Feature::Fog).
+		template <typename... Features>
+		static constexpr uint32_t MakeKey(Features... features)
+		{
+			return ((1u << static_cast<uint32_t>(features))
+			        | ... | 0u);
+		}
+
+		// Bit of a feature by name, or 0 if not declared.
+		uint32_t GetFeatureBit(std::string_view feature) const;
+
+		std::string GetVertexSource(uint32_t key) const;
+		std::string GetFragmentSource(uint32_t key) const;
+
+		inline ShaderHandle Find(uint32_t key) const
+		{
+			auto it = m_variants.find(key);
+			return it != m_variants.end() ? it->second
+			                              : ShaderHandle{};
+		}
+		inline void Add(uint32_t key, ShaderHandle handle)
+		{
+			m_variants[key] = handle;
+		}
+		inline const auto& GetVariants() const
+		{
+			return m_variants;
+		}
+
+	  private:
+		std::string Specialize(const std::string& source,
+		                       uint32_t key) const;
+
+	  private:
+		std::string m_vertex;
+		std::string m_fragment;
+		std::vector<std::string> m_features;
+		Core::FlatHashMap<uint32_t, ShaderHandle> m_variants;
+	};
+} // namespace AthiVegam::Graphics
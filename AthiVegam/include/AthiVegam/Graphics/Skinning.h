@@ -0,0 +1,101 @@
+#pragma once
+
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Math/Matrix.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	class CommandList;
+	class VertexLayout;
+
+	// Skeletal meshes are skinned in the vertex shader:
+	// each vertex carries up to four bone indices and
+	// weights, and each draw reads its bone palette from
+	// the frame's constant ring, pushed with PushPalette().
+	// The mesh data stays static, so characters sharing a
+	// mesh share its buffers, and the CPU only builds the
+	// palettes.
+	namespace Skinning
+	{
+		// Past RenderCommands::DrawMaterialLocation.
+		constexpr uint32_t BoneIndicesLocation = 9;
+		constexpr uint32_t BoneWeightsLocation = 10;
+		// 16 KB of mat4s, the uniform block size every GL
+		// implementation allows.
+		constexpr uint32_t MaxBones = 256;
+
+		// Bone indices (UByte4) and weights (UByte4Norm).
+		void AddAttributes(VertexLayout& layout);
+
+		// The two attributes of a vertex, as they are laid
+		// out by AddAttributes().
+		struct VertexWeights
+		{
+			uint8_t indices[4];
+			uint8_t weights[4];
+		};
+
+		// Quantizes weights, renormalized to sum to one; the
+		// rounding error goes to the heaviest bone.
+		VertexWeights PackWeights(const uint32_t indices[4],
+		                          const float weights[4]);
+
+		// Copies a palette into the list for a draw's
+		// constants, padded with identities to blockBones,
+		// the SKINNING_MAX_BONES of the shader: a draw's
+		// constants must cover its whole block.
+		RenderCommands::Constants
+		PushPalette(CommandList& list,
+		            std::span<const Math::Mat4> palette,
+		            uint32_t blockBones = MaxBones);
+	} // namespace Skinning
+
+	// Bone hierarchy and bind pose of a skeletal mesh.
+	// Bones are listed parents first, so a palette is built
+	// in one forward pass.
+	class Skeleton
+	{
+	  public:
+		static constexpr uint32_t NoParent = 0xFFFFFFFF;
+
+		// Returns the bone's index. parent must already be
+		// a bone, or NoParent for a root. inverseBind takes
+		// model space to the bone's space in the bind pose.
+		uint32_t AddBone(uint32_t parent,
+		                 const Math::Mat4& inverseBind);
+
+		inline uint32_t GetBoneCount() const
+		{
+			return static_cast<uint32_t>(m_parents.size());
+		}
+		inline uint32_t GetParent(uint32_t bone) const
+		{
+			return m_parents[bone];
+		}
+
+		// Skinning matrices from each bone's transform
+		// relative to its parent, or to the model for
+		// roots. Both spans hold GetBoneCount() matrices;
+		// callable from any thread.
+		void ComputePalette(
+		    std::span<const Math::Mat4> localPose,
+		    std::span<Math::Mat4> palette) const;
+
+	  private:
+		std::vector<uint32_t> m_parents;
+		std::vector<Math::Mat4> m_inverseBind;
+	};
+
+	// GLSL to insert right after the #version line of the
+	// vertex stage of skinned shaders. Declares the bone
+	// attributes and the Constants block with the palette,
+	// so the shader can't have its own, and SkinMatrix(),
+	// the model-space transform of the vertex. The palette
+	// holds MaxBones matrices unless SKINNING_MAX_BONES is
+	// defined before it to what the skeletons need.
+	extern const char* SkinningShaderSource;
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// 64-bit key used to order submitted render commands.
+	// Most significant bits first:
+	//   | viewport (3) | layer (8) | translucent (1) |
+	//   | shader (16) | state (6) | mesh (16) |
+	//   | depth (14) |
+	// Translucent keys move depth above the shader, so
+	// they draw back to front across shaders:
+	//   | ... | translucent (1) | depth (14) |
+	//   | shader (16) | state (6) | mesh (16) |
+	// Translucent depth 0 is kept for weighted blended
+	// OIT draws, which need no order: they come first
+	// among a layer's translucent draws, in one run
+	// grouped by shader.
+	namespace SortKey
+	{
+		constexpr uint32_t DepthBits = 14;
+		constexpr uint32_t MeshBits = 16;
+		constexpr uint32_t StateBits = 6;
+		constexpr uint32_t ShaderBits = 16;
+		constexpr uint32_t TranslucentBits = 1;
+		constexpr uint32_t LayerBits = 8;
+		constexpr uint32_t ViewportBits = 3;
+
+		constexpr uint32_t DepthShift = 0;
+		constexpr uint32_t MeshShift = DepthShift + DepthBits;
+		constexpr uint32_t StateShift = MeshShift + MeshBits;
+		constexpr uint32_t ShaderShift = StateShift + StateBits;
+		constexpr uint32_t TranslucentShift =
+		    ShaderShift + ShaderBits;
+		constexpr uint32_t LayerShift =
+		    TranslucentShift + TranslucentBits;
+		constexpr uint32_t ViewportShift =
+		    LayerShift + LayerBits;
+		static_assert(ViewportShift + ViewportBits == 64);
+
+		constexpr uint64_t Mask(uint32_t bits)
+		{
+			return (uint64_t(1) << bits) - 1;
+		}
+
+		// Where a field below the translucent bit sits in
+		// a key of either kind.
+		constexpr uint32_t FieldShift(bool translucent,
+		                              uint32_t shift)
+		{
+			if (!translucent)
+			{
+				return shift;
+			}
+			return shift == DepthShift
+			           ? TranslucentShift - DepthBits
+			           : shift - DepthBits;
+		}
+
+		constexpr bool IsTranslucent(uint64_t key)
+		{
+			return ((key >> TranslucentShift) & 1) != 0;
+		}
+
+		// Sorted translucent draws start above the OIT run.
+		constexpr uint32_t KeptDepth(bool translucent,
+		                             uint32_t depth)
+		{
+			return translucent && depth == 0 ? 1 : depth;
+		}
+
+		constexpr uint64_t Make(uint8_t layer,
+		                        bool translucent,
+		                        uint32_t shaderId,
+		                        uint32_t meshId,
+		                        uint32_t depth = 0)
+		{
+			return (uint64_t(layer) << LayerShift)
+			       | (uint64_t(translucent ? 1 : 0)
+			          << TranslucentShift)
+			       | ((shaderId & Mask(ShaderBits))
+			          << FieldShift(translucent, ShaderShift))
+			       | ((meshId & Mask(MeshBits))
+			          << FieldShift(translucent, MeshShift))
+			       | (uint64_t(KeptDepth(translucent,
+			                             depth & Mask(DepthBits)))
+			          << FieldShift(translucent, DepthShift));
+		}
+
+		constexpr uint32_t GetField(uint64_t key,
+		                            uint32_t shift,
+		                            uint32_t bits)
+		{
+			return static_cast<uint32_t>(
+			    (key >> FieldShift(IsTranslucent(key), shift))
+			    & Mask(bits));
+		}
+		constexpr uint64_t WithField(uint64_t key,
+		                             uint32_t shift,
+		                             uint32_t bits,
+		                             uint32_t value)
+		{
+			const auto at =
+			    FieldShift(IsTranslucent(key), shift);
+			return (key & ~(Mask(bits) << at))
+			       | ((value & Mask(bits)) << at);
+		}
+
+		// Moves a command to another viewport (see
+		// VegamWindow::CreateViewport()); 0 is the main
+		// window. Viewports execute in id order.
+		constexpr uint64_t WithViewport(uint64_t key,
+		                                uint32_t viewport)
+		{
+			return (key & ~(Mask(ViewportBits) << ViewportShift))
+			       | ((viewport & Mask(ViewportBits))
+			          << ViewportShift);
+		}
+		constexpr uint32_t GetViewport(uint64_t key)
+		{
+			return static_cast<uint32_t>(
+			    (key >> ViewportShift) & Mask(ViewportBits));
+		}
+
+		// Groups draws by pipeline state within a shader
+		// (see MaterialTable::GetStateId()); ids past the
+		// field only cost batching.
+		constexpr uint64_t WithState(uint64_t key,
+		                             uint32_t state)
+		{
+			return WithField(key, StateShift, StateBits, state);
+		}
+		constexpr uint64_t WithShader(uint64_t key,
+		                              uint32_t shaderId)
+		{
+			return WithField(key, ShaderShift, ShaderBits,
+			                 shaderId);
+		}
+		// A quantized depth, see QuantizeDepth(); opaque
+		// keys want it increasing with distance, translucent
+		// ones decreasing.
+		constexpr uint64_t WithDepth(uint64_t key,
+		                             uint32_t depth)
+		{
+			return WithField(
+			    key, DepthShift, DepthBits,
+			    KeptDepth(IsTranslucent(key),
+			              depth & Mask(DepthBits)));
+		}
+		constexpr uint32_t GetDepth(uint64_t key)
+		{
+			return GetField(key, DepthShift, DepthBits);
+		}
+
+		// Moves the fields to the other kind's layout.
+		constexpr uint64_t WithTranslucent(uint64_t key,
+		                                   bool translucent)
+		{
+			if (IsTranslucent(key) == translucent)
+			{
+				return key;
+			}
+			const auto high =
+			    key
+			    & ~Mask(TranslucentShift + TranslucentBits);
+			return high
+			       | Make(0, translucent,
+			              GetField(key, ShaderShift, ShaderBits),
+			              GetField(key, MeshShift, MeshBits),
+			              GetField(key, DepthShift, DepthBits))
+			       | (uint64_t(GetField(key, StateShift,
+			                            StateBits))
+			          << FieldShift(translucent, StateShift));
+		}
+
+		// Into the layer's weighted blended OIT run.
+		constexpr uint64_t WithWeightedOit(uint64_t key)
+		{
+			return WithField(WithTranslucent(key, true),
+			                 DepthShift, DepthBits, 0);
+		}
+		constexpr bool IsWeightedOit(uint64_t key)
+		{
+			return IsTranslucent(key) && GetDepth(key) == 0;
+		}
+
+		// Quantizes a view depth in [0, 1] into the depth
+		// field of the key.
+		constexpr uint32_t QuantizeDepth(float depth01)
+		{
+			if (depth01 <= 0.f)
+			{
+				return 0;
+			}
+			if (depth01 >= 1.f)
+			{
+				return static_cast<uint32_t>(
+				    Mask(DepthBits));
+			}
+			return static_cast<uint32_t>(
+			    depth01 * static_cast<float>(
+			                  Mask(DepthBits)));
+		}
+	} // namespace SortKey
+} // namespace AthiVegam::Graphics
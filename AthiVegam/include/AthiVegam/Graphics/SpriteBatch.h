@@ -0,0 +1,143 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Graphics/PipelineState.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	class CommandList;
+	class Shader;
+
+	// A textured, tinted quad, rotated about its origin.
+	struct Sprite
+	{
+		// Where the origin lands, in the batch's world
+		// space.
+		float x = 0.0f;
+		float y = 0.0f;
+		float width = 1.0f;
+		float height = 1.0f;
+		// Texture coordinates of the bottom-left and
+		// top-right corners.
+		float u0 = 0.0f;
+		float v0 = 0.0f;
+		float u1 = 1.0f;
+		float v1 = 1.0f;
+		// Radians, counter-clockwise.
+		float rotation = 0.0f;
+		// As a fraction of the size, from the bottom-left.
+		float originX = 0.5f;
+		float originY = 0.5f;
+		std::array<float, 4> color{1.0f, 1.0f, 1.0f, 1.0f};
+		// The texture holds the region turned, its columns
+		// the sprite's rows, as TextureAtlas may store it.
+		bool uvRotated = false;
+		// A 2D texture; invalid draws the color alone.
+		TextureHandle texture;
+		// Lower layers draw first; sprites of a layer and
+		// texture draw in the order they were added.
+		int16_t layer = 0;
+		// The texture's red channel is a signed distance
+		// field, edge at 0.5, as Font glyphs are: the
+		// sprite draws the color inside it, antialiased at
+		// any scale.
+		bool distanceField = false;
+	};
+
+	// Collects sprites between Begin() and End() and
+	// submits them as a few DrawSprites commands: sprites
+	// are sorted by layer, shading and texture, and each
+	// run sharing them is one instanced draw of a
+	// four-vertex strip.
+	// Each sprite is one 64-byte instance in the frame's
+	// instance data, so a batch costs its sprites' copy
+	// plus a draw per run.
+	//
+	// Recording runs on any thread, one batch per thread at
+	// a time; Initialize() and Shutdown() on the GL thread.
+	class SpriteBatch
+	{
+	  public:
+		// Per-instance layout of DrawSprites; in the
+		// attributes of the instance transform.
+		struct Instance
+		{
+			// Origin position and size.
+			float rect[4];
+			float uvs[4];
+			// Cosine and sine of the rotation, doubled for
+			// turned coordinates, and origin.
+			float transform[4];
+			float color[4];
+		};
+		static_assert(
+		    sizeof(Instance)
+		    == sizeof(RenderCommands::InstanceTransform));
+
+		SpriteBatch();
+		~SpriteBatch();
+
+		SpriteBatch(const SpriteBatch&) = delete;
+		SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+		void Initialize();
+		void Shutdown();
+		inline bool IsInitialized() const { return m_vao != 0; }
+
+		// Starts a batch drawn with a column-major
+		// view-projection, e.g. an orthographic one in
+		// pixels. Its draws go to the render manager's sort
+		// key layer renderLayer, in order within it; give
+		// batches of a frame different layers to order them.
+		void Begin(const float viewProjection[16],
+		           uint8_t renderLayer = 0,
+		           BlendMode blend = BlendMode::Alpha);
+		void Draw(const Sprite& sprite);
+		// Submits to the calling thread's command list of
+		// the render manager, or to list.
+		void End();
+		void End(CommandList& list);
+
+		// Of the last End().
+		inline uint32_t GetSpriteCount() const
+		{
+			return m_spriteCount;
+		}
+		inline uint32_t GetDrawCount() const
+		{
+			return m_drawCount;
+		}
+
+	  private:
+		void Sort();
+
+	  private:
+		std::unique_ptr<Shader> m_shader;
+		std::unique_ptr<Shader> m_distanceFieldShader;
+		uint32_t m_vao = 0;
+		uint32_t m_whiteTexture = 0;
+
+		bool m_recording = false;
+		std::array<float, 16> m_viewProjection{};
+		uint8_t m_renderLayer = 0;
+		BlendMode m_blend = BlendMode::Alpha;
+
+		std::vector<Instance> m_instances;
+		// Layer, shading and texture above the index of
+		// the instance, sorted by the former.
+		std::vector<uint64_t> m_keys;
+		std::vector<uint64_t> m_keyScratch;
+		std::vector<TextureHandle> m_textures;
+		std::vector<RenderCommands::InstanceTransform>
+		    m_sorted;
+
+		uint32_t m_spriteCount = 0;
+		uint32_t m_drawCount = 0;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+typedef struct __GLsync* GLsync;
+
+namespace AthiVegam::Graphics
+{
+	// A GL buffer split into a ring of equally sized
+	// segments for data rewritten every frame. Each write
+	// goes to the next segment, waiting on a fence only if
+	// the GPU may still be reading it, so the CPU never
+	// overwrites in-flight data and rarely stalls.
+	//
+	// With GL 4.4 the buffer is persistently mapped; older
+	// contexts map each segment unsynchronized instead.
+	class StreamBuffer
+	{
+	  public:
+		static constexpr uint32_t SegmentCount = 3;
+
+		explicit StreamBuffer(size_t segmentSize);
+		~StreamBuffer();
+
+		StreamBuffer(const StreamBuffer&) = delete;
+		StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+		// Fences the current segment, which must not be
+		// written again until the GPU is done with the draws
+		// issued so far, and returns the next one for
+		// writing. Call EndWrite() before drawing from it.
+		void* BeginWrite();
+		void EndWrite();
+
+		inline auto GetId() const { return m_buffer; }
+		inline auto GetSegment() const { return m_segment; }
+		inline auto GetSegmentSize() const
+		{
+			return m_segmentSize;
+		}
+		inline auto IsPersistent() const
+		{
+			return m_persistent != nullptr;
+		}
+
+	  private:
+		void WaitForSegment(uint32_t segment);
+
+	  private:
+		uint32_t m_buffer;
+		size_t m_segmentSize;
+		uint32_t m_segment;
+		uint8_t* m_persistent;
+		std::array<GLsync, SegmentCount> m_fences;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Uniform.h"
+#include "AthiVegam/Math/Matrix.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// Renders the scene below the display resolution with
+	// a sub-pixel camera jitter that changes every frame,
+	// and reconstructs the display resolution over time:
+	// each display pixel blends the render texels around
+	// it into the last output, reprojected with the motion
+	// vectors the scene wrote and clipped to the colors
+	// around it so stale history can't ghost. The history
+	// is kept at the display size, so the render size may
+	// change every frame, e.g. under DynamicResolution.
+	//
+	// The scene target has two color attachments:
+	//  0. the color, RGBA16F;
+	//  1. the motion, RG16F: for each pixel, its screen UV
+	//     (0 to 1) in this frame minus in the last, both
+	//     without jitter. Shaders write it at location 1;
+	//     it is cleared to 0, which static geometry under a
+	//     still camera can keep.
+	// The app applies GetJitter() to its projection, e.g.
+	// with JitterProjection(), and keeps the unjittered one
+	// for the motion. GL 4.3; GL thread unless noted.
+	class TemporalUpscaler
+	{
+	  public:
+		// minScale is the smallest render scale it will
+		// see; the jitter sequence is longer the lower it
+		// is, so every display pixel is covered.
+		explicit TemporalUpscaler(float minScale);
+		~TemporalUpscaler();
+
+		TemporalUpscaler(const TemporalUpscaler&) = delete;
+		TemporalUpscaler&
+		operator=(const TemporalUpscaler&) = delete;
+
+		bool Initialize();
+		void Shutdown();
+		inline bool IsInitialized() const
+		{
+			return m_resolveProgram != 0;
+		}
+
+		// Binds the scene target with a viewport of the
+		// render size, which is at most the display size.
+		// (Re)allocates it and the history for a new
+		// display size, dropping the history.
+		bool BeginFrame(int displayWidth, int displayHeight,
+		                int renderWidth, int renderHeight);
+		// Zeroes the motion attachment; call after the
+		// scene target is cleared, as the clear color is no
+		// motion.
+		void ClearMotion();
+		// Binds the scene target again, e.g. after drawing
+		// to another window.
+		void Bind() const;
+		// Reconstructs this frame into the history and
+		// copies it to outputFramebuffer, which is left
+		// bound with a viewport of the display size.
+		void Resolve(uint32_t outputFramebuffer);
+
+		// The next resolve ignores the history, e.g. after
+		// a camera cut. Any thread.
+		inline void ResetHistory()
+		{
+			m_resetHistory.store(true,
+			                     std::memory_order_relaxed);
+		}
+
+		// The recording thread: the jitter of the frame
+		// being recorded, in NDC. It is converted with the
+		// last render size, so the frame after a size
+		// change is off by the change's fraction of a
+		// pixel at most.
+		Float2 GetJitter() const;
+		// Offsets projection by GetJitter().
+		Math::Mat4
+		JitterProjection(const Math::Mat4& projection) const;
+		// The recording thread, once it finished a frame.
+		inline void EndRecording()
+		{
+			m_recordedFrames.fetch_add(
+			    1, std::memory_order_relaxed);
+		}
+
+		inline uint32_t GetFramebuffer() const
+		{
+			return m_framebuffer;
+		}
+		inline int GetRenderWidth() const
+		{
+			return m_renderWidth;
+		}
+		inline int GetRenderHeight() const
+		{
+			return m_renderHeight;
+		}
+
+	  private:
+		// Frame's jitter in render pixels, -0.5 to 0.5.
+		Float2 GetPixelJitter(uint64_t frame) const;
+		bool Resize(int displayWidth, int displayHeight);
+		void DestroyTargets();
+
+	  private:
+		uint32_t m_jitterPhases = 8;
+
+		uint32_t m_framebuffer = 0;
+		uint32_t m_color = 0;
+		uint32_t m_motion = 0;
+		uint32_t m_depth = 0;
+		// Written and read in turn, each with a
+		// framebuffer to copy it out of.
+		std::array<uint32_t, 2> m_history{};
+		std::array<uint32_t, 2> m_historyFramebuffers{};
+		uint32_t m_historyIndex = 0;
+		bool m_historyValid = false;
+		int m_displayWidth = 0;
+		int m_displayHeight = 0;
+		int m_renderWidth = 0;
+		int m_renderHeight = 0;
+
+		uint32_t m_resolveProgram = 0;
+		int32_t m_renderSizeLocation = -1;
+		int32_t m_jitterLocation = -1;
+		int32_t m_blendFactorLocation = -1;
+
+		// Frames recorded and resolved; the same frame
+		// has the same count on both sides.
+		std::atomic<uint64_t> m_recordedFrames{0};
+		uint64_t m_resolvedFrames = 0;
+		// Render size, width in the high half.
+		std::atomic<uint64_t> m_renderSize{0};
+		std::atomic<bool> m_resetHistory{false};
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "AthiVegam/Core/MappedFile.h"
+#include "AthiVegam/Graphics/Uniform.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	class CommandList;
+	class Shader;
+
+	// A heightfield drawn as geometry clipmaps: nested
+	// square rings of the same grid, each level twice as
+	// coarse as the one inside it, centered on the eye. A
+	// handful of small grid pieces, built once, are
+	// instanced into every ring, and the vertex shader
+	// lifts them with the level's heights; towards a
+	// ring's outer edge vertices morph to the coarser
+	// level so the rings meet without cracks.
+	//
+	// Each level keeps a TextureSize square window of its
+	// heights and normals in a layer of two array
+	// textures, addressed toroidally: texel (x, y) of the
+	// level lives at (x, y) mod TextureSize, so when the
+	// eye moves only the strips it exposes are read from
+	// the heightfield file and uploaded, and a compute
+	// pass regenerates their normals.
+	//
+	// The heightfield is a raw file of little-endian
+	// 16-bit heights, row by row, mapped rather than read;
+	// the rows ahead of the eye are prefetched. Its texel
+	// (x, y) is at world (x, z) = (x, y) * gridSpacing, and
+	// the terrain clamps at its edges.
+	//
+	// Draw() records from any thread; the rest is GL 4.3,
+	// GL thread only.
+	class Terrain
+	{
+	  public:
+		// Texels per side of a level's window; the rings
+		// are one vertex less.
+		static constexpr uint32_t TextureSize = 256;
+		static constexpr uint32_t MaxLevels = 12;
+		// Texture units of the heights and normals while
+		// the terrain draws, clear of material sets and
+		// CascadedShadows::ShadowMapUnit.
+		static constexpr uint32_t HeightsUnit = 12;
+		static constexpr uint32_t NormalsUnit = 13;
+		// Uniform block binding of the levels' origins,
+		// past ParticleSystem::EmittersBinding.
+		static constexpr uint32_t LevelsBinding = 4;
+
+		struct Settings
+		{
+			std::string heightfieldPath;
+			uint32_t heightfieldWidth = 0;
+			uint32_t heightfieldHeight = 0;
+			// World units between the finest level's
+			// vertices and between heightfield texels.
+			float gridSpacing = 1.0f;
+			// World height of the largest 16-bit height.
+			float heightScale = 256.0f;
+			uint32_t levels = 8;
+			// Texels of the finest level ahead of the eye
+			// whose rows are prefetched as it moves.
+			uint32_t prefetchTexels = 64;
+			// Fragment shader to draw with instead of the
+			// built-in one; it gets the world position and
+			// normal as `in vec3 WorldPosition` and
+			// `in vec3 WorldNormal`.
+			std::string fragmentSource;
+			// Of the built-in shader: the direction light
+			// travels in and the ground's color.
+			Float3 lightDirection{0.3f, -1.0f, 0.2f};
+			Float3 color{0.45f, 0.5f, 0.35f};
+		};
+
+		explicit Terrain(const Settings& settings);
+		~Terrain();
+
+		Terrain(const Terrain&) = delete;
+		Terrain& operator=(const Terrain&) = delete;
+
+		// Maps the heightfield, compiles the shaders and
+		// builds the pieces; false, after logging why,
+		// without GL 4.3 or a heightfield of the size set.
+		bool Initialize();
+		void Shutdown();
+		inline bool IsInitialized() const
+		{
+			return m_normalsProgram != 0;
+		}
+
+		// Moves the levels with the eye, uploading what
+		// comes into view. Call before the frame's draws.
+		void Update(const Float3& eye);
+
+		// Records the rings as a DrawTerrain command with a
+		// column-major view-projection matrix, skipping
+		// pieces outside it. eye is the one given to the
+		// last Update(). Drawn opaque in the sort key layer
+		// renderLayer.
+		void Draw(CommandList& list,
+		          const float viewProjection[16],
+		          const Float3& eye,
+		          uint8_t renderLayer = 0) const;
+
+		// World height at (x, z), from the heightfield.
+		float GetHeight(float x, float z) const;
+
+		inline const Settings& GetSettings() const
+		{
+			return m_settings;
+		}
+
+	  private:
+		struct Origin
+		{
+			int32_t x, y;
+
+			bool operator==(const Origin&) const = default;
+		};
+		using Origins = std::array<Origin, MaxLevels>;
+
+		// A mesh of the piece buffers.
+		struct Piece
+		{
+			uint32_t firstIndex;
+			uint32_t indexCount;
+			uint32_t baseVertex;
+		};
+
+		void ComputeOrigins(const Float3& eye,
+		                    Origins& origins) const;
+		void BuildPieces();
+		// Uploads the level's texels in [x, x + width) by
+		// [y, y + height).
+		void UploadRegion(uint32_t level, int32_t x, int32_t y,
+		                  uint32_t width, uint32_t height);
+		void GenerateNormals(uint32_t level);
+		// Moving by motion since the finest level last
+		// moved.
+		void Prefetch(const Float3& motion);
+		uint16_t SampleHeight(int64_t x, int64_t y) const;
+
+	  private:
+		Settings m_settings;
+		Core::MappedFile m_heightfield;
+
+		uint32_t m_heights = 0;
+		uint32_t m_normals = 0;
+		uint32_t m_levelsBuffer = 0;
+		uint32_t m_normalsProgram = 0;
+		std::unique_ptr<Shader> m_drawShader;
+		uint32_t m_vao = 0;
+		uint32_t m_vertexBuffer = 0;
+		uint32_t m_indexBuffer = 0;
+		std::vector<Piece> m_pieces;
+
+		// Where each level's window starts, in its own
+		// texels, as last uploaded.
+		Origins m_origins{};
+		bool m_uploaded = false;
+		Float3 m_lastEye{0.0f, 0.0f, 0.0f};
+		std::vector<uint16_t> m_staging;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// Pixel formats a Texture can store. Besides RGBA8 and
+	// R8 all are GPU block-compressed and are uploaded as
+	// they are; whether the driver takes them varies, see
+	// Texture::IsFormatSupported().
+	enum class TextureFormat : uint8_t
+	{
+		RGBA8,
+		RGBA8Srgb,
+		// One channel, e.g. distance fields or masks.
+		R8,
+		// S3TC, from GL_EXT_texture_compression_s3tc.
+		BC1,
+		BC1Srgb,
+		BC3,
+		BC3Srgb,
+		// RGTC, core since 3.0.
+		BC4,
+		BC5,
+		// BPTC, core since 4.2.
+		BC6H,
+		BC7,
+		BC7Srgb,
+		// Core since 4.3; some desktop drivers decode them
+		// in software at upload.
+		ETC2RGB8,
+		ETC2RGB8Srgb,
+		ETC2RGBA8,
+		ETC2RGBA8Srgb,
+		// From GL_KHR_texture_compression_astc_ldr.
+		ASTC4x4,
+		ASTC4x4Srgb,
+		ASTC6x6,
+		ASTC6x6Srgb,
+		ASTC8x8,
+		ASTC8x8Srgb,
+		COUNT
+	};
+
+	enum class TextureWrap : uint8_t
+	{
+		Repeat,
+		Clamp
+	};
+
+	enum class TextureType : uint8_t
+	{
+		Texture2D,
+		// GL_TEXTURE_2D_ARRAY of layerCount layers, each
+		// with every level.
+		Array
+	};
+
+	struct TextureDesc
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		// Level 0 is the full size, each further level
+		// half of the previous one.
+		uint32_t levelCount = 1;
+		TextureType type = TextureType::Texture2D;
+		uint32_t layerCount = 1;
+		TextureFormat format = TextureFormat::RGBA8;
+		TextureWrap wrap = TextureWrap::Repeat;
+		// 1 disables anisotropic filtering.
+		float maxAnisotropy = 1.0f;
+	};
+
+	// A 2D texture in immutable storage (glTexStorage2D)
+	// with every level allocated up front. Levels are
+	// uploaded one at a time, usually smallest first, and
+	// sampling is clamped to the finest level below which
+	// all are uploaded, so a streamed texture draws blurry
+	// rather than garbage while its top levels load.
+	class Texture
+	{
+	  public:
+		static constexpr uint32_t MaxLevels = 16;
+
+		// Placeholder for a texture still being read. It
+		// owns no GL object and binds as none until
+		// Create().
+		Texture() = default;
+		explicit Texture(const TextureDesc& desc);
+		~Texture();
+
+		Texture(const Texture&) = delete;
+		Texture& operator=(const Texture&) = delete;
+
+		// Allocates a placeholder's storage. GL thread.
+		bool Create(const TextureDesc& desc);
+		// Trades GL objects and contents with other, e.g. to
+		// swap a hot reloaded texture in behind a handle.
+		// GL thread.
+		void Swap(Texture& other);
+
+		// data holds GetLevelSize(level) bytes, every layer
+		// of the level. GL thread.
+		void UploadLevel(uint32_t level, const void* data);
+		// One layer of an array's level, GetLayerSize(level)
+		// bytes. A level counts as uploaded once each of its
+		// layers was. GL thread.
+		void UploadLayer(uint32_t layer, uint32_t level,
+		                 const void* data);
+		// Rewrites part of an uncompressed 2D texture's
+		// level, tightly packed rows, e.g. a glyph of an
+		// atlas. Does not mark the level uploaded. GL
+		// thread.
+		void UploadRegion(uint32_t level, uint32_t x,
+		                  uint32_t y, uint32_t width,
+		                  uint32_t height, const void* data);
+
+		// Reallocates storage to hold only the levels from
+		// level on, keeping those uploaded; finer levels are
+		// dropped and can be uploaded again, which moves the
+		// storage back. Frees memory without recreating the
+		// texture, but changes GetId(), GetArrayId() and
+		// GetBindlessHandle(). Needs glCopyImageSubData
+		// (GL 4.3). GL thread.
+		bool SetStorageLevel(uint32_t level);
+
+		// The texture as a GL_TEXTURE_2D_ARRAY, which is how
+		// materials sample every texture: the texture itself
+		// for arrays, a one-layer view (GL 4.3) of it
+		// otherwise. 0 if views are not available.
+		uint32_t GetArrayId();
+		// ARB_bindless_texture handle of GetArrayId(), made
+		// resident on first use. The view's sampler state is
+		// frozen from then on, so levels streamed in later
+		// no longer move its base level; samplers clamp to
+		// GetResidentLevel() instead (see MaterialTable).
+		uint64_t GetBindlessHandle();
+		static bool IsBindlessSupported();
+
+		inline auto GetId() const { return m_id; }
+		inline const auto& GetDesc() const { return m_desc; }
+		inline bool IsCreated() const { return m_id != 0; }
+		// The finest level sampled; the level count while
+		// nothing can be.
+		inline auto GetResidentLevel() const
+		{
+			return m_residentLevel;
+		}
+		inline bool IsReady() const
+		{
+			return m_id && m_residentLevel < m_desc.levelCount;
+		}
+		inline bool IsLevelUploaded(uint32_t level) const
+		{
+			return (m_uploadedLevels >> level) & 1;
+		}
+		// The finest level with storage. GL level numbers,
+		// and sampler LODs, count from it.
+		inline auto GetStorageLevel() const
+		{
+			return m_storageLevel;
+		}
+		// Bytes of the levels in storage.
+		size_t GetStorageSize() const;
+
+		// Stamps the texture as drawn in frame (see
+		// GpuMemory::GetFrame()), for eviction. GL thread.
+		inline void MarkUsed(uint64_t frame) const
+		{
+			m_lastUsedFrame = std::max(m_lastUsedFrame, frame);
+		}
+		inline auto GetLastUsedFrame() const
+		{
+			return m_lastUsedFrame;
+		}
+
+		inline size_t GetLevelSize(uint32_t level) const
+		{
+			return GetLevelSize(m_desc, level);
+		}
+		inline size_t GetLayerSize(uint32_t level) const
+		{
+			return GetLayerSize(m_desc, level);
+		}
+		// Of all layers, and of one.
+		static size_t GetLevelSize(const TextureDesc& desc,
+		                           uint32_t level);
+		static size_t GetLayerSize(const TextureDesc& desc,
+		                           uint32_t level);
+		// Needs a current context.
+		static bool IsFormatSupported(TextureFormat format);
+		static const char* GetFormatName(TextureFormat format);
+
+	  private:
+		void MarkUploaded(uint32_t level);
+
+	  private:
+		uint32_t m_id = 0;
+		uint32_t m_arrayView = 0;
+		uint64_t m_bindlessHandle = 0;
+		TextureDesc m_desc;
+		uint32_t m_residentLevel = 0;
+		uint32_t m_storageLevel = 0;
+		uint32_t m_uploadedLevels = 0;
+		std::array<uint32_t, MaxLevels> m_uploadedLayers{};
+		// Bookkeeping, so draws through const references
+		// can stamp it.
+		mutable uint64_t m_lastUsedFrame = 0;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Handle.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	struct Sprite;
+
+	// An image to pack: RGBA8, rows packed, the first row
+	// the bottom one as GL takes them.
+	struct AtlasImage
+	{
+		std::string name;
+		const uint8_t* pixels = nullptr;
+		uint32_t width = 0;
+		uint32_t height = 0;
+	};
+
+	// Packs many small images, such as sprites, UI pieces
+	// and icons, into one RGBA8 texture with stb_rect_pack,
+	// so the sprites drawn from them share a texture and a
+	// SpriteBatch run. Each image keeps a region of the
+	// atlas whose coordinates replace the image's own.
+	//
+	// Around each image its edge texels are repeated for
+	// padding texels, so filtering never reaches a
+	// neighbour; with mip levels, regions also start and
+	// end on multiples of 2^(levelCount - 1) texels, so
+	// every level keeps them apart too. Images taller than
+	// wide may be stored turned, which packs tighter (see
+	// Sprite::uvRotated).
+	//
+	// Build() and Save() are CPU only and run anywhere,
+	// e.g. offline in a tool; Load() reads a saved atlas
+	// back without packing again. CreateTexture() and
+	// Destroy() run on the GL thread.
+	class TextureAtlas
+	{
+	  public:
+		static constexpr uint32_t NoRegion = 0xFFFFFFFF;
+
+		struct Settings
+		{
+			// Largest width and height; the atlas is the
+			// smallest square power of two holding every
+			// image.
+			uint32_t maxSize = 4096;
+			uint32_t padding = 2;
+			uint32_t levelCount = 1;
+			bool allowRotation = true;
+		};
+
+		struct Region
+		{
+			// Bottom-left and top-right in the atlas.
+			float u0 = 0.0f;
+			float v0 = 0.0f;
+			float u1 = 0.0f;
+			float v1 = 0.0f;
+			// The atlas holds the image turned: its columns
+			// are the image's rows.
+			bool rotated = false;
+		};
+
+		TextureAtlas();
+		explicit TextureAtlas(const Settings& settings);
+		~TextureAtlas();
+
+		TextureAtlas(const TextureAtlas&) = delete;
+		TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+		// Packs the images, replacing anything built or
+		// loaded; false, after logging why, when they don't
+		// fit in maxSize or names repeat.
+		bool Build(std::span<const AtlasImage> images);
+
+		// The regions and every level's pixels, as built.
+		bool Save(const std::string& path) const;
+		bool Load(const std::string& path);
+
+		// Uploads the built or loaded atlas, then releases
+		// the pixels.
+		bool CreateTexture();
+		void Destroy();
+		inline TextureHandle GetTexture() const
+		{
+			return m_texture;
+		}
+
+		// NoRegion for names not in the atlas.
+		uint32_t Find(std::string_view name) const;
+		inline const Region& GetRegion(uint32_t region) const
+		{
+			return m_regions[region];
+		}
+		inline uint32_t GetRegionCount() const
+		{
+			return static_cast<uint32_t>(m_regions.size());
+		}
+		// Texels per side.
+		inline uint32_t GetSize() const { return m_size; }
+
+		// Points the sprite at a region: the atlas texture
+		// and the region's coordinates.
+		void Apply(uint32_t region, Sprite& sprite) const;
+
+	  private:
+		void Reset();
+		void GenerateLevels();
+
+	  private:
+		Settings m_settings;
+		uint32_t m_size = 0;
+		std::vector<Region> m_regions;
+		std::vector<std::string> m_names;
+		std::unordered_map<std::string, uint32_t> m_lookup;
+		// Until CreateTexture(), from level 0 on.
+		std::vector<std::vector<uint8_t>> m_levels;
+		TextureHandle m_texture;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "AthiVegam/Graphics/FrameReadback.h"
+#include "AthiVegam/Graphics/RenderTarget.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace AthiVegam::Graphics
+{
+	class Mesh;
+	class Shader;
+
+	// Renders meshes into small offscreen images, e.g. the
+	// previews of an asset browser: each fitted to the
+	// image from above and to the side, lit by one light,
+	// on a transparent background. The pixels are read
+	// back through a FrameReadback, so rendering never
+	// waits for the GPU. GL thread only.
+	class ThumbnailRenderer
+	{
+	  public:
+		ThumbnailRenderer() = default;
+		~ThumbnailRenderer();
+
+		ThumbnailRenderer(const ThumbnailRenderer&) = delete;
+		ThumbnailRenderer&
+		operator=(const ThumbnailRenderer&) = delete;
+
+		// size texels per side.
+		bool Initialize(int size);
+		// Delivers what is in flight first.
+		void Shutdown();
+		inline bool IsInitialized() const
+		{
+			return m_shader != nullptr;
+		}
+		inline int GetSize() const
+		{
+			return m_target.GetWidth();
+		}
+
+		// RGBA8 pixels, bottom row first, and the ticket
+		// passed to Render(); as FrameReadback's.
+		inline void SetCallback(FrameReadback::Callback callback)
+		{
+			m_readback.SetCallback(std::move(callback));
+		}
+
+		// Positions, normals and texture coordinates are read
+		// at locations 0, 1 and 2, as tools/cookmeshes.py
+		// lays them out; without normals the faces' are
+		// used. albedo is a 2D texture, 0 for white. False
+		// for meshes that are not ready or unbounded.
+		bool Render(const Mesh& mesh, uint32_t albedo,
+		            uint64_t ticket);
+		// Hands finished images to the callback; once per
+		// frame.
+		inline void Poll() { m_readback.Poll(); }
+
+	  private:
+		RenderTarget m_target;
+		FrameReadback m_readback;
+		std::unique_ptr<Shader> m_shader;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "AthiVegam/Core/StringId.h"
+
+#include <cstdint>
+#include <string_view>
+
+namespace AthiVegam::Graphics
+{
+	// Value types that select the glProgramUniform* variant
+	// a UniformHandle is set with.
+	struct Int2
+	{
+		int x, y;
+	};
+	struct Int3
+	{
+		int x, y, z;
+	};
+	struct Int4
+	{
+		int x, y, z, w;
+	};
+	struct Float2
+	{
+		float x, y;
+	};
+	struct Float3
+	{
+		float x, y, z;
+	};
+	struct Float4
+	{
+		float x, y, z, w;
+	};
+
+	// Location of a uniform in one shader, resolved once
+	// with Shader::GetUniform<T>(). Setting through a handle
+	// is a single glProgramUniform* call.
+	template <typename T>
+	struct UniformHandle
+	{
+		int location = -1;
+
+		constexpr bool IsValid() const { return location >= 0; }
+	};
+
+	// Uniform name with its Core::StringId. Built from a
+	// string literal the id is computed at compile time, so
+	// lookups by name never hash at run time.
+	struct UniformName
+	{
+		consteval UniformName(const char* literal)
+		    : name(literal)
+		    , id(Core::MakeStringId(name))
+		{
+		}
+		constexpr UniformName(std::string_view name,
+		                      Core::StringId id)
+		    : name(name)
+		    , id(id)
+		{
+		}
+
+		static constexpr UniformName
+		FromString(std::string_view name)
+		{
+			return {name, Core::MakeStringId(name)};
+		}
+
+		std::string_view name;
+		Core::StringId id;
+	};
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace AthiVegam::Graphics
+{
+	// Storage format of a single vertex attribute. The
+	// Norm formats are remapped to [0, 1] / [-1, 1] when
+	// read in the shader.
+	enum class VertexFormat : uint8_t
+	{
+		Float1,
+		Float2,
+		Float3,
+		Float4,
+		Half2,
+		Half4,
+		Byte4Norm,
+		UByte4Norm,
+		Short2Norm,
+		Short4Norm,
+		UShort2Norm,
+		UShort4Norm,
+		// Signed 10-10-10-2, for normals and tangents.
+		Int1010102Norm,
+		// Integer, read as a uvec4; bone indices.
+		UByte4,
+		COUNT
+	};
+
+	uint32_t GetFormatSize(VertexFormat format);
+	// Read as integers (ivec/uvec) rather than floats.
+	bool IsIntegerFormat(VertexFormat format);
+
+	struct VertexAttribute
+	{
+		uint32_t location = 0;
+		VertexFormat format = VertexFormat::Float3;
+		uint32_t offset = 0;
+	};
+
+	// Describes one interleaved vertex buffer. Attribute
+	// offsets are assigned in the order they are added.
+	// Locations 4-7 are taken by the per-instance transform
+	// of instanced draws.
+	class VertexLayout
+	{
+	  public:
+		static constexpr uint32_t MaxAttributes = 8;
+
+		VertexLayout() = default;
+
+		// A single float position stream at location 0, the
+		// layout of meshes created from a float array.
+		static VertexLayout Positions(uint32_t dimensions);
+
+		VertexLayout& Add(uint32_t location,
+		                  VertexFormat format);
+
+		// Sets up the attribute pointers of the bound VAO
+		// for the buffer bound to GL_ARRAY_BUFFER.
+		void Apply() const;
+
+		inline auto GetStride() const { return m_stride; }
+		inline auto GetAttributeCount() const
+		{
+			return m_count;
+		}
+		inline const auto& GetAttribute(uint32_t i) const
+		{
+			return m_attributes[i];
+		}
+
+		bool operator==(const VertexLayout& other) const;
+
+	  private:
+		std::array<VertexAttribute, MaxAttributes>
+		    m_attributes{};
+		uint32_t m_count = 0;
+		uint32_t m_stride = 0;
+	};
+
+	// Packing helpers for filling compact vertex data.
+	uint16_t PackHalf(float value);
+	uint32_t PackInt1010102(float x, float y, float z,
+	                        float w = 0.f);
+} // namespace AthiVegam::Graphics
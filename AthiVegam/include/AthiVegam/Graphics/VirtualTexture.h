@@ -0,0 +1,268 @@
+#pragma once
+
+#include "AthiVegam/Assets/Archive.h"
+#include "AthiVegam/Assets/AssetId.h"
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef struct __GLsync* GLsync;
+
+namespace AthiVegam::Graphics
+{
+	// Layout of a virtual texture's archive entry
+	// (ArchiveFormat::EntryType::VirtualTexture), as
+	// tools/cooktextures.py writes it. Little-endian:
+	//
+	//   Header
+	//   Level[levelCount]
+	//   zeros up to ArchiveFormat::ChunkSize
+	//   Page[pageCount]
+	//
+	// A page is PageSize texels square of RGBA8, bottom
+	// row first: PageContent texels of its level with
+	// Border texels of the neighbouring pages around them,
+	// clamped at the level's edges. Pages are exactly one
+	// archive chunk each, so a page is one read; level by
+	// level from the full size on, each row by row from
+	// the bottom. Every level halves the previous one, and
+	// the last fits in one page.
+	namespace VirtualTextureFormat
+	{
+		constexpr uint32_t Magic = 0x54564156; // "AVVT"
+		constexpr uint32_t Version = 1;
+		constexpr uint32_t PageSize = 128;
+		constexpr uint32_t Border = 4;
+		constexpr uint32_t PageContent = PageSize - 2 * Border;
+		constexpr uint32_t PageBytes = PageSize * PageSize * 4;
+		constexpr uint32_t MaxLevels = 16;
+
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			// Texels of level 0.
+			uint32_t width;
+			uint32_t height;
+			uint32_t levelCount;
+			uint32_t pageCount;
+			uint32_t reserved[2];
+		};
+
+		struct Level
+		{
+			uint32_t pagesX;
+			uint32_t pagesY;
+			// Index of its first page among all pages.
+			uint32_t firstPage;
+			uint32_t reserved;
+		};
+
+		static_assert(sizeof(Header) == 32);
+		static_assert(sizeof(Level) == 16);
+		static_assert(PageBytes
+		              == Assets::ArchiveFormat::ChunkSize);
+	} // namespace VirtualTextureFormat
+
+	// Sparse virtual texturing of one huge texture, such
+	// as the unique texture of a terrain: only the pages
+	// the frame samples live in a cache texture of fixed
+	// size, however large the texture is.
+	//
+	// Shaders including VirtualTextureShaderSource sample
+	// through a page table with an entry per page of every
+	// level, pointing at the cache slot of the page or,
+	// until it streams in, of its nearest resident
+	// ancestor. Sampling also records the page it wanted
+	// in a feedback bitset, from one fragment in
+	// feedbackStride squared; Update() reads the bitset
+	// back a few frames later without stalling, and a
+	// streaming thread reads and decompresses the missing
+	// pages from the archive, coarsest first. Pages
+	// evict least recently wanted first; the last level
+	// is read at Initialize() and always stays.
+	//
+	// One virtual texture is bound at a time. GL 4.3, GL
+	// thread only.
+	class VirtualTexture
+	{
+	  public:
+		// Unit the cache is sampled from and the uniform
+		// and shader storage bindings of the shader source,
+		// past every other's.
+		static constexpr uint32_t CacheUnit = 16;
+		static constexpr uint32_t ParamsBinding = 5;
+		static constexpr uint32_t PageTableBinding = 19;
+		static constexpr uint32_t FeedbackBinding = 20;
+		static constexpr uint32_t ReadbackSlots = 3;
+
+		struct Settings
+		{
+			std::string archivePath;
+			Assets::AssetId id{};
+			// Pages per side of the cache; 32 holds 4096
+			// squared texels in 64 MB.
+			uint32_t cachePages = 32;
+			// Uploaded per Update(), and read ahead at most.
+			uint32_t maxUploads = 16;
+			uint32_t maxPending = 64;
+			// A power of two.
+			uint32_t feedbackStride = 4;
+			// Color, decoded to linear when sampled.
+			bool srgb = true;
+		};
+
+		explicit VirtualTexture(const Settings& settings);
+		~VirtualTexture();
+
+		VirtualTexture(const VirtualTexture&) = delete;
+		VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+		// Opens the archive, reads the last level and
+		// starts streaming; false, after logging why,
+		// without GL 4.3, enough units and bindings, or the
+		// entry.
+		bool Initialize();
+		void Shutdown();
+		inline bool IsInitialized() const
+		{
+			return m_cache != 0;
+		}
+
+		// Once per frame, before its draws: reads back
+		// finished feedback, requests the pages it wants,
+		// uploads those read since, and starts the frame's
+		// feedback.
+		void Update();
+		// Binds the cache, page table, feedback and params
+		// for the frame's shading.
+		void Bind();
+
+		inline uint32_t GetWidth() const
+		{
+			return m_header.width;
+		}
+		inline uint32_t GetHeight() const
+		{
+			return m_header.height;
+		}
+		inline uint32_t GetResidentCount() const
+		{
+			return m_residentCount;
+		}
+		inline uint32_t GetPendingCount() const
+		{
+			return m_pendingCount;
+		}
+
+	  private:
+		static constexpr uint32_t NoSlot = 0xFFFFFFFF;
+
+		struct Slot
+		{
+			uint32_t page = NoSlot;
+			// Update() that last wanted it.
+			uint64_t lastWanted = 0;
+		};
+
+		struct LoadedPage
+		{
+			uint32_t page;
+			// Empty if the read failed.
+			std::vector<uint8_t> pixels;
+		};
+
+		struct Readback
+		{
+			uint32_t buffer = 0;
+			GLsync fence = nullptr;
+		};
+
+		struct PageCoord
+		{
+			uint32_t level, x, y;
+		};
+
+		enum class PageState : uint8_t
+		{
+			Absent,
+			Pending,
+			Resident,
+			Failed
+		};
+
+		bool ReadPage(uint32_t page,
+		              std::vector<uint8_t>& stored,
+		              std::vector<uint8_t>& pixels) const;
+		void StreamMain();
+		void ReadFeedback(const uint32_t* bits);
+		void Request(std::vector<uint32_t>& pages);
+		void Upload(LoadedPage& loaded);
+		// Puts the page in a slot, evicting if needed;
+		// NoSlot when every slot was wanted lately.
+		uint32_t Place(uint32_t page, const uint8_t* pixels);
+		uint32_t FindSlot() const;
+		// Points the page, and descendants that are not
+		// resident, at entry.
+		void SetEntry(uint32_t level, uint32_t x, uint32_t y,
+		              uint32_t entry);
+		uint32_t GetPage(uint32_t level, uint32_t x,
+		                 uint32_t y) const;
+		PageCoord Locate(uint32_t page) const;
+		void UploadTable();
+
+	  private:
+		Settings m_settings;
+		Assets::Archive m_archive;
+		const Assets::Archive::Entry* m_entry = nullptr;
+		VirtualTextureFormat::Header m_header{};
+		std::vector<VirtualTextureFormat::Level> m_levels;
+
+		std::vector<Slot> m_slots;
+		// Per page: its slot, or NoSlot.
+		std::vector<uint32_t> m_pageSlots;
+		std::vector<PageState> m_pageStates;
+		// The page table as the GPU holds it, and the
+		// range that changed since it was uploaded.
+		std::vector<uint32_t> m_table;
+		uint32_t m_dirtyBegin = 0;
+		uint32_t m_dirtyEnd = 0;
+		uint64_t m_frame = 0;
+		uint32_t m_residentCount = 0;
+		uint32_t m_pendingCount = 0;
+		std::vector<uint32_t> m_wanted;
+
+		uint32_t m_cache = 0;
+		uint32_t m_tableBuffer = 0;
+		uint32_t m_feedbackBuffer = 0;
+		uint32_t m_paramsBuffer = 0;
+		size_t m_feedbackSize = 0;
+		std::array<Readback, ReadbackSlots> m_readbacks{};
+		uint32_t m_nextReadback = 0;
+
+		// Guards the queues between Update() and the
+		// streaming thread.
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::deque<uint32_t> m_requests;
+		std::vector<LoadedPage> m_loaded;
+		// Page buffers to reuse.
+		std::vector<std::vector<uint8_t>> m_buffers;
+		bool m_stopRequested = false;
+		std::thread m_thread;
+	};
+
+	// GLSL to insert after the #version 430 line of
+	// fragment shaders sampling the bound virtual texture.
+	// Declares SampleVirtualTexture(uv), uv in [0, 1]
+	// clamped at the edges, which filters bilinearly from
+	// the finest resident level at or above the one the
+	// derivatives ask for, and records that level's page.
+	extern const char* VirtualTextureShaderSource;
+} // namespace AthiVegam::Graphics
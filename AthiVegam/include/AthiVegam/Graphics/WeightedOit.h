@@ -0,0 +1,91 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Shader.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace AthiVegam::Graphics
+{
+	class RenderState;
+
+	// Weighted blended order-independent transparency
+	// (McGuire and Bavoil): BlendMode::WeightedOit draws
+	// add their color and coverage, weighted by depth,
+	// into an accumulation target and multiply their
+	// alpha into its revealage, so they draw in any order
+	// and batch like opaque draws. One full-screen pass
+	// then composites the weighted average over the
+	// framebuffer. Intersecting surfaces blend right; the
+	// cost is that nearer layers only dominate by weight.
+	//
+	// The targets test against the framebuffer's own depth:
+	// attached as it is for framebuffer objects, blitted
+	// for the default framebuffer, which then needs a
+	// 24-bit depth and 8-bit stencil.
+	// GL 4.3; GL thread only.
+	class WeightedOit
+	{
+	  public:
+		WeightedOit();
+		~WeightedOit();
+
+		WeightedOit(const WeightedOit&) = delete;
+		WeightedOit& operator=(const WeightedOit&) = delete;
+
+		// GLSL for fragment shaders drawing with the blend
+		// mode: AvWeightedOit(color, accumulation, weight)
+		// turns a straight alpha color into the values for
+		// outputs 0 and 1.
+		static const char* GetShaderSource();
+
+		// False, after logging why, without GL 4.3 or if
+		// the composite shader fails to compile.
+		bool Initialize();
+		void Shutdown();
+		inline bool IsInitialized() const
+		{
+			return m_vao != 0;
+		}
+
+		// Redirects drawing from the bound framebuffer into
+		// the cleared targets, sized to cover the viewport.
+		// False, leaving the framebuffer bound, if the
+		// targets can't be made.
+		bool Begin();
+		// Blends the accumulated draws over the framebuffer
+		// Begin() found and binds it again. The state cache
+		// is invalidated.
+		void Composite(RenderState& state);
+		inline bool IsActive() const { return m_active; }
+
+	  private:
+		void Resize(int width, int height);
+		bool AttachDepth(uint32_t framebuffer);
+		void DestroyTargets();
+
+	  private:
+		uint32_t m_framebuffer = 0;
+		// RGBA16F: weighted premultiplied color, and the
+		// revealage in alpha.
+		uint32_t m_accumulation = 0;
+		// R16F: the summed weighted coverage.
+		uint32_t m_weight = 0;
+		// For the default framebuffer's depth, which can't
+		// be attached.
+		uint32_t m_depth = 0;
+		int m_width = 0;
+		int m_height = 0;
+		// The framebuffer's depth as attached, to notice
+		// when it changes.
+		int32_t m_depthType = 0;
+		uint32_t m_depthName = 0;
+
+		uint32_t m_target = 0;
+		bool m_active = false;
+		std::unique_ptr<Shader> m_compositeShader;
+		// No attributes; the triangle comes from
+		// gl_VertexID.
+		uint32_t m_vao = 0;
+	};
+} // namespace AthiVegam::Graphics
@@ -1,11 +1,12 @@
 #pragma once
 
+#include "AthiVegam/Core/Events.h"
+
 #include <array>
-#include <memory>
-#include <unordered_map>
+#include <cstdint>
+#include <span>
 
 using SDL_GameController = struct _SDL_GameController;
-struct SDL_ControllerDeviceEvent;
 
 namespace AthiVegam::Input
 {
@@ -54,22 +55,56 @@ namespace AthiVegam::Input
 		COUNT
 	};
 
+	// Bit (1 << ControllerButton) per button.
+	using ControllerButtonMask = uint32_t;
+	using ControllerAxes =
+	    std::span<const float, (int)ControllerAxis::COUNT>;
+
+	// Controllers live in a fixed array of slots; a
+	// controller id is its slot index.
 	class Controller
 	{
 	  public:
-		static void
-		OnControllerConnected(SDL_ControllerDeviceEvent& e);
+		static constexpr int MaxControllers = 8;
+		static constexpr float DefaultDeadzone = 0.1f;
+		// The input.deadzone CVar, DefaultDeadzone unless
+		// set.
+		static float GetDeadzone();
+
+		// Subscribed to the engine's event bus. Devices are
+		// opened and closed on a thread of their own, as
+		// opening can block while one is enumerated; a
+		// connected controller takes its slot in the first
+		// Update() after it opened.
+		static void OnControllerConnected(
+		    std::span<const Core::ControllerConnected> events);
 		static void OnControllerDisconnected(
-		    SDL_ControllerDeviceEvent& e);
+		    std::span<const Core::ControllerDisconnected>
+		        events);
 
 		static void Shutdown();
 		static void Update();
 
+		// Samples controllers on a thread of their own,
+		// rateHz times a second. Update() then takes the
+		// latest sample instead of querying SDL, so input
+		// age no longer depends on the frame time.
+		static void StartSampling(uint32_t rateHz);
+		static void StopSampling();
+
+		// Takes a controller's state from a recording instead
+		// of SDL. Until the next Update(), the controller
+		// counts as available exactly when connected is set.
+		static void Apply(int controllerId, bool connected,
+		                  ControllerButtonMask buttons,
+		                  ControllerAxes axes);
+
 		inline static bool
 		IsControllerAvailabe(int controllerId)
 		{
-			return availableControllers.count(controllerId)
-			       > 0;
+			return controllerId >= 0
+			       && controllerId < MaxControllers
+			       && controllers[controllerId].connected;
 		}
 
 		static bool GetButton(int controllerId,
@@ -80,38 +115,50 @@ namespace AthiVegam::Input
 		                        ControllerButton button);
 		static float GetAxisRaw(int controllerId,
 		                        ControllerAxis axis);
-		static float GetAxis(int controllerId,
-		                     ControllerAxis axis);
+		// GetAxisRaw(), or 0 within deadzone. See
+		// InputActions for per-binding dead zones.
+		static float
+		GetAxis(int controllerId, ControllerAxis axis,
+		        float deadzone = GetDeadzone());
+
+		// Every button at once, for code that checks many;
+		// 0 for a controller that is not available.
+		static ControllerButtonMask
+		GetButtons(int controllerId);
+		static ControllerButtonMask
+		GetButtonsDown(int controllerId);
+		static ControllerButtonMask
+		GetButtonsUp(int controllerId);
+		// Raw axes, -1 to 1, indexed by ControllerAxis; all
+		// 0 for a controller that is not available.
+		static ControllerAxes GetAxesRaw(int controllerId);
+
+		// Maps an SDL joystick instance id, as carried by
+		// controller events, to a controller id; -1 if it is
+		// not connected.
+		static int GetControllerId(int instanceId);
 
 	  private:
 		static int GentNextFreeIndex();
+		// Gives the controllers opened since the last call
+		// their slots.
+		static void AddOpenedControllers();
 
 	  private:
 		struct SDLController
 		{
-			int controllerIndex = -1;
+			int deviceIndex = -1;
+			int instanceId = -1;
 			SDL_GameController* gc = nullptr;
+			bool connected = false;
 
-			std::array<bool, (int)ControllerButton::COUNT>
-			    buttonStates;
-			std::array<bool, (int)ControllerButton::COUNT>
-			    prevButtonStates;
-
+			ControllerButtonMask buttons = 0;
+			ControllerButtonMask prevButtons = 0;
 			std::array<float, (int)ControllerAxis::COUNT>
-			    axesStates; /* -1f to 1f */
-			std::array<float, (int)ControllerAxis::COUNT>
-			    prevAxesStates; /* -1f to 1f */
-
-			void UpdatePreviousStates()
-			{
-				prevButtonStates = buttonStates;
-				prevAxesStates = axesStates;
-			}
+			    axes{}; /* -1f to 1f */
 		};
 
-		static std::unordered_map<
-		    int, std::unique_ptr<SDLController>>
-		    availableControllers;
-		static float deadzone;
+		static std::array<SDLController, MaxControllers>
+		    controllers;
 	};
 } // namespace AthiVegam::Input
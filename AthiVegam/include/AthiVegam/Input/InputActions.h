@@ -0,0 +1,80 @@
+#pragma once
+
+#include "AthiVegam/Input/Controller.h"
+#include "AthiVegam/Input/Keyboard.h"
+#include "AthiVegam/Input/Mouse.h"
+
+#include <cstdint>
+#include <string_view>
+
+namespace AthiVegam::Input
+{
+	// Named actions (on/off) and axes (-1 to 1) that game
+	// code reads instead of raw keys and buttons. Bindings
+	// may change at any time; the next Update() compiles
+	// them into flat per-source tables, and evaluates every
+	// action and axis once per tick after the devices have
+	// been updated.
+	class InputActions
+	{
+	  public:
+		enum class ActionId : uint16_t
+		{
+		};
+		enum class AxisId : uint16_t
+		{
+		};
+
+		// A controllerId of AnyController binds every
+		// controller.
+		static constexpr int AnyController = -1;
+		static constexpr float DefaultDeadzone =
+		    Controller::DefaultDeadzone;
+
+		// Returns the existing id for a name already added.
+		static ActionId AddAction(std::string_view name);
+		static AxisId AddAxis(std::string_view name);
+
+		static void BindKey(ActionId action, KeyCode key);
+		static void BindMouseButton(ActionId action,
+		                            MouseButton button);
+		static void
+		BindControllerButton(ActionId action,
+		                     ControllerButton button,
+		                     int controllerId = AnyController);
+
+		// While held, a key or button adds value to the axis,
+		// e.g. -1 for A and 1 for D.
+		static void BindKey(AxisId axis, KeyCode key,
+		                    float value);
+		static void
+		BindControllerButton(AxisId axis,
+		                     ControllerButton button,
+		                     float value,
+		                     int controllerId = AnyController);
+		// Stick or trigger values within deadzone read 0;
+		// the rest is rescaled to still reach 1, then
+		// multiplied by scale.
+		static void
+		BindControllerAxis(AxisId axis,
+		                   ControllerAxis controllerAxis,
+		                   float deadzone =
+		                       Controller::GetDeadzone(),
+		                   float scale = 1.0f,
+		                   int controllerId = AnyController);
+
+		static void ClearBindings();
+
+		// Once per tick, after Keyboard, Mouse and
+		// Controller.
+		static void Update();
+
+		static bool Action(ActionId action);
+		static bool ActionDown(ActionId action);
+		static bool ActionUp(ActionId action);
+		static float Axis(AxisId axis);
+
+	  private:
+		static void Compile();
+	};
+} // namespace AthiVegam::Input
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "AthiVegam/Input/Controller.h"
+#include "AthiVegam/Input/Keyboard.h"
+#include "AthiVegam/Input/Mouse.h"
+
+#include <cstdint>
+#include <span>
+
+union SDL_Event;
+
+namespace AthiVegam::Input
+{
+	enum class InputEventType : uint8_t
+	{
+		Key,
+		MouseButton,
+		MouseMotion,
+		MouseWheel,
+		ControllerButton,
+		ControllerAxis
+	};
+
+	struct InputEvent
+	{
+		InputEventType type;
+		// Key, mouse and controller buttons.
+		bool pressed;
+		bool repeat;
+		// Controller events; Controller's id, or -1 for a
+		// controller that has since disconnected.
+		int controllerId;
+		// steady_clock nanoseconds when SDL queued the
+		// event.
+		uint64_t timestamp;
+
+		union
+		{
+			KeyCode key;
+			MouseButton mouseButton;
+			ControllerButton controllerButton;
+			ControllerAxis controllerAxis;
+		};
+		// Mouse position, motion or wheel delta.
+		int x, y, dx, dy;
+		// Controller axis, -1 to 1.
+		float value;
+	};
+
+	// Key, mouse and controller events in the order SDL
+	// queued them, each stamped on arrival. The fixed
+	// timestep hands every tick the events stamped before
+	// its simulated end, so a press and release within
+	// one frame both reach the simulation, each in the tick
+	// it happened in. Events after the frame's last tick
+	// wait for the next one.
+	class InputQueue
+	{
+	  public:
+		static void Initialize();
+		static void Shutdown();
+
+		// Main thread, once per tick: collects events
+		// stamped at or before tickEnd, a steady_clock
+		// time in nanoseconds.
+		static void BeginTick(uint64_t tickEnd);
+		// This tick's events, oldest first.
+		static std::span<const InputEvent> Events();
+		// Replaces this tick's events, for input replay.
+		static void
+		SetEvents(std::span<const InputEvent> events);
+
+	  private:
+		static int OnSDLEvent(void* userData, SDL_Event* e);
+	};
+} // namespace AthiVegam::Input
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+
+namespace AthiVegam::Input
+{
+	// Records the Keyboard, Mouse and Controller state and
+	// the InputQueue events of every tick to a binary file,
+	// and replays such a file through the same API in place
+	// of SDL. With the fixed timestep, a replay feeds the
+	// simulation exactly what the recorded session saw, so
+	// frame times can be compared across builds.
+	class InputRecorder
+	{
+	  public:
+		// Ticks must run at tickRate for a replay to match.
+		static bool StartRecording(const std::string& path,
+		                           double tickRate);
+		static bool StartReplay(const std::string& path,
+		                        double tickRate);
+		static void Stop();
+
+		inline static bool IsRecording()
+		{
+			return recording;
+		}
+		inline static bool IsReplaying() { return replaying; }
+
+		// Once per tick, after the devices have been
+		// updated.
+		static void RecordTick();
+		// Once per tick, instead of updating the devices.
+		// Returns false once the recording has run out.
+		static bool ReplayTick();
+
+	  private:
+		static bool recording;
+		static bool replaying;
+	};
+} // namespace AthiVegam::Input
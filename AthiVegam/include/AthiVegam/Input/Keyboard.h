@@ -1,6 +1,8 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
+#include <span>
 
 namespace AthiVegam::Input
 {
@@ -254,23 +256,68 @@ namespace AthiVegam::Input
 
 	constexpr static const int KeyCount =
 	    287; // SDL supports 286 indices for scancodes.
-	using KeyStates = std::array<bool, KeyCount>;
+
+	// One bit per key, in 64-bit words, so whole-keyboard
+	// comparisons take a handful of word operations and a
+	// snapshot for replay or rollback is 40 bytes.
+	struct KeyStates
+	{
+		static constexpr int WordCount =
+		    (KeyCount + 63) / 64;
+
+		std::array<uint64_t, WordCount> words{};
+
+		inline bool Test(int key) const
+		{
+			return (words[key >> 6] >> (key & 63)) & 1;
+		}
+		inline bool Any() const
+		{
+			uint64_t any = 0;
+			for (auto word : words)
+			{
+				any |= word;
+			}
+			return any != 0;
+		}
+		bool operator==(const KeyStates&) const = default;
+	};
 
 	class Keyboard
 	{
 	  public:
 		static void Initialize();
 		static void Update();
+		// Takes keys from a recording instead of SDL, as
+		// Update() would.
+		static void Apply(const KeyStates& current);
 
 		static bool Key(KeyCode key);
 		static bool KeyDown(KeyCode key);
 		static bool KeyUp(KeyCode key);
 
-	  private:
-		static int x, xPrev;
-		static int y, yPrev;
+		// Whether any key went down or up in the last
+		// Update(), and which did.
+		inline static bool AnyKeyChanged()
+		{
+			return changedKeyCount > 0;
+		}
+		inline static std::span<const KeyCode> ChangedKeys()
+		{
+			return {changedKeys.data(), changedKeyCount};
+		}
+
+		inline static const KeyStates& GetKeyStates()
+		{
+			return keyStates;
+		}
 
+	  private:
 		static KeyStates keyStates;
-		static KeyStates prevKeyStates;
+		static KeyStates pressedKeys;
+		static KeyStates releasedKeys;
+
+		static std::array<KeyCode, KeyCount> changedKeys;
+		static size_t changedKeyCount;
 	};
 } // namespace AthiVegam::Input
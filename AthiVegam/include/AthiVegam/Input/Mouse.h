@@ -1,6 +1,10 @@
 #pragma once
 
+#include "AthiVegam/Core/Events.h"
+
 #include <array>
+#include <cstdint>
+#include <span>
 
 namespace AthiVegam::Input
 {
@@ -20,11 +24,51 @@ namespace AthiVegam::Input
 	using MouseButtonStates =
 	    std::array<bool, MouseButtonCount>;
 
+	// Relative motion and wheel scrolling since the
+	// previous Update(), summed over every SDL event in
+	// between.
+	struct MouseMotion
+	{
+		float dx = 0.0f;
+		float dy = 0.0f;
+		float wheelX = 0.0f;
+		float wheelY = 0.0f;
+
+		bool operator==(const MouseMotion&) const = default;
+	};
+
 	class Mouse
 	{
 	  public:
 		static void Initialize();
 		static void Update();
+		// Takes the position, buttons (bit i for button
+		// i + 1) and motion from a recording instead of SDL.
+		static void Apply(int newX, int newY,
+		                  uint32_t buttonMask,
+		                  const MouseMotion& newMotion);
+		static uint32_t GetButtonMask();
+
+		// Subscribed to the engine's event bus.
+		static void
+		OnMouseMotion(std::span<const Core::MouseMoved> events);
+		static void
+		OnMouseWheel(std::span<const Core::MouseWheel> events);
+
+		// Hides the cursor and reports motion without
+		// stopping at the window edges; X() and Y() stay put,
+		// GetMotion() keeps counting.
+		static bool SetRelativeMode(bool enabled);
+		static bool IsRelativeMode();
+		inline static const MouseMotion& GetMotion()
+		{
+			return motion;
+		}
+		// Main thread. Pumps SDL and returns the motion that
+		// arrived since the last Update(), without consuming
+		// it; for late-latched constants (see
+		// RenderManager::SetLateLatchCallback()).
+		static MouseMotion PeekLateMotion();
 
 		inline static int X() { return x; }
 		inline static int Y() { return y; }
@@ -41,5 +85,9 @@ namespace AthiVegam::Input
 
 		static MouseButtonStates buttonStates;
 		static MouseButtonStates prevButtonStates;
+
+		static MouseMotion motion;
+		// Accumulated from events until the next Update().
+		static MouseMotion pendingMotion;
 	};
 } // namespace AthiVegam::Input
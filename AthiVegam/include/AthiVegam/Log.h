@@ -1,6 +1,11 @@
 #pragma once
 
+#include "AthiVegam/Core/BinaryLog.h"
 #include "AthiVegam/Managers/LogManager.h"
+
+#include <atomic>
+#include <cstdint>
+
 #if defined(AV_PLATFORM_WINDOWS)
 #define VEGAM_BREAK __debugbreak();
 #elif defined(AV_PLATFORM_MAC)
@@ -9,49 +14,140 @@
 #define VEGAM_BREAK __builtin_trap();
 #endif
 
-#ifndef AV_CONFIG_RELEASE
-#define VEGAM_TRACE(...)                                   \
-	if (::AthiVegam::Managers::LogManager::Logger()        \
-	    != nullptr)                                        \
-	{                                                      \
-		::AthiVegam::Managers::LogManager::Logger()        \
-		    ->trace(__VA_ARGS__);                          \
-	}
-#define VEGAM_DEBUG(...)                                   \
-	if (::AthiVegam::Managers::LogManager::Logger()        \
-	    != nullptr)                                        \
-	{                                                      \
-		::AthiVegam::Managers::LogManager::Logger()        \
-		    ->debug(__VA_ARGS__);                          \
-	}
-#define VEGAM_INFO(...)                                    \
-	if (::AthiVegam::Managers::LogManager::Logger()        \
-	    != nullptr)                                        \
-	{                                                      \
-		::AthiVegam::Managers::LogManager::Logger()->info( \
-		    __VA_ARGS__);                                  \
-	}
-#define VEGAM_WARN(...)                                    \
-	if (::AthiVegam::Managers::LogManager::Logger()        \
-	    != nullptr)                                        \
+// Messages below VEGAM_LOG_LEVEL are compiled out, along
+// with their arguments. Define it on the command line to
+// override the per-configuration default.
+#define VEGAM_LOG_LEVEL_TRACE 0
+#define VEGAM_LOG_LEVEL_DEBUG 1
+#define VEGAM_LOG_LEVEL_INFO 2
+#define VEGAM_LOG_LEVEL_WARN 3
+#define VEGAM_LOG_LEVEL_ERROR 4
+#define VEGAM_LOG_LEVEL_FATAL 5
+#define VEGAM_LOG_LEVEL_OFF 6
+
+#ifndef VEGAM_LOG_LEVEL
+#if defined(AV_CONFIG_RELEASE)
+#define VEGAM_LOG_LEVEL VEGAM_LOG_LEVEL_OFF
+#elif defined(AV_CONFIG_PROFILE)
+#define VEGAM_LOG_LEVEL VEGAM_LOG_LEVEL_INFO
+#else
+#define VEGAM_LOG_LEVEL VEGAM_LOG_LEVEL_TRACE
+#endif
+#endif // VEGAM_LOG_LEVEL
+
+#define VEGAM_LOG_WITH(getLogger, method, ...)             \
+	do                                                     \
 	{                                                      \
-		::AthiVegam::Managers::LogManager::Logger()->warn( \
-		    __VA_ARGS__);                                  \
-	}
-#define VEGAM_ERROR(...)                                   \
-	if (::AthiVegam::Managers::LogManager::Logger()        \
-	    != nullptr)                                        \
+		if (auto* vegamLogger_ = ::AthiVegam::Managers::   \
+		        LogManager::getLogger())                   \
+		{                                                  \
+			vegamLogger_->method(__VA_ARGS__);             \
+		}                                                  \
+	} while (0)
+#define VEGAM_LOG(method, ...)                             \
+	VEGAM_LOG_WITH(GetLogger, method, __VA_ARGS__)
+
+// Verbose levels go to Core::BinaryLog while it records.
+// The first argument must be the format string literal.
+#define VEGAM_LOG_DEFERRED(method, ...)                    \
+	do                                                     \
 	{                                                      \
-		::AthiVegam::Managers::LogManager::Logger()        \
-		    ->error(__VA_ARGS__);                          \
-	}
+		if (::AthiVegam::Core::BinaryLog::IsRecording())   \
+		{                                                  \
+			static ::AthiVegam::Core::BinaryLog::Site      \
+			    vegamSite_{__FILE__, __LINE__,             \
+			               ::spdlog::level::method};       \
+			::AthiVegam::Core::BinaryLog::Write(           \
+			    vegamSite_, __VA_ARGS__);                  \
+		}                                                  \
+		else                                               \
+		{                                                  \
+			VEGAM_LOG(method, __VA_ARGS__);                \
+		}                                                  \
+	} while (0)
+
+#if VEGAM_LOG_LEVEL <= VEGAM_LOG_LEVEL_TRACE
+#define VEGAM_TRACE(...) VEGAM_LOG_DEFERRED(trace, __VA_ARGS__)
+#else
+#define VEGAM_TRACE(...) (void)0
+#endif
+#if VEGAM_LOG_LEVEL <= VEGAM_LOG_LEVEL_DEBUG
+#define VEGAM_DEBUG(...) VEGAM_LOG_DEFERRED(debug, __VA_ARGS__)
+#else
+#define VEGAM_DEBUG(...) (void)0
+#endif
+#if VEGAM_LOG_LEVEL <= VEGAM_LOG_LEVEL_INFO
+#define VEGAM_INFO(...) VEGAM_LOG(info, __VA_ARGS__)
+#else
+#define VEGAM_INFO(...) (void)0
+#endif
+#if VEGAM_LOG_LEVEL <= VEGAM_LOG_LEVEL_WARN
+#define VEGAM_WARN(...) VEGAM_LOG(warn, __VA_ARGS__)
+#else
+#define VEGAM_WARN(...) (void)0
+#endif
+#if VEGAM_LOG_LEVEL <= VEGAM_LOG_LEVEL_ERROR
+#define VEGAM_ERROR(...) VEGAM_LOG(error, __VA_ARGS__)
+#else
+#define VEGAM_ERROR(...) (void)0
+#endif
+// Written synchronously even with async logging, so the
+// message is out before an assert breaks.
+#if VEGAM_LOG_LEVEL <= VEGAM_LOG_LEVEL_FATAL
 #define VEGAM_FATAL(...)                                   \
-	if (::AthiVegam::Managers::LogManager::Logger()        \
-	    != nullptr)                                        \
+	VEGAM_LOG_WITH(GetFatalLogger, critical, __VA_ARGS__)
+#else
+#define VEGAM_FATAL(...) (void)0
+#endif
+
+// Rate-limited logging, counted per call site: for hot
+// paths that could otherwise log every frame. The check
+// is a relaxed atomic load or increment.
+#define VEGAM_LOG_ONCE(log, ...)                           \
+	do                                                     \
 	{                                                      \
-		::AthiVegam::Managers::LogManager::Logger()        \
-		    ->critical(__VA_ARGS__);                       \
-	}
+		static std::atomic<bool> vegamLogged_{false};      \
+		if (!vegamLogged_.load(std::memory_order_relaxed)  \
+		    && !vegamLogged_.exchange(                     \
+		        true, std::memory_order_relaxed))          \
+		{                                                  \
+			log(__VA_ARGS__);                              \
+		}                                                  \
+	} while (0)
+// Logs the 1st, (n+1)th, (2n+1)th... time it is reached.
+#define VEGAM_LOG_EVERY_N(n, log, ...)                     \
+	do                                                     \
+	{                                                      \
+		static std::atomic<uint32_t> vegamCount_{0};       \
+		if (vegamCount_.fetch_add(                         \
+		        1, std::memory_order_relaxed)              \
+		        % (n)                                      \
+		    == 0)                                          \
+		{                                                  \
+			log(__VA_ARGS__);                              \
+		}                                                  \
+	} while (0)
+
+#if VEGAM_LOG_LEVEL <= VEGAM_LOG_LEVEL_WARN
+#define VEGAM_WARN_ONCE(...)                               \
+	VEGAM_LOG_ONCE(VEGAM_WARN, __VA_ARGS__)
+#define VEGAM_WARN_EVERY_N(n, ...)                         \
+	VEGAM_LOG_EVERY_N(n, VEGAM_WARN, __VA_ARGS__)
+#else
+#define VEGAM_WARN_ONCE(...) (void)0
+#define VEGAM_WARN_EVERY_N(n, ...) (void)0
+#endif
+#if VEGAM_LOG_LEVEL <= VEGAM_LOG_LEVEL_ERROR
+#define VEGAM_ERROR_ONCE(...)                              \
+	VEGAM_LOG_ONCE(VEGAM_ERROR, __VA_ARGS__)
+#define VEGAM_ERROR_EVERY_N(n, ...)                        \
+	VEGAM_LOG_EVERY_N(n, VEGAM_ERROR, __VA_ARGS__)
+#else
+#define VEGAM_ERROR_ONCE(...) (void)0
+#define VEGAM_ERROR_EVERY_N(n, ...) (void)0
+#endif
+
+#ifndef AV_CONFIG_RELEASE
 #define VEGAM_ASSERT(x, msg)                               \
 	if ((x))                                               \
 	{                                                      \
@@ -61,15 +157,11 @@
 		VEGAM_FATAL("ASSERT - {}\n\t{}\n\tin file: "       \
 		            "{}\n\ton line: {}",                   \
 		            #x, msg, __FILE__, __LINE__);          \
+		::AthiVegam::Managers::LogManager::                \
+		    WriteCrashLog();                               \
 		VEGAM_BREAK                                        \
 	}
 #else
-#define VEGAM_TRACE(...) (void)0
-#define VEGAM_DEBUG(...) (void)0
-#define VEGAM_INFO(...) (void)0
-#define VEGAM_WARN(...) (void)0
-#define VEGAM_ERROR(...) (void)0
-#define VEGAM_FATAL(...) (void)0
 #define VEGAM_ASSERT(x, msg)                               \
 	if ((x))                                               \
 	{                                                      \
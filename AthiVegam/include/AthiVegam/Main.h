@@ -2,13 +2,37 @@
 
 #include "AthiVegam/App.h"
 #include "AthiVegam/Engine.h"
+#include "AthiVegam/GameModule.h"
 
+#if !defined(AV_GAME_MODULE)
 /* Client Application will implement this method*/
 std::unique_ptr<AthiVegam::App> CreateApp();
+#endif // !AV_GAME_MODULE
 
-int main()
+#if defined(AV_GAME_MODULE_LIBRARY)
+// The game built as a module; the engine's executable
+// loads it (see GameModule).
+VEGAM_MODULE_EXPORT AthiVegam::App* AthiVegamCreateApp()
 {
+	return CreateApp().release();
+}
+
+VEGAM_MODULE_EXPORT void AthiVegamDestroyApp(AthiVegam::App* app)
+{
+	delete app;
+}
+#else
+int main(int argc, char** argv)
+{
+	AthiVegam::Engine::Instance().SetCommandLine(argc, argv);
+#if defined(AV_GAME_MODULE)
+	// The module's name or path, defined by the host.
+	AthiVegam::Engine::Instance().Run(
+	    std::make_unique<AthiVegam::GameModule>(AV_GAME_MODULE));
+#else
 	AthiVegam::Engine::Instance().Run(CreateApp());
+#endif // AV_GAME_MODULE
 
 	return 0;
 }
+#endif // AV_GAME_MODULE_LIBRARY
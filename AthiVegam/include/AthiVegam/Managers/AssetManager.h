@@ -0,0 +1,251 @@
+#pragma once
+
+#include "AthiVegam/Assets/Archive.h"
+#include "AthiVegam/Assets/AssetId.h"
+#include "AthiVegam/Assets/Ktx2.h"
+#include "AthiVegam/Assets/MeshPack.h"
+#include "AthiVegam/Core/FileWatcher.h"
+#include "AthiVegam/Core/Task.h"
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Managers/JobManager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace AthiVegam::Managers
+{
+	class ResourceManager;
+
+	// Streams cooked assets from mounted packs and archives
+	// without ever blocking a frame. A request returns a
+	// placeholder right away; dedicated I/O threads read the
+	// queued requests highest priority first, archived
+	// assets are decompressed chunk by chunk on the job
+	// workers, and the data goes to the ResourceManager's
+	// upload queue, which makes the asset drawable a few
+	// frames later. Requests that are released before their
+	// read starts cost nothing.
+	class AssetManager
+	{
+	  public:
+		enum class State : uint8_t
+		{
+			// Waiting for an I/O thread.
+			Queued,
+			Reading,
+			// Archived assets, on the job workers.
+			Decompressing,
+			// Read; drawable once IsMeshReady() or
+			// IsTextureReady().
+			Uploading,
+			Failed
+		};
+
+		AssetManager() = default;
+		~AssetManager() = default;
+
+		AssetManager(const AssetManager&) = delete;
+		AssetManager& operator=(const AssetManager&) = delete;
+
+		void Initialize(ResourceManager& resources,
+		                JobManager& jobs,
+		                uint32_t ioThreadCount);
+		// Pending reads are dropped; meshes already handed
+		// out stay with the ResourceManager.
+		void Shutdown();
+
+		// Packs and archives stay open until shutdown. For
+		// ids in several the last one mounted wins.
+		bool MountMeshPack(const std::string& path);
+		bool MountArchive(const std::string& path);
+
+		// Main thread, once per frame: schedules the
+		// decompression of archived assets read since.
+		void Update();
+
+		// Editing: requested meshes and textures are
+		// re-cooked from their sources below sourceRoot (see
+		// tools/cook.py) when those change, on a background
+		// thread, and swapped in behind the same handles
+		// once uploaded; the scene draws the old asset until
+		// then. Materials sample textures through their
+		// handles, so they pick the new ones up too.
+		struct HotReloadSettings
+		{
+			std::string sourceRoot;
+			// Run as: <cookCommand> --one <source> <output>.
+			std::string cookCommand = "python3 tools/cook.py";
+			uint32_t intervalMs = 500;
+		};
+		// Main thread.
+		void EnableHotReload(const HotReloadSettings& settings);
+
+		// Main thread. Returns a mesh that draws nothing
+		// until it has streamed in, or an invalid handle for
+		// ids in no pack. Requesting an id again returns the
+		// same mesh, adds a reference and takes the new
+		// priority.
+		Graphics::MeshHandle RequestMesh(Assets::AssetId id,
+		                                 float priority);
+		// Main thread. Like RequestMesh(), for a texture in
+		// a mounted archive; levels finestLevel and up are
+		// read, smallest first.
+		Graphics::TextureHandle
+		RequestTexture(Assets::AssetId id, float priority,
+		               uint32_t finestLevel = 0);
+		// Main thread. Request, then wait in a coroutine
+		// until drawable; an invalid handle if the load
+		// failed. Release() the id when done, as after a
+		// request.
+		Core::Task<Graphics::MeshHandle>
+		LoadMesh(Assets::AssetId id, float priority);
+		Core::Task<Graphics::TextureHandle>
+		LoadTexture(Assets::AssetId id, float priority,
+		            uint32_t finestLevel = 0);
+		// Streams finer levels of a requested texture in,
+		// e.g. as it gets closer to the camera. Levels
+		// already read stay resident.
+		void SetTextureLevel(Assets::AssetId id,
+		                     uint32_t finestLevel);
+		// Reorders a request still waiting for its read.
+		void SetPriority(Assets::AssetId id, float priority);
+		// Drops a reference. The last one cancels the load
+		// if its read has not finished and destroys the
+		// mesh or texture.
+		void Release(Assets::AssetId id);
+
+		State GetState(Assets::AssetId id) const;
+		// Requests not yet read.
+		size_t GetPendingCount() const;
+
+		// Higher loads sooner: every visible asset before
+		// any invisible one, nearer before farther.
+		static inline float
+		StreamingPriority(float distance, bool visible)
+		{
+			return 1.0f / (1.0f + std::max(distance, 0.0f))
+			       + (visible ? 1.0f : 0.0f);
+		}
+
+		// Chunks handed to the job workers per Update(), well
+		// below JobManager::MaxJobsPerThread.
+		static constexpr uint32_t MaxChunksPerUpdate = 1024;
+
+	  private:
+		struct Source
+		{
+			std::unique_ptr<Assets::MeshPack> pack;
+			std::unique_ptr<Assets::Archive> archive;
+		};
+
+		struct Entry
+		{
+			Assets::AssetId id;
+			Assets::ArchiveFormat::EntryType type;
+			// Either a mapped pack or an archive entry.
+			const Assets::MeshPack* pack = nullptr;
+			const Assets::Archive* archive = nullptr;
+			const Assets::Archive::Entry* archiveEntry =
+			    nullptr;
+			Graphics::MeshHandle mesh;
+			Graphics::TextureHandle texture;
+			uint32_t references = 0;
+			float priority = 0.0f;
+			// Bumped on every priority change, so older
+			// queue items for the entry are skipped.
+			uint32_t generation = 0;
+			std::atomic<State> state{State::Queued};
+			std::atomic<bool> cancelled{false};
+
+			// Archived entries, as read and decompressed:
+			// chunkCount chunks from firstChunk on.
+			uint32_t firstChunk = 0;
+			uint32_t chunkCount = 0;
+			std::vector<uint8_t> stored;
+			std::vector<uint8_t> data;
+			std::atomic<uint32_t> chunksLeft{0};
+			std::atomic<bool> corrupt{false};
+
+			// Textures: the header once read, the finest
+			// level asked for, read, and being read.
+			Assets::Ktx2::Info info;
+			bool hasInfo = false;
+			uint32_t wantedLevel = 0;
+			uint32_t loadedLevel = 0;
+			uint32_t readingLevel = 0;
+		};
+
+		struct QueueItem
+		{
+			float priority;
+			uint32_t generation;
+			std::shared_ptr<Entry> entry;
+
+			inline bool operator<(const QueueItem& other) const
+			{
+				return priority < other.priority;
+			}
+		};
+
+		bool Locate(Entry& entry,
+		            Assets::ArchiveFormat::EntryType type) const;
+		void Enqueue(const std::shared_ptr<Entry>& entry,
+		             float priority);
+		void WantLevel(const std::shared_ptr<Entry>& entry,
+		               uint32_t level);
+		void IoMain(uint32_t thread);
+		void ReadMapped(Entry& entry);
+		void ReadArchived(const std::shared_ptr<Entry>& entry);
+		void ReadTexture(const std::shared_ptr<Entry>& entry);
+		void DecompressChunk(const std::shared_ptr<Entry>& entry,
+		                     uint32_t chunk);
+		void
+		FinishDecompression(const std::shared_ptr<Entry>& entry);
+		void FinishTexture(const std::shared_ptr<Entry>& entry);
+		void QueueUpload(Entry& entry,
+		                 const Assets::MeshPack::MeshView& view);
+		void WatchSource(const Entry& entry);
+		void UnwatchSource(const Entry& entry);
+		void CookMain();
+		void Reload(uint64_t id, const std::string& source);
+
+	  private:
+		ResourceManager* m_resources = nullptr;
+		JobManager* m_jobs = nullptr;
+		std::vector<Source> m_sources;
+
+		// Guards the entries and the queue.
+		mutable std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::unordered_map<uint64_t, std::shared_ptr<Entry>>
+		    m_entries;
+		std::priority_queue<QueueItem> m_queue;
+		size_t m_queued = 0;
+		// Read, waiting for Update() to schedule them.
+		std::vector<std::shared_ptr<Entry>> m_decompressions;
+		JobCounter m_decompressionJobs;
+		bool m_stopRequested = false;
+		std::vector<std::thread> m_ioThreads;
+
+		// Hot reload; guarded by m_mutex. Sources by the id
+		// of the asset they cook into, and the requested
+		// assets that depend on each watched source.
+		HotReloadSettings m_hotReload;
+		std::unordered_map<uint64_t, std::string> m_sourcePaths;
+		std::unordered_map<std::string, std::vector<uint64_t>>
+		    m_dependents;
+		Core::FileWatcher m_sourceWatcher;
+		std::condition_variable m_cookWake;
+		bool m_sourcesChanged = false;
+		std::thread m_cookThread;
+	};
+} // namespace AthiVegam::Managers
@@ -0,0 +1,332 @@
+#pragma once
+
+#include "AthiVegam/Assets/Wav.h"
+#include "AthiVegam/Core/FlatHashMap.h"
+#include "AthiVegam/Core/SpscQueue.h"
+#include "AthiVegam/Managers/JobManager.h"
+#include "AthiVegam/Math/Vector.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace AthiVegam::Managers
+{
+	// How an AudioManager voice plays.
+	struct VoiceParams
+	{
+		float gain = 1.0f;
+		// -1 left to 1 right, equal power.
+		float pan = 0.0f;
+		// Playback rate; also shifts the pitch.
+		float pitch = 1.0f;
+		bool loop = false;
+	};
+
+	// A sound placed in the world; see
+	// AudioManager::CreateEmitter().
+	struct EmitterDesc
+	{
+		Math::Vec3 position;
+		float gain = 1.0f;
+		float pitch = 1.0f;
+		// Full volume within minDistance, falling off as
+		// the inverse distance beyond it, scaled by rolloff,
+		// and fading out over the last tenth before
+		// maxDistance.
+		float minDistance = 1.0f;
+		float maxDistance = 50.0f;
+		float rolloff = 1.0f;
+		// Scales the audibility emitters are ranked by, e.g.
+		// above 1 for dialogue.
+		float priority = 1.0f;
+		// Otherwise the emitter is destroyed once its sound
+		// has played out.
+		bool loop = true;
+	};
+
+	// Plays sounds and streamed music through one SDL audio
+	// device. The device's callback mixes on SDL's audio
+	// thread and never allocates, locks or logs: the main
+	// thread sends it commands through a lock-free queue,
+	// and it reports finished voices back through another.
+	// Voices are resampled to the device rate and mixed
+	// two stereo frames per SIMD register. Streamed music
+	// is decoded ahead into a ring by jobs that Update()
+	// schedules on the job workers.
+	//
+	// Emitters place sounds in the world. Any number may
+	// exist, but only the maxRealEmitters most audible to
+	// the listener get a voice; the rest are virtual, with
+	// their playback time kept, and take a voice again
+	// where they would be by then once they rank high
+	// enough. Mixing cost stays bounded however busy the
+	// scene.
+	//
+	// Main thread only.
+	class AudioManager
+	{
+	  public:
+		using SoundHandle = uint32_t;
+		using VoiceId = uint32_t;
+		using EmitterId = uint32_t;
+		static constexpr SoundHandle InvalidSound = 0;
+		static constexpr VoiceId InvalidVoice = 0;
+		static constexpr EmitterId InvalidEmitter = 0;
+
+		static constexpr uint32_t MaxVoices = 64;
+		static constexpr uint32_t CommandCapacity = 256;
+		// Decoded stereo frames held ahead per stream,
+		// about 1.4 s at 48 kHz; refilled once half is
+		// played.
+		static constexpr uint32_t StreamFrames = 1 << 16;
+
+		AudioManager() = default;
+		~AudioManager() = default;
+
+		AudioManager(const AudioManager&) = delete;
+		AudioManager& operator=(const AudioManager&) = delete;
+
+		// SDL's audio subsystem must be up. Returns false
+		// if no device could be opened; the manager then
+		// accepts calls and plays nothing.
+		bool Initialize(JobManager& jobs, uint32_t sampleRate,
+		                uint32_t bufferFrames);
+		void Shutdown();
+		inline bool IsInitialized() const
+		{
+			return m_device != 0;
+		}
+
+		// Once per frame: refills streams and frees what
+		// the audio thread is done with.
+		void Update();
+
+		// Decoded whole; for short effects.
+		SoundHandle LoadSound(const std::string& path);
+		// Stops the sound's voices first.
+		void UnloadSound(SoundHandle sound);
+
+		VoiceId Play(SoundHandle sound,
+		             const VoiceParams& params = {});
+		// Decodes the file as it plays; for music and
+		// ambience.
+		VoiceId PlayStream(const std::string& path,
+		                   const VoiceParams& params = {});
+		void Stop(VoiceId voice);
+		void SetGain(VoiceId voice, float gain);
+		void SetPan(VoiceId voice, float pan);
+		void SetPitch(VoiceId voice, float pitch);
+		void SetMasterGain(float gain);
+		// Until the audio thread reports it finished.
+		bool IsPlaying(VoiceId voice) const;
+
+		// Emitters pan to the listener's right vector, the
+		// cross product of forward and up.
+		void SetListener(const Math::Vec3& position,
+		                 const Math::Vec3& forward,
+		                 const Math::Vec3& up);
+		// Starts playing at once, really or virtually.
+		EmitterId CreateEmitter(SoundHandle sound,
+		                        const EmitterDesc& desc = {});
+		void DestroyEmitter(EmitterId emitter);
+		void SetEmitterPosition(EmitterId emitter,
+		                        const Math::Vec3& position);
+		void SetEmitterGain(EmitterId emitter, float gain);
+		// Has a voice, as of the last Update().
+		bool IsEmitterReal(EmitterId emitter) const;
+		// At most MaxVoices, shared with Play() and
+		// PlayStream().
+		void SetMaxRealEmitters(uint32_t count);
+		inline uint32_t GetEmitterCount() const
+		{
+			return static_cast<uint32_t>(m_emitters.size());
+		}
+		inline uint32_t GetRealEmitterCount() const
+		{
+			return m_realEmitters;
+		}
+
+		inline uint32_t GetSampleRate() const
+		{
+			return m_sampleRate;
+		}
+		inline uint32_t GetActiveVoiceCount() const
+		{
+			return m_activeVoices.load(
+			    std::memory_order_relaxed);
+		}
+		// Callbacks in which a stream ran dry.
+		inline uint32_t GetUnderrunCount() const
+		{
+			return m_underruns.load(std::memory_order_relaxed);
+		}
+		// Plays beyond MaxVoices, which were not heard.
+		inline uint32_t GetDroppedVoiceCount() const
+		{
+			return m_droppedVoices.load(
+			    std::memory_order_relaxed);
+		}
+		// The last callback's mixing time over the time its
+		// buffer plays for.
+		inline float GetMixLoad() const
+		{
+			return m_mixLoad.load(std::memory_order_relaxed);
+		}
+
+	  private:
+		// Stereo float frames at sampleRate.
+		struct Sound
+		{
+			std::vector<float> frames;
+			uint64_t frameCount = 0;
+			uint32_t sampleRate = 0;
+		};
+
+		// Filled by one decode job at a time, played by the
+		// audio thread.
+		struct Stream
+		{
+			Assets::WavReader reader;
+			std::unique_ptr<float[]> ring;
+			std::atomic<uint64_t> written{0};
+			std::atomic<uint64_t> read{0};
+			std::atomic<bool> decoding{false};
+			// Every frame has been decoded.
+			std::atomic<bool> ended{false};
+			bool loop = false;
+			VoiceId voice = InvalidVoice;
+			// The audio thread let go of it; main thread.
+			bool released = false;
+		};
+
+		enum class CommandType : uint8_t
+		{
+			Play,
+			Stop,
+			StopSound,
+			SetGain,
+			SetPan,
+			SetPitch,
+			// Both of params.gain and params.pan.
+			SetGainPan,
+			SetMasterGain
+		};
+
+		struct Command
+		{
+			CommandType type = CommandType::Stop;
+			VoiceId voice = InvalidVoice;
+			const Sound* sound = nullptr;
+			Stream* stream = nullptr;
+			uint32_t sampleRate = 0;
+			float value = 0.0f;
+			// Play: the source frame to start at.
+			double position = 0.0;
+			VoiceParams params;
+		};
+
+		// Audio thread only.
+		struct Voice
+		{
+			VoiceId id = InvalidVoice;
+			const Sound* sound = nullptr;
+			Stream* stream = nullptr;
+			// In source frames; for streams, past the
+			// stream's read position.
+			double position = 0.0;
+			double step = 1.0;
+			uint32_t sourceRate = 0;
+			VoiceParams params;
+			// Per-channel gains, ramped to the target over
+			// a callback to avoid clicks.
+			float gains[2] = {};
+			// Waiting to report it finished.
+			bool finished = false;
+		};
+
+		struct Emitter
+		{
+			EmitterId id = InvalidEmitter;
+			const Sound* sound = nullptr;
+			EmitterDesc desc;
+			// Seconds since m_epoch it started at.
+			double start = 0.0;
+			VoiceId voice = InvalidVoice;
+			float audibility = 0.0f;
+			// As last sent to the voice.
+			float gain = 0.0f;
+			float pan = 0.0f;
+		};
+
+		struct Retired
+		{
+			std::unique_ptr<Sound> sound;
+			// Freed once the audio thread is past the
+			// command stopping its voices.
+			uint64_t command = 0;
+			bool sent = false;
+		};
+
+		static void AudioCallback(void* userdata,
+		                          uint8_t* stream, int length);
+		void Mix(float* out, uint32_t frames);
+		void Execute(const Command& command);
+		void MixVoice(Voice& voice, float* out,
+		              uint32_t frames);
+		Voice* FindVoice(VoiceId id);
+		bool Send(const Command& command);
+		VoiceId NextVoice();
+		void ScheduleDecode(Stream& stream);
+		void UpdateEmitters();
+		void RemoveEmitter(uint32_t index);
+		Emitter* FindEmitter(EmitterId id);
+		const Sound* GetSound(SoundHandle sound) const;
+		static void Decode(Stream& stream);
+
+	  private:
+		JobManager* m_jobs = nullptr;
+		uint32_t m_device = 0;
+		uint32_t m_sampleRate = 0;
+
+		Core::SpscQueue<Command, CommandCapacity> m_commands;
+		Core::SpscQueue<VoiceId, CommandCapacity> m_finished;
+		uint64_t m_commandsSent = 0;
+		std::atomic<uint64_t> m_commandsDone{0};
+
+		// Main thread.
+		std::vector<std::unique_ptr<Sound>> m_sounds;
+		std::vector<std::unique_ptr<Stream>> m_streams;
+		std::vector<Retired> m_retired;
+		std::unordered_set<VoiceId> m_playing;
+		VoiceId m_nextVoice = InvalidVoice;
+		JobCounter m_decodeJobs;
+
+		Math::Vec3 m_listener;
+		Math::Vec3 m_listenerRight{1.0f, 0.0f, 0.0f};
+		std::vector<Emitter> m_emitters;
+		Core::FlatHashMap<EmitterId, uint32_t> m_emitterIndices;
+		Core::FlatHashMap<VoiceId, EmitterId> m_emitterVoices;
+		// Emitter indices, most audible first.
+		std::vector<uint32_t> m_ranking;
+		EmitterId m_nextEmitter = InvalidEmitter;
+		uint32_t m_maxRealEmitters = 32;
+		uint32_t m_realEmitters = 0;
+		std::chrono::steady_clock::time_point m_epoch =
+		    std::chrono::steady_clock::now();
+
+		// Audio thread.
+		std::array<Voice, MaxVoices> m_voices;
+		float m_masterGain = 1.0f;
+
+		std::atomic<uint32_t> m_activeVoices{0};
+		std::atomic<uint32_t> m_underruns{0};
+		std::atomic<uint32_t> m_droppedVoices{0};
+		std::atomic<float> m_mixLoad{0.0f};
+	};
+} // namespace AthiVegam::Managers
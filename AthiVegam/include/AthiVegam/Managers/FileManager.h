@@ -0,0 +1,187 @@
+#pragma once
+
+#include "AthiVegam/Assets/Archive.h"
+#include "AthiVegam/Assets/AssetId.h"
+#include "AthiVegam/Core/MappedFile.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace AthiVegam::Managers
+{
+	// Read-only contents of a file, mapped when it is a
+	// loose file and decompressed into memory when it is
+	// archived.
+	class FileData
+	{
+	  public:
+		FileData() = default;
+
+		inline std::span<const uint8_t> GetBytes() const
+		{
+			if (m_mapped.IsOpen())
+			{
+				return {m_mapped.GetData(), m_mapped.GetSize()};
+			}
+			return m_owned;
+		}
+		inline std::string_view GetText() const
+		{
+			const auto bytes = GetBytes();
+			return {reinterpret_cast<const char*>(bytes.data()),
+			        bytes.size()};
+		}
+		inline bool IsMapped() const
+		{
+			return m_mapped.IsOpen();
+		}
+
+	  private:
+		friend class FileManager;
+		Core::MappedFile m_mapped;
+		std::vector<uint8_t> m_owned;
+	};
+
+	// The virtual file system every engine read goes
+	// through. Paths use '/' and are looked up in the
+	// mounts from the last mounted on: a directory mounted
+	// at "shaders" serves "shaders/basic.vert" from
+	// <directory>/basic.vert, and an archive (see
+	// tools/pack.py) serves it from the entry whose
+	// Assets::AssetId is HashPath("basic.vert"). Loose
+	// directories suit development, where files are
+	// edited and hot reloaded; archives suit shipping.
+	// Below every mount the working directory is mounted
+	// at the root, so paths in no mount read as they are.
+	//
+	// Reads are synchronous, or queued to I/O threads and
+	// completed into a buffer the caller provides, with a
+	// callback on the main thread. Mounting is main thread
+	// only; everything else is thread safe.
+	class FileManager
+	{
+	  public:
+		// Bytes read; false if the file is missing, the
+		// range is past its end or the read failed.
+		using ReadCallback =
+		    std::function<void(bool ok, size_t bytes)>;
+
+		FileManager() = default;
+		~FileManager() = default;
+
+		FileManager(const FileManager&) = delete;
+		FileManager& operator=(const FileManager&) = delete;
+
+		void Initialize(uint32_t ioThreadCount);
+		// Pending reads are dropped uncompleted.
+		void Shutdown();
+
+		// A mount point of "" is the root.
+		bool MountDirectory(std::string_view point,
+		                    const std::string& directory);
+		bool MountArchive(std::string_view point,
+		                  const std::string& path);
+
+		// Main thread, once per frame: runs the callbacks
+		// of finished reads.
+		void Update();
+
+		bool Exists(std::string_view path) const;
+		// 0 for missing files.
+		uint64_t GetSize(std::string_view path) const;
+
+		// The whole file.
+		bool Read(std::string_view path,
+		          std::vector<uint8_t>& out) const;
+		bool ReadText(std::string_view path,
+		              std::string& out) const;
+		// buffer.size() bytes from offset on.
+		bool ReadAt(std::string_view path, uint64_t offset,
+		            std::span<uint8_t> buffer) const;
+		// Like ReadAt() on an I/O thread. The buffer must
+		// stay valid until done runs; buffer.size() past
+		// the end of the file reads what is there.
+		void ReadAsync(std::string_view path, uint64_t offset,
+		               std::span<uint8_t> buffer,
+		               ReadCallback done);
+		// Maps loose files, reads archived ones.
+		bool Load(std::string_view path, FileData& out) const;
+
+		// Where a loose file lives on disk, e.g. to watch
+		// it; empty for archived files.
+		std::string GetNativePath(std::string_view path) const;
+
+		// Reads queued or running.
+		size_t GetPendingCount() const;
+
+		// '\' to '/', without repeated '/' or "." and ".."
+		// parts; ".." drops the part before it.
+		static std::string NormalizePath(std::string_view path);
+		static inline Assets::AssetId
+		HashPath(std::string_view path)
+		{
+			return Assets::MakeAssetId(NormalizePath(path));
+		}
+
+	  private:
+		struct Mount
+		{
+			// Normalized, with a trailing '/' unless the
+			// root.
+			std::string point;
+			std::string directory;
+			std::unique_ptr<Assets::Archive> archive;
+		};
+
+		// Where a path resolved to: an archive entry, or a
+		// native path.
+		struct Location
+		{
+			const Assets::Archive* archive = nullptr;
+			const Assets::Archive::Entry* entry = nullptr;
+			std::string nativePath;
+		};
+
+		struct Request
+		{
+			std::string path;
+			uint64_t offset = 0;
+			std::span<uint8_t> buffer;
+			ReadCallback done;
+			bool ok = false;
+			size_t bytes = 0;
+		};
+
+		bool Resolve(std::string_view path,
+		             Location& location) const;
+		static uint64_t GetSize(const Location& location);
+		bool ReadRange(const Location& location,
+		               uint64_t offset,
+		               std::span<uint8_t> buffer) const;
+		void IoMain(uint32_t thread);
+
+	  private:
+		// Guards the mounts; reads share it.
+		mutable std::shared_mutex m_mountsMutex;
+		std::vector<Mount> m_mounts;
+
+		// Guards the queues.
+		mutable std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::deque<Request> m_requests;
+		std::vector<Request> m_finished;
+		size_t m_pending = 0;
+		bool m_stopRequested = false;
+		std::vector<std::thread> m_ioThreads;
+	};
+} // namespace AthiVegam::Managers
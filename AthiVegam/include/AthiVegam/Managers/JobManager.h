@@ -0,0 +1,252 @@
+#pragma once
+
+#include "AthiVegam/Core/WorkStealingDeque.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace AthiVegam::Managers
+{
+	// Number of unfinished jobs scheduled against it. Pass
+	// it to JobManager::Wait() to join them.
+	class JobCounter
+	{
+	  public:
+		inline bool IsDone() const
+		{
+			return m_pending.load(std::memory_order_acquire)
+			       == 0;
+		}
+
+	  private:
+		friend class JobManager;
+		std::atomic<uint32_t> m_pending{0};
+	};
+
+	// Runs jobs on one worker per core. Each thread owns a
+	// work-stealing deque: it takes its own newest jobs and
+	// idle threads steal the oldest jobs of others.
+	// Dependencies are expressed with JobCounters; waiting
+	// on one runs other jobs instead of blocking.
+	//
+	// The main thread and jobs may schedule. Scheduling
+	// from any other thread runs the job inline.
+	//
+	// Every thread's time is split between running jobs,
+	// searching other queues, waiting on counters and
+	// sleeping, to show whether more workers would help;
+	// runs of jobs and sleeps appear as profiler zones.
+	class JobManager
+	{
+	  public:
+		// One thread's last frame. Times are in profiler
+		// ticks, charged when a state ends, so a state
+		// spanning frames counts in the later one.
+		struct ThreadStats
+		{
+			// Running jobs, nested ones included once.
+			uint64_t busyTicks = 0;
+			// Searching other threads' queues.
+			uint64_t stealTicks = 0;
+			// In Wait() with nothing to run while its
+			// jobs finish elsewhere.
+			uint64_t waitTicks = 0;
+			// Asleep with nothing queued; workers only.
+			uint64_t idleTicks = 0;
+			uint32_t jobs = 0;
+			uint32_t steals = 0;
+			// Steals lost to another thief or the owner.
+			uint32_t contendedSteals = 0;
+			// Times the sleep mutex was found held.
+			uint32_t lockContentions = 0;
+			// Of the thread's queue, at the end of the
+			// frame and at most during it.
+			uint32_t queueDepth = 0;
+			uint32_t peakQueueDepth = 0;
+		};
+
+		// Jobs in flight per scheduling thread. Slots are
+		// recycled in order, so a thread must not have more
+		// outstanding jobs than this.
+		static constexpr uint32_t MaxJobsPerThread = 4096;
+
+		JobManager() = default;
+		~JobManager() = default;
+
+		// workerCount 0 uses one worker per performance
+		// core besides the calling (main) thread.
+		void Initialize(uint32_t workerCount = 0);
+		// Outstanding jobs must have been waited on.
+		void Shutdown();
+
+		// The function is copied into the job; captures
+		// must fit Job::StorageSize.
+		template <typename F>
+		void Schedule(F&& function, JobCounter* counter = nullptr)
+		{
+			using Function = std::decay_t<F>;
+			static_assert(
+			    sizeof(Function) <= Job::StorageSize
+			        && alignof(Function)
+			               <= alignof(std::max_align_t),
+			    "Job captures too large; capture a pointer");
+
+			auto* job = AllocateJob();
+			if (!job)
+			{
+				function();
+				return;
+			}
+
+			new (job->storage)
+			    Function(std::forward<F>(function));
+			job->run = [](void* storage) {
+				auto* callable = std::launder(
+				    reinterpret_cast<Function*>(storage));
+				(*callable)();
+				callable->~Function();
+			};
+			job->counter = counter;
+			Submit(job);
+		}
+
+		// Runs other jobs until every job scheduled with the
+		// counter has finished.
+		void Wait(const JobCounter& counter);
+		// Runs one queued job on the calling thread, for
+		// callers that wait on something other than a
+		// counter. Returns false if none was found.
+		bool RunPendingJob();
+
+		// Calls function(i) for every i in [0, count) in
+		// batches of batchSize indices, and returns once all
+		// have run.
+		template <typename F>
+		void ParallelFor(uint32_t count, uint32_t batchSize,
+		                 F&& function)
+		{
+			batchSize = std::max(batchSize, 1u);
+			JobCounter counter;
+			for (uint32_t begin = 0; begin < count;
+			     begin += batchSize)
+			{
+				const auto end =
+				    std::min(count - begin, batchSize) + begin;
+				Schedule(
+				    [&function, begin, end] {
+					    for (auto i = begin; i < end; ++i)
+					    {
+						    function(i);
+					    }
+				    },
+				    &counter);
+			}
+			Wait(counter);
+		}
+
+		inline uint32_t GetWorkerCount() const
+		{
+			return static_cast<uint32_t>(m_workers.size());
+		}
+
+		// Main thread, once per frame: collects the
+		// threads' counters into GetFrameStats().
+		void EndFrame();
+		// Index 0 is the main thread.
+		inline std::span<const ThreadStats> GetFrameStats() const
+		{
+			return m_frameStats;
+		}
+		// Between the last two EndFrame() calls.
+		inline uint64_t GetFrameTicks() const
+		{
+			return m_frameTicks;
+		}
+
+	  private:
+		enum class State : uint8_t
+		{
+			Busy,
+			Stealing,
+			Waiting,
+			Idle,
+			// The main thread outside the job system.
+			Untracked
+		};
+		static constexpr size_t StateCount =
+		    static_cast<size_t>(State::Untracked);
+
+		// Added to by the owning thread, taken by
+		// EndFrame().
+		struct alignas(64) Counters
+		{
+			std::array<std::atomic<uint64_t>, StateCount>
+			    ticks{};
+			std::atomic<uint32_t> jobs{0};
+			std::atomic<uint32_t> steals{0};
+			std::atomic<uint32_t> contendedSteals{0};
+			std::atomic<uint32_t> lockContentions{0};
+			std::atomic<uint32_t> peakQueueDepth{0};
+		};
+
+		struct Job
+		{
+			static constexpr size_t StorageSize = 48;
+
+			alignas(std::max_align_t)
+			    std::byte storage[StorageSize];
+			void (*run)(void* storage) = nullptr;
+			JobCounter* counter = nullptr;
+		};
+
+		struct ThreadQueue
+		{
+			Core::WorkStealingDeque<Job*, MaxJobsPerThread>
+			    deque;
+			std::array<Job, MaxJobsPerThread> jobs;
+			uint32_t nextJob = 0;
+			// Owner only.
+			State state = State::Untracked;
+			uint64_t stateStart = 0;
+			Counters counters;
+		};
+
+		// nullptr when the caller is not a job thread.
+		Job* AllocateJob();
+		void Submit(Job* job);
+		void Execute(Job* job);
+		Job* FindJob(uint32_t thread);
+		bool RunOne(uint32_t thread);
+		void RunJob(uint32_t thread, Job* job);
+		void WorkerMain(uint32_t thread);
+		// Charges the time since the last change to the
+		// thread's state and returns that state.
+		State SetState(uint32_t thread, State state);
+
+	  private:
+		// Index 0 belongs to the main thread.
+		std::vector<std::unique_ptr<ThreadQueue>> m_queues;
+		std::vector<std::thread> m_workers;
+
+		std::atomic<bool> m_running{false};
+		std::atomic<uint32_t> m_queued{0};
+		std::mutex m_sleepMutex;
+		std::condition_variable m_wake;
+
+		std::vector<ThreadStats> m_frameStats;
+		uint64_t m_frameStart = 0;
+		uint64_t m_frameTicks = 0;
+	};
+} // namespace AthiVegam::Managers
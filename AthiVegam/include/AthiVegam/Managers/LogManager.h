@@ -1,9 +1,15 @@
 #pragma once
 
+#include "AthiVegam/EngineConfig.h"
 #include "spdlog/spdlog.h"
 
 #include <memory>
 
+namespace spdlog::details
+{
+	class thread_pool;
+}
+
 namespace AthiVegam::Managers
 {
 	constexpr auto AV_DEFAULT_LOGGER_NAME = "VegamLogger";
@@ -15,9 +21,44 @@ namespace AthiVegam::Managers
 		                           AV_DEFAULT_LOGGER_NAME);
 		static void Shutdown();
 
+		// Replaces the console-only logger's sinks with the
+		// ones config asks for. Call before other threads
+		// start logging.
+		static void Configure(const EngineConfig& config);
+
+		// Moves logging to a background thread (see
+		// EngineConfig::asyncLogging). Call before other
+		// threads start logging; Shutdown() drains the queue
+		// and goes back to synchronous logging.
+		static void StartAsync(size_t queueSize,
+		                       LogOverflow overflow);
+
 		static std::shared_ptr<spdlog::logger> Logger();
 
+		// ImGui window with the panel sink's messages.
+		static void DrawPanel();
+		// Writes the crash ring to the configured path.
+		// Called by VEGAM_ASSERT before it breaks.
+		static void WriteCrashLog();
+
+		// Raw pointers for the VEGAM_* macros, so a log call
+		// does not touch the shared_ptr refcount. Valid
+		// until Shutdown().
+		static inline spdlog::logger* GetLogger()
+		{
+			return rawLogger;
+		}
+		// Writes on the calling thread, to the same sinks.
+		static inline spdlog::logger* GetFatalLogger()
+		{
+			return syncLogger.get();
+		}
+
 	  private:
 		static std::shared_ptr<spdlog::logger> logger;
+		static std::shared_ptr<spdlog::logger> syncLogger;
+		static spdlog::logger* rawLogger;
+		static std::shared_ptr<spdlog::details::thread_pool>
+		    threadPool;
 	};
 } // namespace AthiVegam::Managers
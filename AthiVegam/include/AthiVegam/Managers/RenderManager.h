@@ -1,37 +1,459 @@
 #pragma once
 
+#include "AthiVegam/Core/Memory.h"
+#include "AthiVegam/Graphics/CommandBuffer.h"
+#include "AthiVegam/Graphics/CommandList.h"
+#include "AthiVegam/Graphics/FrameGraph.h"
+#include "AthiVegam/Graphics/GpuCulling.h"
 #include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Graphics/RenderState.h"
+#include "AthiVegam/Graphics/RetainedList.h"
+#include "AthiVegam/Graphics/SortKey.h"
+#include "AthiVegam/Graphics/StreamBuffer.h"
+#include "AthiVegam/Graphics/WeightedOit.h"
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
-#include <queue>
+#include <mutex>
+#include <span>
+#include <vector>
 
 namespace AthiVegam::Managers
 {
 	class RenderManager
 	{
 	  public:
-		RenderManager() = default;
+		RenderManager();
 		~RenderManager() = default;
 
 		void Initialize();
 		void Shutdown();
 
 		void Clear();
+		// Until r.clearColor next changes.
 		void SetClearColor(float r, float g, float b,
 		                   float a);
 		void SetWireframeMode(bool enabled);
 
-		void Submit(std::unique_ptr<
-		            Graphics::RenderCommands::RenderCommand>
-		                renderCommand);
+		// Commands are copied into the frame's command
+		// buffer; submitting never touches the heap once the
+		// buffers have grown to the frame's size. These
+		// record into the main thread's list.
+		template <typename T>
+		inline void Submit(const T& renderCommand)
+		{
+			GetMainList().Submit(renderCommand);
+		}
 
-		// Execute submitted RenderCommands in the order
-		// they were received for now.
+		template <typename T>
+		inline void Submit(const T& renderCommand,
+		                   uint64_t sortKey)
+		{
+			GetMainList().Submit(renderCommand, sortKey);
+		}
+
+		// Records into a secondary viewport's window (see
+		// VegamWindow::CreateViewport()). Every viewport is
+		// sorted and executed in the same flush.
+		template <typename T>
+		inline void SubmitToViewport(uint32_t viewport,
+		                             const T& renderCommand)
+		{
+			GetMainList().Submit(
+			    renderCommand,
+			    Graphics::SortKey::WithViewport(
+			        Graphics::RenderCommands::GetSortKey(
+			            renderCommand),
+			        viewport));
+		}
+
+		// GL thread. Called while executing whenever the
+		// commands move to another viewport, to make it the
+		// render target; set by VegamWindow.
+		using ViewportBinder =
+		    std::function<void(uint32_t viewport)>;
+		inline void SetViewportBinder(ViewportBinder binder)
+		{
+			m_viewportBinder = std::move(binder);
+		}
+
+		// Copies per-instance data into this frame's
+		// instance buffer and returns the index of the first
+		// instance, for use in RenderMesh::instance or
+		// RenderMeshInstanced::firstInstance.
+		uint32_t PushInstances(
+		    const Graphics::RenderCommands::InstanceTransform*
+		        transforms,
+		    uint32_t count);
+		// With each instance's draw data, for shaders that
+		// read AV_DRAW_DATA() instead of constants.
+		uint32_t PushInstances(
+		    const Graphics::RenderCommands::InstanceTransform*
+		        transforms,
+		    const Graphics::RenderCommands::DrawData* drawData,
+		    uint32_t count);
+
+		void SubmitInstanced(
+		    Graphics::MeshHandle mesh,
+		    Graphics::ShaderHandle shader,
+		    const Graphics::RenderCommands::InstanceTransform*
+		        transforms,
+		    uint32_t count);
+
+		// Copies a draw's uniform block data into this
+		// frame's constant ring; pass the result in the
+		// command's constants. At execution the range is
+		// bound to the shader's Constants block with
+		// glBindBufferRange, so no uniform is set per draw.
+		inline Graphics::RenderCommands::Constants
+		PushConstants(const void* data, uint32_t size)
+		{
+			return GetMainList().PushConstants(data, size);
+		}
+		template <typename T>
+		inline Graphics::RenderCommands::Constants
+		PushConstants(const T& constants)
+		{
+			return GetMainList().PushConstants(constants);
+		}
+
+		// Late latch: constants that are rewritten right
+		// before the frame's commands are executed (or handed
+		// to the render thread), so e.g. the view matrix can
+		// follow input sampled after App::Render(). The
+		// callback receives the data pushed here and runs on
+		// the main thread; see Input::Mouse::PeekLateMotion().
+		// One block per frame.
+		using LateLatchCallback =
+		    std::function<void(void* data, uint32_t size)>;
+		void SetLateLatchCallback(LateLatchCallback callback);
+		Graphics::RenderCommands::Constants
+		PushLateLatchConstants(const void* data,
+		                       uint32_t size);
+		template <typename T>
+		inline Graphics::RenderCommands::Constants
+		PushLateLatchConstants(const T& constants)
+		{
+			return PushLateLatchConstants(
+			    &constants, static_cast<uint32_t>(sizeof(T)));
+		}
+
+		// Main thread. The list's draws join the first flush
+		// of every frame until it is removed, sorted with
+		// the submitted ones; it must outlive its
+		// registration.
+		void AddRetainedList(const Graphics::RetainedList& list);
+		void
+		RemoveRetainedList(const Graphics::RetainedList& list);
+
+		// Command list owned by the calling thread. Worker
+		// threads record into their own list without
+		// synchronization; all recording must be finished
+		// before Flush() is called on the render thread.
+		Graphics::CommandList& GetThreadCommandList();
+
+		// Batch draws of arena meshes into
+		// glMultiDrawElementsIndirect calls. Requires a GL
+		// 4.3+ context (see EngineConfig); enabled by default
+		// when available. CVar r.multiDrawIndirect.
+		void SetMultiDrawIndirectEnabled(bool enabled);
+		inline bool IsMultiDrawIndirectSupported() const
+		{
+			return m_multiDrawIndirectSupported;
+		}
+
+		// Cull multi-draw batches on the GPU (see
+		// Graphics::GpuCulling): instanced arena draws of
+		// the main viewport are tested by their mesh bounds
+		// and instance transforms. Needs multi-draw indirect
+		// and a GL 4.3 context (see
+		// EngineConfig::gpuCulling). Other draws are never
+		// culled, and the triangle counter still counts
+		// culled draws. CVar r.gpuCulling.
+		void SetGpuCullingEnabled(bool enabled);
+		inline bool IsGpuCullingEnabled() const
+		{
+			return m_gpuCullingEnabled;
+		}
+		// Main thread, while recording: the column-major
+		// view-projection the next flush culls with. Flushes
+		// without one are not culled.
+		void SetCullingView(const float viewProjection[16]);
+		// GL thread. Scales the projected sizes culled
+		// draws pick their mesh's level of detail by; below
+		// 1 favours coarser levels. CVar r.lodBias.
+		void SetLodBias(float bias);
+		// GL thread. Single-sampled depth texture the app
+		// renders its main view into; EndFrame() reduces it
+		// into the pyramid the next frame's occlusion test
+		// reads. 0 culls by the frustum only.
+		void SetOcclusionDepth(uint32_t depthTexture,
+		                       int width, int height);
+
+		// GL thread. Post-processing and other offscreen
+		// passes declare their transient targets here; the
+		// window points its backbuffer at what it renders
+		// into.
+		inline Graphics::FrameGraph& GetFrameGraph()
+		{
+			return m_frameGraph;
+		}
+
+		// Orders the draws of flushes with a culling view
+		// by their depth in it: opaque ones front to back
+		// within their shader, state and mesh, translucent
+		// ones back to front across shaders. Draws are
+		// translucent when their material blends. Off by
+		// default, as depth replaces the material order
+		// within a mesh. CVar r.depthSort.
+		void SetDepthSortEnabled(bool enabled);
+		// Draws of the main viewport whose material writes
+		// depth without blending are drawn twice: depth
+		// only, then shaded against it without writing, so
+		// hidden fragments never reach the fragment shader.
+		// Pays off when fragments cost more than vertices.
+		// CVar r.depthPrepass.
+		void SetDepthPrepassEnabled(bool enabled);
+
+		// Merge every thread's command list and execute the
+		// commands ordered by sort key. Commands with equal
+		// keys keep their submission order. With the render
+		// thread enabled this is a no-op: the frame's
+		// commands run on the render thread in one flush.
 		void Flush();
 
+		// Render thread mode (see EngineConfig). Commands
+		// are recorded into one set of lists while the render
+		// thread executes the other; SwapFrames() hands the
+		// recorded set over and must only be called while
+		// the render thread is idle.
+		void SetRenderThreadEnabled(bool enabled);
+		inline bool IsRenderThreadEnabled() const
+		{
+			return m_renderThreadEnabled;
+		}
+		void SwapFrames();
+		void ExecuteFrame();
+
+		// Any thread, e.g. as a loading screen shows: the
+		// next frame executed first draws every logged
+		// pipeline whose shader is loaded, see
+		// Graphics::PipelineWarmup.
+		inline void RequestPipelineWarmup()
+		{
+			m_pipelineWarmup.store(true,
+			                       std::memory_order_relaxed);
+		}
+
+		// GL thread. Runs commands as given, without
+		// sorting or merging, through the same state cache
+		// and counters; for passes built on the GL thread
+		// after the flush, such as the UI.
+		void ExecuteOrdered(const Graphics::CommandBuffer& commands,
+		                    std::span<const uint32_t> offsets);
+
+		inline const Graphics::RenderState&
+		GetRenderState() const
+		{
+			return m_renderState;
+		}
+
+		// Frames the driver may queue ahead of the GPU; the
+		// GL thread waits on a fence at EndFrame() once more
+		// are in flight. 0 leaves it to the driver.
+		void SetMaxFramesInFlight(uint32_t frames);
+
+		// GL thread, once per frame after the last flush.
+		// Publishes the frame's counters and resets them.
+		void EndFrame();
+		// Counters of the last finished frame. Any thread.
+		Graphics::RenderStats GetFrameStats() const;
+
 	  private:
-		std::queue<std::unique_ptr<
-		    Graphics::RenderCommands::RenderCommand>>
-		    m_renderCommands;
+		static constexpr uint32_t MergedEntry = 0xFFFFFFFF;
+		// Commands generated while flushing (merged
+		// instances, indirect batches) live in their own
+		// buffer and address the combined instance data.
+		static constexpr uint32_t FlushList = 0xFFFFFFFF;
+		static constexpr uint32_t FrameCount = 2;
+		static constexpr uint32_t MaxFramesInFlight = 4;
+
+		// One list per frame in flight for each recording
+		// thread.
+		using FrameLists =
+		    std::array<Graphics::CommandList, FrameCount>;
+
+		template <typename T>
+		using Vector =
+		    Core::Memory::Vector<T, Core::Memory::Tag::Render>;
+
+		struct SortEntry
+		{
+			uint64_t key;
+			uint32_t offset;
+			uint32_t list;
+			// In gathering order, which breaks ties.
+			uint32_t index;
+		};
+
+		struct CommandRef
+		{
+			Graphics::RenderCommands::CommandType type;
+			const void* payload;
+			uint32_t instanceBase;
+			uint32_t constantBase;
+		};
+
+		inline Graphics::CommandList& GetMainList()
+		{
+			return (*m_mainLists)[m_recordFrame];
+		}
+
+		// A retained list as of each frame, copied when its
+		// version moved.
+		struct RetainedCopy
+		{
+			// Null once removed.
+			const Graphics::RetainedList* list;
+			std::array<Graphics::CommandList, FrameCount> frames;
+			std::array<uint64_t, FrameCount> versions{};
+		};
+
+		CommandRef GetCommand(const SortEntry& entry) const;
+
+		void Execute(uint32_t frame);
+		void GatherLists(uint32_t frame);
+#ifndef AV_CONFIG_SHIPPING
+		// Hands the gathered flush to Graphics::FrameCapture
+		// while it records.
+		void CaptureFlush();
+#endif // AV_CONFIG_SHIPPING
+		void SortEntries();
+		// False, leaving the entries as gathered, when too
+		// many moved since last frame's order.
+		bool SortCoherent();
+		void RadixSort();
+		void MergeInstances();
+		void BuildIndirectBatches();
+		// False, for the run to be skipped, without the OIT
+		// targets.
+		bool BeginWeightedOit();
+		// Whether any draw went into the pre-pass.
+		bool ExecuteDepthPrepass(
+		    Graphics::RenderCommands::ExecuteContext& context);
+		void UploadInstances();
+		void UploadConstants();
+		void LateLatch();
+		// Main thread, as the record frame is handed over.
+		void CopyRetainedLists();
+		void WaitForFramesInFlight();
+		void DeleteFrameFences();
+		// GL thread, at the start of each flush: applies
+		// r.* CVars changed since the last one.
+		void ApplyCVars();
+
+	  private:
+		std::vector<std::unique_ptr<FrameLists>> m_lists;
+		std::vector<const Graphics::CommandList*>
+		    m_gatheredLists;
+		std::vector<uint32_t> m_listInstanceBase;
+		std::vector<uint32_t> m_listConstantBase;
+		FrameLists* m_mainLists;
+		std::mutex m_listsMutex;
+		uint32_t m_listsEpoch;
+		// Guarded by m_listsMutex.
+		std::vector<std::unique_ptr<RetainedCopy>> m_retained;
+		// GL thread; reset by EndFrame().
+		bool m_retainedGathered = false;
+
+		bool m_renderThreadEnabled = false;
+		std::atomic<bool> m_pipelineWarmup{false};
+		uint32_t m_recordFrame = 0;
+		uint32_t m_executeFrame = 0;
+
+		Graphics::CommandBuffer m_flushCommands;
+		Vector<SortEntry> m_sortEntries;
+		Vector<SortEntry> m_sortScratch;
+		Vector<SortEntry> m_sortStrays;
+		// Last frame's sorted order, as gathering indices.
+		Vector<uint32_t> m_sortOrder;
+
+		Vector<Graphics::RenderCommands::InstanceTransform>
+		    m_instanceData;
+		uint32_t m_instanceBuffer = 0;
+		size_t m_instanceBufferSize = 0;
+		// One per instance, in a storage buffer from GL 4.3.
+		Vector<Graphics::RenderCommands::DrawData> m_drawData;
+		uint32_t m_drawDataBuffer = 0;
+		size_t m_drawDataBufferSize = 0;
+
+		Vector<uint8_t> m_constantData;
+		std::unique_ptr<Graphics::StreamBuffer> m_constantRing;
+		uint32_t m_constantRingOffset = 0;
+
+		bool m_multiDrawIndirectSupported = false;
+		bool m_multiDrawIndirectEnabled = false;
+		Vector<Graphics::RenderCommands::DrawElementsIndirect>
+		    m_indirectDraws;
+		// Material index of each indirect draw.
+		Vector<uint32_t> m_drawMaterials;
+		uint32_t m_indirectBuffer = 0;
+		size_t m_indirectBufferSize = 0;
+
+		struct CullingView
+		{
+			float viewProjection[16];
+			bool set = false;
+		};
+		Graphics::FrameGraph m_frameGraph;
+		Graphics::GpuCulling m_gpuCulling;
+		// Made on the first BlendMode::WeightedOit draw.
+		Graphics::WeightedOit m_weightedOit;
+		bool m_weightedOitUnavailable = false;
+		bool m_gpuCullingEnabled = false;
+		// Per frame in flight, like the command lists.
+		std::array<CullingView, FrameCount> m_cullingViews;
+		// The executing flush's, or null.
+		const CullingView* m_cullingView = nullptr;
+		// Mesh-space bounds of each indirect draw.
+		Vector<Graphics::Float4> m_drawBounds;
+		uint32_t m_cullableDraws = 0;
+		// Levels of each indirect draw, while any has some.
+		Vector<Graphics::GpuCulling::LodLevels> m_drawLods;
+		uint32_t m_lodDraws = 0;
+		// Indirect draws culled by meshlet, and the
+		// cluster indices their slices add up to.
+		Vector<Graphics::GpuCulling::ClusterDraw>
+		    m_clusterDraws;
+		uint32_t m_clusterIndexCount = 0;
+
+		// Versions of the r.* CVars last applied; see
+		// ApplyCVars().
+		struct CVarVersions
+		{
+			uint32_t clearColor = 0;
+			uint32_t multiDrawIndirect = 0;
+			uint32_t gpuCulling = 0;
+			uint32_t lodBias = 0;
+		};
+		CVarVersions m_cvarVersions;
+
+		ViewportBinder m_viewportBinder;
+		LateLatchCallback m_lateLatchCallback;
+		Graphics::RenderCommands::Constants
+		    m_lateLatchConstants;
+		bool m_lateLatchPending = false;
+
+		uint32_t m_maxFramesInFlight = 0;
+		uint32_t m_frameFence = 0;
+		std::array<GLsync, MaxFramesInFlight> m_frameFences{};
+
+		Graphics::RenderState m_renderState;
+		uint32_t m_constantBytes = 0;
+		mutable std::mutex m_statsMutex;
+		Graphics::RenderStats m_frameStats;
 	};
 } // namespace AthiVegam::Managers
@@ -0,0 +1,448 @@
+#pragma once
+
+#include "AthiVegam/Assets/MeshPack.h"
+#include "AthiVegam/Assets/ShaderPack.h"
+#include "AthiVegam/Core/FileWatcher.h"
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Graphics/ComputeShader.h"
+#include "AthiVegam/Graphics/Material.h"
+#include "AthiVegam/Graphics/MaterialTable.h"
+#include "AthiVegam/Graphics/Mesh.h"
+#include "AthiVegam/Graphics/MeshArena.h"
+#include "AthiVegam/Graphics/MeshOptimizer.h"
+#include "AthiVegam/Graphics/MeshUploadQueue.h"
+#include "AthiVegam/Graphics/ResourcePool.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Graphics/ShaderVariants.h"
+#include "AthiVegam/Graphics/Texture.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace AthiVegam::Managers
+{
+	// Owns the engine's GPU resources. Apps and render
+	// commands refer to them through 32-bit handles.
+	class ResourceManager
+	{
+	  public:
+		ResourceManager() = default;
+		~ResourceManager() = default;
+
+		void Initialize();
+		void Shutdown();
+
+		// Static meshes are sub-allocated from shared arenas,
+		// one set per vertex layout and index width, so they
+		// share a VAO and can be batched. Meshes of up to
+		// 65536 vertices get 16-bit indices.
+		//
+		// site names the caller in the GPU resource
+		// inspector (see Graphics::GpuResources).
+		Graphics::MeshHandle CreateMesh(
+		    float* vertexArray, uint32_t vertexCount,
+		    uint32_t dimensions,
+		    std::source_location site =
+		        std::source_location::current());
+		Graphics::MeshHandle CreateMesh(
+		    float* vertexArray, uint32_t vertexCount,
+		    uint32_t dimensions, uint32_t* elementArray,
+		    uint32_t elementCount,
+		    std::source_location site =
+		        std::source_location::current());
+		Graphics::MeshHandle CreateMesh(
+		    const Graphics::VertexLayout& layout,
+		    const void* vertexData, uint32_t vertexCount,
+		    const uint32_t* elementArray = nullptr,
+		    uint32_t elementCount = 0,
+		    std::source_location site =
+		        std::source_location::current());
+		Graphics::MeshHandle CreateMesh(
+		    Graphics::MeshArena& arena, const void* vertexData,
+		    uint32_t vertexCount, const uint32_t* elementArray,
+		    uint32_t elementCount);
+		// Runs the mesh optimizer on a copy of the data
+		// before creating the mesh. Meant for load time.
+		Graphics::MeshHandle CreateOptimizedMesh(
+		    const Graphics::VertexLayout& layout,
+		    const void* vertexData, uint32_t vertexCount,
+		    const uint32_t* elementArray, uint32_t elementCount,
+		    const Graphics::MeshOptimizer::Options& options =
+		        {},
+		    std::source_location site =
+		        std::source_location::current());
+		// Mesh with its own VAO and buffers.
+		Graphics::MeshHandle CreateStandaloneMesh(
+		    const Graphics::VertexLayout& layout,
+		    const void* vertexData, uint32_t vertexCount,
+		    const uint32_t* elementArray = nullptr,
+		    uint32_t elementCount = 0,
+		    std::source_location site =
+		        std::source_location::current());
+		Graphics::MeshHandle CreateDynamicMesh(
+		    const Graphics::VertexLayout& layout,
+		    uint32_t maxVertexCount, uint32_t maxElementCount,
+		    std::source_location site =
+		        std::source_location::current());
+		// A cooked mesh, copied straight from the pack's
+		// mapping into a shared arena, with its meshlets if
+		// it was split into some. Returns an invalid handle
+		// if the pack has no such mesh.
+		Graphics::MeshHandle LoadMesh(
+		    const Assets::MeshPack& pack, Assets::AssetId id,
+		    std::source_location site =
+		        std::source_location::current());
+		// Callable from any thread. The data is copied and
+		// the returned handle draws nothing until
+		// ProcessUploads() has moved it to the GPU.
+		Graphics::MeshHandle CreateMeshAsync(
+		    const Graphics::VertexLayout& layout,
+		    const void* vertexData, uint32_t vertexCount,
+		    const uint32_t* elementArray = nullptr,
+		    uint32_t elementCount = 0);
+		// The two halves of CreateMeshAsync(), for loaders
+		// that hand out the handle before the data is read.
+		// Both callable from any thread; request.mesh must
+		// be a placeholder, and may have been destroyed.
+		// Bounds unknown until the data is read are
+		// infinite.
+		Graphics::MeshHandle CreateMeshPlaceholder(
+		    const Graphics::Aabb& bounds =
+		        Graphics::Aabb::Infinite());
+		void
+		QueueMeshUpload(Graphics::MeshUploadQueue::Request&&
+		                    request);
+		// GL thread, once per frame. Also finishes shaders
+		// from CreateShaderAsync() and uploads queued
+		// texture levels.
+		void ProcessUploads(double budgetMs);
+		// Whether meshes, shaders or textures are still on
+		// their way,
+		// as of the last ProcessUploads(). Any thread.
+		inline bool HasPendingUploads() const
+		{
+			return m_uploadsPending.load(
+			    std::memory_order_relaxed);
+		}
+		inline bool
+		IsMeshReady(Graphics::MeshHandle handle) const
+		{
+			auto* mesh = m_meshes.Get(handle);
+			return mesh && mesh->IsReady();
+		}
+		void DestroyMesh(Graphics::MeshHandle handle);
+		// Attaches coarser levels, e.g. from an offline
+		// simplifier, to a mesh; they must outlive its use.
+		// Draws batched from an arena pick a level on the
+		// GPU while a culling view is set; Scene::World
+		// picks one for its objects.
+		void SetMeshLods(Graphics::MeshHandle handle,
+		                 const Graphics::LodChain& lods);
+		inline Graphics::Mesh*
+		GetMesh(Graphics::MeshHandle handle) const
+		{
+			return m_meshes.Get(handle);
+		}
+
+		Graphics::ShaderHandle CreateShader(
+		    const std::string& vertex,
+		    const std::string& fragment,
+		    Graphics::Shader::CompileMode mode =
+		        Graphics::Shader::CompileMode::Blocking,
+		    std::source_location site =
+		        std::source_location::current());
+		// Issues the compile and returns right away. Draws
+		// using the shader are skipped, or use the fallback
+		// shader, until ProcessUploads() sees it linked.
+		Graphics::ShaderHandle CreateShaderAsync(
+		    const std::string& vertex,
+		    const std::string& fragment,
+		    std::source_location site =
+		        std::source_location::current());
+		inline void
+		SetFallbackShader(Graphics::ShaderHandle handle)
+		{
+			m_fallbackShader = handle;
+		}
+		// The shader to draw with in place of handle: itself
+		// once linked, the fallback while it is pending, or
+		// nullptr if neither can draw.
+		Graphics::Shader*
+		GetDrawableShader(Graphics::ShaderHandle handle) const;
+		inline bool
+		IsShaderPending(Graphics::ShaderHandle handle) const
+		{
+			auto* shader = m_shaders.Get(handle);
+			return shader && shader->IsPending();
+		}
+		void DestroyShader(Graphics::ShaderHandle handle);
+
+		// A compute program, for Dispatch commands. Compile
+		// errors are logged and leave it not ready. GL 4.3.
+		Graphics::ComputeShaderHandle CreateComputeShader(
+		    const std::string& source,
+		    std::source_location site =
+		        std::source_location::current());
+		void DestroyComputeShader(
+		    Graphics::ComputeShaderHandle handle);
+		inline Graphics::ComputeShader* GetComputeShader(
+		    Graphics::ComputeShaderHandle handle) const
+		{
+			return m_computeShaders.Get(handle);
+		}
+
+		// A shader compiled from GLSL files, or from their
+		// cooked stages once a shader pack is mounted.
+		// #include "file" is resolved relative to the
+		// including file. With hot reload enabled, edited
+		// files are recompiled in the background and the
+		// new program is swapped in behind the same handle
+		// once linked; a failed compile keeps the old one.
+		// Returns an invalid handle if a file cannot be
+		// read.
+		Graphics::ShaderHandle CreateShaderFromFiles(
+		    const std::string& vertexPath,
+		    const std::string& fragmentPath,
+		    std::source_location site =
+		        std::source_location::current());
+		// Stages cooked by tools/cookshaders.py, looked up
+		// by the path passed to CreateShaderFromFiles().
+		bool MountShaderPack(const std::string& path);
+		// Polls the files of every CreateShaderFromFiles()
+		// shader every intervalMs. Reloads are applied by
+		// ProcessUploads().
+		void EnableShaderHotReload(uint32_t intervalMs);
+		// Runs on the GL thread after a reloaded program was
+		// swapped in, e.g. to set its uniforms again.
+		using ShaderReloadCallback =
+		    std::function<void(Graphics::ShaderHandle)>;
+		inline void
+		SetShaderReloadCallback(ShaderReloadCallback callback)
+		{
+			m_shaderReloadCallback = std::move(callback);
+		}
+
+		// Storage for every level, none of them uploaded
+		// yet. GL thread.
+		Graphics::TextureHandle CreateTexture(
+		    const Graphics::TextureDesc& desc,
+		    std::source_location site =
+		        std::source_location::current());
+		// A KTX2 file, every level uploaded before
+		// returning. Returns an invalid handle if it cannot
+		// be read or its format is not supported.
+		Graphics::TextureHandle LoadTexture(
+		    const std::string& path,
+		    std::source_location site =
+		        std::source_location::current());
+		// For streaming: a texture that binds as none until
+		// its first queued level arrives, and the levels.
+		// Both callable from any thread.
+		struct TextureUpload
+		{
+			Graphics::TextureHandle texture;
+			// Creates the placeholder's storage.
+			Graphics::TextureDesc desc;
+			uint32_t level = 0;
+			std::vector<uint8_t> data;
+		};
+		Graphics::TextureHandle CreateTexturePlaceholder();
+		void QueueTextureUpload(TextureUpload&& upload);
+		// Streamed textures lose their finest levels when
+		// GPU memory is over budget (see GpuMemory) and they
+		// were not drawn lately; the level is the finest
+		// one kept. Queuing finer levels again restores
+		// them. Any thread.
+		struct TextureEviction
+		{
+			Graphics::TextureHandle texture;
+			uint32_t level = 0;
+		};
+		std::vector<TextureEviction> TakeTextureEvictions();
+		inline bool
+		IsTextureReady(Graphics::TextureHandle handle) const
+		{
+			auto* texture = m_textures.Get(handle);
+			return texture && texture->IsReady();
+		}
+		void DestroyTexture(Graphics::TextureHandle handle);
+		inline Graphics::Texture*
+		GetTexture(Graphics::TextureHandle handle) const
+		{
+			return m_textures.Get(handle);
+		}
+
+		// For hot reload: once replacement is drawable (a
+		// texture with every level), ProcessUploads() swaps
+		// its contents into handle and destroys it, so draws
+		// through handle keep the old asset until then. A
+		// replaced texture is no longer evicted. Any thread.
+		void ReplaceMesh(Graphics::MeshHandle handle,
+		                 Graphics::MeshHandle replacement);
+		void ReplaceTexture(Graphics::TextureHandle handle,
+		                    Graphics::TextureHandle replacement);
+
+		// Any thread; the table sees changes at the next
+		// ProcessUploads(). Material textures need GL 4.3;
+		// before it draws ignore them.
+		Graphics::MaterialHandle
+		CreateMaterial(const Graphics::MaterialDesc& desc);
+		void UpdateMaterial(Graphics::MaterialHandle handle,
+		                    const Graphics::MaterialDesc& desc);
+		void DestroyMaterial(Graphics::MaterialHandle handle);
+		inline const Graphics::Material*
+		GetMaterial(Graphics::MaterialHandle handle) const
+		{
+			return m_materials.Get(handle);
+		}
+		inline const Graphics::MaterialTable&
+		GetMaterialTable() const
+		{
+			return m_materialTable;
+		}
+		inline Graphics::MaterialTable& GetMaterialTable()
+		{
+			return m_materialTable;
+		}
+
+		// Variant sets live until shutdown, as do the
+		// shaders compiled for them.
+		Graphics::ShaderVariants*
+		CreateShaderVariants(std::string vertex,
+		                     std::string fragment,
+		                     std::vector<std::string> features);
+		// The program for a permutation key, compiled
+		// asynchronously on first use.
+		Graphics::ShaderHandle
+		GetShaderVariant(Graphics::ShaderVariants& variants,
+		                 uint32_t key);
+		inline Graphics::Shader*
+		GetShader(Graphics::ShaderHandle handle) const
+		{
+			return m_shaders.Get(handle);
+		}
+
+		// Arenas live until shutdown; meshes created in one
+		// must be destroyed before it. Meshes from
+		// CreateMesh(layout, ...) never use arenas created
+		// here.
+		Graphics::MeshArena* CreateMeshArena(
+		    uint32_t dimensions, uint32_t vertexCapacity,
+		    uint32_t indexCapacity,
+		    Graphics::IndexType indexType =
+		        Graphics::IndexType::UInt32,
+		    std::source_location site =
+		        std::source_location::current());
+		Graphics::MeshArena* CreateMeshArena(
+		    const Graphics::VertexLayout& layout,
+		    uint32_t vertexCapacity, uint32_t indexCapacity,
+		    Graphics::IndexType indexType =
+		        Graphics::IndexType::UInt32,
+		    std::source_location site =
+		        std::source_location::current());
+
+		// Pool usage, to the log or an ImGui window.
+		void LogStats() const;
+		void DrawStats() const;
+
+		inline auto& GetMeshes() { return m_meshes; }
+		inline auto& GetShaders() { return m_shaders; }
+		inline auto& GetTextures() { return m_textures; }
+
+		static constexpr uint32_t SharedArenaVertexCapacity =
+		    1 << 16;
+		static constexpr uint32_t SharedArenaIndexCapacity =
+		    1 << 18;
+		// Bytes staged for upload per frame.
+		static constexpr size_t MeshUploadStagingSize =
+		    4 << 20;
+		// Texture bytes uploaded per frame; at least one
+		// level always goes.
+		static constexpr size_t TextureUploadBudget = 8 << 20;
+		// Frames a streamed texture goes undrawn before it
+		// can be evicted.
+		static constexpr uint64_t TextureEvictionAge = 120;
+		// Each eviction copies the kept levels.
+		static constexpr uint32_t MaxTextureEvictions = 8;
+
+		// Shared arena with room for the mesh, or nullptr if
+		// it is too big for one.
+		Graphics::MeshArena*
+		GetSharedArena(const Graphics::VertexLayout& layout,
+		               uint32_t vertexCount,
+		               uint32_t elementCount);
+
+	  private:
+		struct ShaderFiles
+		{
+			Graphics::ShaderHandle handle;
+			std::string vertexPath;
+			std::string fragmentPath;
+		};
+
+		struct ShaderReload
+		{
+			Graphics::ShaderHandle handle;
+			std::unique_ptr<Graphics::Shader> shader;
+		};
+
+		template <typename Handle>
+		struct Replacement
+		{
+			Handle handle;
+			Handle replacement;
+		};
+
+		void ReloadShaders();
+		bool ReadShaderSource(const std::string& path,
+		                      std::string& source) const;
+		void ProcessTextureUploads();
+		void ProcessReplacements();
+		void EvictTextures();
+
+	  private:
+		// Guards creation and destruction, which may race
+		// with CreateMeshAsync() on other threads.
+		std::mutex m_meshesMutex;
+		Graphics::ResourcePool<Graphics::Mesh> m_meshes;
+		std::vector<Replacement<Graphics::MeshHandle>>
+		    m_meshReplacements;
+		Graphics::MeshUploadQueue m_uploads;
+		Graphics::ResourcePool<Graphics::Shader> m_shaders;
+		std::vector<Graphics::ShaderHandle> m_pendingShaders;
+		Graphics::ResourcePool<Graphics::ComputeShader>
+		    m_computeShaders;
+		// Guards the textures and their uploads, which
+		// streaming threads add to.
+		std::mutex m_texturesMutex;
+		Graphics::ResourcePool<Graphics::Texture> m_textures;
+		std::vector<TextureUpload> m_textureUploads;
+		std::vector<Graphics::TextureHandle> m_streamedTextures;
+		std::vector<TextureEviction> m_textureEvictions;
+		std::vector<Replacement<Graphics::TextureHandle>>
+		    m_textureReplacements;
+		std::mutex m_materialsMutex;
+		Graphics::ResourcePool<Graphics::Material> m_materials;
+		Graphics::MaterialTable m_materialTable;
+		std::atomic<bool> m_uploadsPending{false};
+		Graphics::ShaderHandle m_fallbackShader;
+		std::vector<std::unique_ptr<Graphics::MeshArena>>
+		    m_meshArenas;
+		std::vector<Graphics::MeshArena*> m_sharedArenas;
+		std::vector<std::unique_ptr<Graphics::ShaderVariants>>
+		    m_shaderVariants;
+
+		std::vector<ShaderFiles> m_shaderFiles;
+		Assets::ShaderPack m_shaderPack;
+		// Compiling replacements, at most one per shader.
+		std::vector<ShaderReload> m_shaderReloads;
+		Core::FileWatcher m_shaderWatcher;
+		ShaderReloadCallback m_shaderReloadCallback;
+	};
+} // namespace AthiVegam::Managers
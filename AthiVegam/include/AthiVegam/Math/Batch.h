@@ -0,0 +1,36 @@
+#pragma once
+
+#include "AthiVegam/Math/Matrix.h"
+#include "AthiVegam/Math/Quaternion.h"
+#include "AthiVegam/Math/Vector.h"
+
+#include <cstddef>
+
+namespace AthiVegam::Math
+{
+	// Kernels over arrays, keeping the matrix in registers
+	// across the whole array. Input and output may be the
+	// same array.
+
+	void TransformPoints(const Mat4& m, const Vec3* points,
+	                     Vec3* out, size_t count);
+	void TransformVectors(const Mat4& m,
+	                      const Vec3* vectors, Vec3* out,
+	                      size_t count);
+	void Transform(const Mat4& m, const Vec4* vectors,
+	               Vec4* out, size_t count);
+	// out[i] = m * matrices[i], e.g. a view-projection
+	// applied to every instance.
+	void Multiply(const Mat4& m, const Mat4* matrices,
+	              Mat4* out, size_t count);
+	// out[i] = a[i] * b[i], e.g. parents' world matrices
+	// with their children's local ones.
+	void Multiply(const Mat4* a, const Mat4* b, Mat4* out,
+	              size_t count);
+	// out[i] = Mat4::Trs(translations[i], rotations[i],
+	// scales[i]).
+	void ComposeTrs(const Vec3* translations,
+	                const Quat* rotations,
+	                const Vec3* scales, Mat4* out,
+	                size_t count);
+} // namespace AthiVegam::Math
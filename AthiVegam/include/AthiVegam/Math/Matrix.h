@@ -0,0 +1,129 @@
+#pragma once
+
+#include "AthiVegam/Math/Quaternion.h"
+#include "AthiVegam/Math/Vector.h"
+
+namespace AthiVegam::Math
+{
+	// Column-major 4x4, as GL expects and with the same
+	// layout as RenderCommands::InstanceTransform, so
+	// Data() can be copied or uploaded directly. Vectors
+	// are columns: m * v applies m to v.
+	struct alignas(16) Mat4
+	{
+		Vec4 columns[4] = {{1.0f, 0.0f, 0.0f, 0.0f},
+		                   {0.0f, 1.0f, 0.0f, 0.0f},
+		                   {0.0f, 0.0f, 1.0f, 0.0f},
+		                   {0.0f, 0.0f, 0.0f, 1.0f}};
+
+		inline const float* Data() const
+		{
+			return &columns[0].x;
+		}
+		inline float* Data() { return &columns[0].x; }
+
+		// From 16 column-major floats, e.g.
+		// InstanceTransform::m.
+		static inline Mat4 Load(const float* data)
+		{
+			Mat4 result;
+			for (int i = 0; i < 4; ++i)
+			{
+				Simd::Store(&result.columns[i].x,
+				            Simd::Load(data + i * 4));
+			}
+			return result;
+		}
+		inline void Store(float* data) const
+		{
+			for (int i = 0; i < 4; ++i)
+			{
+				Simd::Store(data + i * 4,
+				            Simd::Load(&columns[i].x));
+			}
+		}
+
+		static constexpr Mat4 Identity() { return {}; }
+		static Mat4 Translation(const Vec3& offset);
+		static Mat4 Scale(const Vec3& scale);
+		static Mat4 Rotation(const Quat& rotation);
+		// Scales, then rotates, then translates.
+		static Mat4 Trs(const Vec3& translation,
+		                const Quat& rotation,
+		                const Vec3& scale);
+		// Right-handed, looking down -z, depth to [-1, 1]
+		// as GL clips. fovY in radians.
+		static Mat4 Perspective(float fovY, float aspect,
+		                        float nearZ, float farZ);
+		static Mat4 Orthographic(float left, float right,
+		                         float bottom, float top,
+		                         float nearZ, float farZ);
+		static Mat4 LookAt(const Vec3& eye,
+		                   const Vec3& target,
+		                   const Vec3& up);
+	};
+
+	inline Vec4 operator*(const Mat4& m, const Vec4& v)
+	{
+		const auto value = Load(v);
+		auto result = Simd::Mul(Load(m.columns[0]),
+		                        Simd::SplatLane<0>(value));
+		result =
+		    Simd::MulAdd(Load(m.columns[1]),
+		                 Simd::SplatLane<1>(value), result);
+		result =
+		    Simd::MulAdd(Load(m.columns[2]),
+		                 Simd::SplatLane<2>(value), result);
+		result =
+		    Simd::MulAdd(Load(m.columns[3]),
+		                 Simd::SplatLane<3>(value), result);
+		return ToVec4(result);
+	}
+
+	inline Mat4 operator*(const Mat4& a, const Mat4& b)
+	{
+		const auto a0 = Load(a.columns[0]);
+		const auto a1 = Load(a.columns[1]);
+		const auto a2 = Load(a.columns[2]);
+		const auto a3 = Load(a.columns[3]);
+		Mat4 result;
+		for (int i = 0; i < 4; ++i)
+		{
+			const auto column = Load(b.columns[i]);
+			auto value =
+			    Simd::Mul(a0, Simd::SplatLane<0>(column));
+			value = Simd::MulAdd(
+			    a1, Simd::SplatLane<1>(column), value);
+			value = Simd::MulAdd(
+			    a2, Simd::SplatLane<2>(column), value);
+			value = Simd::MulAdd(
+			    a3, Simd::SplatLane<3>(column), value);
+			Simd::Store(&result.columns[i].x, value);
+		}
+		return result;
+	}
+	inline Mat4& operator*=(Mat4& a, const Mat4& b)
+	{
+		return a = a * b;
+	}
+
+	// w = 1.
+	inline Vec3 TransformPoint(const Mat4& m, const Vec3& p)
+	{
+		return (m * Vec4{p.x, p.y, p.z, 1.0f}).Xyz();
+	}
+	// w = 0, so translation is ignored.
+	inline Vec3 TransformVector(const Mat4& m,
+	                            const Vec3& v)
+	{
+		return (m * Vec4{v.x, v.y, v.z, 0.0f}).Xyz();
+	}
+
+	Mat4 Transpose(const Mat4& m);
+	// General inverse; a singular matrix gives the
+	// identity.
+	Mat4 Inverse(const Mat4& m);
+	// For rotations, scales and translations only, much
+	// cheaper than Inverse().
+	Mat4 InverseAffine(const Mat4& m);
+} // namespace AthiVegam::Math
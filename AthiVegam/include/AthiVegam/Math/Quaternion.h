@@ -0,0 +1,62 @@
+#pragma once
+
+#include "AthiVegam/Math/Vector.h"
+
+namespace AthiVegam::Math
+{
+	// Rotation as a unit quaternion (x, y, z, w); the
+	// default is no rotation. Laid out like a Vec4 so it
+	// can be uploaded as a vec4 uniform.
+	struct alignas(16) Quat
+	{
+		float x = 0.0f, y = 0.0f, z = 0.0f, w = 1.0f;
+
+		constexpr bool
+		operator==(const Quat&) const = default;
+	};
+
+	// Radians, about a unit axis.
+	Quat FromAxisAngle(const Vec3& axis, float angle);
+	// Shortest path; t in [0, 1].
+	Quat Slerp(const Quat& a, const Quat& b, float t);
+
+	// Applies b, then a.
+	constexpr Quat operator*(const Quat& a, const Quat& b)
+	{
+		return {
+		    a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		    a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		    a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+		    a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+	}
+	constexpr Quat Conjugate(const Quat& q)
+	{
+		return {-q.x, -q.y, -q.z, q.w};
+	}
+	inline float Dot(const Quat& a, const Quat& b)
+	{
+		return Simd::Sum(
+		    Simd::Mul(Simd::Load(&a.x), Simd::Load(&b.x)));
+	}
+	inline Quat Normalize(const Quat& q)
+	{
+		const auto v = Simd::Load(&q.x);
+		const auto length =
+		    std::sqrt(Simd::Sum(Simd::Mul(v, v)));
+		if (length <= 0.0f)
+		{
+			return {};
+		}
+		Quat result;
+		Simd::Store(&result.x,
+		            Simd::Div(v, Simd::Splat(length)));
+		return result;
+	}
+	constexpr Vec3 Rotate(const Quat& q, const Vec3& v)
+	{
+		// v + 2w(q x v) + 2q x (q x v)
+		const Vec3 axis{q.x, q.y, q.z};
+		const auto t = Cross(axis, v) * 2.0f;
+		return v + t * q.w + Cross(axis, t);
+	}
+} // namespace AthiVegam::Math
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AV_MATH_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define AV_MATH_NEON
+#endif
+
+namespace AthiVegam::Math::Simd
+{
+	// Four floats in one register: SSE2 on x64, NEON on
+	// 64-bit ARM, plain arrays elsewhere. Loads and stores
+	// are unaligned, so any float array can be used.
+#if defined(AV_MATH_SSE2)
+	using Float4 = __m128;
+
+	inline Float4 Load(const float* p)
+	{
+		return _mm_loadu_ps(p);
+	}
+	inline void Store(float* p, Float4 v)
+	{
+		_mm_storeu_ps(p, v);
+	}
+	inline Float4 Splat(float v) { return _mm_set1_ps(v); }
+	inline Float4 Set(float x, float y, float z, float w)
+	{
+		return _mm_setr_ps(x, y, z, w);
+	}
+	inline Float4 Add(Float4 a, Float4 b)
+	{
+		return _mm_add_ps(a, b);
+	}
+	inline Float4 Sub(Float4 a, Float4 b)
+	{
+		return _mm_sub_ps(a, b);
+	}
+	inline Float4 Mul(Float4 a, Float4 b)
+	{
+		return _mm_mul_ps(a, b);
+	}
+	inline Float4 Div(Float4 a, Float4 b)
+	{
+		return _mm_div_ps(a, b);
+	}
+	inline Float4 Min(Float4 a, Float4 b)
+	{
+		return _mm_min_ps(a, b);
+	}
+	inline Float4 Max(Float4 a, Float4 b)
+	{
+		return _mm_max_ps(a, b);
+	}
+	// a * b + c
+	inline Float4 MulAdd(Float4 a, Float4 b, Float4 c)
+	{
+		return _mm_add_ps(_mm_mul_ps(a, b), c);
+	}
+	template <int Lane>
+	inline Float4 SplatLane(Float4 v)
+	{
+		return _mm_shuffle_ps(
+		    v, v, _MM_SHUFFLE(Lane, Lane, Lane, Lane));
+	}
+	inline Float4 Sqrt(Float4 v) { return _mm_sqrt_ps(v); }
+	// v, negated in the lanes where sign is negative.
+	inline Float4 MulSign(Float4 v, Float4 sign)
+	{
+		return _mm_xor_ps(
+		    v, _mm_and_ps(sign, _mm_set1_ps(-0.0f)));
+	}
+	inline float Sum(Float4 v)
+	{
+		const auto pairs =
+		    _mm_add_ps(v, _mm_movehl_ps(v, v));
+		return _mm_cvtss_f32(_mm_add_ss(
+		    pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+	}
+#elif defined(AV_MATH_NEON)
+	using Float4 = float32x4_t;
+
+	inline Float4 Load(const float* p)
+	{
+		return vld1q_f32(p);
+	}
+	inline void Store(float* p, Float4 v)
+	{
+		vst1q_f32(p, v);
+	}
+	inline Float4 Splat(float v) { return vdupq_n_f32(v); }
+	inline Float4 Set(float x, float y, float z, float w)
+	{
+		const float values[4] = {x, y, z, w};
+		return vld1q_f32(values);
+	}
+	inline Float4 Add(Float4 a, Float4 b)
+	{
+		return vaddq_f32(a, b);
+	}
+	inline Float4 Sub(Float4 a, Float4 b)
+	{
+		return vsubq_f32(a, b);
+	}
+	inline Float4 Mul(Float4 a, Float4 b)
+	{
+		return vmulq_f32(a, b);
+	}
+	inline Float4 Div(Float4 a, Float4 b)
+	{
+		return vdivq_f32(a, b);
+	}
+	inline Float4 Min(Float4 a, Float4 b)
+	{
+		return vminq_f32(a, b);
+	}
+	inline Float4 Max(Float4 a, Float4 b)
+	{
+		return vmaxq_f32(a, b);
+	}
+	inline Float4 MulAdd(Float4 a, Float4 b, Float4 c)
+	{
+		return vfmaq_f32(c, a, b);
+	}
+	template <int Lane>
+	inline Float4 SplatLane(Float4 v)
+	{
+		return vdupq_laneq_f32(v, Lane);
+	}
+	inline Float4 Sqrt(Float4 v) { return vsqrtq_f32(v); }
+	inline Float4 MulSign(Float4 v, Float4 sign)
+	{
+		const auto bits = vandq_u32(vreinterpretq_u32_f32(sign),
+		                            vdupq_n_u32(0x80000000u));
+		return vreinterpretq_f32_u32(
+		    veorq_u32(vreinterpretq_u32_f32(v), bits));
+	}
+	inline float Sum(Float4 v) { return vaddvq_f32(v); }
+#else
+	struct Float4
+	{
+		float v[4];
+	};
+
+	inline Float4 Load(const float* p)
+	{
+		return {{p[0], p[1], p[2], p[3]}};
+	}
+	inline void Store(float* p, Float4 v)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			p[i] = v.v[i];
+		}
+	}
+	inline Float4 Splat(float v) { return {{v, v, v, v}}; }
+	inline Float4 Set(float x, float y, float z, float w)
+	{
+		return {{x, y, z, w}};
+	}
+	template <typename Op>
+	inline Float4 Lanewise(Float4 a, Float4 b, Op op)
+	{
+		return {{op(a.v[0], b.v[0]), op(a.v[1], b.v[1]),
+		         op(a.v[2], b.v[2]), op(a.v[3], b.v[3])}};
+	}
+	inline Float4 Add(Float4 a, Float4 b)
+	{
+		return Lanewise(a, b, [](float x, float y) {
+			return x + y;
+		});
+	}
+	inline Float4 Sub(Float4 a, Float4 b)
+	{
+		return Lanewise(a, b, [](float x, float y) {
+			return x - y;
+		});
+	}
+	inline Float4 Mul(Float4 a, Float4 b)
+	{
+		return Lanewise(a, b, [](float x, float y) {
+			return x * y;
+		});
+	}
+	inline Float4 Div(Float4 a, Float4 b)
+	{
+		return Lanewise(a, b, [](float x, float y) {
+			return x / y;
+		});
+	}
+	inline Float4 Min(Float4 a, Float4 b)
+	{
+		return Lanewise(a, b, [](float x, float y) {
+			return y < x ? y : x;
+		});
+	}
+	inline Float4 Max(Float4 a, Float4 b)
+	{
+		return Lanewise(a, b, [](float x, float y) {
+			return x < y ? y : x;
+		});
+	}
+	inline Float4 MulAdd(Float4 a, Float4 b, Float4 c)
+	{
+		return Add(Mul(a, b), c);
+	}
+	template <int Lane>
+	inline Float4 SplatLane(Float4 v)
+	{
+		return Splat(v.v[Lane]);
+	}
+	inline Float4 Sqrt(Float4 v)
+	{
+		return {{std::sqrt(v.v[0]), std::sqrt(v.v[1]),
+		         std::sqrt(v.v[2]), std::sqrt(v.v[3])}};
+	}
+	inline Float4 MulSign(Float4 v, Float4 sign)
+	{
+		return Lanewise(v, sign, [](float x, float y) {
+			return std::signbit(y) ? -x : x;
+		});
+	}
+	inline float Sum(Float4 v)
+	{
+		return (v.v[0] + v.v[1]) + (v.v[2] + v.v[3]);
+	}
+#endif
+} // namespace AthiVegam::Math::Simd
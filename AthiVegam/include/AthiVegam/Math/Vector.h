@@ -0,0 +1,181 @@
+#pragma once
+
+#include "AthiVegam/Math/Simd.h"
+
+#include <cmath>
+
+namespace AthiVegam::Math
+{
+	// Tightly packed, so arrays of Vec3 match vertex
+	// positions. Single vectors are handled in scalar code;
+	// the batch functions in Batch.h process arrays four
+	// lanes at a time.
+	struct Vec3
+	{
+		float x = 0.0f, y = 0.0f, z = 0.0f;
+
+		constexpr bool
+		operator==(const Vec3&) const = default;
+	};
+
+	constexpr Vec3 operator+(const Vec3& a, const Vec3& b)
+	{
+		return {a.x + b.x, a.y + b.y, a.z + b.z};
+	}
+	constexpr Vec3 operator-(const Vec3& a, const Vec3& b)
+	{
+		return {a.x - b.x, a.y - b.y, a.z - b.z};
+	}
+	constexpr Vec3 operator-(const Vec3& v)
+	{
+		return {-v.x, -v.y, -v.z};
+	}
+	constexpr Vec3 operator*(const Vec3& a, const Vec3& b)
+	{
+		return {a.x * b.x, a.y * b.y, a.z * b.z};
+	}
+	constexpr Vec3 operator*(const Vec3& v, float s)
+	{
+		return {v.x * s, v.y * s, v.z * s};
+	}
+	constexpr Vec3 operator*(float s, const Vec3& v)
+	{
+		return v * s;
+	}
+	constexpr Vec3 operator/(const Vec3& v, float s)
+	{
+		return {v.x / s, v.y / s, v.z / s};
+	}
+	constexpr Vec3& operator+=(Vec3& a, const Vec3& b)
+	{
+		return a = a + b;
+	}
+	constexpr Vec3& operator-=(Vec3& a, const Vec3& b)
+	{
+		return a = a - b;
+	}
+	constexpr Vec3& operator*=(Vec3& v, float s)
+	{
+		return v = v * s;
+	}
+
+	constexpr float Dot(const Vec3& a, const Vec3& b)
+	{
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+	constexpr Vec3 Cross(const Vec3& a, const Vec3& b)
+	{
+		return {a.y * b.z - a.z * b.y,
+		        a.z * b.x - a.x * b.z,
+		        a.x * b.y - a.y * b.x};
+	}
+	inline float Length(const Vec3& v)
+	{
+		return std::sqrt(Dot(v, v));
+	}
+	// Zero stays zero.
+	inline Vec3 Normalize(const Vec3& v)
+	{
+		const auto length = Length(v);
+		return length > 0.0f ? v / length : v;
+	}
+	constexpr Vec3 Lerp(const Vec3& a, const Vec3& b,
+	                    float t)
+	{
+		return a + (b - a) * t;
+	}
+	constexpr Vec3 Min(const Vec3& a, const Vec3& b)
+	{
+		return {a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y,
+		        a.z < b.z ? a.z : b.z};
+	}
+	constexpr Vec3 Max(const Vec3& a, const Vec3& b)
+	{
+		return {a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y,
+		        a.z > b.z ? a.z : b.z};
+	}
+
+	// One SIMD register.
+	struct alignas(16) Vec4
+	{
+		float x = 0.0f, y = 0.0f, z = 0.0f, w = 0.0f;
+
+		constexpr Vec3 Xyz() const { return {x, y, z}; }
+		constexpr bool
+		operator==(const Vec4&) const = default;
+	};
+
+	inline Simd::Float4 Load(const Vec4& v)
+	{
+		return Simd::Load(&v.x);
+	}
+	inline Vec4 ToVec4(Simd::Float4 v)
+	{
+		Vec4 result;
+		Simd::Store(&result.x, v);
+		return result;
+	}
+
+	inline Vec4 operator+(const Vec4& a, const Vec4& b)
+	{
+		return ToVec4(Simd::Add(Load(a), Load(b)));
+	}
+	inline Vec4 operator-(const Vec4& a, const Vec4& b)
+	{
+		return ToVec4(Simd::Sub(Load(a), Load(b)));
+	}
+	inline Vec4 operator*(const Vec4& a, const Vec4& b)
+	{
+		return ToVec4(Simd::Mul(Load(a), Load(b)));
+	}
+	inline Vec4 operator*(const Vec4& v, float s)
+	{
+		return ToVec4(
+		    Simd::Mul(Load(v), Simd::Splat(s)));
+	}
+	inline Vec4 operator*(float s, const Vec4& v)
+	{
+		return v * s;
+	}
+	inline Vec4 operator/(const Vec4& v, float s)
+	{
+		return ToVec4(
+		    Simd::Div(Load(v), Simd::Splat(s)));
+	}
+	inline Vec4& operator+=(Vec4& a, const Vec4& b)
+	{
+		return a = a + b;
+	}
+	inline Vec4& operator-=(Vec4& a, const Vec4& b)
+	{
+		return a = a - b;
+	}
+	inline Vec4& operator*=(Vec4& v, float s)
+	{
+		return v = v * s;
+	}
+
+	inline float Dot(const Vec4& a, const Vec4& b)
+	{
+		return Simd::Sum(Simd::Mul(Load(a), Load(b)));
+	}
+	inline float Length(const Vec4& v)
+	{
+		return std::sqrt(Dot(v, v));
+	}
+	inline Vec4 Min(const Vec4& a, const Vec4& b)
+	{
+		return ToVec4(Simd::Min(Load(a), Load(b)));
+	}
+	inline Vec4 Max(const Vec4& a, const Vec4& b)
+	{
+		return ToVec4(Simd::Max(Load(a), Load(b)));
+	}
+	inline Vec4 Lerp(const Vec4& a, const Vec4& b,
+	                 float t)
+	{
+		const auto from = Load(a);
+		return ToVec4(Simd::MulAdd(Simd::Sub(Load(b), from),
+		                           Simd::Splat(t), from));
+	}
+} // namespace AthiVegam::Math
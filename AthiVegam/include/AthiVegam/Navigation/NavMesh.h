@@ -0,0 +1,172 @@
+#pragma once
+
+#include "AthiVegam/Managers/JobManager.h"
+#include "AthiVegam/Math/Vector.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace AthiVegam::Navigation
+{
+	// Where ground agents can stand, built from triangle
+	// geometry, y up. The world's xz plane is split into
+	// square tiles of cells; each cell holds the height of
+	// the highest walkable surface over its centre, or
+	// none where the slope is too steep, there is no
+	// headroom, or it is closer than the agent's radius to
+	// an edge or a step it cannot climb. One surface per
+	// cell, so no floors over floors.
+	//
+	// Adding or removing geometry only marks the tiles it
+	// touches dirty; Update() rebuilds them on job workers
+	// and swaps each in whole once built, so a moving door
+	// costs a few tiles in the background rather than a
+	// rebuild on the main thread. Queries read the tiles
+	// as last swapped in.
+	//
+	// Main thread. Queries may also run on workers, while
+	// nothing calls Update() or changes the geometry, as
+	// within PathService::Update().
+	class NavMesh
+	{
+	  public:
+		struct Settings
+		{
+			// Side of a cell.
+			float cellSize = 0.25f;
+			// Cells along a tile's side.
+			uint32_t tileCells = 64;
+			float agentRadius = 0.4f;
+			float agentHeight = 1.8f;
+			// Highest step between neighbouring cells.
+			float maxClimb = 0.4f;
+			float maxSlopeDegrees = 45.0f;
+			// Tiles building at once.
+			uint32_t maxBuilds = 4;
+		};
+
+		using GeometryId = uint32_t;
+		static constexpr GeometryId InvalidGeometry = ~0u;
+		static constexpr float NoHeight =
+		    std::numeric_limits<float>::lowest();
+
+		// Global cell coordinates.
+		struct Cell
+		{
+			int32_t x = 0;
+			int32_t z = 0;
+
+			constexpr bool
+			operator==(const Cell&) const = default;
+		};
+
+		NavMesh();
+		explicit NavMesh(const Settings& settings);
+		// Waits for the builds in flight.
+		~NavMesh();
+
+		NavMesh(const NavMesh&) = delete;
+		NavMesh& operator=(const NavMesh&) = delete;
+
+		// A triangle list, copied.
+		GeometryId
+		AddGeometry(std::span<const Math::Vec3> vertices,
+		            std::span<const uint32_t> indices);
+		void RemoveGeometry(GeometryId geometry);
+
+		// Installs the tiles built since the last call and
+		// starts building dirty ones. Once per frame, not
+		// during PathService::Update().
+		void Update();
+		// Blocks until every dirty tile is built and
+		// installed, e.g. while loading a level.
+		void Build();
+		inline bool IsBuilding() const
+		{
+			return m_building > 0 || m_dirty > 0;
+		}
+		// Changes whenever a tile is installed, so agents
+		// can tell their paths may be stale.
+		inline uint64_t GetVersion() const
+		{
+			return m_version;
+		}
+		inline const Settings& GetSettings() const
+		{
+			return m_settings;
+		}
+
+		// NoHeight unless the cell is walkable.
+		float GetHeight(Cell cell) const;
+		inline bool IsWalkable(Cell cell) const
+		{
+			return GetHeight(cell) != NoHeight;
+		}
+		// Both walkable, and close enough in height.
+		bool CanStep(Cell from, Cell to) const;
+		Cell GetCell(const Math::Vec3& position) const;
+		// On the surface; the cell must be walkable.
+		Math::Vec3 GetCenter(Cell cell) const;
+		// The walkable cell nearest position within
+		// radius, if any.
+		bool FindNearest(const Math::Vec3& position,
+		                 float radius, Cell& cell) const;
+
+	  private:
+		struct Geometry
+		{
+			std::vector<Math::Vec3> vertices;
+			std::vector<uint32_t> indices;
+			Math::Vec3 min;
+			Math::Vec3 max;
+		};
+
+		// Cells of one tile, row by row along x.
+		struct TileData
+		{
+			std::vector<float> heights;
+		};
+
+		struct Tile
+		{
+			std::shared_ptr<const TileData> data;
+			// Bumped when dirtied, so a build started
+			// before is not installed as current.
+			uint32_t generation = 0;
+			bool dirty = false;
+			bool building = false;
+		};
+
+		struct TileBuild;
+
+		static uint64_t GetKey(int32_t x, int32_t z);
+		// Dirties the tiles whose cells the geometry may
+		// change.
+		void Invalidate(const Geometry& geometry);
+		void StartBuild(uint64_t key, Tile& tile);
+		void Install();
+		// On a worker.
+		static std::shared_ptr<const TileData>
+		BuildTile(const TileBuild& build);
+
+	  private:
+		Settings m_settings;
+		std::vector<std::shared_ptr<const Geometry>>
+		    m_geometry;
+		std::vector<GeometryId> m_freeGeometry;
+		std::unordered_map<uint64_t, Tile> m_tiles;
+		uint32_t m_dirty = 0;
+		uint32_t m_building = 0;
+		uint64_t m_version = 0;
+
+		Managers::JobCounter m_jobs;
+		std::mutex m_mutex;
+		// Built by the workers, for Install().
+		std::vector<std::shared_ptr<TileBuild>> m_built;
+	};
+} // namespace AthiVegam::Navigation
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "AthiVegam/Math/Vector.h"
+#include "AthiVegam/Navigation/NavMesh.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace AthiVegam::Navigation
+{
+	// Paths across a NavMesh for many agents, found in
+	// batches. Gameplay requests a path and gets it by
+	// callback a frame or more later; Update() spreads the
+	// queued searches over the job workers until the
+	// frame's budget is spent and leaves the rest for the
+	// next, so a crowd re-pathing at once costs a bounded
+	// slice of each frame rather than a spike.
+	//
+	// Searches are A* over the mesh's cells, eight ways
+	// without cutting corners, stopping at a node limit
+	// with the path to the nearest node reached. Main
+	// thread.
+	class PathService
+	{
+	  public:
+		struct Settings
+		{
+			// Of wall time per Update(), across workers.
+			float budgetMs = 1.0f;
+			// Nodes one search may expand.
+			uint32_t maxNodes = 8192;
+			// How far start and goal may be from the mesh.
+			float snapRadius = 2.0f;
+		};
+
+		enum class Status : uint8_t
+		{
+			Found,
+			// Towards the goal as far as the node limit, or
+			// as near as it can get.
+			Partial,
+			// Start or goal is off the mesh.
+			NoPath,
+		};
+
+		// The centres of the corner cells, from the start's
+		// cell to the goal's or where the search stopped;
+		// empty for NoPath.
+		using Callback =
+		    std::function<void(Status status,
+		                       std::span<const Math::Vec3> path)>;
+		using RequestId = uint32_t;
+
+		struct Stats
+		{
+			// Of the last Update().
+			uint32_t searched = 0;
+			uint32_t nodesExpanded = 0;
+			double updateMs = 0.0;
+			// Waiting for a later Update().
+			uint32_t queued = 0;
+		};
+
+		explicit PathService(const NavMesh& mesh);
+		PathService(const NavMesh& mesh,
+		            const Settings& settings);
+
+		PathService(const PathService&) = delete;
+		PathService& operator=(const PathService&) = delete;
+
+		RequestId Request(const Math::Vec3& start,
+		                  const Math::Vec3& goal,
+		                  Callback callback);
+		// Drops a request that has not been answered; its
+		// callback is never called.
+		void Cancel(RequestId request);
+
+		// Runs queued searches until the budget is spent,
+		// then calls back the requests answered, in the
+		// order they were made. Once per frame.
+		void Update();
+
+		inline const Stats& GetStats() const
+		{
+			return m_stats;
+		}
+
+	  private:
+		struct Query
+		{
+			RequestId id = 0;
+			Math::Vec3 start;
+			Math::Vec3 goal;
+			Callback callback;
+			// Filled by the worker that searched it.
+			bool searched = false;
+			Status status = Status::NoPath;
+			std::vector<Math::Vec3> path;
+			uint32_t nodesExpanded = 0;
+		};
+
+		// On a worker.
+		void Search(Query& query) const;
+		void RunBatch(
+		    std::chrono::steady_clock::time_point deadline);
+
+	  private:
+		const NavMesh& m_mesh;
+		Settings m_settings;
+		std::deque<Query> m_queue;
+		RequestId m_nextId = 1;
+
+		// The queries of the Update() running, handed out
+		// to the workers by index.
+		std::vector<Query> m_batch;
+		std::atomic<uint32_t> m_nextQuery{0};
+		Stats m_stats;
+	};
+} // namespace AthiVegam::Navigation
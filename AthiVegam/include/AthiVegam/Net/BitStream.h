@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AthiVegam::Net
+{
+	// Bits needed for any value in [0, range].
+	uint32_t BitsRequired(uint32_t range);
+
+	// Packs values of any bit width back to back, least
+	// significant bit first. Running out of room sets the
+	// overflow flag and drops everything after.
+	class BitWriter
+	{
+	  public:
+		BitWriter(uint8_t* data, size_t capacity);
+
+		// bits from 0 to 32; higher bits of value are
+		// ignored.
+		void WriteBits(uint32_t value, uint32_t bits);
+		inline void WriteBool(bool value)
+		{
+			WriteBits(value ? 1 : 0, 1);
+		}
+		// 6 bits up to 15, growing to 34 for large values.
+		void WriteVarUint(uint32_t value);
+		// Starts on a byte boundary.
+		void WriteBytes(const void* data, size_t size);
+		void Align();
+
+		// Pads to a whole byte and returns the bytes written.
+		size_t Finish();
+
+		inline bool HasOverflowed() const
+		{
+			return m_overflowed;
+		}
+		inline size_t GetBitCount() const { return m_bits; }
+
+	  private:
+		uint8_t* m_data;
+		size_t m_capacity;
+		size_t m_bits = 0;
+		size_t m_bytes = 0;
+		uint64_t m_scratch = 0;
+		uint32_t m_scratchBits = 0;
+		bool m_overflowed = false;
+	};
+
+	// Reads what BitWriter wrote. Reading past the end
+	// returns zeros and sets the overflow flag, so callers
+	// can decode a whole message and check once.
+	class BitReader
+	{
+	  public:
+		BitReader(const uint8_t* data, size_t size);
+
+		uint32_t ReadBits(uint32_t bits);
+		inline bool ReadBool() { return ReadBits(1) != 0; }
+		uint32_t ReadVarUint();
+		bool ReadBytes(void* data, size_t size);
+		void Align();
+
+		inline bool HasOverflowed() const
+		{
+			return m_overflowed;
+		}
+		inline size_t GetBitsRemaining() const
+		{
+			return (m_size - m_bytes) * 8 + m_scratchBits;
+		}
+
+	  private:
+		const uint8_t* m_data;
+		size_t m_size;
+		size_t m_bytes = 0;
+		uint64_t m_scratch = 0;
+		uint32_t m_scratchBits = 0;
+		bool m_overflowed = false;
+	};
+} // namespace AthiVegam::Net
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Net
+{
+	enum class Channel : uint8_t
+	{
+		// Sent once, in the next packet; lost with it.
+		Unreliable,
+		// Resent until acknowledged, delivered once and in
+		// order.
+		Reliable
+	};
+
+	// One end of a conversation over UDP, independent of
+	// the socket. Every packet carries its sequence number
+	// and acknowledges the last 33 packets received, so
+	// there are no separate ack packets; reliable messages
+	// ride along in each packet until one carrying them is
+	// acknowledged. Write a packet every tick, even with
+	// nothing queued, to keep acks flowing.
+	class Connection
+	{
+	  public:
+		struct Settings
+		{
+			// Packets without it are ignored.
+			uint32_t protocolId = 0x41564E31;
+			// Under the common 1500-byte MTU, after IP and
+			// UDP headers.
+			uint32_t maxPacketSize = 1200;
+			// Reliable messages wait at least this long, or
+			// 1.25 round trips, before being resent.
+			double resendTime = 0.1;
+		};
+
+		// Reliable messages in flight; Send() fails beyond.
+		static constexpr uint32_t ReliableWindow = 256;
+
+		Connection();
+		explicit Connection(const Settings& settings);
+
+		void Reset();
+
+		// Queues a message for the next packet. Fails for
+		// messages too large for a packet and when the
+		// reliable window is full.
+		bool Send(Channel channel, const void* data,
+		          size_t size);
+		// The next delivered message on the channel.
+		bool Receive(Channel channel, std::vector<uint8_t>& data);
+
+		// Writes the next packet into buffer, at least
+		// Settings::maxPacketSize long, and returns its
+		// size. Unreliable messages that do not fit are
+		// dropped.
+		size_t WritePacket(double time, uint8_t* buffer);
+		// False for foreign, malformed and duplicate
+		// packets.
+		bool ReadPacket(double time, const uint8_t* data,
+		                size_t size);
+
+		// Sequence numbers of sent packets acknowledged by
+		// the last ReadPacket().
+		inline const std::vector<uint16_t>&
+		GetAckedPackets() const
+		{
+			return m_ackedPackets;
+		}
+		// Of the last WritePacket().
+		inline uint16_t GetLastSequence() const
+		{
+			return static_cast<uint16_t>(m_sequence - 1);
+		}
+		inline double GetLastReceiveTime() const
+		{
+			return m_lastReceiveTime;
+		}
+		// Smoothed, in seconds.
+		inline double GetRoundTripTime() const { return m_rtt; }
+		inline uint64_t GetBytesSent() const
+		{
+			return m_bytesSent;
+		}
+		inline uint64_t GetBytesReceived() const
+		{
+			return m_bytesReceived;
+		}
+
+	  private:
+		static constexpr uint32_t PacketHistory = 256;
+		static constexpr uint32_t MaxPacketMessages = 64;
+
+		struct SentPacket
+		{
+			uint16_t sequence = 0;
+			bool acked = true;
+			double time = 0.0;
+			uint32_t messageCount = 0;
+			std::array<uint16_t, MaxPacketMessages> messageIds;
+		};
+
+		struct Message
+		{
+			uint16_t id = 0;
+			bool pending = false;
+			double lastSent = 0.0;
+			std::vector<uint8_t> data;
+		};
+
+		void OnAcked(uint16_t sequence, double time);
+
+	  private:
+		Settings m_settings;
+
+		uint16_t m_sequence = 0;
+		// Newest received, and bit n for receiving
+		// m_remoteSequence - 1 - n.
+		uint16_t m_remoteSequence = 0;
+		uint32_t m_receivedBits = 0;
+		bool m_receivedAny = false;
+		std::vector<SentPacket> m_sentPackets;
+		std::vector<uint16_t> m_ackedPackets;
+
+		// Reliable messages by id % ReliableWindow.
+		std::vector<Message> m_sendQueue;
+		uint16_t m_sendNext = 0;
+		uint16_t m_sendOldest = 0;
+		std::vector<Message> m_receiveQueue;
+		uint16_t m_receiveNext = 0;
+
+		std::vector<std::vector<uint8_t>> m_unreliableSend;
+		size_t m_unreliableSendCount = 0;
+		std::vector<std::vector<uint8_t>> m_unreliableReceived;
+		size_t m_unreliableReceivedCount = 0;
+		size_t m_unreliableRead = 0;
+
+		double m_lastReceiveTime = 0.0;
+		double m_rtt = 0.0;
+		uint64_t m_bytesSent = 0;
+		uint64_t m_bytesReceived = 0;
+	};
+} // namespace AthiVegam::Net
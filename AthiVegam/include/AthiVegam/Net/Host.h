@@ -0,0 +1,113 @@
+#pragma once
+
+#include "AthiVegam/Core/FlatHashMap.h"
+#include "AthiVegam/Net/Connection.h"
+#include "AthiVegam/Net/Socket.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Net
+{
+	// A UDP socket with a Connection per peer. Servers
+	// Listen() and take a peer on its first valid packet;
+	// clients Connect() to one. Peers that go quiet for
+	// Settings::timeout are dropped, which is also how the
+	// other side learns of Disconnect(). Main thread.
+	//
+	// Each tick: Update(), drain PollEvent() and Receive(),
+	// Send(), then Flush().
+	class Host
+	{
+	  public:
+		using PeerId = uint32_t;
+		static constexpr PeerId InvalidPeer = 0xFFFFFFFF;
+
+		struct Settings
+		{
+			Connection::Settings connection;
+			uint32_t maxPeers = 64;
+			// Seconds without a packet.
+			double timeout = 5.0;
+		};
+
+		struct Event
+		{
+			enum class Type : uint8_t
+			{
+				Connected,
+				Disconnected
+			};
+
+			Type type = Type::Connected;
+			PeerId peer = InvalidPeer;
+		};
+
+		Host();
+		explicit Host(const Settings& settings);
+
+		bool Listen(uint16_t port);
+		// Connected once the server answers; Disconnected
+		// if it never does.
+		PeerId Connect(const Address& server, double time);
+		void Disconnect(PeerId peer);
+		void Close();
+
+		// Reads waiting datagrams and drops quiet peers.
+		void Update(double time);
+		bool PollEvent(Event& event);
+
+		bool Send(PeerId peer, Channel channel,
+		          const void* data, size_t size);
+		bool Receive(PeerId peer, Channel channel,
+		             std::vector<uint8_t>& data);
+		// Writes each peer's packet.
+		void Flush(double time);
+
+		inline bool IsConnected(PeerId peer) const
+		{
+			return peer < m_peers.size()
+			       && m_peers[peer].connected;
+		}
+		inline Connection& GetConnection(PeerId peer)
+		{
+			return m_peers[peer].connection;
+		}
+		inline const Address& GetAddress(PeerId peer) const
+		{
+			return m_peers[peer].address;
+		}
+		inline uint16_t GetPort() const
+		{
+			return m_socket.GetPort();
+		}
+
+	  private:
+		struct Peer
+		{
+			Address address;
+			Connection connection;
+			bool active = false;
+			// Has heard from the other side.
+			bool connected = false;
+			double lastReceive = 0.0;
+		};
+
+		PeerId AddPeer(const Address& address);
+		void RemovePeer(PeerId peer, bool notify);
+
+	  private:
+		Settings m_settings;
+		UdpSocket m_socket;
+		bool m_listening = false;
+		double m_time = 0.0;
+
+		std::vector<Peer> m_peers;
+		Core::FlatHashMap<uint64_t, PeerId> m_peerIds;
+		uint32_t m_peerCount = 0;
+
+		std::vector<Event> m_events;
+		size_t m_eventRead = 0;
+		std::vector<uint8_t> m_buffer;
+	};
+} // namespace AthiVegam::Net
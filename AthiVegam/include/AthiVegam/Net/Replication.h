@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Net
+{
+	class BitReader;
+	class BitWriter;
+
+	// The fields of a replicated entity, each quantized to
+	// the fewest bits its range and precision allow.
+	// Entities are replicated as quantized values, so the
+	// server compares and the client rebuilds exactly what
+	// goes on the wire.
+	class SnapshotSchema
+	{
+	  public:
+		// Multiples of precision within [min, max].
+		uint32_t AddFloat(float min, float max, float precision);
+		uint32_t AddInt(int32_t min, int32_t max);
+
+		inline uint32_t GetFieldCount() const
+		{
+			return static_cast<uint32_t>(m_fields.size());
+		}
+		inline uint32_t GetBits(uint32_t field) const
+		{
+			return m_fields[field].bits;
+		}
+
+		// Out of range values are clamped.
+		uint32_t Quantize(uint32_t field, float value) const;
+		float Dequantize(uint32_t field, uint32_t value) const;
+		uint32_t QuantizeInt(uint32_t field, int32_t value) const;
+		int32_t DequantizeInt(uint32_t field,
+		                      uint32_t value) const;
+
+	  private:
+		struct Field
+		{
+			float min = 0.0f;
+			float precision = 1.0f;
+			int32_t intMin = 0;
+			uint32_t maxValue = 0;
+			uint32_t bits = 0;
+		};
+
+		std::vector<Field> m_fields;
+	};
+
+	struct Snapshot
+	{
+		uint16_t sequence = 0;
+		// Ascending.
+		std::vector<uint32_t> ids;
+		// The schema's fields for each entity, in ids order.
+		std::vector<uint32_t> values;
+
+		// Null if absent.
+		const uint32_t* Find(uint32_t id,
+		                     uint32_t fieldCount) const;
+	};
+
+	// Server half. Each tick, SetEntity() what changed,
+	// Capture() once, then Write() for every client and send
+	// it unreliably. Each client is sent the changes since
+	// the newest snapshot it acknowledged: unchanged
+	// entities cost nothing and unchanged fields one bit.
+	// Clients acknowledging the same snapshot share one
+	// encoding, and the history is shared too, so a client
+	// costs a lookup and a copy once the world settles.
+	//
+	// A snapshot must fit one message; raise
+	// Connection::Settings::maxPacketSize for worlds whose
+	// first, full snapshot does not.
+	class ReplicationServer
+	{
+	  public:
+		using ClientId = uint32_t;
+		// Snapshots kept as baselines. Clients that have
+		// acknowledged none of them get full snapshots.
+		static constexpr uint32_t HistorySize = 64;
+
+		explicit ReplicationServer(const SnapshotSchema& schema);
+
+		// values holds the schema's fields, quantized.
+		void SetEntity(uint32_t id, const uint32_t* values);
+		void RemoveEntity(uint32_t id);
+		inline uint32_t GetEntityCount() const
+		{
+			return static_cast<uint32_t>(m_ids.size());
+		}
+
+		// Freezes the entities into the next snapshot and
+		// returns its sequence.
+		uint16_t Capture();
+
+		ClientId AddClient();
+		void RemoveClient(ClientId client);
+		// The client decoded the snapshot, as reported by
+		// ReplicationClient::GetSequence(); later snapshots
+		// are encoded against it.
+		void Acknowledge(ClientId client, uint16_t sequence);
+		// The latest snapshot for the client; returns its
+		// size, or 0 if it does not fit capacity.
+		size_t Write(ClientId client, uint8_t* buffer,
+		             size_t capacity);
+
+	  private:
+		struct Client
+		{
+			bool active = false;
+			bool hasBaseline = false;
+			uint16_t baseline = 0;
+		};
+
+		// One encoding of the latest snapshot.
+		struct Encoding
+		{
+			const Snapshot* baseline = nullptr;
+			size_t offset = 0;
+			size_t size = 0;
+		};
+
+		const Snapshot* FindSnapshot(uint16_t sequence) const;
+		void Encode(const Snapshot* baseline,
+		            const Snapshot& snapshot,
+		            BitWriter& writer) const;
+
+	  private:
+		SnapshotSchema m_schema;
+		std::vector<uint32_t> m_zeros;
+
+		// Ascending, as captured.
+		std::vector<uint32_t> m_ids;
+		std::vector<uint32_t> m_values;
+
+		std::vector<Snapshot> m_history;
+		std::vector<bool> m_captured;
+		uint16_t m_sequence = 0;
+		bool m_hasSnapshot = false;
+
+		std::vector<Client> m_clients;
+		std::vector<Encoding> m_encodings;
+		std::vector<uint8_t> m_encoded;
+	};
+
+	// Client half. Read() each snapshot message and send
+	// GetSequence() back to the server, for it to pass to
+	// ReplicationServer::Acknowledge().
+	class ReplicationClient
+	{
+	  public:
+		explicit ReplicationClient(const SnapshotSchema& schema);
+
+		// False for malformed and stale snapshots, and for
+		// deltas against a snapshot no longer held.
+		bool Read(const uint8_t* data, size_t size);
+
+		inline bool HasSnapshot() const { return m_hasSnapshot; }
+		// The newest snapshot read.
+		inline uint16_t GetSequence() const
+		{
+			return m_sequence;
+		}
+		inline const Snapshot& GetSnapshot() const
+		{
+			return m_history[m_sequence
+			                 % ReplicationServer::HistorySize];
+		}
+		// Quantized values, or null if absent.
+		inline const uint32_t* FindEntity(uint32_t id) const
+		{
+			return GetSnapshot().Find(id,
+			                          m_schema.GetFieldCount());
+		}
+
+	  private:
+		bool Decode(const Snapshot& baseline,
+		            BitReader& reader, Snapshot& snapshot);
+
+	  private:
+		SnapshotSchema m_schema;
+		std::vector<Snapshot> m_history;
+		std::vector<bool> m_received;
+		uint16_t m_sequence = 0;
+		bool m_hasSnapshot = false;
+	};
+} // namespace AthiVegam::Net
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "AthiVegam/Ecs/Registry.h"
+#include "AthiVegam/Ecs/RollbackBuffer.h"
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace AthiVegam::Net
+{
+	// Rollback netcode over an Ecs::Registry, for fighting
+	// and lockstep games with EngineConfig::deterministic.
+	// Each tick the simulation runs at once on the inputs
+	// it has, predicting those that have not arrived by
+	// repeating the player's last. When an input arrives
+	// that differs from its prediction, the next Advance()
+	// restores the registry as it was before that tick and
+	// re-simulates every tick since, several within one
+	// frame, before running the new one.
+	//
+	// Everything the simulation reads and writes must live
+	// in the registry, and the step must depend only on it
+	// and the inputs; see Ecs::RollbackBuffer for what
+	// components may hold. Inputs are fixed-size blobs,
+	// e.g. a struct of buttons and sticks, and every
+	// player's are recorded for the rollback window. Main
+	// thread.
+	class Rollback
+	{
+	  public:
+		struct Settings
+		{
+			uint32_t players = 2;
+			// Bytes of one player's input for one tick.
+			uint32_t inputSize = 8;
+			// Ticks an input may arrive late, or early.
+			uint32_t maxRollback = 8;
+		};
+
+		// One tick of the simulation; inputs holds every
+		// player's, one after another.
+		using Step =
+		    std::function<void(uint64_t tick,
+		                       std::span<const uint8_t> inputs)>;
+
+		struct Stats
+		{
+			// Of the last Advance().
+			uint32_t resimulatedTicks = 0;
+			double restoreMs = 0.0;
+			double resimulateMs = 0.0;
+			// Of the last tick run.
+			double saveMs = 0.0;
+			// Since the start.
+			uint64_t rollbacks = 0;
+		};
+
+		Rollback(Ecs::Registry& registry,
+		         const Settings& settings, Step step);
+
+		Rollback(const Rollback&) = delete;
+		Rollback& operator=(const Rollback&) = delete;
+
+		// A player's input for a tick, local or received.
+		// False if it is outside the rollback window, too
+		// late to be applied: the peers have desynced.
+		bool SetInput(uint32_t player, uint64_t tick,
+		              std::span<const uint8_t> input);
+
+		// Re-simulates from the earliest mispredicted tick,
+		// if any, then runs the current tick and moves on.
+		// Once per App::Update().
+		void Advance();
+
+		// The next tick to run.
+		inline uint64_t GetTick() const { return m_tick; }
+		// Every tick before this had every input.
+		inline uint64_t GetConfirmedTick() const
+		{
+			return m_confirmed;
+		}
+		inline const Stats& GetStats() const
+		{
+			return m_stats;
+		}
+
+	  private:
+		struct Frame
+		{
+			uint64_t tick = Ecs::RollbackBuffer::NoTick;
+			std::vector<uint8_t> inputs;
+			// Per player: received rather than predicted.
+			std::vector<uint8_t> confirmed;
+		};
+
+		// The frame of the tick, cleared for it if it held
+		// another.
+		Frame& GetFrame(uint64_t tick);
+		// Saves the registry and runs the step.
+		void Simulate(uint64_t tick);
+
+	  private:
+		Ecs::Registry& m_registry;
+		Settings m_settings;
+		Step m_step;
+		Ecs::RollbackBuffer m_states;
+		// By tick modulo their count: the rollback window
+		// behind the current tick, the one before it for
+		// predicting, and the window ahead.
+		std::vector<Frame> m_frames;
+
+		uint64_t m_tick = 0;
+		uint64_t m_confirmed = 0;
+		// Earliest tick simulated on a wrong prediction;
+		// NoTick if none.
+		uint64_t m_mispredicted = Ecs::RollbackBuffer::NoTick;
+		Stats m_stats;
+	};
+} // namespace AthiVegam::Net
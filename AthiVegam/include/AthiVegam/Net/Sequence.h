@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+namespace AthiVegam::Net
+{
+	// Whether 16-bit sequence a comes after b, allowing for
+	// wrap around: anything up to half the range ahead is
+	// newer.
+	inline bool IsSequenceNewer(uint16_t a, uint16_t b)
+	{
+		return a != b && static_cast<uint16_t>(a - b) < 0x8000;
+	}
+} // namespace AthiVegam::Net
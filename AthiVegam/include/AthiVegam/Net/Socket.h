@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace AthiVegam::Net
+{
+	// An IPv4 address and port, in host byte order.
+	struct Address
+	{
+		uint32_t host = 0;
+		uint16_t port = 0;
+
+		// "host:port", where host is dotted or a name to
+		// resolve. Blocks while resolving.
+		static bool Parse(const std::string& text,
+		                  Address& address);
+		std::string ToString() const;
+
+		inline uint64_t GetKey() const
+		{
+			return static_cast<uint64_t>(host) << 16 | port;
+		}
+		inline bool operator==(const Address& other) const
+		{
+			return host == other.host && port == other.port;
+		}
+	};
+
+	// Non-blocking UDP socket.
+	class UdpSocket
+	{
+	  public:
+		UdpSocket() = default;
+		~UdpSocket();
+
+		UdpSocket(const UdpSocket&) = delete;
+		UdpSocket& operator=(const UdpSocket&) = delete;
+
+		// Binds to port on all interfaces; 0 picks a free
+		// one.
+		bool Open(uint16_t port = 0);
+		void Close();
+		inline bool IsOpen() const { return m_socket != Invalid; }
+		inline uint16_t GetPort() const { return m_port; }
+
+		bool Send(const Address& to, const uint8_t* data,
+		          size_t size);
+		// Returns the size of the next datagram, or 0 once
+		// none are waiting. Datagrams larger than capacity
+		// are skipped, or truncated on some platforms.
+		size_t Receive(Address& from, uint8_t* buffer,
+		               size_t capacity);
+
+	  private:
+		static constexpr uintptr_t Invalid = ~uintptr_t(0);
+
+		// SOCKET on Windows, a descriptor elsewhere.
+		uintptr_t m_socket = Invalid;
+		uint16_t m_port = 0;
+	};
+} // namespace AthiVegam::Net
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Bounds.h"
+#include "AthiVegam/Math/Quaternion.h"
+#include "AthiVegam/Math/Vector.h"
+
+#include <array>
+#include <cstdint>
+
+namespace AthiVegam::Physics
+{
+	enum class ShapeType : uint8_t
+	{
+		Sphere,
+		Box
+	};
+
+	// A shape placed in the world.
+	struct Shape
+	{
+		ShapeType type = ShapeType::Box;
+		// Sphere: x is the radius. Box: half its size
+		// along each local axis.
+		Math::Vec3 extents{0.5f, 0.5f, 0.5f};
+		Math::Vec3 position;
+		Math::Quat orientation;
+	};
+
+	struct ContactPoint
+	{
+		// Halfway between the two surfaces.
+		Math::Vec3 position;
+		float depth = 0.0f;
+	};
+
+	struct ContactManifold
+	{
+		static constexpr uint32_t MaxPoints = 4;
+
+		// Unit length, from the first shape toward the
+		// second.
+		Math::Vec3 normal;
+		std::array<ContactPoint, MaxPoints> points;
+		uint32_t count = 0;
+	};
+
+	Graphics::Aabb GetBounds(const Shape& shape);
+
+	// Fills manifold if the shapes overlap. Boxes touching
+	// face to face get up to four points, clipped from the
+	// incident face against the reference face, so stacks
+	// rest flat.
+	bool Collide(const Shape& a, const Shape& b,
+	             ContactManifold& manifold);
+} // namespace AthiVegam::Physics
@@ -0,0 +1,308 @@
+#pragma once
+
+#include "AthiVegam/Core/FlatHashMap.h"
+#include "AthiVegam/Math/Matrix.h"
+#include "AthiVegam/Math/Quaternion.h"
+#include "AthiVegam/Math/Vector.h"
+#include "AthiVegam/Physics/Collision.h"
+#include "AthiVegam/Scene/BoundingVolumeTree.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Managers
+{
+	class JobManager;
+}
+
+namespace AthiVegam::Physics
+{
+	struct BodyDesc
+	{
+		ShapeType shape = ShapeType::Box;
+		// See Shape::extents.
+		Math::Vec3 extents{0.5f, 0.5f, 0.5f};
+		Math::Vec3 position;
+		Math::Quat orientation;
+		Math::Vec3 linearVelocity;
+		Math::Vec3 angularVelocity;
+		// 0 makes the body static.
+		float mass = 1.0f;
+		float friction = 0.5f;
+		float restitution = 0.0f;
+	};
+
+	// Rigid bodies stepped at a fixed rate, normally from
+	// Engine's "Physics.Step" update stage. Bodies sit in a
+	// dynamic AABB tree under fattened boxes; pairs whose
+	// boxes overlap persist from step to step, and only
+	// bodies that moved out of their fat box look for new
+	// ones. Each step generates contacts for the pairs,
+	// groups touching bodies into islands and solves each
+	// island on its own with sequential impulses,
+	// warm-started from the pair's last step. Pair finding,
+	// contacts and islands are spread over the job system.
+	// Islands at rest fall asleep and cost nothing until
+	// something wakes them.
+	//
+	// Rendering reads GetInterpolatedTransform() with
+	// App::Render()'s alpha, so bodies move smoothly at any
+	// frame rate. Main thread, or one thread at a time.
+	class PhysicsWorld
+	{
+	  public:
+		using BodyId = uint32_t;
+		static constexpr BodyId InvalidBody = 0xFFFFFFFF;
+
+		struct Settings
+		{
+			Math::Vec3 gravity{0.0f, -9.81f, 0.0f};
+			uint32_t velocityIterations = 10;
+			// Fraction of the penetration pushed out per
+			// step, past slop, which is left so resting
+			// contacts persist.
+			float baumgarte = 0.2f;
+			float slop = 0.01f;
+			// Fraction of the velocity lost per second.
+			float linearDamping = 0.01f;
+			float angularDamping = 0.05f;
+			// An island whose bodies all stay under these
+			// speeds for sleepTime seconds falls asleep.
+			float sleepLinearSpeed = 0.05f;
+			float sleepAngularSpeed = 0.05f;
+			float sleepTime = 0.5f;
+			// Bodies, pairs or islands per job.
+			uint32_t batchSize = 64;
+		};
+
+		PhysicsWorld();
+		explicit PhysicsWorld(const Settings& settings);
+
+		BodyId CreateBody(const BodyDesc& desc);
+		void DestroyBody(BodyId body);
+		void Clear();
+
+		// Advances by deltaTime, normally the fixed tick
+		// length.
+		void Step(float deltaTime);
+		void Step(float deltaTime, Managers::JobManager& jobs);
+
+		// Teleports the body, without interpolating from
+		// where it was.
+		void SetTransform(BodyId body,
+		                  const Math::Vec3& position,
+		                  const Math::Quat& orientation);
+		void SetLinearVelocity(BodyId body,
+		                       const Math::Vec3& velocity);
+		void SetAngularVelocity(BodyId body,
+		                        const Math::Vec3& velocity);
+		// Through the centre of mass, over the next step.
+		void ApplyForce(BodyId body, const Math::Vec3& force);
+		// At a world-space point.
+		void ApplyImpulse(BodyId body,
+		                  const Math::Vec3& impulse,
+		                  const Math::Vec3& point);
+		void WakeUp(BodyId body);
+
+		inline const Math::Vec3& GetPosition(BodyId body) const
+		{
+			return m_bodies[body].shape.position;
+		}
+		inline const Math::Quat&
+		GetOrientation(BodyId body) const
+		{
+			return m_bodies[body].shape.orientation;
+		}
+		inline const Math::Vec3&
+		GetLinearVelocity(BodyId body) const
+		{
+			return m_bodies[body].linearVelocity;
+		}
+		inline const Math::Vec3&
+		GetAngularVelocity(BodyId body) const
+		{
+			return m_bodies[body].angularVelocity;
+		}
+		inline bool IsAwake(BodyId body) const
+		{
+			return m_bodies[body].awake;
+		}
+		// Between the last two steps; alpha as passed to
+		// App::Render().
+		Math::Mat4 GetInterpolatedTransform(BodyId body,
+		                                    float alpha) const;
+
+		inline uint32_t GetBodyCount() const
+		{
+			return m_tree.GetLeafCount();
+		}
+		// As of the last step.
+		inline uint32_t GetAwakeBodyCount() const
+		{
+			return m_awakeBodies;
+		}
+		inline uint32_t GetContactCount() const
+		{
+			return m_contactCount;
+		}
+		inline uint32_t GetIslandCount() const
+		{
+			return static_cast<uint32_t>(
+			    m_islandOffsets.empty()
+			        ? 0
+			        : m_islandOffsets.size() - 1);
+		}
+
+	  private:
+		struct Body
+		{
+			// Also the body's position and orientation.
+			Shape shape;
+			// As of the start of the last step.
+			Math::Vec3 previousPosition;
+			Math::Quat previousOrientation;
+			Math::Vec3 linearVelocity;
+			Math::Vec3 angularVelocity;
+			Math::Vec3 force;
+			float inverseMass = 0.0f;
+			// Of the principal moments, in body space.
+			Math::Vec3 inverseInertia;
+			// The inverse inertia tensor's rows in world
+			// space, as of the current step.
+			Math::Vec3 inverseInertiaRows[3];
+			float friction = 0.5f;
+			float restitution = 0.0f;
+			Graphics::Aabb bounds;
+			Scene::BoundingVolumeTree::LeafId leaf =
+			    Scene::BoundingVolumeTree::NullNode;
+			float restTime = 0.0f;
+			bool awake = true;
+			bool alive = false;
+			// Left its fat box, or was created or teleported,
+			// since the last step: looks for new pairs.
+			bool moved = true;
+
+			inline bool IsDynamic() const
+			{
+				return inverseMass > 0.0f;
+			}
+			inline bool IsActive() const
+			{
+				return inverseMass > 0.0f && awake;
+			}
+		};
+
+		struct Pair
+		{
+			BodyId a;
+			BodyId b;
+		};
+
+		// Solver state of one contact point, per direction
+		// of Contact::directions.
+		struct Point
+		{
+			// Offset from each body's centre crossed with the
+			// direction, and that through the body's inverse
+			// inertia: what an impulse along it does to the
+			// spin.
+			Math::Vec3 armA[3];
+			Math::Vec3 armB[3];
+			Math::Vec3 spinA[3];
+			Math::Vec3 spinB[3];
+			float mass[3] = {};
+			// Separating speed to reach.
+			float bias = 0.0f;
+			// Accumulated over the step.
+			float impulse[3] = {};
+		};
+
+		// A pair of bodies whose fat boxes overlap, a < b.
+		struct Contact
+		{
+			BodyId a = InvalidBody;
+			BodyId b = InvalidBody;
+			ContactManifold manifold;
+			// The manifold's points in a's space, matched
+			// against the next step's to carry impulses
+			// over.
+			std::array<Math::Vec3, ContactManifold::MaxPoints>
+			    anchors;
+			// The normal, then two tangents for friction.
+			Math::Vec3 directions[3];
+			float friction = 0.0f;
+			float restitution = 0.0f;
+			std::array<Point, ContactManifold::MaxPoints> points;
+			// Either body was awake this step; otherwise the
+			// manifold is left as it was.
+			bool active = false;
+
+			inline bool IsTouching() const
+			{
+				return active && manifold.count > 0;
+			}
+		};
+
+		// function(i) for i in [0, count), on the job
+		// system when stepping with one.
+		template <typename F>
+		void ForEach(uint32_t count, uint32_t batchSize,
+		             F&& function);
+
+		void UpdateBroadphase();
+		void FindPairs(uint32_t batch);
+		void UpdatePairs();
+		void RemovePair(uint32_t index);
+		void CollidePair(Contact& contact) const;
+		void BuildIslands();
+		uint32_t FindRoot(uint32_t body);
+		void SolveIsland(uint32_t island, float deltaTime);
+		void PrepareContact(Contact& contact,
+		                    float deltaTime);
+		void SolveContact(Contact& contact);
+		void WakeOverlapping(const Graphics::Aabb& bounds);
+
+		static void SetMass(Body& body, float mass);
+		static Math::Vec3
+		ApplyInverseInertia(const Body& body,
+		                    const Math::Vec3& v);
+		static void UpdateInertia(Body& body);
+		// Closing speed along direction row of a contact.
+		static float GetSpeed(const Body& a, const Body& b,
+		                      const Contact& contact,
+		                      const Point& point, int row);
+		static void ApplyRowImpulse(Body& a, Body& b,
+		                            const Contact& contact,
+		                            const Point& point, int row,
+		                            float impulse);
+
+	  private:
+		Settings m_settings;
+		Managers::JobManager* m_jobs = nullptr;
+
+		std::vector<Body> m_bodies;
+		std::vector<BodyId> m_freeIds;
+		Scene::BoundingVolumeTree m_tree;
+
+		std::vector<Contact> m_contacts;
+		Core::FlatHashMap<uint64_t, uint32_t> m_pairIndices;
+
+		// Per step.
+		std::vector<BodyId> m_moved;
+		std::vector<std::vector<Pair>> m_batchPairs;
+		std::vector<uint32_t> m_parents;
+		// Per union-find root; NoIsland unless it holds an
+		// awake body.
+		std::vector<uint32_t> m_rootIslands;
+		// Bodies and contacts of island i lie in
+		// [offsets[i], offsets[i + 1]).
+		std::vector<uint32_t> m_islandOffsets;
+		std::vector<uint32_t> m_contactOffsets;
+		std::vector<BodyId> m_islandBodies;
+		std::vector<uint32_t> m_islandContacts;
+
+		uint32_t m_awakeBodies = 0;
+		uint32_t m_contactCount = 0;
+	};
+} // namespace AthiVegam::Physics
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Bounds.h"
+#include "AthiVegam/Graphics/Uniform.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Scene
+{
+	// How a node's box relates to a query volume.
+	enum class Overlap : uint8_t
+	{
+		Outside,
+		Partial,
+		// Everything below is reported without testing.
+		Inside
+	};
+
+	// Dynamic AABB tree. Leaves hold boxes enlarged by a
+	// margin, so objects moving within it leave the tree
+	// alone; others are reinserted, refitting their
+	// ancestors on the way up. Leaves are inserted where
+	// they add the least surface area, and rotations keep
+	// the tree balanced, so queries stay logarithmic at
+	// 100k+ leaves. Queries may run on several threads
+	// while nothing modifies the tree.
+	class BoundingVolumeTree
+	{
+	  public:
+		using LeafId = uint32_t;
+		static constexpr LeafId NullNode = 0xFFFFFFFF;
+		static constexpr float DefaultMargin = 0.1f;
+
+		explicit BoundingVolumeTree(
+		    float margin = DefaultMargin);
+
+		// bounds must be finite.
+		LeafId Insert(const Graphics::Aabb& bounds,
+		              uint32_t userData);
+		void Remove(LeafId leaf);
+		// Returns whether the leaf had to be reinserted.
+		bool Move(LeafId leaf, const Graphics::Aabb& bounds);
+		void Clear();
+
+		inline const Graphics::Aabb&
+		GetFatBounds(LeafId leaf) const
+		{
+			return m_nodes[leaf].bounds;
+		}
+		inline uint32_t GetUserData(LeafId leaf) const
+		{
+			return m_nodes[leaf].userData;
+		}
+		inline uint32_t GetLeafCount() const
+		{
+			return m_leafCount;
+		}
+		int GetHeight() const;
+
+		// Calls visit(userData) for every leaf whose fat box
+		// test(const Aabb&) doesn't return Outside.
+		template <typename Test, typename Visit>
+		void Query(Test&& test, Visit&& visit) const;
+
+		// Calls visit(userData, entry) for leaves whose fat
+		// box the ray enters within maxDistance, entry being
+		// the distance along direction to the box. visit
+		// returns the new maxDistance, e.g. entry's hit
+		// distance to find the nearest, or maxDistance to
+		// see every leaf.
+		template <typename Visit>
+		void RayCast(const Graphics::Float3& origin,
+		             const Graphics::Float3& direction,
+		             float maxDistance, Visit&& visit) const;
+
+		// Distance along the ray to where it enters the box
+		// (0 from inside), or a negative value when it
+		// misses within maxDistance.
+		static float
+		RayEntry(const Graphics::Aabb& box,
+		         const Graphics::Float3& origin,
+		         const Graphics::Float3& inverseDirection,
+		         float maxDistance);
+
+	  private:
+		struct Node
+		{
+			Graphics::Aabb bounds;
+			// Next free node while unused.
+			uint32_t parent = NullNode;
+			uint32_t child1 = NullNode;
+			uint32_t child2 = NullNode;
+			// Leaves are 0, free nodes -1.
+			int32_t height = -1;
+			uint32_t userData = 0;
+
+			inline bool IsLeaf() const
+			{
+				return child1 == NullNode;
+			}
+		};
+
+		uint32_t AllocateNode();
+		void FreeNode(uint32_t node);
+		void InsertLeaf(uint32_t leaf);
+		void RemoveLeaf(uint32_t leaf);
+		uint32_t Balance(uint32_t node);
+		// Refits and rebalances from node to the root.
+		void Refit(uint32_t node);
+
+	  private:
+		std::vector<Node> m_nodes;
+		uint32_t m_root = NullNode;
+		uint32_t m_freeList = NullNode;
+		uint32_t m_leafCount = 0;
+		float m_margin;
+
+		// Balanced trees of 2^32 leaves are under 93 levels
+		// deep, and a depth-first stack holds at most one
+		// node per level besides the current one.
+		static constexpr uint32_t MaxStack = 128;
+	};
+
+	template <typename Test, typename Visit>
+	void BoundingVolumeTree::Query(Test&& test,
+	                               Visit&& visit) const
+	{
+		if (m_root == NullNode)
+		{
+			return;
+		}
+
+		// Nodes inside the volume are pushed tagged, so
+		// their subtrees skip the test.
+		constexpr uint32_t InsideBit = 0x80000000;
+		uint32_t stack[MaxStack];
+		uint32_t size = 0;
+		stack[size++] = m_root;
+		while (size > 0)
+		{
+			const auto entry = stack[--size];
+			const auto& node = m_nodes[entry & ~InsideBit];
+
+			auto overlap = Overlap::Inside;
+			if (!(entry & InsideBit))
+			{
+				overlap = test(node.bounds);
+				if (overlap == Overlap::Outside)
+				{
+					continue;
+				}
+			}
+			if (node.IsLeaf())
+			{
+				visit(node.userData);
+				continue;
+			}
+			const auto tag =
+			    overlap == Overlap::Inside ? InsideBit : 0;
+			stack[size++] = node.child1 | tag;
+			stack[size++] = node.child2 | tag;
+		}
+	}
+
+	template <typename Visit>
+	void BoundingVolumeTree::RayCast(
+	    const Graphics::Float3& origin,
+	    const Graphics::Float3& direction, float maxDistance,
+	    Visit&& visit) const
+	{
+		if (m_root == NullNode)
+		{
+			return;
+		}
+
+		// Infinite for axis-parallel rays, which the slab
+		// test handles.
+		const Graphics::Float3 inverse{1.0f / direction.x,
+		                               1.0f / direction.y,
+		                               1.0f / direction.z};
+		uint32_t stack[MaxStack];
+		uint32_t size = 0;
+		stack[size++] = m_root;
+		while (size > 0)
+		{
+			const auto& node = m_nodes[stack[--size]];
+			const auto entry = RayEntry(node.bounds, origin,
+			                            inverse, maxDistance);
+			if (entry < 0.0f)
+			{
+				continue;
+			}
+			if (node.IsLeaf())
+			{
+				maxDistance = std::min(
+				    maxDistance, visit(node.userData, entry));
+				continue;
+			}
+			stack[size++] = node.child1;
+			stack[size++] = node.child2;
+		}
+	}
+} // namespace AthiVegam::Scene
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Graphics/VertexLayout.h"
+#include "AthiVegam/Scene/World.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Managers
+{
+	class ResourceManager;
+}
+
+namespace AthiVegam::Scene
+{
+	// Merges static geometry at load time: pieces sharing
+	// a vertex layout, shader and material are baked into
+	// world space and cut into chunks by a grid, each one
+	// mesh in the shared arena with its own bounds. A
+	// level of many small pieces then culls and draws as
+	// a few large objects.
+	//
+	// Load time, main thread.
+	class StaticBatcher
+	{
+	  public:
+		static constexpr uint32_t NoAttribute = 0xFFFFFFFF;
+
+		struct Options
+		{
+			// Side of the grid cells chunks never span,
+			// in world units.
+			float cellSize = 64.0f;
+			// Cells with more vertices are split; pieces
+			// are never split.
+			uint32_t maxChunkVertices = 65536;
+			// Location of a Float3, Float4 or
+			// Int1010102Norm direction, e.g. the normal,
+			// turned with its piece.
+			uint32_t normalLocation = NoAttribute;
+			// Runs the mesh optimizer over each chunk.
+			bool optimize = false;
+		};
+
+		StaticBatcher();
+		explicit StaticBatcher(const Options& options);
+
+		// Copies a piece of indexed triangles. Positions
+		// must be Float3 or Float4 at location 0; returns
+		// false for anything else, which is left to be
+		// drawn on its own.
+		bool Add(const Graphics::VertexLayout& layout,
+		         const void* vertexData, uint32_t vertexCount,
+		         const uint32_t* elementArray,
+		         uint32_t elementCount,
+		         const Graphics::RenderCommands::
+		             InstanceTransform& transform,
+		         Graphics::ShaderHandle shader,
+		         Graphics::MaterialHandle material = {});
+
+		// Creates the chunk meshes and returns them as
+		// objects with identity transforms, ready for
+		// World::Add(). Forgets the pieces.
+		std::vector<SceneObject>
+		Build(Managers::ResourceManager& resources);
+
+		inline uint32_t GetPieceCount() const
+		{
+			return static_cast<uint32_t>(m_pieces.size());
+		}
+		void Clear();
+
+	  private:
+		struct Piece
+		{
+			// Index of the layout, shader and material.
+			uint32_t group;
+			// Grid cell of the piece's center.
+			int32_t cell[3];
+			uint32_t vertexCount;
+			// World space.
+			std::vector<uint8_t> vertices;
+			std::vector<uint32_t> indices;
+		};
+		struct Group
+		{
+			Graphics::VertexLayout layout;
+			Graphics::ShaderHandle shader;
+			Graphics::MaterialHandle material;
+		};
+
+		uint32_t FindGroup(const Graphics::VertexLayout& layout,
+		                   Graphics::ShaderHandle shader,
+		                   Graphics::MaterialHandle material);
+
+	  private:
+		Options m_options;
+		std::vector<Group> m_groups;
+		std::vector<Piece> m_pieces;
+	};
+} // namespace AthiVegam::Scene
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Bounds.h"
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Graphics/VertexLayout.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	class CommandList;
+	struct Frustum;
+} // namespace AthiVegam::Graphics
+
+namespace AthiVegam::Managers
+{
+	class ResourceManager;
+}
+
+namespace AthiVegam::Scene
+{
+	// A grid of tiles from a texture atlas, drawn as one
+	// static mesh per square chunk of tiles in the shared
+	// arena. Editing a tile only marks its chunk dirty;
+	// Update() rebuilds the dirty chunks, so painting
+	// costs a chunk's rebuild per frame at most, not the
+	// map's. Chunks outside the frustum are never
+	// submitted.
+	//
+	// Tiles lie in the xy plane of the map's transform,
+	// tile (0, 0) at the origin. Main thread, or one
+	// thread at a time.
+	class Tilemap
+	{
+	  public:
+		using Tile = uint16_t;
+		// Draws nothing; tile t draws atlas cell t - 1,
+		// row by row from the top-left.
+		static constexpr Tile EmptyTile = 0;
+
+		struct Options
+		{
+			// In tiles.
+			uint32_t width = 256;
+			uint32_t height = 256;
+			// Side of a chunk in tiles. Up to 128, so a
+			// chunk takes 16-bit indices.
+			uint32_t chunkSize = 32;
+			float tileSize = 1.0f;
+			uint32_t atlasColumns = 16;
+			uint32_t atlasRows = 16;
+			// Shrinks each cell's texture coordinates by
+			// this fraction of it on every side, so
+			// filtering doesn't bleed in neighbours.
+			float atlasInset = 0.0f;
+		};
+
+		// Position Float3 at location 0, texture
+		// coordinates Float2 at location 1.
+		static Graphics::VertexLayout GetLayout();
+
+		Tilemap();
+		explicit Tilemap(const Options& options);
+		~Tilemap();
+
+		Tilemap(const Tilemap&) = delete;
+		Tilemap& operator=(const Tilemap&) = delete;
+
+		// Optional with a material, as in RenderMesh.
+		void SetShader(Graphics::ShaderHandle shader,
+		               Graphics::MaterialHandle material = {});
+		void SetTransform(
+		    const Graphics::RenderCommands::InstanceTransform&
+		        transform);
+
+		// Out of range tiles are ignored, or read empty.
+		void SetTile(uint32_t x, uint32_t y, Tile tile);
+		Tile GetTile(uint32_t x, uint32_t y) const;
+		// A rectangle of tiles, clipped to the map.
+		void Fill(uint32_t x, uint32_t y, uint32_t width,
+		          uint32_t height, Tile tile);
+
+		// Rebuilds up to maxChunks dirty chunks, in the
+		// order they were dirtied, and returns how many.
+		// New meshes upload through ProcessUploads(); a
+		// chunk keeps drawing its previous mesh until then.
+		uint32_t Update(Managers::ResourceManager& resources,
+		                uint32_t maxChunks = 0xFFFFFFFF);
+		// Records the chunks in the frustum, in world
+		// space, into list as RenderMesh commands.
+		void Submit(const Graphics::Frustum& frustum,
+		            Graphics::CommandList& list) const;
+		// Destroys the chunk meshes; the tiles stay, and
+		// the next Update() rebuilds every chunk.
+		void Destroy(Managers::ResourceManager& resources);
+
+		inline const Options& GetOptions() const
+		{
+			return m_options;
+		}
+		inline uint32_t GetChunkCount() const
+		{
+			return static_cast<uint32_t>(m_chunks.size());
+		}
+		inline uint32_t GetDirtyChunkCount() const
+		{
+			return static_cast<uint32_t>(m_dirty.size());
+		}
+
+	  private:
+		struct Chunk
+		{
+			Graphics::MeshHandle mesh;
+			// Rebuilt mesh still uploading.
+			Graphics::MeshHandle pending;
+			// Map space, of mesh and pending.
+			Graphics::Aabb bounds;
+			Graphics::Aabb pendingBounds;
+			// World space, of mesh.
+			Graphics::BoundingSphere sphere;
+			bool dirty = false;
+		};
+
+		void MarkDirty(uint32_t chunkX, uint32_t chunkY);
+		void Rebuild(Managers::ResourceManager& resources,
+		             Chunk& chunk, uint32_t index);
+		void UpdateSphere(Chunk& chunk) const;
+
+	  private:
+		Options m_options;
+		uint32_t m_chunksX = 0;
+		uint32_t m_chunksY = 0;
+		std::vector<Tile> m_tiles;
+		std::vector<Chunk> m_chunks;
+		// Chunk indices, each once.
+		std::vector<uint32_t> m_dirty;
+		std::vector<uint32_t> m_pending;
+
+		Graphics::ShaderHandle m_shader;
+		Graphics::MaterialHandle m_material;
+		Graphics::RenderCommands::InstanceTransform m_transform{
+		    {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}};
+
+		// Reused by Rebuild().
+		std::vector<float> m_vertices;
+		std::vector<uint32_t> m_indices;
+	};
+} // namespace AthiVegam::Scene
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Math/Quaternion.h"
+#include "AthiVegam/Math/Vector.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace AthiVegam::Managers
+{
+	class JobManager;
+}
+
+namespace AthiVegam::Scene
+{
+	// Relative to the parent node.
+	struct LocalTransform
+	{
+		Math::Vec3 position;
+		Math::Quat rotation;
+		Math::Vec3 scale{1.0f, 1.0f, 1.0f};
+	};
+
+	// Parent/child transforms stored in arrays sorted by
+	// depth, so Update() computes world matrices in one
+	// forward pass in which every parent comes before its
+	// children. Only nodes whose local transform was set,
+	// and their descendants, are recomputed; the nodes of
+	// one depth never depend on each other, so a level can
+	// be split across jobs.
+	//
+	// Creating, destroying or reparenting nodes re-sorts
+	// the arrays on the next Update(). Ids are reused after
+	// that Update(). Main thread, or one thread at a time.
+	class TransformHierarchy
+	{
+	  public:
+		using NodeId = uint32_t;
+		static constexpr NodeId InvalidNode = 0xFFFFFFFF;
+		// Column-major, as drawn by RenderMesh.
+		using Matrix =
+		    Graphics::RenderCommands::InstanceTransform;
+
+		// Levels smaller than this are not worth a job.
+		static constexpr uint32_t ParallelBatch = 1024;
+
+		NodeId Create(const LocalTransform& local = {},
+		              NodeId parent = InvalidNode);
+		// The node's descendants are destroyed at the next
+		// Update().
+		void Destroy(NodeId node);
+		void Clear();
+		// Keeps the local transform, so the node moves with
+		// its new parent.
+		void SetParent(NodeId node, NodeId parent);
+		NodeId GetParent(NodeId node) const;
+		bool IsAlive(NodeId node) const;
+
+		void SetLocal(NodeId node,
+		              const LocalTransform& local);
+		const LocalTransform& GetLocal(NodeId node) const;
+		// As of the last Update().
+		const Matrix& GetWorld(NodeId node) const;
+		// Whether the last Update() recomputed the node's
+		// world matrix.
+		bool HasChanged(NodeId node) const;
+		// Calls visit(NodeId, const Matrix&) for every node
+		// the last Update() recomputed, e.g. to forward
+		// them to World::SetTransform().
+		template <typename Visit>
+		void ForEachChanged(Visit&& visit) const
+		{
+			if (!m_anyChanged)
+			{
+				return;
+			}
+			for (size_t i = 0; i < m_nodes.size(); ++i)
+			{
+				if (m_changed[i])
+				{
+					visit(m_nodes[i], m_worlds[i]);
+				}
+			}
+		}
+
+		void Update();
+		// Levels of at least ParallelBatch nodes are spread
+		// over the job system.
+		void Update(Managers::JobManager& jobs);
+
+		// Including nodes destroyed since the last
+		// Update().
+		inline uint32_t GetCount() const
+		{
+			return static_cast<uint32_t>(m_nodes.size());
+		}
+		// Levels as of the last Update().
+		inline uint32_t GetDepth() const
+		{
+			return m_levels.empty()
+			           ? 0
+			           : static_cast<uint32_t>(
+			                 m_levels.size() - 1);
+		}
+
+	  private:
+		static constexpr uint32_t NoParent = 0xFFFFFFFF;
+
+		struct Slot
+		{
+			NodeId parent = InvalidNode;
+			// Into the sorted arrays.
+			uint32_t index = 0;
+			bool alive = false;
+		};
+
+		// Drops destroyed nodes and sorts the rest by depth.
+		void Rebuild();
+		// Returns whether any node is recomputed.
+		bool Prepare();
+		void UpdateNode(uint32_t index);
+
+	  private:
+		std::vector<Slot> m_slots;
+		std::vector<NodeId> m_freeIds;
+
+		// Sorted by depth as of the last Update(); nodes
+		// created since are appended.
+		std::vector<NodeId> m_nodes;
+		std::vector<uint32_t> m_parents;
+		std::vector<LocalTransform> m_locals;
+		std::vector<Matrix> m_worlds;
+		std::vector<uint8_t> m_dirty;
+		std::vector<uint8_t> m_changed;
+		// First index of each depth, then the end.
+		std::vector<uint32_t> m_levels;
+
+		bool m_sorted = true;
+		bool m_anyDirty = false;
+		bool m_anyChanged = false;
+	};
+} // namespace AthiVegam::Scene
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "AthiVegam/Graphics/Bounds.h"
+#include "AthiVegam/Graphics/Culling.h"
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Graphics/Lod.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Scene/BoundingVolumeTree.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	class CommandList;
+	class Impostors;
+}
+
+namespace AthiVegam::Scene
+{
+	struct SceneObject
+	{
+		Graphics::MeshHandle mesh;
+		// Optional with a material, as in RenderMesh.
+		Graphics::ShaderHandle shader;
+		Graphics::MaterialHandle material;
+		Graphics::RenderCommands::InstanceTransform transform{
+		    {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}};
+		// Mesh space, e.g. Mesh::GetBounds(). Infinite
+		// bounds are never culled.
+		Graphics::Aabb bounds = Graphics::Aabb::Infinite();
+		// Coarser levels of mesh, e.g. its
+		// Mesh::GetLods(), picked by the view-projection
+		// Submit().
+		Graphics::LodChain lods;
+	};
+
+	struct RayHit
+	{
+		uint32_t object;
+		// Along the ray's direction, to the object's box.
+		float distance;
+	};
+
+	// The objects an app draws, indexed by their world
+	// boxes in a BoundingVolumeTree, so culling, picking
+	// and streaming ask for what they need instead of
+	// walking every object. Moving an object only touches
+	// the tree when it leaves its leaf's margin.
+	//
+	// Ids are reused after Remove(). Main thread, or one
+	// thread at a time; queries may run concurrently.
+	class World
+	{
+	  public:
+		using ObjectId = uint32_t;
+		static constexpr ObjectId InvalidObject = 0xFFFFFFFF;
+
+		explicit World(float margin =
+		                   BoundingVolumeTree::DefaultMargin);
+
+		ObjectId Add(const SceneObject& object);
+		void Remove(ObjectId object);
+		void Clear();
+		void SetTransform(
+		    ObjectId object,
+		    const Graphics::RenderCommands::InstanceTransform&
+		        transform);
+		// E.g. once an async mesh has loaded.
+		void SetBounds(ObjectId object,
+		               const Graphics::Aabb& bounds);
+
+		const SceneObject& Get(ObjectId object) const;
+		const Graphics::Aabb&
+		GetWorldBounds(ObjectId object) const;
+		inline uint32_t GetCount() const { return m_count; }
+		inline const BoundingVolumeTree& GetTree() const
+		{
+			return m_tree;
+		}
+
+		// Append the objects whose boxes may intersect the
+		// volume.
+		void QueryFrustum(const Graphics::Frustum& frustum,
+		                  std::vector<ObjectId>& objects) const;
+		void QueryRadius(const Graphics::Float3& center,
+		                 float radius,
+		                 std::vector<ObjectId>& objects) const;
+		// Nearest object whose world box the ray enters
+		// within maxDistance; objects with infinite bounds
+		// are never hit.
+		std::optional<RayHit>
+		Raycast(const Graphics::Float3& origin,
+		        const Graphics::Float3& direction,
+		        float maxDistance) const;
+
+		// Records the objects in the frustum into list as
+		// RenderMesh commands with their transforms.
+		void Submit(const Graphics::Frustum& frustum,
+		            Graphics::CommandList& list) const;
+		// Likewise, culling by a column-major
+		// view-projection that also picks each object's
+		// level of detail. Call once per frame for the main
+		// view: hysteresis and cross-fades carry over from
+		// the previous call. While fading, objects draw
+		// with LodFadeConstants, to their shader's
+		// LodFadeShaderSource.
+		void Submit(const float viewProjection[16],
+		            Graphics::CommandList& list,
+		            const Graphics::LodSettings& settings = {});
+
+		// Draws the impostor levels of LodChains with these
+		// impostors from the view-projection Submit(), one
+		// draw per impostor; without, objects stay at their
+		// last mesh. They must outlive the setting.
+		inline void SetImpostors(
+		    const Graphics::Impostors* impostors)
+		{
+			m_impostors = impostors;
+		}
+
+	  private:
+		struct Slot
+		{
+			SceneObject object;
+			Graphics::Aabb worldBounds;
+			BoundingVolumeTree::LeafId leaf =
+			    BoundingVolumeTree::NullNode;
+			bool alive = false;
+			Graphics::LodState lod;
+			// Submit() that last picked the level.
+			uint32_t lodFrame = 0;
+		};
+
+		// Places the object's world box in the tree, or in
+		// the unbounded list.
+		void Place(ObjectId object);
+		void Unplace(ObjectId object);
+		template <typename Visit>
+		void QueryFrustum(const Graphics::Frustum& frustum,
+		                  Visit&& visit) const;
+
+	  private:
+		std::vector<Slot> m_objects;
+		std::vector<ObjectId> m_freeIds;
+		uint32_t m_count = 0;
+		BoundingVolumeTree m_tree;
+		// Objects with infinite bounds, outside the tree
+		// and part of every volume query.
+		std::vector<ObjectId> m_unbounded;
+		// Counts view-projection Submit() calls; objects
+		// missing from the last one snap to their level.
+		uint32_t m_lodFrame = 0;
+
+		struct ImpostorDraw
+		{
+			uint32_t impostor;
+			Graphics::RenderCommands::InstanceTransform
+			    transform;
+		};
+		const Graphics::Impostors* m_impostors = nullptr;
+		// Scratch of Submit().
+		std::vector<ImpostorDraw> m_impostorDraws;
+		std::vector<Graphics::RenderCommands::InstanceTransform>
+		    m_impostorInstances;
+	};
+} // namespace AthiVegam::Scene
@@ -0,0 +1,240 @@
+#pragma once
+
+#include "AthiVegam/Core/Serialize.h"
+#include "AthiVegam/Ecs/Registry.h"
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Math/Vector.h"
+#include "AthiVegam/Navigation/NavMesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace AthiVegam::Ecs
+{
+	class SceneSnapshot;
+}
+
+namespace AthiVegam::Managers
+{
+	class AssetManager;
+	class FileManager;
+} // namespace AthiVegam::Managers
+
+namespace AthiVegam::Scene
+{
+	// Streams an open world in square cells of the xz
+	// plane, y up. Each cell is cooked into a package of
+	// its own: its entities as an Ecs::SceneSnapshot, the
+	// meshes and textures they use and its navigation
+	// geometry. Cells near the camera, or where its
+	// velocity takes it, are read on the FileManager's I/O
+	// threads; once read, a cell's entities are restored
+	// into a registry of its own, its assets requested
+	// from the AssetManager and its geometry added to the
+	// NavMesh. Cells are unloaded only past a wider
+	// radius, so a camera on a border doesn't thrash, and
+	// sooner, farthest first, when the package memory or
+	// the GPU (see Graphics::GpuMemory) is over budget.
+	//
+	// Main thread.
+	class WorldPartition
+	{
+	  public:
+		struct Settings
+		{
+			float cellSize = 128.0f;
+			// Of the cell's square, from the camera or its
+			// predicted position.
+			float loadRadius = 256.0f;
+			float unloadRadius = 384.0f;
+			// How far ahead the velocity is followed.
+			float lookaheadSeconds = 2.0f;
+			// Of the packages loaded and being read.
+			size_t memoryBudget = 256 << 20;
+			uint32_t maxReads = 4;
+			// Cells restored per Update(), each costing
+			// about as much as copying its package.
+			uint32_t maxInstallsPerUpdate = 1;
+			// Formatted with the cell's x and z, read
+			// through the FileManager's mounts.
+			std::string pathFormat =
+			    "world/cell_{}_{}.avcell";
+		};
+
+		struct CellCoord
+		{
+			int32_t x = 0;
+			int32_t z = 0;
+
+			constexpr bool
+			operator==(const CellCoord&) const = default;
+		};
+
+		// A cooked cell, as written by Cook().
+		struct Package
+		{
+			CellCoord coord;
+			// Ecs::SceneSnapshot::Save() data.
+			std::vector<uint8_t> scene;
+			// Assets::AssetIds the entities use.
+			std::vector<uint64_t> meshes;
+			std::vector<uint64_t> textures;
+			// A triangle list.
+			std::vector<Math::Vec3> navVertices;
+			std::vector<uint32_t> navIndices;
+
+			VEGAM_SERIAL_FIELDS(&Package::coord,
+			                    &Package::scene,
+			                    &Package::meshes,
+			                    &Package::textures,
+			                    &Package::navVertices,
+			                    &Package::navIndices)
+		};
+
+		struct LoadedCell
+		{
+			CellCoord coord;
+			Ecs::Registry registry;
+			// In the order of the package's ids; invalid
+			// for ids in no mounted pack.
+			std::vector<Graphics::MeshHandle> meshes;
+			std::vector<Graphics::TextureHandle> textures;
+		};
+
+		// E.g. to add a loaded cell's objects to a World,
+		// and remove them before it goes.
+		using CellCallback = std::function<void(LoadedCell&)>;
+
+		WorldPartition();
+		explicit WorldPartition(const Settings& settings);
+		~WorldPartition();
+
+		WorldPartition(const WorldPartition&) = delete;
+		WorldPartition& operator=(const WorldPartition&) =
+		    delete;
+
+		// The snapshot must have the package's types added,
+		// and, like the managers and the optional NavMesh,
+		// outlive Shutdown(). resolveContext goes to the
+		// snapshot's resolve functions.
+		void Initialize(Managers::FileManager& files,
+		                Managers::AssetManager& assets,
+		                const Ecs::SceneSnapshot& snapshot,
+		                Navigation::NavMesh* navMesh = nullptr,
+		                void* resolveContext = nullptr);
+		// Unloads every cell; reads in flight are ignored
+		// when they finish.
+		void Shutdown();
+
+		inline void SetCallbacks(CellCallback loaded,
+		                         CellCallback unloading)
+		{
+			m_loaded = std::move(loaded);
+			m_unloading = std::move(unloading);
+		}
+
+		// Once per frame, after FileManager::Update().
+		void Update(const Math::Vec3& camera,
+		            const Math::Vec3& velocity);
+
+		CellCoord
+		GetCellCoord(const Math::Vec3& position) const;
+		// nullptr unless loaded.
+		LoadedCell* GetCell(CellCoord coord);
+		inline size_t GetLoadedCount() const
+		{
+			return m_loadedCount;
+		}
+		// Of the packages loaded and being read.
+		inline size_t GetMemoryUsed() const
+		{
+			return m_memoryUsed;
+		}
+		inline uint32_t GetPendingCount() const
+		{
+			return m_reads + m_readyCount;
+		}
+
+		// Writes a package for tools and editors.
+		static void Cook(const Package& package,
+		                 std::vector<uint8_t>& data);
+
+		static constexpr uint32_t SchemaVersion = 1;
+
+	  private:
+		enum class State : uint8_t
+		{
+			// No package at the path.
+			Missing,
+			Reading,
+			// Read, waiting for an install slot.
+			Ready,
+			Loaded
+		};
+
+		struct Cell
+		{
+			CellCoord coord;
+			State state = State::Reading;
+			// Of the read, so that one abandoned with its
+			// cell is ignored when it completes.
+			uint32_t generation = 0;
+			std::shared_ptr<std::vector<uint8_t>> data;
+			size_t bytes = 0;
+			std::unique_ptr<LoadedCell> loaded;
+			// Requested, to release on unload.
+			std::vector<uint64_t> meshIds;
+			std::vector<uint64_t> textureIds;
+			std::vector<Navigation::NavMesh::GeometryId>
+			    navGeometry;
+			// From the camera or its prediction, whichever
+			// is nearer, as of the last Update().
+			float distance = 0.0f;
+		};
+
+		// A cell to read, nearest first.
+		struct Candidate
+		{
+			float distance;
+			CellCoord coord;
+		};
+
+		static uint64_t Key(CellCoord coord);
+		float Distance(CellCoord coord,
+		               const Math::Vec3& position) const;
+		// False, reading nothing, if the package would go
+		// over the memory budget.
+		bool StartRead(CellCoord coord, float distance,
+		               bool force);
+		void OnRead(uint64_t key, uint32_t generation, bool ok);
+		bool Install(Cell& cell);
+		void Unload(Cell& cell);
+
+	  private:
+		Settings m_settings;
+		Managers::FileManager* m_files = nullptr;
+		Managers::AssetManager* m_assets = nullptr;
+		const Ecs::SceneSnapshot* m_snapshot = nullptr;
+		Navigation::NavMesh* m_navMesh = nullptr;
+		void* m_resolveContext = nullptr;
+		CellCallback m_loaded;
+		CellCallback m_unloading;
+
+		std::unordered_map<uint64_t, Cell> m_cells;
+		size_t m_loadedCount = 0;
+		size_t m_memoryUsed = 0;
+		uint32_t m_reads = 0;
+		uint32_t m_readyCount = 0;
+		uint32_t m_nextGeneration = 0;
+		// Read callbacks hold it weakly, to notice when
+		// they outlive Shutdown().
+		std::shared_ptr<WorldPartition*> m_token;
+		// Scratch of Update().
+		std::vector<Candidate> m_candidates;
+	};
+} // namespace AthiVegam::Scene
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "AthiVegam/Core/FlatHashMap.h"
+#include "AthiVegam/Core/StringId.h"
+#include "AthiVegam/Script/Value.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AthiVegam::Script
+{
+	// The engine functions and numeric constants scripts
+	// can name, e.g. "Input.KeyDown" or "Key.Space". Names
+	// are resolved when a program compiles, so a call
+	// costs an indexed function pointer call rather than a
+	// lookup by name, and nothing crosses the boundary but
+	// Values. The part of a name before its last dot is a
+	// namespace scripts cannot use on its own.
+	//
+	// Fill before compiling; then shared, read-only, by
+	// every program compiled against it and every state
+	// running those.
+	class Bindings
+	{
+	  public:
+		struct Native
+		{
+			std::string name;
+			NativeFunction function = nullptr;
+			void* user = nullptr;
+		};
+
+		static constexpr uint32_t NotFound = ~0u;
+
+		// Replaces a native or constant of the same name.
+		void Add(std::string_view name,
+		         NativeFunction function,
+		         void* user = nullptr);
+		void AddConstant(std::string_view name, double value);
+
+		uint32_t FindNative(std::string_view name) const;
+		bool FindConstant(std::string_view name,
+		                  double& value) const;
+		bool IsNamespace(std::string_view name) const;
+
+		inline const Native& GetNative(uint32_t index) const
+		{
+			return m_natives[index];
+		}
+		inline uint32_t GetNativeCount() const
+		{
+			return static_cast<uint32_t>(m_natives.size());
+		}
+
+	  private:
+		using Map = Core::FlatHashMap<Core::StringId, uint32_t,
+		                              Core::StringIdHash>;
+
+		void AddNamespaces(std::string_view name);
+
+	  private:
+		std::vector<Native> m_natives;
+		std::vector<double> m_constantValues;
+		Map m_nativeIndices;
+		Map m_constants;
+		Map m_namespaces;
+	};
+} // namespace AthiVegam::Script
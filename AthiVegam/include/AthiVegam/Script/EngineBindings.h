@@ -0,0 +1,136 @@
+#pragma once
+
+#include "AthiVegam/Ecs/Registry.h"
+#include "AthiVegam/Script/Bindings.h"
+#include "AthiVegam/Script/State.h"
+
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace AthiVegam::Script
+{
+	// Adds the engine's natives and constants:
+	//   Input.Key(key), Input.KeyDown(key), Input.KeyUp(key)
+	//     with Key.A to Key.Z, Key.Num0 to Key.Num9,
+	//     Key.F1 to Key.F12, Key.Space, Key.Return,
+	//     Key.Escape, Key.Tab, Key.Backspace, Key.Left,
+	//     Key.Right, Key.Up, Key.Down, Key.LeftShift,
+	//     Key.LeftCtrl and Key.LeftAlt;
+	//   Debug.Line(x0, y0, z0, x1, y1, z1[, r, g, b]) and
+	//     Debug.Sphere(x, y, z, radius[, r, g, b]);
+	//   Math.Sqrt, Abs, Floor, Ceil, Sin, Cos, Min, Max.
+	// All safe from several states at once.
+	void AddEngineBindings(Bindings& bindings);
+
+	namespace Detail
+	{
+		template <typename>
+		struct FieldTraits;
+
+		template <typename T, typename U>
+		struct FieldTraits<U T::*>
+		{
+			using Component = T;
+			using Type = U;
+		};
+
+		// The component of the entity in args[0], or nullptr
+		// after failing the call.
+		template <typename T>
+		T* GetComponent(State& state,
+		                std::span<const Value> args,
+		                size_t count, void* registry)
+		{
+			if (args.size() != count
+			    || args[0].type != Type::Entity)
+			{
+				state.Error("Expected an entity");
+				return nullptr;
+			}
+			auto* component =
+			    static_cast<Ecs::Registry*>(registry)->Get<T>(
+			        args[0].AsEntity());
+			if (!component)
+			{
+				state.Error("Entity lacks the component");
+			}
+			return component;
+		}
+
+		template <auto Field>
+		Value GetField(State& state, std::span<const Value> args,
+		               void* registry)
+		{
+			using Traits = FieldTraits<decltype(Field)>;
+			const auto* component =
+			    GetComponent<typename Traits::Component>(
+			        state, args, 1, registry);
+			if (!component)
+			{
+				return {};
+			}
+			if constexpr (std::is_same_v<typename Traits::Type,
+			                             bool>)
+			{
+				return Value::FromBoolean(component->*Field);
+			}
+			else
+			{
+				return Value::FromNumber(
+				    static_cast<double>(component->*Field));
+			}
+		}
+
+		template <auto Field>
+		Value SetField(State& state, std::span<const Value> args,
+		               void* registry)
+		{
+			using Traits = FieldTraits<decltype(Field)>;
+			auto* component =
+			    GetComponent<typename Traits::Component>(
+			        state, args, 2, registry);
+			if (!component)
+			{
+				return {};
+			}
+			if constexpr (std::is_same_v<typename Traits::Type,
+			                             bool>)
+			{
+				component->*Field = args[1].IsTrue();
+			}
+			else if (args[1].type == Type::Number)
+			{
+				component->*Field =
+				    static_cast<typename Traits::Type>(
+				        args[1].number);
+			}
+			else
+			{
+				state.Error("Expected a number");
+			}
+			return {};
+		}
+	} // namespace Detail
+
+	// Binds an arithmetic or bool field of a component as
+	// getter(entity) and setter(entity, value), e.g.
+	//   AddComponentField<&Health::points>(
+	//       bindings, "Health.Get", "Health.Set", registry);
+	// Each call is one Registry::Get() with no lookup by
+	// name. Scripts on several states at once may read
+	// fields, but only write their own entities'.
+	template <auto Field>
+	void AddComponentField(Bindings& bindings,
+	                       std::string_view getter,
+	                       std::string_view setter,
+	                       Ecs::Registry& registry)
+	{
+		using FieldType = typename Detail::FieldTraits<
+		    decltype(Field)>::Type;
+		static_assert(std::is_arithmetic_v<FieldType>,
+		              "Only number and bool fields bind");
+		bindings.Add(getter, Detail::GetField<Field>, &registry);
+		bindings.Add(setter, Detail::SetField<Field>, &registry);
+	}
+} // namespace AthiVegam::Script
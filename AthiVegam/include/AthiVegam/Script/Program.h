@@ -0,0 +1,190 @@
+#pragma once
+
+#include "AthiVegam/Core/FlatHashMap.h"
+#include "AthiVegam/Core/StringId.h"
+#include "AthiVegam/Script/Bindings.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AthiVegam::Script
+{
+	// A compiled script: bytecode for a stack machine, and
+	// the constants, functions and global names it uses.
+	// Read-only once compiled, so any number of States,
+	// on any threads, can run one program.
+	//
+	// The language is a subset of Lua: local, global and
+	// nested functions (without upvalues: a function sees
+	// its own locals and the globals), if, while, numeric
+	// for, for k, v in pairs(t), break, return, tables
+	// with . and [] and constructors, and the arithmetic,
+	// comparison, logic and # operators. Strings are the
+	// program's literals; scripts compare and pass them but
+	// cannot build new ones. Names resolve to a local, then
+	// a native or constant of the bindings, then a global,
+	// each global getting a slot at compile time.
+	class Program
+	{
+	  public:
+		// Instructions are 32 bits: the op in the low 8, an
+		// operand in the high 24.
+		enum class Op : uint8_t
+		{
+			Nil,
+			True,
+			False,
+			// Operand: constant, string or function index.
+			Number,
+			String,
+			Function,
+			Pop,
+			// Operand: slot.
+			GetLocal,
+			SetLocal,
+			GetGlobal,
+			SetGlobal,
+			NewTable,
+			// table key -> value.
+			GetIndex,
+			// table key value ->.
+			SetIndex,
+			// table key value -> table, and with the index
+			// as operand, table value -> table.
+			InitIndex,
+			InitArray,
+			Add,
+			Subtract,
+			Multiply,
+			Divide,
+			Modulo,
+			Negate,
+			Not,
+			Length,
+			Equal,
+			NotEqual,
+			Less,
+			LessEqual,
+			Greater,
+			GreaterEqual,
+			// Operand: target, from the function's start.
+			Jump,
+			// Pops the condition.
+			JumpIfFalse,
+			// Jumps keeping the value if false (true), else
+			// pops it: and, or.
+			JumpIfFalseKeep,
+			JumpIfTrueKeep,
+			// Operand: first of the loop's slots: index,
+			// limit, step, variable.
+			ForPrepare,
+			// Pushes whether to go on.
+			ForCheck,
+			ForStep,
+			// Operand: first of the loop's slots: table,
+			// key, k, v. Pushes whether there was another.
+			Next,
+			// Operand: argument count; the function is
+			// under the arguments.
+			Call,
+			// Operand: native index << 8 | argument count.
+			CallNative,
+			Return,
+		};
+
+		struct Function
+		{
+			// Into the code.
+			uint32_t entry = 0;
+			uint32_t parameters = 0;
+			// Locals, parameters first.
+			uint32_t slots = 0;
+			// Deepest the stack grows above the locals.
+			uint32_t stack = 0;
+			// String index, or NoName for the main chunk.
+			uint32_t name = NoName;
+		};
+
+		static constexpr uint32_t NoName = ~0u;
+		static constexpr uint32_t NotFound = ~0u;
+		static constexpr uint32_t MaxOperand = (1u << 24) - 1;
+
+		// name is for messages. Fills error, with the line,
+		// on failure.
+		static bool Compile(std::string_view source,
+		                    std::string_view name,
+		                    const Bindings& bindings,
+		                    Program& program,
+		                    std::string& error);
+
+		uint32_t FindGlobal(std::string_view name) const;
+		// The index of a literal, to pass scripts strings
+		// they can compare with theirs.
+		uint32_t FindString(std::string_view string) const;
+
+		inline const Bindings& GetBindings() const
+		{
+			return *m_bindings;
+		}
+		inline const std::string& GetName() const
+		{
+			return m_name;
+		}
+		inline std::span<const uint32_t> GetCode() const
+		{
+			return m_code;
+		}
+		inline uint32_t GetLine(uint32_t pc) const
+		{
+			return m_lines[pc];
+		}
+		inline double GetNumber(uint32_t index) const
+		{
+			return m_numbers[index];
+		}
+		inline std::string_view GetString(uint32_t index) const
+		{
+			return m_strings[index];
+		}
+		inline const Function& GetFunction(uint32_t index) const
+		{
+			return m_functions[index];
+		}
+		// Function 0 is the main chunk.
+		inline uint32_t GetFunctionCount() const
+		{
+			return static_cast<uint32_t>(m_functions.size());
+		}
+		inline uint32_t GetGlobalCount() const
+		{
+			return static_cast<uint32_t>(m_globalNames.size());
+		}
+		inline std::string_view GetGlobalName(uint32_t slot) const
+		{
+			return m_strings[m_globalNames[slot]];
+		}
+
+	  private:
+		friend class Compiler;
+
+		using Map = Core::FlatHashMap<Core::StringId, uint32_t,
+		                              Core::StringIdHash>;
+
+	  private:
+		const Bindings* m_bindings = nullptr;
+		std::string m_name;
+		std::vector<uint32_t> m_code;
+		// Source line of each instruction.
+		std::vector<uint32_t> m_lines;
+		std::vector<double> m_numbers;
+		std::vector<std::string> m_strings;
+		std::vector<Function> m_functions;
+		// String index of each global's name.
+		std::vector<uint32_t> m_globalNames;
+		Map m_stringIndices;
+		Map m_globals;
+	};
+} // namespace AthiVegam::Script
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "AthiVegam/Core/FlatHashMap.h"
+#include "AthiVegam/Core/Pool.h"
+#include "AthiVegam/Script/Program.h"
+#include "AthiVegam/Script/Value.h"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AthiVegam::Script
+{
+	struct Table
+	{
+		enum class Color : uint8_t
+		{
+			// Not reached yet in this collection.
+			White,
+			// Reached, its entries not yet.
+			Gray,
+			// Reached with its entries.
+			Black,
+		};
+
+		Core::FlatHashMap<Value, Value, ValueHash, ValueEqual>
+		    entries;
+		// Every table of the state, newest first.
+		Table* next = nullptr;
+		Color color = Color::White;
+	};
+
+	// One isolated script world running a program: its own
+	// stack, globals and tables, touched by nothing else,
+	// so separate states may run at once on different
+	// threads (see CallEach()). Calls use a stack and call
+	// frames sized up front and pass arguments and results
+	// as Values, so crossing the boundary either way never
+	// allocates; only creating tables does.
+	//
+	// Tables are freed by an incremental mark and sweep
+	// collector that runs in slices between calls, within
+	// a budget per slice, rather than stopping a frame to
+	// collect everything. Its roots are the globals alone,
+	// as nothing is on the stack between calls. One thread
+	// at a time.
+	class State
+	{
+	  public:
+		struct Settings
+		{
+			// Values, for locals and temporaries of every
+			// call in progress.
+			uint32_t stackSize = 4096;
+			uint32_t maxCalls = 200;
+			// Loop iterations and calls one Call() may
+			// take before it fails, so a runaway script
+			// stops instead of hanging the frame; 0 for no
+			// limit.
+			uint32_t maxSteps = 1'000'000;
+			// A collection starts once the tables number
+			// gcPause times those alive after the last, and
+			// at least gcMinTables.
+			float gcPause = 2.0f;
+			uint32_t gcMinTables = 256;
+		};
+
+		struct Stats
+		{
+			// Since the last ResetStats().
+			uint32_t calls = 0;
+			double callMs = 0.0;
+			double gcMs = 0.0;
+			uint32_t freed = 0;
+			// Now.
+			uint32_t tables = 0;
+		};
+
+		State();
+		explicit State(const Settings& settings);
+		~State();
+
+		State(const State&) = delete;
+		State& operator=(const State&) = delete;
+
+		// Frees everything from the last program and runs
+		// the new one's main chunk, which defines its
+		// functions and globals. The program must outlive
+		// the state or the next Load().
+		bool Load(std::shared_ptr<const Program> program);
+
+		// Calls a global function, or a function value, with
+		// args; stores what it returns in result if given.
+		// On a script error returns false and logs it, with
+		// the line; the globals keep what the call had done.
+		// Not from within a call, e.g. a native.
+		bool Call(std::string_view function,
+		          std::span<const Value> args = {},
+		          Value* result = nullptr);
+		bool Call(const Value& function,
+		          std::span<const Value> args = {},
+		          Value* result = nullptr);
+
+		// Nil if there is no such global.
+		Value GetGlobal(std::string_view name) const;
+		// False if the program never names it.
+		bool SetGlobal(std::string_view name,
+		               const Value& value);
+
+		// A string of the program, e.g. to pass scripts a
+		// name; nil if the program has no such literal.
+		Value FindString(std::string_view string) const;
+		// Empty unless value is a string.
+		std::string_view GetString(const Value& value) const;
+
+		// For natives and the host.
+		Value NewTable();
+		Value Get(const Value& table, const Value& key) const;
+		// Nil removes the key. False if table is not a table
+		// or key is nil or NaN.
+		bool Set(const Value& table, const Value& key,
+		         const Value& value);
+
+		// From a native: fails the call in progress once the
+		// native returns.
+		void Error(std::string_view message);
+		// Of the last failed Load() or Call().
+		inline const std::string& GetError() const
+		{
+			return m_error;
+		}
+
+		// Runs the collector until budgetMs is spent or the
+		// cycle ends; returns at once if none is due. Once
+		// per frame, between calls.
+		void CollectGarbage(float budgetMs);
+		// Finishes the cycle in progress, or runs a whole
+		// one.
+		void CollectAll();
+
+		inline const Stats& GetStats() const { return m_stats; }
+		void ResetStats();
+
+	  private:
+		enum class Phase : uint8_t
+		{
+			Idle,
+			Mark,
+			Sweep,
+		};
+
+		struct Frame
+		{
+			uint32_t function;
+			// Into the function, of the next instruction.
+			uint32_t pc;
+			// Of the function's first local.
+			uint32_t base;
+		};
+
+		void Reset();
+		// Pushes a frame for the function under count
+		// arguments at the top of the stack.
+		bool Enter(uint32_t count);
+		// Until the frame the last Enter() pushed returns.
+		bool Execute();
+		bool Fail(std::string_view message);
+
+		Table* Allocate();
+		bool RawSet(Table& table, const Value& key,
+		            const Value& value);
+		// Write barriers, for stores while marking.
+		inline void Barrier(Table& table, const Value& value)
+		{
+			if (m_phase == Phase::Mark
+			    && table.color == Table::Color::Black
+			    && value.type == Type::Table
+			    && value.table->color == Table::Color::White)
+			{
+				table.color = Table::Color::Gray;
+				m_gray.push_back(&table);
+			}
+		}
+		inline void Shade(const Value& value)
+		{
+			if (value.type == Type::Table
+			    && value.table->color == Table::Color::White)
+			{
+				value.table->color = Table::Color::Gray;
+				m_gray.push_back(value.table);
+			}
+		}
+		// Does a little of the cycle, starting one if idle;
+		// returns how much, or 0 once the cycle ends.
+		uint32_t Step();
+
+	  private:
+		Settings m_settings;
+		std::shared_ptr<const Program> m_program;
+		const uint32_t* m_code = nullptr;
+		std::vector<Value> m_globals;
+		std::vector<Value> m_stack;
+		uint32_t m_top = 0;
+		std::vector<Frame> m_frames;
+		uint32_t m_frameCount = 0;
+		uint32_t m_steps = 0;
+		bool m_failed = false;
+		std::string m_error;
+		Stats m_stats;
+
+		Core::Pool<Table> m_tables;
+		Table* m_objects = nullptr;
+		// Made while sweeping, kept out of the sweep.
+		Table* m_newObjects = nullptr;
+		Table* m_newTail = nullptr;
+		uint32_t m_newCount = 0;
+		Table** m_sweep = nullptr;
+		std::vector<Table*> m_gray;
+		// Keys set to nil, dropped when their table is
+		// marked.
+		std::vector<Value> m_dead;
+		Phase m_phase = Phase::Idle;
+		// Where marking the globals got to.
+		uint32_t m_markedGlobals = 0;
+		uint32_t m_live = 0;
+		uint32_t m_threshold = 0;
+	};
+
+	// Calls function in every state, spread over the job
+	// workers, then runs each one's collector for up to
+	// gcBudgetMs. For many independent scripted objects,
+	// e.g. one state per AI agent. Returns how many calls
+	// failed.
+	uint32_t CallEach(std::span<State* const> states,
+	                  std::string_view function,
+	                  std::span<const Value> args,
+	                  float gcBudgetMs);
+} // namespace AthiVegam::Script
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "AthiVegam/Ecs/Component.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace AthiVegam::Script
+{
+	class State;
+	struct Table;
+
+	enum class Type : uint8_t
+	{
+		Nil,
+		Boolean,
+		Number,
+		// An index into the program's strings.
+		String,
+		Table,
+		// An index into the program's functions.
+		Function,
+		Entity,
+	};
+
+	// A script value: 16 bytes, copied by value across the
+	// boundary, never allocating. Strings and functions
+	// belong to the program; tables belong to the state
+	// that made them and live only while reachable from its
+	// globals, so a table the host keeps past the next
+	// CollectGarbage() must be stored in one.
+	struct Value
+	{
+		Type type = Type::Nil;
+		union
+		{
+			double number = 0.0;
+			bool boolean;
+			uint32_t index;
+			Table* table;
+			uint64_t entity;
+		};
+
+		static inline Value FromBoolean(bool boolean)
+		{
+			Value value;
+			value.type = Type::Boolean;
+			value.boolean = boolean;
+			return value;
+		}
+		static inline Value FromNumber(double number)
+		{
+			Value value;
+			value.type = Type::Number;
+			value.number = number;
+			return value;
+		}
+		static inline Value FromEntity(Ecs::Entity entity)
+		{
+			Value value;
+			value.type = Type::Entity;
+			value.entity =
+			    static_cast<uint64_t>(entity.generation) << 32
+			    | entity.index;
+			return value;
+		}
+
+		inline bool IsNil() const { return type == Type::Nil; }
+		inline bool IsNumber() const
+		{
+			return type == Type::Number;
+		}
+		// Everything but nil and false, as in Lua.
+		inline bool IsTrue() const
+		{
+			return type != Type::Nil
+			       && (type != Type::Boolean || boolean);
+		}
+		inline Ecs::Entity AsEntity() const
+		{
+			return {static_cast<uint32_t>(entity),
+			        static_cast<uint32_t>(entity >> 32)};
+		}
+	};
+
+	// Same type and same number, string, table...; what
+	// table keys and == compare.
+	inline bool RawEqual(const Value& a, const Value& b)
+	{
+		if (a.type != b.type)
+		{
+			return false;
+		}
+		switch (a.type)
+		{
+		case Type::Nil:
+			return true;
+		case Type::Boolean:
+			return a.boolean == b.boolean;
+		case Type::Number:
+			return a.number == b.number;
+		case Type::String:
+		case Type::Function:
+			return a.index == b.index;
+		case Type::Table:
+			return a.table == b.table;
+		case Type::Entity:
+			return a.entity == b.entity;
+		}
+		return false;
+	}
+
+	struct ValueHash
+	{
+		inline size_t operator()(const Value& value) const
+		{
+			uint64_t bits = 0;
+			switch (value.type)
+			{
+			case Type::Nil:
+				break;
+			case Type::Boolean:
+				bits = value.boolean;
+				break;
+			case Type::Number:
+				// -0 and 0 are the same key.
+				bits = std::bit_cast<uint64_t>(
+				    value.number + 0.0);
+				break;
+			case Type::String:
+			case Type::Function:
+				bits = value.index;
+				break;
+			case Type::Table:
+				bits = reinterpret_cast<uintptr_t>(value.table);
+				break;
+			case Type::Entity:
+				bits = value.entity;
+				break;
+			}
+			return static_cast<size_t>(
+			    bits ^ static_cast<uint64_t>(value.type) << 59);
+		}
+	};
+
+	struct ValueEqual
+	{
+		inline bool operator()(const Value& a,
+		                       const Value& b) const
+		{
+			return RawEqual(a, b);
+		}
+	};
+
+	// An engine function scripts call by name. args point
+	// into the script's stack and are only valid during the
+	// call; user is what the binding was added with.
+	// Report bad arguments through State::Error(). Natives
+	// may run on several states at once, from job workers.
+	using NativeFunction = Value (*)(State& state,
+	                                 std::span<const Value> args,
+	                                 void* user);
+
+	// For messages, e.g. "number".
+	const char* GetTypeName(Type type);
+} // namespace AthiVegam::Script
@@ -0,0 +1,216 @@
+#include "AthiVegam/Ai/UpdateScheduler.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace AthiVegam::Ai
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		// Fractional part of the golden ratio: successive
+		// multiples spread evenly over [0, 1).
+		constexpr double Stagger = 0.6180339887498949;
+
+		inline double Milliseconds(Clock::time_point start)
+		{
+			return std::chrono::duration<double, std::milli>(
+			           Clock::now() - start)
+			    .count();
+		}
+	} // namespace
+
+	UpdateScheduler::UpdateScheduler()
+	    : UpdateScheduler(Settings{})
+	{
+	}
+
+	UpdateScheduler::UpdateScheduler(const Settings& settings)
+	    : m_settings(settings)
+	{
+	}
+
+	UpdateScheduler::AgentId
+	UpdateScheduler::Add(const Agent& agent)
+	{
+		VEGAM_ASSERT(agent.frequency > 0.0f,
+		             "Agents need a frequency");
+		AgentId id;
+		if (!m_free.empty())
+		{
+			id = m_free.back();
+			m_free.pop_back();
+		}
+		else
+		{
+			id = static_cast<AgentId>(m_slots.size());
+			m_slots.emplace_back();
+		}
+
+		auto& slot = m_slots[id];
+		slot.agent = agent;
+		slot.alive = true;
+		slot.last = m_time;
+		const auto phase =
+		    std::fmod(Stagger * static_cast<double>(m_added++),
+		              1.0);
+		slot.next = m_time + GetInterval(slot) * phase;
+		++m_count;
+		return id;
+	}
+
+	void UpdateScheduler::Remove(AgentId agent)
+	{
+		if (agent >= m_slots.size() || !m_slots[agent].alive)
+		{
+			return;
+		}
+		m_slots[agent] = {};
+		m_free.push_back(agent);
+		--m_count;
+	}
+
+	void UpdateScheduler::SetPosition(AgentId agent,
+	                                  const Math::Vec3& position)
+	{
+		VEGAM_ASSERT(agent < m_slots.size()
+		                 && m_slots[agent].alive,
+		             "Unknown agent");
+		m_slots[agent].agent.position = position;
+	}
+
+	void UpdateScheduler::SetPriority(AgentId agent,
+	                                  float priority)
+	{
+		VEGAM_ASSERT(agent < m_slots.size()
+		                 && m_slots[agent].alive,
+		             "Unknown agent");
+		m_slots[agent].agent.priority = priority;
+	}
+
+	void UpdateScheduler::Update(float deltaTime)
+	{
+		VEGAM_PROFILE_SCOPE("UpdateScheduler::Update");
+		const auto start = Clock::now();
+		m_time += deltaTime;
+		m_stats = {};
+
+		m_due.clear();
+		m_mainDue.clear();
+		for (AgentId id = 0; id < m_slots.size(); ++id)
+		{
+			const auto& slot = m_slots[id];
+			if (!slot.alive || m_time < slot.next)
+			{
+				continue;
+			}
+			const auto lateness = m_time - slot.next;
+			const auto urgency = static_cast<float>(
+			    lateness / GetInterval(slot)
+			    + slot.agent.priority);
+			(slot.agent.mainThread ? m_mainDue : m_due)
+			    .push_back({urgency, id});
+			m_stats.maxLateness = std::max(
+			    m_stats.maxLateness, static_cast<float>(lateness));
+		}
+		m_stats.due =
+		    static_cast<uint32_t>(m_due.size() + m_mainDue.size());
+		if (m_stats.due == 0)
+		{
+			return;
+		}
+
+		const auto byUrgency = [](const Due& a, const Due& b) {
+			return a.urgency > b.urgency;
+		};
+		std::sort(m_due.begin(), m_due.end(), byUrgency);
+		std::sort(m_mainDue.begin(), m_mainDue.end(), byUrgency);
+
+		const auto deadline =
+		    start
+		    + std::chrono::duration_cast<Clock::duration>(
+		        std::chrono::duration<float, std::milli>(
+		            m_settings.budgetMs));
+		m_next.store(0, std::memory_order_relaxed);
+		m_updated.store(0, std::memory_order_relaxed);
+
+		// The workers take the concurrent agents while
+		// this thread runs the main thread ones, then
+		// helps.
+		auto& jobs = Engine::Instance().GetJobManager();
+		const auto helpers =
+		    std::min<size_t>(jobs.GetWorkerCount(), m_due.size());
+		Managers::JobCounter counter;
+		for (size_t i = 0; i < helpers; ++i)
+		{
+			jobs.Schedule(
+			    [this, deadline] {
+				    RunList(m_due, m_next, deadline);
+			    },
+			    &counter);
+		}
+		if (!m_mainDue.empty())
+		{
+			std::atomic<uint32_t> next{0};
+			RunList(m_mainDue, next, deadline);
+		}
+		if (Clock::now() < deadline || helpers == 0)
+		{
+			RunList(m_due, m_next, deadline);
+		}
+		jobs.Wait(counter);
+
+		m_stats.updated =
+		    m_updated.load(std::memory_order_relaxed);
+		m_stats.updateMs = Milliseconds(start);
+	}
+
+	double UpdateScheduler::GetInterval(const Slot& slot) const
+	{
+		const auto distance =
+		    Math::Length(slot.agent.position - m_viewer);
+		const auto range = std::max(
+		    m_settings.farDistance - m_settings.nearDistance,
+		    1e-3f);
+		const auto t = std::clamp(
+		    (distance - m_settings.nearDistance) / range, 0.0f,
+		    1.0f);
+		const auto scale =
+		    1.0f + (m_settings.minRateScale - 1.0f) * t;
+		return 1.0 / (slot.agent.frequency * scale);
+	}
+
+	void UpdateScheduler::Run(AgentId agent)
+	{
+		auto& slot = m_slots[agent];
+		const auto deltaTime =
+		    static_cast<float>(m_time - slot.last);
+		slot.last = m_time;
+		slot.next = m_time + GetInterval(slot);
+		slot.agent.update(deltaTime);
+		m_updated.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void UpdateScheduler::RunList(const std::vector<Due>& list,
+	                              std::atomic<uint32_t>& next,
+	                              Clock::time_point deadline)
+	{
+		// At least one agent each, so every Update() makes
+		// progress however small the budget.
+		do
+		{
+			const auto index =
+			    next.fetch_add(1, std::memory_order_relaxed);
+			if (index >= list.size())
+			{
+				return;
+			}
+			Run(list[index].agent);
+		} while (Clock::now() < deadline);
+	}
+} // namespace AthiVegam::Ai
@@ -0,0 +1,256 @@
+#include "AthiVegam/Animation/AnimationSystem.h"
+
+#include "AthiVegam/Animation/Clip.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/Skinning.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Managers/JobManager.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace AthiVegam::Animation
+{
+	namespace
+	{
+		float AdvanceTime(const AnimationSystem::Layer& layer,
+		                  float deltaTime)
+		{
+			const auto duration = layer.clip->GetDuration();
+			const auto time =
+			    layer.time + deltaTime * layer.speed;
+			if (duration <= 0.0f)
+			{
+				return 0.0f;
+			}
+			if (!layer.loop)
+			{
+				return std::clamp(time, 0.0f, duration);
+			}
+			const auto wrapped = std::fmod(time, duration);
+			return wrapped < 0.0f ? wrapped + duration
+			                      : wrapped;
+		}
+	} // namespace
+
+	AnimationSystem::AnimationSystem()
+	    : AnimationSystem(Settings{})
+	{
+	}
+
+	AnimationSystem::AnimationSystem(const Settings& settings)
+	    : m_settings(settings)
+	{
+	}
+
+	AnimationSystem::CharacterId
+	AnimationSystem::Create(const Graphics::Skeleton& skeleton)
+	{
+		CharacterId id;
+		if (!m_freeIds.empty())
+		{
+			id = m_freeIds.back();
+			m_freeIds.pop_back();
+		}
+		else
+		{
+			id = static_cast<CharacterId>(m_characters.size());
+			m_characters.emplace_back();
+		}
+
+		auto& character = m_characters[id];
+		const auto boneCount = skeleton.GetBoneCount();
+		character.skeleton = &skeleton;
+		character.layers = {};
+		for (auto& mask : character.masks)
+		{
+			mask.clear();
+		}
+		character.position = {};
+		character.pendingTime = 0.0f;
+		character.interval = 1;
+		character.alive = true;
+		character.evaluated = false;
+		character.pose.Resize(boneCount);
+		character.scratch.Resize(boneCount);
+		character.locals.resize(boneCount);
+		character.palette.assign(boneCount, Math::Mat4{});
+		return id;
+	}
+
+	void AnimationSystem::Destroy(CharacterId character)
+	{
+		VEGAM_ASSERT(character < m_characters.size()
+		                 && m_characters[character].alive,
+		             "Destroying a dead character");
+		m_characters[character].alive = false;
+		m_characters[character].skeleton = nullptr;
+		m_freeIds.push_back(character);
+	}
+
+	void AnimationSystem::SetLayer(CharacterId character,
+	                               uint32_t index,
+	                               const Layer& layer)
+	{
+		VEGAM_ASSERT(index < MaxLayers, "Layer out of range");
+		auto& data = m_characters[character];
+		VEGAM_ASSERT(!layer.clip
+		                 || layer.clip->GetBoneCount()
+		                        == data.pose.GetBoneCount(),
+		             "Clip of another skeleton");
+		data.layers[index] = layer;
+	}
+
+	const AnimationSystem::Layer&
+	AnimationSystem::GetLayer(CharacterId character,
+	                          uint32_t index) const
+	{
+		VEGAM_ASSERT(index < MaxLayers, "Layer out of range");
+		return m_characters[character].layers[index];
+	}
+
+	void AnimationSystem::SetLayerMask(
+	    CharacterId character, uint32_t index,
+	    std::span<const float> boneWeights)
+	{
+		VEGAM_ASSERT(index < MaxLayers, "Layer out of range");
+		auto& data = m_characters[character];
+		auto& mask = data.masks[index];
+		if (boneWeights.empty())
+		{
+			mask.clear();
+			return;
+		}
+		// Padded for Blend(); missing bones blend fully.
+		mask.assign(data.pose.GetPaddedCount(), 1.0f);
+		std::copy_n(boneWeights.begin(),
+		            std::min<size_t>(boneWeights.size(),
+		                             mask.size()),
+		            mask.begin());
+	}
+
+	void AnimationSystem::SetPosition(
+	    CharacterId character, const Math::Vec3& position)
+	{
+		m_characters[character].position = position;
+	}
+
+	void AnimationSystem::Schedule(float deltaTime,
+	                               const Math::Vec3& eye)
+	{
+		++m_frame;
+		m_due.clear();
+		for (CharacterId id = 0; id < m_characters.size();
+		     ++id)
+		{
+			auto& character = m_characters[id];
+			if (!character.alive)
+			{
+				continue;
+			}
+			character.pendingTime += deltaTime;
+
+			const auto distance =
+			    Math::Length(character.position - eye);
+			uint32_t level = 0;
+			for (const auto lodDistance :
+			     m_settings.lodDistances)
+			{
+				level += distance > lodDistance ? 1 : 0;
+			}
+			character.interval = 1u << level;
+			// Ids offset the frames a rate runs on, so
+			// characters sharing it spread over them.
+			if (!character.evaluated
+			    || (m_frame + id) % character.interval == 0)
+			{
+				m_due.push_back(id);
+			}
+		}
+	}
+
+	void AnimationSystem::Evaluate(Character& character) const
+	{
+		auto& pose = character.pose;
+		auto& scratch = character.scratch;
+		for (auto& layer : character.layers)
+		{
+			if (layer.clip)
+			{
+				layer.time =
+				    AdvanceTime(layer, character.pendingTime);
+			}
+		}
+		character.pendingTime = 0.0f;
+
+		const auto& base = character.layers[0];
+		if (base.clip)
+		{
+			base.clip->Sample(base.time, pose);
+		}
+		else
+		{
+			pose.SetIdentity();
+		}
+		for (uint32_t i = 1; i < MaxLayers; ++i)
+		{
+			const auto& layer = character.layers[i];
+			if (!layer.clip || layer.weight <= 0.0f)
+			{
+				continue;
+			}
+			layer.clip->Sample(layer.time, scratch);
+			if (layer.clip->IsAdditive())
+			{
+				AddAdditive(pose, scratch, layer.weight, pose);
+			}
+			else
+			{
+				const auto& mask = character.masks[i];
+				Blend(pose, scratch, layer.weight, pose,
+				      mask.empty() ? nullptr : mask.data());
+			}
+		}
+
+		pose.ToMatrices(character.locals);
+		character.skeleton->ComputePalette(character.locals,
+		                                   character.palette);
+		character.evaluated = true;
+	}
+
+	void AnimationSystem::Update(float deltaTime,
+	                             const Math::Vec3& eye)
+	{
+		VEGAM_PROFILE_SCOPE("AnimationSystem::Update");
+		Schedule(deltaTime, eye);
+		for (const auto id : m_due)
+		{
+			Evaluate(m_characters[id]);
+		}
+	}
+
+	void AnimationSystem::Update(float deltaTime,
+	                             const Math::Vec3& eye,
+	                             Managers::JobManager& jobs)
+	{
+		VEGAM_PROFILE_SCOPE("AnimationSystem::Update");
+		Schedule(deltaTime, eye);
+		jobs.ParallelFor(
+		    static_cast<uint32_t>(m_due.size()),
+		    m_settings.batchSize, [this](uint32_t i) {
+			    Evaluate(m_characters[m_due[i]]);
+		    });
+	}
+
+	std::span<const Math::Mat4>
+	AnimationSystem::GetPalette(CharacterId character) const
+	{
+		return m_characters[character].palette;
+	}
+
+	uint32_t AnimationSystem::GetUpdateInterval(
+	    CharacterId character) const
+	{
+		return m_characters[character].interval;
+	}
+} // namespace AthiVegam::Animation
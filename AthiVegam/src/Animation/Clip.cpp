@@ -0,0 +1,386 @@
+#include "AthiVegam/Animation/Clip.h"
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace AthiVegam::Animation
+{
+	namespace
+	{
+		constexpr float Sqrt2 = 1.41421356f;
+		constexpr float MaxVectorKey = 65535.0f;
+		// Rotation components keep 15 bits; the low bits
+		// hold which component was dropped.
+		constexpr float MaxRotationKey = 32767.0f;
+
+		inline float Component(const Math::Vec3& v, int axis)
+		{
+			return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+		}
+
+		inline float MaxError(const Math::Vec3& a,
+		                      const Math::Vec3& b)
+		{
+			return std::max({std::abs(a.x - b.x),
+			                 std::abs(a.y - b.y),
+			                 std::abs(a.z - b.z)});
+		}
+
+		// Shortest arc, normalized.
+		Math::Quat Nlerp(const Math::Quat& a, Math::Quat b,
+		                 float t)
+		{
+			if (Math::Dot(a, b) < 0.0f)
+			{
+				b = {-b.x, -b.y, -b.z, -b.w};
+			}
+			return Math::Normalize({a.x + (b.x - a.x) * t,
+			                        a.y + (b.y - a.y) * t,
+			                        a.z + (b.z - a.z) * t,
+			                        a.w + (b.w - a.w) * t});
+		}
+
+		// q and -q are the same rotation.
+		float MaxError(const Math::Quat& a, Math::Quat b)
+		{
+			if (Math::Dot(a, b) < 0.0f)
+			{
+				b = {-b.x, -b.y, -b.z, -b.w};
+			}
+			return std::max({std::abs(a.x - b.x),
+			                 std::abs(a.y - b.y),
+			                 std::abs(a.z - b.z),
+			                 std::abs(a.w - b.w)});
+		}
+
+		// Math::Lerp() for rotations.
+		inline Math::Quat Lerp(const Math::Quat& a,
+		                       const Math::Quat& b, float t)
+		{
+			return Nlerp(a, b, t);
+		}
+
+		// Frames to keep so that interpolating between them
+		// reproduces every other within tolerance: each
+		// segment is stretched as far as it still fits.
+		template <typename T>
+		std::vector<uint32_t> ReduceKeys(std::span<const T> values,
+		                                 float tolerance)
+		{
+			const auto count =
+			    static_cast<uint32_t>(values.size());
+			std::vector<uint32_t> keys{0};
+			const auto still = std::all_of(
+			    values.begin(), values.end(),
+			    [&](const T& value) {
+				    return MaxError(values[0], value)
+				           <= tolerance;
+			    });
+			if (still)
+			{
+				return keys;
+			}
+
+			const auto fits = [&](uint32_t start, uint32_t end) {
+				const auto span =
+				    static_cast<float>(end - start);
+				for (auto frame = start + 1; frame < end;
+				     ++frame)
+				{
+					const auto t =
+					    static_cast<float>(frame - start) / span;
+					const auto value = Lerp(values[start],
+					                        values[end], t);
+					if (MaxError(value, values[frame])
+					    > tolerance)
+					{
+						return false;
+					}
+				}
+				return true;
+			};
+			uint32_t start = 0;
+			while (start + 1 < count)
+			{
+				auto end = start + 1;
+				while (end + 1 < count && fits(start, end + 1))
+				{
+					++end;
+				}
+				keys.push_back(end);
+				start = end;
+			}
+			return keys;
+		}
+
+		inline uint16_t Quantize(float value, float max)
+		{
+			return static_cast<uint16_t>(std::lround(
+			    std::clamp(value, 0.0f, 1.0f) * max));
+		}
+
+		// The three smallest components, from
+		// [-1/sqrt(2), 1/sqrt(2)] to 15 bits each, and the
+		// index of the largest, which is made positive and
+		// recomputed from them.
+		void PackRotation(Math::Quat q, uint16_t out[3])
+		{
+			q = Math::Normalize(q);
+			const float components[4] = {q.x, q.y, q.z, q.w};
+			uint32_t largest = 0;
+			for (uint32_t i = 1; i < 4; ++i)
+			{
+				if (std::abs(components[i])
+				    > std::abs(components[largest]))
+				{
+					largest = i;
+				}
+			}
+			const auto sign =
+			    components[largest] < 0.0f ? -1.0f : 1.0f;
+			uint32_t next = 0;
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				if (i == largest)
+				{
+					continue;
+				}
+				const auto unit =
+				    (components[i] * sign * Sqrt2 + 1.0f) * 0.5f;
+				out[next++] = static_cast<uint16_t>(
+				    Quantize(unit, MaxRotationKey) << 1);
+			}
+			out[0] |= static_cast<uint16_t>(largest >> 1);
+			out[1] |= static_cast<uint16_t>(largest & 1);
+		}
+
+		Math::Quat UnpackRotation(const uint16_t in[3])
+		{
+			const auto largest =
+			    static_cast<uint32_t>(((in[0] & 1) << 1)
+			                          | (in[1] & 1));
+			float components[4];
+			auto sum = 0.0f;
+			uint32_t next = 0;
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				if (i == largest)
+				{
+					continue;
+				}
+				const auto unit =
+				    static_cast<float>(in[next++] >> 1)
+				    / MaxRotationKey;
+				components[i] = (unit * 2.0f - 1.0f) / Sqrt2;
+				sum += components[i] * components[i];
+			}
+			components[largest] =
+			    std::sqrt(std::max(0.0f, 1.0f - sum));
+			return {components[0], components[1],
+			        components[2], components[3]};
+		}
+	} // namespace
+
+	Clip::Clip(const RawClip& raw) : Clip(raw, Settings{}) {}
+
+	Clip::Clip(const RawClip& raw, const Settings& settings)
+	    : m_sampleRate(raw.sampleRate),
+	      m_frameCount(raw.frameCount),
+	      m_additive(!settings.additiveReference.empty())
+	{
+		VEGAM_ASSERT(raw.frames.size()
+		                 == size_t{raw.frameCount} * raw.boneCount,
+		             "Raw clip frames don't match its counts");
+		VEGAM_ASSERT(raw.frameCount > 0
+		                 && raw.frameCount <= 65536,
+		             "Clips hold 1 to 65536 frames");
+		VEGAM_ASSERT(!m_additive
+		                 || settings.additiveReference.size()
+		                        >= raw.boneCount,
+		             "Additive reference needs every bone");
+
+		std::vector<Math::Vec3> translations(raw.frameCount);
+		std::vector<Math::Quat> rotations(raw.frameCount);
+		std::vector<Math::Vec3> scales(raw.frameCount);
+		for (uint32_t bone = 0; bone < raw.boneCount; ++bone)
+		{
+			for (uint32_t frame = 0; frame < raw.frameCount;
+			     ++frame)
+			{
+				auto transform =
+				    raw.frames[size_t{frame} * raw.boneCount
+				               + bone];
+				if (m_additive)
+				{
+					const auto& reference =
+					    settings.additiveReference[bone];
+					transform.translation =
+					    transform.translation
+					    - reference.translation;
+					transform.rotation =
+					    Math::Conjugate(reference.rotation)
+					    * transform.rotation;
+					const auto divide = [](float a, float b) {
+						return b != 0.0f ? a / b : 1.0f;
+					};
+					transform.scale = {
+					    divide(transform.scale.x,
+					           reference.scale.x),
+					    divide(transform.scale.y,
+					           reference.scale.y),
+					    divide(transform.scale.z,
+					           reference.scale.z)};
+				}
+				translations[frame] = transform.translation;
+				rotations[frame] = transform.rotation;
+				scales[frame] = transform.scale;
+			}
+			AddVectorTrack(translations,
+			               settings.translationTolerance);
+			AddRotationTrack(rotations,
+			                 settings.rotationTolerance);
+			AddVectorTrack(scales, settings.scaleTolerance);
+		}
+	}
+
+	void Clip::AddVectorTrack(
+	    std::span<const Math::Vec3> values, float tolerance)
+	{
+		const auto keys = ReduceKeys(values, tolerance);
+		Track track;
+		track.firstKey = static_cast<uint32_t>(m_frames.size());
+		track.keyCount = static_cast<uint32_t>(keys.size());
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			auto low = Component(values[keys[0]], axis);
+			auto high = low;
+			for (const auto key : keys)
+			{
+				const auto value = Component(values[key], axis);
+				low = std::min(low, value);
+				high = std::max(high, value);
+			}
+			track.min[axis] = low;
+			track.extent[axis] = high - low;
+		}
+
+		for (const auto key : keys)
+		{
+			PackedKey packed{};
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				if (track.extent[axis] > 0.0f)
+				{
+					packed.values[axis] = Quantize(
+					    (Component(values[key], axis)
+					     - track.min[axis])
+					        / track.extent[axis],
+					    MaxVectorKey);
+				}
+			}
+			m_frames.push_back(static_cast<uint16_t>(key));
+			m_keys.push_back(packed);
+		}
+		m_tracks.push_back(track);
+	}
+
+	void Clip::AddRotationTrack(
+	    std::span<const Math::Quat> values, float tolerance)
+	{
+		const auto keys = ReduceKeys(values, tolerance);
+		Track track;
+		track.firstKey = static_cast<uint32_t>(m_frames.size());
+		track.keyCount = static_cast<uint32_t>(keys.size());
+		for (const auto key : keys)
+		{
+			PackedKey packed{};
+			PackRotation(values[key], packed.values);
+			m_frames.push_back(static_cast<uint16_t>(key));
+			m_keys.push_back(packed);
+		}
+		m_tracks.push_back(track);
+	}
+
+	uint32_t Clip::FindKey(const Track& track,
+	                       float frame) const
+	{
+		const auto begin = m_frames.begin() + track.firstKey;
+		const auto end = begin + track.keyCount;
+		const auto after = std::upper_bound(
+		    begin, end, frame, [](float value, uint16_t key) {
+			    return value < static_cast<float>(key);
+		    });
+		return static_cast<uint32_t>(
+		    std::max(after - 1, begin) - m_frames.begin());
+	}
+
+	Math::Vec3 Clip::SampleVector(const Track& track,
+	                              float frame) const
+	{
+		const auto decode = [&](uint32_t key) {
+			float value[3];
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				value[axis] =
+				    track.min[axis]
+				    + static_cast<float>(
+				          m_keys[key].values[axis])
+				          / MaxVectorKey * track.extent[axis];
+			}
+			return Math::Vec3{value[0], value[1], value[2]};
+		};
+
+		const auto key = FindKey(track, frame);
+		if (key + 1 == track.firstKey + track.keyCount)
+		{
+			return decode(key);
+		}
+		const auto from = static_cast<float>(m_frames[key]);
+		const auto to = static_cast<float>(m_frames[key + 1]);
+		return Lerp(decode(key), decode(key + 1),
+		            (frame - from) / (to - from));
+	}
+
+	Math::Quat Clip::SampleRotation(const Track& track,
+	                                float frame) const
+	{
+		const auto key = FindKey(track, frame);
+		const auto first = UnpackRotation(m_keys[key].values);
+		if (key + 1 == track.firstKey + track.keyCount)
+		{
+			return first;
+		}
+		const auto from = static_cast<float>(m_frames[key]);
+		const auto to = static_cast<float>(m_frames[key + 1]);
+		return Nlerp(first,
+		             UnpackRotation(m_keys[key + 1].values),
+		             (frame - from) / (to - from));
+	}
+
+	void Clip::Sample(float time, Pose& out) const
+	{
+		const auto boneCount = GetBoneCount();
+		VEGAM_ASSERT(out.GetBoneCount() == boneCount,
+		             "Sampling a clip of another skeleton");
+		const auto frame = std::clamp(
+		    time * m_sampleRate, 0.0f,
+		    static_cast<float>(m_frameCount - 1));
+		for (uint32_t bone = 0; bone < boneCount; ++bone)
+		{
+			const auto* tracks = &m_tracks[size_t{bone} * 3];
+			out.Set(bone, {SampleVector(tracks[0], frame),
+			               SampleRotation(tracks[1], frame),
+			               SampleVector(tracks[2], frame)});
+		}
+	}
+
+	size_t Clip::GetSize() const
+	{
+		return m_tracks.size() * sizeof(Track)
+		       + m_frames.size() * sizeof(uint16_t)
+		       + m_keys.size() * sizeof(PackedKey);
+	}
+} // namespace AthiVegam::Animation
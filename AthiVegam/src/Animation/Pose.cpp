@@ -0,0 +1,276 @@
+#include "AthiVegam/Animation/Pose.h"
+
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Math/Simd.h"
+
+#include <algorithm>
+
+namespace AthiVegam::Animation
+{
+	namespace
+	{
+		using Float4 = Math::Simd::Float4;
+		namespace S = Math::Simd;
+
+		// Four bones' rotations, one component per register.
+		struct Quat4
+		{
+			Float4 x, y, z, w;
+		};
+
+		inline Quat4 LoadRotations(const Pose& pose, size_t i)
+		{
+			return {S::Load(pose.GetStream(Pose::RotationX) + i),
+			        S::Load(pose.GetStream(Pose::RotationY) + i),
+			        S::Load(pose.GetStream(Pose::RotationZ) + i),
+			        S::Load(pose.GetStream(Pose::RotationW) + i)};
+		}
+
+		inline void StoreRotations(Pose& pose, size_t i,
+		                           const Quat4& q)
+		{
+			S::Store(pose.GetStream(Pose::RotationX) + i, q.x);
+			S::Store(pose.GetStream(Pose::RotationY) + i, q.y);
+			S::Store(pose.GetStream(Pose::RotationZ) + i, q.z);
+			S::Store(pose.GetStream(Pose::RotationW) + i, q.w);
+		}
+
+		// a towards b by t, on the shorter arc, normalized.
+		inline Quat4 Nlerp(const Quat4& a, Quat4 b, Float4 t)
+		{
+			auto dot = S::Mul(a.x, b.x);
+			dot = S::MulAdd(a.y, b.y, dot);
+			dot = S::MulAdd(a.z, b.z, dot);
+			dot = S::MulAdd(a.w, b.w, dot);
+			b = {S::MulSign(b.x, dot), S::MulSign(b.y, dot),
+			     S::MulSign(b.z, dot), S::MulSign(b.w, dot)};
+
+			Quat4 r{S::MulAdd(S::Sub(b.x, a.x), t, a.x),
+			        S::MulAdd(S::Sub(b.y, a.y), t, a.y),
+			        S::MulAdd(S::Sub(b.z, a.z), t, a.z),
+			        S::MulAdd(S::Sub(b.w, a.w), t, a.w)};
+			auto length = S::Mul(r.x, r.x);
+			length = S::MulAdd(r.y, r.y, length);
+			length = S::MulAdd(r.z, r.z, length);
+			length = S::MulAdd(r.w, r.w, length);
+			const auto inverse =
+			    S::Div(S::Splat(1.0f), S::Sqrt(length));
+			return {S::Mul(r.x, inverse), S::Mul(r.y, inverse),
+			        S::Mul(r.z, inverse), S::Mul(r.w, inverse)};
+		}
+
+		// Applies b, then a, as Math::Quat's operator*.
+		inline Quat4 Multiply(const Quat4& a, const Quat4& b)
+		{
+			auto x = S::Mul(a.w, b.x);
+			x = S::MulAdd(a.x, b.w, x);
+			x = S::MulAdd(a.y, b.z, x);
+			x = S::Sub(x, S::Mul(a.z, b.y));
+			auto y = S::Mul(a.w, b.y);
+			y = S::Sub(y, S::Mul(a.x, b.z));
+			y = S::MulAdd(a.y, b.w, y);
+			y = S::MulAdd(a.z, b.x, y);
+			auto z = S::Mul(a.w, b.z);
+			z = S::MulAdd(a.x, b.y, z);
+			z = S::Sub(z, S::Mul(a.y, b.x));
+			z = S::MulAdd(a.z, b.w, z);
+			auto w = S::Mul(a.w, b.w);
+			w = S::Sub(w, S::Mul(a.x, b.x));
+			w = S::Sub(w, S::Mul(a.y, b.y));
+			w = S::Sub(w, S::Mul(a.z, b.z));
+			return {x, y, z, w};
+		}
+
+		constexpr Pose::Stream VectorStreams[] = {
+		    Pose::TranslationX, Pose::TranslationY,
+		    Pose::TranslationZ, Pose::ScaleX,
+		    Pose::ScaleY,       Pose::ScaleZ};
+	} // namespace
+
+	Pose::Pose(uint32_t boneCount) { Resize(boneCount); }
+
+	void Pose::Resize(uint32_t boneCount)
+	{
+		m_boneCount = boneCount;
+		m_paddedCount = (boneCount + 3) & ~3u;
+		m_data.resize(size_t{StreamCount} * m_paddedCount);
+		SetIdentity();
+	}
+
+	void Pose::SetIdentity()
+	{
+		for (uint32_t stream = 0; stream < StreamCount;
+		     ++stream)
+		{
+			const auto one = stream == RotationW
+			                 || stream >= ScaleX;
+			std::fill_n(GetStream(static_cast<Stream>(stream)),
+			            m_paddedCount, one ? 1.0f : 0.0f);
+		}
+	}
+
+	void Pose::Set(uint32_t bone, const Transform& transform)
+	{
+		VEGAM_ASSERT(bone < m_boneCount, "Bone out of range");
+		const float values[StreamCount] = {
+		    transform.translation.x, transform.translation.y,
+		    transform.translation.z, transform.rotation.x,
+		    transform.rotation.y,    transform.rotation.z,
+		    transform.rotation.w,    transform.scale.x,
+		    transform.scale.y,       transform.scale.z};
+		for (uint32_t stream = 0; stream < StreamCount;
+		     ++stream)
+		{
+			GetStream(static_cast<Stream>(stream))[bone] =
+			    values[stream];
+		}
+	}
+
+	Transform Pose::Get(uint32_t bone) const
+	{
+		VEGAM_ASSERT(bone < m_boneCount, "Bone out of range");
+		const auto at = [&](Stream stream) {
+			return GetStream(stream)[bone];
+		};
+		return {{at(TranslationX), at(TranslationY),
+		         at(TranslationZ)},
+		        {at(RotationX), at(RotationY), at(RotationZ),
+		         at(RotationW)},
+		        {at(ScaleX), at(ScaleY), at(ScaleZ)}};
+	}
+
+	void Pose::ToMatrices(std::span<Math::Mat4> out) const
+	{
+		VEGAM_ASSERT(out.size() >= m_boneCount,
+		             "Too few matrices for the pose");
+		const auto two = S::Splat(2.0f);
+		const auto one = S::Splat(1.0f);
+		for (uint32_t i = 0; i < m_boneCount; i += 4)
+		{
+			const auto q = LoadRotations(*this, i);
+			const auto x2 = S::Mul(q.x, two);
+			const auto y2 = S::Mul(q.y, two);
+			const auto z2 = S::Mul(q.z, two);
+			const auto xx = S::Mul(q.x, x2);
+			const auto yy = S::Mul(q.y, y2);
+			const auto zz = S::Mul(q.z, z2);
+			const auto xy = S::Mul(q.x, y2);
+			const auto xz = S::Mul(q.x, z2);
+			const auto yz = S::Mul(q.y, z2);
+			const auto wx = S::Mul(q.w, x2);
+			const auto wy = S::Mul(q.w, y2);
+			const auto wz = S::Mul(q.w, z2);
+
+			const auto sx = S::Load(GetStream(ScaleX) + i);
+			const auto sy = S::Load(GetStream(ScaleY) + i);
+			const auto sz = S::Load(GetStream(ScaleZ) + i);
+			// Column-major upper 3x3, each column scaled.
+			const Float4 entries[12] = {
+			    S::Mul(S::Sub(one, S::Add(yy, zz)), sx),
+			    S::Mul(S::Add(xy, wz), sx),
+			    S::Mul(S::Sub(xz, wy), sx),
+			    S::Mul(S::Sub(xy, wz), sy),
+			    S::Mul(S::Sub(one, S::Add(xx, zz)), sy),
+			    S::Mul(S::Add(yz, wx), sy),
+			    S::Mul(S::Add(xz, wy), sz),
+			    S::Mul(S::Sub(yz, wx), sz),
+			    S::Mul(S::Sub(one, S::Add(xx, yy)), sz),
+			    S::Load(GetStream(TranslationX) + i),
+			    S::Load(GetStream(TranslationY) + i),
+			    S::Load(GetStream(TranslationZ) + i)};
+
+			// Back to one matrix per bone.
+			float lanes[12][4];
+			for (int e = 0; e < 12; ++e)
+			{
+				S::Store(lanes[e], entries[e]);
+			}
+			const auto count = std::min(4u, m_boneCount - i);
+			for (uint32_t lane = 0; lane < count; ++lane)
+			{
+				auto& m = out[i + lane];
+				for (int c = 0; c < 4; ++c)
+				{
+					m.columns[c] = {lanes[c * 3][lane],
+					                lanes[c * 3 + 1][lane],
+					                lanes[c * 3 + 2][lane],
+					                c == 3 ? 1.0f : 0.0f};
+				}
+			}
+		}
+	}
+
+	void Blend(const Pose& a, const Pose& b, float weight,
+	           Pose& out, const float* mask)
+	{
+		VEGAM_ASSERT(a.GetBoneCount() == b.GetBoneCount()
+		                 && a.GetBoneCount()
+		                        == out.GetBoneCount(),
+		             "Blending poses of different skeletons");
+		const auto count = a.GetPaddedCount();
+		const auto splat = S::Splat(weight);
+		for (uint32_t i = 0; i < count; i += 4)
+		{
+			const auto t =
+			    mask ? S::Mul(S::Load(mask + i), splat) : splat;
+			for (const auto stream : VectorStreams)
+			{
+				const auto from = S::Load(a.GetStream(stream) + i);
+				const auto to = S::Load(b.GetStream(stream) + i);
+				S::Store(out.GetStream(stream) + i,
+				         S::MulAdd(S::Sub(to, from), t, from));
+			}
+			StoreRotations(out, i,
+			               Nlerp(LoadRotations(a, i),
+			                     LoadRotations(b, i), t));
+		}
+	}
+
+	void AddAdditive(const Pose& base, const Pose& delta,
+	                 float weight, Pose& out)
+	{
+		VEGAM_ASSERT(base.GetBoneCount()
+		                     == delta.GetBoneCount()
+		                 && base.GetBoneCount()
+		                        == out.GetBoneCount(),
+		             "Adding poses of different skeletons");
+		const auto count = base.GetPaddedCount();
+		const auto t = S::Splat(weight);
+		const auto zero = S::Splat(0.0f);
+		const auto one = S::Splat(1.0f);
+		for (uint32_t i = 0; i < count; i += 4)
+		{
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				const auto translation =
+				    static_cast<Pose::Stream>(
+				        Pose::TranslationX + axis);
+				S::Store(
+				    out.GetStream(translation) + i,
+				    S::MulAdd(
+				        S::Load(delta.GetStream(translation)
+				                + i),
+				        t,
+				        S::Load(base.GetStream(translation)
+				                + i)));
+
+				const auto scale = static_cast<Pose::Stream>(
+				    Pose::ScaleX + axis);
+				const auto factor = S::MulAdd(
+				    S::Sub(S::Load(delta.GetStream(scale) + i),
+				           one),
+				    t, one);
+				S::Store(out.GetStream(scale) + i,
+				         S::Mul(S::Load(base.GetStream(scale)
+				                        + i),
+				                factor));
+			}
+			const Quat4 identity{zero, zero, zero, one};
+			const auto partial =
+			    Nlerp(identity, LoadRotations(delta, i), t);
+			StoreRotations(
+			    out, i,
+			    Multiply(LoadRotations(base, i), partial));
+		}
+	}
+} // namespace AthiVegam::Animation
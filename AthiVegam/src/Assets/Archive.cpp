@@ -0,0 +1,221 @@
+#include "AthiVegam/Assets/Archive.h"
+
+#include "AthiVegam/Assets/Lz4.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace AthiVegam::Assets
+{
+	namespace
+	{
+		using namespace ArchiveFormat;
+	} // namespace
+
+	bool Archive::Open(const std::string& path)
+	{
+		Close();
+		if (!m_file.Open(path))
+		{
+			return false;
+		}
+
+		Header header{};
+		const auto tocSize = [&] {
+			return sizeof(Header)
+			       + uint64_t{header.entryCount} * sizeof(Entry)
+			       + uint64_t{header.chunkCount}
+			             * sizeof(uint32_t);
+		};
+		if (!m_file.ReadAt(0, &header, sizeof(header))
+		    || header.magic != Magic
+		    || header.version != Version
+		    || tocSize() > m_file.GetSize())
+		{
+			VEGAM_ERROR("{} is not a version {} asset archive",
+			            path, Version);
+			m_file.Close();
+			return false;
+		}
+
+		// The table of contents in one read.
+		std::vector<uint8_t> toc(tocSize() - sizeof(Header));
+		if (!m_file.ReadAt(sizeof(Header), toc.data(),
+		                   toc.size()))
+		{
+			VEGAM_ERROR("Error reading {}", path);
+			m_file.Close();
+			return false;
+		}
+		m_entries.resize(header.entryCount);
+		std::memcpy(m_entries.data(), toc.data(),
+		            m_entries.size() * sizeof(Entry));
+		m_chunkSizes.resize(header.chunkCount);
+		std::memcpy(m_chunkSizes.data(),
+		            toc.data() + m_entries.size() * sizeof(Entry),
+		            m_chunkSizes.size() * sizeof(uint32_t));
+
+		// Check every entry once here, so reads need not.
+		m_chunkOffsets.resize(m_chunkSizes.size());
+		for (const auto& entry : m_entries)
+		{
+			bool valid = uint64_t{entry.firstChunk}
+			                     + entry.chunkCount
+			                 <= m_chunkSizes.size()
+			             && entry.offset <= m_file.GetSize()
+			             && entry.storedSize
+			                    <= m_file.GetSize() - entry.offset
+			             && entry.size
+			                    <= uint64_t{entry.chunkCount}
+			                           * ChunkSize;
+			uint64_t offset = 0;
+			for (uint32_t i = 0; valid && i < entry.chunkCount;
+			     ++i)
+			{
+				const auto chunk = entry.firstChunk + i;
+				m_chunkOffsets[chunk] = offset;
+				offset += m_chunkSizes[chunk]
+				          & ~ChunkUncompressed;
+			}
+			if (!valid || offset != entry.storedSize)
+			{
+				VEGAM_ERROR("{} has a malformed entry {:016x}",
+				            path, entry.id);
+				Close();
+				return false;
+			}
+		}
+
+		m_path = path;
+		VEGAM_INFO("Opened asset archive {}: {} entries, {} KB",
+		           path, m_entries.size(),
+		           m_file.GetSize() / 1024);
+		return true;
+	}
+
+	void Archive::Close()
+	{
+		m_file.Close();
+		m_entries.clear();
+		m_chunkSizes.clear();
+		m_chunkOffsets.clear();
+		m_path.clear();
+	}
+
+	const Archive::Entry* Archive::Find(AssetId id) const
+	{
+		const auto key = static_cast<uint64_t>(id);
+		const auto it = std::lower_bound(
+		    m_entries.begin(), m_entries.end(), key,
+		    [](const Entry& entry, uint64_t value) {
+			    return entry.id < value;
+		    });
+		return it != m_entries.end() && it->id == key ? &*it
+		                                               : nullptr;
+	}
+
+	bool Archive::Read(const Entry& entry,
+	                   std::vector<uint8_t>& stored) const
+	{
+		return ReadChunks(entry, 0, entry.chunkCount, stored);
+	}
+
+	bool Archive::ReadChunks(const Entry& entry,
+	                         uint32_t first, uint32_t count,
+	                         std::vector<uint8_t>& stored) const
+	{
+		VEGAM_ASSERT(first + count <= entry.chunkCount,
+		             "Reading past the end of an entry!");
+		if (count == 0)
+		{
+			stored.clear();
+			return true;
+		}
+
+		const auto begin = m_chunkOffsets[entry.firstChunk
+		                                  + first];
+		const auto last = entry.firstChunk + first + count - 1;
+		const auto end = m_chunkOffsets[last]
+		                 + (m_chunkSizes[last]
+		                    & ~ChunkUncompressed);
+		stored.resize(end - begin);
+		if (!m_file.ReadAt(entry.offset + begin, stored.data(),
+		                   stored.size()))
+		{
+			VEGAM_ERROR("Error reading {:016x} from {}",
+			            entry.id, m_path);
+			return false;
+		}
+		return true;
+	}
+
+	uint64_t Archive::GetChunksSize(const Entry& entry,
+	                                uint32_t first,
+	                                uint32_t count)
+	{
+		const auto begin =
+		    std::min(uint64_t{first} * ChunkSize, entry.size);
+		const auto end = std::min(
+		    uint64_t{first + count} * ChunkSize, entry.size);
+		return end - begin;
+	}
+
+	bool Archive::DecompressChunk(const Entry& entry,
+	                              uint32_t i,
+	                              const uint8_t* stored,
+	                              uint8_t* out,
+	                              uint32_t first) const
+	{
+		const auto chunk = entry.firstChunk + i;
+		const auto storedSize =
+		    m_chunkSizes[chunk] & ~ChunkUncompressed;
+		const auto* src =
+		    stored + m_chunkOffsets[chunk]
+		    - m_chunkOffsets[entry.firstChunk + first];
+		const auto offset = uint64_t{i} * ChunkSize;
+		const auto size = static_cast<size_t>(std::min<uint64_t>(
+		    ChunkSize, entry.size - std::min(offset, entry.size)));
+		out += offset - uint64_t{first} * ChunkSize;
+
+		bool ok = true;
+		if (m_chunkSizes[chunk] & ChunkUncompressed)
+		{
+			ok = storedSize == size;
+			if (ok)
+			{
+				std::memcpy(out, src, size);
+			}
+		}
+		else
+		{
+			ok = Lz4::Decompress(src, storedSize, out, size);
+		}
+		if (!ok)
+		{
+			VEGAM_ERROR("Chunk {} of {:016x} in {} is corrupt",
+			            i, entry.id, m_path);
+		}
+		return ok;
+	}
+
+	bool Archive::Load(const Entry& entry,
+	                   std::vector<uint8_t>& out) const
+	{
+		std::vector<uint8_t> stored;
+		if (!Read(entry, stored))
+		{
+			return false;
+		}
+		out.resize(entry.size);
+		for (uint32_t i = 0; i < entry.chunkCount; ++i)
+		{
+			if (!DecompressChunk(entry, i, stored.data(),
+			                     out.data()))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+} // namespace AthiVegam::Assets
@@ -0,0 +1,542 @@
+#include "AthiVegam/Assets/ImageWriter.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace AthiVegam::Assets::ImageWriter
+{
+	namespace
+	{
+		constexpr uint32_t WindowSize = 32768;
+		constexpr uint32_t HashBits = 15;
+		constexpr uint32_t MaxChain = 32;
+		constexpr uint32_t MinMatch = 3;
+		constexpr uint32_t MaxMatch = 258;
+
+		constexpr uint16_t LengthBase[29] = {
+		    3,  4,  5,  6,  7,  8,  9,  10, 11,  13,
+		    15, 17, 19, 23, 27, 31, 35, 43, 51,  59,
+		    67, 83, 99, 115, 131, 163, 195, 227, 258};
+		constexpr uint8_t LengthExtra[29] = {
+		    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+		    2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+		constexpr uint16_t DistanceBase[30] = {
+		    1,    2,    3,    4,     5,     7,    9,
+		    13,   17,   25,   33,    49,    65,   97,
+		    129,  193,  257,  385,   513,   769,  1025,
+		    1537, 2049, 3073, 4097,  6145,  8193, 12289,
+		    16385, 24577};
+		constexpr uint8_t DistanceExtra[30] = {
+		    0, 0, 0, 0, 1, 1, 2,  2,  3,  3,  4,  4,  5,  5, 6,
+		    6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+		const std::array<uint32_t, 256> CrcTable = [] {
+			std::array<uint32_t, 256> table{};
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				auto c = i;
+				for (int k = 0; k < 8; ++k)
+				{
+					c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				}
+				table[i] = c;
+			}
+			return table;
+		}();
+
+		uint32_t Crc32(const uint8_t* data, size_t size)
+		{
+			uint32_t crc = 0xFFFFFFFFu;
+			for (size_t i = 0; i < size; ++i)
+			{
+				crc = CrcTable[(crc ^ data[i]) & 0xFF]
+				      ^ (crc >> 8);
+			}
+			return ~crc;
+		}
+
+		uint32_t Adler32(const uint8_t* data, size_t size)
+		{
+			// 5552 bytes is the most that cannot overflow.
+			uint32_t a = 1;
+			uint32_t b = 0;
+			while (size > 0)
+			{
+				const auto n = size < 5552 ? size : 5552;
+				for (size_t i = 0; i < n; ++i)
+				{
+					a += data[i];
+					b += a;
+				}
+				a %= 65521;
+				b %= 65521;
+				data += n;
+				size -= n;
+			}
+			return b << 16 | a;
+		}
+
+		// Deflate writes bits from the least significant
+		// one up, Huffman codes from their most.
+		class BitWriter
+		{
+		  public:
+			explicit BitWriter(std::vector<uint8_t>& out)
+			    : m_out(out)
+			{
+			}
+
+			inline void Put(uint32_t value, uint32_t count)
+			{
+				m_bits |= static_cast<uint64_t>(value) << m_count;
+				m_count += count;
+				while (m_count >= 8)
+				{
+					m_out.push_back(static_cast<uint8_t>(m_bits));
+					m_bits >>= 8;
+					m_count -= 8;
+				}
+			}
+
+			inline void PutCode(uint32_t code, uint32_t length)
+			{
+				uint32_t reversed = 0;
+				for (uint32_t i = 0; i < length; ++i)
+				{
+					reversed = reversed << 1 | (code >> i & 1);
+				}
+				Put(reversed, length);
+			}
+
+			// The fixed literal/length code.
+			inline void PutSymbol(uint32_t symbol)
+			{
+				if (symbol < 144)
+				{
+					PutCode(0x30 + symbol, 8);
+				}
+				else if (symbol < 256)
+				{
+					PutCode(0x190 + symbol - 144, 9);
+				}
+				else if (symbol < 280)
+				{
+					PutCode(symbol - 256, 7);
+				}
+				else
+				{
+					PutCode(0xC0 + symbol - 280, 8);
+				}
+			}
+
+			void PutMatch(uint32_t length, uint32_t distance)
+			{
+				uint32_t code = 28;
+				while (LengthBase[code] > length)
+				{
+					--code;
+				}
+				PutSymbol(257 + code);
+				Put(length - LengthBase[code], LengthExtra[code]);
+
+				code = 29;
+				while (DistanceBase[code] > distance)
+				{
+					--code;
+				}
+				PutCode(code, 5);
+				Put(distance - DistanceBase[code],
+				    DistanceExtra[code]);
+			}
+
+			void Finish()
+			{
+				if (m_count > 0)
+				{
+					m_out.push_back(static_cast<uint8_t>(m_bits));
+				}
+				m_bits = 0;
+				m_count = 0;
+			}
+
+		  private:
+			std::vector<uint8_t>& m_out;
+			uint64_t m_bits = 0;
+			uint32_t m_count = 0;
+		};
+
+		inline uint32_t Hash(const uint8_t* p)
+		{
+			const uint32_t key = p[0] << 16 | p[1] << 8 | p[2];
+			return (key * 2654435761u) >> (32 - HashBits);
+		}
+
+		// A zlib stream of one fixed Huffman block, matches
+		// found by greedy hash chains.
+		void Deflate(const uint8_t* data, size_t size,
+		             std::vector<uint8_t>& out)
+		{
+			out.push_back(0x78);
+			out.push_back(0x01);
+
+			BitWriter writer(out);
+			writer.Put(1, 1); // Final block.
+			writer.Put(1, 2); // Fixed codes.
+
+			std::vector<int32_t> head(1u << HashBits, -1);
+			std::vector<int32_t> previous(WindowSize, -1);
+			const auto insert = [&](size_t position) {
+				if (position + MinMatch > size)
+				{
+					return;
+				}
+				auto& first = head[Hash(data + position)];
+				previous[position & (WindowSize - 1)] = first;
+				first = static_cast<int32_t>(position);
+			};
+
+			size_t position = 0;
+			while (position < size)
+			{
+				uint32_t best = 0;
+				uint32_t bestDistance = 0;
+				if (position + MinMatch <= size)
+				{
+					const auto limit = static_cast<uint32_t>(
+					    std::min<size_t>(MaxMatch,
+					                     size - position));
+					auto candidate = head[Hash(data + position)];
+					for (uint32_t chain = 0;
+					     candidate >= 0 && chain < MaxChain;
+					     ++chain)
+					{
+						const auto distance =
+						    static_cast<uint32_t>(position
+						                          - candidate);
+						if (distance > WindowSize)
+						{
+							break;
+						}
+						const auto* a = data + candidate;
+						const auto* b = data + position;
+						uint32_t length = 0;
+						while (length < limit
+						       && a[length] == b[length])
+						{
+							++length;
+						}
+						if (length > best)
+						{
+							best = length;
+							bestDistance = distance;
+							if (length == limit)
+							{
+								break;
+							}
+						}
+						candidate = previous[candidate
+						                     & (WindowSize - 1)];
+					}
+				}
+
+				if (best >= MinMatch)
+				{
+					writer.PutMatch(best, bestDistance);
+					for (uint32_t i = 0; i < best; ++i)
+					{
+						insert(position + i);
+					}
+					position += best;
+				}
+				else
+				{
+					writer.PutSymbol(data[position]);
+					insert(position);
+					++position;
+				}
+			}
+			writer.PutSymbol(256);
+			writer.Finish();
+
+			const auto adler = Adler32(data, size);
+			for (int shift = 24; shift >= 0; shift -= 8)
+			{
+				out.push_back(
+				    static_cast<uint8_t>(adler >> shift));
+			}
+		}
+
+		inline void PutBig32(std::vector<uint8_t>& out,
+		                     uint32_t value)
+		{
+			for (int shift = 24; shift >= 0; shift -= 8)
+			{
+				out.push_back(
+				    static_cast<uint8_t>(value >> shift));
+			}
+		}
+
+		void PutChunk(std::vector<uint8_t>& out,
+		              const char (&type)[5],
+		              const std::vector<uint8_t>& data)
+		{
+			PutBig32(out, static_cast<uint32_t>(data.size()));
+			const auto start = out.size();
+			out.insert(out.end(), type, type + 4);
+			out.insert(out.end(), data.begin(), data.end());
+			PutBig32(out, Crc32(out.data() + start,
+			                    out.size() - start));
+		}
+
+		inline uint8_t Paeth(int a, int b, int c)
+		{
+			const auto p = a + b - c;
+			const auto pa = std::abs(p - a);
+			const auto pb = std::abs(p - b);
+			const auto pc = std::abs(p - c);
+			if (pa <= pb && pa <= pc)
+			{
+				return static_cast<uint8_t>(a);
+			}
+			return static_cast<uint8_t>(pb <= pc ? b : c);
+		}
+
+		inline const uint8_t* GetRow(const Image& image,
+		                             uint32_t y)
+		{
+			const auto row =
+			    image.bottomUp ? image.height - 1 - y : y;
+			return image.pixels
+			       + static_cast<size_t>(row) * image.width * 4;
+		}
+
+		uint16_t ToHalf(float value)
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			const auto sign =
+			    static_cast<uint16_t>(bits >> 16 & 0x8000);
+			const auto exponent =
+			    static_cast<int32_t>(bits >> 23 & 0xFF) - 112;
+			auto mantissa = bits & 0x7FFFFF;
+			if (exponent <= 0)
+			{
+				// Subnormal, or too small for one.
+				if (exponent < -10)
+				{
+					return sign;
+				}
+				mantissa |= 0x800000;
+				const auto shift =
+				    static_cast<uint32_t>(14 - exponent);
+				auto half = mantissa >> shift;
+				half += mantissa >> (shift - 1) & 1;
+				return static_cast<uint16_t>(sign | half);
+			}
+			if (exponent >= 31)
+			{
+				return static_cast<uint16_t>(sign | 0x7C00);
+			}
+			// Rounding may carry into the exponent, which is
+			// still right.
+			auto half = static_cast<uint32_t>(exponent) << 10
+			            | mantissa >> 13;
+			half += mantissa >> 12 & 1;
+			return static_cast<uint16_t>(sign | half);
+		}
+
+		const std::array<uint16_t, 256> LinearHalf = [] {
+			std::array<uint16_t, 256> table{};
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				const auto c = static_cast<float>(i) / 255.0f;
+				table[i] = ToHalf(
+				    c <= 0.04045f
+				        ? c / 12.92f
+				        : std::pow((c + 0.055f) / 1.055f, 2.4f));
+			}
+			return table;
+		}();
+
+		template <typename T>
+		inline void PutLittle(std::vector<uint8_t>& out,
+		                      T value)
+		{
+			uint8_t bytes[sizeof(T)];
+			std::memcpy(bytes, &value, sizeof(T));
+			out.insert(out.end(), bytes, bytes + sizeof(T));
+		}
+
+		void PutAttribute(std::vector<uint8_t>& out,
+		                  const char* name, const char* type,
+		                  uint32_t size)
+		{
+			out.insert(out.end(), name,
+			           name + std::strlen(name) + 1);
+			out.insert(out.end(), type,
+			           type + std::strlen(type) + 1);
+			PutLittle(out, size);
+		}
+	} // namespace
+
+	std::vector<uint8_t> EncodePng(const Image& image,
+	                               bool alpha)
+	{
+		const uint32_t channels = alpha ? 4 : 3;
+		const size_t rowSize =
+		    static_cast<size_t>(image.width) * channels;
+
+		// Each row is its filter's byte and residuals.
+		std::vector<uint8_t> filtered;
+		filtered.reserve((rowSize + 1) * image.height);
+		std::vector<uint8_t> previous(rowSize, 0);
+		std::vector<uint8_t> current(rowSize);
+		std::array<std::vector<uint8_t>, 5> candidates;
+		for (auto& candidate : candidates)
+		{
+			candidate.resize(rowSize);
+		}
+
+		for (uint32_t y = 0; y < image.height; ++y)
+		{
+			const auto* source = GetRow(image, y);
+			for (uint32_t x = 0; x < image.width; ++x)
+			{
+				std::memcpy(&current[x * channels],
+				            source + x * 4, channels);
+			}
+
+			std::array<uint64_t, 5> costs{};
+			for (size_t i = 0; i < rowSize; ++i)
+			{
+				const int a = i >= channels
+				                  ? current[i - channels]
+				                  : 0;
+				const int b = previous[i];
+				const int c = i >= channels
+				                  ? previous[i - channels]
+				                  : 0;
+				const int x = current[i];
+				const uint8_t values[5] = {
+				    static_cast<uint8_t>(x),
+				    static_cast<uint8_t>(x - a),
+				    static_cast<uint8_t>(x - b),
+				    static_cast<uint8_t>(x - (a + b) / 2),
+				    static_cast<uint8_t>(x - Paeth(a, b, c))};
+				for (uint32_t f = 0; f < 5; ++f)
+				{
+					candidates[f][i] = values[f];
+					costs[f] += static_cast<uint32_t>(std::abs(
+					    static_cast<int8_t>(values[f])));
+				}
+			}
+
+			uint32_t best = 0;
+			for (uint32_t f = 1; f < 5; ++f)
+			{
+				if (costs[f] < costs[best])
+				{
+					best = f;
+				}
+			}
+			filtered.push_back(static_cast<uint8_t>(best));
+			filtered.insert(filtered.end(),
+			                candidates[best].begin(),
+			                candidates[best].end());
+			std::swap(previous, current);
+		}
+
+		std::vector<uint8_t> out = {0x89, 'P',  'N',  'G',
+		                            '\r', '\n', 0x1A, '\n'};
+		std::vector<uint8_t> header;
+		PutBig32(header, image.width);
+		PutBig32(header, image.height);
+		// 8 bits, RGB(A), deflate, adaptive filters, no
+		// interlacing.
+		header.insert(header.end(),
+		              {8, static_cast<uint8_t>(alpha ? 6 : 2),
+		               0, 0, 0});
+		PutChunk(out, "IHDR", header);
+
+		std::vector<uint8_t> data;
+		data.reserve(filtered.size() / 2);
+		Deflate(filtered.data(), filtered.size(), data);
+		PutChunk(out, "IDAT", data);
+		PutChunk(out, "IEND", {});
+		return out;
+	}
+
+	std::vector<uint8_t> EncodeExr(const Image& image)
+	{
+		const auto width = static_cast<int32_t>(image.width);
+		const auto height = static_cast<int32_t>(image.height);
+
+		std::vector<uint8_t> out = {0x76, 0x2F, 0x31, 0x01,
+		                            2,    0,    0,    0};
+
+		// Channels in the alphabetical order their data
+		// follows.
+		PutAttribute(out, "channels", "chlist", 3 * 18 + 1);
+		for (const char* name : {"B", "G", "R"})
+		{
+			out.insert(out.end(), {static_cast<uint8_t>(*name),
+			                       0});
+			PutLittle<int32_t>(out, 1); // Half.
+			PutLittle<uint32_t>(out, 0); // Perceptual.
+			PutLittle<int32_t>(out, 1);
+			PutLittle<int32_t>(out, 1);
+		}
+		out.push_back(0);
+		PutAttribute(out, "compression", "compression", 1);
+		out.push_back(0);
+		for (const char* name : {"dataWindow", "displayWindow"})
+		{
+			PutAttribute(out, name, "box2i", 16);
+			PutLittle<int32_t>(out, 0);
+			PutLittle<int32_t>(out, 0);
+			PutLittle<int32_t>(out, width - 1);
+			PutLittle<int32_t>(out, height - 1);
+		}
+		PutAttribute(out, "lineOrder", "lineOrder", 1);
+		out.push_back(0); // Increasing y.
+		PutAttribute(out, "pixelAspectRatio", "float", 4);
+		PutLittle(out, 1.0f);
+		PutAttribute(out, "screenWindowCenter", "v2f", 8);
+		PutLittle(out, 0.0f);
+		PutLittle(out, 0.0f);
+		PutAttribute(out, "screenWindowWidth", "float", 4);
+		PutLittle(out, 1.0f);
+		out.push_back(0);
+
+		// Uncompressed, each scanline is a chunk.
+		const auto lineSize =
+		    static_cast<uint32_t>(image.width) * 3 * 2;
+		const auto chunkSize = uint64_t{8} + lineSize;
+		const auto first =
+		    out.size() + uint64_t{8} * image.height;
+		for (uint32_t y = 0; y < image.height; ++y)
+		{
+			PutLittle<uint64_t>(out, first + chunkSize * y);
+		}
+
+		out.reserve(first + chunkSize * image.height);
+		for (uint32_t y = 0; y < image.height; ++y)
+		{
+			PutLittle(out, static_cast<int32_t>(y));
+			PutLittle(out, lineSize);
+			const auto* source = GetRow(image, y);
+			for (const uint32_t channel : {2u, 1u, 0u})
+			{
+				for (uint32_t x = 0; x < image.width; ++x)
+				{
+					const auto value = source[x * 4 + channel];
+					PutLittle(out, LinearHalf[value]);
+				}
+			}
+		}
+		return out;
+	}
+} // namespace AthiVegam::Assets::ImageWriter
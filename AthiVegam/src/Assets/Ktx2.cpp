@@ -0,0 +1,178 @@
+#include "AthiVegam/Assets/Ktx2.h"
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace AthiVegam::Assets::Ktx2
+{
+	namespace
+	{
+		using Graphics::TextureFormat;
+
+		constexpr uint8_t Identifier[12] = {
+		    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+		    0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+		struct Header
+		{
+			uint8_t identifier[12];
+			uint32_t vkFormat;
+			uint32_t typeSize;
+			uint32_t pixelWidth;
+			uint32_t pixelHeight;
+			uint32_t pixelDepth;
+			uint32_t layerCount;
+			uint32_t faceCount;
+			uint32_t levelCount;
+			uint32_t supercompressionScheme;
+			uint32_t dfdByteOffset;
+			uint32_t dfdByteLength;
+			uint32_t kvdByteOffset;
+			uint32_t kvdByteLength;
+			uint64_t sgdByteOffset;
+			uint64_t sgdByteLength;
+		};
+		static_assert(sizeof(Header) == HeaderSize);
+
+		struct LevelIndex
+		{
+			uint64_t byteOffset;
+			uint64_t byteLength;
+			uint64_t uncompressedByteLength;
+		};
+
+		// VkFormat values of the formats Texture knows.
+		bool ToTextureFormat(uint32_t vkFormat,
+		                     TextureFormat& format)
+		{
+			switch (vkFormat)
+			{
+			case 37: format = TextureFormat::RGBA8; break;
+			case 43: format = TextureFormat::RGBA8Srgb; break;
+			case 133: format = TextureFormat::BC1; break;
+			case 134: format = TextureFormat::BC1Srgb; break;
+			case 137: format = TextureFormat::BC3; break;
+			case 138: format = TextureFormat::BC3Srgb; break;
+			case 139: format = TextureFormat::BC4; break;
+			case 141: format = TextureFormat::BC5; break;
+			case 143: format = TextureFormat::BC6H; break;
+			case 145: format = TextureFormat::BC7; break;
+			case 146: format = TextureFormat::BC7Srgb; break;
+			case 147: format = TextureFormat::ETC2RGB8; break;
+			case 148:
+				format = TextureFormat::ETC2RGB8Srgb;
+				break;
+			case 151: format = TextureFormat::ETC2RGBA8; break;
+			case 152:
+				format = TextureFormat::ETC2RGBA8Srgb;
+				break;
+			case 157: format = TextureFormat::ASTC4x4; break;
+			case 158:
+				format = TextureFormat::ASTC4x4Srgb;
+				break;
+			case 165: format = TextureFormat::ASTC6x6; break;
+			case 166:
+				format = TextureFormat::ASTC6x6Srgb;
+				break;
+			case 171: format = TextureFormat::ASTC8x8; break;
+			case 172:
+				format = TextureFormat::ASTC8x8Srgb;
+				break;
+			default: return false;
+			}
+			return true;
+		}
+	} // namespace
+
+	bool Parse(const uint8_t* data, size_t size,
+	           uint64_t fileSize, Info& info,
+	           std::string_view name)
+	{
+		const auto fail = [&](const char* reason) {
+			VEGAM_ERROR("Cannot load texture {}: {}", name,
+			            reason);
+			return false;
+		};
+
+		Header header;
+		if (size < sizeof(Header))
+		{
+			return fail("truncated");
+		}
+		std::memcpy(&header, data, sizeof(header));
+		if (std::memcmp(header.identifier, Identifier,
+		                sizeof(Identifier))
+		    != 0)
+		{
+			return fail("not a KTX2 file");
+		}
+		if (header.supercompressionScheme != 0)
+		{
+			return fail("supercompressed; export it without "
+			            "Basis or zstd supercompression");
+		}
+		if (header.pixelDepth > 1 || header.layerCount > 1
+		    || header.faceCount != 1 || header.pixelHeight == 0)
+		{
+			return fail("not a 2D texture");
+		}
+
+		TextureFormat format;
+		if (!ToTextureFormat(header.vkFormat, format))
+		{
+			return fail("unsupported VkFormat");
+		}
+
+		// 0 asks for mipmaps generated at load; the file
+		// holds level 0 only.
+		const auto levelCount =
+		    std::max(header.levelCount, 1u);
+		if (levelCount > Graphics::Texture::MaxLevels)
+		{
+			return fail("too many levels");
+		}
+		if (size < GetIndexSize(levelCount))
+		{
+			return fail("truncated");
+		}
+
+		info.desc = {};
+		info.desc.width = header.pixelWidth;
+		info.desc.height = header.pixelHeight;
+		info.desc.levelCount = levelCount;
+		info.desc.format = format;
+		for (uint32_t level = 0; level < levelCount; ++level)
+		{
+			LevelIndex index;
+			std::memcpy(&index,
+			            data + HeaderSize
+			                + level * sizeof(LevelIndex),
+			            sizeof(index));
+			if (index.byteLength
+			        != Graphics::Texture::GetLevelSize(
+			            info.desc, level)
+			    || index.byteOffset > fileSize
+			    || index.byteLength
+			           > fileSize - index.byteOffset)
+			{
+				return fail("bad level index");
+			}
+			info.levels[level] = {index.byteOffset,
+			                      index.byteLength};
+		}
+		return true;
+	}
+
+	uint64_t GetPrefixSize(const Info& info, uint32_t level)
+	{
+		uint64_t size = GetIndexSize(info.desc.levelCount);
+		for (auto i = level; i < info.desc.levelCount; ++i)
+		{
+			size = std::max(size, info.levels[i].offset
+			                          + info.levels[i].size);
+		}
+		return size;
+	}
+} // namespace AthiVegam::Assets::Ktx2
@@ -0,0 +1,224 @@
+#include "AthiVegam/Assets/Lz4.h"
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace AthiVegam::Assets::Lz4
+{
+	namespace
+	{
+		// A 4-bit length of 15 continues in the following
+		// bytes, each added until one is below 255.
+		inline bool ReadLength(const uint8_t*& in,
+		                       const uint8_t* end,
+		                       size_t& length)
+		{
+			uint8_t byte = 255;
+			while (byte == 255)
+			{
+				if (in == end)
+				{
+					return false;
+				}
+				byte = *in++;
+				length += byte;
+			}
+			return true;
+		}
+
+		// A block ends in at least this many literals, and
+		// its last match starts at least MatchLimit bytes
+		// before the end.
+		constexpr size_t LastLiterals = 5;
+		constexpr size_t MatchLimit = 12;
+		constexpr size_t MinMatch = 4;
+		constexpr size_t MaxOffset = 65535;
+		constexpr uint32_t HashBits = 12;
+
+		inline uint32_t Read32(const uint8_t* in)
+		{
+			uint32_t value;
+			std::memcpy(&value, in, sizeof(value));
+			return value;
+		}
+
+		inline uint32_t Hash(uint32_t sequence)
+		{
+			return (sequence * 2654435761u) >> (32 - HashBits);
+		}
+
+		inline uint8_t* WriteLength(uint8_t* out,
+		                            size_t length)
+		{
+			for (; length >= 255; length -= 255)
+			{
+				*out++ = 255;
+			}
+			*out++ = static_cast<uint8_t>(length);
+			return out;
+		}
+
+		// The token and literals of a sequence; the match,
+		// if any, is left to the caller.
+		inline uint8_t* WriteLiterals(uint8_t* out,
+		                              const uint8_t* literals,
+		                              size_t count,
+		                              size_t match)
+		{
+			const auto literalNibble = std::min<size_t>(count,
+			                                            15);
+			const auto matchNibble = std::min<size_t>(match, 15);
+			*out++ = static_cast<uint8_t>(literalNibble << 4
+			                              | matchNibble);
+			if (count >= 15)
+			{
+				out = WriteLength(out, count - 15);
+			}
+			std::memcpy(out, literals, count);
+			return out + count;
+		}
+	} // namespace
+
+	bool Decompress(const uint8_t* src, size_t srcSize,
+	                uint8_t* dst, size_t dstSize)
+	{
+		const auto* in = src;
+		const auto* inEnd = src + srcSize;
+		auto* out = dst;
+		auto* outEnd = dst + dstSize;
+
+		while (in < inEnd)
+		{
+			const auto token = *in++;
+
+			size_t literals = token >> 4;
+			if (literals == 15 && !ReadLength(in, inEnd, literals))
+			{
+				return false;
+			}
+			if (literals > static_cast<size_t>(inEnd - in)
+			    || literals > static_cast<size_t>(outEnd - out))
+			{
+				return false;
+			}
+			std::memcpy(out, in, literals);
+			in += literals;
+			out += literals;
+
+			// The last sequence ends after its literals.
+			if (in == inEnd)
+			{
+				break;
+			}
+
+			if (inEnd - in < 2)
+			{
+				return false;
+			}
+			const size_t offset = in[0] | (in[1] << 8);
+			in += 2;
+			size_t match = token & 15;
+			if (match == 15 && !ReadLength(in, inEnd, match))
+			{
+				return false;
+			}
+			match += 4;
+			if (offset == 0
+			    || offset > static_cast<size_t>(out - dst)
+			    || match > static_cast<size_t>(outEnd - out))
+			{
+				return false;
+			}
+
+			// Matches may overlap their own output, e.g. a
+			// run of one repeated byte, so copy bytewise
+			// unless they are far enough apart.
+			const auto* from = out - offset;
+			if (offset >= match)
+			{
+				std::memcpy(out, from, match);
+				out += match;
+			}
+			else
+			{
+				for (size_t i = 0; i < match; ++i)
+				{
+					*out++ = from[i];
+				}
+			}
+		}
+		return out == outEnd;
+	}
+
+	size_t Compress(const uint8_t* src, size_t srcSize,
+	                uint8_t* dst)
+	{
+		VEGAM_ASSERT(srcSize <= UINT32_MAX,
+		             "LZ4 blocks are limited to 4GB");
+		// Positions of the last sequence of each hash; 0,
+		// the start, doubles as empty since every
+		// candidate is checked.
+		std::array<uint32_t, 1u << HashBits> table{};
+
+		const auto* in = src;
+		const auto* anchor = src;
+		const auto* end = src + srcSize;
+		auto* out = dst;
+		if (srcSize > MatchLimit)
+		{
+			const auto* last = end - MatchLimit;
+			const auto* matchEnd = end - LastLiterals;
+			while (in <= last)
+			{
+				const auto sequence = Read32(in);
+				auto& slot = table[Hash(sequence)];
+				const auto* candidate = src + slot;
+				slot = static_cast<uint32_t>(in - src);
+				if (candidate >= in
+				    || static_cast<size_t>(in - candidate)
+				           > MaxOffset
+				    || Read32(candidate) != sequence)
+				{
+					++in;
+					continue;
+				}
+
+				auto* to = in + MinMatch;
+				auto* from = candidate + MinMatch;
+				while (to < matchEnd && *to == *from)
+				{
+					++to;
+					++from;
+				}
+				while (in > anchor && candidate > src
+				       && in[-1] == candidate[-1])
+				{
+					--in;
+					--candidate;
+				}
+
+				const auto match =
+				    static_cast<size_t>(to - in) - MinMatch;
+				out = WriteLiterals(
+				    out, anchor,
+				    static_cast<size_t>(in - anchor), match);
+				const auto offset =
+				    static_cast<size_t>(in - candidate);
+				*out++ = static_cast<uint8_t>(offset);
+				*out++ = static_cast<uint8_t>(offset >> 8);
+				if (match >= 15)
+				{
+					out = WriteLength(out, match - 15);
+				}
+				in = to;
+				anchor = in;
+			}
+		}
+		out = WriteLiterals(out, anchor,
+		                    static_cast<size_t>(end - anchor), 0);
+		return static_cast<size_t>(out - dst);
+	}
+} // namespace AthiVegam::Assets::Lz4
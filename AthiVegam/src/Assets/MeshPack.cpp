@@ -0,0 +1,212 @@
+#include "AthiVegam/Assets/MeshPack.h"
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+
+namespace AthiVegam::Assets
+{
+	namespace
+	{
+		using namespace MeshPackFormat;
+
+		inline bool IsAligned(uint64_t value)
+		{
+			return value % Alignment == 0;
+		}
+	} // namespace
+
+	bool MeshPack::Open(const std::string& path)
+	{
+		Close();
+		if (!m_file.Open(path))
+		{
+			return false;
+		}
+
+		const auto* data = m_file.GetData();
+		const auto size = m_file.GetSize();
+		const auto* header =
+		    reinterpret_cast<const PackHeader*>(data);
+		if (size < sizeof(PackHeader)
+		    || header->magic != Magic
+		    || header->version != Version
+		    || size < sizeof(PackHeader)
+		                  + static_cast<size_t>(
+		                        header->meshCount)
+		                        * sizeof(PackEntry))
+		{
+			VEGAM_ERROR("{} is not a version {} mesh pack",
+			            path, Version);
+			m_file.Close();
+			return false;
+		}
+
+		m_entries = {reinterpret_cast<const PackEntry*>(
+		                 data + sizeof(PackHeader)),
+		             header->meshCount};
+		m_path = path;
+		VEGAM_INFO("Mapped mesh pack {}: {} meshes, {} KB",
+		           path, m_entries.size(), size / 1024);
+		return true;
+	}
+
+	void MeshPack::Close()
+	{
+		m_file.Close();
+		m_entries = {};
+		m_path.clear();
+	}
+
+	const PackEntry* MeshPack::FindEntry(AssetId id) const
+	{
+		const auto key = static_cast<uint64_t>(id);
+		const auto it = std::lower_bound(
+		    m_entries.begin(), m_entries.end(), key,
+		    [](const PackEntry& entry, uint64_t value) {
+			    return entry.id < value;
+		    });
+		return it != m_entries.end() && it->id == key ? &*it
+		                                               : nullptr;
+	}
+
+	bool MeshPack::Contains(AssetId id) const
+	{
+		return FindEntry(id) != nullptr;
+	}
+
+	bool MeshPack::Find(AssetId id, MeshView& view) const
+	{
+		const auto* entry = FindEntry(id);
+		if (!entry)
+		{
+			VEGAM_ERROR("Mesh {:016x} is not in {}",
+			            static_cast<uint64_t>(id), m_path);
+			return false;
+		}
+
+		if (!IsAligned(entry->offset)
+		    || entry->offset > m_file.GetSize()
+		    || entry->size > m_file.GetSize() - entry->offset)
+		{
+			VEGAM_ERROR("Mesh {:016x} lies outside of {}",
+			            entry->id, m_path);
+			return false;
+		}
+		return ParseMesh(id, m_file.GetData() + entry->offset,
+		                 entry->size, view);
+	}
+
+	bool MeshPack::ParseMesh(AssetId id, const uint8_t* data,
+	                         size_t size, MeshView& view)
+	{
+		// Everything read below must lie within the data.
+		const auto fail = [&](const char* reason) {
+			VEGAM_ERROR("Mesh {:016x} is malformed: {}",
+			            static_cast<uint64_t>(id), reason);
+			return false;
+		};
+		if (size < sizeof(MeshHeader))
+		{
+			return fail("out of bounds");
+		}
+
+		const auto& header =
+		    *reinterpret_cast<const MeshHeader*>(data);
+		if (header.attributeCount == 0
+		    || header.attributeCount
+		           > Graphics::VertexLayout::MaxAttributes)
+		{
+			return fail("bad attribute count");
+		}
+
+		Graphics::VertexLayout layout;
+		for (uint32_t i = 0; i < header.attributeCount; ++i)
+		{
+			const auto& attribute = header.attributes[i];
+			if (attribute.format
+			    >= static_cast<uint8_t>(
+			        Graphics::VertexFormat::COUNT))
+			{
+				return fail("bad vertex format");
+			}
+			layout.Add(attribute.location,
+			           static_cast<Graphics::VertexFormat>(
+			               attribute.format));
+			if (layout.GetAttribute(i).offset
+			    != attribute.offset)
+			{
+				return fail("attributes not packed");
+			}
+		}
+
+		const auto vertexBytes =
+		    static_cast<uint64_t>(header.vertexCount)
+		    * header.stride;
+		const auto indexBytes =
+		    static_cast<uint64_t>(header.elementCount)
+		    * sizeof(uint32_t);
+		if (layout.GetStride() != header.stride)
+		{
+			return fail("stride does not match layout");
+		}
+		if (!IsAligned(header.vertexOffset)
+		    || !IsAligned(header.indexOffset)
+		    || header.vertexOffset < sizeof(MeshHeader)
+		    || header.vertexOffset + vertexBytes
+		           > header.indexOffset
+		    || header.indexOffset + indexBytes > size)
+		{
+			return fail("blobs out of bounds");
+		}
+
+		const auto meshletBytes =
+		    static_cast<uint64_t>(header.meshletCount)
+		    * sizeof(Graphics::Meshlet);
+		if (header.meshletCount > 0
+		    && (!IsAligned(header.meshletOffset)
+		        || header.meshletOffset
+		               < header.indexOffset + indexBytes
+		        || header.meshletOffset + meshletBytes > size))
+		{
+			return fail("meshlets out of bounds");
+		}
+		const auto* meshlets =
+		    reinterpret_cast<const Graphics::Meshlet*>(
+		        data + header.meshletOffset);
+		for (uint32_t i = 0; i < header.meshletCount; ++i)
+		{
+			// The GPU reads the indices they cover.
+			const auto& meshlet = meshlets[i];
+			if (meshlet.indexCount % 3 != 0
+			    || meshlet.firstIndex > header.elementCount
+			    || meshlet.indexCount
+			           > header.elementCount
+			                 - meshlet.firstIndex)
+			{
+				return fail("meshlet out of range");
+			}
+		}
+
+		view.layout = layout;
+		view.vertices = data + header.vertexOffset;
+		view.vertexCount = header.vertexCount;
+		view.indices = header.elementCount
+		                   ? reinterpret_cast<const uint32_t*>(
+		                         data + header.indexOffset)
+		                   : nullptr;
+		view.elementCount = header.elementCount;
+		view.meshlets =
+		    header.meshletCount > 0 ? meshlets : nullptr;
+		view.meshletCount = header.meshletCount;
+		return true;
+	}
+
+	void MeshPack::Prefetch(AssetId id) const
+	{
+		if (const auto* entry = FindEntry(id))
+		{
+			m_file.Prefetch(entry->offset, entry->size);
+		}
+	}
+} // namespace AthiVegam::Assets
@@ -0,0 +1,95 @@
+#include "AthiVegam/Assets/ShaderPack.h"
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+
+namespace AthiVegam::Assets
+{
+	using namespace ShaderPackFormat;
+
+	bool ShaderPack::Open(const std::string& path)
+	{
+		Close();
+		if (!m_file.Open(path))
+		{
+			return false;
+		}
+
+		const auto* data = m_file.GetData();
+		const auto size = m_file.GetSize();
+		const auto* header =
+		    reinterpret_cast<const PackHeader*>(data);
+		if (size < sizeof(PackHeader)
+		    || header->magic != Magic
+		    || header->version != Version
+		    || size < sizeof(PackHeader)
+		                  + static_cast<size_t>(
+		                        header->shaderCount)
+		                        * sizeof(PackEntry))
+		{
+			VEGAM_ERROR("{} is not a version {} shader pack",
+			            path, Version);
+			m_file.Close();
+			return false;
+		}
+
+		m_entries = {reinterpret_cast<const PackEntry*>(
+		                 data + sizeof(PackHeader)),
+		             header->shaderCount};
+		m_path = path;
+		VEGAM_INFO("Mapped shader pack {}: {} stages, {} KB",
+		           path, m_entries.size(), size / 1024);
+		return true;
+	}
+
+	void ShaderPack::Close()
+	{
+		m_file.Close();
+		m_entries = {};
+		m_path.clear();
+	}
+
+	const PackEntry* ShaderPack::FindEntry(AssetId id) const
+	{
+		const auto key = static_cast<uint64_t>(id);
+		const auto it = std::lower_bound(
+		    m_entries.begin(), m_entries.end(), key,
+		    [](const PackEntry& entry, uint64_t value) {
+			    return entry.id < value;
+		    });
+		return it != m_entries.end() && it->id == key ? &*it
+		                                               : nullptr;
+	}
+
+	bool ShaderPack::Contains(AssetId id) const
+	{
+		return FindEntry(id) != nullptr;
+	}
+
+	bool ShaderPack::Find(AssetId id,
+	                      std::string_view& source) const
+	{
+		const auto* entry = FindEntry(id);
+		if (!entry)
+		{
+			return false;
+		}
+
+		// The terminator must be inside the file too.
+		const auto* data = m_file.GetData();
+		if (entry->offset % Alignment != 0
+		    || entry->offset > m_file.GetSize()
+		    || entry->size >= m_file.GetSize() - entry->offset
+		    || data[entry->offset + entry->size] != '\0')
+		{
+			VEGAM_ERROR("Shader {:016x} lies outside of {}",
+			            entry->id, m_path);
+			return false;
+		}
+		source = {reinterpret_cast<const char*>(
+		              data + entry->offset),
+		          static_cast<size_t>(entry->size)};
+		return true;
+	}
+} // namespace AthiVegam::Assets
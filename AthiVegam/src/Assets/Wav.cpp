@@ -0,0 +1,396 @@
+#include "AthiVegam/Assets/Wav.h"
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace AthiVegam::Assets
+{
+	namespace
+	{
+		// Frames converted per file read.
+		constexpr uint32_t ReadFrames = 4096;
+
+		constexpr int16_t ImaSteps[89] = {
+		    7,     8,     9,     10,    11,    12,    13,
+		    14,    16,    17,    19,    21,    23,    25,
+		    28,    31,    34,    37,    41,    45,    50,
+		    55,    60,    66,    73,    80,    88,    97,
+		    107,   118,   130,   143,   157,   173,   190,
+		    209,   230,   253,   279,   307,   337,   371,
+		    408,   449,   494,   544,   598,   658,   724,
+		    796,   876,   963,   1060,  1166,  1282,  1411,
+		    1552,  1707,  1878,  2066,  2272,  2499,  2749,
+		    3024,  3327,  3660,  4026,  4428,  4871,  5358,
+		    5894,  6484,  7132,  7845,  8630,  9493,  10442,
+		    11487, 12635, 13899, 15289, 16818, 18500, 20350,
+		    22385, 24623, 27086, 29794, 32767};
+		constexpr int8_t ImaIndices[8] = {-1, -1, -1, -1,
+		                                  2,  4,  6,  8};
+
+		inline uint16_t Read16(const uint8_t* p)
+		{
+			return static_cast<uint16_t>(p[0] | p[1] << 8);
+		}
+		inline uint32_t Read32(const uint8_t* p)
+		{
+			return static_cast<uint32_t>(Read16(p))
+			       | static_cast<uint32_t>(Read16(p + 2)) << 16;
+		}
+
+		inline float ToFloat(int32_t sample, float scale)
+		{
+			return static_cast<float>(sample) * scale;
+		}
+
+		struct ImaChannel
+		{
+			int32_t predictor = 0;
+			int32_t index = 0;
+
+			inline float Decode(uint8_t nibble)
+			{
+				const int32_t step = ImaSteps[index];
+				auto difference = step >> 3;
+				if (nibble & 1)
+				{
+					difference += step >> 2;
+				}
+				if (nibble & 2)
+				{
+					difference += step >> 1;
+				}
+				if (nibble & 4)
+				{
+					difference += step;
+				}
+				predictor += nibble & 8 ? -difference
+				                        : difference;
+				predictor = std::clamp(predictor, -32768, 32767);
+				index = std::clamp(index + ImaIndices[nibble & 7],
+				                   0, 88);
+				return ToFloat(predictor, 1.0f / 32768.0f);
+			}
+		};
+	} // namespace
+
+	bool WavReader::Open(const std::string& path)
+	{
+		Close();
+		m_path = path;
+		if (!m_file.Open(path))
+		{
+			return false;
+		}
+
+		uint8_t header[12];
+		if (!m_file.ReadAt(0, header, sizeof(header))
+		    || std::memcmp(header, "RIFF", 4) != 0
+		    || std::memcmp(header + 8, "WAVE", 4) != 0)
+		{
+			VEGAM_ERROR("{} is not a WAV file", path);
+			Close();
+			return false;
+		}
+
+		uint8_t format[40] = {};
+		bool hasFormat = false;
+		uint64_t factFrames = 0;
+		uint64_t offset = sizeof(header);
+		while (offset + 8 <= m_file.GetSize())
+		{
+			uint8_t chunk[8];
+			if (!m_file.ReadAt(offset, chunk, sizeof(chunk)))
+			{
+				break;
+			}
+			const uint64_t size = Read32(chunk + 4);
+			const auto body = offset + 8;
+			if (std::memcmp(chunk, "fmt ", 4) == 0)
+			{
+				hasFormat = m_file.ReadAt(
+				    body, format,
+				    std::min<uint64_t>(size, sizeof(format)));
+			}
+			else if (std::memcmp(chunk, "fact", 4) == 0
+			         && size >= 4)
+			{
+				uint8_t frames[4];
+				if (m_file.ReadAt(body, frames, 4))
+				{
+					factFrames = Read32(frames);
+				}
+			}
+			else if (std::memcmp(chunk, "data", 4) == 0)
+			{
+				m_dataOffset = body;
+				m_dataSize = std::min(size,
+				                      m_file.GetSize() - body);
+				break;
+			}
+			// Chunks are padded to an even size.
+			offset = body + size + (size & 1);
+		}
+
+		auto tag = Read16(format);
+		if (tag == 0xFFFE)
+		{
+			// WAVE_FORMAT_EXTENSIBLE: the sub-format GUID
+			// starts with the tag.
+			tag = Read16(format + 24);
+		}
+		m_channels = Read16(format + 2);
+		m_sampleRate = Read32(format + 4);
+		m_blockAlign = Read16(format + 12);
+		const auto bits = Read16(format + 14);
+		m_bytesPerSample = bits / 8;
+
+		bool supported = hasFormat && m_dataOffset != 0
+		                 && m_channels >= 1 && m_channels <= 2
+		                 && m_sampleRate > 0 && m_blockAlign > 0;
+		if (tag == 1)
+		{
+			m_encoding = Encoding::Pcm;
+			supported = supported && bits % 8 == 0
+			            && bits >= 8 && bits <= 32;
+		}
+		else if (tag == 3)
+		{
+			m_encoding = Encoding::Float;
+			supported = supported && bits == 32;
+		}
+		else if (tag == 0x11)
+		{
+			m_encoding = Encoding::ImaAdpcm;
+			supported = supported && bits == 4
+			            && m_blockAlign > 4 * m_channels;
+		}
+		else
+		{
+			supported = false;
+		}
+		if (!supported)
+		{
+			VEGAM_ERROR("{}: unsupported WAV format {:#x}, {} "
+			            "channels, {} bits",
+			            path, tag, m_channels, bits);
+			Close();
+			return false;
+		}
+
+		if (m_encoding == Encoding::ImaAdpcm)
+		{
+			// A header sample, then 8 samples per 4 bytes of
+			// each channel.
+			const auto bytesPerChannel =
+			    (m_blockAlign - 4 * m_channels) / m_channels;
+			m_framesPerBlock = bytesPerChannel * 2 + 1;
+			const auto blocks = m_dataSize / m_blockAlign;
+			const auto remainder = m_dataSize % m_blockAlign;
+			m_frameCount = blocks * m_framesPerBlock;
+			if (remainder > 4u * m_channels)
+			{
+				m_frameCount +=
+				    (remainder - 4 * m_channels) * 2 / m_channels
+				    + 1;
+			}
+			if (factFrames != 0)
+			{
+				m_frameCount = std::min(m_frameCount, factFrames);
+			}
+			m_block.resize(m_framesPerBlock * 2);
+		}
+		else
+		{
+			m_frameCount = m_dataSize / m_blockAlign;
+		}
+		Rewind();
+		return true;
+	}
+
+	void WavReader::Close()
+	{
+		m_file.Close();
+		m_channels = 0;
+		m_sampleRate = 0;
+		m_dataOffset = 0;
+		m_dataSize = 0;
+		m_frameCount = 0;
+		Rewind();
+	}
+
+	void WavReader::Rewind()
+	{
+		m_frame = 0;
+		m_blockFrames = 0;
+		m_blockFrame = 0;
+	}
+
+	uint32_t WavReader::Read(float* out, uint32_t frameCount)
+	{
+		uint32_t done = 0;
+		if (!IsOpen())
+		{
+			return done;
+		}
+		frameCount = static_cast<uint32_t>(std::min<uint64_t>(
+		    frameCount, m_frameCount - m_frame));
+
+		if (m_encoding == Encoding::ImaAdpcm)
+		{
+			while (done < frameCount)
+			{
+				if (m_blockFrame == m_blockFrames
+				    && !DecodeBlock())
+				{
+					break;
+				}
+				const auto count =
+				    std::min(frameCount - done,
+				             m_blockFrames - m_blockFrame);
+				std::memcpy(out + done * 2,
+				            m_block.data() + m_blockFrame * 2,
+				            count * 2 * sizeof(float));
+				m_blockFrame += count;
+				m_frame += count;
+				done += count;
+			}
+			return done;
+		}
+
+		while (done < frameCount)
+		{
+			const auto count =
+			    std::min(frameCount - done, ReadFrames);
+			m_bytes.resize(static_cast<size_t>(count)
+			               * m_blockAlign);
+			if (!m_file.ReadAt(m_dataOffset
+			                       + m_frame * m_blockAlign,
+			                   m_bytes.data(), m_bytes.size()))
+			{
+				VEGAM_ERROR("Error reading {}", m_path);
+				break;
+			}
+
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const auto* frame =
+				    m_bytes.data() + i * m_blockAlign;
+				float samples[2];
+				for (uint32_t c = 0; c < m_channels; ++c)
+				{
+					const auto* p = frame + c * m_bytesPerSample;
+					if (m_encoding == Encoding::Float)
+					{
+						std::memcpy(&samples[c], p, sizeof(float));
+						continue;
+					}
+					switch (m_bytesPerSample)
+					{
+					case 1:
+						samples[c] =
+						    ToFloat(p[0] - 128, 1.0f / 128.0f);
+						break;
+					case 2:
+						samples[c] = ToFloat(
+						    static_cast<int16_t>(Read16(p)),
+						    1.0f / 32768.0f);
+						break;
+					case 3:
+						// Sign-extended from the top byte.
+						samples[c] = ToFloat(
+						    static_cast<int32_t>(
+						        static_cast<uint32_t>(p[0]) << 8
+						        | static_cast<uint32_t>(p[1]) << 16
+						        | static_cast<uint32_t>(p[2]) << 24)
+						        >> 8,
+						    1.0f / 8388608.0f);
+						break;
+					default:
+						samples[c] = ToFloat(
+						    static_cast<int32_t>(Read32(p)) >> 8,
+						    1.0f / 8388608.0f);
+						break;
+					}
+				}
+				out[(done + i) * 2] = samples[0];
+				out[(done + i) * 2 + 1] =
+				    samples[m_channels - 1];
+			}
+			m_frame += count;
+			done += count;
+		}
+		return done;
+	}
+
+	bool WavReader::DecodeBlock()
+	{
+		const auto block = m_frame / m_framesPerBlock;
+		const auto offset = block * m_blockAlign;
+		if (offset >= m_dataSize)
+		{
+			return false;
+		}
+		const auto size = static_cast<size_t>(
+		    std::min<uint64_t>(m_blockAlign, m_dataSize - offset));
+		m_bytes.resize(size);
+		if (!m_file.ReadAt(m_dataOffset + offset, m_bytes.data(),
+		                   size))
+		{
+			VEGAM_ERROR("Error reading {}", m_path);
+			return false;
+		}
+
+		const auto frames = static_cast<uint32_t>(
+		    std::min<uint64_t>(m_framesPerBlock,
+		                       m_frameCount - m_frame));
+		ImaChannel channels[2];
+		for (uint32_t c = 0; c < m_channels; ++c)
+		{
+			const auto* header = m_bytes.data() + c * 4;
+			channels[c].predictor =
+			    static_cast<int16_t>(Read16(header));
+			channels[c].index = std::min<int32_t>(header[2], 88);
+			m_block[c] = ToFloat(channels[c].predictor,
+			                     1.0f / 32768.0f);
+		}
+
+		// Each channel's samples come 8 at a time in 4
+		// bytes, low nibble first.
+		const auto* data = m_bytes.data() + 4 * m_channels;
+		const auto* end = m_bytes.data() + size;
+		for (uint32_t frame = 1; frame < frames; frame += 8)
+		{
+			for (uint32_t c = 0; c < m_channels; ++c)
+			{
+				if (data + 4 > end)
+				{
+					break;
+				}
+				for (uint32_t k = 0; k < 8; ++k)
+				{
+					const uint8_t nibble =
+					    data[k / 2] >> (k % 2 * 4) & 0xF;
+					const auto sample = channels[c].Decode(nibble);
+					if (frame + k < frames)
+					{
+						m_block[(frame + k) * 2 + c] = sample;
+					}
+				}
+				data += 4;
+			}
+		}
+		if (m_channels == 1)
+		{
+			for (uint32_t frame = 0; frame < frames; ++frame)
+			{
+				m_block[frame * 2 + 1] = m_block[frame * 2];
+			}
+		}
+
+		m_blockFrames = frames;
+		m_blockFrame = 0;
+		return frames > 0;
+	}
+} // namespace AthiVegam::Assets
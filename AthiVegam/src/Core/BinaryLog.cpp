@@ -0,0 +1,446 @@
+#include "AthiVegam/Core/BinaryLog.h"
+
+#include "AthiVegam/Core/CpuTopology.h"
+#include "AthiVegam/Log.h"
+#include "spdlog/fmt/bundled/args.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AthiVegam::Core::BinaryLog
+{
+	std::atomic<bool> Detail::recording{false};
+
+	namespace
+	{
+		constexpr uint32_t RingCapacity = 256 << 10;
+		constexpr auto DrainInterval =
+		    std::chrono::milliseconds(10);
+		constexpr char FileMagic[8] = {'A', 'V', 'B', 'L',
+		                               'O', 'G', '1', '\0'};
+
+		struct RecordHeader
+		{
+			uint32_t site;
+			uint32_t size;
+			// Nanoseconds since the epoch, on spdlog's clock.
+			uint64_t time;
+		};
+
+		// Single producer (the owning thread), single
+		// consumer (the writer thread). Records are written
+		// contiguously modulo the capacity.
+		struct ThreadRing
+		{
+			std::unique_ptr<uint8_t[]> data =
+			    std::make_unique<uint8_t[]>(RingCapacity);
+			std::atomic<uint64_t> write{0};
+			std::atomic<uint64_t> read{0};
+			std::atomic<uint32_t> dropped{0};
+			uint32_t index = 0;
+
+			void CopyIn(uint64_t position, const void* source,
+			            uint32_t size)
+			{
+				const auto offset = static_cast<uint32_t>(
+				    position % RingCapacity);
+				const auto first =
+				    std::min(size, RingCapacity - offset);
+				const auto* bytes =
+				    static_cast<const uint8_t*>(source);
+				std::memcpy(data.get() + offset, bytes, first);
+				std::memcpy(data.get(), bytes + first,
+				            size - first);
+			}
+
+			void CopyOut(uint64_t position, void* target,
+			             uint32_t size) const
+			{
+				const auto offset = static_cast<uint32_t>(
+				    position % RingCapacity);
+				const auto first =
+				    std::min(size, RingCapacity - offset);
+				auto* bytes = static_cast<uint8_t*>(target);
+				std::memcpy(bytes, data.get() + offset, first);
+				std::memcpy(bytes + first, data.get(),
+				            size - first);
+			}
+		};
+
+		std::mutex registryMutex;
+		std::vector<Site*> sites;
+		std::vector<std::unique_ptr<ThreadRing>> rings;
+
+		ThreadRing& GetThreadRing()
+		{
+			thread_local ThreadRing* ring = nullptr;
+			if (!ring)
+			{
+				std::lock_guard lock(registryMutex);
+				rings.push_back(std::make_unique<ThreadRing>());
+				ring = rings.back().get();
+				ring->index =
+				    static_cast<uint32_t>(rings.size() - 1);
+			}
+			return *ring;
+		}
+
+		template <typename T>
+		T Read(const uint8_t* data, uint32_t& offset)
+		{
+			T value;
+			std::memcpy(&value, data + offset, sizeof(T));
+			offset += sizeof(T);
+			return value;
+		}
+
+		std::string Format(const char* format,
+		                   const uint8_t* data, uint32_t size)
+		{
+			fmt::dynamic_format_arg_store<fmt::format_context>
+			    store;
+			uint32_t offset = 0;
+			while (offset < size)
+			{
+				const auto type =
+				    static_cast<ArgType>(data[offset++]);
+				switch (type)
+				{
+				case ArgType::Int64:
+					store.push_back(
+					    Read<int64_t>(data, offset));
+					break;
+				case ArgType::UInt64:
+					store.push_back(
+					    Read<uint64_t>(data, offset));
+					break;
+				case ArgType::Double:
+					store.push_back(
+					    Read<double>(data, offset));
+					break;
+				case ArgType::Bool:
+					store.push_back(
+					    Read<uint8_t>(data, offset) != 0);
+					break;
+				case ArgType::String:
+				{
+					const auto length =
+					    Read<uint16_t>(data, offset);
+					store.push_back(std::string(
+					    reinterpret_cast<const char*>(data)
+					        + offset,
+					    length));
+					offset += length;
+					break;
+				}
+				case ArgType::Pointer:
+				{
+					const auto address = static_cast<uintptr_t>(
+					    Read<uint64_t>(data, offset));
+					store.push_back(
+					    reinterpret_cast<const void*>(address));
+					break;
+				}
+				}
+			}
+
+			try
+			{
+				return fmt::vformat(format, store);
+			}
+			catch (const fmt::format_error& error)
+			{
+				return std::string(format) + " ("
+				       + error.what() + ")";
+			}
+		}
+
+		class Writer
+		{
+		  public:
+			~Writer() { Stop(); }
+
+			bool Start(BinaryLogMode mode,
+			           const std::string& path)
+			{
+				if (m_thread.joinable()
+				    || mode == BinaryLogMode::Off)
+				{
+					return false;
+				}
+
+				if (mode == BinaryLogMode::File)
+				{
+					m_file.open(path, std::ios::binary
+					                      | std::ios::trunc);
+					if (!m_file)
+					{
+						VEGAM_ERROR("Cannot open binary log {}",
+						            path);
+						return false;
+					}
+					m_file.write(FileMagic, sizeof(FileMagic));
+				}
+
+				m_mode = mode;
+				m_writtenSites.clear();
+				m_stop = false;
+				m_thread = std::thread([this] { Run(); });
+				Detail::recording.store(
+				    true, std::memory_order_relaxed);
+				return true;
+			}
+
+			void Stop()
+			{
+				Detail::recording.store(
+				    false, std::memory_order_relaxed);
+				{
+					std::lock_guard lock(m_mutex);
+					m_stop = true;
+				}
+				m_condition.notify_one();
+				if (m_thread.joinable())
+				{
+					m_thread.join();
+				}
+				if (m_file.is_open())
+				{
+					m_file.close();
+				}
+			}
+
+		  private:
+			void Run()
+			{
+				SetThreadClass(ThreadClass::Background);
+				for (;;)
+				{
+					bool stop = false;
+					{
+						std::unique_lock lock(m_mutex);
+						stop = m_condition.wait_for(
+						    lock, DrainInterval,
+						    [this] { return m_stop; });
+					}
+					Drain();
+					if (stop)
+					{
+						break;
+					}
+				}
+			}
+
+			void Drain()
+			{
+				std::vector<ThreadRing*> threadRings;
+				{
+					std::lock_guard lock(registryMutex);
+					m_sites = sites;
+					for (auto& ring : rings)
+					{
+						threadRings.push_back(ring.get());
+					}
+				}
+
+				for (auto* ring : threadRings)
+				{
+					const auto write = ring->write.load(
+					    std::memory_order_acquire);
+					auto read =
+					    ring->read.load(std::memory_order_relaxed);
+					while (read < write)
+					{
+						RecordHeader header;
+						ring->CopyOut(read, &header,
+						              sizeof(header));
+						m_payload.resize(header.size);
+						ring->CopyOut(read + sizeof(header),
+						              m_payload.data(),
+						              header.size);
+						read += sizeof(header) + header.size;
+						Dispatch(*ring, header);
+					}
+					ring->read.store(read,
+					                 std::memory_order_release);
+
+					const auto dropped = ring->dropped.exchange(
+					    0, std::memory_order_relaxed);
+					if (dropped > 0)
+					{
+						ReportDropped(*ring, dropped);
+					}
+				}
+
+				if (m_file.is_open())
+				{
+					m_file.flush();
+				}
+			}
+
+			void Dispatch(const ThreadRing& ring,
+			              const RecordHeader& header)
+			{
+				const auto& site = *m_sites[header.site - 1];
+				if (m_mode == BinaryLogMode::Format)
+				{
+					auto* logger =
+					    Managers::LogManager::GetLogger();
+					if (!logger)
+					{
+						return;
+					}
+					using spdlog::log_clock;
+					const log_clock::time_point time(
+					    std::chrono::duration_cast<
+					        log_clock::duration>(
+					        std::chrono::nanoseconds(
+					            header.time)));
+					const spdlog::source_loc location{
+					    site.file, static_cast<int>(site.line),
+					    ""};
+					logger->log(
+					    time, location,
+					    static_cast<spdlog::level::level_enum>(
+					        site.level),
+					    Format(site.format, m_payload.data(),
+					           header.size));
+					return;
+				}
+
+				WriteSite(header.site, site);
+				Put('M');
+				Put(header.site);
+				Put(ring.index);
+				Put(header.time);
+				Put(header.size);
+				m_file.write(reinterpret_cast<const char*>(
+				                 m_payload.data()),
+				             header.size);
+			}
+
+			// Site table entries go out ahead of their first
+			// message, so the file can be decoded in one pass.
+			void WriteSite(uint32_t id, const Site& site)
+			{
+				if (m_writtenSites.size() < id)
+				{
+					m_writtenSites.resize(id, false);
+				}
+				if (m_writtenSites[id - 1])
+				{
+					return;
+				}
+				m_writtenSites[id - 1] = true;
+
+				Put('S');
+				Put(id);
+				Put(site.level);
+				Put(site.line);
+				PutString(site.file);
+				PutString(site.format);
+			}
+
+			void ReportDropped(const ThreadRing& ring,
+			                   uint32_t count)
+			{
+				if (m_mode == BinaryLogMode::Format)
+				{
+					VEGAM_WARN("Binary log dropped {} messages "
+					           "from thread {}",
+					           count, ring.index);
+					return;
+				}
+				Put('D');
+				Put(ring.index);
+				Put(count);
+			}
+
+			template <typename T>
+			inline void Put(T value)
+			{
+				m_file.write(
+				    reinterpret_cast<const char*>(&value),
+				    sizeof(T));
+			}
+
+			inline void PutString(std::string_view text)
+			{
+				Put(static_cast<uint16_t>(text.size()));
+				m_file.write(text.data(), text.size());
+			}
+
+		  private:
+			std::thread m_thread;
+			std::mutex m_mutex;
+			std::condition_variable m_condition;
+			bool m_stop = false;
+			BinaryLogMode m_mode = BinaryLogMode::Off;
+
+			// Writer thread only while running.
+			std::ofstream m_file;
+			std::vector<Site*> m_sites;
+			std::vector<bool> m_writtenSites;
+			std::vector<uint8_t> m_payload;
+		};
+
+		Writer logWriter;
+	} // namespace
+
+	bool Start(BinaryLogMode mode, const std::string& path)
+	{
+		return logWriter.Start(mode, path);
+	}
+
+	void Stop() { logWriter.Stop(); }
+
+	uint32_t Detail::Register(Site& site, const char* format)
+	{
+		std::lock_guard lock(registryMutex);
+		auto id = site.id.load(std::memory_order_relaxed);
+		if (id == 0)
+		{
+			site.format = format;
+			sites.push_back(&site);
+			id = static_cast<uint32_t>(sites.size());
+			site.id.store(id, std::memory_order_release);
+		}
+		return id;
+	}
+
+	void Detail::Commit(uint32_t site,
+	                    const RecordWriter& writer)
+	{
+		auto& ring = GetThreadRing();
+		const RecordHeader header{
+		    site, writer.GetSize(),
+		    static_cast<uint64_t>(
+		        std::chrono::duration_cast<
+		            std::chrono::nanoseconds>(
+		            spdlog::log_clock::now().time_since_epoch())
+		            .count())};
+		const auto size = sizeof(header) + header.size;
+
+		const auto write =
+		    ring.write.load(std::memory_order_relaxed);
+		if (writer.HasOverflowed()
+		    || write + size
+		           - ring.read.load(std::memory_order_acquire)
+		           > RingCapacity)
+		{
+			ring.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		ring.CopyIn(write, &header, sizeof(header));
+		ring.CopyIn(write + sizeof(header), writer.GetData(),
+		            header.size);
+		ring.write.store(write + size,
+		                 std::memory_order_release);
+	}
+} // namespace AthiVegam::Core::BinaryLog
@@ -0,0 +1,313 @@
+#include "AthiVegam/Core/CVar.h"
+
+#include "AthiVegam/Log.h"
+#include "external/imgui/imgui.h"
+
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+
+namespace AthiVegam::Core
+{
+	namespace
+	{
+		// Constant-initialized, so variables may register
+		// during any other static initialization.
+		CVarBase* first = nullptr;
+
+		std::string_view Trim(std::string_view text)
+		{
+			while (!text.empty()
+			       && std::isspace(
+			           static_cast<unsigned char>(text.front())))
+			{
+				text.remove_prefix(1);
+			}
+			while (!text.empty()
+			       && std::isspace(
+			           static_cast<unsigned char>(text.back())))
+			{
+				text.remove_suffix(1);
+			}
+			return text;
+		}
+
+		bool ParseBool(std::string_view text, uint32_t& bits)
+		{
+			if (text == "1" || text == "true" || text == "on")
+			{
+				bits = 1;
+				return true;
+			}
+			if (text == "0" || text == "false" || text == "off")
+			{
+				bits = 0;
+				return true;
+			}
+			return false;
+		}
+
+		bool ParseInt(std::string_view text, uint32_t& bits)
+		{
+			auto negative = false;
+			if (text.starts_with('-'))
+			{
+				negative = true;
+				text.remove_prefix(1);
+			}
+			auto base = 10;
+			if (text.starts_with("0x") || text.starts_with("0X"))
+			{
+				base = 16;
+				text.remove_prefix(2);
+			}
+			if (text.starts_with('-'))
+			{
+				return false;
+			}
+			int64_t value = 0;
+			const auto* end = text.data() + text.size();
+			const auto result =
+			    std::from_chars(text.data(), end, value, base);
+			if (result.ec != std::errc() || result.ptr != end)
+			{
+				return false;
+			}
+			value = negative ? -value : value;
+			// Hex up to 0xFFFFFFFF, e.g. colors.
+			if (value < INT32_MIN || value > UINT32_MAX)
+			{
+				return false;
+			}
+			bits = static_cast<uint32_t>(value);
+			return true;
+		}
+
+		bool ParseFloat(std::string_view text, uint32_t& bits)
+		{
+			float value = 0.0f;
+			const auto* end = text.data() + text.size();
+			const auto result =
+			    std::from_chars(text.data(), end, value);
+			if (result.ec != std::errc() || result.ptr != end)
+			{
+				return false;
+			}
+			bits = std::bit_cast<uint32_t>(value);
+			return true;
+		}
+	} // namespace
+
+	CVarBase::CVarBase(const char* name,
+	                   const char* description, Type type,
+	                   uint32_t bits)
+	    : m_name(name), m_id(MakeStringId(name)),
+	      m_description(description),
+	      m_type(type), m_default(bits), m_bits(bits),
+	      m_next(first)
+	{
+		first = this;
+	}
+
+	CVarBase::~CVarBase()
+	{
+		for (auto** link = &first; *link != nullptr;
+		     link = &(*link)->m_next)
+		{
+			if (*link == this)
+			{
+				*link = m_next;
+				return;
+			}
+		}
+	}
+
+	bool CVarBase::Set(std::string_view value)
+	{
+		value = Trim(value);
+		uint32_t bits = 0;
+		const auto parsed =
+		    m_type == Type::Bool  ? ParseBool(value, bits)
+		    : m_type == Type::Int ? ParseInt(value, bits)
+		                          : ParseFloat(value, bits);
+		if (parsed)
+		{
+			SetBits(bits);
+		}
+		return parsed;
+	}
+
+	std::string CVarBase::ToString() const
+	{
+		const auto bits = GetBits();
+		switch (m_type)
+		{
+		case Type::Bool:
+			return bits != 0 ? "true" : "false";
+		case Type::Int:
+			return std::to_string(static_cast<int32_t>(bits));
+		default:
+			return fmt::format("{}", std::bit_cast<float>(bits));
+		}
+	}
+
+	void CVarBase::SetBits(uint32_t bits)
+	{
+		m_bits.store(bits, std::memory_order_relaxed);
+		m_version.fetch_add(1, std::memory_order_release);
+	}
+
+	namespace CVars
+	{
+		CVarBase* Find(StringId id)
+		{
+			for (auto* cvar = first; cvar != nullptr;
+			     cvar = cvar->GetNext())
+			{
+				if (cvar->GetId() == id)
+				{
+					return cvar;
+				}
+			}
+			return nullptr;
+		}
+
+		CVarBase* GetFirst()
+		{
+			return first;
+		}
+
+		bool Set(std::string_view name,
+		         std::string_view value)
+		{
+			auto* cvar = Find(name);
+			if (cvar == nullptr)
+			{
+				VEGAM_WARN("Unknown CVar {}", name);
+				return false;
+			}
+			if (!cvar->Set(value))
+			{
+				VEGAM_WARN("Bad value for CVar {}: {}", name,
+				           value);
+				return false;
+			}
+			return true;
+		}
+
+		bool Execute(std::string_view line)
+		{
+			line = Trim(line);
+			if (line.empty() || line.starts_with('#'))
+			{
+				return true;
+			}
+
+			const auto space = line.find_first_of(" \t");
+			const auto name = line.substr(0, space);
+			if (space != std::string_view::npos)
+			{
+				return Set(name, line.substr(space));
+			}
+			if (const auto* cvar = Find(name))
+			{
+				VEGAM_INFO("{} = {} ({})", name,
+				           cvar->ToString(),
+				           cvar->GetDescription());
+				return true;
+			}
+			VEGAM_WARN("Unknown CVar {}", name);
+			return false;
+		}
+
+		bool LoadFile(const std::string& path)
+		{
+			std::ifstream file(path);
+			if (!file)
+			{
+				return false;
+			}
+			std::string line;
+			while (std::getline(file, line))
+			{
+				Execute(line);
+			}
+			VEGAM_INFO("Loaded CVars from {}", path);
+			return true;
+		}
+
+		void DrawPanel()
+		{
+			if (!ImGui::Begin("Console"))
+			{
+				ImGui::End();
+				return;
+			}
+
+			static std::array<char, 256> command{};
+			if (ImGui::InputText(
+			        "Command", command.data(), command.size(),
+			        ImGuiInputTextFlags_EnterReturnsTrue))
+			{
+				Execute(command.data());
+				command[0] = '\0';
+				ImGui::SetKeyboardFocusHere(-1);
+			}
+			static ImGuiTextFilter filter;
+			filter.Draw("Filter");
+			ImGui::Separator();
+
+			for (auto* cvar = first; cvar != nullptr;
+			     cvar = cvar->GetNext())
+			{
+				if (!filter.PassFilter(cvar->GetName()))
+				{
+					continue;
+				}
+				// Edit a copy: Set() counts the change.
+				const auto* name = cvar->GetName();
+				switch (cvar->GetType())
+				{
+				case CVarBase::Type::Bool:
+				{
+					auto& var = static_cast<CVar<bool>&>(*cvar);
+					auto value = var.Get();
+					if (ImGui::Checkbox(name, &value))
+					{
+						var.Set(value);
+					}
+					break;
+				}
+				case CVarBase::Type::Int:
+				{
+					auto& var =
+					    static_cast<CVar<int32_t>&>(*cvar);
+					auto value = var.Get();
+					if (ImGui::InputInt(name, &value))
+					{
+						var.Set(value);
+					}
+					break;
+				}
+				case CVarBase::Type::Float:
+				{
+					auto& var = static_cast<CVar<float>&>(*cvar);
+					auto value = var.Get();
+					if (ImGui::DragFloat(name, &value, 0.01f))
+					{
+						var.Set(value);
+					}
+					break;
+				}
+				}
+				if (ImGui::IsItemHovered())
+				{
+					ImGui::SetTooltip("%s",
+					                  cvar->GetDescription());
+				}
+			}
+			ImGui::End();
+		}
+	} // namespace CVars
+} // namespace AthiVegam::Core
@@ -0,0 +1,42 @@
+#include "AthiVegam/Core/CpuFeatures.h"
+
+#include "AthiVegam/Log.h"
+#include "SDL2/SDL_cpuinfo.h"
+
+namespace AthiVegam::Core
+{
+	namespace
+	{
+		CpuFeatures Detect()
+		{
+			CpuFeatures cpu;
+			cpu.sse2 = SDL_HasSSE2();
+			cpu.sse41 = SDL_HasSSE41();
+			cpu.avx = SDL_HasAVX();
+			cpu.avx2 = SDL_HasAVX2();
+			cpu.avx512f = SDL_HasAVX512F();
+			cpu.neon = SDL_HasNEON();
+			cpu.cores = static_cast<uint32_t>(SDL_GetCPUCount());
+			cpu.cacheLine =
+			    static_cast<uint32_t>(SDL_GetCPUCacheLineSize());
+			return cpu;
+		}
+	} // namespace
+
+	const CpuFeatures& GetCpuFeatures()
+	{
+		static const auto cpu = Detect();
+		return cpu;
+	}
+
+	void LogCpuFeatures()
+	{
+		const auto& cpu = GetCpuFeatures();
+		VEGAM_INFO("CPU: {} cores, {} byte lines, SSE2 {}, "
+		           "SSE4.1 {}, AVX {}, AVX2 {}, AVX-512F {}, "
+		           "NEON {}",
+		           cpu.cores, cpu.cacheLine, cpu.sse2,
+		           cpu.sse41, cpu.avx, cpu.avx2, cpu.avx512f,
+		           cpu.neon);
+	}
+} // namespace AthiVegam::Core
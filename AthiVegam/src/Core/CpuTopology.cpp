@@ -0,0 +1,298 @@
+#include "AthiVegam/Core/CpuTopology.h"
+
+#include "AthiVegam/Core/CVar.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+
+#ifdef AV_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(AV_PLATFORM_MAC)
+#include <pthread.h>
+#include <sys/qos.h>
+#include <sys/sysctl.h>
+#else
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif // AV_PLATFORM_WINDOWS
+
+namespace AthiVegam::Core
+{
+	namespace
+	{
+		CVar<bool> threadPlacementCVar(
+		    "cpu.threadPlacement", true,
+		    "Keep frame threads on performance cores and "
+		    "background ones on efficiency cores");
+
+#if !defined(AV_PLATFORM_WINDOWS) && !defined(AV_PLATFORM_MAC)
+		bool ReadText(const std::string& path,
+		              std::string& text)
+		{
+			std::ifstream file(path);
+			return static_cast<bool>(std::getline(file, text));
+		}
+
+		// sysfs lists, e.g. "0-7,12".
+		std::vector<uint32_t> ParseCpuList(
+		    const std::string& text)
+		{
+			std::vector<uint32_t> cpus;
+			size_t at = 0;
+			while (at < text.size())
+			{
+				auto end = text.find(',', at);
+				if (end == std::string::npos)
+				{
+					end = text.size();
+				}
+				const auto range = text.substr(at, end - at);
+				const auto dash = range.find('-');
+				const auto first = std::stoul(range);
+				const auto last =
+				    dash == std::string::npos
+				        ? first
+				        : std::stoul(range.substr(dash + 1));
+				for (auto cpu = first; cpu <= last; ++cpu)
+				{
+					cpus.push_back(static_cast<uint32_t>(cpu));
+				}
+				at = end + 1;
+			}
+			return cpus;
+		}
+#endif
+
+		CpuTopology Detect()
+		{
+			CpuTopology topology;
+#ifdef AV_PLATFORM_WINDOWS
+			// Only the first processor group, which affinity
+			// masks can address.
+			using Info = SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX;
+			DWORD size = 0;
+			GetLogicalProcessorInformationEx(
+			    RelationProcessorCore, nullptr, &size);
+			std::vector<std::byte> buffer(size);
+			if (size > 0
+			    && GetLogicalProcessorInformationEx(
+			        RelationProcessorCore,
+			        reinterpret_cast<Info*>(buffer.data()),
+			        &size))
+			{
+				const auto forEachCore = [&](auto&& function) {
+					for (DWORD offset = 0; offset < size;)
+					{
+						const auto* info = reinterpret_cast<Info*>(
+						    buffer.data() + offset);
+						const auto& core = info->Processor;
+						if (core.GroupMask[0].Group == 0)
+						{
+							function(core);
+						}
+						offset += info->Size;
+					}
+				};
+				// Higher classes are faster.
+				BYTE fastest = 0;
+				forEachCore([&](const auto& core) {
+					fastest = std::max(fastest,
+					                   core.EfficiencyClass);
+				});
+				forEachCore([&](const auto& core) {
+					auto& cpus = core.EfficiencyClass == fastest
+					                 ? topology.performance
+					                 : topology.efficiency;
+					const auto mask = core.GroupMask[0].Mask;
+					for (uint32_t cpu = 0; cpu < 64; ++cpu)
+					{
+						if (mask & (KAFFINITY(1) << cpu))
+						{
+							cpus.push_back(cpu);
+						}
+					}
+				});
+			}
+#elif defined(AV_PLATFORM_MAC)
+			// Threads can't be pinned, so the ids only count
+			// the cores.
+			int levels = 0;
+			int performance = 0;
+			int efficiency = 0;
+			size_t size = sizeof(int);
+			if (sysctlbyname("hw.nperflevels", &levels, &size,
+			                 nullptr, 0)
+			        == 0
+			    && levels >= 2)
+			{
+				sysctlbyname("hw.perflevel0.logicalcpu",
+				             &performance, &size, nullptr, 0);
+				sysctlbyname("hw.perflevel1.logicalcpu",
+				             &efficiency, &size, nullptr, 0);
+			}
+			for (int cpu = 0; cpu < performance + efficiency;
+			     ++cpu)
+			{
+				(cpu < performance ? topology.performance
+				                   : topology.efficiency)
+				    .push_back(static_cast<uint32_t>(cpu));
+			}
+#else
+			// Intel hybrid parts list each core type's CPUs;
+			// ARM big.LITTLE parts rank cores by capacity.
+			std::string text;
+			if (ReadText("/sys/devices/cpu_core/cpus", text))
+			{
+				topology.performance = ParseCpuList(text);
+			}
+			if (ReadText("/sys/devices/cpu_atom/cpus", text))
+			{
+				topology.efficiency = ParseCpuList(text);
+			}
+			if (!topology.IsHybrid())
+			{
+				topology = {};
+				std::vector<std::pair<uint32_t, uint32_t>> cpus;
+				uint32_t highest = 0;
+				const auto count =
+				    std::thread::hardware_concurrency();
+				for (uint32_t cpu = 0; cpu < count; ++cpu)
+				{
+					if (!ReadText("/sys/devices/system/cpu/cpu"
+					                  + std::to_string(cpu)
+					                  + "/cpu_capacity",
+					              text))
+					{
+						cpus.clear();
+						break;
+					}
+					const auto capacity =
+					    static_cast<uint32_t>(std::stoul(text));
+					highest = std::max(highest, capacity);
+					cpus.emplace_back(cpu, capacity);
+				}
+				for (const auto& [cpu, capacity] : cpus)
+				{
+					(capacity == highest ? topology.performance
+					                     : topology.efficiency)
+					    .push_back(cpu);
+				}
+			}
+#endif // AV_PLATFORM_WINDOWS
+
+			if (topology.IsHybrid())
+			{
+				VEGAM_INFO("Hybrid CPU: {} performance and {} "
+				           "efficiency logical CPUs",
+				           topology.performance.size(),
+				           topology.efficiency.size());
+				return topology;
+			}
+			topology = {};
+			const auto count =
+			    std::thread::hardware_concurrency();
+			for (uint32_t cpu = 0; cpu < count; ++cpu)
+			{
+				topology.performance.push_back(cpu);
+			}
+			return topology;
+		}
+	} // namespace
+
+	const CpuTopology& GetCpuTopology()
+	{
+		static const auto topology = Detect();
+		return topology;
+	}
+
+	void SetThreadClass(ThreadClass threadClass)
+	{
+		if (!threadPlacementCVar.Get())
+		{
+			return;
+		}
+
+		const auto& topology = GetCpuTopology();
+		const auto& cpus = threadClass == ThreadClass::Background
+		                       ? topology.efficiency
+		                       : topology.performance;
+#ifdef AV_PLATFORM_WINDOWS
+		auto* const thread = GetCurrentThread();
+		if (topology.IsHybrid())
+		{
+			DWORD_PTR mask = 0;
+			for (const auto cpu : cpus)
+			{
+				mask |= DWORD_PTR(1) << cpu;
+			}
+			SetThreadAffinityMask(thread, mask);
+		}
+		SetThreadPriority(
+		    thread, threadClass == ThreadClass::Latency
+		                ? THREAD_PRIORITY_ABOVE_NORMAL
+		            : threadClass == ThreadClass::Background
+		                ? THREAD_PRIORITY_BELOW_NORMAL
+		                : THREAD_PRIORITY_NORMAL);
+#ifdef THREAD_POWER_THROTTLING_CURRENT_VERSION
+		// EcoQoS, which also steers the scheduler to
+		// efficiency cores.
+		THREAD_POWER_THROTTLING_STATE throttling{};
+		throttling.Version =
+		    THREAD_POWER_THROTTLING_CURRENT_VERSION;
+		throttling.ControlMask =
+		    THREAD_POWER_THROTTLING_EXECUTION_SPEED;
+		throttling.StateMask =
+		    threadClass == ThreadClass::Background
+		        ? THREAD_POWER_THROTTLING_EXECUTION_SPEED
+		        : 0;
+		SetThreadInformation(thread, ThreadPowerThrottling,
+		                     &throttling, sizeof(throttling));
+#endif
+#elif defined(AV_PLATFORM_MAC)
+		// Quality of service picks the core type.
+		(void)cpus;
+		pthread_set_qos_class_self_np(
+		    threadClass == ThreadClass::Latency
+		        ? QOS_CLASS_USER_INTERACTIVE
+		    : threadClass == ThreadClass::Background
+		        ? QOS_CLASS_UTILITY
+		        : QOS_CLASS_USER_INITIATED,
+		    0);
+#else
+		// Threads inherit their creator's affinity and
+		// niceness, so every class sets both.
+		if (topology.IsHybrid())
+		{
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			for (const auto cpu : cpus)
+			{
+				if (cpu < CPU_SETSIZE)
+				{
+					CPU_SET(cpu, &set);
+				}
+			}
+			pthread_setaffinity_np(pthread_self(), sizeof(set),
+			                       &set);
+		}
+		// Raising it needs CAP_SYS_NICE; without it the
+		// thread keeps its niceness.
+		const int niceness =
+		    threadClass == ThreadClass::Latency      ? -5
+		    : threadClass == ThreadClass::Background ? 5
+		                                             : 0;
+		setpriority(PRIO_PROCESS,
+		            static_cast<id_t>(syscall(SYS_gettid)),
+		            niceness);
+#endif // AV_PLATFORM_WINDOWS
+	}
+} // namespace AthiVegam::Core
@@ -0,0 +1,52 @@
+#include "AthiVegam/Core/EventBus.h"
+
+#include "AthiVegam/Core/Profiler.h"
+
+#include <atomic>
+
+namespace AthiVegam::Core
+{
+	namespace
+	{
+		std::atomic<EventTypeId> eventTypeCount{0};
+	}
+
+	EventTypeId RegisterEventType()
+	{
+		return eventTypeCount.fetch_add(
+		    1, std::memory_order_relaxed);
+	}
+
+	void EventBus::Unsubscribe(SubscriptionId id)
+	{
+		const auto it = m_subscriptions.find(id);
+		if (it == m_subscriptions.end())
+		{
+			return;
+		}
+		const auto type = it->second;
+		m_subscriptions.erase(it);
+		m_queues[type]->Unsubscribe(id);
+	}
+
+	void EventBus::Dispatch()
+	{
+		VEGAM_PROFILE_SCOPE("EventBus::Dispatch");
+		// By index: a handler may publish a new type.
+		for (size_t i = 0; i < m_order.size(); ++i)
+		{
+			m_queues[m_order[i]]->Dispatch();
+		}
+	}
+
+	void EventBus::Clear()
+	{
+		for (auto& queue : m_queues)
+		{
+			if (queue)
+			{
+				queue->Clear();
+			}
+		}
+	}
+} // namespace AthiVegam::Core
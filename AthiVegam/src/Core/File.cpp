@@ -0,0 +1,142 @@
+#include "AthiVegam/Core/File.h"
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+
+#ifdef AV_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // AV_PLATFORM_WINDOWS
+
+namespace AthiVegam::Core
+{
+	File::~File() { Close(); }
+
+#ifdef AV_PLATFORM_WINDOWS
+	bool File::Open(const std::string& path)
+	{
+		Close();
+		auto handle = CreateFileA(
+		    path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+		    nullptr, OPEN_EXISTING,
+		    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+		    nullptr);
+		LARGE_INTEGER size{};
+		if (handle == INVALID_HANDLE_VALUE)
+		{
+			VEGAM_ERROR("Error opening {}", path);
+			return false;
+		}
+		if (!GetFileSizeEx(handle, &size))
+		{
+			VEGAM_ERROR("Error reading the size of {}", path);
+			CloseHandle(handle);
+			return false;
+		}
+
+		m_handle = handle;
+		m_size = static_cast<uint64_t>(size.QuadPart);
+		m_isOpen = true;
+		return true;
+	}
+
+	void File::Close()
+	{
+		if (m_isOpen)
+		{
+			CloseHandle(m_handle);
+		}
+		m_handle = nullptr;
+		m_size = 0;
+		m_isOpen = false;
+	}
+
+	bool File::ReadAt(uint64_t offset, void* dst,
+	                  size_t size) const
+	{
+		auto* out = static_cast<uint8_t*>(dst);
+		while (size > 0)
+		{
+			// The offset comes in through the OVERLAPPED, so
+			// the handle's own position is never used.
+			OVERLAPPED overlapped{};
+			overlapped.Offset = static_cast<DWORD>(offset);
+			overlapped.OffsetHigh =
+			    static_cast<DWORD>(offset >> 32);
+			const auto request = static_cast<DWORD>(
+			    std::min<size_t>(size, 1u << 30));
+			DWORD read = 0;
+			if (!ReadFile(m_handle, out, request, &read,
+			              &overlapped)
+			    || read == 0)
+			{
+				return false;
+			}
+			out += read;
+			offset += read;
+			size -= read;
+		}
+		return true;
+	}
+#else
+	bool File::Open(const std::string& path)
+	{
+		Close();
+		const int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			VEGAM_ERROR("Error opening {}", path);
+			return false;
+		}
+
+		struct stat info{};
+		if (fstat(fd, &info) != 0)
+		{
+			VEGAM_ERROR("Error reading the size of {}", path);
+			close(fd);
+			return false;
+		}
+
+		m_fd = fd;
+		m_size = static_cast<uint64_t>(info.st_size);
+		m_isOpen = true;
+		return true;
+	}
+
+	void File::Close()
+	{
+		if (m_isOpen)
+		{
+			close(m_fd);
+		}
+		m_fd = -1;
+		m_size = 0;
+		m_isOpen = false;
+	}
+
+	bool File::ReadAt(uint64_t offset, void* dst,
+	                  size_t size) const
+	{
+		auto* out = static_cast<uint8_t*>(dst);
+		while (size > 0)
+		{
+			const auto read =
+			    pread(m_fd, out, size, static_cast<off_t>(offset));
+			if (read <= 0)
+			{
+				return false;
+			}
+			out += read;
+			offset += static_cast<uint64_t>(read);
+			size -= static_cast<size_t>(read);
+		}
+		return true;
+	}
+#endif // AV_PLATFORM_WINDOWS
+} // namespace AthiVegam::Core
@@ -0,0 +1,135 @@
+#include "AthiVegam/Core/FileWatcher.h"
+
+#include "AthiVegam/Core/CpuTopology.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+
+namespace AthiVegam::Core
+{
+	namespace
+	{
+		std::filesystem::file_time_type
+		GetWriteTime(const std::string& path)
+		{
+			std::error_code error;
+			const auto time =
+			    std::filesystem::last_write_time(path, error);
+			return error ? std::filesystem::file_time_type::min()
+			             : time;
+		}
+	} // namespace
+
+	FileWatcher::~FileWatcher() { Stop(); }
+
+	bool FileWatcher::Start(std::chrono::milliseconds interval,
+	                        std::function<void()> onChange)
+	{
+		VEGAM_ASSERT(!IsRunning(),
+		             "File watcher is already running!");
+		if (IsRunning())
+		{
+			return false;
+		}
+
+		m_interval = interval;
+		m_onChange = std::move(onChange);
+		m_stopRequested = false;
+		m_thread = std::thread(&FileWatcher::Run, this);
+		return true;
+	}
+
+	void FileWatcher::Stop()
+	{
+		if (!IsRunning())
+		{
+			return;
+		}
+
+		{
+			std::lock_guard lock(m_mutex);
+			m_stopRequested = true;
+		}
+		m_condition.notify_all();
+		m_thread.join();
+	}
+
+	void FileWatcher::Watch(const std::string& path)
+	{
+		const auto time = GetWriteTime(path);
+		std::lock_guard lock(m_mutex);
+		m_files.try_emplace(path, time);
+	}
+
+	void FileWatcher::Unwatch(const std::string& path)
+	{
+		std::lock_guard lock(m_mutex);
+		m_files.erase(path);
+		std::erase(m_changes, path);
+	}
+
+	std::vector<std::string> FileWatcher::TakeChanges()
+	{
+		std::lock_guard lock(m_mutex);
+		return std::exchange(m_changes, {});
+	}
+
+	void FileWatcher::Run()
+	{
+		Profiler::SetThreadName("FileWatcher");
+		SetThreadClass(ThreadClass::Background);
+		std::vector<std::string> paths;
+		std::vector<std::filesystem::file_time_type> times;
+
+		std::unique_lock lock(m_mutex);
+		while (!m_condition.wait_for(lock, m_interval, [this] {
+			return m_stopRequested;
+		}))
+		{
+			// Stat outside the lock, so Watch() and
+			// TakeChanges() never wait on the disk.
+			paths.clear();
+			for (const auto& [path, time] : m_files)
+			{
+				paths.push_back(path);
+			}
+			lock.unlock();
+			times.resize(paths.size());
+			std::transform(paths.begin(), paths.end(),
+			               times.begin(), GetWriteTime);
+			lock.lock();
+
+			bool changed = false;
+			for (size_t i = 0; i < paths.size(); ++i)
+			{
+				const auto it = m_files.find(paths[i]);
+				if (it == m_files.end()
+				    || it->second == times[i])
+				{
+					continue;
+				}
+				it->second = times[i];
+				// Deleted files are reported once they
+				// come back.
+				if (times[i]
+				        == std::filesystem::file_time_type::min()
+				    || std::find(m_changes.begin(),
+				                 m_changes.end(), paths[i])
+				           != m_changes.end())
+				{
+					continue;
+				}
+				m_changes.push_back(paths[i]);
+				changed = true;
+			}
+
+			if (changed && m_onChange)
+			{
+				lock.unlock();
+				m_onChange();
+				lock.lock();
+			}
+		}
+	}
+} // namespace AthiVegam::Core
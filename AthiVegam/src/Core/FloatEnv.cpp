@@ -0,0 +1,45 @@
+#include "AthiVegam/Core/FloatEnv.h"
+
+#include "AthiVegam/Core/CpuFeatures.h"
+
+#include <cfenv>
+
+#ifdef AV_CPU_X86
+#include <xmmintrin.h>
+#endif // AV_CPU_X86
+
+namespace AthiVegam::Core::FloatEnv
+{
+	namespace
+	{
+#ifdef AV_CPU_X86
+		// MXCSR: flush to zero, denormals are zero and the
+		// SSE rounding mode.
+		constexpr unsigned int FlushToZero = 0x8000;
+		constexpr unsigned int DenormalsAreZero = 0x0040;
+		constexpr unsigned int RoundingMask = 0x6000;
+		constexpr unsigned int ModeMask =
+		    FlushToZero | DenormalsAreZero | RoundingMask;
+#endif // AV_CPU_X86
+	} // namespace
+
+	void SetDeterministic()
+	{
+		std::fesetround(FE_TONEAREST);
+#ifdef AV_CPU_X86
+		// Exception masks and flags are left alone.
+		_mm_setcsr(_mm_getcsr() & ~ModeMask);
+#endif // AV_CPU_X86
+	}
+
+	bool IsDeterministic()
+	{
+#ifdef AV_CPU_X86
+		if ((_mm_getcsr() & ModeMask) != 0)
+		{
+			return false;
+		}
+#endif // AV_CPU_X86
+		return std::fegetround() == FE_TONEAREST;
+	}
+} // namespace AthiVegam::Core::FloatEnv
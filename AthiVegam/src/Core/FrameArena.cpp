@@ -0,0 +1,101 @@
+#include "AthiVegam/Core/FrameArena.h"
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+
+namespace AthiVegam::Core
+{
+	namespace
+	{
+		inline uintptr_t AlignUp(uintptr_t value,
+		                         size_t alignment)
+		{
+			return (value + alignment - 1)
+			       & ~static_cast<uintptr_t>(alignment - 1);
+		}
+	} // namespace
+
+	void FrameArena::Initialize(size_t capacity,
+	                            size_t reserve, bool largePages)
+	{
+		VirtualArena::Settings settings;
+		settings.reserve = std::max(reserve, capacity);
+		settings.commit = capacity;
+		settings.largePages = largePages;
+		settings.tag = Memory::Tag::Core;
+		for (auto& buffer : m_buffers)
+		{
+			// Failing that, every allocation overflows.
+			buffer.memory.Initialize(settings);
+		}
+		m_current = 0;
+	}
+
+	void FrameArena::Shutdown()
+	{
+		for (auto& buffer : m_buffers)
+		{
+			buffer.memory.Shutdown();
+			buffer.overflow.clear();
+			buffer.overflowSize = 0;
+		}
+	}
+
+	void* FrameArena::Allocate(size_t size, size_t alignment)
+	{
+		auto& buffer = m_buffers[m_current];
+		if (auto* memory =
+		        buffer.memory.Allocate(size, alignment))
+		{
+			return memory;
+		}
+		return AllocateOverflow(buffer, size, alignment);
+	}
+
+	void* FrameArena::AllocateOverflow(Buffer& buffer,
+	                                   size_t size,
+	                                   size_t alignment)
+	{
+		std::lock_guard lock(m_overflowMutex);
+		if (buffer.overflow.empty())
+		{
+			VEGAM_WARN("Frame arena of {} bytes is full; "
+			           "falling back to the heap",
+			           buffer.memory.GetReserved());
+		}
+
+		const auto padded = size + alignment - 1;
+		buffer.overflow.emplace_back(padded);
+		buffer.overflowSize += padded;
+
+		const auto base = reinterpret_cast<uintptr_t>(
+		    buffer.overflow.back().data());
+		return reinterpret_cast<void*>(
+		    AlignUp(base, alignment));
+	}
+
+	void FrameArena::NextFrame()
+	{
+		m_current ^= 1;
+		Reset(m_buffers[m_current]);
+	}
+
+	void FrameArena::Reset(Buffer& buffer)
+	{
+		buffer.overflow.clear();
+		buffer.overflowSize = 0;
+		buffer.memory.Reset();
+	}
+
+	size_t FrameArena::GetUsed() const
+	{
+		const auto& buffer = m_buffers[m_current];
+		return buffer.memory.GetUsed() + buffer.overflowSize;
+	}
+
+	size_t FrameArena::GetCapacity() const
+	{
+		return m_buffers[m_current].memory.GetCommitted();
+	}
+} // namespace AthiVegam::Core
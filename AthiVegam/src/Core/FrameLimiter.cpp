@@ -0,0 +1,59 @@
+#include "AthiVegam/Core/FrameLimiter.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace AthiVegam::Core
+{
+	void FrameLimiter::Wait(double frameRate)
+	{
+		const auto now = Clock::now();
+		if (frameRate <= 0.0)
+		{
+			m_started = false;
+			return;
+		}
+
+		const auto period =
+		    std::chrono::duration_cast<Clock::duration>(
+		        Duration(1.0 / frameRate));
+		if (!m_started)
+		{
+			m_started = true;
+			m_deadline = now + period;
+		}
+		else
+		{
+			m_deadline += period;
+			// A frame that ran over starts a new schedule
+			// instead of rushing the following ones.
+			m_deadline = std::max(m_deadline, now);
+		}
+
+		for (;;)
+		{
+			const auto start = Clock::now();
+			const auto remaining =
+			    Duration(m_deadline - start).count();
+			if (remaining <= m_sleepOvershoot)
+			{
+				break;
+			}
+
+			const auto request = remaining - m_sleepOvershoot;
+			std::this_thread::sleep_for(Duration(request));
+			const auto overshoot =
+			    Duration(Clock::now() - start).count()
+			    - request;
+			m_sleepOvershoot = std::clamp(
+			    m_sleepOvershoot
+			        + (overshoot - m_sleepOvershoot) * 0.1,
+			    0.0, 0.02);
+		}
+
+		while (Clock::now() < m_deadline)
+		{
+			std::this_thread::yield();
+		}
+	}
+} // namespace AthiVegam::Core
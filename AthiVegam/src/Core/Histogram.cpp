@@ -0,0 +1,101 @@
+#include "AthiVegam/Core/Histogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace AthiVegam::Core
+{
+	uint32_t Histogram::GetIndex(uint64_t value)
+	{
+		value = std::min<uint64_t>(value, UINT32_MAX);
+		if (value < 2 * SubBucketCount)
+		{
+			return static_cast<uint32_t>(value);
+		}
+		// Drops the bits below the top SubBucketBits + 1.
+		const auto shift = static_cast<uint32_t>(
+		    std::bit_width(value) - 1 - SubBucketBits);
+		return 2 * SubBucketCount
+		       + (shift - 1) * SubBucketCount
+		       + static_cast<uint32_t>(value >> shift)
+		       - SubBucketCount;
+	}
+
+	uint64_t Histogram::GetUpperBound(uint32_t index)
+	{
+		if (index < 2 * SubBucketCount)
+		{
+			return index;
+		}
+		const auto offset = index - 2 * SubBucketCount;
+		const auto shift = offset / SubBucketCount + 1;
+		const uint64_t sub =
+		    offset % SubBucketCount + SubBucketCount;
+		return ((sub + 1) << shift) - 1;
+	}
+
+	void Histogram::Record(uint64_t value)
+	{
+		++m_counts[GetIndex(value)];
+		++m_count;
+		m_max = std::max(m_max, value);
+	}
+
+	void Histogram::Clear()
+	{
+		m_counts.fill(0);
+		m_count = 0;
+		m_max = 0;
+	}
+
+	uint64_t Histogram::GetPercentile(double percent) const
+	{
+		if (m_count == 0)
+		{
+			return 0;
+		}
+		const auto rank = std::max<uint64_t>(
+		    1, static_cast<uint64_t>(std::ceil(
+		           percent / 100.0
+		           * static_cast<double>(m_count))));
+		uint64_t seen = 0;
+		for (uint32_t i = 0; i < BucketCount; ++i)
+		{
+			seen += m_counts[i];
+			if (seen >= rank)
+			{
+				return std::min(GetUpperBound(i), m_max);
+			}
+		}
+		return m_max;
+	}
+
+	std::vector<Histogram::Bucket> Histogram::GetBuckets() const
+	{
+		std::vector<Bucket> buckets;
+		for (uint32_t i = 0; i < BucketCount; ++i)
+		{
+			if (m_counts[i] > 0)
+			{
+				buckets.push_back({i, m_counts[i]});
+			}
+		}
+		return buckets;
+	}
+
+	void Histogram::Add(std::span<const Bucket> buckets)
+	{
+		for (const auto& bucket : buckets)
+		{
+			if (bucket.index >= BucketCount)
+			{
+				continue;
+			}
+			m_counts[bucket.index] += bucket.count;
+			m_count += bucket.count;
+			m_max = std::max(m_max,
+			                 GetUpperBound(bucket.index));
+		}
+	}
+} // namespace AthiVegam::Core
@@ -1,13 +1,18 @@
 #include "AthiVegam/Core/ImGuiWindow.h"
 
 #include "AthiVegam/Engine.h"
+#include "AthiVegam/Graphics/GpuProfiler.h"
 #include "external/imgui/imgui.h"
-#include "external/imgui/imgui_impl_opengl3.h"
 #include "external/imgui/imgui_impl_sdl.h"
 
 namespace AthiVegam::Core
 {
-	void ImGuiWindow::Create()
+	namespace
+	{
+		constexpr uint32_t RebuildFrames = 2;
+	} // namespace
+
+	void ImGuiWindow::Create(Clock::duration refreshInterval)
 	{
 		IMGUI_CHECKVERSION();
 
@@ -16,33 +21,143 @@ namespace AthiVegam::Core
 		ImGui_ImplSDL2_InitForOpenGL(
 		    vegamWindow.GetSDLWindow(),
 		    vegamWindow.GetGLContext());
-		ImGui_ImplOpenGL3_Init("#version 410");
+		// Builds the font atlas while the context is current
+		// here; with the render thread enabled NewFrame()
+		// runs on a thread without one.
+		m_renderer.Initialize();
+
+		m_refreshInterval = refreshInterval;
+		m_dirtyFrames = RebuildFrames;
+		m_created = true;
 	}
 
 	void ImGuiWindow::Shutdown()
 	{
-		ImGui_ImplOpenGL3_Shutdown();
+		if (!m_created)
+		{
+			return;
+		}
+		m_created = false;
+		ReleaseSnapshots();
+		m_renderer.Shutdown();
 		ImGui_ImplSDL2_Shutdown();
 		ImGui::DestroyContext();
 	}
 
 	void ImGuiWindow::HandleSDLEvent(SDL_Event& e)
 	{
+		if (!m_created)
+		{
+			return;
+		}
 		ImGui_ImplSDL2_ProcessEvent(&e);
+		m_dirtyFrames = RebuildFrames;
 	}
 
-	void ImGuiWindow::BeginRender()
+	bool ImGuiWindow::BeginRender()
 	{
-		ImGui_ImplOpenGL3_NewFrame();
+		const auto now = Clock::now();
+		m_building = m_dirtyFrames > 0
+		             || now - m_lastBuild >= m_refreshInterval;
+		if (!m_building)
+		{
+			return false;
+		}
+
+		m_dirtyFrames -= m_dirtyFrames > 0 ? 1 : 0;
+		m_lastBuild = now;
 		ImGui_ImplSDL2_NewFrame(
 		    Engine::Instance().GetWindow().GetSDLWindow());
 		ImGui::NewFrame();
+		return true;
 	}
 
 	void ImGuiWindow::EndRender()
 	{
+		VEGAM_PROFILE_SCOPE("ImGui");
+		VEGAM_PROFILE_GPU_SCOPE("ImGui");
+		// Without a new frame, the previous draw data is
+		// still valid, and still uploaded.
+		if (m_building)
+		{
+			ImGui::Render();
+		}
+		m_renderer.Render(ImGui::GetDrawData(), !m_building);
+	}
+
+	void ImGuiWindow::Skip()
+	{
+		// Whatever is shown next must be current.
+		m_dirtyFrames = RebuildFrames;
+		m_building = false;
+		m_captureState = FrameState::Skipped;
+	}
+
+	void ImGuiWindow::CaptureRender()
+	{
+		if (!m_building)
+		{
+			m_captureState = FrameState::Reused;
+			return;
+		}
+
+		m_captureState = FrameState::Built;
 		ImGui::Render();
-		ImGui_ImplOpenGL3_RenderDrawData(
-		    ImGui::GetDrawData());
+
+		auto& snapshot = m_snapshots[m_captureSnapshot];
+		for (auto* list : snapshot.lists)
+		{
+			IM_DELETE(list);
+		}
+		snapshot.lists.clear();
+
+		const auto* drawData = ImGui::GetDrawData();
+		for (int i = 0; i < drawData->CmdListsCount; ++i)
+		{
+			snapshot.lists.push_back(
+			    drawData->CmdLists[i]->CloneOutput());
+		}
+		snapshot.data = *drawData;
+		snapshot.data.CmdLists = snapshot.lists.data();
+	}
+
+	void ImGuiWindow::SwapFrames()
+	{
+		// A reused frame keeps drawing the last snapshot.
+		m_renderState = m_captureState;
+		if (m_captureState != FrameState::Built)
+		{
+			return;
+		}
+		m_renderSnapshot = m_captureSnapshot;
+		m_captureSnapshot =
+		    (m_captureSnapshot + 1) % m_snapshots.size();
+	}
+
+	void ImGuiWindow::RenderCaptured()
+	{
+		auto& snapshot = m_snapshots[m_renderSnapshot];
+		if (m_renderState != FrameState::Skipped
+		    && snapshot.data.Valid)
+		{
+			VEGAM_PROFILE_SCOPE("ImGui");
+			VEGAM_PROFILE_GPU_SCOPE("ImGui");
+			m_renderer.Render(
+			    &snapshot.data,
+			    m_renderState == FrameState::Reused);
+		}
+	}
+
+	void ImGuiWindow::ReleaseSnapshots()
+	{
+		for (auto& snapshot : m_snapshots)
+		{
+			for (auto* list : snapshot.lists)
+			{
+				IM_DELETE(list);
+			}
+			snapshot.lists.clear();
+			snapshot.data.Clear();
+		}
 	}
 } // namespace AthiVegam::Core
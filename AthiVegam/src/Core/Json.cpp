@@ -0,0 +1,382 @@
+#include "AthiVegam/Core/Json.h"
+
+#include "AthiVegam/Log.h"
+
+#include <charconv>
+
+namespace AthiVegam::Core
+{
+	namespace
+	{
+		// Nesting deeper than this fails rather than
+		// overflowing the stack.
+		constexpr uint32_t MaxDepth = 256;
+
+		const Json NullValue;
+		const std::string EmptyString;
+
+		void AppendUtf8(std::string& out, uint32_t code)
+		{
+			if (code < 0x80)
+			{
+				out += static_cast<char>(code);
+			}
+			else if (code < 0x800)
+			{
+				out += static_cast<char>(0xC0 | (code >> 6));
+				out += static_cast<char>(0x80 | (code & 0x3F));
+			}
+			else if (code < 0x10000)
+			{
+				out += static_cast<char>(0xE0 | (code >> 12));
+				out += static_cast<char>(
+				    0x80 | ((code >> 6) & 0x3F));
+				out += static_cast<char>(0x80 | (code & 0x3F));
+			}
+			else
+			{
+				out += static_cast<char>(0xF0 | (code >> 18));
+				out += static_cast<char>(
+				    0x80 | ((code >> 12) & 0x3F));
+				out += static_cast<char>(
+				    0x80 | ((code >> 6) & 0x3F));
+				out += static_cast<char>(0x80 | (code & 0x3F));
+			}
+		}
+	} // namespace
+
+	class JsonParser
+	{
+	  public:
+		explicit JsonParser(std::string_view text)
+		    : m_text(text)
+		{
+		}
+
+		bool Parse(Json& value, std::string& error)
+		{
+			SkipSpace();
+			if (!ParseValue(value, 0))
+			{
+				error = fmt::format("{} at byte {}", m_error,
+				                    m_position);
+				return false;
+			}
+			SkipSpace();
+			if (m_position != m_text.size())
+			{
+				error = fmt::format("Trailing data at byte {}",
+				                    m_position);
+				return false;
+			}
+			return true;
+		}
+
+	  private:
+		bool Fail(const char* reason)
+		{
+			m_error = reason;
+			return false;
+		}
+
+		inline bool AtEnd() const
+		{
+			return m_position >= m_text.size();
+		}
+		inline char Peek() const
+		{
+			return AtEnd() ? '\0' : m_text[m_position];
+		}
+
+		void SkipSpace()
+		{
+			while (!AtEnd()
+			       && (Peek() == ' ' || Peek() == '\n'
+			           || Peek() == '\r' || Peek() == '\t'))
+			{
+				++m_position;
+			}
+		}
+
+		bool Expect(std::string_view word)
+		{
+			if (m_text.substr(m_position, word.size()) != word)
+			{
+				return Fail("Unexpected token");
+			}
+			m_position += word.size();
+			return true;
+		}
+
+		bool ParseValue(Json& value, uint32_t depth)
+		{
+			if (depth > MaxDepth)
+			{
+				return Fail("Nested too deep");
+			}
+			switch (Peek())
+			{
+			case '{':
+				return ParseObject(value, depth);
+			case '[':
+				return ParseArray(value, depth);
+			case '"':
+				value.m_type = Json::Type::String;
+				return ParseString(value.m_string);
+			case 't':
+				value.m_type = Json::Type::Bool;
+				value.m_bool = true;
+				return Expect("true");
+			case 'f':
+				value.m_type = Json::Type::Bool;
+				value.m_bool = false;
+				return Expect("false");
+			case 'n':
+				value.m_type = Json::Type::Null;
+				return Expect("null");
+			default:
+				return ParseNumber(value);
+			}
+		}
+
+		bool ParseObject(Json& value, uint32_t depth)
+		{
+			value.m_type = Json::Type::Object;
+			++m_position;
+			SkipSpace();
+			if (Peek() == '}')
+			{
+				++m_position;
+				return true;
+			}
+			for (;;)
+			{
+				if (Peek() != '"')
+				{
+					return Fail("Expected a member name");
+				}
+				auto& member = value.m_children.emplace_back();
+				if (!ParseString(member.m_key))
+				{
+					return false;
+				}
+				SkipSpace();
+				if (Peek() != ':')
+				{
+					return Fail("Expected ':'");
+				}
+				++m_position;
+				SkipSpace();
+				if (!ParseValue(member, depth + 1))
+				{
+					return false;
+				}
+				SkipSpace();
+				if (Peek() == '}')
+				{
+					++m_position;
+					return true;
+				}
+				if (Peek() != ',')
+				{
+					return Fail("Expected ',' or '}'");
+				}
+				++m_position;
+				SkipSpace();
+			}
+		}
+
+		bool ParseArray(Json& value, uint32_t depth)
+		{
+			value.m_type = Json::Type::Array;
+			++m_position;
+			SkipSpace();
+			if (Peek() == ']')
+			{
+				++m_position;
+				return true;
+			}
+			for (;;)
+			{
+				if (!ParseValue(value.m_children.emplace_back(),
+				                depth + 1))
+				{
+					return false;
+				}
+				SkipSpace();
+				if (Peek() == ']')
+				{
+					++m_position;
+					return true;
+				}
+				if (Peek() != ',')
+				{
+					return Fail("Expected ',' or ']'");
+				}
+				++m_position;
+				SkipSpace();
+			}
+		}
+
+		bool ParseHex(uint32_t& code)
+		{
+			if (m_position + 4 > m_text.size())
+			{
+				return Fail("Truncated escape");
+			}
+			const auto* begin = m_text.data() + m_position;
+			const auto [end, error] =
+			    std::from_chars(begin, begin + 4, code, 16);
+			if (error != std::errc() || end != begin + 4)
+			{
+				return Fail("Bad escape");
+			}
+			m_position += 4;
+			return true;
+		}
+
+		bool ParseString(std::string& out)
+		{
+			++m_position;
+			for (;;)
+			{
+				// Copy runs without escapes at once.
+				const auto start = m_position;
+				while (!AtEnd() && Peek() != '"'
+				       && Peek() != '\\')
+				{
+					++m_position;
+				}
+				out.append(m_text.substr(start,
+				                         m_position - start));
+				if (AtEnd())
+				{
+					return Fail("Unterminated string");
+				}
+				if (Peek() == '"')
+				{
+					++m_position;
+					return true;
+				}
+
+				++m_position;
+				const auto escape = Peek();
+				++m_position;
+				switch (escape)
+				{
+				case '"':
+				case '\\':
+				case '/':
+					out += escape;
+					break;
+				case 'b':
+					out += '\b';
+					break;
+				case 'f':
+					out += '\f';
+					break;
+				case 'n':
+					out += '\n';
+					break;
+				case 'r':
+					out += '\r';
+					break;
+				case 't':
+					out += '\t';
+					break;
+				case 'u':
+				{
+					uint32_t code = 0;
+					if (!ParseHex(code))
+					{
+						return false;
+					}
+					// A surrogate pair makes one code point.
+					uint32_t low = 0;
+					if (code >= 0xD800 && code < 0xDC00
+					    && Expect("\\u") && ParseHex(low)
+					    && low >= 0xDC00 && low < 0xE000)
+					{
+						code = 0x10000 + ((code - 0xD800) << 10)
+						       + (low - 0xDC00);
+					}
+					else if (code >= 0xD800 && code < 0xE000)
+					{
+						return Fail("Bad surrogate");
+					}
+					AppendUtf8(out, code);
+					break;
+				}
+				default:
+					return Fail("Bad escape");
+				}
+			}
+		}
+
+		bool ParseNumber(Json& value)
+		{
+			// Unlike from_chars, JSON takes no "inf" or
+			// "nan".
+			const auto first = Peek();
+			if (first != '-' && (first < '0' || first > '9'))
+			{
+				return Fail("Unexpected token");
+			}
+			const auto* begin = m_text.data() + m_position;
+			const auto [end, error] = std::from_chars(
+			    begin, m_text.data() + m_text.size(),
+			    value.m_number);
+			if (error == std::errc::invalid_argument)
+			{
+				return Fail("Bad number");
+			}
+			// Out of range reads as 0.
+			value.m_type = Json::Type::Number;
+			m_position += static_cast<size_t>(end - begin);
+			return true;
+		}
+
+	  private:
+		std::string_view m_text;
+		size_t m_position = 0;
+		const char* m_error = "";
+	};
+
+	bool Json::Parse(std::string_view text, Json& value,
+	                 std::string& error)
+	{
+		value = Json();
+		return JsonParser(text).Parse(value, error);
+	}
+
+	bool Json::GetBool(bool fallback) const
+	{
+		return m_type == Type::Bool ? m_bool : fallback;
+	}
+
+	double Json::GetNumber(double fallback) const
+	{
+		return m_type == Type::Number ? m_number : fallback;
+	}
+
+	const std::string& Json::GetString() const
+	{
+		return m_type == Type::String ? m_string : EmptyString;
+	}
+
+	const Json& Json::operator[](std::string_view key) const
+	{
+		if (m_type != Type::Object)
+		{
+			return NullValue;
+		}
+		for (const auto& member : m_children)
+		{
+			if (member.m_key == key)
+			{
+				return member;
+			}
+		}
+		return NullValue;
+	}
+} // namespace AthiVegam::Core
@@ -0,0 +1,223 @@
+#include "AthiVegam/Core/LoaderThread.h"
+
+#include "AthiVegam/Core/CpuTopology.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Log.h"
+#include "SDL2/SDL.h"
+#include "glad/glad.h"
+
+#include <utility>
+
+namespace AthiVegam::Core
+{
+	LoaderThread::~LoaderThread() { Stop(); }
+
+	bool LoaderThread::Start(SDL_Window* window)
+	{
+		VEGAM_ASSERT(!IsRunning(),
+		             "Loader thread is already running!");
+		if (IsRunning())
+		{
+			return false;
+		}
+
+		auto* current = SDL_GL_GetCurrentContext();
+		SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT,
+		                    1);
+		m_context = SDL_GL_CreateContext(window);
+		SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT,
+		                    0);
+		// Creating a context makes it current.
+		SDL_GL_MakeCurrent(window, current);
+		if (!m_context)
+		{
+			VEGAM_ERROR("Error creating loader GL context: {}",
+			            SDL_GetError());
+			return false;
+		}
+
+		m_window = window;
+		m_stopRequested = false;
+		m_thread = std::thread(&LoaderThread::Run, this);
+		VEGAM_INFO("Loader thread started");
+		return true;
+	}
+
+	void LoaderThread::Stop()
+	{
+		if (!IsRunning())
+		{
+			return;
+		}
+
+		{
+			std::lock_guard lock(m_mutex);
+			m_stopRequested = true;
+		}
+		m_condition.notify_all();
+		m_thread.join();
+
+		// The objects finished jobs made are still shared
+		// with the window's context.
+		for (auto& entry : m_finished)
+		{
+			if (entry.fence)
+			{
+				glDeleteSync(static_cast<GLsync>(entry.fence));
+				VEGAM_CHECK_GL_ERROR;
+			}
+		}
+		m_jobs.clear();
+		m_finished.clear();
+		m_pending = 0;
+		SDL_GL_DeleteContext(m_context);
+		m_context = nullptr;
+		VEGAM_INFO("Loader thread stopped");
+	}
+
+	void LoaderThread::Submit(Job job, Job done)
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			++m_pending;
+			if (!IsRunning())
+			{
+				m_finished.push_back(
+				    {std::move(job), std::move(done)});
+				return;
+			}
+			m_jobs.push_back({std::move(job), std::move(done)});
+		}
+		m_condition.notify_one();
+	}
+
+	void LoaderThread::Update()
+	{
+		std::vector<Entry> ready;
+		{
+			std::lock_guard lock(m_mutex);
+			size_t count = 0;
+			for (; count < m_finished.size(); ++count)
+			{
+				auto* fence =
+				    static_cast<GLsync>(m_finished[count].fence);
+				if (!fence)
+				{
+					continue;
+				}
+				const auto status = glClientWaitSync(fence, 0, 0);
+				if (status != GL_ALREADY_SIGNALED
+				    && status != GL_CONDITION_SATISFIED)
+				{
+					break;
+				}
+			}
+			if (count == 0)
+			{
+				return;
+			}
+			ready.assign(
+			    std::make_move_iterator(m_finished.begin()),
+			    std::make_move_iterator(m_finished.begin()
+			                            + count));
+			m_finished.erase(m_finished.begin(),
+			                 m_finished.begin() + count);
+		}
+
+		VEGAM_PROFILE_SCOPE("LoaderThread::Update");
+		for (auto& entry : ready)
+		{
+			if (entry.fence)
+			{
+				glDeleteSync(static_cast<GLsync>(entry.fence));
+				VEGAM_CHECK_GL_ERROR;
+			}
+			// Not run by the loader thread.
+			if (entry.job)
+			{
+				entry.job();
+			}
+			if (entry.done)
+			{
+				entry.done();
+			}
+		}
+
+		std::lock_guard lock(m_mutex);
+		m_pending -= ready.size();
+	}
+
+	size_t LoaderThread::GetPendingCount()
+	{
+		std::lock_guard lock(m_mutex);
+		return m_pending;
+	}
+
+	void LoaderThread::Run()
+	{
+		Profiler::SetThreadName("Loader");
+		SetThreadClass(ThreadClass::Background);
+		const auto current =
+		    SDL_GL_MakeCurrent(m_window, m_context) == 0;
+		if (!current)
+		{
+			VEGAM_ERROR("Loader GL context unusable, loading "
+			            "on the GL thread: {}",
+			            SDL_GetError());
+		}
+
+		std::vector<Entry> jobs;
+		while (true)
+		{
+			{
+				std::unique_lock lock(m_mutex);
+				m_condition.wait(lock, [this] {
+					return !m_jobs.empty() || m_stopRequested;
+				});
+				if (m_stopRequested)
+				{
+					break;
+				}
+				jobs.swap(m_jobs);
+				if (!current)
+				{
+					// Update() runs them instead.
+					for (auto& entry : jobs)
+					{
+						m_finished.push_back(std::move(entry));
+					}
+					jobs.clear();
+					continue;
+				}
+			}
+
+			for (auto& entry : jobs)
+			{
+				VEGAM_PROFILE_SCOPE("LoaderThread::Job");
+				entry.job();
+				entry.job = nullptr;
+				entry.fence =
+				    glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+				VEGAM_CHECK_GL_ERROR;
+				// Other contexts only see commands, the
+				// fence included, once they are flushed.
+				glFlush();
+				VEGAM_CHECK_GL_ERROR;
+
+				std::lock_guard lock(m_mutex);
+				m_finished.push_back(std::move(entry));
+				if (m_stopRequested)
+				{
+					break;
+				}
+			}
+			jobs.clear();
+		}
+
+		if (current)
+		{
+			SDL_GL_MakeCurrent(m_window, nullptr);
+		}
+	}
+} // namespace AthiVegam::Core
@@ -0,0 +1,178 @@
+#include "AthiVegam/Core/MappedFile.h"
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <utility>
+
+#ifdef AV_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // AV_PLATFORM_WINDOWS
+
+namespace AthiVegam::Core
+{
+	MappedFile::~MappedFile() { Close(); }
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	MappedFile&
+	MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+			m_data = std::exchange(other.m_data, nullptr);
+			m_size = std::exchange(other.m_size, 0);
+#ifdef AV_PLATFORM_WINDOWS
+			m_file = std::exchange(other.m_file, nullptr);
+			m_mapping =
+			    std::exchange(other.m_mapping, nullptr);
+#endif // AV_PLATFORM_WINDOWS
+		}
+		return *this;
+	}
+
+#ifdef AV_PLATFORM_WINDOWS
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+		auto file = CreateFileA(
+		    path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+		    nullptr, OPEN_EXISTING,
+		    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+		    nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			VEGAM_ERROR("Error opening {}", path);
+			return false;
+		}
+
+		LARGE_INTEGER size{};
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			VEGAM_ERROR("{} is empty", path);
+			CloseHandle(file);
+			return false;
+		}
+
+		auto mapping = CreateFileMappingA(
+		    file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		const void* view =
+		    mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0,
+		                            0, 0)
+		            : nullptr;
+		if (!view)
+		{
+			VEGAM_ERROR("Error mapping {}", path);
+			if (mapping)
+			{
+				CloseHandle(mapping);
+			}
+			CloseHandle(file);
+			return false;
+		}
+
+		m_file = file;
+		m_mapping = mapping;
+		m_data = static_cast<const uint8_t*>(view);
+		m_size = static_cast<size_t>(size.QuadPart);
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_data)
+		{
+			UnmapViewOfFile(m_data);
+			CloseHandle(m_mapping);
+			CloseHandle(m_file);
+		}
+		m_data = nullptr;
+		m_size = 0;
+		m_file = nullptr;
+		m_mapping = nullptr;
+	}
+
+	void MappedFile::Prefetch(size_t offset, size_t size) const
+	{
+		if (!m_data || offset >= m_size)
+		{
+			return;
+		}
+		WIN32_MEMORY_RANGE_ENTRY range{
+		    const_cast<uint8_t*>(m_data + offset),
+		    std::min(size, m_size - offset)};
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range,
+		                      0);
+	}
+#else
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+		const int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			VEGAM_ERROR("Error opening {}", path);
+			return false;
+		}
+
+		struct stat info{};
+		if (fstat(fd, &info) != 0 || info.st_size == 0)
+		{
+			VEGAM_ERROR("{} is empty", path);
+			close(fd);
+			return false;
+		}
+
+		const auto size = static_cast<size_t>(info.st_size);
+		void* view =
+		    mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		// The mapping keeps the file alive.
+		close(fd);
+		if (view == MAP_FAILED)
+		{
+			VEGAM_ERROR("Error mapping {}", path);
+			return false;
+		}
+
+		m_data = static_cast<const uint8_t*>(view);
+		m_size = size;
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_data)
+		{
+			munmap(const_cast<uint8_t*>(m_data), m_size);
+		}
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+	void MappedFile::Prefetch(size_t offset, size_t size) const
+	{
+		if (!m_data || offset >= m_size)
+		{
+			return;
+		}
+		// madvise() wants a page-aligned start.
+		const auto pageSize =
+		    static_cast<size_t>(sysconf(_SC_PAGESIZE));
+		const auto start = offset / pageSize * pageSize;
+		const auto end = std::min(offset + size, m_size);
+		madvise(const_cast<uint8_t*>(m_data + start),
+		        end - start, MADV_WILLNEED);
+	}
+#endif // AV_PLATFORM_WINDOWS
+} // namespace AthiVegam::Core
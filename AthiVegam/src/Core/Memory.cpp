@@ -0,0 +1,145 @@
+#include "AthiVegam/Core/Memory.h"
+
+#include <array>
+#include <atomic>
+
+namespace AthiVegam::Core::Memory
+{
+	namespace
+	{
+		constexpr auto TagCount =
+		    static_cast<size_t>(Tag::Count);
+
+		struct Counters
+		{
+			std::atomic<int64_t> live{0};
+			std::atomic<int64_t> peak{0};
+			std::atomic<size_t> allocations{0};
+
+			void Add(int64_t bytes)
+			{
+				const auto live =
+				    this->live.fetch_add(
+				        bytes, std::memory_order_relaxed)
+				    + bytes;
+				auto peak =
+				    this->peak.load(std::memory_order_relaxed);
+				while (live > peak
+				       && !this->peak.compare_exchange_weak(
+				           peak, live,
+				           std::memory_order_relaxed))
+				{
+				}
+			}
+
+			Stats Get() const
+			{
+				const auto clamp = [](int64_t value) {
+					return static_cast<size_t>(
+					    value > 0 ? value : 0);
+				};
+				return {
+				    clamp(live.load(std::memory_order_relaxed)),
+				    clamp(peak.load(std::memory_order_relaxed)),
+				    allocations.load(
+				        std::memory_order_relaxed)};
+			}
+		};
+
+		class DefaultAllocator final : public Allocator
+		{
+		  public:
+			void* Allocate(size_t size,
+			               size_t alignment) override
+			{
+				return ::operator new(
+				    size, std::align_val_t(alignment));
+			}
+			void Free(void* memory, size_t,
+			          size_t alignment) override
+			{
+				::operator delete(
+				    memory, std::align_val_t(alignment));
+			}
+		};
+
+		DefaultAllocator defaultAllocator;
+		Allocator* allocator = &defaultAllocator;
+
+		std::array<Counters, TagCount> cpuCounters;
+		std::array<Counters, TagCount> gpuCounters;
+
+		inline size_t ToIndex(Tag tag)
+		{
+			const auto index = static_cast<size_t>(tag);
+			return index < TagCount ? index : 0;
+		}
+	} // namespace
+
+	const char* GetTagName(Tag tag)
+	{
+		static constexpr std::array<const char*, TagCount>
+		    names{"General", "Core",   "Render", "Assets",
+		          "Input",   "Editor", "Scene"};
+		return names[ToIndex(tag)];
+	}
+
+	void SetAllocator(Allocator* replacement)
+	{
+		allocator = replacement ? replacement
+		                        : &defaultAllocator;
+	}
+
+	void* Allocate(size_t size, Tag tag, size_t alignment)
+	{
+		auto& counters = cpuCounters[ToIndex(tag)];
+		counters.Add(static_cast<int64_t>(size));
+		counters.allocations.fetch_add(
+		    1, std::memory_order_relaxed);
+		return allocator->Allocate(size, alignment);
+	}
+
+	void Free(void* memory, size_t size, Tag tag,
+	          size_t alignment)
+	{
+		if (!memory)
+		{
+			return;
+		}
+		cpuCounters[ToIndex(tag)].Add(
+		    -static_cast<int64_t>(size));
+		allocator->Free(memory, size, alignment);
+	}
+
+	void TrackGpu(Tag tag, int64_t bytes)
+	{
+		auto& counters = gpuCounters[ToIndex(tag)];
+		counters.Add(bytes);
+		if (bytes > 0)
+		{
+			counters.allocations.fetch_add(
+			    1, std::memory_order_relaxed);
+		}
+	}
+
+	void TrackCpu(Tag tag, int64_t bytes)
+	{
+		auto& counters = cpuCounters[ToIndex(tag)];
+		counters.Add(bytes);
+		if (bytes > 0)
+		{
+			counters.allocations.fetch_add(
+			    1, std::memory_order_relaxed);
+		}
+	}
+
+	Stats GetStats(Tag tag)
+	{
+		return cpuCounters[ToIndex(tag)].Get();
+	}
+
+	Stats GetGpuStats(Tag tag)
+	{
+		return gpuCounters[ToIndex(tag)].Get();
+	}
+} // namespace AthiVegam::Core::Memory
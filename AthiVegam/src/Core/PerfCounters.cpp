@@ -0,0 +1,154 @@
+#include "AthiVegam/Core/PerfCounters.h"
+
+#include "AthiVegam/Core/CVar.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if !defined(AV_PLATFORM_WINDOWS) && !defined(AV_PLATFORM_MAC)
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif // !AV_PLATFORM_WINDOWS && !AV_PLATFORM_MAC
+
+namespace AthiVegam::Core::PerfCounters
+{
+	namespace
+	{
+		CVar<bool> enabledCVar(
+		    "profile.perfCounters", false,
+		    "Sample hardware counters per profiler zone "
+		    "(Linux)");
+
+		constexpr size_t CounterCount =
+		    static_cast<size_t>(Counter::Count);
+
+#if !defined(AV_PLATFORM_WINDOWS) && !defined(AV_PLATFORM_MAC)
+		constexpr std::array<uint64_t, CounterCount> Configs = {
+		    PERF_COUNT_HW_CPU_CYCLES,
+		    PERF_COUNT_HW_INSTRUCTIONS,
+		    PERF_COUNT_HW_CACHE_MISSES,
+		    PERF_COUNT_HW_BRANCH_MISSES};
+
+		std::atomic<bool> warned{false};
+
+		// One group per thread, led by the cycle counter,
+		// so a single read() returns all of them.
+		struct ThreadCounters
+		{
+			std::array<int, CounterCount> fds;
+			bool opened = false;
+			bool available = false;
+
+			ThreadCounters() { fds.fill(-1); }
+			~ThreadCounters()
+			{
+				for (const auto fd : fds)
+				{
+					if (fd >= 0)
+					{
+						close(fd);
+					}
+				}
+			}
+
+			ThreadCounters(const ThreadCounters&) = delete;
+			ThreadCounters&
+			operator=(const ThreadCounters&) = delete;
+
+			void Open()
+			{
+				opened = true;
+				for (size_t i = 0; i < CounterCount; ++i)
+				{
+					perf_event_attr attr;
+					std::memset(&attr, 0, sizeof(attr));
+					attr.size = sizeof(attr);
+					attr.type = PERF_TYPE_HARDWARE;
+					attr.config = Configs[i];
+					attr.read_format = PERF_FORMAT_GROUP;
+					attr.exclude_kernel = 1;
+					attr.exclude_hv = 1;
+					// This thread, on any CPU.
+					fds[i] = static_cast<int>(syscall(
+					    SYS_perf_event_open, &attr, 0, -1,
+					    i == 0 ? -1 : fds[0], 0));
+					if (fds[i] < 0)
+					{
+						if (!warned.exchange(true))
+						{
+							VEGAM_WARN(
+							    "Hardware counter {} unavailable: "
+							    "{}",
+							    GetName(static_cast<Counter>(i)),
+							    std::strerror(errno));
+						}
+						return;
+					}
+				}
+				available = true;
+			}
+		};
+#endif // !AV_PLATFORM_WINDOWS && !AV_PLATFORM_MAC
+	} // namespace
+
+	const char* GetName(Counter counter)
+	{
+		switch (counter)
+		{
+		case Counter::Cycles:
+			return "cycles";
+		case Counter::Instructions:
+			return "instructions";
+		case Counter::CacheMisses:
+			return "cacheMisses";
+		case Counter::BranchMisses:
+			return "branchMisses";
+		default:
+			return "unknown";
+		}
+	}
+
+	bool IsEnabled() { return enabledCVar.Get(); }
+
+	bool Read(Values& values)
+	{
+#if !defined(AV_PLATFORM_WINDOWS) && !defined(AV_PLATFORM_MAC)
+		if (!IsEnabled())
+		{
+			return false;
+		}
+		thread_local ThreadCounters counters;
+		if (!counters.opened)
+		{
+			counters.Open();
+		}
+		if (!counters.available)
+		{
+			return false;
+		}
+
+		// PERF_FORMAT_GROUP: the count, then the values in
+		// the order the counters joined.
+		std::array<uint64_t, CounterCount + 1> buffer;
+		if (read(counters.fds[0], buffer.data(),
+		         sizeof(buffer))
+		        != static_cast<ssize_t>(sizeof(buffer))
+		    || buffer[0] != CounterCount)
+		{
+			return false;
+		}
+		std::copy(buffer.begin() + 1, buffer.end(),
+		          values.begin());
+		return true;
+#else
+		// No equivalent without ETW sessions or a driver.
+		(void)values;
+		return false;
+#endif // !AV_PLATFORM_WINDOWS && !AV_PLATFORM_MAC
+	}
+} // namespace AthiVegam::Core::PerfCounters
@@ -0,0 +1,274 @@
+#include "AthiVegam/Core/PerformanceHud.h"
+
+#include "AthiVegam/Core/CVar.h"
+#include "AthiVegam/Core/Memory.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Graphics/GLCallCounter.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "external/imgui/imgui.h"
+
+#include <algorithm>
+
+namespace AthiVegam::Core
+{
+	namespace
+	{
+		// Nearest-rank percentile of sorted samples.
+		float Percentile(const float* sorted, uint32_t count,
+		                 float percent)
+		{
+			const auto rank = static_cast<uint32_t>(
+			    percent / 100.0f * (count - 1) + 0.5f);
+			return sorted[std::min(rank, count - 1)];
+		}
+	} // namespace
+
+	void PerformanceHud::Draw()
+	{
+		if (!m_visible)
+		{
+			return;
+		}
+
+		if (ImGui::Begin("Performance"))
+		{
+			DrawFrameTimes();
+			DrawRenderStats();
+			DrawJobs();
+			DrawMemory();
+#ifdef AV_CONFIG_DEBUG
+			ImGui::Checkbox("ImGui demo window",
+			                &m_showDemoWindow);
+#endif // AV_CONFIG_DEBUG
+		}
+		ImGui::End();
+
+		Engine::Instance().GetResourceManager().DrawStats();
+		Managers::LogManager::DrawPanel();
+		CVars::DrawPanel();
+#ifndef AV_CONFIG_SHIPPING
+		Profiler::DrawPanel();
+		Graphics::GpuResources::DrawPanel();
+		Graphics::GLCallCounter::DrawPanel();
+#endif // AV_CONFIG_SHIPPING
+#ifdef AV_CONFIG_DEBUG
+		if (m_showDemoWindow)
+		{
+			ImGui::ShowDemoWindow(&m_showDemoWindow);
+		}
+#endif // AV_CONFIG_DEBUG
+	}
+
+	void PerformanceHud::RecordFrame()
+	{
+		const auto now = Clock::now();
+		if (m_started)
+		{
+			const std::chrono::duration<float, std::milli>
+			    elapsed = now - m_lastFrame;
+			m_frameTimes[m_next] = elapsed.count();
+			m_next = (m_next + 1) % HistorySize;
+			m_count = std::min(m_count + 1, HistorySize);
+		}
+		m_lastFrame = now;
+		m_started = true;
+	}
+
+	void PerformanceHud::DrawFrameTimes()
+	{
+		if (m_count == 0)
+		{
+			return;
+		}
+
+		// Oldest sample first for the plot.
+		std::array<float, HistorySize> ordered;
+		const auto first =
+		    m_count < HistorySize ? 0u : m_next;
+		for (uint32_t i = 0; i < m_count; ++i)
+		{
+			ordered[i] = m_frameTimes[(first + i) % HistorySize];
+		}
+
+		auto sorted = ordered;
+		std::sort(sorted.begin(), sorted.begin() + m_count);
+		const auto p50 = Percentile(sorted.data(), m_count, 50);
+		const auto p95 = Percentile(sorted.data(), m_count, 95);
+		const auto p99 = Percentile(sorted.data(), m_count, 99);
+
+		const auto last = ordered[m_count - 1];
+		ImGui::Text("Frame %.2f ms (%.0f fps)", last,
+		            last > 0.0f ? 1000.0f / last : 0.0f);
+		ImGui::Text("p50 %.2f  p95 %.2f  p99 %.2f ms", p50,
+		            p95, p99);
+		for (const auto& budget : Profiler::GetBudgets())
+		{
+			if (budget.windowViolations > 0)
+			{
+				ImGui::TextColored(
+				    ImVec4(1.0f, 0.3f, 0.3f, 1.0f),
+				    "%s over %.2f ms in %u of %u frames",
+				    budget.zone.c_str(), budget.budgetMs,
+				    budget.windowViolations,
+				    Profiler::BudgetWindow);
+			}
+		}
+		ImGui::PlotHistogram("##FrameTimes", ordered.data(),
+		                     static_cast<int>(m_count), 0,
+		                     nullptr, 0.0f,
+		                     std::max(sorted[m_count - 1],
+		                              33.3f),
+		                     ImVec2(0.0f, 60.0f));
+	}
+
+	void PerformanceHud::DrawRenderStats()
+	{
+		if (!ImGui::CollapsingHeader(
+		        "Render", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			return;
+		}
+
+		const auto stats =
+		    Engine::Instance().GetRenderManager().GetFrameStats();
+		ImGui::Text("Draw calls      %u", stats.drawCalls);
+		ImGui::Text("Triangles       %llu",
+		            static_cast<unsigned long long>(
+		                stats.triangles));
+		ImGui::Text("State changes   %u (%u skipped)",
+		            stats.stateChanges, stats.skippedChanges);
+		ImGui::Text("Uniform uploads %u", stats.uniformUploads);
+		ImGui::Text("Constants       %.1f KiB",
+		            stats.constantBytes / 1024.0);
+		if (Graphics::GLCallCounter::IsInstalled())
+		{
+			ImGui::Text("GL calls        %u (%.2f ms)",
+			            stats.glCalls, stats.glMilliseconds);
+		}
+	}
+
+	void PerformanceHud::DrawJobs()
+	{
+		if (!ImGui::CollapsingHeader("Jobs"))
+		{
+			return;
+		}
+
+		const auto& jobs = Engine::Instance().GetJobManager();
+		const auto frame = jobs.GetFrameTicks();
+		const auto stats = jobs.GetFrameStats();
+		if (frame == 0 || stats.empty())
+		{
+			return;
+		}
+		const auto percent = [frame](uint64_t ticks) {
+			return 100.0 * static_cast<double>(ticks)
+			       / static_cast<double>(frame);
+		};
+
+		// Workers only; the main thread's own work isn't
+		// counted.
+		uint64_t workerBusy = 0;
+		for (size_t i = 1; i < stats.size(); ++i)
+		{
+			workerBusy += stats[i].busyTicks;
+		}
+		ImGui::Text("Workers busy %.0f%% of %zu",
+		            stats.size() > 1
+		                ? percent(workerBusy) / (stats.size() - 1)
+		                : 0.0,
+		            stats.size() - 1);
+		if (!ImGui::BeginTable("Threads", 9))
+		{
+			return;
+		}
+		for (const char* header :
+		     {"Thread", "Busy %", "Steal %", "Wait %", "Idle %",
+		      "Jobs", "Steals (lost)", "Queue (peak)",
+		      "Lock waits"})
+		{
+			ImGui::TableSetupColumn(header);
+		}
+		ImGui::TableHeadersRow();
+		for (size_t i = 0; i < stats.size(); ++i)
+		{
+			const auto& thread = stats[i];
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			if (i == 0)
+			{
+				ImGui::TextUnformatted("Main");
+			}
+			else
+			{
+				ImGui::Text("Worker %zu", i);
+			}
+			for (const auto ticks :
+			     {thread.busyTicks, thread.stealTicks,
+			      thread.waitTicks, thread.idleTicks})
+			{
+				ImGui::TableNextColumn();
+				ImGui::Text("%.0f", percent(ticks));
+			}
+			ImGui::TableNextColumn();
+			ImGui::Text("%u", thread.jobs);
+			ImGui::TableNextColumn();
+			ImGui::Text("%u (%u)", thread.steals,
+			            thread.contendedSteals);
+			ImGui::TableNextColumn();
+			ImGui::Text("%u (%u)", thread.queueDepth,
+			            thread.peakQueueDepth);
+			ImGui::TableNextColumn();
+			ImGui::Text("%u", thread.lockContentions);
+		}
+		ImGui::EndTable();
+	}
+
+	void PerformanceHud::DrawMemory()
+	{
+		if (!ImGui::CollapsingHeader(
+		        "Memory", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			return;
+		}
+
+		const auto kib = [](size_t bytes) {
+			return static_cast<double>(bytes) / 1024.0;
+		};
+		if (!ImGui::BeginTable("Tags", 6))
+		{
+			return;
+		}
+		for (const char* header :
+		     {"Tag", "Live KiB", "Peak KiB", "Allocs",
+		      "GPU KiB", "GPU peak KiB"})
+		{
+			ImGui::TableSetupColumn(header);
+		}
+		ImGui::TableHeadersRow();
+
+		using Memory::Tag;
+		for (uint8_t i = 0;
+		     i < static_cast<uint8_t>(Tag::Count); ++i)
+		{
+			const auto tag = static_cast<Tag>(i);
+			const auto cpu = Memory::GetStats(tag);
+			const auto gpu = Memory::GetGpuStats(tag);
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(Memory::GetTagName(tag));
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", kib(cpu.live));
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", kib(cpu.peak));
+			ImGui::TableNextColumn();
+			ImGui::Text("%zu", cpu.allocations);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", kib(gpu.live));
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", kib(gpu.peak));
+		}
+		ImGui::EndTable();
+	}
+} // namespace AthiVegam::Core
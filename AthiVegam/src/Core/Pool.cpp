@@ -0,0 +1,12 @@
+#include "AthiVegam/Core/Pool.h"
+
+namespace AthiVegam::Core
+{
+	uint32_t GetThreadCacheIndex()
+	{
+		static std::atomic<uint32_t> nextIndex{0};
+		thread_local const uint32_t index =
+		    nextIndex.fetch_add(1, std::memory_order_relaxed);
+		return index;
+	}
+} // namespace AthiVegam::Core
@@ -0,0 +1,924 @@
+#include "AthiVegam/Core/Profiler.h"
+
+#include "AthiVegam/Core/CpuTopology.h"
+#include "AthiVegam/Core/FlatHashMap.h"
+#include "AthiVegam/Log.h"
+#include "SDL2/SDL.h"
+#include "external/imgui/imgui.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace AthiVegam::Core::Profiler
+{
+	namespace
+	{
+		constexpr uint32_t RingCapacity = 4096;
+		constexpr uint32_t FrameHistory = 120;
+
+		// Single producer (the owning thread), single
+		// consumer (EndFrame() on the main thread).
+		struct ThreadRing
+		{
+			std::string name;
+			std::array<Zone, RingCapacity> zones;
+			std::atomic<uint64_t> write{0};
+			std::atomic<uint64_t> read{0};
+			std::atomic<uint32_t> dropped{0};
+			uint32_t depth = 0;
+		};
+
+		std::mutex ringsMutex;
+		std::vector<std::unique_ptr<ThreadRing>> rings;
+
+		std::vector<ThreadZones> lastFrame;
+		std::mutex gpuMutex;
+		ThreadZones gpuZones{"GPU"};
+		uint64_t gpuGeneration = 0;
+		std::array<float, FrameHistory> frameTimes{};
+		uint32_t frameIndex = 0;
+		uint64_t lastFrameEnd = 0;
+
+		struct Event
+		{
+			const char* category;
+			std::string detail;
+			uint64_t time;
+		};
+
+		// Appends the GPU zones if they were resolved since
+		// generation.
+		void AppendGpuZones(std::vector<ThreadZones>& frame,
+		                    uint64_t& generation)
+		{
+			std::lock_guard lock(gpuMutex);
+			if (gpuGeneration != generation)
+			{
+				generation = gpuGeneration;
+				frame.push_back(gpuZones);
+			}
+		}
+
+		// Frames handed from EndFrame() to the writer
+		// thread.
+		class CaptureWriter
+		{
+		  public:
+			~CaptureWriter() { Finish(); }
+
+			bool Start(const std::string& path,
+			           uint32_t frameCount)
+			{
+				if (m_thread.joinable())
+				{
+					if (m_framesLeft > 0)
+					{
+						return false;
+					}
+					Finish();
+				}
+
+				m_file.open(path, std::ios::trunc);
+				if (!m_file)
+				{
+					VEGAM_ERROR("Cannot open profile capture "
+					            "file {}",
+					            path);
+					return false;
+				}
+
+				m_path = path;
+				m_framesLeft = frameCount;
+				m_base = Now();
+				m_namedThreads.clear();
+				m_firstEvent = true;
+				m_done = false;
+				m_events.clear();
+				{
+					std::lock_guard lock(gpuMutex);
+					m_lastGpuGeneration = gpuGeneration;
+				}
+				m_writing = true;
+				m_file << "{\"traceEvents\":[";
+				m_thread = std::thread([this] { Run(); });
+				return true;
+			}
+
+			// Writes frames already recorded, and events,
+			// with times relative to base. False while a
+			// previous file is still being written.
+			bool Dump(const std::string& path,
+			          std::vector<std::vector<ThreadZones>> frames,
+			          std::vector<Event> events, uint64_t base)
+			{
+				if (m_writing || !Start(path, 0))
+				{
+					return false;
+				}
+				std::lock_guard lock(m_mutex);
+				m_base = base;
+				m_events = std::move(events);
+				m_frames.assign(
+				    std::make_move_iterator(frames.begin()),
+				    std::make_move_iterator(frames.end()));
+				m_done = true;
+				m_condition.notify_one();
+				return true;
+			}
+
+			inline bool IsCapturing() const
+			{
+				return m_framesLeft > 0;
+			}
+
+			// Main thread, after draining the rings.
+			void AddFrame(const std::vector<ThreadZones>& frame)
+			{
+				if (m_framesLeft == 0)
+				{
+					return;
+				}
+
+				std::vector<ThreadZones> copy = frame;
+				AppendGpuZones(copy, m_lastGpuGeneration);
+
+				std::lock_guard lock(m_mutex);
+				m_frames.push_back(std::move(copy));
+				m_done = --m_framesLeft == 0;
+				m_condition.notify_one();
+			}
+
+			void Finish()
+			{
+				{
+					std::lock_guard lock(m_mutex);
+					m_framesLeft = 0;
+					m_done = true;
+					m_condition.notify_one();
+				}
+				if (m_thread.joinable())
+				{
+					m_thread.join();
+				}
+			}
+
+		  private:
+			void Run()
+			{
+				SetThreadClass(ThreadClass::Background);
+				for (;;)
+				{
+					std::vector<ThreadZones> frame;
+					{
+						std::unique_lock lock(m_mutex);
+						m_condition.wait(lock, [this] {
+							return m_done || !m_frames.empty();
+						});
+						if (m_frames.empty())
+						{
+							break;
+						}
+						frame = std::move(m_frames.front());
+						m_frames.pop_front();
+					}
+					Write(frame);
+				}
+				WriteEvents();
+
+				m_file << "]}\n";
+				m_file.close();
+				VEGAM_INFO("Profile capture written to {}",
+				           m_path);
+				m_writing = false;
+			}
+
+			void Write(const std::vector<ThreadZones>& frame)
+			{
+				for (size_t i = 0; i < frame.size(); ++i)
+				{
+					const auto& thread = frame[i];
+					const auto tid = thread.threadName == "GPU"
+					                     ? GpuThreadId
+					                     : i;
+					if (std::find(m_namedThreads.begin(),
+					              m_namedThreads.end(), tid)
+					    == m_namedThreads.end())
+					{
+						m_namedThreads.push_back(tid);
+						Separator();
+						m_file << "{\"name\":\"thread_name\","
+						          "\"ph\":\"M\",\"pid\":0,"
+						          "\"tid\":"
+						       << tid << ",\"args\":{\"name\":\"";
+						WriteEscaped(thread.threadName.c_str());
+						m_file << "\"}}";
+					}
+
+					for (const auto& zone : thread.zones)
+					{
+						Separator();
+						m_file << "{\"name\":\"";
+						WriteEscaped(zone.name);
+						m_file << "\",\"ph\":\"X\",\"pid\":0,"
+						          "\"tid\":"
+						       << tid << ",\"ts\":"
+						       << ToMicroseconds(zone.start)
+						       << ",\"dur\":"
+						       << TicksToMs(zone.end - zone.start)
+						              * 1000.0;
+						WriteCounters(zone.counters);
+						m_file << "}";
+					}
+				}
+			}
+
+			void WriteCounters(
+			    const PerfCounters::Values& counters)
+			{
+				using PerfCounters::Counter;
+				if (counters[0] == 0)
+				{
+					return;
+				}
+				m_file << ",\"args\":{";
+				for (size_t i = 0; i < counters.size(); ++i)
+				{
+					m_file << (i > 0 ? ",\"" : "\"")
+					       << PerfCounters::GetName(
+					              static_cast<Counter>(i))
+					       << "\":" << counters[i];
+				}
+				m_file << "}";
+			}
+
+			void WriteEvents()
+			{
+				for (const auto& event : m_events)
+				{
+					Separator();
+					m_file << "{\"name\":\"";
+					WriteEscaped(event.category);
+					m_file << "\",\"ph\":\"i\",\"s\":\"g\","
+					          "\"pid\":0,\"tid\":0,\"ts\":"
+					       << ToMicroseconds(event.time)
+					       << ",\"args\":{\"detail\":\"";
+					WriteEscaped(event.detail.c_str());
+					m_file << "\"}}";
+				}
+			}
+
+			inline double ToMicroseconds(uint64_t ticks) const
+			{
+				const auto delta = static_cast<int64_t>(
+				    ticks - m_base);
+				return delta < 0
+				           ? -TicksToMs(m_base - ticks) * 1000.0
+				           : TicksToMs(delta) * 1000.0;
+			}
+
+			inline void Separator()
+			{
+				if (!m_firstEvent)
+				{
+					m_file << ",\n";
+				}
+				m_firstEvent = false;
+			}
+
+			void WriteEscaped(const char* text)
+			{
+				for (; *text; ++text)
+				{
+					if (*text == '"' || *text == '\\')
+					{
+						m_file << '\\';
+					}
+					// Control characters aren't valid JSON.
+					m_file << (static_cast<unsigned char>(*text)
+					                   < 0x20
+					               ? ' '
+					               : *text);
+				}
+			}
+
+		  private:
+			static constexpr size_t GpuThreadId = 1000;
+
+			std::thread m_thread;
+			std::mutex m_mutex;
+			std::condition_variable m_condition;
+			std::deque<std::vector<ThreadZones>> m_frames;
+			std::vector<Event> m_events;
+			uint32_t m_framesLeft = 0;
+			bool m_done = false;
+			std::atomic<bool> m_writing{false};
+
+			// Writer thread only while running.
+			std::ofstream m_file;
+			std::string m_path;
+			uint64_t m_base = 0;
+			std::vector<size_t> m_namedThreads;
+			bool m_firstEvent = true;
+			uint64_t m_lastGpuGeneration = 0;
+		};
+
+		CaptureWriter captureWriter;
+
+		// Hitch capture. The history is main thread only;
+		// events come from any thread.
+		struct HistoryFrame
+		{
+			uint64_t start;
+			std::vector<ThreadZones> threads;
+		};
+
+		HitchSettings hitchSettings;
+		std::deque<HistoryFrame> history;
+		uint64_t historyGpuGeneration = 0;
+		// No trace until the previous one's window passed.
+		uint64_t nextHitch = 0;
+		std::atomic<uint32_t> hitchCount{0};
+		CaptureWriter hitchWriter;
+
+		std::atomic<bool> recordingEvents{false};
+		std::mutex eventsMutex;
+		std::deque<Event> events;
+
+		struct Budget
+		{
+			BudgetStatus status;
+			// Frames over budget, by frameIndex.
+			std::bitset<BudgetWindow> window;
+			uint64_t lastWarning = 0;
+		};
+
+		std::mutex budgetsMutex;
+		std::vector<Budget> budgets;
+		// Zone name pointers to their budget, or -1; names
+		// are literals, so each is compared once.
+		Core::FlatHashMap<const char*, int32_t> budgetIndices;
+		std::atomic<uint64_t> budgetViolations{0};
+
+		int32_t FindBudget(const char* name)
+		{
+			const auto [it, inserted] =
+			    budgetIndices.try_emplace(name, -1);
+			if (inserted)
+			{
+				for (size_t i = 0; i < budgets.size(); ++i)
+				{
+					if (budgets[i].status.zone == name)
+					{
+						it->second = static_cast<int32_t>(i);
+					}
+				}
+			}
+			return it->second;
+		}
+
+		// Main thread, after the frame's zones are drained.
+		void CheckBudgets()
+		{
+			std::lock_guard lock(budgetsMutex);
+			if (budgets.empty())
+			{
+				return;
+			}
+			std::vector<double> spent(budgets.size());
+			for (const auto& thread : lastFrame)
+			{
+				for (const auto& zone : thread.zones)
+				{
+					const auto index = FindBudget(zone.name);
+					if (index >= 0)
+					{
+						spent[index] +=
+						    TicksToMs(zone.end - zone.start);
+					}
+				}
+			}
+
+			const auto slot = frameIndex % BudgetWindow;
+			bool over = false;
+			for (size_t i = 0; i < budgets.size(); ++i)
+			{
+				auto& budget = budgets[i];
+				auto& status = budget.status;
+				status.lastMs = static_cast<float>(spent[i]);
+				status.worstMs =
+				    std::max(status.worstMs, status.lastMs);
+				const auto violated =
+				    status.lastMs > status.budgetMs;
+				budget.window[slot] = violated;
+				status.windowViolations =
+				    static_cast<uint32_t>(budget.window.count());
+				if (!violated)
+				{
+					continue;
+				}
+				over = true;
+				++status.totalViolations;
+				if (budget.lastWarning == 0
+				    || frameIndex - budget.lastWarning
+				           >= BudgetWindow)
+				{
+					budget.lastWarning = frameIndex;
+					VEGAM_WARN("{} took {:.2f} ms, over its "
+					           "{:.2f} ms budget ({} of the "
+					           "last {} frames)",
+					           status.zone, status.lastMs,
+					           status.budgetMs,
+					           status.windowViolations,
+					           BudgetWindow);
+				}
+			}
+			if (over)
+			{
+				budgetViolations.fetch_add(
+				    1, std::memory_order_relaxed);
+			}
+		}
+
+		void DrawBudgets()
+		{
+			const auto statuses = GetBudgets();
+			if (statuses.empty()
+			    || !ImGui::CollapsingHeader(
+			        "Budgets", ImGuiTreeNodeFlags_DefaultOpen)
+			    || !ImGui::BeginTable("Budgets", 5))
+			{
+				return;
+			}
+			for (const char* header :
+			     {"Zone", "Budget ms", "Last ms", "Worst ms",
+			      "Over"})
+			{
+				ImGui::TableSetupColumn(header);
+			}
+			ImGui::TableHeadersRow();
+			for (const auto& status : statuses)
+			{
+				const auto over =
+				    status.lastMs > status.budgetMs;
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(status.zone.c_str());
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", status.budgetMs);
+				ImGui::TableNextColumn();
+				if (over)
+				{
+					ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1),
+					                   "%.2f", status.lastMs);
+				}
+				else
+				{
+					ImGui::Text("%.2f", status.lastMs);
+				}
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", status.worstMs);
+				ImGui::TableNextColumn();
+				ImGui::Text("%u / %u", status.windowViolations,
+				            BudgetWindow);
+			}
+			ImGui::EndTable();
+		}
+
+		uint64_t MsToTicks(double milliseconds)
+		{
+			return static_cast<uint64_t>(
+			    milliseconds / 1000.0
+			    * static_cast<double>(
+			        SDL_GetPerformanceFrequency()));
+		}
+
+		float GetMedianFrameMs()
+		{
+			const auto count = std::min(frameIndex, FrameHistory);
+			std::array<float, FrameHistory> sorted = frameTimes;
+			const auto middle = sorted.begin() + count / 2;
+			std::nth_element(sorted.begin(), middle,
+			                 sorted.begin() + count);
+			return *middle;
+		}
+
+		void WriteHitch(uint64_t frameStart, float frameMs,
+		                float medianMs)
+		{
+			std::vector<std::vector<ThreadZones>> frames;
+			for (auto& frame : history)
+			{
+				frames.push_back(frame.threads);
+			}
+			std::vector<Event> context;
+			{
+				std::lock_guard lock(eventsMutex);
+				context.assign(events.begin(), events.end());
+			}
+			context.push_back(
+			    {"Hitch",
+			     fmt::format("frame {:.1f} ms, median {:.1f} ms",
+			                 frameMs, medianMs),
+			     frameStart});
+
+			const auto seconds =
+			    std::chrono::duration_cast<std::chrono::seconds>(
+			        std::chrono::system_clock::now()
+			            .time_since_epoch())
+			        .count();
+			const auto path =
+			    (std::filesystem::path(hitchSettings.directory)
+			     / ("Hitch-" + std::to_string(seconds) + "-"
+			        + std::to_string(frameIndex) + ".json"))
+			        .string();
+			if (hitchWriter.Dump(path, std::move(frames),
+			                     std::move(context),
+			                     history.front().start))
+			{
+				hitchCount.fetch_add(1, std::memory_order_relaxed);
+				VEGAM_WARN("Hitch: {:.1f} ms frame (median "
+				           "{:.1f} ms), writing {}",
+				           frameMs, medianMs, path);
+			}
+		}
+
+		// Main thread, after the frame's zones are drained.
+		void DetectHitch(uint64_t frameStart, uint64_t now)
+		{
+			history.push_back({frameStart, lastFrame});
+			AppendGpuZones(history.back().threads,
+			               historyGpuGeneration);
+			const auto window =
+			    MsToTicks(hitchSettings.historySeconds * 1000.0);
+			while (history.size() > 1
+			       && now - history.front().start > window)
+			{
+				history.pop_front();
+			}
+			{
+				std::lock_guard lock(eventsMutex);
+				while (!events.empty()
+				       && events.front().time
+				              < history.front().start)
+				{
+					events.pop_front();
+				}
+			}
+
+			// Too few frames for a stable median.
+			if (frameIndex < 30 || now < nextHitch)
+			{
+				return;
+			}
+			const auto frameMs =
+			    static_cast<float>(TicksToMs(now - frameStart));
+			const auto medianMs = GetMedianFrameMs();
+			if (frameMs < hitchSettings.minimumMs
+			    || frameMs < hitchSettings.medianMultiple
+			                     * medianMs)
+			{
+				return;
+			}
+			WriteHitch(frameStart, frameMs, medianMs);
+			nextHitch = now + window;
+		}
+
+		ThreadRing& GetThreadRing()
+		{
+			thread_local ThreadRing* ring = nullptr;
+			if (!ring)
+			{
+				std::lock_guard lock(ringsMutex);
+				rings.push_back(std::make_unique<ThreadRing>());
+				ring = rings.back().get();
+				ring->name =
+				    "Thread " + std::to_string(rings.size());
+			}
+			return *ring;
+		}
+	} // namespace
+
+	uint64_t Now() { return SDL_GetPerformanceCounter(); }
+
+	double TicksToMs(uint64_t ticks)
+	{
+		static const double frequency = static_cast<double>(
+		    SDL_GetPerformanceFrequency());
+		return static_cast<double>(ticks) * 1000.0 / frequency;
+	}
+
+	void SetThreadName(std::string name)
+	{
+		auto& ring = GetThreadRing();
+		std::lock_guard lock(ringsMutex);
+		ring.name = std::move(name);
+	}
+
+	void Record(const char* name, uint64_t start,
+	            uint64_t end, uint32_t depth,
+	            const PerfCounters::Values& counters)
+	{
+		auto& ring = GetThreadRing();
+		const auto write =
+		    ring.write.load(std::memory_order_relaxed);
+		if (write - ring.read.load(std::memory_order_acquire)
+		    >= RingCapacity)
+		{
+			ring.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		ring.zones[write % RingCapacity] = {name, start, end,
+		                                    depth, counters};
+		ring.write.store(write + 1, std::memory_order_release);
+	}
+
+	void EndFrame()
+	{
+		const auto now = Now();
+		const auto frameStart = lastFrameEnd;
+		if (lastFrameEnd != 0)
+		{
+			frameTimes[frameIndex % FrameHistory] =
+			    static_cast<float>(
+			        TicksToMs(now - lastFrameEnd));
+			++frameIndex;
+		}
+		lastFrameEnd = now;
+
+		std::lock_guard lock(ringsMutex);
+		lastFrame.resize(rings.size());
+		for (size_t i = 0; i < rings.size(); ++i)
+		{
+			auto& ring = *rings[i];
+			auto& frame = lastFrame[i];
+			frame.threadName = ring.name;
+			frame.zones.clear();
+			frame.dropped = ring.dropped.exchange(
+			    0, std::memory_order_relaxed);
+
+			const auto write =
+			    ring.write.load(std::memory_order_acquire);
+			for (auto read =
+			         ring.read.load(std::memory_order_relaxed);
+			     read < write; ++read)
+			{
+				frame.zones.push_back(
+				    ring.zones[read % RingCapacity]);
+			}
+			ring.read.store(write, std::memory_order_release);
+
+			// Zones are recorded when they close; show
+			// them in the order they opened.
+			std::sort(frame.zones.begin(), frame.zones.end(),
+			          [](const Zone& a, const Zone& b) {
+				          return a.start < b.start;
+			          });
+		}
+
+		captureWriter.AddFrame(lastFrame);
+		CheckBudgets();
+		if (!hitchSettings.directory.empty() && frameStart != 0)
+		{
+			DetectHitch(frameStart, now);
+		}
+	}
+
+	bool StartCapture(const std::string& path,
+	                  uint32_t frameCount)
+	{
+		if (frameCount == 0)
+		{
+			return false;
+		}
+		return captureWriter.Start(path, frameCount);
+	}
+
+	bool IsCapturing() { return captureWriter.IsCapturing(); }
+
+	void Shutdown()
+	{
+		captureWriter.Finish();
+		hitchWriter.Finish();
+		for (const auto& status : GetBudgets())
+		{
+			if (status.totalViolations > 0)
+			{
+				VEGAM_WARN("{} went over its {:.2f} ms budget "
+				           "in {} frames, worst {:.2f} ms",
+				           status.zone, status.budgetMs,
+				           status.totalViolations,
+				           status.worstMs);
+			}
+		}
+	}
+
+	void SetBudget(const std::string& zone,
+	               float milliseconds)
+	{
+		std::lock_guard lock(budgetsMutex);
+		budgetIndices.clear();
+		const auto it = std::find_if(
+		    budgets.begin(), budgets.end(),
+		    [&](const Budget& budget) {
+			    return budget.status.zone == zone;
+		    });
+		if (milliseconds <= 0.0f)
+		{
+			if (it != budgets.end())
+			{
+				budgets.erase(it);
+			}
+			return;
+		}
+		if (it != budgets.end())
+		{
+			it->status.budgetMs = milliseconds;
+			return;
+		}
+		Budget budget;
+		budget.status.zone = zone;
+		budget.status.budgetMs = milliseconds;
+		budgets.push_back(std::move(budget));
+	}
+
+	std::vector<BudgetStatus> GetBudgets()
+	{
+		std::lock_guard lock(budgetsMutex);
+		std::vector<BudgetStatus> statuses;
+		for (const auto& budget : budgets)
+		{
+			statuses.push_back(budget.status);
+		}
+		return statuses;
+	}
+
+	uint64_t GetBudgetViolations()
+	{
+		return budgetViolations.load(std::memory_order_relaxed);
+	}
+
+	void SetHitchCapture(const HitchSettings& settings)
+	{
+		hitchSettings = settings;
+		history.clear();
+		nextHitch = 0;
+		if (!settings.directory.empty())
+		{
+			std::error_code error;
+			std::filesystem::create_directories(
+			    settings.directory, error);
+			VEGAM_INFO("Writing hitches over {}x the median "
+			           "frame to {}",
+			           settings.medianMultiple,
+			           settings.directory);
+		}
+		recordingEvents = !settings.directory.empty();
+		if (!recordingEvents)
+		{
+			std::lock_guard lock(eventsMutex);
+			events.clear();
+		}
+	}
+
+	uint32_t GetHitchCount()
+	{
+		return hitchCount.load(std::memory_order_relaxed);
+	}
+
+	bool IsRecordingEvents()
+	{
+		return recordingEvents.load(std::memory_order_relaxed);
+	}
+
+	void AddEvent(const char* category, std::string detail)
+	{
+		if (!IsRecordingEvents())
+		{
+			return;
+		}
+		const auto time = Now();
+		std::lock_guard lock(eventsMutex);
+		events.push_back({category, std::move(detail), time});
+	}
+
+	const std::vector<ThreadZones>& GetLastFrame()
+	{
+		return lastFrame;
+	}
+
+	void SetGpuZones(const std::vector<Zone>& zones)
+	{
+		std::lock_guard lock(gpuMutex);
+		gpuZones.zones = zones;
+		++gpuGeneration;
+	}
+
+	void DrawPanel()
+	{
+		if (!ImGui::Begin("Profiler"))
+		{
+			ImGui::End();
+			return;
+		}
+
+		const auto count = std::min(frameIndex, FrameHistory);
+		if (count > 0)
+		{
+			const auto offset = frameIndex % FrameHistory;
+			ImGui::PlotLines(
+			    "Frame ms", frameTimes.data(),
+			    static_cast<int>(count),
+			    count == FrameHistory ? offset : 0, nullptr,
+			    0.0f, 50.0f, ImVec2(0, 60));
+		}
+		DrawBudgets();
+
+		const auto drawThread = [](const ThreadZones& thread) {
+			if (thread.zones.empty()
+			    || !ImGui::CollapsingHeader(
+			        thread.threadName.c_str(),
+			        ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				return;
+			}
+			if (thread.dropped > 0)
+			{
+				ImGui::Text("%u zones dropped", thread.dropped);
+			}
+			using PerfCounters::Counter;
+			const auto read = [](const Zone& zone,
+			                     Counter counter) {
+				return static_cast<unsigned long long>(
+				    zone.counters[static_cast<size_t>(counter)]);
+			};
+			for (const auto& zone : thread.zones)
+			{
+				ImGui::Text("%*s%-32s %8.3f ms",
+				            static_cast<int>(zone.depth * 2), "",
+				            zone.name,
+				            TicksToMs(zone.end - zone.start));
+				const auto cycles = read(zone, Counter::Cycles);
+				if (cycles == 0)
+				{
+					continue;
+				}
+				ImGui::SameLine();
+				ImGui::Text(
+				    " IPC %.2f  LLC miss %llu  branch miss %llu",
+				    static_cast<double>(
+				        read(zone, Counter::Instructions))
+				        / cycles,
+				    read(zone, Counter::CacheMisses),
+				    read(zone, Counter::BranchMisses));
+			}
+		};
+		for (const auto& thread : lastFrame)
+		{
+			drawThread(thread);
+		}
+		{
+			std::lock_guard lock(gpuMutex);
+			drawThread(gpuZones);
+		}
+		ImGui::End();
+	}
+
+	// Counters are read outside the timed span, so the
+	// syscall doesn't inflate the zone.
+	Scope::Scope(const char* name)
+	    : m_name(name)
+	    , m_counted(PerfCounters::Read(m_counters))
+	{
+		++GetThreadRing().depth;
+		m_start = Now();
+	}
+
+	Scope::~Scope()
+	{
+		const auto end = Now();
+		auto& ring = GetThreadRing();
+		PerfCounters::Values counters{};
+		if (m_counted && PerfCounters::Read(counters))
+		{
+			for (size_t i = 0; i < counters.size(); ++i)
+			{
+				counters[i] -= m_counters[i];
+			}
+		}
+		else
+		{
+			counters = {};
+		}
+		Record(m_name, m_start, end, --ring.depth, counters);
+	}
+} // namespace AthiVegam::Core::Profiler
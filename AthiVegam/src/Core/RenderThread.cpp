@@ -0,0 +1,100 @@
+#include "AthiVegam/Core/RenderThread.h"
+
+#include "AthiVegam/Core/CpuTopology.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Log.h"
+
+namespace AthiVegam::Core
+{
+	RenderThread::~RenderThread() { Stop(); }
+
+	bool RenderThread::Start()
+	{
+		VEGAM_ASSERT(!IsRunning(),
+		             "Render thread is already running!");
+		if (IsRunning())
+		{
+			return false;
+		}
+
+		if (!Engine::Instance().GetWindow().MakeContextCurrent(
+		        false))
+		{
+			return false;
+		}
+
+		m_framePending = false;
+		m_stopRequested = false;
+		m_thread = std::thread(&RenderThread::Run, this);
+		VEGAM_INFO("Render thread started");
+		return true;
+	}
+
+	void RenderThread::Stop()
+	{
+		if (!IsRunning())
+		{
+			return;
+		}
+
+		{
+			std::lock_guard lock(m_mutex);
+			m_stopRequested = true;
+		}
+		m_condition.notify_all();
+		m_thread.join();
+
+		Engine::Instance().GetWindow().MakeContextCurrent(
+		    true);
+		VEGAM_INFO("Render thread stopped");
+	}
+
+	void RenderThread::SubmitFrame()
+	{
+		std::unique_lock lock(m_mutex);
+		m_condition.wait(lock,
+		                 [this] { return !m_framePending; });
+
+		// The render thread is idle, so the frame buffers
+		// can change hands.
+		Engine::Instance().GetWindow().SwapFrames();
+		m_framePending = true;
+
+		lock.unlock();
+		m_condition.notify_all();
+	}
+
+	void RenderThread::Run()
+	{
+		Profiler::SetThreadName("Render");
+		SetThreadClass(ThreadClass::Latency);
+		auto& window = Engine::Instance().GetWindow();
+		window.MakeContextCurrent(true);
+
+		while (true)
+		{
+			{
+				std::unique_lock lock(m_mutex);
+				m_condition.wait(lock, [this] {
+					return m_framePending || m_stopRequested;
+				});
+				// Finish the submitted frame before stopping.
+				if (!m_framePending)
+				{
+					break;
+				}
+			}
+
+			window.RenderFrame();
+
+			{
+				std::lock_guard lock(m_mutex);
+				m_framePending = false;
+			}
+			m_condition.notify_all();
+		}
+
+		window.MakeContextCurrent(false);
+	}
+} // namespace AthiVegam::Core
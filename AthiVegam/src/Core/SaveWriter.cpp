@@ -0,0 +1,230 @@
+#include "AthiVegam/Core/SaveWriter.h"
+
+#include "AthiVegam/Assets/Lz4.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Log.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+namespace AthiVegam::Core
+{
+	namespace
+	{
+		constexpr uint32_t Magic = 0x47535641; // "AVSG"
+		constexpr uint16_t Version = 1;
+
+		enum class Compression : uint16_t
+		{
+			None,
+			Lz4,
+		};
+
+		struct Header
+		{
+			uint32_t magic;
+			uint16_t version;
+			Compression compression;
+			// Serialized, and as stored after the header.
+			uint64_t size;
+			uint64_t storedSize;
+		};
+
+		static_assert(sizeof(Header) == 24);
+
+		using Clock = std::chrono::steady_clock;
+
+		inline double Milliseconds(Clock::time_point start)
+		{
+			return std::chrono::duration<double, std::milli>(
+			           Clock::now() - start)
+			    .count();
+		}
+	} // namespace
+
+	SaveWriter::~SaveWriter() { Wait(); }
+
+	void SaveWriter::Write(const std::string& path,
+	                       Serialize serialize)
+	{
+		std::lock_guard lock(m_mutex);
+		for (auto& pending : m_pending)
+		{
+			if (pending.path == path)
+			{
+				pending.serialize = std::move(serialize);
+				return;
+			}
+		}
+		m_pending.push_back({path, std::move(serialize)});
+		if (!m_writing)
+		{
+			m_writing = true;
+			Engine::Instance().GetJobManager().Schedule(
+			    [this] { Drain(); }, &m_jobs);
+		}
+	}
+
+	void SaveWriter::Wait()
+	{
+		Engine::Instance().GetJobManager().Wait(m_jobs);
+	}
+
+	bool SaveWriter::IsWriting() const
+	{
+		std::lock_guard lock(m_mutex);
+		return m_writing;
+	}
+
+	SaveWriter::Stats SaveWriter::GetStats() const
+	{
+		std::lock_guard lock(m_mutex);
+		return m_stats;
+	}
+
+	void SaveWriter::Drain()
+	{
+		while (true)
+		{
+			Pending pending;
+			Stats stats;
+			{
+				std::lock_guard lock(m_mutex);
+				if (m_pending.empty())
+				{
+					m_writing = false;
+					return;
+				}
+				pending = std::move(m_pending.front());
+				m_pending.pop_front();
+			}
+
+			const auto written = WriteFile(pending, stats);
+			std::lock_guard lock(m_mutex);
+			stats.writes = m_stats.writes + (written ? 1 : 0);
+			stats.failures =
+			    m_stats.failures + (written ? 0 : 1);
+			m_stats = stats;
+		}
+	}
+
+	bool SaveWriter::WriteFile(const Pending& pending,
+	                           Stats& stats)
+	{
+		VEGAM_PROFILE_SCOPE("SaveWriter::WriteFile");
+		auto start = Clock::now();
+		m_data.clear();
+		pending.serialize(m_data);
+		stats.serializeMs = Milliseconds(start);
+
+		start = Clock::now();
+		m_compressed.resize(
+		    Assets::Lz4::GetMaxCompressedSize(m_data.size()));
+		auto storedSize = Assets::Lz4::Compress(
+		    m_data.data(), m_data.size(), m_compressed.data());
+		auto compression = Compression::Lz4;
+		const auto* stored = m_compressed.data();
+		// Already compressed data, e.g. textures, is kept
+		// as it is.
+		if (storedSize >= m_data.size())
+		{
+			storedSize = m_data.size();
+			compression = Compression::None;
+			stored = m_data.data();
+		}
+		stats.compressMs = Milliseconds(start);
+		stats.bytes = m_data.size();
+		stats.storedBytes = storedSize;
+
+		// Written next to the save and renamed over it, so
+		// a crash never leaves a truncated save behind.
+		start = Clock::now();
+		const Header header{Magic, Version, compression,
+		                    m_data.size(), storedSize};
+		const auto temporary = pending.path + ".tmp";
+		{
+			std::ofstream file(temporary, std::ios::binary
+			                                  | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(&header),
+			           sizeof(header));
+			file.write(reinterpret_cast<const char*>(stored),
+			           static_cast<std::streamsize>(storedSize));
+			file.flush();
+			if (!file)
+			{
+				VEGAM_ERROR("Failed to write save {}",
+				            temporary);
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporary, pending.path,
+		                        error);
+		stats.writeMs = Milliseconds(start);
+		if (error)
+		{
+			VEGAM_ERROR("Failed to write save {}: {}",
+			            pending.path, error.message());
+			return false;
+		}
+		return true;
+	}
+
+	bool SaveWriter::Read(const std::string& path,
+	                      std::vector<uint8_t>& data)
+	{
+		VEGAM_PROFILE_SCOPE("SaveWriter::Read");
+		std::error_code error;
+		const auto fileSize =
+		    std::filesystem::file_size(path, error);
+		std::ifstream file(path, std::ios::binary);
+		if (error || !file)
+		{
+			return false;
+		}
+
+		Header header{};
+		file.read(reinterpret_cast<char*>(&header),
+		          sizeof(header));
+		if (!file || header.magic != Magic
+		    || header.version != Version
+		    || (header.compression != Compression::None
+		        && header.compression != Compression::Lz4)
+		    || header.storedSize != fileSize - sizeof(header)
+		    // LZ4 expands at most 255 times.
+		    || header.size / 255 > header.storedSize)
+		{
+			VEGAM_ERROR("{} is not a save", path);
+			return false;
+		}
+
+		std::vector<uint8_t> stored(header.storedSize);
+		file.read(reinterpret_cast<char*>(stored.data()),
+		          static_cast<std::streamsize>(stored.size()));
+		if (!file)
+		{
+			VEGAM_ERROR("Save {} is truncated", path);
+			return false;
+		}
+		if (header.compression == Compression::None)
+		{
+			data = std::move(stored);
+			return header.size == header.storedSize;
+		}
+
+		data.resize(header.size);
+		if (!Assets::Lz4::Decompress(stored.data(),
+		                             stored.size(), data.data(),
+		                             data.size()))
+		{
+			VEGAM_ERROR("Save {} is corrupt", path);
+			return false;
+		}
+		return true;
+	}
+} // namespace AthiVegam::Core
@@ -0,0 +1,77 @@
+#include "AthiVegam/Core/Serialize.h"
+
+#include "AthiVegam/Log.h"
+
+namespace AthiVegam::Core::Serial
+{
+	namespace Detail
+	{
+		void Writer::Align(size_t alignment)
+		{
+			const auto size = m_buffer.size();
+			m_buffer.resize((size + alignment - 1)
+			                & ~(alignment - 1));
+		}
+
+		size_t Writer::Reserve(size_t size)
+		{
+			const auto offset = m_buffer.size();
+			VEGAM_ASSERT(offset + size <= UINT32_MAX,
+			             "Serial data is limited to 4 GiB");
+			m_buffer.resize(offset + size);
+			return offset;
+		}
+
+		size_t Writer::Append(const void* data, size_t size)
+		{
+			const auto offset = Reserve(size);
+			if (size > 0)
+			{
+				std::memcpy(m_buffer.data() + offset, data, size);
+			}
+			return offset;
+		}
+
+		void Writer::WriteAt(size_t offset, uint32_t value)
+		{
+			std::memcpy(m_buffer.data() + offset, &value, 4);
+		}
+	} // namespace Detail
+
+	bool OpenHeader(const uint8_t* data, size_t size,
+	                Header& header)
+	{
+		if (data == nullptr || size < sizeof(Header))
+		{
+			VEGAM_ERROR("Serial data too small: {} bytes", size);
+			return false;
+		}
+		if (reinterpret_cast<uintptr_t>(data) % MaxAlignment != 0)
+		{
+			VEGAM_ERROR("Serial data must be {}-byte aligned",
+			            MaxAlignment);
+			return false;
+		}
+
+		std::memcpy(&header, data, sizeof(header));
+		if (header.magic != Magic)
+		{
+			VEGAM_ERROR("Not serial data");
+			return false;
+		}
+		if (header.formatVersion != FormatVersion)
+		{
+			VEGAM_ERROR("Serial format version {}, expected {}",
+			            header.formatVersion, FormatVersion);
+			return false;
+		}
+		if (header.size > size
+		    || header.rootOffset + size_t{4} > header.size)
+		{
+			VEGAM_ERROR("Serial data truncated: {} of {} bytes",
+			            size, header.size);
+			return false;
+		}
+		return true;
+	}
+} // namespace AthiVegam::Core::Serial
@@ -0,0 +1,81 @@
+#include "AthiVegam/Core/StartupTimer.h"
+
+#include "AthiVegam/Log.h"
+
+#include <mutex>
+#include <vector>
+
+namespace AthiVegam::Core
+{
+	namespace
+	{
+		using Milliseconds =
+		    std::chrono::duration<double, std::milli>;
+
+		struct Phase
+		{
+			const char* name;
+			StartupTimer::Clock::time_point start;
+			StartupTimer::Clock::time_point end;
+		};
+
+		// Close enough to process start: set while static
+		// objects are initialized, before main().
+		const auto processStart = StartupTimer::Clock::now();
+
+		std::mutex phasesMutex;
+		std::vector<Phase> phases;
+		bool reported = false;
+
+		void Record(const char* name,
+		            StartupTimer::Clock::time_point start)
+		{
+			const auto end = StartupTimer::Clock::now();
+			std::lock_guard lock(phasesMutex);
+			if (!reported)
+			{
+				phases.push_back({name, start, end});
+			}
+		}
+	} // namespace
+
+	StartupTimer::Scope::Scope(const char* name)
+	    : m_name(name), m_start(Clock::now())
+	{
+	}
+
+	StartupTimer::Scope::~Scope() { Record(m_name, m_start); }
+
+	void StartupTimer::Scope::Next(const char* name)
+	{
+		Record(m_name, m_start);
+		m_name = name;
+		m_start = Clock::now();
+	}
+
+	void StartupTimer::Report()
+	{
+		const auto now = Clock::now();
+		std::lock_guard lock(phasesMutex);
+		if (reported)
+		{
+			return;
+		}
+		reported = true;
+
+		VEGAM_INFO("Startup phases (start, duration):");
+		for (const auto& phase : phases)
+		{
+			VEGAM_INFO("  {:<24} {:8.2f} ms {:8.2f} ms",
+			           phase.name,
+			           Milliseconds(phase.start - processStart)
+			               .count(),
+			           Milliseconds(phase.end - phase.start)
+			               .count());
+		}
+		VEGAM_INFO("Startup to first frame: {:.2f} ms",
+		           Milliseconds(now - processStart).count());
+		phases.clear();
+		phases.shrink_to_fit();
+	}
+} // namespace AthiVegam::Core
@@ -0,0 +1,53 @@
+#include "AthiVegam/Core/StringId.h"
+
+#include "AthiVegam/Log.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace AthiVegam::Core
+{
+	namespace
+	{
+		struct InternTable
+		{
+			std::mutex mutex;
+			// Nodes never move, so views of the strings
+			// stay valid.
+			std::unordered_map<StringId, std::string,
+			                   StringIdHash>
+			    strings;
+		};
+
+		InternTable& GetTable()
+		{
+			static InternTable table;
+			return table;
+		}
+	} // namespace
+
+	StringId Intern(std::string_view name)
+	{
+		const auto id = MakeStringId(name);
+		auto& table = GetTable();
+		std::lock_guard lock(table.mutex);
+		const auto [it, added] =
+		    table.strings.try_emplace(id, name);
+		if (!added && it->second != name)
+		{
+			VEGAM_ERROR("String id collision: {} and {}",
+			            it->second, name);
+		}
+		return id;
+	}
+
+	std::string_view GetString(StringId id)
+	{
+		auto& table = GetTable();
+		std::lock_guard lock(table.mutex);
+		const auto it = table.strings.find(id);
+		return it != table.strings.end() ? it->second
+		                                 : std::string_view();
+	}
+} // namespace AthiVegam::Core
@@ -0,0 +1,152 @@
+#include "AthiVegam/Core/Task.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Managers/JobManager.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace AthiVegam::Core::Coroutines
+{
+	namespace
+	{
+		struct Waiter
+		{
+			std::coroutine_handle<> handle;
+			std::function<bool()> ready;
+		};
+
+		// Coroutines may suspend on any thread, e.g. after
+		// ResumeOn, so the lists are shared.
+		std::mutex mutex;
+		std::vector<std::coroutine_handle<>> roots;
+		std::vector<std::coroutine_handle<>> nextFrame;
+		std::vector<Waiter> waiters;
+
+		Managers::JobManager* jobManager = nullptr;
+		Managers::JobCounter jobs;
+	} // namespace
+
+	namespace Detail
+	{
+		void AddRoot(std::coroutine_handle<> handle)
+		{
+			std::lock_guard lock(mutex);
+			roots.push_back(handle);
+		}
+
+		void RemoveRoot(std::coroutine_handle<> handle)
+		{
+			std::lock_guard lock(mutex);
+			const auto it =
+			    std::find(roots.begin(), roots.end(), handle);
+			if (it != roots.end())
+			{
+				*it = roots.back();
+				roots.pop_back();
+			}
+		}
+
+		void ResumeNextFrame(std::coroutine_handle<> handle)
+		{
+			std::lock_guard lock(mutex);
+			nextFrame.push_back(handle);
+		}
+
+		void ResumeWhen(std::coroutine_handle<> handle,
+		                std::function<bool()> ready)
+		{
+			std::lock_guard lock(mutex);
+			waiters.push_back({handle, std::move(ready)});
+		}
+
+		void ResumeOnJob(Managers::JobManager& manager,
+		                 std::coroutine_handle<> handle)
+		{
+			jobManager = &manager;
+			manager.Schedule([handle] { handle.resume(); },
+			                 &jobs);
+		}
+	} // namespace Detail
+
+	void Spawn(Task<void> task)
+	{
+		auto handle = task.Release();
+		if (!handle)
+		{
+			return;
+		}
+		handle.promise().detached = true;
+		Detail::AddRoot(handle);
+		handle.resume();
+	}
+
+	void Update()
+	{
+		VEGAM_PROFILE_SCOPE("Coroutines::Update");
+		std::vector<std::coroutine_handle<>> resume;
+		std::vector<Waiter> waiting;
+		{
+			std::lock_guard lock(mutex);
+			resume.swap(nextFrame);
+			waiting.swap(waiters);
+		}
+		// Coroutines suspending again from here wait for
+		// the next Update().
+		for (auto handle : resume)
+		{
+			handle.resume();
+		}
+
+		size_t kept = 0;
+		for (auto& waiter : waiting)
+		{
+			if (waiter.ready())
+			{
+				waiter.handle.resume();
+			}
+			else
+			{
+				waiting[kept++] = std::move(waiter);
+			}
+		}
+		waiting.resize(kept);
+		if (kept > 0)
+		{
+			std::lock_guard lock(mutex);
+			waiters.insert(
+			    waiters.begin(),
+			    std::make_move_iterator(waiting.begin()),
+			    std::make_move_iterator(waiting.end()));
+		}
+	}
+
+	void Shutdown()
+	{
+		if (jobManager)
+		{
+			jobManager->Wait(jobs);
+			jobManager = nullptr;
+		}
+
+		std::vector<std::coroutine_handle<>> destroy;
+		{
+			std::lock_guard lock(mutex);
+			nextFrame.clear();
+			waiters.clear();
+			destroy.swap(roots);
+		}
+		// Destroying a root destroys the tasks it awaits.
+		for (auto handle : destroy)
+		{
+			handle.destroy();
+		}
+	}
+
+	size_t GetRunningCount()
+	{
+		std::lock_guard lock(mutex);
+		return roots.size();
+	}
+} // namespace AthiVegam::Core::Coroutines
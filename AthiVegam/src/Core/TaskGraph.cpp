@@ -0,0 +1,266 @@
+#include "AthiVegam/Core/TaskGraph.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+namespace AthiVegam::Core
+{
+	void TaskGraph::AddStage(
+	    std::string name,
+	    std::initializer_list<std::string_view> reads,
+	    std::initializer_list<std::string_view> writes,
+	    StageFunction function, Affinity affinity)
+	{
+		AddStage(std::move(name),
+		         std::vector<std::string>(reads.begin(),
+		                                  reads.end()),
+		         std::vector<std::string>(writes.begin(),
+		                                  writes.end()),
+		         std::move(function), affinity);
+	}
+
+	void TaskGraph::AddStage(std::string name,
+	                         std::vector<std::string> reads,
+	                         std::vector<std::string> writes,
+	                         StageFunction function,
+	                         Affinity affinity)
+	{
+		Stage stage;
+		stage.name = std::move(name);
+		stage.reads = std::move(reads);
+		stage.writes = std::move(writes);
+		stage.function = std::move(function);
+		stage.affinity = affinity;
+		m_stages.push_back(std::move(stage));
+		m_compiled = false;
+	}
+
+	bool TaskGraph::AddDependency(std::string_view before,
+	                              std::string_view after)
+	{
+		const auto first = FindStage(before);
+		const auto second = FindStage(after);
+		if (first < 0 || second < 0)
+		{
+			VEGAM_WARN("Task graph dependency between unknown "
+			           "stages {} and {}",
+			           before, after);
+			return false;
+		}
+
+		m_explicitEdges.emplace_back(first, second);
+		m_compiled = false;
+		return true;
+	}
+
+	int32_t TaskGraph::FindStage(std::string_view name) const
+	{
+		for (size_t i = 0; i < m_stages.size(); ++i)
+		{
+			if (m_stages[i].name == name)
+			{
+				return static_cast<int32_t>(i);
+			}
+		}
+		return -1;
+	}
+
+	void TaskGraph::AddEdge(uint32_t before, uint32_t after)
+	{
+		auto& dependents = m_stages[before].dependents;
+		if (before == after
+		    || std::find(dependents.begin(), dependents.end(),
+		                 after)
+		           != dependents.end())
+		{
+			return;
+		}
+		dependents.push_back(after);
+		++m_stages[after].dependencyCount;
+	}
+
+	void TaskGraph::Compile()
+	{
+		for (auto& stage : m_stages)
+		{
+			stage.dependents.clear();
+			stage.dependencyCount = 0;
+		}
+
+		struct Access
+		{
+			int32_t writer = -1;
+			std::vector<uint32_t> readers;
+		};
+		std::unordered_map<std::string, Access> resources;
+
+		const auto count = static_cast<uint32_t>(m_stages.size());
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			for (const auto& read : m_stages[i].reads)
+			{
+				auto& access = resources[read];
+				if (access.writer >= 0)
+				{
+					AddEdge(access.writer, i);
+				}
+				access.readers.push_back(i);
+			}
+			for (const auto& write : m_stages[i].writes)
+			{
+				auto& access = resources[write];
+				if (access.writer >= 0)
+				{
+					AddEdge(access.writer, i);
+				}
+				for (auto reader : access.readers)
+				{
+					AddEdge(reader, i);
+				}
+				access.readers.clear();
+				access.writer = static_cast<int32_t>(i);
+			}
+		}
+		for (const auto& [before, after] : m_explicitEdges)
+		{
+			AddEdge(before, after);
+		}
+
+		// Explicit edges can close a cycle; run serially in
+		// registration order rather than deadlock.
+		std::vector<uint32_t> remaining(count);
+		std::vector<uint32_t> ready;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			remaining[i] = m_stages[i].dependencyCount;
+			if (remaining[i] == 0)
+			{
+				ready.push_back(i);
+			}
+		}
+		uint32_t visited = 0;
+		while (!ready.empty())
+		{
+			const auto stage = ready.back();
+			ready.pop_back();
+			++visited;
+			for (auto dependent : m_stages[stage].dependents)
+			{
+				if (--remaining[dependent] == 0)
+				{
+					ready.push_back(dependent);
+				}
+			}
+		}
+		if (visited != count)
+		{
+			VEGAM_ERROR("Task graph has a dependency cycle; "
+			            "running stages serially");
+			for (auto& stage : m_stages)
+			{
+				stage.dependents.clear();
+				stage.dependencyCount = 0;
+			}
+			for (uint32_t i = 1; i < count; ++i)
+			{
+				AddEdge(i - 1, i);
+			}
+		}
+
+		m_remaining =
+		    std::make_unique<std::atomic<uint32_t>[]>(count);
+		m_compiled = true;
+	}
+
+	void TaskGraph::Execute(Managers::JobManager& jobs)
+	{
+		if (!m_compiled)
+		{
+			Compile();
+		}
+
+		const auto count = static_cast<uint32_t>(m_stages.size());
+		m_jobs = &jobs;
+		m_completed.store(0, std::memory_order_relaxed);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			m_remaining[i].store(m_stages[i].dependencyCount,
+			                     std::memory_order_relaxed);
+		}
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (m_stages[i].dependencyCount == 0)
+			{
+				MakeReady(i);
+			}
+		}
+
+		while (m_completed.load(std::memory_order_acquire)
+		       < count)
+		{
+			int64_t stage = -1;
+			{
+				std::lock_guard lock(m_mainMutex);
+				if (!m_mainReady.empty())
+				{
+					// Lowest index first keeps registration
+					// order among ready main-thread stages.
+					auto it = std::min_element(
+					    m_mainReady.begin(), m_mainReady.end());
+					stage = *it;
+					m_mainReady.erase(it);
+				}
+			}
+
+			if (stage >= 0)
+			{
+				RunStage(static_cast<uint32_t>(stage));
+			}
+			else if (!jobs.RunPendingJob())
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		// Stage jobs finish their bookkeeping after the last
+		// stage is counted.
+		jobs.Wait(m_jobCounter);
+		m_jobs = nullptr;
+	}
+
+	void TaskGraph::MakeReady(uint32_t stage)
+	{
+		if (m_stages[stage].affinity == Affinity::MainThread)
+		{
+			std::lock_guard lock(m_mainMutex);
+			m_mainReady.push_back(stage);
+			return;
+		}
+
+		m_jobs->Schedule([this, stage] { RunStage(stage); },
+		                 &m_jobCounter);
+	}
+
+	void TaskGraph::RunStage(uint32_t stage)
+	{
+		{
+			VEGAM_PROFILE_SCOPE(m_stages[stage].name.c_str());
+			m_stages[stage].function();
+		}
+
+		for (auto dependent : m_stages[stage].dependents)
+		{
+			if (m_remaining[dependent].fetch_sub(
+			        1, std::memory_order_acq_rel)
+			    == 1)
+			{
+				MakeReady(dependent);
+			}
+		}
+		m_completed.fetch_add(1, std::memory_order_release);
+	}
+} // namespace AthiVegam::Core
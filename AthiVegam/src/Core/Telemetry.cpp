@@ -0,0 +1,318 @@
+#include "AthiVegam/Core/Telemetry.h"
+
+#include "AthiVegam/Core/CpuTopology.h"
+#include "AthiVegam/Core/Memory.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/GpuProfiler.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+
+namespace AthiVegam::Core::Telemetry
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		constexpr const char* Extension = ".avtm";
+		// Frames between median updates, and before hitches
+		// count.
+		constexpr uint32_t MedianInterval = 64;
+		// Spooled reports are retried this often.
+		constexpr auto RetryInterval = std::chrono::minutes(1);
+
+		struct Section
+		{
+			std::string name;
+			uint64_t startTime = 0;
+			Clock::time_point start;
+			Histogram cpu;
+			Histogram gpu;
+			uint32_t frames = 0;
+			uint32_t hitches = 0;
+			uint64_t cpuPeak = 0;
+			uint64_t gpuPeak = 0;
+		};
+
+		// Main thread only.
+		bool running = false;
+		std::string session;
+		std::string buildName;
+		std::filesystem::path spool;
+		Section current;
+		Clock::time_point lastFrame;
+		bool hasLastFrame = false;
+		float medianMs = 0.0f;
+
+		// Shared with the upload thread.
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::deque<Report> pending;
+		Uploader uploader;
+		bool stopping = false;
+		std::thread thread;
+		uint32_t written = 0;
+
+		uint64_t GetUnixTime()
+		{
+			return static_cast<uint64_t>(
+			    std::chrono::duration_cast<std::chrono::seconds>(
+			        std::chrono::system_clock::now()
+			            .time_since_epoch())
+			        .count());
+		}
+
+		std::string MakeSessionId()
+		{
+			std::random_device device;
+			const auto id =
+			    static_cast<uint64_t>(device()) << 32 | device();
+			return fmt::format("{:016x}", id);
+		}
+
+		void StartSection(std::string name)
+		{
+			current = Section{};
+			current.name = std::move(name);
+			current.startTime = GetUnixTime();
+			current.start = Clock::now();
+			hasLastFrame = false;
+			medianMs = 0.0f;
+		}
+
+		void SubmitSection()
+		{
+			if (current.frames == 0)
+			{
+				return;
+			}
+			Report report;
+			report.session = session;
+			report.section = current.name;
+			report.build = buildName;
+			report.startTime = current.startTime;
+			report.seconds =
+			    std::chrono::duration<float>(Clock::now()
+			                                 - current.start)
+			        .count();
+			report.frames = current.frames;
+			report.hitches = current.hitches;
+			report.cpuFrameTimes = current.cpu.GetBuckets();
+			report.gpuFrameTimes = current.gpu.GetBuckets();
+			report.cpuMemoryPeak = current.cpuPeak;
+			report.gpuMemoryPeak = current.gpuPeak;
+
+			std::lock_guard lock(mutex);
+			pending.push_back(std::move(report));
+			wake.notify_one();
+		}
+
+		// Upload thread.
+		void Spool(const Report& report)
+		{
+			std::vector<uint8_t> data;
+			Serial::Save(report, data, SchemaVersion);
+			const auto path =
+			    spool
+			    / fmt::format("{}-{}{}", report.session,
+			                  written++, Extension);
+			std::ofstream file(path, std::ios::binary);
+			file.write(reinterpret_cast<const char*>(data.data()),
+			           static_cast<std::streamsize>(data.size()));
+			if (!file)
+			{
+				VEGAM_WARN("Could not spool telemetry to {}",
+				           path.string());
+			}
+		}
+
+		// Oldest first; stops at the first refusal.
+		void UploadSpooled(const Uploader& upload)
+		{
+			std::error_code error;
+			std::vector<std::pair<std::filesystem::file_time_type,
+			                      std::filesystem::path>>
+			    files;
+			for (const auto& entry :
+			     std::filesystem::directory_iterator(spool,
+			                                         error))
+			{
+				if (entry.path().extension() == Extension)
+				{
+					files.emplace_back(
+					    entry.last_write_time(error),
+					    entry.path());
+				}
+			}
+			std::sort(files.begin(), files.end());
+			for (const auto& [time, path] : files)
+			{
+				std::ifstream file(path, std::ios::binary);
+				const std::vector<uint8_t> data(
+				    (std::istreambuf_iterator<char>(file)),
+				    std::istreambuf_iterator<char>());
+				if (!upload(data))
+				{
+					return;
+				}
+				std::filesystem::remove(path, error);
+			}
+		}
+
+		void Run()
+		{
+			SetThreadClass(ThreadClass::Background);
+			Profiler::SetThreadName("Telemetry");
+			std::unique_lock lock(mutex);
+			for (;;)
+			{
+				wake.wait_for(lock, RetryInterval, [] {
+					return stopping || !pending.empty();
+				});
+				auto reports = std::move(pending);
+				pending.clear();
+				const auto upload = uploader;
+				const auto done = stopping;
+				lock.unlock();
+
+				for (const auto& report : reports)
+				{
+					Spool(report);
+				}
+				if (upload)
+				{
+					UploadSpooled(upload);
+				}
+
+				lock.lock();
+				if (done && pending.empty())
+				{
+					return;
+				}
+			}
+		}
+	} // namespace
+
+	void Start(const std::string& spoolDirectory,
+	           std::string build, std::string section)
+	{
+		if (running)
+		{
+			return;
+		}
+		std::error_code error;
+		std::filesystem::create_directories(spoolDirectory,
+		                                    error);
+		spool = spoolDirectory;
+		session = MakeSessionId();
+		buildName = std::move(build);
+		StartSection(std::move(section));
+		{
+			std::lock_guard lock(mutex);
+			stopping = false;
+		}
+		thread = std::thread(Run);
+		running = true;
+		VEGAM_INFO("Telemetry session {}, spooled to {}",
+		           session, spoolDirectory);
+	}
+
+	void Stop()
+	{
+		if (!running)
+		{
+			return;
+		}
+		SubmitSection();
+		{
+			std::lock_guard lock(mutex);
+			stopping = true;
+			wake.notify_one();
+		}
+		thread.join();
+		running = false;
+	}
+
+	bool IsRunning() { return running; }
+
+	void SetUploader(Uploader upload)
+	{
+		std::lock_guard lock(mutex);
+		uploader = std::move(upload);
+		wake.notify_one();
+	}
+
+	void BeginSection(std::string name)
+	{
+		if (!running)
+		{
+			return;
+		}
+		SubmitSection();
+		StartSection(std::move(name));
+	}
+
+	void EndFrame()
+	{
+		if (!running)
+		{
+			return;
+		}
+		const auto now = Clock::now();
+		if (!hasLastFrame)
+		{
+			lastFrame = now;
+			hasLastFrame = true;
+			return;
+		}
+		const auto elapsed = now - lastFrame;
+		lastFrame = now;
+		const auto microseconds =
+		    std::chrono::duration_cast<
+		        std::chrono::microseconds>(elapsed)
+		        .count();
+		current.cpu.Record(static_cast<uint64_t>(microseconds));
+		const auto gpuMs = Graphics::GpuProfiler::GetFrameMs();
+		if (gpuMs > 0.0f)
+		{
+			current.gpu.Record(
+			    static_cast<uint64_t>(gpuMs * 1000.0f));
+		}
+
+		const auto ms = static_cast<float>(microseconds) / 1000.0f;
+		if (current.frames >= MedianInterval
+		    && ms > HitchMultiple * medianMs
+		    && ms > HitchMinimumMs)
+		{
+			++current.hitches;
+		}
+		if (++current.frames % MedianInterval == 0)
+		{
+			medianMs =
+			    static_cast<float>(current.cpu.GetPercentile(50))
+			    / 1000.0f;
+		}
+
+		uint64_t cpu = 0;
+		uint64_t gpu = 0;
+		for (uint8_t i = 0;
+		     i < static_cast<uint8_t>(Memory::Tag::Count); ++i)
+		{
+			const auto tag = static_cast<Memory::Tag>(i);
+			cpu += Memory::GetStats(tag).live;
+			gpu += Memory::GetGpuStats(tag).live;
+		}
+		current.cpuPeak = std::max(current.cpuPeak, cpu);
+		current.gpuPeak = std::max(current.gpuPeak, gpu);
+	}
+} // namespace AthiVegam::Core::Telemetry
@@ -0,0 +1,101 @@
+#include "AthiVegam/Core/Time.h"
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+
+namespace AthiVegam::Core
+{
+	namespace
+	{
+		// A hitch, e.g. a breakpoint or loading, feeds the
+		// smoothed delta no more than this.
+		constexpr float MaxSmoothedSeconds = 0.25f;
+
+		inline size_t Index(TimeDomain domain)
+		{
+			VEGAM_ASSERT(domain < TimeDomain::Count,
+			             "Invalid time domain");
+			return static_cast<size_t>(domain);
+		}
+	} // namespace
+
+	Time::Time()
+	{
+		m_scales.fill(1.0f);
+		m_previous = Now();
+		m_snapshot.now = m_previous;
+	}
+
+	uint64_t Time::Now()
+	{
+		return std::chrono::duration_cast<
+		           std::chrono::nanoseconds>(
+		           Clock::now().time_since_epoch())
+		    .count();
+	}
+
+	double Time::Seconds(uint64_t from, uint64_t to)
+	{
+		return static_cast<double>(to - from) * 1e-9;
+	}
+
+	const TimeSnapshot& Time::BeginFrame()
+	{
+		const auto now = Now();
+		const auto real = Seconds(m_previous, now);
+		m_previous = now;
+
+		const auto clamped =
+		    std::min(static_cast<float>(real), MaxSmoothedSeconds);
+		m_smoothedReal =
+		    m_snapshot.frame == 0
+		        ? clamped
+		        : m_smoothedReal
+		              + (clamped - m_smoothedReal) * m_smoothing;
+
+		auto& snapshot = m_snapshot;
+		snapshot.now = now;
+		++snapshot.frame;
+		for (size_t i = 0; i < TimeSnapshot::DomainCount; ++i)
+		{
+			const auto scale = m_paused[i] ? 0.0f : m_scales[i];
+			snapshot.delta[i] = static_cast<float>(real) * scale;
+			snapshot.smoothedDelta[i] = m_smoothedReal * scale;
+			snapshot.time[i] += real * scale;
+		}
+		return snapshot;
+	}
+
+	void Time::Resync() { m_previous = Now(); }
+
+	void Time::SetScale(TimeDomain domain, float scale)
+	{
+		VEGAM_ASSERT(domain != TimeDomain::Real,
+		             "Real time is not scaled");
+		VEGAM_ASSERT(scale >= 0.0f, "Time runs forwards");
+		m_scales[Index(domain)] = scale;
+	}
+
+	float Time::GetScale(TimeDomain domain) const
+	{
+		return m_scales[Index(domain)];
+	}
+
+	void Time::SetPaused(TimeDomain domain, bool paused)
+	{
+		VEGAM_ASSERT(domain != TimeDomain::Real,
+		             "Real time is not paused");
+		m_paused[Index(domain)] = paused;
+	}
+
+	bool Time::IsPaused(TimeDomain domain) const
+	{
+		return m_paused[Index(domain)];
+	}
+
+	void Time::SetSmoothing(float weight)
+	{
+		m_smoothing = std::clamp(weight, 0.01f, 1.0f);
+	}
+} // namespace AthiVegam::Core
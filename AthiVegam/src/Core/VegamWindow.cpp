@@ -1,20 +1,106 @@
 #include "AthiVegam/Core/VegamWindow.h"
 
+#include "AthiVegam/Core/Events.h"
+#include "AthiVegam/Core/Profiler.h"
 #include "AthiVegam/Engine.h"
+#include "AthiVegam/Graphics/GpuFence.h"
+#include "AthiVegam/Graphics/GLCallCounter.h"
+#include "AthiVegam/Graphics/GpuProfiler.h"
 #include "AthiVegam/Graphics/Helpers.h"
-#include "AthiVegam/Input/Controller.h"
-#include "AthiVegam/Input/Keyboard.h"
-#include "AthiVegam/Input/Mouse.h"
 #include "AthiVegam/Log.h"
 #include "SDL2/SDL.h"
 #include "external/imgui/imgui.h"
 #include "glad/glad.h"
 
+#include <algorithm>
+
 namespace AthiVegam::Core
 {
+	namespace
+	{
+		uint32_t GetWindowFlags(const WindowDesc& desc)
+		{
+			uint32_t flags = SDL_WINDOW_OPENGL;
+			if (desc.resizable)
+			{
+				flags |= SDL_WINDOW_RESIZABLE;
+			}
+			if (desc.hidden)
+			{
+				flags |= SDL_WINDOW_HIDDEN;
+			}
+			if (desc.highDpi)
+			{
+				flags |= SDL_WINDOW_ALLOW_HIGHDPI;
+			}
+			switch (desc.mode)
+			{
+			case WindowMode::Borderless:
+				flags |= SDL_WINDOW_FULLSCREEN_DESKTOP;
+				break;
+			case WindowMode::Fullscreen:
+				flags |= SDL_WINDOW_FULLSCREEN;
+				break;
+			default:
+				break;
+			}
+			return flags;
+		}
+
+		// Binds the default framebuffer of the window the
+		// context is current on, with a viewport covering
+		// its drawable.
+		void BindWindowFramebuffer(int w, int h)
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			VEGAM_CHECK_GL_ERROR;
+			glViewport(0, 0, w, h);
+			VEGAM_CHECK_GL_ERROR;
+		}
+
+		void BindWindowFramebuffer(SDL_Window* window)
+		{
+			int w = 0;
+			int h = 0;
+			SDL_GL_GetDrawableSize(window, &w, &h);
+			BindWindowFramebuffer(w, h);
+		}
+
+		inline uint64_t PackSize(int w, int h)
+		{
+			return static_cast<uint64_t>(
+			           static_cast<uint32_t>(w))
+			           << 32
+			       | static_cast<uint32_t>(h);
+		}
+
+		inline void UnpackSize(uint64_t size, int& w, int& h)
+		{
+			w = static_cast<int>(size >> 32);
+			h = static_cast<int>(size & 0xffffffffu);
+		}
+
+		inline int64_t Now()
+		{
+			return std::chrono::steady_clock::now()
+			    .time_since_epoch()
+			    .count();
+		}
+	} // namespace
+
 	VegamWindow::VegamWindow()
 	    : m_sdlWindow(nullptr), m_glContext(nullptr)
 	{
+		m_readback.SetCallback([this](const uint8_t* pixels,
+		                              int width, int height,
+		                              uint64_t frame) {
+			m_screenCapture.Deliver(pixels, width, height,
+			                        frame);
+			if (m_frameCallback)
+			{
+				m_frameCallback(pixels, width, height, frame);
+			}
+		});
 	}
 
 	VegamWindow::~VegamWindow()
@@ -25,12 +111,31 @@ namespace AthiVegam::Core
 		}
 	}
 
-	bool VegamWindow::Create()
+	bool VegamWindow::Create(const EngineConfig& config)
 	{
+		const auto& desc = config.window;
+		auto contextDesc = desc;
+		if ((config.gpuCulling || config.hdr
+		     || config.temporalUpscaling)
+		    && contextDesc.glMajorVersion * 10
+		               + contextDesc.glMinorVersion
+		           < 43)
+		{
+			// Compute shaders and storage buffers.
+			contextDesc.glMajorVersion = 4;
+			contextDesc.glMinorVersion = 3;
+		}
+		SetContextAttributes(contextDesc);
+
+		auto flags = GetWindowFlags(desc);
+		if (config.headless)
+		{
+			flags |= SDL_WINDOW_HIDDEN;
+		}
 		m_sdlWindow = SDL_CreateWindow(
-		    "AthiVegamGame", SDL_WINDOWPOS_CENTERED,
-		    SDL_WINDOWPOS_CENTERED, 800, 600,
-		    SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+		    desc.title.c_str(), SDL_WINDOWPOS_CENTERED,
+		    SDL_WINDOWPOS_CENTERED, desc.width, desc.height,
+		    flags);
 		if (!m_sdlWindow)
 		{
 			VEGAM_ERROR("Error creating window: {}",
@@ -38,26 +143,15 @@ namespace AthiVegam::Core
 			return false;
 		}
 
-		VEGAM_INFO("OpenGl Context Created!");
-
-#ifdef AV_PLATFORM_MAC
-		SDL_GL_SetAttribute(
-		    SDL_GL_CONTEXT_FLAGS,
-		    SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
-#endif // AV_PLATFORM_MAC
-
-		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK,
-		                    SDL_GL_CONTEXT_PROFILE_CORE);
-		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION,
-		                    4);
-		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION,
-		                    1);
-		SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
-
-		SDL_SetWindowSize(m_sdlWindow, 800, 600);
-
 		m_glContext = SDL_GL_CreateContext(m_sdlWindow);
-
+		if (!m_glContext && desc.noErrorContext)
+		{
+			// Drivers without KHR_no_error reject the flag.
+			VEGAM_WARN("No-error GL context unavailable: {}",
+			           SDL_GetError());
+			SDL_GL_SetAttribute(SDL_GL_CONTEXT_NO_ERROR, 0);
+			m_glContext = SDL_GL_CreateContext(m_sdlWindow);
+		}
 		if (!m_glContext)
 		{
 			VEGAM_ERROR("Error creating OpelGl context: {}",
@@ -65,15 +159,194 @@ namespace AthiVegam::Core
 			return false;
 		}
 
+		VEGAM_INFO("OpenGl Context Created!");
+		UpdateSize();
+		GetDrawableSize(m_targetWidth, m_targetHeight);
+
 		gladLoadGLLoader(SDL_GL_GetProcAddress);
+		if (desc.countGLCalls)
+		{
+			Graphics::GLCallCounter::Install();
+		}
+		VEGAM_INFO("Requested GL {}.{}, got {}.{}",
+		           contextDesc.glMajorVersion,
+		           contextDesc.glMinorVersion,
+		           GLVersion.major, GLVersion.minor);
+
+		int noError = 0;
+		SDL_GL_GetAttribute(SDL_GL_CONTEXT_NO_ERROR, &noError);
+		if (noError)
+		{
+			VEGAM_INFO("GL errors are not checked (no-error "
+			           "context)");
+		}
+
+#ifndef AV_CONFIG_RELEASE
+		if (desc.debugContext && !noError)
+		{
+			// Debug builds check every call anyway, so their
+			// output may as well point at the failing call.
+#ifdef AV_CONFIG_DEBUG
+			m_debugOutput = Graphics::EnableDebugOutput(true);
+#else
+			m_debugOutput = Graphics::EnableDebugOutput(false);
+#endif // AV_CONFIG_DEBUG
+			if (!m_debugOutput)
+			{
+				VEGAM_WARN(
+				    "GL debug output needs a 4.3+ context");
+			}
+		}
+#endif // AV_CONFIG_RELEASE
+
+		m_srgb = desc.srgb;
+		if (desc.srgb)
+		{
+			glEnable(GL_FRAMEBUFFER_SRGB);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		if (desc.msaaSamples > 0)
+		{
+			glEnable(GL_MULTISAMPLE);
+			VEGAM_CHECK_GL_ERROR;
+		}
+
+		if (config.headless)
+		{
+			// Nothing is shown, so there is no swap to
+			// wait on either.
+			if (!m_offscreen.Create(desc.width, desc.height))
+			{
+				return false;
+			}
+			m_headless = true;
+			VEGAM_INFO("Headless: rendering offscreen at {}x{}",
+			           desc.width, desc.height);
+		}
+		else
+		{
+			SetSwapInterval(desc.vsync);
+		}
+		const auto dynamicResolution =
+		    config.dynamicResolutionMs > 0.0f;
+		if (config.temporalUpscaling)
+		{
+			m_upscalingScale = std::clamp(config.upscalingScale,
+			                              0.25f, 1.0f);
+			m_temporalUpscaler.emplace(
+			    dynamicResolution ? config.minResolutionScale
+			                      : m_upscalingScale);
+			if (!m_temporalUpscaler->Initialize())
+			{
+				m_temporalUpscaler.reset();
+			}
+		}
+		if (config.hdr)
+		{
+			m_hdrPipeline.emplace();
+			if (!m_hdrPipeline->Initialize())
+			{
+				m_hdrPipeline.reset();
+			}
+			else if (dynamicResolution && !m_temporalUpscaler)
+			{
+				VEGAM_WARN("Dynamic resolution needs temporal "
+				           "upscaling with HDR rendering");
+			}
+		}
+		if (dynamicResolution
+		    && (m_temporalUpscaler || !m_hdrPipeline))
+		{
+			Graphics::DynamicResolution::Settings settings;
+			settings.targetMs = config.dynamicResolutionMs;
+			settings.minScale = config.minResolutionScale;
+			settings.externalTarget =
+			    m_temporalUpscaler.has_value();
+			m_dynamicResolution.emplace(settings);
+		}
+		m_performanceHud.SetVisible(config.showPerformanceHud);
+		Engine::Instance().GetRenderManager().SetViewportBinder(
+		    [this](uint32_t viewport) { BindViewport(viewport); });
 
-		m_imguiWindow.Create();
+		if (config.imgui)
+		{
+			m_imguiWindow.Create(
+			    std::chrono::milliseconds(config.uiRefreshMs));
+			m_uiEnabled = true;
+		}
 
 		return true;
 	}
 
+	void VegamWindow::SetContextAttributes(
+	    const WindowDesc& desc)
+	{
+		int contextFlags = 0;
+#ifdef AV_PLATFORM_MAC
+		contextFlags |= SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG;
+#endif // AV_PLATFORM_MAC
+		// A no-error context may not also be a debug one.
+		if (desc.debugContext && !desc.noErrorContext)
+		{
+			contextFlags |= SDL_GL_CONTEXT_DEBUG_FLAG;
+		}
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, contextFlags);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_NO_ERROR,
+		                    desc.noErrorContext ? 1 : 0);
+
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK,
+		                    SDL_GL_CONTEXT_PROFILE_CORE);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION,
+		                    desc.glMajorVersion);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION,
+		                    desc.glMinorVersion);
+		SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+
+		SDL_GL_SetAttribute(SDL_GL_FRAMEBUFFER_SRGB_CAPABLE,
+		                    desc.srgb ? 1 : 0);
+		SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS,
+		                    desc.msaaSamples > 0 ? 1 : 0);
+		SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES,
+		                    desc.msaaSamples);
+	}
+
 	void VegamWindow::Shutdown()
 	{
+		{
+			std::lock_guard lock(m_viewportsMutex);
+			for (auto*& window : m_viewports)
+			{
+				if (window)
+				{
+					m_retiredViewports.push_back(window);
+					window = nullptr;
+				}
+			}
+		}
+		DestroyRetiredViewports();
+		if (m_glContext)
+		{
+			m_imguiWindow.Shutdown();
+			m_readback.Destroy();
+			m_screenCapture.Shutdown();
+			if (m_dynamicResolution)
+			{
+				m_dynamicResolution->Shutdown();
+				m_dynamicResolution.reset();
+			}
+			if (m_hdrPipeline)
+			{
+				m_hdrPipeline->Shutdown();
+				m_hdrPipeline.reset();
+			}
+			if (m_temporalUpscaler)
+			{
+				m_temporalUpscaler->Shutdown();
+				m_temporalUpscaler.reset();
+			}
+			m_offscreen.Destroy();
+			m_headless = false;
+		}
 		SDL_DestroyWindow(m_sdlWindow);
 		SDL_GL_DeleteContext(m_glContext);
 		m_sdlWindow = nullptr;
@@ -81,21 +354,38 @@ namespace AthiVegam::Core
 
 	void VegamWindow::PumpEvents()
 	{
+		VEGAM_PROFILE_SCOPE("VegamWindow::PumpEvents");
+		// Only translates; the engine delivers the events
+		// once every one is in.
+		auto& events = Engine::Instance().GetEventBus();
 		SDL_Event e;
 		while (SDL_PollEvent(&e))
 		{
 			switch (e.type)
 			{
 			case SDL_QUIT:
-				Engine::Instance().Quit();
+				events.Publish(QuitRequested{});
+				break;
+			case SDL_WINDOWEVENT:
+				OnWindowEvent(e.window, events);
+				break;
+			case SDL_MOUSEMOTION:
+				events.Publish(
+				    MouseMoved{static_cast<float>(e.motion.xrel),
+				               static_cast<float>(e.motion.yrel)});
+				break;
+			case SDL_MOUSEWHEEL:
+				events.Publish(MouseWheel{e.wheel.preciseX,
+				                          e.wheel.preciseY});
 				break;
 			case SDL_CONTROLLERDEVICEADDED:
-				Input::Controller::OnControllerConnected(
-				    e.cdevice);
+				events.Publish(
+				    ControllerConnected{e.cdevice.which});
 				break;
 			case SDL_CONTROLLERDEVICEREMOVED:
-				Input::Controller::OnControllerDisconnected(
-				    e.cdevice);
+				// Removal events carry the instance id.
+				events.Publish(
+				    ControllerDisconnected{e.cdevice.which});
 				break;
 			default:
 				break;
@@ -103,28 +393,542 @@ namespace AthiVegam::Core
 
 			m_imguiWindow.HandleSDLEvent(e);
 		}
+	}
+
+	bool VegamWindow::WaitForEvent(int timeoutMs)
+	{
+		// A null event leaves it queued for PumpEvents().
+		return SDL_WaitEventTimeout(nullptr, timeoutMs) == 1;
+	}
+
+	void VegamWindow::OnWindowEvent(
+	    const SDL_WindowEvent& event, EventBus& events)
+	{
+		switch (event.event)
+		{
+		case SDL_WINDOWEVENT_FOCUS_GAINED:
+		case SDL_WINDOWEVENT_FOCUS_LOST:
+			// From any of the app's windows, so focus moving
+			// to an ImGui viewport ends gained.
+			m_hasFocus =
+			    event.event == SDL_WINDOWEVENT_FOCUS_GAINED;
+			events.Publish(WindowFocusChanged{m_hasFocus});
+			break;
+		case SDL_WINDOWEVENT_SIZE_CHANGED:
+		{
+			// Secondary viewports query their own size.
+			if (event.windowID != SDL_GetWindowID(m_sdlWindow))
+			{
+				break;
+			}
+			UpdateSize();
+			WindowResized resized;
+			GetSize(resized.width, resized.height);
+			GetDrawableSize(resized.drawableWidth,
+			                resized.drawableHeight);
+			events.Publish(resized);
+			break;
+		}
+		case SDL_WINDOWEVENT_MINIMIZED:
+			m_minimized = true;
+			events.Publish(WindowMinimized{true});
+			break;
+		case SDL_WINDOWEVENT_RESTORED:
+		case SDL_WINDOWEVENT_MAXIMIZED:
+			if (m_minimized)
+			{
+				m_minimized = false;
+				events.Publish(WindowMinimized{false});
+			}
+			break;
+		default:
+			break;
+		}
+	}
 
-		// Update Input
-		Input::Mouse::Update();
-		Input::Keyboard::Update();
-		Input::Controller::Update();
+	void VegamWindow::SetSwapInterval(VSync vsync)
+	{
+		int interval = vsync == VSync::Off ? 0 : 1;
+		if (vsync == VSync::Adaptive
+		    && SDL_GL_SetSwapInterval(-1) == 0)
+		{
+			interval = -1;
+		}
+		else if (SDL_GL_SetSwapInterval(interval))
+		{
+			VEGAM_WARN("Error setting swap interval {}: {}",
+			           interval, SDL_GetError());
+			return;
+		}
+		VEGAM_INFO("Swap interval {}", interval);
 	}
 
-	void VegamWindow::GetSize(int& w, int& h)
+	void VegamWindow::UpdateSize()
 	{
+		int w = 0;
+		int h = 0;
 		SDL_GetWindowSize(m_sdlWindow, &w, &h);
+		m_size.store(PackSize(w, h), std::memory_order_relaxed);
+		SDL_GL_GetDrawableSize(m_sdlWindow, &w, &h);
+		m_drawableSize.store(PackSize(w, h),
+		                     std::memory_order_relaxed);
+		m_resizeTime.store(Now(), std::memory_order_relaxed);
+	}
+
+	void VegamWindow::GetSize(int& w, int& h) const
+	{
+		UnpackSize(m_size.load(std::memory_order_relaxed), w,
+		           h);
+	}
+
+	void VegamWindow::GetDrawableSize(int& w, int& h) const
+	{
+		UnpackSize(
+		    m_drawableSize.load(std::memory_order_relaxed), w,
+		    h);
 	}
 
 	void VegamWindow::BeginRender()
 	{
-		Engine::Instance().GetRenderManager().Clear();
+		VEGAM_PROFILE_SCOPE("VegamWindow::BeginRender");
+		Graphics::GpuProfiler::BeginFrame();
+		auto& engine = Engine::Instance();
+		engine.GetLoaderThread().Update();
+		Graphics::GpuFence::Poll();
+		engine.GetResourceManager().ProcessUploads(
+		    engine.GetConfig().meshUploadBudgetMs);
+		BindRenderTarget();
+		engine.GetRenderManager().Clear();
+		if (m_upscaledScene)
+		{
+			m_temporalUpscaler->ClearMotion();
+		}
 	}
 
-	void VegamWindow::EndRender()
+	void VegamWindow::BindRenderTarget()
+	{
+		auto& frameGraph =
+		    Engine::Instance().GetRenderManager().GetFrameGraph();
+		int w = m_offscreen.GetWidth();
+		int h = m_offscreen.GetHeight();
+		if (!m_headless)
+		{
+			GetDrawableSize(w, h);
+			const std::chrono::steady_clock::duration
+			    sinceResize(Now()
+			                - m_resizeTime.load(
+			                    std::memory_order_relaxed));
+			if ((w != m_targetWidth || h != m_targetHeight)
+			    && w > 0 && h > 0
+			    && sinceResize >= ResizeDebounce)
+			{
+				ApplyResize(w, h);
+			}
+		}
+		m_hdrScene = m_hdrPipeline
+		             && m_hdrPipeline->BeginFrame(w, h);
+		m_upscaledScene = m_temporalUpscaler
+		                  && BeginUpscaledScene(w, h);
+		if (m_upscaledScene)
+		{
+			frameGraph.SetBackbuffer(
+			    m_temporalUpscaler->GetFramebuffer(),
+			    m_temporalUpscaler->GetRenderWidth(),
+			    m_temporalUpscaler->GetRenderHeight());
+			return;
+		}
+		if (m_hdrScene)
+		{
+			frameGraph.SetBackbuffer(
+			    m_hdrPipeline->GetFramebuffer(), w, h);
+			return;
+		}
+		// Without the upscaler's target there is nothing to
+		// scale into.
+		m_scaledScene = m_dynamicResolution
+		                && !m_temporalUpscaler
+		                && m_dynamicResolution->BeginFrame(w, h);
+		if (m_scaledScene)
+		{
+			frameGraph.SetBackbuffer(
+			    m_dynamicResolution->GetFramebuffer(),
+			    m_dynamicResolution->GetRenderWidth(),
+			    m_dynamicResolution->GetRenderHeight());
+			return;
+		}
+		if (m_headless)
+		{
+			m_offscreen.Bind();
+			frameGraph.SetBackbuffer(m_offscreen.GetId(), w, h);
+			return;
+		}
+		BindWindowFramebuffer(w, h);
+		frameGraph.SetBackbuffer(0, w, h);
+	}
+
+	bool VegamWindow::BeginUpscaledScene(int w, int h)
+	{
+		// Dynamic resolution only picks the render size
+		// then; the upscaler's target takes the scene.
+		m_scaledScene = m_dynamicResolution
+		                && m_dynamicResolution->BeginFrame(w, h);
+		const auto began =
+		    m_scaledScene
+		        ? m_temporalUpscaler->BeginFrame(
+		              w, h,
+		              m_dynamicResolution->GetRenderWidth(),
+		              m_dynamicResolution->GetRenderHeight())
+		        : m_temporalUpscaler->BeginFrame(
+		              w, h,
+		              static_cast<int>(static_cast<float>(w)
+		                               * m_upscalingScale),
+		              static_cast<int>(static_cast<float>(h)
+		                               * m_upscalingScale));
+		if (!began && m_scaledScene)
+		{
+			m_scaledScene = false;
+			m_dynamicResolution->EndFrame();
+		}
+		return began;
+	}
+
+	void VegamWindow::ApplyResize(int w, int h)
+	{
+		VEGAM_PROFILE_SCOPE("VegamWindow::ApplyResize");
+		m_targetWidth = w;
+		m_targetHeight = h;
+		if (m_dynamicResolution)
+		{
+			m_dynamicResolution->Resize(w, h);
+		}
+		if (m_resizeCallback)
+		{
+			m_resizeCallback(w, h);
+		}
+	}
+
+	void VegamWindow::ResolveRenderTarget()
+	{
+		const auto display =
+		    m_headless ? m_offscreen.GetId() : 0;
+		if (m_upscaledScene)
+		{
+			m_upscaledScene = false;
+			if (m_scaledScene)
+			{
+				m_scaledScene = false;
+				m_dynamicResolution->EndFrame();
+			}
+			m_temporalUpscaler->Resolve(
+			    m_hdrScene ? m_hdrPipeline->GetFramebuffer()
+			               : display);
+		}
+		if (m_hdrScene)
+		{
+			m_hdrScene = false;
+			m_hdrPipeline->Resolve(display, m_srgb);
+			return;
+		}
+		if (!m_scaledScene)
+		{
+			return;
+		}
+		m_scaledScene = false;
+		m_dynamicResolution->Resolve(display);
+	}
+
+	uint32_t VegamWindow::CreateViewport(const WindowDesc& desc)
+	{
+		if (m_headless)
+		{
+			VEGAM_WARN("Viewports are not available headless");
+			return 0;
+		}
+
+		std::lock_guard lock(m_viewportsMutex);
+		for (uint32_t i = 1; i < MaxViewports; ++i)
+		{
+			if (m_viewports[i])
+			{
+				continue;
+			}
+			// The context attributes set in Create() still
+			// apply, so the pixel formats match and the main
+			// context can draw into the new window.
+			m_viewports[i] = SDL_CreateWindow(
+			    desc.title.c_str(), SDL_WINDOWPOS_CENTERED,
+			    SDL_WINDOWPOS_CENTERED, desc.width,
+			    desc.height, GetWindowFlags(desc));
+			if (!m_viewports[i])
+			{
+				VEGAM_ERROR("Error creating viewport: {}",
+				            SDL_GetError());
+				return 0;
+			}
+			return i;
+		}
+
+		VEGAM_ERROR("Out of viewports ({} at most)",
+		            MaxViewports - 1);
+		return 0;
+	}
+
+	void VegamWindow::DestroyViewport(uint32_t viewport)
+	{
+		if (viewport == 0 || viewport >= MaxViewports)
+		{
+			return;
+		}
+		{
+			std::lock_guard lock(m_viewportsMutex);
+			if (!m_viewports[viewport])
+			{
+				return;
+			}
+			m_retiredViewports.push_back(m_viewports[viewport]);
+			m_viewports[viewport] = nullptr;
+		}
+
+		// The render thread may still be drawing into it;
+		// SwapFrames() destroys it once that thread idles.
+		if (!Engine::Instance()
+		         .GetRenderManager()
+		         .IsRenderThreadEnabled())
+		{
+			DestroyRetiredViewports();
+		}
+	}
+
+	void VegamWindow::DestroyRetiredViewports()
+	{
+		std::lock_guard lock(m_viewportsMutex);
+		for (auto* window : m_retiredViewports)
+		{
+			SDL_DestroyWindow(window);
+		}
+		m_retiredViewports.clear();
+	}
+
+	SDL_Window* VegamWindow::GetViewportWindow(uint32_t viewport)
+	{
+		std::lock_guard lock(m_viewportsMutex);
+		return viewport < MaxViewports ? m_viewports[viewport]
+		                               : nullptr;
+	}
+
+	void VegamWindow::BindViewport(uint32_t viewport)
+	{
+		std::lock_guard lock(m_viewportsMutex);
+		auto* window = viewport < MaxViewports
+		                   ? m_viewports[viewport]
+		                   : nullptr;
+		if (!window)
+		{
+			SDL_GL_MakeCurrent(m_sdlWindow, m_glContext);
+			if (m_upscaledScene)
+			{
+				m_temporalUpscaler->Bind();
+			}
+			else if (m_hdrScene)
+			{
+				m_hdrPipeline->Bind();
+			}
+			else if (m_scaledScene)
+			{
+				m_dynamicResolution->Bind();
+			}
+			else if (m_headless)
+			{
+				m_offscreen.Bind();
+			}
+			else
+			{
+				int w = 0;
+				int h = 0;
+				GetDrawableSize(w, h);
+				BindWindowFramebuffer(w, h);
+			}
+			return;
+		}
+
+		SDL_GL_MakeCurrent(window, m_glContext);
+		BindWindowFramebuffer(window);
+		if (!m_viewportsDrawn[viewport])
+		{
+			m_viewportsDrawn[viewport] = true;
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			VEGAM_CHECK_GL_ERROR;
+		}
+	}
+
+	void VegamWindow::Present()
 	{
-		m_imguiWindow.BeginRender();
-		ImGui::ShowDemoWindow();
-		m_imguiWindow.EndRender();
+		{
+			std::lock_guard lock(m_viewportsMutex);
+			bool swapped = false;
+			for (uint32_t i = 1; i < MaxViewports; ++i)
+			{
+				if (!m_viewportsDrawn[i])
+				{
+					continue;
+				}
+				m_viewportsDrawn[i] = false;
+				if (m_viewports[i])
+				{
+					SDL_GL_MakeCurrent(m_viewports[i],
+					                   m_glContext);
+					SDL_GL_SwapWindow(m_viewports[i]);
+					swapped = true;
+				}
+			}
+			if (swapped)
+			{
+				SDL_GL_MakeCurrent(m_sdlWindow, m_glContext);
+			}
+		}
+
+		// Read back before the swap, which may leave the
+		// back buffer undefined.
+		const auto screenCapture =
+		    m_screenCapture.Claim(m_presentedFrames);
+		if (m_frameCallback || screenCapture)
+		{
+			int w = m_offscreen.GetWidth();
+			int h = m_offscreen.GetHeight();
+			if (!m_headless)
+			{
+				GetDrawableSize(w, h);
+			}
+			m_readback.Capture(w, h, m_presentedFrames);
+		}
+		++m_presentedFrames;
+
+		if (m_headless)
+		{
+			m_readback.Poll();
+			glFlush();
+			VEGAM_CHECK_GL_ERROR;
+			return;
+		}
 		SDL_GL_SwapWindow(m_sdlWindow);
+		m_readback.Poll();
+	}
+
+	void VegamWindow::CheckFrameErrors()
+	{
+#ifdef AV_CONFIG_PROFILE
+		// Without debug output, one glGetError per frame
+		// still catches errors, if not where they happen.
+		if (!m_debugOutput)
+		{
+			Graphics::CheckOpenGLError();
+		}
+#endif // AV_CONFIG_PROFILE
+	}
+
+	void VegamWindow::EndRender()
+	{
+		VEGAM_PROFILE_SCOPE("VegamWindow::EndRender");
+		m_performanceHud.RecordFrame();
+		if (m_temporalUpscaler)
+		{
+			m_temporalUpscaler->EndRecording();
+		}
+		ResolveRenderTarget();
+		if (IsUiVisible())
+		{
+			if (m_imguiWindow.BeginRender())
+			{
+				DrawUi();
+			}
+			m_imguiWindow.EndRender();
+		}
+		else
+		{
+			m_imguiWindow.Skip();
+		}
+		Engine::Instance().GetRenderManager().EndFrame();
+		Graphics::GpuProfiler::EndFrame();
+		CheckFrameErrors();
+		Present();
+	}
+
+	void VegamWindow::EndRecording()
+	{
+		m_performanceHud.RecordFrame();
+		if (m_temporalUpscaler)
+		{
+			m_temporalUpscaler->EndRecording();
+		}
+		if (!IsUiVisible())
+		{
+			m_imguiWindow.Skip();
+			return;
+		}
+		if (m_imguiWindow.BeginRender())
+		{
+			DrawUi();
+		}
+		m_imguiWindow.CaptureRender();
+	}
+
+	bool VegamWindow::IsUiVisible() const
+	{
+		return m_imguiWindow.IsCreated() && m_uiEnabled
+		       && (m_performanceHud.IsVisible() || m_uiCallback);
+	}
+
+	void VegamWindow::DrawUi()
+	{
+		m_performanceHud.Draw();
+		if (m_uiCallback)
+		{
+			m_uiCallback();
+		}
+	}
+
+	void VegamWindow::SwapFrames()
+	{
+		DestroyRetiredViewports();
+		Engine::Instance().GetRenderManager().SwapFrames();
+		m_imguiWindow.SwapFrames();
+	}
+
+	void VegamWindow::RenderFrame()
+	{
+		VEGAM_PROFILE_SCOPE("VegamWindow::RenderFrame");
+		Graphics::GpuProfiler::BeginFrame();
+		auto& engine = Engine::Instance();
+		engine.GetLoaderThread().Update();
+		Graphics::GpuFence::Poll();
+		engine.GetResourceManager().ProcessUploads(
+		    engine.GetConfig().meshUploadBudgetMs);
+		auto& renderManager = engine.GetRenderManager();
+		BindRenderTarget();
+		renderManager.Clear();
+		if (m_upscaledScene)
+		{
+			m_temporalUpscaler->ClearMotion();
+		}
+		renderManager.ExecuteFrame();
+		ResolveRenderTarget();
+		m_imguiWindow.RenderCaptured();
+		Engine::Instance().GetRenderManager().EndFrame();
+		Graphics::GpuProfiler::EndFrame();
+		CheckFrameErrors();
+		Present();
+	}
+
+	bool VegamWindow::MakeContextCurrent(bool current)
+	{
+		if (SDL_GL_MakeCurrent(m_sdlWindow,
+		                       current ? m_glContext
+		                               : nullptr))
+		{
+			VEGAM_ERROR("Error making GL context current: {}",
+			            SDL_GetError());
+			return false;
+		}
+		return true;
 	}
 } // namespace AthiVegam::Core
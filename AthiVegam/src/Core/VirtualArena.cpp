@@ -0,0 +1,311 @@
+#include "AthiVegam/Core/VirtualArena.h"
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+
+#ifdef AV_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif // AV_PLATFORM_WINDOWS
+
+namespace AthiVegam::Core
+{
+	namespace
+	{
+		constexpr size_t HugePageSize = size_t(2) << 20;
+
+		inline size_t AlignUp(size_t value, size_t alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+
+#ifdef AV_PLATFORM_WINDOWS
+		std::byte* Map(size_t size, bool commit, bool large)
+		{
+			const DWORD type =
+			    MEM_RESERVE
+			    | (commit ? MEM_COMMIT : 0)
+			    | (large ? MEM_LARGE_PAGES : 0);
+			return static_cast<std::byte*>(VirtualAlloc(
+			    nullptr, size, type,
+			    commit ? PAGE_READWRITE : PAGE_NOACCESS));
+		}
+
+		void Unmap(std::byte* memory, size_t)
+		{
+			VirtualFree(memory, 0, MEM_RELEASE);
+		}
+
+		bool CommitPages(std::byte* memory, size_t size, bool)
+		{
+			return VirtualAlloc(memory, size, MEM_COMMIT,
+			                    PAGE_READWRITE)
+			       != nullptr;
+		}
+
+		void DecommitPages(std::byte* memory, size_t size)
+		{
+			VirtualFree(memory, size, MEM_DECOMMIT);
+		}
+#else
+		std::byte* Map(size_t size, bool, bool)
+		{
+			// Address space only: no access, no swap.
+			auto* memory =
+			    mmap(nullptr, size, PROT_NONE,
+			         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+			         -1, 0);
+			return memory == MAP_FAILED
+			           ? nullptr
+			           : static_cast<std::byte*>(memory);
+		}
+
+		void Unmap(std::byte* memory, size_t size)
+		{
+			munmap(memory, size);
+		}
+
+		// Maps pages over part of the reservation.
+		inline bool MapFixed(std::byte* memory, size_t size,
+		                     int flags)
+		{
+			return mmap(memory, size, PROT_READ | PROT_WRITE,
+			            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED
+			                | flags,
+			            -1, 0)
+			       != MAP_FAILED;
+		}
+
+		bool CommitPages(std::byte* memory, size_t size,
+		                 bool large)
+		{
+#ifdef MAP_HUGETLB
+			// Explicit huge pages, if the system set some
+			// aside.
+			if (large && MapFixed(memory, size, MAP_HUGETLB))
+			{
+				return true;
+			}
+#endif // MAP_HUGETLB
+			// Remapped rather than mprotect()ed: a failed
+			// fixed mapping may have unmapped the range.
+			if (!MapFixed(memory, size, 0))
+			{
+				return false;
+			}
+#ifdef MADV_HUGEPAGE
+			if (large)
+			{
+				madvise(memory, size, MADV_HUGEPAGE);
+			}
+#endif // MADV_HUGEPAGE
+			return true;
+		}
+
+		void DecommitPages(std::byte* memory, size_t size)
+		{
+			// A fresh reservation over the range drops its
+			// pages, huge ones included.
+			mmap(memory, size, PROT_NONE,
+			     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE
+			         | MAP_FIXED,
+			     -1, 0);
+		}
+#endif // AV_PLATFORM_WINDOWS
+	} // namespace
+
+	VirtualArena::~VirtualArena() { Shutdown(); }
+
+	bool VirtualArena::Initialize()
+	{
+		return Initialize(Settings{});
+	}
+
+	bool VirtualArena::Initialize(const Settings& settings)
+	{
+		VEGAM_ASSERT(!m_base, "Virtual arena is initialized");
+		const auto largePage = GetLargePageSize();
+		m_largePages = settings.largePages && largePage != 0;
+		const auto page =
+		    m_largePages ? largePage : GetPageSize();
+		m_step =
+		    AlignUp(std::max(settings.commitStep, page), page);
+		m_reserved =
+		    AlignUp(std::max(settings.reserve, m_step), m_step);
+		m_tag = settings.tag;
+
+#ifdef AV_PLATFORM_WINDOWS
+		if (m_largePages)
+		{
+			m_base = Map(m_reserved, true, true);
+			if (m_base)
+			{
+				m_mapping = m_base;
+				m_mappingSize = m_reserved;
+				m_committed.store(m_reserved,
+				                  std::memory_order_relaxed);
+				Memory::TrackCpu(
+				    m_tag, static_cast<int64_t>(m_reserved));
+				return true;
+			}
+			VEGAM_WARN("No large pages for a {} MB arena: {}",
+			           m_reserved >> 20, GetLastError());
+			m_largePages = false;
+		}
+#endif // AV_PLATFORM_WINDOWS
+
+		// Huge pages need their start aligned to their size.
+		const auto slack = m_largePages ? largePage : 0;
+		m_mappingSize = m_reserved + slack;
+		m_mapping = Map(m_mappingSize, false, false);
+		if (!m_mapping)
+		{
+			VEGAM_ERROR("Could not reserve {} MB of address "
+			            "space",
+			            m_mappingSize >> 20);
+			m_mappingSize = 0;
+			m_reserved = 0;
+			return false;
+		}
+		m_base = reinterpret_cast<std::byte*>(AlignUp(
+		    reinterpret_cast<uintptr_t>(m_mapping),
+		    std::max<size_t>(slack, 1)));
+		m_offset.store(0, std::memory_order_relaxed);
+		m_committed.store(0, std::memory_order_relaxed);
+		if (settings.commit > 0
+		    && !Commit(std::min(settings.commit, m_reserved)))
+		{
+			Shutdown();
+			return false;
+		}
+		return true;
+	}
+
+	void VirtualArena::Shutdown()
+	{
+		if (!m_mapping)
+		{
+			return;
+		}
+		Memory::TrackCpu(
+		    m_tag, -static_cast<int64_t>(m_committed.load(
+		               std::memory_order_relaxed)));
+		Unmap(m_mapping, m_mappingSize);
+		m_mapping = nullptr;
+		m_mappingSize = 0;
+		m_base = nullptr;
+		m_reserved = 0;
+		m_offset.store(0, std::memory_order_relaxed);
+		m_committed.store(0, std::memory_order_relaxed);
+	}
+
+	void* VirtualArena::Allocate(size_t size, size_t alignment)
+	{
+		VEGAM_ASSERT((alignment & (alignment - 1)) == 0,
+		             "Alignment must be a power of two");
+		const auto base = reinterpret_cast<uintptr_t>(m_base);
+		auto offset = m_offset.load(std::memory_order_relaxed);
+		size_t start;
+		size_t end;
+		do
+		{
+			start = AlignUp(base + offset, alignment) - base;
+			end = start + size;
+			if (end > m_reserved)
+			{
+				return nullptr;
+			}
+		} while (!m_offset.compare_exchange_weak(
+		    offset, end, std::memory_order_relaxed));
+
+		if (end > m_committed.load(std::memory_order_acquire)
+		    && !Commit(end))
+		{
+			return nullptr;
+		}
+		return m_base + start;
+	}
+
+	bool VirtualArena::Commit(size_t end)
+	{
+		std::lock_guard lock(m_commitMutex);
+		const auto committed =
+		    m_committed.load(std::memory_order_relaxed);
+		if (end <= committed)
+		{
+			return true;
+		}
+		const auto target =
+		    std::min(AlignUp(end, m_step), m_reserved);
+		if (!CommitPages(m_base + committed,
+		                 target - committed, m_largePages))
+		{
+			VEGAM_ERROR("Could not commit {} KB of a virtual "
+			            "arena",
+			            (target - committed) >> 10);
+			return false;
+		}
+		Memory::TrackCpu(
+		    m_tag, static_cast<int64_t>(target - committed));
+		m_committed.store(target, std::memory_order_release);
+		return true;
+	}
+
+	void VirtualArena::Reset()
+	{
+		m_offset.store(0, std::memory_order_relaxed);
+	}
+
+	void VirtualArena::Trim(size_t keep)
+	{
+#ifdef AV_PLATFORM_WINDOWS
+		if (m_largePages)
+		{
+			// Committed with the reservation, for good.
+			return;
+		}
+#endif // AV_PLATFORM_WINDOWS
+		std::lock_guard lock(m_commitMutex);
+		const auto committed =
+		    m_committed.load(std::memory_order_relaxed);
+		const auto kept =
+		    std::min(AlignUp(std::max(keep, GetUsed()), m_step),
+		             committed);
+		if (kept == committed)
+		{
+			return;
+		}
+		DecommitPages(m_base + kept, committed - kept);
+		Memory::TrackCpu(
+		    m_tag, -static_cast<int64_t>(committed - kept));
+		m_committed.store(kept, std::memory_order_relaxed);
+	}
+
+	size_t VirtualArena::GetPageSize()
+	{
+#ifdef AV_PLATFORM_WINDOWS
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		// Reservations go by the allocation granularity.
+		return info.dwAllocationGranularity;
+#else
+		return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif // AV_PLATFORM_WINDOWS
+	}
+
+	size_t VirtualArena::GetLargePageSize()
+	{
+#ifdef AV_PLATFORM_WINDOWS
+		return GetLargePageMinimum();
+#elif defined(MADV_HUGEPAGE) || defined(MAP_HUGETLB)
+		return HugePageSize;
+#else
+		return 0;
+#endif // AV_PLATFORM_WINDOWS
+	}
+} // namespace AthiVegam::Core
@@ -0,0 +1,376 @@
+#include "AthiVegam/Core/VirtualList.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "external/imgui/imgui.h"
+
+#include <cfloat>
+#include <cstring>
+#include <utility>
+
+namespace AthiVegam::Core
+{
+	namespace
+	{
+		// ASCII only, which leaves UTF-8 sequences intact.
+		inline char Lower(char c)
+		{
+			return c >= 'A' && c <= 'Z'
+			           ? static_cast<char>(c - 'A' + 'a')
+			           : c;
+		}
+	} // namespace
+
+	VirtualList::VirtualList(Managers::JobManager& jobs)
+	    : m_jobs(jobs)
+	{
+	}
+
+	VirtualList::~VirtualList() { m_jobs.Wait(m_counter); }
+
+	void VirtualList::SetItems(std::vector<Item> items)
+	{
+		m_pendingItems = std::move(items);
+		m_itemsChanged = true;
+		Schedule();
+	}
+
+	void VirtualList::SetFilter(std::string_view filter)
+	{
+		if (filter.data() != m_filterText.data())
+		{
+			const auto size =
+			    std::min(filter.size(), m_filterText.size() - 1);
+			std::memcpy(m_filterText.data(), filter.data(), size);
+			m_filterText[size] = '\0';
+		}
+		m_query.resize(filter.size());
+		for (size_t i = 0; i < filter.size(); ++i)
+		{
+			m_query[i] = Lower(filter[i]);
+		}
+		Schedule();
+	}
+
+	std::shared_ptr<const VirtualList::Index>
+	VirtualList::BuildIndex(std::vector<Item> items)
+	{
+		VEGAM_PROFILE_SCOPE("VirtualList::BuildIndex");
+		auto index = std::make_shared<Index>();
+		const auto count = static_cast<uint32_t>(items.size());
+		index->nameOffsets.reserve(count + 1);
+		index->firstChild.assign(count, NoItem);
+		index->nextSibling.assign(count, NoItem);
+		// The last child of each item, and the last root,
+		// to link them in item order.
+		std::vector<uint32_t> lastChild(count, NoItem);
+		uint32_t lastRoot = NoItem;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			index->nameOffsets.push_back(
+			    static_cast<uint32_t>(index->names.size()));
+			for (const auto c : items[i].name)
+			{
+				index->names.push_back(Lower(c));
+			}
+
+			// Parents that do not come first make roots.
+			auto& parent = items[i].parent;
+			if (parent >= i)
+			{
+				parent = NoItem;
+			}
+			auto& last =
+			    parent == NoItem ? lastRoot : lastChild[parent];
+			auto& first = parent == NoItem
+			                  ? index->firstRoot
+			                  : index->firstChild[parent];
+			if (last == NoItem)
+			{
+				first = i;
+			}
+			else
+			{
+				index->nextSibling[last] = i;
+			}
+			last = i;
+		}
+		index->nameOffsets.push_back(
+		    static_cast<uint32_t>(index->names.size()));
+		index->items = std::move(items);
+		return index;
+	}
+
+	std::shared_ptr<VirtualList::Result>
+	VirtualList::Filter(Request& request)
+	{
+		VEGAM_PROFILE_SCOPE("VirtualList::Filter");
+		auto result = std::make_shared<Result>();
+		result->index = request.index
+		                    ? std::move(request.index)
+		                    : BuildIndex(std::move(request.items));
+		result->query = std::move(request.query);
+		const auto& index = *result->index;
+
+		std::vector<std::string_view> terms;
+		const std::string_view query = result->query;
+		for (size_t start = 0; start < query.size();)
+		{
+			const auto end =
+			    std::min(query.find(' ', start), query.size());
+			if (end > start)
+			{
+				terms.push_back(query.substr(start, end - start));
+			}
+			start = end + 1;
+		}
+		if (terms.empty())
+		{
+			return result;
+		}
+
+		const auto matches = [&](uint32_t item) {
+			const std::string_view name(
+			    index.names.data() + index.nameOffsets[item],
+			    index.nameOffsets[item + 1]
+			        - index.nameOffsets[item]);
+			for (const auto term : terms)
+			{
+				if (name.find(term) == std::string_view::npos)
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+		const auto count =
+		    static_cast<uint32_t>(index.items.size());
+		if (request.base)
+		{
+			for (const auto item : request.base->matches)
+			{
+				if (matches(item))
+				{
+					result->matches.push_back(item);
+				}
+			}
+		}
+		else
+		{
+			for (uint32_t item = 0; item < count; ++item)
+			{
+				if (matches(item))
+				{
+					result->matches.push_back(item);
+				}
+			}
+		}
+
+		// Parents come first, so one backward pass marks
+		// every ancestor.
+		result->shown.assign(count, 0);
+		for (const auto item : result->matches)
+		{
+			result->shown[item] = 1;
+		}
+		for (auto item = count; item-- > 0;)
+		{
+			const auto parent = index.items[item].parent;
+			if (result->shown[item] && parent != NoItem)
+			{
+				result->shown[parent] = 1;
+			}
+		}
+		return result;
+	}
+
+	void VirtualList::Schedule()
+	{
+		if (m_inFlight
+		    || !(m_itemsChanged
+		         || (m_result && m_result->query != m_query)))
+		{
+			return;
+		}
+
+		auto request = std::make_shared<Request>();
+		if (m_itemsChanged)
+		{
+			request->items = std::move(m_pendingItems);
+			m_pendingItems.clear();
+			m_itemsChanged = false;
+		}
+		else
+		{
+			request->index = m_result->index;
+			// Typing on narrows the previous matches.
+			if (!m_result->shown.empty()
+			    && m_query.starts_with(m_result->query))
+			{
+				request->base = m_result;
+			}
+		}
+		request->query = m_query;
+
+		m_inFlight = true;
+		m_jobs.Schedule(
+		    [this, request] {
+			    auto result = Filter(*request);
+			    std::lock_guard lock(m_mutex);
+			    m_finished = std::move(result);
+		    },
+		    &m_counter);
+	}
+
+	void VirtualList::Poll()
+	{
+		std::shared_ptr<Result> finished;
+		{
+			std::lock_guard lock(m_mutex);
+			finished.swap(m_finished);
+		}
+		if (!finished)
+		{
+			return;
+		}
+		m_inFlight = false;
+		if (!m_result || m_result->index != finished->index)
+		{
+			m_expanded.assign(finished->index->items.size(), 0);
+			m_selected = NoItem;
+		}
+		m_result = std::move(finished);
+		m_rowsDirty = true;
+		Schedule();
+	}
+
+	void VirtualList::BuildRows()
+	{
+		VEGAM_PROFILE_SCOPE("VirtualList::BuildRows");
+		m_rowsDirty = false;
+		m_rows.clear();
+		if (!m_result)
+		{
+			return;
+		}
+		const auto& index = *m_result->index;
+		const auto& shown = m_result->shown;
+		const bool filtering = !shown.empty();
+
+		// Depth first, in item order: each entry is the
+		// next sibling to visit at its depth.
+		std::vector<Row> stack{{index.firstRoot, 0}};
+		while (!stack.empty())
+		{
+			const auto row = stack.back();
+			stack.pop_back();
+			if (row.item == NoItem)
+			{
+				continue;
+			}
+			stack.push_back(
+			    {index.nextSibling[row.item], row.depth});
+			if (filtering && !shown[row.item])
+			{
+				continue;
+			}
+			m_rows.push_back(row);
+			if (filtering || m_expanded[row.item])
+			{
+				stack.push_back(
+				    {index.firstChild[row.item], row.depth + 1});
+			}
+		}
+	}
+
+	bool VirtualList::Draw(const char* id, const RowCallback& row)
+	{
+		Poll();
+		if (m_rowsDirty)
+		{
+			BuildRows();
+		}
+
+		ImGui::PushID(id);
+		ImGui::SetNextItemWidth(-FLT_MIN);
+		if (ImGui::InputTextWithHint("##filter", "Filter",
+		                             m_filterText.data(),
+		                             m_filterText.size()))
+		{
+			SetFilter(m_filterText.data());
+		}
+
+		bool changed = false;
+		if (ImGui::BeginChild("##rows") && m_result)
+		{
+			const auto& index = *m_result->index;
+			const bool filtering = !m_result->shown.empty();
+			const auto indent = ImGui::GetStyle().IndentSpacing;
+			ImGuiListClipper clipper;
+			clipper.Begin(static_cast<int>(m_rows.size()));
+			while (clipper.Step())
+			{
+				for (auto r = clipper.DisplayStart;
+				     r < clipper.DisplayEnd; ++r)
+				{
+					const auto item = m_rows[r].item;
+					const bool parent =
+					    index.firstChild[item] != NoItem;
+					ImGuiTreeNodeFlags flags =
+					    ImGuiTreeNodeFlags_SpanAvailWidth
+					    | ImGuiTreeNodeFlags_NoTreePushOnOpen
+					    | ImGuiTreeNodeFlags_OpenOnArrow
+					    | ImGuiTreeNodeFlags_OpenOnDoubleClick;
+					if (!parent)
+					{
+						flags |= ImGuiTreeNodeFlags_Leaf;
+					}
+					if (item == m_selected)
+					{
+						flags |= ImGuiTreeNodeFlags_Selected;
+					}
+
+					ImGui::PushID(static_cast<int>(item));
+					ImGui::SetCursorPosX(
+					    ImGui::GetCursorPosX()
+					    + indent * m_rows[r].depth);
+					if (parent)
+					{
+						ImGui::SetNextItemOpen(
+						    filtering || m_expanded[item],
+						    ImGuiCond_Always);
+					}
+					const bool open = ImGui::TreeNodeEx(
+					    "##row", flags, "%s",
+					    index.items[item].name.c_str());
+					if (ImGui::IsItemClicked()
+					    && !ImGui::IsItemToggledOpen()
+					    && item != m_selected)
+					{
+						m_selected = item;
+						changed = true;
+					}
+					// Filtered trees stay expanded.
+					if (parent && !filtering
+					    && open != (m_expanded[item] != 0))
+					{
+						m_expanded[item] = open;
+						m_rowsDirty = true;
+					}
+					if (row)
+					{
+						row(item);
+					}
+					ImGui::PopID();
+				}
+			}
+		}
+		ImGui::EndChild();
+		ImGui::PopID();
+
+		if (m_rowsDirty)
+		{
+			BuildRows();
+		}
+		return changed;
+	}
+} // namespace AthiVegam::Core
@@ -0,0 +1,241 @@
+#include "AthiVegam/Ecs/Archetype.h"
+
+#include "AthiVegam/Core/Memory.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace AthiVegam::Ecs
+{
+	namespace
+	{
+		using namespace Core;
+
+		inline size_t AlignUp(size_t value, size_t alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+	} // namespace
+
+	Archetype::Archetype(const ComponentMask& mask)
+	    : m_mask(mask)
+	{
+		size_t rowSize = sizeof(Entity);
+		for (ComponentId id = 0; id < MaxComponents; ++id)
+		{
+			if (!mask.test(id))
+			{
+				continue;
+			}
+			const auto& info = GetComponentInfo(id);
+			VEGAM_ASSERT(info.alignment <= ChunkAlignment,
+			             "Component alignment exceeds chunk "
+			             "alignment");
+			m_columns[id] =
+			    static_cast<uint8_t>(m_components.size());
+			m_components.push_back(id);
+			m_trivial = m_trivial && info.trivial;
+			rowSize += info.size;
+		}
+
+		// As many rows as fit once every column is
+		// aligned.
+		m_offsets.resize(m_components.size());
+		for (m_capacity = static_cast<uint32_t>(
+		         ChunkSize / rowSize);
+		     m_capacity > 1; --m_capacity)
+		{
+			auto offset = sizeof(Entity) * m_capacity;
+			for (size_t i = 0; i < m_components.size(); ++i)
+			{
+				const auto& info =
+				    GetComponentInfo(m_components[i]);
+				offset = AlignUp(offset, info.alignment);
+				m_offsets[i] = static_cast<uint32_t>(offset);
+				offset += info.size * m_capacity;
+			}
+			if (offset <= ChunkSize)
+			{
+				break;
+			}
+		}
+		VEGAM_ASSERT(m_capacity > 0,
+		             "Components too large for a chunk");
+	}
+
+	Archetype::~Archetype()
+	{
+		Clear();
+	}
+
+	Archetype::Location Archetype::Allocate(Entity entity)
+	{
+		uint32_t count = 1;
+		const auto location = AllocateRun(count);
+		GetEntities(m_chunks[location.chunk])[location.row] =
+		    entity;
+		return location;
+	}
+
+	Archetype::Location Archetype::AllocateRun(uint32_t& count)
+	{
+		if (m_chunks.empty()
+		    || m_chunks.back().count == m_capacity)
+		{
+			m_chunks.push_back(
+			    {static_cast<std::byte*>(Memory::Allocate(
+			         ChunkSize, Memory::Tag::Scene,
+			         ChunkAlignment)),
+			     0});
+		}
+
+		auto& chunk = m_chunks.back();
+		count = std::min(count, m_capacity - chunk.count);
+		const Location location{
+		    static_cast<uint32_t>(m_chunks.size() - 1),
+		    chunk.count};
+		chunk.count += count;
+		m_count += count;
+		return location;
+	}
+
+	void Archetype::Construct(Location location)
+	{
+		for (const auto id : m_components)
+		{
+			GetComponentInfo(id).construct(Get(location, id));
+		}
+	}
+
+	Entity Archetype::Remove(Location location, bool destroy)
+	{
+		auto& chunk = m_chunks[location.chunk];
+		if (destroy)
+		{
+			Destroy(chunk, location.row);
+		}
+
+		auto& last = m_chunks.back();
+		const auto lastRow = last.count - 1;
+		Entity moved;
+		if (&last != &chunk || lastRow != location.row)
+		{
+			moved = GetEntities(last)[lastRow];
+			GetEntities(chunk)[location.row] = moved;
+			for (size_t i = 0; i < m_components.size(); ++i)
+			{
+				const auto& info =
+				    GetComponentInfo(m_components[i]);
+				auto* dst = chunk.data + m_offsets[i]
+				            + info.size * location.row;
+				auto* src = last.data + m_offsets[i]
+				            + info.size * lastRow;
+				if (info.trivial)
+				{
+					std::memcpy(dst, src, info.size);
+				}
+				else
+				{
+					info.relocate(dst, src);
+				}
+			}
+		}
+
+		--m_count;
+		if (--last.count == 0)
+		{
+			Memory::Free(last.data, ChunkSize,
+			             Memory::Tag::Scene, ChunkAlignment);
+			m_chunks.pop_back();
+		}
+		return moved;
+	}
+
+	void Archetype::Clear()
+	{
+		for (auto& chunk : m_chunks)
+		{
+			for (uint32_t row = 0; row < chunk.count; ++row)
+			{
+				Destroy(chunk, row);
+			}
+			Memory::Free(chunk.data, ChunkSize,
+			             Memory::Tag::Scene, ChunkAlignment);
+		}
+		m_chunks.clear();
+		m_count = 0;
+	}
+
+	void Archetype::Resize(uint32_t count)
+	{
+		VEGAM_ASSERT(m_trivial, "Resizing rows that need "
+		                        "constructing");
+		const size_t chunks =
+		    (count + m_capacity - 1) / m_capacity;
+		while (m_chunks.size() > chunks)
+		{
+			Memory::Free(m_chunks.back().data, ChunkSize,
+			             Memory::Tag::Scene, ChunkAlignment);
+			m_chunks.pop_back();
+		}
+		while (m_chunks.size() < chunks)
+		{
+			m_chunks.push_back(
+			    {static_cast<std::byte*>(Memory::Allocate(
+			         ChunkSize, Memory::Tag::Scene,
+			         ChunkAlignment)),
+			     0});
+		}
+		// All full but the last.
+		for (auto& chunk : m_chunks)
+		{
+			chunk.count = m_capacity;
+		}
+		if (!m_chunks.empty())
+		{
+			m_chunks.back().count =
+			    count
+			    - m_capacity
+			          * static_cast<uint32_t>(chunks - 1);
+		}
+		m_count = count;
+	}
+
+	uint32_t Archetype::FindEdge(ComponentId id,
+	                             bool add) const
+	{
+		for (const auto& edge : m_edges)
+		{
+			if (edge.id == id && edge.add == add)
+			{
+				return edge.archetype;
+			}
+		}
+		return NoEdge;
+	}
+
+	void Archetype::SetEdge(ComponentId id, bool add,
+	                        uint32_t archetype)
+	{
+		m_edges.push_back({id, add, archetype});
+	}
+
+	void Archetype::Destroy(Chunk& chunk, uint32_t row)
+	{
+		if (m_trivial)
+		{
+			return;
+		}
+		for (size_t i = 0; i < m_components.size(); ++i)
+		{
+			const auto& info =
+			    GetComponentInfo(m_components[i]);
+			if (!info.trivial)
+			{
+				info.destroy(chunk.data + m_offsets[i]
+				             + info.size * row);
+			}
+		}
+	}
+} // namespace AthiVegam::Ecs
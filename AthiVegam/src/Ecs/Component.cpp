@@ -0,0 +1,32 @@
+#include "AthiVegam/Ecs/Component.h"
+
+#include "AthiVegam/Log.h"
+
+#include <array>
+#include <mutex>
+
+namespace AthiVegam::Ecs
+{
+	namespace
+	{
+		// Fixed storage, so infos can be read without the
+		// lock while other types register.
+		std::array<ComponentInfo, MaxComponents> infos;
+		ComponentId count = 0;
+		std::mutex mutex;
+	} // namespace
+
+	ComponentId RegisterComponent(const ComponentInfo& info)
+	{
+		std::lock_guard lock(mutex);
+		VEGAM_ASSERT(count < MaxComponents,
+		             "Too many component types");
+		infos[count] = info;
+		return count++;
+	}
+
+	const ComponentInfo& GetComponentInfo(ComponentId id)
+	{
+		return infos[id];
+	}
+} // namespace AthiVegam::Ecs
@@ -0,0 +1,231 @@
+#include "AthiVegam/Ecs/Registry.h"
+
+#include <cstring>
+
+namespace AthiVegam::Ecs
+{
+	Registry::Registry()
+	{
+		FindOrCreateArchetype({});
+	}
+
+	Registry::~Registry() = default;
+
+	Entity Registry::Create()
+	{
+		const auto entity = AllocateRecord();
+		const auto location = m_archetypes[0]->Allocate(entity);
+		auto& record = m_records[entity.index];
+		record.archetype = 0;
+		record.chunk = location.chunk;
+		record.row = location.row;
+		return entity;
+	}
+
+	Entity Registry::AllocateRecord()
+	{
+		AssertStructural();
+		uint32_t index;
+		if (!m_freeRecords.empty())
+		{
+			index = m_freeRecords.back();
+			m_freeRecords.pop_back();
+		}
+		else
+		{
+			index = static_cast<uint32_t>(m_records.size());
+			m_records.emplace_back();
+		}
+		++m_count;
+		return {index, m_records[index].generation};
+	}
+
+	void Registry::Destroy(Entity entity)
+	{
+		AssertStructural();
+		if (!IsAlive(entity))
+		{
+			return;
+		}
+
+		auto& record = m_records[entity.index];
+		const Archetype::Location location{record.chunk,
+		                                   record.row};
+		FixMoved(
+		    m_archetypes[record.archetype]->Remove(location,
+		                                           true),
+		    location);
+		Free(entity.index);
+	}
+
+	bool Registry::IsAlive(Entity entity) const
+	{
+		return entity.index < m_records.size()
+		       && m_records[entity.index].archetype != Dead
+		       && m_records[entity.index].generation
+		              == entity.generation;
+	}
+
+	void Registry::Clear()
+	{
+		AssertStructural();
+		for (auto& archetype : m_archetypes)
+		{
+			archetype->Clear();
+		}
+		for (uint32_t i = 0; i < m_records.size(); ++i)
+		{
+			if (m_records[i].archetype != Dead)
+			{
+				Free(i);
+			}
+		}
+	}
+
+	void Registry::Free(uint32_t index)
+	{
+		// Stale handles stop matching; generation 0 is
+		// never issued.
+		auto& record = m_records[index];
+		record.archetype = Dead;
+		if (++record.generation == 0)
+		{
+			record.generation = 1;
+		}
+		m_freeRecords.push_back(index);
+		--m_count;
+	}
+
+	uint32_t
+	Registry::FindOrCreateArchetype(const ComponentMask& mask)
+	{
+		const auto it = m_archetypeIndex.find(mask);
+		if (it != m_archetypeIndex.end())
+		{
+			return it->second;
+		}
+
+		const auto index =
+		    static_cast<uint32_t>(m_archetypes.size());
+		m_archetypes.push_back(
+		    std::make_unique<Archetype>(mask));
+		m_archetypeIndex.emplace(mask, index);
+		return index;
+	}
+
+	uint32_t Registry::GetNeighbour(uint32_t archetype,
+	                                ComponentId id, bool add)
+	{
+		auto neighbour =
+		    m_archetypes[archetype]->FindEdge(id, add);
+		if (neighbour == Archetype::NoEdge)
+		{
+			auto mask = m_archetypes[archetype]->GetMask();
+			mask.set(id, add);
+			neighbour = FindOrCreateArchetype(mask);
+			m_archetypes[archetype]->SetEdge(id, add,
+			                                 neighbour);
+		}
+		return neighbour;
+	}
+
+	void Registry::Move(Entity entity, uint32_t archetype)
+	{
+		auto& record = m_records[entity.index];
+		auto& source = *m_archetypes[record.archetype];
+		auto& target = *m_archetypes[archetype];
+		const Archetype::Location from{record.chunk,
+		                               record.row};
+		const auto to = target.Allocate(entity);
+
+		for (const auto id : target.GetComponents())
+		{
+			const auto& info = GetComponentInfo(id);
+			auto* dst = target.Get(to, id);
+			if (!source.Has(id))
+			{
+				info.construct(dst);
+			}
+			else if (info.trivial)
+			{
+				std::memcpy(dst, source.Get(from, id),
+				            info.size);
+			}
+			else
+			{
+				info.relocate(dst, source.Get(from, id));
+			}
+		}
+		for (const auto id : source.GetComponents())
+		{
+			const auto& info = GetComponentInfo(id);
+			if (!target.Has(id) && !info.trivial)
+			{
+				info.destroy(source.Get(from, id));
+			}
+		}
+
+		FixMoved(source.Remove(from, false), from);
+		record.archetype = archetype;
+		record.chunk = to.chunk;
+		record.row = to.row;
+	}
+
+	void Registry::FixMoved(Entity moved,
+	                        Archetype::Location location)
+	{
+		if (moved.IsValid())
+		{
+			auto& record = m_records[moved.index];
+			record.chunk = location.chunk;
+			record.row = location.row;
+		}
+	}
+
+	void* Registry::AddComponent(Entity entity,
+	                             ComponentId id)
+	{
+		AssertStructural();
+		VEGAM_ASSERT(IsAlive(entity),
+		             "Adding a component to a dead entity");
+		const auto& record = m_records[entity.index];
+		if (!m_archetypes[record.archetype]->Has(id))
+		{
+			Move(entity,
+			     GetNeighbour(record.archetype, id, true));
+		}
+		return m_archetypes[record.archetype]->Get(
+		    {record.chunk, record.row}, id);
+	}
+
+	void Registry::RemoveComponent(Entity entity,
+	                               ComponentId id)
+	{
+		AssertStructural();
+		if (!IsAlive(entity))
+		{
+			return;
+		}
+		const auto& record = m_records[entity.index];
+		if (m_archetypes[record.archetype]->Has(id))
+		{
+			Move(entity,
+			     GetNeighbour(record.archetype, id, false));
+		}
+	}
+
+	void* Registry::GetComponent(Entity entity,
+	                             ComponentId id) const
+	{
+		if (!IsAlive(entity))
+		{
+			return nullptr;
+		}
+		const auto& record = m_records[entity.index];
+		const auto& archetype = *m_archetypes[record.archetype];
+		return archetype.Has(id)
+		           ? archetype.Get({record.chunk, record.row},
+		                           id)
+		           : nullptr;
+	}
+} // namespace AthiVegam::Ecs
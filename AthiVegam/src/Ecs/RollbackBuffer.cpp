@@ -0,0 +1,140 @@
+#include "AthiVegam/Ecs/RollbackBuffer.h"
+
+#include "AthiVegam/Core/Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace AthiVegam::Ecs
+{
+	RollbackBuffer::RollbackBuffer(uint32_t capacity)
+	    : m_states(std::max(capacity, 1u))
+	{
+	}
+
+	void RollbackBuffer::Save(const Registry& registry,
+	                          uint64_t tick)
+	{
+		VEGAM_PROFILE_SCOPE("RollbackBuffer::Save");
+		auto slot = FindSlot(tick);
+		if (slot == GetCapacity())
+		{
+			slot = m_next;
+			m_next = (m_next + 1) % GetCapacity();
+		}
+		auto* state = &m_states[slot];
+		state->tick = tick;
+		state->records = registry.m_records;
+		state->freeRecords = registry.m_freeRecords;
+		state->count = registry.m_count;
+
+		size_t chunkCount = 0;
+		state->rows.clear();
+		for (const auto& archetype : registry.m_archetypes)
+		{
+			VEGAM_ASSERT(archetype->IsTrivial()
+			                 || archetype->GetCount() == 0,
+			             "Rolling back components that are "
+			             "not trivially copyable");
+			state->rows.push_back(archetype->GetCount());
+			chunkCount += archetype->GetChunkCount();
+		}
+		state->chunks.resize(chunkCount
+		                     * Archetype::ChunkSize);
+		auto* dst = state->chunks.data();
+		for (const auto& archetype : registry.m_archetypes)
+		{
+			for (size_t i = 0; i < archetype->GetChunkCount();
+			     ++i)
+			{
+				std::memcpy(dst, archetype->GetChunk(i).data,
+				            Archetype::ChunkSize);
+				dst += Archetype::ChunkSize;
+			}
+		}
+	}
+
+	bool RollbackBuffer::Restore(Registry& registry,
+	                             uint64_t tick) const
+	{
+		const auto slot = FindSlot(tick);
+		if (slot == GetCapacity())
+		{
+			return false;
+		}
+		const auto* state = &m_states[slot];
+		VEGAM_PROFILE_SCOPE("RollbackBuffer::Restore");
+		registry.AssertStructural();
+		registry.m_records = state->records;
+		registry.m_freeRecords = state->freeRecords;
+		registry.m_count = state->count;
+
+		const auto* src = state->chunks.data();
+		for (size_t a = 0; a < registry.m_archetypes.size();
+		     ++a)
+		{
+			auto& archetype = *registry.m_archetypes[a];
+			const auto rows =
+			    a < state->rows.size() ? state->rows[a] : 0;
+			if (rows == 0)
+			{
+				// Created since, or emptied; nothing in it
+				// needs destroying.
+				if (archetype.GetCount() != 0)
+				{
+					archetype.Resize(0);
+				}
+				continue;
+			}
+			archetype.Resize(rows);
+			for (size_t i = 0; i < archetype.GetChunkCount();
+			     ++i)
+			{
+				std::memcpy(archetype.GetChunk(i).data, src,
+				            Archetype::ChunkSize);
+				src += Archetype::ChunkSize;
+			}
+		}
+		return true;
+	}
+
+	bool RollbackBuffer::Has(uint64_t tick) const
+	{
+		return FindSlot(tick) != GetCapacity();
+	}
+
+	void RollbackBuffer::Clear()
+	{
+		for (auto& state : m_states)
+		{
+			state.tick = NoTick;
+		}
+		m_next = 0;
+	}
+
+	size_t RollbackBuffer::GetMemoryUsage() const
+	{
+		size_t bytes = 0;
+		for (const auto& state : m_states)
+		{
+			bytes += state.records.capacity()
+			             * sizeof(Registry::Record)
+			         + state.freeRecords.capacity()
+			               * sizeof(uint32_t)
+			         + state.rows.capacity() * sizeof(uint32_t)
+			         + state.chunks.capacity();
+		}
+		return bytes;
+	}
+
+	uint32_t RollbackBuffer::FindSlot(uint64_t tick) const
+	{
+		uint32_t slot = 0;
+		while (slot < GetCapacity()
+		       && (tick == NoTick || m_states[slot].tick != tick))
+		{
+			++slot;
+		}
+		return slot;
+	}
+} // namespace AthiVegam::Ecs
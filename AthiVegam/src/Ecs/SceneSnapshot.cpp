@@ -0,0 +1,372 @@
+#include "AthiVegam/Ecs/SceneSnapshot.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Core/Serialize.h"
+#include "AthiVegam/Ecs/Registry.h"
+#include "AthiVegam/Log.h"
+
+#include <array>
+#include <cstring>
+
+namespace AthiVegam::Ecs
+{
+	namespace
+	{
+		constexpr uint32_t SchemaVersion = 1;
+		constexpr uint32_t NoType = ~0u;
+
+		struct SavedType
+		{
+			std::string name;
+			uint32_t size = 0;
+			uint32_t alignment = 0;
+			VEGAM_SERIAL_FIELDS(&SavedType::name,
+			                    &SavedType::size,
+			                    &SavedType::alignment)
+		};
+
+		// One archetype's entities, then each component's
+		// column in turn, packed.
+		struct SavedArchetype
+		{
+			// Indices into SavedScene::types.
+			std::vector<uint32_t> types;
+			std::vector<Entity> entities;
+			std::vector<uint8_t> columns;
+			VEGAM_SERIAL_FIELDS(&SavedArchetype::types,
+			                    &SavedArchetype::entities,
+			                    &SavedArchetype::columns)
+		};
+
+		struct SavedScene
+		{
+			// Of every entity slot, live or free.
+			std::vector<uint32_t> generations;
+			std::vector<SavedType> types;
+			std::vector<SavedArchetype> archetypes;
+			VEGAM_SERIAL_FIELDS(&SavedScene::generations,
+			                    &SavedScene::types,
+			                    &SavedScene::archetypes)
+		};
+	} // namespace
+
+	struct SceneSnapshot::Captured
+	{
+		SavedScene scene;
+	};
+
+	void SceneSnapshot::AddType(ComponentId id,
+	                            std::string_view name,
+	                            Resolve resolve)
+	{
+		VEGAM_ASSERT(GetComponentInfo(id).trivial,
+		             "Snapshotted components are copied as "
+		             "bytes");
+		VEGAM_ASSERT(Find(id) == nullptr && Find(name) == nullptr,
+		             "Component added to the snapshot twice");
+		m_types.push_back({id, std::string(name), resolve});
+	}
+
+	void SceneSnapshot::Save(const Registry& registry,
+	                         std::vector<uint8_t>& data) const
+	{
+		VEGAM_PROFILE_SCOPE("SceneSnapshot::Save");
+		Serialize(*Capture(registry), data);
+	}
+
+	std::shared_ptr<const SceneSnapshot::Captured>
+	SceneSnapshot::Capture(const Registry& registry) const
+	{
+		VEGAM_PROFILE_SCOPE("SceneSnapshot::Capture");
+		auto captured = std::make_shared<Captured>();
+		auto& scene = captured->scene;
+		scene.generations.reserve(registry.m_records.size());
+		for (const auto& record : registry.m_records)
+		{
+			scene.generations.push_back(record.generation);
+		}
+
+		std::array<uint32_t, MaxComponents> indices;
+		indices.fill(NoType);
+		for (const auto& type : m_types)
+		{
+			const auto& info = GetComponentInfo(type.id);
+			indices[type.id] =
+			    static_cast<uint32_t>(scene.types.size());
+			scene.types.push_back(
+			    {type.name, static_cast<uint32_t>(info.size),
+			     static_cast<uint32_t>(info.alignment)});
+		}
+
+		std::vector<ComponentId> ids;
+		for (const auto& archetype : registry.m_archetypes)
+		{
+			if (archetype->GetCount() == 0)
+			{
+				continue;
+			}
+
+			auto& saved = scene.archetypes.emplace_back();
+			ids.clear();
+			size_t rowSize = 0;
+			for (const auto id : archetype->GetComponents())
+			{
+				if (indices[id] == NoType)
+				{
+					VEGAM_WARN("Component {} left out of the "
+					           "scene snapshot",
+					           id);
+					continue;
+				}
+				ids.push_back(id);
+				saved.types.push_back(indices[id]);
+				rowSize += GetComponentInfo(id).size;
+			}
+
+			const auto count = archetype->GetCount();
+			saved.entities.reserve(count);
+			saved.columns.resize(rowSize * count);
+			uint32_t row = 0;
+			for (size_t i = 0; i < archetype->GetChunkCount();
+			     ++i)
+			{
+				auto& chunk = archetype->GetChunk(i);
+				const auto* entities =
+				    archetype->GetEntities(chunk);
+				saved.entities.insert(saved.entities.end(),
+				                      entities,
+				                      entities + chunk.count);
+
+				size_t column = 0;
+				for (const auto id : ids)
+				{
+					const auto size = GetComponentInfo(id).size;
+					std::memcpy(saved.columns.data() + column
+					                + size * row,
+					            archetype->GetColumn(chunk, id),
+					            size * chunk.count);
+					column += size * count;
+				}
+				row += chunk.count;
+			}
+		}
+		return captured;
+	}
+
+	void SceneSnapshot::Serialize(const Captured& captured,
+	                              std::vector<uint8_t>& data)
+	{
+		VEGAM_PROFILE_SCOPE("SceneSnapshot::Serialize");
+		Core::Serial::Save(captured.scene, data, SchemaVersion);
+	}
+
+	bool SceneSnapshot::Load(Registry& registry,
+	                         const uint8_t* data, size_t size,
+	                         void* context) const
+	{
+		VEGAM_PROFILE_SCOPE("SceneSnapshot::Load");
+		registry.Clear();
+
+		Core::Serial::View<SavedScene> scene;
+		if (!Core::Serial::Open(data, size, scene))
+		{
+			return false;
+		}
+
+		const auto generations =
+		    scene.Get<&SavedScene::generations>();
+		auto& records = registry.m_records;
+		records.assign(generations.size(), {});
+		for (size_t i = 0; i < generations.size(); ++i)
+		{
+			records[i].generation =
+			    generations[i] != 0 ? generations[i] : 1;
+		}
+		registry.m_freeRecords.clear();
+		registry.m_count = 0;
+
+		// The registered type each saved one maps to, if
+		// its layout still matches.
+		const auto savedTypes = scene.Get<&SavedScene::types>();
+		std::vector<const Type*> types(savedTypes.size());
+		std::vector<uint32_t> sizes(savedTypes.size());
+		for (size_t i = 0; i < savedTypes.size(); ++i)
+		{
+			const auto saved = savedTypes[i];
+			const auto name = saved.Get<&SavedType::name>();
+			sizes[i] = saved.Get<&SavedType::size>();
+			types[i] = Find(name);
+			if (types[i] == nullptr)
+			{
+				VEGAM_WARN("Scene snapshot component {} is "
+				           "not registered",
+				           name);
+				continue;
+			}
+			const auto& info = GetComponentInfo(types[i]->id);
+			if (info.size != sizes[i]
+			    || info.alignment
+			           != saved.Get<&SavedType::alignment>())
+			{
+				VEGAM_ERROR("Scene snapshot component {} "
+				            "changed layout",
+				            name);
+				types[i] = nullptr;
+			}
+		}
+
+		const auto fail = [&](const char* reason) {
+			VEGAM_ERROR("Malformed scene snapshot: {}",
+			            reason);
+			for (auto& archetype : registry.m_archetypes)
+			{
+				archetype->Clear();
+			}
+			records.clear();
+			registry.m_count = 0;
+			return false;
+		};
+
+		struct Column
+		{
+			const Type* type;
+			size_t offset;
+			size_t size;
+		};
+		std::vector<Column> columns;
+		const auto archetypes =
+		    scene.Get<&SavedScene::archetypes>();
+		for (size_t a = 0; a < archetypes.size(); ++a)
+		{
+			const auto saved = archetypes[a];
+			const auto typeIndices =
+			    saved.Get<&SavedArchetype::types>();
+			const auto entities =
+			    saved.Get<&SavedArchetype::entities>();
+			const auto bytes =
+			    saved.Get<&SavedArchetype::columns>();
+			const auto count = entities.size();
+
+			ComponentMask mask;
+			columns.clear();
+			size_t offset = 0;
+			for (const auto index : typeIndices)
+			{
+				if (index >= types.size())
+				{
+					return fail("bad component");
+				}
+				const auto* type = types[index];
+				if (type != nullptr)
+				{
+					if (mask.test(type->id))
+					{
+						return fail("repeated component");
+					}
+					mask.set(type->id);
+				}
+				columns.push_back({type, offset, sizes[index]});
+				offset += sizes[index] * count;
+			}
+			if (offset != bytes.size())
+			{
+				return fail("bad column size");
+			}
+
+			const auto target =
+			    registry.FindOrCreateArchetype(mask);
+			for (const auto entity : entities)
+			{
+				if (entity.index >= records.size()
+				    || entity.generation == 0
+				    || entity.generation
+				           != records[entity.index].generation
+				    || records[entity.index].archetype
+				           != Registry::Dead)
+				{
+					return fail("bad entity");
+				}
+				records[entity.index].archetype = target;
+			}
+
+			auto& archetype = *registry.m_archetypes[target];
+			for (uint32_t row = 0; row < count;)
+			{
+				auto run = static_cast<uint32_t>(count - row);
+				const auto location = archetype.AllocateRun(run);
+				auto& chunk = archetype.GetChunk(location.chunk);
+				std::memcpy(archetype.GetEntities(chunk)
+				                + location.row,
+				            entities.data() + row,
+				            sizeof(Entity) * run);
+				for (const auto& column : columns)
+				{
+					if (column.type == nullptr)
+					{
+						continue;
+					}
+					auto* dst = static_cast<std::byte*>(
+					                archetype.GetColumn(
+					                    chunk, column.type->id))
+					            + column.size * location.row;
+					std::memcpy(dst,
+					            bytes.data() + column.offset
+					                + column.size * row,
+					            column.size * run);
+					if (column.type->resolve != nullptr)
+					{
+						column.type->resolve(dst, run, context);
+					}
+				}
+
+				for (uint32_t i = 0; i < run; ++i)
+				{
+					auto& record =
+					    records[entities[row + i].index];
+					record.chunk = location.chunk;
+					record.row = location.row + i;
+				}
+				registry.m_count += run;
+				row += run;
+			}
+		}
+
+		// Lowest slots are reused first, as in a fresh
+		// registry.
+		for (auto i = static_cast<uint32_t>(records.size());
+		     i-- > 0;)
+		{
+			if (records[i].archetype == Registry::Dead)
+			{
+				registry.m_freeRecords.push_back(i);
+			}
+		}
+		return true;
+	}
+
+	const SceneSnapshot::Type*
+	SceneSnapshot::Find(ComponentId id) const
+	{
+		for (const auto& type : m_types)
+		{
+			if (type.id == id)
+			{
+				return &type;
+			}
+		}
+		return nullptr;
+	}
+
+	const SceneSnapshot::Type*
+	SceneSnapshot::Find(std::string_view name) const
+	{
+		for (const auto& type : m_types)
+		{
+			if (type.name == name)
+			{
+				return &type;
+			}
+		}
+		return nullptr;
+	}
+} // namespace AthiVegam::Ecs
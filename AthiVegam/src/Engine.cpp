@@ -1,15 +1,46 @@
 #include "AthiVegam/Engine.h"
 
+#include "AthiVegam/Core/BinaryLog.h"
+#include "AthiVegam/Core/CVar.h"
+#include "AthiVegam/Core/CpuFeatures.h"
+#include "AthiVegam/Core/CpuTopology.h"
+#include "AthiVegam/Core/FloatEnv.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Core/StartupTimer.h"
+#include "AthiVegam/Core/Task.h"
+#include "AthiVegam/Core/Telemetry.h"
+#include "AthiVegam/Graphics/FrameCapture.h"
+#include "AthiVegam/Graphics/PipelineWarmup.h"
+#include "AthiVegam/Graphics/ProgramBinaryCache.h"
 #include "AthiVegam/Log.h"
 #include "Athivegam/Input/Controller.h"
+#include "Athivegam/Input/InputActions.h"
+#include "Athivegam/Input/InputQueue.h"
+#include "Athivegam/Input/InputRecorder.h"
 #include "Athivegam/Input/Keyboard.h"
 #include "Athivegam/Input/Mouse.h"
 #include "SDL2/SDL.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <string>
+#include <thread>
 
 namespace AthiVegam
 {
+	namespace
+	{
+		// Override the app's window size when set.
+		Core::CVar<int32_t> windowWidthCVar(
+		    "window.width", 800,
+		    "Window width, applied at startup");
+		Core::CVar<int32_t> windowHeightCVar(
+		    "window.height", 600,
+		    "Window height, applied at startup");
+	} // namespace
+
 	Engine::Engine()
 	    : m_isRunning(false)
 	    , m_isInitialized(false)
@@ -30,8 +61,47 @@ namespace AthiVegam
 		if (!m_isInitialized)
 		{
 			GetInfo();
+			Core::Profiler::SetThreadName("Main");
+			Core::SetThreadClass(Core::ThreadClass::Latency);
+			Core::StartupTimer::Scope phase("Job system");
+			m_jobManager.Initialize(m_config.workerThreads);
+			m_frameArena.Initialize(
+			    m_config.frameArenaSize,
+			    m_config.frameArenaReserve,
+			    m_config.frameArenaLargePages);
+			m_fileManager.Initialize(m_config.fileIoThreads);
+			for (const auto& mount : m_config.mounts)
+			{
+				if (mount.path.ends_with(".avar"))
+				{
+					m_fileManager.MountArchive(mount.point,
+					                           mount.path);
+				}
+				else
+				{
+					m_fileManager.MountDirectory(mount.point,
+					                             mount.path);
+				}
+			}
 
-			if (SDL_Init(SDL_INIT_EVERYTHING))
+			// Disk reads overlap SDL, window and context
+			// creation on the main thread.
+			Managers::JobCounter prefetch;
+			m_jobManager.Schedule(
+			    [this] {
+				    Core::StartupTimer::Scope prefetchPhase(
+				        "Shader cache prefetch");
+				    Graphics::ProgramBinaryCache::Prefetch(
+				        m_config.shaderCacheDirectory);
+			    },
+			    &prefetch);
+
+			// Video (and events) only; the rest start with
+			// the features that need them. Servers only
+			// take events, for SIGINT and SIGTERM.
+			phase.Next("SDL");
+			if (SDL_Init(m_config.server ? SDL_INIT_EVENTS
+			                             : SDL_INIT_VIDEO))
 			{
 				VEGAM_ERROR("Error initializing SDL2: {}",
 				            SDL_GetError());
@@ -45,19 +115,137 @@ namespace AthiVegam
 				           (int32_t)version.minor,
 				           (int32_t)version.patch);
 
-				if (m_window.Create())
+				// Opening the joystick subsystem enumerates
+				// devices, which can take a while.
+				phase.Next("SDL subsystems");
+				m_controllersEnabled =
+				    m_config.controllers && !m_config.headless
+				    && !m_config.server
+				    && InitSubsystem(SDL_INIT_GAMECONTROLLER);
+				if (m_config.sdlSubsystems != 0)
 				{
+					InitSubsystem(m_config.sdlSubsystems);
+				}
+
+				SubscribeToEvents();
+				if (m_config.server)
+				{
+					BuildFrameGraphs();
+					phase.Next("App::Initialize");
+					m_app->Initialize();
+					StartProfileCapture(m_startupCaptureFrames);
+					ret = true;
+				}
+				else if (phase.Next("Window and GL context");
+				         m_window.Create(m_config))
+				{
+					phase.Next("Shader cache");
+					m_jobManager.Wait(prefetch);
+					Graphics::ProgramBinaryCache::Initialize(
+					    m_config.shaderCacheDirectory);
+					if (!m_config.pipelineLog.empty())
+					{
+						Graphics::PipelineWarmup::Load(
+						    m_config.pipelineLog);
+					}
+
 					// Initialize Managers
+					phase.Next("Managers");
 					m_renderManager.Initialize();
+					if (m_config.loaderThread)
+					{
+						m_loaderThread.Start(
+						    m_window.GetSDLWindow());
+					}
+					m_renderManager.SetMaxFramesInFlight(
+					    m_config.maxFramesInFlight);
+					if (m_config.gpuCulling)
+					{
+						if (m_renderManager
+						        .IsMultiDrawIndirectSupported())
+						{
+							m_renderManager.SetGpuCullingEnabled(
+							    true);
+						}
+						else
+						{
+							VEGAM_WARN("GPU culling needs a GL 4.3 "
+							           "context; disabled");
+						}
+					}
+					m_resourceManager.Initialize();
+					if (!m_config.shaderPack.empty())
+					{
+						m_resourceManager.MountShaderPack(
+						    m_config.shaderPack);
+					}
+					if (m_config.shaderHotReload)
+					{
+						m_resourceManager.EnableShaderHotReload(
+						    m_config.shaderWatchIntervalMs);
+					}
+					m_assetManager.Initialize(
+					    m_resourceManager, m_jobManager,
+					    m_config.assetIoThreads);
+					if (!m_config.assetSourceRoot.empty())
+					{
+						m_assetManager.EnableHotReload(
+						    {m_config.assetSourceRoot,
+						     m_config.assetCookCommand,
+						     m_config.assetWatchIntervalMs});
+					}
+					if (m_config.audio && !m_config.headless
+					    && InitSubsystem(SDL_INIT_AUDIO))
+					{
+						m_audioManager.Initialize(
+						    m_jobManager, m_config.audioSampleRate,
+						    m_config.audioBufferFrames);
+					}
 
 					// Initialize Input
+					phase.Next("Input");
 					Input::Mouse::Initialize();
 					Input::Keyboard::Initialize();
+					Input::InputQueue::Initialize();
+					if (m_controllersEnabled)
+					{
+						Input::Controller::StartSampling(
+						    m_config.controllerSampleRate);
+					}
+					if (!m_config.inputReplayPath.empty())
+					{
+						Input::InputRecorder::StartReplay(
+						    m_config.inputReplayPath,
+						    m_config.tickRate);
+					}
+					if (!m_config.inputRecordPath.empty())
+					{
+						Input::InputRecorder::StartRecording(
+						    m_config.inputRecordPath,
+						    m_config.tickRate);
+					}
+					BuildFrameGraphs();
+					if (!m_config.telemetryDirectory.empty())
+					{
+						Core::Telemetry::Start(
+						    m_config.telemetryDirectory,
+						    m_config.window.title);
+					}
+					phase.Next("App::Initialize");
 					m_app->Initialize();
+					StartProfileCapture(m_startupCaptureFrames);
 
 					ret = true;
+					if (m_config.renderThread)
+					{
+						phase.Next("Render thread");
+						m_renderManager.SetRenderThreadEnabled(
+						    true);
+						ret = m_renderThread.Start();
+					}
 				}
 			}
+			m_jobManager.Wait(prefetch);
 
 			m_isRunning = ret;
 			m_isInitialized = ret;
@@ -77,21 +265,47 @@ namespace AthiVegam
 		m_isInitialized = false;
 		m_isRunning = false;
 
+		// Take the GL context back before the app releases
+		// its resources.
+		m_renderThread.Stop();
+		m_loaderThread.Stop();
+		// Suspended tasks may hold the app's resources.
+		Core::Coroutines::Shutdown();
+
 		/* Shutdown App */
 		m_app->Shutdown();
 		m_app.reset();
 
 		/* Shutdown managers */
+		m_assetManager.Shutdown();
+		m_audioManager.Shutdown();
+		m_fileManager.Shutdown();
+		m_physicsWorld.Clear();
+		m_jobManager.Shutdown();
+		m_frameArena.Shutdown();
+		m_resourceManager.Shutdown();
 		m_renderManager.Shutdown();
+		Graphics::ProgramBinaryCache::Shutdown();
+		if (!m_config.pipelineLog.empty())
+		{
+			Graphics::PipelineWarmup::Save(m_config.pipelineLog);
+		}
+		Core::Telemetry::Stop();
+		Core::Profiler::Shutdown();
+		Core::BinaryLog::Stop();
 		m_logManager.Shutdown();
 
 		/* Shutdown SDL */
+		Input::InputRecorder::Stop();
+		Input::Controller::Shutdown();
+		Input::InputQueue::Shutdown();
 		m_window.Shutdown();
 		SDL_Quit();
 	}
 
 	void Engine::Run(std::unique_ptr<App> app)
 	{
+		Core::StartupTimer::Scope phase("Config and logging");
 		m_logManager.Initialize();
 		VEGAM_ASSERT(!m_app, "Attempting to call Run when "
 		                     "a valid app already exists");
@@ -109,31 +323,535 @@ namespace AthiVegam
 		}
 
 		m_app = std::move(app);
+		m_config = m_app->GetEngineConfig();
+		m_logManager.Configure(m_config);
+		if (m_config.asyncLogging)
+		{
+			m_logManager.StartAsync(m_config.logQueueSize,
+			                        m_config.logOverflow);
+		}
+		ParseCommandLine();
+		if (m_config.deterministic)
+		{
+			Core::FloatEnv::SetDeterministic();
+			m_config.renderOnDemand = false;
+		}
+#ifndef AV_CONFIG_SHIPPING
+		Core::Profiler::SetHitchCapture(
+		    {m_config.hitchCaptureDirectory,
+		     m_config.hitchHistorySeconds,
+		     m_config.hitchMultiple, m_config.hitchMinimumMs});
+#endif // AV_CONFIG_SHIPPING
+		if (m_config.binaryLog != BinaryLogMode::Off)
+		{
+			Core::BinaryLog::Start(m_config.binaryLog,
+			                       m_config.binaryLogPath);
+		}
 
-		if (Initialize())
+		phase.Next("Engine::Initialize");
+		if (Initialize() && m_config.server)
 		{
+			phase.Next("Running");
+			Core::StartupTimer::Report();
+			RunServer();
+		}
+		else if (m_isRunning)
+		{
+			phase.Next("First frame");
+			bool firstFrame = true;
+			const auto tick = 1.0 / m_config.tickRate;
+			const auto maxUpdates =
+			    std::max(m_config.maxUpdatesPerFrame, 1u);
+			m_time.Resync();
+			double accumulator = 0.0;
+
 			/* Core Loop */
 			while (m_isRunning)
 			{
-				Update();
-				Render();
+				if (m_config.renderOnDemand && IsIdle())
+				{
+					if (!m_window.WaitForEvent(
+					        m_config.idleTimeoutMs))
+					{
+						continue;
+					}
+					// One tick to take in the new input, and a
+					// follow-up frame for ImGui widgets that
+					// settle a frame after the event.
+					m_time.Resync();
+					accumulator = tick;
+					m_redrawRequested.store(
+					    true, std::memory_order_relaxed);
+				}
+				else
+				{
+					m_redrawRequested.store(
+					    false, std::memory_order_relaxed);
+				}
+
+				const auto& time = m_time.BeginFrame();
+				// Once per frame, so each tick can take the
+				// events stamped within its own interval.
+				m_window.PumpEvents();
+				m_eventBus.Dispatch();
+				m_fileManager.Update();
+				m_assetManager.Update();
+				m_audioManager.Update();
+				Core::Coroutines::Update();
+
+				// Game time, so pausing stops the ticks and
+				// slow motion spaces them out, each still tick
+				// seconds long.
+				accumulator += time.Delta(Core::TimeDomain::Game);
+				const auto scale =
+				    m_time.IsPaused(Core::TimeDomain::Game)
+				        ? 0.0
+				        : m_time.GetScale(Core::TimeDomain::Game);
+
+				uint32_t updates = 0;
+				while (accumulator >= tick
+				       && updates < maxUpdates && m_isRunning)
+				{
+					// The tick covers the accumulator's oldest
+					// tick seconds, in real time.
+					m_tickEnd =
+					    time.now
+					    - (scale > 0.0 ? static_cast<uint64_t>(
+					                         (accumulator - tick)
+					                         / scale * 1e9)
+					                   : 0);
+					Update(static_cast<float>(tick));
+					accumulator -= tick;
+					++updates;
+				}
+				if (accumulator >= tick && !m_config.deterministic)
+				{
+					// Fell behind; keep the phase, drop the
+					// backlog.
+					accumulator = std::fmod(accumulator, tick);
+				}
+
+				Render(static_cast<float>(accumulator / tick));
+				if (firstFrame)
+				{
+					firstFrame = false;
+					phase.Next("Running");
+					Core::StartupTimer::Report();
+				}
+
+				m_frameLimiter.Wait(
+				    m_window.IsInBackground()
+				        ? m_config.backgroundFrameRate
+				        : m_config.maxFrameRate);
 			}
 		}
 	}
 
+	void Engine::RunServer()
+	{
+		using Clock = std::chrono::steady_clock;
+		const auto tick =
+		    std::chrono::duration_cast<Clock::duration>(
+		        std::chrono::duration<double>(
+		            1.0 / m_config.tickRate));
+		const auto tickSeconds =
+		    std::chrono::duration<float>(tick).count();
+		const auto maxUpdates =
+		    std::max(m_config.maxUpdatesPerFrame, 1u);
+		// End of the next tick to simulate.
+		auto tickEnd = Clock::now() + tick;
+
+		while (m_isRunning)
+		{
+			// For the snapshot alone: servers tick in real
+			// time.
+			m_time.BeginFrame();
+			SDL_Event event;
+			while (SDL_PollEvent(&event))
+			{
+				if (event.type == SDL_QUIT)
+				{
+					m_eventBus.Publish(Core::QuitRequested{});
+				}
+			}
+			m_eventBus.Dispatch();
+
+			const auto now = Clock::now();
+			uint32_t updates = 0;
+			while (tickEnd <= now && updates < maxUpdates
+			       && m_isRunning)
+			{
+				m_tickEnd = std::chrono::duration_cast<
+				                std::chrono::nanoseconds>(
+				                tickEnd.time_since_epoch())
+				                .count();
+				// No frames; ticks take their place.
+				m_fileManager.Update();
+				Core::Coroutines::Update();
+				Update(tickSeconds);
+				m_frameArena.NextFrame();
+				Core::Profiler::EndFrame();
+				m_jobManager.EndFrame();
+				tickEnd += tick;
+				++updates;
+			}
+			if (tickEnd <= now && !m_config.deterministic)
+			{
+				// Fell behind; keep the phase, drop the
+				// backlog.
+				tickEnd += (now - tickEnd) / tick * tick + tick;
+			}
+
+			// Sleep rather than spin: a late wake-up only
+			// shifts one tick, and idle servers cost nothing.
+			std::this_thread::sleep_until(tickEnd);
+		}
+	}
+
 	void Engine::Quit() { m_isRunning = false; }
 
-	void Engine::Update()
+	void Engine::SubscribeToEvents()
+	{
+		m_eventBus.Subscribe<Core::QuitRequested>(
+		    [this](std::span<const Core::QuitRequested>) {
+			    Quit();
+		    });
+		m_eventBus.Subscribe<Core::MouseMoved>(
+		    Input::Mouse::OnMouseMotion);
+		m_eventBus.Subscribe<Core::MouseWheel>(
+		    Input::Mouse::OnMouseWheel);
+		m_eventBus.Subscribe<Core::ControllerConnected>(
+		    Input::Controller::OnControllerConnected);
+		m_eventBus.Subscribe<Core::ControllerDisconnected>(
+		    Input::Controller::OnControllerDisconnected);
+	}
+
+	bool Engine::InitSubsystem(uint32_t sdlFlags)
+	{
+		const auto missing = sdlFlags & ~SDL_WasInit(sdlFlags);
+		if (missing == 0)
+		{
+			return true;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		if (SDL_InitSubSystem(missing))
+		{
+			VEGAM_ERROR("Error initializing SDL subsystems "
+			            "{:#x}: {}",
+			            missing, SDL_GetError());
+			return false;
+		}
+		const std::chrono::duration<double, std::milli> elapsed =
+		    std::chrono::steady_clock::now() - start;
+		VEGAM_INFO("SDL subsystems {:#x} up in {:.1f} ms",
+		           missing, elapsed.count());
+		return true;
+	}
+
+	void Engine::SetCommandLine(int argc, char** argv)
+	{
+		m_arguments.assign(argv, argv + argc);
+	}
+
+	void Engine::ParseCommandLine()
+	{
+		constexpr std::string_view captureFlag =
+		    "--profile-capture";
+		constexpr std::string_view binaryLogFlag =
+		    "--binary-log";
+		constexpr std::string_view recordInputFlag =
+		    "--record-input=";
+		constexpr std::string_view replayInputFlag =
+		    "--replay-input=";
+		constexpr std::string_view configFlag = "--config=";
+		constexpr std::string_view renderCaptureFlag =
+		    "--render-capture=";
+		constexpr std::string_view hitchCaptureFlag =
+		    "--hitch-capture";
+		constexpr std::string_view zoneBudgetFlag =
+		    "--zone-budget=";
+
+		// The file first, so the command line overrides it.
+		for (const auto& argument : m_arguments)
+		{
+			if (argument.starts_with(configFlag))
+			{
+				m_config.cvarConfigPath =
+				    argument.substr(configFlag.size());
+			}
+		}
+		if (!m_config.cvarConfigPath.empty())
+		{
+			Core::CVars::LoadFile(m_config.cvarConfigPath);
+		}
+
+		for (const auto& argument : m_arguments)
+		{
+			if (argument.starts_with('+'))
+			{
+				const auto equals = argument.find('=');
+				Core::CVars::Set(
+				    std::string_view(argument).substr(
+				        1, equals - 1),
+				    equals == std::string::npos
+				        ? std::string_view()
+				        : std::string_view(argument).substr(
+				              equals + 1));
+				continue;
+			}
+			if (argument == "--headless")
+			{
+				m_config.headless = true;
+				continue;
+			}
+			if (argument == "--server")
+			{
+				m_config.server = true;
+				continue;
+			}
+			if (argument == "--deterministic")
+			{
+				m_config.deterministic = true;
+				continue;
+			}
+			if (argument.starts_with(recordInputFlag))
+			{
+				m_config.inputRecordPath =
+				    argument.substr(recordInputFlag.size());
+				continue;
+			}
+			if (argument.starts_with(replayInputFlag))
+			{
+				m_config.inputReplayPath =
+				    argument.substr(replayInputFlag.size());
+				continue;
+			}
+			if (argument.starts_with(renderCaptureFlag))
+			{
+				Graphics::FrameCapture::Request(
+				    argument.substr(renderCaptureFlag.size()),
+				    m_config.renderCaptureFlushes);
+				continue;
+			}
+			if (argument.starts_with(zoneBudgetFlag))
+			{
+				// Zone names may hold '=', the value can't.
+				const auto equals = argument.rfind('=');
+				if (equals > zoneBudgetFlag.size())
+				{
+					Core::Profiler::SetBudget(
+					    argument.substr(
+					        zoneBudgetFlag.size(),
+					        equals - zoneBudgetFlag.size()),
+					    std::strtof(argument.c_str() + equals + 1,
+					                nullptr));
+				}
+				continue;
+			}
+			if (argument.starts_with(hitchCaptureFlag))
+			{
+				m_config.hitchCaptureDirectory = "Hitches";
+				if (argument.size() > hitchCaptureFlag.size() + 1
+				    && argument[hitchCaptureFlag.size()] == '=')
+				{
+					m_config.hitchCaptureDirectory =
+					    argument.substr(hitchCaptureFlag.size()
+					                    + 1);
+				}
+				continue;
+			}
+			if (argument.starts_with(binaryLogFlag))
+			{
+				m_config.binaryLog = BinaryLogMode::File;
+				if (argument.size() > binaryLogFlag.size() + 1
+				    && argument[binaryLogFlag.size()] == '=')
+				{
+					m_config.binaryLogPath =
+					    argument.substr(binaryLogFlag.size() + 1);
+				}
+				continue;
+			}
+			if (!argument.starts_with(captureFlag))
+			{
+				continue;
+			}
+
+			m_startupCaptureFrames = m_config.profileCaptureFrames;
+			if (argument.size() > captureFlag.size() + 1
+			    && argument[captureFlag.size()] == '=')
+			{
+				m_startupCaptureFrames = static_cast<uint32_t>(
+				    std::strtoul(argument.c_str()
+				                     + captureFlag.size() + 1,
+				                 nullptr, 10));
+			}
+		}
+
+		if (windowWidthCVar.GetVersion() != 0)
+		{
+			m_config.window.width = windowWidthCVar.Get();
+		}
+		if (windowHeightCVar.GetVersion() != 0)
+		{
+			m_config.window.height = windowHeightCVar.Get();
+		}
+	}
+
+	void Engine::StartProfileCapture(uint32_t frameCount)
+	{
+#ifndef AV_CONFIG_SHIPPING
+		if (frameCount == 0 || Core::Profiler::IsCapturing())
+		{
+			return;
+		}
+
+		const auto seconds =
+		    std::chrono::duration_cast<std::chrono::seconds>(
+		        std::chrono::system_clock::now()
+		            .time_since_epoch())
+		        .count();
+		const auto path =
+		    "ProfileCapture-" + std::to_string(seconds) + ".json";
+		if (Core::Profiler::StartCapture(path, frameCount))
+		{
+			VEGAM_INFO("Capturing {} frames to {}", frameCount,
+			           path);
+		}
+#endif // AV_CONFIG_SHIPPING
+	}
+
+	bool Engine::IsIdle() const
 	{
-		m_window.PumpEvents();
-		m_app->Update();
+		return !m_animating
+		       && !m_redrawRequested.load(
+		           std::memory_order_relaxed)
+		       && !m_resourceManager.HasPendingUploads();
 	}
 
-	void Engine::Render()
+	void Engine::Update(float deltaTime)
 	{
-		m_window.BeginRender();
-		m_app->Render();
-		m_window.EndRender();
+		VEGAM_PROFILE_SCOPE("Engine::Update");
+		VEGAM_ASSERT(!m_config.deterministic
+		                 || Core::FloatEnv::IsDeterministic(),
+		             "Floating-point environment changed");
+		m_deltaTime = deltaTime;
+		++m_tick;
+		m_updateGraph.Execute(m_jobManager);
+	}
+
+	void Engine::Render(float alpha)
+	{
+		{
+			VEGAM_PROFILE_SCOPE("Engine::Render");
+			m_alpha = alpha;
+			m_renderGraph.Execute(m_jobManager);
+			m_frameArena.NextFrame();
+		}
+		Core::Profiler::EndFrame();
+		m_jobManager.EndFrame();
+		Core::Telemetry::EndFrame();
+	}
+
+	void Engine::BuildFrameGraphs()
+	{
+		using Affinity = Core::TaskGraph::Affinity;
+
+		if (m_config.server)
+		{
+			m_updateGraph.AddStage(
+			    "App.Update", {}, {"World"},
+			    [this] { m_app->Update(m_deltaTime); },
+			    Affinity::MainThread);
+			m_updateGraph.AddStage(
+			    "Physics.Step", {}, {"World"},
+			    [this] {
+				    m_physicsWorld.Step(m_deltaTime,
+				                        m_jobManager);
+			    },
+			    Affinity::MainThread);
+			return;
+		}
+
+		m_updateGraph.AddStage(
+		    "Input.Update", {}, {"Input"},
+		    [this] {
+			    Input::InputQueue::BeginTick(m_tickEnd);
+			    if (Input::InputRecorder::IsReplaying())
+			    {
+				    if (!Input::InputRecorder::ReplayTick())
+				    {
+					    Quit();
+				    }
+			    }
+			    else
+			    {
+				    Input::Mouse::Update();
+				    Input::Keyboard::Update();
+				    Input::Controller::Update();
+			    }
+			    Input::InputRecorder::RecordTick();
+			    Input::InputActions::Update();
+		    },
+		    Affinity::MainThread);
+		m_updateGraph.AddStage(
+		    "App.Update", {"Input"}, {"World"},
+		    [this] { m_app->Update(m_deltaTime); },
+		    Affinity::MainThread);
+		m_updateGraph.AddStage(
+		    "Physics.Step", {}, {"World"},
+		    [this] {
+			    m_physicsWorld.Step(m_deltaTime, m_jobManager);
+		    },
+		    Affinity::MainThread);
+		m_updateGraph.AddStage(
+		    "Profiler.Hotkey", {"Input"}, {},
+		    [this] {
+			    if (Input::Keyboard::KeyDown(
+			            Input::KeyCode::AV_KEY_F11))
+			    {
+				    StartProfileCapture(
+				        m_config.profileCaptureFrames);
+			    }
+			    if (Input::Keyboard::KeyDown(
+			            Input::KeyCode::AV_KEY_F10))
+			    {
+				    m_window.GetPerformanceHud().ToggleVisible();
+			    }
+		    },
+		    Affinity::MainThread);
+
+		// The render thread owns the GL context and the
+		// window's Begin/EndRender when it is enabled.
+		if (m_config.renderThread)
+		{
+			m_renderGraph.AddStage(
+			    "App.Render", {"World"}, {"Frame"},
+			    [this] { m_app->Render(m_alpha); },
+			    Affinity::MainThread);
+			m_renderGraph.AddStage(
+			    "Window.EndRecording", {}, {"Frame"},
+			    [this] { m_window.EndRecording(); },
+			    Affinity::MainThread);
+			m_renderGraph.AddStage(
+			    "RenderThread.SubmitFrame", {}, {"Frame"},
+			    [this] { m_renderThread.SubmitFrame(); },
+			    Affinity::MainThread);
+			return;
+		}
+
+		m_renderGraph.AddStage(
+		    "Window.BeginRender", {}, {"Frame"},
+		    [this] { m_window.BeginRender(); },
+		    Affinity::MainThread);
+		m_renderGraph.AddStage(
+		    "App.Render", {"World"}, {"Frame"},
+		    [this] { m_app->Render(m_alpha); },
+		    Affinity::MainThread);
+		m_renderGraph.AddStage(
+		    "Window.EndRender", {}, {"Frame"},
+		    [this] { m_window.EndRender(); },
+		    Affinity::MainThread);
 	}
 
 	void Engine::GetInfo()
@@ -142,6 +860,9 @@ namespace AthiVegam
 #ifdef AV_CONFIG_DEBUG
 		VEGAM_DEBUG("Configuration : DEBUG");
 #endif //  AV_CONFIG_DEBUG
+#ifdef AV_CONFIG_PROFILE
+		VEGAM_DEBUG("Configuration : PROFILE");
+#endif // AV_CONFIG_PROFILE
 #ifdef AV_CONFIG_RELEASE
 		VEGAM_DEBUG("Configuration : RELEASE");
 #endif // AV_CONFIG_RELEASE
@@ -154,5 +875,6 @@ namespace AthiVegam
 #ifdef AV_PLATFORM_MAC
 		VEGAM_WARN"Platform : MAC");
 #endif // AV_PLATFORM_MAC
+		Core::LogCpuFeatures();
 	}
 } // namespace AthiVegam
@@ -0,0 +1,238 @@
+#include "AthiVegam/GameModule.h"
+
+#include "AthiVegam/Log.h"
+#include "SDL2/SDL.h"
+
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace AthiVegam
+{
+	namespace
+	{
+		std::string LibraryPath(std::string path)
+		{
+			if (path.find_first_of("/\\.") != std::string::npos)
+			{
+				return path;
+			}
+#if defined(AV_PLATFORM_WINDOWS)
+			path += ".dll";
+#elif defined(AV_PLATFORM_MAC)
+			path = "lib" + path + ".dylib";
+#else
+			path = "lib" + path + ".so";
+#endif
+			if (auto* base = SDL_GetBasePath())
+			{
+				path = base + path;
+				SDL_free(base);
+			}
+			return path;
+		}
+	} // namespace
+
+	GameModule::GameModule(std::string path)
+	    : m_path(LibraryPath(std::move(path)))
+	{
+		// Before logging is up; GetEngineConfig() reports
+		// a failure.
+		if (Load(m_library, m_loadError))
+		{
+			m_app = m_library.app;
+		}
+	}
+
+	GameModule::~GameModule()
+	{
+		Unload(m_library);
+	}
+
+	EngineConfig GameModule::GetEngineConfig() const
+	{
+		if (!m_app)
+		{
+			VEGAM_ERROR("Cannot load game module {}: {}",
+			            m_path, m_loadError);
+			return {};
+		}
+		return m_app->GetEngineConfig();
+	}
+
+	void GameModule::Initialize()
+	{
+		if (m_app)
+		{
+			m_app->Initialize();
+		}
+	}
+
+	void GameModule::Shutdown()
+	{
+		if (m_app)
+		{
+			m_app->Shutdown();
+		}
+	}
+
+	void GameModule::Update(float deltaTime)
+	{
+		if (IsRebuilt())
+		{
+			Reload();
+		}
+		if (m_app)
+		{
+			m_app->Update(deltaTime);
+		}
+	}
+
+	void GameModule::Render(float alpha)
+	{
+		if (m_app)
+		{
+			m_app->Render(alpha);
+		}
+	}
+
+	bool GameModule::Load(Library& library, std::string& error)
+	{
+		std::error_code fsError;
+		// Tried once per build, loaded or not.
+		m_loadedTime =
+		    std::filesystem::last_write_time(m_path, fsError);
+		if (fsError)
+		{
+			error = fsError.message();
+			return false;
+		}
+
+		const std::filesystem::path path(m_path);
+		library.copy =
+		    std::filesystem::temp_directory_path(fsError)
+		    / fmt::format(
+		        "{}-{}-{}{}", path.stem().string(),
+		        m_loadedTime.time_since_epoch().count(),
+		        m_copyCount++, path.extension().string());
+		if (!std::filesystem::copy_file(
+		        path, library.copy,
+		        std::filesystem::copy_options::overwrite_existing,
+		        fsError))
+		{
+			error = fsError.message();
+			return false;
+		}
+
+		library.handle =
+		    SDL_LoadObject(library.copy.string().c_str());
+		if (!library.handle)
+		{
+			error = SDL_GetError();
+			Unload(library);
+			return false;
+		}
+		const auto create = reinterpret_cast<CreateFunction>(
+		    SDL_LoadFunction(library.handle,
+		                     "AthiVegamCreateApp"));
+		library.destroy = reinterpret_cast<DestroyFunction>(
+		    SDL_LoadFunction(library.handle,
+		                     "AthiVegamDestroyApp"));
+		if (!create || !library.destroy)
+		{
+			error = "not a game module";
+			Unload(library);
+			return false;
+		}
+		library.app = create();
+		if (!library.app)
+		{
+			error = "no App created";
+			Unload(library);
+			return false;
+		}
+		return true;
+	}
+
+	void GameModule::Unload(Library& library)
+	{
+		// The App goes with the module that allocated it.
+		if (library.app)
+		{
+			library.destroy(library.app);
+		}
+		if (library.handle)
+		{
+			SDL_UnloadObject(library.handle);
+		}
+		if (!library.copy.empty())
+		{
+			std::error_code error;
+			std::filesystem::remove(library.copy, error);
+		}
+		library = {};
+	}
+
+	bool GameModule::IsRebuilt()
+	{
+		const auto now = std::chrono::steady_clock::now();
+		if (now < m_nextCheck)
+		{
+			return false;
+		}
+		m_nextCheck = now + CheckInterval;
+
+		std::error_code error;
+		const auto time =
+		    std::filesystem::last_write_time(m_path, error);
+		if (error || time == m_loadedTime)
+		{
+			m_pendingTime = {};
+			return false;
+		}
+		if (time != m_pendingTime)
+		{
+			m_pendingTime = time;
+			return false;
+		}
+		return true;
+	}
+
+	void GameModule::Reload()
+	{
+		VEGAM_INFO("Reloading game module {}", m_path);
+		Library library;
+		std::string error;
+		if (!Load(library, error))
+		{
+			VEGAM_ERROR("Game module reload failed, keeping "
+			            "the running one: {}",
+			            error);
+			return;
+		}
+
+		std::vector<uint8_t> state;
+		if (m_app)
+		{
+			m_app->SaveState(state);
+			if (state.empty())
+			{
+				m_app->Shutdown();
+			}
+		}
+		Unload(m_library);
+		m_library = library;
+		m_app = library.app;
+		if (state.empty())
+		{
+			m_app->Initialize();
+		}
+		else
+		{
+			m_app->LoadState(state);
+		}
+		++m_reloadCount;
+		VEGAM_INFO("Game module reloaded, {} bytes of state",
+		           state.size());
+	}
+} // namespace AthiVegam
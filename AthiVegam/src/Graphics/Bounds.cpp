@@ -0,0 +1,134 @@
+#include "AthiVegam/Graphics/Bounds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace AthiVegam::Graphics
+{
+	BoundingSphere Aabb::GetSphere() const
+	{
+		if (!std::isfinite(max.x - min.x)
+		    || !std::isfinite(max.y - min.y)
+		    || !std::isfinite(max.z - min.z))
+		{
+			return {{0.0f, 0.0f, 0.0f},
+			        std::numeric_limits<float>::infinity()};
+		}
+
+		const Float3 extent{(max.x - min.x) * 0.5f,
+		                    (max.y - min.y) * 0.5f,
+		                    (max.z - min.z) * 0.5f};
+		return {{min.x + extent.x, min.y + extent.y,
+		         min.z + extent.z},
+		        std::sqrt(extent.x * extent.x
+		                  + extent.y * extent.y
+		                  + extent.z * extent.z)};
+	}
+
+	Aabb ComputeBounds(const VertexLayout& layout,
+	                   const void* vertexData,
+	                   uint32_t vertexCount)
+	{
+		const VertexAttribute* position = nullptr;
+		for (uint32_t i = 0; i < layout.GetAttributeCount(); ++i)
+		{
+			if (layout.GetAttribute(i).location == 0)
+			{
+				position = &layout.GetAttribute(i);
+			}
+		}
+		if (!position || !vertexData || vertexCount == 0)
+		{
+			return Aabb::Infinite();
+		}
+
+		uint32_t components;
+		switch (position->format)
+		{
+		case VertexFormat::Float2:
+			components = 2;
+			break;
+		case VertexFormat::Float3:
+		case VertexFormat::Float4:
+			components = 3;
+			break;
+		default:
+			return Aabb::Infinite();
+		}
+
+		const auto* bytes = static_cast<const uint8_t*>(vertexData)
+		                    + position->offset;
+		float first[3] = {};
+		std::memcpy(first, bytes, components * sizeof(float));
+		Aabb bounds{{first[0], first[1], first[2]},
+		            {first[0], first[1], first[2]}};
+		for (uint32_t i = 1; i < vertexCount; ++i)
+		{
+			float p[3] = {};
+			std::memcpy(p, bytes + static_cast<size_t>(i)
+			                           * layout.GetStride(),
+			            components * sizeof(float));
+			bounds.min = {std::min(bounds.min.x, p[0]),
+			              std::min(bounds.min.y, p[1]),
+			              std::min(bounds.min.z, p[2])};
+			bounds.max = {std::max(bounds.max.x, p[0]),
+			              std::max(bounds.max.y, p[1]),
+			              std::max(bounds.max.z, p[2])};
+		}
+		return bounds;
+	}
+
+	BoundingSphere Transform(const BoundingSphere& sphere,
+	                         const float matrix[16])
+	{
+		const auto& c = sphere.center;
+		const Float3 center{
+		    matrix[0] * c.x + matrix[4] * c.y + matrix[8] * c.z
+		        + matrix[12],
+		    matrix[1] * c.x + matrix[5] * c.y + matrix[9] * c.z
+		        + matrix[13],
+		    matrix[2] * c.x + matrix[6] * c.y + matrix[10] * c.z
+		        + matrix[14]};
+
+		float scale = 0.0f;
+		for (int column = 0; column < 3; ++column)
+		{
+			const auto* axis = matrix + column * 4;
+			scale = std::max(scale, axis[0] * axis[0]
+			                            + axis[1] * axis[1]
+			                            + axis[2] * axis[2]);
+		}
+		return {center, sphere.radius * std::sqrt(scale)};
+	}
+
+	// Each output axis gathers the smaller and larger
+	// product of every input axis.
+	Aabb Transform(const Aabb& box, const float matrix[16])
+	{
+		if (!std::isfinite(box.max.x - box.min.x)
+		    || !std::isfinite(box.max.y - box.min.y)
+		    || !std::isfinite(box.max.z - box.min.z))
+		{
+			return Aabb::Infinite();
+		}
+
+		const float min[3] = {box.min.x, box.min.y, box.min.z};
+		const float max[3] = {box.max.x, box.max.y, box.max.z};
+		float outMin[3] = {matrix[12], matrix[13], matrix[14]};
+		float outMax[3] = {matrix[12], matrix[13], matrix[14]};
+		for (int row = 0; row < 3; ++row)
+		{
+			for (int column = 0; column < 3; ++column)
+			{
+				const auto m = matrix[column * 4 + row];
+				const auto a = m * min[column];
+				const auto b = m * max[column];
+				outMin[row] += std::min(a, b);
+				outMax[row] += std::max(a, b);
+			}
+		}
+		return {{outMin[0], outMin[1], outMin[2]},
+		        {outMax[0], outMax[1], outMax[2]}};
+	}
+} // namespace AthiVegam::Graphics
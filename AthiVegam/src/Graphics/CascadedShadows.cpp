@@ -0,0 +1,436 @@
+#include "AthiVegam/Graphics/CascadedShadows.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/FrameGraph.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace AthiVegam::Graphics
+{
+	// Cascades are picked by view depth; normals push the
+	// lookup out of the surface by a texel of its cascade.
+	const char* CascadedShadowsShaderSource = R"(
+layout(std140, binding = 2) uniform Shadows
+{
+	mat4 ShadowMatrices[4];
+	vec4 ShadowSplits;
+	vec4 ShadowTexelSizes;
+	// Cascade count, depth bias, normal offset in
+	// texels, texel size in the map.
+	vec4 ShadowParams;
+	vec4 ShadowViewDepthRow;
+};
+layout(binding = 14) uniform sampler2DArrayShadow ShadowMap;
+
+float CascadedShadow(vec3 worldPosition, vec3 normal)
+{
+	float depth = -dot(ShadowViewDepthRow, vec4(worldPosition, 1.0));
+	int count = int(ShadowParams.x);
+	int cascade = 0;
+	while (cascade < count && depth > ShadowSplits[cascade])
+	{
+		++cascade;
+	}
+	if (cascade == count)
+	{
+		return 1.0;
+	}
+
+	vec3 offset = normal * ShadowParams.z * ShadowTexelSizes[cascade];
+	vec4 p = ShadowMatrices[cascade]
+	         * vec4(worldPosition + offset, 1.0);
+	float reference = p.z - ShadowParams.y;
+	float lit = 0.0;
+	for (int y = -1; y <= 1; ++y)
+	{
+		for (int x = -1; x <= 1; ++x)
+		{
+			vec2 uv = p.xy + vec2(x, y) * ShadowParams.w;
+			lit += texture(ShadowMap,
+			               vec4(uv, float(cascade), reference));
+		}
+	}
+	return lit / 9.0;
+}
+)";
+
+	namespace
+	{
+		static_assert(CascadedShadows::MaxCascades == 4,
+		              "The Shadows block holds four cascades");
+
+		// std140 Shadows block.
+		struct ShadowConstants
+		{
+			float matrices[CascadedShadows::MaxCascades][16];
+			float splits[4];
+			float texelSizes[4];
+			float params[4];
+			float viewDepthRow[4];
+		};
+
+		uint32_t CreateDepthArray(int resolution,
+		                          uint32_t layers, bool compare,
+		                          const char* label)
+		{
+			uint32_t texture = 0;
+			glGenTextures(1, &texture);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+			VEGAM_CHECK_GL_ERROR;
+			glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1,
+			               GL_DEPTH_COMPONENT32F, resolution,
+			               resolution, layers);
+			VEGAM_CHECK_GL_ERROR;
+			// Linear comparisons filter the 2x2 results.
+			const auto filter = compare ? GL_LINEAR : GL_NEAREST;
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+			                GL_TEXTURE_MIN_FILTER, filter);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+			                GL_TEXTURE_MAG_FILTER, filter);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+			                GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+			                GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			VEGAM_CHECK_GL_ERROR;
+			if (compare)
+			{
+				glTexParameteri(GL_TEXTURE_2D_ARRAY,
+				                GL_TEXTURE_COMPARE_MODE,
+				                GL_COMPARE_REF_TO_TEXTURE);
+				glTexParameteri(GL_TEXTURE_2D_ARRAY,
+				                GL_TEXTURE_COMPARE_FUNC,
+				                GL_LEQUAL);
+				VEGAM_CHECK_GL_ERROR;
+			}
+			glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(
+			    GpuResources::Type::Texture, texture,
+			    static_cast<size_t>(resolution) * resolution * 4
+			        * layers,
+			    label);
+			return texture;
+		}
+
+		void DeleteTexture(uint32_t& texture)
+		{
+			if (texture == 0)
+			{
+				return;
+			}
+			GpuResources::Unregister(GpuResources::Type::Texture,
+			                         texture);
+			glDeleteTextures(1, &texture);
+			VEGAM_CHECK_GL_ERROR;
+			texture = 0;
+		}
+	} // namespace
+
+	CascadedShadows::CascadedShadows() = default;
+
+	CascadedShadows::CascadedShadows(const Settings& settings)
+	    : m_settings(settings)
+	{
+		VEGAM_ASSERT(m_settings.cascadeCount > 0
+		                 && m_settings.cascadeCount
+		                        <= MaxCascades
+		                 && m_settings.firstCachedCascade
+		                        <= m_settings.cascadeCount
+		                 && m_settings.resolution > 0
+		                 && m_settings.distance > 0.0f,
+		             "Invalid cascaded shadow settings");
+	}
+
+	CascadedShadows::~CascadedShadows()
+	{
+		VEGAM_ASSERT(
+		    !IsInitialized(),
+		    "CascadedShadows destroyed without Shutdown()");
+	}
+
+	bool CascadedShadows::Initialize()
+	{
+		if (IsInitialized())
+		{
+			return true;
+		}
+		if (!GLAD_GL_VERSION_4_3)
+		{
+			VEGAM_WARN("Cascaded shadows need a GL 4.3 context");
+			return false;
+		}
+
+		const auto count = m_settings.cascadeCount;
+		m_shadowMap = CreateDepthArray(m_settings.resolution,
+		                               count, true,
+		                               "Shadow cascades");
+		if (m_settings.firstCachedCascade < count)
+		{
+			m_staticCache = CreateDepthArray(
+			    m_settings.resolution,
+			    count - m_settings.firstCachedCascade, false,
+			    "Shadow cascade cache");
+		}
+
+		glGenBuffers(1, &m_constantsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_UNIFORM_BUFFER, m_constantsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(ShadowConstants),
+		             nullptr, GL_DYNAMIC_DRAW);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::Buffer,
+		                       m_constantsBuffer,
+		                       sizeof(ShadowConstants),
+		                       "Shadow constants");
+
+		InvalidateStatic();
+		return true;
+	}
+
+	void CascadedShadows::Shutdown()
+	{
+		DeleteTexture(m_shadowMap);
+		DeleteTexture(m_staticCache);
+		if (m_constantsBuffer != 0)
+		{
+			GpuResources::Unregister(GpuResources::Type::Buffer,
+			                         m_constantsBuffer);
+			glDeleteBuffers(1, &m_constantsBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			m_constantsBuffer = 0;
+		}
+	}
+
+	void CascadedShadows::InvalidateStatic()
+	{
+		for (auto& cascade : m_cascades)
+		{
+			cascade.staticValid = false;
+		}
+	}
+
+	void CascadedShadows::Fit(Cascade& cascade,
+	                          const Math::Vec3& center,
+	                          float radius)
+	{
+		const auto up = std::abs(m_lightDirection.y) > 0.99f
+		                    ? Math::Vec3{1.0f, 0.0f, 0.0f}
+		                    : Math::Vec3{0.0f, 1.0f, 0.0f};
+		const auto lightView =
+		    Math::Mat4::LookAt({}, m_lightDirection, up);
+
+		// Whole texels in light space, so the rasterized
+		// texels of static geometry don't move.
+		const auto texel =
+		    2.0f * radius
+		    / static_cast<float>(m_settings.resolution);
+		auto origin = Math::TransformPoint(lightView, center);
+		origin.x = std::floor(origin.x / texel) * texel;
+		origin.y = std::floor(origin.y / texel) * texel;
+
+		const auto projection = Math::Mat4::Orthographic(
+		    origin.x - radius, origin.x + radius,
+		    origin.y - radius, origin.y + radius,
+		    -origin.z - radius - m_settings.casterDistance,
+		    -origin.z + radius);
+		cascade.viewProjection = projection * lightView;
+		cascade.texelSize = texel;
+		cascade.center = center;
+		cascade.radius = radius;
+	}
+
+	void CascadedShadows::Update(const float view[16],
+	                             const float projection[16],
+	                             float zNear,
+	                             const Math::Vec3& lightDirection)
+	{
+		VEGAM_PROFILE_SCOPE("CascadedShadows::Update");
+		const auto direction = Math::Normalize(lightDirection);
+		const auto lightTurned =
+		    Math::Dot(direction, m_lightDirection) < 0.99999f;
+		m_lightDirection = direction;
+		m_viewDepthRow = {view[2], view[6], view[10], view[14]};
+
+		const auto inverseView =
+		    Math::InverseAffine(Math::Mat4::Load(view));
+		// Squared half-diagonal of the frustum at depth 1.
+		const auto tanX = 1.0f / projection[0];
+		const auto tanY = 1.0f / projection[5];
+		const auto diagonal = tanX * tanX + tanY * tanY;
+
+		const auto count = m_settings.cascadeCount;
+		const auto end = m_settings.distance;
+		auto begin = zNear;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const auto t = static_cast<float>(i + 1) / count;
+			const auto uniform = zNear + (end - zNear) * t;
+			const auto logarithmic =
+			    zNear * std::pow(end / zNear, t);
+			const auto split =
+			    uniform
+			    + (logarithmic - uniform) * m_settings.splitLambda;
+
+			// The sphere through the slice's near and far
+			// corners, centered on the view axis.
+			const auto a = begin * begin * diagonal;
+			const auto b = split * split * diagonal;
+			const auto depth = std::clamp(
+			    (split * split + b - begin * begin - a)
+			        / (2.0f * (split - begin)),
+			    begin, split);
+			const auto radius = std::sqrt(std::max(
+			    (depth - begin) * (depth - begin) + a,
+			    (split - depth) * (split - depth) + b));
+			const auto center = Math::TransformPoint(
+			    inverseView, {0.0f, 0.0f, -depth});
+
+			auto& cascade = m_cascades[i];
+			cascade.split = split;
+			if (!IsCached(i))
+			{
+				Fit(cascade, center, radius);
+			}
+			else if (lightTurned
+			         || Math::Length(center - cascade.center)
+			                    + radius
+			                > cascade.radius)
+			{
+				Fit(cascade, center,
+				    radius * (1.0f + m_settings.cacheMargin));
+				cascade.staticValid = false;
+			}
+			begin = split;
+		}
+	}
+
+	void CascadedShadows::AddPasses(FrameGraph& graph,
+	                                const DrawFunction& draw)
+	{
+		VEGAM_ASSERT(IsInitialized(),
+		             "CascadedShadows used before "
+		             "Initialize()!");
+		const auto resolution = m_settings.resolution;
+		m_staticRenders = 0;
+		for (uint32_t i = 0; i < m_settings.cascadeCount; ++i)
+		{
+			const auto target = graph.Import(
+			    "Shadow cascade", m_shadowMap, resolution,
+			    resolution, AttachmentFormat::Depth32F,
+			    static_cast<int32_t>(i));
+			const auto* viewProjection =
+			    m_cascades[i].viewProjection.Data();
+			if (!IsCached(i))
+			{
+				graph.AddPass(
+				    "Shadow cascade",
+				    [target](FrameGraph::PassBuilder& builder) {
+					    builder.WriteDepth(target, LoadOp::Clear);
+				    },
+				    [draw, i, viewProjection](
+				        const FrameGraph::PassContext&) {
+					    draw({i, Casters::All, viewProjection});
+				    });
+				continue;
+			}
+
+			const auto layer = static_cast<int32_t>(
+			    i - m_settings.firstCachedCascade);
+			const auto cache = graph.Import(
+			    "Shadow cascade cache", m_staticCache,
+			    resolution, resolution,
+			    AttachmentFormat::Depth32F, layer);
+			auto& cascade = m_cascades[i];
+			if (!cascade.staticValid)
+			{
+				graph.AddPass(
+				    "Shadow cascade cache",
+				    [cache](FrameGraph::PassBuilder& builder) {
+					    builder.WriteDepth(cache, LoadOp::Clear);
+				    },
+				    [draw, i, viewProjection](
+				        const FrameGraph::PassContext&) {
+					    draw({i, Casters::Static,
+					          viewProjection});
+				    });
+				cascade.staticValid = true;
+				++m_staticRenders;
+			}
+
+			// The copy covers the whole layer.
+			graph.AddPass(
+			    "Shadow cascade",
+			    [cache, target](FrameGraph::PassBuilder& builder) {
+				    builder.Read(cache);
+				    builder.WriteDepth(target, LoadOp::DontCare);
+			    },
+			    [this, draw, i, layer, viewProjection](
+			        const FrameGraph::PassContext&) {
+				    const auto size = m_settings.resolution;
+				    glCopyImageSubData(
+				        m_staticCache, GL_TEXTURE_2D_ARRAY, 0, 0,
+				        0, layer, m_shadowMap,
+				        GL_TEXTURE_2D_ARRAY, 0, 0, 0,
+				        static_cast<GLint>(i), size, size, 1);
+				    VEGAM_CHECK_GL_ERROR;
+				    draw({i, Casters::Dynamic, viewProjection});
+			    });
+		}
+	}
+
+	void CascadedShadows::Bind()
+	{
+		VEGAM_ASSERT(IsInitialized(),
+		             "CascadedShadows used before "
+		             "Initialize()!");
+		// From clip space to texture coordinates and depth.
+		const auto toTexture =
+		    Math::Mat4::Translation({0.5f, 0.5f, 0.5f})
+		    * Math::Mat4::Scale({0.5f, 0.5f, 0.5f});
+
+		ShadowConstants constants{};
+		for (uint32_t i = 0; i < m_settings.cascadeCount; ++i)
+		{
+			const auto& cascade = m_cascades[i];
+			(toTexture * cascade.viewProjection)
+			    .Store(constants.matrices[i]);
+			constants.splits[i] = cascade.split;
+			constants.texelSizes[i] = cascade.texelSize;
+		}
+		constants.params[0] =
+		    static_cast<float>(m_settings.cascadeCount);
+		constants.params[1] = m_settings.depthBias;
+		constants.params[2] = m_settings.normalOffset;
+		constants.params[3] =
+		    1.0f / static_cast<float>(m_settings.resolution);
+		std::copy(m_viewDepthRow.begin(), m_viewDepthRow.end(),
+		          constants.viewDepthRow);
+
+		glBindBuffer(GL_UNIFORM_BUFFER, m_constantsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(constants),
+		                &constants);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBufferBase(GL_UNIFORM_BUFFER, ShadowsBinding,
+		                 m_constantsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+
+		glActiveTexture(GL_TEXTURE0 + ShadowMapUnit);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_shadowMap);
+		VEGAM_CHECK_GL_ERROR;
+		glActiveTexture(GL_TEXTURE0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+} // namespace AthiVegam::Graphics
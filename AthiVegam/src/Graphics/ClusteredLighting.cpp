@@ -0,0 +1,720 @@
+#include "AthiVegam/Graphics/ClusteredLighting.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Managers/JobManager.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace AthiVegam::Graphics
+{
+	// Windowed inverse-square falloff, reaching 0 at the
+	// light's radius. Decals sample with the gradients of
+	// the position, taken before the loop while control
+	// flow is uniform.
+	const char* ClusteredLightingShaderSource = R"(
+struct PointLight
+{
+	vec4 positionRadius;
+	vec4 colorIntensity;
+};
+struct Decal
+{
+	mat4 worldToDecal;
+	vec4 uvRect;
+	vec4 color;
+	vec4 axisFade;
+	uvec4 layer;
+};
+struct LightProbe
+{
+	vec4 positionRadius;
+	vec4 irradiance[3];
+	int reflectionLayer;
+	float intensity;
+	float reflectionLevels;
+	float falloff;
+};
+
+layout(std430, binding = 7) readonly buffer Lights
+{
+	PointLight lights[];
+};
+layout(std430, binding = 8) readonly buffer Clusters
+{
+	mat4 ClusterView;
+	uvec4 ClusterGrid;
+	vec4 ClusterDepth;
+	vec4 ClusterViewport;
+	uvec4 clusters[];
+};
+layout(std430, binding = 9) readonly buffer ClusterIndices
+{
+	uint clusterIndices[];
+};
+layout(std430, binding = 22) readonly buffer Decals
+{
+	Decal decals[];
+};
+layout(std430, binding = 23) readonly buffer LightProbes
+{
+	LightProbe probes[];
+};
+layout(binding = 17) uniform sampler2DArray DecalTextures;
+layout(binding = 18) uniform samplerCubeArray ProbeTextures;
+
+uint ClusterIndex(vec3 worldPosition)
+{
+	float depth = max(-(ClusterView * vec4(worldPosition, 1.0)).z,
+	                  ClusterDepth.x);
+	uint slice = uint(clamp(log(depth) * ClusterDepth.y
+	                            + ClusterDepth.z,
+	                        0.0, float(ClusterGrid.z - 1u)));
+	uvec2 tile = min(uvec2(gl_FragCoord.xy / ClusterViewport.xy
+	                       * vec2(ClusterGrid.xy)),
+	                 ClusterGrid.xy - 1u);
+	return (slice * ClusterGrid.y + tile.y) * ClusterGrid.x
+	       + tile.x;
+}
+
+vec3 ClusteredLighting(vec3 worldPosition, vec3 normal,
+                       vec3 albedo)
+{
+	uvec4 cluster = clusters[ClusterIndex(worldPosition)];
+	vec3 result = vec3(0.0);
+	for (uint i = 0u; i < cluster.y; ++i)
+	{
+		PointLight light = lights[clusterIndices[cluster.x + i]];
+		vec3 toLight = light.positionRadius.xyz - worldPosition;
+		float distanceSq = max(dot(toLight, toLight), 1e-4);
+		float falloff = clamp(1.0 - distanceSq
+		                          / (light.positionRadius.w
+		                             * light.positionRadius.w),
+		                      0.0, 1.0);
+		float diffuse =
+		    max(dot(normal, toLight * inversesqrt(distanceSq)),
+		        0.0);
+		result += light.colorIntensity.rgb
+		          * light.colorIntensity.w * diffuse * falloff
+		          * falloff / distanceSq;
+	}
+	return result * albedo;
+}
+
+vec3 ClusteredDecals(vec3 worldPosition, vec3 normal,
+                     vec3 albedo)
+{
+	uvec4 cluster = clusters[ClusterIndex(worldPosition)];
+	vec3 dx = dFdx(worldPosition);
+	vec3 dy = dFdy(worldPosition);
+	uint first = cluster.x + cluster.y;
+	for (uint i = 0u; i < cluster.z; ++i)
+	{
+		Decal decal = decals[clusterIndices[first + i]];
+		vec3 local = (decal.worldToDecal
+		              * vec4(worldPosition, 1.0)).xyz;
+		if (any(greaterThan(abs(local), vec3(0.5))))
+		{
+			continue;
+		}
+		// Full strength from halfway between the fade
+		// cosine and facing straight up the z axis.
+		float fade = clamp(2.0 * (dot(normal, decal.axisFade.xyz)
+		                          - decal.axisFade.w)
+		                       / max(1.0 - decal.axisFade.w, 1e-4),
+		                   0.0, 1.0);
+		if (fade <= 0.0)
+		{
+			continue;
+		}
+		vec2 uv = decal.uvRect.xy
+		          + (local.xy + 0.5) * decal.uvRect.zw;
+		vec2 uvDx = (mat3(decal.worldToDecal) * dx).xy
+		            * decal.uvRect.zw;
+		vec2 uvDy = (mat3(decal.worldToDecal) * dy).xy
+		            * decal.uvRect.zw;
+		vec4 color = textureGrad(DecalTextures,
+		                         vec3(uv, float(decal.layer.x)),
+		                         uvDx, uvDy)
+		             * decal.color;
+		albedo = mix(albedo, color.rgb, color.a * fade);
+	}
+	return albedo;
+}
+
+void ClusteredProbes(vec3 worldPosition, vec3 normal,
+                     vec3 reflected, float roughness,
+                     out vec3 irradiance, out vec3 reflection)
+{
+	uvec4 cluster = clusters[ClusterIndex(worldPosition)];
+	irradiance = vec3(0.0);
+	reflection = vec3(0.0);
+	float total = 0.0;
+	float reflectionTotal = 0.0;
+	vec4 basis = vec4(1.0, normal);
+	uint first = cluster.x + cluster.y + cluster.z;
+	for (uint i = 0u; i < cluster.w; ++i)
+	{
+		LightProbe probe = probes[clusterIndices[first + i]];
+		float radius = probe.positionRadius.w;
+		float weight =
+		    clamp((radius - distance(worldPosition,
+		                             probe.positionRadius.xyz))
+		              / max(probe.falloff * radius, 1e-4),
+		          0.0, 1.0);
+		if (weight <= 0.0)
+		{
+			continue;
+		}
+		irradiance += max(vec3(dot(probe.irradiance[0], basis),
+		                       dot(probe.irradiance[1], basis),
+		                       dot(probe.irradiance[2], basis)),
+		                  0.0)
+		              * probe.intensity * weight;
+		total += weight;
+		if (probe.reflectionLayer >= 0)
+		{
+			float lod = roughness
+			            * max(probe.reflectionLevels - 1.0, 0.0);
+			reflection +=
+			    textureLod(ProbeTextures,
+			               vec4(reflected,
+			                    float(probe.reflectionLayer)),
+			               lod).rgb
+			    * probe.intensity * weight;
+			reflectionTotal += weight;
+		}
+	}
+	// Overlaps average; alone, a probe fades out.
+	irradiance /= max(total, 1.0);
+	reflection /= max(reflectionTotal, 1.0);
+}
+)";
+
+	namespace
+	{
+		// Slices per job; slices vary a lot in cost, so
+		// one each balances best.
+		constexpr uint32_t SliceBatch = 1;
+
+		// Orphaned every upload, like GpuCulling's buffers.
+		void UploadStorage(uint32_t buffer, size_t& capacity,
+		                   const void* data, size_t size)
+		{
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+			VEGAM_CHECK_GL_ERROR;
+			// Empty buffers can't be bound.
+			size = std::max<size_t>(size, 16);
+			if (size > capacity)
+			{
+				capacity = size * 2;
+			}
+			glBufferData(GL_SHADER_STORAGE_BUFFER, capacity,
+			             nullptr, GL_STREAM_DRAW);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Resize(GpuResources::Type::Buffer,
+			                     buffer, capacity);
+			if (data)
+			{
+				glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
+				                size, data);
+				VEGAM_CHECK_GL_ERROR;
+			}
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+			VEGAM_CHECK_GL_ERROR;
+		}
+
+		void CreateBuffer(uint32_t& buffer, const char* label)
+		{
+			glGenBuffers(1, &buffer);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(GpuResources::Type::Buffer,
+			                       buffer, 0, label);
+		}
+
+		void DeleteBuffer(uint32_t& buffer, size_t& capacity)
+		{
+			if (buffer == 0)
+			{
+				return;
+			}
+			GpuResources::Unregister(GpuResources::Type::Buffer,
+			                         buffer);
+			glDeleteBuffers(1, &buffer);
+			VEGAM_CHECK_GL_ERROR;
+			buffer = 0;
+			capacity = 0;
+		}
+
+		// Tile of an NDC coordinate, clamped to the grid.
+		inline uint32_t Tile(float ndc, uint32_t tiles)
+		{
+			const auto tile = static_cast<int32_t>(
+			    std::floor((ndc + 1.0f) * 0.5f
+			               * static_cast<float>(tiles)));
+			return static_cast<uint32_t>(std::clamp(
+			    tile, 0, static_cast<int32_t>(tiles) - 1));
+		}
+
+		inline float DistanceSq(float value, float lo,
+		                        float hi)
+		{
+			const auto d = value < lo   ? lo - value
+			               : value > hi ? value - hi
+			                            : 0.0f;
+			return d * d;
+		}
+
+		// Of an affine column-major transform, through the
+		// adjugate of its upper 3x3.
+		void InverseAffine(const float m[16], float out[16])
+		{
+			const float inverse[9] = {
+			    m[5] * m[10] - m[9] * m[6],
+			    m[8] * m[6] - m[4] * m[10],
+			    m[4] * m[9] - m[8] * m[5],
+			    m[9] * m[2] - m[1] * m[10],
+			    m[0] * m[10] - m[8] * m[2],
+			    m[8] * m[1] - m[0] * m[9],
+			    m[1] * m[6] - m[5] * m[2],
+			    m[4] * m[2] - m[0] * m[6],
+			    m[0] * m[5] - m[4] * m[1]};
+			const auto det = m[0] * inverse[0]
+			                 + m[4] * inverse[3]
+			                 + m[8] * inverse[6];
+			VEGAM_ASSERT(det != 0.0f,
+			             "Decal transform isn't invertible");
+			const auto invDet = 1.0f / det;
+			for (int row = 0; row < 3; ++row)
+			{
+				const auto* r = inverse + row * 3;
+				out[row] = r[0] * invDet;
+				out[row + 4] = r[1] * invDet;
+				out[row + 8] = r[2] * invDet;
+				out[row + 12] = -(r[0] * m[12] + r[1] * m[13]
+				                  + r[2] * m[14])
+				                * invDet;
+			}
+			out[3] = out[7] = out[11] = 0.0f;
+			out[15] = 1.0f;
+		}
+	} // namespace
+
+	ClusteredLighting::ClusteredLighting()
+	    : m_cells(ClusterCount, Cell{0, 0, 0, 0})
+	{
+	}
+
+	ClusteredLighting::~ClusteredLighting()
+	{
+		VEGAM_ASSERT(
+		    !IsInitialized(),
+		    "ClusteredLighting destroyed without Shutdown()");
+	}
+
+	bool ClusteredLighting::Initialize()
+	{
+		if (IsInitialized())
+		{
+			return true;
+		}
+		if (!GLAD_GL_VERSION_4_3)
+		{
+			VEGAM_WARN("Clustered lighting needs a GL 4.3 "
+			           "context");
+			return false;
+		}
+		CreateBuffer(m_lightsBuffer, "Lights");
+		CreateBuffer(m_clustersBuffer, "Light clusters");
+		CreateBuffer(m_indicesBuffer, "Cluster indices");
+		CreateBuffer(m_decalsBuffer, "Decals");
+		CreateBuffer(m_probesBuffer, "Light probes");
+		return true;
+	}
+
+	void ClusteredLighting::Shutdown()
+	{
+		DeleteBuffer(m_lightsBuffer, m_lightsBufferSize);
+		DeleteBuffer(m_clustersBuffer, m_clustersBufferSize);
+		DeleteBuffer(m_indicesBuffer, m_indicesBufferSize);
+		DeleteBuffer(m_decalsBuffer, m_decalsBufferSize);
+		DeleteBuffer(m_probesBuffer, m_probesBufferSize);
+	}
+
+	void ClusteredLighting::Prepare(
+	    const float view[16], const float projection[16],
+	    float zNear, float zFar, int width, int height,
+	    const Contents& contents)
+	{
+		VEGAM_ASSERT(zNear > 0.0f && zFar > zNear
+		                 && projection[0] > 0.0f
+		                 && projection[5] > 0.0f,
+		             "Invalid clustered lighting view");
+
+		std::memcpy(m_header.view, view, sizeof(m_header.view));
+		m_header.grid[0] = TilesX;
+		m_header.grid[1] = TilesY;
+		m_header.grid[2] = Slices;
+		m_header.grid[3] =
+		    static_cast<uint32_t>(contents.lights.size());
+		// slice = log(depth / zNear) * scale.
+		const auto scale = static_cast<float>(Slices)
+		                   / std::log(zFar / zNear);
+		m_header.depth[0] = zNear;
+		m_header.depth[1] = scale;
+		m_header.depth[2] = -std::log(zNear) * scale;
+		m_header.viewport[0] = static_cast<float>(width);
+		m_header.viewport[1] = static_cast<float>(height);
+		for (uint32_t i = 0; i <= Slices; ++i)
+		{
+			m_sliceDepths[i] =
+			    zNear
+			    * std::pow(zFar / zNear, static_cast<float>(i)
+			                                 / Slices);
+		}
+		m_xScale = projection[0];
+		m_yScale = projection[5];
+
+		const auto& lights = contents.lights;
+		const auto& decals = contents.decals;
+		const auto& probes = contents.probes;
+		m_lights.assign(lights.begin(), lights.end());
+		m_probes.assign(probes.begin(), probes.end());
+		m_spheres.clear();
+		m_spheres.reserve(lights.size() + decals.size()
+		                  + probes.size());
+		const auto* v = view;
+		const auto addSphere = [&](float x, float y, float z,
+		                           float radius) {
+			m_spheres.push_back(
+			    {v[0] * x + v[4] * y + v[8] * z + v[12],
+			     v[1] * x + v[5] * y + v[9] * z + v[13],
+			     -(v[2] * x + v[6] * y + v[10] * z + v[14]),
+			     radius});
+		};
+		for (const auto& light : lights)
+		{
+			const auto& p = light.position;
+			addSphere(p.x, p.y, p.z, light.radius);
+		}
+
+		// Decals bound the unit cube by half its diagonal.
+		m_decals.resize(decals.size());
+		for (size_t i = 0; i < decals.size(); ++i)
+		{
+			const auto* m = decals[i].transform;
+			auto& decal = m_decals[i];
+			InverseAffine(m, decal.worldToDecal);
+			decal.uvRect = decals[i].uvRect;
+			decal.color = decals[i].color;
+			const auto axis = std::sqrt(
+			    m[8] * m[8] + m[9] * m[9] + m[10] * m[10]);
+			decal.axisFade = {m[8] / axis, m[9] / axis,
+			                  m[10] / axis, decals[i].normalFade};
+			decal.layer = decals[i].layer;
+			addSphere(m[12], m[13], m[14],
+			          0.5f
+			              * std::sqrt(m[0] * m[0] + m[1] * m[1]
+			                          + m[2] * m[2] + m[4] * m[4]
+			                          + m[5] * m[5] + m[6] * m[6]
+			                          + axis * axis));
+		}
+
+		for (const auto& probe : probes)
+		{
+			const auto& p = probe.position;
+			addSphere(p.x, p.y, p.z, probe.radius);
+		}
+	}
+
+	void ClusteredLighting::Build(
+	    const float view[16], const float projection[16],
+	    float zNear, float zFar, int width, int height,
+	    std::span<const PointLight> lights)
+	{
+		Build(view, projection, zNear, zFar, width, height,
+		      Contents{lights, {}, {}});
+	}
+
+	void ClusteredLighting::Build(
+	    const float view[16], const float projection[16],
+	    float zNear, float zFar, int width, int height,
+	    const Contents& contents)
+	{
+		VEGAM_PROFILE_SCOPE("ClusteredLighting::Build");
+		Prepare(view, projection, zNear, zFar, width, height,
+		        contents);
+		for (uint32_t slice = 0; slice < Slices; ++slice)
+		{
+			BuildSlice(slice);
+		}
+		Finish();
+	}
+
+	void ClusteredLighting::Build(
+	    const float view[16], const float projection[16],
+	    float zNear, float zFar, int width, int height,
+	    std::span<const PointLight> lights,
+	    Managers::JobManager& jobs)
+	{
+		Build(view, projection, zNear, zFar, width, height,
+		      Contents{lights, {}, {}}, jobs);
+	}
+
+	void ClusteredLighting::Build(
+	    const float view[16], const float projection[16],
+	    float zNear, float zFar, int width, int height,
+	    const Contents& contents, Managers::JobManager& jobs)
+	{
+		VEGAM_PROFILE_SCOPE("ClusteredLighting::Build");
+		Prepare(view, projection, zNear, zFar, width, height,
+		        contents);
+		jobs.ParallelFor(Slices, SliceBatch,
+		                 [this](uint32_t slice) {
+			                 BuildSlice(slice);
+		                 });
+		Finish();
+	}
+
+	void ClusteredLighting::BuildSlice(uint32_t slice)
+	{
+		const auto sliceNear = m_sliceDepths[slice];
+		const auto sliceFar = m_sliceDepths[slice + 1];
+
+		// Tiles each sphere's view-space box covers within
+		// the slice; x / depth is extreme at the box's
+		// corners.
+		auto& candidates = m_sliceCandidates[slice];
+		candidates.clear();
+		for (uint32_t i = 0; i < m_spheres.size(); ++i)
+		{
+			const auto& sphere = m_spheres[i];
+			const auto lo =
+			    std::max(sphere.depth - sphere.radius, sliceNear);
+			const auto hi =
+			    std::min(sphere.depth + sphere.radius, sliceFar);
+			if (lo > hi)
+			{
+				continue;
+			}
+			const auto left =
+			    (sphere.x - sphere.radius) * m_xScale;
+			const auto right =
+			    (sphere.x + sphere.radius) * m_xScale;
+			const auto bottom =
+			    (sphere.y - sphere.radius) * m_yScale;
+			const auto top =
+			    (sphere.y + sphere.radius) * m_yScale;
+			const auto minX = std::min(left / lo, left / hi);
+			const auto maxX = std::max(right / lo, right / hi);
+			const auto minY = std::min(bottom / lo, bottom / hi);
+			const auto maxY = std::max(top / lo, top / hi);
+			if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f
+			    || minY > 1.0f)
+			{
+				continue;
+			}
+			candidates.push_back({i, Tile(minX, TilesX),
+			                      Tile(maxX, TilesX),
+			                      Tile(minY, TilesY),
+			                      Tile(maxY, TilesY)});
+		}
+
+		// Candidates come in sphere order, so each cell's
+		// run holds its lights, decals and probes in turn.
+		const auto decalsBegin =
+		    static_cast<uint32_t>(m_lights.size());
+		const auto probesBegin =
+		    decalsBegin + static_cast<uint32_t>(m_decals.size());
+		auto& indices = m_sliceIndices[slice];
+		indices.clear();
+		uint32_t overflow = 0;
+		const auto invX = 1.0f / m_xScale;
+		const auto invY = 1.0f / m_yScale;
+		for (uint32_t y = 0; y < TilesY; ++y)
+		{
+			const auto y0 = -1.0f + 2.0f * y / TilesY;
+			const auto y1 = -1.0f + 2.0f * (y + 1) / TilesY;
+			// View-space box of the cluster.
+			const auto minY =
+			    std::min(y0 * sliceNear, y0 * sliceFar) * invY;
+			const auto maxY =
+			    std::max(y1 * sliceNear, y1 * sliceFar) * invY;
+			for (uint32_t x = 0; x < TilesX; ++x)
+			{
+				const auto x0 = -1.0f + 2.0f * x / TilesX;
+				const auto x1 = -1.0f + 2.0f * (x + 1) / TilesX;
+				const auto minX =
+				    std::min(x0 * sliceNear, x0 * sliceFar) * invX;
+				const auto maxX =
+				    std::max(x1 * sliceNear, x1 * sliceFar) * invX;
+
+				auto& cell =
+				    m_cells[(slice * TilesY + y) * TilesX + x];
+				cell.offset =
+				    static_cast<uint32_t>(indices.size());
+				cell.lights = 0;
+				cell.decals = 0;
+				cell.probes = 0;
+				for (const auto& candidate : candidates)
+				{
+					if (x < candidate.x0 || x > candidate.x1
+					    || y < candidate.y0 || y > candidate.y1)
+					{
+						continue;
+					}
+					const auto& sphere =
+					    m_spheres[candidate.sphere];
+					const auto distanceSq =
+					    DistanceSq(sphere.x, minX, maxX)
+					    + DistanceSq(sphere.y, minY, maxY)
+					    + DistanceSq(sphere.depth, sliceNear,
+					                 sliceFar);
+					if (distanceSq
+					    > sphere.radius * sphere.radius)
+					{
+						continue;
+					}
+					auto* count = &cell.lights;
+					auto limit = MaxLightsPerCluster;
+					auto base = 0u;
+					if (candidate.sphere >= probesBegin)
+					{
+						count = &cell.probes;
+						limit = MaxProbesPerCluster;
+						base = probesBegin;
+					}
+					else if (candidate.sphere >= decalsBegin)
+					{
+						count = &cell.decals;
+						limit = MaxDecalsPerCluster;
+						base = decalsBegin;
+					}
+					if (*count == limit)
+					{
+						++overflow;
+						continue;
+					}
+					indices.push_back(candidate.sphere - base);
+					++*count;
+				}
+			}
+		}
+		m_sliceOverflow[slice] = overflow;
+	}
+
+	void ClusteredLighting::Finish()
+	{
+		// Slices were built apart; their runs are laid out
+		// one after another.
+		m_indices.clear();
+		m_overflow = 0;
+		for (uint32_t slice = 0; slice < Slices; ++slice)
+		{
+			const auto base =
+			    static_cast<uint32_t>(m_indices.size());
+			const auto first = slice * TilesX * TilesY;
+			for (uint32_t i = first; i < first + TilesX * TilesY;
+			     ++i)
+			{
+				m_cells[i].offset += base;
+			}
+			m_indices.insert(m_indices.end(),
+			                      m_sliceIndices[slice].begin(),
+			                      m_sliceIndices[slice].end());
+			m_overflow += m_sliceOverflow[slice];
+		}
+		if (m_overflow > 0)
+		{
+			VEGAM_WARN_ONCE("{} light-cluster entries over the "
+			                "limits per cluster were dropped",
+			                m_overflow);
+		}
+	}
+
+	void ClusteredLighting::Upload()
+	{
+		VEGAM_ASSERT(IsInitialized(),
+		             "ClusteredLighting used before "
+		             "Initialize()!");
+		VEGAM_PROFILE_SCOPE("ClusteredLighting::Upload");
+		static_assert(sizeof(PointLight) == 32,
+		              "PointLight must match its std430 layout");
+		static_assert(sizeof(GpuDecal) == 128,
+		              "GpuDecal must match its std430 layout");
+		static_assert(sizeof(LightProbe) == 80,
+		              "LightProbe must match its std430 layout");
+		static_assert(sizeof(Header) % 16 == 0,
+		              "Cells must start 16-byte aligned");
+
+		UploadStorage(m_lightsBuffer, m_lightsBufferSize,
+		              m_lights.data(),
+		              m_lights.size() * sizeof(PointLight));
+		UploadStorage(m_indicesBuffer, m_indicesBufferSize,
+		              m_indices.data(),
+		              m_indices.size() * sizeof(uint32_t));
+		UploadStorage(m_decalsBuffer, m_decalsBufferSize,
+		              m_decals.data(),
+		              m_decals.size() * sizeof(GpuDecal));
+		UploadStorage(m_probesBuffer, m_probesBufferSize,
+		              m_probes.data(),
+		              m_probes.size() * sizeof(LightProbe));
+
+		// Header and cells in one buffer.
+		const auto cellsSize = m_cells.size() * sizeof(Cell);
+		UploadStorage(m_clustersBuffer, m_clustersBufferSize,
+		              nullptr, sizeof(Header) + cellsSize);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_clustersBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
+		                sizeof(Header), &m_header);
+		VEGAM_CHECK_GL_ERROR;
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+		                sizeof(Header), cellsSize,
+		                m_cells.data());
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void ClusteredLighting::Bind() const
+	{
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LightsBinding,
+		                 m_lightsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+		                 ClustersBinding, m_clustersBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+		                 IndicesBinding, m_indicesBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DecalsBinding,
+		                 m_decalsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ProbesBinding,
+		                 m_probesBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		if (m_decalTextures != 0)
+		{
+			glActiveTexture(GL_TEXTURE0 + DecalTextureUnit);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D_ARRAY, m_decalTextures);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		if (m_probeTextures != 0)
+		{
+			glActiveTexture(GL_TEXTURE0 + ProbeTextureUnit);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY,
+			              m_probeTextures);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glActiveTexture(GL_TEXTURE0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+} // namespace AthiVegam::Graphics
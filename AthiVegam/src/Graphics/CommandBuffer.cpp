@@ -0,0 +1,36 @@
+#include "AthiVegam/Graphics/CommandBuffer.h"
+
+#include "AthiVegam/Log.h"
+
+namespace AthiVegam::Graphics
+{
+	CommandBuffer::CommandBuffer(size_t initialCapacity)
+	    : m_data(initialCapacity), m_head(0)
+	{
+	}
+
+	size_t CommandBuffer::Allocate(size_t size)
+	{
+		const auto offset = m_head;
+		const auto alignedSize =
+		    (size + Alignment - 1) & ~(Alignment - 1);
+
+		if (offset + alignedSize > m_data.size())
+		{
+			// Only happens while the stream warms up to the
+			// largest frame seen so far.
+			auto newSize = m_data.empty() ? Alignment
+			                              : m_data.size();
+			while (offset + alignedSize > newSize)
+			{
+				newSize *= 2;
+			}
+			VEGAM_TRACE("Growing CommandBuffer to {} bytes",
+			            newSize);
+			m_data.resize(newSize);
+		}
+
+		m_head += alignedSize;
+		return offset;
+	}
+} // namespace AthiVegam::Graphics
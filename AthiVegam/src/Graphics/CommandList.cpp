@@ -0,0 +1,71 @@
+#include "AthiVegam/Graphics/CommandList.h"
+
+#include <cstring>
+
+namespace AthiVegam::Graphics
+{
+	uint32_t CommandList::PushInstances(
+	    const RenderCommands::InstanceTransform* transforms,
+	    uint32_t count)
+	{
+		const auto first =
+		    static_cast<uint32_t>(m_instances.size());
+		m_instances.insert(m_instances.end(), transforms,
+		                   transforms + count);
+		m_drawData.resize(m_instances.size());
+		return first;
+	}
+
+	uint32_t CommandList::PushInstances(
+	    const RenderCommands::InstanceTransform* transforms,
+	    const RenderCommands::DrawData* drawData,
+	    uint32_t count)
+	{
+		const auto first =
+		    static_cast<uint32_t>(m_instances.size());
+		m_instances.insert(m_instances.end(), transforms,
+		                   transforms + count);
+		m_drawData.insert(m_drawData.end(), drawData,
+		                  drawData + count);
+		return first;
+	}
+
+	void CommandList::SubmitInstanced(
+	    MeshHandle mesh, ShaderHandle shader,
+	    const RenderCommands::InstanceTransform* transforms,
+	    uint32_t count)
+	{
+		Submit(RenderCommands::RenderMeshInstanced{
+		    mesh, shader, PushInstances(transforms, count),
+		    count});
+	}
+
+	RenderCommands::Constants
+	CommandList::PushConstants(const void* data,
+	                           uint32_t size)
+	{
+		constexpr auto alignment =
+		    RenderCommands::ConstantsAlignment;
+		const auto offset = static_cast<uint32_t>(
+		    (m_constants.size() + alignment - 1)
+		    & ~static_cast<size_t>(alignment - 1));
+		m_constants.resize(offset + size);
+		std::memcpy(m_constants.data() + offset, data, size);
+		return {offset, size};
+	}
+
+	void CommandList::EraseEntry(uint32_t entry)
+	{
+		m_entries[entry] = m_entries.back();
+		m_entries.pop_back();
+	}
+
+	void CommandList::Reset()
+	{
+		m_commands.Reset();
+		m_entries.clear();
+		m_instances.clear();
+		m_drawData.clear();
+		m_constants.clear();
+	}
+} // namespace AthiVegam::Graphics
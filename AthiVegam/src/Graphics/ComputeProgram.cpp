@@ -0,0 +1,79 @@
+#include "AthiVegam/Graphics/ComputeProgram.h"
+
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+namespace AthiVegam::Graphics
+{
+	uint32_t CreateComputeProgram(const char* source,
+	                              const char* label)
+	{
+		const auto shader = glCreateShader(GL_COMPUTE_SHADER);
+		VEGAM_CHECK_GL_ERROR;
+		glShaderSource(shader, 1, &source, nullptr);
+		VEGAM_CHECK_GL_ERROR;
+		glCompileShader(shader);
+		VEGAM_CHECK_GL_ERROR;
+
+		GLint status = GL_FALSE;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+		VEGAM_CHECK_GL_ERROR;
+		if (status != GL_TRUE)
+		{
+			char errorLog[512];
+			glGetShaderInfoLog(shader, sizeof(errorLog),
+			                   nullptr, errorLog);
+			VEGAM_ERROR("{} compile error: {}", label,
+			            errorLog);
+			glDeleteShader(shader);
+			VEGAM_CHECK_GL_ERROR;
+			return 0;
+		}
+
+		const auto program = glCreateProgram();
+		VEGAM_CHECK_GL_ERROR;
+		glAttachShader(program, shader);
+		VEGAM_CHECK_GL_ERROR;
+		glLinkProgram(program);
+		VEGAM_CHECK_GL_ERROR;
+		glDeleteShader(shader);
+		VEGAM_CHECK_GL_ERROR;
+
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+		VEGAM_CHECK_GL_ERROR;
+		if (status != GL_TRUE)
+		{
+			char errorLog[512];
+			glGetProgramInfoLog(program, sizeof(errorLog),
+			                    nullptr, errorLog);
+			VEGAM_ERROR("{} link error: {}", label,
+			            errorLog);
+			glDeleteProgram(program);
+			VEGAM_CHECK_GL_ERROR;
+			return 0;
+		}
+		GpuResources::Register(GpuResources::Type::Program,
+		                       program, 0, label);
+		return program;
+	}
+
+	void DeleteComputeProgram(uint32_t& program)
+	{
+		if (program == 0)
+		{
+			return;
+		}
+		if (Shader::GetCurrentProgram() == program)
+		{
+			Shader::UseProgram(0);
+		}
+		GpuResources::Unregister(GpuResources::Type::Program,
+		                         program);
+		glDeleteProgram(program);
+		VEGAM_CHECK_GL_ERROR;
+		program = 0;
+	}
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,43 @@
+#include "AthiVegam/Graphics/ComputeShader.h"
+
+#include "AthiVegam/Graphics/ComputeProgram.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "glad/glad.h"
+
+namespace AthiVegam::Graphics
+{
+	ComputeShader::ComputeShader(const std::string& source)
+	{
+		m_programId =
+		    CreateComputeProgram(source.c_str(), "ComputeShader");
+		if (m_programId == 0)
+		{
+			return;
+		}
+
+		const auto block =
+		    glGetUniformBlockIndex(m_programId, "Constants");
+		VEGAM_CHECK_GL_ERROR;
+		if (block != GL_INVALID_INDEX)
+		{
+			glUniformBlockBinding(m_programId, block,
+			                      Shader::ConstantsBinding);
+			VEGAM_CHECK_GL_ERROR;
+		}
+
+		GLint size[3] = {1, 1, 1};
+		glGetProgramiv(m_programId, GL_COMPUTE_WORK_GROUP_SIZE,
+		               size);
+		VEGAM_CHECK_GL_ERROR;
+		for (int i = 0; i < 3; ++i)
+		{
+			m_workGroupSize[i] = static_cast<uint32_t>(size[i]);
+		}
+	}
+
+	ComputeShader::~ComputeShader()
+	{
+		DeleteComputeProgram(m_programId);
+	}
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,395 @@
+#include "AthiVegam/Graphics/Culling.h"
+
+#include "AthiVegam/Core/CpuFeatures.h"
+#include "AthiVegam/Graphics/OcclusionBuffer.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Managers/JobManager.h"
+
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#if defined(AV_CPU_X86)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AV_CULL_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define AV_CULL_NEON
+#endif
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		constexpr uint32_t NoSlot = 0xFFFFFFFF;
+
+		// Bit i set for each sphere i of the block
+		// intersecting every plane.
+		uint64_t CullBlockBaseline(const Frustum& frustum,
+		                           const float* x,
+		                           const float* y,
+		                           const float* z,
+		                           const float* radius)
+		{
+			constexpr auto block = CullingSet::BlockSize;
+			const auto& planes = frustum.planes;
+			uint64_t mask = 0;
+#if defined(AV_CULL_SSE2)
+			for (uint32_t i = 0; i < block; i += 4)
+			{
+				const auto px = _mm_loadu_ps(x + i);
+				const auto py = _mm_loadu_ps(y + i);
+				const auto pz = _mm_loadu_ps(z + i);
+				const auto negRadius = _mm_sub_ps(
+				    _mm_setzero_ps(), _mm_loadu_ps(radius + i));
+				auto inside =
+				    _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (const auto& plane : planes)
+				{
+					auto d = _mm_add_ps(
+					    _mm_mul_ps(px, _mm_set1_ps(plane.x)),
+					    _mm_set1_ps(plane.w));
+					d = _mm_add_ps(
+					    d, _mm_mul_ps(py, _mm_set1_ps(plane.y)));
+					d = _mm_add_ps(
+					    d, _mm_mul_ps(pz, _mm_set1_ps(plane.z)));
+					inside = _mm_and_ps(inside,
+					                    _mm_cmpgt_ps(d, negRadius));
+				}
+				mask |= static_cast<uint64_t>(
+				            _mm_movemask_ps(inside))
+				        << i;
+			}
+#elif defined(AV_CULL_NEON)
+			for (uint32_t i = 0; i < block; i += 4)
+			{
+				const auto px = vld1q_f32(x + i);
+				const auto py = vld1q_f32(y + i);
+				const auto pz = vld1q_f32(z + i);
+				const auto negRadius =
+				    vnegq_f32(vld1q_f32(radius + i));
+				auto inside = vdupq_n_u32(0xFFFFFFFF);
+				for (const auto& plane : planes)
+				{
+					auto d = vmlaq_n_f32(vdupq_n_f32(plane.w),
+					                     px, plane.x);
+					d = vmlaq_n_f32(d, py, plane.y);
+					d = vmlaq_n_f32(d, pz, plane.z);
+					inside = vandq_u32(inside,
+					                   vcgtq_f32(d, negRadius));
+				}
+				// One bit per lane.
+				constexpr uint32_t laneBits[4] = {1, 2, 4, 8};
+				const auto bits = vandq_u32(
+				    inside, vld1q_u32(laneBits));
+				const auto lanes = vgetq_lane_u32(bits, 0)
+				                   | vgetq_lane_u32(bits, 1)
+				                   | vgetq_lane_u32(bits, 2)
+				                   | vgetq_lane_u32(bits, 3);
+				mask |= static_cast<uint64_t>(lanes) << i;
+			}
+#else
+			for (uint32_t i = 0; i < block; ++i)
+			{
+				bool inside = true;
+				for (const auto& plane : planes)
+				{
+					inside = inside
+					         && plane.x * x[i] + plane.y * y[i]
+					                    + plane.z * z[i] + plane.w
+					                > -radius[i];
+				}
+				mask |= static_cast<uint64_t>(inside) << i;
+			}
+#endif
+			return mask;
+		}
+
+#if defined(AV_CPU_X86)
+		AV_TARGET_AVX2 uint64_t CullBlockAvx2(
+		    const Frustum& frustum, const float* x,
+		    const float* y, const float* z,
+		    const float* radius)
+		{
+			constexpr auto block = CullingSet::BlockSize;
+			const auto& planes = frustum.planes;
+			uint64_t mask = 0;
+			for (uint32_t i = 0; i < block; i += 8)
+			{
+				const auto px = _mm256_loadu_ps(x + i);
+				const auto py = _mm256_loadu_ps(y + i);
+				const auto pz = _mm256_loadu_ps(z + i);
+				const auto negRadius = _mm256_sub_ps(
+				    _mm256_setzero_ps(),
+				    _mm256_loadu_ps(radius + i));
+				auto inside = _mm256_castsi256_ps(
+				    _mm256_set1_epi32(-1));
+				for (const auto& plane : planes)
+				{
+					auto d = _mm256_add_ps(
+					    _mm256_mul_ps(px,
+					                  _mm256_set1_ps(plane.x)),
+					    _mm256_set1_ps(plane.w));
+					d = _mm256_add_ps(
+					    d, _mm256_mul_ps(
+					           py, _mm256_set1_ps(plane.y)));
+					d = _mm256_add_ps(
+					    d, _mm256_mul_ps(
+					           pz, _mm256_set1_ps(plane.z)));
+					inside = _mm256_and_ps(
+					    inside,
+					    _mm256_cmp_ps(d, negRadius, _CMP_GT_OQ));
+				}
+				mask |= static_cast<uint64_t>(
+				            _mm256_movemask_ps(inside))
+				        << i;
+			}
+			return mask;
+		}
+
+		AV_TARGET_AVX512 uint64_t CullBlockAvx512(
+		    const Frustum& frustum, const float* x,
+		    const float* y, const float* z,
+		    const float* radius)
+		{
+			constexpr auto block = CullingSet::BlockSize;
+			const auto& planes = frustum.planes;
+			uint64_t mask = 0;
+			for (uint32_t i = 0; i < block; i += 16)
+			{
+				const auto px = _mm512_loadu_ps(x + i);
+				const auto py = _mm512_loadu_ps(y + i);
+				const auto pz = _mm512_loadu_ps(z + i);
+				const auto negRadius = _mm512_sub_ps(
+				    _mm512_setzero_ps(),
+				    _mm512_loadu_ps(radius + i));
+				__mmask16 inside = 0xFFFF;
+				for (const auto& plane : planes)
+				{
+					// No FMA, so every kernel rounds alike.
+					auto d = _mm512_add_ps(
+					    _mm512_mul_ps(px,
+					                  _mm512_set1_ps(plane.x)),
+					    _mm512_set1_ps(plane.w));
+					d = _mm512_add_ps(
+					    d, _mm512_mul_ps(
+					           py, _mm512_set1_ps(plane.y)));
+					d = _mm512_add_ps(
+					    d, _mm512_mul_ps(
+					           pz, _mm512_set1_ps(plane.z)));
+					inside = _mm512_mask_cmp_ps_mask(
+					    inside, d, negRadius, _CMP_GT_OQ);
+				}
+				mask |= static_cast<uint64_t>(inside) << i;
+			}
+			return mask;
+		}
+#endif
+
+		using CullBlockFn = uint64_t (*)(const Frustum&,
+		                                 const float*,
+		                                 const float*,
+		                                 const float*,
+		                                 const float*);
+
+		CullBlockFn SelectCullBlock()
+		{
+			Core::Kernels<CullBlockFn> kernels;
+			kernels.baseline = CullBlockBaseline;
+#if defined(AV_CPU_X86)
+			kernels.avx2 = CullBlockAvx2;
+			kernels.avx512 = CullBlockAvx512;
+#endif
+			return Core::SelectKernel(kernels);
+		}
+
+		const CullBlockFn CullBlock = SelectCullBlock();
+	} // namespace
+
+	Frustum Frustum::FromMatrix(const float matrix[16])
+	{
+		// Row i of the column-major matrix.
+		const auto row = [matrix](int i) {
+			return Float4{matrix[i], matrix[4 + i],
+			              matrix[8 + i], matrix[12 + i]};
+		};
+		const auto w = row(3);
+		Frustum frustum;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const auto r = row(axis);
+			frustum.planes[axis * 2] = {w.x + r.x, w.y + r.y,
+			                            w.z + r.z, w.w + r.w};
+			frustum.planes[axis * 2 + 1] = {
+			    w.x - r.x, w.y - r.y, w.z - r.z, w.w - r.w};
+		}
+		for (auto& plane : frustum.planes)
+		{
+			const auto length =
+			    std::sqrt(plane.x * plane.x + plane.y * plane.y
+			              + plane.z * plane.z);
+			if (length > 0.0f)
+			{
+				plane = {plane.x / length, plane.y / length,
+				         plane.z / length, plane.w / length};
+			}
+		}
+		return frustum;
+	}
+
+	bool Frustum::Intersects(const BoundingSphere& sphere) const
+	{
+		const auto& c = sphere.center;
+		for (const auto& plane : planes)
+		{
+			if (plane.x * c.x + plane.y * c.y + plane.z * c.z
+			        + plane.w
+			    <= -sphere.radius)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	CullingSet::ObjectId
+	CullingSet::Add(const BoundingSphere& sphere)
+	{
+		ObjectId object;
+		if (!m_freeIds.empty())
+		{
+			object = m_freeIds.back();
+			m_freeIds.pop_back();
+		}
+		else
+		{
+			object = static_cast<ObjectId>(m_slots.size());
+			m_slots.push_back(NoSlot);
+		}
+
+		const auto slot = m_count++;
+		if (slot == m_x.size())
+		{
+			const auto padded = m_x.size() + BlockSize;
+			constexpr auto outside =
+			    -std::numeric_limits<float>::infinity();
+			m_x.resize(padded, 0.0f);
+			m_y.resize(padded, 0.0f);
+			m_z.resize(padded, 0.0f);
+			m_radius.resize(padded, outside);
+			m_objects.resize(padded, 0);
+		}
+		Store(slot, sphere);
+		m_objects[slot] = object;
+		m_slots[object] = slot;
+		return object;
+	}
+
+	void CullingSet::Update(ObjectId object,
+	                        const BoundingSphere& sphere)
+	{
+		VEGAM_ASSERT(object < m_slots.size()
+		                 && m_slots[object] != NoSlot,
+		             "Updating a removed culling object");
+		Store(m_slots[object], sphere);
+	}
+
+	void CullingSet::Remove(ObjectId object)
+	{
+		VEGAM_ASSERT(object < m_slots.size()
+		                 && m_slots[object] != NoSlot,
+		             "Removing a removed culling object");
+
+		// The last object fills the hole.
+		const auto slot = m_slots[object];
+		const auto last = --m_count;
+		m_x[slot] = m_x[last];
+		m_y[slot] = m_y[last];
+		m_z[slot] = m_z[last];
+		m_radius[slot] = m_radius[last];
+		m_objects[slot] = m_objects[last];
+		m_slots[m_objects[slot]] = slot;
+
+		m_radius[last] = -std::numeric_limits<float>::infinity();
+		m_slots[object] = NoSlot;
+		m_freeIds.push_back(object);
+	}
+
+	void CullingSet::Clear()
+	{
+		m_x.clear();
+		m_y.clear();
+		m_z.clear();
+		m_radius.clear();
+		m_count = 0;
+		m_objects.clear();
+		m_slots.clear();
+		m_freeIds.clear();
+	}
+
+	void CullingSet::Store(uint32_t slot,
+	                       const BoundingSphere& sphere)
+	{
+		m_x[slot] = sphere.center.x;
+		m_y[slot] = sphere.center.y;
+		m_z[slot] = sphere.center.z;
+		m_radius[slot] = sphere.radius;
+	}
+
+	void CullingSet::Cull(const Frustum& frustum,
+	                      std::vector<ObjectId>& visible,
+	                      Managers::JobManager* jobs,
+	                      const OcclusionBuffer* occlusion)
+	{
+		const auto blocks = (m_count + BlockSize - 1) / BlockSize;
+		m_masks.resize(blocks);
+
+		const auto cullBlock = [this, &frustum,
+		                        occlusion](uint32_t b) {
+			const auto first = b * BlockSize;
+			auto mask =
+			    CullBlock(frustum, &m_x[first], &m_y[first],
+			              &m_z[first], &m_radius[first]);
+			// Only what passed the frustum is rasterized
+			// against, so the dearer test runs least.
+			for (auto bits = occlusion ? mask : 0; bits != 0;
+			     bits &= bits - 1)
+			{
+				const auto bit = std::countr_zero(bits);
+				const auto slot = first + bit;
+				if (occlusion->IsOccluded(
+				        {{m_x[slot], m_y[slot], m_z[slot]},
+				         m_radius[slot]}))
+				{
+					mask &= ~(uint64_t{1} << bit);
+				}
+			}
+			m_masks[b] = mask;
+		};
+		if (jobs && blocks > BlocksPerJob)
+		{
+			jobs->ParallelFor(blocks, BlocksPerJob, cullBlock);
+		}
+		else
+		{
+			for (uint32_t b = 0; b < blocks; ++b)
+			{
+				cullBlock(b);
+			}
+		}
+
+		for (uint32_t b = 0; b < blocks; ++b)
+		{
+			for (auto mask = m_masks[b]; mask != 0;
+			     mask &= mask - 1)
+			{
+				visible.push_back(
+				    m_objects[b * BlockSize
+				              + std::countr_zero(mask)]);
+			}
+		}
+	}
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,295 @@
+#include "AthiVegam/Graphics/DebugDraw.h"
+
+#ifndef AV_CONFIG_RELEASE
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Graphics/CommandList.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Graphics/SortKey.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace AthiVegam::Graphics::DebugDraw
+{
+	namespace
+	{
+		static_assert(
+		    sizeof(LineInstance)
+		    == sizeof(RenderCommands::InstanceTransform));
+		static_assert(RenderCommands::InstanceTransformLocation
+		              == 4);
+
+		// Each instance's two ends from gl_VertexID.
+		const char* VertexSource = R"(#version 410 core
+layout(location = 4) in vec4 From;
+layout(location = 5) in vec4 To;
+layout(location = 6) in vec4 Color;
+
+layout(std140) uniform Constants
+{
+	mat4 ViewProjection;
+};
+
+out vec4 FragColor;
+
+void main()
+{
+	vec3 position = gl_VertexID == 0 ? From.xyz : To.xyz;
+	gl_Position = ViewProjection * vec4(position, 1);
+	FragColor = Color;
+}
+)";
+
+		const char* FragmentSource = R"(#version 410 core
+in vec4 FragColor;
+
+layout(location = 0) out vec4 OutColor;
+
+void main()
+{
+	OutColor = FragColor;
+}
+)";
+
+		constexpr float TwoPi = 6.28318531f;
+
+		// Written by its thread, read by Flush(); the lock
+		// is all but uncontended.
+		struct ThreadLines
+		{
+			std::mutex mutex;
+			std::vector<LineInstance> lines;
+		};
+
+		// Buffers outlive their threads, which keep a
+		// pointer to theirs.
+		std::mutex buffersMutex;
+		std::vector<std::unique_ptr<ThreadLines>> buffers;
+		thread_local ThreadLines* threadLines = nullptr;
+
+		std::unique_ptr<Shader> shader;
+		uint32_t vao = 0;
+		std::vector<LineInstance> gathered;
+		uint32_t lineCount = 0;
+
+		ThreadLines& GetThreadLines()
+		{
+			if (!threadLines)
+			{
+				std::lock_guard lock(buffersMutex);
+				auto& buffer = buffers.emplace_back(
+				    std::make_unique<ThreadLines>());
+				threadLines = buffer.get();
+			}
+			return *threadLines;
+		}
+
+		inline LineInstance MakeLine(const Math::Vec3& from,
+		                             const Math::Vec3& to,
+		                             const Color& color)
+		{
+			return {{from.x, from.y, from.z, 1.0f},
+			        {to.x, to.y, to.z, 1.0f},
+			        {color[0], color[1], color[2], color[3]},
+			        {}};
+		}
+
+		// The 12 edges of a box from its corners, indexed
+		// by x | y << 1 | z << 2.
+		void AddBoxEdges(const Math::Vec3 (&corners)[8],
+		                 const Color& color)
+		{
+			constexpr uint8_t edges[12][2] = {
+			    {0, 1}, {2, 3}, {4, 5}, {6, 7},
+			    {0, 2}, {1, 3}, {4, 6}, {5, 7},
+			    {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+			auto& buffer = GetThreadLines();
+			std::lock_guard lock(buffer.mutex);
+			for (const auto& edge : edges)
+			{
+				buffer.lines.push_back(MakeLine(
+				    corners[edge[0]], corners[edge[1]], color));
+			}
+		}
+	} // namespace
+
+	void Initialize()
+	{
+		shader = std::make_unique<Shader>(VertexSource,
+		                                  FragmentSource);
+		// No vertex attributes; instance attributes are
+		// pointed at the frame's data per draw.
+		glGenVertexArrays(1, &vao);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::VertexArray,
+		                       vao, 0, "Debug lines");
+	}
+
+	void Shutdown()
+	{
+		if (vao != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::VertexArray, vao);
+			glDeleteVertexArrays(1, &vao);
+			VEGAM_CHECK_GL_ERROR;
+			vao = 0;
+		}
+		shader.reset();
+
+		std::lock_guard lock(buffersMutex);
+		for (auto& buffer : buffers)
+		{
+			std::lock_guard bufferLock(buffer->mutex);
+			buffer->lines.clear();
+		}
+		gathered = {};
+	}
+
+	void Line(const Math::Vec3& from, const Math::Vec3& to,
+	          const Color& color)
+	{
+		auto& buffer = GetThreadLines();
+		std::lock_guard lock(buffer.mutex);
+		buffer.lines.push_back(MakeLine(from, to, color));
+	}
+
+	void Box(const Aabb& box, const Color& color)
+	{
+		Math::Vec3 corners[8];
+		for (uint32_t i = 0; i < 8; ++i)
+		{
+			corners[i] = {i & 1 ? box.max.x : box.min.x,
+			              i & 2 ? box.max.y : box.min.y,
+			              i & 4 ? box.max.z : box.min.z};
+		}
+		AddBoxEdges(corners, color);
+	}
+
+	void Box(const Math::Mat4& transform, const Color& color)
+	{
+		Math::Vec3 corners[8];
+		for (uint32_t i = 0; i < 8; ++i)
+		{
+			corners[i] = Math::TransformPoint(
+			    transform, {i & 1 ? 1.0f : -1.0f,
+			                i & 2 ? 1.0f : -1.0f,
+			                i & 4 ? 1.0f : -1.0f});
+		}
+		AddBoxEdges(corners, color);
+	}
+
+	void Sphere(const Math::Vec3& center, float radius,
+	            const Color& color, uint32_t segments)
+	{
+		segments = std::max(segments, 3u);
+		const auto point = [&](uint32_t axis, uint32_t i) {
+			const auto angle = TwoPi * static_cast<float>(i)
+			                   / static_cast<float>(segments);
+			const auto c = std::cos(angle) * radius;
+			const auto s = std::sin(angle) * radius;
+			const Math::Vec3 offsets[3] = {
+			    {0.0f, c, s}, {c, 0.0f, s}, {c, s, 0.0f}};
+			return center + offsets[axis];
+		};
+
+		auto& buffer = GetThreadLines();
+		std::lock_guard lock(buffer.mutex);
+		for (uint32_t axis = 0; axis < 3; ++axis)
+		{
+			for (uint32_t i = 0; i < segments; ++i)
+			{
+				buffer.lines.push_back(MakeLine(
+				    point(axis, i), point(axis, i + 1), color));
+			}
+		}
+	}
+
+	void Frustum(const Math::Mat4& viewProjection,
+	             const Color& color)
+	{
+		// Clip space corners back to world space.
+		const auto inverse = Math::Inverse(viewProjection);
+		Math::Vec3 corners[8];
+		for (uint32_t i = 0; i < 8; ++i)
+		{
+			const auto corner =
+			    inverse * Math::Vec4{i & 1 ? 1.0f : -1.0f,
+			                         i & 2 ? 1.0f : -1.0f,
+			                         i & 4 ? 1.0f : -1.0f,
+			                         1.0f};
+			const auto w =
+			    std::abs(corner.w) > 1e-6f ? corner.w : 1e-6f;
+			corners[i] = {corner.x / w, corner.y / w,
+			              corner.z / w};
+		}
+		AddBoxEdges(corners, color);
+	}
+
+	void Flush(const Math::Mat4& viewProjection,
+	           bool depthTest)
+	{
+		Flush(viewProjection,
+		      Engine::Instance()
+		          .GetRenderManager()
+		          .GetThreadCommandList(),
+		      depthTest);
+	}
+
+	void Flush(const Math::Mat4& viewProjection,
+	           CommandList& list, bool depthTest)
+	{
+		VEGAM_PROFILE_SCOPE("DebugDraw::Flush");
+		gathered.clear();
+		{
+			std::lock_guard lock(buffersMutex);
+			for (auto& buffer : buffers)
+			{
+				std::lock_guard bufferLock(buffer->mutex);
+				gathered.insert(gathered.end(),
+				                buffer->lines.begin(),
+				                buffer->lines.end());
+				buffer->lines.clear();
+			}
+		}
+		lineCount = static_cast<uint32_t>(gathered.size());
+		if (lineCount == 0 || !shader)
+		{
+			return;
+		}
+
+		RenderCommands::DrawLines command{};
+		command.program = shader->GetId();
+		command.vao = vao;
+		command.firstInstance = list.PushInstances(
+		    reinterpret_cast<
+		        const RenderCommands::InstanceTransform*>(
+		        gathered.data()),
+		    lineCount);
+		command.instanceCount = lineCount;
+		float constants[16];
+		viewProjection.Store(constants);
+		command.constants =
+		    list.PushConstants(constants, sizeof(constants));
+		command.depthTest = depthTest;
+		// Over everything else of the main viewport.
+		list.Submit(command,
+		            SortKey::Make(static_cast<uint8_t>(
+		                              SortKey::Mask(
+		                                  SortKey::LayerBits)),
+		                          true, 0, 0, 0));
+	}
+
+	uint32_t GetLineCount() { return lineCount; }
+} // namespace AthiVegam::Graphics::DebugDraw
+
+#endif // AV_CONFIG_RELEASE
@@ -0,0 +1,228 @@
+#include "AthiVegam/Graphics/DynamicResolution.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		int Scaled(int size, float scale)
+		{
+			const auto scaled = static_cast<int>(
+			    std::lround(static_cast<float>(size) * scale));
+			return std::max(scaled, 1);
+		}
+	} // namespace
+
+	DynamicResolution::DynamicResolution() = default;
+
+	DynamicResolution::DynamicResolution(
+	    const Settings& settings)
+	    : m_settings(settings), m_scale(settings.maxScale)
+	{
+		VEGAM_ASSERT(settings.minScale > 0.0f
+		                 && settings.minScale
+		                        <= settings.maxScale,
+		             "Invalid dynamic resolution scales");
+	}
+
+	DynamicResolution::~DynamicResolution()
+	{
+		VEGAM_ASSERT(m_queries[0] == 0,
+		             "DynamicResolution destroyed without "
+		             "Shutdown()");
+	}
+
+	void DynamicResolution::Shutdown()
+	{
+		if (m_queries[0] != 0)
+		{
+			if (m_timing)
+			{
+				glEndQuery(GL_TIME_ELAPSED);
+				VEGAM_CHECK_GL_ERROR;
+				m_timing = false;
+			}
+			glDeleteQueries(FrameLatency, m_queries.data());
+			VEGAM_CHECK_GL_ERROR;
+			m_queries.fill(0);
+			m_pending.fill(false);
+		}
+		m_target.Destroy();
+		m_displayWidth = 0;
+		m_displayHeight = 0;
+	}
+
+	void DynamicResolution::SetTargetMs(float targetMs)
+	{
+		m_settings.targetMs = targetMs;
+		m_spareFrames = 0;
+	}
+
+	bool DynamicResolution::BeginFrame(int displayWidth,
+	                                   int displayHeight)
+	{
+		VEGAM_PROFILE_SCOPE("DynamicResolution::BeginFrame");
+		if (m_queries[0] == 0)
+		{
+			glGenQueries(FrameLatency, m_queries.data());
+			VEGAM_CHECK_GL_ERROR;
+		}
+		if (!m_settings.externalTarget && m_target.GetId() == 0
+		    && !Resize(displayWidth, displayHeight))
+		{
+			return false;
+		}
+		m_displayWidth = displayWidth;
+		m_displayHeight = displayHeight;
+
+		ReadQueries();
+		m_renderWidth = Scaled(displayWidth, m_scale);
+		m_renderHeight = Scaled(displayHeight, m_scale);
+		if (!m_settings.externalTarget)
+		{
+			m_renderWidth =
+			    std::min(m_renderWidth, m_target.GetWidth());
+			m_renderHeight =
+			    std::min(m_renderHeight, m_target.GetHeight());
+		}
+
+		// A result still pending here is lost; the newer
+		// frames' stand in for it.
+		const auto index = m_frameIndex % FrameLatency;
+		glBeginQuery(GL_TIME_ELAPSED, m_queries[index]);
+		VEGAM_CHECK_GL_ERROR;
+		m_pending[index] = true;
+		m_timing = true;
+
+		if (!m_settings.externalTarget)
+		{
+			Bind();
+		}
+		return true;
+	}
+
+	bool DynamicResolution::Resize(int displayWidth,
+	                               int displayHeight)
+	{
+		if (m_settings.externalTarget)
+		{
+			return true;
+		}
+		return m_target.Create(
+		    Scaled(displayWidth, m_settings.maxScale),
+		    Scaled(displayHeight, m_settings.maxScale));
+	}
+
+	void DynamicResolution::Bind() const
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, m_target.GetId());
+		VEGAM_CHECK_GL_ERROR;
+		glViewport(0, 0, m_renderWidth, m_renderHeight);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void DynamicResolution::Resolve(uint32_t displayFramebuffer)
+	{
+		VEGAM_PROFILE_SCOPE("DynamicResolution::Resolve");
+		EndFrame();
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_target.GetId());
+		VEGAM_CHECK_GL_ERROR;
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER,
+		                  displayFramebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		// Linear filtering; the depth is not needed past
+		// the scene.
+		glBlitFramebuffer(0, 0, m_renderWidth, m_renderHeight,
+		                  0, 0, m_displayWidth, m_displayHeight,
+		                  GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		VEGAM_CHECK_GL_ERROR;
+		glBindFramebuffer(GL_FRAMEBUFFER, displayFramebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glViewport(0, 0, m_displayWidth, m_displayHeight);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void DynamicResolution::EndFrame()
+	{
+		if (m_timing)
+		{
+			glEndQuery(GL_TIME_ELAPSED);
+			VEGAM_CHECK_GL_ERROR;
+			m_timing = false;
+			++m_frameIndex;
+		}
+	}
+
+	void DynamicResolution::ReadQueries()
+	{
+		// Oldest first, so the newest finished result is
+		// the one kept.
+		bool measured = false;
+		GLuint64 elapsed = 0;
+		for (uint32_t i = 0; i < FrameLatency; ++i)
+		{
+			const auto index = (m_frameIndex + i) % FrameLatency;
+			if (!m_pending[index])
+			{
+				continue;
+			}
+			GLint available = 0;
+			glGetQueryObjectiv(m_queries[index],
+			                   GL_QUERY_RESULT_AVAILABLE,
+			                   &available);
+			VEGAM_CHECK_GL_ERROR;
+			if (!available)
+			{
+				// Later queries finish after this one.
+				break;
+			}
+			glGetQueryObjectui64v(m_queries[index],
+			                      GL_QUERY_RESULT, &elapsed);
+			VEGAM_CHECK_GL_ERROR;
+			m_pending[index] = false;
+			measured = true;
+		}
+		if (measured)
+		{
+			UpdateScale(static_cast<float>(elapsed) / 1e6f);
+		}
+	}
+
+	void DynamicResolution::UpdateScale(float gpuMs)
+	{
+		m_gpuMs = gpuMs;
+		// GPU time follows the pixel count, the square of
+		// the scale.
+		const auto budget =
+		    m_settings.targetMs * (1.0f - m_settings.headroom);
+		const auto ideal =
+		    m_scale * std::sqrt(budget / std::max(gpuMs, 0.01f));
+		const auto step = m_settings.step;
+		if (ideal < m_scale)
+		{
+			// Round down, to get under the budget.
+			m_scale = std::floor(ideal / step) * step;
+			m_spareFrames = 0;
+		}
+		else if (ideal >= m_scale + step
+		         && ++m_spareFrames >= m_settings.raiseFrames)
+		{
+			m_scale += step;
+			m_spareFrames = 0;
+		}
+		else if (ideal < m_scale + step)
+		{
+			m_spareFrames = 0;
+		}
+		m_scale = std::clamp(m_scale, m_settings.minScale,
+		                     m_settings.maxScale);
+	}
+} // namespace AthiVegam::Graphics
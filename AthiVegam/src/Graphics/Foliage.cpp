@@ -0,0 +1,712 @@
+#include "AthiVegam/Graphics/Foliage.h"
+
+#include "AthiVegam/Core/CVar.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/CommandList.h"
+#include "AthiVegam/Graphics/ComputeProgram.h"
+#include "AthiVegam/Graphics/Culling.h"
+#include "AthiVegam/Graphics/GpuProfiler.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/Mesh.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Managers/ResourceManager.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <string>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		Core::CVar<float> densityCVar(
+		    "r.foliageDensity", 1.0f,
+		    "Fraction of foliage instances drawn, 0 to 1");
+
+		constexpr uint32_t GroupSize = 64;
+		// Shader storage bindings of the passes, as
+		// GpuCulling's, which never runs at the same time.
+		constexpr uint32_t InstancesBinding = 3;
+		constexpr uint32_t CellsBinding = 4;
+		constexpr uint32_t VisibleBinding = 5;
+		constexpr uint32_t DrawsBinding = 6;
+
+		const char* CommonSource = R"(#version 430 core
+struct Draw
+{
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+layout(std430, binding = 6) buffer Draws
+{
+	Draw draws[];
+};
+
+uniform uint LevelCount;
+uniform uint MaxVisible;
+)";
+
+		// One invocation per stored instance, the cells
+		// along y.
+		const char* ScatterSource = R"(
+layout(local_size_x = 64) in;
+
+// Origin (x, minimum height, z, height range), and
+// first instance, count and seed.
+struct Cell
+{
+	vec4 origin;
+	uvec4 range;
+};
+
+// x and z in the low and high half of the first word;
+// height, yaw and scale in the second's 16, 8 and 8
+// bits.
+layout(std430, binding = 3) readonly buffer Instances
+{
+	uvec2 instances[];
+};
+layout(std430, binding = 4) readonly buffer Cells
+{
+	Cell cells[];
+};
+layout(std430, binding = 5) writeonly buffer Visible
+{
+	mat4 visible[];
+};
+
+uniform vec4 Planes[6];
+uniform vec3 Eye;
+// Mesh-space bounds of the first level's mesh.
+uniform vec4 Sphere;
+uniform vec4 Distances;
+uniform float CellSize;
+// Minimum scale and range.
+uniform vec2 Scales;
+// Instances whose rank is below it are kept, of 65536.
+uniform uint Density;
+
+uint Hash(uint x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+void main()
+{
+	Cell cell = cells[gl_WorkGroupID.y];
+	uint index = gl_GlobalInvocationID.x;
+	if (index >= cell.range.y
+	    || (Hash(index ^ cell.range.z) & 0xFFFFu) >= Density)
+	{
+		return;
+	}
+
+	uvec2 packed = instances[cell.range.x + index];
+	vec3 position =
+	    cell.origin.xyz
+	    + vec3(float(packed.x & 0xFFFFu) * CellSize,
+	           float(packed.y & 0xFFFFu) * cell.origin.w,
+	           float(packed.x >> 16) * CellSize)
+	          / 65535.0;
+	float yaw = float((packed.y >> 16) & 0xFFu)
+	            * (6.28318530718 / 256.0);
+	float scale =
+	    Scales.x + float(packed.y >> 24) / 255.0 * Scales.y;
+	float c = cos(yaw) * scale;
+	float s = sin(yaw) * scale;
+	mat4 m = mat4(vec4(c, 0.0, -s, 0.0),
+	              vec4(0.0, scale, 0.0, 0.0),
+	              vec4(s, 0.0, c, 0.0),
+	              vec4(position, 1.0));
+
+	vec3 center = (m * vec4(Sphere.xyz, 1.0)).xyz;
+	float radius = Sphere.w * scale;
+	for (int i = 0; i < 6; ++i)
+	{
+		if (dot(Planes[i].xyz, center) + Planes[i].w
+		    <= -radius)
+		{
+			return;
+		}
+	}
+	float distance = length(center - Eye);
+	uint level = 0;
+	while (level < LevelCount && distance >= Distances[level])
+	{
+		++level;
+	}
+	if (level == LevelCount)
+	{
+		return;
+	}
+
+	uint slot = atomicAdd(draws[level].instanceCount, 1u);
+	if (slot < MaxVisible)
+	{
+		visible[level * MaxVisible + slot] = m;
+	}
+}
+)";
+
+		// Drops the appends past a level's slice.
+		const char* ClampSource = R"(
+layout(local_size_x = 4) in;
+
+void main()
+{
+	uint level = gl_LocalInvocationID.x;
+	if (level < LevelCount)
+	{
+		draws[level].instanceCount =
+		    min(draws[level].instanceCount, MaxVisible);
+	}
+}
+)";
+
+		// Mirrors the Cell struct of the scatter pass.
+		struct CellData
+		{
+			float origin[4];
+			uint32_t range[4];
+		};
+
+		inline GLint Location(uint32_t program,
+		                      const char* name)
+		{
+			const auto location =
+			    glGetUniformLocation(program, name);
+			VEGAM_CHECK_GL_ERROR;
+			return location;
+		}
+
+		inline uint32_t Unorm(float value, float scale)
+		{
+			return static_cast<uint32_t>(std::lround(
+			    std::clamp(value, 0.0f, 1.0f) * scale));
+		}
+
+		uint32_t CreateBuffer(GLenum target, size_t size,
+		                      GLenum usage, const char* label)
+		{
+			uint32_t buffer = 0;
+			glGenBuffers(1, &buffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBindBuffer(target, buffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBufferData(target, static_cast<GLsizeiptr>(size),
+			             nullptr, usage);
+			VEGAM_CHECK_GL_ERROR;
+			glBindBuffer(target, 0);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(GpuResources::Type::Buffer,
+			                       buffer, size, label);
+			return buffer;
+		}
+
+		void DeleteBuffer(uint32_t& buffer)
+		{
+			if (buffer == 0)
+			{
+				return;
+			}
+			GpuResources::Unregister(GpuResources::Type::Buffer,
+			                         buffer);
+			glDeleteBuffers(1, &buffer);
+			VEGAM_CHECK_GL_ERROR;
+			buffer = 0;
+		}
+	} // namespace
+
+	Foliage::Foliage(const Settings& settings)
+	    : m_settings(settings)
+	{
+		VEGAM_ASSERT(settings.cellSize > 0.0f,
+		             "Foliage cell size must be positive");
+		VEGAM_ASSERT(settings.maxCells > 0
+		                 && settings.cellCapacity > 0
+		                 && settings.maxVisible > 0,
+		             "Foliage needs room for instances");
+		VEGAM_ASSERT(settings.maxScale >= settings.minScale,
+		             "Invalid foliage scale range");
+		VEGAM_ASSERT(settings.levels[0].mesh.IsValid(),
+		             "Foliage needs a mesh");
+		for (uint32_t level = 1; level < GetLevelCount();
+		     ++level)
+		{
+			VEGAM_ASSERT(settings.levels[level].distance
+			                 > settings.levels[level - 1]
+			                       .distance,
+			             "Foliage level distances must "
+			             "increase");
+		}
+	}
+
+	Foliage::~Foliage()
+	{
+		VEGAM_ASSERT(!IsInitialized(),
+		             "Foliage destroyed without Shutdown()");
+	}
+
+	bool Foliage::Initialize()
+	{
+		if (IsInitialized())
+		{
+			return true;
+		}
+		if (!GLAD_GL_VERSION_4_3)
+		{
+			VEGAM_WARN("Foliage needs a GL 4.3 context");
+			return false;
+		}
+
+		const auto common = std::string(CommonSource);
+		m_clampProgram = CreateComputeProgram(
+		    (common + ClampSource).c_str(), "Foliage clamp");
+		if (!m_clampProgram)
+		{
+			return false;
+		}
+		m_scatterProgram = CreateComputeProgram(
+		    (common + ScatterSource).c_str(),
+		    "Foliage scatter");
+		if (!m_scatterProgram)
+		{
+			DeleteComputeProgram(m_clampProgram);
+			return false;
+		}
+
+		const auto slots = size_t{m_settings.maxCells}
+		                   * m_settings.cellCapacity;
+		m_instanceBuffer = CreateBuffer(
+		    GL_SHADER_STORAGE_BUFFER,
+		    slots * 2 * sizeof(uint32_t), GL_DYNAMIC_DRAW,
+		    "Foliage instances");
+		m_visibleBuffer = CreateBuffer(
+		    GL_SHADER_STORAGE_BUFFER,
+		    size_t{MaxLevels} * m_settings.maxVisible
+		        * sizeof(RenderCommands::InstanceTransform),
+		    GL_DYNAMIC_COPY, "Foliage visible instances");
+		m_argsBuffer = CreateBuffer(
+		    GL_DRAW_INDIRECT_BUFFER,
+		    MaxLevels
+		        * sizeof(RenderCommands::DrawElementsIndirect),
+		    GL_DYNAMIC_DRAW, "Foliage draws");
+		m_cellBuffer = CreateBuffer(GL_SHADER_STORAGE_BUFFER, 0,
+		                            GL_STREAM_DRAW,
+		                            "Foliage cells");
+		m_cellBufferSize = 0;
+
+		m_freeSlots.resize(m_settings.maxCells);
+		for (uint32_t i = 0; i < m_settings.maxCells; ++i)
+		{
+			m_freeSlots[i] = m_settings.maxCells - 1 - i;
+		}
+		m_cells.clear();
+		m_ready = {};
+		VEGAM_INFO("Foliage of {} cells of {} instances",
+		           m_settings.maxCells, m_settings.cellCapacity);
+		return true;
+	}
+
+	void Foliage::Shutdown()
+	{
+		DeleteComputeProgram(m_scatterProgram);
+		DeleteComputeProgram(m_clampProgram);
+		DeleteBuffer(m_instanceBuffer);
+		DeleteBuffer(m_visibleBuffer);
+		DeleteBuffer(m_argsBuffer);
+		DeleteBuffer(m_cellBuffer);
+		m_cellBufferSize = 0;
+		m_cells.clear();
+		m_freeSlots.clear();
+		m_staging = {};
+		m_ready = {};
+	}
+
+	uint64_t Foliage::Key(int32_t x, int32_t y)
+	{
+		return (uint64_t{static_cast<uint32_t>(x)} << 32)
+		       | static_cast<uint32_t>(y);
+	}
+
+	uint32_t Foliage::GetLevelCount() const
+	{
+		uint32_t count = 0;
+		while (count < MaxLevels
+		       && m_settings.levels[count].mesh.IsValid())
+		{
+			++count;
+		}
+		return count;
+	}
+
+	bool Foliage::SetCell(
+	    int32_t x, int32_t y,
+	    std::span<const FoliageInstance> instances)
+	{
+		if (!IsInitialized())
+		{
+			return false;
+		}
+		auto it = m_cells.find(Key(x, y));
+		if (it == m_cells.end())
+		{
+			if (m_freeSlots.empty())
+			{
+				VEGAM_WARN("No free foliage cell for ({}, {})",
+				           x, y);
+				return false;
+			}
+			const auto slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+			it = m_cells.emplace(Key(x, y),
+			                     Cell{x, y, slot, 0, 0.0f, 0.0f})
+			         .first;
+		}
+		auto& cell = it->second;
+
+		const auto capacity = m_settings.cellCapacity;
+		if (instances.size() > capacity)
+		{
+			VEGAM_WARN("Foliage cell ({}, {}) drops {} of {} "
+			           "instances",
+			           x, y, instances.size() - capacity,
+			           instances.size());
+			instances = instances.first(capacity);
+		}
+		cell.count = static_cast<uint32_t>(instances.size());
+		if (instances.empty())
+		{
+			return true;
+		}
+
+		cell.minY = instances[0].position.y;
+		cell.maxY = cell.minY;
+		for (const auto& instance : instances)
+		{
+			cell.minY = std::min(cell.minY, instance.position.y);
+			cell.maxY = std::max(cell.maxY, instance.position.y);
+		}
+
+		const auto size = m_settings.cellSize;
+		const auto originX = static_cast<float>(x) * size;
+		const auto originZ = static_cast<float>(y) * size;
+		const auto height = cell.maxY - cell.minY;
+		const auto scales =
+		    m_settings.maxScale - m_settings.minScale;
+		constexpr auto Turn = 2.0f * std::numbers::pi_v<float>;
+		m_staging.resize(instances.size() * 2);
+		auto* packed = m_staging.data();
+		for (const auto& instance : instances)
+		{
+			const auto& position = instance.position;
+			const auto turns = instance.yaw / Turn;
+			const auto yaw =
+			    static_cast<uint32_t>(std::lround(
+			        (turns - std::floor(turns)) * 256.0f))
+			    & 0xFFu;
+			packed[0] =
+			    Unorm((position.x - originX) / size, 65535.0f)
+			    | Unorm((position.z - originZ) / size, 65535.0f)
+			          << 16;
+			packed[1] =
+			    (height > 0.0f
+			         ? Unorm((position.y - cell.minY) / height,
+			                 65535.0f)
+			         : 0u)
+			    | yaw << 16
+			    | (scales > 0.0f
+			           ? Unorm((instance.scale
+			                    - m_settings.minScale)
+			                       / scales,
+			                   255.0f)
+			           : 0u)
+			          << 24;
+			packed += 2;
+		}
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_instanceBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBufferSubData(
+		    GL_SHADER_STORAGE_BUFFER,
+		    static_cast<GLintptr>(size_t{cell.slot} * capacity
+		                          * 2 * sizeof(uint32_t)),
+		    static_cast<GLsizeiptr>(m_staging.size()
+		                            * sizeof(uint32_t)),
+		    m_staging.data());
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		return true;
+	}
+
+	void Foliage::RemoveCell(int32_t x, int32_t y)
+	{
+		const auto it = m_cells.find(Key(x, y));
+		if (it == m_cells.end())
+		{
+			return;
+		}
+		m_freeSlots.push_back(it->second.slot);
+		m_cells.erase(it);
+	}
+
+	void Foliage::Clear()
+	{
+		for (const auto& [key, cell] : m_cells)
+		{
+			m_freeSlots.push_back(cell.slot);
+		}
+		m_cells.clear();
+	}
+
+	void Foliage::Cull(
+	    const Managers::ResourceManager& resources,
+	    const float viewProjection[16], const Float3& eye)
+	{
+		if (!IsInitialized())
+		{
+			return;
+		}
+		VEGAM_PROFILE_SCOPE("Foliage::Cull");
+		VEGAM_PROFILE_GPU_SCOPE("Foliage");
+
+		// Every level's count starts at 0 for the pass to
+		// append to.
+		const auto levels = GetLevelCount();
+		if (levels == 0)
+		{
+			return;
+		}
+		RenderCommands::DrawElementsIndirect
+		    draws[MaxLevels]{};
+		m_ready = {};
+		for (uint32_t level = 0; level < levels; ++level)
+		{
+			const auto* mesh =
+			    resources.GetMesh(m_settings.levels[level].mesh);
+			if (!mesh || !mesh->IsReady()
+			    || mesh->GetElementCount() == 0)
+			{
+				continue;
+			}
+			if (level == 0)
+			{
+				m_bounds = mesh->GetBounds().GetSphere();
+			}
+			draws[level].count = mesh->GetElementCount();
+			draws[level].firstIndex = mesh->GetFirstIndex();
+			draws[level].baseVertex =
+			    static_cast<int32_t>(mesh->GetBaseVertex());
+			m_ready[level] = true;
+		}
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_argsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0,
+		                sizeof(draws), draws);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		// Cells whose box, grown by the largest instance,
+		// is in the frustum and within the last level's
+		// distance.
+		const auto frustum = Frustum::FromMatrix(viewProjection);
+		const auto size = m_settings.cellSize;
+		const auto reach = m_settings.levels[levels - 1].distance;
+		const auto& center = m_bounds.center;
+		const auto grow =
+		    (m_bounds.radius
+		     + std::sqrt(center.x * center.x
+		                 + center.y * center.y
+		                 + center.z * center.z))
+		    * m_settings.maxScale;
+		std::vector<CellData> visible;
+		uint32_t largest = 0;
+		for (const auto& [key, cell] : m_cells)
+		{
+			if (cell.count == 0)
+			{
+				continue;
+			}
+			const auto half = 0.5f * size;
+			const auto halfHeight =
+			    0.5f * (cell.maxY - cell.minY);
+			BoundingSphere sphere;
+			sphere.center = {static_cast<float>(cell.x) * size
+			                     + half,
+			                 cell.minY + halfHeight,
+			                 static_cast<float>(cell.y) * size
+			                     + half};
+			sphere.radius =
+			    std::sqrt(2.0f * half * half
+			              + halfHeight * halfHeight)
+			    + grow;
+			const auto dx = sphere.center.x - eye.x;
+			const auto dy = sphere.center.y - eye.y;
+			const auto dz = sphere.center.z - eye.z;
+			if (std::sqrt(dx * dx + dy * dy + dz * dz)
+			        - sphere.radius
+			        >= reach
+			    || !frustum.Intersects(sphere))
+			{
+				continue;
+			}
+			CellData data;
+			data.origin[0] = static_cast<float>(cell.x) * size;
+			data.origin[1] = cell.minY;
+			data.origin[2] = static_cast<float>(cell.y) * size;
+			data.origin[3] = cell.maxY - cell.minY;
+			data.range[0] = cell.slot * m_settings.cellCapacity;
+			data.range[1] = cell.count;
+			data.range[2] = static_cast<uint32_t>(
+			    key ^ (key >> 32) ^ 0x9E3779B9u);
+			data.range[3] = 0;
+			visible.push_back(data);
+			largest = std::max(largest, cell.count);
+		}
+		if (visible.empty())
+		{
+			return;
+		}
+
+		const auto bytes = visible.size() * sizeof(CellData);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_cellBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		if (bytes > m_cellBufferSize)
+		{
+			m_cellBufferSize = bytes * 2;
+			glBufferData(
+			    GL_SHADER_STORAGE_BUFFER,
+			    static_cast<GLsizeiptr>(m_cellBufferSize),
+			    nullptr, GL_STREAM_DRAW);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Resize(GpuResources::Type::Buffer,
+			                     m_cellBuffer, m_cellBufferSize);
+		}
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
+		                static_cast<GLsizeiptr>(bytes),
+		                visible.data());
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+		                 InstancesBinding, m_instanceBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CellsBinding,
+		                 m_cellBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+		                 VisibleBinding, m_visibleBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DrawsBinding,
+		                 m_argsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+
+		float distances[MaxLevels] = {};
+		for (uint32_t level = 0; level < levels; ++level)
+		{
+			distances[level] = m_settings.levels[level].distance;
+		}
+		const auto density =
+		    std::clamp(densityCVar.Get(), 0.0f, 1.0f);
+		for (const auto program :
+		     {m_scatterProgram, m_clampProgram})
+		{
+			glProgramUniform1ui(program,
+			                    Location(program, "LevelCount"),
+			                    levels);
+			VEGAM_CHECK_GL_ERROR;
+			glProgramUniform1ui(program,
+			                    Location(program, "MaxVisible"),
+			                    m_settings.maxVisible);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		const auto program = m_scatterProgram;
+		glProgramUniform4fv(program, Location(program, "Planes"),
+		                    6, &frustum.planes[0].x);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform3f(program, Location(program, "Eye"),
+		                   eye.x, eye.y, eye.z);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform4f(program, Location(program, "Sphere"),
+		                   center.x, center.y, center.z,
+		                   m_bounds.radius);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform4fv(program,
+		                    Location(program, "Distances"), 1,
+		                    distances);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1f(program,
+		                   Location(program, "CellSize"), size);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform2f(
+		    program, Location(program, "Scales"),
+		    m_settings.minScale,
+		    m_settings.maxScale - m_settings.minScale);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1ui(
+		    program, Location(program, "Density"),
+		    static_cast<uint32_t>(density * 65536.0f));
+		VEGAM_CHECK_GL_ERROR;
+
+		Shader::UseProgram(program);
+		glDispatchCompute((largest + GroupSize - 1) / GroupSize,
+		                  static_cast<GLuint>(visible.size()), 1);
+		VEGAM_CHECK_GL_ERROR;
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		VEGAM_CHECK_GL_ERROR;
+		Shader::UseProgram(m_clampProgram);
+		glDispatchCompute(1, 1, 1);
+		VEGAM_CHECK_GL_ERROR;
+		// The draws read the counts as indirect commands
+		// and the transforms as instance attributes.
+		glMemoryBarrier(GL_COMMAND_BARRIER_BIT
+		                | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Foliage::Draw(CommandList& list,
+	                   RenderCommands::Constants constants) const
+	{
+		if (!IsInitialized())
+		{
+			return;
+		}
+		for (uint32_t level = 0; level < GetLevelCount();
+		     ++level)
+		{
+			if (!m_ready[level])
+			{
+				continue;
+			}
+			RenderCommands::DrawFoliage command{};
+			command.mesh = m_settings.levels[level].mesh;
+			command.shader = m_settings.shader;
+			command.constants = constants;
+			command.material = m_settings.material;
+			command.instanceBuffer = m_visibleBuffer;
+			command.firstInstance =
+			    level * m_settings.maxVisible;
+			command.argsBuffer = m_argsBuffer;
+			command.argsOffset = static_cast<uint32_t>(
+			    level
+			    * sizeof(RenderCommands::DrawElementsIndirect));
+			list.Submit(command);
+		}
+	}
+} // namespace AthiVegam::Graphics
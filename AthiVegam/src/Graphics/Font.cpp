@@ -0,0 +1,493 @@
+#include "AthiVegam/Graphics/Font.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Graphics/SpriteBatch.h"
+#include "AthiVegam/Graphics/Texture.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// ImGui compiles its copy static to imgui_draw.cpp.
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "external/imgui/imstb_truetype.h"
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		// Distance field value on the glyph's outline.
+		constexpr unsigned char EdgeValue = 128;
+		constexpr char32_t Replacement = 0xFFFD;
+
+		// The code point at text[pos], advancing pos;
+		// malformed sequences decode as U+FFFD.
+		char32_t DecodeUtf8(std::string_view text, size_t& pos)
+		{
+			const auto lead =
+			    static_cast<unsigned char>(text[pos++]);
+			if (lead < 0x80)
+			{
+				return lead;
+			}
+			uint32_t length = 0;
+			char32_t codepoint = 0;
+			if ((lead & 0xE0) == 0xC0)
+			{
+				length = 1;
+				codepoint = lead & 0x1F;
+			}
+			else if ((lead & 0xF0) == 0xE0)
+			{
+				length = 2;
+				codepoint = lead & 0x0F;
+			}
+			else if ((lead & 0xF8) == 0xF0)
+			{
+				length = 3;
+				codepoint = lead & 0x07;
+			}
+			else
+			{
+				return Replacement;
+			}
+			for (uint32_t i = 0; i < length; ++i)
+			{
+				if (pos >= text.size()
+				    || (static_cast<unsigned char>(text[pos])
+				        & 0xC0)
+				           != 0x80)
+				{
+					return Replacement;
+				}
+				codepoint =
+				    (codepoint << 6)
+				    | (static_cast<unsigned char>(text[pos++])
+				       & 0x3F);
+			}
+			return codepoint;
+		}
+	} // namespace
+
+	struct Font::FontInfo
+	{
+		stbtt_fontinfo info{};
+	};
+
+	Font::Font() : Font(Settings{}) {}
+
+	Font::Font(const Settings& settings) : m_settings(settings)
+	{
+	}
+
+	Font::~Font()
+	{
+		VEGAM_ASSERT(!m_atlas.IsValid(),
+		             "Font destroyed without Unload()");
+	}
+
+	bool Font::Load(std::vector<uint8_t> data)
+	{
+		VEGAM_ASSERT(!m_atlas.IsValid(), "Font loaded twice");
+		m_data = std::move(data);
+		m_info = std::make_unique<FontInfo>();
+		auto* info = &m_info->info;
+		const auto offset =
+		    stbtt_GetFontOffsetForIndex(m_data.data(), 0);
+		if (m_data.empty() || offset < 0
+		    || !stbtt_InitFont(info, m_data.data(), offset))
+		{
+			VEGAM_ERROR("Font data is not a TrueType font");
+			m_info.reset();
+			m_data.clear();
+			return false;
+		}
+
+		const auto glyphSize =
+		    static_cast<float>(m_settings.glyphSize);
+		m_scale = stbtt_ScaleForPixelHeight(info, glyphSize);
+		int ascent = 0;
+		int descent = 0;
+		int lineGap = 0;
+		stbtt_GetFontVMetrics(info, &ascent, &descent,
+		                      &lineGap);
+		m_lineGap =
+		    static_cast<float>(ascent - descent + lineGap)
+		    * m_scale / glyphSize;
+
+		m_cellSize =
+		    m_settings.glyphSize + m_settings.padding * 2;
+		m_cellsPerRow = m_settings.atlasSize / m_cellSize;
+		VEGAM_ASSERT(m_cellsPerRow > 0,
+		             "Font atlas smaller than a glyph");
+		m_cells.assign(size_t{m_cellsPerRow} * m_cellsPerRow,
+		               Cell{});
+		m_head = NoCell;
+		m_tail = NoCell;
+		m_nextFree = 0;
+		m_cellPixels.resize(size_t{m_cellSize} * m_cellSize);
+		m_glyphs.clear();
+		m_warnedFull = false;
+
+		TextureDesc desc;
+		desc.width = m_settings.atlasSize;
+		desc.height = m_settings.atlasSize;
+		desc.format = TextureFormat::R8;
+		desc.wrap = TextureWrap::Clamp;
+		auto& resources =
+		    Engine::Instance().GetResourceManager();
+		m_atlas = resources.CreateTexture(desc);
+		auto* atlas = resources.GetTexture(m_atlas);
+		if (!atlas)
+		{
+			Unload();
+			return false;
+		}
+		// Cleared, so the atlas samples as ready.
+		const std::vector<uint8_t> empty(
+		    atlas->GetLevelSize(0), 0);
+		atlas->UploadLevel(0, empty.data());
+		return true;
+	}
+
+	bool Font::LoadFile(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			VEGAM_ERROR("Error opening {}", path);
+			return false;
+		}
+		std::vector<uint8_t> data(
+		    (std::istreambuf_iterator<char>(file)),
+		    std::istreambuf_iterator<char>());
+		return Load(std::move(data));
+	}
+
+	void Font::Unload()
+	{
+		if (m_atlas.IsValid())
+		{
+			Engine::Instance()
+			    .GetResourceManager()
+			    .DestroyTexture(m_atlas);
+			m_atlas = {};
+		}
+		m_info.reset();
+		m_data.clear();
+		m_cells.clear();
+		m_glyphs.clear();
+		m_head = NoCell;
+		m_tail = NoCell;
+		m_nextFree = 0;
+	}
+
+	void Font::NewFrame()
+	{
+		++m_frame;
+		m_warnedFull = false;
+	}
+
+	void Font::Preload(std::string_view text)
+	{
+		VEGAM_PROFILE_SCOPE("Font::Preload");
+		size_t pos = 0;
+		while (pos < text.size())
+		{
+			GetGlyph(DecodeUtf8(text, pos));
+		}
+	}
+
+	const Font::Glyph* Font::GetGlyph(char32_t codepoint)
+	{
+		if (!m_info)
+		{
+			return nullptr;
+		}
+		const auto found = m_glyphs.find(codepoint);
+		if (found == m_glyphs.end())
+		{
+			return Rasterize(codepoint);
+		}
+		if (found->second.cell != NoCell)
+		{
+			Touch(found->second.cell);
+		}
+		return &found->second;
+	}
+
+	const Font::Glyph* Font::Rasterize(char32_t codepoint)
+	{
+		VEGAM_PROFILE_SCOPE("Font::Rasterize");
+		const auto* info = &m_info->info;
+		const auto glyphSize =
+		    static_cast<float>(m_settings.glyphSize);
+		Glyph glyph;
+		glyph.index = stbtt_FindGlyphIndex(
+		    info, static_cast<int>(codepoint));
+		glyph.cell = NoCell;
+		int advance = 0;
+		int bearing = 0;
+		stbtt_GetGlyphHMetrics(info, glyph.index, &advance,
+		                       &bearing);
+		glyph.advance =
+		    static_cast<float>(advance) * m_scale / glyphSize;
+
+		const auto padding =
+		    static_cast<int>(m_settings.padding);
+		int width = 0;
+		int height = 0;
+		int left = 0;
+		int top = 0;
+		auto* bitmap = stbtt_GetGlyphSDF(
+		    info, m_scale, glyph.index, padding, EdgeValue,
+		    static_cast<float>(EdgeValue)
+		        / static_cast<float>(std::max(padding, 1)),
+		    &width, &height, &left, &top);
+		if (!bitmap)
+		{
+			// Nothing to draw, only the advance.
+			return &m_glyphs.emplace(codepoint, glyph)
+			            .first->second;
+		}
+		const auto cellSize = static_cast<int>(m_cellSize);
+		if (width > cellSize || height > cellSize)
+		{
+			VEGAM_WARN("Glyph U+{:04X} of {}x{} does not fit "
+			           "a {} texel font cell",
+			           static_cast<uint32_t>(codepoint), width,
+			           height, m_cellSize);
+			stbtt_FreeSDF(bitmap, nullptr);
+			return &m_glyphs.emplace(codepoint, glyph)
+			            .first->second;
+		}
+
+		const auto cell = AcquireCell();
+		if (cell == NoCell)
+		{
+			stbtt_FreeSDF(bitmap, nullptr);
+			if (!m_warnedFull)
+			{
+				VEGAM_WARN("Font atlas full with glyphs of "
+				           "this frame; skipping U+{:04X}",
+				           static_cast<uint32_t>(codepoint));
+				m_warnedFull = true;
+			}
+			return nullptr;
+		}
+
+		// The whole cell, so nothing of the glyph it held
+		// filters in at the edges.
+		std::fill(m_cellPixels.begin(), m_cellPixels.end(),
+		          uint8_t{0});
+		for (int row = 0; row < height; ++row)
+		{
+			std::memcpy(&m_cellPixels[size_t(row) * m_cellSize],
+			            bitmap + size_t(row) * width,
+			            static_cast<size_t>(width));
+		}
+		stbtt_FreeSDF(bitmap, nullptr);
+		const auto cellX = (cell % m_cellsPerRow) * m_cellSize;
+		const auto cellY = (cell / m_cellsPerRow) * m_cellSize;
+		auto* atlas =
+		    Engine::Instance().GetResourceManager().GetTexture(
+		        m_atlas);
+		atlas->UploadRegion(0, cellX, cellY, m_cellSize,
+		                    m_cellSize, m_cellPixels.data());
+
+		// Rows run top-down from the cell's first texel
+		// row, so v flips.
+		const auto atlasSize =
+		    static_cast<float>(m_settings.atlasSize);
+		glyph.cell = cell;
+		glyph.x = static_cast<float>(left) / glyphSize;
+		glyph.y = -static_cast<float>(top + height) / glyphSize;
+		glyph.width = static_cast<float>(width) / glyphSize;
+		glyph.height = static_cast<float>(height) / glyphSize;
+		glyph.u0 = static_cast<float>(cellX) / atlasSize;
+		glyph.u1 =
+		    static_cast<float>(cellX + width) / atlasSize;
+		glyph.v0 =
+		    static_cast<float>(cellY + height) / atlasSize;
+		glyph.v1 = static_cast<float>(cellY) / atlasSize;
+		m_cells[cell].codepoint = codepoint;
+		return &m_glyphs.emplace(codepoint, glyph).first->second;
+	}
+
+	uint32_t Font::AcquireCell()
+	{
+		uint32_t cell = NoCell;
+		if (m_nextFree < m_cells.size())
+		{
+			cell = m_nextFree++;
+			PushFront(cell);
+		}
+		else if (m_tail != NoCell
+		         && m_cells[m_tail].lastUsed != m_frame)
+		{
+			cell = m_tail;
+			m_glyphs.erase(m_cells[cell].codepoint);
+			++m_evictions;
+		}
+		if (cell != NoCell)
+		{
+			Touch(cell);
+		}
+		return cell;
+	}
+
+	void Font::Touch(uint32_t cell)
+	{
+		m_cells[cell].lastUsed = m_frame;
+		if (m_head != cell)
+		{
+			Unlink(cell);
+			PushFront(cell);
+		}
+	}
+
+	void Font::Unlink(uint32_t cell)
+	{
+		auto& data = m_cells[cell];
+		if (data.previous != NoCell)
+		{
+			m_cells[data.previous].next = data.next;
+		}
+		else
+		{
+			m_head = data.next;
+		}
+		if (data.next != NoCell)
+		{
+			m_cells[data.next].previous = data.previous;
+		}
+		else
+		{
+			m_tail = data.previous;
+		}
+		data.previous = NoCell;
+		data.next = NoCell;
+	}
+
+	void Font::PushFront(uint32_t cell)
+	{
+		auto& data = m_cells[cell];
+		data.previous = NoCell;
+		data.next = m_head;
+		if (m_head != NoCell)
+		{
+			m_cells[m_head].previous = cell;
+		}
+		m_head = cell;
+		if (m_tail == NoCell)
+		{
+			m_tail = cell;
+		}
+	}
+
+	float Font::Draw(SpriteBatch& batch, std::string_view text,
+	                 float x, float y, const TextStyle& style)
+	{
+		return Layout(text, style, x, y, &batch);
+	}
+
+	float Font::Measure(std::string_view text, float size)
+	{
+		TextStyle style;
+		style.size = size;
+		return Layout(text, style, 0.0f, 0.0f, nullptr);
+	}
+
+	float Font::Layout(std::string_view text,
+	                   const TextStyle& style, float x, float y,
+	                   SpriteBatch* batch)
+	{
+		if (!m_info)
+		{
+			return 0.0f;
+		}
+		const auto* info = &m_info->info;
+		const auto size = style.size;
+		const auto kernScale =
+		    m_scale / static_cast<float>(m_settings.glyphSize);
+
+		Sprite sprite;
+		sprite.originX = 0.0f;
+		sprite.originY = 0.0f;
+		sprite.color = style.color;
+		sprite.texture = m_atlas;
+		sprite.layer = style.layer;
+		sprite.distanceField = true;
+
+		auto penX = x;
+		auto penY = y;
+		auto widest = 0.0f;
+		auto previous = -1;
+		size_t pos = 0;
+		while (pos < text.size())
+		{
+			const auto codepoint = DecodeUtf8(text, pos);
+			if (codepoint == '\n')
+			{
+				widest = std::max(widest, penX - x);
+				penX = x;
+				penY -= m_lineGap * size;
+				previous = -1;
+				continue;
+			}
+
+			// Measuring needs the metrics alone.
+			const Glyph* glyph = nullptr;
+			Glyph metrics;
+			if (batch)
+			{
+				glyph = GetGlyph(codepoint);
+			}
+			else if (const auto found = m_glyphs.find(codepoint);
+			         found != m_glyphs.end())
+			{
+				glyph = &found->second;
+			}
+			if (!glyph)
+			{
+				int advance = 0;
+				int bearing = 0;
+				metrics.index = stbtt_FindGlyphIndex(
+				    info, static_cast<int>(codepoint));
+				metrics.cell = NoCell;
+				stbtt_GetGlyphHMetrics(info, metrics.index,
+				                       &advance, &bearing);
+				metrics.advance =
+				    static_cast<float>(advance) * kernScale;
+				glyph = &metrics;
+			}
+
+			if (previous >= 0)
+			{
+				penX += static_cast<float>(
+				            stbtt_GetGlyphKernAdvance(
+				                info, previous, glyph->index))
+				        * kernScale * size;
+			}
+			if (batch && glyph->cell != NoCell)
+			{
+				sprite.x = penX + glyph->x * size;
+				sprite.y = penY + glyph->y * size;
+				sprite.width = glyph->width * size;
+				sprite.height = glyph->height * size;
+				sprite.u0 = glyph->u0;
+				sprite.v0 = glyph->v0;
+				sprite.u1 = glyph->u1;
+				sprite.v1 = glyph->v1;
+				batch->Draw(sprite);
+			}
+			penX += glyph->advance * size;
+			previous = glyph->index;
+		}
+		return std::max(widest, penX - x);
+	}
+} // namespace AthiVegam::Graphics
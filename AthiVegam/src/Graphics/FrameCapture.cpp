@@ -0,0 +1,282 @@
+#include "AthiVegam/Graphics/FrameCapture.h"
+
+#include "AthiVegam/Core/FlatHashMap.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Managers/ResourceManager.h"
+#include "glad/glad.h"
+
+#include <fstream>
+#include <iterator>
+#include <mutex>
+
+namespace AthiVegam::Graphics::FrameCapture
+{
+	namespace
+	{
+		// Request() may race with the GL thread's flushes.
+		std::mutex mutex;
+		std::string requestedPath;
+		uint32_t requestedFlushes = 0;
+
+		// GL thread only.
+		std::string capturePath;
+		uint32_t remaining = 0;
+		Capture capture;
+		Core::FlatHashMap<uint32_t, uint32_t> meshes;
+		Core::FlatHashMap<uint32_t, uint32_t> shaders;
+
+#ifndef AV_CONFIG_SHIPPING
+		// Reads the mesh's range of whatever buffers its
+		// VAO holds, so arena meshes work too. Dynamic
+		// meshes rotate through stream buffers and are
+		// skipped.
+		bool ReadMesh(const Mesh& mesh, CapturedMesh& out)
+		{
+			const auto& layout = mesh.GetLayout();
+			if (!mesh.IsReady() || mesh.IsDynamic()
+			    || layout.GetAttributeCount() == 0)
+			{
+				return false;
+			}
+
+			GLint previous = 0;
+			glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous);
+			VEGAM_CHECK_GL_ERROR;
+			glBindVertexArray(mesh.GetId());
+			VEGAM_CHECK_GL_ERROR;
+			GLint vertexBuffer = 0;
+			glGetVertexAttribiv(
+			    layout.GetAttribute(0).location,
+			    GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING,
+			    &vertexBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			GLint indexBuffer = 0;
+			glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING,
+			              &indexBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBindVertexArray(previous);
+			VEGAM_CHECK_GL_ERROR;
+
+			out.layout = layout;
+			out.indexType = mesh.GetIndexType();
+			out.vertexCount = mesh.GetVertexCount();
+			out.elementCount = indexBuffer != 0
+			                       ? mesh.GetElementCount()
+			                       : 0;
+			const auto read = [](GLint buffer, size_t offset,
+			                     std::vector<uint8_t>& data) {
+				glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+				VEGAM_CHECK_GL_ERROR;
+				glGetBufferSubData(
+				    GL_COPY_READ_BUFFER,
+				    static_cast<GLintptr>(offset),
+				    static_cast<GLsizeiptr>(data.size()),
+				    data.data());
+				VEGAM_CHECK_GL_ERROR;
+			};
+			const size_t stride = layout.GetStride();
+			out.vertices.resize(stride * out.vertexCount);
+			read(vertexBuffer, stride * mesh.GetBaseVertex(),
+			     out.vertices);
+			const size_t indexSize =
+			    GetIndexSize(out.indexType);
+			out.indices.resize(indexSize * out.elementCount);
+			if (!out.indices.empty())
+			{
+				read(indexBuffer,
+				     indexSize * mesh.GetFirstIndex(),
+				     out.indices);
+			}
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+			VEGAM_CHECK_GL_ERROR;
+			return true;
+		}
+
+		void Write()
+		{
+			std::vector<uint8_t> data;
+			Core::Serial::Save(capture, data, SchemaVersion);
+			std::ofstream file(capturePath, std::ios::binary);
+			file.write(reinterpret_cast<const char*>(data.data()),
+			           static_cast<std::streamsize>(data.size()));
+			if (!file)
+			{
+				VEGAM_ERROR("Error writing frame capture {}",
+				            capturePath);
+				return;
+			}
+			VEGAM_INFO("Captured {} flushes, {} meshes, {} "
+			           "shaders, {} KB to {}",
+			           capture.flushes.size(),
+			           capture.meshes.size(),
+			           capture.shaders.size(),
+			           data.size() / 1024, capturePath);
+		}
+#endif // AV_CONFIG_SHIPPING
+	} // namespace
+
+	void Request(const std::string& path, uint32_t flushes)
+	{
+#ifdef AV_CONFIG_SHIPPING
+		VEGAM_WARN("Frame capture is not available in "
+		           "Shipping builds");
+#else
+		std::lock_guard lock(mutex);
+		requestedPath = path;
+		requestedFlushes = flushes;
+#endif // AV_CONFIG_SHIPPING
+	}
+
+	bool IsRecording()
+	{
+		if (remaining > 0)
+		{
+			return true;
+		}
+		std::lock_guard lock(mutex);
+		if (requestedFlushes == 0)
+		{
+			return false;
+		}
+		capturePath = std::move(requestedPath);
+		remaining = requestedFlushes;
+		requestedFlushes = 0;
+		capture = {};
+		meshes.clear();
+		shaders.clear();
+		return true;
+	}
+
+	void BeginFlush(std::span<const CommandList* const> lists)
+	{
+		auto& flush = capture.flushes.emplace_back();
+		for (const auto* list : lists)
+		{
+			auto& captured = flush.lists.emplace_back();
+			captured.instances.assign(
+			    list->GetInstances().begin(),
+			    list->GetInstances().end());
+			captured.constants.assign(
+			    list->GetConstants().begin(),
+			    list->GetConstants().end());
+		}
+	}
+
+	void AddCommand(uint32_t list, uint64_t key,
+	                RenderCommands::CommandType type,
+	                const void* payload,
+	                const Managers::ResourceManager& resources)
+	{
+		using namespace RenderCommands;
+
+		CapturedDraw draw;
+		draw.key = key;
+		MaterialHandle material;
+		if (type == CommandType::RenderMesh)
+		{
+			const auto* command =
+			    static_cast<const RenderMesh*>(payload);
+			draw.mesh = command->mesh;
+			draw.shader = command->shader;
+			draw.firstInstance = command->instance;
+			draw.constants = command->constants;
+			material = command->material;
+		}
+		else if (type == CommandType::RenderMeshInstanced)
+		{
+			const auto* command =
+			    static_cast<const RenderMeshInstanced*>(
+			        payload);
+			draw.mesh = command->mesh;
+			draw.shader = command->shader;
+			draw.firstInstance = command->firstInstance;
+			draw.instanceCount = command->instanceCount;
+			draw.constants = command->constants;
+			draw.instanced = true;
+			material = command->material;
+		}
+		else
+		{
+			return;
+		}
+		draw.shader = resources.GetMaterialTable().ResolveShader(
+		    draw.shader, material);
+		capture.flushes.back().lists[list].draws.push_back(draw);
+	}
+
+	void EndFlush(const Managers::ResourceManager& resources)
+	{
+#ifndef AV_CONFIG_SHIPPING
+		// Each resource once, the first time it is drawn.
+		for (auto& list : capture.flushes.back().lists)
+		{
+			std::erase_if(list.draws, [&](const auto& draw) {
+				if (!meshes.contains(draw.mesh.value))
+				{
+					CapturedMesh mesh;
+					mesh.handle = draw.mesh;
+					const auto* data =
+					    resources.GetMesh(draw.mesh);
+					const auto read =
+					    data && ReadMesh(*data, mesh);
+					meshes[draw.mesh.value] = read;
+					if (read)
+					{
+						capture.meshes.push_back(
+						    std::move(mesh));
+					}
+				}
+				if (!shaders.contains(draw.shader.value))
+				{
+					const auto* shader =
+					    resources.GetShader(draw.shader);
+					shaders[draw.shader.value] =
+					    shader != nullptr;
+					if (shader)
+					{
+						capture.shaders.push_back(
+						    {draw.shader,
+						     shader->GetVertexSource(),
+						     shader->GetFragmentSource()});
+					}
+				}
+				return !meshes[draw.mesh.value]
+				       || !shaders[draw.shader.value];
+			});
+		}
+
+		if (--remaining == 0)
+		{
+			Write();
+			capture = {};
+		}
+#else
+		(void)resources;
+		remaining = 0;
+#endif // AV_CONFIG_SHIPPING
+	}
+
+	bool Load(const std::string& path, Capture& out)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			VEGAM_ERROR("Error opening frame capture {}", path);
+			return false;
+		}
+		const std::vector<uint8_t> data(
+		    (std::istreambuf_iterator<char>(file)),
+		    std::istreambuf_iterator<char>());
+		uint32_t schemaVersion = 0;
+		if (!Core::Serial::Load(data.data(), data.size(),
+		                        out, &schemaVersion)
+		    || schemaVersion != SchemaVersion)
+		{
+			VEGAM_ERROR("{} is not a version {} frame capture",
+			            path, SchemaVersion);
+			return false;
+		}
+		return true;
+	}
+} // namespace AthiVegam::Graphics::FrameCapture
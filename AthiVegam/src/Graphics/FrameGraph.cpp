@@ -0,0 +1,801 @@
+#include "AthiVegam/Graphics/FrameGraph.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/GLState.h"
+#include "AthiVegam/Graphics/GpuProfiler.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		struct FormatInfo
+		{
+			GLenum internalFormat;
+			// For contexts without immutable storage.
+			GLenum format;
+			GLenum type;
+			uint32_t bytesPerPixel;
+			// Formats of a class other than 0 can view
+			// each other's storage.
+			uint8_t viewClass;
+			bool depth;
+		};
+
+		constexpr FormatInfo Formats[] = {
+		    {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4, 1, false},
+		    {GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, 4, 1,
+		     false},
+		    {GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, 8, 0, false},
+		    {GL_RG16F, GL_RG, GL_HALF_FLOAT, 4, 1, false},
+		    {GL_R11F_G11F_B10F, GL_RGB, GL_FLOAT, 4, 1, false},
+		    {GL_R32F, GL_RED, GL_FLOAT, 4, 1, false},
+		    {GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL,
+		     GL_UNSIGNED_INT_24_8, 4, 0, true},
+		    {GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT,
+		     GL_FLOAT, 4, 0, true},
+		};
+		static_assert(std::size(Formats)
+		                  == static_cast<size_t>(
+		                      AttachmentFormat::COUNT),
+		              "Missing attachment format info");
+
+		inline const FormatInfo& GetInfo(AttachmentFormat format)
+		{
+			return Formats[static_cast<size_t>(format)];
+		}
+
+		inline GLenum GetDepthAttachment(AttachmentFormat format)
+		{
+			return format == AttachmentFormat::Depth24Stencil8
+			           ? GL_DEPTH_STENCIL_ATTACHMENT
+			           : GL_DEPTH_ATTACHMENT;
+		}
+
+		void SetSamplerState(GLuint texture)
+		{
+			glBindTexture(GL_TEXTURE_2D, texture);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+			                GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+			                GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
+			                GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
+			                GL_CLAMP_TO_EDGE);
+			VEGAM_CHECK_GL_ERROR;
+		}
+	} // namespace
+
+	FrameGraph::PassBuilder::PassBuilder(FrameGraph& graph,
+	                                     uint32_t pass)
+	    : m_graph(graph), m_pass(pass)
+	{
+	}
+
+	void FrameGraph::PassBuilder::Read(ResourceId resource)
+	{
+		VEGAM_ASSERT(resource < m_graph.m_resources.size(),
+		             "Reading an unknown frame graph resource!");
+		m_graph.m_passes[m_pass].reads.push_back(resource);
+	}
+
+	void FrameGraph::PassBuilder::WriteColor(ResourceId resource,
+	                                         LoadOp load)
+	{
+		auto& pass = m_graph.m_passes[m_pass];
+		VEGAM_ASSERT(resource < m_graph.m_resources.size(),
+		             "Writing an unknown frame graph resource!");
+		VEGAM_ASSERT(pass.colors.size() < MaxColorAttachments,
+		             "Too many color attachments!");
+		VEGAM_ASSERT(
+		    resource == 0
+		        || !GetInfo(m_graph.m_resources[resource]
+		                        .desc.format)
+		                .depth,
+		    "Depth format written as a color attachment!");
+		pass.colors.push_back({resource, load});
+	}
+
+	void FrameGraph::PassBuilder::WriteDepth(ResourceId resource,
+	                                         LoadOp load)
+	{
+		VEGAM_ASSERT(resource < m_graph.m_resources.size(),
+		             "Writing an unknown frame graph resource!");
+		VEGAM_ASSERT(
+		    resource == 0
+		        || GetInfo(m_graph.m_resources[resource]
+		                       .desc.format)
+		               .depth,
+		    "Color format written as a depth attachment!");
+		m_graph.m_passes[m_pass].depth = {resource, load};
+	}
+
+	void FrameGraph::PassBuilder::SetSideEffects()
+	{
+		m_graph.m_passes[m_pass].sideEffects = true;
+	}
+
+	FrameGraph::PassContext::PassContext(const FrameGraph& graph,
+	                                     int width, int height)
+	    : m_graph(graph), m_width(width), m_height(height)
+	{
+	}
+
+	uint32_t
+	FrameGraph::PassContext::GetTexture(ResourceId resource) const
+	{
+		VEGAM_ASSERT(resource < m_graph.m_resources.size(),
+		             "Unknown frame graph resource!");
+		return m_graph.m_resources[resource].texture;
+	}
+
+	FrameGraph::FrameGraph() { Reset(); }
+
+	FrameGraph::~FrameGraph()
+	{
+		VEGAM_ASSERT(m_pool.empty() && m_framebuffers.empty(),
+		             "Frame graph destroyed before Shutdown()!");
+	}
+
+	void FrameGraph::Shutdown()
+	{
+		for (auto& framebuffer : m_framebuffers)
+		{
+			DestroyFramebuffer(framebuffer);
+		}
+		m_framebuffers.clear();
+		for (auto& pooled : m_pool)
+		{
+			DestroyTexture(pooled);
+		}
+		m_pool.clear();
+		Reset();
+	}
+
+	void FrameGraph::SetBackbuffer(uint32_t framebuffer,
+	                               int width, int height)
+	{
+		m_backbuffer = framebuffer;
+		m_backbufferWidth = width;
+		m_backbufferHeight = height;
+		m_resources[0].width = width;
+		m_resources[0].height = height;
+	}
+
+	FrameGraph::ResourceId
+	FrameGraph::CreateTransient(std::string name,
+	                            const TransientDesc& desc)
+	{
+		VEGAM_ASSERT(!m_compiled,
+		             "Frame graph changed after Compile()!");
+		Resource resource;
+		resource.name = std::move(name);
+		resource.desc = desc;
+		m_resources.push_back(std::move(resource));
+		return static_cast<ResourceId>(m_resources.size() - 1);
+	}
+
+	FrameGraph::ResourceId
+	FrameGraph::Import(std::string name, uint32_t texture,
+	                   int width, int height,
+	                   AttachmentFormat format, int32_t layer)
+	{
+		VEGAM_ASSERT(!m_compiled,
+		             "Frame graph changed after Compile()!");
+		Resource resource;
+		resource.name = std::move(name);
+		resource.desc.format = format;
+		resource.width = width;
+		resource.height = height;
+		resource.imported = true;
+		resource.layer = layer;
+		resource.texture = texture;
+		m_resources.push_back(std::move(resource));
+		return static_cast<ResourceId>(m_resources.size() - 1);
+	}
+
+	void FrameGraph::AddPass(std::string name,
+	                         const SetupFunction& setup,
+	                         ExecuteFunction execute)
+	{
+		VEGAM_ASSERT(!m_compiled,
+		             "Frame graph changed after Compile()!");
+		Pass pass;
+		pass.name = std::move(name);
+		pass.execute = std::move(execute);
+		m_passes.push_back(std::move(pass));
+		PassBuilder builder(
+		    *this, static_cast<uint32_t>(m_passes.size() - 1));
+		setup(builder);
+	}
+
+	void FrameGraph::Cull()
+	{
+		// Walks back from the outputs. A write that loads
+		// needs what earlier passes wrote; one that doesn't
+		// makes them dead unless something reads them first.
+		std::vector<bool> needed(m_resources.size(), false);
+		for (auto i = m_passes.size(); i-- > 0;)
+		{
+			auto& pass = m_passes[i];
+			pass.alive = pass.sideEffects;
+			const auto write = [&](const Attachment& attachment) {
+				if (attachment.resource == InvalidResource)
+				{
+					return;
+				}
+				const auto& resource =
+				    m_resources[attachment.resource];
+				pass.alive = pass.alive || resource.imported
+				             || needed[attachment.resource];
+			};
+			for (const auto& color : pass.colors)
+			{
+				write(color);
+			}
+			write(pass.depth);
+			if (!pass.alive)
+			{
+				++m_stats.culledPasses;
+				continue;
+			}
+
+			const auto need = [&](const Attachment& attachment) {
+				if (attachment.resource != InvalidResource)
+				{
+					needed[attachment.resource] =
+					    attachment.load == LoadOp::Load;
+				}
+			};
+			for (const auto& color : pass.colors)
+			{
+				need(color);
+			}
+			need(pass.depth);
+			for (const auto read : pass.reads)
+			{
+				needed[read] = true;
+			}
+		}
+	}
+
+	void FrameGraph::Compile()
+	{
+		VEGAM_PROFILE_SCOPE("FrameGraph::Compile");
+		VEGAM_ASSERT(!m_compiled, "Frame graph compiled twice!");
+		m_stats = {};
+		m_stats.passes = static_cast<uint32_t>(m_passes.size());
+		Cull();
+
+		for (uint32_t i = 0; i < m_passes.size(); ++i)
+		{
+			const auto& pass = m_passes[i];
+			if (!pass.alive)
+			{
+				continue;
+			}
+			const auto use = [&](ResourceId id) {
+				if (id == InvalidResource)
+				{
+					return;
+				}
+				auto& resource = m_resources[id];
+				resource.first = std::min(resource.first, i);
+				resource.last = std::max(resource.last, i);
+			};
+			for (const auto read : pass.reads)
+			{
+				use(read);
+			}
+			for (const auto& color : pass.colors)
+			{
+				use(color.resource);
+			}
+			use(pass.depth.resource);
+		}
+
+		for (auto& resource : m_resources)
+		{
+			if (resource.imported)
+			{
+				continue;
+			}
+			const auto& desc = resource.desc;
+			const auto scaled = [&](int size) {
+				return std::max(
+				    static_cast<int>(size * desc.scale), 1);
+			};
+			resource.width = desc.width > 0
+			                     ? desc.width
+			                     : scaled(m_backbufferWidth);
+			resource.height = desc.height > 0
+			                      ? desc.height
+			                      : scaled(m_backbufferHeight);
+		}
+
+		// A pass's transients are all acquired before any
+		// of its last uses are released, so what it reads
+		// never shares with what it writes.
+		for (uint32_t i = 0; i < m_passes.size(); ++i)
+		{
+			if (!m_passes[i].alive)
+			{
+				continue;
+			}
+			for (auto& resource : m_resources)
+			{
+				if (!resource.imported && resource.first == i)
+				{
+					Acquire(resource);
+					++m_stats.transients;
+					m_stats.requestedBytes +=
+					    static_cast<size_t>(resource.width)
+					    * resource.height
+					    * GetInfo(resource.desc.format)
+					          .bytesPerPixel;
+				}
+			}
+			for (const auto& resource : m_resources)
+			{
+				if (!resource.imported && resource.last == i)
+				{
+					Release(resource);
+				}
+			}
+		}
+
+		for (const auto& pooled : m_pool)
+		{
+			if (pooled.lastUsedFrame == m_frame)
+			{
+				++m_stats.textures;
+				m_stats.allocatedBytes += pooled.bytes;
+			}
+		}
+		m_compiled = true;
+	}
+
+	void FrameGraph::Acquire(Resource& resource)
+	{
+		const auto format = resource.desc.format;
+		const auto& info = GetInfo(format);
+		// Views need immutable storage.
+		const auto viewable =
+		    GLAD_GL_VERSION_4_3 && glTexStorage2D;
+
+		// Prefers the same format, then a view of another.
+		uint32_t found = 0xFFFFFFFF;
+		for (uint32_t i = 0; i < m_pool.size(); ++i)
+		{
+			const auto& pooled = m_pool[i];
+			if (pooled.inUse || pooled.width != resource.width
+			    || pooled.height != resource.height)
+			{
+				continue;
+			}
+			if (pooled.format == format)
+			{
+				found = i;
+				break;
+			}
+			if (viewable && info.viewClass != 0
+			    && found == 0xFFFFFFFF
+			    && GetInfo(pooled.format).viewClass
+			           == info.viewClass)
+			{
+				found = i;
+			}
+		}
+
+		if (found == 0xFFFFFFFF)
+		{
+			PooledTexture pooled;
+			pooled.width = resource.width;
+			pooled.height = resource.height;
+			pooled.format = format;
+			pooled.bytes = static_cast<size_t>(resource.width)
+			               * resource.height
+			               * info.bytesPerPixel;
+			glGenTextures(1, &pooled.texture);
+			VEGAM_CHECK_GL_ERROR;
+			SetSamplerState(pooled.texture);
+			if (glTexStorage2D)
+			{
+				glTexStorage2D(GL_TEXTURE_2D, 1,
+				               info.internalFormat,
+				               resource.width, resource.height);
+			}
+			else
+			{
+				glTexImage2D(GL_TEXTURE_2D, 0,
+				             static_cast<GLint>(
+				                 info.internalFormat),
+				             resource.width, resource.height, 0,
+				             info.format, info.type, nullptr);
+			}
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+			                0);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D, 0);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(GpuResources::Type::Texture,
+			                       pooled.texture, pooled.bytes,
+			                       "Frame graph transient");
+			m_pool.push_back(pooled);
+			found = static_cast<uint32_t>(m_pool.size() - 1);
+		}
+
+		auto& pooled = m_pool[found];
+		pooled.inUse = true;
+		pooled.lastUsedFrame = m_frame;
+		resource.pooled = found;
+
+		auto& view = pooled.views[static_cast<size_t>(format)];
+		if (format == pooled.format)
+		{
+			view = pooled.texture;
+		}
+		else if (view == 0)
+		{
+			glGenTextures(1, &view);
+			VEGAM_CHECK_GL_ERROR;
+			glTextureView(view, GL_TEXTURE_2D, pooled.texture,
+			              info.internalFormat, 0, 1, 0, 1);
+			VEGAM_CHECK_GL_ERROR;
+			SetSamplerState(view);
+			glBindTexture(GL_TEXTURE_2D, 0);
+			VEGAM_CHECK_GL_ERROR;
+			// Shares the storage registered with the
+			// texture.
+			GpuResources::Register(GpuResources::Type::Texture,
+			                       view, 0,
+			                       "Frame graph transient view");
+		}
+		resource.texture = view;
+	}
+
+	void FrameGraph::Release(const Resource& resource)
+	{
+		m_pool[resource.pooled].inUse = false;
+	}
+
+	uint32_t FrameGraph::GetFramebuffer(const Pass& pass)
+	{
+		Framebuffer key{};
+		key.layers.fill(-1);
+		const auto setKey = [&](size_t slot, ResourceId id) {
+			key.attachments[slot] = m_resources[id].texture;
+			key.layers[slot] = m_resources[id].layer;
+		};
+		for (size_t i = 0; i < pass.colors.size(); ++i)
+		{
+			setKey(i, pass.colors[i].resource);
+		}
+		if (pass.depth.resource != InvalidResource)
+		{
+			setKey(MaxColorAttachments, pass.depth.resource);
+		}
+		for (const auto& framebuffer : m_framebuffers)
+		{
+			if (framebuffer.attachments == key.attachments
+			    && framebuffer.layers == key.layers)
+			{
+				return framebuffer.framebuffer;
+			}
+		}
+
+		glGenFramebuffers(1, &key.framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindFramebuffer(GL_FRAMEBUFFER, key.framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		const auto attach = [&](GLenum point, size_t slot) {
+			if (key.layers[slot] >= 0)
+			{
+				glFramebufferTextureLayer(
+				    GL_FRAMEBUFFER, point, key.attachments[slot],
+				    0, key.layers[slot]);
+			}
+			else
+			{
+				glFramebufferTexture2D(GL_FRAMEBUFFER, point,
+				                       GL_TEXTURE_2D,
+				                       key.attachments[slot], 0);
+			}
+			VEGAM_CHECK_GL_ERROR;
+		};
+		GLenum drawBuffers[MaxColorAttachments];
+		for (size_t i = 0; i < pass.colors.size(); ++i)
+		{
+			drawBuffers[i] =
+			    GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i);
+			attach(drawBuffers[i], i);
+		}
+		if (pass.depth.resource != InvalidResource)
+		{
+			attach(GetDepthAttachment(
+			           m_resources[pass.depth.resource]
+			               .desc.format),
+			       MaxColorAttachments);
+		}
+		if (pass.colors.empty())
+		{
+			glDrawBuffer(GL_NONE);
+		}
+		else
+		{
+			glDrawBuffers(static_cast<GLsizei>(pass.colors.size()),
+			              drawBuffers);
+		}
+		VEGAM_CHECK_GL_ERROR;
+
+		const auto status =
+		    glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		if (status != GL_FRAMEBUFFER_COMPLETE)
+		{
+			VEGAM_ERROR("Frame graph pass '{}' has an incomplete "
+			            "framebuffer: {:#x}",
+			            pass.name, status);
+		}
+		GpuResources::Register(GpuResources::Type::Framebuffer,
+		                       key.framebuffer, 0,
+		                       "Frame graph framebuffer");
+		m_framebuffers.push_back(key);
+		return key.framebuffer;
+	}
+
+	void FrameGraph::BeginPass(const Pass& pass, int& width,
+	                           int& height)
+	{
+		const auto backbuffer =
+		    (!pass.colors.empty() && pass.colors[0].resource == 0)
+		    || pass.depth.resource == 0;
+		VEGAM_ASSERT(
+		    !backbuffer
+		        || std::all_of(pass.colors.begin(),
+		                       pass.colors.end(),
+		                       [](const Attachment& a) {
+			                       return a.resource == 0;
+		                       }),
+		    "Pass mixes the backbuffer with other "
+		    "attachments!");
+
+		const auto framebuffer =
+		    backbuffer ? m_backbuffer : GetFramebuffer(pass);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		const auto& first =
+		    m_resources[pass.colors.empty()
+		                    ? pass.depth.resource
+		                    : pass.colors[0].resource];
+		width = first.width;
+		height = first.height;
+		glViewport(0, 0, width, height);
+		VEGAM_CHECK_GL_ERROR;
+
+		// Masks and the scissor limit clears.
+		const auto prepareClear = [](bool depth) {
+			GLState::SetEnabled(GLState::Capability::ScissorTest,
+			                    false);
+			if (depth)
+			{
+				GLState::SetDepthMask(true);
+			}
+			else
+			{
+				GLState::SetColorMask(true);
+			}
+		};
+
+		GLenum discards[MaxColorAttachments + 2];
+		GLsizei discardCount = 0;
+		GLbitfield clearMask = 0;
+		for (size_t i = 0; i < pass.colors.size(); ++i)
+		{
+			const auto& color = pass.colors[i];
+			if (color.load == LoadOp::Clear)
+			{
+				prepareClear(false);
+				if (backbuffer)
+				{
+					clearMask |= GL_COLOR_BUFFER_BIT;
+					continue;
+				}
+				glClearBufferfv(
+				    GL_COLOR, static_cast<GLint>(i),
+				    m_resources[color.resource]
+				        .desc.clearColor.data());
+				VEGAM_CHECK_GL_ERROR;
+			}
+			else if (color.load == LoadOp::DontCare)
+			{
+				discards[discardCount++] =
+				    framebuffer == 0
+				        ? GL_COLOR
+				        : GL_COLOR_ATTACHMENT0
+				              + static_cast<GLenum>(i);
+			}
+		}
+
+		if (pass.depth.resource != InvalidResource)
+		{
+			const auto format =
+			    m_resources[pass.depth.resource].desc.format;
+			if (pass.depth.load == LoadOp::Clear)
+			{
+				prepareClear(true);
+				if (backbuffer)
+				{
+					clearMask |= GL_DEPTH_BUFFER_BIT
+					             | GL_STENCIL_BUFFER_BIT;
+				}
+				else if (format
+				         == AttachmentFormat::Depth24Stencil8)
+				{
+					glClearBufferfi(GL_DEPTH_STENCIL, 0, 1.0f, 0);
+					VEGAM_CHECK_GL_ERROR;
+				}
+				else
+				{
+					const GLfloat one = 1.0f;
+					glClearBufferfv(GL_DEPTH, 0, &one);
+					VEGAM_CHECK_GL_ERROR;
+				}
+			}
+			else if (pass.depth.load == LoadOp::DontCare)
+			{
+				if (framebuffer == 0)
+				{
+					discards[discardCount++] = GL_DEPTH;
+					discards[discardCount++] = GL_STENCIL;
+				}
+				else
+				{
+					// The headless target's depth has
+					// stencil.
+					discards[discardCount++] =
+					    backbuffer ? GL_DEPTH_STENCIL_ATTACHMENT
+					               : GetDepthAttachment(format);
+				}
+			}
+		}
+
+		if (clearMask != 0)
+		{
+			glClear(clearMask);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		if (discardCount > 0 && GLAD_GL_VERSION_4_3)
+		{
+			glInvalidateFramebuffer(GL_FRAMEBUFFER, discardCount,
+			                        discards);
+			VEGAM_CHECK_GL_ERROR;
+		}
+	}
+
+	void FrameGraph::Execute()
+	{
+		VEGAM_PROFILE_SCOPE("FrameGraph::Execute");
+		// Zone names must outlive the frame's queries.
+		VEGAM_PROFILE_GPU_SCOPE("FrameGraph");
+		VEGAM_ASSERT(m_compiled,
+		             "Frame graph executed before Compile()!");
+		for (const auto& pass : m_passes)
+		{
+			if (!pass.alive)
+			{
+				continue;
+			}
+			int width = m_backbufferWidth;
+			int height = m_backbufferHeight;
+			if (!pass.colors.empty()
+			    || pass.depth.resource != InvalidResource)
+			{
+				BeginPass(pass, width, height);
+			}
+			if (pass.execute)
+			{
+				pass.execute(PassContext(*this, width, height));
+			}
+		}
+
+		// Later rendering expects the backbuffer.
+		glBindFramebuffer(GL_FRAMEBUFFER, m_backbuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glViewport(0, 0, m_backbufferWidth, m_backbufferHeight);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void FrameGraph::Reset()
+	{
+		m_passes.clear();
+		m_resources.resize(1);
+		m_resources[0] = {};
+		m_resources[0].name = "Backbuffer";
+		m_resources[0].imported = true;
+		m_resources[0].width = m_backbufferWidth;
+		m_resources[0].height = m_backbufferHeight;
+		m_compiled = false;
+
+		// Sizes change on resizes and with what passes are
+		// declared; textures left out for a while go.
+		for (size_t i = m_pool.size(); i-- > 0;)
+		{
+			auto& pooled = m_pool[i];
+			pooled.inUse = false;
+			if (m_frame - pooled.lastUsedFrame >= PoolFrames)
+			{
+				DestroyTexture(pooled);
+				m_pool.erase(m_pool.begin()
+				             + static_cast<ptrdiff_t>(i));
+			}
+		}
+		++m_frame;
+	}
+
+	void FrameGraph::DestroyTexture(PooledTexture& pooled)
+	{
+		// Framebuffers using it or its views go too.
+		const auto uses = [&](const Framebuffer& framebuffer) {
+			return std::any_of(
+			    framebuffer.attachments.begin(),
+			    framebuffer.attachments.end(), [&](uint32_t id) {
+				    return id != 0
+				           && (id == pooled.texture
+				               || std::find(pooled.views.begin(),
+				                            pooled.views.end(),
+				                            id)
+				                      != pooled.views.end());
+			    });
+		};
+		for (auto& framebuffer : m_framebuffers)
+		{
+			if (uses(framebuffer))
+			{
+				DestroyFramebuffer(framebuffer);
+			}
+		}
+		std::erase_if(m_framebuffers,
+		              [](const Framebuffer& framebuffer) {
+			              return framebuffer.framebuffer == 0;
+		              });
+
+		for (auto& view : pooled.views)
+		{
+			if (view != 0 && view != pooled.texture)
+			{
+				GpuResources::Unregister(
+				    GpuResources::Type::Texture, view);
+				glDeleteTextures(1, &view);
+				VEGAM_CHECK_GL_ERROR;
+			}
+			view = 0;
+		}
+		GpuResources::Unregister(GpuResources::Type::Texture,
+		                         pooled.texture);
+		glDeleteTextures(1, &pooled.texture);
+		VEGAM_CHECK_GL_ERROR;
+		pooled.texture = 0;
+	}
+
+	void FrameGraph::DestroyFramebuffer(Framebuffer& framebuffer)
+	{
+		if (framebuffer.framebuffer == 0)
+		{
+			return;
+		}
+		GpuResources::Unregister(GpuResources::Type::Framebuffer,
+		                         framebuffer.framebuffer);
+		glDeleteFramebuffers(1, &framebuffer.framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		framebuffer.framebuffer = 0;
+	}
+} // namespace AthiVegam::Graphics
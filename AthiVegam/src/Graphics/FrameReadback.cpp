@@ -0,0 +1,128 @@
+#include "AthiVegam/Graphics/FrameReadback.h"
+
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		constexpr GLuint64 FenceTimeout = 1'000'000'000;
+	} // namespace
+
+	void FrameReadback::Capture(int width, int height,
+	                            uint64_t frame)
+	{
+		Poll();
+		auto& slot = m_slots[m_next];
+		if (slot.fence)
+		{
+			Deliver(slot, true);
+		}
+
+		const auto size = static_cast<size_t>(width) * height * 4;
+		if (slot.buffer == 0)
+		{
+			glGenBuffers(1, &slot.buffer);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+		VEGAM_CHECK_GL_ERROR;
+		if (slot.size != size)
+		{
+			glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr,
+			             GL_STREAM_READ);
+			VEGAM_CHECK_GL_ERROR;
+			slot.size = size;
+			GpuResources::Register(GpuResources::Type::Buffer,
+			                       slot.buffer, size,
+			                       "Frame readback");
+		}
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		VEGAM_CHECK_GL_ERROR;
+		glReadPixels(0, 0, width, height, GL_RGBA,
+		             GL_UNSIGNED_BYTE, nullptr);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		slot.fence =
+		    glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		VEGAM_CHECK_GL_ERROR;
+		slot.width = width;
+		slot.height = height;
+		slot.frame = frame;
+		m_next = (m_next + 1) % SlotCount;
+	}
+
+	void FrameReadback::Poll(bool wait)
+	{
+		// m_next is the oldest slot.
+		for (uint32_t i = 0; i < SlotCount; ++i)
+		{
+			auto& slot = m_slots[(m_next + i) % SlotCount];
+			if (slot.fence && !Deliver(slot, wait))
+			{
+				return;
+			}
+		}
+	}
+
+	bool FrameReadback::Deliver(Slot& slot, bool wait)
+	{
+		const auto result = glClientWaitSync(
+		    slot.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+		    wait ? FenceTimeout : 0);
+		if (result == GL_TIMEOUT_EXPIRED && !wait)
+		{
+			return false;
+		}
+		if (result == GL_TIMEOUT_EXPIRED
+		    || result == GL_WAIT_FAILED)
+		{
+			VEGAM_WARN("Frame {} readback failed", slot.frame);
+		}
+		glDeleteSync(slot.fence);
+		VEGAM_CHECK_GL_ERROR;
+		slot.fence = nullptr;
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+		VEGAM_CHECK_GL_ERROR;
+		const auto* pixels = static_cast<const uint8_t*>(
+		    glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.size,
+		                     GL_MAP_READ_BIT));
+		VEGAM_CHECK_GL_ERROR;
+		if (pixels && m_callback)
+		{
+			m_callback(pixels, slot.width, slot.height,
+			           slot.frame);
+		}
+		if (pixels)
+		{
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		return true;
+	}
+
+	void FrameReadback::Destroy()
+	{
+		Poll(true);
+		for (auto& slot : m_slots)
+		{
+			if (slot.buffer != 0)
+			{
+				GpuResources::Unregister(
+				    GpuResources::Type::Buffer, slot.buffer);
+				glDeleteBuffers(1, &slot.buffer);
+				VEGAM_CHECK_GL_ERROR;
+			}
+			slot = {};
+		}
+		m_next = 0;
+	}
+} // namespace AthiVegam::Graphics
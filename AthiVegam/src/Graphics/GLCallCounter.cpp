@@ -0,0 +1,368 @@
+#include "AthiVegam/Graphics/GLCallCounter.h"
+
+#include "AthiVegam/Log.h"
+#include "external/imgui/imgui.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#ifndef AV_CONFIG_SHIPPING
+
+// Every GL function the engine calls. A function missing
+// here still works but isn't counted.
+#define VEGAM_GL_FUNCTIONS(X) \
+	X(glActiveTexture) \
+	X(glAttachShader) \
+	X(glBeginQuery) \
+	X(glBindBuffer) \
+	X(glBindBufferBase) \
+	X(glBindBufferRange) \
+	X(glBindFramebuffer) \
+	X(glBindImageTexture) \
+	X(glBindRenderbuffer) \
+	X(glBindSampler) \
+	X(glBindTexture) \
+	X(glBindVertexArray) \
+	X(glBlendFuncSeparate) \
+	X(glBlitFramebuffer) \
+	X(glBufferData) \
+	X(glBufferStorage) \
+	X(glBufferSubData) \
+	X(glCheckFramebufferStatus) \
+	X(glClear) \
+	X(glClearBufferfi) \
+	X(glClearBufferfv) \
+	X(glClearBufferuiv) \
+	X(glClearColor) \
+	X(glClientWaitSync) \
+	X(glColorMask) \
+	X(glCompileShader) \
+	X(glCompressedTexImage2D) \
+	X(glCompressedTexImage3D) \
+	X(glCompressedTexSubImage2D) \
+	X(glCompressedTexSubImage3D) \
+	X(glCopyBufferSubData) \
+	X(glCopyImageSubData) \
+	X(glCreateProgram) \
+	X(glCreateShader) \
+	X(glCullFace) \
+	X(glDebugMessageCallback) \
+	X(glDebugMessageControl) \
+	X(glDeleteBuffers) \
+	X(glDeleteFramebuffers) \
+	X(glDeleteProgram) \
+	X(glDeleteQueries) \
+	X(glDeleteRenderbuffers) \
+	X(glDeleteSamplers) \
+	X(glDeleteShader) \
+	X(glDeleteSync) \
+	X(glDeleteTextures) \
+	X(glDeleteVertexArrays) \
+	X(glDepthFunc) \
+	X(glDepthMask) \
+	X(glDisable) \
+	X(glDispatchCompute) \
+	X(glDispatchComputeIndirect) \
+	X(glDrawArrays) \
+	X(glDrawArraysIndirect) \
+	X(glDrawArraysInstanced) \
+	X(glDrawBuffer) \
+	X(glDrawBuffers) \
+	X(glDrawElementsBaseVertex) \
+	X(glDrawElementsInstancedBaseVertex) \
+	X(glEnable) \
+	X(glEnableVertexAttribArray) \
+	X(glEndQuery) \
+	X(glFenceSync) \
+	X(glFinish) \
+	X(glFlush) \
+	X(glFramebufferRenderbuffer) \
+	X(glFramebufferTexture2D) \
+	X(glFramebufferTextureLayer) \
+	X(glGenBuffers) \
+	X(glGenFramebuffers) \
+	X(glGenQueries) \
+	X(glGenRenderbuffers) \
+	X(glGenSamplers) \
+	X(glGenTextures) \
+	X(glGenVertexArrays) \
+	X(glGetActiveAttrib) \
+	X(glGetActiveUniform) \
+	X(glGetActiveUniformBlockName) \
+	X(glGetActiveUniformBlockiv) \
+	X(glGetAttribLocation) \
+	X(glGetBufferSubData) \
+	X(glGetError) \
+	X(glGetFloatv) \
+	X(glGetInteger64v) \
+	X(glGetIntegerv) \
+	X(glGetProgramBinary) \
+	X(glGetProgramInfoLog) \
+	X(glGetProgramInterfaceiv) \
+	X(glGetProgramResourceName) \
+	X(glGetProgramResourceiv) \
+	X(glGetProgramiv) \
+	X(glGetQueryObjectiv) \
+	X(glGetQueryObjectui64v) \
+	X(glGetShaderInfoLog) \
+	X(glGetShaderiv) \
+	X(glGetString) \
+	X(glGetStringi) \
+	X(glGetUniformBlockIndex) \
+	X(glGetUniformLocation) \
+	X(glGetVertexAttribiv) \
+	X(glInvalidateFramebuffer) \
+	X(glLinkProgram) \
+	X(glMapBufferRange) \
+	X(glMemoryBarrier) \
+	X(glMultiDrawElementsIndirect) \
+	X(glPixelStorei) \
+	X(glPolygonMode) \
+	X(glProgramBinary) \
+	X(glProgramParameteri) \
+	X(glProgramUniform1f) \
+	X(glProgramUniform1i) \
+	X(glProgramUniform1ui) \
+	X(glProgramUniform2f) \
+	X(glProgramUniform2i) \
+	X(glProgramUniform3f) \
+	X(glProgramUniform3fv) \
+	X(glProgramUniform3i) \
+	X(glProgramUniform4f) \
+	X(glProgramUniform4fv) \
+	X(glProgramUniform4i) \
+	X(glProgramUniformMatrix4fv) \
+	X(glQueryCounter) \
+	X(glReadPixels) \
+	X(glRenderbufferStorage) \
+	X(glSamplerParameteri) \
+	X(glScissor) \
+	X(glShaderSource) \
+	X(glTexImage2D) \
+	X(glTexImage3D) \
+	X(glTexParameterf) \
+	X(glTexParameteri) \
+	X(glTexStorage2D) \
+	X(glTexStorage3D) \
+	X(glTexSubImage2D) \
+	X(glTexSubImage3D) \
+	X(glTextureView) \
+	X(glUniformBlockBinding) \
+	X(glUnmapBuffer) \
+	X(glUseProgram) \
+	X(glValidateProgram) \
+	X(glVertexAttribDivisor) \
+	X(glVertexAttribI4ui) \
+	X(glVertexAttribIPointer) \
+	X(glVertexAttribPointer) \
+	X(glViewport)
+
+namespace AthiVegam::Graphics::GLCallCounter
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		// Expands to glad's pointer names, e.g.
+		// glad_glDrawArrays, which are unique.
+		enum class Id : uint32_t
+		{
+#define VEGAM_GL_ID(name) name,
+			VEGAM_GL_FUNCTIONS(VEGAM_GL_ID)
+#undef VEGAM_GL_ID
+			Count
+		};
+		constexpr auto Count = static_cast<size_t>(Id::Count);
+
+		struct LiveCounter
+		{
+			std::atomic<uint32_t> calls{0};
+			std::atomic<uint64_t> nanoseconds{0};
+		};
+
+		// Written by whichever thread calls GL (the loader
+		// thread's shared context too), hence atomics.
+		std::array<LiveCounter, Count> live;
+		std::array<const char*, Count> names{};
+		bool installed = false;
+
+		std::mutex mutex;
+		std::array<Function, Count> published{};
+		FrameTotals publishedTotals;
+
+		class Timer
+		{
+		  public:
+			explicit Timer(Id id) :
+			    m_id(id), m_start(Clock::now())
+			{
+			}
+			~Timer()
+			{
+				auto& counter =
+				    live[static_cast<size_t>(m_id)];
+				counter.calls.fetch_add(
+				    1, std::memory_order_relaxed);
+				const auto elapsed = std::chrono::duration_cast<
+				    std::chrono::nanoseconds>(Clock::now()
+				                              - m_start);
+				counter.nanoseconds.fetch_add(
+				    static_cast<uint64_t>(elapsed.count()),
+				    std::memory_order_relaxed);
+			}
+
+			Timer(const Timer&) = delete;
+			Timer& operator=(const Timer&) = delete;
+
+		  private:
+			Id m_id;
+			Clock::time_point m_start;
+		};
+
+		template <Id id, typename Proc>
+		struct Hook;
+
+		template <Id id, typename R, typename... A>
+		struct Hook<id, R(APIENTRYP)(A...)>
+		{
+			static inline R(APIENTRYP real)(A...) = nullptr;
+
+			static R APIENTRY Call(A... arguments)
+			{
+				const Timer timer(id);
+				return real(arguments...);
+			}
+
+			// Functions the driver lacks stay null, so
+			// checks against null still hold.
+			static void Install(R(APIENTRYP & pointer)(A...),
+			                    const char* name)
+			{
+				names[static_cast<size_t>(id)] = name;
+				if (pointer && pointer != &Call)
+				{
+					real = pointer;
+					pointer = &Call;
+				}
+			}
+		};
+	} // namespace
+
+	void Install()
+	{
+		if (installed)
+		{
+			return;
+		}
+#define VEGAM_GL_HOOK(name)                                 \
+	Hook<Id::name, decltype(glad_##name)>::Install(         \
+	    glad_##name, #name);
+		VEGAM_GL_FUNCTIONS(VEGAM_GL_HOOK)
+#undef VEGAM_GL_HOOK
+		installed = true;
+		VEGAM_INFO("Counting calls to {} GL functions", Count);
+	}
+
+	bool IsInstalled() { return installed; }
+
+	void EndFrame()
+	{
+		if (!installed)
+		{
+			return;
+		}
+		std::array<Function, Count> frame;
+		FrameTotals totals;
+		for (size_t i = 0; i < Count; ++i)
+		{
+			frame[i].name = names[i];
+			frame[i].calls = live[i].calls.exchange(
+			    0, std::memory_order_relaxed);
+			frame[i].milliseconds =
+			    static_cast<double>(live[i].nanoseconds.exchange(
+			        0, std::memory_order_relaxed))
+			    / 1e6;
+			totals.calls += frame[i].calls;
+			totals.milliseconds += frame[i].milliseconds;
+		}
+
+		std::lock_guard lock(mutex);
+		published = frame;
+		publishedTotals = totals;
+	}
+
+	FrameTotals GetFrameTotals()
+	{
+		std::lock_guard lock(mutex);
+		return publishedTotals;
+	}
+
+	std::vector<Function> GetFunctions()
+	{
+		std::vector<Function> functions;
+		{
+			std::lock_guard lock(mutex);
+			for (const auto& function : published)
+			{
+				if (function.calls > 0)
+				{
+					functions.push_back(function);
+				}
+			}
+		}
+		std::sort(functions.begin(), functions.end(),
+		          [](const Function& a, const Function& b) {
+			          return a.milliseconds > b.milliseconds;
+		          });
+		return functions;
+	}
+
+	void DrawPanel()
+	{
+		if (!installed)
+		{
+			return;
+		}
+		if (!ImGui::Begin("GL Calls"))
+		{
+			ImGui::End();
+			return;
+		}
+
+		const auto totals = GetFrameTotals();
+		ImGui::Text("%u calls, %.3f ms in the driver",
+		            totals.calls, totals.milliseconds);
+		if (ImGui::BeginTable("Functions", 4,
+		                      ImGuiTableFlags_ScrollY))
+		{
+			for (const char* header :
+			     {"Function", "Calls", "ms", "us / call"})
+			{
+				ImGui::TableSetupColumn(header);
+			}
+			ImGui::TableHeadersRow();
+			for (const auto& function : GetFunctions())
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(function.name);
+				ImGui::TableNextColumn();
+				ImGui::Text("%u", function.calls);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", function.milliseconds);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", function.milliseconds
+				                        * 1000.0
+				                        / function.calls);
+			}
+			ImGui::EndTable();
+		}
+		ImGui::End();
+	}
+} // namespace AthiVegam::Graphics::GLCallCounter
+
+#endif // AV_CONFIG_SHIPPING
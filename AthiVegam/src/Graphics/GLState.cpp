@@ -0,0 +1,167 @@
+#include "AthiVegam/Graphics/GLState.h"
+
+#include "AthiVegam/Graphics/Helpers.h"
+#include "glad/glad.h"
+
+#include <array>
+#include <cstddef>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		constexpr auto CapabilityCount =
+		    static_cast<size_t>(GLState::Capability::COUNT);
+		constexpr std::array<GLenum, CapabilityCount>
+		    capabilities = {GL_BLEND, GL_DEPTH_TEST,
+		                    GL_CULL_FACE, GL_SCISSOR_TEST};
+
+		// GL thread only, like the program cache.
+		struct Shadow
+		{
+			std::array<uint32_t, CapabilityCount> enabled{};
+			std::array<uint32_t, 4> blendFunc{GL_ONE, GL_ZERO,
+			                                  GL_ONE, GL_ZERO};
+			uint32_t depthMask = GL_TRUE;
+			uint32_t colorMask = GL_TRUE;
+			uint32_t depthFunc = GL_LESS;
+			uint32_t cullFace = GL_BACK;
+			uint32_t polygonMode = GL_FILL;
+		};
+		Shadow shadow;
+
+		// Updates a shadowed value, returning whether it
+		// changed.
+		template <typename T>
+		inline bool Update(T& current, const T& value)
+		{
+			if (current == value)
+			{
+				return false;
+			}
+			current = value;
+			return true;
+		}
+	} // namespace
+
+	bool GLState::SetEnabled(Capability capability,
+	                         bool enabled)
+	{
+		const auto index = static_cast<size_t>(capability);
+		if (!Update(shadow.enabled[index],
+		            static_cast<uint32_t>(enabled)))
+		{
+			return false;
+		}
+
+		if (enabled)
+		{
+			glEnable(capabilities[index]);
+		}
+		else
+		{
+			glDisable(capabilities[index]);
+		}
+		VEGAM_CHECK_GL_ERROR;
+		return true;
+	}
+
+	bool GLState::SetBlendFunc(uint32_t sourceColor,
+	                           uint32_t destinationColor,
+	                           uint32_t sourceAlpha,
+	                           uint32_t destinationAlpha)
+	{
+		if (!Update(shadow.blendFunc,
+		            {sourceColor, destinationColor, sourceAlpha,
+		             destinationAlpha}))
+		{
+			return false;
+		}
+
+		glBlendFuncSeparate(sourceColor, destinationColor,
+		                    sourceAlpha, destinationAlpha);
+		VEGAM_CHECK_GL_ERROR;
+		return true;
+	}
+
+	bool GLState::SetDepthMask(bool write)
+	{
+		if (!Update(shadow.depthMask,
+		            static_cast<uint32_t>(write ? GL_TRUE
+		                                        : GL_FALSE)))
+		{
+			return false;
+		}
+
+		glDepthMask(write ? GL_TRUE : GL_FALSE);
+		VEGAM_CHECK_GL_ERROR;
+		return true;
+	}
+
+	bool GLState::SetColorMask(bool write)
+	{
+		if (!Update(shadow.colorMask,
+		            static_cast<uint32_t>(write ? GL_TRUE
+		                                        : GL_FALSE)))
+		{
+			return false;
+		}
+
+		const auto mask = write ? GL_TRUE : GL_FALSE;
+		glColorMask(mask, mask, mask, mask);
+		VEGAM_CHECK_GL_ERROR;
+		return true;
+	}
+
+	bool GLState::SetDepthFunc(uint32_t func)
+	{
+		if (!Update(shadow.depthFunc, func))
+		{
+			return false;
+		}
+
+		glDepthFunc(func);
+		VEGAM_CHECK_GL_ERROR;
+		return true;
+	}
+
+	bool GLState::SetCullFace(uint32_t face)
+	{
+		if (!Update(shadow.cullFace, face))
+		{
+			return false;
+		}
+
+		glCullFace(face);
+		VEGAM_CHECK_GL_ERROR;
+		return true;
+	}
+
+	bool GLState::SetPolygonMode(uint32_t mode)
+	{
+		if (!Update(shadow.polygonMode, mode))
+		{
+			return false;
+		}
+
+		glPolygonMode(GL_FRONT_AND_BACK, mode);
+		VEGAM_CHECK_GL_ERROR;
+		return true;
+	}
+
+	uint32_t GLState::GetPolygonMode()
+	{
+		return shadow.polygonMode;
+	}
+
+	void GLState::Invalidate()
+	{
+		shadow.enabled.fill(Unknown);
+		shadow.blendFunc.fill(Unknown);
+		shadow.depthMask = Unknown;
+		shadow.colorMask = Unknown;
+		shadow.depthFunc = Unknown;
+		shadow.cullFace = Unknown;
+		shadow.polygonMode = Unknown;
+	}
+} // namespace AthiVegam::Graphics
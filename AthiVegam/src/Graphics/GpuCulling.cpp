@@ -0,0 +1,897 @@
+#include "AthiVegam/Graphics/GpuCulling.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/ComputeProgram.h"
+#include "AthiVegam/Graphics/Culling.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Math/Matrix.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <string>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		constexpr uint32_t CullGroupSize = 64;
+		constexpr uint32_t PyramidGroupSize = 8;
+		constexpr uint32_t MaxClusterGroups = 65535;
+
+		// Shared by both culling passes: the draws, the
+		// instance transforms and the visibility tests.
+		const char* CommonSource = R"(#version 430 core
+layout(local_size_x = 64) in;
+
+struct Draw
+{
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+layout(std430, binding = 3) buffer Draws
+{
+	Draw draws[];
+};
+layout(std430, binding = 5) readonly buffer Instances
+{
+	mat4 transforms[];
+};
+
+uniform vec4 Planes[6];
+uniform mat4 ViewProjection;
+// Farthest depth per texel; no occlusion test while
+// PyramidLevels is 0.
+uniform sampler2D DepthPyramid;
+uniform vec2 PyramidSize;
+uniform int PyramidLevels;
+
+bool InFrustum(vec3 center, float radius)
+{
+	for (int i = 0; i < 6; ++i)
+	{
+		if (dot(Planes[i].xyz, center) + Planes[i].w
+		    <= -radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Whether the sphere's screen rectangle lies behind the
+// pyramid texels covering it, at the level where two
+// texels span it.
+bool Occluded(vec3 center, float radius)
+{
+	if (PyramidLevels == 0)
+	{
+		return false;
+	}
+	vec3 lo = vec3(1.0);
+	vec3 hi = vec3(-1.0);
+	for (int i = 0; i < 8; ++i)
+	{
+		vec3 corner = vec3((i & 1) != 0 ? 1.0 : -1.0,
+		                   (i & 2) != 0 ? 1.0 : -1.0,
+		                   (i & 4) != 0 ? 1.0 : -1.0);
+		vec4 clip =
+		    ViewProjection * vec4(center + corner * radius, 1.0);
+		if (clip.w <= 0.0)
+		{
+			// Reaches behind the camera.
+			return false;
+		}
+		vec3 ndc = clip.xyz / clip.w;
+		lo = min(lo, ndc);
+		hi = max(hi, ndc);
+	}
+
+	vec2 uvMin = clamp(lo.xy * 0.5 + 0.5, 0.0, 1.0);
+	vec2 uvMax = clamp(hi.xy * 0.5 + 0.5, 0.0, 1.0);
+	vec2 extent = (uvMax - uvMin) * PyramidSize;
+	float level = min(ceil(log2(max(max(extent.x, extent.y),
+	                                1.0))),
+	                  float(PyramidLevels - 1));
+	float farthest = max(
+	    max(textureLod(DepthPyramid, uvMin, level).r,
+	        textureLod(DepthPyramid, vec2(uvMax.x, uvMin.y),
+	                   level).r),
+	    max(textureLod(DepthPyramid, vec2(uvMin.x, uvMax.y),
+	                   level).r,
+	        textureLod(DepthPyramid, uvMax, level).r));
+	return lo.z * 0.5 + 0.5 > farthest;
+}
+)";
+
+		const char* CullSource = R"(
+layout(std430, binding = 4) readonly buffer Bounds
+{
+	vec4 bounds[];
+};
+
+struct LodLevels
+{
+	uvec4 counts;
+	uvec4 firstIndices;
+	ivec4 baseVertices;
+	vec4 thresholds;
+};
+
+layout(std430, binding = 6) readonly buffer Lods
+{
+	LodLevels lods[];
+};
+
+uniform uint DrawCount;
+// Whether Lods is bound, and how spheres project.
+uniform bool SelectLods;
+uniform float ProjectionScale;
+uniform float LodBias;
+
+void main()
+{
+	uint i = gl_GlobalInvocationID.x;
+	if (i >= DrawCount || bounds[i].w < 0.0)
+	{
+		return;
+	}
+
+	vec4 sphere = bounds[i];
+	bool selectLod = SelectLods && lods[i].thresholds.x > 0.0;
+	// Largest projected size of a visible instance.
+	float size = -1.0;
+	uint first = draws[i].baseInstance;
+	uint count = draws[i].instanceCount;
+	for (uint j = 0; j < count; ++j)
+	{
+		mat4 m = transforms[first + j];
+		vec3 center = (m * vec4(sphere.xyz, 1.0)).xyz;
+		float scale = max(max(dot(m[0].xyz, m[0].xyz),
+		                      dot(m[1].xyz, m[1].xyz)),
+		                  dot(m[2].xyz, m[2].xyz));
+		float radius = sphere.w * sqrt(scale);
+		if (InFrustum(center, radius)
+		    && !Occluded(center, radius))
+		{
+			if (!selectLod)
+			{
+				return;
+			}
+			float w = (ViewProjection * vec4(center, 1.0)).w;
+			size = max(size, w > radius
+			                     ? radius * ProjectionScale / w
+			                     : 3.0e38);
+		}
+	}
+	if (size < 0.0)
+	{
+		draws[i].instanceCount = 0;
+		return;
+	}
+
+	// Thresholds decrease, and are 0 past the chain.
+	size *= LodBias;
+	LodLevels levels = lods[i];
+	uint level = 0;
+	for (int k = 0; k < 3; ++k)
+	{
+		if (size < levels.thresholds[k])
+		{
+			level = uint(k + 1);
+		}
+	}
+	draws[i].count = levels.counts[level];
+	draws[i].firstIndex = levels.firstIndices[level];
+	draws[i].baseVertex = levels.baseVertices[level];
+}
+)";
+
+		// One group per meshlet: the first invocation tests
+		// it against every instance, and if any sees it, the
+		// group appends its indices to the draw's slice of
+		// the cluster indices and adds them to its count.
+		const char* ClusterSource = R"(
+struct Meshlet
+{
+	vec4 sphere;
+	vec4 cone;
+	uint firstIndex;
+	uint indexCount;
+	uvec2 reserved;
+};
+
+layout(std430, binding = 16) readonly buffer Meshlets
+{
+	Meshlet meshlets[];
+};
+// The arena's; 16-bit indices come two to a word.
+layout(std430, binding = 17) readonly buffer Indices
+{
+	uint indices[];
+};
+layout(std430, binding = 18) writeonly buffer ClusterIndices
+{
+	uint clusterIndices[];
+};
+
+uniform uint DrawIndex;
+uniform uint FirstMeshlet;
+uniform uint MeshletCount;
+// The mesh's, in Indices.
+uniform uint FirstIndex;
+uniform bool ShortIndices;
+uniform bool BackFaceCulling;
+// w is 0 for orthographic views, which skip the cone
+// test.
+uniform vec4 CameraPosition;
+
+shared bool visible;
+shared uint outputFirst;
+
+uint ReadIndex(uint i)
+{
+	if (!ShortIndices)
+	{
+		return indices[i];
+	}
+	uint word = indices[i >> 1];
+	return (i & 1u) != 0u ? word >> 16 : word & 0xFFFFu;
+}
+
+// Whether all the meshlet's triangles face away from the
+// camera. Not under non-uniform scale or mirroring, which
+// don't carry the cone over.
+bool BackFacing(mat4 m, vec3 scales, vec3 center,
+                float radius, vec4 cone)
+{
+	if (!BackFaceCulling || CameraPosition.w == 0.0
+	    || scales.x <= 0.0
+	    || any(greaterThan(abs(scales - scales.x),
+	                       vec3(scales.x * 1.0e-3)))
+	    || determinant(mat3(m)) < 0.0)
+	{
+		return false;
+	}
+	vec3 axis = mat3(m) * cone.xyz / scales.x;
+	vec3 offset = center - CameraPosition.xyz;
+	return dot(offset, axis)
+	       >= cone.w * length(offset) + radius;
+}
+
+void main()
+{
+	uint i = FirstMeshlet + gl_WorkGroupID.x;
+	if (i >= MeshletCount)
+	{
+		return;
+	}
+
+	Meshlet meshlet = meshlets[i];
+	if (gl_LocalInvocationIndex == 0u)
+	{
+		visible = false;
+		uint first = draws[DrawIndex].baseInstance;
+		uint count = draws[DrawIndex].instanceCount;
+		for (uint j = 0u; j < count && !visible; ++j)
+		{
+			mat4 m = transforms[first + j];
+			vec3 center = (m * vec4(meshlet.sphere.xyz, 1.0)).xyz;
+			vec3 scales = vec3(length(m[0].xyz),
+			                   length(m[1].xyz),
+			                   length(m[2].xyz));
+			float radius = meshlet.sphere.w
+			               * max(max(scales.x, scales.y),
+			                     scales.z);
+			visible = InFrustum(center, radius)
+			          && !BackFacing(m, scales, center, radius,
+			                         meshlet.cone)
+			          && !Occluded(center, radius);
+		}
+		if (visible)
+		{
+			outputFirst =
+			    draws[DrawIndex].firstIndex
+			    + atomicAdd(draws[DrawIndex].count,
+			                meshlet.indexCount);
+		}
+	}
+	memoryBarrierShared();
+	barrier();
+	if (!visible)
+	{
+		return;
+	}
+
+	uint source = FirstIndex + meshlet.firstIndex;
+	for (uint j = gl_LocalInvocationIndex;
+	     j < meshlet.indexCount; j += 64u)
+	{
+		clusterIndices[outputFirst + j] = ReadIndex(source + j);
+	}
+}
+)";
+
+		// Each texel of the destination level keeps the
+		// farthest of the source texels it covers; odd
+		// sizes fold their last row or column in.
+		const char* PyramidSource = R"(#version 430 core
+layout(local_size_x = 8, local_size_y = 8) in;
+
+uniform sampler2D Source;
+uniform int SourceLevel;
+layout(r32f, binding = 0) writeonly uniform image2D Destination;
+
+void main()
+{
+	ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+	ivec2 size = imageSize(Destination);
+	if (any(greaterThanEqual(p, size)))
+	{
+		return;
+	}
+
+	ivec2 sourceSize = textureSize(Source, SourceLevel);
+	ivec2 first = p * sourceSize / size;
+	ivec2 last = min(((p + 1) * sourceSize + size - 1) / size,
+	                 sourceSize) - 1;
+	float farthest = 0.0;
+	for (int y = first.y; y <= last.y; ++y)
+	{
+		for (int x = first.x; x <= last.x; ++x)
+		{
+			farthest = max(farthest,
+			               texelFetch(Source, ivec2(x, y),
+			                          SourceLevel).r);
+		}
+	}
+	imageStore(Destination, p, vec4(farthest));
+}
+)";
+
+		inline GLint Location(uint32_t program,
+		                      const char* name)
+		{
+			const auto location =
+			    glGetUniformLocation(program, name);
+			VEGAM_CHECK_GL_ERROR;
+			return location;
+		}
+
+		// Orphaned every frame, like the indirect buffer.
+		void UploadStorage(uint32_t buffer, size_t& capacity,
+		                   const void* data, size_t size)
+		{
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+			VEGAM_CHECK_GL_ERROR;
+			if (size > capacity)
+			{
+				capacity = size * 2;
+			}
+			glBufferData(GL_SHADER_STORAGE_BUFFER, capacity,
+			             nullptr, GL_STREAM_DRAW);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Resize(GpuResources::Type::Buffer,
+			                     buffer, capacity);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size,
+			                data);
+			VEGAM_CHECK_GL_ERROR;
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+			VEGAM_CHECK_GL_ERROR;
+		}
+	} // namespace
+
+	GpuCulling::~GpuCulling()
+	{
+		VEGAM_ASSERT(!IsInitialized(),
+		             "GpuCulling destroyed without Shutdown()");
+	}
+
+	bool GpuCulling::Initialize()
+	{
+		if (IsInitialized())
+		{
+			return true;
+		}
+		if (!GLAD_GL_VERSION_4_3)
+		{
+			VEGAM_WARN("GPU culling needs a GL 4.3 context");
+			return false;
+		}
+
+		const auto cullSource =
+		    std::string(CommonSource) + CullSource;
+		const auto clusterSource =
+		    std::string(CommonSource) + ClusterSource;
+		m_cullProgram = CreateComputeProgram(
+		    cullSource.c_str(), "GPU culling");
+		m_clusterProgram = CreateComputeProgram(
+		    clusterSource.c_str(), "Cluster culling");
+		m_pyramidProgram = CreateComputeProgram(
+		    PyramidSource, "Depth pyramid");
+		if (!m_cullProgram || !m_clusterProgram
+		    || !m_pyramidProgram)
+		{
+			Shutdown();
+			return false;
+		}
+		for (const auto program :
+		     {m_cullProgram, m_clusterProgram})
+		{
+			glProgramUniform1i(
+			    program, Location(program, "DepthPyramid"),
+			    PyramidUnit);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glProgramUniform1i(m_pyramidProgram,
+		                   Location(m_pyramidProgram, "Source"),
+		                   PyramidUnit);
+		VEGAM_CHECK_GL_ERROR;
+
+		glGenSamplers(1, &m_depthSampler);
+		VEGAM_CHECK_GL_ERROR;
+		glSamplerParameteri(m_depthSampler,
+		                    GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		VEGAM_CHECK_GL_ERROR;
+		glSamplerParameteri(m_depthSampler,
+		                    GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		VEGAM_CHECK_GL_ERROR;
+
+		glGenBuffers(1, &m_boundsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::Buffer,
+		                       m_boundsBuffer, 0, "Draw bounds");
+		glGenBuffers(1, &m_lodsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::Buffer,
+		                       m_lodsBuffer, 0, "Draw LODs");
+		glGenBuffers(1, &m_clusterIndexBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::Buffer,
+		                       m_clusterIndexBuffer, 0,
+		                       "Cluster indices");
+		VEGAM_INFO("GPU culling enabled");
+		return true;
+	}
+
+	void GpuCulling::Shutdown()
+	{
+		DeleteComputeProgram(m_cullProgram);
+		DeleteComputeProgram(m_clusterProgram);
+		DeleteComputeProgram(m_pyramidProgram);
+		if (m_boundsBuffer != 0)
+		{
+			GpuResources::Unregister(GpuResources::Type::Buffer,
+			                         m_boundsBuffer);
+			glDeleteBuffers(1, &m_boundsBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			m_boundsBuffer = 0;
+			m_boundsBufferSize = 0;
+		}
+		if (m_lodsBuffer != 0)
+		{
+			GpuResources::Unregister(GpuResources::Type::Buffer,
+			                         m_lodsBuffer);
+			glDeleteBuffers(1, &m_lodsBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			m_lodsBuffer = 0;
+			m_lodsBufferSize = 0;
+		}
+		if (m_clusterIndexBuffer != 0)
+		{
+			GpuResources::Unregister(GpuResources::Type::Buffer,
+			                         m_clusterIndexBuffer);
+			glDeleteBuffers(1, &m_clusterIndexBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			m_clusterIndexBuffer = 0;
+			m_clusterIndexBufferSize = 0;
+		}
+		if (m_depthSampler != 0)
+		{
+			glDeleteSamplers(1, &m_depthSampler);
+			VEGAM_CHECK_GL_ERROR;
+			m_depthSampler = 0;
+		}
+		DestroyPyramid();
+		m_depthTexture = 0;
+	}
+
+	void GpuCulling::SetOcclusionDepth(uint32_t depthTexture,
+	                                   int width, int height)
+	{
+		if (width != m_depthWidth || height != m_depthHeight
+		    || depthTexture == 0)
+		{
+			DestroyPyramid();
+		}
+		m_depthTexture = depthTexture;
+		m_depthWidth = width;
+		m_depthHeight = height;
+		// Last frame's pyramid came from another texture.
+		m_pyramidReady = false;
+	}
+
+	void GpuCulling::DestroyPyramid()
+	{
+		if (m_pyramid != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Texture, m_pyramid);
+			glDeleteTextures(1, &m_pyramid);
+			VEGAM_CHECK_GL_ERROR;
+			m_pyramid = 0;
+		}
+		m_pyramidLevels = 0;
+		m_pyramidReady = false;
+	}
+
+	void GpuCulling::BuildDepthPyramid()
+	{
+		if (!IsInitialized() || m_depthTexture == 0
+		    || m_depthWidth <= 0 || m_depthHeight <= 0)
+		{
+			return;
+		}
+		VEGAM_PROFILE_SCOPE("GpuCulling::BuildDepthPyramid");
+
+		if (m_pyramid == 0)
+		{
+			const auto largest = static_cast<uint32_t>(
+			    std::max(m_depthWidth, m_depthHeight));
+			m_pyramidLevels = std::bit_width(largest);
+			glGenTextures(1, &m_pyramid);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D, m_pyramid);
+			VEGAM_CHECK_GL_ERROR;
+			glTexStorage2D(GL_TEXTURE_2D, m_pyramidLevels,
+			               GL_R32F, m_depthWidth,
+			               m_depthHeight);
+			VEGAM_CHECK_GL_ERROR;
+			// Whole texels of one level, see Occluded().
+			glTexParameteri(GL_TEXTURE_2D,
+			                GL_TEXTURE_MIN_FILTER,
+			                GL_NEAREST_MIPMAP_NEAREST);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D,
+			                GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
+			                GL_CLAMP_TO_EDGE);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
+			                GL_CLAMP_TO_EDGE);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(
+			    GpuResources::Type::Texture, m_pyramid,
+			    static_cast<size_t>(m_depthWidth)
+			        * m_depthHeight * 4 * 4 / 3,
+			    "Depth pyramid");
+		}
+
+		Shader::UseProgram(m_pyramidProgram);
+		glActiveTexture(GL_TEXTURE0 + PyramidUnit);
+		VEGAM_CHECK_GL_ERROR;
+		const auto sourceLevel =
+		    Location(m_pyramidProgram, "SourceLevel");
+
+		// Level 0 copies the depth texture, every further
+		// level reduces the one before.
+		auto width = m_depthWidth;
+		auto height = m_depthHeight;
+		for (int level = 0; level < m_pyramidLevels; ++level)
+		{
+			glBindTexture(GL_TEXTURE_2D, level == 0
+			                                 ? m_depthTexture
+			                                 : m_pyramid);
+			VEGAM_CHECK_GL_ERROR;
+			// Depth textures without mips are incomplete
+			// under the default filter.
+			glBindSampler(PyramidUnit,
+			              level == 0 ? m_depthSampler : 0);
+			VEGAM_CHECK_GL_ERROR;
+			glProgramUniform1i(m_pyramidProgram, sourceLevel,
+			                   level == 0 ? 0 : level - 1);
+			VEGAM_CHECK_GL_ERROR;
+			glBindImageTexture(0, m_pyramid, level, GL_FALSE,
+			                   0, GL_WRITE_ONLY, GL_R32F);
+			VEGAM_CHECK_GL_ERROR;
+			glDispatchCompute(
+			    (width + PyramidGroupSize - 1)
+			        / PyramidGroupSize,
+			    (height + PyramidGroupSize - 1)
+			        / PyramidGroupSize,
+			    1);
+			VEGAM_CHECK_GL_ERROR;
+			glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+			VEGAM_CHECK_GL_ERROR;
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+		}
+
+		glBindSampler(PyramidUnit, 0);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, 0);
+		VEGAM_CHECK_GL_ERROR;
+		glActiveTexture(GL_TEXTURE0);
+		VEGAM_CHECK_GL_ERROR;
+		m_pyramidReady = true;
+	}
+
+	void GpuCulling::Cull(const float viewProjection[16],
+	                      uint32_t indirectBuffer,
+	                      uint32_t instanceBuffer,
+	                      std::span<const Float4> bounds,
+	                      std::span<const LodLevels> lods)
+	{
+		if (!IsInitialized() || bounds.empty())
+		{
+			return;
+		}
+		VEGAM_PROFILE_SCOPE("GpuCulling::Cull");
+		VEGAM_ASSERT(lods.empty()
+		                 || lods.size() == bounds.size(),
+		             "One set of levels per draw");
+
+		UploadStorage(m_boundsBuffer, m_boundsBufferSize,
+		              bounds.data(), bounds.size_bytes());
+		const auto selectLods = !lods.empty();
+		if (selectLods)
+		{
+			UploadStorage(m_lodsBuffer, m_lodsBufferSize,
+			              lods.data(), lods.size_bytes());
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+			                 LodsBinding, m_lodsBuffer);
+			VEGAM_CHECK_GL_ERROR;
+		}
+
+		const auto drawCount =
+		    static_cast<uint32_t>(bounds.size());
+		glBindBufferRange(
+		    GL_SHADER_STORAGE_BUFFER, DrawsBinding,
+		    indirectBuffer, 0,
+		    drawCount
+		        * sizeof(RenderCommands::DrawElementsIndirect));
+		VEGAM_CHECK_GL_ERROR;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+		                 BoundsBinding, m_boundsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+		                 InstancesBinding, instanceBuffer);
+		VEGAM_CHECK_GL_ERROR;
+
+		const auto frustum = Frustum::FromMatrix(viewProjection);
+		glProgramUniform1ui(m_cullProgram,
+		                    Location(m_cullProgram, "DrawCount"),
+		                    drawCount);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform4fv(m_cullProgram,
+		                    Location(m_cullProgram, "Planes"), 6,
+		                    &frustum.planes[0].x);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniformMatrix4fv(
+		    m_cullProgram,
+		    Location(m_cullProgram, "ViewProjection"), 1,
+		    GL_FALSE, viewProjection);
+		VEGAM_CHECK_GL_ERROR;
+		const auto occlusion = m_pyramidReady;
+		glProgramUniform1i(
+		    m_cullProgram,
+		    Location(m_cullProgram, "PyramidLevels"),
+		    occlusion ? m_pyramidLevels : 0);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform2f(
+		    m_cullProgram,
+		    Location(m_cullProgram, "PyramidSize"),
+		    static_cast<float>(m_depthWidth),
+		    static_cast<float>(m_depthHeight));
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1i(
+		    m_cullProgram,
+		    Location(m_cullProgram, "SelectLods"), selectLods);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1f(
+		    m_cullProgram,
+		    Location(m_cullProgram, "ProjectionScale"),
+		    GetProjectionScale(viewProjection));
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1f(m_cullProgram,
+		                   Location(m_cullProgram, "LodBias"),
+		                   m_lodBias);
+		VEGAM_CHECK_GL_ERROR;
+
+		Shader::UseProgram(m_cullProgram);
+		if (occlusion)
+		{
+			glActiveTexture(GL_TEXTURE0 + PyramidUnit);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D, m_pyramid);
+			VEGAM_CHECK_GL_ERROR;
+			glActiveTexture(GL_TEXTURE0);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glDispatchCompute(
+		    (drawCount + CullGroupSize - 1) / CullGroupSize, 1,
+		    1);
+		VEGAM_CHECK_GL_ERROR;
+		// The draws read the counts as indirect commands.
+		glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void GpuCulling::CullClusters(
+	    const float viewProjection[16],
+	    uint32_t indirectBuffer, uint32_t instanceBuffer,
+	    std::span<const ClusterDraw> draws,
+	    uint32_t indexCount)
+	{
+		if (!IsInitialized() || draws.empty())
+		{
+			return;
+		}
+		VEGAM_PROFILE_SCOPE("GpuCulling::CullClusters");
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER,
+		             m_clusterIndexBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		const auto indexBytes =
+		    static_cast<size_t>(indexCount) * sizeof(uint32_t);
+		if (indexBytes > m_clusterIndexBufferSize)
+		{
+			m_clusterIndexBufferSize = indexBytes * 2;
+			glBufferData(GL_SHADER_STORAGE_BUFFER,
+			             m_clusterIndexBufferSize, nullptr,
+			             GL_DYNAMIC_COPY);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Resize(GpuResources::Type::Buffer,
+			                     m_clusterIndexBuffer,
+			                     m_clusterIndexBufferSize);
+		}
+
+		// Counts start at 0 for the groups to add to.
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, indirectBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		constexpr auto EntrySize =
+		    sizeof(RenderCommands::DrawElementsIndirect);
+		for (const auto& draw : draws)
+		{
+			glClearBufferSubData(
+			    GL_SHADER_STORAGE_BUFFER, GL_R32UI,
+			    static_cast<GLintptr>(draw.draw) * EntrySize,
+			    sizeof(uint32_t), GL_RED_INTEGER,
+			    GL_UNSIGNED_INT, nullptr);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DrawsBinding,
+		                 indirectBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+		                 InstancesBinding, instanceBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+		                 ClusterIndicesBinding,
+		                 m_clusterIndexBuffer);
+		VEGAM_CHECK_GL_ERROR;
+
+		// The camera is where the view-projection maps to
+		// no point; a direction for orthographic views.
+		const auto camera =
+		    Math::Inverse(Math::Mat4::Load(viewProjection))
+		    * Math::Vec4{0.0f, 0.0f, 1.0f, 0.0f};
+		const auto perspective = std::abs(camera.w) > 1.0e-6f;
+		const auto program = m_clusterProgram;
+		if (perspective)
+		{
+			glProgramUniform4f(
+			    program, Location(program, "CameraPosition"),
+			    camera.x / camera.w, camera.y / camera.w,
+			    camera.z / camera.w, 1.0f);
+		}
+		else
+		{
+			glProgramUniform4f(
+			    program, Location(program, "CameraPosition"),
+			    0.0f, 0.0f, 0.0f, 0.0f);
+		}
+		VEGAM_CHECK_GL_ERROR;
+
+		const auto frustum = Frustum::FromMatrix(viewProjection);
+		glProgramUniform4fv(program,
+		                    Location(program, "Planes"), 6,
+		                    &frustum.planes[0].x);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniformMatrix4fv(
+		    program, Location(program, "ViewProjection"), 1,
+		    GL_FALSE, viewProjection);
+		VEGAM_CHECK_GL_ERROR;
+		const auto occlusion = m_pyramidReady;
+		glProgramUniform1i(program,
+		                   Location(program, "PyramidLevels"),
+		                   occlusion ? m_pyramidLevels : 0);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform2f(program,
+		                   Location(program, "PyramidSize"),
+		                   static_cast<float>(m_depthWidth),
+		                   static_cast<float>(m_depthHeight));
+		VEGAM_CHECK_GL_ERROR;
+
+		Shader::UseProgram(program);
+		if (occlusion)
+		{
+			glActiveTexture(GL_TEXTURE0 + PyramidUnit);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D, m_pyramid);
+			VEGAM_CHECK_GL_ERROR;
+			glActiveTexture(GL_TEXTURE0);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		// Cull() left instance counts for the tests, and
+		// the clears must land before the groups add.
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		VEGAM_CHECK_GL_ERROR;
+
+		const auto drawIndex = Location(program, "DrawIndex");
+		const auto firstMeshlet =
+		    Location(program, "FirstMeshlet");
+		const auto meshletCount =
+		    Location(program, "MeshletCount");
+		const auto firstIndex = Location(program, "FirstIndex");
+		const auto shortIndices =
+		    Location(program, "ShortIndices");
+		const auto backFaceCulling =
+		    Location(program, "BackFaceCulling");
+		for (const auto& draw : draws)
+		{
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+			                 MeshletsBinding, draw.meshletBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+			                 IndicesBinding, draw.indexBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			glProgramUniform1ui(program, drawIndex, draw.draw);
+			VEGAM_CHECK_GL_ERROR;
+			glProgramUniform1ui(program, meshletCount,
+			                    draw.meshletCount);
+			VEGAM_CHECK_GL_ERROR;
+			glProgramUniform1ui(program, firstIndex,
+			                    draw.firstIndex);
+			VEGAM_CHECK_GL_ERROR;
+			glProgramUniform1i(program, shortIndices,
+			                   draw.shortIndices);
+			VEGAM_CHECK_GL_ERROR;
+			glProgramUniform1i(program, backFaceCulling,
+			                   draw.backFaceCulling);
+			VEGAM_CHECK_GL_ERROR;
+
+			// GL guarantees 65535 groups per dispatch.
+			for (uint32_t first = 0; first < draw.meshletCount;
+			     first += MaxClusterGroups)
+			{
+				glProgramUniform1ui(program, firstMeshlet,
+				                    first);
+				VEGAM_CHECK_GL_ERROR;
+				glDispatchCompute(
+				    std::min(draw.meshletCount - first,
+				             MaxClusterGroups),
+				    1, 1);
+				VEGAM_CHECK_GL_ERROR;
+			}
+		}
+		// The draws read the counts as indirect commands,
+		// and the indices as their element buffer.
+		glMemoryBarrier(GL_COMMAND_BARRIER_BIT
+		                | GL_ELEMENT_ARRAY_BARRIER_BIT);
+		VEGAM_CHECK_GL_ERROR;
+	}
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,72 @@
+#include "AthiVegam/Graphics/GpuFence.h"
+
+#include "AthiVegam/Core/Task.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "glad/glad.h"
+
+#include <mutex>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		std::mutex mutex;
+		// Shared with the awaiting coroutines.
+		std::vector<std::shared_ptr<void>> polled;
+	} // namespace
+
+	GpuFence::GpuFence() : m_state(std::make_shared<State>())
+	{
+	}
+
+	GpuFence::GpuFence(void* sync) : GpuFence()
+	{
+		m_state->sync = sync;
+	}
+
+	void GpuFence::await_suspend(std::coroutine_handle<> handle)
+	{
+		{
+			std::lock_guard lock(mutex);
+			polled.push_back(m_state);
+		}
+		Core::Coroutines::Detail::ResumeWhen(
+		    handle, [state = m_state] {
+			    return state->signalled.load(
+			        std::memory_order_acquire);
+		    });
+	}
+
+	void GpuFence::Poll()
+	{
+		std::lock_guard lock(mutex);
+		size_t kept = 0;
+		for (auto& entry : polled)
+		{
+			auto& state = *static_cast<State*>(entry.get());
+			if (!state.sync)
+			{
+				state.sync =
+				    glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+				VEGAM_CHECK_GL_ERROR;
+				polled[kept++] = std::move(entry);
+				continue;
+			}
+			auto* sync = static_cast<GLsync>(state.sync);
+			const auto status = glClientWaitSync(sync, 0, 0);
+			if (status != GL_ALREADY_SIGNALED
+			    && status != GL_CONDITION_SATISFIED)
+			{
+				polled[kept++] = std::move(entry);
+				continue;
+			}
+			glDeleteSync(sync);
+			VEGAM_CHECK_GL_ERROR;
+			state.sync = nullptr;
+			state.signalled.store(true,
+			                      std::memory_order_release);
+		}
+		polled.resize(kept);
+	}
+} // namespace AthiVegam::Graphics
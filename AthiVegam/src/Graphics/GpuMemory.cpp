@@ -0,0 +1,168 @@
+#include "AthiVegam/Graphics/GpuMemory.h"
+
+#include "AthiVegam/Core/CVar.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string_view>
+
+namespace AthiVegam::Graphics::GpuMemory
+{
+	namespace
+	{
+		Core::CVar<int32_t> budgetCVar(
+		    "r.gpuBudgetMB", 0,
+		    "GPU memory budget; 0 picks one from the driver");
+
+		// GL_NVX_gpu_memory_info, in KB.
+		constexpr GLenum DedicatedVidmemNvx = 0x9047;
+		constexpr GLenum CurrentAvailableVidmemNvx = 0x9049;
+		// GL_ATI_meminfo: free KB, largest block, and the
+		// same for auxiliary memory.
+		constexpr GLenum TextureFreeMemoryAti = 0x87FC;
+
+		// Share of video memory the automatic budget takes,
+		// leaving room for the driver, other processes and
+		// what we don't register.
+		constexpr size_t BudgetPercent = 75;
+		// Driver-reported free memory below which textures
+		// are evicted regardless of the budget.
+		constexpr size_t DriverReserve = 64 << 20;
+		// Driver queries can be slow on some drivers.
+		constexpr uint64_t PollInterval = 16;
+
+		enum class Source : uint8_t
+		{
+			None,
+			Nvx,
+			Ati
+		};
+
+		Source source = Source::None;
+		size_t driverBudget = 0;
+		size_t driverAvailable = 0;
+		std::atomic<uint64_t> frame{0};
+		std::atomic<size_t> overage{0};
+	} // namespace
+
+	void Initialize()
+	{
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		VEGAM_CHECK_GL_ERROR;
+		for (GLint i = 0; i < count; ++i)
+		{
+			const std::string_view extension(
+			    reinterpret_cast<const char*>(
+			        glGetStringi(GL_EXTENSIONS, i)));
+			if (extension == "GL_NVX_gpu_memory_info")
+			{
+				source = Source::Nvx;
+			}
+			else if (extension == "GL_ATI_meminfo"
+			         && source == Source::None)
+			{
+				source = Source::Ati;
+			}
+		}
+
+		// ATI only reports what is free, so count what is
+		// already ours as well.
+		const auto available = GetDriverAvailable();
+		size_t total = 0;
+		if (source == Source::Nvx)
+		{
+			GLint dedicated = 0;
+			glGetIntegerv(DedicatedVidmemNvx, &dedicated);
+			VEGAM_CHECK_GL_ERROR;
+			total = static_cast<size_t>(dedicated) << 10;
+		}
+		else if (source == Source::Ati)
+		{
+			total = available + GetUsed();
+		}
+		driverBudget = total / 100 * BudgetPercent;
+		driverAvailable = available;
+		if (total > 0)
+		{
+			VEGAM_INFO("GPU memory: {} MB, {} MB free, budget "
+			           "{} MB",
+			           total >> 20, available >> 20,
+			           driverBudget >> 20);
+		}
+	}
+
+	void EndFrame()
+	{
+		const auto current =
+		    frame.fetch_add(1, std::memory_order_relaxed) + 1;
+		if (current % PollInterval == 0)
+		{
+			driverAvailable = GetDriverAvailable();
+		}
+
+		const auto budget = GetBudget();
+		const auto used = GetUsed();
+		size_t over = budget > 0 && used > budget ? used - budget
+		                                          : 0;
+		if (source != Source::None
+		    && driverAvailable < DriverReserve)
+		{
+			over = std::max(over,
+			                DriverReserve - driverAvailable);
+		}
+		overage.store(over, std::memory_order_relaxed);
+	}
+
+	uint64_t GetFrame()
+	{
+		return frame.load(std::memory_order_relaxed);
+	}
+
+	size_t GetUsed()
+	{
+		size_t used = 0;
+		for (int i = 0; i < (int)GpuResources::Type::Count; ++i)
+		{
+			used += GpuResources::GetBytes(
+			    static_cast<GpuResources::Type>(i));
+		}
+		return used;
+	}
+
+	size_t GetBudget()
+	{
+		const auto megabytes = budgetCVar.Get();
+		return megabytes > 0
+		           ? static_cast<size_t>(megabytes) << 20
+		           : driverBudget;
+	}
+
+	size_t GetOverage()
+	{
+		return overage.load(std::memory_order_relaxed);
+	}
+
+	size_t GetDriverAvailable()
+	{
+		GLint kilobytes[4] = {};
+		if (source == Source::Nvx)
+		{
+			glGetIntegerv(CurrentAvailableVidmemNvx, kilobytes);
+		}
+		else if (source == Source::Ati)
+		{
+			glGetIntegerv(TextureFreeMemoryAti, kilobytes);
+		}
+		else
+		{
+			return 0;
+		}
+		VEGAM_CHECK_GL_ERROR;
+		return static_cast<size_t>(kilobytes[0]) << 10;
+	}
+} // namespace AthiVegam::Graphics::GpuMemory
@@ -0,0 +1,234 @@
+#include "AthiVegam/Graphics/GpuProfiler.h"
+
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Log.h"
+#include "SDL2/SDL.h"
+#include "glad/glad.h"
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+namespace AthiVegam::Graphics::GpuProfiler
+{
+	namespace
+	{
+		struct FrameQueries
+		{
+			// Begin and end timestamp per zone.
+			std::array<GLuint, MaxZonesPerFrame * 2> queries{};
+			std::array<const char*, MaxZonesPerFrame> names{};
+			std::array<uint32_t, MaxZonesPerFrame> depths{};
+			uint32_t zoneCount = 0;
+			// The GPU finishes queries in order, so this one
+			// being available means they all are.
+			GLuint lastQuery = 0;
+			// GPU and CPU clocks sampled together at the
+			// start of the frame.
+			GLint64 gpuBase = 0;
+			uint64_t cpuBase = 0;
+			// Timestamps at BeginFrame() and EndFrame().
+			std::array<GLuint, 2> frameQueries{};
+			bool frameTimed = false;
+		};
+
+		bool initialized = false;
+		std::array<FrameQueries, FrameLatency> frames;
+		uint32_t frameIndex = 0;
+		uint32_t depth = 0;
+		bool inFrame = false;
+		std::vector<Core::Profiler::Zone> resolved;
+		std::atomic<float> frameMs{0.0f};
+
+		inline FrameQueries& CurrentFrame()
+		{
+			return frames[frameIndex % FrameLatency];
+		}
+
+		void ResolveFrameTime(FrameQueries& frame)
+		{
+			if (!frame.frameTimed)
+			{
+				return;
+			}
+			frame.frameTimed = false;
+			GLint available = 0;
+			glGetQueryObjectiv(frame.frameQueries[1],
+			                   GL_QUERY_RESULT_AVAILABLE,
+			                   &available);
+			VEGAM_CHECK_GL_ERROR;
+			if (!available)
+			{
+				return;
+			}
+			GLuint64 begin = 0;
+			GLuint64 end = 0;
+			glGetQueryObjectui64v(frame.frameQueries[0],
+			                      GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(frame.frameQueries[1],
+			                      GL_QUERY_RESULT, &end);
+			VEGAM_CHECK_GL_ERROR;
+			frameMs.store(
+			    static_cast<float>(end - begin) / 1e6f,
+			    std::memory_order_relaxed);
+		}
+
+		void Resolve(FrameQueries& frame)
+		{
+			ResolveFrameTime(frame);
+			if (frame.zoneCount == 0)
+			{
+				return;
+			}
+
+			GLint available = 0;
+			glGetQueryObjectiv(frame.lastQuery,
+			                   GL_QUERY_RESULT_AVAILABLE,
+			                   &available);
+			VEGAM_CHECK_GL_ERROR;
+			if (!available)
+			{
+				return;
+			}
+
+			const auto ticksPerNs =
+			    static_cast<double>(
+			        SDL_GetPerformanceFrequency())
+			    / 1e9;
+			const auto toCpu = [&](GLuint64 timestamp) {
+				const auto ns = static_cast<double>(
+				    static_cast<int64_t>(timestamp)
+				    - frame.gpuBase);
+				return frame.cpuBase
+				       + static_cast<int64_t>(ns * ticksPerNs);
+			};
+
+			resolved.clear();
+			for (uint32_t i = 0; i < frame.zoneCount; ++i)
+			{
+				GLuint64 begin = 0;
+				GLuint64 end = 0;
+				glGetQueryObjectui64v(frame.queries[i * 2],
+				                      GL_QUERY_RESULT, &begin);
+				glGetQueryObjectui64v(frame.queries[i * 2 + 1],
+				                      GL_QUERY_RESULT, &end);
+				VEGAM_CHECK_GL_ERROR;
+				resolved.push_back({frame.names[i],
+				                    toCpu(begin), toCpu(end),
+				                    frame.depths[i]});
+			}
+			Core::Profiler::SetGpuZones(resolved);
+		}
+	} // namespace
+
+	void Initialize()
+	{
+		for (auto& frame : frames)
+		{
+			glGenQueries(static_cast<GLsizei>(
+			                 frame.queries.size()),
+			             frame.queries.data());
+			VEGAM_CHECK_GL_ERROR;
+			glGenQueries(static_cast<GLsizei>(
+			                 frame.frameQueries.size()),
+			             frame.frameQueries.data());
+			VEGAM_CHECK_GL_ERROR;
+			frame.zoneCount = 0;
+			frame.frameTimed = false;
+		}
+		frameIndex = 0;
+		initialized = true;
+	}
+
+	void Shutdown()
+	{
+		if (!initialized)
+		{
+			return;
+		}
+		for (auto& frame : frames)
+		{
+			glDeleteQueries(static_cast<GLsizei>(
+			                    frame.queries.size()),
+			                frame.queries.data());
+			VEGAM_CHECK_GL_ERROR;
+			glDeleteQueries(static_cast<GLsizei>(
+			                    frame.frameQueries.size()),
+			                frame.frameQueries.data());
+			VEGAM_CHECK_GL_ERROR;
+			frame.zoneCount = 0;
+		}
+		initialized = false;
+	}
+
+	void BeginFrame()
+	{
+		if (!initialized)
+		{
+			return;
+		}
+
+		// This slot was last used FrameLatency frames ago.
+		auto& frame = CurrentFrame();
+		Resolve(frame);
+		frame.zoneCount = 0;
+
+		glGetInteger64v(GL_TIMESTAMP, &frame.gpuBase);
+		VEGAM_CHECK_GL_ERROR;
+		frame.cpuBase = Core::Profiler::Now();
+		glQueryCounter(frame.frameQueries[0], GL_TIMESTAMP);
+		VEGAM_CHECK_GL_ERROR;
+		depth = 0;
+		inFrame = true;
+	}
+
+	void EndFrame()
+	{
+		if (!inFrame)
+		{
+			return;
+		}
+		inFrame = false;
+		auto& frame = CurrentFrame();
+		glQueryCounter(frame.frameQueries[1], GL_TIMESTAMP);
+		VEGAM_CHECK_GL_ERROR;
+		frame.frameTimed = true;
+		++frameIndex;
+	}
+
+	float GetFrameMs()
+	{
+		return frameMs.load(std::memory_order_relaxed);
+	}
+
+	Scope::Scope(const char* name)
+	    : m_zone(-1)
+	{
+		auto& frame = CurrentFrame();
+		if (!inFrame || frame.zoneCount >= MaxZonesPerFrame)
+		{
+			return;
+		}
+
+		m_zone = static_cast<int32_t>(frame.zoneCount++);
+		frame.names[m_zone] = name;
+		frame.depths[m_zone] = depth++;
+		frame.lastQuery = frame.queries[m_zone * 2];
+		glQueryCounter(frame.lastQuery, GL_TIMESTAMP);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	Scope::~Scope()
+	{
+		if (m_zone < 0)
+		{
+			return;
+		}
+
+		--depth;
+		auto& frame = CurrentFrame();
+		frame.lastQuery = frame.queries[m_zone * 2 + 1];
+		glQueryCounter(frame.lastQuery, GL_TIMESTAMP);
+		VEGAM_CHECK_GL_ERROR;
+	}
+} // namespace AthiVegam::Graphics::GpuProfiler
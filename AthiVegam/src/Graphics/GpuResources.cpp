@@ -0,0 +1,358 @@
+#include "AthiVegam/Graphics/GpuResources.h"
+
+#include "external/imgui/imgui.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace AthiVegam::Graphics::GpuResources
+{
+	namespace
+	{
+		thread_local const std::source_location* currentSite =
+		    nullptr;
+		thread_local std::source_location scopeSite;
+	} // namespace
+
+	const char* GetTypeName(Type type)
+	{
+		constexpr std::array<const char*, (int)Type::Count>
+		    names{"VertexArray",  "Buffer",
+		          "Program",      "Texture",
+		          "Renderbuffer", "Framebuffer"};
+		return names[static_cast<int>(type)];
+	}
+
+	SiteScope::SiteScope(std::source_location site)
+	    : m_owner(currentSite == nullptr)
+	{
+		if (m_owner)
+		{
+			scopeSite = site;
+			currentSite = &scopeSite;
+		}
+	}
+
+	SiteScope::~SiteScope()
+	{
+		if (m_owner)
+		{
+			currentSite = nullptr;
+		}
+	}
+
+	namespace
+	{
+		struct Entry
+		{
+			Type type;
+			uint32_t id;
+			uint32_t owner;
+			size_t bytes;
+			const char* label;
+			std::source_location site;
+			uint64_t createdFrame;
+			// UINT64_MAX until first bound.
+			uint64_t lastBoundFrame;
+			uint64_t binds;
+		};
+
+		inline uint64_t Key(Type type, uint32_t id)
+		{
+			return static_cast<uint64_t>(type) << 32 | id;
+		}
+
+		// Resources are created on the GL thread but the
+		// panel may draw on the main thread.
+		std::mutex mutex;
+		std::unordered_map<uint64_t, Entry> entries;
+		std::array<size_t, (int)Type::Count> totals{};
+		uint64_t frame = 0;
+	} // namespace
+
+	void Register(Type type, uint32_t id, size_t bytes,
+	              const char* label, uint32_t owner,
+	              std::source_location site)
+	{
+		if (id == 0)
+		{
+			return;
+		}
+
+		std::lock_guard lock(mutex);
+		auto& entry = entries[Key(type, id)];
+		auto& total = totals[static_cast<int>(type)];
+		total += bytes - entry.bytes;
+		entry = Entry{type,
+		              id,
+		              owner,
+		              bytes,
+		              label,
+		              currentSite ? *currentSite : site,
+		              frame,
+		              UINT64_MAX,
+		              0};
+	}
+
+	void Resize(Type type, uint32_t id, size_t bytes)
+	{
+		std::lock_guard lock(mutex);
+		const auto it = entries.find(Key(type, id));
+		if (it != entries.end())
+		{
+			totals[static_cast<int>(type)] +=
+			    bytes - it->second.bytes;
+			it->second.bytes = bytes;
+		}
+	}
+
+	void Unregister(Type type, uint32_t id)
+	{
+		std::lock_guard lock(mutex);
+		const auto it = entries.find(Key(type, id));
+		if (it != entries.end())
+		{
+			totals[static_cast<int>(type)] -= it->second.bytes;
+			entries.erase(it);
+		}
+	}
+
+	size_t GetBytes(Type type)
+	{
+		std::lock_guard lock(mutex);
+		return totals[static_cast<int>(type)];
+	}
+
+	void EndFrame()
+	{
+		std::lock_guard lock(mutex);
+		++frame;
+	}
+
+#ifndef AV_CONFIG_SHIPPING
+	namespace
+	{
+		// Panel state.
+		ImGuiTextFilter filter;
+		int staleFrames = 0;
+
+		const char* FileName(const char* path)
+		{
+			const char* name = path;
+			for (const char* c = path; *c; ++c)
+			{
+				if (*c == '/' || *c == '\\')
+				{
+					name = c + 1;
+				}
+			}
+			return name;
+		}
+	} // namespace
+
+	void MarkBound(Type type, uint32_t id)
+	{
+		std::lock_guard lock(mutex);
+		const auto it = entries.find(Key(type, id));
+		if (it != entries.end())
+		{
+			it->second.lastBoundFrame = frame;
+			++it->second.binds;
+		}
+	}
+
+	void DrawPanel()
+	{
+		if (!ImGui::Begin("GPU Resources"))
+		{
+			ImGui::End();
+			return;
+		}
+
+		std::vector<Entry> rows;
+		uint64_t currentFrame;
+		{
+			std::lock_guard lock(mutex);
+			currentFrame = frame;
+			rows.reserve(entries.size());
+			for (const auto& [key, entry] : entries)
+			{
+				auto row = entry;
+				// Buffers are bound through their VAO.
+				if (row.owner != 0)
+				{
+					const auto owner = entries.find(
+					    Key(Type::VertexArray, row.owner));
+					if (owner != entries.end())
+					{
+						row.lastBoundFrame =
+						    owner->second.lastBoundFrame;
+						row.binds = owner->second.binds;
+					}
+				}
+				rows.push_back(row);
+			}
+		}
+
+		std::array<size_t, (int)Type::Count> counts{};
+		std::array<size_t, (int)Type::Count> bytes{};
+		size_t totalBytes = 0;
+		for (const auto& row : rows)
+		{
+			++counts[static_cast<int>(row.type)];
+			bytes[static_cast<int>(row.type)] += row.bytes;
+			totalBytes += row.bytes;
+		}
+		for (int i = 0; i < (int)Type::Count; ++i)
+		{
+			if (counts[i] > 0)
+			{
+				ImGui::Text("%-12s %6zu live %10.2f MB",
+				            GetTypeName(static_cast<Type>(i)),
+				            counts[i], bytes[i] / 1048576.0);
+			}
+		}
+		ImGui::Text("Total %zu objects, %.2f MB", rows.size(),
+		            totalBytes / 1048576.0);
+
+		filter.Draw("Filter");
+		ImGui::InputInt("Unbound for frames", &staleFrames);
+		staleFrames = std::max(staleFrames, 0);
+
+		const auto isShown = [&](const Entry& row) {
+			if (staleFrames > 0 && row.lastBoundFrame != UINT64_MAX
+			    && currentFrame - row.lastBoundFrame
+			           < static_cast<uint64_t>(staleFrames))
+			{
+				return false;
+			}
+			return filter.PassFilter(row.label)
+			       || filter.PassFilter(
+			           FileName(row.site.file_name()))
+			       || filter.PassFilter(
+			           GetTypeName(row.type));
+		};
+		std::erase_if(rows, [&](const Entry& row) {
+			return !isShown(row);
+		});
+
+		constexpr auto flags =
+		    ImGuiTableFlags_Sortable | ImGuiTableFlags_RowBg
+		    | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable
+		    | ImGuiTableFlags_BordersInnerV;
+		if (!ImGui::BeginTable("Resources", 8, flags))
+		{
+			ImGui::End();
+			return;
+		}
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Type");
+		ImGui::TableSetupColumn("Id");
+		ImGui::TableSetupColumn("Label");
+		ImGui::TableSetupColumn(
+		    "Bytes", ImGuiTableColumnFlags_DefaultSort
+		                 | ImGuiTableColumnFlags_PreferSortDescending);
+		ImGui::TableSetupColumn("Site");
+		ImGui::TableSetupColumn("Created");
+		ImGui::TableSetupColumn("Last bound");
+		ImGui::TableSetupColumn("Binds");
+		ImGui::TableHeadersRow();
+
+		if (const auto* specs = ImGui::TableGetSortSpecs();
+		    specs && specs->SpecsCount > 0)
+		{
+			const auto& spec = specs->Specs[0];
+			const auto field = [&](const Entry& row) {
+				switch (spec.ColumnIndex)
+				{
+				case 0: return static_cast<uint64_t>(row.type);
+				case 1: return static_cast<uint64_t>(row.id);
+				case 3: return static_cast<uint64_t>(row.bytes);
+				case 5: return row.createdFrame;
+				case 6: return row.lastBoundFrame;
+				case 7: return row.binds;
+				default: return uint64_t{0};
+				}
+			};
+			const bool ascending =
+			    spec.SortDirection
+			    == ImGuiSortDirection_Ascending;
+			std::stable_sort(
+			    rows.begin(), rows.end(),
+			    [&](const Entry& a, const Entry& b) {
+				    if (spec.ColumnIndex == 2)
+				    {
+					    const auto order =
+					        std::strcmp(a.label, b.label);
+					    return ascending ? order < 0
+					                     : order > 0;
+				    }
+				    if (spec.ColumnIndex == 4)
+				    {
+					    const auto order = std::strcmp(
+					        a.site.file_name(),
+					        b.site.file_name());
+					    return ascending ? order < 0
+					                     : order > 0;
+				    }
+				    return ascending ? field(a) < field(b)
+				                     : field(a) > field(b);
+			    });
+		}
+
+		ImGuiListClipper clipper;
+		clipper.Begin(static_cast<int>(rows.size()));
+		while (clipper.Step())
+		{
+			for (int i = clipper.DisplayStart;
+			     i < clipper.DisplayEnd; ++i)
+			{
+				const auto& row = rows[i];
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(GetTypeName(row.type));
+				ImGui::TableNextColumn();
+				ImGui::Text("%u", row.id);
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(row.label);
+				ImGui::TableNextColumn();
+				ImGui::Text("%zu", row.bytes);
+				ImGui::TableNextColumn();
+				ImGui::Text("%s:%u",
+				            FileName(row.site.file_name()),
+				            row.site.line());
+				if (ImGui::IsItemHovered())
+				{
+					ImGui::SetTooltip(
+					    "%s", row.site.function_name());
+				}
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", static_cast<unsigned long long>(
+				                        row.createdFrame));
+				ImGui::TableNextColumn();
+				if (row.lastBoundFrame == UINT64_MAX)
+				{
+					ImGui::TextUnformatted("never");
+				}
+				else
+				{
+					ImGui::Text(
+					    "%llu",
+					    static_cast<unsigned long long>(
+					        row.lastBoundFrame));
+				}
+				ImGui::TableNextColumn();
+				ImGui::Text(
+				    "%llu",
+				    static_cast<unsigned long long>(row.binds));
+			}
+		}
+		ImGui::EndTable();
+		ImGui::End();
+	}
+#endif // AV_CONFIG_SHIPPING
+} // namespace AthiVegam::Graphics::GpuResources
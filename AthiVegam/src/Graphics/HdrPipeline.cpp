@@ -0,0 +1,594 @@
+#include "AthiVegam/Graphics/HdrPipeline.h"
+
+#include "AthiVegam/Core/CVar.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/ComputeProgram.h"
+#include "AthiVegam/Graphics/GLState.h"
+#include "AthiVegam/Graphics/GpuProfiler.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		Core::CVar<float> exposureCVar(
+		    "r.exposure", 1.0f,
+		    "Scales the HDR scene before tonemapping");
+		Core::CVar<float> bloomIntensityCVar(
+		    "r.bloomIntensity", 0.05f,
+		    "Amount of bloom added to the HDR scene");
+		Core::CVar<float> bloomThresholdCVar(
+		    "r.bloomThreshold", 1.0f,
+		    "HDR brightness where bloom starts; negative "
+		    "blooms everything");
+		Core::CVar<float> contrastCVar(
+		    "r.contrast", 1.0f,
+		    "Contrast of the tonemapped image around mid grey");
+		Core::CVar<float> saturationCVar(
+		    "r.saturation", 1.0f,
+		    "Saturation of the tonemapped image");
+
+		constexpr int GroupSize = 8;
+		constexpr uint32_t SceneUnit = 0;
+		constexpr uint32_t BloomUnit = 1;
+
+		// Destination texel p filters source texels 2p - 1
+		// to 2p + 2 with weights (1, 3, 3, 1) each way, so a
+		// group's outputs read an 18x18 tile: loaded once
+		// into shared memory rather than fetched 16 times
+		// per texel. The first level also keeps only what is
+		// above the threshold, with a soft knee.
+		const char* DownsampleSource = R"(#version 430 core
+layout(local_size_x = 8, local_size_y = 8) in;
+
+uniform sampler2D Source;
+uniform int SourceLevel;
+// Negative passes every texel.
+uniform float Threshold;
+layout(rgba16f, binding = 0) writeonly uniform image2D Destination;
+
+const int Tile = 18;
+shared vec3 tile[Tile * Tile];
+
+vec3 Prefilter(vec3 color)
+{
+	if (Threshold < 0.0)
+	{
+		return color;
+	}
+	float brightness = max(color.r, max(color.g, color.b));
+	float knee = 0.5 * Threshold;
+	float soft = clamp(brightness - Threshold + knee, 0.0,
+	                   2.0 * knee);
+	soft = soft * soft / (4.0 * knee + 1e-4);
+	return color * max(soft, brightness - Threshold)
+	       / max(brightness, 1e-4);
+}
+
+void main()
+{
+	ivec2 sourceSize = textureSize(Source, SourceLevel);
+	ivec2 origin = ivec2(gl_WorkGroupID.xy) * 16 - 1;
+	for (uint i = gl_LocalInvocationIndex; i < Tile * Tile;
+	     i += 64)
+	{
+		ivec2 texel = origin + ivec2(i % Tile, i / Tile);
+		texel = clamp(texel, ivec2(0), sourceSize - 1);
+		tile[i] = Prefilter(
+		    texelFetch(Source, texel, SourceLevel).rgb);
+	}
+	barrier();
+
+	ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(p, imageSize(Destination))))
+	{
+		return;
+	}
+	const float weights[4] = float[](1.0, 3.0, 3.0, 1.0);
+	ivec2 first = ivec2(gl_LocalInvocationID.xy) * 2;
+	vec3 sum = vec3(0.0);
+	for (int y = 0; y < 4; ++y)
+	{
+		for (int x = 0; x < 4; ++x)
+		{
+			sum += weights[x] * weights[y]
+			       * tile[(first.y + y) * Tile + first.x + x];
+		}
+	}
+	imageStore(Destination, p, vec4(sum / 64.0, 1.0));
+}
+)";
+
+		// Adds the smaller level, through a 3x3 tent of
+		// bilinear taps, to the destination level in place.
+		const char* UpsampleSource = R"(#version 430 core
+layout(local_size_x = 8, local_size_y = 8) in;
+
+uniform sampler2D Source;
+uniform int SourceLevel;
+layout(rgba16f, binding = 0) uniform image2D Destination;
+
+void main()
+{
+	ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+	ivec2 size = imageSize(Destination);
+	if (any(greaterThanEqual(p, size)))
+	{
+		return;
+	}
+	vec2 uv = (vec2(p) + 0.5) / vec2(size);
+	vec2 texel = 1.0 / vec2(textureSize(Source, SourceLevel));
+	vec3 sum = vec3(0.0);
+	for (int y = -1; y <= 1; ++y)
+	{
+		for (int x = -1; x <= 1; ++x)
+		{
+			float weight = float((2 - abs(x)) * (2 - abs(y)));
+			sum += weight
+			       * textureLod(Source, uv + vec2(x, y) * texel,
+			                    float(SourceLevel)).rgb;
+		}
+	}
+	vec3 destination = imageLoad(Destination, p).rgb;
+	imageStore(Destination, p, vec4(destination + sum / 16.0,
+	                                1.0));
+}
+)";
+
+		// One triangle covering the screen.
+		const char* TonemapVertexSource = R"(#version 430 core
+out vec2 FragUV;
+
+void main()
+{
+	vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	FragUV = corner;
+	gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+		const char* TonemapFragmentSource = R"(#version 430 core
+in vec2 FragUV;
+
+uniform sampler2D Scene;
+uniform sampler2D Bloom;
+uniform float Exposure;
+uniform float BloomIntensity;
+uniform float Contrast;
+uniform float Saturation;
+uniform int EncodeSrgb;
+
+layout(location = 0) out vec4 OutColor;
+
+// Narkowicz's fit of the ACES filmic curve.
+vec3 Aces(vec3 x)
+{
+	return clamp((x * (2.51 * x + 0.03))
+	                 / (x * (2.43 * x + 0.59) + 0.14),
+	             0.0, 1.0);
+}
+
+void main()
+{
+	vec3 color = texelFetch(Scene, ivec2(gl_FragCoord.xy), 0).rgb;
+	color += BloomIntensity * textureLod(Bloom, FragUV, 0.0).rgb;
+	color = Aces(color * Exposure);
+
+	color = clamp((color - 0.5) * Contrast + 0.5, 0.0, 1.0);
+	float luma = dot(color, vec3(0.2126, 0.7152, 0.0722));
+	color = clamp(mix(vec3(luma), color, Saturation), 0.0, 1.0);
+
+	if (EncodeSrgb != 0)
+	{
+		color = mix(color * 12.92,
+		            1.055 * pow(color, vec3(1.0 / 2.4)) - 0.055,
+		            step(0.0031308, color));
+	}
+	OutColor = vec4(color, 1.0);
+}
+)";
+
+		inline GLint Location(uint32_t program,
+		                      const char* name)
+		{
+			const auto location =
+			    glGetUniformLocation(program, name);
+			VEGAM_CHECK_GL_ERROR;
+			return location;
+		}
+
+		inline GLuint Groups(int size)
+		{
+			return static_cast<GLuint>((size + GroupSize - 1)
+			                           / GroupSize);
+		}
+
+		inline int LevelSize(int size, int level)
+		{
+			return std::max(size >> level, 1);
+		}
+
+		uint32_t CreateTexture(int width, int height,
+		                       int levels, GLenum minFilter,
+		                       const char* label)
+		{
+			GLuint texture = 0;
+			glGenTextures(1, &texture);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D, texture);
+			VEGAM_CHECK_GL_ERROR;
+			glTexStorage2D(GL_TEXTURE_2D, levels, GL_RGBA16F,
+			               width, height);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D,
+			                GL_TEXTURE_MIN_FILTER, minFilter);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D,
+			                GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
+			                GL_CLAMP_TO_EDGE);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
+			                GL_CLAMP_TO_EDGE);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D, 0);
+			VEGAM_CHECK_GL_ERROR;
+
+			// 8 bytes per texel, a third more for mips.
+			auto bytes =
+			    static_cast<size_t>(width) * height * 8;
+			if (levels > 1)
+			{
+				bytes = bytes * 4 / 3;
+			}
+			GpuResources::Register(GpuResources::Type::Texture,
+			                       texture, bytes, label);
+			return texture;
+		}
+
+		void DeleteTexture(uint32_t& texture)
+		{
+			if (texture == 0)
+			{
+				return;
+			}
+			GpuResources::Unregister(GpuResources::Type::Texture,
+			                         texture);
+			glDeleteTextures(1, &texture);
+			VEGAM_CHECK_GL_ERROR;
+			texture = 0;
+		}
+	} // namespace
+
+	HdrPipeline::HdrPipeline() = default;
+
+	HdrPipeline::~HdrPipeline()
+	{
+		VEGAM_ASSERT(!IsInitialized() && m_framebuffer == 0,
+		             "HdrPipeline destroyed without Shutdown()");
+	}
+
+	bool HdrPipeline::Initialize()
+	{
+		if (IsInitialized())
+		{
+			return true;
+		}
+		if (!GLAD_GL_VERSION_4_3)
+		{
+			VEGAM_WARN("HDR rendering needs a GL 4.3 context");
+			return false;
+		}
+
+		m_downsampleProgram = CreateComputeProgram(
+		    DownsampleSource, "Bloom downsample");
+		m_upsampleProgram = CreateComputeProgram(
+		    UpsampleSource, "Bloom upsample");
+		m_tonemapShader = std::make_unique<Shader>(
+		    TonemapVertexSource, TonemapFragmentSource);
+		if (!m_downsampleProgram || !m_upsampleProgram
+		    || !m_tonemapShader->IsReady())
+		{
+			Shutdown();
+			return false;
+		}
+		glProgramUniform1i(
+		    m_downsampleProgram,
+		    Location(m_downsampleProgram, "Source"),
+		    SceneUnit);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1i(m_upsampleProgram,
+		                   Location(m_upsampleProgram, "Source"),
+		                   SceneUnit);
+		VEGAM_CHECK_GL_ERROR;
+		m_tonemapShader->SetUniformInt("Scene", SceneUnit);
+		m_tonemapShader->SetUniformInt("Bloom", BloomUnit);
+		m_exposureUniform =
+		    m_tonemapShader->GetUniform<float>("Exposure");
+		m_bloomIntensityUniform =
+		    m_tonemapShader->GetUniform<float>("BloomIntensity");
+		m_contrastUniform =
+		    m_tonemapShader->GetUniform<float>("Contrast");
+		m_saturationUniform =
+		    m_tonemapShader->GetUniform<float>("Saturation");
+		m_encodeSrgbUniform =
+		    m_tonemapShader->GetUniform<int>("EncodeSrgb");
+
+		glGenVertexArrays(1, &m_vao);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::VertexArray,
+		                       m_vao, 0, "Tonemap");
+		VEGAM_INFO("HDR rendering enabled");
+		return true;
+	}
+
+	void HdrPipeline::Shutdown()
+	{
+		DestroyTargets();
+		DeleteComputeProgram(m_downsampleProgram);
+		DeleteComputeProgram(m_upsampleProgram);
+		m_tonemapShader.reset();
+		if (m_vao != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::VertexArray, m_vao);
+			glDeleteVertexArrays(1, &m_vao);
+			VEGAM_CHECK_GL_ERROR;
+			m_vao = 0;
+		}
+	}
+
+	void HdrPipeline::DestroyTargets()
+	{
+		if (m_framebuffer != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Framebuffer, m_framebuffer);
+			glDeleteFramebuffers(1, &m_framebuffer);
+			VEGAM_CHECK_GL_ERROR;
+			m_framebuffer = 0;
+		}
+		if (m_depth != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Renderbuffer, m_depth);
+			glDeleteRenderbuffers(1, &m_depth);
+			VEGAM_CHECK_GL_ERROR;
+			m_depth = 0;
+		}
+		DeleteTexture(m_color);
+		DeleteTexture(m_bloom);
+		m_bloomLevels = 0;
+		m_width = 0;
+		m_height = 0;
+	}
+
+	bool HdrPipeline::Resize(int displayWidth,
+	                         int displayHeight)
+	{
+		VEGAM_ASSERT(IsInitialized(),
+		             "HdrPipeline used before Initialize()");
+		DestroyTargets();
+		m_width = displayWidth;
+		m_height = displayHeight;
+
+		m_color = CreateTexture(displayWidth, displayHeight, 1,
+		                        GL_NEAREST, "HDR scene");
+		glGenRenderbuffers(1, &m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		glBindRenderbuffer(GL_RENDERBUFFER, m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		glRenderbufferStorage(GL_RENDERBUFFER,
+		                      GL_DEPTH24_STENCIL8, displayWidth,
+		                      displayHeight);
+		VEGAM_CHECK_GL_ERROR;
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		glGenFramebuffers(1, &m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glFramebufferTexture2D(GL_FRAMEBUFFER,
+		                       GL_COLOR_ATTACHMENT0,
+		                       GL_TEXTURE_2D, m_color, 0);
+		VEGAM_CHECK_GL_ERROR;
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER,
+		                          GL_DEPTH_STENCIL_ATTACHMENT,
+		                          GL_RENDERBUFFER, m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		const auto status =
+		    glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::Framebuffer,
+		                       m_framebuffer, 0, "HDR scene");
+		GpuResources::Register(
+		    GpuResources::Type::Renderbuffer, m_depth,
+		    static_cast<size_t>(displayWidth) * displayHeight
+		        * 4,
+		    "HDR scene depth");
+		if (status != GL_FRAMEBUFFER_COMPLETE)
+		{
+			VEGAM_ERROR("HDR target {}x{} incomplete: {:#x}",
+			            displayWidth, displayHeight, status);
+			DestroyTargets();
+			return false;
+		}
+
+		// Down to where a level would be a few texels.
+		const auto bloomWidth = LevelSize(displayWidth, 1);
+		const auto bloomHeight = LevelSize(displayHeight, 1);
+		m_bloomLevels = 1;
+		while (m_bloomLevels < static_cast<int>(MaxBloomLevels)
+		       && std::min(bloomWidth, bloomHeight)
+		                  >> m_bloomLevels
+		              >= 4)
+		{
+			++m_bloomLevels;
+		}
+		m_bloom = CreateTexture(bloomWidth, bloomHeight,
+		                        m_bloomLevels,
+		                        GL_LINEAR_MIPMAP_NEAREST,
+		                        "Bloom");
+		return true;
+	}
+
+	bool HdrPipeline::BeginFrame(int displayWidth,
+	                             int displayHeight)
+	{
+		if (!IsInitialized())
+		{
+			return false;
+		}
+		if ((m_framebuffer == 0 || displayWidth != m_width
+		     || displayHeight != m_height)
+		    && !Resize(displayWidth, displayHeight))
+		{
+			return false;
+		}
+		Bind();
+		return true;
+	}
+
+	void HdrPipeline::Bind() const
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glViewport(0, 0, m_width, m_height);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void HdrPipeline::Resolve(uint32_t displayFramebuffer,
+	                          bool srgbFramebuffer)
+	{
+		VEGAM_PROFILE_SCOPE("HdrPipeline::Resolve");
+		VEGAM_PROFILE_GPU_SCOPE("HDR resolve");
+		Bloom();
+		Tonemap(displayFramebuffer, srgbFramebuffer);
+	}
+
+	void HdrPipeline::Bloom()
+	{
+		const auto sourceLevel =
+		    Location(m_downsampleProgram, "SourceLevel");
+		const auto threshold =
+		    Location(m_downsampleProgram, "Threshold");
+		glActiveTexture(GL_TEXTURE0 + SceneUnit);
+		VEGAM_CHECK_GL_ERROR;
+
+		// Level 0 is the prefiltered scene at half size,
+		// every further level half the one before.
+		Shader::UseProgram(m_downsampleProgram);
+		const auto bloomWidth = LevelSize(m_width, 1);
+		const auto bloomHeight = LevelSize(m_height, 1);
+		for (int level = 0; level < m_bloomLevels; ++level)
+		{
+			glBindTexture(GL_TEXTURE_2D,
+			              level == 0 ? m_color : m_bloom);
+			VEGAM_CHECK_GL_ERROR;
+			glProgramUniform1i(m_downsampleProgram, sourceLevel,
+			                   level == 0 ? 0 : level - 1);
+			VEGAM_CHECK_GL_ERROR;
+			glProgramUniform1f(
+			    m_downsampleProgram, threshold,
+			    level == 0 ? bloomThresholdCVar.Get() : -1.0f);
+			VEGAM_CHECK_GL_ERROR;
+			glBindImageTexture(0, m_bloom, level, GL_FALSE, 0,
+			                   GL_WRITE_ONLY, GL_RGBA16F);
+			VEGAM_CHECK_GL_ERROR;
+			glDispatchCompute(
+			    Groups(LevelSize(bloomWidth, level)),
+			    Groups(LevelSize(bloomHeight, level)), 1);
+			VEGAM_CHECK_GL_ERROR;
+			glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT
+			                | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+			VEGAM_CHECK_GL_ERROR;
+		}
+
+		// Smallest first, so each level carries every
+		// smaller one into the next.
+		Shader::UseProgram(m_upsampleProgram);
+		glBindTexture(GL_TEXTURE_2D, m_bloom);
+		VEGAM_CHECK_GL_ERROR;
+		const auto upsampleLevel =
+		    Location(m_upsampleProgram, "SourceLevel");
+		for (int level = m_bloomLevels - 2; level >= 0; --level)
+		{
+			glProgramUniform1i(m_upsampleProgram, upsampleLevel,
+			                   level + 1);
+			VEGAM_CHECK_GL_ERROR;
+			glBindImageTexture(0, m_bloom, level, GL_FALSE, 0,
+			                   GL_READ_WRITE, GL_RGBA16F);
+			VEGAM_CHECK_GL_ERROR;
+			glDispatchCompute(
+			    Groups(LevelSize(bloomWidth, level)),
+			    Groups(LevelSize(bloomHeight, level)), 1);
+			VEGAM_CHECK_GL_ERROR;
+			glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT
+			                | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_READ_ONLY,
+		                   GL_RGBA16F);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void HdrPipeline::Tonemap(uint32_t displayFramebuffer,
+	                          bool srgbFramebuffer)
+	{
+		// The state cache of the render manager is reset
+		// at its next flush.
+		glBindFramebuffer(GL_FRAMEBUFFER, displayFramebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glViewport(0, 0, m_width, m_height);
+		VEGAM_CHECK_GL_ERROR;
+		GLState::SetEnabled(GLState::Capability::Blend, false);
+		GLState::SetEnabled(GLState::Capability::DepthTest,
+		                    false);
+		GLState::SetEnabled(GLState::Capability::CullFace,
+		                    false);
+		GLState::SetEnabled(GLState::Capability::ScissorTest,
+		                    false);
+		GLState::SetColorMask(true);
+		GLState::SetPolygonMode(GL_FILL);
+
+		glActiveTexture(GL_TEXTURE0 + SceneUnit);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, m_color);
+		VEGAM_CHECK_GL_ERROR;
+		glActiveTexture(GL_TEXTURE0 + BloomUnit);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, m_bloom);
+		VEGAM_CHECK_GL_ERROR;
+
+		auto& shader = *m_tonemapShader;
+		shader.Set(m_exposureUniform, exposureCVar.Get());
+		shader.Set(m_bloomIntensityUniform,
+		           bloomIntensityCVar.Get());
+		shader.Set(m_contrastUniform, contrastCVar.Get());
+		shader.Set(m_saturationUniform, saturationCVar.Get());
+		shader.Set(m_encodeSrgbUniform,
+		           srgbFramebuffer ? 0 : 1);
+		Shader::UseProgram(shader.GetId());
+		glBindVertexArray(m_vao);
+		VEGAM_CHECK_GL_ERROR;
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		VEGAM_CHECK_GL_ERROR;
+		glBindVertexArray(0);
+		VEGAM_CHECK_GL_ERROR;
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+		VEGAM_CHECK_GL_ERROR;
+		glActiveTexture(GL_TEXTURE0 + SceneUnit);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, 0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+} // namespace AthiVegam::Graphics
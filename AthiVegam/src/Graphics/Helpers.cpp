@@ -7,6 +7,102 @@
 
 namespace AthiVegam::Graphics
 {
+	namespace
+	{
+		const char* GetSourceName(GLenum source)
+		{
+			switch (source)
+			{
+			case GL_DEBUG_SOURCE_API:
+				return "API";
+			case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
+				return "Window system";
+			case GL_DEBUG_SOURCE_SHADER_COMPILER:
+				return "Shader compiler";
+			case GL_DEBUG_SOURCE_THIRD_PARTY:
+				return "Third party";
+			case GL_DEBUG_SOURCE_APPLICATION:
+				return "Application";
+			default:
+				return "Other";
+			}
+		}
+
+		const char* GetTypeName(GLenum type)
+		{
+			switch (type)
+			{
+			case GL_DEBUG_TYPE_ERROR:
+				return "Error";
+			case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+				return "Deprecated";
+			case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+				return "Undefined behavior";
+			case GL_DEBUG_TYPE_PORTABILITY:
+				return "Portability";
+			case GL_DEBUG_TYPE_PERFORMANCE:
+				return "Performance";
+			default:
+				return "Other";
+			}
+		}
+
+		// May run on a driver thread when output is
+		// asynchronous; the logger is thread safe.
+		void APIENTRY OnDebugMessage(GLenum source,
+		                             GLenum type, GLuint id,
+		                             GLenum severity,
+		                             GLsizei length,
+		                             const GLchar* message,
+		                             const void* userParam)
+		{
+			switch (severity)
+			{
+			case GL_DEBUG_SEVERITY_HIGH:
+				VEGAM_ERROR("OpenGL {} {} ({}): {}",
+				            GetSourceName(source),
+				            GetTypeName(type), id, message);
+				break;
+			case GL_DEBUG_SEVERITY_MEDIUM:
+				VEGAM_WARN("OpenGL {} {} ({}): {}",
+				           GetSourceName(source),
+				           GetTypeName(type), id, message);
+				break;
+			case GL_DEBUG_SEVERITY_LOW:
+				VEGAM_INFO("OpenGL {} {} ({}): {}",
+				           GetSourceName(source),
+				           GetTypeName(type), id, message);
+				break;
+			default:
+				// Notifications are too chatty to log.
+				break;
+			}
+		}
+	} // namespace
+
+	bool EnableDebugOutput(bool synchronous)
+	{
+		if (!GLAD_GL_VERSION_4_3 || !glDebugMessageCallback)
+		{
+			return false;
+		}
+
+		glEnable(GL_DEBUG_OUTPUT);
+		if (synchronous)
+		{
+			glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+		}
+		else
+		{
+			glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+		}
+		glDebugMessageCallback(OnDebugMessage, nullptr);
+		glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE,
+		                      GL_DEBUG_SEVERITY_NOTIFICATION,
+		                      0, nullptr, GL_FALSE);
+		return true;
+	}
+
 	void CheckOpenGLError()
 	{
 		GLenum error = glGetError();
@@ -0,0 +1,373 @@
+#include "AthiVegam/Graphics/ImGuiRenderer.h"
+
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Graphics/GLState.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Graphics/StreamBuffer.h"
+#include "AthiVegam/Log.h"
+#include "external/imgui/imgui.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		constexpr size_t InitialVertexCount = 64 * 1024;
+		constexpr size_t InitialIndexCount = 128 * 1024;
+
+		constexpr auto UiIndexType = sizeof(ImDrawIdx) == 2
+		                                 ? IndexType::UInt16
+		                                 : IndexType::UInt32;
+
+		const char* VertexSource = R"(#version 410 core
+layout(location = 0) in vec2 Position;
+layout(location = 1) in vec2 UV;
+layout(location = 2) in vec4 Color;
+
+// xy scale, zw translation to clip space.
+uniform vec4 Transform;
+
+out vec2 FragUV;
+out vec4 FragColor;
+
+void main()
+{
+	FragUV = UV;
+	FragColor = Color;
+	gl_Position =
+	    vec4(Position * Transform.xy + Transform.zw, 0, 1);
+}
+)";
+
+		const char* FragmentSource = R"(#version 410 core
+in vec2 FragUV;
+in vec4 FragColor;
+
+uniform sampler2D Texture;
+
+layout(location = 0) out vec4 OutColor;
+
+void main()
+{
+	OutColor = FragColor * texture(Texture, FragUV);
+}
+)";
+	} // namespace
+
+	ImGuiRenderer::ImGuiRenderer()
+	    : m_commands(16 * 1024)
+	{
+	}
+
+	ImGuiRenderer::~ImGuiRenderer() = default;
+
+	void ImGuiRenderer::Initialize()
+	{
+		auto& io = ImGui::GetIO();
+		io.BackendRendererName = "AthiVegam";
+		io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+
+		m_shader = std::make_unique<Shader>(VertexSource,
+		                                    FragmentSource);
+		m_shader->SetUniformInt("Texture", 0);
+
+		unsigned char* pixels = nullptr;
+		int width = 0;
+		int height = 0;
+		io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+		glGenTextures(1, &m_fontTexture);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, m_fontTexture);
+		VEGAM_CHECK_GL_ERROR;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+		                GL_LINEAR);
+		VEGAM_CHECK_GL_ERROR;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+		                GL_LINEAR);
+		VEGAM_CHECK_GL_ERROR;
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		VEGAM_CHECK_GL_ERROR;
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height,
+		             0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, 0);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(
+		    GpuResources::Type::Texture, m_fontTexture,
+		    static_cast<size_t>(width) * height * 4,
+		    "ImGui font atlas");
+		io.Fonts->SetTexID(reinterpret_cast<ImTextureID>(
+		    static_cast<intptr_t>(m_fontTexture)));
+
+		Reserve(InitialVertexCount, InitialIndexCount);
+	}
+
+	void ImGuiRenderer::Shutdown()
+	{
+		if (m_vao)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::VertexArray, m_vao);
+			glDeleteVertexArrays(1, &m_vao);
+			VEGAM_CHECK_GL_ERROR;
+			m_vao = 0;
+		}
+		if (m_fontTexture)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Texture, m_fontTexture);
+			glDeleteTextures(1, &m_fontTexture);
+			VEGAM_CHECK_GL_ERROR;
+			m_fontTexture = 0;
+			ImGui::GetIO().Fonts->SetTexID(nullptr);
+		}
+		m_vertices.reset();
+		m_indices.reset();
+		m_shader.reset();
+		m_vertexCapacity = 0;
+		m_indexCapacity = 0;
+		m_uploaded = false;
+	}
+
+	void ImGuiRenderer::Reserve(size_t vertexCount,
+	                            size_t indexCount)
+	{
+		if (vertexCount <= m_vertexCapacity
+		    && indexCount <= m_indexCapacity)
+		{
+			return;
+		}
+
+		m_vertexCapacity =
+		    std::max(vertexCount, m_vertexCapacity * 2);
+		m_indexCapacity =
+		    std::max(indexCount, m_indexCapacity * 2);
+		// Whole vertices per segment, so base vertices
+		// address every segment from one attribute setup.
+		m_vertices = std::make_unique<StreamBuffer>(
+		    m_vertexCapacity * sizeof(ImDrawVert));
+		m_indices = std::make_unique<StreamBuffer>(
+		    m_indexCapacity * sizeof(ImDrawIdx));
+
+		if (m_vao == 0)
+		{
+			glGenVertexArrays(1, &m_vao);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(
+			    GpuResources::Type::VertexArray, m_vao, 0,
+			    "ImGui");
+		}
+		glBindVertexArray(m_vao);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_ARRAY_BUFFER, m_vertices->GetId());
+		VEGAM_CHECK_GL_ERROR;
+		glEnableVertexAttribArray(0);
+		VEGAM_CHECK_GL_ERROR;
+		glVertexAttribPointer(
+		    0, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert),
+		    reinterpret_cast<void*>(offsetof(ImDrawVert, pos)));
+		VEGAM_CHECK_GL_ERROR;
+		glEnableVertexAttribArray(1);
+		VEGAM_CHECK_GL_ERROR;
+		glVertexAttribPointer(
+		    1, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert),
+		    reinterpret_cast<void*>(offsetof(ImDrawVert, uv)));
+		VEGAM_CHECK_GL_ERROR;
+		glEnableVertexAttribArray(2);
+		VEGAM_CHECK_GL_ERROR;
+		glVertexAttribPointer(
+		    2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert),
+		    reinterpret_cast<void*>(offsetof(ImDrawVert, col)));
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+		             m_indices->GetId());
+		VEGAM_CHECK_GL_ERROR;
+		glBindVertexArray(0);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void ImGuiRenderer::Render(const ImDrawData* drawData,
+	                           bool reuse)
+	{
+		const auto scale = drawData->FramebufferScale;
+		const int width =
+		    static_cast<int>(drawData->DisplaySize.x * scale.x);
+		const int height =
+		    static_cast<int>(drawData->DisplaySize.y * scale.y);
+		if (width <= 0 || height <= 0
+		    || drawData->TotalVtxCount == 0 || !m_shader)
+		{
+			return;
+		}
+
+		if (!reuse || !m_uploaded)
+		{
+			Upload(drawData);
+		}
+
+		// Orthographic projection of DisplayPos to
+		// DisplayPos + DisplaySize, y down.
+		const auto pos = drawData->DisplayPos;
+		const auto size = drawData->DisplaySize;
+		m_shader->SetUniformFloat4(
+		    "Transform", 2.0f / size.x, -2.0f / size.y,
+		    -1.0f - pos.x * 2.0f / size.x,
+		    1.0f + pos.y * 2.0f / size.y);
+
+		// The polygon mode is left to whoever set it, e.g.
+		// a wireframe debug view.
+		const auto polygonMode = GLState::GetPolygonMode();
+		SetUiState();
+
+		const auto segmentVertices = static_cast<int32_t>(
+		    m_vertices->GetSegment() * m_vertexCapacity);
+		auto indexBase = static_cast<uint32_t>(
+		    m_indices->GetSegment()
+		    * m_indices->GetSegmentSize());
+		int32_t vertexBase = segmentVertices;
+		const auto program = m_shader->GetId();
+
+		m_commands.Reset();
+		m_offsets.clear();
+		for (int i = 0; i < drawData->CmdListsCount; ++i)
+		{
+			const auto* list = drawData->CmdLists[i];
+			for (const auto& cmd : list->CmdBuffer)
+			{
+				if (cmd.UserCallback)
+				{
+					// Callbacks see the GL state as
+					// ImGui's own backend leaves it, so
+					// everything before runs first.
+					Flush();
+					if (cmd.UserCallback
+					    != ImDrawCallback_ResetRenderState)
+					{
+						cmd.UserCallback(list, &cmd);
+					}
+					// Whatever the callback changed is
+					// unknown now.
+					GLState::Invalidate();
+					SetUiState();
+					continue;
+				}
+
+				// Clip rectangle in framebuffer pixels,
+				// y up.
+				const float x0 =
+				    (cmd.ClipRect.x - pos.x) * scale.x;
+				const float y0 =
+				    (cmd.ClipRect.y - pos.y) * scale.y;
+				const float x1 =
+				    (cmd.ClipRect.z - pos.x) * scale.x;
+				const float y1 =
+				    (cmd.ClipRect.w - pos.y) * scale.y;
+				if (x1 <= x0 || y1 <= y0 || cmd.ElemCount == 0)
+				{
+					continue;
+				}
+
+				RenderCommands::DrawUi draw{};
+				draw.program = program;
+				draw.vao = m_vao;
+				draw.texture = static_cast<uint32_t>(
+				    reinterpret_cast<intptr_t>(cmd.GetTexID()));
+				draw.elementCount = cmd.ElemCount;
+				draw.indexOffset = static_cast<uint32_t>(
+				    indexBase
+				    + cmd.IdxOffset * sizeof(ImDrawIdx));
+				draw.baseVertex = vertexBase
+				                  + static_cast<int32_t>(
+				                      cmd.VtxOffset);
+				draw.indexType = UiIndexType;
+				draw.scissor[0] = static_cast<int32_t>(x0);
+				draw.scissor[1] =
+				    static_cast<int32_t>(height - y1);
+				draw.scissor[2] =
+				    static_cast<int32_t>(x1 - x0);
+				draw.scissor[3] =
+				    static_cast<int32_t>(y1 - y0);
+				m_offsets.push_back(m_commands.Push(draw));
+			}
+			vertexBase += list->VtxBuffer.Size;
+			indexBase += static_cast<uint32_t>(
+			    list->IdxBuffer.Size * sizeof(ImDrawIdx));
+		}
+		Flush();
+
+		GLState::SetEnabled(GLState::Capability::ScissorTest,
+		                    false);
+		GLState::SetEnabled(GLState::Capability::DepthTest,
+		                    true);
+		GLState::SetBlendFunc(GL_SRC_ALPHA,
+		                      GL_ONE_MINUS_SRC_ALPHA);
+		if (polygonMode != GLState::Unknown)
+		{
+			GLState::SetPolygonMode(polygonMode);
+		}
+	}
+
+	void ImGuiRenderer::SetUiState()
+	{
+		using Capability = GLState::Capability;
+		GLState::SetEnabled(Capability::Blend, true);
+		GLState::SetBlendFunc(GL_SRC_ALPHA,
+		                      GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+		                      GL_ONE_MINUS_SRC_ALPHA);
+		GLState::SetEnabled(Capability::DepthTest, false);
+		GLState::SetEnabled(Capability::CullFace, false);
+		GLState::SetEnabled(Capability::ScissorTest, true);
+		GLState::SetPolygonMode(GL_FILL);
+	}
+
+	void ImGuiRenderer::Upload(const ImDrawData* drawData)
+	{
+		Reserve(drawData->TotalVtxCount,
+		        drawData->TotalIdxCount);
+		auto* vertices =
+		    static_cast<uint8_t*>(m_vertices->BeginWrite());
+		auto* indices =
+		    static_cast<uint8_t*>(m_indices->BeginWrite());
+		size_t vertexBytes = 0;
+		size_t indexBytes = 0;
+		for (int i = 0; i < drawData->CmdListsCount; ++i)
+		{
+			const auto* list = drawData->CmdLists[i];
+			const auto vtx =
+			    list->VtxBuffer.Size * sizeof(ImDrawVert);
+			const auto idx =
+			    list->IdxBuffer.Size * sizeof(ImDrawIdx);
+			std::memcpy(vertices + vertexBytes,
+			            list->VtxBuffer.Data, vtx);
+			std::memcpy(indices + indexBytes,
+			            list->IdxBuffer.Data, idx);
+			vertexBytes += vtx;
+			indexBytes += idx;
+		}
+		m_vertices->EndWrite();
+		m_indices->EndWrite();
+		m_uploaded = true;
+	}
+
+	void ImGuiRenderer::Flush()
+	{
+		if (m_offsets.empty())
+		{
+			return;
+		}
+
+		Engine::Instance().GetRenderManager().ExecuteOrdered(
+		    m_commands, m_offsets);
+		m_commands.Reset();
+		m_offsets.clear();
+	}
+} // namespace AthiVegam::Graphics
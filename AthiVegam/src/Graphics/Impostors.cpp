@@ -0,0 +1,742 @@
+#include "AthiVegam/Graphics/Impostors.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/CommandList.h"
+#include "AthiVegam/Graphics/GLState.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/Lod.h"
+#include "AthiVegam/Graphics/Mesh.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Graphics/SortKey.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Math/Matrix.h"
+#include "AthiVegam/Math/Vector.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		// Shared by both stages of the draw. Directions map
+		// to [0, 1]^2 with +y at the center and -y at the
+		// corners; frame (i, j) looks from the direction at
+		// (i, j) / (frames - 1), with the basis of
+		// FrameBasis().
+		const char* OctahedralSource = R"(
+vec2 SignNotZero(vec2 v)
+{
+	return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec2 OctEncode(vec3 n)
+{
+	vec2 p = n.xz / (abs(n.x) + abs(n.y) + abs(n.z));
+	if (n.y < 0.0)
+	{
+		p = (1.0 - abs(p.yx)) * SignNotZero(p);
+	}
+	return p * 0.5 + 0.5;
+}
+
+vec3 OctDecode(vec2 uv)
+{
+	vec2 p = uv * 2.0 - 1.0;
+	vec3 n = vec3(p.x, 1.0 - abs(p.x) - abs(p.y), p.y);
+	if (n.y < 0.0)
+	{
+		n.xz = (1.0 - abs(n.zx)) * SignNotZero(n.xz);
+	}
+	return normalize(n);
+}
+
+void FrameBasis(vec3 d, out vec3 right, out vec3 up)
+{
+	vec3 reference = abs(d.y) > 0.999 ? vec3(0.0, 0.0, 1.0)
+	                                  : vec3(0.0, 1.0, 0.0);
+	right = normalize(cross(reference, d));
+	up = cross(d, right);
+}
+)";
+
+		const char* ConstantsSource = R"(
+layout(std140) uniform Constants
+{
+	mat4 ViewProjection;
+	// The camera's position with w 1, or the direction
+	// towards it with w 0.
+	vec4 Eye;
+	// Mesh-space sphere the frames fit.
+	vec4 Sphere;
+	// Layer, frames per side, half a texel of a frame.
+	vec4 Params;
+	// Ambient in w.
+	vec4 LightDirection;
+};
+)";
+
+		const char* DrawVertexSource = R"(
+layout(location = 4) in mat4 Transform;
+
+out vec2 FrameUV[3];
+flat out ivec2 Frames[3];
+flat out vec3 Weights;
+out vec3 WorldPosition;
+flat out vec3 ViewDirection;
+flat out float Radius;
+flat out float Fade;
+flat out mat3 NormalMatrix;
+
+void main()
+{
+	// The fade rides in the row affine transforms leave
+	// zero.
+	mat4 model = Transform;
+	Fade = model[0][3] == 0.0 ? 1.0 : model[0][3];
+	model[0][3] = 0.0;
+	mat3 linear = mat3(model);
+	mat3 toMesh = inverse(linear);
+	NormalMatrix = transpose(toMesh);
+
+	vec3 center = (model * vec4(Sphere.xyz, 1.0)).xyz;
+	float scale = max(length(linear[0]),
+	                  max(length(linear[1]), length(linear[2])));
+	Radius = Sphere.w * scale;
+	vec3 view =
+	    normalize(Eye.w != 0.0 ? Eye.xyz - center : Eye.xyz);
+	ViewDirection = view;
+
+	// The triangle of frames around the view direction.
+	float last = Params.y - 1.0;
+	vec2 grid = OctEncode(normalize(toMesh * view)) * last;
+	vec2 cell = min(floor(grid), vec2(last - 1.0));
+	vec2 f = grid - cell;
+	ivec2 base = ivec2(cell);
+	Frames[1] = base + ivec2(1, 0);
+	Frames[2] = base + ivec2(0, 1);
+	if (f.x + f.y < 1.0)
+	{
+		Frames[0] = base;
+		Weights = vec3(1.0 - f.x - f.y, f.x, f.y);
+	}
+	else
+	{
+		Frames[0] = base + ivec2(1, 1);
+		Weights = vec3(f.x + f.y - 1.0, 1.0 - f.y, 1.0 - f.x);
+	}
+
+	vec3 right;
+	vec3 up;
+	FrameBasis(view, right, up);
+	vec2 corner =
+	    vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+	WorldPosition =
+	    center + (right * corner.x + up * corner.y) * Radius;
+
+	// Where the corner falls in each frame's orthographic
+	// view of the sphere.
+	vec3 p = toMesh * (WorldPosition - model[3].xyz) - Sphere.xyz;
+	for (int i = 0; i < 3; ++i)
+	{
+		vec3 frameRight;
+		vec3 frameUp;
+		FrameBasis(OctDecode(vec2(Frames[i]) / last), frameRight,
+		           frameUp);
+		FrameUV[i] = vec2(dot(p, frameRight), dot(p, frameUp))
+		                 / (2.0 * Sphere.w)
+		             + 0.5;
+	}
+	gl_Position = ViewProjection * vec4(WorldPosition, 1.0);
+}
+)";
+
+		const char* DrawFragmentSource = R"(
+in vec2 FrameUV[3];
+flat in ivec2 Frames[3];
+flat in vec3 Weights;
+in vec3 WorldPosition;
+flat in vec3 ViewDirection;
+flat in float Radius;
+flat in float Fade;
+flat in mat3 NormalMatrix;
+
+layout(binding = 12) uniform sampler2DArray Albedo;
+layout(binding = 13) uniform sampler2DArray NormalDepth;
+
+layout(location = 0) out vec4 OutColor;
+
+// As LodDither().
+void Dither()
+{
+	const float pattern[16] = float[16](
+	    0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0,
+	    3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+	ivec2 p = ivec2(gl_FragCoord.xy) & 3;
+	float threshold = (pattern[p.y * 4 + p.x] + 0.5) / 16.0;
+	if (Fade >= 0.0 ? threshold > Fade : threshold <= -Fade)
+	{
+		discard;
+	}
+}
+
+void main()
+{
+	Dither();
+	vec4 albedo = vec4(0.0);
+	vec4 normalDepth = vec4(0.0);
+	float coverage = 0.0;
+	for (int i = 0; i < 3; ++i)
+	{
+		// Kept inside the frame, so filtering doesn't
+		// reach into its neighbours.
+		vec2 uv = clamp(FrameUV[i], Params.z, 1.0 - Params.z);
+		vec3 coord = vec3((vec2(Frames[i]) + uv) / Params.y,
+		                  Params.x);
+		vec4 texel = texture(Albedo, coord);
+		albedo += texel * Weights[i];
+		normalDepth += texture(NormalDepth, coord)
+		               * (texel.a * Weights[i]);
+		coverage += texel.a * Weights[i];
+	}
+	if (albedo.a < 0.5)
+	{
+		discard;
+	}
+	normalDepth /= coverage;
+
+	vec3 normal =
+	    normalize(NormalMatrix * (normalDepth.xyz * 2.0 - 1.0));
+	float diffuse = max(dot(normal, -LightDirection.xyz), 0.0);
+	OutColor = vec4(albedo.rgb / albedo.a
+	                    * (LightDirection.w + diffuse),
+	                1.0);
+
+	// Depth 0 is the sphere's near side, 1 its far side.
+	float offset = Radius * (1.0 - 2.0 * normalDepth.w);
+	vec3 surface = WorldPosition + ViewDirection * offset;
+	vec4 clip = ViewProjection * vec4(surface, 1.0);
+	gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;
+}
+)";
+
+		const char* BakeVertexSource = R"(#version 430 core
+layout(location = 0) in vec3 Position;
+layout(location = 1) in vec3 Normal;
+layout(location = 2) in vec2 TexCoord;
+
+uniform mat4 ViewProjection;
+
+out vec3 FragPosition;
+out vec3 FragNormal;
+out vec2 FragTexCoord;
+
+void main()
+{
+	FragPosition = Position;
+	FragNormal = Normal;
+	FragTexCoord = TexCoord;
+	gl_Position = ViewProjection * vec4(Position, 1.0);
+}
+)";
+
+		const char* BakeFragmentSource = R"(#version 430 core
+in vec3 FragPosition;
+in vec3 FragNormal;
+in vec2 FragTexCoord;
+
+layout(binding = 0) uniform sampler2D Albedo;
+uniform bool HasAlbedo;
+
+layout(location = 0) out vec4 OutAlbedo;
+layout(location = 1) out vec4 OutNormalDepth;
+
+void main()
+{
+	vec4 albedo = HasAlbedo ? texture(Albedo, FragTexCoord)
+	                        : vec4(1.0);
+	if (albedo.a < 0.5)
+	{
+		discard;
+	}
+	vec3 normal = FragNormal;
+	if (dot(normal, normal) < 1.0e-4)
+	{
+		normal = cross(dFdx(FragPosition), dFdy(FragPosition));
+	}
+	OutAlbedo = vec4(albedo.rgb, 1.0);
+	// The orthographic depth is linear over the sphere.
+	OutNormalDepth =
+	    vec4(normalize(normal) * 0.5 + 0.5, gl_FragCoord.z);
+}
+)";
+
+		struct DrawConstants
+		{
+			float viewProjection[16];
+			float eye[4];
+			float sphere[4];
+			float params[4];
+			float lightDirection[4];
+		};
+
+		constexpr float Ambient = 0.25f;
+
+		inline GLenum GetGLIndexType(IndexType type)
+		{
+			return type == IndexType::UInt16 ? GL_UNSIGNED_SHORT
+			                                 : GL_UNSIGNED_INT;
+		}
+
+		inline const void* IndexOffset(const Mesh& mesh)
+		{
+			return reinterpret_cast<const void*>(
+			    static_cast<uintptr_t>(mesh.GetFirstIndex())
+			    * GetIndexSize(mesh.GetIndexType()));
+		}
+
+		// As the shaders' OctDecode() and FrameBasis().
+		Math::Vec3 OctDecode(float u, float v)
+		{
+			const auto px = u * 2.0f - 1.0f;
+			const auto pz = v * 2.0f - 1.0f;
+			Math::Vec3 n{px, 1.0f - std::abs(px) - std::abs(pz),
+			             pz};
+			if (n.y < 0.0f)
+			{
+				const auto x = n.x;
+				n.x = (1.0f - std::abs(n.z))
+				      * (x >= 0.0f ? 1.0f : -1.0f);
+				n.z = (1.0f - std::abs(x))
+				      * (n.z >= 0.0f ? 1.0f : -1.0f);
+			}
+			return Math::Normalize(n);
+		}
+
+		inline Math::Vec3 FrameUp(const Math::Vec3& d)
+		{
+			return std::abs(d.y) > 0.999f
+			           ? Math::Vec3{0.0f, 0.0f, 1.0f}
+			           : Math::Vec3{0.0f, 1.0f, 0.0f};
+		}
+
+		uint32_t CreateAtlas(GLsizei size, GLsizei levels,
+		                     GLsizei layers, const char* label)
+		{
+			uint32_t texture = 0;
+			glGenTextures(1, &texture);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+			VEGAM_CHECK_GL_ERROR;
+			glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8,
+			               size, size, layers);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+			                GL_TEXTURE_MIN_FILTER,
+			                GL_LINEAR_MIPMAP_LINEAR);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+			                GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+			                GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+			                GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+			VEGAM_CHECK_GL_ERROR;
+			// A third more for the mips.
+			GpuResources::Register(
+			    GpuResources::Type::Texture, texture,
+			    size_t{static_cast<uint32_t>(size)}
+			        * static_cast<uint32_t>(size)
+			        * static_cast<uint32_t>(layers) * 4 * 4 / 3,
+			    label);
+			return texture;
+		}
+
+		void DeleteTexture(uint32_t& texture)
+		{
+			if (texture == 0)
+			{
+				return;
+			}
+			GpuResources::Unregister(GpuResources::Type::Texture,
+			                         texture);
+			glDeleteTextures(1, &texture);
+			VEGAM_CHECK_GL_ERROR;
+			texture = 0;
+		}
+	} // namespace
+
+	Impostors::Impostors() = default;
+
+	Impostors::Impostors(const Settings& settings)
+	    : m_settings(settings)
+	{
+		VEGAM_ASSERT(settings.capacity > 0,
+		             "Impostors need a capacity");
+		VEGAM_ASSERT(settings.frames >= 2,
+		             "Impostors need at least 2x2 frames");
+		VEGAM_ASSERT(settings.frameSize >= 8
+		                 && std::has_single_bit(
+		                     settings.frameSize),
+		             "Impostor frame size must be a power of "
+		             "two of at least 8");
+	}
+
+	Impostors::~Impostors()
+	{
+		VEGAM_ASSERT(!IsInitialized(),
+		             "Impostors destroyed without Shutdown()");
+	}
+
+	bool Impostors::Initialize()
+	{
+		if (IsInitialized())
+		{
+			return true;
+		}
+		if (!GLAD_GL_VERSION_4_3)
+		{
+			VEGAM_WARN("Impostors need a GL 4.3 context");
+			return false;
+		}
+
+		m_bakeShader = std::make_unique<Shader>(
+		    BakeVertexSource, BakeFragmentSource);
+		const auto header = std::string("#version 430 core\n")
+		                    + ConstantsSource + OctahedralSource;
+		m_drawShader = std::make_unique<Shader>(
+		    header + DrawVertexSource,
+		    header + DrawFragmentSource);
+
+		// Mips down to 4x4 per frame; smaller ones would
+		// blend the frames together.
+		const auto size = static_cast<GLsizei>(
+		    m_settings.frames * m_settings.frameSize);
+		const auto levels = static_cast<GLsizei>(
+		    std::bit_width(m_settings.frameSize) - 2);
+		const auto layers =
+		    static_cast<GLsizei>(m_settings.capacity);
+		m_albedo =
+		    CreateAtlas(size, levels, layers, "Impostor albedo");
+		m_normalDepth = CreateAtlas(size, levels, layers,
+		                            "Impostor normals");
+
+		glGenRenderbuffers(1, &m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		glBindRenderbuffer(GL_RENDERBUFFER, m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		glRenderbufferStorage(GL_RENDERBUFFER,
+		                      GL_DEPTH_COMPONENT24, size, size);
+		VEGAM_CHECK_GL_ERROR;
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(
+		    GpuResources::Type::Renderbuffer, m_depth,
+		    size_t{static_cast<uint32_t>(size)}
+		        * static_cast<uint32_t>(size) * 4,
+		    "Impostor bake depth");
+
+		// Layers are attached as they bake.
+		GLint previous = 0;
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+		VEGAM_CHECK_GL_ERROR;
+		glGenFramebuffers(1, &m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER,
+		                          GL_DEPTH_ATTACHMENT,
+		                          GL_RENDERBUFFER, m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0,
+		                              GL_COLOR_ATTACHMENT1};
+		glDrawBuffers(2, drawBuffers);
+		VEGAM_CHECK_GL_ERROR;
+		glBindFramebuffer(GL_FRAMEBUFFER, previous);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::Framebuffer,
+		                       m_framebuffer, 0,
+		                       "Impostor bake");
+
+		glGenVertexArrays(1, &m_vao);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::VertexArray,
+		                       m_vao, 0, "Impostors");
+
+		m_entries.assign(m_settings.capacity, {});
+		VEGAM_INFO("Impostors enabled: {} of {}x{} frames",
+		           m_settings.capacity, m_settings.frames,
+		           m_settings.frames);
+		return true;
+	}
+
+	void Impostors::Shutdown()
+	{
+		m_bakeShader.reset();
+		m_drawShader.reset();
+		DeleteTexture(m_albedo);
+		DeleteTexture(m_normalDepth);
+		if (m_depth != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Renderbuffer, m_depth);
+			glDeleteRenderbuffers(1, &m_depth);
+			VEGAM_CHECK_GL_ERROR;
+			m_depth = 0;
+		}
+		if (m_framebuffer != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Framebuffer, m_framebuffer);
+			glDeleteFramebuffers(1, &m_framebuffer);
+			VEGAM_CHECK_GL_ERROR;
+			m_framebuffer = 0;
+		}
+		if (m_vao != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::VertexArray, m_vao);
+			glDeleteVertexArrays(1, &m_vao);
+			VEGAM_CHECK_GL_ERROR;
+			m_vao = 0;
+		}
+		m_entries.clear();
+	}
+
+	uint32_t Impostors::Bake(const Mesh& mesh, uint32_t albedo)
+	{
+		if (!IsInitialized() || !mesh.IsReady())
+		{
+			return LodChain::NoImpostor;
+		}
+		const auto sphere = mesh.GetBounds().GetSphere();
+		if (!std::isfinite(sphere.radius)
+		    || sphere.radius <= 0.0f)
+		{
+			VEGAM_WARN("Impostors need bounded meshes");
+			return LodChain::NoImpostor;
+		}
+		const auto free =
+		    std::find_if(m_entries.begin(), m_entries.end(),
+		                 [](const Entry& e) { return !e.used; });
+		if (free == m_entries.end())
+		{
+			VEGAM_WARN("Out of impostor layers ({})",
+			           m_settings.capacity);
+			return LodChain::NoImpostor;
+		}
+		VEGAM_PROFILE_SCOPE("Impostors::Bake");
+		const auto layer =
+		    static_cast<uint32_t>(free - m_entries.begin());
+
+		GLint previousFramebuffer = 0;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING,
+		              &previousFramebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		GLint previousViewport[4] = {};
+		glGetIntegerv(GL_VIEWPORT, previousViewport);
+		VEGAM_CHECK_GL_ERROR;
+
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glFramebufferTextureLayer(
+		    GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_albedo, 0,
+		    static_cast<GLint>(layer));
+		VEGAM_CHECK_GL_ERROR;
+		glFramebufferTextureLayer(
+		    GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, m_normalDepth,
+		    0, static_cast<GLint>(layer));
+		VEGAM_CHECK_GL_ERROR;
+		GLState::SetEnabled(GLState::Capability::Blend, false);
+		GLState::SetEnabled(GLState::Capability::ScissorTest,
+		                    false);
+		GLState::SetEnabled(GLState::Capability::CullFace,
+		                    false);
+		GLState::SetEnabled(GLState::Capability::DepthTest,
+		                    true);
+		GLState::SetDepthMask(true);
+		GLState::SetDepthFunc(GL_LESS);
+		GLState::SetColorMask(true);
+		const GLfloat clearAlbedo[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+		glClearBufferfv(GL_COLOR, 0, clearAlbedo);
+		VEGAM_CHECK_GL_ERROR;
+		const GLfloat clearNormal[4] = {0.5f, 1.0f, 0.5f, 1.0f};
+		glClearBufferfv(GL_COLOR, 1, clearNormal);
+		VEGAM_CHECK_GL_ERROR;
+		const GLfloat clearDepth = 1.0f;
+		glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+		VEGAM_CHECK_GL_ERROR;
+
+		// The state cache of the render manager is reset
+		// at its next flush.
+		Shader::UseProgram(m_bakeShader->GetId());
+		m_bakeShader->Set(
+		    m_bakeShader->GetUniform<int>("HasAlbedo"),
+		    albedo != 0 ? 1 : 0);
+		const auto viewProjectionUniform =
+		    m_bakeShader->GetUniform<Math::Mat4>(
+		        "ViewProjection");
+		glActiveTexture(GL_TEXTURE0);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, albedo);
+		VEGAM_CHECK_GL_ERROR;
+		glBindVertexArray(mesh.GetId());
+		VEGAM_CHECK_GL_ERROR;
+
+		const Math::Vec3 center{sphere.center.x,
+		                        sphere.center.y,
+		                        sphere.center.z};
+		const auto r = sphere.radius;
+		const auto projection = Math::Mat4::Orthographic(
+		    -r, r, -r, r, 0.0f, 2.0f * r);
+		const auto frames = m_settings.frames;
+		const auto frameSize =
+		    static_cast<GLsizei>(m_settings.frameSize);
+		const auto last = static_cast<float>(frames - 1);
+		for (uint32_t j = 0; j < frames; ++j)
+		{
+			for (uint32_t i = 0; i < frames; ++i)
+			{
+				const auto d =
+				    OctDecode(static_cast<float>(i) / last,
+				              static_cast<float>(j) / last);
+				const auto view = Math::Mat4::LookAt(
+				    center + d * r, center, FrameUp(d));
+				m_bakeShader->Set(viewProjectionUniform,
+				                  projection * view);
+				glViewport(static_cast<GLint>(i) * frameSize,
+				           static_cast<GLint>(j) * frameSize,
+				           frameSize, frameSize);
+				VEGAM_CHECK_GL_ERROR;
+				if (mesh.GetElementCount() > 0)
+				{
+					glDrawElementsBaseVertex(
+					    GL_TRIANGLES, mesh.GetElementCount(),
+					    GetGLIndexType(mesh.GetIndexType()),
+					    IndexOffset(mesh), mesh.GetBaseVertex());
+				}
+				else
+				{
+					glDrawArrays(GL_TRIANGLE_STRIP,
+					             mesh.GetBaseVertex(),
+					             mesh.GetVertexCount());
+				}
+				VEGAM_CHECK_GL_ERROR;
+			}
+		}
+		glBindVertexArray(0);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glViewport(previousViewport[0], previousViewport[1],
+		           previousViewport[2], previousViewport[3]);
+		VEGAM_CHECK_GL_ERROR;
+		for (const auto texture : {m_albedo, m_normalDepth})
+		{
+			glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+			VEGAM_CHECK_GL_ERROR;
+			glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		free->sphere = sphere;
+		free->used = true;
+		return layer;
+	}
+
+	void Impostors::Release(uint32_t impostor)
+	{
+		if (impostor < m_entries.size())
+		{
+			m_entries[impostor].used = false;
+		}
+	}
+
+	void Impostors::Draw(
+	    CommandList& list, const float viewProjection[16],
+	    uint32_t impostor,
+	    std::span<const RenderCommands::InstanceTransform>
+	        instances,
+	    uint8_t renderLayer) const
+	{
+		if (!IsInitialized() || instances.empty()
+		    || impostor >= m_entries.size()
+		    || !m_entries[impostor].used)
+		{
+			return;
+		}
+		const auto& sphere = m_entries[impostor].sphere;
+		DrawConstants constants;
+		std::memcpy(constants.viewProjection, viewProjection,
+		            sizeof(constants.viewProjection));
+		// The camera is where the view-projection maps to
+		// no point; for orthographic views, the direction
+		// towards the near plane.
+		const auto inverse =
+		    Math::Inverse(Math::Mat4::Load(viewProjection));
+		const auto camera =
+		    inverse * Math::Vec4{0.0f, 0.0f, 1.0f, 0.0f};
+		if (std::abs(camera.w) > 1.0e-6f)
+		{
+			constants.eye[0] = camera.x / camera.w;
+			constants.eye[1] = camera.y / camera.w;
+			constants.eye[2] = camera.z / camera.w;
+			constants.eye[3] = 1.0f;
+		}
+		else
+		{
+			const auto near =
+			    inverse * Math::Vec4{0.0f, 0.0f, -1.0f, 0.0f};
+			constants.eye[0] = near.x;
+			constants.eye[1] = near.y;
+			constants.eye[2] = near.z;
+			constants.eye[3] = 0.0f;
+		}
+		constants.sphere[0] = sphere.center.x;
+		constants.sphere[1] = sphere.center.y;
+		constants.sphere[2] = sphere.center.z;
+		constants.sphere[3] = sphere.radius;
+		constants.params[0] = static_cast<float>(impostor);
+		constants.params[1] =
+		    static_cast<float>(m_settings.frames);
+		constants.params[2] =
+		    0.5f / static_cast<float>(m_settings.frameSize);
+		constants.params[3] = 0.0f;
+		const auto light = Math::Normalize(
+		    Math::Vec3{m_settings.lightDirection.x,
+		               m_settings.lightDirection.y,
+		               m_settings.lightDirection.z});
+		constants.lightDirection[0] = light.x;
+		constants.lightDirection[1] = light.y;
+		constants.lightDirection[2] = light.z;
+		constants.lightDirection[3] = Ambient;
+
+		RenderCommands::DrawImpostors command{};
+		command.program = m_drawShader->GetId();
+		command.vao = m_vao;
+		command.albedo = m_albedo;
+		command.normalDepth = m_normalDepth;
+		command.firstInstance = list.PushInstances(
+		    instances.data(),
+		    static_cast<uint32_t>(instances.size()));
+		command.instanceCount =
+		    static_cast<uint32_t>(instances.size());
+		command.constants = list.PushConstants(constants);
+		list.Submit(command,
+		            SortKey::Make(renderLayer, false, 0, 0, 0));
+	}
+} // namespace AthiVegam::Graphics
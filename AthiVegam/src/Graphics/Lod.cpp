@@ -0,0 +1,113 @@
+#include "AthiVegam/Graphics/Lod.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace AthiVegam::Graphics
+{
+	// Ordered 4x4 dither; the level fading in keeps the
+	// pixels whose threshold its coverage reaches, the
+	// level fading out the rest.
+	const char* LodFadeShaderSource = R"(
+layout(std140) uniform Constants
+{
+	float LodFade;
+};
+
+void LodDither()
+{
+	const float pattern[16] = float[16](
+	    0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0,
+	    3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+	ivec2 p = ivec2(gl_FragCoord.xy) & 3;
+	float threshold = (pattern[p.y * 4 + p.x] + 0.5) / 16.0;
+	if (LodFade >= 0.0 ? threshold > LodFade
+	                   : threshold <= -LodFade)
+	{
+		discard;
+	}
+}
+)";
+
+	float GetProjectionScale(const float viewProjection[16])
+	{
+		const auto* m = viewProjection;
+		return std::sqrt(m[1] * m[1] + m[5] * m[5]
+		                 + m[9] * m[9]);
+	}
+
+	float ProjectedSize(const float viewProjection[16],
+	                    const BoundingSphere& sphere)
+	{
+		return ProjectedSize(viewProjection,
+		                     GetProjectionScale(viewProjection),
+		                     sphere);
+	}
+
+	float ProjectedSize(const float viewProjection[16],
+	                    float projectionScale,
+	                    const BoundingSphere& sphere)
+	{
+		// Clip w is the view depth under a perspective,
+		// and 1 under an orthographic projection.
+		const auto* m = viewProjection;
+		const auto& c = sphere.center;
+		const auto w =
+		    m[3] * c.x + m[7] * c.y + m[11] * c.z + m[15];
+		if (w <= sphere.radius)
+		{
+			return std::numeric_limits<float>::max();
+		}
+		return sphere.radius * projectionScale / w;
+	}
+
+	uint32_t SelectLod(const LodChain& chain, float size,
+	                   uint32_t current, float hysteresis)
+	{
+		const auto last = chain.GetLastLevel();
+		const auto threshold = [&](uint32_t level) {
+			return level < chain.count
+			           ? chain.thresholds[level]
+			           : chain.impostorThreshold;
+		};
+		auto level = std::min(current, last);
+		const auto down = 1.0f - hysteresis;
+		const auto up = 1.0f + hysteresis;
+		while (level < last && size < threshold(level) * down)
+		{
+			++level;
+		}
+		while (level > 0 && size > threshold(level - 1) * up)
+		{
+			--level;
+		}
+		return level;
+	}
+
+	void UpdateLod(const LodChain& chain, float size,
+	               const LodSettings& settings,
+	               LodState& state)
+	{
+		const auto level = static_cast<uint8_t>(
+		    SelectLod(chain, size * settings.bias,
+		              state.level, settings.hysteresis));
+		if (level != state.level)
+		{
+			// A switch mid-fade drops the oldest level.
+			state.previous = state.level;
+			state.level = level;
+			state.fade = 0.0f;
+		}
+		if (settings.fadeFrames == 0)
+		{
+			state.fade = 1.0f;
+		}
+		else if (state.IsFading())
+		{
+			const auto step =
+			    1.0f / static_cast<float>(settings.fadeFrames);
+			state.fade = std::min(state.fade + step, 1.0f);
+		}
+	}
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,474 @@
+#include "AthiVegam/Graphics/MaterialTable.h"
+
+#include "AthiVegam/Graphics/GpuMemory.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Graphics/WeightedOit.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		bool HasExtension(std::string_view name)
+		{
+			GLint count = 0;
+			glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+			VEGAM_CHECK_GL_ERROR;
+			for (GLint i = 0; i < count; ++i)
+			{
+				const std::string_view extension(
+				    reinterpret_cast<const char*>(
+				        glGetStringi(GL_EXTENSIONS, i)));
+				VEGAM_CHECK_GL_ERROR;
+				if (extension == name)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Sizes the buffer for at least size bytes and
+		// writes data to its start; stream buffers are
+		// orphaned every time.
+		void Upload(GLenum target, uint32_t buffer,
+		            size_t& capacity, const void* data,
+		            size_t size, GLenum usage)
+		{
+			glBindBuffer(target, buffer);
+			VEGAM_CHECK_GL_ERROR;
+			if (size > capacity || usage == GL_STREAM_DRAW)
+			{
+				capacity = std::max(capacity, size * 2);
+				glBufferData(target, capacity, nullptr, usage);
+				VEGAM_CHECK_GL_ERROR;
+				GpuResources::Resize(GpuResources::Type::Buffer,
+				                     buffer, capacity);
+			}
+			glBufferSubData(target, 0, size, data);
+			VEGAM_CHECK_GL_ERROR;
+			glBindBuffer(target, 0);
+			VEGAM_CHECK_GL_ERROR;
+		}
+
+		inline size_t AlignConstants(size_t size)
+		{
+			constexpr size_t alignment =
+			    RenderCommands::ConstantsAlignment;
+			return (size + alignment - 1) & ~(alignment - 1);
+		}
+	} // namespace
+
+	void MaterialTable::Initialize()
+	{
+		glGenBuffers(1, &m_constantsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::Buffer,
+		                       m_constantsBuffer, 0,
+		                       "Material constants");
+
+		m_mode = Mode::Unsupported;
+		if (GLAD_GL_VERSION_4_3)
+		{
+			m_mode = Texture::IsBindlessSupported()
+			             ? Mode::Bindless
+			             : Mode::Arrays;
+			m_drawId =
+			    HasExtension("GL_ARB_shader_draw_parameters");
+
+			glGenBuffers(1, &m_buffer);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(GpuResources::Type::Buffer,
+			                       m_buffer, 0, "Materials");
+			glGenBuffers(1, &m_drawBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(GpuResources::Type::Buffer,
+			                       m_drawBuffer, 0,
+			                       "Draw materials");
+		}
+		BuildHeaders();
+
+		constexpr const char* modeNames[] = {
+		    "unavailable (needs GL 4.3)", "texture arrays",
+		    "bindless textures"};
+		VEGAM_INFO("Materials: {}{}",
+		           modeNames[static_cast<int>(m_mode)],
+		           m_mode != Mode::Unsupported && !m_drawId
+		               ? ", not batched (needs "
+		                 "ARB_shader_draw_parameters)"
+		               : "");
+	}
+
+	void MaterialTable::Shutdown()
+	{
+		for (auto* buffer :
+		     {&m_buffer, &m_drawBuffer, &m_constantsBuffer})
+		{
+			if (*buffer)
+			{
+				GpuResources::Unregister(
+				    GpuResources::Type::Buffer, *buffer);
+				glDeleteBuffers(1, buffer);
+				VEGAM_CHECK_GL_ERROR;
+				*buffer = 0;
+			}
+		}
+		m_bufferSize = 0;
+		m_drawBufferSize = 0;
+		m_records.clear();
+		m_materials.clear();
+		m_sets.clear();
+		m_states.assign(1, PipelineState{});
+		m_constantData.clear();
+		m_uploadedConstants.clear();
+		m_mode = Mode::Unsupported;
+	}
+
+	const std::string&
+	MaterialTable::GetShaderHeader(Stage stage) const
+	{
+		return m_headers[static_cast<size_t>(stage)];
+	}
+
+	void MaterialTable::BuildHeaders()
+	{
+		for (auto& header : m_headers)
+		{
+			header.clear();
+		}
+		if (m_mode == Mode::Unsupported)
+		{
+			return;
+		}
+
+		const auto bindless = m_mode == Mode::Bindless;
+		std::string common;
+		if (bindless)
+		{
+			common += "#extension GL_ARB_bindless_texture : "
+			          "require\n";
+		}
+		common +=
+		    "struct Material\n"
+		    "{\n"
+		    "\tuvec2 textures["
+		    + std::to_string(MaxTextures)
+		    + "];\n"
+		      "\tuvec4 layers;\n"
+		      "\tvec4 minLods;\n"
+		      "\tvec4 color;\n"
+		      "};\n"
+		      "layout(std430, binding = "
+		    + std::to_string(MaterialsBinding)
+		    + ") readonly buffer Materials\n"
+		      "{\n"
+		      "\tMaterial materials[];\n"
+		      "};\n";
+
+		auto& vertex = m_headers[static_cast<size_t>(
+		    Stage::Vertex)];
+		if (m_drawId)
+		{
+			vertex += "#extension GL_ARB_shader_draw_parameters "
+			          ": require\n";
+		}
+		vertex += common;
+		// Set per draw as a generic attribute value: a
+		// material index, or for multi-draws the first of
+		// their entries in DrawMaterials; then the flag for
+		// multi-draws, and the first instance of others.
+		vertex +=
+		    "layout(std430, binding = "
+		    + std::to_string(DrawMaterialsBinding)
+		    + ") readonly buffer DrawMaterials\n"
+		      "{\n"
+		      "\tuint drawMaterials[];\n"
+		      "};\n"
+		      "layout(location = "
+		    + std::to_string(RenderCommands::DrawMaterialLocation)
+		    + ") in uvec3 AvDrawMaterial;\n"
+		      "#define AV_DRAW_MATERIAL() (AvDrawMaterial.y != 0u"
+		      " ? drawMaterials[AvDrawMaterial.x + uint("
+		    + (m_drawId ? "gl_DrawIDARB" : "0")
+		    + ")] : AvDrawMaterial.x)\n";
+		// The instance's RenderCommands::DrawData.
+		vertex +=
+		    "struct AvDrawData\n"
+		    "{\n"
+		    "\tuint objectId;\n"
+		    "\tuint user;\n"
+		    "\tvec2 params;\n"
+		    "};\n"
+		    "layout(std430, binding = "
+		    + std::to_string(DrawDataBinding)
+		    + ") readonly buffer DrawDataBuffer\n"
+		      "{\n"
+		      "\tAvDrawData avDrawData[];\n"
+		      "};\n"
+		      "#define AV_INSTANCE_INDEX() ((AvDrawMaterial.y != 0u"
+		      " ? uint("
+		    + (m_drawId ? "gl_BaseInstanceARB" : "0")
+		    + ") : AvDrawMaterial.z) + uint(gl_InstanceID))\n"
+		      "#define AV_DRAW_DATA() "
+		      "avDrawData[AV_INSTANCE_INDEX()]\n";
+
+		auto& fragment = m_headers[static_cast<size_t>(
+		    Stage::Fragment)];
+		fragment += common;
+		if (!bindless)
+		{
+			fragment += "layout(binding = "
+			            + std::to_string(FirstTextureUnit)
+			            + ") uniform sampler2DArray "
+			              "MaterialTextures["
+			            + std::to_string(MaxTextures) + "];\n";
+		}
+		// Sampling is clamped to the finest level resident,
+		// which a bindless texture's base level cannot do.
+		fragment +=
+		    "vec4 SampleMaterial(uint index, uint slot, vec2 uv)\n"
+		    "{\n"
+		    "\tMaterial material = materials[index];\n"
+		    "\tif (material.minLods[slot] < 0.0)\n"
+		    "\t\treturn material.color;\n"
+		    + std::string(bindless
+		                      ? "\tsampler2DArray textures = "
+		                        "sampler2DArray(material."
+		                        "textures[slot]);\n"
+		                      : "#define textures "
+		                        "MaterialTextures[slot]\n")
+		    + "\tfloat lod = max(textureQueryLod(textures, "
+		      "uv).x, material.minLods[slot]);\n"
+		      "\treturn textureLod(textures, vec3(uv, "
+		      "float(material.layers[slot])), lod)\n"
+		      "\t       * material.color;\n"
+		    + (bindless ? "" : "#undef textures\n") + "}\n";
+		fragment += WeightedOit::GetShaderSource();
+	}
+
+	void MaterialTable::Update(
+	    ResourcePool<Material>& materials,
+	    const ResourcePool<Texture>& textures)
+	{
+		// Pass draws on to textures before the snapshot is
+		// redone.
+		const auto frame = GpuMemory::GetFrame();
+		for (const auto& info : m_materials)
+		{
+			const auto* material =
+			    info.used ? materials.Get(info.handle) : nullptr;
+			if (!material)
+			{
+				continue;
+			}
+			for (const auto texture :
+			     material->GetDesc().textures)
+			{
+				if (const auto* data = textures.Get(texture))
+				{
+					data->MarkUsed(frame);
+				}
+			}
+		}
+
+		m_materials.assign(materials.GetStats().capacity,
+		                   Info{});
+		m_constantData.clear();
+		materials.ForEach([&](MaterialHandle handle,
+		                      Material& material) {
+			const auto& desc = material.GetDesc();
+			auto& info = m_materials[handle.GetIndex()];
+			info.handle = handle;
+			info.set = 0;
+			info.state = FindState(desc.state);
+			info.shader = desc.shader;
+			if (!desc.constants.empty())
+			{
+				const auto offset =
+				    AlignConstants(m_constantData.size());
+				m_constantData.resize(offset);
+				m_constantData.insert(m_constantData.end(),
+				                      desc.constants.begin(),
+				                      desc.constants.end());
+				info.constants = {
+				    static_cast<uint32_t>(offset),
+				    static_cast<uint32_t>(
+				        desc.constants.size())};
+			}
+		});
+		UpdateConstants();
+
+		if (m_mode != Mode::Unsupported)
+		{
+			UpdateRecords(materials, textures);
+		}
+	}
+
+	// Materials change rarely, so the block is only
+	// uploaded when some material's constants did.
+	void MaterialTable::UpdateConstants()
+	{
+		if (m_constantData == m_uploadedConstants
+		    || m_constantData.empty())
+		{
+			return;
+		}
+		glBindBuffer(GL_UNIFORM_BUFFER, m_constantsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBufferData(GL_UNIFORM_BUFFER, m_constantData.size(),
+		             m_constantData.data(), GL_DYNAMIC_DRAW);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Resize(GpuResources::Type::Buffer,
+		                     m_constantsBuffer,
+		                     m_constantData.size());
+		m_uploadedConstants = m_constantData;
+	}
+
+	void MaterialTable::UpdateRecords(
+	    ResourcePool<Material>& materials,
+	    const ResourcePool<Texture>& textures)
+	{
+		const auto capacity = materials.GetStats().capacity;
+		const auto bindless = m_mode == Mode::Bindless;
+		m_records.resize(capacity);
+		m_sets.clear();
+
+		size_t first = capacity;
+		size_t last = 0;
+		materials.ForEach([&](MaterialHandle handle,
+		                      Material& material) {
+			const auto& desc = material.GetDesc();
+			Record record{};
+			TextureSet set{};
+			for (uint32_t slot = 0; slot < MaxTextures; ++slot)
+			{
+				record.minLods[slot] = -1.0f;
+				auto* texture =
+				    textures.Get(desc.textures[slot]);
+				if (!texture || !texture->IsReady())
+				{
+					continue;
+				}
+				if (bindless)
+				{
+					const auto textureHandle =
+					    texture->GetBindlessHandle();
+					if (!textureHandle)
+					{
+						continue;
+					}
+					record.handles[slot][0] =
+					    static_cast<uint32_t>(textureHandle);
+					record.handles[slot][1] =
+					    static_cast<uint32_t>(textureHandle
+					                          >> 32);
+				}
+				else
+				{
+					set[slot] = texture->GetArrayId();
+					if (!set[slot])
+					{
+						continue;
+					}
+				}
+				record.layers[slot] = desc.layers[slot];
+				record.minLods[slot] = static_cast<float>(
+				    texture->GetResidentLevel()
+				    - texture->GetStorageLevel());
+			}
+			std::copy(desc.color.begin(), desc.color.end(),
+			          record.color);
+
+			const auto index = handle.GetIndex();
+			m_materials[index].set = bindless ? 0 : FindSet(set);
+			if (std::memcmp(&m_records[index], &record,
+			                sizeof(record))
+			    != 0)
+			{
+				m_records[index] = record;
+				first = std::min<size_t>(first, index);
+				last = std::max<size_t>(last, index);
+			}
+		});
+
+		if (first <= last)
+		{
+			const auto size = m_records.size() * sizeof(Record);
+			if (size > m_bufferSize)
+			{
+				Upload(GL_SHADER_STORAGE_BUFFER, m_buffer,
+				       m_bufferSize, m_records.data(), size,
+				       GL_DYNAMIC_DRAW);
+			}
+			else
+			{
+				glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_buffer);
+				VEGAM_CHECK_GL_ERROR;
+				glBufferSubData(
+				    GL_SHADER_STORAGE_BUFFER,
+				    first * sizeof(Record),
+				    (last - first + 1) * sizeof(Record),
+				    m_records.data() + first);
+				VEGAM_CHECK_GL_ERROR;
+				glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+				VEGAM_CHECK_GL_ERROR;
+			}
+		}
+		if (m_bufferSize > 0)
+		{
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+			                 MaterialsBinding, m_buffer);
+			VEGAM_CHECK_GL_ERROR;
+		}
+	}
+
+	uint32_t MaterialTable::FindSet(const TextureSet& set)
+	{
+		const auto it = std::find(m_sets.begin(), m_sets.end(), set);
+		if (it != m_sets.end())
+		{
+			return static_cast<uint32_t>(it - m_sets.begin());
+		}
+		m_sets.push_back(set);
+		return static_cast<uint32_t>(m_sets.size() - 1);
+	}
+
+	uint32_t MaterialTable::FindState(const PipelineState& state)
+	{
+		const auto it =
+		    std::find(m_states.begin(), m_states.end(), state);
+		if (it != m_states.end())
+		{
+			return static_cast<uint32_t>(it - m_states.begin());
+		}
+		m_states.push_back(state);
+		return static_cast<uint32_t>(m_states.size() - 1);
+	}
+
+	void MaterialTable::UploadDrawMaterials(
+	    std::span<const uint32_t> materials)
+	{
+		if (m_mode == Mode::Unsupported || materials.empty())
+		{
+			return;
+		}
+
+		// Orphaned every frame, so the upload doesn't wait
+		// on last frame's draws.
+		Upload(GL_SHADER_STORAGE_BUFFER, m_drawBuffer,
+		       m_drawBufferSize, materials.data(),
+		       materials.size_bytes(), GL_STREAM_DRAW);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+		                 DrawMaterialsBinding, m_drawBuffer);
+		VEGAM_CHECK_GL_ERROR;
+	}
+} // namespace AthiVegam::Graphics
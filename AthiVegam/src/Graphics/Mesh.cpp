@@ -1,56 +1,103 @@
 #include "AthiVegam/Graphics/Mesh.h"
 
+#include "AthiVegam/Core/Memory.h"
+#include "AthiVegam/Graphics/GpuResources.h"
 #include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/MeshArena.h"
+#include "AthiVegam/Graphics/RetireQueue.h"
+#include "AthiVegam/Log.h"
 #include "glad/glad.h"
 
+#include <cstring>
+#include <utility>
+#include <vector>
+
 namespace AthiVegam::Graphics
 {
 	Mesh::Mesh(float* vertexArray, uint32_t vertexCount,
 	           uint32_t dimensions)
+	    : Mesh(VertexLayout::Positions(dimensions),
+	           vertexArray, vertexCount)
+	{
+	}
+
+	Mesh::Mesh(float* vertexArray, uint32_t vertexCount,
+	           uint32_t dimensions, uint32_t* elementArray,
+	           uint32_t elementCount)
+	    : Mesh(VertexLayout::Positions(dimensions),
+	           vertexArray, vertexCount, elementArray,
+	           elementCount)
+	{
+	}
+
+	Mesh::Mesh(const VertexLayout& layout,
+	           const void* vertexData, uint32_t vertexCount)
 	    : m_vertexCount(vertexCount)
 	    , m_elementCount(0)
 	    , m_ebo(0)
+	    , m_arena(nullptr)
+	    , m_baseVertex(0)
+	    , m_firstIndex(0)
+	    , m_indexType(SelectIndexType(vertexCount))
+	    , m_layout(layout)
+	    , m_bounds(ComputeBounds(layout, vertexData, vertexCount))
+	    , m_maxVertexCount(0)
+	    , m_maxElementCount(0)
+	    , m_ready(true)
 	{
 		glGenVertexArrays(1, &m_vao);
 		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(
+		    GpuResources::Type::VertexArray, m_vao, 0, "Mesh");
 		glBindVertexArray(m_vao);
 		VEGAM_CHECK_GL_ERROR;
 		{
-			glGenBuffers(1, &m_positionsVbo);
+			glGenBuffers(1, &m_vbo);
 			VEGAM_CHECK_GL_ERROR;
-			glBindBuffer(GL_ARRAY_BUFFER, m_positionsVbo);
+			glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
 			VEGAM_CHECK_GL_ERROR;
 			{
 				glBufferData(
 				    GL_ARRAY_BUFFER,
 				    static_cast<uint64_t>(vertexCount)
-				        * dimensions * sizeof(float),
-				    vertexArray, GL_STATIC_DRAW);
+				        * layout.GetStride(),
+				    vertexData, GL_STATIC_DRAW);
 				VEGAM_CHECK_GL_ERROR;
 
-				glEnableVertexAttribArray(0);
-				VEGAM_CHECK_GL_ERROR;
-				glVertexAttribPointer(0, dimensions,
-				                      GL_FLOAT, GL_FALSE, 0,
-				                      0);
-				VEGAM_CHECK_GL_ERROR;
-				glDisableVertexAttribArray(0);
-				VEGAM_CHECK_GL_ERROR;
+				// Attribute enables are VAO state, so leave
+				// them on and binding the VAO is enough.
+				layout.Apply();
 			}
 			glBindBuffer(GL_ARRAY_BUFFER, 0);
 			VEGAM_CHECK_GL_ERROR;
 		}
 		glBindVertexArray(0);
 		VEGAM_CHECK_GL_ERROR;
+
+		Core::Memory::TrackGpu(
+		    Core::Memory::Tag::Assets,
+		    static_cast<int64_t>(vertexCount)
+		        * layout.GetStride());
+		GpuResources::Register(
+		    GpuResources::Type::Buffer, m_vbo,
+		    static_cast<size_t>(vertexCount) * layout.GetStride(),
+		    "Mesh vertices", m_vao);
 	}
 
-	Mesh::Mesh(float* vertexArray, uint32_t vertexCount,
-	           uint32_t dimensions, uint32_t* elementArray,
+	Mesh::Mesh(const VertexLayout& layout,
+	           const void* vertexData, uint32_t vertexCount,
+	           const uint32_t* elementArray,
 	           uint32_t elementCount)
-	    : Mesh(vertexArray, vertexCount, dimensions)
+	    : Mesh(layout, vertexData, vertexCount)
 	{
 		m_elementCount = elementCount;
 
+		std::vector<uint8_t> indices(
+		    static_cast<size_t>(elementCount)
+		    * GetIndexSize(m_indexType));
+		WriteIndices(elementArray, elementCount, m_indexType,
+		             indices.data());
+
 		glBindVertexArray(m_vao);
 		VEGAM_CHECK_GL_ERROR;
 		{
@@ -59,41 +106,307 @@ namespace AthiVegam::Graphics
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
 			VEGAM_CHECK_GL_ERROR;
 			glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-			             static_cast<uint64_t>(elementCount)
-			                 * sizeof(uint32_t),
-			             elementArray, GL_STATIC_DRAW);
+			             indices.size(), indices.data(),
+			             GL_STATIC_DRAW);
 			VEGAM_CHECK_GL_ERROR;
 		}
 		glBindVertexArray(0);
 		VEGAM_CHECK_GL_ERROR;
+
+		Core::Memory::TrackGpu(
+		    Core::Memory::Tag::Assets,
+		    static_cast<int64_t>(indices.size()));
+		GpuResources::Register(GpuResources::Type::Buffer,
+		                       m_ebo, indices.size(),
+		                       "Mesh indices", m_vao);
 	}
 
-	Mesh::~Mesh()
+	Mesh::Mesh(MeshArena& arena, const void* vertexData,
+	           uint32_t vertexCount,
+	           const uint32_t* elementArray,
+	           uint32_t elementCount)
+	    : m_vertexCount(vertexCount)
+	    , m_elementCount(elementCount)
+	    , m_vao(arena.GetVao())
+	    , m_ebo(0)
+	    , m_vbo(0)
+	    , m_arena(&arena)
+	    , m_baseVertex(0)
+	    , m_firstIndex(0)
+	    , m_indexType(arena.GetIndexType())
+	    , m_layout(arena.GetLayout())
+	    , m_bounds(ComputeBounds(arena.GetLayout(), vertexData,
+	                             vertexCount))
+	    , m_maxVertexCount(0)
+	    , m_maxElementCount(0)
+	    , m_ready(true)
 	{
-		glDeleteBuffers(1, &m_positionsVbo);
+		auto allocation =
+		    arena.Allocate(*this, vertexData, vertexCount,
+		                   elementArray, elementCount);
+		VEGAM_ASSERT(allocation.valid,
+		             "Failed to allocate mesh in arena");
+		if (!allocation.valid)
+		{
+			// Nothing to draw; also keeps Free() a no-op.
+			m_vertexCount = 0;
+			m_elementCount = 0;
+		}
+		m_baseVertex = allocation.baseVertex;
+		m_firstIndex = allocation.firstIndex;
+	}
+
+	Mesh::Mesh(uint32_t dimensions, uint32_t maxVertexCount,
+	           uint32_t maxElementCount)
+	    : Mesh(VertexLayout::Positions(dimensions),
+	           maxVertexCount, maxElementCount)
+	{
+	}
+
+	Mesh::Mesh(const VertexLayout& layout,
+	           uint32_t maxVertexCount,
+	           uint32_t maxElementCount)
+	    : m_vertexCount(0)
+	    , m_elementCount(0)
+	    , m_ebo(0)
+	    , m_vbo(0)
+	    , m_arena(nullptr)
+	    , m_baseVertex(0)
+	    , m_firstIndex(0)
+	    , m_indexType(SelectIndexType(maxVertexCount))
+	    , m_layout(layout)
+	    , m_bounds(Aabb::Infinite())
+	    , m_maxVertexCount(maxVertexCount)
+	    , m_maxElementCount(maxElementCount)
+	    , m_ready(true)
+	{
+		glGenVertexArrays(1, &m_vao);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::VertexArray,
+		                       m_vao, 0, "Dynamic mesh");
+
+		m_vertexStream = std::make_unique<StreamBuffer>(
+		    static_cast<size_t>(maxVertexCount)
+		    * layout.GetStride());
+		if (maxElementCount > 0)
+		{
+			m_indexStream = std::make_unique<StreamBuffer>(
+			    static_cast<size_t>(maxElementCount)
+			    * GetIndexSize(m_indexType));
+		}
+
+		// Every segment is addressed through the base vertex
+		// and first index, so the attributes start at 0.
+		glBindVertexArray(m_vao);
 		VEGAM_CHECK_GL_ERROR;
+		{
+			glBindBuffer(GL_ARRAY_BUFFER,
+			             m_vertexStream->GetId());
+			VEGAM_CHECK_GL_ERROR;
+			layout.Apply();
+
+			if (m_indexStream)
+			{
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+				             m_indexStream->GetId());
+				VEGAM_CHECK_GL_ERROR;
+			}
+		}
+		glBindVertexArray(0);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	Mesh::Mesh(const VertexLayout& layout, const Aabb& bounds)
+	    : m_vertexCount(0)
+	    , m_elementCount(0)
+	    , m_vao(0)
+	    , m_ebo(0)
+	    , m_vbo(0)
+	    , m_arena(nullptr)
+	    , m_baseVertex(0)
+	    , m_firstIndex(0)
+	    , m_indexType(IndexType::UInt32)
+	    , m_layout(layout)
+	    , m_bounds(bounds)
+	    , m_maxVertexCount(0)
+	    , m_maxElementCount(0)
+	    , m_ready(false)
+	{
+	}
+
+	Mesh::~Mesh()
+	{
+		SetMeshlets({});
+		if (m_arena)
+		{
+			m_arena->Free(*this);
+			return;
+		}
+
+		if (IsDynamic())
+		{
+			m_vertexStream.reset();
+			m_indexStream.reset();
+			GpuResources::Unregister(
+			    GpuResources::Type::VertexArray, m_vao);
+			RetireQueue::RetireVertexArray(m_vao);
+			return;
+		}
+
+		if (m_vao == 0)
+		{
+			// Placeholder whose upload never landed.
+			return;
+		}
+
+		GpuResources::Unregister(GpuResources::Type::Buffer,
+		                         m_vbo);
+		RetireQueue::RetireBuffer(m_vbo);
+		auto gpuSize = static_cast<int64_t>(m_vertexCount)
+		               * m_layout.GetStride();
 		if (m_ebo != 0)
 		{
-			glDeleteBuffers(1, &m_ebo);
-			VEGAM_CHECK_GL_ERROR
+			GpuResources::Unregister(
+			    GpuResources::Type::Buffer, m_ebo);
+			RetireQueue::RetireBuffer(m_ebo);
+			gpuSize += static_cast<int64_t>(m_elementCount)
+			           * GetIndexSize(m_indexType);
+		}
+		GpuResources::Unregister(
+		    GpuResources::Type::VertexArray, m_vao);
+		RetireQueue::RetireVertexArray(m_vao);
+		Core::Memory::TrackGpu(Core::Memory::Tag::Assets,
+		                       -gpuSize);
+	}
+
+	void Mesh::SetMeshlets(std::span<const Meshlet> meshlets)
+	{
+		VEGAM_ASSERT(meshlets.empty() || m_arena,
+		             "Only arena meshes are culled by meshlet");
+		if (m_meshletBuffer != 0)
+		{
+			GpuResources::Unregister(GpuResources::Type::Buffer,
+			                         m_meshletBuffer);
+			RetireQueue::RetireBuffer(m_meshletBuffer);
+			Core::Memory::TrackGpu(
+			    Core::Memory::Tag::Assets,
+			    -static_cast<int64_t>(m_meshletCount
+			                          * sizeof(Meshlet)));
+			m_meshletBuffer = 0;
+			m_meshletCount = 0;
+		}
+		if (meshlets.empty())
+		{
+			return;
 		}
-		glDeleteVertexArrays(1, &m_vao);
+
+		glGenBuffers(1, &m_meshletBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_meshletBuffer);
 		VEGAM_CHECK_GL_ERROR;
+		glBufferData(GL_SHADER_STORAGE_BUFFER,
+		             meshlets.size_bytes(), meshlets.data(),
+		             GL_STATIC_DRAW);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		m_meshletCount = static_cast<uint32_t>(meshlets.size());
+		GpuResources::Register(GpuResources::Type::Buffer,
+		                       m_meshletBuffer,
+		                       meshlets.size_bytes(), "Meshlets");
+		Core::Memory::TrackGpu(
+		    Core::Memory::Tag::Assets,
+		    static_cast<int64_t>(meshlets.size_bytes()));
+	}
+
+	void Mesh::Swap(Mesh& other)
+	{
+		// Arenas track their meshes by address.
+		if (m_arena)
+		{
+			m_arena->SwapOwners(*this, other);
+		}
+		if (other.m_arena && other.m_arena != m_arena)
+		{
+			other.m_arena->SwapOwners(*this, other);
+		}
+		std::swap(m_vertexCount, other.m_vertexCount);
+		std::swap(m_elementCount, other.m_elementCount);
+		std::swap(m_vao, other.m_vao);
+		std::swap(m_ebo, other.m_ebo);
+		std::swap(m_vbo, other.m_vbo);
+		std::swap(m_arena, other.m_arena);
+		std::swap(m_baseVertex, other.m_baseVertex);
+		std::swap(m_firstIndex, other.m_firstIndex);
+		std::swap(m_indexType, other.m_indexType);
+		std::swap(m_layout, other.m_layout);
+		std::swap(m_bounds, other.m_bounds);
+		std::swap(m_meshletBuffer, other.m_meshletBuffer);
+		std::swap(m_meshletCount, other.m_meshletCount);
+		std::swap(m_maxVertexCount, other.m_maxVertexCount);
+		std::swap(m_maxElementCount, other.m_maxElementCount);
+		std::swap(m_vertexStream, other.m_vertexStream);
+		std::swap(m_indexStream, other.m_indexStream);
+		std::swap(m_ready, other.m_ready);
 	}
 
 	void Mesh::Bind()
 	{
 		glBindVertexArray(m_vao);
 		VEGAM_CHECK_GL_ERROR;
-		glEnableVertexAttribArray(0);
-		VEGAM_CHECK_GL_ERROR;
 	}
 
 	void Mesh::Unbind()
 	{
-		glDisableVertexAttribArray(0);
-		VEGAM_CHECK_GL_ERROR;
 		glBindVertexArray(0);
 		VEGAM_CHECK_GL_ERROR;
 	}
+
+	bool Mesh::Update(const void* vertexData,
+	                  uint32_t vertexCount,
+	                  const uint32_t* elementArray,
+	                  uint32_t elementCount)
+	{
+		VEGAM_ASSERT(IsDynamic(),
+		             "Attempting to update a static mesh");
+		if (!IsDynamic())
+		{
+			return false;
+		}
+
+		if (vertexCount > m_maxVertexCount
+		    || elementCount > m_maxElementCount)
+		{
+			VEGAM_ERROR("Dynamic mesh update of {} vertices / "
+			            "{} indices exceeds its capacity",
+			            vertexCount, elementCount);
+			return false;
+		}
+
+		auto* vertices = m_vertexStream->BeginWrite();
+		std::memcpy(vertices, vertexData,
+		            static_cast<size_t>(vertexCount)
+		                * m_layout.GetStride());
+		m_vertexStream->EndWrite();
+		m_baseVertex =
+		    m_vertexStream->GetSegment() * m_maxVertexCount;
+
+		if (m_indexStream)
+		{
+			auto* indices = m_indexStream->BeginWrite();
+			WriteIndices(elementArray, elementCount,
+			             m_indexType, indices);
+			m_indexStream->EndWrite();
+			m_firstIndex = m_indexStream->GetSegment()
+			               * m_maxElementCount;
+		}
+
+		m_vertexCount = vertexCount;
+		m_elementCount = elementCount;
+		m_bounds =
+		    ComputeBounds(m_layout, vertexData, vertexCount);
+		return true;
+	}
 } // namespace AthiVegam::Graphics
@@ -0,0 +1,471 @@
+#include "AthiVegam/Graphics/MeshArena.h"
+
+#include "AthiVegam/Core/Memory.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/Mesh.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace AthiVegam::Graphics
+{
+	MeshArena::MeshArena(uint32_t dimensions,
+	                     uint32_t vertexCapacity,
+	                     uint32_t indexCapacity,
+	                     IndexType indexType)
+	    : MeshArena(VertexLayout::Positions(dimensions),
+	                vertexCapacity, indexCapacity, indexType)
+	{
+	}
+
+	MeshArena::MeshArena(const VertexLayout& layout,
+	                     uint32_t vertexCapacity,
+	                     uint32_t indexCapacity,
+	                     IndexType indexType)
+	    : m_layout(layout)
+	    , m_indexType(indexType)
+	{
+		m_vertices.capacity = vertexCapacity;
+		m_indices.capacity = indexCapacity;
+
+		glGenVertexArrays(1, &m_vao);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::VertexArray,
+		                       m_vao, 0, "Mesh arena");
+		CreateBuffers(m_vbo, m_ebo);
+		BindBuffers();
+		Core::Memory::TrackGpu(Core::Memory::Tag::Assets,
+		                       GetGpuSize());
+	}
+
+	MeshArena::~MeshArena()
+	{
+		VEGAM_ASSERT(m_meshes.empty(),
+		             "Destroying a MeshArena with live meshes");
+
+		GpuResources::Unregister(GpuResources::Type::Buffer,
+		                         m_vbo);
+		GpuResources::Unregister(GpuResources::Type::Buffer,
+		                         m_ebo);
+		GpuResources::Unregister(
+		    GpuResources::Type::VertexArray, m_vao);
+		glDeleteBuffers(1, &m_vbo);
+		VEGAM_CHECK_GL_ERROR;
+		glDeleteBuffers(1, &m_ebo);
+		VEGAM_CHECK_GL_ERROR;
+		glDeleteVertexArrays(1, &m_vao);
+		VEGAM_CHECK_GL_ERROR;
+		Core::Memory::TrackGpu(Core::Memory::Tag::Assets,
+		                       -GetGpuSize());
+	}
+
+	int64_t MeshArena::GetGpuSize() const
+	{
+		return static_cast<int64_t>(m_vertices.capacity)
+		           * m_layout.GetStride()
+		       + static_cast<int64_t>(m_indices.capacity)
+		             * GetIndexSize(m_indexType);
+	}
+
+	MeshArena::Allocation
+	MeshArena::Allocate(Mesh& owner, const void* vertexData,
+	                    uint32_t vertexCount,
+	                    const uint32_t* elementArray,
+	                    uint32_t elementCount)
+	{
+		auto allocation =
+		    Reserve(owner, vertexCount, elementCount);
+		if (!allocation.valid)
+		{
+			return allocation;
+		}
+
+		const auto vertexSize = m_layout.GetStride();
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		VEGAM_CHECK_GL_ERROR;
+		glBufferSubData(GL_ARRAY_BUFFER,
+		                allocation.baseVertex * vertexSize,
+		                vertexCount * vertexSize, vertexData);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		if (elementCount > 0)
+		{
+			const auto indexSize = GetIndexSize(m_indexType);
+			std::vector<uint8_t> indices(
+			    static_cast<size_t>(elementCount) * indexSize);
+			WriteIndices(elementArray, elementCount,
+			             m_indexType, indices.data());
+
+			// Binding the element buffer outside of the VAO
+			// would replace the VAO's element binding.
+			glBindVertexArray(m_vao);
+			VEGAM_CHECK_GL_ERROR;
+			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+			                allocation.firstIndex * indexSize,
+			                indices.size(), indices.data());
+			VEGAM_CHECK_GL_ERROR;
+			glBindVertexArray(0);
+			VEGAM_CHECK_GL_ERROR;
+		}
+
+		return allocation;
+	}
+
+	MeshArena::Allocation
+	MeshArena::Reserve(Mesh& owner, uint32_t vertexCount,
+	                   uint32_t elementCount)
+	{
+		Allocation allocation;
+
+		if (m_indexType == IndexType::UInt16
+		    && elementCount > 0
+		    && vertexCount > MaxUInt16IndexedVertices)
+		{
+			VEGAM_ERROR("Mesh of {} vertices needs 32-bit "
+			            "indices, arena uses 16-bit",
+			            vertexCount);
+			return allocation;
+		}
+
+		if (!CanFit(vertexCount, elementCount))
+		{
+			VEGAM_ERROR("MeshArena out of space: {} "
+			            "vertices / {} indices requested",
+			            vertexCount, elementCount);
+			return allocation;
+		}
+
+		uint32_t baseVertex = 0;
+		uint32_t firstIndex = 0;
+		auto allocated = m_vertices.Allocate(vertexCount,
+		                                     baseVertex);
+		if (allocated
+		    && !m_indices.Allocate(elementCount, firstIndex))
+		{
+			m_vertices.Free(baseVertex, vertexCount);
+			allocated = false;
+		}
+
+		if (!allocated)
+		{
+			// There is room, just not in one piece.
+			Compact();
+			m_vertices.Allocate(vertexCount, baseVertex);
+			m_indices.Allocate(elementCount, firstIndex);
+		}
+
+		m_meshes.push_back(&owner);
+
+		allocation.baseVertex = baseVertex;
+		allocation.firstIndex = firstIndex;
+		allocation.valid = true;
+		return allocation;
+	}
+
+	void MeshArena::CopyFrom(uint32_t sourceBuffer,
+	                         size_t vertexOffset,
+	                         size_t indexOffset,
+	                         const Allocation& allocation,
+	                         uint32_t vertexCount,
+	                         uint32_t elementCount)
+	{
+		const auto vertexSize = m_layout.GetStride();
+		const auto indexSize = GetIndexSize(m_indexType);
+
+		glBindBuffer(GL_COPY_READ_BUFFER, sourceBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_vbo);
+		VEGAM_CHECK_GL_ERROR;
+		glCopyBufferSubData(
+		    GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+		    vertexOffset, allocation.baseVertex * vertexSize,
+		    static_cast<size_t>(vertexCount) * vertexSize);
+		VEGAM_CHECK_GL_ERROR;
+
+		if (elementCount > 0)
+		{
+			glBindBuffer(GL_COPY_WRITE_BUFFER, m_ebo);
+			VEGAM_CHECK_GL_ERROR;
+			glCopyBufferSubData(
+			    GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+			    indexOffset, allocation.firstIndex * indexSize,
+			    static_cast<size_t>(elementCount) * indexSize);
+			VEGAM_CHECK_GL_ERROR;
+		}
+
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void MeshArena::Free(Mesh& owner)
+	{
+		auto it =
+		    std::find(m_meshes.begin(), m_meshes.end(), &owner);
+		if (it == m_meshes.end())
+		{
+			return;
+		}
+
+		*it = m_meshes.back();
+		m_meshes.pop_back();
+
+		m_vertices.Free(owner.GetBaseVertex(),
+		                owner.GetVertexCount());
+		m_indices.Free(owner.GetFirstIndex(),
+		               owner.GetElementCount());
+	}
+
+	void MeshArena::SwapOwners(Mesh& a, Mesh& b)
+	{
+		for (auto*& mesh : m_meshes)
+		{
+			if (mesh == &a)
+			{
+				mesh = &b;
+			}
+			else if (mesh == &b)
+			{
+				mesh = &a;
+			}
+		}
+	}
+
+	bool MeshArena::CanFit(uint32_t vertexCount,
+	                       uint32_t elementCount) const
+	{
+		return m_vertices.used + vertexCount
+		           <= m_vertices.capacity
+		       && m_indices.used + elementCount
+		              <= m_indices.capacity;
+	}
+
+	void MeshArena::Compact()
+	{
+		if (m_vertices.holes.empty() && m_indices.holes.empty())
+		{
+			return;
+		}
+
+		// Copy into fresh buffers instead of moving in place,
+		// copies between overlapping ranges are undefined.
+		uint32_t vbo = 0;
+		uint32_t ebo = 0;
+		CreateBuffers(vbo, ebo);
+
+		// Keep the meshes in their current order.
+		std::sort(m_meshes.begin(), m_meshes.end(),
+		          [](const Mesh* a, const Mesh* b) {
+			          return a->GetBaseVertex()
+			                 < b->GetBaseVertex();
+		          });
+
+		const auto vertexSize = m_layout.GetStride();
+		const auto indexSize = GetIndexSize(m_indexType);
+		uint32_t vertexHead = 0;
+		uint32_t indexHead = 0;
+
+		glBindBuffer(GL_COPY_READ_BUFFER, m_vbo);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+		VEGAM_CHECK_GL_ERROR;
+		for (auto* mesh : m_meshes)
+		{
+			glCopyBufferSubData(
+			    GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+			    mesh->GetBaseVertex() * vertexSize,
+			    vertexHead * vertexSize,
+			    mesh->GetVertexCount() * vertexSize);
+			VEGAM_CHECK_GL_ERROR;
+			mesh->m_baseVertex = vertexHead;
+			vertexHead += mesh->GetVertexCount();
+		}
+
+		// Indices are relative to the base vertex, so they
+		// move without being rewritten.
+		glBindBuffer(GL_COPY_READ_BUFFER, m_ebo);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+		VEGAM_CHECK_GL_ERROR;
+		for (auto* mesh : m_meshes)
+		{
+			if (mesh->GetElementCount() > 0)
+			{
+				glCopyBufferSubData(
+				    GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+				    mesh->GetFirstIndex() * indexSize,
+				    indexHead * indexSize,
+				    mesh->GetElementCount() * indexSize);
+				VEGAM_CHECK_GL_ERROR;
+			}
+			mesh->m_firstIndex = indexHead;
+			indexHead += mesh->GetElementCount();
+		}
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		GpuResources::Unregister(GpuResources::Type::Buffer,
+		                         m_vbo);
+		GpuResources::Unregister(GpuResources::Type::Buffer,
+		                         m_ebo);
+		glDeleteBuffers(1, &m_vbo);
+		VEGAM_CHECK_GL_ERROR;
+		glDeleteBuffers(1, &m_ebo);
+		VEGAM_CHECK_GL_ERROR;
+		m_vbo = vbo;
+		m_ebo = ebo;
+		BindBuffers();
+
+		m_vertices.holes.clear();
+		m_vertices.head = vertexHead;
+		m_indices.holes.clear();
+		m_indices.head = indexHead;
+
+		VEGAM_TRACE("MeshArena compacted: {} meshes, {} "
+		            "vertices, {} indices",
+		            m_meshes.size(), vertexHead, indexHead);
+	}
+
+	void MeshArena::CreateBuffers(uint32_t& vbo,
+	                              uint32_t& ebo) const
+	{
+		// Created through the copy targets so the bound
+		// VAO's element binding is left alone.
+		glGenBuffers(1, &vbo);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+		VEGAM_CHECK_GL_ERROR;
+		glBufferData(GL_COPY_WRITE_BUFFER,
+		             static_cast<uint64_t>(m_vertices.capacity)
+		                 * m_layout.GetStride(),
+		             nullptr, GL_STATIC_DRAW);
+		VEGAM_CHECK_GL_ERROR;
+
+		glGenBuffers(1, &ebo);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+		VEGAM_CHECK_GL_ERROR;
+		glBufferData(GL_COPY_WRITE_BUFFER,
+		             static_cast<uint64_t>(m_indices.capacity)
+		                 * GetIndexSize(m_indexType),
+		             nullptr, GL_STATIC_DRAW);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		GpuResources::Register(
+		    GpuResources::Type::Buffer, vbo,
+		    static_cast<size_t>(m_vertices.capacity)
+		        * m_layout.GetStride(),
+		    "Mesh arena vertices", m_vao);
+		GpuResources::Register(
+		    GpuResources::Type::Buffer, ebo,
+		    static_cast<size_t>(m_indices.capacity)
+		        * GetIndexSize(m_indexType),
+		    "Mesh arena indices", m_vao);
+	}
+
+	void MeshArena::BindBuffers()
+	{
+		glBindVertexArray(m_vao);
+		VEGAM_CHECK_GL_ERROR;
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+			VEGAM_CHECK_GL_ERROR;
+			m_layout.Apply();
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glBindVertexArray(0);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	bool MeshArena::RangeAllocator::Allocate(
+	    uint32_t count, uint32_t& offset)
+	{
+		if (count == 0)
+		{
+			offset = 0;
+			return true;
+		}
+
+		for (auto it = holes.begin(); it != holes.end(); ++it)
+		{
+			if (it->count >= count)
+			{
+				offset = it->offset;
+				it->offset += count;
+				it->count -= count;
+				if (it->count == 0)
+				{
+					holes.erase(it);
+				}
+				used += count;
+				return true;
+			}
+		}
+
+		if (head + count > capacity)
+		{
+			return false;
+		}
+
+		offset = head;
+		head += count;
+		used += count;
+		return true;
+	}
+
+	void MeshArena::RangeAllocator::Free(uint32_t offset,
+	                                     uint32_t count)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+		used -= count;
+
+		auto it = std::lower_bound(
+		    holes.begin(), holes.end(), offset,
+		    [](const Range& range, uint32_t value) {
+			    return range.offset < value;
+		    });
+		it = holes.insert(it, {offset, count});
+
+		// Merge with the following and preceding hole.
+		auto next = it + 1;
+		if (next != holes.end()
+		    && it->offset + it->count == next->offset)
+		{
+			it->count += next->count;
+			holes.erase(next);
+		}
+		if (it != holes.begin())
+		{
+			auto prev = it - 1;
+			if (prev->offset + prev->count == it->offset)
+			{
+				prev->count += it->count;
+				it = holes.erase(it) - 1;
+			}
+		}
+
+		// A hole touching the head is just unused space.
+		if (it->offset + it->count == head)
+		{
+			head = it->offset;
+			holes.erase(it);
+		}
+	}
+} // namespace AthiVegam::Graphics
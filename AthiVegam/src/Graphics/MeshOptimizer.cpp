@@ -0,0 +1,465 @@
+#include "AthiVegam/Graphics/MeshOptimizer.h"
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <string_view>
+#include <unordered_map>
+
+namespace AthiVegam::Graphics::MeshOptimizer
+{
+	namespace
+	{
+		// Forsyth's linear-speed vertex cache optimisation,
+		// scored against a simulated LRU cache.
+		constexpr int32_t CacheSize = 32;
+		constexpr float CacheDecayPower = 1.5f;
+		constexpr float LastTriangleScore = 0.75f;
+		constexpr float ValenceBoostScale = 2.f;
+		constexpr float ValenceBoostPower = 0.5f;
+
+		// FIFO size used to find cluster boundaries for the
+		// overdraw pass; close to typical hardware.
+		constexpr uint32_t ClusterCacheSize = 16;
+
+		float VertexScore(int32_t cachePosition,
+		                  uint32_t remainingTriangles)
+		{
+			if (remainingTriangles == 0)
+			{
+				return -1.f;
+			}
+
+			float score = 0.f;
+			if (cachePosition >= 0)
+			{
+				if (cachePosition < 3)
+				{
+					// The last triangle's vertices get a fixed
+					// score so the next triangle doesn't just
+					// reuse them.
+					score = LastTriangleScore;
+				}
+				else
+				{
+					const auto scale =
+					    1.f / (CacheSize - 3);
+					score = std::pow(
+					    1.f - (cachePosition - 3) * scale,
+					    CacheDecayPower);
+				}
+			}
+
+			// Favour vertices with few triangles left so they
+			// are finished off and leave the working set.
+			score += ValenceBoostScale
+			         * std::pow(static_cast<float>(
+			                        remainingTriangles),
+			                    -ValenceBoostPower);
+			return score;
+		}
+
+		bool ReadPosition(const VertexLayout& layout,
+		                  uint32_t& offset)
+		{
+			for (uint32_t i = 0; i < layout.GetAttributeCount();
+			     ++i)
+			{
+				const auto& attribute = layout.GetAttribute(i);
+				if (attribute.location != 0)
+				{
+					continue;
+				}
+				if (attribute.format == VertexFormat::Float3
+				    || attribute.format == VertexFormat::Float4)
+				{
+					offset = attribute.offset;
+					return true;
+				}
+				return false;
+			}
+			return false;
+		}
+
+		std::array<float, 3> LoadPosition(const uint8_t* vertices,
+		                                  uint32_t stride,
+		                                  uint32_t offset,
+		                                  uint32_t index)
+		{
+			std::array<float, 3> position;
+			std::memcpy(position.data(),
+			            vertices
+			                + static_cast<size_t>(index) * stride
+			                + offset,
+			            sizeof(position));
+			return position;
+		}
+	} // namespace
+
+	void Optimize(const VertexLayout& layout,
+	              std::vector<uint8_t>& vertices,
+	              std::vector<uint32_t>& indices,
+	              const Options& options)
+	{
+		const auto stride = layout.GetStride();
+		if (indices.empty() || stride == 0
+		    || indices.size() % 3 != 0)
+		{
+			VEGAM_WARN("MeshOptimizer needs an indexed "
+			           "triangle list, skipping");
+			return;
+		}
+
+		auto vertexCount =
+		    static_cast<uint32_t>(vertices.size() / stride);
+
+		if (options.weldVertices)
+		{
+			WeldVertices(vertices.data(), vertexCount, stride,
+			             indices);
+		}
+		if (options.vertexCache)
+		{
+			OptimizeVertexCache(indices, vertexCount);
+		}
+
+		uint32_t positionOffset = 0;
+		if (options.overdraw
+		    && ReadPosition(layout, positionOffset))
+		{
+			OptimizeOverdraw(indices, vertices.data(),
+			                 vertexCount, stride,
+			                 positionOffset);
+		}
+
+		// Welding leaves unreferenced vertices behind, so
+		// compact them away even if fetch order is not
+		// wanted.
+		if (options.vertexFetch || options.weldVertices)
+		{
+			OptimizeVertexFetch(vertices, stride, indices);
+		}
+	}
+
+	void WeldVertices(const uint8_t* vertices,
+	                  uint32_t vertexCount, uint32_t stride,
+	                  std::vector<uint32_t>& indices)
+	{
+		std::unordered_map<std::string_view, uint32_t> unique;
+		unique.reserve(vertexCount);
+
+		std::vector<uint32_t> remap(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; ++i)
+		{
+			const std::string_view key(
+			    reinterpret_cast<const char*>(
+			        vertices + static_cast<size_t>(i) * stride),
+			    stride);
+			remap[i] = unique.try_emplace(key, i).first->second;
+		}
+
+		for (auto& index : indices)
+		{
+			index = remap[index];
+		}
+	}
+
+	void OptimizeVertexCache(std::vector<uint32_t>& indices,
+	                         uint32_t vertexCount)
+	{
+		const auto triangleCount =
+		    static_cast<uint32_t>(indices.size() / 3);
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		// Triangles touching each vertex, CSR style.
+		std::vector<uint32_t> remaining(vertexCount, 0);
+		for (auto index : indices)
+		{
+			++remaining[index];
+		}
+		std::vector<uint32_t> firstTriangle(vertexCount + 1, 0);
+		std::partial_sum(remaining.begin(), remaining.end(),
+		                 firstTriangle.begin() + 1);
+		std::vector<uint32_t> adjacency(indices.size());
+		{
+			auto cursor = firstTriangle;
+			for (uint32_t i = 0; i < indices.size(); ++i)
+			{
+				adjacency[cursor[indices[i]]++] = i / 3;
+			}
+		}
+
+		std::vector<float> vertexScore(vertexCount);
+		for (uint32_t v = 0; v < vertexCount; ++v)
+		{
+			vertexScore[v] = VertexScore(-1, remaining[v]);
+		}
+
+		std::vector<bool> emitted(triangleCount, false);
+
+		std::vector<uint32_t> output;
+		output.reserve(indices.size());
+
+		// Cache plus room for the triangle being added.
+		std::vector<uint32_t> cache;
+		std::vector<uint32_t> nextCache;
+		cache.reserve(CacheSize + 3);
+		nextCache.reserve(CacheSize + 3);
+
+		uint32_t scanCursor = 0;
+		int64_t best = -1;
+		while (output.size() < indices.size())
+		{
+			if (best < 0)
+			{
+				// Nothing in the cache touches a live
+				// triangle; restart at the next one in input
+				// order, which keeps the pass linear.
+				while (emitted[scanCursor])
+				{
+					++scanCursor;
+				}
+				best = scanCursor;
+			}
+
+			const auto triangle = static_cast<uint32_t>(best);
+			emitted[triangle] = true;
+
+			nextCache.clear();
+			for (uint32_t corner = 0; corner < 3; ++corner)
+			{
+				const auto v = indices[triangle * 3 + corner];
+				output.push_back(v);
+				nextCache.push_back(v);
+
+				// Drop the triangle from the vertex's list.
+				auto* begin = &adjacency[firstTriangle[v]];
+				auto* end = begin + remaining[v];
+				auto* it = std::find(begin, end, triangle);
+				std::swap(*it, *(end - 1));
+				--remaining[v];
+			}
+			for (auto v : cache)
+			{
+				if (v != nextCache[0] && v != nextCache[1]
+				    && v != nextCache[2])
+				{
+					nextCache.push_back(v);
+				}
+			}
+
+			// Vertices pushed out of the cache lose their
+			// cache score.
+			for (size_t i = CacheSize; i < nextCache.size(); ++i)
+			{
+				const auto v = nextCache[i];
+				vertexScore[v] = VertexScore(-1, remaining[v]);
+			}
+			if (nextCache.size() > CacheSize)
+			{
+				nextCache.resize(CacheSize);
+			}
+			std::swap(cache, nextCache);
+
+			// Rescore the cached vertices and pick the best
+			// triangle touching them.
+			for (size_t i = 0; i < cache.size(); ++i)
+			{
+				const auto v = cache[i];
+				vertexScore[v] = VertexScore(
+				    static_cast<int32_t>(i), remaining[v]);
+			}
+
+			best = -1;
+			float bestScore = -1.f;
+			for (auto v : cache)
+			{
+				for (uint32_t i = 0; i < remaining[v]; ++i)
+				{
+					const auto t = adjacency[firstTriangle[v] + i];
+					const auto score =
+					    vertexScore[indices[t * 3]]
+					    + vertexScore[indices[t * 3 + 1]]
+					    + vertexScore[indices[t * 3 + 2]];
+					if (score > bestScore)
+					{
+						bestScore = score;
+						best = t;
+					}
+				}
+			}
+		}
+
+		indices = std::move(output);
+	}
+
+	void OptimizeOverdraw(std::vector<uint32_t>& indices,
+	                      const uint8_t* vertices,
+	                      uint32_t vertexCount, uint32_t stride,
+	                      uint32_t positionOffset)
+	{
+		const auto triangleCount =
+		    static_cast<uint32_t>(indices.size() / 3);
+		if (triangleCount < 2)
+		{
+			return;
+		}
+
+		// Split where a triangle misses the cache on every
+		// vertex: reordering whole clusters keeps the
+		// vertex cache behaviour of the previous pass.
+		std::vector<uint32_t> clusterStart;
+		{
+			std::vector<uint32_t> timestamp(vertexCount, 0);
+			uint32_t time = ClusterCacheSize + 1;
+			for (uint32_t t = 0; t < triangleCount; ++t)
+			{
+				uint32_t misses = 0;
+				for (uint32_t corner = 0; corner < 3; ++corner)
+				{
+					const auto v = indices[t * 3 + corner];
+					if (time - timestamp[v] > ClusterCacheSize)
+					{
+						timestamp[v] = time++;
+						++misses;
+					}
+				}
+				if (t == 0 || misses == 3)
+				{
+					clusterStart.push_back(t);
+				}
+			}
+		}
+		if (clusterStart.size() < 2)
+		{
+			return;
+		}
+
+		const auto load = [&](uint32_t index)
+		{
+			return LoadPosition(vertices, stride,
+			                    positionOffset, index);
+		};
+
+		std::array<float, 3> meshCentroid{};
+		for (uint32_t v = 0; v < vertexCount; ++v)
+		{
+			const auto p = load(v);
+			for (int i = 0; i < 3; ++i)
+			{
+				meshCentroid[i] += p[i] / vertexCount;
+			}
+		}
+
+		// Clusters facing away from the mesh centre are
+		// likely in front of the rest, so draw them first.
+		const auto clusterCount =
+		    static_cast<uint32_t>(clusterStart.size());
+		clusterStart.push_back(triangleCount);
+		std::vector<float> sortKey(clusterCount);
+		for (uint32_t c = 0; c < clusterCount; ++c)
+		{
+			std::array<float, 3> centroid{};
+			std::array<float, 3> normal{};
+			float area = 0.f;
+			for (auto t = clusterStart[c];
+			     t < clusterStart[c + 1]; ++t)
+			{
+				const auto a = load(indices[t * 3]);
+				const auto b = load(indices[t * 3 + 1]);
+				const auto d = load(indices[t * 3 + 2]);
+				const std::array<float, 3> e1{
+				    b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+				const std::array<float, 3> e2{
+				    d[0] - a[0], d[1] - a[1], d[2] - a[2]};
+				const std::array<float, 3> n{
+				    e1[1] * e2[2] - e1[2] * e2[1],
+				    e1[2] * e2[0] - e1[0] * e2[2],
+				    e1[0] * e2[1] - e1[1] * e2[0]};
+				const auto triangleArea = std::sqrt(
+				    n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+				for (int i = 0; i < 3; ++i)
+				{
+					centroid[i] += (a[i] + b[i] + d[i])
+					               * triangleArea / 3.f;
+					normal[i] += n[i];
+				}
+				area += triangleArea;
+			}
+
+			const auto inverseArea =
+			    area > 0.f ? 1.f / area : 0.f;
+			const auto normalLength = std::sqrt(
+			    normal[0] * normal[0] + normal[1] * normal[1]
+			    + normal[2] * normal[2]);
+			const auto inverseNormal =
+			    normalLength > 0.f ? 1.f / normalLength : 0.f;
+
+			float key = 0.f;
+			for (int i = 0; i < 3; ++i)
+			{
+				key += (centroid[i] * inverseArea
+				        - meshCentroid[i])
+				       * normal[i] * inverseNormal;
+			}
+			sortKey[c] = key;
+		}
+
+		std::vector<uint32_t> order(clusterCount);
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(),
+		                 [&](uint32_t a, uint32_t b) {
+			                 return sortKey[a] > sortKey[b];
+		                 });
+
+		std::vector<uint32_t> output;
+		output.reserve(indices.size());
+		for (auto c : order)
+		{
+			output.insert(output.end(),
+			              indices.begin() + clusterStart[c] * 3,
+			              indices.begin()
+			                  + clusterStart[c + 1] * 3);
+		}
+		indices = std::move(output);
+	}
+
+	uint32_t OptimizeVertexFetch(std::vector<uint8_t>& vertices,
+	                             uint32_t stride,
+	                             std::vector<uint32_t>& indices)
+	{
+		const auto vertexCount =
+		    static_cast<uint32_t>(vertices.size() / stride);
+		constexpr auto Unused = 0xFFFFFFFF;
+
+		std::vector<uint32_t> remap(vertexCount, Unused);
+		std::vector<uint8_t> output;
+		output.reserve(vertices.size());
+
+		uint32_t next = 0;
+		for (auto& index : indices)
+		{
+			if (remap[index] == Unused)
+			{
+				remap[index] = next++;
+				const auto* source =
+				    vertices.data()
+				    + static_cast<size_t>(index) * stride;
+				output.insert(output.end(), source,
+				              source + stride);
+			}
+			index = remap[index];
+		}
+
+		vertices = std::move(output);
+		return next;
+	}
+} // namespace AthiVegam::Graphics::MeshOptimizer
@@ -0,0 +1,288 @@
+#include "AthiVegam/Graphics/MeshUploadQueue.h"
+
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/IndexType.h"
+#include "AthiVegam/Graphics/Mesh.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Managers/ResourceManager.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		inline size_t AlignUp(size_t value)
+		{
+			return (value + 3) & ~static_cast<size_t>(3);
+		}
+	} // namespace
+
+	void MeshUploadQueue::Initialize(size_t stagingSize)
+	{
+		m_staging = std::make_unique<StreamBuffer>(stagingSize);
+	}
+
+	void MeshUploadQueue::Shutdown()
+	{
+		for (auto& batch : m_batches)
+		{
+			glDeleteSync(batch.fence);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		m_batches.clear();
+		m_copies.clear();
+		m_staging.reset();
+
+		std::lock_guard lock(m_requestsMutex);
+		m_requests.clear();
+	}
+
+	void MeshUploadQueue::Push(Request&& request)
+	{
+		std::lock_guard lock(m_requestsMutex);
+		m_requests.push_back(std::move(request));
+	}
+
+	size_t MeshUploadQueue::GetPendingCount()
+	{
+		std::lock_guard lock(m_requestsMutex);
+		return m_requests.size() + m_batches.size();
+	}
+
+	void MeshUploadQueue::Process(
+	    Managers::ResourceManager& resources, double budgetMs)
+	{
+		PublishBatches(resources);
+		if (!m_staging)
+		{
+			return;
+		}
+
+		using Clock = std::chrono::steady_clock;
+		const auto start = Clock::now();
+		const auto segmentSize = m_staging->GetSegmentSize();
+
+		uint8_t* staging = nullptr;
+		size_t used = 0;
+		bool first = true;
+		Request request;
+		while (first
+		       || std::chrono::duration<double, std::milli>(
+		              Clock::now() - start)
+		                  .count()
+		              < budgetMs)
+		{
+			first = false;
+			if (!PopRequest(request, segmentSize - used))
+			{
+				break;
+			}
+
+			if (GetStagedSize(request) > segmentSize)
+			{
+				// Would never fit the ring; upload directly.
+				if (auto* mesh = Place(resources, request, true))
+				{
+					mesh->m_ready = true;
+				}
+				continue;
+			}
+
+			auto* mesh = Place(resources, request, false);
+			if (!mesh)
+			{
+				continue;
+			}
+			if (mesh->IsReady())
+			{
+				// Created standalone.
+				continue;
+			}
+
+			if (!staging)
+			{
+				staging = static_cast<uint8_t*>(
+				    m_staging->BeginWrite());
+			}
+
+			Copy copy{mesh, request.mesh, used, 0};
+			std::memcpy(staging + used,
+			            request.vertices.data(),
+			            request.vertices.size());
+			used = AlignUp(used + request.vertices.size());
+
+			copy.indexOffset = used;
+			WriteIndices(request.indices.data(),
+			             mesh->GetElementCount(),
+			             mesh->GetIndexType(), staging + used);
+			used = AlignUp(
+			    used
+			    + static_cast<size_t>(mesh->GetElementCount())
+			          * GetIndexSize(mesh->GetIndexType()));
+
+			m_copies.push_back(copy);
+		}
+
+		if (!staging)
+		{
+			return;
+		}
+		m_staging->EndWrite();
+
+		// Offsets are read back from the mesh here since a
+		// later reservation may have compacted its arena.
+		const auto segmentOffset =
+		    static_cast<size_t>(m_staging->GetSegment())
+		    * segmentSize;
+		Batch batch;
+		for (const auto& copy : m_copies)
+		{
+			auto* mesh = copy.mesh;
+			MeshArena::Allocation allocation{
+			    mesh->GetBaseVertex(), mesh->GetFirstIndex(),
+			    true};
+			mesh->GetArena()->CopyFrom(
+			    m_staging->GetId(),
+			    segmentOffset + copy.vertexOffset,
+			    segmentOffset + copy.indexOffset, allocation,
+			    mesh->GetVertexCount(),
+			    mesh->GetElementCount());
+			batch.meshes.push_back(copy.handle);
+		}
+		m_copies.clear();
+
+		batch.fence =
+		    glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		VEGAM_CHECK_GL_ERROR;
+		m_batches.push_back(std::move(batch));
+	}
+
+	void MeshUploadQueue::PublishBatches(
+	    Managers::ResourceManager& resources)
+	{
+		std::erase_if(m_batches, [&](const Batch& batch) {
+			const auto status =
+			    glClientWaitSync(batch.fence, 0, 0);
+			VEGAM_CHECK_GL_ERROR;
+			if (status != GL_ALREADY_SIGNALED
+			    && status != GL_CONDITION_SATISFIED)
+			{
+				return false;
+			}
+
+			glDeleteSync(batch.fence);
+			VEGAM_CHECK_GL_ERROR;
+			for (auto handle : batch.meshes)
+			{
+				// Meshes destroyed while in flight are gone.
+				if (auto* mesh = resources.GetMesh(handle))
+				{
+					mesh->m_ready = true;
+				}
+			}
+			return true;
+		});
+	}
+
+	bool MeshUploadQueue::PopRequest(Request& request,
+	                                 size_t available)
+	{
+		std::lock_guard lock(m_requestsMutex);
+		if (m_requests.empty())
+		{
+			return false;
+		}
+
+		// Leave it for the next frame's segment unless no
+		// segment could ever hold it.
+		const auto size = GetStagedSize(m_requests.front());
+		if (size > available
+		    && size <= m_staging->GetSegmentSize())
+		{
+			return false;
+		}
+
+		request = std::move(m_requests.front());
+		m_requests.pop_front();
+		return true;
+	}
+
+	Mesh* MeshUploadQueue::Place(
+	    Managers::ResourceManager& resources,
+	    const Request& request, bool upload)
+	{
+		auto* mesh = resources.GetMesh(request.mesh);
+		if (!mesh)
+		{
+			// Destroyed before its upload started.
+			return nullptr;
+		}
+
+		const auto elementCount =
+		    static_cast<uint32_t>(request.indices.size());
+		auto* arena = resources.GetSharedArena(
+		    request.layout, request.vertexCount, elementCount);
+		if (!arena)
+		{
+			// The placeholder owns nothing, so the slot can
+			// be rebuilt as a standalone mesh.
+			mesh->~Mesh();
+			if (elementCount == 0)
+			{
+				new (mesh) Mesh(request.layout,
+				                request.vertices.data(),
+				                request.vertexCount);
+			}
+			else
+			{
+				new (mesh) Mesh(
+				    request.layout, request.vertices.data(),
+				    request.vertexCount,
+				    request.indices.data(), elementCount);
+			}
+			return mesh;
+		}
+
+		auto allocation =
+		    upload ? arena->Allocate(*mesh,
+		                             request.vertices.data(),
+		                             request.vertexCount,
+		                             request.indices.data(),
+		                             elementCount)
+		           : arena->Reserve(*mesh, request.vertexCount,
+		                            elementCount);
+		if (!allocation.valid)
+		{
+			VEGAM_ERROR("Failed to allocate an uploaded mesh "
+			            "of {} vertices",
+			            request.vertexCount);
+			return nullptr;
+		}
+
+		mesh->m_arena = arena;
+		mesh->m_vao = arena->GetVao();
+		mesh->m_indexType = arena->GetIndexType();
+		mesh->m_layout = arena->GetLayout();
+		mesh->m_bounds = ComputeBounds(request.layout,
+		                               request.vertices.data(),
+		                               request.vertexCount);
+		mesh->m_vertexCount = request.vertexCount;
+		mesh->m_elementCount = elementCount;
+		mesh->m_baseVertex = allocation.baseVertex;
+		mesh->m_firstIndex = allocation.firstIndex;
+		return mesh;
+	}
+
+	size_t MeshUploadQueue::GetStagedSize(const Request& request)
+	{
+		const auto indexSize = GetIndexSize(
+		    SelectIndexType(request.vertexCount));
+		return AlignUp(request.vertices.size())
+		       + AlignUp(request.indices.size() * indexSize);
+	}
+} // namespace AthiVegam::Graphics
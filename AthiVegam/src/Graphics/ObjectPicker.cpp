@@ -0,0 +1,374 @@
+#include "AthiVegam/Graphics/ObjectPicker.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Graphics/GLState.h"
+#include "AthiVegam/Graphics/GpuProfiler.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/Mesh.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Input/Mouse.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		constexpr GLuint64 FenceTimeout = 1'000'000'000;
+
+		// Positions at location 0, as ComputeBounds()
+		// reads them.
+		const char* VertexSource = R"(#version 410 core
+layout(location = 0) in vec3 Position;
+
+uniform mat4 Transform;
+
+void main()
+{
+	gl_Position = Transform * vec4(Position, 1);
+}
+)";
+
+		const char* FragmentSource = R"(#version 410 core
+uniform int Id;
+
+layout(location = 0) out uint OutId;
+
+void main()
+{
+	OutId = uint(Id);
+}
+)";
+
+		inline GLenum GetGLIndexType(IndexType type)
+		{
+			return type == IndexType::UInt16 ? GL_UNSIGNED_SHORT
+			                                 : GL_UNSIGNED_INT;
+		}
+
+		inline const void* IndexOffset(const Mesh& mesh)
+		{
+			return reinterpret_cast<const void*>(
+			    static_cast<uintptr_t>(mesh.GetFirstIndex())
+			    * GetIndexSize(mesh.GetIndexType()));
+		}
+	} // namespace
+
+	ObjectPicker::ObjectPicker() = default;
+
+	ObjectPicker::~ObjectPicker()
+	{
+		VEGAM_ASSERT(m_framebuffer == 0,
+		             "ObjectPicker destroyed without "
+		             "Shutdown()");
+	}
+
+	void ObjectPicker::Initialize()
+	{
+		m_shader = std::make_unique<Shader>(VertexSource,
+		                                    FragmentSource);
+		m_transformUniform =
+		    m_shader->GetUniform<Math::Mat4>("Transform");
+		m_idUniform = m_shader->GetUniform<int>("Id");
+
+		glGenRenderbuffers(1, &m_color);
+		VEGAM_CHECK_GL_ERROR;
+		glBindRenderbuffer(GL_RENDERBUFFER, m_color);
+		VEGAM_CHECK_GL_ERROR;
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_R32UI, 1, 1);
+		VEGAM_CHECK_GL_ERROR;
+		glGenRenderbuffers(1, &m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		glBindRenderbuffer(GL_RENDERBUFFER, m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		glRenderbufferStorage(GL_RENDERBUFFER,
+		                      GL_DEPTH_COMPONENT24, 1, 1);
+		VEGAM_CHECK_GL_ERROR;
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		GLint previous = 0;
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+		VEGAM_CHECK_GL_ERROR;
+		glGenFramebuffers(1, &m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER,
+		                          GL_COLOR_ATTACHMENT0,
+		                          GL_RENDERBUFFER, m_color);
+		VEGAM_CHECK_GL_ERROR;
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER,
+		                          GL_DEPTH_ATTACHMENT,
+		                          GL_RENDERBUFFER, m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		const auto status =
+		    glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		glBindFramebuffer(GL_FRAMEBUFFER, previous);
+		VEGAM_CHECK_GL_ERROR;
+		if (status != GL_FRAMEBUFFER_COMPLETE)
+		{
+			VEGAM_ERROR("Picking target incomplete: {:#x}",
+			            status);
+		}
+
+		GpuResources::Register(GpuResources::Type::Framebuffer,
+		                       m_framebuffer, 0, "Picking");
+		GpuResources::Register(
+		    GpuResources::Type::Renderbuffer, m_color, 4,
+		    "Picking ids");
+		GpuResources::Register(
+		    GpuResources::Type::Renderbuffer, m_depth, 4,
+		    "Picking depth");
+
+		for (auto& slot : m_slots)
+		{
+			glGenBuffers(1, &slot.buffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(uint32_t),
+			             nullptr, GL_STREAM_READ);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(GpuResources::Type::Buffer,
+			                       slot.buffer, sizeof(uint32_t),
+			                       "Picking readback");
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void ObjectPicker::Shutdown()
+	{
+		if (m_framebuffer == 0)
+		{
+			return;
+		}
+		Poll(true);
+		for (auto& slot : m_slots)
+		{
+			GpuResources::Unregister(GpuResources::Type::Buffer,
+			                         slot.buffer);
+			glDeleteBuffers(1, &slot.buffer);
+			VEGAM_CHECK_GL_ERROR;
+			slot = {};
+		}
+		m_next = 0;
+
+		GpuResources::Unregister(
+		    GpuResources::Type::Framebuffer, m_framebuffer);
+		glDeleteFramebuffers(1, &m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Unregister(
+		    GpuResources::Type::Renderbuffer, m_color);
+		GpuResources::Unregister(
+		    GpuResources::Type::Renderbuffer, m_depth);
+		const GLuint renderbuffers[] = {m_color, m_depth};
+		glDeleteRenderbuffers(2, renderbuffers);
+		VEGAM_CHECK_GL_ERROR;
+		m_framebuffer = 0;
+		m_color = 0;
+		m_depth = 0;
+		m_shader.reset();
+		m_requested = false;
+	}
+
+	void ObjectPicker::Request(int x, int y)
+	{
+		m_requested = true;
+		m_requestX = x;
+		m_requestY = y;
+	}
+
+	void ObjectPicker::RequestAtMouse()
+	{
+		Request(Input::Mouse::X(), Input::Mouse::Y());
+	}
+
+	void ObjectPicker::Render(const Math::Mat4& viewProjection,
+	                          int width, int height,
+	                          std::span<const Item> items)
+	{
+		if (!m_requested || m_framebuffer == 0)
+		{
+			return;
+		}
+		m_requested = false;
+		const auto x = m_requestX;
+		// GL rows count from the bottom.
+		const auto y = height - 1 - m_requestY;
+		if (x < 0 || y < 0 || x >= width || y >= height)
+		{
+			if (m_callback)
+			{
+				m_callback(NoObject, m_requestX, m_requestY);
+			}
+			return;
+		}
+
+		VEGAM_PROFILE_SCOPE("ObjectPicker::Render");
+		VEGAM_PROFILE_GPU_SCOPE("ObjectPicker::Render");
+		Poll();
+		auto& slot = m_slots[m_next];
+		if (slot.fence)
+		{
+			Deliver(slot, true);
+		}
+
+		// Scales the pixel's clip space square up to the
+		// whole 1x1 target.
+		const auto w = static_cast<float>(width);
+		const auto h = static_cast<float>(height);
+		const auto pick =
+		    Math::Mat4::Scale({w, h, 1.0f})
+		    * Math::Mat4::Translation(
+		        {-(2.0f * (static_cast<float>(x) + 0.5f) / w
+		           - 1.0f),
+		         -(2.0f * (static_cast<float>(y) + 0.5f) / h
+		           - 1.0f),
+		         0.0f});
+		const auto pickViewProjection = pick * viewProjection;
+
+		GLint previousFramebuffer = 0;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING,
+		              &previousFramebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		GLint previousViewport[4] = {};
+		glGetIntegerv(GL_VIEWPORT, previousViewport);
+		VEGAM_CHECK_GL_ERROR;
+
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glViewport(0, 0, 1, 1);
+		VEGAM_CHECK_GL_ERROR;
+		GLState::SetEnabled(GLState::Capability::Blend, false);
+		GLState::SetEnabled(GLState::Capability::ScissorTest,
+		                    false);
+		GLState::SetEnabled(GLState::Capability::DepthTest,
+		                    true);
+		GLState::SetDepthMask(true);
+		GLState::SetDepthFunc(GL_LESS);
+		GLState::SetColorMask(true);
+		const GLuint clearId[4] = {NoObject, 0, 0, 0};
+		glClearBufferuiv(GL_COLOR, 0, clearId);
+		VEGAM_CHECK_GL_ERROR;
+		const GLfloat clearDepth = 1.0f;
+		glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+		VEGAM_CHECK_GL_ERROR;
+
+		// The state cache of the render manager is reset
+		// at its next flush.
+		Shader::UseProgram(m_shader->GetId());
+		auto& resources =
+		    Engine::Instance().GetResourceManager();
+		for (const auto& item : items)
+		{
+			const auto* mesh = resources.GetMesh(item.mesh);
+			if (!mesh || !mesh->IsReady()
+			    || item.id == NoObject)
+			{
+				continue;
+			}
+			m_shader->Set(m_transformUniform,
+			              pickViewProjection * item.transform);
+			m_shader->Set(m_idUniform,
+			              static_cast<int>(item.id));
+			glBindVertexArray(mesh->GetId());
+			VEGAM_CHECK_GL_ERROR;
+			if (mesh->GetElementCount() > 0)
+			{
+				glDrawElementsBaseVertex(
+				    GL_TRIANGLES, mesh->GetElementCount(),
+				    GetGLIndexType(mesh->GetIndexType()),
+				    IndexOffset(*mesh), mesh->GetBaseVertex());
+			}
+			else
+			{
+				glDrawArrays(GL_TRIANGLE_STRIP,
+				             mesh->GetBaseVertex(),
+				             mesh->GetVertexCount());
+			}
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glBindVertexArray(0);
+		VEGAM_CHECK_GL_ERROR;
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+		VEGAM_CHECK_GL_ERROR;
+		glReadPixels(0, 0, 1, 1, GL_RED_INTEGER,
+		             GL_UNSIGNED_INT, nullptr);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		slot.fence =
+		    glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		VEGAM_CHECK_GL_ERROR;
+		slot.x = m_requestX;
+		slot.y = m_requestY;
+		m_next = (m_next + 1) % SlotCount;
+
+		glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glViewport(previousViewport[0], previousViewport[1],
+		           previousViewport[2], previousViewport[3]);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void ObjectPicker::Poll(bool wait)
+	{
+		// m_next is the oldest slot.
+		for (uint32_t i = 0; i < SlotCount; ++i)
+		{
+			auto& slot = m_slots[(m_next + i) % SlotCount];
+			if (slot.fence && !Deliver(slot, wait))
+			{
+				return;
+			}
+		}
+	}
+
+	bool ObjectPicker::Deliver(Slot& slot, bool wait)
+	{
+		const auto result = glClientWaitSync(
+		    slot.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+		    wait ? FenceTimeout : 0);
+		if (result == GL_TIMEOUT_EXPIRED && !wait)
+		{
+			return false;
+		}
+		glDeleteSync(slot.fence);
+		VEGAM_CHECK_GL_ERROR;
+		slot.fence = nullptr;
+		if (result == GL_TIMEOUT_EXPIRED
+		    || result == GL_WAIT_FAILED)
+		{
+			VEGAM_WARN("Pick readback at {}, {} failed",
+			           slot.x, slot.y);
+			return true;
+		}
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+		VEGAM_CHECK_GL_ERROR;
+		const auto* id = static_cast<const uint32_t*>(
+		    glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+		                     sizeof(uint32_t), GL_MAP_READ_BIT));
+		VEGAM_CHECK_GL_ERROR;
+		if (id)
+		{
+			const auto value = *id;
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			VEGAM_CHECK_GL_ERROR;
+			if (m_callback)
+			{
+				m_callback(value, slot.x, slot.y);
+			}
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		return true;
+	}
+} // namespace AthiVegam::Graphics
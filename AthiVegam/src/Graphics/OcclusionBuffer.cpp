@@ -0,0 +1,298 @@
+#include "AthiVegam/Graphics/OcclusionBuffer.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		// Triangles nearer than this in w are dropped.
+		constexpr float NearW = 1e-5f;
+
+		// Column-major a * b.
+		void Multiply(const float a[16], const float b[16],
+		              float out[16])
+		{
+			for (int column = 0; column < 4; ++column)
+			{
+				for (int row = 0; row < 4; ++row)
+				{
+					float sum = 0.0f;
+					for (int k = 0; k < 4; ++k)
+					{
+						sum += a[k * 4 + row] * b[column * 4 + k];
+					}
+					out[column * 4 + row] = sum;
+				}
+			}
+		}
+
+		inline Float4 ToClip(const float m[16], float x,
+		                     float y, float z)
+		{
+			return {m[0] * x + m[4] * y + m[8] * z + m[12],
+			        m[1] * x + m[5] * y + m[9] * z + m[13],
+			        m[2] * x + m[6] * y + m[10] * z + m[14],
+			        m[3] * x + m[7] * y + m[11] * z + m[15]};
+		}
+
+		inline float EdgeFunction(float ax, float ay, float bx,
+		                          float by, float px, float py)
+		{
+			return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+		}
+	} // namespace
+
+	OcclusionBuffer::OcclusionBuffer(int width, int height)
+	    : m_width(width)
+	    , m_height(height)
+	    , m_tilesX((width + TileSize - 1) / TileSize)
+	    , m_tilesY((height + TileSize - 1) / TileSize)
+	    , m_depth(static_cast<size_t>(width) * height, 1.0f)
+	    , m_tileFarthest(static_cast<size_t>(m_tilesX) * m_tilesY,
+	                     1.0f)
+	{
+		VEGAM_ASSERT(width > 0 && height > 0,
+		             "Empty occlusion buffer");
+	}
+
+	void OcclusionBuffer::Begin(const float viewProjection[16])
+	{
+		std::copy_n(viewProjection, 16, m_viewProjection);
+		std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+		std::fill(m_tileFarthest.begin(), m_tileFarthest.end(),
+		          1.0f);
+	}
+
+	void OcclusionBuffer::AddOccluder(
+	    std::span<const Float3> positions,
+	    std::span<const uint32_t> indices,
+	    const float transform[16])
+	{
+		VEGAM_PROFILE_SCOPE("OcclusionBuffer::AddOccluder");
+		float matrix[16];
+		Multiply(m_viewProjection, transform, matrix);
+
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			std::array<Float4, 3> clip;
+			bool valid = true;
+			for (int v = 0; v < 3; ++v)
+			{
+				const auto index = indices[i + v];
+				if (index >= positions.size())
+				{
+					valid = false;
+					break;
+				}
+				const auto& p = positions[index];
+				clip[v] = ToClip(matrix, p.x, p.y, p.z);
+				valid = valid && clip[v].w > NearW;
+			}
+			if (valid)
+			{
+				RasterizeTriangle(clip[0], clip[1], clip[2]);
+			}
+		}
+	}
+
+	void OcclusionBuffer::AddOccluder(const Aabb& box,
+	                                  const float transform[16])
+	{
+		const std::array<Float3, 8> corners = {{
+		    {box.min.x, box.min.y, box.min.z},
+		    {box.max.x, box.min.y, box.min.z},
+		    {box.min.x, box.max.y, box.min.z},
+		    {box.max.x, box.max.y, box.min.z},
+		    {box.min.x, box.min.y, box.max.z},
+		    {box.max.x, box.min.y, box.max.z},
+		    {box.min.x, box.max.y, box.max.z},
+		    {box.max.x, box.max.y, box.max.z},
+		}};
+		static constexpr std::array<uint32_t, 36> indices = {
+		    0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6,
+		    0, 1, 4, 1, 5, 4, 2, 6, 3, 3, 6, 7,
+		    0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5};
+		AddOccluder(corners, indices, transform);
+	}
+
+	// Either winding; depth is affine in screen space, so
+	// it is interpolated with the same edge functions.
+	void OcclusionBuffer::RasterizeTriangle(const Float4& a,
+	                                        const Float4& b,
+	                                        const Float4& c)
+	{
+		const auto toScreen = [this](const Float4& p) {
+			return Float3{
+			    (p.x / p.w * 0.5f + 0.5f) * m_width,
+			    (p.y / p.w * 0.5f + 0.5f) * m_height,
+			    p.z / p.w * 0.5f + 0.5f};
+		};
+		const auto s0 = toScreen(a);
+		const auto s1 = toScreen(b);
+		const auto s2 = toScreen(c);
+
+		const auto area =
+		    EdgeFunction(s0.x, s0.y, s1.x, s1.y, s2.x, s2.y);
+		if (area == 0.0f || !std::isfinite(area))
+		{
+			return;
+		}
+
+		const auto minX = std::max(
+		    0, static_cast<int>(std::floor(
+		           std::min({s0.x, s1.x, s2.x}))));
+		const auto maxX = std::min(
+		    m_width - 1, static_cast<int>(std::ceil(
+		                     std::max({s0.x, s1.x, s2.x}))));
+		const auto minY = std::max(
+		    0, static_cast<int>(std::floor(
+		           std::min({s0.y, s1.y, s2.y}))));
+		const auto maxY = std::min(
+		    m_height - 1, static_cast<int>(std::ceil(
+		                      std::max({s0.y, s1.y, s2.y}))));
+		const auto inverseArea = 1.0f / area;
+
+		for (int y = minY; y <= maxY; ++y)
+		{
+			const auto py = y + 0.5f;
+			auto* row = &m_depth[static_cast<size_t>(y) * m_width];
+			for (int x = minX; x <= maxX; ++x)
+			{
+				const auto px = x + 0.5f;
+				const auto w0 =
+				    EdgeFunction(s1.x, s1.y, s2.x, s2.y, px, py)
+				    * inverseArea;
+				const auto w1 =
+				    EdgeFunction(s2.x, s2.y, s0.x, s0.y, px, py)
+				    * inverseArea;
+				const auto w2 = 1.0f - w0 - w1;
+				if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+				{
+					continue;
+				}
+				const auto depth =
+				    w0 * s0.z + w1 * s1.z + w2 * s2.z;
+				row[x] = std::min(row[x],
+				                  std::clamp(depth, 0.0f, 1.0f));
+			}
+		}
+	}
+
+	void OcclusionBuffer::Finish()
+	{
+		for (int ty = 0; ty < m_tilesY; ++ty)
+		{
+			for (int tx = 0; tx < m_tilesX; ++tx)
+			{
+				float farthest = 0.0f;
+				const auto endY =
+				    std::min((ty + 1) * TileSize, m_height);
+				const auto endX =
+				    std::min((tx + 1) * TileSize, m_width);
+				for (int y = ty * TileSize; y < endY; ++y)
+				{
+					const auto* row =
+					    &m_depth[static_cast<size_t>(y) * m_width];
+					for (int x = tx * TileSize; x < endX; ++x)
+					{
+						farthest = std::max(farthest, row[x]);
+					}
+				}
+				m_tileFarthest[ty * m_tilesX + tx] = farthest;
+			}
+		}
+	}
+
+	bool
+	OcclusionBuffer::IsOccluded(const BoundingSphere& sphere) const
+	{
+		if (!std::isfinite(sphere.radius))
+		{
+			return false;
+		}
+
+		// Screen rectangle and nearest depth of the
+		// sphere's bounding box.
+		float minX = m_width;
+		float minY = m_height;
+		float maxX = 0.0f;
+		float maxY = 0.0f;
+		float nearest = 1.0f;
+		for (int i = 0; i < 8; ++i)
+		{
+			const auto r = sphere.radius;
+			const auto clip = ToClip(
+			    m_viewProjection,
+			    sphere.center.x + (i & 1 ? r : -r),
+			    sphere.center.y + (i & 2 ? r : -r),
+			    sphere.center.z + (i & 4 ? r : -r));
+			if (clip.w <= NearW)
+			{
+				// Reaches behind the camera.
+				return false;
+			}
+			const auto x =
+			    (clip.x / clip.w * 0.5f + 0.5f) * m_width;
+			const auto y =
+			    (clip.y / clip.w * 0.5f + 0.5f) * m_height;
+			minX = std::min(minX, x);
+			minY = std::min(minY, y);
+			maxX = std::max(maxX, x);
+			maxY = std::max(maxY, y);
+			nearest = std::min(nearest,
+			                   clip.z / clip.w * 0.5f + 0.5f);
+		}
+
+		const auto x0 =
+		    std::max(0, static_cast<int>(std::floor(minX)));
+		const auto y0 =
+		    std::max(0, static_cast<int>(std::floor(minY)));
+		const auto x1 = std::min(
+		    m_width - 1, static_cast<int>(std::floor(maxX)));
+		const auto y1 = std::min(
+		    m_height - 1, static_cast<int>(std::floor(maxY)));
+		if (x0 > x1 || y0 > y1)
+		{
+			// Off screen; the frustum test decides.
+			return false;
+		}
+
+		for (int ty = y0 / TileSize; ty <= y1 / TileSize; ++ty)
+		{
+			for (int tx = x0 / TileSize; tx <= x1 / TileSize;
+			     ++tx)
+			{
+				if (nearest > m_tileFarthest[ty * m_tilesX + tx])
+				{
+					continue;
+				}
+				// Some pixel of the tile may show it.
+				const auto startY = std::max(y0, ty * TileSize);
+				const auto endY =
+				    std::min(y1, (ty + 1) * TileSize - 1);
+				const auto startX = std::max(x0, tx * TileSize);
+				const auto endX =
+				    std::min(x1, (tx + 1) * TileSize - 1);
+				for (int y = startY; y <= endY; ++y)
+				{
+					const auto* row =
+					    &m_depth[static_cast<size_t>(y) * m_width];
+					for (int x = startX; x <= endX; ++x)
+					{
+						if (nearest <= row[x])
+						{
+							return false;
+						}
+					}
+				}
+			}
+		}
+		return true;
+	}
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,997 @@
+#include "AthiVegam/Graphics/ParticleSystem.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/CommandList.h"
+#include "AthiVegam/Graphics/ComputeProgram.h"
+#include "AthiVegam/Graphics/GpuProfiler.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Graphics/SortKey.h"
+#include "AthiVegam/Graphics/WeightedOit.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <utility>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		constexpr uint32_t GroupSize = 64;
+		// Bytes of a Particle.
+		constexpr size_t ParticleSize = 48;
+		// Bytes of an Entry of the draw order.
+		constexpr size_t EntrySize = 8;
+		constexpr int DefaultTextureSize = 32;
+
+		// Shared by every pass.
+		const char* CommonSource = R"(#version 430 core
+struct Particle
+{
+	// Age in w.
+	vec4 position;
+	// Lifetime in w.
+	vec4 velocity;
+	// Start and end colors, start and end sizes as
+	// halves, rotation and spin as halves.
+	uvec4 look;
+};
+
+layout(std430, binding = 10) buffer Particles
+{
+	Particle particles[];
+};
+layout(std430, binding = 11) buffer Dead
+{
+	uint dead[];
+};
+layout(std430, binding = 12) buffer Alive
+{
+	uint alive[];
+};
+layout(std430, binding = 13) buffer NextAlive
+{
+	uint nextAlive[];
+};
+layout(std430, binding = 14) buffer State
+{
+	int deadCount;
+	uint aliveCount[2];
+	uint padding;
+	uvec4 simulateArgs;
+	uvec4 drawArgs;
+	uint sortArgs[];
+};
+
+struct Entry
+{
+	float key;
+	uint index;
+};
+
+layout(std430, binding = 15) buffer Order
+{
+	Entry order[];
+};
+
+// Alive list the pass reads; the other one is written.
+uniform uint Current;
+)";
+
+		const char* EmitSource = R"(
+layout(local_size_x = 64) in;
+
+struct Emitter
+{
+	// Radius in w.
+	vec4 position;
+	// Spread in w.
+	vec4 velocity;
+	vec4 startColor;
+	vec4 endColor;
+	vec4 lifetimeSize;
+	vec2 spin;
+	uint first;
+	uint padding;
+};
+
+layout(std140, binding = 3) uniform Emitters
+{
+	Emitter emitters[64];
+};
+
+uniform uint EmitterCount;
+uniform uint SpawnCount;
+uniform uint Seed;
+
+uint Hash(uint x)
+{
+	x ^= x >> 16;
+	x *= 0x7FEB352Du;
+	x ^= x >> 15;
+	x *= 0x846CA68Bu;
+	x ^= x >> 16;
+	return x;
+}
+
+float Random(inout uint state)
+{
+	state = Hash(state);
+	return float(state >> 8) / 16777216.0;
+}
+
+vec3 RandomInSphere(inout uint state)
+{
+	float z = Random(state) * 2.0 - 1.0;
+	float angle = Random(state) * 6.2831853;
+	float r = sqrt(1.0 - z * z);
+	return vec3(r * cos(angle), r * sin(angle), z)
+	       * pow(Random(state), 1.0 / 3.0);
+}
+
+void main()
+{
+	uint i = gl_GlobalInvocationID.x;
+	if (i >= SpawnCount)
+	{
+		return;
+	}
+	// Spawns take the top free slot; once none are left,
+	// the rest give back what they took.
+	int available = atomicAdd(deadCount, -1);
+	if (available <= 0)
+	{
+		atomicAdd(deadCount, 1);
+		return;
+	}
+	uint index = dead[available - 1];
+
+	uint e = 0u;
+	while (e + 1u < EmitterCount && i >= emitters[e + 1u].first)
+	{
+		++e;
+	}
+	Emitter emitter = emitters[e];
+	uint state = Hash(i ^ Hash(Seed));
+
+	Particle p;
+	p.position = vec4(emitter.position.xyz
+	                      + RandomInSphere(state)
+	                            * emitter.position.w,
+	                  0.0);
+	p.velocity = vec4(emitter.velocity.xyz
+	                      + RandomInSphere(state)
+	                            * emitter.velocity.w,
+	                  mix(emitter.lifetimeSize.x,
+	                      emitter.lifetimeSize.y,
+	                      Random(state)));
+	float rotation = Random(state) * 6.2831853;
+	float spin = mix(emitter.spin.x, emitter.spin.y,
+	                 Random(state));
+	p.look = uvec4(packUnorm4x8(emitter.startColor),
+	               packUnorm4x8(emitter.endColor),
+	               packHalf2x16(emitter.lifetimeSize.zw),
+	               packHalf2x16(vec2(rotation, spin)));
+	particles[index] = p;
+	alive[atomicAdd(aliveCount[Current], 1u)] = index;
+}
+)";
+
+		// Mode 0 sizes the simulation from the live count;
+		// mode 1 the draw and the sort from the survivors.
+		const char* PrepareSource = R"(
+layout(local_size_x = 1) in;
+
+uniform uint Mode;
+uniform uint SortLevels;
+
+void main()
+{
+	uint next = 1u - Current;
+	if (Mode == 0u)
+	{
+		simulateArgs =
+		    uvec4((aliveCount[Current] + 63u) / 64u, 1u, 1u, 0u);
+		aliveCount[next] = 0u;
+		return;
+	}
+
+	uint count = aliveCount[next];
+	drawArgs = uvec4(4u, count, 0u, 0u);
+	// The live count rounded up to a power of two of
+	// whole blocks; levels merging past it are skipped.
+	uint size = 1024u;
+	while (size < count)
+	{
+		size <<= 1u;
+	}
+	for (uint level = 0u; level < SortLevels; ++level)
+	{
+		bool active = count > 0u && (1024u << level) <= size;
+		sortArgs[level * 3u] = active ? size / 1024u : 0u;
+		sortArgs[level * 3u + 1u] = 1u;
+		sortArgs[level * 3u + 2u] = 1u;
+	}
+}
+)";
+
+		const char* SimulateSource = R"(
+layout(local_size_x = 64) in;
+
+uniform float DeltaTime;
+uniform vec3 Gravity;
+// Fraction of the velocity kept over DeltaTime.
+uniform float Damping;
+uniform vec3 Eye;
+
+void main()
+{
+	uint i = gl_GlobalInvocationID.x;
+	if (i >= aliveCount[Current])
+	{
+		return;
+	}
+	uint index = alive[i];
+	Particle p = particles[index];
+	p.position.w += DeltaTime;
+	if (p.position.w >= p.velocity.w)
+	{
+		dead[atomicAdd(deadCount, 1)] = index;
+		return;
+	}
+
+	p.velocity.xyz =
+	    (p.velocity.xyz + Gravity * DeltaTime) * Damping;
+	p.position.xyz += p.velocity.xyz * DeltaTime;
+	vec2 spin = unpackHalf2x16(p.look.w);
+	spin.x = mod(spin.x + spin.y * DeltaTime, 6.2831853);
+	p.look.w = packHalf2x16(spin);
+	particles[index] = p;
+
+	uint slot = atomicAdd(aliveCount[1u - Current], 1u);
+	nextAlive[slot] = index;
+	// Farthest first once sorted.
+	vec3 offset = p.position.xyz - Eye;
+	order[slot] = Entry(-dot(offset, offset), index);
+}
+)";
+
+		// Bitonic sort of the draw order by key. Mode 0
+		// sorts each block in shared memory, padding past
+		// the live count with entries that sort last; mode
+		// 1 is one step of a merge across blocks, J apart;
+		// mode 2 finishes a merge within each block.
+		const char* SortSource = R"(
+layout(local_size_x = 512) in;
+
+uniform uint Mode;
+// Length of the runs being merged into one.
+uniform uint K;
+uniform uint J;
+
+shared Entry block[1024];
+
+void main()
+{
+	if (Mode == 1u)
+	{
+		uint i = gl_GlobalInvocationID.x;
+		uint lo = ((i & ~(J - 1u)) << 1u) | (i & (J - 1u));
+		uint hi = lo + J;
+		Entry a = order[lo];
+		Entry b = order[hi];
+		if ((a.key > b.key) == ((lo & K) == 0u))
+		{
+			order[lo] = b;
+			order[hi] = a;
+		}
+		return;
+	}
+
+	uint t = gl_LocalInvocationID.x;
+	uint base = gl_WorkGroupID.x * 1024u;
+	uint count = aliveCount[1u - Current];
+	for (uint n = t; n < 1024u; n += 512u)
+	{
+		Entry e = order[base + n];
+		if (Mode == 0u && base + n >= count)
+		{
+			e = Entry(uintBitsToFloat(0x7F800000u), 0u);
+		}
+		block[n] = e;
+	}
+	barrier();
+
+	uint firstK = Mode == 0u ? 2u : K;
+	uint lastK = Mode == 0u ? 1024u : K;
+	for (uint k = firstK; k <= lastK; k <<= 1u)
+	{
+		for (uint j = min(k, 1024u) >> 1u; j > 0u; j >>= 1u)
+		{
+			uint lo = ((t & ~(j - 1u)) << 1u) | (t & (j - 1u));
+			uint hi = lo + j;
+			Entry a = block[lo];
+			Entry b = block[hi];
+			if ((a.key > b.key) == (((base + lo) & k) == 0u))
+			{
+				block[lo] = b;
+				block[hi] = a;
+			}
+			barrier();
+		}
+	}
+
+	for (uint n = t; n < 1024u; n += 512u)
+	{
+		order[base + n] = block[n];
+	}
+}
+)";
+
+		// Corners from gl_VertexID, as a strip, facing the
+		// camera.
+		const char* DrawVertexSource = R"(#version 430 core
+struct Particle
+{
+	vec4 position;
+	vec4 velocity;
+	uvec4 look;
+};
+
+layout(std430, binding = 10) readonly buffer Particles
+{
+	Particle particles[];
+};
+
+struct Entry
+{
+	float key;
+	uint index;
+};
+
+layout(std430, binding = 15) readonly buffer Order
+{
+	Entry order[];
+};
+
+layout(std140) uniform Constants
+{
+	mat4 ViewProjection;
+	vec4 CameraRight;
+	vec4 CameraUp;
+};
+
+out vec2 FragUV;
+out vec4 FragColor;
+
+void main()
+{
+	Particle p = particles[order[gl_InstanceID].index];
+	float t = clamp(p.position.w / p.velocity.w, 0.0, 1.0);
+	vec2 sizes = unpackHalf2x16(p.look.z);
+	float rotation = unpackHalf2x16(p.look.w).x;
+
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+	vec2 local = (corner - 0.5) * mix(sizes.x, sizes.y, t);
+	float c = cos(rotation);
+	float s = sin(rotation);
+	local = vec2(local.x * c - local.y * s,
+	             local.x * s + local.y * c);
+	vec3 world = p.position.xyz + CameraRight.xyz * local.x
+	             + CameraUp.xyz * local.y;
+	gl_Position = ViewProjection * vec4(world, 1.0);
+	FragUV = corner;
+	FragColor = mix(unpackUnorm4x8(p.look.x),
+	                unpackUnorm4x8(p.look.y), t);
+}
+)";
+
+		const char* DrawFragmentSource = R"(#version 430 core
+in vec2 FragUV;
+in vec4 FragColor;
+
+uniform sampler2D Texture;
+
+layout(location = 0) out vec4 OutColor;
+
+void main()
+{
+	OutColor = FragColor * texture(Texture, FragUV);
+}
+)";
+
+		// For BlendMode::WeightedOit, after the version line
+		// and WeightedOit::GetShaderSource().
+		const char* DrawOitFragmentSource = R"(
+in vec2 FragUV;
+in vec4 FragColor;
+
+uniform sampler2D Texture;
+
+layout(location = 0) out vec4 OutAccumulation;
+layout(location = 1) out vec4 OutWeight;
+
+void main()
+{
+	AvWeightedOit(FragColor * texture(Texture, FragUV),
+	              OutAccumulation, OutWeight);
+}
+)";
+
+		struct DrawConstants
+		{
+			float viewProjection[16];
+			float cameraRight[4];
+			float cameraUp[4];
+		};
+
+		inline GLint Location(uint32_t program,
+		                      const char* name)
+		{
+			const auto location =
+			    glGetUniformLocation(program, name);
+			VEGAM_CHECK_GL_ERROR;
+			return location;
+		}
+
+		uint32_t CreateBuffer(GLenum target, size_t size,
+		                      const void* data,
+		                      const char* label)
+		{
+			uint32_t buffer = 0;
+			glGenBuffers(1, &buffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBindBuffer(target, buffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBufferData(target, static_cast<GLsizeiptr>(size),
+			             data, GL_DYNAMIC_DRAW);
+			VEGAM_CHECK_GL_ERROR;
+			glBindBuffer(target, 0);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(GpuResources::Type::Buffer,
+			                       buffer, size, label);
+			return buffer;
+		}
+
+		void DeleteBuffer(uint32_t& buffer)
+		{
+			if (buffer == 0)
+			{
+				return;
+			}
+			GpuResources::Unregister(GpuResources::Type::Buffer,
+			                         buffer);
+			glDeleteBuffers(1, &buffer);
+			VEGAM_CHECK_GL_ERROR;
+			buffer = 0;
+		}
+
+		inline size_t SortArgsOffset(size_t stateSize,
+		                             uint32_t level)
+		{
+			return stateSize
+			       + size_t{level} * 3 * sizeof(uint32_t);
+		}
+	} // namespace
+
+	ParticleSystem::ParticleSystem() = default;
+
+	ParticleSystem::ParticleSystem(const Settings& settings)
+	    : m_settings(settings)
+	{
+		VEGAM_ASSERT(settings.capacity > 0
+		                 && settings.capacity <= (1u << 30),
+		             "Invalid particle capacity");
+		VEGAM_ASSERT(settings.drag >= 0.0f
+		                 && settings.drag <= 1.0f,
+		             "Particle drag must be in [0, 1]");
+	}
+
+	ParticleSystem::~ParticleSystem()
+	{
+		VEGAM_ASSERT(!IsInitialized(),
+		             "ParticleSystem destroyed without "
+		             "Shutdown()");
+	}
+
+	bool ParticleSystem::Initialize()
+	{
+		if (IsInitialized())
+		{
+			return true;
+		}
+		if (!GLAD_GL_VERSION_4_3)
+		{
+			VEGAM_WARN("GPU particles need a GL 4.3 context");
+			return false;
+		}
+
+		const auto compile = [](const char* body,
+		                        const char* label) {
+			const auto source = std::string(CommonSource) + body;
+			return CreateComputeProgram(source.c_str(), label);
+		};
+		m_emitProgram = compile(EmitSource, "Particle emit");
+		m_prepareProgram =
+		    compile(PrepareSource, "Particle prepare");
+		m_simulateProgram =
+		    compile(SimulateSource, "Particle simulate");
+		m_sortProgram = compile(SortSource, "Particle sort");
+		if (!m_emitProgram || !m_prepareProgram
+		    || !m_simulateProgram || !m_sortProgram)
+		{
+			Shutdown();
+			return false;
+		}
+
+		m_drawShader = std::make_unique<Shader>(
+		    DrawVertexSource, DrawFragmentSource);
+		m_drawShader->SetUniformInt("Texture", 0);
+		const auto oitSource =
+		    std::string("#version 430 core\n")
+		    + WeightedOit::GetShaderSource()
+		    + DrawOitFragmentSource;
+		m_drawOitShader = std::make_unique<Shader>(
+		    DrawVertexSource, oitSource);
+		m_drawOitShader->SetUniformInt("Texture", 0);
+
+		// No vertex attributes; everything is read from
+		// shader storage.
+		glGenVertexArrays(1, &m_vao);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::VertexArray,
+		                       m_vao, 0, "Particles");
+
+		// A soft dot, for particles without a texture.
+		std::vector<uint32_t> texels(DefaultTextureSize
+		                             * DefaultTextureSize);
+		const auto half = DefaultTextureSize * 0.5f;
+		for (int y = 0; y < DefaultTextureSize; ++y)
+		{
+			for (int x = 0; x < DefaultTextureSize; ++x)
+			{
+				const auto dx = (x + 0.5f - half) / half;
+				const auto dy = (y + 0.5f - half) / half;
+				const auto falloff = std::max(
+				    1.0f - std::sqrt(dx * dx + dy * dy), 0.0f);
+				const auto alpha = static_cast<uint32_t>(
+				    std::lround(falloff * falloff * 255.0f));
+				texels[y * DefaultTextureSize + x] =
+				    0x00FFFFFFu | (alpha << 24);
+			}
+		}
+		glGenTextures(1, &m_defaultTexture);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, m_defaultTexture);
+		VEGAM_CHECK_GL_ERROR;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+		                GL_LINEAR);
+		VEGAM_CHECK_GL_ERROR;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
+		                GL_CLAMP_TO_EDGE);
+		VEGAM_CHECK_GL_ERROR;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
+		                GL_CLAMP_TO_EDGE);
+		VEGAM_CHECK_GL_ERROR;
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8,
+		             DefaultTextureSize, DefaultTextureSize, 0,
+		             GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, 0);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::Texture,
+		                       m_defaultTexture,
+		                       texels.size() * 4,
+		                       "Particle dot");
+
+		const auto capacity = m_settings.capacity;
+		const auto sortSize =
+		    std::max(std::bit_ceil(capacity), SortBlock);
+		m_sortLevels =
+		    m_settings.sort
+		        ? static_cast<uint32_t>(
+		              std::bit_width(sortSize / SortBlock))
+		        : 0;
+
+		m_particleBuffer = CreateBuffer(
+		    GL_SHADER_STORAGE_BUFFER, capacity * ParticleSize,
+		    nullptr, "Particles");
+		// Low slots are taken first.
+		std::vector<uint32_t> slots(capacity);
+		for (uint32_t i = 0; i < capacity; ++i)
+		{
+			slots[i] = capacity - 1 - i;
+		}
+		m_deadBuffer = CreateBuffer(
+		    GL_SHADER_STORAGE_BUFFER,
+		    slots.size() * sizeof(uint32_t), slots.data(),
+		    "Particle free list");
+		for (auto& buffer : m_aliveBuffers)
+		{
+			buffer = CreateBuffer(GL_SHADER_STORAGE_BUFFER,
+			                      capacity * sizeof(uint32_t),
+			                      nullptr, "Particle live list");
+		}
+
+		std::vector<uint8_t> state(
+		    SortArgsOffset(sizeof(State), m_sortLevels));
+		State initial{};
+		initial.deadCount = static_cast<int32_t>(capacity);
+		std::memcpy(state.data(), &initial, sizeof(initial));
+		m_stateBuffer = CreateBuffer(
+		    GL_SHADER_STORAGE_BUFFER, state.size(), state.data(),
+		    "Particle state");
+		m_orderBuffer = CreateBuffer(
+		    GL_SHADER_STORAGE_BUFFER,
+		    size_t{m_settings.sort ? sortSize : capacity}
+		        * EntrySize,
+		    nullptr, "Particle order");
+		m_emitterBuffer = CreateBuffer(
+		    GL_UNIFORM_BUFFER, MaxEmitters * sizeof(EmitterData),
+		    nullptr, "Particle emitters");
+		m_current = 0;
+
+		VEGAM_INFO("GPU particles enabled for {} particles",
+		           capacity);
+		return true;
+	}
+
+	void ParticleSystem::Shutdown()
+	{
+		DeleteComputeProgram(m_emitProgram);
+		DeleteComputeProgram(m_prepareProgram);
+		DeleteComputeProgram(m_simulateProgram);
+		DeleteComputeProgram(m_sortProgram);
+		m_drawShader.reset();
+		m_drawOitShader.reset();
+		if (m_vao != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::VertexArray, m_vao);
+			glDeleteVertexArrays(1, &m_vao);
+			VEGAM_CHECK_GL_ERROR;
+			m_vao = 0;
+		}
+		if (m_defaultTexture != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Texture, m_defaultTexture);
+			glDeleteTextures(1, &m_defaultTexture);
+			VEGAM_CHECK_GL_ERROR;
+			m_defaultTexture = 0;
+		}
+		DeleteBuffer(m_particleBuffer);
+		DeleteBuffer(m_deadBuffer);
+		for (auto& buffer : m_aliveBuffers)
+		{
+			DeleteBuffer(buffer);
+		}
+		DeleteBuffer(m_stateBuffer);
+		DeleteBuffer(m_orderBuffer);
+		DeleteBuffer(m_emitterBuffer);
+
+		std::lock_guard lock(m_emitMutex);
+		m_emits.clear();
+	}
+
+	void ParticleSystem::Emit(const ParticleEmitter& emitter,
+	                          uint32_t count)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+		std::lock_guard lock(m_emitMutex);
+		m_emits.push_back({emitter, count});
+	}
+
+	void ParticleSystem::Simulate(float deltaTime,
+	                              const Float3& eye)
+	{
+		if (!IsInitialized())
+		{
+			return;
+		}
+		VEGAM_PROFILE_SCOPE("ParticleSystem::Simulate");
+		VEGAM_PROFILE_GPU_SCOPE("Particles");
+
+		{
+			std::lock_guard lock(m_emitMutex);
+			m_spawning.swap(m_emits);
+		}
+
+		const auto next = 1 - m_current;
+		const std::pair<uint32_t, uint32_t> buffers[] = {
+		    {ParticlesBinding, m_particleBuffer},
+		    {DeadBinding, m_deadBuffer},
+		    {AliveBinding, m_aliveBuffers[m_current]},
+		    {NextAliveBinding, m_aliveBuffers[next]},
+		    {StateBinding, m_stateBuffer},
+		    {OrderBinding, m_orderBuffer}};
+		for (const auto& [binding, buffer] : buffers)
+		{
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding,
+			                 buffer);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER,
+		             m_stateBuffer);
+		VEGAM_CHECK_GL_ERROR;
+
+		Spawn(m_spawning);
+		m_spawning.clear();
+
+		glProgramUniform1ui(
+		    m_prepareProgram,
+		    Location(m_prepareProgram, "Current"), m_current);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1ui(m_prepareProgram,
+		                    Location(m_prepareProgram, "Mode"),
+		                    0);
+		VEGAM_CHECK_GL_ERROR;
+		Shader::UseProgram(m_prepareProgram);
+		glDispatchCompute(1, 1, 1);
+		VEGAM_CHECK_GL_ERROR;
+		glMemoryBarrier(GL_COMMAND_BARRIER_BIT
+		                | GL_SHADER_STORAGE_BARRIER_BIT);
+		VEGAM_CHECK_GL_ERROR;
+
+		const auto& gravity = m_settings.gravity;
+		const auto damping =
+		    std::pow(1.0f - m_settings.drag, deltaTime);
+		glProgramUniform1ui(
+		    m_simulateProgram,
+		    Location(m_simulateProgram, "Current"), m_current);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1f(
+		    m_simulateProgram,
+		    Location(m_simulateProgram, "DeltaTime"),
+		    deltaTime);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform3f(
+		    m_simulateProgram,
+		    Location(m_simulateProgram, "Gravity"), gravity.x,
+		    gravity.y, gravity.z);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1f(
+		    m_simulateProgram,
+		    Location(m_simulateProgram, "Damping"), damping);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform3f(m_simulateProgram,
+		                   Location(m_simulateProgram, "Eye"),
+		                   eye.x, eye.y, eye.z);
+		VEGAM_CHECK_GL_ERROR;
+		Shader::UseProgram(m_simulateProgram);
+		DispatchIndirect(offsetof(State, simulateArgs));
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		VEGAM_CHECK_GL_ERROR;
+
+		glProgramUniform1ui(m_prepareProgram,
+		                    Location(m_prepareProgram, "Mode"),
+		                    1);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1ui(
+		    m_prepareProgram,
+		    Location(m_prepareProgram, "SortLevels"),
+		    m_sortLevels);
+		VEGAM_CHECK_GL_ERROR;
+		Shader::UseProgram(m_prepareProgram);
+		glDispatchCompute(1, 1, 1);
+		VEGAM_CHECK_GL_ERROR;
+		glMemoryBarrier(GL_COMMAND_BARRIER_BIT
+		                | GL_SHADER_STORAGE_BARRIER_BIT);
+		VEGAM_CHECK_GL_ERROR;
+
+		if (m_sortLevels > 0)
+		{
+			Sort();
+		}
+		m_current = next;
+
+		glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void ParticleSystem::Spawn(
+	    std::span<const PendingEmit> emits)
+	{
+		if (emits.empty())
+		{
+			return;
+		}
+		glBindBufferBase(GL_UNIFORM_BUFFER, EmittersBinding,
+		                 m_emitterBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1ui(m_emitProgram,
+		                    Location(m_emitProgram, "Current"),
+		                    m_current);
+		VEGAM_CHECK_GL_ERROR;
+		Shader::UseProgram(m_emitProgram);
+
+		for (size_t begin = 0; begin < emits.size();
+		     begin += MaxEmitters)
+		{
+			const auto batch = emits.subspan(
+			    begin, std::min<size_t>(MaxEmitters,
+			                            emits.size() - begin));
+			m_emitterData.clear();
+			// Spawns past the pool could never find a slot.
+			uint32_t total = 0;
+			for (const auto& [emitter, requested] : batch)
+			{
+				const auto count = std::min(
+				    requested, m_settings.capacity - total);
+				if (count == 0)
+				{
+					break;
+				}
+				auto& data = m_emitterData.emplace_back();
+				data.position[0] = emitter.position.x;
+				data.position[1] = emitter.position.y;
+				data.position[2] = emitter.position.z;
+				data.position[3] = emitter.radius;
+				data.velocity[0] = emitter.velocity.x;
+				data.velocity[1] = emitter.velocity.y;
+				data.velocity[2] = emitter.velocity.z;
+				data.velocity[3] = emitter.spread;
+				std::memcpy(data.startColor,
+				            emitter.startColor.data(),
+				            sizeof(data.startColor));
+				std::memcpy(data.endColor,
+				            emitter.endColor.data(),
+				            sizeof(data.endColor));
+				data.lifetimeSize[0] = emitter.minLifetime;
+				data.lifetimeSize[1] = emitter.maxLifetime;
+				data.lifetimeSize[2] = emitter.startSize;
+				data.lifetimeSize[3] = emitter.endSize;
+				data.spin[0] = emitter.minSpin;
+				data.spin[1] = emitter.maxSpin;
+				data.first = total;
+				total += count;
+			}
+			if (total == 0)
+			{
+				continue;
+			}
+
+			glBindBuffer(GL_UNIFORM_BUFFER, m_emitterBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBufferSubData(GL_UNIFORM_BUFFER, 0,
+			                m_emitterData.size()
+			                    * sizeof(EmitterData),
+			                m_emitterData.data());
+			VEGAM_CHECK_GL_ERROR;
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			VEGAM_CHECK_GL_ERROR;
+
+			glProgramUniform1ui(
+			    m_emitProgram,
+			    Location(m_emitProgram, "EmitterCount"),
+			    static_cast<uint32_t>(m_emitterData.size()));
+			VEGAM_CHECK_GL_ERROR;
+			glProgramUniform1ui(
+			    m_emitProgram,
+			    Location(m_emitProgram, "SpawnCount"), total);
+			VEGAM_CHECK_GL_ERROR;
+			glProgramUniform1ui(m_emitProgram,
+			                    Location(m_emitProgram, "Seed"),
+			                    ++m_seed);
+			VEGAM_CHECK_GL_ERROR;
+			glDispatchCompute((total + GroupSize - 1)
+			                      / GroupSize,
+			                  1, 1);
+			VEGAM_CHECK_GL_ERROR;
+			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+			VEGAM_CHECK_GL_ERROR;
+		}
+	}
+
+	// Level 0 sorts each block; every further level
+	// merges pairs of sorted runs into runs twice as long,
+	// with a step across blocks per halving of the
+	// distance down to one block, then the rest within
+	// each block. Levels past the live count dispatch no
+	// groups.
+	void ParticleSystem::Sort()
+	{
+		const auto program = m_sortProgram;
+		const auto mode = Location(program, "Mode");
+		const auto runLength = Location(program, "K");
+		const auto distance = Location(program, "J");
+		glProgramUniform1ui(program,
+		                    Location(program, "Current"),
+		                    m_current);
+		VEGAM_CHECK_GL_ERROR;
+		Shader::UseProgram(program);
+
+		const auto stateSize = sizeof(State);
+		glProgramUniform1ui(program, mode, 0);
+		VEGAM_CHECK_GL_ERROR;
+		DispatchIndirect(SortArgsOffset(stateSize, 0));
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		VEGAM_CHECK_GL_ERROR;
+
+		for (uint32_t level = 1; level < m_sortLevels; ++level)
+		{
+			const auto k = SortBlock << level;
+			const auto args = SortArgsOffset(stateSize, level);
+			glProgramUniform1ui(program, runLength, k);
+			VEGAM_CHECK_GL_ERROR;
+			glProgramUniform1ui(program, mode, 1);
+			VEGAM_CHECK_GL_ERROR;
+			for (auto j = k / 2; j >= SortBlock; j /= 2)
+			{
+				glProgramUniform1ui(program, distance, j);
+				VEGAM_CHECK_GL_ERROR;
+				DispatchIndirect(args);
+				glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+				VEGAM_CHECK_GL_ERROR;
+			}
+			glProgramUniform1ui(program, mode, 2);
+			VEGAM_CHECK_GL_ERROR;
+			DispatchIndirect(args);
+			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+			VEGAM_CHECK_GL_ERROR;
+		}
+	}
+
+	void ParticleSystem::DispatchIndirect(size_t offset) const
+	{
+		glDispatchComputeIndirect(
+		    static_cast<GLintptr>(offset));
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void ParticleSystem::Draw(CommandList& list,
+	                          const float viewProjection[16],
+	                          const float view[16],
+	                          TextureHandle texture,
+	                          uint8_t renderLayer,
+	                          BlendMode blend) const
+	{
+		if (!IsInitialized())
+		{
+			return;
+		}
+		DrawConstants constants;
+		std::memcpy(constants.viewProjection, viewProjection,
+		            sizeof(constants.viewProjection));
+		// The view's rows: the camera's axes in world
+		// space.
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			constants.cameraRight[i] = view[i * 4];
+			constants.cameraUp[i] = view[i * 4 + 1];
+		}
+		constants.cameraRight[3] = 0.0f;
+		constants.cameraUp[3] = 0.0f;
+
+		RenderCommands::DrawParticles command{};
+		const auto oit = blend == BlendMode::WeightedOit;
+		command.program = oit ? m_drawOitShader->GetId()
+		                      : m_drawShader->GetId();
+		command.vao = m_vao;
+		command.particleBuffer = m_particleBuffer;
+		command.orderBuffer = m_orderBuffer;
+		command.argsBuffer = m_stateBuffer;
+		command.argsOffset = offsetof(State, drawArgs);
+		command.texture = texture;
+		command.defaultTexture = m_defaultTexture;
+		command.constants = list.PushConstants(constants);
+		command.blend = blend;
+		const auto key = SortKey::Make(
+		    renderLayer, true, 0, 0,
+		    static_cast<uint32_t>(
+		        SortKey::Mask(SortKey::DepthBits)));
+		list.Submit(command, oit ? SortKey::WithWeightedOit(key)
+		                         : key);
+	}
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,297 @@
+#include "AthiVegam/Graphics/PipelineWarmup.h"
+
+#include "AthiVegam/Core/CVar.h"
+#include "AthiVegam/Core/FlatHashMap.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Core/Serialize.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Graphics/RenderState.h"
+#include "AthiVegam/Graphics/RenderTarget.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+namespace AthiVegam::Graphics::PipelineWarmup
+{
+	namespace
+	{
+		Core::CVar<bool> recordCVar(
+		    "r.recordPipelines", false,
+		    "Log the shader, vertex layout and state of mesh "
+		    "draws for PipelineWarmup");
+
+		constexpr uint32_t SchemaVersion = 1;
+
+		struct Entry
+		{
+			uint64_t shader = 0;
+			VertexLayout layout;
+			PipelineState state;
+			bool instanced = false;
+		};
+
+		struct SavedLog
+		{
+			std::vector<Entry> entries;
+			VEGAM_SERIAL_FIELDS(&SavedLog::entries)
+		};
+
+		// By field rather than by bytes, which have
+		// padding.
+		uint64_t Hash(const Entry& entry)
+		{
+			auto hash = 14695981039346656037ull;
+			const auto mix = [&](uint64_t value) {
+				hash ^= value;
+				hash *= 1099511628211ull;
+			};
+			mix(entry.shader);
+			const auto& layout = entry.layout;
+			for (uint32_t i = 0; i < layout.GetAttributeCount();
+			     ++i)
+			{
+				const auto& attribute = layout.GetAttribute(i);
+				mix(attribute.location);
+				mix(static_cast<uint64_t>(attribute.format));
+				mix(attribute.offset);
+			}
+			mix(layout.GetStride());
+			const auto& state = entry.state;
+			mix(static_cast<uint64_t>(state.blend));
+			mix(state.depthTest);
+			mix(state.depthWrite);
+			mix(static_cast<uint64_t>(state.depthFunc));
+			mix(static_cast<uint64_t>(state.cull));
+			mix(entry.instanced);
+			return hash;
+		}
+
+		// Recording runs on the render thread, loading and
+		// saving wherever the engine starts and stops.
+		std::mutex mutex;
+		std::vector<Entry> entries;
+		Core::FlatHashMap<uint64_t, uint32_t> known;
+		bool recorded = false;
+
+		void Add(const Entry& entry)
+		{
+			if (known.try_emplace(Hash(entry),
+			                      static_cast<uint32_t>(
+			                          entries.size()))
+			        .second)
+			{
+				entries.push_back(entry);
+			}
+		}
+
+		// Points the bound VAO's instance transform at the
+		// zeroed buffer.
+		void ApplyInstanceAttributes()
+		{
+			using RenderCommands::InstanceTransform;
+			for (uint32_t column = 0; column < 4; ++column)
+			{
+				const auto location =
+				    RenderCommands::InstanceTransformLocation
+				    + column;
+				glEnableVertexAttribArray(location);
+				VEGAM_CHECK_GL_ERROR;
+				glVertexAttribPointer(
+				    location, 4, GL_FLOAT, GL_FALSE,
+				    sizeof(InstanceTransform),
+				    reinterpret_cast<const void*>(
+				        uintptr_t{column} * 4 * sizeof(float)));
+				VEGAM_CHECK_GL_ERROR;
+				glVertexAttribDivisor(location, 1);
+				VEGAM_CHECK_GL_ERROR;
+			}
+		}
+	} // namespace
+
+	void Record(const Shader& shader,
+	            const VertexLayout& layout,
+	            const PipelineState& state, bool instanced)
+	{
+		if (!recordCVar.Get())
+		{
+			return;
+		}
+		Entry entry;
+		entry.shader = shader.GetSourceHash();
+		entry.layout = layout;
+		entry.state = state;
+		entry.instanced = instanced;
+
+		std::lock_guard lock(mutex);
+		const auto count = entries.size();
+		Add(entry);
+		recorded |= entries.size() != count;
+	}
+
+	bool Load(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			return true;
+		}
+		const std::vector<uint8_t> data(
+		    (std::istreambuf_iterator<char>(file)),
+		    std::istreambuf_iterator<char>());
+		SavedLog log;
+		uint32_t schemaVersion = 0;
+		if (!Core::Serial::Load(data.data(), data.size(), log,
+		                        &schemaVersion)
+		    || schemaVersion != SchemaVersion)
+		{
+			VEGAM_WARN("Ignoring pipeline log {}", path);
+			return false;
+		}
+
+		std::lock_guard lock(mutex);
+		for (const auto& entry : log.entries)
+		{
+			Add(entry);
+		}
+		return true;
+	}
+
+	bool Save(const std::string& path)
+	{
+		std::vector<uint8_t> data;
+		{
+			std::lock_guard lock(mutex);
+			if (!recorded)
+			{
+				return true;
+			}
+			SavedLog log;
+			log.entries = entries;
+			Core::Serial::Save(log, data, SchemaVersion);
+			recorded = false;
+		}
+
+		std::ofstream file(path, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(data.data()),
+		           static_cast<std::streamsize>(data.size()));
+		if (!file)
+		{
+			VEGAM_ERROR("Error writing pipeline log {}", path);
+			return false;
+		}
+		return true;
+	}
+
+	size_t GetCount()
+	{
+		std::lock_guard lock(mutex);
+		return entries.size();
+	}
+
+	uint32_t Warm(ResourcePool<Shader>& shaders,
+	              RenderState& state)
+	{
+		VEGAM_PROFILE_SCOPE("PipelineWarmup::Warm");
+		std::vector<Entry> warm;
+		{
+			std::lock_guard lock(mutex);
+			warm = entries;
+		}
+		Core::FlatHashMap<uint64_t, const Shader*> byHash;
+		shaders.ForEach([&](ShaderHandle, Shader& shader) {
+			if (shader.IsReady())
+			{
+				byHash.try_emplace(shader.GetSourceHash(),
+				                   &shader);
+			}
+		});
+		std::erase_if(warm, [&](const Entry& entry) {
+			return !byHash.contains(entry.shader);
+		});
+		if (warm.empty())
+		{
+			return 0;
+		}
+
+		GLint previousFramebuffer = 0;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING,
+		              &previousFramebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		GLint previousViewport[4] = {};
+		glGetIntegerv(GL_VIEWPORT, previousViewport);
+		VEGAM_CHECK_GL_ERROR;
+		RenderTarget target;
+		if (!target.Create(1, 1))
+		{
+			return 0;
+		}
+		target.Bind();
+
+		// One zeroed triangle serves every layout: it
+		// covers no pixel, but the driver still has to
+		// finish the program for the draw.
+		uint32_t stride =
+		    sizeof(RenderCommands::InstanceTransform);
+		for (const auto& entry : warm)
+		{
+			stride = std::max(stride, entry.layout.GetStride());
+		}
+		const std::vector<uint8_t> zeros(stride * 3);
+		GLuint buffer = 0;
+		glGenBuffers(1, &buffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBufferData(GL_ARRAY_BUFFER, zeros.size(),
+		             zeros.data(), GL_STATIC_DRAW);
+		VEGAM_CHECK_GL_ERROR;
+
+		for (const auto& entry : warm)
+		{
+			GLuint vao = 0;
+			glGenVertexArrays(1, &vao);
+			VEGAM_CHECK_GL_ERROR;
+			state.BindVertexArray(vao);
+			glBindBuffer(GL_ARRAY_BUFFER, buffer);
+			VEGAM_CHECK_GL_ERROR;
+			entry.layout.Apply();
+			if (entry.instanced)
+			{
+				ApplyInstanceAttributes();
+			}
+			state.UseProgram(byHash[entry.shader]->GetId());
+			state.SetPipelineState(entry.state);
+			if (entry.instanced)
+			{
+				glDrawArraysInstanced(GL_TRIANGLES, 0, 3, 1);
+			}
+			else
+			{
+				glDrawArrays(GL_TRIANGLES, 0, 3);
+			}
+			VEGAM_CHECK_GL_ERROR;
+			state.BindVertexArray(0);
+			glDeleteVertexArrays(1, &vao);
+			VEGAM_CHECK_GL_ERROR;
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		glDeleteBuffers(1, &buffer);
+		VEGAM_CHECK_GL_ERROR;
+		state.SetPipelineState(PipelineState{});
+		glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glViewport(previousViewport[0], previousViewport[1],
+		           previousViewport[2], previousViewport[3]);
+		VEGAM_CHECK_GL_ERROR;
+		VEGAM_INFO("Warmed up {} pipelines", warm.size());
+		return static_cast<uint32_t>(warm.size());
+	}
+} // namespace AthiVegam::Graphics::PipelineWarmup
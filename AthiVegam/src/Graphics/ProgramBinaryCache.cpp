@@ -0,0 +1,319 @@
+#include "AthiVegam/Graphics/ProgramBinaryCache.h"
+
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace AthiVegam::Graphics::ProgramBinaryCache
+{
+	namespace
+	{
+		constexpr uint32_t Magic = 0x42505641; // "AVPB"
+		constexpr uint32_t Version = 2;
+
+		// Followed by the binary, then the metadata.
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint64_t key;
+			uint32_t format;
+			uint32_t length;
+			uint32_t metadataLength;
+			uint32_t reserved;
+		};
+
+		std::filesystem::path cacheDirectory;
+		// Vendor, renderer and version strings; a driver
+		// update changes it and so invalidates every entry.
+		std::string driverId;
+		bool enabled = false;
+
+		// Entries read by Prefetch(), by file name; each is
+		// dropped once loaded.
+		constexpr size_t MaxPrefetchSize = 64 << 20;
+		std::unordered_map<std::string, std::vector<char>>
+		    prefetched;
+		// Programs may also be loaded on the loader thread.
+		std::mutex prefetchedMutex;
+
+		inline uint64_t Hash(uint64_t hash,
+		                     std::string_view data)
+		{
+			for (auto c : data)
+			{
+				hash ^= static_cast<uint8_t>(c);
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+
+		uint64_t MakeKey(const std::string& vertex,
+		                 const std::string& fragment)
+		{
+			auto hash = 14695981039346656037ull;
+			hash = Hash(hash, driverId);
+			hash = Hash(hash, std::string_view("\0", 1));
+			hash = Hash(hash, vertex);
+			hash = Hash(hash, std::string_view("\0", 1));
+			return Hash(hash, fragment);
+		}
+
+		std::filesystem::path GetPath(uint64_t key)
+		{
+			char name[32];
+			snprintf(name, sizeof(name), "%016llx.bin",
+			         static_cast<unsigned long long>(key));
+			return cacheDirectory / name;
+		}
+
+		bool ReadFile(const std::filesystem::path& path,
+		              std::vector<char>& data)
+		{
+			std::ifstream file(path,
+			                   std::ios::binary | std::ios::ate);
+			if (!file)
+			{
+				return false;
+			}
+			data.resize(static_cast<size_t>(file.tellg()));
+			file.seekg(0);
+			file.read(data.data(), data.size());
+			return static_cast<bool>(file);
+		}
+
+		std::string GetString(GLenum name)
+		{
+			const auto* value = reinterpret_cast<const char*>(
+			    glGetString(name));
+			VEGAM_CHECK_GL_ERROR;
+			return value ? value : "";
+		}
+	} // namespace
+
+	void Prefetch(const std::string& directory)
+	{
+		prefetched.clear();
+		std::error_code error;
+		if (directory.empty()
+		    || !std::filesystem::is_directory(directory, error))
+		{
+			return;
+		}
+
+		size_t total = 0;
+		for (const auto& entry :
+		     std::filesystem::directory_iterator(directory,
+		                                         error))
+		{
+			if (entry.path().extension() != ".bin"
+			    || !entry.is_regular_file(error))
+			{
+				continue;
+			}
+			total += entry.file_size(error);
+			if (total > MaxPrefetchSize)
+			{
+				break;
+			}
+			std::vector<char> data;
+			if (ReadFile(entry.path(), data))
+			{
+				prefetched.emplace(
+				    entry.path().filename().string(),
+				    std::move(data));
+			}
+		}
+	}
+
+	void Initialize(const std::string& directory)
+	{
+		enabled = false;
+		if (directory.empty())
+		{
+			prefetched.clear();
+			return;
+		}
+
+		GLint formatCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS,
+		              &formatCount);
+		VEGAM_CHECK_GL_ERROR;
+		if (formatCount == 0)
+		{
+			VEGAM_INFO("Program binary cache: unavailable "
+			           "(driver has no binary formats)");
+			prefetched.clear();
+			return;
+		}
+
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		if (error)
+		{
+			VEGAM_WARN("Program binary cache: cannot create "
+			           "{}: {}",
+			           directory, error.message());
+			prefetched.clear();
+			return;
+		}
+
+		cacheDirectory = directory;
+		driverId = GetString(GL_VENDOR) + "|"
+		           + GetString(GL_RENDERER) + "|"
+		           + GetString(GL_VERSION);
+		enabled = true;
+		VEGAM_INFO("Program binary cache: {}", directory);
+	}
+
+	void Shutdown()
+	{
+		enabled = false;
+		prefetched.clear();
+		cacheDirectory.clear();
+		driverId.clear();
+	}
+
+	bool IsEnabled() { return enabled; }
+
+	bool Load(uint32_t program, const std::string& vertex,
+	          const std::string& fragment,
+	          std::vector<uint8_t>& metadata)
+	{
+		if (!enabled)
+		{
+			return false;
+		}
+
+		const auto key = MakeKey(vertex, fragment);
+		const auto path = GetPath(key);
+		std::vector<char> entry;
+		{
+			std::lock_guard lock(prefetchedMutex);
+			const auto it =
+			    prefetched.find(path.filename().string());
+			if (it != prefetched.end())
+			{
+				entry = std::move(it->second);
+				prefetched.erase(it);
+			}
+		}
+		if (entry.empty() && !ReadFile(path, entry))
+		{
+			return false;
+		}
+
+		Header header{};
+		if (entry.size() < sizeof(header))
+		{
+			return false;
+		}
+		std::memcpy(&header, entry.data(), sizeof(header));
+		if (header.magic != Magic || header.version != Version
+		    || header.key != key
+		    || entry.size() - sizeof(header)
+		           < uint64_t{header.length}
+		                 + header.metadataLength)
+		{
+			return false;
+		}
+
+		glProgramBinary(program, header.format,
+		                entry.data() + sizeof(header),
+		                static_cast<GLsizei>(header.length));
+		// The driver may reject old or foreign binaries;
+		// that is reported through the link status.
+		while (glGetError() != GL_NO_ERROR)
+		{
+		}
+
+		GLint status = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+		VEGAM_CHECK_GL_ERROR;
+		if (status != GL_TRUE)
+		{
+			VEGAM_TRACE("Program binary cache: stale entry "
+			            "{:016x}",
+			            key);
+			return false;
+		}
+		const auto* stored = reinterpret_cast<const uint8_t*>(
+		    entry.data() + sizeof(header) + header.length);
+		metadata.assign(stored, stored + header.metadataLength);
+		return true;
+	}
+
+	void Store(uint32_t program, const std::string& vertex,
+	           const std::string& fragment,
+	           std::span<const uint8_t> metadata)
+	{
+		if (!enabled)
+		{
+			return;
+		}
+
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH,
+		               &length);
+		VEGAM_CHECK_GL_ERROR;
+		if (length <= 0)
+		{
+			return;
+		}
+
+		std::vector<char> binary(length);
+		GLenum format = 0;
+		glGetProgramBinary(program, length, nullptr, &format,
+		                   binary.data());
+		VEGAM_CHECK_GL_ERROR;
+
+		const auto key = MakeKey(vertex, fragment);
+		const auto metadataLength =
+		    static_cast<uint32_t>(metadata.size());
+		const Header header{Magic, Version, key, format,
+		                    static_cast<uint32_t>(length),
+		                    metadataLength, 0};
+
+		// Written next to the entry and renamed over it, so
+		// a crash never leaves a truncated binary behind.
+		const auto path = GetPath(key);
+		auto temporary = path;
+		temporary += ".tmp";
+		{
+			std::ofstream file(temporary, std::ios::binary
+			                                  | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(&header),
+			           sizeof(header));
+			file.write(binary.data(), binary.size());
+			file.write(
+			    reinterpret_cast<const char*>(metadata.data()),
+			    static_cast<std::streamsize>(metadata.size()));
+			if (!file)
+			{
+				VEGAM_WARN("Program binary cache: failed to "
+				           "write {}",
+				           temporary.string());
+				return;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporary, path, error);
+		if (error)
+		{
+			VEGAM_WARN("Program binary cache: failed to "
+			           "write {}: {}",
+			           path.string(), error.message());
+		}
+	}
+} // namespace AthiVegam::Graphics::ProgramBinaryCache
@@ -0,0 +1,788 @@
+#include "AthiVegam/Graphics/ReflectionProbes.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Core/Serialize.h"
+#include "AthiVegam/Graphics/GLState.h"
+#include "AthiVegam/Graphics/GpuProfiler.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/RenderState.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Math/Matrix.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <numbers>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		constexpr uint32_t SchemaVersion = 1;
+		constexpr uint32_t SourceUnit = 0;
+		// RGBA16F.
+		constexpr size_t TexelSize = 8;
+
+		struct CachedProbe
+		{
+			Math::Vec3 position;
+			bool dynamic = true;
+			// BC6H, level by level, six faces each.
+			std::vector<uint8_t> blocks;
+
+			VEGAM_SERIAL_FIELDS(&CachedProbe::position,
+			                    &CachedProbe::dynamic,
+			                    &CachedProbe::blocks)
+		};
+
+		struct BakedCache
+		{
+			uint32_t size = 0;
+			uint32_t levelCount = 0;
+			std::vector<CachedProbe> probes;
+
+			VEGAM_SERIAL_FIELDS(&BakedCache::size,
+			                    &BakedCache::levelCount,
+			                    &BakedCache::probes)
+		};
+
+		// One triangle covering the viewport.
+		const char* DecodeVertexSource = R"(#version 430 core
+void main()
+{
+	vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+		// The sampler decodes; the face level is copied
+		// texel for texel.
+		const char* DecodeFragmentSource = R"(#version 430 core
+uniform sampler2D Source;
+uniform int Level;
+
+layout(location = 0) out vec4 OutColor;
+
+void main()
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	OutColor = vec4(texelFetch(Source, texel, Level).rgb, 1.0);
+}
+)";
+
+		// Looking down each face's axis, with the up GL's
+		// cube map faces are laid out with.
+		struct FaceView
+		{
+			Math::Vec3 direction;
+			Math::Vec3 up;
+		};
+		constexpr FaceView FaceViews[6] = {
+		    {{1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f}},
+		    {{-1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f}},
+		    {{0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+		    {{0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, -1.0f}},
+		    {{0.0f, 0.0f, 1.0f}, {0.0f, -1.0f, 0.0f}},
+		    {{0.0f, 0.0f, -1.0f}, {0.0f, -1.0f, 0.0f}}};
+
+		inline uint32_t LevelSize(uint32_t size,
+		                          uint32_t level)
+		{
+			return std::max(size >> level, 1u);
+		}
+
+		// Of one face's level, in 4x4 blocks of 16 bytes.
+		inline size_t BlockBytes(uint32_t size)
+		{
+			const size_t blocks = (size + 3) / 4;
+			return blocks * blocks * 16;
+		}
+
+		// Of a probe's blocks, before the level's.
+		size_t BlockOffset(uint32_t size, uint32_t level)
+		{
+			size_t offset = 0;
+			for (uint32_t i = 0; i < level; ++i)
+			{
+				offset += 6 * BlockBytes(LevelSize(size, i));
+			}
+			return offset;
+		}
+
+		// Of a cube map's six faces and levels.
+		size_t CubeBytes(uint32_t size, uint32_t levelCount)
+		{
+			size_t bytes = 0;
+			for (uint32_t i = 0; i < levelCount; ++i)
+			{
+				const size_t levelSize = LevelSize(size, i);
+				bytes += 6 * levelSize * levelSize * TexelSize;
+			}
+			return bytes;
+		}
+
+		// Restores the framebuffer and viewport found.
+		class TargetScope
+		{
+		  public:
+			TargetScope()
+			{
+				glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING,
+				              &m_framebuffer);
+				VEGAM_CHECK_GL_ERROR;
+				glGetIntegerv(GL_VIEWPORT, m_viewport);
+				VEGAM_CHECK_GL_ERROR;
+			}
+
+			~TargetScope()
+			{
+				glBindFramebuffer(
+				    GL_FRAMEBUFFER,
+				    static_cast<GLuint>(m_framebuffer));
+				VEGAM_CHECK_GL_ERROR;
+				glViewport(m_viewport[0], m_viewport[1],
+				           m_viewport[2], m_viewport[3]);
+				VEGAM_CHECK_GL_ERROR;
+			}
+
+		  private:
+			GLint m_framebuffer = 0;
+			GLint m_viewport[4] = {};
+		};
+	} // namespace
+
+	ReflectionProbes::ReflectionProbes()
+	    : ReflectionProbes(Settings{})
+	{
+	}
+
+	ReflectionProbes::ReflectionProbes(
+	    const Settings& settings)
+	    : m_settings(settings)
+	{
+		VEGAM_ASSERT(std::has_single_bit(settings.size)
+		                 && settings.maxProbes > 0
+		                 && settings.facesPerFrame > 0,
+		             "Invalid reflection probe settings");
+		m_levelCount =
+		    static_cast<uint32_t>(std::bit_width(settings.size));
+	}
+
+	ReflectionProbes::~ReflectionProbes()
+	{
+		VEGAM_ASSERT(!IsInitialized() && m_vao == 0,
+		             "ReflectionProbes destroyed without "
+		             "Shutdown()");
+	}
+
+	bool ReflectionProbes::Initialize()
+	{
+		if (IsInitialized())
+		{
+			return true;
+		}
+		if (!GLAD_GL_VERSION_4_3)
+		{
+			VEGAM_WARN("Reflection probes need a GL 4.3 "
+			           "context");
+			return false;
+		}
+		m_decodeShader = std::make_unique<Shader>(
+		    DecodeVertexSource, DecodeFragmentSource);
+		if (!m_decodeShader->IsReady())
+		{
+			m_decodeShader.reset();
+			return false;
+		}
+		m_decodeShader->SetUniformInt("Source", SourceUnit);
+		m_decodeLevel = m_decodeShader->GetUniform<int>("Level");
+
+		glGenVertexArrays(1, &m_vao);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::VertexArray,
+		                       m_vao, 0, "Probe decode");
+
+		// Reflections filter across the face edges.
+		glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+		VEGAM_CHECK_GL_ERROR;
+		if (!CreateTargets())
+		{
+			Shutdown();
+			return false;
+		}
+		return true;
+	}
+
+	void ReflectionProbes::Shutdown()
+	{
+		DestroyTargets();
+		m_decodeShader.reset();
+		if (m_vao != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::VertexArray, m_vao);
+			glDeleteVertexArrays(1, &m_vao);
+			VEGAM_CHECK_GL_ERROR;
+			m_vao = 0;
+		}
+		Clear();
+	}
+
+	bool ReflectionProbes::CreateTargets()
+	{
+		const auto size = static_cast<GLsizei>(m_settings.size);
+		const auto levels = static_cast<GLsizei>(m_levelCount);
+
+		glGenTextures(1, &m_array);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, m_array);
+		VEGAM_CHECK_GL_ERROR;
+		glTexStorage3D(GL_TEXTURE_CUBE_MAP_ARRAY, levels,
+		               GL_RGBA16F, size, size,
+		               static_cast<GLsizei>(
+		                   m_settings.maxProbes * 6));
+		VEGAM_CHECK_GL_ERROR;
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY,
+		                GL_TEXTURE_MIN_FILTER,
+		                GL_LINEAR_MIPMAP_LINEAR);
+		VEGAM_CHECK_GL_ERROR;
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY,
+		                GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(
+		    GpuResources::Type::Texture, m_array,
+		    CubeBytes(m_settings.size, m_levelCount)
+		        * m_settings.maxProbes,
+		    "Reflection probes");
+
+		// Rendered into a face at a time, then filtered.
+		glGenTextures(1, &m_scratch);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_CUBE_MAP, m_scratch);
+		VEGAM_CHECK_GL_ERROR;
+		glTexStorage2D(GL_TEXTURE_CUBE_MAP, levels,
+		               GL_RGBA16F, size, size);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(
+		    GpuResources::Type::Texture, m_scratch,
+		    CubeBytes(m_settings.size, m_levelCount),
+		    "Reflection probe face");
+
+		glGenRenderbuffers(1, &m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		glBindRenderbuffer(GL_RENDERBUFFER, m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		glRenderbufferStorage(GL_RENDERBUFFER,
+		                      GL_DEPTH_COMPONENT24, size, size);
+		VEGAM_CHECK_GL_ERROR;
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(
+		    GpuResources::Type::Renderbuffer, m_depth,
+		    static_cast<size_t>(size) * size * 4,
+		    "Reflection probe depth");
+
+		const TargetScope scope;
+		glGenFramebuffers(1, &m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER,
+		                          GL_DEPTH_ATTACHMENT,
+		                          GL_RENDERBUFFER, m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		glFramebufferTexture2D(GL_FRAMEBUFFER,
+		                       GL_COLOR_ATTACHMENT0,
+		                       GL_TEXTURE_CUBE_MAP_POSITIVE_X,
+		                       m_scratch, 0);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::Framebuffer,
+		                       m_framebuffer, 0,
+		                       "Reflection probes");
+		const auto status =
+		    glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		if (status != GL_FRAMEBUFFER_COMPLETE)
+		{
+			VEGAM_ERROR("Reflection probe target {}x{} "
+			            "incomplete: {:#x}",
+			            size, size, status);
+			return false;
+		}
+		return true;
+	}
+
+	void ReflectionProbes::DestroyTargets()
+	{
+		if (m_framebuffer != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Framebuffer, m_framebuffer);
+			glDeleteFramebuffers(1, &m_framebuffer);
+			VEGAM_CHECK_GL_ERROR;
+			m_framebuffer = 0;
+		}
+		if (m_depth != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Renderbuffer, m_depth);
+			glDeleteRenderbuffers(1, &m_depth);
+			VEGAM_CHECK_GL_ERROR;
+			m_depth = 0;
+		}
+		for (auto* texture : {&m_scratch, &m_array})
+		{
+			if (*texture != 0)
+			{
+				GpuResources::Unregister(
+				    GpuResources::Type::Texture, *texture);
+				glDeleteTextures(1, texture);
+				VEGAM_CHECK_GL_ERROR;
+				*texture = 0;
+			}
+		}
+	}
+
+	int32_t ReflectionProbes::AddProbe(
+	    const Math::Vec3& position, bool dynamic)
+	{
+		VEGAM_ASSERT(IsInitialized(),
+		             "ReflectionProbes used before "
+		             "Initialize()");
+		if (m_probes.size() >= m_settings.maxProbes)
+		{
+			VEGAM_WARN_ONCE("More than {} reflection probes",
+			                m_settings.maxProbes);
+			return -1;
+		}
+		const auto layer = static_cast<uint32_t>(m_probes.size());
+		m_probes.push_back({position, dynamic});
+		ClearLayer(layer);
+		return static_cast<int32_t>(layer);
+	}
+
+	void ReflectionProbes::SetDynamic(int32_t layer,
+	                                  bool dynamic)
+	{
+		VEGAM_ASSERT(layer >= 0
+		                 && static_cast<size_t>(layer)
+		                        < m_probes.size(),
+		             "Invalid reflection probe");
+		// Update() leaves one it was relighting.
+		m_probes[layer].dynamic = dynamic;
+	}
+
+	void ReflectionProbes::Clear()
+	{
+		m_probes.clear();
+		m_current = -1;
+		m_face = 0;
+	}
+
+	void ReflectionProbes::ClearLayer(uint32_t layer)
+	{
+		const TargetScope scope;
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		GLState::SetColorMask(true);
+		constexpr GLfloat black[] = {0.0f, 0.0f, 0.0f, 1.0f};
+		for (uint32_t level = 0; level < m_levelCount; ++level)
+		{
+			for (uint32_t face = 0; face < 6; ++face)
+			{
+				glFramebufferTextureLayer(
+				    GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_array,
+				    static_cast<GLint>(level),
+				    static_cast<GLint>(layer * 6 + face));
+				VEGAM_CHECK_GL_ERROR;
+				// Clears follow the scissor.
+				GLState::SetEnabled(
+				    GLState::Capability::ScissorTest, false);
+				glClearBufferfv(GL_COLOR, 0, black);
+				VEGAM_CHECK_GL_ERROR;
+			}
+		}
+	}
+
+	void ReflectionProbes::RenderFace(const Probe& probe,
+	                                  uint32_t face)
+	{
+		VEGAM_PROFILE_GPU_SCOPE("Reflection probe face");
+		const TargetScope scope;
+		const auto size = static_cast<GLsizei>(m_settings.size);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glFramebufferTexture2D(
+		    GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+		    GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, m_scratch, 0);
+		VEGAM_CHECK_GL_ERROR;
+		glViewport(0, 0, size, size);
+		VEGAM_CHECK_GL_ERROR;
+
+		GLState::SetEnabled(GLState::Capability::ScissorTest,
+		                    false);
+		GLState::SetColorMask(true);
+		GLState::SetDepthMask(true);
+		constexpr GLfloat black[] = {0.0f, 0.0f, 0.0f, 1.0f};
+		constexpr GLfloat farDepth = 1.0f;
+		glClearBufferfv(GL_COLOR, 0, black);
+		VEGAM_CHECK_GL_ERROR;
+		glClearBufferfv(GL_DEPTH, 0, &farDepth);
+		VEGAM_CHECK_GL_ERROR;
+
+		const auto& faceView = FaceViews[face];
+		const auto view = Math::Mat4::LookAt(
+		    probe.position, probe.position + faceView.direction,
+		    faceView.up);
+		const auto projection = Math::Mat4::Perspective(
+		    std::numbers::pi_v<float> * 0.5f, 1.0f,
+		    m_settings.zNear, m_settings.zFar);
+		m_renderer(view.Data(), projection.Data());
+	}
+
+	void ReflectionProbes::Finish(uint32_t layer)
+	{
+		VEGAM_PROFILE_GPU_SCOPE("Reflection probe filter");
+		glBindTexture(GL_TEXTURE_CUBE_MAP, m_scratch);
+		VEGAM_CHECK_GL_ERROR;
+		glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+		VEGAM_CHECK_GL_ERROR;
+		for (uint32_t level = 0; level < m_levelCount; ++level)
+		{
+			const auto size = static_cast<GLsizei>(
+			    LevelSize(m_settings.size, level));
+			glCopyImageSubData(
+			    m_scratch, GL_TEXTURE_CUBE_MAP,
+			    static_cast<GLint>(level), 0, 0, 0, m_array,
+			    GL_TEXTURE_CUBE_MAP_ARRAY,
+			    static_cast<GLint>(level), 0, 0,
+			    static_cast<GLint>(layer * 6), size, size, 6);
+			VEGAM_CHECK_GL_ERROR;
+		}
+	}
+
+	int32_t ReflectionProbes::NextDynamic() const
+	{
+		const auto count = static_cast<int32_t>(m_probes.size());
+		for (int32_t i = 1; i <= count; ++i)
+		{
+			const auto index = (m_current + i) % count;
+			if (m_probes[index].dynamic)
+			{
+				return index;
+			}
+		}
+		return -1;
+	}
+
+	void ReflectionProbes::Update()
+	{
+		VEGAM_ASSERT(IsInitialized(),
+		             "ReflectionProbes used before "
+		             "Initialize()");
+		if (!m_renderer || m_probes.empty())
+		{
+			return;
+		}
+		VEGAM_PROFILE_SCOPE("ReflectionProbes::Update");
+		for (uint32_t i = 0; i < m_settings.facesPerFrame; ++i)
+		{
+			// Started over if it stopped being dynamic.
+			if (m_current < 0 || m_face == 0
+			    || !m_probes[m_current].dynamic)
+			{
+				m_current = NextDynamic();
+				m_face = 0;
+				if (m_current < 0)
+				{
+					return;
+				}
+			}
+			RenderFace(m_probes[m_current], m_face);
+			if (++m_face == 6)
+			{
+				Finish(static_cast<uint32_t>(m_current));
+				m_face = 0;
+			}
+		}
+	}
+
+	void ReflectionProbes::RenderAll()
+	{
+		VEGAM_ASSERT(IsInitialized(),
+		             "ReflectionProbes used before "
+		             "Initialize()");
+		if (!m_renderer)
+		{
+			return;
+		}
+		VEGAM_PROFILE_SCOPE("ReflectionProbes::RenderAll");
+		for (uint32_t layer = 0; layer < m_probes.size();
+		     ++layer)
+		{
+			for (uint32_t face = 0; face < 6; ++face)
+			{
+				RenderFace(m_probes[layer], face);
+			}
+			Finish(layer);
+		}
+		// The scratch faces of one half relit are gone.
+		m_current = -1;
+		m_face = 0;
+	}
+
+	bool ReflectionProbes::SaveCache(const std::string& path,
+	                                 RenderState& state)
+	{
+		VEGAM_ASSERT(IsInitialized(),
+		             "ReflectionProbes used before "
+		             "Initialize()");
+		VEGAM_PROFILE_SCOPE("ReflectionProbes::SaveCache");
+		BakedCache cache;
+		cache.size = m_settings.size;
+		cache.levelCount = m_levelCount;
+		for (const auto& probe : m_probes)
+		{
+			cache.probes.push_back(
+			    {probe.position, probe.dynamic, {}});
+		}
+
+		// The driver encodes what's uploaded to a BC6H
+		// texture; it's read back as blocks.
+		uint32_t encoder = 0;
+		glGenTextures(1, &encoder);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, encoder);
+		VEGAM_CHECK_GL_ERROR;
+		std::vector<uint8_t> texels;
+		auto ok = true;
+		for (uint32_t level = 0;
+		     level < m_levelCount && ok && !m_probes.empty();
+		     ++level)
+		{
+			const auto size = LevelSize(m_settings.size, level);
+			const auto faceBytes =
+			    static_cast<size_t>(size) * size * TexelSize;
+			const auto blockBytes = BlockBytes(size);
+			texels.resize(faceBytes * m_settings.maxProbes * 6);
+			glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, m_array);
+			VEGAM_CHECK_GL_ERROR;
+			glGetTexImage(GL_TEXTURE_CUBE_MAP_ARRAY,
+			              static_cast<GLint>(level), GL_RGBA,
+			              GL_HALF_FLOAT, texels.data());
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
+			VEGAM_CHECK_GL_ERROR;
+
+			for (size_t face = 0; face < m_probes.size() * 6;
+			     ++face)
+			{
+				glTexImage2D(GL_TEXTURE_2D, 0,
+				             GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT,
+				             static_cast<GLsizei>(size),
+				             static_cast<GLsizei>(size), 0,
+				             GL_RGBA, GL_HALF_FLOAT,
+				             texels.data() + face * faceBytes);
+				VEGAM_CHECK_GL_ERROR;
+				GLint compressed = GL_FALSE;
+				GLint compressedBytes = 0;
+				glGetTexLevelParameteriv(GL_TEXTURE_2D, 0,
+				                         GL_TEXTURE_COMPRESSED,
+				                         &compressed);
+				VEGAM_CHECK_GL_ERROR;
+				glGetTexLevelParameteriv(
+				    GL_TEXTURE_2D, 0,
+				    GL_TEXTURE_COMPRESSED_IMAGE_SIZE,
+				    &compressedBytes);
+				VEGAM_CHECK_GL_ERROR;
+				if (compressed != GL_TRUE
+				    || static_cast<size_t>(compressedBytes)
+				           != blockBytes)
+				{
+					VEGAM_ERROR("The driver can't encode BC6H "
+					            "reflection probes");
+					ok = false;
+					break;
+				}
+				auto& blocks = cache.probes[face / 6].blocks;
+				blocks.resize(blocks.size() + blockBytes);
+				glGetCompressedTexImage(
+				    GL_TEXTURE_2D, 0,
+				    blocks.data() + blocks.size() - blockBytes);
+				VEGAM_CHECK_GL_ERROR;
+			}
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+		VEGAM_CHECK_GL_ERROR;
+		glDeleteTextures(1, &encoder);
+		VEGAM_CHECK_GL_ERROR;
+		state.Invalidate();
+		if (!ok)
+		{
+			return false;
+		}
+
+		std::vector<uint8_t> data;
+		Core::Serial::Save(cache, data, SchemaVersion);
+		std::ofstream file(path, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(data.data()),
+		           static_cast<std::streamsize>(data.size()));
+		if (!file)
+		{
+			VEGAM_ERROR("Error writing reflection probes {}",
+			            path);
+			return false;
+		}
+		VEGAM_INFO("Baked {} reflection probes into {} ({} "
+		           "bytes)",
+		           m_probes.size(), path, data.size());
+		return true;
+	}
+
+	bool ReflectionProbes::LoadCache(const std::string& path,
+	                                 RenderState& state)
+	{
+		VEGAM_ASSERT(IsInitialized(),
+		             "ReflectionProbes used before "
+		             "Initialize()");
+		VEGAM_PROFILE_SCOPE("ReflectionProbes::LoadCache");
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			VEGAM_ERROR("Error reading reflection probes {}",
+			            path);
+			return false;
+		}
+		const std::vector<uint8_t> data(
+		    (std::istreambuf_iterator<char>(file)),
+		    std::istreambuf_iterator<char>());
+		BakedCache cache;
+		uint32_t schemaVersion = 0;
+		if (!Core::Serial::Load(data.data(), data.size(), cache,
+		                        &schemaVersion)
+		    || schemaVersion != SchemaVersion)
+		{
+			VEGAM_ERROR("Ignoring malformed reflection probes "
+			            "{}",
+			            path);
+			return false;
+		}
+		if (cache.size != m_settings.size
+		    || cache.levelCount != m_levelCount
+		    || cache.probes.size() > m_settings.maxProbes)
+		{
+			VEGAM_ERROR("Reflection probes {} were baked at "
+			            "{}x{}, {} of them",
+			            path, cache.size, cache.size,
+			            cache.probes.size());
+			return false;
+		}
+		const auto probeBytes =
+		    BlockOffset(m_settings.size, m_levelCount);
+		for (const auto& probe : cache.probes)
+		{
+			if (probe.blocks.size() != probeBytes)
+			{
+				VEGAM_ERROR("Ignoring malformed reflection "
+				            "probes {}",
+				            path);
+				return false;
+			}
+		}
+
+		VEGAM_PROFILE_GPU_SCOPE("Reflection probe decode");
+		Clear();
+		uint32_t source = 0;
+		glGenTextures(1, &source);
+		VEGAM_CHECK_GL_ERROR;
+		glActiveTexture(GL_TEXTURE0 + SourceUnit);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, source);
+		VEGAM_CHECK_GL_ERROR;
+		glTexStorage2D(GL_TEXTURE_2D,
+		               static_cast<GLsizei>(m_levelCount),
+		               GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT,
+		               static_cast<GLsizei>(m_settings.size),
+		               static_cast<GLsizei>(m_settings.size));
+		VEGAM_CHECK_GL_ERROR;
+
+		const TargetScope scope;
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		GLState::SetEnabled(GLState::Capability::Blend, false);
+		GLState::SetEnabled(GLState::Capability::DepthTest,
+		                    false);
+		GLState::SetEnabled(GLState::Capability::CullFace,
+		                    false);
+		GLState::SetEnabled(GLState::Capability::ScissorTest,
+		                    false);
+		GLState::SetColorMask(true);
+		const auto polygonMode = GLState::GetPolygonMode();
+		GLState::SetPolygonMode(GL_FILL);
+		Shader::UseProgram(m_decodeShader->GetId());
+		glBindVertexArray(m_vao);
+		VEGAM_CHECK_GL_ERROR;
+
+		for (uint32_t layer = 0; layer < cache.probes.size();
+		     ++layer)
+		{
+			const auto& probe = cache.probes[layer];
+			m_probes.push_back({probe.position, probe.dynamic});
+			for (uint32_t face = 0; face < 6; ++face)
+			{
+				for (uint32_t level = 0; level < m_levelCount;
+				     ++level)
+				{
+					const auto size =
+					    LevelSize(m_settings.size, level);
+					const auto blockBytes = BlockBytes(size);
+					glCompressedTexSubImage2D(
+					    GL_TEXTURE_2D, static_cast<GLint>(level),
+					    0, 0, static_cast<GLsizei>(size),
+					    static_cast<GLsizei>(size),
+					    GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT,
+					    static_cast<GLsizei>(blockBytes),
+					    probe.blocks.data()
+					        + BlockOffset(m_settings.size, level)
+					        + face * blockBytes);
+					VEGAM_CHECK_GL_ERROR;
+				}
+				for (uint32_t level = 0; level < m_levelCount;
+				     ++level)
+				{
+					const auto size = static_cast<GLsizei>(
+					    LevelSize(m_settings.size, level));
+					glFramebufferTextureLayer(
+					    GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+					    m_array, static_cast<GLint>(level),
+					    static_cast<GLint>(layer * 6 + face));
+					VEGAM_CHECK_GL_ERROR;
+					glViewport(0, 0, size, size);
+					VEGAM_CHECK_GL_ERROR;
+					m_decodeShader->Set(
+					    m_decodeLevel, static_cast<int>(level));
+					glDrawArrays(GL_TRIANGLES, 0, 3);
+					VEGAM_CHECK_GL_ERROR;
+				}
+			}
+		}
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+		VEGAM_CHECK_GL_ERROR;
+		glDeleteTextures(1, &source);
+		VEGAM_CHECK_GL_ERROR;
+		if (polygonMode != GLState::Unknown)
+		{
+			GLState::SetPolygonMode(polygonMode);
+		}
+		state.Invalidate();
+		return true;
+	}
+} // namespace AthiVegam::Graphics
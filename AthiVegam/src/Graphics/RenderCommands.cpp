@@ -1,46 +1,413 @@
 #include "AthiVegam/Graphics/RenderCommands.h"
 
+#include "AthiVegam/Graphics/ComputeShader.h"
+#include "AthiVegam/Graphics/GpuMemory.h"
 #include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/Impostors.h"
+#include "AthiVegam/Graphics/MaterialTable.h"
 #include "AthiVegam/Graphics/Mesh.h"
+#include "AthiVegam/Graphics/ParticleSystem.h"
+#include "AthiVegam/Graphics/PipelineWarmup.h"
+#include "AthiVegam/Graphics/RenderState.h"
 #include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Graphics/SortKey.h"
+#include "AthiVegam/Graphics/Terrain.h"
 #include "AthiVegam/Log.h"
+#include "AthiVegam/Managers/ResourceManager.h"
 #include "glad/glad.h"
 
+#include <utility>
+
 namespace AthiVegam::Graphics::RenderCommands
 {
-	RenderMesh::RenderMesh(std::weak_ptr<Mesh> mesh,
-	                       std::weak_ptr<Shader> shader)
-	    : m_mesh(mesh), m_shader(shader)
+	namespace
+	{
+		inline GLenum GetGLIndexType(IndexType type)
+		{
+			return type == IndexType::UInt16 ? GL_UNSIGNED_SHORT
+			                                 : GL_UNSIGNED_INT;
+		}
+
+		inline const void* IndexOffset(const Mesh& mesh)
+		{
+			return reinterpret_cast<const void*>(
+			    static_cast<uintptr_t>(mesh.GetFirstIndex())
+			    * GetIndexSize(mesh.GetIndexType()));
+		}
+
+		// Points the mat4 instance attribute of the bound
+		// VAO at the instance buffer, starting at
+		// firstInstance.
+		void BindInstanceAttributes(uint32_t instanceBuffer,
+		                            uint32_t firstInstance)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			const auto base =
+			    static_cast<uintptr_t>(firstInstance)
+			    * sizeof(InstanceTransform);
+			for (uint32_t column = 0; column < 4; ++column)
+			{
+				const auto location =
+				    InstanceTransformLocation + column;
+				glEnableVertexAttribArray(location);
+				VEGAM_CHECK_GL_ERROR;
+				glVertexAttribPointer(
+				    location, 4, GL_FLOAT, GL_FALSE,
+				    sizeof(InstanceTransform),
+				    reinterpret_cast<const void*>(
+				        base + column * 4 * sizeof(float)));
+				VEGAM_CHECK_GL_ERROR;
+				glVertexAttribDivisor(location, 1);
+				VEGAM_CHECK_GL_ERROR;
+			}
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		inline void BindConstants(const Constants& constants,
+		                          ExecuteContext& context)
+		{
+			if (constants.offset == NoConstants)
+			{
+				return;
+			}
+			context.state.BindConstants(
+			    context.constantBuffer,
+			    context.constantBase + constants.offset,
+			    constants.size);
+		}
+
+		// The GL texture of an optional 2D texture handle,
+		// left as given when invalid. False for stale,
+		// streaming or non-2D textures, whose draw is
+		// skipped.
+		bool ResolveTexture2D(TextureHandle handle,
+		                      const ExecuteContext& context,
+		                      uint32_t& texture)
+		{
+			if (!handle.IsValid())
+			{
+				return true;
+			}
+			const auto* data =
+			    context.resources.GetTexture(handle);
+			if (!data || !data->IsReady()
+			    || data->GetDesc().type
+			           != TextureType::Texture2D)
+			{
+				return false;
+			}
+			data->MarkUsed(GpuMemory::GetFrame());
+			texture = data->GetId();
+			return true;
+		}
+
+		inline void
+		BindMaterialConstants(const Constants& constants,
+		                      ExecuteContext& context)
+		{
+			if (constants.offset == NoConstants)
+			{
+				return;
+			}
+			context.state.BindMaterialConstants(
+			    context.resources.GetMaterialTable()
+			        .GetConstantsBuffer(),
+			    constants.offset, constants.size);
+		}
+
+		inline void SetPipelineState(uint32_t id,
+		                             ExecuteContext& context)
+		{
+			context.state.SetPipelineState(
+			    context.resources.GetMaterialTable().GetState(
+			        id));
+		}
+
+		// Created since the material table's last update;
+		// it draws from the next frame.
+		inline bool IsMaterialPending(MaterialHandle material,
+		                              ExecuteContext& context)
+		{
+			return material.IsValid()
+			       && !context.resources.GetMaterialTable()
+			               .Contains(material)
+			       && context.resources.GetMaterial(material);
+		}
+
+		// After a mesh draw: checks the mesh against the
+		// shader's inputs and logs the combination for
+		// PipelineWarmup.
+		inline void RecordPipeline(const Shader& shader,
+		                           const Mesh& mesh,
+		                           MaterialHandle material,
+		                           bool instanced,
+		                           const ExecuteContext& context)
+		{
+#ifndef AV_CONFIG_SHIPPING
+			shader.ValidateLayout(mesh.GetLayout(), instanced);
+#endif
+			const auto& table =
+			    context.resources.GetMaterialTable();
+			PipelineWarmup::Record(
+			    shader, mesh.GetLayout(),
+			    table.GetState(table.GetStateId(material)),
+			    instanced);
+		}
+
+		// False for a stale material; none draws with the
+		// default state.
+		bool BindMaterial(MaterialHandle material,
+		                  ExecuteContext& context)
+		{
+			const auto& table =
+			    context.resources.GetMaterialTable();
+			if (!material.IsValid())
+			{
+				SetPipelineState(MaterialTable::DefaultState,
+				                 context);
+				return true;
+			}
+			if (!table.Contains(material))
+			{
+				return false;
+			}
+
+			SetPipelineState(table.GetStateId(material),
+			                 context);
+			BindMaterialConstants(table.GetConstants(material),
+			                      context);
+			if (table.GetMode() == MaterialTable::Mode::Arrays)
+			{
+				context.state.BindTextureSet(table.GetSetTextures(
+				    table.GetTextureSet(material)));
+			}
+			context.state.SetDrawMaterial(material.GetIndex(),
+			                              false);
+			return true;
+		}
+	} // namespace
+
+	namespace
 	{
+		inline uint64_t TriangleStripCount(const Mesh& mesh)
+		{
+			return mesh.GetVertexCount() > 2
+			           ? mesh.GetVertexCount() - 2
+			           : 0;
+		}
+
+		GLbitfield GetGLBarriers(Barrier barriers)
+		{
+			if (barriers == Barrier::All)
+			{
+				return GL_ALL_BARRIER_BITS;
+			}
+			constexpr std::pair<Barrier, GLbitfield> bits[] = {
+			    {Barrier::ShaderStorage,
+			     GL_SHADER_STORAGE_BARRIER_BIT},
+			    {Barrier::ShaderImage,
+			     GL_SHADER_IMAGE_ACCESS_BARRIER_BIT},
+			    {Barrier::Command, GL_COMMAND_BARRIER_BIT},
+			    {Barrier::VertexAttrib,
+			     GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT},
+			    {Barrier::ElementArray,
+			     GL_ELEMENT_ARRAY_BARRIER_BIT},
+			    {Barrier::Uniform, GL_UNIFORM_BARRIER_BIT},
+			    {Barrier::TextureFetch,
+			     GL_TEXTURE_FETCH_BARRIER_BIT},
+			    {Barrier::BufferUpdate,
+			     GL_BUFFER_UPDATE_BARRIER_BIT},
+			    {Barrier::Framebuffer,
+			     GL_FRAMEBUFFER_BARRIER_BIT}};
+			GLbitfield result = 0;
+			for (const auto& [barrier, bit] : bits)
+			{
+				if (HasBarrier(barriers, barrier))
+				{
+					result |= bit;
+				}
+			}
+			return result;
+		}
+
+		GLenum GetGLImageFormat(ImageFormat format)
+		{
+			switch (format)
+			{
+			case ImageFormat::RGBA16F:
+				return GL_RGBA16F;
+			case ImageFormat::RGBA32F:
+				return GL_RGBA32F;
+			case ImageFormat::R32F:
+				return GL_R32F;
+			case ImageFormat::R32UI:
+				return GL_R32UI;
+			case ImageFormat::RG16F:
+				return GL_RG16F;
+			default:
+				return GL_RGBA8;
+			}
+		}
+
+		inline GLenum GetGLImageAccess(ImageAccess access)
+		{
+			return access == ImageAccess::Read    ? GL_READ_ONLY
+			       : access == ImageAccess::Write ? GL_WRITE_ONLY
+			                                      : GL_READ_WRITE;
+		}
+
+		// Binds the shader and everything it reads and
+		// writes; false for a stale or unlinked shader,
+		// whose dispatch is skipped.
+		bool BindCompute(ComputeShaderHandle handle,
+		                 const Constants& constants,
+		                 const ComputeBindings& bindings,
+		                 ExecuteContext& context)
+		{
+			const auto* shader =
+			    context.resources.GetComputeShader(handle);
+			if (!shader || !shader->IsReady())
+			{
+				return false;
+			}
+			context.state.UseProgram(shader->GetId());
+			BindConstants(constants, context);
+
+			for (uint32_t i = 0; i < bindings.bufferCount; ++i)
+			{
+				const auto& buffer = bindings.buffers[i];
+				if (buffer.size == 0)
+				{
+					glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+					                 buffer.binding,
+					                 buffer.buffer);
+				}
+				else
+				{
+					glBindBufferRange(GL_SHADER_STORAGE_BUFFER,
+					                  buffer.binding,
+					                  buffer.buffer,
+					                  buffer.offset,
+					                  buffer.size);
+				}
+				VEGAM_CHECK_GL_ERROR;
+			}
+			for (uint32_t i = 0; i < bindings.imageCount; ++i)
+			{
+				const auto& image = bindings.images[i];
+				const auto layered =
+				    image.layer == ImageBinding::AllLayers;
+				glBindImageTexture(
+				    image.unit, image.texture,
+				    static_cast<GLint>(image.level),
+				    layered ? GL_TRUE : GL_FALSE,
+				    layered ? 0
+				            : static_cast<GLint>(image.layer),
+				    GetGLImageAccess(image.access),
+				    GetGLImageFormat(image.format));
+				VEGAM_CHECK_GL_ERROR;
+			}
+			return true;
+		}
+
+		inline void IssueBarriers(Barrier barriers)
+		{
+			if (barriers == Barrier::None)
+			{
+				return;
+			}
+			glMemoryBarrier(GetGLBarriers(barriers));
+			VEGAM_CHECK_GL_ERROR;
+		}
+	} // namespace
+
+	uint64_t GetSortKey(const RenderMesh& command)
+	{
+		// Same-mesh draws group by material.
+		return SortKey::Make(0, false,
+		                     command.shader.GetIndex(),
+		                     command.mesh.GetIndex(),
+		                     command.material.GetIndex());
+	}
+
+	uint64_t GetSortKey(const RenderMeshInstanced& command)
+	{
+		// Same-mesh draws group by material.
+		return SortKey::Make(0, false,
+		                     command.shader.GetIndex(),
+		                     command.mesh.GetIndex(),
+		                     command.material.GetIndex());
 	}
 
-	void RenderMesh::Execute()
+	uint64_t GetSortKey(const DrawFoliage& command)
 	{
-		std::shared_ptr<Mesh> mesh = m_mesh.lock();
-		std::shared_ptr<Shader> shader = m_shader.lock();
+		return SortKey::Make(0, false,
+		                     command.shader.GetIndex(),
+		                     command.mesh.GetIndex(),
+		                     command.material.GetIndex());
+	}
+
+	uint64_t GetSortKey(const Dispatch&)
+	{
+		// First in the main viewport; the radix sort keeps
+		// dispatches in submission order.
+		return SortKey::Make(0, false, 0, 0, 0);
+	}
+
+	uint64_t GetSortKey(const DispatchIndirect&)
+	{
+		return SortKey::Make(0, false, 0, 0, 0);
+	}
+
+	void Execute(const RenderMesh& command,
+	             ExecuteContext& context)
+	{
+		const auto shaderHandle =
+		    context.resources.GetMaterialTable().ResolveShader(
+		        command.shader, command.material);
+		auto* mesh = context.resources.GetMesh(command.mesh);
+		auto* shader =
+		    context.resources.GetDrawableShader(shaderHandle);
+		auto& state = context.state;
+
+		if ((mesh && !mesh->IsReady())
+		    || (!shader
+		        && context.resources.IsShaderPending(
+		            shaderHandle))
+		    || IsMaterialPending(command.material, context))
+		{
+			// Still uploading or compiling; it appears in a
+			// later frame.
+			return;
+		}
 
-		if (mesh && shader)
+		if (mesh && shader
+		    && BindMaterial(command.material, context))
 		{
-			mesh->Bind();
-			shader->Bind();
+			state.BindVertexArray(mesh->GetId());
+			state.UseProgram(shader->GetId());
+			BindConstants(command.constants, context);
 
 			if (mesh->GetElementCount() > 0)
 			{
-				glDrawElements(GL_TRIANGLES,
-				               mesh->GetElementCount(),
-				               GL_UNSIGNED_INT, 0);
-				VEGAM_CHECK_GL_ERROR
+				glDrawElementsBaseVertex(
+				    GL_TRIANGLES, mesh->GetElementCount(),
+				    GetGLIndexType(mesh->GetIndexType()),
+				    IndexOffset(*mesh), mesh->GetBaseVertex());
+				VEGAM_CHECK_GL_ERROR;
+				state.CountDraw(mesh->GetElementCount() / 3);
 			}
 			else
 			{
-				glDrawArrays(GL_TRIANGLE_STRIP, 0,
+				glDrawArrays(GL_TRIANGLE_STRIP,
+				             mesh->GetBaseVertex(),
 				             mesh->GetVertexCount());
 				VEGAM_CHECK_GL_ERROR;
-				VEGAM_CHECK_GL_ERROR
+				state.CountDraw(TriangleStripCount(*mesh));
 			}
-
-			shader->Unbind();
-			mesh->Unbind();
+			RecordPipeline(*shader, *mesh, command.material,
+			               false, context);
 		}
 		else
 		{
@@ -48,4 +415,490 @@ namespace AthiVegam::Graphics::RenderCommands
 			           "with invalid data");
 		}
 	}
+
+	void Execute(const RenderMeshInstanced& command,
+	             ExecuteContext& context)
+	{
+		const auto shaderHandle =
+		    context.resources.GetMaterialTable().ResolveShader(
+		        command.shader, command.material);
+		auto* mesh = context.resources.GetMesh(command.mesh);
+		auto* shader =
+		    context.resources.GetDrawableShader(shaderHandle);
+		auto& state = context.state;
+
+		if ((mesh && !mesh->IsReady())
+		    || (!shader
+		        && context.resources.IsShaderPending(
+		            shaderHandle))
+		    || IsMaterialPending(command.material, context))
+		{
+			// Still uploading or compiling; it appears in a
+			// later frame.
+			return;
+		}
+
+		if (!mesh || !shader || command.instanceCount == 0
+		    || !BindMaterial(command.material, context))
+		{
+			VEGAM_WARN("Attempting to execute "
+			           "RenderMeshInstanced with invalid "
+			           "data");
+			return;
+		}
+
+		state.BindVertexArray(mesh->GetId());
+		state.UseProgram(shader->GetId());
+		BindConstants(command.constants, context);
+
+		// GL 4.1 has no base instance, so this draw's slice
+		// of the instance buffer goes into the attribute
+		// pointers.
+		BindInstanceAttributes(context.instanceBuffer,
+		                       context.instanceBase
+		                           + command.firstInstance);
+		state.SetDrawInstance(context.instanceBase
+		                      + command.firstInstance);
+
+		if (mesh->GetElementCount() > 0)
+		{
+			glDrawElementsInstancedBaseVertex(
+			    GL_TRIANGLES, mesh->GetElementCount(),
+			    GetGLIndexType(mesh->GetIndexType()),
+			    IndexOffset(*mesh), command.instanceCount,
+			    mesh->GetBaseVertex());
+			VEGAM_CHECK_GL_ERROR;
+			state.CountDraw(
+			    static_cast<uint64_t>(mesh->GetElementCount() / 3)
+			    * command.instanceCount);
+		}
+		else
+		{
+			glDrawArraysInstanced(
+			    GL_TRIANGLE_STRIP, mesh->GetBaseVertex(),
+			    mesh->GetVertexCount(), command.instanceCount);
+			VEGAM_CHECK_GL_ERROR;
+			state.CountDraw(TriangleStripCount(*mesh)
+			                * command.instanceCount);
+		}
+		RecordPipeline(*shader, *mesh, command.material, true,
+		               context);
+	}
+
+	void Execute(const MultiDrawIndirect& command,
+	             ExecuteContext& context)
+	{
+		auto* shader =
+		    context.resources.GetShader(command.shader);
+		if (!shader || command.drawCount == 0)
+		{
+			return;
+		}
+
+		auto& state = context.state;
+		state.BindVertexArray(command.vao);
+		state.UseProgram(shader->GetId());
+		BindConstants(command.constants, context);
+		SetPipelineState(command.pipelineState, context);
+		BindMaterialConstants(command.materialConstants,
+		                      context);
+		if (command.materials)
+		{
+			const auto& table =
+			    context.resources.GetMaterialTable();
+			if (table.GetMode() == MaterialTable::Mode::Arrays)
+			{
+				state.BindTextureSet(
+				    table.GetSetTextures(command.textureSet));
+			}
+		}
+		// Also for the draw data, found through each draw's
+		// baseInstance.
+		state.SetDrawMaterial(command.firstDraw, true);
+
+		if (command.instanced)
+		{
+			// Instances are addressed through each draw's
+			// baseInstance, so the attributes start at 0.
+			BindInstanceAttributes(context.instanceBuffer, 0);
+		}
+
+		if (command.indexBuffer != 0)
+		{
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+			             command.indexBuffer);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER,
+		             context.indirectBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glMultiDrawElementsIndirect(
+		    GL_TRIANGLES, GetGLIndexType(command.indexType),
+		    reinterpret_cast<const void*>(
+		        static_cast<uintptr_t>(command.firstDraw)
+		        * sizeof(DrawElementsIndirect)),
+		    command.drawCount, 0);
+		VEGAM_CHECK_GL_ERROR;
+		if (command.indexBuffer != 0)
+		{
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+			             command.vaoIndexBuffer);
+			VEGAM_CHECK_GL_ERROR;
+		}
+
+		uint64_t triangles = 0;
+		if (context.indirectDraws)
+		{
+			for (uint32_t i = 0; i < command.drawCount; ++i)
+			{
+				const auto& draw =
+				    context.indirectDraws[command.firstDraw + i];
+				triangles += static_cast<uint64_t>(draw.count / 3)
+				             * draw.instanceCount;
+			}
+		}
+		state.CountDraw(triangles);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Execute(const DrawUi& command, ExecuteContext& context)
+	{
+		auto& state = context.state;
+		state.BindVertexArray(command.vao);
+		state.UseProgram(command.program);
+		state.BindTexture(command.texture);
+		state.SetScissor(command.scissor[0], command.scissor[1],
+		                 command.scissor[2], command.scissor[3]);
+
+		glDrawElementsBaseVertex(
+		    GL_TRIANGLES, command.elementCount,
+		    GetGLIndexType(command.indexType),
+		    reinterpret_cast<const void*>(
+		        static_cast<uintptr_t>(command.indexOffset)),
+		    command.baseVertex);
+		VEGAM_CHECK_GL_ERROR;
+		state.CountDraw(command.elementCount / 3);
+	}
+
+	void Execute(const DrawSprites& command,
+	             ExecuteContext& context)
+	{
+		auto texture = command.defaultTexture;
+		if (!ResolveTexture2D(command.texture, context, texture))
+		{
+			return;
+		}
+
+		auto& state = context.state;
+		PipelineState pipeline;
+		pipeline.blend = command.blend;
+		pipeline.depthTest = false;
+		pipeline.depthWrite = false;
+		state.SetPipelineState(pipeline);
+		state.BindVertexArray(command.vao);
+		state.UseProgram(command.program);
+		state.BindTexture(texture);
+		BindConstants(command.constants, context);
+		BindInstanceAttributes(context.instanceBuffer,
+		                       context.instanceBase
+		                           + command.firstInstance);
+
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4,
+		                      command.instanceCount);
+		VEGAM_CHECK_GL_ERROR;
+		state.CountDraw(static_cast<uint64_t>(2)
+		                * command.instanceCount);
+	}
+
+	void Execute(const DrawParticles& command,
+	             ExecuteContext& context)
+	{
+		auto texture = command.defaultTexture;
+		if (!ResolveTexture2D(command.texture, context, texture))
+		{
+			return;
+		}
+
+		auto& state = context.state;
+		PipelineState pipeline;
+		pipeline.blend = command.blend;
+		pipeline.depthWrite = false;
+		state.SetPipelineState(pipeline);
+		state.BindVertexArray(command.vao);
+		state.UseProgram(command.program);
+		state.BindTexture(texture);
+		BindConstants(command.constants, context);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+		                 ParticleSystem::ParticlesBinding,
+		                 command.particleBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+		                 ParticleSystem::OrderBinding,
+		                 command.orderBuffer);
+		VEGAM_CHECK_GL_ERROR;
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER,
+		             command.argsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glDrawArraysIndirect(
+		    GL_TRIANGLE_STRIP,
+		    reinterpret_cast<const void*>(
+		        static_cast<uintptr_t>(command.argsOffset)));
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		// The count stays on the GPU; no triangles are
+		// counted.
+		state.CountDraw(0);
+	}
+
+	void Execute(const DrawTerrain& command,
+	             ExecuteContext& context)
+	{
+		auto& state = context.state;
+		PipelineState pipeline;
+		pipeline.blend = BlendMode::Opaque;
+		pipeline.cull = CullMode::Back;
+		state.SetPipelineState(pipeline);
+		state.BindVertexArray(command.vao);
+		state.UseProgram(command.program);
+		BindConstants(command.constants, context);
+		glBindBufferBase(GL_UNIFORM_BUFFER,
+		                 Terrain::LevelsBinding,
+		                 command.levelsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glActiveTexture(GL_TEXTURE0 + Terrain::HeightsUnit);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D_ARRAY, command.heights);
+		VEGAM_CHECK_GL_ERROR;
+		glActiveTexture(GL_TEXTURE0 + Terrain::NormalsUnit);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D_ARRAY, command.normals);
+		VEGAM_CHECK_GL_ERROR;
+		glActiveTexture(GL_TEXTURE0);
+		VEGAM_CHECK_GL_ERROR;
+
+		for (uint32_t i = 0; i < command.pieceCount; ++i)
+		{
+			const auto& piece = command.pieces[i];
+			if (piece.instanceCount == 0)
+			{
+				continue;
+			}
+			BindInstanceAttributes(context.instanceBuffer,
+			                       context.instanceBase
+			                           + piece.firstInstance);
+			glDrawElementsInstancedBaseVertex(
+			    GL_TRIANGLES,
+			    static_cast<GLsizei>(piece.indexCount),
+			    GL_UNSIGNED_SHORT,
+			    reinterpret_cast<const void*>(
+			        static_cast<uintptr_t>(piece.firstIndex)
+			        * sizeof(uint16_t)),
+			    static_cast<GLsizei>(piece.instanceCount),
+			    static_cast<GLint>(piece.baseVertex));
+			VEGAM_CHECK_GL_ERROR;
+			state.CountDraw(static_cast<uint64_t>(
+			                    piece.indexCount / 3)
+			                * piece.instanceCount);
+		}
+	}
+
+	void Execute(const DrawImpostors& command,
+	             ExecuteContext& context)
+	{
+		auto& state = context.state;
+		PipelineState pipeline;
+		pipeline.blend = BlendMode::Opaque;
+		state.SetPipelineState(pipeline);
+		state.BindVertexArray(command.vao);
+		state.UseProgram(command.program);
+		BindConstants(command.constants, context);
+		glActiveTexture(GL_TEXTURE0 + Impostors::AlbedoUnit);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D_ARRAY, command.albedo);
+		VEGAM_CHECK_GL_ERROR;
+		glActiveTexture(GL_TEXTURE0
+		                + Impostors::NormalDepthUnit);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D_ARRAY, command.normalDepth);
+		VEGAM_CHECK_GL_ERROR;
+		glActiveTexture(GL_TEXTURE0);
+		VEGAM_CHECK_GL_ERROR;
+		BindInstanceAttributes(context.instanceBuffer,
+		                       context.instanceBase
+		                           + command.firstInstance);
+
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4,
+		                      command.instanceCount);
+		VEGAM_CHECK_GL_ERROR;
+		state.CountDraw(static_cast<uint64_t>(2)
+		                * command.instanceCount);
+	}
+
+	void Execute(const DrawFoliage& command,
+	             ExecuteContext& context)
+	{
+		const auto shaderHandle =
+		    context.resources.GetMaterialTable().ResolveShader(
+		        command.shader, command.material);
+		auto* mesh = context.resources.GetMesh(command.mesh);
+		auto* shader =
+		    context.resources.GetDrawableShader(shaderHandle);
+		if ((mesh && !mesh->IsReady())
+		    || (!shader
+		        && context.resources.IsShaderPending(
+		            shaderHandle))
+		    || IsMaterialPending(command.material, context))
+		{
+			return;
+		}
+		if (!mesh || !shader || mesh->GetElementCount() == 0
+		    || !BindMaterial(command.material, context))
+		{
+			VEGAM_WARN("Attempting to execute DrawFoliage "
+			           "with invalid data");
+			return;
+		}
+
+		auto& state = context.state;
+		state.BindVertexArray(mesh->GetId());
+		state.UseProgram(shader->GetId());
+		BindConstants(command.constants, context);
+		BindInstanceAttributes(command.instanceBuffer,
+		                       command.firstInstance);
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER,
+		             command.argsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glDrawElementsIndirect(
+		    GL_TRIANGLES, GetGLIndexType(mesh->GetIndexType()),
+		    reinterpret_cast<const void*>(
+		        static_cast<uintptr_t>(command.argsOffset)));
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		// The count stays on the GPU.
+		state.CountDraw(0);
+		RecordPipeline(*shader, *mesh, command.material, true,
+		               context);
+	}
+
+	void Execute(const DrawLines& command,
+	             ExecuteContext& context)
+	{
+		auto& state = context.state;
+		PipelineState pipeline;
+		pipeline.blend = BlendMode::Alpha;
+		pipeline.depthTest = command.depthTest;
+		pipeline.depthWrite = false;
+		state.SetPipelineState(pipeline);
+		state.BindVertexArray(command.vao);
+		state.UseProgram(command.program);
+		BindConstants(command.constants, context);
+		BindInstanceAttributes(context.instanceBuffer,
+		                       context.instanceBase
+		                           + command.firstInstance);
+
+		glDrawArraysInstanced(GL_LINES, 0, 2,
+		                      command.instanceCount);
+		VEGAM_CHECK_GL_ERROR;
+		state.CountDraw(0);
+	}
+
+	void Execute(const Dispatch& command,
+	             ExecuteContext& context)
+	{
+		if (!BindCompute(command.shader, command.constants,
+		                 command.bindings, context))
+		{
+			return;
+		}
+		glDispatchCompute(command.groups[0], command.groups[1],
+		                  command.groups[2]);
+		VEGAM_CHECK_GL_ERROR;
+		IssueBarriers(command.barriers);
+	}
+
+	void Execute(const DispatchIndirect& command,
+	             ExecuteContext& context)
+	{
+		if (!BindCompute(command.shader, command.constants,
+		                 command.bindings, context))
+		{
+			return;
+		}
+		glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER,
+		             command.argsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glDispatchComputeIndirect(
+		    static_cast<GLintptr>(command.argsOffset));
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		IssueBarriers(command.barriers);
+	}
+
+	void Execute(CommandType type, const void* command,
+	             ExecuteContext& context)
+	{
+		switch (type)
+		{
+		case CommandType::RenderMesh:
+			Execute(*static_cast<const RenderMesh*>(command),
+			        context);
+			break;
+		case CommandType::RenderMeshInstanced:
+			Execute(*static_cast<const RenderMeshInstanced*>(
+			            command),
+			        context);
+			break;
+		case CommandType::MultiDrawIndirect:
+			Execute(*static_cast<const MultiDrawIndirect*>(
+			            command),
+			        context);
+			break;
+		case CommandType::DrawUi:
+			Execute(*static_cast<const DrawUi*>(command),
+			        context);
+			break;
+		case CommandType::DrawSprites:
+			Execute(*static_cast<const DrawSprites*>(command),
+			        context);
+			break;
+		case CommandType::DrawParticles:
+			Execute(*static_cast<const DrawParticles*>(command),
+			        context);
+			break;
+		case CommandType::DrawTerrain:
+			Execute(*static_cast<const DrawTerrain*>(command),
+			        context);
+			break;
+		case CommandType::DrawImpostors:
+			Execute(*static_cast<const DrawImpostors*>(command),
+			        context);
+			break;
+		case CommandType::DrawFoliage:
+			Execute(*static_cast<const DrawFoliage*>(command),
+			        context);
+			break;
+		case CommandType::DrawLines:
+			Execute(*static_cast<const DrawLines*>(command),
+			        context);
+			break;
+		case CommandType::Dispatch:
+			Execute(*static_cast<const Dispatch*>(command),
+			        context);
+			break;
+		case CommandType::DispatchIndirect:
+			Execute(*static_cast<const DispatchIndirect*>(
+			            command),
+			        context);
+			break;
+		default:
+			VEGAM_ASSERT(false, "Unknown render command");
+			break;
+		}
+	}
 } // namespace AthiVegam::Graphics::RenderCommands
@@ -0,0 +1,316 @@
+#include "AthiVegam/Graphics/RenderState.h"
+
+#include "AthiVegam/Graphics/GLState.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/MaterialTable.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		// Color, then alpha. Weighted OIT adds up color and
+		// weight, and multiplies alpha into the revealage.
+		constexpr GLenum blendFuncs[][4] = {
+		    {GL_ONE, GL_ZERO, GL_ONE, GL_ZERO},
+		    {GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA,
+		     GL_ONE_MINUS_SRC_ALPHA},
+		    {GL_SRC_ALPHA, GL_ONE, GL_SRC_ALPHA, GL_ONE},
+		    {GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+		     GL_ONE_MINUS_SRC_ALPHA},
+		    {GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA}};
+		constexpr GLenum depthFuncs[] = {
+		    GL_LESS, GL_LEQUAL, GL_EQUAL, GL_GREATER,
+		    GL_ALWAYS};
+	} // namespace
+
+	RenderState::RenderState()
+	    : m_vao(Unknown)
+	    , m_constantsBuffer(Unknown)
+	    , m_constantsOffset(Unknown)
+	    , m_constantsSize(Unknown)
+	    , m_materialConstants{Unknown, Unknown, Unknown}
+	    , m_texture(Unknown)
+	    , m_drawMaterial{Unknown, Unknown, Unknown}
+	    , m_scissor{-1, -1, -1, -1}
+	    , m_stateChanges(0)
+	    , m_skippedChanges(0)
+	    , m_drawCalls(0)
+	    , m_triangles(0)
+	{
+		m_textureSet.fill(Unknown);
+	}
+
+	void RenderState::Invalidate()
+	{
+		Shader::InvalidateCurrentProgram();
+		m_vao = Unknown;
+		m_constantsBuffer = Unknown;
+		m_constantsOffset = Unknown;
+		m_constantsSize = Unknown;
+		m_materialConstants[0] = m_materialConstants[1] =
+		    m_materialConstants[2] = Unknown;
+		m_texture = Unknown;
+		m_textureSet.fill(Unknown);
+		m_drawMaterial[0] = m_drawMaterial[1] =
+		    m_drawMaterial[2] = Unknown;
+		m_scissor[0] = m_scissor[1] = m_scissor[2] =
+		    m_scissor[3] = -1;
+	}
+
+	void RenderState::UseProgram(uint32_t program)
+	{
+		// Shaders bind through the same cache, so it is
+		// right even if a program was bound directly.
+		if (Shader::UseProgram(program))
+		{
+			++m_stateChanges;
+		}
+		else
+		{
+			++m_skippedChanges;
+		}
+	}
+
+	void RenderState::BindVertexArray(uint32_t vao)
+	{
+		if (m_vao == vao)
+		{
+			++m_skippedChanges;
+			return;
+		}
+
+		glBindVertexArray(vao);
+		VEGAM_CHECK_GL_ERROR;
+		m_vao = vao;
+		GpuResources::MarkBound(GpuResources::Type::VertexArray,
+		                        vao);
+		++m_stateChanges;
+	}
+
+	void RenderState::BindConstants(uint32_t buffer,
+	                                uint32_t offset,
+	                                uint32_t size)
+	{
+		if (m_constantsBuffer == buffer
+		    && m_constantsOffset == offset
+		    && m_constantsSize == size)
+		{
+			++m_skippedChanges;
+			return;
+		}
+
+		glBindBufferRange(GL_UNIFORM_BUFFER,
+		                  Shader::ConstantsBinding, buffer,
+		                  offset, size);
+		VEGAM_CHECK_GL_ERROR;
+		m_constantsBuffer = buffer;
+		m_constantsOffset = offset;
+		m_constantsSize = size;
+		++m_stateChanges;
+	}
+
+	void RenderState::BindMaterialConstants(uint32_t buffer,
+	                                        uint32_t offset,
+	                                        uint32_t size)
+	{
+		if (m_materialConstants[0] == buffer
+		    && m_materialConstants[1] == offset
+		    && m_materialConstants[2] == size)
+		{
+			++m_skippedChanges;
+			return;
+		}
+
+		glBindBufferRange(GL_UNIFORM_BUFFER,
+		                  Shader::MaterialConstantsBinding,
+		                  buffer, offset, size);
+		VEGAM_CHECK_GL_ERROR;
+		m_materialConstants[0] = buffer;
+		m_materialConstants[1] = offset;
+		m_materialConstants[2] = size;
+		++m_stateChanges;
+	}
+
+	void RenderState::SetDepthPrepass(DepthPrepass pass)
+	{
+		m_depthPrepass = pass;
+		const auto changed =
+		    GLState::SetColorMask(pass != DepthPrepass::Depth);
+		++(changed ? m_stateChanges : m_skippedChanges);
+	}
+
+	void RenderState::SetPipelineState(
+	    const PipelineState& requested)
+	{
+		using Capability = GLState::Capability;
+		// The pre-pass leaves the nearest depth; shading
+		// keeps the fragments at it.
+		auto state = requested;
+		if (m_depthPrepass == DepthPrepass::Shade
+		    && WritesOpaqueDepth(state))
+		{
+			state.depthWrite = false;
+			state.depthFunc = CompareFunc::LessEqual;
+		}
+		if (state.blend == BlendMode::WeightedOit)
+		{
+			state.depthWrite = false;
+		}
+		const auto count = [this](bool changed) {
+			++(changed ? m_stateChanges : m_skippedChanges);
+		};
+
+		const auto blend = static_cast<int>(state.blend);
+		count(GLState::SetEnabled(
+		    Capability::Blend, state.blend != BlendMode::Opaque));
+		if (state.blend != BlendMode::Opaque)
+		{
+			count(GLState::SetBlendFunc(
+			    blendFuncs[blend][0], blendFuncs[blend][1],
+			    blendFuncs[blend][2], blendFuncs[blend][3]));
+		}
+
+		count(GLState::SetEnabled(Capability::DepthTest,
+		                          state.depthTest));
+		count(GLState::SetDepthMask(state.depthWrite));
+		count(GLState::SetDepthFunc(
+		    depthFuncs[static_cast<int>(state.depthFunc)]));
+
+		count(GLState::SetEnabled(Capability::CullFace,
+		                          state.cull != CullMode::None));
+		if (state.cull != CullMode::None)
+		{
+			count(GLState::SetCullFace(
+			    state.cull == CullMode::Back ? GL_BACK
+			                                 : GL_FRONT));
+		}
+	}
+
+	void RenderState::BindTexture(uint32_t texture)
+	{
+		if (m_texture == texture)
+		{
+			++m_skippedChanges;
+			return;
+		}
+
+		glActiveTexture(GL_TEXTURE0);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, texture);
+		VEGAM_CHECK_GL_ERROR;
+		m_texture = texture;
+		GpuResources::MarkBound(GpuResources::Type::Texture,
+		                        texture);
+		++m_stateChanges;
+	}
+
+	void RenderState::BindTextureSet(
+	    std::span<const uint32_t> textures)
+	{
+		static_assert(std::tuple_size_v<decltype(m_textureSet)>
+		              == MaterialTable::MaxTextures);
+		if (textures.size() != m_textureSet.size()
+		    || std::equal(textures.begin(), textures.end(),
+		                  m_textureSet.begin()))
+		{
+			++m_skippedChanges;
+			return;
+		}
+
+		for (uint32_t i = 0; i < m_textureSet.size(); ++i)
+		{
+			if (m_textureSet[i] == textures[i])
+			{
+				continue;
+			}
+			glActiveTexture(GL_TEXTURE0
+			                + MaterialTable::FirstTextureUnit + i);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D_ARRAY, textures[i]);
+			VEGAM_CHECK_GL_ERROR;
+			m_textureSet[i] = textures[i];
+			GpuResources::MarkBound(GpuResources::Type::Texture,
+			                        textures[i]);
+		}
+		glActiveTexture(GL_TEXTURE0);
+		VEGAM_CHECK_GL_ERROR;
+		++m_stateChanges;
+	}
+
+	void RenderState::SetDrawMaterial(uint32_t value,
+	                                  bool indirect)
+	{
+		const uint32_t flag = indirect ? 1 : 0;
+		if (m_drawMaterial[0] == value
+		    && m_drawMaterial[1] == flag)
+		{
+			++m_skippedChanges;
+			return;
+		}
+
+		m_drawMaterial[0] = value;
+		m_drawMaterial[1] = flag;
+		ApplyDrawMaterial();
+	}
+
+	void RenderState::SetDrawInstance(uint32_t firstInstance)
+	{
+		if (m_drawMaterial[1] == 0
+		    && m_drawMaterial[2] == firstInstance)
+		{
+			++m_skippedChanges;
+			return;
+		}
+
+		m_drawMaterial[1] = 0;
+		m_drawMaterial[2] = firstInstance;
+		ApplyDrawMaterial();
+	}
+
+	void RenderState::ApplyDrawMaterial()
+	{
+		// The attribute array is never enabled, so every
+		// vertex reads this current value.
+		glVertexAttribI4ui(
+		    RenderCommands::DrawMaterialLocation,
+		    m_drawMaterial[0],
+		    m_drawMaterial[1],
+		    m_drawMaterial[2] == Unknown ? 0 : m_drawMaterial[2],
+		    0);
+		VEGAM_CHECK_GL_ERROR;
+		++m_stateChanges;
+	}
+
+	void RenderState::SetScissor(int32_t x, int32_t y,
+	                             int32_t width, int32_t height)
+	{
+		if (m_scissor[0] == x && m_scissor[1] == y
+		    && m_scissor[2] == width && m_scissor[3] == height)
+		{
+			++m_skippedChanges;
+			return;
+		}
+
+		glScissor(x, y, width, height);
+		VEGAM_CHECK_GL_ERROR;
+		m_scissor[0] = x;
+		m_scissor[1] = y;
+		m_scissor[2] = width;
+		m_scissor[3] = height;
+		++m_stateChanges;
+	}
+
+	void RenderState::ResetCounters()
+	{
+		m_stateChanges = 0;
+		m_skippedChanges = 0;
+		m_drawCalls = 0;
+		m_triangles = 0;
+	}
+} // namespace AthiVegam::Graphics
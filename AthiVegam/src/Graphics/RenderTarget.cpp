@@ -0,0 +1,158 @@
+#include "AthiVegam/Graphics/RenderTarget.h"
+
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+namespace AthiVegam::Graphics
+{
+	RenderTarget::~RenderTarget() { Destroy(); }
+
+	bool RenderTarget::Create(int width, int height,
+	                          bool sampled)
+	{
+		Destroy();
+		m_width = width;
+		m_height = height;
+		m_sampled = sampled;
+
+		if (sampled)
+		{
+			glGenTextures(1, &m_color);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D, m_color);
+			VEGAM_CHECK_GL_ERROR;
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width,
+			             height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+			             nullptr);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D,
+			                GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D,
+			                GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
+			                GL_CLAMP_TO_EDGE);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
+			                GL_CLAMP_TO_EDGE);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D, 0);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		else
+		{
+			glGenRenderbuffers(1, &m_color);
+			VEGAM_CHECK_GL_ERROR;
+			glBindRenderbuffer(GL_RENDERBUFFER, m_color);
+			VEGAM_CHECK_GL_ERROR;
+			glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8,
+			                      width, height);
+			VEGAM_CHECK_GL_ERROR;
+		}
+
+		glGenRenderbuffers(1, &m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		glBindRenderbuffer(GL_RENDERBUFFER, m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		glRenderbufferStorage(GL_RENDERBUFFER,
+		                      GL_DEPTH24_STENCIL8, width,
+		                      height);
+		VEGAM_CHECK_GL_ERROR;
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		glGenFramebuffers(1, &m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		if (sampled)
+		{
+			glFramebufferTexture2D(GL_FRAMEBUFFER,
+			                       GL_COLOR_ATTACHMENT0,
+			                       GL_TEXTURE_2D, m_color, 0);
+		}
+		else
+		{
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER,
+			                          GL_COLOR_ATTACHMENT0,
+			                          GL_RENDERBUFFER, m_color);
+		}
+		VEGAM_CHECK_GL_ERROR;
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER,
+		                          GL_DEPTH_STENCIL_ATTACHMENT,
+		                          GL_RENDERBUFFER, m_depth);
+		VEGAM_CHECK_GL_ERROR;
+
+		const auto status =
+		    glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		if (status != GL_FRAMEBUFFER_COMPLETE)
+		{
+			VEGAM_ERROR("Render target {}x{} incomplete: {:#x}",
+			            width, height, status);
+			Destroy();
+			return false;
+		}
+
+		// Both formats are 4 bytes per pixel.
+		const auto bytes = static_cast<size_t>(width) * height * 4;
+		GpuResources::Register(GpuResources::Type::Framebuffer,
+		                       m_framebuffer, 0, "Render target");
+		GpuResources::Register(
+		    sampled ? GpuResources::Type::Texture
+		            : GpuResources::Type::Renderbuffer,
+		    m_color, bytes, "Render target color");
+		GpuResources::Register(
+		    GpuResources::Type::Renderbuffer, m_depth, bytes,
+		    "Render target depth");
+		return true;
+	}
+
+	void RenderTarget::Destroy()
+	{
+		if (m_framebuffer != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Framebuffer, m_framebuffer);
+			glDeleteFramebuffers(1, &m_framebuffer);
+			VEGAM_CHECK_GL_ERROR;
+			m_framebuffer = 0;
+		}
+		if (m_color != 0 && m_sampled)
+		{
+			GpuResources::Unregister(GpuResources::Type::Texture,
+			                         m_color);
+			glDeleteTextures(1, &m_color);
+			VEGAM_CHECK_GL_ERROR;
+			m_color = 0;
+		}
+		else if (m_color != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Renderbuffer, m_color);
+			glDeleteRenderbuffers(1, &m_color);
+			VEGAM_CHECK_GL_ERROR;
+			m_color = 0;
+		}
+		if (m_depth != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Renderbuffer, m_depth);
+			glDeleteRenderbuffers(1, &m_depth);
+			VEGAM_CHECK_GL_ERROR;
+			m_depth = 0;
+		}
+	}
+
+	void RenderTarget::Bind() const
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glViewport(0, 0, m_width, m_height);
+		VEGAM_CHECK_GL_ERROR;
+	}
+} // namespace AthiVegam::Graphics
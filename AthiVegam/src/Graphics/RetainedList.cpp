@@ -0,0 +1,71 @@
+#include "AthiVegam/Graphics/RetainedList.h"
+
+namespace AthiVegam::Graphics
+{
+	void RetainedList::Remove(Id id)
+	{
+		if (!Contains(id))
+		{
+			return;
+		}
+		const auto entry = m_entries[id];
+		m_list.EraseEntry(entry);
+		// The last entry moved into the gap.
+		m_ids[entry] = m_ids.back();
+		m_ids.pop_back();
+		if (entry < m_ids.size())
+		{
+			m_entries[m_ids[entry]] = entry;
+		}
+		m_entries[id] = Removed;
+		++m_version;
+	}
+
+	uint32_t RetainedList::PushInstances(
+	    const RenderCommands::InstanceTransform* transforms,
+	    uint32_t count)
+	{
+		++m_version;
+		return m_list.PushInstances(transforms, count);
+	}
+
+	uint32_t RetainedList::PushInstances(
+	    const RenderCommands::InstanceTransform* transforms,
+	    const RenderCommands::DrawData* drawData,
+	    uint32_t count)
+	{
+		++m_version;
+		return m_list.PushInstances(transforms, drawData,
+		                            count);
+	}
+
+	RenderCommands::Constants
+	RetainedList::PushConstants(const void* data,
+	                            uint32_t size)
+	{
+		++m_version;
+		return m_list.PushConstants(data, size);
+	}
+
+	RenderCommands::InstanceTransform*
+	RetainedList::MapInstances(uint32_t first)
+	{
+		++m_version;
+		return m_list.MapInstances(first);
+	}
+
+	void* RetainedList::MapConstants(
+	    RenderCommands::Constants constants)
+	{
+		++m_version;
+		return m_list.MapConstants(constants);
+	}
+
+	void RetainedList::Clear()
+	{
+		m_list.Reset();
+		m_entries.clear();
+		m_ids.clear();
+		++m_version;
+	}
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,201 @@
+#include "AthiVegam/Graphics/RetireQueue.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace AthiVegam::Graphics::RetireQueue
+{
+	namespace
+	{
+		struct Object
+		{
+			Release release;
+			uint64_t object;
+		};
+
+		struct Batch
+		{
+			GLsync fence = nullptr;
+			uint64_t frame = 0;
+			std::vector<Object> objects;
+		};
+
+		std::mutex mutex;
+		// Retired since the last EndFrame().
+		std::vector<Object> retired;
+		size_t pending = 0;
+
+		// GL thread only; oldest first.
+		std::vector<Batch> batches;
+		uint64_t frame = 0;
+
+		void Delete(Batch& batch)
+		{
+			VEGAM_PROFILE_EVENT("GL objects deleted", "{}",
+			                    batch.objects.size());
+			for (const auto& object : batch.objects)
+			{
+				object.release(object.object);
+			}
+			if (batch.fence)
+			{
+				glDeleteSync(batch.fence);
+				VEGAM_CHECK_GL_ERROR;
+			}
+			std::lock_guard lock(mutex);
+			pending -= batch.objects.size();
+		}
+
+		bool IsSignalled(GLsync fence)
+		{
+			const auto status = glClientWaitSync(fence, 0, 0);
+			return status == GL_ALREADY_SIGNALED
+			       || status == GL_CONDITION_SATISFIED;
+		}
+	} // namespace
+
+	void Retire(Release release, uint64_t object)
+	{
+		std::lock_guard lock(mutex);
+		retired.push_back({release, object});
+		++pending;
+	}
+
+	void RetireBuffer(uint32_t buffer)
+	{
+		Retire(
+		    [](uint64_t object) {
+			    const auto id = static_cast<GLuint>(object);
+			    glDeleteBuffers(1, &id);
+			    VEGAM_CHECK_GL_ERROR;
+		    },
+		    buffer);
+	}
+
+	void RetireVertexArray(uint32_t vao)
+	{
+		Retire(
+		    [](uint64_t object) {
+			    const auto id = static_cast<GLuint>(object);
+			    glDeleteVertexArrays(1, &id);
+			    VEGAM_CHECK_GL_ERROR;
+		    },
+		    vao);
+	}
+
+	void RetireTexture(uint32_t texture)
+	{
+		Retire(
+		    [](uint64_t object) {
+			    const auto id = static_cast<GLuint>(object);
+			    glDeleteTextures(1, &id);
+			    VEGAM_CHECK_GL_ERROR;
+		    },
+		    texture);
+	}
+
+	void RetireProgram(uint32_t program)
+	{
+		Retire(
+		    [](uint64_t object) {
+			    const auto id = static_cast<GLuint>(object);
+			    // A deleted program stays alive while current
+			    // and its id may be reused, so never leave it
+			    // bound.
+			    if (Shader::GetCurrentProgram() == id)
+			    {
+				    Shader::UseProgram(0);
+			    }
+			    glDeleteProgram(id);
+			    VEGAM_CHECK_GL_ERROR;
+		    },
+		    program);
+	}
+
+	void RetireShader(uint32_t shader)
+	{
+		Retire(
+		    [](uint64_t object) {
+			    glDeleteShader(static_cast<GLuint>(object));
+			    VEGAM_CHECK_GL_ERROR;
+		    },
+		    shader);
+	}
+
+	void RetireSync(void* sync)
+	{
+		Retire(
+		    [](uint64_t object) {
+			    glDeleteSync(reinterpret_cast<GLsync>(object));
+			    VEGAM_CHECK_GL_ERROR;
+		    },
+		    reinterpret_cast<uint64_t>(sync));
+	}
+
+	void EndFrame()
+	{
+		VEGAM_PROFILE_SCOPE("RetireQueue::EndFrame");
+		++frame;
+
+		size_t deleted = 0;
+		for (; deleted < batches.size(); ++deleted)
+		{
+			auto& batch = batches[deleted];
+			if (frame - batch.frame < RetireFrames
+			    || !IsSignalled(batch.fence))
+			{
+				break;
+			}
+			Delete(batch);
+		}
+		batches.erase(batches.begin(),
+		              batches.begin() + deleted);
+
+		Batch batch;
+		{
+			std::lock_guard lock(mutex);
+			if (retired.empty())
+			{
+				return;
+			}
+			batch.objects.swap(retired);
+		}
+		batch.fence =
+		    glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		VEGAM_CHECK_GL_ERROR;
+		batch.frame = frame;
+		batches.push_back(std::move(batch));
+	}
+
+	void Flush()
+	{
+		VEGAM_PROFILE_SCOPE("RetireQueue::Flush");
+		glFinish();
+		VEGAM_CHECK_GL_ERROR;
+		for (auto& batch : batches)
+		{
+			Delete(batch);
+		}
+		batches.clear();
+
+		Batch batch;
+		{
+			std::lock_guard lock(mutex);
+			batch.objects.swap(retired);
+		}
+		Delete(batch);
+	}
+
+	size_t GetPendingCount()
+	{
+		std::lock_guard lock(mutex);
+		return pending;
+	}
+} // namespace AthiVegam::Graphics::RetireQueue
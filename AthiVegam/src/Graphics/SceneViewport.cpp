@@ -0,0 +1,124 @@
+#include "AthiVegam/Graphics/SceneViewport.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Log.h"
+#include "external/imgui/imgui.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace AthiVegam::Graphics
+{
+	void SceneViewport::Destroy()
+	{
+		m_target.Destroy();
+		m_invalidated = true;
+	}
+
+	bool SceneViewport::BeginScene()
+	{
+		if (!m_visible || m_pixelWidth <= 0
+		    || m_pixelHeight <= 0)
+		{
+			return false;
+		}
+
+		const auto now = std::chrono::steady_clock::now();
+		const bool resized = m_pixelWidth != m_target.GetWidth()
+		                     || m_pixelHeight
+		                            != m_target.GetHeight();
+		const auto interval =
+		    std::chrono::duration<float>(
+		        1.0f / std::max(m_settings.idleRate, 0.01f));
+		if (!resized && !m_focused && !m_animating
+		    && !m_invalidated && now - m_lastRender < interval)
+		{
+			return false;
+		}
+		VEGAM_PROFILE_SCOPE("SceneViewport::BeginScene");
+
+		if (resized
+		    && !m_target.Create(m_pixelWidth, m_pixelHeight,
+		                        true))
+		{
+			VEGAM_ERROR("Cannot create a {}x{} viewport",
+			            m_pixelWidth, m_pixelHeight);
+			m_visible = false;
+			return false;
+		}
+		m_invalidated = false;
+		m_lastRender = now;
+
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING,
+		              &m_previousFramebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glGetIntegerv(GL_VIEWPORT, m_previousViewport);
+		VEGAM_CHECK_GL_ERROR;
+		m_target.Bind();
+		return true;
+	}
+
+	void SceneViewport::EndScene()
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER,
+		                  static_cast<GLuint>(
+		                      m_previousFramebuffer));
+		VEGAM_CHECK_GL_ERROR;
+		glViewport(m_previousViewport[0], m_previousViewport[1],
+		           m_previousViewport[2], m_previousViewport[3]);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void SceneViewport::DrawWindow(const char* title)
+	{
+		ImGui::SetNextWindowSize(ImVec2(640.0f, 360.0f),
+		                         ImGuiCond_FirstUseEver);
+		ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding,
+		                    ImVec2(0.0f, 0.0f));
+		m_visible = ImGui::Begin(title);
+		ImGui::PopStyleVar();
+		m_focused = m_visible && ImGui::IsWindowFocused();
+		m_hovered = m_visible && ImGui::IsWindowHovered();
+		if (m_visible)
+		{
+			const auto position = ImGui::GetCursorScreenPos();
+			const auto size = ImGui::GetContentRegionAvail();
+			const auto scale =
+			    ImGui::GetIO().DisplayFramebufferScale;
+			m_imageX = position.x;
+			m_imageY = position.y;
+			m_imageWidth = std::max(size.x, 0.0f);
+			m_imageHeight = std::max(size.y, 0.0f);
+			m_pixelWidth = static_cast<int>(
+			    std::lround(m_imageWidth * scale.x));
+			m_pixelHeight = static_cast<int>(
+			    std::lround(m_imageHeight * scale.y));
+
+			// GL images start at the bottom.
+			if (const auto texture = m_target.GetColorTexture())
+			{
+				ImGui::Image(reinterpret_cast<ImTextureID>(
+				                 static_cast<intptr_t>(texture)),
+				             ImVec2(m_imageWidth, m_imageHeight),
+				             ImVec2(0.0f, 1.0f),
+				             ImVec2(1.0f, 0.0f));
+			}
+		}
+		ImGui::End();
+	}
+
+	bool SceneViewport::MapToImage(float x, float y, float& u,
+	                               float& v) const
+	{
+		if (!m_visible || m_imageWidth <= 0.0f
+		    || m_imageHeight <= 0.0f)
+		{
+			return false;
+		}
+		u = (x - m_imageX) / m_imageWidth;
+		v = (y - m_imageY) / m_imageHeight;
+		return u >= 0.0f && u < 1.0f && v >= 0.0f && v < 1.0f;
+	}
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,230 @@
+#include "AthiVegam/Graphics/ScreenCapture.h"
+
+#include "AthiVegam/Assets/ImageWriter.h"
+#include "AthiVegam/Core/CpuTopology.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		const char* GetExtension(ScreenCapture::Format format)
+		{
+			return format == ScreenCapture::Format::Exr ? ".exr"
+			                                            : ".png";
+		}
+	} // namespace
+
+	ScreenCapture::~ScreenCapture() { Shutdown(); }
+
+	void ScreenCapture::Request(std::string path,
+	                            Format format)
+	{
+		std::lock_guard lock(m_requestMutex);
+		m_requests.push_back({std::move(path), format, 0});
+	}
+
+	void ScreenCapture::RequestSequence(std::string directory,
+	                                    uint32_t count,
+	                                    Format format)
+	{
+		std::lock_guard lock(m_requestMutex);
+		m_sequenceDirectory = std::move(directory);
+		m_sequenceRemaining = count;
+		m_sequenceIndex = 0;
+		m_sequenceFormat = format;
+	}
+
+	bool ScreenCapture::IsPending() const
+	{
+		std::lock_guard lock(m_requestMutex);
+		return !m_requests.empty() || m_sequenceRemaining > 0;
+	}
+
+	bool ScreenCapture::Claim(uint64_t frame)
+	{
+		std::lock_guard lock(m_requestMutex);
+		if (m_requests.empty() && m_sequenceRemaining == 0)
+		{
+			return false;
+		}
+		for (auto& request : m_requests)
+		{
+			request.frame = frame;
+			m_claimed.push_back(std::move(request));
+		}
+		m_requests.clear();
+		if (m_sequenceRemaining > 0)
+		{
+			char name[32];
+			std::snprintf(name, sizeof(name), "frame_%06u%s",
+			              m_sequenceIndex,
+			              GetExtension(m_sequenceFormat));
+			m_claimed.push_back(
+			    {(std::filesystem::path(m_sequenceDirectory)
+			      / name)
+			         .string(),
+			     m_sequenceFormat, frame});
+			++m_sequenceIndex;
+			--m_sequenceRemaining;
+		}
+		return true;
+	}
+
+	void ScreenCapture::Deliver(const uint8_t* pixels,
+	                            int width, int height,
+	                            uint64_t frame)
+	{
+		// Captures are delivered in order, so the claimed
+		// frames are at the front; older ones were lost.
+		const auto end = std::find_if(
+		    m_claimed.begin(), m_claimed.end(),
+		    [frame](const Target& target) {
+			    return target.frame > frame;
+		    });
+		std::vector<Target> targets;
+		for (auto it = m_claimed.begin(); it != end; ++it)
+		{
+			if (it->frame == frame)
+			{
+				targets.push_back(std::move(*it));
+			}
+			else
+			{
+				VEGAM_WARN("Screen capture of frame {} to {} "
+				           "was not read back",
+				           it->frame, it->path);
+			}
+		}
+		m_claimed.erase(m_claimed.begin(), end);
+		if (targets.empty() || !pixels)
+		{
+			return;
+		}
+
+		VEGAM_PROFILE_SCOPE("ScreenCapture::Deliver");
+		std::unique_lock lock(m_mutex);
+		if (!m_thread.joinable())
+		{
+			m_stop = false;
+			m_thread = std::thread([this] { Run(); });
+		}
+		m_drained.wait(lock, [this] {
+			return !m_queue.Full();
+		});
+
+		m_queue.Push({});
+		auto& pending = m_queue.Back();
+		if (!m_spare.empty())
+		{
+			pending.pixels = std::move(m_spare.back());
+			m_spare.pop_back();
+		}
+		const auto size = static_cast<size_t>(width) * height * 4;
+		pending.pixels.resize(size);
+		std::memcpy(pending.pixels.data(), pixels, size);
+		pending.width = width;
+		pending.height = height;
+		pending.targets = std::move(targets);
+		lock.unlock();
+		m_condition.notify_one();
+	}
+
+	void ScreenCapture::Flush()
+	{
+		std::unique_lock lock(m_mutex);
+		m_drained.wait(lock, [this] {
+			return m_queue.Empty() && !m_writing;
+		});
+	}
+
+	void ScreenCapture::Shutdown()
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_stop = true;
+		}
+		m_condition.notify_one();
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+		m_spare.clear();
+		m_claimed.clear();
+	}
+
+	void ScreenCapture::Run()
+	{
+		Core::SetThreadClass(Core::ThreadClass::Background);
+		std::unique_lock lock(m_mutex);
+		while (true)
+		{
+			m_condition.wait(lock, [this] {
+				return m_stop || !m_queue.Empty();
+			});
+			if (m_queue.Empty())
+			{
+				return;
+			}
+
+			auto pending = std::move(m_queue.Front());
+			m_queue.Pop();
+			m_writing = true;
+			lock.unlock();
+			Write(pending);
+			lock.lock();
+			m_writing = false;
+			m_spare.push_back(std::move(pending.pixels));
+			m_drained.notify_all();
+		}
+	}
+
+	void ScreenCapture::Write(const Pending& pending)
+	{
+		VEGAM_PROFILE_SCOPE("ScreenCapture::Write");
+		const Assets::ImageWriter::Image image{
+		    pending.pixels.data(),
+		    static_cast<uint32_t>(pending.width),
+		    static_cast<uint32_t>(pending.height), true};
+		std::vector<uint8_t> encoded[2];
+		for (const auto& target : pending.targets)
+		{
+			auto& data = encoded[static_cast<int>(target.format)];
+			if (data.empty())
+			{
+				using namespace Assets::ImageWriter;
+				data = target.format == Format::Exr
+				           ? EncodeExr(image)
+				           : EncodePng(image);
+			}
+
+			std::error_code error;
+			const std::filesystem::path path(target.path);
+			if (path.has_parent_path())
+			{
+				std::filesystem::create_directories(
+				    path.parent_path(), error);
+			}
+			std::ofstream file(path, std::ios::binary);
+			file.write(reinterpret_cast<const char*>(data.data()),
+			           static_cast<std::streamsize>(data.size()));
+			if (!file)
+			{
+				VEGAM_ERROR("Could not write screen capture {}",
+				            target.path);
+				continue;
+			}
+			m_written.fetch_add(1, std::memory_order_relaxed);
+			VEGAM_INFO("Wrote screen capture {} ({}x{})",
+			           target.path, pending.width,
+			           pending.height);
+		}
+	}
+} // namespace AthiVegam::Graphics
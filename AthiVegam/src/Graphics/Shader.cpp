@@ -1,220 +1,688 @@
 #include "AthiVegam/Graphics/Shader.h"
 
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Core/Serialize.h"
+#include "AthiVegam/Graphics/GpuResources.h"
 #include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/ProgramBinaryCache.h"
+#include "AthiVegam/Graphics/RetireQueue.h"
 #include "AthiVegam/Log.h"
 #include "glad/glad.h"
 
+#include <atomic>
+#include <string_view>
+#include <utility>
+
 namespace AthiVegam::Graphics
 {
-	Shader::Shader(const std::string& vertex,
-	               const std::string& fragment)
+	namespace
 	{
-		auto status = GL_FALSE;
-		;
-		char errorLog[512];
+		constexpr uint32_t UnknownProgram = 0xFFFFFFFF;
+		// Only the thread owning the GL context binds.
+		uint32_t currentProgram = UnknownProgram;
+		// Setters may run wherever the context is current.
+		std::atomic<uint32_t> uniformUploads{0};
 
-		m_programId = glCreateProgram();
-		VEGAM_CHECK_GL_ERROR;
+		inline void CountUniformUpload()
+		{
+			uniformUploads.fetch_add(1,
+			                         std::memory_order_relaxed);
+		}
+	} // namespace
 
-		auto vertexShaderId =
-		    glCreateShader(GL_VERTEX_SHADER);
-		VEGAM_CHECK_GL_ERROR;
-		auto fragmentShaderId =
-		    glCreateShader(GL_FRAGMENT_SHADER);
-		VEGAM_CHECK_GL_ERROR;
+	namespace
+	{
+		// From GL_KHR_parallel_shader_compile, which glad
+		// was not generated with.
+		constexpr GLenum CompletionStatus = 0x91B1;
 
-		// Vertex Shader
+		bool HasParallelCompile()
 		{
-			auto glSource = vertex.c_str();
-			glShaderSource(vertexShaderId, 1, &glSource,
-			               NULL);
+			GLint count = 0;
+			glGetIntegerv(GL_NUM_EXTENSIONS, &count);
 			VEGAM_CHECK_GL_ERROR;
-			glCompileShader(vertexShaderId);
-			VEGAM_CHECK_GL_ERROR;
-			glGetShaderiv(vertexShaderId, GL_COMPILE_STATUS,
-			              &status);
-			VEGAM_CHECK_GL_ERROR;
-			if (status != GL_TRUE)
+			for (GLint i = 0; i < count; ++i)
 			{
-				glGetShaderInfoLog(vertexShaderId,
-				                   sizeof(errorLog), NULL,
-				                   errorLog);
-				VEGAM_ERROR(
-				    "Vertex Shader compilation error: {}",
-				    errorLog);
-			}
-			else
-			{
-				glAttachShader(m_programId, vertexShaderId);
+				const auto* name =
+				    reinterpret_cast<const char*>(
+				        glGetStringi(GL_EXTENSIONS, i));
 				VEGAM_CHECK_GL_ERROR;
+				const std::string_view extension(name);
+				if (extension
+				        == "GL_KHR_parallel_shader_compile"
+				    || extension
+				           == "GL_ARB_parallel_shader_compile")
+				{
+					return true;
+				}
 			}
+			return false;
 		}
 
-		// Fragment Shader
-		if (status == GL_TRUE)
+		// Logs a failed compile; returns true on success.
+		bool CheckCompile(uint32_t shader, const char* stage)
 		{
-			auto glSource = fragment.c_str();
-			glShaderSource(fragmentShaderId, 1, &glSource,
-			               NULL);
-			VEGAM_CHECK_GL_ERROR;
-			glCompileShader(fragmentShaderId);
-			VEGAM_CHECK_GL_ERROR;
-			glGetShaderiv(fragmentShaderId,
-			              GL_COMPILE_STATUS, &status);
+			auto status = GL_FALSE;
+			glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
 			VEGAM_CHECK_GL_ERROR;
 			if (status != GL_TRUE)
 			{
-				glGetShaderInfoLog(fragmentShaderId,
-				                   sizeof(errorLog), NULL,
-				                   errorLog);
+				char errorLog[512];
+				glGetShaderInfoLog(shader, sizeof(errorLog),
+				                   NULL, errorLog);
 				VEGAM_CHECK_GL_ERROR;
-				VEGAM_ERROR(
-				    "Fragment Shader compilation error: {}",
-				    errorLog);
+				VEGAM_ERROR("{} Shader compilation error: {}",
+				            stage, errorLog);
 			}
-			else
+			return status == GL_TRUE;
+		}
+
+		// Of the reflection kept with program binaries.
+		constexpr uint32_t ReflectionVersion = 1;
+
+		// FNV-1a of both stages, stable across runs.
+		uint64_t HashSources(const std::string& vertex,
+		                     const std::string& fragment)
+		{
+			auto hash = 14695981039346656037ull;
+			const auto mix = [&](std::string_view data) {
+				for (auto c : data)
+				{
+					hash ^= static_cast<uint8_t>(c);
+					hash *= 1099511628211ull;
+				}
+			};
+			mix(vertex);
+			mix(std::string_view("\0", 1));
+			mix(fragment);
+			return hash;
+		}
+
+		// The driver's binary as a stand-in for the
+		// program's GPU footprint.
+		void TrackProgramSize(uint32_t program)
+		{
+#ifndef AV_CONFIG_SHIPPING
+			GLint length = 0;
+			glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH,
+			               &length);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Resize(GpuResources::Type::Program,
+			                     program,
+			                     static_cast<size_t>(length));
+#endif // AV_CONFIG_SHIPPING
+		}
+	} // namespace
+
+	Shader::Shader(const std::string& vertex,
+	               const std::string& fragment)
+	    : Shader(vertex, fragment, CompileMode::Blocking)
+	{
+	}
+
+	Shader::Shader(const std::string& vertex,
+	               const std::string& fragment,
+	               CompileMode mode)
+	    : m_vertexShaderId(0)
+	    , m_fragmentShaderId(0)
+	    , m_ready(false)
+	    , m_sourceHash(HashSources(vertex, fragment))
+#ifndef AV_CONFIG_SHIPPING
+	    , m_vertexSource(vertex)
+	    , m_fragmentSource(fragment)
+#endif // AV_CONFIG_SHIPPING
+	{
+		m_programId = glCreateProgram();
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::Program,
+		                       GetId(), 0, "Shader");
+
+		std::vector<uint8_t> metadata;
+		if (ProgramBinaryCache::Load(GetId(), vertex,
+		                             fragment, metadata))
+		{
+			uint32_t version = 0;
+			if (!Core::Serial::Load(metadata.data(),
+			                        metadata.size(), m_reflection,
+			                        &version)
+			    || version != ReflectionVersion)
 			{
-				glAttachShader(m_programId,
-				               fragmentShaderId);
-				VEGAM_CHECK_GL_ERROR;
+				m_reflection = ShaderReflection::Reflect(GetId());
 			}
+			ApplyReflection();
+			TrackProgramSize(GetId());
+			m_ready = true;
+			return;
+		}
+
+		VEGAM_PROFILE_EVENT(
+		    "Shader compile", "{:016x}{}", m_sourceHash,
+		    mode == CompileMode::Blocking ? " (blocking)" : "");
+		BeginCompile(vertex, fragment);
+		if (mode == CompileMode::Blocking)
+		{
+			FinishCompile(vertex, fragment);
 		}
+		else
+		{
+			// Kept for the binary cache once linked.
+			m_pending = std::make_unique<PendingSources>(
+			    PendingSources{vertex, fragment});
+		}
+	}
+
+	bool Shader::IsParallelCompileSupported()
+	{
+		static const bool supported = HasParallelCompile();
+		return supported;
+	}
+
+	void Shader::Swap(Shader& other)
+	{
+		std::swap(m_programId, other.m_programId);
+		std::swap(m_vertexShaderId, other.m_vertexShaderId);
+		std::swap(m_fragmentShaderId,
+		          other.m_fragmentShaderId);
+		std::swap(m_pending, other.m_pending);
+		std::swap(m_ready, other.m_ready);
+		std::swap(m_uniformLocations, other.m_uniformLocations);
+		std::swap(m_sourceHash, other.m_sourceHash);
+		std::swap(m_reflection, other.m_reflection);
+#ifndef AV_CONFIG_SHIPPING
+		std::swap(m_vertexSource, other.m_vertexSource);
+		std::swap(m_fragmentSource, other.m_fragmentSource);
+#endif // AV_CONFIG_SHIPPING
+		std::swap(m_layoutWarned, other.m_layoutWarned);
+	}
+
+	bool Shader::Poll()
+	{
+		if (!m_pending)
+		{
+			return true;
+		}
+
+		if (IsParallelCompileSupported())
+		{
+			GLint complete = GL_FALSE;
+			glGetProgramiv(m_programId, CompletionStatus,
+			               &complete);
+			VEGAM_CHECK_GL_ERROR;
+			if (complete != GL_TRUE)
+			{
+				return false;
+			}
+		}
+
+		FinishCompile(m_pending->vertex, m_pending->fragment);
+		m_pending.reset();
+		return true;
+	}
+
+	// Issues both compiles and the link without querying any
+	// status, so the driver can work on them in the
+	// background.
+	void Shader::BeginCompile(const std::string& vertex,
+	                          const std::string& fragment)
+	{
+		m_vertexShaderId = glCreateShader(GL_VERTEX_SHADER);
+		VEGAM_CHECK_GL_ERROR;
+		m_fragmentShaderId =
+		    glCreateShader(GL_FRAGMENT_SHADER);
+		VEGAM_CHECK_GL_ERROR;
+
+		const auto* vertexSource = vertex.c_str();
+		glShaderSource(m_vertexShaderId, 1, &vertexSource,
+		               NULL);
+		VEGAM_CHECK_GL_ERROR;
+		glCompileShader(m_vertexShaderId);
+		VEGAM_CHECK_GL_ERROR;
+
+		const auto* fragmentSource = fragment.c_str();
+		glShaderSource(m_fragmentShaderId, 1,
+		               &fragmentSource, NULL);
+		VEGAM_CHECK_GL_ERROR;
+		glCompileShader(m_fragmentShaderId);
+		VEGAM_CHECK_GL_ERROR;
+
+		glAttachShader(m_programId, m_vertexShaderId);
+		VEGAM_CHECK_GL_ERROR;
+		glAttachShader(m_programId, m_fragmentShaderId);
+		VEGAM_CHECK_GL_ERROR;
+
+		if (ProgramBinaryCache::IsEnabled())
+		{
+			glProgramParameteri(
+			    m_programId,
+			    GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glLinkProgram(m_programId);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Shader::FinishCompile(const std::string& vertex,
+	                           const std::string& fragment)
+	{
+		auto status =
+		    CheckCompile(m_vertexShaderId, "Vertex")
+		            && CheckCompile(m_fragmentShaderId,
+		                            "Fragment")
+		        ? GL_TRUE
+		        : GL_FALSE;
 
 		VEGAM_ASSERT(status == GL_TRUE,
 		             "Error Compiling Shader");
 
 		if (status == GL_TRUE)
 		{
-			glLinkProgram(m_programId);
-			VEGAM_CHECK_GL_ERROR;
-			glValidateProgram(m_programId);
-			VEGAM_CHECK_GL_ERROR;
 			glGetProgramiv(m_programId, GL_LINK_STATUS,
 			               &status);
 			VEGAM_CHECK_GL_ERROR;
 			if (status != GL_TRUE)
 			{
+				char errorLog[512];
 				glGetProgramInfoLog(m_programId,
 				                    sizeof(errorLog), NULL,
 				                    errorLog);
 				VEGAM_CHECK_GL_ERROR;
 				VEGAM_ERROR("Shader link error: {}",
 				            errorLog);
-				glDeleteProgram(m_programId);
-				VEGAM_CHECK_GL_ERROR;
-				m_programId = -1;
 			}
 		}
 
-		glDeleteShader(vertexShaderId);
+		if (status == GL_TRUE)
+		{
+#ifdef AV_CONFIG_DEBUG
+			glValidateProgram(m_programId);
+			VEGAM_CHECK_GL_ERROR;
+#endif // AV_CONFIG_DEBUG
+			m_reflection = ShaderReflection::Reflect(GetId());
+			if (ProgramBinaryCache::IsEnabled())
+			{
+				std::vector<uint8_t> metadata;
+				Core::Serial::Save(m_reflection, metadata,
+				                   ReflectionVersion);
+				ProgramBinaryCache::Store(GetId(), vertex,
+				                          fragment, metadata);
+			}
+			ApplyReflection();
+			TrackProgramSize(GetId());
+			m_ready = true;
+		}
+		else
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Program, GetId());
+			glDeleteProgram(m_programId);
+			VEGAM_CHECK_GL_ERROR;
+			m_programId = -1;
+		}
+
+		glDeleteShader(m_vertexShaderId);
 		VEGAM_CHECK_GL_ERROR;
-		glDeleteShader(fragmentShaderId);
+		glDeleteShader(m_fragmentShaderId);
 		VEGAM_CHECK_GL_ERROR;
+		m_vertexShaderId = 0;
+		m_fragmentShaderId = 0;
 	}
 
 	Shader::~Shader()
 	{
-		Bind();
-		glDeleteProgram(m_programId);
-		// VEGAM_CHECK_GL_ERROR;
-		Unbind();
+		if (m_pending)
+		{
+			RetireQueue::RetireShader(m_vertexShaderId);
+			RetireQueue::RetireShader(m_fragmentShaderId);
+		}
+		if (m_programId > 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Program, GetId());
+			RetireQueue::RetireProgram(GetId());
+		}
 	}
 
-	void Shader::Bind()
+	void Shader::Bind() { UseProgram(GetId()); }
+
+	void Shader::Unbind() { UseProgram(0); }
+
+	bool Shader::UseProgram(uint32_t program)
 	{
-		glUseProgram(m_programId);
+		if (currentProgram == program)
+		{
+			return false;
+		}
+
+		glUseProgram(program);
 		VEGAM_CHECK_GL_ERROR;
+		currentProgram = program;
+		GpuResources::MarkBound(GpuResources::Type::Program,
+		                        program);
+		return true;
 	}
 
-	void Shader::Unbind()
+	uint32_t Shader::GetCurrentProgram()
 	{
-		glUseProgram(0);
-		VEGAM_CHECK_GL_ERROR;
+		return currentProgram;
 	}
 
-	void Shader::SetUniformInt(const std::string& name,
+	void Shader::InvalidateCurrentProgram()
+	{
+		currentProgram = UnknownProgram;
+	}
+
+	uint32_t Shader::TakeUniformUploads()
+	{
+		return uniformUploads.exchange(
+		    0, std::memory_order_relaxed);
+	}
+
+	void Shader::SetUniformInt(UniformName name,
 	                           int val)
 	{
-		Bind();
-		glUniform1i(GetUniformLocation(name), val);
+		CountUniformUpload();
+		glProgramUniform1i(m_programId,
+		                   GetUniformLocation(name), val);
 		VEGAM_CHECK_GL_ERROR;
 	}
 
-	void Shader::SetUniformInt2(const std::string& name,
+	void Shader::SetUniformInt2(UniformName name,
 	                            int val1, int val2)
 	{
-		Bind();
-		glUniform2i(GetUniformLocation(name), val1, val2);
+		CountUniformUpload();
+		glProgramUniform2i(m_programId,
+		                   GetUniformLocation(name), val1,
+		                   val2);
 		VEGAM_CHECK_GL_ERROR;
 	}
 
-	void Shader::SetUniformInt3(const std::string& name,
+	void Shader::SetUniformInt3(UniformName name,
 	                            int val1, int val2,
 	                            int val3)
 	{
-		Bind();
-		glUniform3i(GetUniformLocation(name), val1, val2,
-		            val3);
+		CountUniformUpload();
+		glProgramUniform3i(m_programId,
+		                   GetUniformLocation(name), val1,
+		                   val2, val3);
 		VEGAM_CHECK_GL_ERROR;
 	}
 
-	void Shader::SetUniformInt4(const std::string& name,
+	void Shader::SetUniformInt4(UniformName name,
 	                            int val1, int val2,
 	                            int val3, int val4)
 	{
-		Bind();
-		glUniform4i(GetUniformLocation(name), val1, val2,
-		            val3, val4);
+		CountUniformUpload();
+		glProgramUniform4i(m_programId,
+		                   GetUniformLocation(name), val1,
+		                   val2, val3, val4);
 		VEGAM_CHECK_GL_ERROR;
 	}
 
-	void Shader::SetUniformFloat(const std::string& name,
+	void Shader::SetUniformFloat(UniformName name,
 	                             float val)
 	{
-		Bind();
-		glUniform1f(GetUniformLocation(name), val);
+		CountUniformUpload();
+		glProgramUniform1f(m_programId,
+		                   GetUniformLocation(name), val);
 		VEGAM_CHECK_GL_ERROR;
 	}
 
-	void Shader::SetUniformFloat2(const std::string& name,
+	void Shader::SetUniformFloat2(UniformName name,
 	                              float val1, float val2)
 	{
-		Bind();
-		glUniform2f(GetUniformLocation(name), val1, val2);
+		CountUniformUpload();
+		glProgramUniform2f(m_programId,
+		                   GetUniformLocation(name), val1,
+		                   val2);
 		VEGAM_CHECK_GL_ERROR;
 	}
 
-	void Shader::SetUniformFloat3(const std::string& name,
+	void Shader::SetUniformFloat3(UniformName name,
 	                              float val1, float val2,
 	                              float val3)
 	{
-		Bind();
-		glUniform3f(GetUniformLocation(name), val1, val2,
-		            val3);
+		CountUniformUpload();
+		glProgramUniform3f(m_programId,
+		                   GetUniformLocation(name), val1,
+		                   val2, val3);
 		VEGAM_CHECK_GL_ERROR;
 	}
 
-	void Shader::SetUniformFloat4(const std::string& name,
+	void Shader::SetUniformFloat4(UniformName name,
 	                              float val1, float val2,
 	                              float val3, float val4)
 	{
-		Bind();
-		glUniform4f(GetUniformLocation(name), val1, val2,
-		            val3, val4);
+		CountUniformUpload();
+		glProgramUniform4f(m_programId,
+		                   GetUniformLocation(name), val1,
+		                   val2, val3, val4);
 		VEGAM_CHECK_GL_ERROR;
 	}
 
-	int Shader::GetUniformLocation(const std::string& name)
+	void Shader::SetUniformFloat3(UniformName name,
+	                              const Math::Vec3& value)
 	{
-		auto it = m_uniformLocations.find(name);
+		SetUniformFloat3(name, value.x, value.y, value.z);
+	}
 
-		if (it == m_uniformLocations.end())
+	void Shader::SetUniformFloat4(UniformName name,
+	                              const Math::Vec4& value)
+	{
+		CountUniformUpload();
+		glProgramUniform4fv(m_programId,
+		                    GetUniformLocation(name), 1,
+		                    &value.x);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Shader::SetUniformMat4(UniformName name,
+	                           const Math::Mat4& value)
+	{
+		CountUniformUpload();
+		glProgramUniformMatrix4fv(m_programId,
+		                          GetUniformLocation(name), 1,
+		                          GL_FALSE, value.Data());
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Shader::Set(UniformHandle<int> uniform, int value)
+	{
+		CountUniformUpload();
+		glProgramUniform1i(m_programId, uniform.location,
+		                   value);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Shader::Set(UniformHandle<Int2> uniform, Int2 value)
+	{
+		CountUniformUpload();
+		glProgramUniform2i(m_programId, uniform.location,
+		                   value.x, value.y);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Shader::Set(UniformHandle<Int3> uniform, Int3 value)
+	{
+		CountUniformUpload();
+		glProgramUniform3i(m_programId, uniform.location,
+		                   value.x, value.y, value.z);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Shader::Set(UniformHandle<Int4> uniform, Int4 value)
+	{
+		CountUniformUpload();
+		glProgramUniform4i(m_programId, uniform.location,
+		                   value.x, value.y, value.z,
+		                   value.w);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Shader::Set(UniformHandle<float> uniform,
+	                 float value)
+	{
+		CountUniformUpload();
+		glProgramUniform1f(m_programId, uniform.location,
+		                   value);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Shader::Set(UniformHandle<Float2> uniform,
+	                 Float2 value)
+	{
+		CountUniformUpload();
+		glProgramUniform2f(m_programId, uniform.location,
+		                   value.x, value.y);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Shader::Set(UniformHandle<Float3> uniform,
+	                 Float3 value)
+	{
+		CountUniformUpload();
+		glProgramUniform3f(m_programId, uniform.location,
+		                   value.x, value.y, value.z);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Shader::Set(UniformHandle<Float4> uniform,
+	                 Float4 value)
+	{
+		CountUniformUpload();
+		glProgramUniform4f(m_programId, uniform.location,
+		                   value.x, value.y, value.z,
+		                   value.w);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Shader::Set(UniformHandle<Math::Vec3> uniform,
+	                 const Math::Vec3& value)
+	{
+		CountUniformUpload();
+		glProgramUniform3fv(m_programId, uniform.location, 1,
+		                    &value.x);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Shader::Set(UniformHandle<Math::Vec4> uniform,
+	                 const Math::Vec4& value)
+	{
+		CountUniformUpload();
+		glProgramUniform4fv(m_programId, uniform.location, 1,
+		                    &value.x);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Shader::Set(UniformHandle<Math::Mat4> uniform,
+	                 const Math::Mat4& value)
+	{
+		CountUniformUpload();
+		glProgramUniformMatrix4fv(m_programId,
+		                          uniform.location, 1,
+		                          GL_FALSE, value.Data());
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Shader::ApplyReflection()
+	{
+		const std::pair<std::string_view, uint32_t> blocks[] = {
+		    {"Constants", ConstantsBinding},
+		    {"MaterialConstants", MaterialConstantsBinding}};
+		for (const auto& [name, binding] : blocks)
 		{
-			m_uniformLocations[name] = glGetUniformLocation(
-			    m_programId, name.c_str());
-			VEGAM_CHECK_GL_ERROR;
+			if (const auto* block = ShaderReflection::Find(
+			        m_reflection.uniformBlocks, name))
+			{
+				glUniformBlockBinding(m_programId,
+				                      block->location, binding);
+				VEGAM_CHECK_GL_ERROR;
+			}
+		}
+
+		m_uniformLocations.clear();
+		for (const auto& uniform : m_reflection.uniforms)
+		{
+			if (uniform.location < 0)
+			{
+				continue;
+			}
+			m_uniformLocations.emplace(
+			    Core::MakeStringId(uniform.name),
+			    uniform.location);
+			if (uniform.size > 1)
+			{
+				m_uniformLocations.emplace(
+				    Core::MakeStringId(uniform.name + "[0]"),
+				    uniform.location);
+			}
+		}
+	}
+
+	bool Shader::ValidateLayout(const VertexLayout& layout,
+	                            bool instanced) const
+	{
+		if (m_layoutWarned)
+		{
+			return true;
+		}
+		std::string problem;
+		if (m_reflection.Accepts(layout, instanced, &problem))
+		{
+			return true;
+		}
+		VEGAM_WARN("Mesh layout doesn't suit shader {}: {}",
+		           GetId(), problem);
+		m_layoutWarned = true;
+		return false;
+	}
+
+	bool Shader::BindUniformBlock(std::string_view name,
+	                              uint32_t binding)
+	{
+		if (m_ready)
+		{
+			const auto* block = ShaderReflection::Find(
+			    m_reflection.uniformBlocks, name);
+			if (block)
+			{
+				glUniformBlockBinding(m_programId,
+				                      block->location, binding);
+				VEGAM_CHECK_GL_ERROR;
+			}
+			return block != nullptr;
 		}
 
-		return m_uniformLocations[name];
+		const std::string blockName(name);
+		const auto index =
+		    glGetUniformBlockIndex(m_programId,
+		                           blockName.c_str());
+		VEGAM_CHECK_GL_ERROR;
+		if (index == GL_INVALID_INDEX)
+		{
+			return false;
+		}
+
+		glUniformBlockBinding(m_programId, index, binding);
+		VEGAM_CHECK_GL_ERROR;
+		return true;
+	}
+
+	int Shader::GetUniformLocation(UniformName name)
+	{
+		auto it = m_uniformLocations.find(name.id);
+		if (it != m_uniformLocations.end())
+		{
+			return it->second;
+		}
+
+		// Not among the reflected names, e.g. one array
+		// element. glGetUniformLocation() wants a terminated
+		// string; this runs once per name.
+		const std::string uniformName(name.name);
+		const auto location = glGetUniformLocation(
+		    m_programId, uniformName.c_str());
+		VEGAM_CHECK_GL_ERROR;
+		m_uniformLocations.emplace(name.id, location);
+		return location;
 	}
 } // namespace AthiVegam::Graphics
@@ -0,0 +1,350 @@
+#include "AthiVegam/Graphics/ShaderReflection.h"
+
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		using Variable = ShaderReflection::Variable;
+
+		// GL reports arrays as "name[0]".
+		std::string GetName(const std::vector<char>& buffer,
+		                    GLsizei length)
+		{
+			std::string_view name(buffer.data(), length);
+			if (name.ends_with("[0]"))
+			{
+				name.remove_suffix(3);
+			}
+			return std::string(name);
+		}
+
+		bool IsIntegerType(uint32_t type)
+		{
+			switch (type)
+			{
+			case GL_INT:
+			case GL_INT_VEC2:
+			case GL_INT_VEC3:
+			case GL_INT_VEC4:
+			case GL_UNSIGNED_INT:
+			case GL_UNSIGNED_INT_VEC2:
+			case GL_UNSIGNED_INT_VEC3:
+			case GL_UNSIGNED_INT_VEC4:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		// Locations an input takes: one per matrix column.
+		int32_t GetLocationCount(uint32_t type)
+		{
+			switch (type)
+			{
+			case GL_FLOAT_MAT2:
+			case GL_FLOAT_MAT2x3:
+			case GL_FLOAT_MAT2x4:
+				return 2;
+			case GL_FLOAT_MAT3:
+			case GL_FLOAT_MAT3x2:
+			case GL_FLOAT_MAT3x4:
+				return 3;
+			case GL_FLOAT_MAT4:
+			case GL_FLOAT_MAT4x2:
+			case GL_FLOAT_MAT4x3:
+				return 4;
+			default:
+				return 1;
+			}
+		}
+
+		inline bool IsInstanceLocation(int32_t location)
+		{
+			constexpr auto first = static_cast<int32_t>(
+			    RenderCommands::InstanceTransformLocation);
+			return location >= first && location < first + 4;
+		}
+
+		void ReflectBlocks(uint32_t program,
+		                   std::vector<Variable>& blocks)
+		{
+			GLint count = 0;
+			glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS,
+			               &count);
+			VEGAM_CHECK_GL_ERROR;
+			GLint maxLength = 0;
+			glGetProgramiv(
+			    program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH,
+			    &maxLength);
+			VEGAM_CHECK_GL_ERROR;
+			std::vector<char> buffer(std::max(maxLength, 1));
+			for (GLint i = 0; i < count; ++i)
+			{
+				GLsizei length = 0;
+				glGetActiveUniformBlockName(
+				    program, i,
+				    static_cast<GLsizei>(buffer.size()), &length,
+				    buffer.data());
+				VEGAM_CHECK_GL_ERROR;
+				Variable block;
+				block.name = GetName(buffer, length);
+				glGetActiveUniformBlockiv(
+				    program, i, GL_UNIFORM_BLOCK_DATA_SIZE,
+				    &block.size);
+				VEGAM_CHECK_GL_ERROR;
+				block.location = i;
+				blocks.push_back(std::move(block));
+			}
+		}
+
+		void ReflectStorageBlocks(uint32_t program,
+		                          std::vector<Variable>& blocks)
+		{
+			if (!GLAD_GL_VERSION_4_3)
+			{
+				return;
+			}
+			GLint count = 0;
+			glGetProgramInterfaceiv(program,
+			                        GL_SHADER_STORAGE_BLOCK,
+			                        GL_ACTIVE_RESOURCES, &count);
+			VEGAM_CHECK_GL_ERROR;
+			GLint maxLength = 0;
+			glGetProgramInterfaceiv(program,
+			                        GL_SHADER_STORAGE_BLOCK,
+			                        GL_MAX_NAME_LENGTH,
+			                        &maxLength);
+			VEGAM_CHECK_GL_ERROR;
+			std::vector<char> buffer(std::max(maxLength, 1));
+			for (GLint i = 0; i < count; ++i)
+			{
+				GLsizei length = 0;
+				glGetProgramResourceName(
+				    program, GL_SHADER_STORAGE_BLOCK, i,
+				    static_cast<GLsizei>(buffer.size()), &length,
+				    buffer.data());
+				VEGAM_CHECK_GL_ERROR;
+				Variable block;
+				block.name = GetName(buffer, length);
+				const GLenum property = GL_BUFFER_DATA_SIZE;
+				glGetProgramResourceiv(
+				    program, GL_SHADER_STORAGE_BLOCK, i, 1,
+				    &property, 1, nullptr, &block.size);
+				VEGAM_CHECK_GL_ERROR;
+				block.location = i;
+				blocks.push_back(std::move(block));
+			}
+		}
+	} // namespace
+
+	ShaderReflection ShaderReflection::Reflect(uint32_t program)
+	{
+		ShaderReflection reflection;
+		GLint count = 0;
+		GLint maxLength = 0;
+		std::vector<char> buffer;
+
+		glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+		VEGAM_CHECK_GL_ERROR;
+		glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH,
+		               &maxLength);
+		VEGAM_CHECK_GL_ERROR;
+		buffer.resize(std::max(maxLength, 1));
+		for (GLint i = 0; i < count; ++i)
+		{
+			GLsizei length = 0;
+			GLint size = 0;
+			GLenum type = 0;
+			glGetActiveAttrib(program, i,
+			                  static_cast<GLsizei>(buffer.size()),
+			                  &length, &size, &type,
+			                  buffer.data());
+			VEGAM_CHECK_GL_ERROR;
+			// Built-ins such as gl_VertexID have none.
+			const auto location =
+			    glGetAttribLocation(program, buffer.data());
+			VEGAM_CHECK_GL_ERROR;
+			if (location < 0)
+			{
+				continue;
+			}
+			reflection.attributes.push_back(
+			    {GetName(buffer, length), type, size, location});
+		}
+		std::sort(reflection.attributes.begin(),
+		          reflection.attributes.end(),
+		          [](const Variable& a, const Variable& b) {
+			          return a.location < b.location;
+		          });
+
+		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+		VEGAM_CHECK_GL_ERROR;
+		glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH,
+		               &maxLength);
+		VEGAM_CHECK_GL_ERROR;
+		buffer.resize(std::max(maxLength, 1));
+		for (GLint i = 0; i < count; ++i)
+		{
+			GLsizei length = 0;
+			GLint size = 0;
+			GLenum type = 0;
+			glGetActiveUniform(
+			    program, i, static_cast<GLsizei>(buffer.size()),
+			    &length, &size, &type, buffer.data());
+			VEGAM_CHECK_GL_ERROR;
+			const auto location =
+			    glGetUniformLocation(program, buffer.data());
+			VEGAM_CHECK_GL_ERROR;
+			reflection.uniforms.push_back(
+			    {GetName(buffer, length), type, size, location});
+		}
+
+		ReflectBlocks(program, reflection.uniformBlocks);
+		ReflectStorageBlocks(program, reflection.storageBlocks);
+		return reflection;
+	}
+
+	const ShaderReflection::Variable*
+	ShaderReflection::Find(std::span<const Variable> variables,
+	                       std::string_view name)
+	{
+		const auto it = std::find_if(
+		    variables.begin(), variables.end(),
+		    [&](const Variable& variable) {
+			    return variable.name == name;
+		    });
+		return it != variables.end() ? &*it : nullptr;
+	}
+
+	bool ShaderReflection::IsSampler(uint32_t type)
+	{
+		switch (type)
+		{
+		case GL_SAMPLER_1D:
+		case GL_SAMPLER_2D:
+		case GL_SAMPLER_3D:
+		case GL_SAMPLER_CUBE:
+		case GL_SAMPLER_2D_SHADOW:
+		case GL_SAMPLER_2D_ARRAY:
+		case GL_SAMPLER_2D_ARRAY_SHADOW:
+		case GL_SAMPLER_CUBE_SHADOW:
+		case GL_SAMPLER_2D_MULTISAMPLE:
+		case GL_SAMPLER_2D_RECT:
+		case GL_SAMPLER_BUFFER:
+		case GL_INT_SAMPLER_2D:
+		case GL_INT_SAMPLER_2D_ARRAY:
+		case GL_UNSIGNED_INT_SAMPLER_2D:
+		case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	VertexLayout ShaderReflection::MakeVertexLayout() const
+	{
+		VertexLayout layout;
+		for (const auto& input : attributes)
+		{
+			if (IsInstanceLocation(input.location))
+			{
+				continue;
+			}
+			const auto location =
+			    static_cast<uint32_t>(input.location);
+			switch (input.type)
+			{
+			case GL_FLOAT:
+				layout.Add(location, VertexFormat::Float1);
+				break;
+			case GL_FLOAT_VEC2:
+				layout.Add(location, VertexFormat::Float2);
+				break;
+			case GL_FLOAT_VEC3:
+				layout.Add(location, VertexFormat::Float3);
+				break;
+			case GL_FLOAT_VEC4:
+				layout.Add(location, VertexFormat::Float4);
+				break;
+			default:
+				if (IsIntegerType(input.type))
+				{
+					layout.Add(location, VertexFormat::UByte4);
+				}
+				else
+				{
+					VEGAM_WARN("Vertex input {} has no vertex "
+					           "format",
+					           input.name);
+				}
+				break;
+			}
+		}
+		return layout;
+	}
+
+	bool ShaderReflection::Accepts(const VertexLayout& layout,
+	                               bool instanced,
+	                               std::string* problem) const
+	{
+		const auto reject = [&](const Variable& input,
+		                        int32_t location,
+		                        std::string_view why) {
+			if (problem)
+			{
+				*problem =
+				    fmt::format("input {} at location {} {}",
+				                input.name, location, why);
+			}
+			return false;
+		};
+		for (const auto& input : attributes)
+		{
+			const auto integer = IsIntegerType(input.type);
+			const auto kind =
+			    integer ? "reads integers" : "reads floats";
+			for (int32_t column = 0;
+			     column < GetLocationCount(input.type);
+			     ++column)
+			{
+				const auto location = input.location + column;
+				if (instanced && IsInstanceLocation(location))
+				{
+					// The transform is floats.
+					if (integer)
+					{
+						return reject(input, location, kind);
+					}
+					continue;
+				}
+				const VertexAttribute* fed = nullptr;
+				for (uint32_t i = 0;
+				     i < layout.GetAttributeCount(); ++i)
+				{
+					if (layout.GetAttribute(i).location
+					    == static_cast<uint32_t>(location))
+					{
+						fed = &layout.GetAttribute(i);
+					}
+				}
+				if (!fed)
+				{
+					return reject(input, location,
+					              "is not in the layout");
+				}
+				if (IsIntegerFormat(fed->format) != integer)
+				{
+					return reject(input, location, kind);
+				}
+			}
+		}
+		return true;
+	}
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,87 @@
+#include "AthiVegam/Graphics/ShaderVariants.h"
+
+#include "AthiVegam/Log.h"
+
+#include <utility>
+
+namespace AthiVegam::Graphics
+{
+	ShaderVariants::ShaderVariants(
+	    std::string vertex, std::string fragment,
+	    std::vector<std::string> features)
+	    : m_vertex(std::move(vertex))
+	    , m_fragment(std::move(fragment))
+	    , m_features(std::move(features))
+	{
+		VEGAM_ASSERT(m_features.size() <= MaxFeatures,
+		             "Too many shader features");
+		if (m_features.size() > MaxFeatures)
+		{
+			m_features.resize(MaxFeatures);
+		}
+	}
+
+	uint32_t ShaderVariants::GetFeatureBit(
+	    std::string_view feature) const
+	{
+		for (uint32_t i = 0; i < m_features.size(); ++i)
+		{
+			if (m_features[i] == feature)
+			{
+				return 1u << i;
+			}
+		}
+		return 0;
+	}
+
+	std::string
+	ShaderVariants::GetVertexSource(uint32_t key) const
+	{
+		return Specialize(m_vertex, key);
+	}
+
+	std::string
+	ShaderVariants::GetFragmentSource(uint32_t key) const
+	{
+		return Specialize(m_fragment, key);
+	}
+
+	// Defines go right after the #version directive, which
+	// must stay the first statement of the source.
+	std::string ShaderVariants::Specialize(
+	    const std::string& source, uint32_t key) const
+	{
+		std::string defines;
+		for (uint32_t i = 0; i < m_features.size(); ++i)
+		{
+			if (key & (1u << i))
+			{
+				defines += "#define " + m_features[i] + " 1\n";
+			}
+		}
+		if (defines.empty())
+		{
+			return source;
+		}
+
+		size_t insert = 0;
+		const auto version = source.find("#version");
+		if (version != std::string::npos)
+		{
+			const auto lineEnd = source.find('\n', version);
+			insert = lineEnd == std::string::npos
+			             ? source.size()
+			             : lineEnd + 1;
+		}
+
+		auto specialized = source.substr(0, insert);
+		if (insert == source.size() && !specialized.empty()
+		    && specialized.back() != '\n')
+		{
+			specialized += '\n';
+		}
+		specialized += defines;
+		specialized.append(source, insert);
+		return specialized;
+	}
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,156 @@
+#include "AthiVegam/Graphics/Skinning.h"
+
+#include "AthiVegam/Graphics/CommandList.h"
+#include "AthiVegam/Graphics/VertexLayout.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace AthiVegam::Graphics
+{
+	const char* SkinningShaderSource = R"(
+#ifndef SKINNING_MAX_BONES
+#define SKINNING_MAX_BONES 256
+#endif
+layout(location = 9) in uvec4 BoneIndices;
+layout(location = 10) in vec4 BoneWeights;
+
+layout(std140) uniform Constants
+{
+	mat4 Bones[SKINNING_MAX_BONES];
+};
+
+mat4 SkinMatrix()
+{
+	return Bones[BoneIndices.x] * BoneWeights.x
+	       + Bones[BoneIndices.y] * BoneWeights.y
+	       + Bones[BoneIndices.z] * BoneWeights.z
+	       + Bones[BoneIndices.w] * BoneWeights.w;
+}
+)";
+
+	namespace Skinning
+	{
+		void AddAttributes(VertexLayout& layout)
+		{
+			layout.Add(BoneIndicesLocation, VertexFormat::UByte4)
+			    .Add(BoneWeightsLocation,
+			         VertexFormat::UByte4Norm);
+		}
+
+		VertexWeights PackWeights(const uint32_t indices[4],
+		                          const float weights[4])
+		{
+			VertexWeights packed{};
+			auto sum = 0.0f;
+			for (int i = 0; i < 4; ++i)
+			{
+				sum += std::max(weights[i], 0.0f);
+			}
+			if (sum <= 0.0f)
+			{
+				// Rigidly bound to the first bone.
+				packed.indices[0] =
+				    static_cast<uint8_t>(indices[0]);
+				packed.weights[0] = 255;
+				return packed;
+			}
+
+			auto total = 0;
+			auto heaviest = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				VEGAM_ASSERT(indices[i] < MaxBones,
+				             "Bone index out of range");
+				packed.indices[i] =
+				    static_cast<uint8_t>(indices[i]);
+				const auto weight =
+				    std::max(weights[i], 0.0f) / sum;
+				packed.weights[i] = static_cast<uint8_t>(
+				    std::lround(weight * 255.0f));
+				total += packed.weights[i];
+				if (packed.weights[i]
+				    > packed.weights[heaviest])
+				{
+					heaviest = i;
+				}
+			}
+			packed.weights[heaviest] = static_cast<uint8_t>(
+			    packed.weights[heaviest] + 255 - total);
+			return packed;
+		}
+
+		RenderCommands::Constants
+		PushPalette(CommandList& list,
+		            std::span<const Math::Mat4> palette,
+		            uint32_t blockBones)
+		{
+			// Mat4 starts out as the identity.
+			static const std::array<Math::Mat4, MaxBones>
+			    identities{};
+
+			VEGAM_ASSERT(blockBones <= MaxBones
+			                 && palette.size() <= blockBones,
+			             "Too many bones in a palette");
+			blockBones = std::min(blockBones, MaxBones);
+			const auto count = std::min<size_t>(
+			    palette.size(), blockBones);
+			if (count == blockBones)
+			{
+				return list.PushConstants(
+				    palette.data(),
+				    static_cast<uint32_t>(
+				        count * sizeof(Math::Mat4)));
+			}
+
+			const auto constants = list.PushConstants(
+			    identities.data(),
+			    static_cast<uint32_t>(blockBones
+			                          * sizeof(Math::Mat4)));
+			std::memcpy(list.MapConstants(constants),
+			            palette.data(),
+			            count * sizeof(Math::Mat4));
+			return constants;
+		}
+	} // namespace Skinning
+
+	uint32_t Skeleton::AddBone(uint32_t parent,
+	                           const Math::Mat4& inverseBind)
+	{
+		VEGAM_ASSERT(parent == NoParent
+		                 || parent < m_parents.size(),
+		             "A bone's parent must come before it");
+		VEGAM_ASSERT(m_parents.size() < Skinning::MaxBones,
+		             "Too many bones in a skeleton");
+		m_parents.push_back(parent);
+		m_inverseBind.push_back(inverseBind);
+		return static_cast<uint32_t>(m_parents.size() - 1);
+	}
+
+	void Skeleton::ComputePalette(
+	    std::span<const Math::Mat4> localPose,
+	    std::span<Math::Mat4> palette) const
+	{
+		const auto count = GetBoneCount();
+		VEGAM_ASSERT(localPose.size() >= count
+		                 && palette.size() >= count,
+		             "Pose and palette need every bone");
+
+		// Model-space bone transforms first; parents are
+		// done before their children read them.
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const auto parent = m_parents[i];
+			palette[i] = parent == NoParent
+			                 ? localPose[i]
+			                 : palette[parent] * localPose[i];
+		}
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			palette[i] *= m_inverseBind[i];
+		}
+	}
+} // namespace AthiVegam::Graphics
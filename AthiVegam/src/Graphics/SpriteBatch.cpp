@@ -0,0 +1,356 @@
+#include "AthiVegam/Graphics/SpriteBatch.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Graphics/CommandList.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Graphics/SortKey.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		static_assert(RenderCommands::InstanceTransformLocation
+		              == 4);
+
+		// Corners from gl_VertexID, as a strip.
+		const char* VertexSource = R"(#version 410 core
+layout(location = 4) in vec4 Rect;
+layout(location = 5) in vec4 UVs;
+layout(location = 6) in vec4 Transform;
+layout(location = 7) in vec4 Color;
+
+layout(std140) uniform Constants
+{
+	mat4 ViewProjection;
+};
+
+out vec2 FragUV;
+out vec4 FragColor;
+
+void main()
+{
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+	vec2 local = (corner - Transform.zw) * Rect.zw;
+	bool turned = dot(Transform.xy, Transform.xy) > 2.0;
+	vec2 cs = turned ? 0.5 * Transform.xy : Transform.xy;
+	vec2 rotated = vec2(local.x * cs.x - local.y * cs.y,
+	                    local.x * cs.y + local.y * cs.x);
+	gl_Position = ViewProjection * vec4(Rect.xy + rotated, 0, 1);
+	FragUV = mix(UVs.xy, UVs.zw, turned ? corner.yx : corner);
+	FragColor = Color;
+}
+)";
+
+		const char* FragmentSource = R"(#version 410 core
+in vec2 FragUV;
+in vec4 FragColor;
+
+uniform sampler2D Texture;
+
+layout(location = 0) out vec4 OutColor;
+
+void main()
+{
+	OutColor = FragColor * texture(Texture, FragUV);
+}
+)";
+
+		// Coverage from the distance to the glyph edge,
+		// over about a pixel whatever the scale.
+		const char* DistanceFieldSource = R"(#version 410 core
+in vec2 FragUV;
+in vec4 FragColor;
+
+uniform sampler2D Texture;
+
+layout(location = 0) out vec4 OutColor;
+
+void main()
+{
+	float distance = texture(Texture, FragUV).r;
+	float width = max(fwidth(distance) * 0.7, 1e-4);
+	float coverage =
+	    smoothstep(0.5 - width, 0.5 + width, distance);
+	OutColor = vec4(FragColor.rgb, FragColor.a * coverage);
+}
+)";
+
+		// Layer, shading and texture index, above the
+		// instance index; only they are sorted on.
+		constexpr uint32_t KeyShift = 27;
+		constexpr uint32_t MaxSprites = 1u << KeyShift;
+		static_assert(KeyShift + TextureHandle::IndexBits + 1
+		              <= 48);
+
+		inline uint64_t MakeKey(const Sprite& sprite,
+		                        uint32_t index)
+		{
+			// Flipping the sign bit orders negative layers
+			// first.
+			const auto biased =
+			    static_cast<uint16_t>(sprite.layer) ^ 0x8000u;
+			return (static_cast<uint64_t>(biased) << 48)
+			       | (static_cast<uint64_t>(sprite.distanceField)
+			          << 47)
+			       | (static_cast<uint64_t>(
+			              sprite.texture.GetIndex())
+			          << KeyShift)
+			       | index;
+		}
+
+		inline uint32_t GetIndex(uint64_t key)
+		{
+			return static_cast<uint32_t>(key)
+			       & (MaxSprites - 1);
+		}
+	} // namespace
+
+	SpriteBatch::SpriteBatch() = default;
+
+	SpriteBatch::~SpriteBatch()
+	{
+		VEGAM_ASSERT(m_vao == 0,
+		             "SpriteBatch destroyed without Shutdown()");
+	}
+
+	void SpriteBatch::Initialize()
+	{
+		m_shader = std::make_unique<Shader>(VertexSource,
+		                                    FragmentSource);
+		m_shader->SetUniformInt("Texture", 0);
+		m_distanceFieldShader = std::make_unique<Shader>(
+		    VertexSource, DistanceFieldSource);
+		m_distanceFieldShader->SetUniformInt("Texture", 0);
+
+		// No vertex attributes; instance attributes are
+		// pointed at the frame's data per draw.
+		glGenVertexArrays(1, &m_vao);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::VertexArray,
+		                       m_vao, 0, "Sprites");
+
+		const uint32_t white = 0xFFFFFFFF;
+		glGenTextures(1, &m_whiteTexture);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, m_whiteTexture);
+		VEGAM_CHECK_GL_ERROR;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+		                GL_NEAREST);
+		VEGAM_CHECK_GL_ERROR;
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0,
+		             GL_RGBA, GL_UNSIGNED_BYTE, &white);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, 0);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::Texture,
+		                       m_whiteTexture, 4,
+		                       "Sprite white");
+	}
+
+	void SpriteBatch::Shutdown()
+	{
+		if (m_vao != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::VertexArray, m_vao);
+			glDeleteVertexArrays(1, &m_vao);
+			VEGAM_CHECK_GL_ERROR;
+			m_vao = 0;
+		}
+		if (m_whiteTexture != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Texture, m_whiteTexture);
+			glDeleteTextures(1, &m_whiteTexture);
+			VEGAM_CHECK_GL_ERROR;
+			m_whiteTexture = 0;
+		}
+		m_shader.reset();
+		m_distanceFieldShader.reset();
+	}
+
+	void SpriteBatch::Begin(const float viewProjection[16],
+	                        uint8_t renderLayer,
+	                        BlendMode blend)
+	{
+		VEGAM_ASSERT(!m_recording,
+		             "SpriteBatch::Begin() without End()");
+		m_recording = true;
+		std::memcpy(m_viewProjection.data(), viewProjection,
+		            sizeof(m_viewProjection));
+		m_renderLayer = renderLayer;
+		m_blend = blend;
+		m_instances.clear();
+		m_keys.clear();
+		m_textures.clear();
+	}
+
+	void SpriteBatch::Draw(const Sprite& sprite)
+	{
+		VEGAM_ASSERT(m_recording,
+		             "SpriteBatch::Draw() outside Begin()");
+		const auto index =
+		    static_cast<uint32_t>(m_instances.size());
+		VEGAM_ASSERT(index < MaxSprites,
+		             "Too many sprites in one batch");
+		auto& instance = m_instances.emplace_back();
+		instance.rect[0] = sprite.x;
+		instance.rect[1] = sprite.y;
+		instance.rect[2] = sprite.width;
+		instance.rect[3] = sprite.height;
+		instance.uvs[0] = sprite.u0;
+		instance.uvs[1] = sprite.v0;
+		instance.uvs[2] = sprite.u1;
+		instance.uvs[3] = sprite.v1;
+		instance.transform[0] = 1.0f;
+		instance.transform[1] = 0.0f;
+		if (sprite.rotation != 0.0f)
+		{
+			instance.transform[0] = std::cos(sprite.rotation);
+			instance.transform[1] = std::sin(sprite.rotation);
+		}
+		if (sprite.uvRotated)
+		{
+			instance.transform[0] *= 2.0f;
+			instance.transform[1] *= 2.0f;
+		}
+		instance.transform[2] = sprite.originX;
+		instance.transform[3] = sprite.originY;
+		std::memcpy(instance.color, sprite.color.data(),
+		            sizeof(instance.color));
+
+		m_keys.push_back(MakeKey(sprite, index));
+		m_textures.push_back(sprite.texture);
+	}
+
+	void SpriteBatch::End()
+	{
+		End(Engine::Instance()
+		        .GetRenderManager()
+		        .GetThreadCommandList());
+	}
+
+	void SpriteBatch::End(CommandList& list)
+	{
+		VEGAM_PROFILE_SCOPE("SpriteBatch::End");
+		VEGAM_ASSERT(m_recording,
+		             "SpriteBatch::End() without Begin()");
+		m_recording = false;
+		const auto count =
+		    static_cast<uint32_t>(m_instances.size());
+		m_spriteCount = count;
+		m_drawCount = 0;
+		if (count == 0)
+		{
+			return;
+		}
+
+		Sort();
+		m_sorted.resize(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			std::memcpy(&m_sorted[i],
+			            &m_instances[GetIndex(m_keys[i])],
+			            sizeof(Instance));
+		}
+		const auto first =
+		    list.PushInstances(m_sorted.data(), count);
+
+		RenderCommands::DrawSprites command{};
+		const auto colorProgram =
+		    m_shader ? m_shader->GetId() : 0;
+		const auto distanceFieldProgram =
+		    m_distanceFieldShader
+		        ? m_distanceFieldShader->GetId()
+		        : 0;
+		command.vao = m_vao;
+		command.defaultTexture = m_whiteTexture;
+		command.constants = list.PushConstants(
+		    m_viewProjection.data(),
+		    static_cast<uint32_t>(sizeof(m_viewProjection)));
+		command.blend = m_blend;
+
+		// Runs keep their order through the depth field of
+		// translucent keys; past its range they tie, which
+		// the stable sort of the flush keeps in order too.
+		uint32_t runStart = 0;
+		for (uint32_t i = 1; i <= count; ++i)
+		{
+			if (i < count
+			    && (m_keys[i] >> KeyShift)
+			           == (m_keys[runStart] >> KeyShift))
+			{
+				continue;
+			}
+			command.texture =
+			    m_textures[GetIndex(m_keys[runStart])];
+			command.program = (m_keys[runStart] >> 47) & 1
+			                      ? distanceFieldProgram
+			                      : colorProgram;
+			command.firstInstance = first + runStart;
+			command.instanceCount = i - runStart;
+			const auto order = std::min(
+			    m_drawCount,
+			    static_cast<uint32_t>(
+			        SortKey::Mask(SortKey::DepthBits)));
+			list.Submit(command,
+			            SortKey::Make(m_renderLayer, true, 0, 0,
+			                          order));
+			++m_drawCount;
+			runStart = i;
+		}
+	}
+
+	// LSD radix sort on the layer, shading and texture, 8
+	// bits per pass, which keeps sprites of a run in the
+	// order they were drawn. Passes where every key shares
+	// the digit are skipped, so a single layer or a few
+	// textures are cheap.
+	void SpriteBatch::Sort()
+	{
+		const auto count = m_keys.size();
+		m_keyScratch.resize(count);
+		auto* src = m_keys.data();
+		auto* dst = m_keyScratch.data();
+
+		for (uint32_t shift = KeyShift; shift < 64; shift += 8)
+		{
+			std::array<uint32_t, 256> histogram{};
+			for (size_t i = 0; i < count; ++i)
+			{
+				++histogram[(src[i] >> shift) & 0xFF];
+			}
+			if (histogram[(src[0] >> shift) & 0xFF] == count)
+			{
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (auto& bucket : histogram)
+			{
+				const auto bucketCount = bucket;
+				bucket = offset;
+				offset += bucketCount;
+			}
+			for (size_t i = 0; i < count; ++i)
+			{
+				dst[histogram[(src[i] >> shift) & 0xFF]++] =
+				    src[i];
+			}
+			std::swap(src, dst);
+		}
+		if (src != m_keys.data())
+		{
+			m_keys.swap(m_keyScratch);
+		}
+	}
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,146 @@
+#include "AthiVegam/Graphics/StreamBuffer.h"
+
+#include "AthiVegam/Core/Memory.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/RetireQueue.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		// Waits are bounded so a lost context can't hang
+		// the thread forever.
+		constexpr GLuint64 FenceTimeout = 1'000'000'000;
+	} // namespace
+
+	StreamBuffer::StreamBuffer(size_t segmentSize)
+	    : m_buffer(0)
+	    , m_segmentSize(segmentSize)
+	    , m_segment(SegmentCount - 1)
+	    , m_persistent(nullptr)
+	    , m_fences{}
+	{
+		const auto size = segmentSize * SegmentCount;
+
+		// Bound to the copy target so creating the buffer
+		// leaves the current VAO's element binding alone.
+		glGenBuffers(1, &m_buffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+		VEGAM_CHECK_GL_ERROR;
+
+		if (GLAD_GL_VERSION_4_4)
+		{
+			const GLbitfield flags = GL_MAP_WRITE_BIT
+			                         | GL_MAP_PERSISTENT_BIT
+			                         | GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_COPY_WRITE_BUFFER, size,
+			                nullptr, flags);
+			VEGAM_CHECK_GL_ERROR;
+			m_persistent = static_cast<uint8_t*>(
+			    glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size,
+			                     flags));
+			VEGAM_CHECK_GL_ERROR;
+		}
+		else
+		{
+			glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr,
+			             GL_STREAM_DRAW);
+			VEGAM_CHECK_GL_ERROR;
+		}
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		Core::Memory::TrackGpu(Core::Memory::Tag::Render,
+		                       static_cast<int64_t>(size));
+		GpuResources::Register(GpuResources::Type::Buffer,
+		                       m_buffer, size, "Stream buffer");
+	}
+
+	StreamBuffer::~StreamBuffer()
+	{
+		for (auto& fence : m_fences)
+		{
+			if (fence)
+			{
+				RetireQueue::RetireSync(fence);
+			}
+		}
+
+		// Deleting a persistently mapped buffer unmaps it.
+		GpuResources::Unregister(GpuResources::Type::Buffer,
+		                         m_buffer);
+		RetireQueue::RetireBuffer(m_buffer);
+		Core::Memory::TrackGpu(
+		    Core::Memory::Tag::Render,
+		    -static_cast<int64_t>(m_segmentSize * SegmentCount));
+	}
+
+	void* StreamBuffer::BeginWrite()
+	{
+		m_fences[m_segment] =
+		    glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		m_segment = (m_segment + 1) % SegmentCount;
+		WaitForSegment(m_segment);
+
+		const auto offset = m_segment * m_segmentSize;
+		if (m_persistent)
+		{
+			return m_persistent + offset;
+		}
+
+		// The fence already guarantees the GPU is done with
+		// this segment, so skip the driver's own sync.
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+		VEGAM_CHECK_GL_ERROR;
+		auto* data = glMapBufferRange(
+		    GL_COPY_WRITE_BUFFER, offset, m_segmentSize,
+		    GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+		        | GL_MAP_INVALIDATE_RANGE_BIT);
+		VEGAM_CHECK_GL_ERROR;
+		return data;
+	}
+
+	void StreamBuffer::EndWrite()
+	{
+		if (m_persistent)
+		{
+			// Coherent mapping, nothing to flush.
+			return;
+		}
+
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void StreamBuffer::WaitForSegment(uint32_t segment)
+	{
+		auto& fence = m_fences[segment];
+		if (!fence)
+		{
+			return;
+		}
+
+		auto result = glClientWaitSync(
+		    fence, GL_SYNC_FLUSH_COMMANDS_BIT, FenceTimeout);
+		if (result == GL_TIMEOUT_EXPIRED
+		    || result == GL_WAIT_FAILED)
+		{
+			VEGAM_WARN("StreamBuffer fence wait failed, "
+			           "segment {} may still be in use",
+			           segment);
+		}
+
+		glDeleteSync(fence);
+		VEGAM_CHECK_GL_ERROR;
+		fence = nullptr;
+	}
+} // namespace AthiVegam::Graphics
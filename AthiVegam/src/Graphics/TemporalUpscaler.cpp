@@ -0,0 +1,550 @@
+#include "AthiVegam/Graphics/TemporalUpscaler.h"
+
+#include "AthiVegam/Core/CVar.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/ComputeProgram.h"
+#include "AthiVegam/Graphics/GpuProfiler.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		Core::CVar<float> blendFactorCVar(
+		    "r.taaBlend", 0.1f,
+		    "Weight of the current frame in temporal "
+		    "upscaling, where a sample lands on the pixel");
+
+		constexpr int GroupSize = 8;
+		constexpr uint32_t SceneUnit = 0;
+		constexpr uint32_t MotionUnit = 1;
+		constexpr uint32_t HistoryUnit = 2;
+
+		// Colors are compressed by their brightness while
+		// filtered and blended, so one bright texel can't
+		// flicker through the frames, and expanded again
+		// on output.
+		const char* ResolveSource = R"(#version 430 core
+layout(local_size_x = 8, local_size_y = 8) in;
+
+uniform sampler2D Scene;
+uniform sampler2D Motion;
+uniform sampler2D History;
+uniform ivec2 RenderSize;
+// In render pixels.
+uniform vec2 Jitter;
+// 1 drops the history.
+uniform float BlendFactor;
+layout(rgba16f, binding = 0) writeonly uniform image2D Output;
+
+vec3 Compress(vec3 color)
+{
+	return color / (1.0 + max(color.r, max(color.g, color.b)));
+}
+
+vec3 Expand(vec3 color)
+{
+	return color / max(1.0 - max(color.r, max(color.g, color.b)),
+	                   1e-4);
+}
+
+vec3 ToYCoCg(vec3 color)
+{
+	return vec3(dot(color, vec3(0.25, 0.5, 0.25)),
+	            dot(color, vec3(0.5, 0.0, -0.5)),
+	            dot(color, vec3(-0.25, 0.5, -0.25)));
+}
+
+vec3 FromYCoCg(vec3 color)
+{
+	return vec3(color.x + color.y - color.z, color.x + color.z,
+	            color.x - color.y - color.z);
+}
+
+void main()
+{
+	ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+	ivec2 size = imageSize(Output);
+	if (any(greaterThanEqual(p, size)))
+	{
+		return;
+	}
+	vec2 uv = (vec2(p) + 0.5) / vec2(size);
+
+	// The pixel center among the render texels, whose
+	// centers the jitter moved.
+	vec2 position = uv * vec2(RenderSize) + Jitter;
+	ivec2 center = ivec2(floor(position));
+	vec3 sum = vec3(0.0);
+	float weightSum = 0.0;
+	float nearest = 0.0;
+	vec3 moment1 = vec3(0.0);
+	vec3 moment2 = vec3(0.0);
+	for (int y = -1; y <= 1; ++y)
+	{
+		for (int x = -1; x <= 1; ++x)
+		{
+			ivec2 texel = center + ivec2(x, y);
+			vec3 color = Compress(texelFetch(
+			    Scene, clamp(texel, ivec2(0), RenderSize - 1),
+			    0).rgb);
+			vec2 offset = vec2(texel) + 0.5 - position;
+			float weight = exp(-2.29 * dot(offset, offset));
+			sum += weight * color;
+			weightSum += weight;
+			nearest = max(nearest, weight);
+			vec3 ycocg = ToYCoCg(color);
+			moment1 += ycocg;
+			moment2 += ycocg * ycocg;
+		}
+	}
+	vec3 result = sum / weightSum;
+
+	ivec2 motionTexel = clamp(ivec2(position), ivec2(0),
+	                          RenderSize - 1);
+	vec2 previous = uv - texelFetch(Motion, motionTexel, 0).rg;
+	if (BlendFactor < 1.0
+	    && all(greaterThanEqual(previous, vec2(0.0)))
+	    && all(lessThanEqual(previous, vec2(1.0))))
+	{
+		// Clipped to the spread of the colors around, so
+		// history of what is no longer there drops out.
+		vec3 mean = moment1 / 9.0;
+		vec3 sigma = sqrt(max(moment2 / 9.0 - mean * mean, 0.0));
+		vec3 history = ToYCoCg(Compress(
+		    textureLod(History, previous, 0.0).rgb));
+		history = FromYCoCg(clamp(history, mean - sigma,
+		                          mean + sigma));
+		// Samples far from the pixel center count less.
+		result = mix(history, result, BlendFactor * nearest);
+	}
+	imageStore(Output, p, vec4(Expand(result), 1.0));
+}
+)";
+
+		inline GLint Location(uint32_t program,
+		                      const char* name)
+		{
+			const auto location =
+			    glGetUniformLocation(program, name);
+			VEGAM_CHECK_GL_ERROR;
+			return location;
+		}
+
+		float Halton(uint32_t index, uint32_t base)
+		{
+			auto fraction = 1.0f;
+			auto result = 0.0f;
+			while (index > 0)
+			{
+				fraction /= static_cast<float>(base);
+				result += fraction
+				          * static_cast<float>(index % base);
+				index /= base;
+			}
+			return result;
+		}
+
+		uint32_t CreateTexture(int width, int height,
+		                       GLenum format, GLenum filter,
+		                       size_t texelSize,
+		                       const char* label)
+		{
+			GLuint texture = 0;
+			glGenTextures(1, &texture);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D, texture);
+			VEGAM_CHECK_GL_ERROR;
+			glTexStorage2D(GL_TEXTURE_2D, 1, format, width,
+			               height);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D,
+			                GL_TEXTURE_MIN_FILTER, filter);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D,
+			                GL_TEXTURE_MAG_FILTER, filter);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
+			                GL_CLAMP_TO_EDGE);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
+			                GL_CLAMP_TO_EDGE);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D, 0);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(
+			    GpuResources::Type::Texture, texture,
+			    static_cast<size_t>(width) * height * texelSize,
+			    label);
+			return texture;
+		}
+
+		void DeleteTexture(uint32_t& texture)
+		{
+			if (texture == 0)
+			{
+				return;
+			}
+			GpuResources::Unregister(GpuResources::Type::Texture,
+			                         texture);
+			glDeleteTextures(1, &texture);
+			VEGAM_CHECK_GL_ERROR;
+			texture = 0;
+		}
+
+		void DeleteFramebuffer(uint32_t& framebuffer)
+		{
+			if (framebuffer == 0)
+			{
+				return;
+			}
+			GpuResources::Unregister(
+			    GpuResources::Type::Framebuffer, framebuffer);
+			glDeleteFramebuffers(1, &framebuffer);
+			VEGAM_CHECK_GL_ERROR;
+			framebuffer = 0;
+		}
+
+		// Leaves it bound.
+		void CreateFramebuffer(uint32_t& framebuffer,
+		                       uint32_t color, const char* label)
+		{
+			glGenFramebuffers(1, &framebuffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+			VEGAM_CHECK_GL_ERROR;
+			glFramebufferTexture2D(GL_FRAMEBUFFER,
+			                       GL_COLOR_ATTACHMENT0,
+			                       GL_TEXTURE_2D, color, 0);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(
+			    GpuResources::Type::Framebuffer, framebuffer, 0,
+			    label);
+		}
+	} // namespace
+
+	TemporalUpscaler::TemporalUpscaler(float minScale)
+	{
+		VEGAM_ASSERT(minScale > 0.0f && minScale <= 1.0f,
+		             "Invalid temporal upscaling scale");
+		// Eight phases for each display pixel a render
+		// pixel covers.
+		const auto phases =
+		    std::ceil(8.0f / (minScale * minScale));
+		m_jitterPhases = std::clamp(
+		    static_cast<uint32_t>(phases), 8u, 32u);
+	}
+
+	TemporalUpscaler::~TemporalUpscaler()
+	{
+		VEGAM_ASSERT(!IsInitialized() && m_framebuffer == 0,
+		             "TemporalUpscaler destroyed without "
+		             "Shutdown()");
+	}
+
+	bool TemporalUpscaler::Initialize()
+	{
+		if (IsInitialized())
+		{
+			return true;
+		}
+		if (!GLAD_GL_VERSION_4_3)
+		{
+			VEGAM_WARN("Temporal upscaling needs a GL 4.3 "
+			           "context");
+			return false;
+		}
+		m_resolveProgram = CreateComputeProgram(
+		    ResolveSource, "Temporal upscaling");
+		if (!m_resolveProgram)
+		{
+			return false;
+		}
+		glProgramUniform1i(m_resolveProgram,
+		                   Location(m_resolveProgram, "Scene"),
+		                   SceneUnit);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1i(m_resolveProgram,
+		                   Location(m_resolveProgram, "Motion"),
+		                   MotionUnit);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1i(m_resolveProgram,
+		                   Location(m_resolveProgram, "History"),
+		                   HistoryUnit);
+		VEGAM_CHECK_GL_ERROR;
+		m_renderSizeLocation =
+		    Location(m_resolveProgram, "RenderSize");
+		m_jitterLocation = Location(m_resolveProgram, "Jitter");
+		m_blendFactorLocation =
+		    Location(m_resolveProgram, "BlendFactor");
+		VEGAM_INFO("Temporal upscaling enabled, {} jitter "
+		           "phases",
+		           m_jitterPhases);
+		return true;
+	}
+
+	void TemporalUpscaler::Shutdown()
+	{
+		DestroyTargets();
+		DeleteComputeProgram(m_resolveProgram);
+	}
+
+	void TemporalUpscaler::DestroyTargets()
+	{
+		DeleteFramebuffer(m_framebuffer);
+		for (auto& framebuffer : m_historyFramebuffers)
+		{
+			DeleteFramebuffer(framebuffer);
+		}
+		if (m_depth != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Renderbuffer, m_depth);
+			glDeleteRenderbuffers(1, &m_depth);
+			VEGAM_CHECK_GL_ERROR;
+			m_depth = 0;
+		}
+		DeleteTexture(m_color);
+		DeleteTexture(m_motion);
+		for (auto& history : m_history)
+		{
+			DeleteTexture(history);
+		}
+		m_historyValid = false;
+		m_displayWidth = 0;
+		m_displayHeight = 0;
+	}
+
+	bool TemporalUpscaler::Resize(int displayWidth,
+	                              int displayHeight)
+	{
+		DestroyTargets();
+		m_displayWidth = displayWidth;
+		m_displayHeight = displayHeight;
+
+		// The render size never exceeds the display size.
+		m_color = CreateTexture(displayWidth, displayHeight,
+		                        GL_RGBA16F, GL_NEAREST, 8,
+		                        "Upscaling scene");
+		m_motion = CreateTexture(displayWidth, displayHeight,
+		                         GL_RG16F, GL_NEAREST, 4,
+		                         "Upscaling motion");
+		glGenRenderbuffers(1, &m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		glBindRenderbuffer(GL_RENDERBUFFER, m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		glRenderbufferStorage(GL_RENDERBUFFER,
+		                      GL_DEPTH24_STENCIL8, displayWidth,
+		                      displayHeight);
+		VEGAM_CHECK_GL_ERROR;
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(
+		    GpuResources::Type::Renderbuffer, m_depth,
+		    static_cast<size_t>(displayWidth) * displayHeight
+		        * 4,
+		    "Upscaling depth");
+
+		CreateFramebuffer(m_framebuffer, m_color,
+		                  "Upscaling scene");
+		glFramebufferTexture2D(GL_FRAMEBUFFER,
+		                       GL_COLOR_ATTACHMENT1,
+		                       GL_TEXTURE_2D, m_motion, 0);
+		VEGAM_CHECK_GL_ERROR;
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER,
+		                          GL_DEPTH_STENCIL_ATTACHMENT,
+		                          GL_RENDERBUFFER, m_depth);
+		VEGAM_CHECK_GL_ERROR;
+		const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0,
+		                              GL_COLOR_ATTACHMENT1};
+		glDrawBuffers(2, drawBuffers);
+		VEGAM_CHECK_GL_ERROR;
+		auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		for (uint32_t i = 0; i < m_history.size()
+		                     && status == GL_FRAMEBUFFER_COMPLETE;
+		     ++i)
+		{
+			m_history[i] = CreateTexture(
+			    displayWidth, displayHeight, GL_RGBA16F,
+			    GL_LINEAR, 8, "Upscaling history");
+			CreateFramebuffer(m_historyFramebuffers[i],
+			                  m_history[i], "Upscaling history");
+			status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		if (status != GL_FRAMEBUFFER_COMPLETE)
+		{
+			VEGAM_ERROR("Upscaling target {}x{} incomplete: "
+			            "{:#x}",
+			            displayWidth, displayHeight, status);
+			DestroyTargets();
+			return false;
+		}
+		return true;
+	}
+
+	bool TemporalUpscaler::BeginFrame(int displayWidth,
+	                                  int displayHeight,
+	                                  int renderWidth,
+	                                  int renderHeight)
+	{
+		if (!IsInitialized())
+		{
+			return false;
+		}
+		if ((m_framebuffer == 0 || displayWidth != m_displayWidth
+		     || displayHeight != m_displayHeight)
+		    && !Resize(displayWidth, displayHeight))
+		{
+			return false;
+		}
+		m_renderWidth = std::clamp(renderWidth, 1, displayWidth);
+		m_renderHeight =
+		    std::clamp(renderHeight, 1, displayHeight);
+		m_renderSize.store(
+		    static_cast<uint64_t>(m_renderWidth) << 32
+		        | static_cast<uint32_t>(m_renderHeight),
+		    std::memory_order_relaxed);
+		Bind();
+		return true;
+	}
+
+	void TemporalUpscaler::ClearMotion()
+	{
+		const GLfloat zero[4] = {};
+		glClearBufferfv(GL_COLOR, 1, zero);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void TemporalUpscaler::Bind() const
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glViewport(0, 0, m_renderWidth, m_renderHeight);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void TemporalUpscaler::Resolve(uint32_t outputFramebuffer)
+	{
+		VEGAM_PROFILE_SCOPE("TemporalUpscaler::Resolve");
+		VEGAM_PROFILE_GPU_SCOPE("Temporal upscaling");
+		const auto jitter = GetPixelJitter(m_resolvedFrames++);
+		if (m_resetHistory.exchange(false,
+		                            std::memory_order_relaxed))
+		{
+			m_historyValid = false;
+		}
+
+		const auto previous = m_history[m_historyIndex];
+		m_historyIndex ^= 1;
+		const auto output = m_history[m_historyIndex];
+
+		Shader::UseProgram(m_resolveProgram);
+		glProgramUniform2i(m_resolveProgram,
+		                   m_renderSizeLocation, m_renderWidth,
+		                   m_renderHeight);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform2f(m_resolveProgram, m_jitterLocation,
+		                   jitter.x, jitter.y);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1f(
+		    m_resolveProgram, m_blendFactorLocation,
+		    m_historyValid ? blendFactorCVar.Get() : 1.0f);
+		VEGAM_CHECK_GL_ERROR;
+		const std::array<uint32_t, 3> textures = {
+		    m_color, m_motion, previous};
+		for (uint32_t unit = 0; unit < textures.size(); ++unit)
+		{
+			glActiveTexture(GL_TEXTURE0 + unit);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D, textures[unit]);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glBindImageTexture(0, output, 0, GL_FALSE, 0,
+		                   GL_WRITE_ONLY, GL_RGBA16F);
+		VEGAM_CHECK_GL_ERROR;
+		glDispatchCompute(
+		    static_cast<GLuint>((m_displayWidth + GroupSize - 1)
+		                        / GroupSize),
+		    static_cast<GLuint>((m_displayHeight + GroupSize - 1)
+		                        / GroupSize),
+		    1);
+		VEGAM_CHECK_GL_ERROR;
+		glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT
+		                | GL_TEXTURE_FETCH_BARRIER_BIT);
+		VEGAM_CHECK_GL_ERROR;
+		glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_READ_ONLY,
+		                   GL_RGBA16F);
+		VEGAM_CHECK_GL_ERROR;
+		for (uint32_t unit = 0; unit < textures.size(); ++unit)
+		{
+			glActiveTexture(GL_TEXTURE0 + unit);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D, 0);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glActiveTexture(GL_TEXTURE0);
+		VEGAM_CHECK_GL_ERROR;
+		m_historyValid = true;
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER,
+		                  m_historyFramebuffers[m_historyIndex]);
+		VEGAM_CHECK_GL_ERROR;
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, outputFramebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBlitFramebuffer(0, 0, m_displayWidth, m_displayHeight,
+		                  0, 0, m_displayWidth, m_displayHeight,
+		                  GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		VEGAM_CHECK_GL_ERROR;
+		glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glViewport(0, 0, m_displayWidth, m_displayHeight);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	Float2 TemporalUpscaler::GetPixelJitter(uint64_t frame) const
+	{
+		// Halton (2, 3): well spread over any run of
+		// frames. Index 0 of each sequence is 0, so start
+		// at 1.
+		const auto index =
+		    static_cast<uint32_t>(frame % m_jitterPhases) + 1;
+		return {Halton(index, 2) - 0.5f,
+		        Halton(index, 3) - 0.5f};
+	}
+
+	Float2 TemporalUpscaler::GetJitter() const
+	{
+		const auto size =
+		    m_renderSize.load(std::memory_order_relaxed);
+		const auto width = static_cast<float>(size >> 32);
+		const auto height = static_cast<float>(
+		    static_cast<uint32_t>(size));
+		if (width == 0.0f || height == 0.0f)
+		{
+			return {0.0f, 0.0f};
+		}
+		const auto jitter = GetPixelJitter(
+		    m_recordedFrames.load(std::memory_order_relaxed));
+		return {2.0f * jitter.x / width,
+		        2.0f * jitter.y / height};
+	}
+
+	Math::Mat4 TemporalUpscaler::JitterProjection(
+	    const Math::Mat4& projection) const
+	{
+		// Moves clip x and y by the jitter times w, i.e.
+		// NDC by the jitter.
+		const auto jitter = GetJitter();
+		return Math::Mat4::Translation({jitter.x, jitter.y, 0.0f})
+		       * projection;
+	}
+} // namespace AthiVegam::Graphics
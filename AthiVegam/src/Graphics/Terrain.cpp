@@ -0,0 +1,1011 @@
+#include "AthiVegam/Graphics/Terrain.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/CommandList.h"
+#include "AthiVegam/Graphics/ComputeProgram.h"
+#include "AthiVegam/Graphics/Culling.h"
+#include "AthiVegam/Graphics/GpuProfiler.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/RenderCommands.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Graphics/SortKey.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		// Vertices per side of a ring.
+		constexpr int32_t GridSize =
+		    static_cast<int32_t>(Terrain::TextureSize) - 1;
+		// Quads per side of a ring.
+		constexpr int32_t Extent = GridSize - 1;
+		// Vertices per side of a block; a ring is four
+		// blocks and a fixup across.
+		constexpr int32_t BlockSize = (GridSize + 1) / 4;
+		// The hole a ring leaves for the finer level, from
+		// Inner to Extent - Inner.
+		constexpr int32_t Inner = BlockSize - 1;
+		constexpr int32_t Fixup = 2 * (BlockSize - 1);
+		constexpr int32_t GroupSize = 8;
+
+		enum Piece : uint32_t
+		{
+			Block,
+			// Fill the gaps between the blocks across and
+			// along the ring.
+			FixupH,
+			FixupV,
+			// The L of a texel the finer level leaves at its
+			// side of the hole.
+			TrimV,
+			TrimH,
+			// Fills the finest level's hole.
+			Center,
+			PieceCount
+		};
+		static_assert(PieceCount
+		              == RenderCommands::DrawTerrain::MaxPieces);
+
+		struct PieceSize
+		{
+			int32_t width;
+			int32_t height;
+		};
+		constexpr PieceSize PieceSizes[PieceCount] = {
+		    {BlockSize, BlockSize},
+		    {BlockSize, 3},
+		    {3, BlockSize},
+		    {2, Extent - 2 * Inner + 1},
+		    {Extent - 2 * Inner, 2},
+		    {Extent - 2 * Inner + 1, Extent - 2 * Inner + 1}};
+
+		// Instance kinds of the vertex shader: trims place
+		// themselves from the levels' origins.
+		constexpr float FixedKind = 0.0f;
+		constexpr float TrimVKind = 1.0f;
+		constexpr float TrimHKind = 2.0f;
+
+		const char* DrawVertexSource = R"(#version 430 core
+layout(location = 0) in uvec2 Position;
+// Offset in the ring, level and kind.
+layout(location = 4) in vec4 Placement;
+
+layout(std140) uniform Constants
+{
+	mat4 ViewProjection;
+	// Finest spacing, height scale, levels and morph
+	// width in vertices.
+	vec4 Params;
+	// Ambient in w.
+	vec4 LightDirection;
+	vec4 Color;
+};
+
+layout(std140, binding = 4) uniform Levels
+{
+	ivec4 Origins[12];
+};
+
+layout(binding = 12) uniform sampler2DArray Heights;
+layout(binding = 13) uniform sampler2DArray Normals;
+
+out vec3 WorldPosition;
+out vec3 WorldNormal;
+
+const int Mask = 255;
+const float Middle = 127.0;
+
+float Height(ivec2 texel, int level)
+{
+	return texelFetch(Heights, ivec3(texel & Mask, level), 0).r
+	       * Params.y;
+}
+
+vec3 Normal(ivec2 texel, int level)
+{
+	return texelFetch(Normals, ivec3(texel & Mask, level), 0).xyz;
+}
+
+void main()
+{
+	int level = int(Placement.z);
+	int kind = int(Placement.w);
+	ivec2 origin = Origins[level].xy;
+	ivec2 offset = ivec2(Placement.xy);
+	if (kind != 0)
+	{
+		// The finer level sits 63 or 64 texels in; the
+		// trims take the side it leaves.
+		ivec2 inner = Origins[level - 1].xy / 2 - origin;
+		int trimX = inner.x == 64 ? 63 : 190;
+		int trimY = inner.y == 64 ? 63 : 190;
+		offset = kind == 1
+		             ? ivec2(trimX, 63)
+		             : ivec2(inner.x == 64 ? 64 : 63, trimY);
+	}
+	ivec2 local = offset + ivec2(Position);
+	ivec2 texel = origin + local;
+
+	float height = Height(texel, level);
+	vec3 normal = Normal(texel, level);
+	// Towards the edge, become the coarser level: a
+	// vertex between two of its vertices takes their
+	// average, so the rings meet without cracks.
+	if (level + 1 < int(Params.z))
+	{
+		vec2 t = (abs(vec2(local) - Middle)
+		          - (Middle - Params.w))
+		         / Params.w;
+		float morph = clamp(max(t.x, t.y), 0.0, 1.0);
+		if (morph > 0.0)
+		{
+			ivec2 a = texel >> 1;
+			ivec2 b = (texel + 1) >> 1;
+			float coarse = 0.5 * (Height(a, level + 1)
+			                      + Height(b, level + 1));
+			vec3 coarseNormal = Normal(a, level + 1)
+			                    + Normal(b, level + 1);
+			height = mix(height, coarse, morph);
+			normal = mix(normal, 0.5 * coarseNormal, morph);
+		}
+	}
+
+	vec2 xz = vec2(texel) * (Params.x * exp2(float(level)));
+	WorldPosition = vec3(xz.x, height, xz.y);
+	WorldNormal = normal;
+	gl_Position = ViewProjection * vec4(WorldPosition, 1.0);
+}
+)";
+
+		const char* DrawFragmentSource = R"(#version 430 core
+in vec3 WorldPosition;
+in vec3 WorldNormal;
+
+layout(std140) uniform Constants
+{
+	mat4 ViewProjection;
+	vec4 Params;
+	vec4 LightDirection;
+	vec4 Color;
+};
+
+layout(location = 0) out vec4 OutColor;
+
+void main()
+{
+	vec3 normal = normalize(WorldNormal);
+	float diffuse = max(dot(normal, -LightDirection.xyz), 0.0);
+	OutColor = vec4(Color.rgb * (LightDirection.w + diffuse),
+	                1.0);
+}
+)";
+
+		// Central differences over a level's window, which
+		// clamp at its edges; past them nothing is loaded.
+		const char* NormalsSource = R"(#version 430 core
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0) uniform sampler2DArray Heights;
+layout(rgba8_snorm, binding = 0) writeonly uniform image2DArray
+    Normals;
+
+uniform int Level;
+uniform ivec2 Origin;
+uniform float Spacing;
+uniform float HeightScale;
+
+const int Mask = 255;
+
+float Height(ivec2 local)
+{
+	local = clamp(local, ivec2(0), ivec2(Mask));
+	ivec2 texel = (Origin + local) & Mask;
+	return texelFetch(Heights, ivec3(texel, Level), 0).r
+	       * HeightScale;
+}
+
+void main()
+{
+	ivec2 local = ivec2(gl_GlobalInvocationID.xy);
+	float dx = Height(local + ivec2(1, 0))
+	           - Height(local - ivec2(1, 0));
+	float dz = Height(local + ivec2(0, 1))
+	           - Height(local - ivec2(0, 1));
+	vec3 normal = normalize(vec3(-dx, 2.0 * Spacing, -dz));
+	imageStore(Normals, ivec3((Origin + local) & Mask, Level),
+	           vec4(normal, 0.0));
+}
+)";
+
+		struct DrawConstants
+		{
+			float viewProjection[16];
+			float params[4];
+			float lightDirection[4];
+			float color[4];
+		};
+
+		// Mirrors the Levels block.
+		struct LevelsData
+		{
+			int32_t origins[Terrain::MaxLevels][4];
+		};
+
+		constexpr float Ambient = 0.25f;
+
+		inline GLint Location(uint32_t program,
+		                      const char* name)
+		{
+			const auto location =
+			    glGetUniformLocation(program, name);
+			VEGAM_CHECK_GL_ERROR;
+			return location;
+		}
+
+		// Where a level's window goes inside the next
+		// coarser one: the finer lands 63 or 64 texels in,
+		// whichever keeps the coarser origin even, so
+		// every level's vertices fall on the next one's.
+		inline int32_t CoarserOrigin(int32_t finer)
+		{
+			const auto origin = finer / 2 - Inner;
+			return (origin & 1) != 0 ? origin - 1 : origin;
+		}
+
+		// Whether the box is inside or crosses every plane.
+		bool Intersects(const Frustum& frustum,
+		                const Float3& min, const Float3& max)
+		{
+			for (const auto& plane : frustum.planes)
+			{
+				const auto x = plane.x >= 0.0f ? max.x : min.x;
+				const auto y = plane.y >= 0.0f ? max.y : min.y;
+				const auto z = plane.z >= 0.0f ? max.z : min.z;
+				if (plane.x * x + plane.y * y + plane.z * z
+				        + plane.w
+				    < 0.0f)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		uint32_t CreateTextureArray(GLenum format,
+		                            uint32_t layers,
+		                            size_t texelSize,
+		                            const char* label)
+		{
+			uint32_t texture = 0;
+			glGenTextures(1, &texture);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+			VEGAM_CHECK_GL_ERROR;
+			glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, format,
+			               Terrain::TextureSize,
+			               Terrain::TextureSize,
+			               static_cast<GLsizei>(layers));
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+			                GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+			                GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(
+			    GpuResources::Type::Texture, texture,
+			    size_t{Terrain::TextureSize}
+			        * Terrain::TextureSize * layers * texelSize,
+			    label);
+			return texture;
+		}
+
+		void DeleteTexture(uint32_t& texture)
+		{
+			if (texture == 0)
+			{
+				return;
+			}
+			GpuResources::Unregister(GpuResources::Type::Texture,
+			                         texture);
+			glDeleteTextures(1, &texture);
+			VEGAM_CHECK_GL_ERROR;
+			texture = 0;
+		}
+
+		uint32_t CreateBuffer(GLenum target, size_t size,
+		                      const void* data, GLenum usage,
+		                      const char* label)
+		{
+			uint32_t buffer = 0;
+			glGenBuffers(1, &buffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBindBuffer(target, buffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBufferData(target, static_cast<GLsizeiptr>(size),
+			             data, usage);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(GpuResources::Type::Buffer,
+			                       buffer, size, label);
+			return buffer;
+		}
+
+		void DeleteBuffer(uint32_t& buffer)
+		{
+			if (buffer == 0)
+			{
+				return;
+			}
+			GpuResources::Unregister(GpuResources::Type::Buffer,
+			                         buffer);
+			glDeleteBuffers(1, &buffer);
+			VEGAM_CHECK_GL_ERROR;
+			buffer = 0;
+		}
+	} // namespace
+
+	Terrain::Terrain(const Settings& settings)
+	    : m_settings(settings)
+	{
+		VEGAM_ASSERT(settings.heightfieldWidth > 0
+		                 && settings.heightfieldHeight > 0,
+		             "Terrain needs a heightfield size");
+		VEGAM_ASSERT(settings.levels > 0
+		                 && settings.levels <= MaxLevels,
+		             "Invalid terrain level count");
+		VEGAM_ASSERT(settings.gridSpacing > 0.0f,
+		             "Terrain grid spacing must be positive");
+	}
+
+	Terrain::~Terrain()
+	{
+		VEGAM_ASSERT(!IsInitialized(),
+		             "Terrain destroyed without Shutdown()");
+	}
+
+	bool Terrain::Initialize()
+	{
+		if (IsInitialized())
+		{
+			return true;
+		}
+		if (!GLAD_GL_VERSION_4_3)
+		{
+			VEGAM_WARN("Terrain needs a GL 4.3 context");
+			return false;
+		}
+		if (!m_heightfield.Open(m_settings.heightfieldPath))
+		{
+			VEGAM_ERROR("Failed to map heightfield {}",
+			            m_settings.heightfieldPath);
+			return false;
+		}
+		const auto expected = size_t{m_settings.heightfieldWidth}
+		                      * m_settings.heightfieldHeight
+		                      * sizeof(uint16_t);
+		if (m_heightfield.GetSize() < expected)
+		{
+			VEGAM_ERROR("Heightfield {} is {} bytes, expected {}",
+			            m_settings.heightfieldPath,
+			            m_heightfield.GetSize(), expected);
+			m_heightfield.Close();
+			return false;
+		}
+
+		m_normalsProgram = CreateComputeProgram(
+		    NormalsSource, "Terrain normals");
+		if (!m_normalsProgram)
+		{
+			m_heightfield.Close();
+			return false;
+		}
+		m_drawShader = std::make_unique<Shader>(
+		    DrawVertexSource,
+		    m_settings.fragmentSource.empty()
+		        ? std::string(DrawFragmentSource)
+		        : m_settings.fragmentSource);
+
+		const auto levels = m_settings.levels;
+		m_heights = CreateTextureArray(GL_R16, levels,
+		                               sizeof(uint16_t),
+		                               "Terrain heights");
+		m_normals = CreateTextureArray(GL_RGBA8_SNORM, levels,
+		                               4, "Terrain normals");
+		m_levelsBuffer =
+		    CreateBuffer(GL_UNIFORM_BUFFER, sizeof(LevelsData),
+		                 nullptr, GL_DYNAMIC_DRAW,
+		                 "Terrain levels");
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		BuildPieces();
+
+		m_uploaded = false;
+		VEGAM_INFO("Terrain of {} levels over a {}x{} "
+		           "heightfield",
+		           levels, m_settings.heightfieldWidth,
+		           m_settings.heightfieldHeight);
+		return true;
+	}
+
+	void Terrain::Shutdown()
+	{
+		DeleteComputeProgram(m_normalsProgram);
+		m_drawShader.reset();
+		if (m_vao != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::VertexArray, m_vao);
+			glDeleteVertexArrays(1, &m_vao);
+			VEGAM_CHECK_GL_ERROR;
+			m_vao = 0;
+		}
+		DeleteBuffer(m_vertexBuffer);
+		DeleteBuffer(m_indexBuffer);
+		DeleteBuffer(m_levelsBuffer);
+		DeleteTexture(m_heights);
+		DeleteTexture(m_normals);
+		m_pieces.clear();
+		m_staging = {};
+		m_heightfield.Close();
+		m_uploaded = false;
+	}
+
+	void Terrain::BuildPieces()
+	{
+		// Grids of local vertex coordinates, each piece's
+		// indices relative to its first vertex. Every quad
+		// splits along the same diagonal, which the vertex
+		// shader's morph assumes.
+		std::vector<uint16_t> vertices;
+		std::vector<uint16_t> indices;
+		m_pieces.clear();
+		for (const auto& size : PieceSizes)
+		{
+			Piece piece;
+			piece.firstIndex =
+			    static_cast<uint32_t>(indices.size());
+			piece.baseVertex =
+			    static_cast<uint32_t>(vertices.size() / 2);
+			for (int32_t y = 0; y < size.height; ++y)
+			{
+				for (int32_t x = 0; x < size.width; ++x)
+				{
+					vertices.push_back(static_cast<uint16_t>(x));
+					vertices.push_back(static_cast<uint16_t>(y));
+				}
+			}
+			const auto vertex = [&](int32_t x, int32_t y) {
+				return static_cast<uint16_t>(y * size.width + x);
+			};
+			for (int32_t y = 0; y + 1 < size.height; ++y)
+			{
+				for (int32_t x = 0; x + 1 < size.width; ++x)
+				{
+					// Counter-clockwise seen from above.
+					indices.push_back(vertex(x, y));
+					indices.push_back(vertex(x, y + 1));
+					indices.push_back(vertex(x + 1, y + 1));
+					indices.push_back(vertex(x, y));
+					indices.push_back(vertex(x + 1, y + 1));
+					indices.push_back(vertex(x + 1, y));
+				}
+			}
+			piece.indexCount =
+			    static_cast<uint32_t>(indices.size())
+			    - piece.firstIndex;
+			m_pieces.push_back(piece);
+		}
+
+		glGenVertexArrays(1, &m_vao);
+		VEGAM_CHECK_GL_ERROR;
+		glBindVertexArray(m_vao);
+		VEGAM_CHECK_GL_ERROR;
+		m_vertexBuffer = CreateBuffer(
+		    GL_ARRAY_BUFFER, vertices.size() * sizeof(uint16_t),
+		    vertices.data(), GL_STATIC_DRAW, "Terrain pieces");
+		glEnableVertexAttribArray(0);
+		VEGAM_CHECK_GL_ERROR;
+		glVertexAttribIPointer(0, 2, GL_UNSIGNED_SHORT,
+		                       2 * sizeof(uint16_t), nullptr);
+		VEGAM_CHECK_GL_ERROR;
+		m_indexBuffer = CreateBuffer(
+		    GL_ELEMENT_ARRAY_BUFFER,
+		    indices.size() * sizeof(uint16_t), indices.data(),
+		    GL_STATIC_DRAW, "Terrain piece indices");
+		glBindVertexArray(0);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::VertexArray,
+		                       m_vao, 0, "Terrain");
+	}
+
+	void Terrain::ComputeOrigins(const Float3& eye,
+	                             Origins& origins) const
+	{
+		// The finest window centered on the eye, and even
+		// like every other.
+		const auto center = [&](float position) {
+			const auto texel = static_cast<int32_t>(
+			    std::floor(position / m_settings.gridSpacing));
+			return (texel - Extent / 2) & ~1;
+		};
+		origins[0] = {center(eye.x), center(eye.z)};
+		for (uint32_t level = 1; level < m_settings.levels;
+		     ++level)
+		{
+			const auto& finer = origins[level - 1];
+			origins[level] = {CoarserOrigin(finer.x),
+			                  CoarserOrigin(finer.y)};
+		}
+	}
+
+	void Terrain::Update(const Float3& eye)
+	{
+		if (!IsInitialized())
+		{
+			return;
+		}
+		VEGAM_PROFILE_SCOPE("Terrain::Update");
+		VEGAM_PROFILE_GPU_SCOPE("Terrain");
+
+		Origins origins{};
+		ComputeOrigins(eye, origins);
+		if (!m_uploaded)
+		{
+			m_lastEye = eye;
+		}
+		constexpr auto Size =
+		    static_cast<int64_t>(TextureSize);
+		bool moved = false;
+		for (uint32_t level = 0; level < m_settings.levels;
+		     ++level)
+		{
+			const auto& from = m_origins[level];
+			const auto& to = origins[level];
+			if (m_uploaded && from == to)
+			{
+				continue;
+			}
+			const auto dx = int64_t{to.x} - from.x;
+			const auto dy = int64_t{to.y} - from.y;
+			if (!m_uploaded || std::abs(dx) >= Size
+			    || std::abs(dy) >= Size)
+			{
+				UploadRegion(level, to.x, to.y, TextureSize,
+				             TextureSize);
+			}
+			else
+			{
+				// Only the strips the move exposes; the
+				// rest stays where it wrapped to.
+				const auto columns =
+				    static_cast<uint32_t>(std::abs(dx));
+				const auto rows =
+				    static_cast<uint32_t>(std::abs(dy));
+				if (columns != 0)
+				{
+					// Past the old window, or from the new.
+					auto x = to.x;
+					if (dx > 0)
+					{
+						x = static_cast<int32_t>(from.x + Size);
+					}
+					UploadRegion(level, x, to.y, columns,
+					             TextureSize);
+				}
+				if (rows != 0)
+				{
+					auto y = to.y;
+					if (dy > 0)
+					{
+						y = static_cast<int32_t>(from.y + Size);
+					}
+					UploadRegion(level, to.x, y, TextureSize,
+					             rows);
+				}
+			}
+			m_origins[level] = to;
+			// The whole level, as the old edge's normals were
+			// clamped. Cheaper than tracking the strips.
+			GenerateNormals(level);
+			if (level == 0)
+			{
+				Prefetch({eye.x - m_lastEye.x, 0.0f,
+				          eye.z - m_lastEye.z});
+				m_lastEye = eye;
+			}
+			moved = true;
+		}
+		m_uploaded = true;
+		if (!moved)
+		{
+			return;
+		}
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+		VEGAM_CHECK_GL_ERROR;
+
+		LevelsData data{};
+		for (uint32_t level = 0; level < m_settings.levels;
+		     ++level)
+		{
+			data.origins[level][0] = m_origins[level].x;
+			data.origins[level][1] = m_origins[level].y;
+		}
+		glBindBuffer(GL_UNIFORM_BUFFER, m_levelsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(data),
+		                &data);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Terrain::UploadRegion(uint32_t level, int32_t x,
+	                           int32_t y, uint32_t width,
+	                           uint32_t height)
+	{
+		constexpr auto Mask = TextureSize - 1;
+		const auto stride = int64_t{1} << level;
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_heights);
+		VEGAM_CHECK_GL_ERROR;
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+		VEGAM_CHECK_GL_ERROR;
+		// Split where the region wraps around the window.
+		for (uint32_t row = 0; row < height;)
+		{
+			const auto ty = static_cast<uint32_t>(y + row) & Mask;
+			const auto rows =
+			    std::min(height - row, TextureSize - ty);
+			for (uint32_t column = 0; column < width;)
+			{
+				const auto tx =
+				    static_cast<uint32_t>(x + column) & Mask;
+				const auto columns =
+				    std::min(width - column, TextureSize - tx);
+				m_staging.resize(size_t{rows} * columns);
+				for (uint32_t j = 0; j < rows; ++j)
+				{
+					const auto sy =
+					    (int64_t{y} + row + j) * stride;
+					for (uint32_t i = 0; i < columns; ++i)
+					{
+						const auto sx =
+						    (int64_t{x} + column + i) * stride;
+						m_staging[size_t{j} * columns + i] =
+						    SampleHeight(sx, sy);
+					}
+				}
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0,
+				                static_cast<GLint>(tx),
+				                static_cast<GLint>(ty),
+				                static_cast<GLint>(level),
+				                static_cast<GLsizei>(columns),
+				                static_cast<GLsizei>(rows), 1,
+				                GL_RED, GL_UNSIGNED_SHORT,
+				                m_staging.data());
+				VEGAM_CHECK_GL_ERROR;
+				column += columns;
+			}
+			row += rows;
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Terrain::GenerateNormals(uint32_t level)
+	{
+		const auto program = m_normalsProgram;
+		const auto& origin = m_origins[level];
+		glProgramUniform1i(program, Location(program, "Level"),
+		                   static_cast<GLint>(level));
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform2i(program, Location(program, "Origin"),
+		                   origin.x, origin.y);
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1f(
+		    program, Location(program, "Spacing"),
+		    std::ldexp(m_settings.gridSpacing,
+		               static_cast<int>(level)));
+		VEGAM_CHECK_GL_ERROR;
+		glProgramUniform1f(program,
+		                   Location(program, "HeightScale"),
+		                   m_settings.heightScale);
+		VEGAM_CHECK_GL_ERROR;
+
+		Shader::UseProgram(program);
+		glActiveTexture(GL_TEXTURE0);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_heights);
+		VEGAM_CHECK_GL_ERROR;
+		glBindImageTexture(0, m_normals, 0, GL_TRUE, 0,
+		                   GL_WRITE_ONLY, GL_RGBA8_SNORM);
+		VEGAM_CHECK_GL_ERROR;
+		const auto groups = TextureSize / GroupSize;
+		glDispatchCompute(groups, groups, 1);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Terrain::Prefetch(const Float3& motion)
+	{
+		// The finest level's texels are the heightfield's;
+		// ask for the strip it moves into next. Coarser
+		// levels read every few rows over a wider area
+		// and are left to page faults.
+		const auto ahead =
+		    static_cast<int64_t>(m_settings.prefetchTexels);
+		if (ahead == 0)
+		{
+			return;
+		}
+		const auto width = int64_t{m_settings.heightfieldWidth};
+		const auto height =
+		    int64_t{m_settings.heightfieldHeight};
+		const auto size = static_cast<int64_t>(TextureSize);
+		const auto& origin = m_origins[0];
+		const auto prefetch = [&](int64_t x0, int64_t x1,
+		                          int64_t y0, int64_t y1) {
+			x0 = std::clamp<int64_t>(x0, 0, width);
+			x1 = std::clamp<int64_t>(x1, 0, width);
+			y0 = std::clamp<int64_t>(y0, 0, height);
+			y1 = std::clamp<int64_t>(y1, 0, height);
+			if (x0 >= x1)
+			{
+				return;
+			}
+			for (auto y = y0; y < y1; ++y)
+			{
+				m_heightfield.Prefetch(
+				    static_cast<size_t>(y * width + x0)
+				        * sizeof(uint16_t),
+				    static_cast<size_t>(x1 - x0)
+				        * sizeof(uint16_t));
+			}
+		};
+		if (motion.x > 0.0f)
+		{
+			prefetch(origin.x + size, origin.x + size + ahead,
+			         origin.y, origin.y + size);
+		}
+		else if (motion.x < 0.0f)
+		{
+			prefetch(origin.x - ahead, origin.x, origin.y,
+			         origin.y + size);
+		}
+		if (motion.z > 0.0f)
+		{
+			prefetch(origin.x, origin.x + size,
+			         origin.y + size, origin.y + size + ahead);
+		}
+		else if (motion.z < 0.0f)
+		{
+			prefetch(origin.x, origin.x + size,
+			         origin.y - ahead, origin.y);
+		}
+	}
+
+	uint16_t Terrain::SampleHeight(int64_t x, int64_t y) const
+	{
+		x = std::clamp<int64_t>(
+		    x, 0, int64_t{m_settings.heightfieldWidth} - 1);
+		y = std::clamp<int64_t>(
+		    y, 0, int64_t{m_settings.heightfieldHeight} - 1);
+		const auto* texel =
+		    m_heightfield.GetData()
+		    + static_cast<size_t>(
+		          y * m_settings.heightfieldWidth + x)
+		          * sizeof(uint16_t);
+		return static_cast<uint16_t>(texel[0] | (texel[1] << 8));
+	}
+
+	float Terrain::GetHeight(float x, float z) const
+	{
+		if (!m_heightfield.IsOpen())
+		{
+			return 0.0f;
+		}
+		const auto fx = x / m_settings.gridSpacing;
+		const auto fz = z / m_settings.gridSpacing;
+		const auto x0 = static_cast<int64_t>(std::floor(fx));
+		const auto z0 = static_cast<int64_t>(std::floor(fz));
+		const auto tx = fx - static_cast<float>(x0);
+		const auto tz = fz - static_cast<float>(z0);
+		const auto at = [&](int64_t i, int64_t j) {
+			return static_cast<float>(SampleHeight(i, j));
+		};
+		const auto top =
+		    at(x0, z0) + (at(x0 + 1, z0) - at(x0, z0)) * tx;
+		const auto bottom =
+		    at(x0, z0 + 1)
+		    + (at(x0 + 1, z0 + 1) - at(x0, z0 + 1)) * tx;
+		return (top + (bottom - top) * tz)
+		       * (m_settings.heightScale / 65535.0f);
+	}
+
+	void Terrain::Draw(CommandList& list,
+	                   const float viewProjection[16],
+	                   const Float3& eye,
+	                   uint8_t renderLayer) const
+	{
+		if (!IsInitialized())
+		{
+			return;
+		}
+		const auto levels = m_settings.levels;
+		DrawConstants constants;
+		std::memcpy(constants.viewProjection, viewProjection,
+		            sizeof(constants.viewProjection));
+		constants.params[0] = m_settings.gridSpacing;
+		constants.params[1] = m_settings.heightScale;
+		constants.params[2] = static_cast<float>(levels);
+		constants.params[3] = static_cast<float>(GridSize / 10);
+		const auto& light = m_settings.lightDirection;
+		const auto length = std::sqrt(light.x * light.x
+		                              + light.y * light.y
+		                              + light.z * light.z);
+		const auto scale = length > 0.0f ? 1.0f / length : 0.0f;
+		constants.lightDirection[0] = light.x * scale;
+		constants.lightDirection[1] = light.y * scale;
+		constants.lightDirection[2] = light.z * scale;
+		constants.lightDirection[3] = Ambient;
+		constants.color[0] = m_settings.color.x;
+		constants.color[1] = m_settings.color.y;
+		constants.color[2] = m_settings.color.z;
+		constants.color[3] = 1.0f;
+
+		// The same origins Update() moved to, to cull with.
+		Origins origins{};
+		ComputeOrigins(eye, origins);
+		const auto frustum = Frustum::FromMatrix(viewProjection);
+
+		std::vector<RenderCommands::InstanceTransform> instances;
+		std::array<uint32_t, PieceCount> counts{};
+		const auto place = [&](uint32_t piece, uint32_t level,
+		                       int32_t x, int32_t y, float kind) {
+			const auto spacing = std::ldexp(
+			    m_settings.gridSpacing, static_cast<int>(level));
+			const auto& origin = origins[level];
+			const auto& size = PieceSizes[piece];
+			const Float3 min{
+			    static_cast<float>(origin.x + x) * spacing, 0.0f,
+			    static_cast<float>(origin.y + y) * spacing};
+			const Float3 max{
+			    min.x + static_cast<float>(size.width - 1)
+			                * spacing,
+			    m_settings.heightScale,
+			    min.z + static_cast<float>(size.height - 1)
+			                * spacing};
+			if (!Intersects(frustum, min, max))
+			{
+				return;
+			}
+			RenderCommands::InstanceTransform instance{};
+			instance.m[0] = static_cast<float>(x);
+			instance.m[1] = static_cast<float>(y);
+			instance.m[2] = static_cast<float>(level);
+			instance.m[3] = kind;
+			instances.push_back(instance);
+			++counts[piece];
+		};
+
+		constexpr int32_t Blocks[4] = {
+		    0, Inner, Extent - Inner - BlockSize + 1,
+		    Extent - BlockSize + 1};
+		for (uint32_t piece = 0; piece < PieceCount; ++piece)
+		{
+			for (uint32_t level = 0; level < levels; ++level)
+			{
+				const auto& origin = origins[level];
+				const auto inner =
+				    level > 0 ? Origin{origins[level - 1].x / 2
+				                           - origin.x,
+				                       origins[level - 1].y / 2
+				                           - origin.y}
+				              : Origin{0, 0};
+				const auto trim = [](int32_t offset) {
+					return offset == BlockSize
+					           ? Inner
+					           : Extent - Inner - 1;
+				};
+				switch (piece)
+				{
+				case Block:
+					for (uint32_t j = 0; j < 4; ++j)
+					{
+						for (uint32_t i = 0; i < 4; ++i)
+						{
+							if ((i == 1 || i == 2)
+							    && (j == 1 || j == 2))
+							{
+								continue;
+							}
+							place(piece, level, Blocks[i],
+							      Blocks[j], FixedKind);
+						}
+					}
+					break;
+				case FixupH:
+					place(piece, level, Blocks[0], Fixup,
+					      FixedKind);
+					place(piece, level, Blocks[3], Fixup,
+					      FixedKind);
+					break;
+				case FixupV:
+					place(piece, level, Fixup, Blocks[0],
+					      FixedKind);
+					place(piece, level, Fixup, Blocks[3],
+					      FixedKind);
+					break;
+				case TrimV:
+					if (level > 0)
+					{
+						place(piece, level, trim(inner.x), Inner,
+						      TrimVKind);
+					}
+					break;
+				case TrimH:
+					if (level > 0)
+					{
+						place(piece, level,
+						      inner.x == BlockSize ? BlockSize
+						                           : Inner,
+						      trim(inner.y), TrimHKind);
+					}
+					break;
+				case Center:
+					if (level == 0)
+					{
+						place(piece, level, Inner, Inner,
+						      FixedKind);
+					}
+					break;
+				default:
+					break;
+				}
+			}
+		}
+		if (instances.empty())
+		{
+			return;
+		}
+
+		const auto first = list.PushInstances(
+		    instances.data(),
+		    static_cast<uint32_t>(instances.size()));
+		RenderCommands::DrawTerrain command{};
+		command.program = m_drawShader->GetId();
+		command.vao = m_vao;
+		command.heights = m_heights;
+		command.normals = m_normals;
+		command.levelsBuffer = m_levelsBuffer;
+		command.constants = list.PushConstants(constants);
+		command.pieceCount = PieceCount;
+		auto instance = first;
+		for (uint32_t i = 0; i < PieceCount; ++i)
+		{
+			auto& piece = command.pieces[i];
+			piece.indexCount = m_pieces[i].indexCount;
+			piece.firstIndex = m_pieces[i].firstIndex;
+			piece.baseVertex = m_pieces[i].baseVertex;
+			piece.firstInstance = instance;
+			piece.instanceCount = counts[i];
+			instance += counts[i];
+		}
+		list.Submit(command,
+		            SortKey::Make(renderLayer, false, 0, 0, 0));
+	}
+} // namespace AthiVegam::Graphics
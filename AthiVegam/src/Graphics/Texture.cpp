@@ -0,0 +1,809 @@
+#include "AthiVegam/Graphics/Texture.h"
+
+#include "AthiVegam/Graphics/GpuMemory.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/RetireQueue.h"
+#include "AthiVegam/Log.h"
+#include "SDL2/SDL.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <utility>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		// Extension formats glad was not generated with.
+		constexpr GLenum RGBA_S3TC_DXT1 = 0x83F1;
+		constexpr GLenum RGBA_S3TC_DXT5 = 0x83F3;
+		constexpr GLenum SRGB_ALPHA_S3TC_DXT1 = 0x8C4D;
+		constexpr GLenum SRGB_ALPHA_S3TC_DXT5 = 0x8C4F;
+		constexpr GLenum RGBA_ASTC_4x4 = 0x93B0;
+		constexpr GLenum RGBA_ASTC_6x6 = 0x93B4;
+		constexpr GLenum RGBA_ASTC_8x8 = 0x93B7;
+		constexpr GLenum SRGB8_ALPHA8_ASTC_4x4 = 0x93D0;
+		constexpr GLenum SRGB8_ALPHA8_ASTC_6x6 = 0x93D4;
+		constexpr GLenum SRGB8_ALPHA8_ASTC_8x8 = 0x93D7;
+
+		enum class Support : uint8_t
+		{
+			Core,
+			S3tc,
+			S3tcSrgb,
+			Bptc,
+			Etc2,
+			Astc
+		};
+
+		struct FormatInfo
+		{
+			GLenum internalFormat;
+			uint8_t blockWidth;
+			uint8_t blockHeight;
+			uint8_t blockBytes;
+			bool compressed;
+			Support support;
+			const char* name;
+		};
+
+		constexpr std::array<FormatInfo,
+		                     static_cast<size_t>(
+		                         TextureFormat::COUNT)>
+		    formatInfo{{
+		        {GL_RGBA8, 1, 1, 4, false, Support::Core,
+		         "RGBA8"},
+		        {GL_SRGB8_ALPHA8, 1, 1, 4, false, Support::Core,
+		         "RGBA8 sRGB"},
+		        {GL_R8, 1, 1, 1, false, Support::Core, "R8"},
+		        {RGBA_S3TC_DXT1, 4, 4, 8, true, Support::S3tc,
+		         "BC1"},
+		        {SRGB_ALPHA_S3TC_DXT1, 4, 4, 8, true,
+		         Support::S3tcSrgb, "BC1 sRGB"},
+		        {RGBA_S3TC_DXT5, 4, 4, 16, true, Support::S3tc,
+		         "BC3"},
+		        {SRGB_ALPHA_S3TC_DXT5, 4, 4, 16, true,
+		         Support::S3tcSrgb, "BC3 sRGB"},
+		        {GL_COMPRESSED_RED_RGTC1, 4, 4, 8, true,
+		         Support::Core, "BC4"},
+		        {GL_COMPRESSED_RG_RGTC2, 4, 4, 16, true,
+		         Support::Core, "BC5"},
+		        {GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, 4, 4, 16,
+		         true, Support::Bptc, "BC6H"},
+		        {GL_COMPRESSED_RGBA_BPTC_UNORM, 4, 4, 16, true,
+		         Support::Bptc, "BC7"},
+		        {GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, 4, 4, 16,
+		         true, Support::Bptc, "BC7 sRGB"},
+		        {GL_COMPRESSED_RGB8_ETC2, 4, 4, 8, true,
+		         Support::Etc2, "ETC2 RGB8"},
+		        {GL_COMPRESSED_SRGB8_ETC2, 4, 4, 8, true,
+		         Support::Etc2, "ETC2 RGB8 sRGB"},
+		        {GL_COMPRESSED_RGBA8_ETC2_EAC, 4, 4, 16, true,
+		         Support::Etc2, "ETC2 RGBA8"},
+		        {GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC, 4, 4, 16,
+		         true, Support::Etc2, "ETC2 RGBA8 sRGB"},
+		        {RGBA_ASTC_4x4, 4, 4, 16, true, Support::Astc,
+		         "ASTC 4x4"},
+		        {SRGB8_ALPHA8_ASTC_4x4, 4, 4, 16, true,
+		         Support::Astc, "ASTC 4x4 sRGB"},
+		        {RGBA_ASTC_6x6, 6, 6, 16, true, Support::Astc,
+		         "ASTC 6x6"},
+		        {SRGB8_ALPHA8_ASTC_6x6, 6, 6, 16, true,
+		         Support::Astc, "ASTC 6x6 sRGB"},
+		        {RGBA_ASTC_8x8, 8, 8, 16, true, Support::Astc,
+		         "ASTC 8x8"},
+		        {SRGB8_ALPHA8_ASTC_8x8, 8, 8, 16, true,
+		         Support::Astc, "ASTC 8x8 sRGB"},
+		    }};
+
+		inline const FormatInfo& GetInfo(TextureFormat format)
+		{
+			return formatInfo[static_cast<size_t>(format)];
+		}
+
+		// Of uncompressed formats, whose rows are tightly
+		// packed.
+		GLenum GetPixelFormat(const FormatInfo& info)
+		{
+			const auto red = info.internalFormat == GL_R8;
+			glPixelStorei(GL_UNPACK_ALIGNMENT, red ? 1 : 4);
+			VEGAM_CHECK_GL_ERROR;
+			return red ? GL_RED : GL_RGBA;
+		}
+
+		struct Capabilities
+		{
+			bool s3tc = false;
+			bool s3tcSrgb = false;
+			bool astc = false;
+			bool anisotropy = false;
+			float maxAnisotropy = 1.0f;
+			bool bindless = false;
+		};
+
+		// From GL_ARB_bindless_texture, loaded when the
+		// extension is there.
+		using GetTextureHandleFn = GLuint64(APIENTRYP)(GLuint);
+		using MakeHandleResidentFn = void(APIENTRYP)(GLuint64);
+		GetTextureHandleFn getTextureHandle = nullptr;
+		MakeHandleResidentFn makeHandleResident = nullptr;
+		MakeHandleResidentFn makeHandleNonResident = nullptr;
+
+		// Queried on first use, from the GL thread.
+		const Capabilities& GetCapabilities()
+		{
+			static const auto capabilities = [] {
+				Capabilities result;
+				GLint count = 0;
+				glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+				VEGAM_CHECK_GL_ERROR;
+				for (GLint i = 0; i < count; ++i)
+				{
+					const std::string_view extension(
+					    reinterpret_cast<const char*>(
+					        glGetStringi(GL_EXTENSIONS, i)));
+					VEGAM_CHECK_GL_ERROR;
+					if (extension
+					    == "GL_EXT_texture_compression_s3tc")
+					{
+						result.s3tc = true;
+					}
+					else if (extension == "GL_EXT_texture_sRGB"
+					         || extension
+					                == "GL_EXT_texture_"
+					                   "compression_s3tc_srgb")
+					{
+						result.s3tcSrgb = true;
+					}
+					else if (extension
+					         == "GL_KHR_texture_compression_"
+					            "astc_ldr")
+					{
+						result.astc = true;
+					}
+					else if (extension
+					             == "GL_EXT_texture_filter_"
+					                "anisotropic"
+					         || extension
+					                == "GL_ARB_texture_filter_"
+					                   "anisotropic")
+					{
+						result.anisotropy = true;
+					}
+					else if (extension
+					         == "GL_ARB_bindless_texture")
+					{
+						result.bindless = true;
+					}
+				}
+				result.s3tcSrgb = result.s3tcSrgb && result.s3tc;
+				result.anisotropy =
+				    result.anisotropy
+				    || GLVersion.major > 4
+				    || (GLVersion.major == 4
+				        && GLVersion.minor >= 6);
+				if (result.anisotropy)
+				{
+					glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY,
+					            &result.maxAnisotropy);
+					VEGAM_CHECK_GL_ERROR;
+				}
+				if (result.bindless)
+				{
+					getTextureHandle =
+					    reinterpret_cast<GetTextureHandleFn>(
+					        SDL_GL_GetProcAddress(
+					            "glGetTextureHandleARB"));
+					makeHandleResident =
+					    reinterpret_cast<MakeHandleResidentFn>(
+					        SDL_GL_GetProcAddress(
+					            "glMakeTextureHandleResidentARB"));
+					makeHandleNonResident =
+					    reinterpret_cast<MakeHandleResidentFn>(
+					        SDL_GL_GetProcAddress(
+					            "glMakeTextureHandleNonResident"
+					            "ARB"));
+					result.bindless = getTextureHandle
+					                  && makeHandleResident
+					                  && makeHandleNonResident;
+				}
+				return result;
+			}();
+			return capabilities;
+		}
+
+		inline bool HasVersion(int major, int minor)
+		{
+			return GLVersion.major > major
+			       || (GLVersion.major == major
+			           && GLVersion.minor >= minor);
+		}
+	} // namespace
+
+	namespace
+	{
+		inline GLenum GetTarget(const TextureDesc& desc)
+		{
+			return desc.type == TextureType::Array
+			           ? GL_TEXTURE_2D_ARRAY
+			           : GL_TEXTURE_2D;
+		}
+
+		void SetSamplerState(GLenum target,
+		                     const TextureDesc& desc)
+		{
+			const auto wrap = desc.wrap == TextureWrap::Repeat
+			                      ? GL_REPEAT
+			                      : GL_CLAMP_TO_EDGE;
+			glTexParameteri(target, GL_TEXTURE_WRAP_S, wrap);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(target, GL_TEXTURE_WRAP_T, wrap);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(target, GL_TEXTURE_MIN_FILTER,
+			                desc.levelCount > 1
+			                    ? GL_LINEAR_MIPMAP_LINEAR
+			                    : GL_LINEAR);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(target, GL_TEXTURE_MAG_FILTER,
+			                GL_LINEAR);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(target, GL_TEXTURE_MAX_LEVEL,
+			                desc.levelCount - 1);
+			VEGAM_CHECK_GL_ERROR;
+			const auto& capabilities = GetCapabilities();
+			if (desc.maxAnisotropy > 1.0f
+			    && capabilities.anisotropy)
+			{
+				glTexParameterf(
+				    target, GL_TEXTURE_MAX_ANISOTROPY,
+				    std::min(desc.maxAnisotropy,
+				             capabilities.maxAnisotropy));
+				VEGAM_CHECK_GL_ERROR;
+			}
+		}
+
+		void SetBaseLevel(GLenum target, uint32_t texture,
+		                  uint32_t level)
+		{
+			glBindTexture(target, texture);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(target, GL_TEXTURE_BASE_LEVEL,
+			                level);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(target, 0);
+			VEGAM_CHECK_GL_ERROR;
+		}
+
+		// Storage for every level of desc, sampled from its
+		// coarsest until levels are uploaded.
+		GLuint CreateStorage(const TextureDesc& desc)
+		{
+			const auto& info = GetInfo(desc.format);
+			const auto target = GetTarget(desc);
+			const auto array = desc.type == TextureType::Array;
+
+			GLuint id = 0;
+			glGenTextures(1, &id);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(target, id);
+			VEGAM_CHECK_GL_ERROR;
+			if (array && glTexStorage3D)
+			{
+				glTexStorage3D(target, desc.levelCount,
+				               info.internalFormat, desc.width,
+				               desc.height, desc.layerCount);
+				VEGAM_CHECK_GL_ERROR;
+			}
+			else if (!array && glTexStorage2D)
+			{
+				glTexStorage2D(target, desc.levelCount,
+				               info.internalFormat, desc.width,
+				               desc.height);
+				VEGAM_CHECK_GL_ERROR;
+			}
+			else
+			{
+				// 4.1 contexts: mutable storage, level by level.
+				for (uint32_t level = 0; level < desc.levelCount;
+				     ++level)
+				{
+					const auto width =
+					    std::max(desc.width >> level, 1u);
+					const auto height =
+					    std::max(desc.height >> level, 1u);
+					const auto size = static_cast<GLsizei>(
+					    Texture::GetLevelSize(desc, level));
+					if (array && info.compressed)
+					{
+						glCompressedTexImage3D(
+						    target, level, info.internalFormat,
+						    width, height, desc.layerCount, 0,
+						    size, nullptr);
+					}
+					else if (array)
+					{
+						glTexImage3D(target, level,
+						             info.internalFormat, width,
+						             height, desc.layerCount, 0,
+						             GetPixelFormat(info),
+						             GL_UNSIGNED_BYTE, nullptr);
+					}
+					else if (info.compressed)
+					{
+						glCompressedTexImage2D(
+						    target, level, info.internalFormat,
+						    width, height, 0, size, nullptr);
+					}
+					else
+					{
+						glTexImage2D(target, level,
+						             info.internalFormat, width,
+						             height, 0,
+						             GetPixelFormat(info),
+						             GL_UNSIGNED_BYTE, nullptr);
+					}
+					VEGAM_CHECK_GL_ERROR;
+				}
+			}
+
+			SetSamplerState(target, desc);
+			glTexParameteri(target, GL_TEXTURE_BASE_LEVEL,
+			                desc.levelCount - 1);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(target, 0);
+			VEGAM_CHECK_GL_ERROR;
+			return id;
+		}
+
+		// The levels from first on of desc, as a texture of
+		// their own.
+		TextureDesc GetStorageDesc(const TextureDesc& desc,
+		                           uint32_t first)
+		{
+			auto storage = desc;
+			storage.width = std::max(desc.width >> first, 1u);
+			storage.height = std::max(desc.height >> first, 1u);
+			storage.levelCount = desc.levelCount - first;
+			return storage;
+		}
+	} // namespace
+
+	Texture::Texture(const TextureDesc& desc) { Create(desc); }
+
+	Texture::~Texture()
+	{
+		if (m_bindlessHandle)
+		{
+			RetireQueue::Retire(
+			    [](uint64_t handle) {
+				    makeHandleNonResident(handle);
+				    VEGAM_CHECK_GL_ERROR;
+			    },
+			    m_bindlessHandle);
+		}
+		if (m_arrayView)
+		{
+			RetireQueue::RetireTexture(m_arrayView);
+		}
+		if (m_id)
+		{
+			GpuResources::Unregister(GpuResources::Type::Texture,
+			                         m_id);
+			RetireQueue::RetireTexture(m_id);
+		}
+	}
+
+	void Texture::Swap(Texture& other)
+	{
+		std::swap(m_id, other.m_id);
+		std::swap(m_arrayView, other.m_arrayView);
+		std::swap(m_bindlessHandle, other.m_bindlessHandle);
+		std::swap(m_desc, other.m_desc);
+		std::swap(m_residentLevel, other.m_residentLevel);
+		std::swap(m_storageLevel, other.m_storageLevel);
+		std::swap(m_uploadedLevels, other.m_uploadedLevels);
+		std::swap(m_uploadedLayers, other.m_uploadedLayers);
+		std::swap(m_lastUsedFrame, other.m_lastUsedFrame);
+	}
+
+	bool Texture::Create(const TextureDesc& desc)
+	{
+		VEGAM_ASSERT(!m_id, "Texture created twice!");
+		if (desc.width == 0 || desc.height == 0
+		    || desc.levelCount == 0
+		    || desc.levelCount > MaxLevels
+		    || desc.layerCount == 0
+		    || (desc.type == TextureType::Texture2D
+		        && desc.layerCount != 1)
+		    || (std::max(desc.width, desc.height)
+		        >> (desc.levelCount - 1))
+		           == 0)
+		{
+			VEGAM_ERROR("Invalid texture of {}x{}x{} with {} "
+			            "levels",
+			            desc.width, desc.height,
+			            desc.layerCount, desc.levelCount);
+			return false;
+		}
+		if (!IsFormatSupported(desc.format))
+		{
+			VEGAM_ERROR("Texture format {} is not supported "
+			            "by this driver",
+			            GetFormatName(desc.format));
+			return false;
+		}
+
+		m_desc = desc;
+		m_residentLevel = desc.levelCount;
+		m_uploadedLevels = 0;
+		m_uploadedLayers = {};
+		m_id = CreateStorage(desc);
+		m_storageLevel = 0;
+		// Not evicted before it had a chance to be drawn.
+		m_lastUsedFrame = GpuMemory::GetFrame();
+		GpuResources::Register(GpuResources::Type::Texture,
+		                       m_id, GetStorageSize(), "Texture");
+		return true;
+	}
+
+	bool Texture::SetStorageLevel(uint32_t level)
+	{
+		VEGAM_ASSERT(m_id && level < m_desc.levelCount,
+		             "Moving the storage of a missing texture "
+		             "level!");
+		if (!m_id || level >= m_desc.levelCount)
+		{
+			return false;
+		}
+		if (level == m_storageLevel)
+		{
+			return true;
+		}
+		if (!glCopyImageSubData || !glTexStorage2D)
+		{
+			return false;
+		}
+
+		const auto target = GetTarget(m_desc);
+		const auto id =
+		    CreateStorage(GetStorageDesc(m_desc, level));
+		// Carry over what both storages hold, partly
+		// uploaded array levels included.
+		for (auto kept = std::max(level, m_storageLevel);
+		     kept < m_desc.levelCount; ++kept)
+		{
+			if (!IsLevelUploaded(kept) && !m_uploadedLayers[kept])
+			{
+				continue;
+			}
+			glCopyImageSubData(
+			    m_id, target, kept - m_storageLevel, 0, 0, 0, id,
+			    target, kept - level, 0, 0, 0,
+			    std::max(m_desc.width >> kept, 1u),
+			    std::max(m_desc.height >> kept, 1u),
+			    m_desc.layerCount);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		for (uint32_t dropped = m_storageLevel; dropped < level;
+		     ++dropped)
+		{
+			m_uploadedLevels &= ~(1u << dropped);
+			m_uploadedLayers[dropped] = 0;
+		}
+		m_residentLevel = m_desc.levelCount;
+		while (m_residentLevel > 0
+		       && IsLevelUploaded(m_residentLevel - 1))
+		{
+			--m_residentLevel;
+		}
+		SetBaseLevel(target, id,
+		             std::min(m_residentLevel,
+		                      m_desc.levelCount - 1)
+		                 - level);
+
+		// The view and handle are of the old storage; both
+		// are made again on next use.
+		if (m_bindlessHandle)
+		{
+			RetireQueue::Retire(
+			    [](uint64_t handle) {
+				    makeHandleNonResident(handle);
+				    VEGAM_CHECK_GL_ERROR;
+			    },
+			    m_bindlessHandle);
+			m_bindlessHandle = 0;
+		}
+		if (m_arrayView)
+		{
+			RetireQueue::RetireTexture(m_arrayView);
+			m_arrayView = 0;
+		}
+		GpuResources::Unregister(GpuResources::Type::Texture,
+		                         m_id);
+		RetireQueue::RetireTexture(m_id);
+		m_id = id;
+		m_storageLevel = level;
+		GpuResources::Register(GpuResources::Type::Texture,
+		                       m_id, GetStorageSize(), "Texture");
+		return true;
+	}
+
+	size_t Texture::GetStorageSize() const
+	{
+		size_t bytes = 0;
+		for (auto level = m_storageLevel;
+		     level < m_desc.levelCount; ++level)
+		{
+			bytes += GetLevelSize(level);
+		}
+		return bytes;
+	}
+
+	void Texture::UploadLevel(uint32_t level, const void* data)
+	{
+		VEGAM_ASSERT(m_id && level < m_desc.levelCount,
+		             "Uploading to a missing texture level!");
+		if (!m_id || level >= m_desc.levelCount
+		    || (level < m_storageLevel
+		        && !SetStorageLevel(level)))
+		{
+			return;
+		}
+		if (m_desc.type == TextureType::Array)
+		{
+			const auto* bytes = static_cast<const uint8_t*>(data);
+			for (uint32_t layer = 0; layer < m_desc.layerCount;
+			     ++layer)
+			{
+				UploadLayer(layer, level,
+				            bytes + layer * GetLayerSize(level));
+			}
+			return;
+		}
+
+		const auto& info = GetInfo(m_desc.format);
+		const auto width = std::max(m_desc.width >> level, 1u);
+		const auto height =
+		    std::max(m_desc.height >> level, 1u);
+		glBindTexture(GL_TEXTURE_2D, m_id);
+		VEGAM_CHECK_GL_ERROR;
+		if (info.compressed)
+		{
+			glCompressedTexSubImage2D(
+			    GL_TEXTURE_2D, level - m_storageLevel, 0, 0,
+			    width, height,
+			    info.internalFormat,
+			    static_cast<GLsizei>(GetLevelSize(level)), data);
+		}
+		else
+		{
+			glTexSubImage2D(GL_TEXTURE_2D,
+			                level - m_storageLevel, 0, 0, width,
+			                height, GetPixelFormat(info),
+			                GL_UNSIGNED_BYTE, data);
+		}
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, 0);
+		VEGAM_CHECK_GL_ERROR;
+		MarkUploaded(level);
+	}
+
+	void Texture::UploadLayer(uint32_t layer, uint32_t level,
+	                          const void* data)
+	{
+		VEGAM_ASSERT(m_id && level < m_desc.levelCount
+		                 && layer < m_desc.layerCount,
+		             "Uploading to a missing texture layer!");
+		if (m_desc.type != TextureType::Array)
+		{
+			UploadLevel(level, data);
+			return;
+		}
+		if (!m_id || level >= m_desc.levelCount
+		    || layer >= m_desc.layerCount
+		    || (level < m_storageLevel
+		        && !SetStorageLevel(level)))
+		{
+			return;
+		}
+
+		const auto& info = GetInfo(m_desc.format);
+		const auto width = std::max(m_desc.width >> level, 1u);
+		const auto height =
+		    std::max(m_desc.height >> level, 1u);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_id);
+		VEGAM_CHECK_GL_ERROR;
+		if (info.compressed)
+		{
+			glCompressedTexSubImage3D(
+			    GL_TEXTURE_2D_ARRAY, level - m_storageLevel, 0,
+			    0, layer, width, height, 1, info.internalFormat,
+			    static_cast<GLsizei>(GetLayerSize(level)), data);
+		}
+		else
+		{
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY,
+			                level - m_storageLevel, 0, 0,
+			                layer, width, height, 1,
+			                GetPixelFormat(info),
+			                GL_UNSIGNED_BYTE, data);
+		}
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		VEGAM_CHECK_GL_ERROR;
+		if (++m_uploadedLayers[level] >= m_desc.layerCount)
+		{
+			MarkUploaded(level);
+		}
+	}
+
+	void Texture::UploadRegion(uint32_t level, uint32_t x,
+	                           uint32_t y, uint32_t width,
+	                           uint32_t height, const void* data)
+	{
+		const auto& info = GetInfo(m_desc.format);
+		VEGAM_ASSERT(m_id && level < m_desc.levelCount
+		                 && m_desc.type == TextureType::Texture2D
+		                 && !info.compressed,
+		             "Region upload to an unsuitable texture!");
+		VEGAM_ASSERT(
+		    x + width <= std::max(m_desc.width >> level, 1u)
+		        && y + height
+		               <= std::max(m_desc.height >> level, 1u),
+		    "Region upload outside the texture!");
+		// Levels evicted from storage are not kept.
+		if (!m_id || level >= m_desc.levelCount
+		    || level < m_storageLevel || info.compressed)
+		{
+			return;
+		}
+
+		glBindTexture(GL_TEXTURE_2D, m_id);
+		VEGAM_CHECK_GL_ERROR;
+		glTexSubImage2D(GL_TEXTURE_2D, level - m_storageLevel,
+		                x, y, width, height, GetPixelFormat(info),
+		                GL_UNSIGNED_BYTE, data);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, 0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void Texture::MarkUploaded(uint32_t level)
+	{
+		// Sample down from the finest level that has every
+		// smaller one below it.
+		m_uploadedLevels |= 1u << level;
+		auto resident = m_desc.levelCount;
+		while (resident > 0 && IsLevelUploaded(resident - 1))
+		{
+			--resident;
+		}
+		if (resident == m_residentLevel
+		    || resident == m_desc.levelCount)
+		{
+			return;
+		}
+
+		m_residentLevel = resident;
+		// The state of whatever the bindless handle was
+		// made from is frozen.
+		const auto frozen = m_bindlessHandle != 0;
+		if (!frozen || m_desc.type != TextureType::Array)
+		{
+			SetBaseLevel(GetTarget(m_desc), m_id,
+			             resident - m_storageLevel);
+		}
+		if (m_arrayView && !frozen)
+		{
+			SetBaseLevel(GL_TEXTURE_2D_ARRAY, m_arrayView,
+			             resident - m_storageLevel);
+		}
+	}
+
+	uint32_t Texture::GetArrayId()
+	{
+		if (m_desc.type == TextureType::Array || !m_id)
+		{
+			return m_id;
+		}
+		if (m_arrayView || !glTextureView || !glTexStorage2D)
+		{
+			return m_arrayView;
+		}
+
+		const auto storage =
+		    GetStorageDesc(m_desc, m_storageLevel);
+		glGenTextures(1, &m_arrayView);
+		VEGAM_CHECK_GL_ERROR;
+		glTextureView(m_arrayView, GL_TEXTURE_2D_ARRAY, m_id,
+		              GetInfo(m_desc.format).internalFormat, 0,
+		              storage.levelCount, 0, 1);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_arrayView);
+		VEGAM_CHECK_GL_ERROR;
+		SetSamplerState(GL_TEXTURE_2D_ARRAY, storage);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		VEGAM_CHECK_GL_ERROR;
+		SetBaseLevel(GL_TEXTURE_2D_ARRAY, m_arrayView,
+		             std::min(m_residentLevel,
+		                      m_desc.levelCount - 1)
+		                 - m_storageLevel);
+		return m_arrayView;
+	}
+
+	uint64_t Texture::GetBindlessHandle()
+	{
+		if (m_bindlessHandle || !IsBindlessSupported())
+		{
+			return m_bindlessHandle;
+		}
+		const auto id = GetArrayId();
+		if (!id)
+		{
+			return 0;
+		}
+
+		// Sampling is clamped per material from here on,
+		// so the whole chain must be reachable.
+		SetBaseLevel(GL_TEXTURE_2D_ARRAY, id, 0);
+		m_bindlessHandle = getTextureHandle(id);
+		VEGAM_CHECK_GL_ERROR;
+		makeHandleResident(m_bindlessHandle);
+		VEGAM_CHECK_GL_ERROR;
+		return m_bindlessHandle;
+	}
+
+	bool Texture::IsBindlessSupported()
+	{
+		return GetCapabilities().bindless;
+	}
+
+	size_t Texture::GetLevelSize(const TextureDesc& desc,
+	                             uint32_t level)
+	{
+		return GetLayerSize(desc, level) * desc.layerCount;
+	}
+
+	size_t Texture::GetLayerSize(const TextureDesc& desc,
+	                             uint32_t level)
+	{
+		const auto& info = GetInfo(desc.format);
+		const auto width = std::max(desc.width >> level, 1u);
+		const auto height = std::max(desc.height >> level, 1u);
+		const auto blocksX =
+		    (width + info.blockWidth - 1) / info.blockWidth;
+		const auto blocksY =
+		    (height + info.blockHeight - 1) / info.blockHeight;
+		return static_cast<size_t>(blocksX) * blocksY
+		       * info.blockBytes;
+	}
+
+	bool Texture::IsFormatSupported(TextureFormat format)
+	{
+		const auto& capabilities = GetCapabilities();
+		switch (GetInfo(format).support)
+		{
+		case Support::Core:
+			return true;
+		case Support::S3tc:
+			return capabilities.s3tc;
+		case Support::S3tcSrgb:
+			return capabilities.s3tcSrgb;
+		case Support::Bptc:
+			return HasVersion(4, 2);
+		case Support::Etc2:
+			return HasVersion(4, 3);
+		case Support::Astc:
+			return capabilities.astc;
+		}
+		return false;
+	}
+
+	const char* Texture::GetFormatName(TextureFormat format)
+	{
+		return GetInfo(format).name;
+	}
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,436 @@
+#include "AthiVegam/Graphics/TextureAtlas.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Graphics/SpriteBatch.h"
+#include "AthiVegam/Graphics/Texture.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+// ImGui compiles its copy static to imgui_draw.cpp.
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "external/imgui/imstb_rectpack.h"
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		constexpr uint32_t Magic = 0x41545641; // "AVTA"
+		constexpr uint32_t Version = 1;
+
+		// Then regionCount regions, each followed by its
+		// name, then every level's pixels from level 0.
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t size;
+			uint32_t levelCount;
+			uint32_t regionCount;
+			uint32_t reserved;
+		};
+
+		struct RegionRecord
+		{
+			float uvs[4];
+			uint32_t rotated;
+			uint32_t nameLength;
+		};
+
+		constexpr size_t TexelSize = 4;
+		// stbrp_coord is 16-bit.
+		constexpr uint32_t MaxCoordinate = 0xFFFF;
+
+		inline size_t LevelSize(uint32_t size, uint32_t level)
+		{
+			const auto side = std::max(size >> level, 1u);
+			return size_t{side} * side * TexelSize;
+		}
+	} // namespace
+
+	TextureAtlas::TextureAtlas() : TextureAtlas(Settings{}) {}
+
+	TextureAtlas::TextureAtlas(const Settings& settings)
+	    : m_settings(settings)
+	{
+		VEGAM_ASSERT(std::has_single_bit(settings.maxSize),
+		             "Atlas size must be a power of two");
+		VEGAM_ASSERT(settings.levelCount > 0
+		                 && settings.levelCount
+		                        <= Texture::MaxLevels,
+		             "Invalid atlas level count");
+	}
+
+	TextureAtlas::~TextureAtlas()
+	{
+		VEGAM_ASSERT(!m_texture.IsValid(),
+		             "TextureAtlas destroyed without Destroy()");
+	}
+
+	void TextureAtlas::Reset()
+	{
+		m_size = 0;
+		m_regions.clear();
+		m_names.clear();
+		m_lookup.clear();
+		m_levels.clear();
+	}
+
+	bool TextureAtlas::Build(std::span<const AtlasImage> images)
+	{
+		VEGAM_PROFILE_SCOPE("TextureAtlas::Build");
+		Reset();
+		// Regions are packed in blocks of the alignment the
+		// coarsest level needs.
+		const auto align = 1u << (m_settings.levelCount - 1);
+		const auto padding = m_settings.padding;
+		std::vector<stbrp_rect> rects(images.size());
+		uint64_t area = 0;
+		for (size_t i = 0; i < images.size(); ++i)
+		{
+			const auto& image = images[i];
+			if (!image.pixels || image.width == 0
+			    || image.height == 0)
+			{
+				VEGAM_ERROR("Atlas image '{}' is empty",
+				            image.name);
+				Reset();
+				return false;
+			}
+			if (!m_lookup
+			         .emplace(image.name,
+			                  static_cast<uint32_t>(i))
+			         .second)
+			{
+				VEGAM_ERROR("Atlas image '{}' added twice",
+				            image.name);
+				Reset();
+				return false;
+			}
+			auto width = image.width + 2 * padding;
+			auto height = image.height + 2 * padding;
+			const auto rotated = m_settings.allowRotation
+			                     && image.height > image.width;
+			if (rotated)
+			{
+				std::swap(width, height);
+			}
+			auto& rect = rects[i];
+			rect.id = rotated ? 1 : 0;
+			rect.w = static_cast<stbrp_coord>(
+			    std::min((width + align - 1) / align,
+			             MaxCoordinate));
+			rect.h = static_cast<stbrp_coord>(
+			    std::min((height + align - 1) / align,
+			             MaxCoordinate));
+			area += uint64_t{rect.w} * rect.h * align * align;
+		}
+
+		// The smallest size that could hold the area, then
+		// doubling until everything fits.
+		const auto side = static_cast<uint64_t>(
+		    std::ceil(std::sqrt(static_cast<double>(area))));
+		auto size = std::max(
+		    align, static_cast<uint32_t>(std::bit_ceil(side)));
+		bool packed = false;
+		std::vector<stbrp_node> nodes;
+		for (; size <= m_settings.maxSize; size *= 2)
+		{
+			const auto blocks = static_cast<int>(size / align);
+			nodes.resize(static_cast<size_t>(blocks));
+			stbrp_context context;
+			stbrp_init_target(&context, blocks, blocks,
+			                  nodes.data(), blocks);
+			if (stbrp_pack_rects(&context, rects.data(),
+			                     static_cast<int>(rects.size())))
+			{
+				packed = true;
+				break;
+			}
+		}
+		if (!packed)
+		{
+			VEGAM_ERROR("{} images don't fit a {}x{} atlas",
+			            images.size(), m_settings.maxSize,
+			            m_settings.maxSize);
+			Reset();
+			return false;
+		}
+
+		m_size = size;
+		m_levels.resize(std::min<uint32_t>(
+		    m_settings.levelCount, std::bit_width(size)));
+		m_levels[0].assign(LevelSize(size, 0), 0);
+		m_regions.resize(images.size());
+		m_names.resize(images.size());
+		auto* atlas = m_levels[0].data();
+		for (size_t i = 0; i < images.size(); ++i)
+		{
+			const auto& image = images[i];
+			const auto& rect = rects[i];
+			const auto rotated = rect.id != 0;
+			// The stored region, turned or not.
+			const auto width =
+			    rotated ? image.height : image.width;
+			const auto height =
+			    rotated ? image.width : image.height;
+			const auto x0 = uint32_t{rect.x} * align + padding;
+			const auto y0 = uint32_t{rect.y} * align + padding;
+			// Padding repeats the nearest edge texel.
+			for (uint32_t y = 0; y < height + 2 * padding; ++y)
+			{
+				const auto row = static_cast<uint32_t>(std::clamp(
+				    static_cast<int64_t>(y) - padding, int64_t{0},
+				    int64_t{height} - 1));
+				for (uint32_t x = 0; x < width + 2 * padding;
+				     ++x)
+				{
+					const auto column =
+					    static_cast<uint32_t>(std::clamp(
+					        static_cast<int64_t>(x) - padding,
+					        int64_t{0}, int64_t{width} - 1));
+					// Turned, the region's column is the
+					// image's row.
+					const auto sx = rotated ? row : column;
+					const auto sy = rotated ? column : row;
+					std::memcpy(
+					    atlas
+					        + ((size_t{y0} + y - padding) * size
+					           + x0 + x - padding)
+					              * TexelSize,
+					    image.pixels
+					        + (size_t{sy} * image.width + sx)
+					              * TexelSize,
+					    TexelSize);
+				}
+			}
+
+			const auto scale = 1.0f / static_cast<float>(size);
+			auto& region = m_regions[i];
+			region.u0 = static_cast<float>(x0) * scale;
+			region.v0 = static_cast<float>(y0) * scale;
+			region.u1 = static_cast<float>(x0 + width) * scale;
+			region.v1 = static_cast<float>(y0 + height) * scale;
+			region.rotated = rotated;
+			m_names[i] = image.name;
+		}
+		GenerateLevels();
+		VEGAM_INFO("Packed {} images into a {}x{} atlas",
+		           images.size(), size, size);
+		return true;
+	}
+
+	void TextureAtlas::GenerateLevels()
+	{
+		// A box filter; regions are aligned so none reads a
+		// neighbour.
+		for (uint32_t level = 1; level < m_levels.size();
+		     ++level)
+		{
+			const auto& source = m_levels[level - 1];
+			auto& target = m_levels[level];
+			const auto side = m_size >> level;
+			const auto sourceSide = side * 2;
+			target.resize(LevelSize(m_size, level));
+			for (uint32_t y = 0; y < side; ++y)
+			{
+				for (uint32_t x = 0; x < side; ++x)
+				{
+					const auto* a =
+					    source.data()
+					    + (size_t{y} * 2 * sourceSide + x * 2)
+					          * TexelSize;
+					const auto* b = a + sourceSide * TexelSize;
+					auto* out =
+					    target.data()
+					    + (size_t{y} * side + x) * TexelSize;
+					for (size_t c = 0; c < TexelSize; ++c)
+					{
+						out[c] = static_cast<uint8_t>(
+						    (a[c] + a[c + TexelSize] + b[c]
+						     + b[c + TexelSize] + 2)
+						    / 4);
+					}
+				}
+			}
+		}
+	}
+
+	bool TextureAtlas::Save(const std::string& path) const
+	{
+		if (m_levels.empty())
+		{
+			VEGAM_ERROR("No atlas pixels to save to {}", path);
+			return false;
+		}
+		std::ofstream file(path, std::ios::binary);
+		if (!file)
+		{
+			VEGAM_ERROR("Error opening {}", path);
+			return false;
+		}
+		const Header header{
+		    Magic,
+		    Version,
+		    m_size,
+		    static_cast<uint32_t>(m_levels.size()),
+		    static_cast<uint32_t>(m_regions.size()),
+		    0};
+		file.write(reinterpret_cast<const char*>(&header),
+		           sizeof(header));
+		for (size_t i = 0; i < m_regions.size(); ++i)
+		{
+			const auto& region = m_regions[i];
+			const RegionRecord record{
+			    {region.u0, region.v0, region.u1, region.v1},
+			    region.rotated ? 1u : 0u,
+			    static_cast<uint32_t>(m_names[i].size())};
+			file.write(reinterpret_cast<const char*>(&record),
+			           sizeof(record));
+			file.write(m_names[i].data(),
+			           static_cast<std::streamsize>(
+			               m_names[i].size()));
+		}
+		for (const auto& level : m_levels)
+		{
+			file.write(
+			    reinterpret_cast<const char*>(level.data()),
+			    static_cast<std::streamsize>(level.size()));
+		}
+		if (!file)
+		{
+			VEGAM_ERROR("Error writing {}", path);
+			return false;
+		}
+		return true;
+	}
+
+	bool TextureAtlas::Load(const std::string& path)
+	{
+		Reset();
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			VEGAM_ERROR("Error opening {}", path);
+			return false;
+		}
+		Header header{};
+		file.read(reinterpret_cast<char*>(&header),
+		          sizeof(header));
+		if (!file || header.magic != Magic
+		    || header.version != Version
+		    || !std::has_single_bit(header.size)
+		    || header.levelCount == 0
+		    || header.levelCount > std::bit_width(header.size))
+		{
+			VEGAM_ERROR("{} is not a texture atlas", path);
+			return false;
+		}
+
+		m_regions.resize(header.regionCount);
+		m_names.resize(header.regionCount);
+		for (uint32_t i = 0; i < header.regionCount; ++i)
+		{
+			RegionRecord record{};
+			file.read(reinterpret_cast<char*>(&record),
+			          sizeof(record));
+			auto& name = m_names[i];
+			name.resize(file ? record.nameLength : 0);
+			file.read(name.data(),
+			          static_cast<std::streamsize>(name.size()));
+			auto& region = m_regions[i];
+			region.u0 = record.uvs[0];
+			region.v0 = record.uvs[1];
+			region.u1 = record.uvs[2];
+			region.v1 = record.uvs[3];
+			region.rotated = record.rotated != 0;
+			m_lookup.emplace(name, i);
+		}
+		m_levels.resize(header.levelCount);
+		for (uint32_t level = 0; level < header.levelCount;
+		     ++level)
+		{
+			auto& pixels = m_levels[level];
+			pixels.resize(LevelSize(header.size, level));
+			file.read(reinterpret_cast<char*>(pixels.data()),
+			          static_cast<std::streamsize>(pixels.size()));
+		}
+		if (!file)
+		{
+			VEGAM_ERROR("Texture atlas {} is truncated", path);
+			Reset();
+			return false;
+		}
+		m_size = header.size;
+		return true;
+	}
+
+	bool TextureAtlas::CreateTexture()
+	{
+		VEGAM_ASSERT(!m_texture.IsValid(),
+		             "Atlas texture created twice");
+		if (m_levels.empty())
+		{
+			VEGAM_ERROR("Texture atlas not built or loaded");
+			return false;
+		}
+		TextureDesc desc;
+		desc.width = m_size;
+		desc.height = m_size;
+		desc.levelCount = static_cast<uint32_t>(m_levels.size());
+		desc.format = TextureFormat::RGBA8;
+		desc.wrap = TextureWrap::Clamp;
+		auto& resources =
+		    Engine::Instance().GetResourceManager();
+		m_texture = resources.CreateTexture(desc);
+		auto* texture = resources.GetTexture(m_texture);
+		if (!texture)
+		{
+			Destroy();
+			return false;
+		}
+		// Smallest first, as streamed textures are.
+		for (auto level = desc.levelCount; level-- > 0;)
+		{
+			texture->UploadLevel(level, m_levels[level].data());
+		}
+		m_levels.clear();
+		m_levels.shrink_to_fit();
+		return true;
+	}
+
+	void TextureAtlas::Destroy()
+	{
+		if (m_texture.IsValid())
+		{
+			Engine::Instance()
+			    .GetResourceManager()
+			    .DestroyTexture(m_texture);
+			m_texture = {};
+		}
+	}
+
+	uint32_t TextureAtlas::Find(std::string_view name) const
+	{
+		const auto it = m_lookup.find(std::string(name));
+		return it != m_lookup.end() ? it->second : NoRegion;
+	}
+
+	void TextureAtlas::Apply(uint32_t region,
+	                         Sprite& sprite) const
+	{
+		const auto& from = m_regions[region];
+		sprite.texture = m_texture;
+		sprite.u0 = from.u0;
+		sprite.v0 = from.v0;
+		sprite.u1 = from.u1;
+		sprite.v1 = from.v1;
+		sprite.uvRotated = from.rotated;
+	}
+} // namespace AthiVegam::Graphics
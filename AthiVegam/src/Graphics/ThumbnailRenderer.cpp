@@ -0,0 +1,204 @@
+#include "AthiVegam/Graphics/ThumbnailRenderer.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/GLState.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/Mesh.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Math/Matrix.h"
+#include "AthiVegam/Math/Vector.h"
+#include "glad/glad.h"
+
+#include <cmath>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		const char* VertexSource = R"(#version 330 core
+layout(location = 0) in vec3 Position;
+layout(location = 1) in vec3 Normal;
+layout(location = 2) in vec2 TexCoord;
+
+uniform mat4 ViewProjection;
+
+out vec3 FragPosition;
+out vec3 FragNormal;
+out vec2 FragTexCoord;
+
+void main()
+{
+	FragPosition = Position;
+	FragNormal = Normal;
+	FragTexCoord = TexCoord;
+	gl_Position = ViewProjection * vec4(Position, 1.0);
+}
+)";
+
+		const char* FragmentSource = R"(#version 330 core
+in vec3 FragPosition;
+in vec3 FragNormal;
+in vec2 FragTexCoord;
+
+uniform sampler2D Albedo;
+uniform bool HasAlbedo;
+uniform vec3 LightDirection;
+
+out vec4 OutColor;
+
+void main()
+{
+	vec4 albedo = HasAlbedo ? texture(Albedo, FragTexCoord)
+	                        : vec4(1.0);
+	if (albedo.a < 0.5)
+	{
+		discard;
+	}
+	vec3 normal = FragNormal;
+	if (dot(normal, normal) < 1.0e-4)
+	{
+		normal = cross(dFdx(FragPosition), dFdy(FragPosition));
+	}
+	float light =
+	    max(dot(normalize(normal), -LightDirection), 0.0);
+	OutColor = vec4(albedo.rgb * (0.25 + 0.75 * light), 1.0);
+}
+)";
+
+		// Looked at from, and lit from.
+		const Math::Vec3 ViewDirection{0.6f, 0.5f, 0.62f};
+		const Math::Vec3 LightDirection{-0.3f, -1.0f, -0.5f};
+
+		inline GLenum GetGLIndexType(IndexType type)
+		{
+			return type == IndexType::UInt16 ? GL_UNSIGNED_SHORT
+			                                 : GL_UNSIGNED_INT;
+		}
+	} // namespace
+
+	ThumbnailRenderer::~ThumbnailRenderer() { Shutdown(); }
+
+	bool ThumbnailRenderer::Initialize(int size)
+	{
+		if (!m_target.Create(size, size))
+		{
+			VEGAM_ERROR("Cannot create a {0}x{0} thumbnail target",
+			            size);
+			return false;
+		}
+		m_shader =
+		    std::make_unique<Shader>(VertexSource, FragmentSource);
+		m_shader->Set(m_shader->GetUniform<int>("Albedo"), 0);
+		const auto light = Math::Normalize(LightDirection);
+		m_shader->Set(
+		    m_shader->GetUniform<Float3>("LightDirection"),
+		    {light.x, light.y, light.z});
+		return true;
+	}
+
+	void ThumbnailRenderer::Shutdown()
+	{
+		m_readback.Destroy();
+		m_shader.reset();
+		m_target.Destroy();
+	}
+
+	bool ThumbnailRenderer::Render(const Mesh& mesh,
+	                               uint32_t albedo,
+	                               uint64_t ticket)
+	{
+		if (!IsInitialized() || !mesh.IsReady())
+		{
+			return false;
+		}
+		const auto sphere = mesh.GetBounds().GetSphere();
+		if (!std::isfinite(sphere.radius)
+		    || sphere.radius <= 0.0f)
+		{
+			return false;
+		}
+		VEGAM_PROFILE_SCOPE("ThumbnailRenderer::Render");
+
+		GLint previousFramebuffer = 0;
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING,
+		              &previousFramebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		GLint previousViewport[4] = {};
+		glGetIntegerv(GL_VIEWPORT, previousViewport);
+		VEGAM_CHECK_GL_ERROR;
+
+		m_target.Bind();
+		GLState::SetEnabled(GLState::Capability::Blend, false);
+		GLState::SetEnabled(GLState::Capability::ScissorTest,
+		                    false);
+		GLState::SetEnabled(GLState::Capability::CullFace,
+		                    false);
+		GLState::SetEnabled(GLState::Capability::DepthTest,
+		                    true);
+		GLState::SetDepthMask(true);
+		GLState::SetDepthFunc(GL_LESS);
+		GLState::SetColorMask(true);
+		const GLfloat clearColor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+		glClearBufferfv(GL_COLOR, 0, clearColor);
+		VEGAM_CHECK_GL_ERROR;
+		const GLfloat clearDepth = 1.0f;
+		glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+		VEGAM_CHECK_GL_ERROR;
+
+		// The bounding sphere fills the image. The state
+		// cache of the render manager is reset at its next
+		// flush.
+		const Math::Vec3 center{sphere.center.x,
+		                        sphere.center.y,
+		                        sphere.center.z};
+		const auto r = sphere.radius;
+		const auto eye =
+		    center + Math::Normalize(ViewDirection) * r;
+		Shader::UseProgram(m_shader->GetId());
+		m_shader->Set(
+		    m_shader->GetUniform<Math::Mat4>("ViewProjection"),
+		    Math::Mat4::Orthographic(-r, r, -r, r, 0.0f,
+		                             2.0f * r)
+		        * Math::Mat4::LookAt(eye, center,
+		                             {0.0f, 1.0f, 0.0f}));
+		m_shader->Set(m_shader->GetUniform<int>("HasAlbedo"),
+		              albedo != 0 ? 1 : 0);
+		glActiveTexture(GL_TEXTURE0);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, albedo);
+		VEGAM_CHECK_GL_ERROR;
+		glBindVertexArray(mesh.GetId());
+		VEGAM_CHECK_GL_ERROR;
+		if (mesh.GetElementCount() > 0)
+		{
+			glDrawElementsBaseVertex(
+			    GL_TRIANGLES, mesh.GetElementCount(),
+			    GetGLIndexType(mesh.GetIndexType()),
+			    reinterpret_cast<const void*>(
+			        static_cast<uintptr_t>(mesh.GetFirstIndex())
+			        * GetIndexSize(mesh.GetIndexType())),
+			    mesh.GetBaseVertex());
+		}
+		else
+		{
+			glDrawArrays(GL_TRIANGLE_STRIP, mesh.GetBaseVertex(),
+			             mesh.GetVertexCount());
+		}
+		VEGAM_CHECK_GL_ERROR;
+		glBindVertexArray(0);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		m_readback.Capture(m_target.GetWidth(),
+		                   m_target.GetHeight(), ticket);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glViewport(previousViewport[0], previousViewport[1],
+		           previousViewport[2], previousViewport[3]);
+		VEGAM_CHECK_GL_ERROR;
+		return true;
+	}
+} // namespace AthiVegam::Graphics
@@ -0,0 +1,208 @@
+#include "AthiVegam/Graphics/VertexLayout.h"
+
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		struct FormatInfo
+		{
+			GLint components;
+			GLenum type;
+			GLboolean normalized;
+			uint32_t size;
+			// Read as integers, through
+			// glVertexAttribIPointer.
+			bool integer = false;
+		};
+
+		constexpr std::array<FormatInfo,
+		                     static_cast<size_t>(
+		                         VertexFormat::COUNT)>
+		    formatInfo{{
+		        {1, GL_FLOAT, GL_FALSE, 4},
+		        {2, GL_FLOAT, GL_FALSE, 8},
+		        {3, GL_FLOAT, GL_FALSE, 12},
+		        {4, GL_FLOAT, GL_FALSE, 16},
+		        {2, GL_HALF_FLOAT, GL_FALSE, 4},
+		        {4, GL_HALF_FLOAT, GL_FALSE, 8},
+		        {4, GL_BYTE, GL_TRUE, 4},
+		        {4, GL_UNSIGNED_BYTE, GL_TRUE, 4},
+		        {2, GL_SHORT, GL_TRUE, 4},
+		        {4, GL_SHORT, GL_TRUE, 8},
+		        {2, GL_UNSIGNED_SHORT, GL_TRUE, 4},
+		        {4, GL_UNSIGNED_SHORT, GL_TRUE, 8},
+		        {4, GL_INT_2_10_10_10_REV, GL_TRUE, 4},
+		        {4, GL_UNSIGNED_BYTE, GL_FALSE, 4, true},
+		    }};
+
+		inline const FormatInfo& GetInfo(VertexFormat format)
+		{
+			return formatInfo[static_cast<size_t>(format)];
+		}
+
+		int32_t QuantizeSnorm(float value, uint32_t bits)
+		{
+			const auto max =
+			    static_cast<float>((1 << (bits - 1)) - 1);
+			return static_cast<int32_t>(std::round(
+			    std::clamp(value, -1.f, 1.f) * max));
+		}
+	} // namespace
+
+	uint32_t GetFormatSize(VertexFormat format)
+	{
+		return GetInfo(format).size;
+	}
+
+	bool IsIntegerFormat(VertexFormat format)
+	{
+		return GetInfo(format).integer;
+	}
+
+	VertexLayout VertexLayout::Positions(uint32_t dimensions)
+	{
+		VEGAM_ASSERT(dimensions >= 1 && dimensions <= 4,
+		             "Position dimensions must be 1-4");
+		VertexLayout layout;
+		layout.Add(0, static_cast<VertexFormat>(
+		                  static_cast<uint32_t>(
+		                      VertexFormat::Float1)
+		                  + dimensions - 1));
+		return layout;
+	}
+
+	VertexLayout& VertexLayout::Add(uint32_t location,
+	                                VertexFormat format)
+	{
+		VEGAM_ASSERT(m_count < MaxAttributes,
+		             "Too many vertex attributes");
+		if (m_count < MaxAttributes)
+		{
+			m_attributes[m_count++] = {location, format,
+			                           m_stride};
+			m_stride += GetFormatSize(format);
+		}
+		return *this;
+	}
+
+	void VertexLayout::Apply() const
+	{
+		for (uint32_t i = 0; i < m_count; ++i)
+		{
+			const auto& attribute = m_attributes[i];
+			const auto& info = GetInfo(attribute.format);
+
+			const auto* offset = reinterpret_cast<const void*>(
+			    static_cast<uintptr_t>(attribute.offset));
+
+			glEnableVertexAttribArray(attribute.location);
+			VEGAM_CHECK_GL_ERROR;
+			if (info.integer)
+			{
+				glVertexAttribIPointer(attribute.location,
+				                       info.components, info.type,
+				                       m_stride, offset);
+			}
+			else
+			{
+				glVertexAttribPointer(
+				    attribute.location, info.components,
+				    info.type, info.normalized, m_stride,
+				    offset);
+			}
+			VEGAM_CHECK_GL_ERROR;
+		}
+	}
+
+	bool VertexLayout::operator==(
+	    const VertexLayout& other) const
+	{
+		if (m_count != other.m_count
+		    || m_stride != other.m_stride)
+		{
+			return false;
+		}
+
+		for (uint32_t i = 0; i < m_count; ++i)
+		{
+			const auto& a = m_attributes[i];
+			const auto& b = other.m_attributes[i];
+			if (a.location != b.location
+			    || a.format != b.format)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	uint16_t PackHalf(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		const auto sign = (bits >> 16) & 0x8000;
+		const auto exponent =
+		    static_cast<int32_t>((bits >> 23) & 0xFF) - 127
+		    + 15;
+		auto mantissa = bits & 0x007FFFFF;
+
+		if (((bits >> 23) & 0xFF) == 0xFF)
+		{
+			// Inf stays inf, NaN stays NaN.
+			return static_cast<uint16_t>(
+			    sign | 0x7C00 | (mantissa ? 0x200 : 0));
+		}
+		if (exponent >= 0x1F)
+		{
+			return static_cast<uint16_t>(sign | 0x7C00);
+		}
+		if (exponent <= 0)
+		{
+			if (exponent < -10)
+			{
+				return static_cast<uint16_t>(sign);
+			}
+			// Subnormal half.
+			mantissa |= 0x00800000;
+			const auto shift = 14 - exponent;
+			auto half = mantissa >> shift;
+			if ((mantissa >> (shift - 1)) & 1)
+			{
+				++half;
+			}
+			return static_cast<uint16_t>(sign | half);
+		}
+
+		auto half = static_cast<uint32_t>(exponent << 10)
+		            | (mantissa >> 13);
+		// Round to nearest; a carry into the exponent is
+		// still the correct result.
+		if (mantissa & 0x1000)
+		{
+			++half;
+		}
+		return static_cast<uint16_t>(sign | half);
+	}
+
+	uint32_t PackInt1010102(float x, float y, float z,
+	                        float w)
+	{
+		const auto pack = [](float value, uint32_t bits)
+		{
+			return static_cast<uint32_t>(
+			           QuantizeSnorm(value, bits))
+			       & ((1u << bits) - 1);
+		};
+		return pack(x, 10) | (pack(y, 10) << 10)
+		       | (pack(z, 10) << 20) | (pack(w, 2) << 30);
+	}
+} // namespace AthiVegam::Graphics
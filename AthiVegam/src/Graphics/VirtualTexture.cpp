@@ -0,0 +1,882 @@
+#include "AthiVegam/Graphics/VirtualTexture.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/GpuProfiler.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+namespace AthiVegam::Graphics
+{
+	const char* VirtualTextureShaderSource = R"(
+layout(std140, binding = 5) uniform VirtualTextureParams
+{
+	// Level 0 width and height, level count, and cache
+	// texels per side.
+	vec4 VtSize;
+	// Feedback stride mask, and this frame's offset in x
+	// and y.
+	uvec4 VtFeedback;
+	// First page of each level.
+	uvec4 VtFirstPages[4];
+};
+layout(binding = 16) uniform sampler2D VtCache;
+// Per page, the cache slot x and y and level of the
+// page or its nearest resident ancestor, 8 bits each.
+layout(std430, binding = 19) readonly buffer VtPageTable
+{
+	uint VtEntries[];
+};
+layout(std430, binding = 20) buffer VtFeedbackBits
+{
+	uint VtWanted[];
+};
+
+const float VtPageSize = 128.0;
+const float VtBorder = 4.0;
+const float VtContent = 120.0;
+
+// The page holding uv at a level, and where in its
+// content uv falls.
+uint VtPage(int level, vec2 uv, out vec2 inPage)
+{
+	vec2 size = max(floor(VtSize.xy / exp2(float(level))),
+	                vec2(1.0));
+	vec2 pages = ceil(size / VtContent);
+	vec2 texel = uv * size;
+	vec2 page = min(floor(texel / VtContent), pages - 1.0);
+	inPage = texel - page * VtContent;
+	return VtFirstPages[level >> 2][level & 3]
+	       + uint(page.y * pages.x + page.x);
+}
+
+vec4 SampleVirtualTexture(vec2 uv)
+{
+	vec2 texel = uv * VtSize.xy;
+	vec2 dx = dFdx(texel);
+	vec2 dy = dFdy(texel);
+	float lod = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)),
+	                           1e-8));
+	int level = clamp(int(floor(lod)), 0, int(VtSize.z) - 1);
+	uv = clamp(uv, 0.0, 1.0);
+
+	vec2 inPage;
+	uint page = VtPage(level, uv, inPage);
+	uvec2 fragment = uvec2(gl_FragCoord.xy) + VtFeedback.yz;
+	if (((fragment.x | fragment.y) & VtFeedback.x) == 0u)
+	{
+		atomicOr(VtWanted[page >> 5], 1u << (page & 31u));
+	}
+
+	uint entry = VtEntries[page];
+	int resident = int((entry >> 16) & 255u);
+	if (resident != level)
+	{
+		VtPage(resident, uv, inPage);
+	}
+	vec2 slot = vec2(entry & 255u, (entry >> 8) & 255u);
+	vec2 cacheTexel = slot * VtPageSize + VtBorder + inPage;
+	return textureLod(VtCache, cacheTexel / VtSize.w, 0.0);
+}
+)";
+
+	namespace
+	{
+		using namespace VirtualTextureFormat;
+
+		// Mirrors the VirtualTextureParams block.
+		struct Params
+		{
+			float size[4];
+			uint32_t feedback[4];
+			uint32_t firstPages[MaxLevels];
+		};
+
+		// Updates after it was last wanted that a page is
+		// kept for the feedback still in flight.
+		constexpr uint64_t KeepFrames =
+		    VirtualTexture::ReadbackSlots + 2;
+		constexpr uint64_t Pinned =
+		    std::numeric_limits<uint64_t>::max();
+
+		inline uint32_t PackEntry(uint32_t slotX,
+		                          uint32_t slotY,
+		                          uint32_t level)
+		{
+			return slotX | slotY << 8 | level << 16;
+		}
+
+		inline uint32_t PagesFor(uint32_t size,
+		                         uint32_t level)
+		{
+			const auto texels = std::max(size >> level, 1u);
+			return (texels + PageContent - 1) / PageContent;
+		}
+
+		uint32_t CreateBuffer(GLenum target, size_t size,
+		                      GLenum usage, const char* label)
+		{
+			uint32_t buffer = 0;
+			glGenBuffers(1, &buffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBindBuffer(target, buffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBufferData(target, static_cast<GLsizeiptr>(size),
+			             nullptr, usage);
+			VEGAM_CHECK_GL_ERROR;
+			glBindBuffer(target, 0);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(GpuResources::Type::Buffer,
+			                       buffer, size, label);
+			return buffer;
+		}
+
+		void DeleteBuffer(uint32_t& buffer)
+		{
+			if (buffer == 0)
+			{
+				return;
+			}
+			GpuResources::Unregister(GpuResources::Type::Buffer,
+			                         buffer);
+			glDeleteBuffers(1, &buffer);
+			VEGAM_CHECK_GL_ERROR;
+			buffer = 0;
+		}
+	} // namespace
+
+	VirtualTexture::VirtualTexture(const Settings& settings)
+	    : m_settings(settings)
+	{
+		VEGAM_ASSERT(settings.cachePages > 0
+		                 && settings.cachePages <= 256,
+		             "Virtual texture caches hold 1 to 256 "
+		             "pages per side");
+		VEGAM_ASSERT(std::has_single_bit(settings.feedbackStride),
+		             "Feedback stride must be a power of two");
+		VEGAM_ASSERT(settings.maxUploads > 0
+		                 && settings.maxPending > 0,
+		             "Virtual textures must stream pages");
+	}
+
+	VirtualTexture::~VirtualTexture()
+	{
+		VEGAM_ASSERT(!IsInitialized(),
+		             "VirtualTexture destroyed without "
+		             "Shutdown()");
+	}
+
+	bool VirtualTexture::Initialize()
+	{
+		if (IsInitialized())
+		{
+			return true;
+		}
+		if (!GLAD_GL_VERSION_4_3)
+		{
+			VEGAM_WARN("Virtual textures need a GL 4.3 context");
+			return false;
+		}
+		GLint units = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &units);
+		VEGAM_CHECK_GL_ERROR;
+		GLint bindings = 0;
+		glGetIntegerv(GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS,
+		              &bindings);
+		VEGAM_CHECK_GL_ERROR;
+		if (units <= static_cast<GLint>(CacheUnit)
+		    || bindings <= static_cast<GLint>(FeedbackBinding))
+		{
+			VEGAM_WARN("Virtual textures need {} texture units "
+			           "and {} storage bindings, the context "
+			           "has {} and {}",
+			           CacheUnit + 1, FeedbackBinding + 1,
+			           units, bindings);
+			return false;
+		}
+
+		const auto& path = m_settings.archivePath;
+		if (!m_archive.Open(path))
+		{
+			return false;
+		}
+		m_entry = m_archive.Find(m_settings.id);
+		if (!m_entry
+		    || m_entry->type
+		           != Assets::ArchiveFormat::EntryType::
+		               VirtualTexture)
+		{
+			VEGAM_ERROR("{} has no virtual texture {:016x}",
+			            path,
+			            static_cast<uint64_t>(m_settings.id));
+			m_archive.Close();
+			m_entry = nullptr;
+			return false;
+		}
+
+		// The header and levels fill the first chunk.
+		std::vector<uint8_t> stored;
+		std::vector<uint8_t> first(PageBytes);
+		bool valid = m_entry->chunkCount > 0
+		             && m_archive.ReadChunks(*m_entry, 0, 1,
+		                                     stored)
+		             && m_archive.DecompressChunk(
+		                 *m_entry, 0, stored.data(),
+		                 first.data());
+		if (valid)
+		{
+			std::memcpy(&m_header, first.data(),
+			            sizeof(m_header));
+			valid = m_header.magic == Magic
+			        && m_header.version == Version
+			        && m_header.levelCount > 0
+			        && m_header.levelCount <= MaxLevels
+			        && m_entry->chunkCount
+			               == uint64_t{m_header.pageCount} + 1;
+		}
+		if (valid)
+		{
+			m_levels.resize(m_header.levelCount);
+			std::memcpy(m_levels.data(),
+			            first.data() + sizeof(Header),
+			            m_levels.size() * sizeof(Level));
+			uint32_t firstPage = 0;
+			for (uint32_t i = 0; valid && i < m_levels.size();
+			     ++i)
+			{
+				const auto& level = m_levels[i];
+				valid = level.pagesX
+				            == PagesFor(m_header.width, i)
+				        && level.pagesY
+				               == PagesFor(m_header.height, i)
+				        && level.firstPage == firstPage;
+				firstPage += level.pagesX * level.pagesY;
+			}
+			const auto& last = m_levels.back();
+			valid = valid && firstPage == m_header.pageCount
+			        && last.pagesX == 1 && last.pagesY == 1;
+		}
+		if (!valid)
+		{
+			VEGAM_ERROR("Virtual texture {:016x} in {} is "
+			            "malformed",
+			            static_cast<uint64_t>(m_settings.id),
+			            path);
+			m_archive.Close();
+			m_entry = nullptr;
+			m_levels.clear();
+			return false;
+		}
+
+		const auto pageCount = m_header.pageCount;
+		const auto cachePages = m_settings.cachePages;
+		const auto cacheSize = cachePages * PageSize;
+		glGenTextures(1, &m_cache);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, m_cache);
+		VEGAM_CHECK_GL_ERROR;
+		glTexStorage2D(GL_TEXTURE_2D, 1,
+		               m_settings.srgb ? GL_SRGB8_ALPHA8
+		                               : GL_RGBA8,
+		               static_cast<GLsizei>(cacheSize),
+		               static_cast<GLsizei>(cacheSize));
+		VEGAM_CHECK_GL_ERROR;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+		                GL_LINEAR);
+		VEGAM_CHECK_GL_ERROR;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+		                GL_LINEAR);
+		VEGAM_CHECK_GL_ERROR;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
+		                GL_CLAMP_TO_EDGE);
+		VEGAM_CHECK_GL_ERROR;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
+		                GL_CLAMP_TO_EDGE);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, 0);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::Texture,
+		                       m_cache,
+		                       size_t{cacheSize} * cacheSize * 4,
+		                       "Virtual texture cache");
+
+		m_feedbackSize = (size_t{pageCount} + 31) / 32
+		                 * sizeof(uint32_t);
+		m_tableBuffer = CreateBuffer(
+		    GL_SHADER_STORAGE_BUFFER,
+		    size_t{pageCount} * sizeof(uint32_t),
+		    GL_DYNAMIC_DRAW, "Virtual texture page table");
+		m_feedbackBuffer = CreateBuffer(
+		    GL_SHADER_STORAGE_BUFFER, m_feedbackSize,
+		    GL_DYNAMIC_COPY, "Virtual texture feedback");
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_feedbackBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI,
+		                  GL_RED_INTEGER, GL_UNSIGNED_INT,
+		                  nullptr);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		for (auto& readback : m_readbacks)
+		{
+			readback.buffer = CreateBuffer(
+			    GL_COPY_WRITE_BUFFER, m_feedbackSize,
+			    GL_STREAM_READ, "Virtual texture readback");
+		}
+		m_paramsBuffer =
+		    CreateBuffer(GL_UNIFORM_BUFFER, sizeof(Params),
+		                 GL_DYNAMIC_DRAW,
+		                 "Virtual texture params");
+
+		m_slots.assign(size_t{cachePages} * cachePages, {});
+		m_pageSlots.assign(pageCount, NoSlot);
+		m_pageStates.assign(pageCount, PageState::Absent);
+		m_table.assign(pageCount, 0);
+		m_frame = 0;
+		m_residentCount = 0;
+		m_pendingCount = 0;
+		m_nextReadback = 0;
+
+		// The last level backs every page, so it is read
+		// now and never evicted.
+		const auto lastPage = pageCount - 1;
+		std::vector<uint8_t> pixels(PageBytes);
+		const auto slot = ReadPage(lastPage, stored, pixels)
+		                      ? Place(lastPage, pixels.data())
+		                      : NoSlot;
+		if (slot == NoSlot)
+		{
+			VEGAM_ERROR("Failed to read the last level of "
+			            "virtual texture {:016x}",
+			            static_cast<uint64_t>(m_settings.id));
+			Shutdown();
+			return false;
+		}
+		m_slots[slot].lastWanted = Pinned;
+		UploadTable();
+
+		m_stopRequested = false;
+		m_thread = std::thread([this] { StreamMain(); });
+		VEGAM_INFO("Virtual texture {}x{} of {} levels, {} "
+		           "pages, in a {} page cache",
+		           m_header.width, m_header.height,
+		           m_header.levelCount, pageCount,
+		           m_slots.size());
+		return true;
+	}
+
+	void VirtualTexture::Shutdown()
+	{
+		if (m_thread.joinable())
+		{
+			{
+				std::lock_guard lock(m_mutex);
+				m_stopRequested = true;
+			}
+			m_wake.notify_all();
+			m_thread.join();
+		}
+		m_requests.clear();
+		m_loaded.clear();
+		m_buffers.clear();
+
+		for (auto& readback : m_readbacks)
+		{
+			if (readback.fence)
+			{
+				glDeleteSync(readback.fence);
+				VEGAM_CHECK_GL_ERROR;
+			}
+			readback.fence = nullptr;
+			DeleteBuffer(readback.buffer);
+		}
+		DeleteBuffer(m_tableBuffer);
+		DeleteBuffer(m_feedbackBuffer);
+		DeleteBuffer(m_paramsBuffer);
+		if (m_cache != 0)
+		{
+			GpuResources::Unregister(GpuResources::Type::Texture,
+			                         m_cache);
+			glDeleteTextures(1, &m_cache);
+			VEGAM_CHECK_GL_ERROR;
+			m_cache = 0;
+		}
+
+		m_slots.clear();
+		m_pageSlots.clear();
+		m_pageStates.clear();
+		m_table.clear();
+		m_wanted.clear();
+		m_levels.clear();
+		m_dirtyBegin = m_dirtyEnd = 0;
+		m_entry = nullptr;
+		m_archive.Close();
+	}
+
+	bool VirtualTexture::ReadPage(
+	    uint32_t page, std::vector<uint8_t>& stored,
+	    std::vector<uint8_t>& pixels) const
+	{
+		// Pages start at the second chunk.
+		const auto chunk = page + 1;
+		return m_archive.ReadChunks(*m_entry, chunk, 1, stored)
+		       && m_archive.DecompressChunk(*m_entry, chunk,
+		                                    stored.data(),
+		                                    pixels.data(), chunk);
+	}
+
+	void VirtualTexture::StreamMain()
+	{
+		std::vector<uint8_t> stored;
+		for (;;)
+		{
+			LoadedPage loaded;
+			{
+				std::unique_lock lock(m_mutex);
+				m_wake.wait(lock, [this] {
+					return m_stopRequested || !m_requests.empty();
+				});
+				if (m_stopRequested)
+				{
+					return;
+				}
+				loaded.page = m_requests.front();
+				m_requests.pop_front();
+				if (!m_buffers.empty())
+				{
+					loaded.pixels = std::move(m_buffers.back());
+					m_buffers.pop_back();
+				}
+			}
+
+			loaded.pixels.resize(PageBytes);
+			if (!ReadPage(loaded.page, stored, loaded.pixels))
+			{
+				loaded.pixels.clear();
+			}
+			std::lock_guard lock(m_mutex);
+			m_loaded.push_back(std::move(loaded));
+		}
+	}
+
+	void VirtualTexture::Update()
+	{
+		if (!IsInitialized())
+		{
+			return;
+		}
+		VEGAM_PROFILE_SCOPE("VirtualTexture::Update");
+		VEGAM_PROFILE_GPU_SCOPE("VirtualTexture");
+		++m_frame;
+
+		// Feedback of earlier frames, oldest first.
+		m_wanted.clear();
+		for (uint32_t i = 0; i < ReadbackSlots; ++i)
+		{
+			auto& readback =
+			    m_readbacks[(m_nextReadback + i) % ReadbackSlots];
+			if (!readback.fence)
+			{
+				continue;
+			}
+			const auto result =
+			    glClientWaitSync(readback.fence, 0, 0);
+			VEGAM_CHECK_GL_ERROR;
+			if (result == GL_TIMEOUT_EXPIRED)
+			{
+				break;
+			}
+			glDeleteSync(readback.fence);
+			VEGAM_CHECK_GL_ERROR;
+			readback.fence = nullptr;
+			if (result == GL_WAIT_FAILED)
+			{
+				continue;
+			}
+
+			glBindBuffer(GL_COPY_READ_BUFFER, readback.buffer);
+			VEGAM_CHECK_GL_ERROR;
+			const auto* bits = static_cast<const uint32_t*>(
+			    glMapBufferRange(GL_COPY_READ_BUFFER, 0,
+			                     static_cast<GLsizeiptr>(
+			                         m_feedbackSize),
+			                     GL_MAP_READ_BIT));
+			VEGAM_CHECK_GL_ERROR;
+			if (bits)
+			{
+				ReadFeedback(bits);
+				glUnmapBuffer(GL_COPY_READ_BUFFER);
+				VEGAM_CHECK_GL_ERROR;
+			}
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		Request(m_wanted);
+
+		// Pages read since; the rest wait for the next
+		// Update().
+		std::vector<LoadedPage> loaded;
+		{
+			std::lock_guard lock(m_mutex);
+			const auto count = std::min<size_t>(
+			    m_loaded.size(), m_settings.maxUploads);
+			loaded.assign(
+			    std::make_move_iterator(m_loaded.begin()),
+			    std::make_move_iterator(m_loaded.begin()
+			                            + count));
+			m_loaded.erase(m_loaded.begin(),
+			               m_loaded.begin() + count);
+		}
+		for (auto& page : loaded)
+		{
+			Upload(page);
+		}
+		{
+			std::lock_guard lock(m_mutex);
+			for (auto& page : loaded)
+			{
+				if (!page.pixels.empty())
+				{
+					m_buffers.push_back(std::move(page.pixels));
+				}
+			}
+		}
+		UploadTable();
+
+		Params params{};
+		params.size[0] = static_cast<float>(m_header.width);
+		params.size[1] = static_cast<float>(m_header.height);
+		params.size[2] = static_cast<float>(m_header.levelCount);
+		params.size[3] =
+		    static_cast<float>(m_settings.cachePages * PageSize);
+		// Every fragment records once in stride squared
+		// frames.
+		const auto stride = m_settings.feedbackStride;
+		params.feedback[0] = stride - 1;
+		params.feedback[1] =
+		    static_cast<uint32_t>(m_frame % stride);
+		params.feedback[2] =
+		    static_cast<uint32_t>(m_frame / stride % stride);
+		for (size_t i = 0; i < m_levels.size(); ++i)
+		{
+			params.firstPages[i] = m_levels[i].firstPage;
+		}
+		glBindBuffer(GL_UNIFORM_BUFFER, m_paramsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(params),
+		                &params);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		// The last frame's feedback goes to the next free
+		// readback, and this frame's starts empty. With
+		// every readback in flight a frame goes unread.
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+		VEGAM_CHECK_GL_ERROR;
+		auto& readback = m_readbacks[m_nextReadback];
+		if (!readback.fence)
+		{
+			glBindBuffer(GL_COPY_READ_BUFFER, m_feedbackBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBindBuffer(GL_COPY_WRITE_BUFFER, readback.buffer);
+			VEGAM_CHECK_GL_ERROR;
+			glCopyBufferSubData(GL_COPY_READ_BUFFER,
+			                    GL_COPY_WRITE_BUFFER, 0, 0,
+			                    static_cast<GLsizeiptr>(
+			                        m_feedbackSize));
+			VEGAM_CHECK_GL_ERROR;
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+			VEGAM_CHECK_GL_ERROR;
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			VEGAM_CHECK_GL_ERROR;
+			readback.fence =
+			    glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			VEGAM_CHECK_GL_ERROR;
+			m_nextReadback = (m_nextReadback + 1) % ReadbackSlots;
+		}
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_feedbackBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI,
+		                  GL_RED_INTEGER, GL_UNSIGNED_INT,
+		                  nullptr);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void VirtualTexture::Bind()
+	{
+		if (!IsInitialized())
+		{
+			return;
+		}
+		glBindBufferBase(GL_UNIFORM_BUFFER, ParamsBinding,
+		                 m_paramsBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+		                 PageTableBinding, m_tableBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+		                 FeedbackBinding, m_feedbackBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glActiveTexture(GL_TEXTURE0 + CacheUnit);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, m_cache);
+		VEGAM_CHECK_GL_ERROR;
+		glActiveTexture(GL_TEXTURE0);
+		VEGAM_CHECK_GL_ERROR;
+	}
+
+	void VirtualTexture::ReadFeedback(const uint32_t* bits)
+	{
+		const auto words = m_feedbackSize / sizeof(uint32_t);
+		for (size_t word = 0; word < words; ++word)
+		{
+			for (auto mask = bits[word]; mask != 0;
+			     mask &= mask - 1)
+			{
+				const auto page = static_cast<uint32_t>(
+				    word * 32 + std::countr_zero(mask));
+				if (page >= m_header.pageCount)
+				{
+					break;
+				}
+				switch (m_pageStates[page])
+				{
+				case PageState::Resident:
+				{
+					auto& slot = m_slots[m_pageSlots[page]];
+					if (slot.lastWanted != Pinned)
+					{
+						slot.lastWanted = m_frame;
+					}
+					break;
+				}
+				case PageState::Absent:
+					m_wanted.push_back(page);
+					break;
+				default:
+					break;
+				}
+			}
+		}
+	}
+
+	void VirtualTexture::Request(std::vector<uint32_t>& pages)
+	{
+		if (pages.empty())
+		{
+			return;
+		}
+		// Coarser levels come later in the file; they
+		// load first, so the texture sharpens level by
+		// level.
+		std::sort(pages.begin(), pages.end(),
+		          std::greater<uint32_t>());
+		pages.erase(std::unique(pages.begin(), pages.end()),
+		            pages.end());
+		bool requested = false;
+		{
+			std::lock_guard lock(m_mutex);
+			for (const auto page : pages)
+			{
+				if (m_pendingCount >= m_settings.maxPending)
+				{
+					break;
+				}
+				if (m_pageStates[page] != PageState::Absent)
+				{
+					continue;
+				}
+				m_pageStates[page] = PageState::Pending;
+				m_requests.push_back(page);
+				++m_pendingCount;
+				requested = true;
+			}
+		}
+		if (requested)
+		{
+			m_wake.notify_one();
+		}
+	}
+
+	void VirtualTexture::Upload(LoadedPage& loaded)
+	{
+		--m_pendingCount;
+		if (loaded.pixels.empty())
+		{
+			VEGAM_WARN("Virtual texture page {} failed to "
+			           "load",
+			           loaded.page);
+			m_pageStates[loaded.page] = PageState::Failed;
+			return;
+		}
+		if (Place(loaded.page, loaded.pixels.data()) == NoSlot)
+		{
+			// Asked for again if still wanted.
+			m_pageStates[loaded.page] = PageState::Absent;
+		}
+	}
+
+	uint32_t VirtualTexture::Place(uint32_t page,
+	                               const uint8_t* pixels)
+	{
+		const auto index = FindSlot();
+		if (index == NoSlot)
+		{
+			return NoSlot;
+		}
+
+		auto& slot = m_slots[index];
+		if (slot.page != NoSlot)
+		{
+			// Evicted pages fall back to their parent,
+			// which is resident or backed in turn.
+			const auto evicted = Locate(slot.page);
+			m_pageStates[slot.page] = PageState::Absent;
+			m_pageSlots[slot.page] = NoSlot;
+			--m_residentCount;
+			SetEntry(evicted.level, evicted.x, evicted.y,
+			         m_table[GetPage(evicted.level + 1,
+			                         evicted.x / 2,
+			                         evicted.y / 2)]);
+		}
+
+		const auto slotX = index % m_settings.cachePages;
+		const auto slotY = index / m_settings.cachePages;
+		glBindTexture(GL_TEXTURE_2D, m_cache);
+		VEGAM_CHECK_GL_ERROR;
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		VEGAM_CHECK_GL_ERROR;
+		glTexSubImage2D(GL_TEXTURE_2D, 0,
+		                static_cast<GLint>(slotX * PageSize),
+		                static_cast<GLint>(slotY * PageSize),
+		                PageSize, PageSize, GL_RGBA,
+		                GL_UNSIGNED_BYTE, pixels);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, 0);
+		VEGAM_CHECK_GL_ERROR;
+
+		slot.page = page;
+		slot.lastWanted = m_frame;
+		m_pageSlots[page] = index;
+		m_pageStates[page] = PageState::Resident;
+		++m_residentCount;
+		const auto coord = Locate(page);
+		SetEntry(coord.level, coord.x, coord.y,
+		         PackEntry(slotX, slotY, coord.level));
+		return index;
+	}
+
+	uint32_t VirtualTexture::FindSlot() const
+	{
+		// A free slot, else the one wanted longest ago, as
+		// long as no feedback in flight may still want it.
+		auto best = NoSlot;
+		auto oldest = m_frame > KeepFrames ? m_frame - KeepFrames
+		                                   : 0;
+		for (uint32_t i = 0; i < m_slots.size(); ++i)
+		{
+			const auto& slot = m_slots[i];
+			if (slot.page == NoSlot)
+			{
+				return i;
+			}
+			if (slot.lastWanted < oldest)
+			{
+				oldest = slot.lastWanted;
+				best = i;
+			}
+		}
+		return best;
+	}
+
+	void VirtualTexture::SetEntry(uint32_t level, uint32_t x,
+	                              uint32_t y, uint32_t entry)
+	{
+		const auto page = GetPage(level, x, y);
+		m_table[page] = entry;
+		if (m_dirtyBegin == m_dirtyEnd)
+		{
+			m_dirtyBegin = page;
+			m_dirtyEnd = page + 1;
+		}
+		else
+		{
+			m_dirtyBegin = std::min(m_dirtyBegin, page);
+			m_dirtyEnd = std::max(m_dirtyEnd, page + 1);
+		}
+		if (level == 0)
+		{
+			return;
+		}
+
+		// The four pages of the finer level under it.
+		const auto& finer = m_levels[level - 1];
+		for (uint32_t cy = 2 * y;
+		     cy < std::min(2 * y + 2, finer.pagesY); ++cy)
+		{
+			for (uint32_t cx = 2 * x;
+			     cx < std::min(2 * x + 2, finer.pagesX); ++cx)
+			{
+				const auto child = GetPage(level - 1, cx, cy);
+				if (m_pageStates[child] != PageState::Resident)
+				{
+					SetEntry(level - 1, cx, cy, entry);
+				}
+			}
+		}
+	}
+
+	uint32_t VirtualTexture::GetPage(uint32_t level,
+	                                 uint32_t x,
+	                                 uint32_t y) const
+	{
+		const auto& info = m_levels[level];
+		return info.firstPage + y * info.pagesX + x;
+	}
+
+	VirtualTexture::PageCoord
+	VirtualTexture::Locate(uint32_t page) const
+	{
+		uint32_t level = 0;
+		while (level + 1 < m_levels.size()
+		       && page >= m_levels[level + 1].firstPage)
+		{
+			++level;
+		}
+		const auto& info = m_levels[level];
+		const auto index = page - info.firstPage;
+		return {level, index % info.pagesX,
+		        index / info.pagesX};
+	}
+
+	void VirtualTexture::UploadTable()
+	{
+		if (m_dirtyBegin == m_dirtyEnd)
+		{
+			return;
+		}
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_tableBuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBufferSubData(
+		    GL_SHADER_STORAGE_BUFFER,
+		    static_cast<GLintptr>(m_dirtyBegin
+		                          * sizeof(uint32_t)),
+		    static_cast<GLsizeiptr>((m_dirtyEnd - m_dirtyBegin)
+		                            * sizeof(uint32_t)),
+		    m_table.data() + m_dirtyBegin);
+		VEGAM_CHECK_GL_ERROR;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		VEGAM_CHECK_GL_ERROR;
+		m_dirtyBegin = m_dirtyEnd = 0;
+	}
+} // namespace AthiVegam::Graphics
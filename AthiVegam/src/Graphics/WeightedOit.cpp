@@ -0,0 +1,413 @@
+#include "AthiVegam/Graphics/WeightedOit.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/GLState.h"
+#include "AthiVegam/Graphics/GpuProfiler.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/RenderState.h"
+#include "AthiVegam/Log.h"
+#include "glad/glad.h"
+
+namespace AthiVegam::Graphics
+{
+	namespace
+	{
+		constexpr uint32_t AccumulationUnit = 0;
+		constexpr uint32_t WeightUnit = 1;
+
+		// One triangle covering the screen.
+		const char* CompositeVertexSource = R"(#version 430 core
+void main()
+{
+	vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+		// Blended with (1 - alpha, alpha): the average
+		// color covers what the revealage doesn't.
+		const char* CompositeFragmentSource = R"(#version 430 core
+uniform sampler2D Accumulation;
+uniform sampler2D Weight;
+
+layout(location = 0) out vec4 OutColor;
+
+void main()
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	vec4 accumulation = texelFetch(Accumulation, texel, 0);
+	float revealage = accumulation.a;
+	if (revealage >= 1.0)
+	{
+		discard;
+	}
+	float weight = texelFetch(Weight, texel, 0).r;
+	OutColor = vec4(accumulation.rgb / max(weight, 1e-5),
+	                revealage);
+}
+)";
+
+		// Weighted by coverage and, falling off with depth,
+		// as in McGuire and Bavoil's equation 10.
+		const char* WeightSource = R"(
+void AvWeightedOit(vec4 color, out vec4 accumulation,
+                   out vec4 weight)
+{
+	float a = clamp(color.a, 0.0, 1.0);
+	float z = 1.0 - gl_FragCoord.z * 0.9;
+	float w = a * clamp(pow(min(1.0, a * 10.0) + 0.01, 3.0)
+	                        * 1e8 * z * z * z,
+	                    1e-2, 3e3);
+	accumulation = vec4(color.rgb * w, a);
+	weight = vec4(w);
+}
+)";
+
+		uint32_t CreateTarget(int width, int height,
+		                      GLenum format, size_t texelSize,
+		                      const char* label)
+		{
+			uint32_t texture = 0;
+			glGenTextures(1, &texture);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D, texture);
+			VEGAM_CHECK_GL_ERROR;
+			glTexStorage2D(GL_TEXTURE_2D, 1, format, width,
+			               height);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D,
+			                GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			VEGAM_CHECK_GL_ERROR;
+			glTexParameteri(GL_TEXTURE_2D,
+			                GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			VEGAM_CHECK_GL_ERROR;
+			glBindTexture(GL_TEXTURE_2D, 0);
+			VEGAM_CHECK_GL_ERROR;
+			GpuResources::Register(
+			    GpuResources::Type::Texture, texture,
+			    static_cast<size_t>(width) * height * texelSize,
+			    label);
+			return texture;
+		}
+
+		void DeleteTarget(uint32_t& texture)
+		{
+			if (texture == 0)
+			{
+				return;
+			}
+			GpuResources::Unregister(GpuResources::Type::Texture,
+			                         texture);
+			glDeleteTextures(1, &texture);
+			VEGAM_CHECK_GL_ERROR;
+			texture = 0;
+		}
+	} // namespace
+
+	WeightedOit::WeightedOit() = default;
+
+	WeightedOit::~WeightedOit()
+	{
+		VEGAM_ASSERT(!IsInitialized() && m_framebuffer == 0,
+		             "WeightedOit destroyed without Shutdown()");
+	}
+
+	const char* WeightedOit::GetShaderSource()
+	{
+		return WeightSource;
+	}
+
+	bool WeightedOit::Initialize()
+	{
+		if (IsInitialized())
+		{
+			return true;
+		}
+		if (!GLAD_GL_VERSION_4_3)
+		{
+			VEGAM_WARN("Weighted OIT needs a GL 4.3 context");
+			return false;
+		}
+		m_compositeShader = std::make_unique<Shader>(
+		    CompositeVertexSource, CompositeFragmentSource);
+		if (!m_compositeShader->IsReady())
+		{
+			m_compositeShader.reset();
+			return false;
+		}
+		m_compositeShader->SetUniformInt("Accumulation",
+		                                 AccumulationUnit);
+		m_compositeShader->SetUniformInt("Weight", WeightUnit);
+
+		glGenVertexArrays(1, &m_vao);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::VertexArray,
+		                       m_vao, 0, "OIT composite");
+		return true;
+	}
+
+	void WeightedOit::Shutdown()
+	{
+		DestroyTargets();
+		m_compositeShader.reset();
+		if (m_vao != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::VertexArray, m_vao);
+			glDeleteVertexArrays(1, &m_vao);
+			VEGAM_CHECK_GL_ERROR;
+			m_vao = 0;
+		}
+		m_active = false;
+	}
+
+	void WeightedOit::DestroyTargets()
+	{
+		if (m_framebuffer != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Framebuffer, m_framebuffer);
+			glDeleteFramebuffers(1, &m_framebuffer);
+			VEGAM_CHECK_GL_ERROR;
+			m_framebuffer = 0;
+		}
+		if (m_depth != 0)
+		{
+			GpuResources::Unregister(
+			    GpuResources::Type::Renderbuffer, m_depth);
+			glDeleteRenderbuffers(1, &m_depth);
+			VEGAM_CHECK_GL_ERROR;
+			m_depth = 0;
+		}
+		DeleteTarget(m_accumulation);
+		DeleteTarget(m_weight);
+		m_width = 0;
+		m_height = 0;
+		m_depthType = 0;
+		m_depthName = 0;
+	}
+
+	void WeightedOit::Resize(int width, int height)
+	{
+		DestroyTargets();
+		m_width = width;
+		m_height = height;
+		m_accumulation = CreateTarget(width, height,
+		                              GL_RGBA16F, 8,
+		                              "OIT accumulation");
+		m_weight = CreateTarget(width, height, GL_R16F, 2,
+		                        "OIT weight");
+
+		glGenFramebuffers(1, &m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		glFramebufferTexture2D(GL_FRAMEBUFFER,
+		                       GL_COLOR_ATTACHMENT0,
+		                       GL_TEXTURE_2D, m_accumulation, 0);
+		VEGAM_CHECK_GL_ERROR;
+		glFramebufferTexture2D(GL_FRAMEBUFFER,
+		                       GL_COLOR_ATTACHMENT1,
+		                       GL_TEXTURE_2D, m_weight, 0);
+		VEGAM_CHECK_GL_ERROR;
+		constexpr GLenum buffers[] = {GL_COLOR_ATTACHMENT0,
+		                              GL_COLOR_ATTACHMENT1};
+		glDrawBuffers(2, buffers);
+		VEGAM_CHECK_GL_ERROR;
+		GpuResources::Register(GpuResources::Type::Framebuffer,
+		                       m_framebuffer, 0, "OIT");
+	}
+
+	bool WeightedOit::AttachDepth(uint32_t framebuffer)
+	{
+		GLint type = GL_NONE;
+		GLint name = 0;
+		GLint level = 0;
+		if (framebuffer != 0)
+		{
+			glGetFramebufferAttachmentParameteriv(
+			    GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+			    GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+			VEGAM_CHECK_GL_ERROR;
+			if (type != GL_NONE)
+			{
+				glGetFramebufferAttachmentParameteriv(
+				    GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+				    GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME,
+				    &name);
+				VEGAM_CHECK_GL_ERROR;
+			}
+			if (type == GL_TEXTURE)
+			{
+				glGetFramebufferAttachmentParameteriv(
+				    GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+				    GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_LEVEL,
+				    &level);
+				VEGAM_CHECK_GL_ERROR;
+			}
+		}
+		else
+		{
+			if (m_depth == 0)
+			{
+				glGenRenderbuffers(1, &m_depth);
+				VEGAM_CHECK_GL_ERROR;
+				glBindRenderbuffer(GL_RENDERBUFFER, m_depth);
+				VEGAM_CHECK_GL_ERROR;
+				glRenderbufferStorage(GL_RENDERBUFFER,
+				                      GL_DEPTH24_STENCIL8,
+				                      m_width, m_height);
+				VEGAM_CHECK_GL_ERROR;
+				glBindRenderbuffer(GL_RENDERBUFFER, 0);
+				VEGAM_CHECK_GL_ERROR;
+				GpuResources::Register(
+				    GpuResources::Type::Renderbuffer, m_depth,
+				    static_cast<size_t>(m_width) * m_height * 4,
+				    "OIT depth");
+			}
+			type = GL_RENDERBUFFER;
+			name = static_cast<GLint>(m_depth);
+		}
+		if (type == m_depthType
+		    && static_cast<uint32_t>(name) == m_depthName)
+		{
+			return true;
+		}
+
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		if (type == GL_RENDERBUFFER)
+		{
+			glFramebufferRenderbuffer(
+			    GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+			    GL_RENDERBUFFER, static_cast<GLuint>(name));
+		}
+		else
+		{
+			// Nothing to test against when there's none.
+			glFramebufferTexture(GL_FRAMEBUFFER,
+			                     GL_DEPTH_ATTACHMENT,
+			                     static_cast<GLuint>(name),
+			                     level);
+		}
+		VEGAM_CHECK_GL_ERROR;
+		const auto status =
+		    glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		if (status != GL_FRAMEBUFFER_COMPLETE)
+		{
+			VEGAM_ERROR("OIT target {}x{} incomplete: {:#x}",
+			            m_width, m_height, status);
+			m_depthType = 0;
+			m_depthName = 0;
+			return false;
+		}
+		m_depthType = type;
+		m_depthName = static_cast<uint32_t>(name);
+		return true;
+	}
+
+	bool WeightedOit::Begin()
+	{
+		VEGAM_ASSERT(IsInitialized(),
+		             "WeightedOit used before Initialize()");
+		VEGAM_ASSERT(!m_active, "Weighted OIT already begun");
+		GLint framebuffer = 0;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+		GLint viewport[4] = {};
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		VEGAM_CHECK_GL_ERROR;
+		const auto width = viewport[0] + viewport[2];
+		const auto height = viewport[1] + viewport[3];
+		if (width <= 0 || height <= 0)
+		{
+			return false;
+		}
+		m_target = static_cast<uint32_t>(framebuffer);
+		if (m_framebuffer == 0 || width != m_width
+		    || height != m_height)
+		{
+			Resize(width, height);
+			glBindFramebuffer(GL_FRAMEBUFFER, m_target);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		if (!AttachDepth(m_target))
+		{
+			return false;
+		}
+
+		if (m_target == 0)
+		{
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+			VEGAM_CHECK_GL_ERROR;
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER,
+			                  m_framebuffer);
+			VEGAM_CHECK_GL_ERROR;
+			glBlitFramebuffer(0, 0, width, height, 0, 0, width,
+			                  height, GL_DEPTH_BUFFER_BIT,
+			                  GL_NEAREST);
+			VEGAM_CHECK_GL_ERROR;
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		VEGAM_CHECK_GL_ERROR;
+
+		// Nothing accumulated, everything revealed. Clears
+		// follow the scissor, but so do the draws and the
+		// composite.
+		GLState::SetColorMask(true);
+		constexpr GLfloat accumulation[] = {0.0f, 0.0f, 0.0f,
+		                                    1.0f};
+		constexpr GLfloat weight[] = {0.0f, 0.0f, 0.0f, 0.0f};
+		glClearBufferfv(GL_COLOR, 0, accumulation);
+		VEGAM_CHECK_GL_ERROR;
+		glClearBufferfv(GL_COLOR, 1, weight);
+		VEGAM_CHECK_GL_ERROR;
+		m_active = true;
+		return true;
+	}
+
+	void WeightedOit::Composite(RenderState& state)
+	{
+		VEGAM_ASSERT(m_active, "Weighted OIT not begun");
+		VEGAM_PROFILE_SCOPE("WeightedOit::Composite");
+		VEGAM_PROFILE_GPU_SCOPE("OIT composite");
+		m_active = false;
+		glBindFramebuffer(GL_FRAMEBUFFER, m_target);
+		VEGAM_CHECK_GL_ERROR;
+
+		GLState::SetEnabled(GLState::Capability::Blend, true);
+		GLState::SetBlendFunc(GL_ONE_MINUS_SRC_ALPHA,
+		                      GL_SRC_ALPHA);
+		GLState::SetEnabled(GLState::Capability::DepthTest,
+		                    false);
+		GLState::SetEnabled(GLState::Capability::CullFace,
+		                    false);
+		// Wireframe stays on for the draws after.
+		const auto polygonMode = GLState::GetPolygonMode();
+		GLState::SetPolygonMode(GL_FILL);
+
+		glActiveTexture(GL_TEXTURE0 + WeightUnit);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, m_weight);
+		VEGAM_CHECK_GL_ERROR;
+		glActiveTexture(GL_TEXTURE0 + AccumulationUnit);
+		VEGAM_CHECK_GL_ERROR;
+		glBindTexture(GL_TEXTURE_2D, m_accumulation);
+		VEGAM_CHECK_GL_ERROR;
+		Shader::UseProgram(m_compositeShader->GetId());
+		glBindVertexArray(m_vao);
+		VEGAM_CHECK_GL_ERROR;
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		VEGAM_CHECK_GL_ERROR;
+
+		if (polygonMode != GLState::Unknown)
+		{
+			GLState::SetPolygonMode(polygonMode);
+		}
+		// Bindings the draws after expect are gone.
+		state.Invalidate();
+	}
+} // namespace AthiVegam::Graphics
@@ -1,221 +1,624 @@
 #include "AthiVegam/Input/Controller.h"
 
+#include "AthiVegam/Core/CVar.h"
+#include "AthiVegam/Core/CpuTopology.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Core/TripleBuffer.h"
 #include "AthiVegam/Log.h"
 #include "SDL2/SDL_events.h"
 #include "SDL2/SDL_gamecontroller.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace AthiVegam::Input
 {
-	std::unordered_map<
-	    int, std::unique_ptr<Controller::SDLController>>
-	    Controller::availableControllers;
-	float Controller::deadzone =
-	    0.1f; /*Should probalby be customizable*/
+	std::array<Controller::SDLController,
+	           Controller::MaxControllers>
+	    Controller::controllers;
 
 	constexpr const auto SDL_AXES_NORMALIER = 32767.f;
 
-	void Controller::OnControllerConnected(
-	    SDL_ControllerDeviceEvent& e)
+	namespace
 	{
-		int deviceIndex = e.which;
+		Core::CVar<float> deadzoneCVar(
+		    "input.deadzone", Controller::DefaultDeadzone,
+		    "Stick values within this read 0");
+
+		using AxesStates =
+		    std::array<float, (int)ControllerAxis::COUNT>;
+
+		struct ControllerSamples
+		{
+			struct Sample
+			{
+				int controllerId = -1;
+				ControllerButtonMask buttons = 0;
+				AxesStates axes{};
+			};
+
+			uint32_t count = 0;
+			std::array<Sample, Controller::MaxControllers>
+			    samples;
+		};
+
+		struct SampledController
+		{
+			int controllerId;
+			SDL_GameController* gc;
+		};
+
+		// The sampling thread reads sampledControllers under
+		// the mutex; controllers are only closed while
+		// holding it.
+		std::thread samplingThread;
+		std::atomic<bool> samplingStopRequested{false};
+		std::mutex sampledControllersMutex;
+		std::vector<SampledController> sampledControllers;
+		Core::TripleBuffer<ControllerSamples> samples;
+
+		const AxesStates noAxes{};
+
+		// The device thread opens and closes controllers
+		// for the main thread, whose event handlers only
+		// queue requests.
+		struct DeviceRequest
+		{
+			// As of the connection event; SDL renumbers
+			// devices, so the instance id is checked.
+			int deviceIndex = -1;
+			int instanceId = -1;
+			// Set to close instead.
+			SDL_GameController* close = nullptr;
+		};
+
+		struct OpenedController
+		{
+			SDL_GameController* gc;
+			int deviceIndex;
+			int instanceId;
+		};
+
+		std::thread deviceThread;
+		std::mutex deviceMutex;
+		std::condition_variable deviceWake;
+		bool deviceStopRequested = false;
+		std::vector<DeviceRequest> deviceRequests;
+		std::vector<OpenedController> openedControllers;
+		// Lets Update() skip the mutex on most frames.
+		std::atomic<bool> hasOpenedControllers{false};
+
+		// The device's index now, or -1 if it is gone.
+		int FindDevice(const DeviceRequest& request)
+		{
+			if (SDL_JoystickGetDeviceInstanceID(
+			        request.deviceIndex)
+			    == request.instanceId)
+			{
+				return request.deviceIndex;
+			}
+			for (int i = 0; i < SDL_NumJoysticks(); ++i)
+			{
+				if (SDL_JoystickGetDeviceInstanceID(i)
+				    == request.instanceId)
+				{
+					return i;
+				}
+			}
+			return -1;
+		}
+
+		SDL_GameController* OpenDevice(
+		    const DeviceRequest& request, int& deviceIndex)
+		{
+			deviceIndex = FindDevice(request);
+			if (deviceIndex < 0
+			    || !SDL_IsGameController(deviceIndex))
+			{
+				return nullptr;
+			}
+
+			auto* gc = SDL_GameControllerOpen(deviceIndex);
+			if (!gc)
+			{
+				VEGAM_ERROR("SDL Error: Error opening game "
+				            "controller with Device Index "
+				            "{}: {}",
+				            deviceIndex, SDL_GetError());
+				return nullptr;
+			}
+			const auto* name = SDL_GameControllerName(gc);
+			VEGAM_INFO("Opened controller '{}', deviceIndex({})",
+			           name ? name : "unknown", deviceIndex);
+			return gc;
+		}
+
+		void RunDevices()
+		{
+			Core::Profiler::SetThreadName("Controller devices");
+			Core::SetThreadClass(Core::ThreadClass::Background);
+
+			std::vector<DeviceRequest> requests;
+			std::vector<OpenedController> opened;
+			std::unique_lock lock(deviceMutex);
+			while (true)
+			{
+				deviceWake.wait(lock, [] {
+					return deviceStopRequested
+					       || !deviceRequests.empty();
+				});
+				if (deviceStopRequested)
+				{
+					// Shutdown() closes what is left.
+					return;
+				}
+				requests.swap(deviceRequests);
+				lock.unlock();
+
+				opened.clear();
+				for (const auto& request : requests)
+				{
+					if (request.close)
+					{
+						SDL_GameControllerClose(request.close);
+						continue;
+					}
+					int deviceIndex = -1;
+					auto* gc = OpenDevice(request, deviceIndex);
+					if (gc)
+					{
+						opened.push_back({gc, deviceIndex,
+						                  request.instanceId});
+					}
+				}
+				requests.clear();
+
+				lock.lock();
+				if (!opened.empty())
+				{
+					openedControllers.insert(
+					    openedControllers.end(), opened.begin(),
+					    opened.end());
+					hasOpenedControllers.store(
+					    true, std::memory_order_release);
+				}
+			}
+		}
+
+		void RequestDevice(const DeviceRequest& request)
+		{
+			{
+				std::lock_guard lock(deviceMutex);
+				deviceRequests.push_back(request);
+			}
+			if (!deviceThread.joinable())
+			{
+				deviceStopRequested = false;
+				deviceThread = std::thread(RunDevices);
+			}
+			deviceWake.notify_one();
+		}
+
+		void StopDevices()
+		{
+			if (deviceThread.joinable())
+			{
+				{
+					std::lock_guard lock(deviceMutex);
+					deviceStopRequested = true;
+				}
+				deviceWake.notify_one();
+				deviceThread.join();
+			}
+
+			for (const auto& request : deviceRequests)
+			{
+				if (request.close)
+				{
+					SDL_GameControllerClose(request.close);
+				}
+			}
+			deviceRequests.clear();
+			for (const auto& opened : openedControllers)
+			{
+				SDL_GameControllerClose(opened.gc);
+			}
+			openedControllers.clear();
+			hasOpenedControllers = false;
+		}
+
+		ControllerButtonMask ReadController(
+		    SDL_GameController* gc, AxesStates& axes)
+		{
+			ControllerButtonMask buttons = 0;
+			for (auto i = 0;
+			     i < static_cast<int>(ControllerButton::COUNT);
+			     ++i)
+			{
+				buttons |=
+				    static_cast<ControllerButtonMask>(
+				        SDL_GameControllerGetButton(
+				            gc, static_cast<
+				                    SDL_GameControllerButton>(i)))
+				    << i;
+			}
+
+			for (auto i = 0;
+			     i < static_cast<int>(ControllerAxis::COUNT); ++i)
+			{
+				axes[i] = std::clamp(
+				    SDL_GameControllerGetAxis(
+				        gc,
+				        static_cast<SDL_GameControllerAxis>(i))
+				        / SDL_AXES_NORMALIER,
+				    -1.f, 1.f);
+			}
+			return buttons;
+		}
+
+		void RunSampling(uint32_t rateHz)
+		{
+			using Clock = std::chrono::steady_clock;
+			Core::Profiler::SetThreadName("Input");
+			Core::SetThreadClass(Core::ThreadClass::Latency);
+			const auto period =
+			    std::chrono::duration_cast<Clock::duration>(
+			        std::chrono::duration<double>(1.0
+			                                      / rateHz));
+
+			auto deadline = Clock::now();
+			while (!samplingStopRequested.load(
+			    std::memory_order_relaxed))
+			{
+				{
+					std::lock_guard lock(
+					    sampledControllersMutex);
+					// Also queues the controller events, stamped
+					// at this rate rather than the frame rate.
+					SDL_GameControllerUpdate();
 
-		if (SDL_IsGameController(deviceIndex))
+					auto& back = samples.Back();
+					back.count = 0;
+					for (const auto& controller :
+					     sampledControllers)
+					{
+						auto& sample =
+						    back.samples[back.count++];
+						sample.controllerId =
+						    controller.controllerId;
+						sample.buttons = ReadController(
+						    controller.gc, sample.axes);
+					}
+				}
+				samples.Publish();
+
+				// Sleeps rather than spins; at 1 kHz that is
+				// only as regular as the OS timer.
+				deadline =
+				    std::max(deadline + period, Clock::now());
+				std::this_thread::sleep_until(deadline);
+			}
+		}
+	} // namespace
+
+	void Controller::OnControllerConnected(
+	    std::span<const Core::ControllerConnected> events)
+	{
+		for (const auto& e : events)
 		{
-			auto controller = std::make_unique<
-			    Controller::SDLController>();
-			controller->gc =
-			    SDL_GameControllerOpen(deviceIndex);
-			if (controller->gc)
+			// Cheap, unlike opening; identifies the device
+			// if SDL renumbers it before the open.
+			const auto instanceId =
+			    SDL_JoystickGetDeviceInstanceID(e.deviceIndex);
+			if (instanceId < 0
+			    || GetControllerId(instanceId) >= 0)
 			{
-				controller->controllerIndex = deviceIndex;
-				std::fill(controller->buttonStates.begin(),
-				          controller->buttonStates.end(),
-				          false);
-				std::fill(
-				    controller->prevButtonStates.begin(),
-				    controller->prevButtonStates.end(),
-				    false);
-				std::fill(controller->axesStates.begin(),
-				          controller->axesStates.end(),
-				          0.0f);
-				std::fill(
-				    controller->prevAxesStates.begin(),
-				    controller->prevAxesStates.end(), 0.0f);
+				continue;
+			}
+			RequestDevice({e.deviceIndex, instanceId, nullptr});
+		}
+	}
 
-				int mapIndex = GentNextFreeIndex();
-				VEGAM_INFO("Controller connected: "
-				           "mapIndex({}), deviceIndex({})",
-				           mapIndex, deviceIndex);
-				availableControllers[mapIndex] =
-				    std::move_if_noexcept(controller);
+	void Controller::AddOpenedControllers()
+	{
+		if (!hasOpenedControllers.load(
+		        std::memory_order_acquire))
+		{
+			return;
+		}
+
+		std::vector<OpenedController> opened;
+		{
+			std::lock_guard lock(deviceMutex);
+			opened.swap(openedControllers);
+			hasOpenedControllers.store(
+			    false, std::memory_order_relaxed);
+		}
+
+		for (const auto& device : opened)
+		{
+			// Unplugged again while it was opening.
+			if (!SDL_GameControllerGetAttached(device.gc)
+			    || GetControllerId(device.instanceId) >= 0)
+			{
+				RequestDevice({-1, -1, device.gc});
+				continue;
 			}
-			else
+
+			int slot = GentNextFreeIndex();
+			if (slot < 0)
 			{
-				VEGAM_ERROR(
-				    "SDL Error: Error opening game "
-				    "controller with Device Index {}: {}",
-				    deviceIndex, SDL_GetError());
+				VEGAM_WARN("Ignoring controller with Device "
+				           "Index {}: all {} slots are in use",
+				           device.deviceIndex, MaxControllers);
+				RequestDevice({-1, -1, device.gc});
+				continue;
 			}
+
+			auto& controller = controllers[slot];
+			controller = SDLController{};
+			controller.deviceIndex = device.deviceIndex;
+			controller.instanceId = device.instanceId;
+			controller.gc = device.gc;
+			controller.connected = true;
+
+			VEGAM_INFO("Controller connected: "
+			           "mapIndex({}), deviceIndex({})",
+			           slot, device.deviceIndex);
+			std::lock_guard lock(sampledControllersMutex);
+			sampledControllers.push_back({slot, device.gc});
 		}
 	}
 
 	void Controller::OnControllerDisconnected(
-	    SDL_ControllerDeviceEvent& e)
+	    std::span<const Core::ControllerDisconnected> events)
 	{
-		int deviceIndex = e.which;
-
-		for (auto it = availableControllers.begin();
-		     it != availableControllers.end(); ++it)
+		for (const auto& e : events)
 		{
-			auto controller = it->second.get();
-			if (controller->controllerIndex == deviceIndex)
+			const int slot = GetControllerId(e.instanceId);
+			if (slot < 0)
+			{
+				continue;
+			}
+
+			auto& controller = controllers[slot];
+			VEGAM_WARN("Controller disconnected: {}",
+			           controller.deviceIndex);
 			{
-				VEGAM_WARN("Controller disconnected: {}",
-				           deviceIndex);
-				SDL_GameControllerClose(controller->gc);
-				availableControllers.erase(it);
-				break;
+				std::lock_guard lock(sampledControllersMutex);
+				std::erase_if(sampledControllers,
+				              [slot](const auto& sampled) {
+					              return sampled.controllerId
+					                     == slot;
+				              });
 			}
+			RequestDevice({-1, -1, controller.gc});
+			controller = SDLController{};
 		}
 	}
 
 	void Controller::Shutdown()
 	{
-		for (auto it = availableControllers.begin();
-		     it != availableControllers.end();)
+		StopSampling();
+		StopDevices();
+		sampledControllers.clear();
+		for (auto& controller : controllers)
 		{
-			auto controller = it->second.get();
-			SDL_GameControllerClose(controller->gc);
-			it = availableControllers.erase(it);
+			if (controller.gc)
+			{
+				SDL_GameControllerClose(controller.gc);
+			}
+			controller = SDLController{};
 		}
 	}
 
 	void Controller::Update()
 	{
-		for (auto it = availableControllers.begin();
-		     it != availableControllers.end(); ++it)
+		AddOpenedControllers();
+		for (auto& controller : controllers)
 		{
-			auto controller = it->second.get();
-			VEGAM_ASSERT((controller && controller->gc),
-			             "Invalid Game Controller in "
-			             "availableControllers map");
-			if (controller && controller->gc)
+			controller.connected = controller.gc != nullptr;
+			controller.prevButtons = controller.buttons;
+			if (controller.gc && !samplingThread.joinable())
 			{
-				controller->UpdatePreviousStates();
+				controller.buttons = ReadController(
+				    controller.gc, controller.axes);
+			}
+		}
 
-				for (auto i = 0;
-				     i < static_cast<int>(
-				         ControllerButton::COUNT);
-				     ++i)
-				{
-					controller->buttonStates[i] =
-					    SDL_GameControllerGetButton(
-					        controller->gc,
-					        static_cast<
-					            SDL_GameControllerButton>(
-					            i));
-				}
+		if (!samplingThread.joinable())
+		{
+			return;
+		}
 
-				for (auto i = 0; i < static_cast<int>(
-				                     ControllerAxis::COUNT);
-				     ++i)
-				{
-					controller->axesStates[i] = std::clamp(
-					    SDL_GameControllerGetAxis(
-					        controller->gc,
-					        static_cast<
-					            SDL_GameControllerAxis>(i))
-					        / SDL_AXES_NORMALIER,
-					    -1.f, 1.f);
-				}
+		// A controller connected since the latest sample
+		// keeps its previous state until the next one.
+		samples.Update();
+		const auto& latest = samples.Front();
+		for (uint32_t i = 0; i < latest.count; ++i)
+		{
+			const auto& sample = latest.samples[i];
+			auto& controller = controllers[sample.controllerId];
+			if (controller.gc)
+			{
+				controller.buttons = sample.buttons;
+				controller.axes = sample.axes;
 			}
 		}
 	}
 
+	void Controller::StartSampling(uint32_t rateHz)
+	{
+		VEGAM_ASSERT(
+		    !samplingThread.joinable(),
+		    "Controller sampling is already running!");
+		if (samplingThread.joinable() || rateHz == 0)
+		{
+			return;
+		}
+
+		samplingStopRequested = false;
+		samplingThread = std::thread(RunSampling, rateHz);
+		VEGAM_INFO("Sampling controllers at {} Hz", rateHz);
+	}
+
+	void Controller::StopSampling()
+	{
+		if (!samplingThread.joinable())
+		{
+			return;
+		}
+
+		samplingStopRequested = true;
+		samplingThread.join();
+	}
+
+	void Controller::Apply(int controllerId, bool connected,
+	                       ControllerButtonMask buttons,
+	                       ControllerAxes axes)
+	{
+		auto& controller = controllers[controllerId];
+		controller.connected = connected;
+		controller.prevButtons = controller.buttons;
+		controller.buttons = connected ? buttons : 0;
+		std::copy(axes.begin(), axes.end(),
+		          controller.axes.begin());
+	}
+
 	bool Controller::GetButton(int controllerId,
 	                           ControllerButton button)
 	{
-		auto it = availableControllers.find(controllerId);
-		if (it != availableControllers.end())
+		if (IsControllerAvailabe(controllerId))
 		{
-			return it->second.get()
-			    ->buttonStates[static_cast<int>(button)];
+			return (GetButtons(controllerId)
+			        >> static_cast<int>(button))
+			       & 1;
 		}
-		VEGAM_WARN("Controller Id: {} is not available",
-		           controllerId);
+		VEGAM_WARN_ONCE("Controller Id: {} is not available",
+		                controllerId);
 		return false;
 	}
 
 	bool Controller::GetButtonDown(int controllerId,
 	                               ControllerButton button)
 	{
-		auto it = availableControllers.find(controllerId);
-		if (it != availableControllers.end())
+		if (IsControllerAvailabe(controllerId))
 		{
-			return it->second.get()
-			           ->buttonStates[static_cast<int>(
-			               button)]
-			       && !it->second.get()->prevButtonStates
-			               [static_cast<int>(button)];
+			return (GetButtonsDown(controllerId)
+			        >> static_cast<int>(button))
+			       & 1;
 		}
-		VEGAM_WARN("Controller Id: {} is not available",
-		           controllerId);
+		VEGAM_WARN_ONCE("Controller Id: {} is not available",
+		                controllerId);
 		return false;
 	}
 
 	bool Controller::GetButtonUp(int controllerId,
 	                             ControllerButton button)
 	{
-		auto it = availableControllers.find(controllerId);
-		if (it != availableControllers.end())
+		if (IsControllerAvailabe(controllerId))
 		{
-			return !it->second.get()
-			            ->buttonStates[static_cast<int>(
-			                button)]
-			       && it->second.get()->prevButtonStates
-			              [static_cast<int>(button)];
+			return (GetButtonsUp(controllerId)
+			        >> static_cast<int>(button))
+			       & 1;
 		}
-		VEGAM_WARN("Controller Id: {} is not available",
-		           controllerId);
+		VEGAM_WARN_ONCE("Controller Id: {} is not available",
+		                controllerId);
 		return false;
 	}
 
 	float Controller::GetAxisRaw(int controllerId,
 	                             ControllerAxis axis)
 	{
-		auto it = availableControllers.find(controllerId);
-		if (it != availableControllers.end())
+		if (IsControllerAvailabe(controllerId))
 		{
-			return it->second.get()
-			    ->axesStates[static_cast<int>(axis)];
+			return controllers[controllerId]
+			    .axes[static_cast<int>(axis)];
 		}
-		VEGAM_WARN("Controller Id: {} is not available",
-		           controllerId);
+		VEGAM_WARN_ONCE("Controller Id: {} is not available",
+		                controllerId);
 		return 0.0f;
 	}
 
+	float Controller::GetDeadzone()
+	{
+		return deadzoneCVar.Get();
+	}
+
 	float Controller::GetAxis(int controllerId,
-	                          ControllerAxis axis)
+	                          ControllerAxis axis,
+	                          float deadzone)
 	{
 		auto val = GetAxisRaw(controllerId, axis);
 		return abs(val) > deadzone ? val : 0.f;
 	}
 
-	int Controller::GentNextFreeIndex()
+	ControllerButtonMask
+	Controller::GetButtons(int controllerId)
+	{
+		return IsControllerAvailabe(controllerId)
+		           ? controllers[controllerId].buttons
+		           : 0;
+	}
+
+	ControllerButtonMask
+	Controller::GetButtonsDown(int controllerId)
 	{
-		int ret = -1;
-		for (int i = 0; i < SDL_NumJoysticks(); ++i)
+		if (!IsControllerAvailabe(controllerId))
 		{
-			if (availableControllers.count(i) == 0)
+			return 0;
+		}
+		const auto& controller = controllers[controllerId];
+		return controller.buttons & ~controller.prevButtons;
+	}
+
+	ControllerButtonMask
+	Controller::GetButtonsUp(int controllerId)
+	{
+		if (!IsControllerAvailabe(controllerId))
+		{
+			return 0;
+		}
+		const auto& controller = controllers[controllerId];
+		return ~controller.buttons & controller.prevButtons;
+	}
+
+	ControllerAxes Controller::GetAxesRaw(int controllerId)
+	{
+		return IsControllerAvailabe(controllerId)
+		           ? ControllerAxes(
+		                 controllers[controllerId].axes)
+		           : ControllerAxes(noAxes);
+	}
+
+	int Controller::GetControllerId(int instanceId)
+	{
+		for (int i = 0; i < MaxControllers; ++i)
+		{
+			if (controllers[i].gc
+			    && controllers[i].instanceId == instanceId)
 			{
-				ret = i;
-				break;
+				return i;
 			}
 		}
+		return -1;
+	}
 
-		return ret;
+	int Controller::GentNextFreeIndex()
+	{
+		for (int i = 0; i < MaxControllers; ++i)
+		{
+			if (!controllers[i].gc)
+			{
+				return i;
+			}
+		}
+		return -1;
 	}
 
 } // namespace AthiVegam::Input
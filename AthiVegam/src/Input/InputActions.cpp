@@ -0,0 +1,350 @@
+#include "AthiVegam/Input/InputActions.h"
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace AthiVegam::Input
+{
+	namespace
+	{
+		enum class Source : uint8_t
+		{
+			Key,
+			MouseButton,
+			ControllerButton,
+			ControllerAxis
+		};
+
+		// As added; compiled into the tables below.
+		struct Binding
+		{
+			Source source;
+			bool toAxis;
+			uint16_t target;
+			int code;
+			int controllerId;
+			float value;
+			float deadzone;
+		};
+
+		struct ButtonEntry
+		{
+			uint16_t code;
+			// Slot + 1, 0 for any controller.
+			uint8_t controller;
+			uint16_t target;
+			float value;
+		};
+
+		struct StickEntry
+		{
+			uint8_t axis;
+			uint8_t controller;
+			uint16_t target;
+			float deadzone;
+			float scale;
+		};
+
+		std::vector<std::string> actionNames;
+		std::vector<std::string> axisNames;
+		std::vector<Binding> bindings;
+		bool dirty = false;
+
+		// Compiled tables, one per source and target kind.
+		std::vector<ButtonEntry> keyActions;
+		std::vector<ButtonEntry> mouseActions;
+		std::vector<ButtonEntry> controllerActions;
+		std::vector<ButtonEntry> keyAxes;
+		std::vector<ButtonEntry> controllerButtonAxes;
+		std::vector<StickEntry> controllerStickAxes;
+
+		// One bit per action.
+		std::vector<uint64_t> actionStates;
+		std::vector<uint64_t> prevActionStates;
+		std::vector<float> axisValues;
+
+		uint16_t AddName(std::vector<std::string>& names,
+		                 std::string_view name)
+		{
+			const auto it =
+			    std::find(names.begin(), names.end(), name);
+			if (it != names.end())
+			{
+				return static_cast<uint16_t>(it
+				                             - names.begin());
+			}
+			names.emplace_back(name);
+			return static_cast<uint16_t>(names.size() - 1);
+		}
+
+		void AddBinding(Binding binding)
+		{
+			bindings.push_back(binding);
+			dirty = true;
+		}
+
+		inline bool Test(const std::vector<uint64_t>& states,
+		                 uint16_t action)
+		{
+			return action < states.size() * 64
+			       && (states[action >> 6] >> (action & 63))
+			              & 1;
+		}
+
+		inline float ApplyDeadzone(float value, float deadzone)
+		{
+			const auto magnitude = std::abs(value);
+			if (magnitude <= deadzone || deadzone >= 1.0f)
+			{
+				return 0.0f;
+			}
+			return std::copysign((magnitude - deadzone)
+			                         / (1.0f - deadzone),
+			                     value);
+		}
+	} // namespace
+
+	InputActions::ActionId
+	InputActions::AddAction(std::string_view name)
+	{
+		dirty = true;
+		return ActionId{AddName(actionNames, name)};
+	}
+
+	InputActions::AxisId
+	InputActions::AddAxis(std::string_view name)
+	{
+		dirty = true;
+		return AxisId{AddName(axisNames, name)};
+	}
+
+	void InputActions::BindKey(ActionId action, KeyCode key)
+	{
+		AddBinding({Source::Key, false, (uint16_t)action,
+		            (int)key, AnyController, 1.0f, 0.0f});
+	}
+
+	void InputActions::BindMouseButton(ActionId action,
+	                                   MouseButton button)
+	{
+		AddBinding({Source::MouseButton, false,
+		            (uint16_t)action, (int)button, AnyController,
+		            1.0f, 0.0f});
+	}
+
+	void InputActions::BindControllerButton(
+	    ActionId action, ControllerButton button,
+	    int controllerId)
+	{
+		AddBinding({Source::ControllerButton, false,
+		            (uint16_t)action, (int)button, controllerId,
+		            1.0f, 0.0f});
+	}
+
+	void InputActions::BindKey(AxisId axis, KeyCode key,
+	                           float value)
+	{
+		AddBinding({Source::Key, true, (uint16_t)axis,
+		            (int)key, AnyController, value, 0.0f});
+	}
+
+	void InputActions::BindControllerButton(
+	    AxisId axis, ControllerButton button, float value,
+	    int controllerId)
+	{
+		AddBinding({Source::ControllerButton, true,
+		            (uint16_t)axis, (int)button, controllerId,
+		            value, 0.0f});
+	}
+
+	void InputActions::BindControllerAxis(
+	    AxisId axis, ControllerAxis controllerAxis,
+	    float deadzone, float scale, int controllerId)
+	{
+		AddBinding({Source::ControllerAxis, true,
+		            (uint16_t)axis, (int)controllerAxis,
+		            controllerId, scale, deadzone});
+	}
+
+	void InputActions::ClearBindings()
+	{
+		bindings.clear();
+		dirty = true;
+	}
+
+	void InputActions::Compile()
+	{
+		keyActions.clear();
+		mouseActions.clear();
+		controllerActions.clear();
+		keyAxes.clear();
+		controllerButtonAxes.clear();
+		controllerStickAxes.clear();
+
+		for (const auto& binding : bindings)
+		{
+			VEGAM_ASSERT(
+			    binding.controllerId >= AnyController
+			        && binding.controllerId
+			               < Controller::MaxControllers,
+			    "Invalid controller id in input binding");
+			const auto controller =
+			    static_cast<uint8_t>(binding.controllerId + 1);
+			const ButtonEntry entry{
+			    static_cast<uint16_t>(binding.code), controller,
+			    binding.target, binding.value};
+
+			switch (binding.source)
+			{
+			case Source::Key:
+				(binding.toAxis ? keyAxes : keyActions)
+				    .push_back(entry);
+				break;
+			case Source::MouseButton:
+				mouseActions.push_back(entry);
+				break;
+			case Source::ControllerButton:
+				(binding.toAxis ? controllerButtonAxes
+				                : controllerActions)
+				    .push_back(entry);
+				break;
+			case Source::ControllerAxis:
+				controllerStickAxes.push_back(
+				    {static_cast<uint8_t>(binding.code),
+				     controller, binding.target,
+				     binding.deadzone, binding.value});
+				break;
+			}
+		}
+
+		// Resized rather than reset, so held actions do not
+		// report another ActionDown().
+		const auto words = (actionNames.size() + 63) / 64;
+		actionStates.resize(words, 0);
+		prevActionStates.resize(words, 0);
+		axisValues.resize(axisNames.size(), 0.0f);
+		dirty = false;
+	}
+
+	void InputActions::Update()
+	{
+		if (dirty)
+		{
+			Compile();
+		}
+
+		// Controller state once per tick: index 0 is every
+		// controller combined, slot i is index i + 1.
+		std::array<ControllerButtonMask,
+		           Controller::MaxControllers + 1>
+		    buttons{};
+		for (int i = 0; i < Controller::MaxControllers; ++i)
+		{
+			buttons[i + 1] = Controller::GetButtons(i);
+			buttons[0] |= buttons[i + 1];
+		}
+
+		std::swap(actionStates, prevActionStates);
+		std::fill(actionStates.begin(), actionStates.end(),
+		          0);
+		const auto set = [](uint16_t action) {
+			actionStates[action >> 6] |= uint64_t{1}
+			                             << (action & 63);
+		};
+		for (const auto& entry : keyActions)
+		{
+			if (Keyboard::Key(
+			        static_cast<KeyCode>(entry.code)))
+			{
+				set(entry.target);
+			}
+		}
+		for (const auto& entry : mouseActions)
+		{
+			if (Mouse::Button(
+			        static_cast<MouseButton>(entry.code)))
+			{
+				set(entry.target);
+			}
+		}
+		for (const auto& entry : controllerActions)
+		{
+			if ((buttons[entry.controller] >> entry.code) & 1)
+			{
+				set(entry.target);
+			}
+		}
+
+		std::fill(axisValues.begin(), axisValues.end(), 0.0f);
+		for (const auto& entry : keyAxes)
+		{
+			if (Keyboard::Key(
+			        static_cast<KeyCode>(entry.code)))
+			{
+				axisValues[entry.target] += entry.value;
+			}
+		}
+		for (const auto& entry : controllerButtonAxes)
+		{
+			if ((buttons[entry.controller] >> entry.code) & 1)
+			{
+				axisValues[entry.target] += entry.value;
+			}
+		}
+		for (const auto& entry : controllerStickAxes)
+		{
+			// Any controller: the one pushed furthest.
+			float value = 0.0f;
+			const int first =
+			    entry.controller ? entry.controller - 1 : 0;
+			const int last = entry.controller
+			                     ? entry.controller
+			                     : Controller::MaxControllers;
+			for (int i = first; i < last; ++i)
+			{
+				const auto raw =
+				    Controller::GetAxesRaw(i)[entry.axis];
+				if (std::abs(raw) > std::abs(value))
+				{
+					value = raw;
+				}
+			}
+			axisValues[entry.target] +=
+			    ApplyDeadzone(value, entry.deadzone)
+			    * entry.scale;
+		}
+		for (auto& value : axisValues)
+		{
+			value = std::clamp(value, -1.0f, 1.0f);
+		}
+	}
+
+	bool InputActions::Action(ActionId action)
+	{
+		return Test(actionStates, (uint16_t)action);
+	}
+
+	bool InputActions::ActionDown(ActionId action)
+	{
+		return Test(actionStates, (uint16_t)action)
+		       && !Test(prevActionStates, (uint16_t)action);
+	}
+
+	bool InputActions::ActionUp(ActionId action)
+	{
+		return !Test(actionStates, (uint16_t)action)
+		       && Test(prevActionStates, (uint16_t)action);
+	}
+
+	float InputActions::Axis(AxisId axis)
+	{
+		const auto index = static_cast<uint16_t>(axis);
+		return index < axisValues.size() ? axisValues[index]
+		                                 : 0.0f;
+	}
+} // namespace AthiVegam::Input
@@ -0,0 +1,179 @@
+#include "AthiVegam/Input/InputQueue.h"
+
+#include "AthiVegam/Core/SpscQueue.h"
+#include "AthiVegam/Log.h"
+#include "SDL2/SDL.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace AthiVegam::Input
+{
+	namespace
+	{
+		constexpr const auto SDL_AXES_NORMALIER = 32767.f;
+
+		// SDL calls event watchers one at a time, from
+		// whichever thread pushes the event, so the watcher
+		// is the queue's only producer.
+		Core::SpscQueue<InputEvent, 4096> queue;
+		std::atomic<uint32_t> dropped{0};
+		std::vector<InputEvent> tickEvents;
+		bool installed = false;
+
+		uint64_t Now()
+		{
+			return std::chrono::duration_cast<
+			           std::chrono::nanoseconds>(
+			           std::chrono::steady_clock::now()
+			               .time_since_epoch())
+			    .count();
+		}
+	} // namespace
+
+	void InputQueue::Initialize()
+	{
+		if (!installed)
+		{
+			SDL_AddEventWatch(OnSDLEvent, nullptr);
+			installed = true;
+		}
+		tickEvents.reserve(256);
+	}
+
+	void InputQueue::Shutdown()
+	{
+		if (installed)
+		{
+			SDL_DelEventWatch(OnSDLEvent, nullptr);
+			installed = false;
+		}
+		while (queue.Front())
+		{
+			queue.Pop();
+		}
+		tickEvents.clear();
+	}
+
+	void InputQueue::BeginTick(uint64_t tickEnd)
+	{
+		tickEvents.clear();
+		while (const auto* event = queue.Front())
+		{
+			if (event->timestamp > tickEnd)
+			{
+				break;
+			}
+
+			auto& added = tickEvents.emplace_back(*event);
+			queue.Pop();
+			if (added.type == InputEventType::ControllerButton
+			    || added.type == InputEventType::ControllerAxis)
+			{
+				added.controllerId =
+				    Controller::GetControllerId(
+				        added.controllerId);
+			}
+		}
+
+		if (const auto count =
+		        dropped.exchange(0, std::memory_order_relaxed))
+		{
+			VEGAM_WARN_EVERY_N(60,
+			                   "Input queue full, dropped {} "
+			                   "events",
+			                   count);
+		}
+	}
+
+	std::span<const InputEvent> InputQueue::Events()
+	{
+		return tickEvents;
+	}
+
+	void InputQueue::SetEvents(
+	    std::span<const InputEvent> events)
+	{
+		tickEvents.assign(events.begin(), events.end());
+	}
+
+	int InputQueue::OnSDLEvent(void*, SDL_Event* e)
+	{
+		InputEvent event{};
+		switch (e->type)
+		{
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+			event.type = InputEventType::Key;
+			event.key =
+			    static_cast<KeyCode>(e->key.keysym.scancode);
+			event.pressed = e->key.state == SDL_PRESSED;
+			event.repeat = e->key.repeat != 0;
+			break;
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+			if (e->button.button > MouseButtonCount)
+			{
+				return 0;
+			}
+			event.type = InputEventType::MouseButton;
+			event.mouseButton =
+			    static_cast<MouseButton>(e->button.button);
+			event.pressed = e->button.state == SDL_PRESSED;
+			event.x = e->button.x;
+			event.y = e->button.y;
+			break;
+		case SDL_MOUSEMOTION:
+			event.type = InputEventType::MouseMotion;
+			event.x = e->motion.x;
+			event.y = e->motion.y;
+			event.dx = e->motion.xrel;
+			event.dy = e->motion.yrel;
+			break;
+		case SDL_MOUSEWHEEL:
+			event.type = InputEventType::MouseWheel;
+			event.dx = e->wheel.x;
+			event.dy = e->wheel.y;
+			break;
+		case SDL_CONTROLLERBUTTONDOWN:
+		case SDL_CONTROLLERBUTTONUP:
+			if (e->cbutton.button
+			    >= static_cast<int>(ControllerButton::COUNT))
+			{
+				return 0;
+			}
+			event.type = InputEventType::ControllerButton;
+			// Instance id until BeginTick() resolves it.
+			event.controllerId = e->cbutton.which;
+			event.controllerButton =
+			    static_cast<ControllerButton>(e->cbutton.button);
+			event.pressed = e->cbutton.state == SDL_PRESSED;
+			break;
+		case SDL_CONTROLLERAXISMOTION:
+			if (e->caxis.axis
+			    >= static_cast<int>(ControllerAxis::COUNT))
+			{
+				return 0;
+			}
+			event.type = InputEventType::ControllerAxis;
+			event.controllerId = e->caxis.which;
+			event.controllerAxis =
+			    static_cast<ControllerAxis>(e->caxis.axis);
+			event.value =
+			    std::clamp(e->caxis.value / SDL_AXES_NORMALIER,
+			               -1.f, 1.f);
+			break;
+		default:
+			return 0;
+		}
+
+		event.timestamp = Now();
+		if (!queue.Push(event))
+		{
+			dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+		return 0;
+	}
+} // namespace AthiVegam::Input
@@ -0,0 +1,307 @@
+#include "AthiVegam/Input/InputRecorder.h"
+
+#include "AthiVegam/Input/Controller.h"
+#include "AthiVegam/Input/InputQueue.h"
+#include "AthiVegam/Input/Keyboard.h"
+#include "AthiVegam/Input/Mouse.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <vector>
+
+namespace AthiVegam::Input
+{
+	bool InputRecorder::recording = false;
+	bool InputRecorder::replaying = false;
+
+	namespace
+	{
+		constexpr uint32_t Magic = 0x52495641; // "AVIR"
+		constexpr uint32_t Version = 2;
+
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			double tickRate;
+		};
+
+		// Each tick starts with these flags; only what
+		// changed since the previous tick follows, in this
+		// order, then the tick's event count and events.
+		enum TickFlags : uint8_t
+		{
+			KeyboardChanged = 1 << 0,
+			MouseChanged = 1 << 1,
+			ControllersChanged = 1 << 2
+		};
+
+		using Axes =
+		    std::array<float, (int)ControllerAxis::COUNT>;
+
+		struct MouseState
+		{
+			int32_t x;
+			int32_t y;
+			uint32_t buttons;
+			MouseMotion motion;
+
+			bool operator==(const MouseState&) const = default;
+		};
+
+		struct ControllerState
+		{
+			ControllerButtonMask buttons;
+			Axes axes;
+
+			bool operator==(const ControllerState&) const =
+			    default;
+		};
+
+		// Bit i set for each connected controller, then
+		// their states in slot order.
+		struct ControllersState
+		{
+			uint8_t connected = 0;
+			std::array<ControllerState,
+			           Controller::MaxControllers>
+			    states{};
+
+			bool operator==(const ControllersState&) const =
+			    default;
+		};
+
+		std::ofstream recordFile;
+		std::ifstream replayFile;
+
+		// The previous tick's state, on either side.
+		KeyStates keys;
+		MouseState mouse{};
+		ControllersState controllers;
+		std::vector<InputEvent> events;
+
+		template <typename T>
+		inline void Write(const T& value)
+		{
+			recordFile.write(
+			    reinterpret_cast<const char*>(&value),
+			    sizeof(T));
+		}
+
+		template <typename T>
+		inline bool Read(T& value)
+		{
+			return static_cast<bool>(replayFile.read(
+			    reinterpret_cast<char*>(&value), sizeof(T)));
+		}
+
+		ControllersState CaptureControllers()
+		{
+			ControllersState state;
+			for (int i = 0; i < Controller::MaxControllers;
+			     ++i)
+			{
+				if (!Controller::IsControllerAvailabe(i))
+				{
+					continue;
+				}
+				state.connected |= 1 << i;
+				state.states[i].buttons =
+				    Controller::GetButtons(i);
+				const auto axes = Controller::GetAxesRaw(i);
+				std::copy(axes.begin(), axes.end(),
+				          state.states[i].axes.begin());
+			}
+			return state;
+		}
+
+		void Reset()
+		{
+			keys = {};
+			mouse = {};
+			controllers = {};
+		}
+	} // namespace
+
+	bool
+	InputRecorder::StartRecording(const std::string& path,
+	                              double tickRate)
+	{
+		Stop();
+		recordFile.open(path,
+		                std::ios::binary | std::ios::trunc);
+		if (!recordFile)
+		{
+			VEGAM_ERROR("Error opening input recording {}",
+			            path);
+			return false;
+		}
+
+		Write(Header{Magic, Version, tickRate});
+		Reset();
+		recording = true;
+		VEGAM_INFO("Recording input to {}", path);
+		return true;
+	}
+
+	bool InputRecorder::StartReplay(const std::string& path,
+	                                double tickRate)
+	{
+		Stop();
+		replayFile.open(path, std::ios::binary);
+		Header header{};
+		if (!replayFile || !Read(header)
+		    || header.magic != Magic
+		    || header.version != Version)
+		{
+			VEGAM_ERROR("{} is not an input recording", path);
+			replayFile.close();
+			return false;
+		}
+		if (header.tickRate != tickRate)
+		{
+			VEGAM_WARN("{} was recorded at {} ticks per "
+			           "second, replaying at {}; it will not "
+			           "match",
+			           path, header.tickRate, tickRate);
+		}
+
+		Reset();
+		replaying = true;
+		VEGAM_INFO("Replaying input from {}", path);
+		return true;
+	}
+
+	void InputRecorder::Stop()
+	{
+		if (recording)
+		{
+			recordFile.close();
+			recording = false;
+		}
+		if (replaying)
+		{
+			replayFile.close();
+			replaying = false;
+		}
+	}
+
+	void InputRecorder::RecordTick()
+	{
+		if (!recording)
+		{
+			return;
+		}
+
+		const auto& currentKeys = Keyboard::GetKeyStates();
+		const MouseState currentMouse{
+		    Mouse::X(), Mouse::Y(), Mouse::GetButtonMask(),
+		    Mouse::GetMotion()};
+		const auto currentControllers = CaptureControllers();
+
+		uint8_t flags = 0;
+		flags |= currentKeys != keys ? KeyboardChanged : 0;
+		flags |= currentMouse != mouse ? MouseChanged : 0;
+		flags |= currentControllers != controllers
+		             ? ControllersChanged
+		             : 0;
+		Write(flags);
+
+		if (flags & KeyboardChanged)
+		{
+			Write(currentKeys);
+			keys = currentKeys;
+		}
+		if (flags & MouseChanged)
+		{
+			Write(currentMouse);
+			mouse = currentMouse;
+		}
+		if (flags & ControllersChanged)
+		{
+			Write(currentControllers.connected);
+			for (int i = 0; i < Controller::MaxControllers;
+			     ++i)
+			{
+				if (currentControllers.connected & (1 << i))
+				{
+					Write(currentControllers.states[i]);
+				}
+			}
+			controllers = currentControllers;
+		}
+
+		const auto tickEvents = InputQueue::Events();
+		Write(static_cast<uint32_t>(tickEvents.size()));
+		recordFile.write(
+		    reinterpret_cast<const char*>(tickEvents.data()),
+		    tickEvents.size_bytes());
+	}
+
+	bool InputRecorder::ReplayTick()
+	{
+		if (!replaying)
+		{
+			return false;
+		}
+
+		uint8_t flags = 0;
+		bool ok = Read(flags);
+		if (ok && (flags & KeyboardChanged))
+		{
+			ok = Read(keys);
+		}
+		if (ok && (flags & MouseChanged))
+		{
+			ok = Read(mouse);
+		}
+		if (ok && (flags & ControllersChanged))
+		{
+			ok = Read(controllers.connected);
+			for (int i = 0;
+			     ok && i < Controller::MaxControllers; ++i)
+			{
+				controllers.states[i] = {};
+				if (controllers.connected & (1 << i))
+				{
+					ok = Read(controllers.states[i]);
+				}
+			}
+		}
+		uint32_t eventCount = 0;
+		if (ok)
+		{
+			ok = Read(eventCount);
+		}
+		if (ok)
+		{
+			events.resize(eventCount);
+			ok = static_cast<bool>(replayFile.read(
+			    reinterpret_cast<char*>(events.data()),
+			    eventCount * sizeof(InputEvent)));
+		}
+		if (!ok)
+		{
+			VEGAM_INFO("Input replay finished");
+			Stop();
+			return false;
+		}
+
+		// Applied even when unchanged, so this tick's
+		// down/up edges clear as they would live.
+		Keyboard::Apply(keys);
+		Mouse::Apply(mouse.x, mouse.y, mouse.buttons,
+		             mouse.motion);
+		for (int i = 0; i < Controller::MaxControllers; ++i)
+		{
+			Controller::Apply(
+			    i, controllers.connected & (1 << i),
+			    controllers.states[i].buttons,
+			    controllers.states[i].axes);
+		}
+		InputQueue::SetEvents(events);
+		return true;
+	}
+} // namespace AthiVegam::Input
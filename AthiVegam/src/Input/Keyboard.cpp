@@ -2,47 +2,137 @@
 
 #include "SDL2/SDL.h"
 
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
 namespace AthiVegam::Input
 {
 	KeyStates Keyboard::keyStates;
-	KeyStates Keyboard::prevKeyStates;
+	KeyStates Keyboard::pressedKeys;
+	KeyStates Keyboard::releasedKeys;
+	std::array<KeyCode, KeyCount> Keyboard::changedKeys;
+	size_t Keyboard::changedKeyCount = 0;
+
+	namespace
+	{
+		constexpr int PackedKeyCount =
+		    KeyStates::WordCount * 64;
+
+		// Keys below AV_FIRST_KEY and at or above KeyCount
+		// are never reported.
+		constexpr uint64_t WordMask(int word)
+		{
+			uint64_t mask = ~uint64_t{0};
+			const int first = word * 64;
+			if (first < (int)KeyCode::AV_FIRST_KEY)
+			{
+				mask &= ~uint64_t{0}
+				        << ((int)KeyCode::AV_FIRST_KEY
+				            - first);
+			}
+			if (first + 64 > KeyCount)
+			{
+				mask &=
+				    ~uint64_t{0} >> (first + 64 - KeyCount);
+			}
+			return mask;
+		}
+
+		// Eight 0/1 bytes to eight bits, byte i to bit i.
+		inline uint64_t PackBytes(const Uint8* bytes)
+		{
+			uint64_t value;
+			std::memcpy(&value, bytes, sizeof(value));
+			return (value * 0x0102040810204080ull) >> 56;
+		}
+
+		KeyStates ReadKeyStates()
+		{
+			int numKeys = 0;
+			const Uint8* state =
+			    SDL_GetKeyboardState(&numKeys);
+
+			KeyStates states;
+			if (numKeys < PackedKeyCount)
+			{
+				const auto count = std::min(numKeys, KeyCount);
+				for (int i = 0; i < count; ++i)
+				{
+					states.words[i >> 6] |=
+					    uint64_t{state[i] != 0} << (i & 63);
+				}
+			}
+			else
+			{
+				// SDL stores 1 for pressed and 0 for released.
+				for (int word = 0; word < KeyStates::WordCount;
+				     ++word)
+				{
+					const auto* bytes = state + word * 64;
+					for (int byte = 0; byte < 8; ++byte)
+					{
+						states.words[word] |=
+						    PackBytes(bytes + byte * 8)
+						    << (byte * 8);
+					}
+				}
+			}
+
+			for (int word = 0; word < KeyStates::WordCount;
+			     ++word)
+			{
+				states.words[word] &= WordMask(word);
+			}
+			return states;
+		}
+	} // namespace
 
 	void Keyboard::Initialize()
 	{
-		std::fill(keyStates.begin(), keyStates.end(),
-		          false);
-		std::fill(prevKeyStates.begin(),
-		          prevKeyStates.end(), false);
+		keyStates = {};
+		pressedKeys = {};
+		releasedKeys = {};
+		changedKeyCount = 0;
 	}
 
-	void Keyboard::Update()
+	void Keyboard::Update() { Apply(ReadKeyStates()); }
+
+	void Keyboard::Apply(const KeyStates& current)
 	{
-		prevKeyStates = keyStates;
-		const Uint8* state = SDL_GetKeyboardState(nullptr);
-		for (int i = (int)KeyCode::AV_FIRST_KEY;
-		     i < KeyCount; ++i)
+		changedKeyCount = 0;
+		for (int word = 0; word < KeyStates::WordCount;
+		     ++word)
 		{
-			keyStates[i] = state[i];
+			const auto previous = keyStates.words[word];
+			auto changed = current.words[word] ^ previous;
+			pressedKeys.words[word] = changed & ~previous;
+			releasedKeys.words[word] = changed & previous;
+
+			while (changed)
+			{
+				const auto key =
+				    word * 64 + std::countr_zero(changed);
+				changedKeys[changedKeyCount++] =
+				    static_cast<KeyCode>(key);
+				changed &= changed - 1;
+			}
 		}
+		keyStates = current;
 	}
 
 	bool Keyboard::Key(KeyCode key)
 	{
-		auto keyIndex = static_cast<int>(key);
-		return keyStates[keyIndex];
+		return keyStates.Test(static_cast<int>(key));
 	}
 
 	bool Keyboard::KeyDown(KeyCode key)
 	{
-		auto keyIndex = static_cast<int>(key);
-		return keyStates[keyIndex]
-		       && !prevKeyStates[keyIndex];
+		return pressedKeys.Test(static_cast<int>(key));
 	}
 
 	bool Keyboard::KeyUp(KeyCode key)
 	{
-		auto keyIndex = static_cast<int>(key);
-		return !keyStates[keyIndex]
-		       && prevKeyStates[keyIndex];
+		return releasedKeys.Test(static_cast<int>(key));
 	}
 } // namespace AthiVegam::Input
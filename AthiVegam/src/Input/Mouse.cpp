@@ -14,6 +14,8 @@ namespace AthiVegam::Input
 
 	MouseButtonStates Mouse::buttonStates;
 	MouseButtonStates Mouse::prevButtonStates;
+	MouseMotion Mouse::motion;
+	MouseMotion Mouse::pendingMotion;
 
 	void Mouse::Initialize()
 	{
@@ -21,18 +23,119 @@ namespace AthiVegam::Input
 		          false);
 		std::fill(prevButtonStates.begin(),
 		          prevButtonStates.end(), false);
+		motion = {};
+		pendingMotion = {};
 	}
 
 	void Mouse::Update()
 	{
+		int newX = 0;
+		int newY = 0;
+		Uint32 state = SDL_GetMouseState(&newX, &newY);
+		uint32_t buttonMask = 0;
+		for (int i = 0; i < buttonStates.size(); ++i)
+		{
+			if (state & SDL_BUTTON(i + 1))
+			{
+				buttonMask |= 1u << i;
+			}
+		}
+		Apply(newX, newY, buttonMask, pendingMotion);
+		pendingMotion = {};
+	}
+
+	void Mouse::Apply(int newX, int newY,
+	                  uint32_t buttonMask,
+	                  const MouseMotion& newMotion)
+	{
+		motion = newMotion;
 		xPrev = x;
 		yPrev = y;
+		x = newX;
+		y = newY;
 		prevButtonStates = buttonStates;
-		Uint32 state = SDL_GetMouseState(&x, &y);
 		for (int i = 0; i < buttonStates.size(); ++i)
 		{
-			buttonStates[i] = state & SDL_BUTTON(i + 1);
+			buttonStates[i] = (buttonMask >> i) & 1;
+		}
+	}
+
+	uint32_t Mouse::GetButtonMask()
+	{
+		uint32_t buttonMask = 0;
+		for (int i = 0; i < buttonStates.size(); ++i)
+		{
+			if (buttonStates[i])
+			{
+				buttonMask |= 1u << i;
+			}
+		}
+		return buttonMask;
+	}
+
+	void Mouse::OnMouseMotion(
+	    std::span<const Core::MouseMoved> events)
+	{
+		for (const auto& e : events)
+		{
+			pendingMotion.dx += e.dx;
+			pendingMotion.dy += e.dy;
+		}
+	}
+
+	void Mouse::OnMouseWheel(
+	    std::span<const Core::MouseWheel> events)
+	{
+		for (const auto& e : events)
+		{
+			pendingMotion.wheelX += e.x;
+			pendingMotion.wheelY += e.y;
+		}
+	}
+
+	MouseMotion Mouse::PeekLateMotion()
+	{
+		// Events pumped now stay queued for the next
+		// frame's PumpEvents().
+		SDL_PumpEvents();
+		std::array<SDL_Event, 128> events;
+		const auto count = SDL_PeepEvents(
+		    events.data(), static_cast<int>(events.size()),
+		    SDL_PEEKEVENT, SDL_MOUSEMOTION, SDL_MOUSEWHEEL);
+
+		auto late = pendingMotion;
+		for (int i = 0; i < count; ++i)
+		{
+			const auto& e = events[i];
+			if (e.type == SDL_MOUSEMOTION)
+			{
+				late.dx += static_cast<float>(e.motion.xrel);
+				late.dy += static_cast<float>(e.motion.yrel);
+			}
+			else if (e.type == SDL_MOUSEWHEEL)
+			{
+				late.wheelX += e.wheel.preciseX;
+				late.wheelY += e.wheel.preciseY;
+			}
 		}
+		return late;
+	}
+
+	bool Mouse::SetRelativeMode(bool enabled)
+	{
+		if (SDL_SetRelativeMouseMode(enabled ? SDL_TRUE
+		                                     : SDL_FALSE))
+		{
+			VEGAM_WARN("Relative mouse mode unavailable: {}",
+			           SDL_GetError());
+			return false;
+		}
+		return true;
+	}
+
+	bool Mouse::IsRelativeMode()
+	{
+		return SDL_GetRelativeMouseMode() == SDL_TRUE;
 	}
 
 	bool Mouse::Button(MouseButton button)
@@ -0,0 +1,1015 @@
+#include "AthiVegam/Managers/AssetManager.h"
+
+#include "AthiVegam/Core/CpuTopology.h"
+#include "AthiVegam/Core/File.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Managers/ResourceManager.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <iterator>
+#include <string>
+
+namespace AthiVegam::Managers
+{
+	using Assets::ArchiveFormat::EntryType;
+
+	namespace
+	{
+		// Packs and archives are opened where the
+		// FileManager finds them on disk.
+		std::string NativePath(const std::string& path)
+		{
+			auto native =
+			    Engine::Instance().GetFileManager().GetNativePath(
+			        path);
+			return native.empty() ? path : native;
+		}
+	} // namespace
+
+	void AssetManager::Initialize(ResourceManager& resources,
+	                              JobManager& jobs,
+	                              uint32_t ioThreadCount)
+	{
+		m_resources = &resources;
+		m_jobs = &jobs;
+		m_stopRequested = false;
+		ioThreadCount = std::max(ioThreadCount, 1u);
+		for (uint32_t i = 0; i < ioThreadCount; ++i)
+		{
+			m_ioThreads.emplace_back(&AssetManager::IoMain,
+			                         this, i);
+		}
+	}
+
+	void AssetManager::Shutdown()
+	{
+		m_sourceWatcher.Stop();
+		{
+			std::lock_guard lock(m_mutex);
+			m_stopRequested = true;
+		}
+		m_wake.notify_all();
+		m_cookWake.notify_all();
+		for (auto& thread : m_ioThreads)
+		{
+			thread.join();
+		}
+		m_ioThreads.clear();
+		if (m_cookThread.joinable())
+		{
+			m_cookThread.join();
+		}
+		m_sourcePaths.clear();
+		m_dependents.clear();
+		m_sourcesChanged = false;
+		if (m_jobs)
+		{
+			m_jobs->Wait(m_decompressionJobs);
+		}
+
+		m_entries.clear();
+		m_queue = {};
+		m_queued = 0;
+		m_decompressions.clear();
+		m_sources.clear();
+		m_resources = nullptr;
+		m_jobs = nullptr;
+	}
+
+	bool AssetManager::MountMeshPack(const std::string& path)
+	{
+		auto pack = std::make_unique<Assets::MeshPack>();
+		if (!pack->Open(NativePath(path)))
+		{
+			return false;
+		}
+
+		std::lock_guard lock(m_mutex);
+		m_sources.push_back({std::move(pack), nullptr});
+		return true;
+	}
+
+	bool AssetManager::MountArchive(const std::string& path)
+	{
+		auto archive = std::make_unique<Assets::Archive>();
+		if (!archive->Open(NativePath(path)))
+		{
+			return false;
+		}
+
+		std::lock_guard lock(m_mutex);
+		m_sources.push_back({nullptr, std::move(archive)});
+		return true;
+	}
+
+	void AssetManager::Update()
+	{
+		std::vector<std::shared_ptr<Entry>> decompressions;
+		const auto evictions =
+		    m_resources->TakeTextureEvictions();
+		{
+			std::lock_guard lock(m_mutex);
+			// Levels the GPU memory budget dropped are read
+			// again once asked for.
+			for (const auto& eviction : evictions)
+			{
+				for (auto& [key, entry] : m_entries)
+				{
+					if (entry->texture == eviction.texture
+					    && entry->state == State::Uploading)
+					{
+						entry->loadedLevel = std::max(
+						    entry->loadedLevel, eviction.level);
+						entry->wantedLevel = std::max(
+						    entry->wantedLevel, eviction.level);
+						break;
+					}
+				}
+			}
+			size_t count = 0;
+			uint32_t chunks = 0;
+			for (; count < m_decompressions.size(); ++count)
+			{
+				chunks += m_decompressions[count]->chunkCount;
+				if (count > 0 && chunks > MaxChunksPerUpdate)
+				{
+					break;
+				}
+			}
+			const auto end = m_decompressions.begin() + count;
+			decompressions.assign(
+			    std::make_move_iterator(
+			        m_decompressions.begin()),
+			    std::make_move_iterator(end));
+			m_decompressions.erase(m_decompressions.begin(),
+			                       end);
+		}
+
+		for (auto& entry : decompressions)
+		{
+			if (entry->cancelled)
+			{
+				continue;
+			}
+			const auto chunkCount = entry->chunkCount;
+			entry->data.resize(Assets::Archive::GetChunksSize(
+			    *entry->archiveEntry, entry->firstChunk,
+			    chunkCount));
+			entry->chunksLeft = chunkCount;
+			if (chunkCount == 0)
+			{
+				FinishDecompression(entry);
+				continue;
+			}
+			for (uint32_t i = 0; i < chunkCount; ++i)
+			{
+				m_jobs->Schedule(
+				    [this, entry, i] {
+					    DecompressChunk(entry,
+					                    entry->firstChunk + i);
+				    },
+				    &m_decompressionJobs);
+			}
+		}
+	}
+
+	void AssetManager::EnableHotReload(
+	    const HotReloadSettings& settings)
+	{
+		if (m_sourceWatcher.IsRunning())
+		{
+			return;
+		}
+		std::error_code error;
+		if (!std::filesystem::is_directory(settings.sourceRoot,
+		                                   error))
+		{
+			VEGAM_WARN("No asset sources in {}; hot reload "
+			           "disabled",
+			           settings.sourceRoot);
+			return;
+		}
+
+		// Named as tools/cook.py names them: cooked kinds
+		// without their extension.
+		std::unique_lock lock(m_mutex);
+		m_hotReload = settings;
+		for (const auto& file :
+		     std::filesystem::recursive_directory_iterator(
+		         settings.sourceRoot, error))
+		{
+			if (!file.is_regular_file(error))
+			{
+				continue;
+			}
+			auto path = file.path();
+			auto extension = path.extension().string();
+			std::transform(extension.begin(), extension.end(),
+			               extension.begin(), [](char c) {
+				               return static_cast<char>(
+				                   std::tolower(c));
+			               });
+			auto name = path.lexically_relative(
+			    settings.sourceRoot);
+			if (extension == ".obj" || extension == ".png"
+			    || extension == ".ktx2")
+			{
+				name.replace_extension();
+			}
+			m_sourcePaths[static_cast<uint64_t>(
+			    Assets::MakeAssetId(name.generic_string()))] =
+			    path.string();
+		}
+		for (const auto& [key, entry] : m_entries)
+		{
+			WatchSource(*entry);
+		}
+		const auto sourceCount = m_sourcePaths.size();
+		lock.unlock();
+
+		m_sourceWatcher.Start(
+		    std::chrono::milliseconds(settings.intervalMs),
+		    [this] {
+			    {
+				    std::lock_guard changed(m_mutex);
+				    m_sourcesChanged = true;
+			    }
+			    m_cookWake.notify_one();
+		    });
+		m_cookThread = std::thread(&AssetManager::CookMain, this);
+		VEGAM_INFO("Asset hot reload enabled for {} sources",
+		           sourceCount);
+	}
+
+	Graphics::MeshHandle
+	AssetManager::RequestMesh(Assets::AssetId id,
+	                          float priority)
+	{
+		std::lock_guard lock(m_mutex);
+		const auto key = static_cast<uint64_t>(id);
+		if (auto it = m_entries.find(key);
+		    it != m_entries.end())
+		{
+			auto& entry = it->second;
+			if (entry->type != EntryType::Mesh)
+			{
+				VEGAM_ERROR("Asset {:016x} is not a mesh", key);
+				return {};
+			}
+			++entry->references;
+			if (entry->state == State::Queued)
+			{
+				Enqueue(entry, priority);
+			}
+			return entry->mesh;
+		}
+
+		auto entry = std::make_shared<Entry>();
+		entry->id = id;
+		if (!Locate(*entry, EntryType::Mesh))
+		{
+			VEGAM_ERROR("Mesh {:016x} is in no mounted pack",
+			            key);
+			return {};
+		}
+
+		entry->mesh = m_resources->CreateMeshPlaceholder();
+		entry->references = 1;
+		m_entries.emplace(key, entry);
+		WatchSource(*entry);
+		++m_queued;
+		Enqueue(entry, priority);
+		return entry->mesh;
+	}
+
+	Graphics::TextureHandle
+	AssetManager::RequestTexture(Assets::AssetId id,
+	                             float priority,
+	                             uint32_t finestLevel)
+	{
+		std::lock_guard lock(m_mutex);
+		const auto key = static_cast<uint64_t>(id);
+		if (auto it = m_entries.find(key);
+		    it != m_entries.end())
+		{
+			auto& entry = it->second;
+			if (entry->type != EntryType::Texture)
+			{
+				VEGAM_ERROR("Asset {:016x} is not a texture",
+				            key);
+				return {};
+			}
+			++entry->references;
+			if (entry->state == State::Queued)
+			{
+				Enqueue(entry, priority);
+			}
+			entry->priority = priority;
+			WantLevel(entry, finestLevel);
+			return entry->texture;
+		}
+
+		auto entry = std::make_shared<Entry>();
+		entry->id = id;
+		if (!Locate(*entry, EntryType::Texture))
+		{
+			VEGAM_ERROR("Texture {:016x} is in no mounted "
+			            "archive",
+			            key);
+			return {};
+		}
+
+		entry->texture = m_resources->CreateTexturePlaceholder();
+		entry->references = 1;
+		entry->wantedLevel = finestLevel;
+		// Until the header is read.
+		entry->loadedLevel = Graphics::Texture::MaxLevels;
+		m_entries.emplace(key, entry);
+		WatchSource(*entry);
+		++m_queued;
+		Enqueue(entry, priority);
+		return entry->texture;
+	}
+
+	Core::Task<Graphics::MeshHandle>
+	AssetManager::LoadMesh(Assets::AssetId id, float priority)
+	{
+		const auto mesh = RequestMesh(id, priority);
+		if (!mesh.IsValid())
+		{
+			co_return mesh;
+		}
+		co_await Core::Coroutines::WaitUntil{[this, id, mesh] {
+			return m_resources->IsMeshReady(mesh)
+			       || GetState(id) == State::Failed;
+		}};
+		co_return m_resources->IsMeshReady(mesh)
+		    ? mesh
+		    : Graphics::MeshHandle{};
+	}
+
+	Core::Task<Graphics::TextureHandle>
+	AssetManager::LoadTexture(Assets::AssetId id,
+	                          float priority,
+	                          uint32_t finestLevel)
+	{
+		const auto texture =
+		    RequestTexture(id, priority, finestLevel);
+		if (!texture.IsValid())
+		{
+			co_return texture;
+		}
+		co_await Core::Coroutines::WaitUntil{
+		    [this, id, texture] {
+			    return m_resources->IsTextureReady(texture)
+			           || GetState(id) == State::Failed;
+		    }};
+		co_return m_resources->IsTextureReady(texture)
+		    ? texture
+		    : Graphics::TextureHandle{};
+	}
+
+	void AssetManager::SetTextureLevel(Assets::AssetId id,
+	                                   uint32_t finestLevel)
+	{
+		std::lock_guard lock(m_mutex);
+		const auto it =
+		    m_entries.find(static_cast<uint64_t>(id));
+		if (it != m_entries.end()
+		    && it->second->type == EntryType::Texture)
+		{
+			WantLevel(it->second, finestLevel);
+		}
+	}
+
+	void AssetManager::WantLevel(
+	    const std::shared_ptr<Entry>& entry, uint32_t level)
+	{
+		entry->wantedLevel = std::min(entry->wantedLevel, level);
+		// Entries still on their way check again once
+		// they are done.
+		if (entry->state == State::Uploading
+		    && entry->wantedLevel < entry->loadedLevel)
+		{
+			entry->state = State::Queued;
+			++m_queued;
+			Enqueue(entry, entry->priority);
+		}
+	}
+
+	void AssetManager::SetPriority(Assets::AssetId id,
+	                               float priority)
+	{
+		std::lock_guard lock(m_mutex);
+		const auto it =
+		    m_entries.find(static_cast<uint64_t>(id));
+		if (it != m_entries.end()
+		    && it->second->state == State::Queued)
+		{
+			Enqueue(it->second, priority);
+		}
+	}
+
+	void AssetManager::Release(Assets::AssetId id)
+	{
+		std::shared_ptr<Entry> entry;
+		{
+			std::lock_guard lock(m_mutex);
+			const auto it =
+			    m_entries.find(static_cast<uint64_t>(id));
+			if (it == m_entries.end())
+			{
+				VEGAM_WARN("Releasing asset {:016x}, which was "
+				           "not requested",
+				           static_cast<uint64_t>(id));
+				return;
+			}
+			if (--it->second->references > 0)
+			{
+				return;
+			}
+
+			entry = std::move(it->second);
+			m_entries.erase(it);
+			UnwatchSource(*entry);
+			// An I/O thread reading it stops at the next
+			// check; queue items for it are skipped.
+			entry->cancelled = true;
+			if (entry->state == State::Queued)
+			{
+				--m_queued;
+			}
+		}
+		// An upload queued in the meantime finds the mesh
+		// or texture gone and is dropped.
+		if (entry->type == EntryType::Texture)
+		{
+			m_resources->DestroyTexture(entry->texture);
+		}
+		else
+		{
+			m_resources->DestroyMesh(entry->mesh);
+		}
+	}
+
+	AssetManager::State
+	AssetManager::GetState(Assets::AssetId id) const
+	{
+		std::lock_guard lock(m_mutex);
+		const auto it =
+		    m_entries.find(static_cast<uint64_t>(id));
+		return it != m_entries.end()
+		           ? it->second->state.load()
+		           : State::Failed;
+	}
+
+	size_t AssetManager::GetPendingCount() const
+	{
+		std::lock_guard lock(m_mutex);
+		return m_queued;
+	}
+
+	bool AssetManager::Locate(Entry& entry,
+	                          EntryType type) const
+	{
+		for (auto it = m_sources.rbegin();
+		     it != m_sources.rend(); ++it)
+		{
+			if (type == EntryType::Mesh && it->pack
+			    && it->pack->Contains(entry.id))
+			{
+				entry.type = type;
+				entry.pack = it->pack.get();
+				return true;
+			}
+			const auto* archived =
+			    it->archive ? it->archive->Find(entry.id)
+			                : nullptr;
+			if (archived && archived->type == type)
+			{
+				entry.type = type;
+				entry.archive = it->archive.get();
+				entry.archiveEntry = archived;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void AssetManager::Enqueue(
+	    const std::shared_ptr<Entry>& entry, float priority)
+	{
+		VEGAM_PROFILE_EVENT("Asset load", "{:016x}",
+		                    static_cast<uint64_t>(entry->id));
+		entry->priority = priority;
+		m_queue.push({priority, ++entry->generation, entry});
+		m_wake.notify_one();
+	}
+
+	void AssetManager::IoMain(uint32_t thread)
+	{
+		Core::Profiler::SetThreadName("Asset I/O "
+		                              + std::to_string(thread));
+		Core::SetThreadClass(Core::ThreadClass::Background);
+		while (true)
+		{
+			std::shared_ptr<Entry> entry;
+			{
+				std::unique_lock lock(m_mutex);
+				m_wake.wait(lock, [this] {
+					return m_stopRequested || !m_queue.empty();
+				});
+				if (m_stopRequested)
+				{
+					return;
+				}
+
+				auto item = m_queue.top();
+				m_queue.pop();
+				if (item.entry->cancelled
+				    || item.generation
+				           != item.entry->generation)
+				{
+					continue;
+				}
+				entry = std::move(item.entry);
+				entry->state = State::Reading;
+				--m_queued;
+			}
+			if (entry->type == EntryType::Texture)
+			{
+				ReadTexture(entry);
+			}
+			else if (entry->archive)
+			{
+				ReadArchived(entry);
+			}
+			else
+			{
+				ReadMapped(*entry);
+			}
+		}
+	}
+
+	void AssetManager::ReadMapped(Entry& entry)
+	{
+		VEGAM_PROFILE_SCOPE("AssetManager::ReadMapped");
+		Assets::MeshPack::MeshView view;
+		if (!entry.pack->Find(entry.id, view))
+		{
+			entry.state = State::Failed;
+			return;
+		}
+
+		// Packs are mapped, so copying the mesh out in
+		// QueueUpload() is where it is actually read; one
+		// readahead request up front saves faulting it in
+		// page by page.
+		entry.pack->Prefetch(entry.id);
+		QueueUpload(entry, view);
+	}
+
+	void AssetManager::ReadArchived(
+	    const std::shared_ptr<Entry>& entry)
+	{
+		VEGAM_PROFILE_SCOPE("AssetManager::ReadArchived");
+		entry->firstChunk = 0;
+		entry->chunkCount = entry->archiveEntry->chunkCount;
+		if (!entry->archive->Read(*entry->archiveEntry,
+		                          entry->stored))
+		{
+			entry->state = State::Failed;
+			return;
+		}
+
+		{
+			std::lock_guard lock(m_mutex);
+			if (entry->cancelled)
+			{
+				return;
+			}
+			entry->state = State::Decompressing;
+			m_decompressions.push_back(entry);
+		}
+		// Only the main thread may schedule jobs; make sure
+		// it runs a frame.
+		Engine::Instance().RequestRedraw();
+	}
+
+	void AssetManager::ReadTexture(
+	    const std::shared_ptr<Entry>& entry)
+	{
+		VEGAM_PROFILE_SCOPE("AssetManager::ReadTexture");
+		using Assets::ArchiveFormat::ChunkSize;
+		const auto& archived = *entry->archiveEntry;
+		if (!entry->hasInfo)
+		{
+			// The header and level index are in the first
+			// chunk.
+			std::vector<uint8_t> header(
+			    Assets::Archive::GetChunksSize(archived, 0, 1));
+			if (archived.chunkCount == 0
+			    || !entry->archive->ReadChunks(archived, 0, 1,
+			                                   entry->stored)
+			    || !entry->archive->DecompressChunk(
+			        archived, 0, entry->stored.data(),
+			        header.data())
+			    || !Assets::Ktx2::Parse(
+			        header.data(), header.size(), archived.size,
+			        entry->info,
+			        fmt::format("{:016x}", archived.id)))
+			{
+				entry->state = State::Failed;
+				return;
+			}
+			entry->hasInfo = true;
+		}
+
+		const auto levelCount = entry->info.desc.levelCount;
+		uint32_t first;
+		uint32_t last;
+		{
+			std::lock_guard lock(m_mutex);
+			if (entry->cancelled)
+			{
+				return;
+			}
+			entry->loadedLevel =
+			    std::min(entry->loadedLevel, levelCount);
+			entry->readingLevel =
+			    std::min(entry->wantedLevel, levelCount - 1);
+			first = entry->readingLevel;
+			last = entry->loadedLevel;
+		}
+		if (first >= last)
+		{
+			entry->state = State::Uploading;
+			return;
+		}
+
+		// The levels between are one run of the file, so
+		// one run of chunks.
+		uint64_t begin = archived.size;
+		uint64_t end = 0;
+		for (auto level = first; level < last; ++level)
+		{
+			const auto& range = entry->info.levels[level];
+			begin = std::min(begin, range.offset);
+			end = std::max(end, range.offset + range.size);
+		}
+		entry->firstChunk =
+		    static_cast<uint32_t>(begin / ChunkSize);
+		entry->chunkCount =
+		    static_cast<uint32_t>((end - 1) / ChunkSize)
+		    + 1 - entry->firstChunk;
+		if (!entry->archive->ReadChunks(
+		        archived, entry->firstChunk, entry->chunkCount,
+		        entry->stored))
+		{
+			entry->state = State::Failed;
+			return;
+		}
+
+		{
+			std::lock_guard lock(m_mutex);
+			if (entry->cancelled)
+			{
+				return;
+			}
+			entry->state = State::Decompressing;
+			m_decompressions.push_back(entry);
+		}
+		Engine::Instance().RequestRedraw();
+	}
+
+	void AssetManager::DecompressChunk(
+	    const std::shared_ptr<Entry>& entry, uint32_t chunk)
+	{
+		VEGAM_PROFILE_SCOPE("AssetManager::DecompressChunk");
+		if (!entry->cancelled
+		    && !entry->archive->DecompressChunk(
+		        *entry->archiveEntry, chunk,
+		        entry->stored.data(), entry->data.data(),
+		        entry->firstChunk))
+		{
+			entry->corrupt = true;
+		}
+		if (entry->chunksLeft.fetch_sub(
+		        1, std::memory_order_acq_rel)
+		    == 1)
+		{
+			FinishDecompression(entry);
+		}
+	}
+
+	void AssetManager::FinishDecompression(
+	    const std::shared_ptr<Entry>& pointer)
+	{
+		if (pointer->type == EntryType::Texture)
+		{
+			FinishTexture(pointer);
+			return;
+		}
+
+		auto& entry = *pointer;
+		entry.stored = {};
+		Assets::MeshPack::MeshView view;
+		if (entry.cancelled)
+		{
+			return;
+		}
+		if (entry.corrupt
+		    || !Assets::MeshPack::ParseMesh(
+		        entry.id, entry.data.data(), entry.data.size(),
+		        view))
+		{
+			entry.state = State::Failed;
+			return;
+		}
+		QueueUpload(entry, view);
+		entry.data = {};
+	}
+
+	void AssetManager::FinishTexture(
+	    const std::shared_ptr<Entry>& entry)
+	{
+		entry->stored = {};
+		if (entry->cancelled)
+		{
+			return;
+		}
+		if (entry->corrupt)
+		{
+			entry->state = State::Failed;
+			return;
+		}
+
+		const auto base = uint64_t{entry->firstChunk}
+		                  * Assets::ArchiveFormat::ChunkSize;
+		for (auto level = entry->readingLevel;
+		     level < entry->loadedLevel; ++level)
+		{
+			const auto& range = entry->info.levels[level];
+			const auto* bytes =
+			    entry->data.data() + (range.offset - base);
+			ResourceManager::TextureUpload upload;
+			upload.texture = entry->texture;
+			upload.desc = entry->info.desc;
+			upload.level = level;
+			upload.data.assign(bytes, bytes + range.size);
+			m_resources->QueueTextureUpload(std::move(upload));
+		}
+		entry->data = {};
+
+		{
+			std::lock_guard lock(m_mutex);
+			entry->loadedLevel = entry->readingLevel;
+			if (entry->cancelled)
+			{
+				return;
+			}
+			// Finer levels asked for while these were read.
+			if (entry->wantedLevel < entry->loadedLevel)
+			{
+				++m_queued;
+				entry->state = State::Queued;
+				Enqueue(entry, entry->priority);
+			}
+			else
+			{
+				entry->state = State::Uploading;
+			}
+		}
+		Engine::Instance().RequestRedraw();
+	}
+
+	void AssetManager::QueueUpload(
+	    Entry& entry, const Assets::MeshPack::MeshView& view)
+	{
+		Graphics::MeshUploadQueue::Request request;
+		request.mesh = entry.mesh;
+		request.layout = view.layout;
+		request.vertexCount = view.vertexCount;
+		const auto* vertices =
+		    static_cast<const uint8_t*>(view.vertices);
+		request.vertices.assign(
+		    vertices, vertices
+		                  + static_cast<size_t>(view.vertexCount)
+		                        * view.layout.GetStride());
+		if (entry.cancelled)
+		{
+			return;
+		}
+		request.indices.assign(view.indices,
+		                       view.indices
+		                           + view.elementCount);
+		if (entry.cancelled)
+		{
+			return;
+		}
+
+		m_resources->QueueMeshUpload(std::move(request));
+		entry.state = State::Uploading;
+		// Render-on-demand would otherwise idle until input.
+		Engine::Instance().RequestRedraw();
+	}
+
+	void AssetManager::WatchSource(const Entry& entry)
+	{
+		const auto it =
+		    m_sourcePaths.find(static_cast<uint64_t>(entry.id));
+		if (it == m_sourcePaths.end())
+		{
+			return;
+		}
+		auto& dependents = m_dependents[it->second];
+		if (dependents.empty())
+		{
+			m_sourceWatcher.Watch(it->second);
+		}
+		dependents.push_back(static_cast<uint64_t>(entry.id));
+	}
+
+	void AssetManager::UnwatchSource(const Entry& entry)
+	{
+		const auto source =
+		    m_sourcePaths.find(static_cast<uint64_t>(entry.id));
+		if (source == m_sourcePaths.end())
+		{
+			return;
+		}
+		const auto it = m_dependents.find(source->second);
+		if (it == m_dependents.end())
+		{
+			return;
+		}
+		std::erase(it->second, static_cast<uint64_t>(entry.id));
+		if (it->second.empty())
+		{
+			m_sourceWatcher.Unwatch(it->first);
+			m_dependents.erase(it);
+		}
+	}
+
+	void AssetManager::CookMain()
+	{
+		Core::Profiler::SetThreadName("Asset cook");
+		Core::SetThreadClass(Core::ThreadClass::Background);
+		while (true)
+		{
+			{
+				std::unique_lock lock(m_mutex);
+				m_cookWake.wait(lock, [this] {
+					return m_stopRequested || m_sourcesChanged;
+				});
+				if (m_stopRequested)
+				{
+					return;
+				}
+				m_sourcesChanged = false;
+			}
+
+			for (const auto& source :
+			     m_sourceWatcher.TakeChanges())
+			{
+				std::vector<uint64_t> ids;
+				{
+					std::lock_guard lock(m_mutex);
+					const auto it = m_dependents.find(source);
+					if (it != m_dependents.end())
+					{
+						ids = it->second;
+					}
+				}
+				for (const auto id : ids)
+				{
+					Reload(id, source);
+				}
+			}
+		}
+	}
+
+	void AssetManager::Reload(uint64_t id,
+	                          const std::string& source)
+	{
+		VEGAM_PROFILE_SCOPE("AssetManager::Reload");
+		std::error_code error;
+		const auto output =
+		    (std::filesystem::temp_directory_path(error)
+		     / fmt::format("AthiVegam-{:016x}", id))
+		        .string();
+		std::string command;
+		{
+			std::lock_guard lock(m_mutex);
+			command = fmt::format("{} --one \"{}\" \"{}\"",
+			                      m_hotReload.cookCommand,
+			                      source, output);
+		}
+		VEGAM_INFO("Re-cooking {}", source);
+		std::vector<uint8_t> data;
+		{
+			Core::File file;
+			if (std::system(command.c_str()) != 0
+			    || !file.Open(output))
+			{
+				VEGAM_ERROR("Re-cooking {} failed", source);
+				return;
+			}
+			data.resize(file.GetSize());
+			if (!file.ReadAt(0, data.data(), data.size()))
+			{
+				VEGAM_ERROR("Error reading {}", output);
+				return;
+			}
+		}
+		std::filesystem::remove(output, error);
+
+		std::shared_ptr<Entry> entry;
+		{
+			std::lock_guard lock(m_mutex);
+			const auto it = m_entries.find(id);
+			if (it == m_entries.end())
+			{
+				return;
+			}
+			entry = it->second;
+			// A load still in flight would land after the
+			// swap.
+			if (entry->state != State::Uploading)
+			{
+				VEGAM_WARN("{} is still loading; save it again "
+				           "to reload it",
+				           source);
+				return;
+			}
+		}
+
+		if (entry->type == EntryType::Mesh)
+		{
+			Assets::MeshPack::MeshView view;
+			if (!Assets::MeshPack::ParseMesh(entry->id,
+			                                 data.data(),
+			                                 data.size(), view))
+			{
+				VEGAM_ERROR("{} did not cook into a mesh",
+				            source);
+				return;
+			}
+			Graphics::MeshUploadQueue::Request request;
+			request.mesh = m_resources->CreateMeshPlaceholder();
+			request.layout = view.layout;
+			request.vertexCount = view.vertexCount;
+			const auto* vertices =
+			    static_cast<const uint8_t*>(view.vertices);
+			request.vertices.assign(
+			    vertices,
+			    vertices
+			        + static_cast<size_t>(view.vertexCount)
+			              * view.layout.GetStride());
+			request.indices.assign(view.indices,
+			                       view.indices
+			                           + view.elementCount);
+			const auto replacement = request.mesh;
+			m_resources->QueueMeshUpload(std::move(request));
+			m_resources->ReplaceMesh(entry->mesh, replacement);
+		}
+		else
+		{
+			Assets::Ktx2::Info info;
+			if (!Assets::Ktx2::Parse(data.data(), data.size(),
+			                         data.size(), info, source))
+			{
+				return;
+			}
+			const auto replacement =
+			    m_resources->CreateTexturePlaceholder();
+			for (uint32_t level = 0;
+			     level < info.desc.levelCount; ++level)
+			{
+				const auto& range = info.levels[level];
+				const auto* bytes = data.data() + range.offset;
+				ResourceManager::TextureUpload upload;
+				upload.texture = replacement;
+				upload.desc = info.desc;
+				upload.level = level;
+				upload.data.assign(bytes, bytes + range.size);
+				m_resources->QueueTextureUpload(
+				    std::move(upload));
+			}
+			m_resources->ReplaceTexture(entry->texture,
+			                            replacement);
+
+			// Every level is resident, so none is read from
+			// the stale archive again.
+			std::lock_guard lock(m_mutex);
+			entry->info = info;
+			entry->wantedLevel = 0;
+			entry->loadedLevel = 0;
+		}
+		Engine::Instance().RequestRedraw();
+	}
+} // namespace AthiVegam::Managers
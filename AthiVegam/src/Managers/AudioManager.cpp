@@ -0,0 +1,1045 @@
+#include "AthiVegam/Managers/AudioManager.h"
+
+#include "AthiVegam/Core/CpuFeatures.h"
+#include "AthiVegam/Core/CpuTopology.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Math/Simd.h"
+#include "SDL2/SDL.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(AV_CPU_X86)
+#include <immintrin.h>
+#endif
+
+namespace AthiVegam::Managers
+{
+	namespace
+	{
+		namespace Simd = Math::Simd;
+
+		// Frames a decode job writes per read.
+		constexpr uint32_t DecodeFrames = 4096;
+		constexpr float QuarterPi = 0.785398163f;
+		// Read past the end of a sound.
+		constexpr float Silence[2] = {};
+		// Below it an emitter is not worth a voice.
+		constexpr float MinAudibility = 1e-3f;
+		// Ranking bonus of emitters with a voice, so ones
+		// of about equal audibility do not trade voices
+		// back and forth.
+		constexpr float RealBonus = 1.25f;
+		// Smaller changes are not sent to a voice.
+		constexpr float SpatialEpsilon = 0.01f;
+
+		inline void GetTargetGains(const VoiceParams& params,
+		                           float (&gains)[2])
+		{
+			const auto angle =
+			    (std::clamp(params.pan, -1.0f, 1.0f) + 1.0f)
+			    * QuarterPi;
+			gains[0] = params.gain * std::cos(angle);
+			gains[1] = params.gain * std::sin(angle);
+		}
+
+		float GetAttenuation(const EmitterDesc& desc,
+		                     float distance)
+		{
+			if (distance >= desc.maxDistance)
+			{
+				return 0.0f;
+			}
+			const auto beyond =
+			    std::max(distance - desc.minDistance, 0.0f);
+			const auto fade =
+			    (desc.maxDistance - distance)
+			    / (0.1f * desc.maxDistance);
+			return desc.minDistance
+			       / (desc.minDistance + desc.rolloff * beyond)
+			       * std::min(fade, 1.0f);
+		}
+
+		using MasterFn = void (*)(float*, uint32_t, float);
+
+		// Scales count samples by gain and clips them.
+		void MasterBaseline(float* out, uint32_t count,
+		                    float masterGain)
+		{
+			const auto gain = Simd::Splat(masterGain);
+			const auto low = Simd::Splat(-1.0f);
+			const auto high = Simd::Splat(1.0f);
+			uint32_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				Simd::Store(
+				    out + i,
+				    Simd::Min(
+				        Simd::Max(
+				            Simd::Mul(Simd::Load(out + i), gain),
+				            low),
+				        high));
+			}
+			for (; i < count; ++i)
+			{
+				out[i] =
+				    std::clamp(out[i] * masterGain, -1.0f, 1.0f);
+			}
+		}
+
+#if defined(AV_CPU_X86)
+		AV_TARGET_AVX2 void MasterAvx2(float* out,
+		                               uint32_t count,
+		                               float masterGain)
+		{
+			const auto gain = _mm256_set1_ps(masterGain);
+			const auto low = _mm256_set1_ps(-1.0f);
+			const auto high = _mm256_set1_ps(1.0f);
+			uint32_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				_mm256_storeu_ps(
+				    out + i,
+				    _mm256_min_ps(
+				        _mm256_max_ps(
+				            _mm256_mul_ps(
+				                _mm256_loadu_ps(out + i), gain),
+				            low),
+				        high));
+			}
+			MasterBaseline(out + i, count - i, masterGain);
+		}
+#endif
+
+		MasterFn SelectMaster()
+		{
+			Core::Kernels<MasterFn> kernels;
+			kernels.baseline = MasterBaseline;
+#if defined(AV_CPU_X86)
+			kernels.avx2 = MasterAvx2;
+#endif
+			return Core::SelectKernel(kernels);
+		}
+
+		const MasterFn Master = SelectMaster();
+	} // namespace
+
+	bool AudioManager::Initialize(JobManager& jobs,
+	                              uint32_t sampleRate,
+	                              uint32_t bufferFrames)
+	{
+		m_jobs = &jobs;
+
+		SDL_AudioSpec desired{};
+		desired.freq = static_cast<int>(sampleRate);
+		desired.format = AUDIO_F32SYS;
+		desired.channels = 2;
+		desired.samples = static_cast<Uint16>(bufferFrames);
+		desired.callback = AudioCallback;
+		desired.userdata = this;
+		SDL_AudioSpec obtained{};
+		m_device = SDL_OpenAudioDevice(
+		    nullptr, 0, &desired, &obtained,
+		    SDL_AUDIO_ALLOW_FREQUENCY_CHANGE
+		        | SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+		if (m_device == 0)
+		{
+			VEGAM_ERROR("Error opening the audio device: {}",
+			            SDL_GetError());
+			return false;
+		}
+
+		m_sampleRate = static_cast<uint32_t>(obtained.freq);
+		VEGAM_INFO("Audio: {} Hz, {} frame buffer",
+		           m_sampleRate, obtained.samples);
+		SDL_PauseAudioDevice(m_device, 0);
+		return true;
+	}
+
+	void AudioManager::Shutdown()
+	{
+		if (m_device != 0)
+		{
+			// Returns once the callback has stopped.
+			SDL_CloseAudioDevice(m_device);
+			m_device = 0;
+		}
+		if (m_jobs)
+		{
+			m_jobs->Wait(m_decodeJobs);
+			m_jobs = nullptr;
+		}
+
+		while (m_commands.Front())
+		{
+			m_commands.Pop();
+		}
+		while (m_finished.Front())
+		{
+			m_finished.Pop();
+		}
+		m_voices = {};
+		m_streams.clear();
+		m_sounds.clear();
+		m_retired.clear();
+		m_playing.clear();
+		m_emitters.clear();
+		m_emitterIndices.clear();
+		m_emitterVoices.clear();
+		m_realEmitters = 0;
+	}
+
+	void AudioManager::Update()
+	{
+		VEGAM_PROFILE_SCOPE("AudioManager::Update");
+		while (const auto* voice = m_finished.Front())
+		{
+			m_playing.erase(*voice);
+			if (const auto it = m_emitterVoices.find(*voice);
+			    it != m_emitterVoices.end())
+			{
+				// Played out, or dropped for want of a voice;
+				// ranked again below.
+				if (auto* emitter = FindEmitter(it->second))
+				{
+					emitter->voice = InvalidVoice;
+				}
+				m_emitterVoices.erase(it);
+			}
+			for (auto& stream : m_streams)
+			{
+				if (stream->voice == *voice)
+				{
+					stream->released = true;
+				}
+			}
+			m_finished.Pop();
+		}
+		UpdateEmitters();
+
+		std::erase_if(m_streams, [](const auto& stream) {
+			return stream->released
+			       && !stream->decoding.load(
+			           std::memory_order_acquire);
+		});
+		for (auto& stream : m_streams)
+		{
+			const auto buffered =
+			    stream->written.load(std::memory_order_relaxed)
+			    - stream->read.load(std::memory_order_acquire);
+			if (!stream->released
+			    && !stream->decoding.load(
+			        std::memory_order_acquire)
+			    && !stream->ended.load(std::memory_order_relaxed)
+			    && buffered <= StreamFrames / 2)
+			{
+				ScheduleDecode(*stream);
+			}
+		}
+
+		const auto done =
+		    m_commandsDone.load(std::memory_order_acquire);
+		for (auto& retired : m_retired)
+		{
+			if (!retired.sent)
+			{
+				Command command;
+				command.type = CommandType::StopSound;
+				command.sound = retired.sound.get();
+				retired.sent = Send(command);
+				retired.command = m_commandsSent;
+			}
+		}
+		std::erase_if(m_retired, [done](const Retired& retired) {
+			return retired.sent && retired.command <= done;
+		});
+	}
+
+	AudioManager::SoundHandle
+	AudioManager::LoadSound(const std::string& path)
+	{
+		VEGAM_PROFILE_SCOPE("AudioManager::LoadSound");
+		Assets::WavReader reader;
+		if (!reader.Open(path))
+		{
+			return InvalidSound;
+		}
+
+		auto sound = std::make_unique<Sound>();
+		sound->sampleRate = reader.GetSampleRate();
+		sound->frames.resize(reader.GetFrameCount() * 2);
+		sound->frameCount = reader.Read(
+		    sound->frames.data(),
+		    static_cast<uint32_t>(reader.GetFrameCount()));
+		sound->frames.resize(sound->frameCount * 2);
+
+		auto slot = std::find(m_sounds.begin(), m_sounds.end(),
+		                      nullptr);
+		if (slot == m_sounds.end())
+		{
+			slot = m_sounds.insert(slot, nullptr);
+		}
+		*slot = std::move(sound);
+		return static_cast<SoundHandle>(slot - m_sounds.begin())
+		       + 1;
+	}
+
+	void AudioManager::UnloadSound(SoundHandle sound)
+	{
+		if (sound == InvalidSound || sound > m_sounds.size()
+		    || !m_sounds[sound - 1])
+		{
+			return;
+		}
+
+		for (auto i = static_cast<uint32_t>(m_emitters.size());
+		     i-- > 0;)
+		{
+			if (m_emitters[i].sound == m_sounds[sound - 1].get())
+			{
+				RemoveEmitter(i);
+			}
+		}
+
+		auto& retired = m_retired.emplace_back();
+		retired.sound = std::move(m_sounds[sound - 1]);
+		if (m_device == 0)
+		{
+			m_retired.pop_back();
+			return;
+		}
+		// Sent here or retried by Update().
+		Command command;
+		command.type = CommandType::StopSound;
+		command.sound = retired.sound.get();
+		retired.sent = Send(command);
+		retired.command = m_commandsSent;
+	}
+
+	AudioManager::VoiceId
+	AudioManager::Play(SoundHandle sound,
+	                   const VoiceParams& params)
+	{
+		const auto* data = GetSound(sound);
+		if (m_device == 0 || !data)
+		{
+			return InvalidVoice;
+		}
+
+		Command command;
+		command.type = CommandType::Play;
+		command.voice = NextVoice();
+		command.sound = data;
+		command.sampleRate = data->sampleRate;
+		command.params = params;
+		if (!Send(command))
+		{
+			return InvalidVoice;
+		}
+		m_playing.insert(command.voice);
+		return command.voice;
+	}
+
+	AudioManager::VoiceId
+	AudioManager::PlayStream(const std::string& path,
+	                         const VoiceParams& params)
+	{
+		if (m_device == 0)
+		{
+			return InvalidVoice;
+		}
+
+		auto stream = std::make_unique<Stream>();
+		if (!stream->reader.Open(path))
+		{
+			return InvalidVoice;
+		}
+		stream->ring =
+		    std::make_unique<float[]>(StreamFrames * 2);
+		stream->loop = params.loop;
+
+		Command command;
+		command.type = CommandType::Play;
+		command.voice = NextVoice();
+		command.stream = stream.get();
+		command.sampleRate = stream->reader.GetSampleRate();
+		command.params = params;
+		// Played from the decoded ring, which loops itself.
+		command.params.loop = false;
+		if (!Send(command))
+		{
+			return InvalidVoice;
+		}
+
+		// Silent until the first decode lands.
+		stream->voice = command.voice;
+		ScheduleDecode(*stream);
+		m_streams.push_back(std::move(stream));
+		m_playing.insert(command.voice);
+		return command.voice;
+	}
+
+	void AudioManager::Stop(VoiceId voice)
+	{
+		Command command;
+		command.type = CommandType::Stop;
+		command.voice = voice;
+		Send(command);
+	}
+
+	void AudioManager::SetGain(VoiceId voice, float gain)
+	{
+		Command command;
+		command.type = CommandType::SetGain;
+		command.voice = voice;
+		command.value = gain;
+		Send(command);
+	}
+
+	void AudioManager::SetPan(VoiceId voice, float pan)
+	{
+		Command command;
+		command.type = CommandType::SetPan;
+		command.voice = voice;
+		command.value = pan;
+		Send(command);
+	}
+
+	void AudioManager::SetPitch(VoiceId voice, float pitch)
+	{
+		Command command;
+		command.type = CommandType::SetPitch;
+		command.voice = voice;
+		command.value = pitch;
+		Send(command);
+	}
+
+	void AudioManager::SetMasterGain(float gain)
+	{
+		Command command;
+		command.type = CommandType::SetMasterGain;
+		command.value = gain;
+		Send(command);
+	}
+
+	bool AudioManager::IsPlaying(VoiceId voice) const
+	{
+		return m_playing.contains(voice);
+	}
+
+	void AudioManager::SetListener(const Math::Vec3& position,
+	                               const Math::Vec3& forward,
+	                               const Math::Vec3& up)
+	{
+		m_listener = position;
+		m_listenerRight =
+		    Math::Normalize(Math::Cross(forward, up));
+	}
+
+	AudioManager::EmitterId
+	AudioManager::CreateEmitter(SoundHandle sound,
+	                            const EmitterDesc& desc)
+	{
+		const auto* data = GetSound(sound);
+		if (!data || data->frameCount == 0)
+		{
+			return InvalidEmitter;
+		}
+
+		auto& emitter = m_emitters.emplace_back();
+		emitter.id = ++m_nextEmitter != InvalidEmitter
+		                 ? m_nextEmitter
+		                 : ++m_nextEmitter;
+		emitter.sound = data;
+		emitter.desc = desc;
+		emitter.start = std::chrono::duration<double>(
+		                    std::chrono::steady_clock::now()
+		                    - m_epoch)
+		                    .count();
+		m_emitterIndices[emitter.id] =
+		    static_cast<uint32_t>(m_emitters.size() - 1);
+		return emitter.id;
+	}
+
+	void AudioManager::DestroyEmitter(EmitterId emitter)
+	{
+		if (const auto it = m_emitterIndices.find(emitter);
+		    it != m_emitterIndices.end())
+		{
+			RemoveEmitter(it->second);
+		}
+	}
+
+	void AudioManager::SetEmitterPosition(
+	    EmitterId emitter, const Math::Vec3& position)
+	{
+		if (auto* found = FindEmitter(emitter))
+		{
+			found->desc.position = position;
+		}
+	}
+
+	void AudioManager::SetEmitterGain(EmitterId emitter,
+	                                  float gain)
+	{
+		if (auto* found = FindEmitter(emitter))
+		{
+			found->desc.gain = gain;
+		}
+	}
+
+	bool AudioManager::IsEmitterReal(EmitterId emitter) const
+	{
+		const auto it = m_emitterIndices.find(emitter);
+		return it != m_emitterIndices.end()
+		       && m_emitters[it->second].voice != InvalidVoice;
+	}
+
+	void AudioManager::SetMaxRealEmitters(uint32_t count)
+	{
+		m_maxRealEmitters = std::min(count, MaxVoices);
+	}
+
+	void AudioManager::UpdateEmitters()
+	{
+		VEGAM_PROFILE_SCOPE("AudioManager::UpdateEmitters");
+		const auto now = std::chrono::duration<double>(
+		                     std::chrono::steady_clock::now()
+		                     - m_epoch)
+		                     .count();
+
+		// Emitters that played out go; the rest are ranked
+		// by how loud they reach the listener.
+		m_ranking.clear();
+		for (auto i = static_cast<uint32_t>(m_emitters.size());
+		     i-- > 0;)
+		{
+			auto& emitter = m_emitters[i];
+			const auto& sound = *emitter.sound;
+			const auto frames = (now - emitter.start)
+			                    * sound.sampleRate
+			                    * emitter.desc.pitch;
+			if (!emitter.desc.loop
+			    && frames >= static_cast<double>(sound.frameCount))
+			{
+				RemoveEmitter(i);
+				continue;
+			}
+
+			const auto offset =
+			    emitter.desc.position - m_listener;
+			emitter.audibility =
+			    emitter.desc.gain * emitter.desc.priority
+			    * GetAttenuation(emitter.desc,
+			                     Math::Length(offset));
+			if (emitter.voice != InvalidVoice)
+			{
+				emitter.audibility *= RealBonus;
+			}
+		}
+		for (uint32_t i = 0; i < m_emitters.size(); ++i)
+		{
+			if (m_emitters[i].audibility >= MinAudibility)
+			{
+				m_ranking.push_back(i);
+			}
+		}
+		if (m_ranking.size() > m_maxRealEmitters)
+		{
+			std::nth_element(
+			    m_ranking.begin(),
+			    m_ranking.begin() + m_maxRealEmitters,
+			    m_ranking.end(), [this](uint32_t a, uint32_t b) {
+				    return m_emitters[a].audibility
+				           > m_emitters[b].audibility;
+			    });
+			// Outranked: virtual from now on.
+			for (auto it = m_ranking.begin() + m_maxRealEmitters;
+			     it != m_ranking.end(); ++it)
+			{
+				m_emitters[*it].audibility = 0.0f;
+			}
+			m_ranking.resize(m_maxRealEmitters);
+		}
+
+		m_realEmitters = 0;
+		for (auto& emitter : m_emitters)
+		{
+			const bool real = emitter.audibility >= MinAudibility;
+			if (!real && emitter.voice != InvalidVoice)
+			{
+				Stop(emitter.voice);
+				m_emitterVoices.erase(emitter.voice);
+				emitter.voice = InvalidVoice;
+			}
+			if (!real || m_device == 0)
+			{
+				continue;
+			}
+			++m_realEmitters;
+
+			const auto offset =
+			    emitter.desc.position - m_listener;
+			const auto distance = Math::Length(offset);
+			const auto gain =
+			    emitter.desc.gain
+			    * GetAttenuation(emitter.desc, distance);
+			const auto pan =
+			    distance > 1e-4f
+			        ? Math::Dot(offset, m_listenerRight) / distance
+			        : 0.0f;
+			if (emitter.voice == InvalidVoice)
+			{
+				// Where the virtual playback has got to.
+				const auto& sound = *emitter.sound;
+				auto position = (now - emitter.start)
+				                * sound.sampleRate
+				                * emitter.desc.pitch;
+				if (emitter.desc.loop)
+				{
+					position = std::fmod(
+					    position,
+					    static_cast<double>(sound.frameCount));
+				}
+
+				Command command;
+				command.type = CommandType::Play;
+				command.voice = NextVoice();
+				command.sound = &sound;
+				command.sampleRate = sound.sampleRate;
+				command.position = position;
+				command.params = {gain, pan, emitter.desc.pitch,
+				                  emitter.desc.loop};
+				if (Send(command))
+				{
+					emitter.voice = command.voice;
+					emitter.gain = gain;
+					emitter.pan = pan;
+					m_playing.insert(command.voice);
+					m_emitterVoices[command.voice] = emitter.id;
+				}
+			}
+			else if (std::abs(gain - emitter.gain)
+			             > SpatialEpsilon
+			         || std::abs(pan - emitter.pan)
+			                > SpatialEpsilon)
+			{
+				Command command;
+				command.type = CommandType::SetGainPan;
+				command.voice = emitter.voice;
+				command.params.gain = gain;
+				command.params.pan = pan;
+				if (Send(command))
+				{
+					emitter.gain = gain;
+					emitter.pan = pan;
+				}
+			}
+		}
+	}
+
+	void AudioManager::RemoveEmitter(uint32_t index)
+	{
+		auto& emitter = m_emitters[index];
+		if (emitter.voice != InvalidVoice)
+		{
+			Stop(emitter.voice);
+			m_emitterVoices.erase(emitter.voice);
+		}
+		m_emitterIndices.erase(emitter.id);
+		if (index + 1 != m_emitters.size())
+		{
+			emitter = std::move(m_emitters.back());
+			m_emitterIndices[emitter.id] = index;
+		}
+		m_emitters.pop_back();
+	}
+
+	AudioManager::Emitter*
+	AudioManager::FindEmitter(EmitterId id)
+	{
+		const auto it = m_emitterIndices.find(id);
+		return it != m_emitterIndices.end()
+		           ? &m_emitters[it->second]
+		           : nullptr;
+	}
+
+	const AudioManager::Sound*
+	AudioManager::GetSound(SoundHandle sound) const
+	{
+		return sound != InvalidSound && sound <= m_sounds.size()
+		           ? m_sounds[sound - 1].get()
+		           : nullptr;
+	}
+
+	AudioManager::VoiceId AudioManager::NextVoice()
+	{
+		// 0 is InvalidVoice.
+		return ++m_nextVoice != InvalidVoice ? m_nextVoice
+		                                     : ++m_nextVoice;
+	}
+
+	bool AudioManager::Send(const Command& command)
+	{
+		if (m_device == 0)
+		{
+			return false;
+		}
+		if (!m_commands.Push(command))
+		{
+			VEGAM_WARN("Audio command queue full; command "
+			           "dropped");
+			return false;
+		}
+		++m_commandsSent;
+		return true;
+	}
+
+	void AudioManager::ScheduleDecode(Stream& stream)
+	{
+		stream.decoding.store(true, std::memory_order_relaxed);
+		m_jobs->Schedule([stream = &stream] { Decode(*stream); },
+		                 &m_decodeJobs);
+	}
+
+	void AudioManager::Decode(Stream& stream)
+	{
+		VEGAM_PROFILE_SCOPE("AudioManager::Decode");
+		auto written =
+		    stream.written.load(std::memory_order_relaxed);
+		bool rewound = false;
+		while (true)
+		{
+			const auto space =
+			    StreamFrames
+			    - (written
+			       - stream.read.load(std::memory_order_acquire));
+			const auto offset = written & (StreamFrames - 1);
+			const auto count = static_cast<uint32_t>(
+			    std::min<uint64_t>({space, DecodeFrames,
+			                        StreamFrames - offset}));
+			if (count == 0)
+			{
+				break;
+			}
+
+			const auto frames = stream.reader.Read(
+			    stream.ring.get() + offset * 2, count);
+			written += frames;
+			stream.written.store(written,
+			                     std::memory_order_release);
+			if (frames == count)
+			{
+				rewound = false;
+				continue;
+			}
+			// At the end, or a read error. A loop that
+			// yields nothing after rewinding never will.
+			if (!stream.loop || (rewound && frames == 0))
+			{
+				stream.ended.store(true,
+				                   std::memory_order_release);
+				break;
+			}
+			stream.reader.Rewind();
+			rewound = frames == 0;
+		}
+		stream.decoding.store(false, std::memory_order_release);
+	}
+
+	void AudioManager::AudioCallback(void* userdata,
+	                                 uint8_t* stream, int length)
+	{
+		auto& self = *static_cast<AudioManager*>(userdata);
+		// SDL's audio thread is not ours to start.
+		static thread_local bool placed = false;
+		if (!placed)
+		{
+			Core::SetThreadClass(Core::ThreadClass::Latency);
+			placed = true;
+		}
+		const auto frames = static_cast<uint32_t>(length)
+		                    / (2 * sizeof(float));
+		const auto start = std::chrono::steady_clock::now();
+		self.Mix(reinterpret_cast<float*>(stream), frames);
+		const std::chrono::duration<float> elapsed =
+		    std::chrono::steady_clock::now() - start;
+		if (frames > 0)
+		{
+			const auto duration =
+			    static_cast<float>(frames)
+			    / static_cast<float>(self.m_sampleRate);
+			self.m_mixLoad.store(elapsed.count() / duration,
+			                     std::memory_order_relaxed);
+		}
+	}
+
+	void AudioManager::Mix(float* out, uint32_t frames)
+	{
+		std::memset(out, 0, frames * 2 * sizeof(float));
+		while (const auto* command = m_commands.Front())
+		{
+			Execute(*command);
+			m_commands.Pop();
+			m_commandsDone.fetch_add(1, std::memory_order_release);
+		}
+
+		uint32_t active = 0;
+		for (auto& voice : m_voices)
+		{
+			if (voice.id == InvalidVoice)
+			{
+				continue;
+			}
+			if (!voice.finished)
+			{
+				MixVoice(voice, out, frames);
+			}
+			// Held until the main thread can be told.
+			if (voice.finished && m_finished.Push(voice.id))
+			{
+				voice = {};
+				continue;
+			}
+			++active;
+		}
+		m_activeVoices.store(active, std::memory_order_relaxed);
+
+		Master(out, frames * 2, m_masterGain);
+	}
+
+	void AudioManager::Execute(const Command& command)
+	{
+		if (command.type == CommandType::SetMasterGain)
+		{
+			m_masterGain = command.value;
+			return;
+		}
+		if (command.type == CommandType::StopSound)
+		{
+			for (auto& voice : m_voices)
+			{
+				if (voice.sound == command.sound)
+				{
+					voice.sound = nullptr;
+					voice.finished = true;
+				}
+			}
+			return;
+		}
+		if (command.type == CommandType::Play)
+		{
+			auto* voice = FindVoice(InvalidVoice);
+			if (!voice)
+			{
+				m_droppedVoices.fetch_add(
+				    1, std::memory_order_relaxed);
+				m_finished.Push(command.voice);
+				return;
+			}
+			*voice = {};
+			voice->id = command.voice;
+			voice->sound = command.sound;
+			voice->stream = command.stream;
+			voice->sourceRate = command.sampleRate;
+			voice->params = command.params;
+			voice->position = command.position;
+			voice->step = static_cast<double>(voice->sourceRate)
+			              * voice->params.pitch / m_sampleRate;
+			return;
+		}
+
+		auto* voice = FindVoice(command.voice);
+		if (!voice || command.voice == InvalidVoice)
+		{
+			return;
+		}
+		switch (command.type)
+		{
+		case CommandType::Stop:
+			voice->finished = true;
+			break;
+		case CommandType::SetGain:
+			voice->params.gain = command.value;
+			break;
+		case CommandType::SetPan:
+			voice->params.pan = command.value;
+			break;
+		case CommandType::SetGainPan:
+			voice->params.gain = command.params.gain;
+			voice->params.pan = command.params.pan;
+			break;
+		case CommandType::SetPitch:
+			voice->params.pitch = command.value;
+			voice->step = static_cast<double>(voice->sourceRate)
+			              * command.value / m_sampleRate;
+			break;
+		default:
+			break;
+		}
+	}
+
+	AudioManager::Voice* AudioManager::FindVoice(VoiceId id)
+	{
+		for (auto& voice : m_voices)
+		{
+			if (voice.id == id)
+			{
+				return &voice;
+			}
+		}
+		return nullptr;
+	}
+
+	void AudioManager::MixVoice(Voice& voice, float* out,
+	                            uint32_t frames)
+	{
+		// Frames are addressed from the voice's origin: a
+		// sound's first frame, or the stream's read
+		// position.
+		const float* data = nullptr;
+		uint64_t available = 0;
+		uint64_t base = 0;
+		bool ended = true;
+		if (voice.stream)
+		{
+			auto& stream = *voice.stream;
+			// ended before written, so a final count is seen
+			// as final.
+			ended = stream.ended.load(std::memory_order_acquire);
+			base = stream.read.load(std::memory_order_relaxed);
+			available =
+			    stream.written.load(std::memory_order_acquire)
+			    - base;
+			data = stream.ring.get();
+		}
+		else if (voice.sound)
+		{
+			data = voice.sound->frames.data();
+			available = voice.sound->frameCount;
+		}
+		if (!data || (!voice.stream && available == 0))
+		{
+			voice.finished = true;
+			return;
+		}
+
+		const bool loop = voice.params.loop && !voice.stream;
+		const auto at = [&](uint64_t frame) -> const float* {
+			if (frame >= available)
+			{
+				if (!loop)
+				{
+					return Silence;
+				}
+				frame %= available;
+			}
+			if (voice.stream)
+			{
+				frame = (base + frame) & (StreamFrames - 1);
+			}
+			return data + frame * 2;
+		};
+
+		float target[2];
+		GetTargetGains(voice.params, target);
+		const auto pairs = static_cast<float>((frames + 1) / 2);
+		auto gain = Simd::Set(voice.gains[0], voice.gains[1],
+		                      voice.gains[0], voice.gains[1]);
+		const auto delta = Simd::Set(
+		    (target[0] - voice.gains[0]) / pairs,
+		    (target[1] - voice.gains[1]) / pairs,
+		    (target[0] - voice.gains[0]) / pairs,
+		    (target[1] - voice.gains[1]) / pairs);
+
+		const auto step = voice.step;
+		auto position = voice.position;
+		for (uint32_t i = 0; i < frames; i += 2)
+		{
+			const auto next = position + step;
+			const auto first = static_cast<uint64_t>(position);
+			const auto second = static_cast<uint64_t>(next);
+			if (voice.stream && !ended && second + 1 >= available)
+			{
+				// Wait for the decoder rather than read past
+				// what it wrote; silent until it catches up.
+				// Not yet started is not an underrun.
+				if (base + available > 0)
+				{
+					m_underruns.fetch_add(
+					    1, std::memory_order_relaxed);
+				}
+				break;
+			}
+			if (!loop && first >= available)
+			{
+				voice.finished = true;
+				break;
+			}
+
+			const auto* a0 = at(first);
+			const auto* a1 = at(second);
+			Simd::Float4 samples;
+			const auto t0 = static_cast<float>(position - first);
+			const auto t1 = static_cast<float>(next - second);
+			if (t0 == 0.0f && t1 == 0.0f)
+			{
+				// Whole frames, e.g. at the device rate.
+				samples = a1 == a0 + 2
+				              ? Simd::Load(a0)
+				              : Simd::Set(a0[0], a0[1], a1[0],
+				                          a1[1]);
+			}
+			else
+			{
+				// Linear interpolation of both frames at once.
+				const auto* b0 = at(first + 1);
+				const auto* b1 = at(second + 1);
+				const auto a =
+				    Simd::Set(a0[0], a0[1], a1[0], a1[1]);
+				const auto b =
+				    Simd::Set(b0[0], b0[1], b1[0], b1[1]);
+				samples = Simd::MulAdd(Simd::Sub(b, a),
+				                       Simd::Set(t0, t0, t1, t1),
+				                       a);
+			}
+
+			auto* mix = out + i * 2;
+			if (i + 1 < frames)
+			{
+				Simd::Store(mix, Simd::MulAdd(samples, gain,
+				                              Simd::Load(mix)));
+			}
+			else
+			{
+				// An odd frame count's last frame.
+				float last[4];
+				Simd::Store(last, Simd::Mul(samples, gain));
+				mix[0] += last[0];
+				mix[1] += last[1];
+			}
+			gain = Simd::Add(gain, delta);
+			position = next + step;
+		}
+		voice.gains[0] = target[0];
+		voice.gains[1] = target[1];
+
+		if (voice.stream)
+		{
+			const auto consumed = std::min(
+			    static_cast<uint64_t>(position), available);
+			voice.stream->read.store(base + consumed,
+			                         std::memory_order_release);
+			position -= static_cast<double>(consumed);
+		}
+		else if (loop)
+		{
+			position = std::fmod(
+			    position, static_cast<double>(available));
+		}
+		voice.position = position;
+	}
+} // namespace AthiVegam::Managers
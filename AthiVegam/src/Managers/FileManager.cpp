@@ -0,0 +1,441 @@
+#include "AthiVegam/Managers/FileManager.h"
+
+#include "AthiVegam/Core/CpuTopology.h"
+#include "AthiVegam/Core/File.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+namespace AthiVegam::Managers
+{
+	namespace
+	{
+		using Assets::ArchiveFormat::ChunkSize;
+
+		inline bool IsAbsolute(std::string_view path)
+		{
+			return (!path.empty()
+			        && (path[0] == '/' || path[0] == '\\'))
+			       || (path.size() > 1 && path[1] == ':');
+		}
+	} // namespace
+
+	void FileManager::Initialize(uint32_t ioThreadCount)
+	{
+		m_stopRequested = false;
+		ioThreadCount = std::max(ioThreadCount, 1u);
+		for (uint32_t i = 0; i < ioThreadCount; ++i)
+		{
+			m_ioThreads.emplace_back(&FileManager::IoMain, this,
+			                         i);
+		}
+	}
+
+	void FileManager::Shutdown()
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_stopRequested = true;
+		}
+		m_wake.notify_all();
+		for (auto& thread : m_ioThreads)
+		{
+			thread.join();
+		}
+		m_ioThreads.clear();
+		m_requests.clear();
+		m_finished.clear();
+		m_pending = 0;
+
+		std::unique_lock lock(m_mountsMutex);
+		m_mounts.clear();
+	}
+
+	bool FileManager::MountDirectory(
+	    std::string_view point, const std::string& directory)
+	{
+		std::error_code error;
+		if (!std::filesystem::is_directory(directory, error))
+		{
+			VEGAM_ERROR("Cannot mount {}: not a directory",
+			            directory);
+			return false;
+		}
+
+		Mount mount;
+		mount.point = NormalizePath(point);
+		if (!mount.point.empty())
+		{
+			mount.point += '/';
+		}
+		mount.directory = directory;
+		VEGAM_INFO("Mounted {} at /{}", directory, mount.point);
+		std::unique_lock lock(m_mountsMutex);
+		m_mounts.push_back(std::move(mount));
+		return true;
+	}
+
+	bool FileManager::MountArchive(std::string_view point,
+	                               const std::string& path)
+	{
+		auto archive = std::make_unique<Assets::Archive>();
+		if (!archive->Open(path))
+		{
+			return false;
+		}
+
+		Mount mount;
+		mount.point = NormalizePath(point);
+		if (!mount.point.empty())
+		{
+			mount.point += '/';
+		}
+		mount.archive = std::move(archive);
+		VEGAM_INFO("Mounted {} at /{}", path, mount.point);
+		std::unique_lock lock(m_mountsMutex);
+		m_mounts.push_back(std::move(mount));
+		return true;
+	}
+
+	void FileManager::Update()
+	{
+		std::vector<Request> finished;
+		{
+			std::lock_guard lock(m_mutex);
+			finished.swap(m_finished);
+		}
+		for (auto& request : finished)
+		{
+			if (request.done)
+			{
+				request.done(request.ok, request.bytes);
+			}
+		}
+	}
+
+	bool FileManager::Exists(std::string_view path) const
+	{
+		Location location;
+		return Resolve(path, location);
+	}
+
+	uint64_t FileManager::GetSize(std::string_view path) const
+	{
+		Location location;
+		return Resolve(path, location) ? GetSize(location) : 0;
+	}
+
+	uint64_t FileManager::GetSize(const Location& location)
+	{
+		if (location.entry)
+		{
+			return location.entry->size;
+		}
+		std::error_code error;
+		const auto size = std::filesystem::file_size(
+		    location.nativePath, error);
+		return error ? 0 : size;
+	}
+
+	bool FileManager::Read(std::string_view path,
+	                       std::vector<uint8_t>& out) const
+	{
+		Location location;
+		if (!Resolve(path, location))
+		{
+			VEGAM_ERROR("Error opening {}", path);
+			return false;
+		}
+		if (location.entry)
+		{
+			return location.archive->Load(*location.entry, out);
+		}
+
+		Core::File file;
+		if (!file.Open(location.nativePath))
+		{
+			VEGAM_ERROR("Error opening {}", path);
+			return false;
+		}
+		out.resize(file.GetSize());
+		return file.ReadAt(0, out.data(), out.size());
+	}
+
+	bool FileManager::ReadText(std::string_view path,
+	                           std::string& out) const
+	{
+		std::vector<uint8_t> bytes;
+		if (!Read(path, bytes))
+		{
+			return false;
+		}
+		out.assign(bytes.begin(), bytes.end());
+		return true;
+	}
+
+	bool FileManager::ReadAt(std::string_view path,
+	                         uint64_t offset,
+	                         std::span<uint8_t> buffer) const
+	{
+		Location location;
+		if (!Resolve(path, location))
+		{
+			VEGAM_ERROR("Error opening {}", path);
+			return false;
+		}
+		return ReadRange(location, offset, buffer);
+	}
+
+	void FileManager::ReadAsync(std::string_view path,
+	                            uint64_t offset,
+	                            std::span<uint8_t> buffer,
+	                            ReadCallback done)
+	{
+		VEGAM_ASSERT(!m_ioThreads.empty(),
+		             "FileManager::ReadAsync() before "
+		             "Initialize()");
+		{
+			std::lock_guard lock(m_mutex);
+			m_requests.push_back(
+			    {std::string(path), offset, buffer,
+			     std::move(done)});
+			++m_pending;
+		}
+		m_wake.notify_one();
+	}
+
+	bool FileManager::Load(std::string_view path,
+	                       FileData& out) const
+	{
+		out.m_mapped.Close();
+		out.m_owned.clear();
+		Location location;
+		if (!Resolve(path, location))
+		{
+			VEGAM_ERROR("Error opening {}", path);
+			return false;
+		}
+		if (location.entry)
+		{
+			return location.archive->Load(*location.entry,
+			                              out.m_owned);
+		}
+		// Empty files cannot be mapped; they read as
+		// nothing.
+		return out.m_mapped.Open(location.nativePath)
+		       || GetSize(location) == 0;
+	}
+
+	std::string
+	FileManager::GetNativePath(std::string_view path) const
+	{
+		Location location;
+		return Resolve(path, location) ? location.nativePath
+		                               : std::string();
+	}
+
+	size_t FileManager::GetPendingCount() const
+	{
+		std::lock_guard lock(m_mutex);
+		return m_pending;
+	}
+
+	std::string FileManager::NormalizePath(std::string_view path)
+	{
+		std::vector<std::string_view> parts;
+		size_t start = 0;
+		while (start <= path.size())
+		{
+			auto end = path.find_first_of("/\\", start);
+			if (end == std::string_view::npos)
+			{
+				end = path.size();
+			}
+			const auto part = path.substr(start, end - start);
+			if (part == ".." && !parts.empty()
+			    && parts.back() != "..")
+			{
+				parts.pop_back();
+			}
+			else if (!part.empty() && part != ".")
+			{
+				parts.push_back(part);
+			}
+			start = end + 1;
+		}
+
+		std::string normalized;
+		if (!path.empty() && (path[0] == '/' || path[0] == '\\'))
+		{
+			normalized += '/';
+		}
+		for (size_t i = 0; i < parts.size(); ++i)
+		{
+			if (i > 0)
+			{
+				normalized += '/';
+			}
+			normalized += parts[i];
+		}
+		return normalized;
+	}
+
+	bool FileManager::Resolve(std::string_view path,
+	                          Location& location) const
+	{
+		const auto normalized = NormalizePath(path);
+		std::error_code error;
+		if (!IsAbsolute(normalized))
+		{
+			std::shared_lock lock(m_mountsMutex);
+			for (auto it = m_mounts.rbegin();
+			     it != m_mounts.rend(); ++it)
+			{
+				if (!normalized.starts_with(it->point))
+				{
+					continue;
+				}
+				const auto relative =
+				    std::string_view(normalized)
+				        .substr(it->point.size());
+				if (it->archive)
+				{
+					location.entry = it->archive->Find(
+					    Assets::MakeAssetId(relative));
+					if (location.entry)
+					{
+						location.archive = it->archive.get();
+						return true;
+					}
+					continue;
+				}
+
+				auto native = it->directory;
+				native += '/';
+				native += relative;
+				if (std::filesystem::is_regular_file(native,
+				                                     error))
+				{
+					location.nativePath = std::move(native);
+					return true;
+				}
+			}
+		}
+
+		// The working directory, below every mount.
+		if (std::filesystem::is_regular_file(normalized, error))
+		{
+			location.nativePath = normalized;
+			return true;
+		}
+		return false;
+	}
+
+	bool FileManager::ReadRange(const Location& location,
+	                            uint64_t offset,
+	                            std::span<uint8_t> buffer) const
+	{
+		if (buffer.empty())
+		{
+			return true;
+		}
+		if (!location.entry)
+		{
+			Core::File file;
+			return file.Open(location.nativePath)
+			       && offset <= file.GetSize()
+			       && buffer.size() <= file.GetSize() - offset
+			       && file.ReadAt(offset, buffer.data(),
+			                      buffer.size());
+		}
+
+		// The chunks holding the range, decompressed.
+		const auto& entry = *location.entry;
+		if (offset > entry.size
+		    || buffer.size() > entry.size - offset)
+		{
+			return false;
+		}
+		const auto first = static_cast<uint32_t>(offset
+		                                         / ChunkSize);
+		const auto last = static_cast<uint32_t>(
+		    (offset + buffer.size() - 1) / ChunkSize);
+		const auto count = last - first + 1;
+		std::vector<uint8_t> stored;
+		if (!location.archive->ReadChunks(entry, first, count,
+		                                  stored))
+		{
+			return false;
+		}
+		std::vector<uint8_t> chunks(
+		    Assets::Archive::GetChunksSize(entry, first, count));
+		for (uint32_t i = first; i <= last; ++i)
+		{
+			if (!location.archive->DecompressChunk(
+			        entry, i, stored.data(), chunks.data(),
+			        first))
+			{
+				return false;
+			}
+		}
+		std::memcpy(buffer.data(),
+		            chunks.data() + offset
+		                - uint64_t{first} * ChunkSize,
+		            buffer.size());
+		return true;
+	}
+
+	void FileManager::IoMain(uint32_t thread)
+	{
+		Core::Profiler::SetThreadName("File I/O "
+		                              + std::to_string(thread));
+		Core::SetThreadClass(Core::ThreadClass::Background);
+		while (true)
+		{
+			Request request;
+			{
+				std::unique_lock lock(m_mutex);
+				m_wake.wait(lock, [this] {
+					return m_stopRequested
+					       || !m_requests.empty();
+				});
+				if (m_stopRequested)
+				{
+					return;
+				}
+				request = std::move(m_requests.front());
+				m_requests.pop_front();
+			}
+
+			// Reads stop at the end of the file.
+			Location location;
+			if (Resolve(request.path, location))
+			{
+				const auto size = GetSize(location);
+				if (request.offset <= size)
+				{
+					request.bytes =
+					    static_cast<size_t>(std::min<uint64_t>(
+					        request.buffer.size(),
+					        size - request.offset));
+					request.ok = ReadRange(
+					    location, request.offset,
+					    request.buffer.first(request.bytes));
+				}
+			}
+			if (!request.ok)
+			{
+				request.bytes = 0;
+				VEGAM_ERROR("Error reading {}", request.path);
+			}
+
+			std::lock_guard lock(m_mutex);
+			m_finished.push_back(std::move(request));
+			--m_pending;
+		}
+	}
+} // namespace AthiVegam::Managers
@@ -0,0 +1,308 @@
+#include "AthiVegam/Managers/JobManager.h"
+
+#include "AthiVegam/Core/CpuTopology.h"
+#include "AthiVegam/Core/FloatEnv.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Log.h"
+
+#include <chrono>
+
+namespace AthiVegam::Managers
+{
+	namespace
+	{
+		constexpr uint32_t NotAJobThread = 0xFFFFFFFF;
+		thread_local uint32_t jobThreadIndex = NotAJobThread;
+	} // namespace
+
+	void JobManager::Initialize(uint32_t workerCount)
+	{
+		if (workerCount == 0)
+		{
+			// A job on a slow efficiency core holds up the
+			// whole frame, so hybrid CPUs leave them to
+			// background threads.
+			const auto cores = static_cast<uint32_t>(
+			    Core::GetCpuTopology().performance.size());
+			workerCount = cores > 1 ? cores - 1 : 1;
+		}
+
+		m_queues.clear();
+		for (uint32_t i = 0; i <= workerCount; ++i)
+		{
+			m_queues.push_back(std::make_unique<ThreadQueue>());
+		}
+
+		jobThreadIndex = 0;
+		m_running = true;
+		for (uint32_t i = 1; i <= workerCount; ++i)
+		{
+			m_workers.emplace_back(&JobManager::WorkerMain,
+			                       this, i);
+		}
+		VEGAM_INFO("Job system: {} workers", workerCount);
+	}
+
+	void JobManager::Shutdown()
+	{
+		VEGAM_ASSERT(m_queued == 0,
+		             "Shutting down with jobs still queued");
+
+		m_running = false;
+		m_wake.notify_all();
+		for (auto& worker : m_workers)
+		{
+			worker.join();
+		}
+		m_workers.clear();
+		m_queues.clear();
+		m_queued = 0;
+		jobThreadIndex = NotAJobThread;
+		m_frameStats.clear();
+		m_frameStart = 0;
+		m_frameTicks = 0;
+	}
+
+	void JobManager::Wait(const JobCounter& counter)
+	{
+		const auto thread = jobThreadIndex;
+		if (thread == NotAJobThread)
+		{
+			while (!counter.IsDone())
+			{
+				std::this_thread::yield();
+			}
+			return;
+		}
+
+		VEGAM_PROFILE_SCOPE("JobManager::Wait");
+		const auto outer = m_queues[thread]->state;
+		while (!counter.IsDone())
+		{
+			if (!RunOne(thread))
+			{
+				SetState(thread, State::Waiting);
+				std::this_thread::yield();
+			}
+		}
+		SetState(thread, outer);
+	}
+
+	bool JobManager::RunPendingJob()
+	{
+		const auto thread = jobThreadIndex;
+		return thread != NotAJobThread && !m_queues.empty()
+		       && RunOne(thread);
+	}
+
+	JobManager::Job* JobManager::AllocateJob()
+	{
+		const auto thread = jobThreadIndex;
+		if (thread == NotAJobThread || m_queues.empty())
+		{
+			return nullptr;
+		}
+
+		auto& queue = *m_queues[thread];
+		auto* job =
+		    &queue.jobs[queue.nextJob++ % MaxJobsPerThread];
+		return job;
+	}
+
+	void JobManager::Submit(Job* job)
+	{
+		if (job->counter)
+		{
+			job->counter->m_pending.fetch_add(
+			    1, std::memory_order_relaxed);
+		}
+
+		auto& queue = *m_queues[jobThreadIndex];
+		if (!queue.deque.Push(job))
+		{
+			// Deque full; nobody else can get to it sooner.
+			Execute(job);
+			return;
+		}
+		const auto depth = queue.deque.Size();
+		if (depth > queue.counters.peakQueueDepth.load(
+		                std::memory_order_relaxed))
+		{
+			queue.counters.peakQueueDepth.store(
+			    depth, std::memory_order_relaxed);
+		}
+
+		m_queued.fetch_add(1, std::memory_order_relaxed);
+		m_wake.notify_one();
+	}
+
+	void JobManager::Execute(Job* job)
+	{
+		auto* counter = job->counter;
+		job->run(job->storage);
+		if (counter)
+		{
+			counter->m_pending.fetch_sub(
+			    1, std::memory_order_release);
+		}
+	}
+
+	JobManager::Job* JobManager::FindJob(uint32_t thread)
+	{
+		auto& queue = *m_queues[thread];
+		Job* job = nullptr;
+		if (queue.deque.Pop(job))
+		{
+			return job;
+		}
+
+		const auto previous = SetState(thread, State::Stealing);
+		const auto count =
+		    static_cast<uint32_t>(m_queues.size());
+		for (uint32_t i = 1; i < count; ++i)
+		{
+			auto& victim = *m_queues[(thread + i) % count];
+			if (victim.deque.Steal(job))
+			{
+				queue.counters.steals.fetch_add(
+				    1, std::memory_order_relaxed);
+				SetState(thread, previous);
+				return job;
+			}
+			// Not empty, so the steal lost a race; or it
+			// emptied since.
+			if (!victim.deque.IsEmpty())
+			{
+				queue.counters.contendedSteals.fetch_add(
+				    1, std::memory_order_relaxed);
+			}
+		}
+		SetState(thread, previous);
+		return nullptr;
+	}
+
+	bool JobManager::RunOne(uint32_t thread)
+	{
+		auto* job = FindJob(thread);
+		if (!job)
+		{
+			return false;
+		}
+
+		RunJob(thread, job);
+		return true;
+	}
+
+	void JobManager::RunJob(uint32_t thread, Job* job)
+	{
+		m_queued.fetch_sub(1, std::memory_order_relaxed);
+		const auto previous = SetState(thread, State::Busy);
+		Execute(job);
+		SetState(thread, previous);
+		m_queues[thread]->counters.jobs.fetch_add(
+		    1, std::memory_order_relaxed);
+	}
+
+	void JobManager::WorkerMain(uint32_t thread)
+	{
+		jobThreadIndex = thread;
+		Core::Profiler::SetThreadName("Job Worker "
+		                              + std::to_string(thread));
+		Core::SetThreadClass(Core::ThreadClass::Worker);
+		Core::FloatEnv::SetDeterministic();
+		auto& queue = *m_queues[thread];
+		queue.stateStart = Core::Profiler::Now();
+		queue.state = State::Busy;
+		while (m_running.load(std::memory_order_relaxed))
+		{
+			if (auto* job = FindJob(thread))
+			{
+				// One zone per run of jobs rather than per
+				// job.
+				VEGAM_PROFILE_SCOPE("Jobs");
+				do
+				{
+					RunJob(thread, job);
+				} while ((job = FindJob(thread)));
+			}
+
+			VEGAM_PROFILE_SCOPE("Job idle");
+			SetState(thread, State::Idle);
+			std::unique_lock lock(m_sleepMutex,
+			                      std::try_to_lock);
+			if (!lock.owns_lock())
+			{
+				queue.counters.lockContentions.fetch_add(
+				    1, std::memory_order_relaxed);
+				lock.lock();
+			}
+			// The timeout covers a wake-up racing the check.
+			m_wake.wait_for(
+			    lock, std::chrono::milliseconds(1), [this] {
+				    return !m_running
+				           || m_queued.load(
+				                  std::memory_order_relaxed)
+				                  > 0;
+			    });
+			lock.unlock();
+			SetState(thread, State::Busy);
+		}
+		SetState(thread, State::Untracked);
+	}
+
+	JobManager::State JobManager::SetState(uint32_t thread,
+	                                       State state)
+	{
+		auto& queue = *m_queues[thread];
+		const auto previous = queue.state;
+		if (previous == state)
+		{
+			return previous;
+		}
+		const auto now = Core::Profiler::Now();
+		if (previous != State::Untracked)
+		{
+			queue.counters.ticks[static_cast<size_t>(previous)]
+			    .fetch_add(now - queue.stateStart,
+			               std::memory_order_relaxed);
+		}
+		queue.state = state;
+		queue.stateStart = now;
+		return previous;
+	}
+
+	void JobManager::EndFrame()
+	{
+		const auto now = Core::Profiler::Now();
+		m_frameTicks = m_frameStart != 0 ? now - m_frameStart
+		                                 : 0;
+		m_frameStart = now;
+
+		const auto take = [](auto& value) {
+			return value.exchange(0, std::memory_order_relaxed);
+		};
+		m_frameStats.resize(m_queues.size());
+		for (size_t i = 0; i < m_queues.size(); ++i)
+		{
+			auto& counters = m_queues[i]->counters;
+			auto& stats = m_frameStats[i];
+			const auto ticks = [&](State state) {
+				return take(
+				    counters.ticks[static_cast<size_t>(state)]);
+			};
+			stats.busyTicks = ticks(State::Busy);
+			stats.stealTicks = ticks(State::Stealing);
+			stats.waitTicks = ticks(State::Waiting);
+			stats.idleTicks = ticks(State::Idle);
+			stats.jobs = take(counters.jobs);
+			stats.steals = take(counters.steals);
+			stats.contendedSteals =
+			    take(counters.contendedSteals);
+			stats.lockContentions =
+			    take(counters.lockContentions);
+			stats.queueDepth = m_queues[i]->deque.Size();
+			stats.peakQueueDepth =
+			    take(counters.peakQueueDepth);
+		}
+	}
+} // namespace AthiVegam::Managers
@@ -1,11 +1,163 @@
 #include "AthiVegam/Managers/LogManager.h"
 
+#include "external/imgui/imgui.h"
+#include "spdlog/async.h"
+#include "spdlog/fmt/chrono.h"
+#include "spdlog/sinks/ringbuffer_sink.h"
+#include "spdlog/sinks/rotating_file_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+
 namespace AthiVegam::Managers
 {
 	std::shared_ptr<spdlog::logger> LogManager::logger =
 	    nullptr;
+	std::shared_ptr<spdlog::logger> LogManager::syncLogger =
+	    nullptr;
+	std::shared_ptr<spdlog::details::thread_pool>
+	    LogManager::threadPool = nullptr;
+	spdlog::logger* LogManager::rawLogger = nullptr;
+
+	namespace
+	{
+		constexpr size_t PanelLines = 512;
+		constexpr auto Pattern =
+		    "%^[%Y-%m-%d %H:%M:%S.%e] %v%$";
+
+		// Keeps the last messages for a post-mortem dump.
+		// Each message claims a slot with one atomic
+		// increment and is formatted straight into it, so
+		// writers never lock and the dump never allocates;
+		// lines longer than a slot are cut short.
+		class CrashRingSink final : public spdlog::sinks::sink
+		{
+		  public:
+			explicit CrashRingSink(uint32_t lines)
+			    : m_slots(std::make_unique<Slot[]>(lines))
+			    , m_count(lines)
+			{
+			}
+
+			void log(const spdlog::details::log_msg& msg) override
+			{
+				const auto index =
+				    m_next.fetch_add(1, std::memory_order_relaxed);
+				auto& slot = m_slots[index % m_count];
+				slot.sequence.store(0, std::memory_order_relaxed);
+
+				const auto time =
+				    spdlog::log_clock::to_time_t(msg.time);
+				const auto level =
+				    spdlog::level::to_string_view(msg.level);
+				const auto result = fmt::format_to_n(
+				    slot.text, SlotSize, "[{:%Y-%m-%d %H:%M:%S}] "
+				    "[{}] {}\n",
+				    fmt::localtime(time),
+				    std::string_view(level.data(), level.size()),
+				    std::string_view(msg.payload.data(),
+				                     msg.payload.size()));
+				slot.length = static_cast<uint32_t>(
+				    std::min<size_t>(result.size, SlotSize));
+				slot.text[slot.length - 1] = '\n';
+				slot.sequence.store(index + 1,
+				                    std::memory_order_release);
+			}
+
+			// Oldest first. Safe to call from a signal handler
+			// as far as stdio is.
+			void Dump(std::FILE* file) const
+			{
+				const auto next =
+				    m_next.load(std::memory_order_acquire);
+				const auto first =
+				    next > m_count ? next - m_count : 0;
+				for (auto index = first; index < next; ++index)
+				{
+					const auto& slot = m_slots[index % m_count];
+					if (slot.sequence.load(
+					        std::memory_order_acquire)
+					    == index + 1)
+					{
+						std::fwrite(slot.text, 1, slot.length,
+						            file);
+					}
+				}
+			}
+
+			void flush() override {}
+			void set_pattern(const std::string&) override {}
+			void set_formatter(
+			    std::unique_ptr<spdlog::formatter>) override
+			{
+			}
+
+		  private:
+			static constexpr size_t SlotSize = 256;
+
+			struct Slot
+			{
+				std::atomic<uint64_t> sequence{0};
+				uint32_t length = 0;
+				char text[SlotSize];
+			};
+
+			std::unique_ptr<Slot[]> m_slots;
+			uint64_t m_count;
+			std::atomic<uint64_t> m_next{0};
+		};
+
+		using RingSink = spdlog::sinks::ringbuffer_sink_mt;
+		std::shared_ptr<RingSink> panelSink;
+		std::shared_ptr<CrashRingSink> crashSink;
+		std::string crashLogPath;
+
+		// Dumps the crash ring, then lets the default action
+		// end the process.
+		void OnFatalSignal(int signal)
+		{
+			LogManager::WriteCrashLog();
+			std::signal(signal, SIG_DFL);
+			std::raise(signal);
+		}
+
+		void InstallCrashHandlers()
+		{
+			for (int signal : {SIGSEGV, SIGABRT, SIGFPE, SIGILL})
+			{
+				std::signal(signal, OnFatalSignal);
+			}
+		}
+
+		// LogLevel mirrors spdlog's level order.
+		inline spdlog::level::level_enum
+		ToSpdlogLevel(LogLevel level)
+		{
+			return static_cast<spdlog::level::level_enum>(
+			    level);
+		}
+
+		ImVec4 GetLevelColor(spdlog::level::level_enum level)
+		{
+			switch (level)
+			{
+			case spdlog::level::trace:
+			case spdlog::level::debug:
+				return {0.6f, 0.6f, 0.6f, 1.0f};
+			case spdlog::level::warn:
+				return {1.0f, 0.8f, 0.3f, 1.0f};
+			case spdlog::level::err:
+			case spdlog::level::critical:
+				return {1.0f, 0.4f, 0.4f, 1.0f};
+			default:
+				return {1.0f, 1.0f, 1.0f, 1.0f};
+			}
+		}
+	} // namespace
 
 	void LogManager::Initialize(const std::string& name)
 	{
@@ -18,19 +170,168 @@ namespace AthiVegam::Managers
 		// };
 
 		logger = spdlog::stdout_color_mt(name);
-		logger->set_pattern(
-		    "%^[%Y-%m-%d %H:%M:%S.%e] %v%$");
-		logger->flush_on(spdlog::level::trace);
+		logger->set_pattern(Pattern);
+		// Nothing is flushed eagerly: errors aside, context
+		// for a crash comes from the crash ring.
+		logger->flush_on(spdlog::level::err);
+		syncLogger = logger;
+		rawLogger = logger.get();
 		// spdlog::register_logger(logger);
 	}
 
+	void LogManager::Configure(const EngineConfig& config)
+	{
+		if (!syncLogger || threadPool)
+		{
+			return;
+		}
+
+		std::vector<spdlog::sink_ptr> sinks;
+		const auto add = [&sinks](spdlog::sink_ptr sink,
+		                          LogLevel level) {
+			sink->set_level(ToSpdlogLevel(level));
+			sink->set_pattern(Pattern);
+			sinks.push_back(std::move(sink));
+		};
+
+		if (config.consoleLogLevel != LogLevel::Off)
+		{
+			add(syncLogger->sinks().front(),
+			    config.consoleLogLevel);
+		}
+		if (!config.logFilePath.empty()
+		    && config.fileLogLevel != LogLevel::Off)
+		{
+			try
+			{
+				add(std::make_shared<
+				        spdlog::sinks::rotating_file_sink_mt>(
+				        config.logFilePath,
+				        config.logFileMaxSize,
+				        std::max(config.logFileCount, 1u)),
+				    config.fileLogLevel);
+			}
+			catch (const spdlog::spdlog_ex& error)
+			{
+				syncLogger->error("Cannot open log file {}: {}",
+				                  config.logFilePath,
+				                  error.what());
+			}
+		}
+		panelSink = nullptr;
+		if (config.panelLogLevel != LogLevel::Off)
+		{
+			panelSink = std::make_shared<RingSink>(PanelLines);
+			add(panelSink, config.panelLogLevel);
+		}
+		crashSink = nullptr;
+		if (config.crashLogLevel != LogLevel::Off
+		    && config.crashLogLines > 0)
+		{
+			crashSink = std::make_shared<CrashRingSink>(
+			    config.crashLogLines);
+			add(crashSink, config.crashLogLevel);
+			InstallCrashHandlers();
+		}
+		crashLogPath = config.crashLogPath;
+
+		// Messages below every sink's level are dropped
+		// before they are formatted.
+		auto level = spdlog::level::off;
+		for (const auto& sink : sinks)
+		{
+			level = std::min(level, sink->level());
+		}
+		syncLogger->sinks() = std::move(sinks);
+		syncLogger->set_level(level);
+		spdlog::flush_every(std::chrono::seconds(1));
+	}
+
+	void LogManager::StartAsync(size_t queueSize,
+	                            LogOverflow overflow)
+	{
+		if (!syncLogger || threadPool)
+		{
+			return;
+		}
+
+		threadPool =
+		    std::make_shared<spdlog::details::thread_pool>(
+		        queueSize, 1);
+		const auto policy =
+		    overflow == LogOverflow::Block
+		        ? spdlog::async_overflow_policy::block
+		        : spdlog::async_overflow_policy::overrun_oldest;
+		auto& sinks = syncLogger->sinks();
+		auto async = std::make_shared<spdlog::async_logger>(
+		    syncLogger->name() + "Async", sinks.begin(),
+		    sinks.end(), threadPool, policy);
+		async->set_level(syncLogger->level());
+		// Errors are flushed right away, the rest every
+		// second (see Configure()).
+		async->flush_on(spdlog::level::err);
+		spdlog::register_logger(async);
+		logger = std::move(async);
+		rawLogger = logger.get();
+	}
+
 	void LogManager::Shutdown()
 	{
 		// spdlog::shutdown();
+		if (threadPool)
+		{
+			spdlog::drop(logger->name());
+			logger = syncLogger;
+			rawLogger = logger.get();
+			// Joins the worker once it has written the
+			// messages still queued.
+			threadPool.reset();
+		}
 	}
 
 	std::shared_ptr<spdlog::logger> LogManager::Logger()
 	{
 		return LogManager::logger;
 	}
+
+	void LogManager::DrawPanel()
+	{
+		if (!panelSink)
+		{
+			return;
+		}
+		if (!ImGui::Begin("Log"))
+		{
+			ImGui::End();
+			return;
+		}
+
+		for (const auto& message : panelSink->last_raw())
+		{
+			ImGui::PushStyleColor(ImGuiCol_Text,
+			                      GetLevelColor(message.level));
+			ImGui::TextUnformatted(message.payload.begin(),
+			                       message.payload.end());
+			ImGui::PopStyleColor();
+		}
+		if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY())
+		{
+			ImGui::SetScrollHereY(1.0f);
+		}
+		ImGui::End();
+	}
+
+	void LogManager::WriteCrashLog()
+	{
+		if (!crashSink || crashLogPath.empty())
+		{
+			return;
+		}
+
+		if (auto* file = std::fopen(crashLogPath.c_str(), "w"))
+		{
+			crashSink->Dump(file);
+			std::fclose(file);
+		}
+	}
 } // namespace AthiVegam::Managers
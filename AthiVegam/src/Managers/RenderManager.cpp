@@ -1,11 +1,96 @@
 #include "AthiVegam/Managers/RenderManager.h"
 
+#include "AthiVegam/Core/CVar.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Graphics/DebugDraw.h"
+#include "AthiVegam/Graphics/FrameCapture.h"
+#include "AthiVegam/Graphics/GLState.h"
+#include "AthiVegam/Graphics/GpuMemory.h"
+#include "AthiVegam/Graphics/GLCallCounter.h"
+#include "AthiVegam/Graphics/GpuProfiler.h"
+#include "AthiVegam/Graphics/GpuResources.h"
 #include "AthiVegam/Graphics/Helpers.h"
+#include "AthiVegam/Graphics/PipelineWarmup.h"
+#include "AthiVegam/Graphics/RetireQueue.h"
+#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Graphics/WeightedOit.h"
 #include "AthiVegam/Log.h"
 #include "glad/glad.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
 namespace AthiVegam::Managers
 {
+	namespace
+	{
+		// Bumped whenever a RenderManager drops its command
+		// lists so threads re-register instead of using a
+		// stale cached list.
+		std::atomic<uint32_t> listsEpochCounter{1};
+
+		struct ThreadListCache
+		{
+			const RenderManager* owner = nullptr;
+			uint32_t epoch = 0;
+			std::array<Graphics::CommandList, 2>* lists =
+			    nullptr;
+		};
+		thread_local ThreadListCache threadListCache;
+
+		// Bounded so a lost context can't hang the GL
+		// thread.
+		constexpr GLuint64 FrameFenceTimeout = 1'000'000'000;
+
+		Core::CVar<int32_t> clearColorCVar(
+		    "r.clearColor", 0x6495ED, // Cornflower blue
+		    "Clear color as 0xRRGGBB");
+		Core::CVar<bool> multiDrawIndirectCVar(
+		    "r.multiDrawIndirect", false,
+		    "Batch arena draws into multi-draw indirect");
+		Core::CVar<bool> gpuCullingCVar(
+		    "r.gpuCulling", false,
+		    "Cull multi-draw batches on the GPU");
+		Core::CVar<float> lodBiasCVar(
+		    "r.lodBias", 1.0f,
+		    "Scales the sizes GPU-culled draws pick levels by");
+		Core::CVar<bool> depthSortCVar(
+		    "r.depthSort", false,
+		    "Sort draws by depth in the culling view");
+		Core::CVar<bool> coherentSortCVar(
+		    "r.coherentSort", true,
+		    "Start sorting draws from last frame's order");
+		Core::CVar<bool> depthPrepassCVar(
+		    "r.depthPrepass", false,
+		    "Draw opaque depth before shading");
+
+		// Out-of-order entries, as a fraction of all, past
+		// which a coherent sort gives way to a radix sort.
+		constexpr size_t MaxSortStrayShare = 16;
+
+		// Past any viewport and layer of a sort key.
+		constexpr uint64_t NoOitRun = ~uint64_t(0);
+	} // namespace
+
+	RenderManager::RenderManager()
+	    : m_mainLists(nullptr)
+	    , m_listsEpoch(listsEpochCounter++)
+	{
+		m_lists.push_back(std::make_unique<FrameLists>());
+		m_mainLists = m_lists.front().get();
+		static_assert(
+		    std::is_same_v<
+		        FrameLists,
+		        std::remove_pointer_t<
+		            decltype(ThreadListCache::lists)>>);
+		threadListCache = {this, m_listsEpoch, m_mainLists};
+	}
+
 	void RenderManager::Initialize()
 	{
 		VEGAM_INFO(
@@ -17,37 +102,133 @@ namespace AthiVegam::Managers
 		    glGetString(GL_VERSION));
 		VEGAM_CHECK_GL_ERROR;
 
-		glEnable(GL_DEPTH_TEST);
-		VEGAM_CHECK_GL_ERROR;
-		glDepthFunc(GL_LEQUAL);
-		VEGAM_CHECK_GL_ERROR;
+		// Draws without a material start from here.
+		m_renderState.SetPipelineState(
+		    Graphics::PipelineState{});
 
-		glEnable(GL_BLEND);
-		VEGAM_CHECK_GL_ERROR;
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glGenBuffers(1, &m_instanceBuffer);
 		VEGAM_CHECK_GL_ERROR;
+		Graphics::GpuResources::Register(
+		    Graphics::GpuResources::Type::Buffer,
+		    m_instanceBuffer, 0, "Instance data");
 
-		// Cornflower blue
-		SetClearColor(static_cast<float>(0x64)
-		                  / static_cast<float>(0xFF),
-		              static_cast<float>(0x95)
-		                  / static_cast<float>(0xFF),
-		              static_cast<float>(0xED)
-		                  / static_cast<float>(0xFF),
-		              1.f);
+		m_multiDrawIndirectSupported = GLAD_GL_VERSION_4_3;
+		SetMultiDrawIndirectEnabled(
+		    m_multiDrawIndirectSupported);
+		if (m_multiDrawIndirectSupported)
+		{
+			glGenBuffers(1, &m_indirectBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			Graphics::GpuResources::Register(
+			    Graphics::GpuResources::Type::Buffer,
+			    m_indirectBuffer, 0, "Indirect draws");
+			glGenBuffers(1, &m_drawDataBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			Graphics::GpuResources::Register(
+			    Graphics::GpuResources::Type::Buffer,
+			    m_drawDataBuffer, 0, "Draw data");
+		}
+		VEGAM_INFO("Multi-draw indirect: {}",
+		           m_multiDrawIndirectSupported
+		               ? "available"
+		               : "unavailable (needs GL 4.3)");
+
+#ifndef AV_CONFIG_SHIPPING
+		Graphics::GpuProfiler::Initialize();
+#endif // AV_CONFIG_SHIPPING
+		Graphics::DebugDraw::Initialize();
+		Graphics::GpuMemory::Initialize();
+
+		// Applies r.clearColor even if never set.
+		m_cvarVersions.clearColor = ~0u;
+		ApplyCVars();
 	}
 
 	void RenderManager::Shutdown()
 	{
-		while (!m_renderCommands.empty())
+		Graphics::GpuProfiler::Shutdown();
+		Graphics::DebugDraw::Shutdown();
+		DeleteFrameFences();
+		m_lateLatchCallback = nullptr;
+		m_lateLatchPending = false;
+		{
+			std::lock_guard lock(m_listsMutex);
+			m_lists.resize(1);
+			for (auto& list : *m_mainLists)
+			{
+				list.Reset();
+			}
+			m_listsEpoch = listsEpochCounter++;
+			threadListCache = {this, m_listsEpoch,
+			                   m_mainLists};
+			m_retained.clear();
+		}
+		m_renderThreadEnabled = false;
+		m_recordFrame = 0;
+		m_executeFrame = 0;
+		m_flushCommands.Reset();
+		m_sortEntries.clear();
+		m_sortScratch.clear();
+		m_sortStrays.clear();
+		m_sortOrder.clear();
+		m_instanceData.clear();
+		m_drawData.clear();
+		m_constantData.clear();
+		m_constantRing.reset();
+
+		if (m_instanceBuffer != 0)
 		{
-			m_renderCommands.pop();
+			Graphics::GpuResources::Unregister(
+			    Graphics::GpuResources::Type::Buffer,
+			    m_instanceBuffer);
+			glDeleteBuffers(1, &m_instanceBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			m_instanceBuffer = 0;
+			m_instanceBufferSize = 0;
 		}
+		if (m_drawDataBuffer != 0)
+		{
+			Graphics::GpuResources::Unregister(
+			    Graphics::GpuResources::Type::Buffer,
+			    m_drawDataBuffer);
+			glDeleteBuffers(1, &m_drawDataBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			m_drawDataBuffer = 0;
+			m_drawDataBufferSize = 0;
+		}
+
+		m_frameGraph.Shutdown();
+		m_gpuCulling.Shutdown();
+		m_weightedOit.Shutdown();
+		m_weightedOitUnavailable = false;
+		m_gpuCullingEnabled = false;
+		m_cullingViews = {};
+		m_cullingView = nullptr;
+		m_drawBounds.clear();
+		m_drawLods.clear();
+		m_clusterDraws.clear();
+
+		m_indirectDraws.clear();
+		m_drawMaterials.clear();
+		if (m_indirectBuffer != 0)
+		{
+			Graphics::GpuResources::Unregister(
+			    Graphics::GpuResources::Type::Buffer,
+			    m_indirectBuffer);
+			glDeleteBuffers(1, &m_indirectBuffer);
+			VEGAM_CHECK_GL_ERROR;
+			m_indirectBuffer = 0;
+			m_indirectBufferSize = 0;
+		}
+		Graphics::RetireQueue::Flush();
 	}
 
 	void RenderManager::Clear()
 	{
-		VEGAM_ASSERT(m_renderCommands.empty(),
+		// The render thread clears while the next frame is
+		// already being recorded.
+		VEGAM_ASSERT(m_renderThreadEnabled
+		                 || GetMainList().GetEntries().empty(),
 		             "Unflushed Render Commands in Queue!");
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		VEGAM_CHECK_GL_ERROR;
@@ -62,27 +243,1572 @@ namespace AthiVegam::Managers
 
 	void RenderManager::SetWireframeMode(bool enabled)
 	{
-		glPolygonMode(GL_FRONT_AND_BACK,
-		              enabled ? GL_LINE : GL_FILL);
-		VEGAM_CHECK_GL_ERROR;
+		Graphics::GLState::SetPolygonMode(enabled ? GL_LINE
+		                                          : GL_FILL);
+	}
+
+	uint32_t RenderManager::PushInstances(
+	    const Graphics::RenderCommands::InstanceTransform*
+	        transforms,
+	    uint32_t count)
+	{
+		return GetMainList().PushInstances(transforms,
+		                                   count);
+	}
+
+	uint32_t RenderManager::PushInstances(
+	    const Graphics::RenderCommands::InstanceTransform*
+	        transforms,
+	    const Graphics::RenderCommands::DrawData* drawData,
+	    uint32_t count)
+	{
+		return GetMainList().PushInstances(
+		    transforms, drawData, count);
+	}
+
+	void RenderManager::SubmitInstanced(
+	    Graphics::MeshHandle mesh,
+	    Graphics::ShaderHandle shader,
+	    const Graphics::RenderCommands::InstanceTransform*
+	        transforms,
+	    uint32_t count)
+	{
+		GetMainList().SubmitInstanced(mesh, shader,
+		                              transforms, count);
+	}
+
+	void RenderManager::SetLateLatchCallback(
+	    LateLatchCallback callback)
+	{
+		m_lateLatchCallback = std::move(callback);
+	}
+
+	Graphics::RenderCommands::Constants
+	RenderManager::PushLateLatchConstants(const void* data,
+	                                      uint32_t size)
+	{
+		VEGAM_ASSERT(!m_lateLatchPending,
+		             "Only one late-latched constant block per "
+		             "frame");
+		m_lateLatchConstants =
+		    GetMainList().PushConstants(data, size);
+		m_lateLatchPending = true;
+		return m_lateLatchConstants;
+	}
+
+	// Main thread, after the frame is recorded: the
+	// callback rewrites the block in the recording list
+	// before anything reads it.
+	void RenderManager::LateLatch()
+	{
+		if (!m_lateLatchPending)
+		{
+			return;
+		}
+		m_lateLatchPending = false;
+		if (m_lateLatchCallback)
+		{
+			VEGAM_PROFILE_SCOPE("RenderManager::LateLatch");
+			m_lateLatchCallback(
+			    GetMainList().MapConstants(m_lateLatchConstants),
+			    m_lateLatchConstants.size);
+		}
+	}
+
+	void RenderManager::AddRetainedList(
+	    const Graphics::RetainedList& list)
+	{
+		auto copy = std::make_unique<RetainedCopy>();
+		copy->list = &list;
+		std::lock_guard lock(m_listsMutex);
+		m_retained.push_back(std::move(copy));
+	}
+
+	// The copies may be executing; CopyRetainedLists()
+	// frees them.
+	void RenderManager::RemoveRetainedList(
+	    const Graphics::RetainedList& list)
+	{
+		std::lock_guard lock(m_listsMutex);
+		for (auto& copy : m_retained)
+		{
+			if (copy->list == &list)
+			{
+				copy->list = nullptr;
+			}
+		}
+	}
+
+	void RenderManager::CopyRetainedLists()
+	{
+		std::lock_guard lock(m_listsMutex);
+		std::erase_if(m_retained, [](const auto& copy) {
+			return copy->list == nullptr;
+		});
+		for (auto& copy : m_retained)
+		{
+			auto& version = copy->versions[m_recordFrame];
+			if (version != copy->list->GetVersion())
+			{
+				copy->frames[m_recordFrame] =
+				    copy->list->GetList();
+				version = copy->list->GetVersion();
+			}
+		}
+	}
+
+	Graphics::CommandList& RenderManager::GetThreadCommandList()
+	{
+		auto& cache = threadListCache;
+		if (cache.owner != this || cache.epoch != m_listsEpoch)
+		{
+			// First submission from this thread; registering
+			// is the only locked step.
+			std::lock_guard lock(m_listsMutex);
+			m_lists.push_back(std::make_unique<FrameLists>());
+			cache = {this, m_listsEpoch,
+			         m_lists.back().get()};
+		}
+		return (*cache.lists)[m_recordFrame];
+	}
+
+	void RenderManager::SetMultiDrawIndirectEnabled(
+	    bool enabled)
+	{
+		VEGAM_ASSERT(!enabled || m_multiDrawIndirectSupported,
+		             "Multi-draw indirect requires a GL 4.3 "
+		             "context");
+		m_multiDrawIndirectEnabled =
+		    enabled && m_multiDrawIndirectSupported;
+		multiDrawIndirectCVar.Set(m_multiDrawIndirectEnabled);
+		m_cvarVersions.multiDrawIndirect =
+		    multiDrawIndirectCVar.GetVersion();
+	}
+
+	void RenderManager::SetGpuCullingEnabled(bool enabled)
+	{
+		VEGAM_ASSERT(!enabled || m_multiDrawIndirectSupported,
+		             "GPU culling requires a GL 4.3 context");
+		m_gpuCullingEnabled = enabled
+		                      && m_multiDrawIndirectSupported
+		                      && m_gpuCulling.Initialize();
+		gpuCullingCVar.Set(m_gpuCullingEnabled);
+		m_cvarVersions.gpuCulling = gpuCullingCVar.GetVersion();
+	}
+
+	void RenderManager::SetLodBias(float bias)
+	{
+		lodBiasCVar.Set(bias);
+	}
+
+	void RenderManager::SetDepthSortEnabled(bool enabled)
+	{
+		depthSortCVar.Set(enabled);
+	}
+
+	void RenderManager::SetDepthPrepassEnabled(bool enabled)
+	{
+		depthPrepassCVar.Set(enabled);
+	}
+
+	void RenderManager::ApplyCVars()
+	{
+		if (clearColorCVar.Changed(m_cvarVersions.clearColor))
+		{
+			const auto rgb =
+			    static_cast<uint32_t>(clearColorCVar.Get());
+			const auto channel = [&](uint32_t shift) {
+				return static_cast<float>((rgb >> shift) & 0xFF)
+				       / 255.0f;
+			};
+			SetClearColor(channel(16), channel(8), channel(0),
+			              1.0f);
+		}
+		if (multiDrawIndirectCVar.Changed(
+		        m_cvarVersions.multiDrawIndirect))
+		{
+			SetMultiDrawIndirectEnabled(
+			    multiDrawIndirectCVar.Get()
+			    && m_multiDrawIndirectSupported);
+		}
+		if (gpuCullingCVar.Changed(m_cvarVersions.gpuCulling))
+		{
+			SetGpuCullingEnabled(gpuCullingCVar.Get()
+			                     && m_multiDrawIndirectSupported);
+		}
+		if (lodBiasCVar.Changed(m_cvarVersions.lodBias))
+		{
+			m_gpuCulling.SetLodBias(lodBiasCVar.Get());
+		}
+	}
+
+	void RenderManager::SetCullingView(
+	    const float viewProjection[16])
+	{
+		auto& view = m_cullingViews[m_recordFrame];
+		std::copy_n(viewProjection, 16, view.viewProjection);
+		view.set = true;
 	}
 
-	void RenderManager::Submit(
-	    std::unique_ptr<
-	        Graphics::RenderCommands::RenderCommand>
-	        renderCommand)
+	void RenderManager::SetOcclusionDepth(
+	    uint32_t depthTexture, int width, int height)
 	{
-		m_renderCommands.push(std::move(renderCommand));
+		m_gpuCulling.SetOcclusionDepth(depthTexture, width,
+		                               height);
 	}
 
 	void RenderManager::Flush()
 	{
-		while (!m_renderCommands.empty())
+		VEGAM_PROFILE_SCOPE("RenderManager::Flush");
+		if (!m_renderThreadEnabled)
+		{
+			LateLatch();
+			CopyRetainedLists();
+			Execute(m_recordFrame);
+		}
+	}
+
+	void RenderManager::SetRenderThreadEnabled(bool enabled)
+	{
+		VEGAM_ASSERT(GetMainList().GetEntries().empty(),
+		             "Switching render thread mode with "
+		             "unflushed render commands!");
+		m_renderThreadEnabled = enabled;
+		m_recordFrame = 0;
+		m_executeFrame = 0;
+	}
+
+	void RenderManager::SwapFrames()
+	{
+		LateLatch();
+		CopyRetainedLists();
+		m_executeFrame = m_recordFrame;
+		m_recordFrame = (m_recordFrame + 1) % FrameCount;
+	}
+
+	void RenderManager::ExecuteFrame()
+	{
+		Execute(m_executeFrame);
+	}
+
+	void RenderManager::EndFrame()
+	{
+		Graphics::RenderStats stats;
+		stats.drawCalls = m_renderState.GetDrawCalls();
+		stats.triangles = m_renderState.GetTriangles();
+		stats.stateChanges = m_renderState.GetStateChanges();
+		stats.skippedChanges =
+		    m_renderState.GetSkippedChanges();
+		stats.uniformUploads =
+		    Graphics::Shader::TakeUniformUploads();
+		stats.constantBytes = m_constantBytes;
+		Graphics::GLCallCounter::EndFrame();
+		const auto glCalls =
+		    Graphics::GLCallCounter::GetFrameTotals();
+		stats.glCalls = glCalls.calls;
+		stats.glMilliseconds = glCalls.milliseconds;
+
+		m_renderState.ResetCounters();
+		m_constantBytes = 0;
+		m_retainedGathered = false;
+
+		{
+			std::lock_guard lock(m_statsMutex);
+			m_frameStats = stats;
+		}
+
+		if (m_gpuCullingEnabled)
+		{
+			m_gpuCulling.BuildDepthPyramid();
+		}
+
+		Graphics::GpuResources::EndFrame();
+		Graphics::GpuMemory::EndFrame();
+		Graphics::RetireQueue::EndFrame();
+		WaitForFramesInFlight();
+	}
+
+	void RenderManager::SetMaxFramesInFlight(uint32_t frames)
+	{
+		DeleteFrameFences();
+		m_maxFramesInFlight =
+		    std::min(frames, MaxFramesInFlight);
+		m_frameFence = 0;
+	}
+
+	// Fences the frame, then waits for the oldest fenced
+	// frame to finish so at most m_maxFramesInFlight are
+	// queued. Without this the driver may buffer several
+	// frames, adding their time to the input latency.
+	void RenderManager::WaitForFramesInFlight()
+	{
+		if (m_maxFramesInFlight == 0)
+		{
+			return;
+		}
+
+		m_frameFences[m_frameFence] =
+		    glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		VEGAM_CHECK_GL_ERROR;
+		m_frameFence = (m_frameFence + 1) % m_maxFramesInFlight;
+
+		auto& fence = m_frameFences[m_frameFence];
+		if (!fence)
+		{
+			return;
+		}
+
+		VEGAM_PROFILE_SCOPE(
+		    "RenderManager::WaitForFramesInFlight");
+		auto result = glClientWaitSync(
+		    fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+		    FrameFenceTimeout);
+		if (result == GL_TIMEOUT_EXPIRED
+		    || result == GL_WAIT_FAILED)
+		{
+			VEGAM_WARN("Frame fence wait failed");
+		}
+		glDeleteSync(fence);
+		VEGAM_CHECK_GL_ERROR;
+		fence = nullptr;
+	}
+
+	void RenderManager::DeleteFrameFences()
+	{
+		for (auto& fence : m_frameFences)
+		{
+			if (fence)
+			{
+				glDeleteSync(fence);
+				VEGAM_CHECK_GL_ERROR;
+				fence = nullptr;
+			}
+		}
+	}
+
+	Graphics::RenderStats RenderManager::GetFrameStats() const
+	{
+		std::lock_guard lock(m_statsMutex);
+		return m_frameStats;
+	}
+
+	void RenderManager::Execute(uint32_t frame)
+	{
+		VEGAM_PROFILE_SCOPE("RenderManager::Execute");
+		VEGAM_PROFILE_GPU_SCOPE("RenderManager::Execute");
+		ApplyCVars();
+		GatherLists(frame);
+#ifndef AV_CONFIG_SHIPPING
+		CaptureFlush();
+#endif // AV_CONFIG_SHIPPING
+		SortEntries();
+		MergeInstances();
+		auto& cullingView = m_cullingViews[frame];
+		m_cullingView = m_gpuCullingEnabled && cullingView.set
+		                    ? &cullingView
+		                    : nullptr;
+		if (m_multiDrawIndirectEnabled)
+		{
+			BuildIndirectBatches();
+		}
+		UploadInstances();
+		UploadConstants();
+		if (m_cullingView && m_cullableDraws > 0)
+		{
+			// Zeroes hidden draws in the uploaded indirect
+			// buffer before any of them executes.
+			std::span<const Graphics::GpuCulling::LodLevels>
+			    lods;
+			if (m_lodDraws > 0)
+			{
+				lods = m_drawLods;
+			}
+			m_gpuCulling.Cull(cullingView.viewProjection,
+			                  m_indirectBuffer,
+			                  m_instanceBuffer, m_drawBounds,
+			                  lods);
+			m_gpuCulling.CullClusters(
+			    cullingView.viewProjection, m_indirectBuffer,
+			    m_instanceBuffer, m_clusterDraws,
+			    m_clusterIndexCount);
+		}
+		cullingView.set = false;
+		m_cullingView = nullptr;
+
+		// ImGui binds programs outside of the cache, so
+		// start every flush from a clean slate.
+		m_renderState.Invalidate();
+		if (m_pipelineWarmup.exchange(false,
+		                              std::memory_order_relaxed))
+		{
+			auto& resources =
+			    Engine::Instance().GetResourceManager();
+			Graphics::PipelineWarmup::Warm(resources.GetShaders(),
+			                               m_renderState);
+		}
+
+		Graphics::RenderCommands::ExecuteContext context{
+		    m_renderState,
+		    Engine::Instance().GetResourceManager(),
+		    m_instanceBuffer,
+		    m_indirectBuffer,
+		    m_constantRing ? m_constantRing->GetId() : 0u,
+		    0,
+		    0,
+		    m_indirectDraws.data()};
+
+		using DepthPrepass = Graphics::RenderState::DepthPrepass;
+		const auto prepass =
+		    depthPrepassCVar.Get()
+		    && ExecuteDepthPrepass(context);
+		if (prepass)
+		{
+			m_renderState.SetDepthPrepass(DepthPrepass::Shade);
+		}
+
+		uint32_t viewport = 0;
+		// Viewport and layer of the weighted OIT run drawing,
+		// begun or skipped.
+		auto oitRun = NoOitRun;
+		auto skipOit = false;
+		for (const auto& entry : m_sortEntries)
+		{
+			if (entry.offset == MergedEntry)
+			{
+				continue;
+			}
+
+			// A run composites before anything draws over
+			// it, and before another viewport binds its
+			// framebuffer.
+			const auto oit =
+			    Graphics::SortKey::IsWeightedOit(entry.key);
+			const auto run =
+			    entry.key >> Graphics::SortKey::LayerShift;
+			if (oitRun != NoOitRun && (!oit || run != oitRun))
+			{
+				if (m_weightedOit.IsActive())
+				{
+					m_weightedOit.Composite(m_renderState);
+				}
+				oitRun = NoOitRun;
+			}
+
+			const auto entryViewport =
+			    Graphics::SortKey::GetViewport(entry.key);
+			if (entryViewport != viewport && m_viewportBinder)
+			{
+				m_viewportBinder(entryViewport);
+				viewport = entryViewport;
+				// Only the main viewport has a pre-pass.
+				if (prepass)
+				{
+					m_renderState.SetDepthPrepass(
+					    viewport == 0 ? DepthPrepass::Shade
+					                  : DepthPrepass::Off);
+				}
+			}
+
+			if (oit && oitRun == NoOitRun)
+			{
+				oitRun = run;
+				skipOit = !BeginWeightedOit();
+			}
+			if (oit && skipOit)
+			{
+				continue;
+			}
+
+			const auto command = GetCommand(entry);
+			context.instanceBase = command.instanceBase;
+			context.constantBase =
+			    m_constantRingOffset + command.constantBase;
+			Graphics::RenderCommands::Execute(
+			    command.type, command.payload, context);
+		}
+		if (m_weightedOit.IsActive())
+		{
+			m_weightedOit.Composite(m_renderState);
+		}
+
+		if (viewport != 0)
+		{
+			m_viewportBinder(0);
+		}
+		m_renderState.SetDepthPrepass(DepthPrepass::Off);
+		m_renderState.UseProgram(0);
+		m_renderState.BindVertexArray(0);
+		// Leaves GL as Initialize() set it up.
+		m_renderState.SetPipelineState(
+		    Graphics::PipelineState{});
+
+		{
+			std::lock_guard lock(m_listsMutex);
+			for (auto& lists : m_lists)
+			{
+				(*lists)[frame].Reset();
+			}
+		}
+		m_flushCommands.Reset();
+		m_sortEntries.clear();
+		m_instanceData.clear();
+		m_drawData.clear();
+		m_constantData.clear();
+		m_indirectDraws.clear();
+		m_drawMaterials.clear();
+		m_drawBounds.clear();
+		m_cullableDraws = 0;
+		m_drawLods.clear();
+		m_lodDraws = 0;
+		m_clusterDraws.clear();
+		m_clusterIndexCount = 0;
+	}
+
+	void RenderManager::ExecuteOrdered(
+	    const Graphics::CommandBuffer& commands,
+	    std::span<const uint32_t> offsets)
+	{
+		// Other GL work may have run since the last flush.
+		m_renderState.Invalidate();
+		Graphics::RenderCommands::ExecuteContext context{
+		    m_renderState,
+		    Engine::Instance().GetResourceManager(),
+		    m_instanceBuffer,
+		    m_indirectBuffer,
+		    0u,
+		    0,
+		    0,
+		    nullptr};
+		for (const auto offset : offsets)
+		{
+			Graphics::RenderCommands::Execute(
+			    commands.GetType(offset),
+			    commands.GetPayload(offset), context);
+		}
+	}
+
+	RenderManager::CommandRef
+	RenderManager::GetCommand(const SortEntry& entry) const
+	{
+		if (entry.list == FlushList)
+		{
+			return {m_flushCommands.GetType(entry.offset),
+			        m_flushCommands.GetPayload(entry.offset),
+			        0, 0};
+		}
+
+		const auto& commands =
+		    m_gatheredLists[entry.list]->GetCommands();
+		return {commands.GetType(entry.offset),
+		        commands.GetPayload(entry.offset),
+		        m_listInstanceBase[entry.list],
+		        m_listConstantBase[entry.list]};
+	}
+
+	namespace
+	{
+		inline size_t AlignConstants(size_t size)
+		{
+			constexpr size_t alignment = Graphics::
+			    RenderCommands::ConstantsAlignment;
+			return (size + alignment - 1) & ~(alignment - 1);
+		}
+
+		// Material draws sort by their pipeline state, and
+		// by their material's shader when they have none.
+		// Submitting threads can't read materials, so keys
+		// are finished here.
+		uint64_t
+		ApplyMaterial(uint64_t key,
+		              Graphics::RenderCommands::CommandType type,
+		              const void* payload,
+		              const Graphics::MaterialTable& materials)
+		{
+			using namespace Graphics::RenderCommands;
+
+			Graphics::ShaderHandle shader;
+			Graphics::MaterialHandle material;
+			if (type == CommandType::RenderMesh)
+			{
+				auto* command =
+				    static_cast<const RenderMesh*>(payload);
+				shader = command->shader;
+				material = command->material;
+			}
+			else if (type == CommandType::RenderMeshInstanced)
+			{
+				auto* command =
+				    static_cast<const RenderMeshInstanced*>(
+				        payload);
+				shader = command->shader;
+				material = command->material;
+			}
+			if (!materials.Contains(material))
+			{
+				return key;
+			}
+			materials.MarkUsed(material);
+
+			const auto stateId = materials.GetStateId(material);
+			using Graphics::BlendMode;
+			const auto blend = materials.GetState(stateId).blend;
+			key = blend == BlendMode::WeightedOit
+			          ? Graphics::SortKey::WithWeightedOit(key)
+			          : Graphics::SortKey::WithTranslucent(
+			                key, blend != BlendMode::Opaque);
+			key = Graphics::SortKey::WithState(key, stateId);
+			if (!shader.IsValid())
+			{
+				key = Graphics::SortKey::WithShader(
+				    key, materials.ResolveShader(shader, material)
+				             .GetIndex());
+			}
+			return key;
+		}
+
+		// Where the mesh's bounds center lands in the view's
+		// clip depth, for RenderMesh commands with a
+		// transform and RenderMeshInstanced, by their first
+		// instance; -1 for other commands.
+		float GetDrawDepth(
+		    Graphics::RenderCommands::CommandType type,
+		    const void* payload,
+		    const Graphics::CommandList& list,
+		    const Managers::ResourceManager& resources,
+		    const float viewProjection[16])
+		{
+			using namespace Graphics::RenderCommands;
+
+			Graphics::MeshHandle mesh;
+			uint32_t instance = NoInstance;
+			if (type == CommandType::RenderMesh)
+			{
+				auto* command =
+				    static_cast<const RenderMesh*>(payload);
+				mesh = command->mesh;
+				instance = command->instance;
+			}
+			else if (type == CommandType::RenderMeshInstanced)
+			{
+				auto* command =
+				    static_cast<const RenderMeshInstanced*>(
+				        payload);
+				mesh = command->mesh;
+				instance = command->instanceCount > 0
+				               ? command->firstInstance
+				               : NoInstance;
+			}
+			if (instance == NoInstance
+			    || instance >= list.GetInstances().size())
+			{
+				return -1.0f;
+			}
+
+			Graphics::Float3 center{0.0f, 0.0f, 0.0f};
+			if (auto* data = resources.GetMesh(mesh))
+			{
+				const auto sphere = data->GetBounds().GetSphere();
+				if (std::isfinite(sphere.radius))
+				{
+					center = sphere.center;
+				}
+			}
+			const auto* m = list.GetInstances()[instance].m;
+			const auto* vp = viewProjection;
+			float world[3];
+			for (int i = 0; i < 3; ++i)
+			{
+				world[i] = m[i] * center.x + m[4 + i] * center.y
+				           + m[8 + i] * center.z + m[12 + i];
+			}
+			const auto clip = [&](int row) {
+				return vp[row] * world[0] + vp[4 + row] * world[1]
+				       + vp[8 + row] * world[2] + vp[12 + row];
+			};
+			const auto w = clip(3);
+			if (w <= 0.0f)
+			{
+				// Behind the camera; nearest is as good as any.
+				return 0.0f;
+			}
+			return std::clamp(clip(2) / w * 0.5f + 0.5f, 0.0f,
+			                  1.0f);
+		}
+
+		// Opaque keys front to back, translucent ones back
+		// to front; weighted OIT ones in no order.
+		uint64_t ApplyDepth(uint64_t key, float depth)
+		{
+			if (depth < 0.0f
+			    || Graphics::SortKey::IsWeightedOit(key))
+			{
+				return key;
+			}
+			if (Graphics::SortKey::IsTranslucent(key))
+			{
+				depth = 1.0f - depth;
+			}
+			return Graphics::SortKey::WithDepth(
+			    key, Graphics::SortKey::QuantizeDepth(depth));
+		}
+
+		// The state a command draws with.
+		Graphics::PipelineState
+		GetDrawState(Graphics::RenderCommands::CommandType type,
+		             const void* payload,
+		             const Graphics::MaterialTable& materials)
+		{
+			using namespace Graphics::RenderCommands;
+
+			Graphics::MaterialHandle material;
+			if (type == CommandType::RenderMesh)
+			{
+				material = static_cast<const RenderMesh*>(payload)
+				               ->material;
+			}
+			else if (type == CommandType::RenderMeshInstanced)
+			{
+				material = static_cast<const RenderMeshInstanced*>(
+				               payload)
+				               ->material;
+			}
+			else if (type == CommandType::MultiDrawIndirect)
+			{
+				auto* command =
+				    static_cast<const MultiDrawIndirect*>(payload);
+				if (command->materials)
+				{
+					return materials.GetState(
+					    command->pipelineState);
+				}
+			}
+			if (!materials.Contains(material))
+			{
+				return {};
+			}
+			return materials.GetState(
+			    materials.GetStateId(material));
+		}
+
+		// Draws are never merged across viewports.
+		inline bool SameViewport(uint64_t a, uint64_t b)
+		{
+			return Graphics::SortKey::GetViewport(a)
+			       == Graphics::SortKey::GetViewport(b);
+		}
+
+		// Returns constants addressing the combined
+		// constant data instead of the command's list.
+		inline Graphics::RenderCommands::Constants
+		RebaseConstants(
+		    Graphics::RenderCommands::Constants constants,
+		    uint32_t constantBase)
+		{
+			if (constants.offset
+			    != Graphics::RenderCommands::NoConstants)
+			{
+				constants.offset += constantBase;
+			}
+			return constants;
+		}
+	} // namespace
+
+	bool RenderManager::BeginWeightedOit()
+	{
+		if (!m_weightedOit.IsInitialized())
+		{
+			if (m_weightedOitUnavailable)
+			{
+				return false;
+			}
+			if (!m_weightedOit.Initialize())
+			{
+				// Drawn into the framebuffer they would only
+				// show their targets' blending.
+				VEGAM_WARN("Skipping weighted OIT draws");
+				m_weightedOitUnavailable = true;
+				return false;
+			}
+		}
+		return m_weightedOit.Begin();
+	}
+
+	bool RenderManager::ExecuteDepthPrepass(
+	    Graphics::RenderCommands::ExecuteContext& context)
+	{
+		VEGAM_PROFILE_SCOPE("RenderManager::DepthPrepass");
+		VEGAM_PROFILE_GPU_SCOPE("RenderManager::DepthPrepass");
+		const auto& materials = context.resources.GetMaterialTable();
+
+		auto any = false;
+		for (const auto& entry : m_sortEntries)
+		{
+			if (entry.offset == MergedEntry
+			    || Graphics::SortKey::GetViewport(entry.key) != 0
+			    || Graphics::SortKey::IsTranslucent(entry.key))
+			{
+				continue;
+			}
+			const auto command = GetCommand(entry);
+			if (Graphics::RenderCommands::IsDispatch(
+			        command.type)
+			    || !Graphics::RenderState::WritesOpaqueDepth(
+			        GetDrawState(command.type, command.payload,
+			                     materials)))
+			{
+				continue;
+			}
+
+			if (!any)
+			{
+				m_renderState.SetDepthPrepass(
+				    Graphics::RenderState::DepthPrepass::Depth);
+				any = true;
+			}
+			context.instanceBase = command.instanceBase;
+			context.constantBase =
+			    m_constantRingOffset + command.constantBase;
+			Graphics::RenderCommands::Execute(
+			    command.type, command.payload, context);
+		}
+		if (any)
+		{
+			m_renderState.SetDepthPrepass(
+			    Graphics::RenderState::DepthPrepass::Off);
+		}
+		return any;
+	}
+
+	// Concatenates every thread's entries, instance data and
+	// constants so they can be sorted and uploaded together.
+#ifndef AV_CONFIG_SHIPPING
+	// Before merging rewrites the commands.
+	void RenderManager::CaptureFlush()
+	{
+		namespace FrameCapture = Graphics::FrameCapture;
+		if (!FrameCapture::IsRecording())
+		{
+			return;
+		}
+		const auto& resources =
+		    Engine::Instance().GetResourceManager();
+		FrameCapture::BeginFlush(m_gatheredLists);
+		for (const auto& entry : m_sortEntries)
+		{
+			const auto command = GetCommand(entry);
+			FrameCapture::AddCommand(entry.list, entry.key,
+			                         command.type,
+			                         command.payload, resources);
+		}
+		FrameCapture::EndFlush(resources);
+	}
+#endif // AV_CONFIG_SHIPPING
+
+	void RenderManager::GatherLists(uint32_t frame)
+	{
+		m_sortEntries.clear();
+		m_instanceData.clear();
+		m_drawData.clear();
+		m_constantData.clear();
+		m_gatheredLists.clear();
+
+		const auto& resources =
+		    Engine::Instance().GetResourceManager();
+		const auto& materials = resources.GetMaterialTable();
+		const auto& view = m_cullingViews[frame];
+		const auto depthSort = depthSortCVar.Get() && view.set;
+
+		// Threads may register new lists while the render
+		// thread executes, so keep our own view of them.
+		std::lock_guard lock(m_listsMutex);
+		for (const auto& lists : m_lists)
+		{
+			m_gatheredLists.push_back(&(*lists)[frame]);
+		}
+		if (!m_retainedGathered)
+		{
+			for (const auto& copy : m_retained)
+			{
+				if (copy->list)
+				{
+					m_gatheredLists.push_back(
+					    &copy->frames[frame]);
+				}
+			}
+			m_retainedGathered = true;
+		}
+		m_listInstanceBase.resize(m_gatheredLists.size());
+		m_listConstantBase.resize(m_gatheredLists.size());
+
+		for (uint32_t i = 0; i < m_gatheredLists.size(); ++i)
+		{
+			const auto& list = *m_gatheredLists[i];
+			m_listInstanceBase[i] =
+			    static_cast<uint32_t>(m_instanceData.size());
+			m_instanceData.insert(m_instanceData.end(),
+			                      list.GetInstances().begin(),
+			                      list.GetInstances().end());
+			m_drawData.insert(m_drawData.end(),
+			                  list.GetDrawData().begin(),
+			                  list.GetDrawData().end());
+
+			// Keep each list's pushes aligned.
+			const auto& constants = list.GetConstants();
+			const auto constantBase = static_cast<uint32_t>(
+			    AlignConstants(m_constantData.size()));
+			m_listConstantBase[i] = constantBase;
+			if (!constants.empty())
+			{
+				m_constantData.resize(constantBase);
+				m_constantData.insert(m_constantData.end(),
+				                      constants.begin(),
+				                      constants.end());
+			}
+			const auto& commands = list.GetCommands();
+			for (const auto& entry : list.GetEntries())
+			{
+				const auto type = commands.GetType(entry.offset);
+				const auto* payload =
+				    commands.GetPayload(entry.offset);
+				auto key = ApplyMaterial(entry.key, type, payload,
+				                         materials);
+				if (depthSort)
+				{
+					key = ApplyDepth(
+					    key, GetDrawDepth(type, payload, list,
+					                      resources,
+					                      view.viewProjection));
+				}
+				const auto index =
+				    static_cast<uint32_t>(m_sortEntries.size());
+				m_sortEntries.push_back(
+				    {key, entry.offset, i, index});
+			}
+		}
+	}
+
+	// Collapses runs of sorted RenderMesh commands that share
+	// a mesh and shader and carry a transform into single
+	// RenderMeshInstanced draws. The run's transforms are
+	// gathered to the end of the instance data so they are
+	// contiguous.
+	void RenderManager::MergeInstances()
+	{
+		using namespace Graphics::RenderCommands;
+
+		// Returns the command with its instance index
+		// rebased onto the combined instance data.
+		const auto asInstancedMesh =
+		    [this](const SortEntry& entry, RenderMesh& out)
+		{
+			if (entry.offset == MergedEntry)
+			{
+				return false;
+			}
+			const auto command = GetCommand(entry);
+			if (command.type != CommandType::RenderMesh)
+			{
+				return false;
+			}
+			out = *static_cast<const RenderMesh*>(
+			    command.payload);
+			out.instance += command.instanceBase;
+			out.constants = RebaseConstants(
+			    out.constants, command.constantBase);
+			return static_cast<const RenderMesh*>(
+			           command.payload)
+			           ->instance
+			       != NoInstance;
+		};
+
+		const auto count = m_sortEntries.size();
+		RenderMesh head;
+		RenderMesh next;
+		for (size_t i = 0; i < count;)
+		{
+			if (!asInstancedMesh(m_sortEntries[i], head))
+			{
+				++i;
+				continue;
+			}
+
+			auto end = i + 1;
+			while (end < count
+			       && SameViewport(m_sortEntries[i].key,
+			                       m_sortEntries[end].key)
+			       && asInstancedMesh(m_sortEntries[end], next)
+			       && next.mesh == head.mesh
+			       && next.shader == head.shader
+			       && next.constants == head.constants
+			       && next.material == head.material)
+			{
+				++end;
+			}
+
+			auto firstInstance = head.instance;
+			if (end - i > 1)
+			{
+				firstInstance = static_cast<uint32_t>(
+				    m_instanceData.size());
+				for (auto j = i; j < end; ++j)
+				{
+					asInstancedMesh(m_sortEntries[j], next);
+					// Copy first, push_back may reallocate.
+					const auto transform =
+					    m_instanceData[next.instance];
+					const auto drawData =
+					    m_drawData[next.instance];
+					m_instanceData.push_back(transform);
+					m_drawData.push_back(drawData);
+				}
+			}
+
+			m_sortEntries[i].offset =
+			    m_flushCommands.Push(RenderMeshInstanced{
+			        head.mesh, head.shader, firstInstance,
+			        static_cast<uint32_t>(end - i),
+			        head.constants, head.material});
+			m_sortEntries[i].list = FlushList;
+			for (auto j = i + 1; j < end; ++j)
+			{
+				m_sortEntries[j].offset = MergedEntry;
+			}
+
+			i = end;
+		}
+	}
+
+	// Replaces runs of sorted indexed draws from the same
+	// mesh arena and shader with a single multi-draw. Each
+	// draw of the run becomes one entry of the frame's
+	// indirect buffer, and its material index the same
+	// entry of the draw materials.
+	void RenderManager::BuildIndirectBatches()
+	{
+		using namespace Graphics::RenderCommands;
+
+		struct Draw
+		{
+			Graphics::ShaderHandle shader;
+			uint32_t vao = 0;
+			Graphics::IndexType indexType =
+			    Graphics::IndexType::UInt32;
+			DrawElementsIndirect indirect{};
+			bool instanced = false;
+			Constants constants;
+			Graphics::MaterialHandle material;
+			uint32_t textureSet =
+			    Graphics::MaterialTable::NoTextureSet;
+			uint32_t state =
+			    Graphics::MaterialTable::DefaultState;
+			Constants materialConstants;
+			Graphics::Float4 bounds =
+			    Graphics::GpuCulling::NeverCull;
+			Graphics::GpuCulling::LodLevels lods{};
+			// Of draws culled by meshlet, which read the
+			// cluster indices through indexBuffer.
+			Graphics::GpuCulling::ClusterDraw cluster;
+			uint32_t indexBuffer = 0;
+		};
+
+		const auto& resources =
+		    Engine::Instance().GetResourceManager();
+		const auto& materials = resources.GetMaterialTable();
+
+		// Levels the GPU can swap in: ready, non-empty and
+		// from the same arena, up to the first that isn't.
+		const auto gatherLods = [&](const Graphics::Mesh& mesh,
+		                            Draw& draw)
+		{
+			auto& levels = draw.lods;
+			levels = {};
+			levels.counts[0] = draw.indirect.count;
+			levels.firstIndices[0] = draw.indirect.firstIndex;
+			levels.baseVertices[0] = draw.indirect.baseVertex;
+
+			const auto& chain = mesh.GetLods();
+			for (uint32_t i = 0; i < chain.count; ++i)
+			{
+				auto* level = resources.GetMesh(chain.meshes[i]);
+				if (!level || !level->IsReady()
+				    || level->GetArena() != mesh.GetArena()
+				    || level->GetIndexType()
+				           != mesh.GetIndexType()
+				    || level->GetElementCount() == 0)
+				{
+					break;
+				}
+				levels.counts[i + 1] = level->GetElementCount();
+				levels.firstIndices[i + 1] =
+				    level->GetFirstIndex();
+				levels.baseVertices[i + 1] =
+				    static_cast<int32_t>(level->GetBaseVertex());
+				levels.thresholds[i] = chain.thresholds[i];
+			}
+		};
+
+		const auto asArenaDraw = [&](const SortEntry& entry,
+		                             Draw& draw)
+		{
+			if (entry.offset == MergedEntry)
+			{
+				return false;
+			}
+
+			const auto command = GetCommand(entry);
+			const auto type = command.type;
+			const auto* payload = command.payload;
+
+			Graphics::MeshHandle meshHandle;
+			draw.indirect.instanceCount = 1;
+			draw.indirect.baseInstance = 0;
+			draw.instanced = false;
+
+			if (type == CommandType::RenderMesh)
+			{
+				auto* single =
+				    static_cast<const RenderMesh*>(payload);
+				meshHandle = single->mesh;
+				draw.shader = materials.ResolveShader(
+				    single->shader, single->material);
+				draw.constants = RebaseConstants(
+				    single->constants, command.constantBase);
+				draw.material = single->material;
+			}
+			else if (type == CommandType::RenderMeshInstanced)
+			{
+				auto* instanced =
+				    static_cast<const RenderMeshInstanced*>(
+				        payload);
+				meshHandle = instanced->mesh;
+				draw.shader = materials.ResolveShader(
+				    instanced->shader, instanced->material);
+				draw.constants =
+				    RebaseConstants(instanced->constants,
+				                    command.constantBase);
+				draw.indirect.instanceCount =
+				    instanced->instanceCount;
+				draw.indirect.baseInstance =
+				    command.instanceBase
+				    + instanced->firstInstance;
+				draw.instanced = true;
+				draw.material = instanced->material;
+			}
+			else
+			{
+				return false;
+			}
+
+			// Pending meshes and shaders are left to the
+			// single draw path, which skips or substitutes.
+			auto* mesh = resources.GetMesh(meshHandle);
+			auto* shader = resources.GetShader(draw.shader);
+			if (!mesh || !mesh->GetArena()
+			    || !mesh->IsReady()
+			    || mesh->GetElementCount() == 0 || !shader
+			    || !shader->IsReady())
+			{
+				return false;
+			}
+
+			// Materials are found through gl_DrawID; stale
+			// ones are left to the single draw path to skip.
+			draw.textureSet =
+			    materials.GetTextureSet(draw.material);
+			draw.state = materials.GetStateId(draw.material);
+			draw.materialConstants =
+			    materials.GetConstants(draw.material);
+			if (draw.material.IsValid()
+			    && (!materials.CanBatch()
+			        || !materials.Contains(draw.material)))
+			{
+				return false;
+			}
+
+			draw.vao = mesh->GetId();
+			draw.indexType = mesh->GetIndexType();
+			draw.indirect.count = mesh->GetElementCount();
+			draw.indirect.firstIndex = mesh->GetFirstIndex();
+			draw.indirect.baseVertex =
+			    static_cast<int32_t>(mesh->GetBaseVertex());
+
+			// Only instance transforms place a mesh where the
+			// GPU can see it.
+			draw.bounds = Graphics::GpuCulling::NeverCull;
+			if (m_cullingView && draw.instanced
+			    && Graphics::SortKey::GetViewport(entry.key)
+			           == 0)
+			{
+				const auto sphere =
+				    mesh->GetBounds().GetSphere();
+				if (std::isfinite(sphere.radius))
+				{
+					draw.bounds = {sphere.center.x,
+					               sphere.center.y,
+					               sphere.center.z,
+					               sphere.radius};
+				}
+			}
+			// Meshes split into meshlets are culled by
+			// meshlet instead of swapping levels.
+			draw.cluster = {};
+			draw.indexBuffer = 0;
+			if (draw.bounds.w >= 0.0f
+			    && mesh->GetMeshletCount() > 0)
+			{
+				auto& cluster = draw.cluster;
+				cluster.meshletBuffer = mesh->GetMeshletBuffer();
+				cluster.meshletCount = mesh->GetMeshletCount();
+				cluster.indexBuffer =
+				    mesh->GetArena()->GetIndexBuffer();
+				cluster.firstIndex = mesh->GetFirstIndex();
+				cluster.shortIndices =
+				    draw.indexType == Graphics::IndexType::UInt16;
+				cluster.backFaceCulling =
+				    materials.GetState(draw.state).cull
+				    == Graphics::CullMode::Back;
+				draw.indexBuffer =
+				    m_gpuCulling.GetClusterIndexBuffer();
+				draw.indexType = Graphics::IndexType::UInt32;
+			}
+			draw.lods = {};
+			if (draw.bounds.w >= 0.0f && draw.indexBuffer == 0
+			    && mesh->GetLods().count > 0)
+			{
+				gatherLods(*mesh, draw);
+			}
+			return true;
+		};
+
+		const auto pushDraw = [this](const Draw& draw)
 		{
-			auto rc = std::move(m_renderCommands.front());
-			m_renderCommands.pop();
+			auto indirect = draw.indirect;
+			if (draw.indexBuffer != 0)
+			{
+				// Its slice of the cluster indices.
+				auto cluster = draw.cluster;
+				cluster.draw =
+				    static_cast<uint32_t>(m_indirectDraws.size());
+				m_clusterDraws.push_back(cluster);
+				indirect.firstIndex = m_clusterIndexCount;
+				m_clusterIndexCount += indirect.count;
+			}
+			m_indirectDraws.push_back(indirect);
+			m_drawMaterials.push_back(draw.material.GetIndex());
+			if (m_cullingView)
+			{
+				m_drawBounds.push_back(draw.bounds);
+				m_cullableDraws += draw.bounds.w >= 0.0f;
+				m_drawLods.push_back(draw.lods);
+				m_lodDraws += draw.lods.thresholds[0] > 0.0f;
+			}
+		};
 
-			rc->Execute();
+		const auto count = m_sortEntries.size();
+		Draw head;
+		Draw next;
+		for (size_t i = 0; i < count;)
+		{
+			if (!asArenaDraw(m_sortEntries[i], head))
+			{
+				++i;
+				continue;
+			}
+
+			const auto firstDraw =
+			    static_cast<uint32_t>(m_indirectDraws.size());
+			pushDraw(head);
+			auto instanced = head.instanced;
+
+			auto end = i + 1;
+			while (end < count
+			       && SameViewport(m_sortEntries[i].key,
+			                       m_sortEntries[end].key)
+			       && asArenaDraw(m_sortEntries[end], next)
+			       && next.shader == head.shader
+			       && next.vao == head.vao
+			       && next.indexBuffer == head.indexBuffer
+			       && next.constants == head.constants
+			       && next.material.IsValid()
+			              == head.material.IsValid()
+			       && next.textureSet == head.textureSet
+			       && next.state == head.state
+			       && next.materialConstants
+			              == head.materialConstants)
+			{
+				pushDraw(next);
+				instanced = instanced || next.instanced;
+				++end;
+			}
+
+			// Not worth a multi-draw, unless the single draw
+			// path can't draw it.
+			if (end - i == 1 && head.indexBuffer == 0)
+			{
+				m_indirectDraws.pop_back();
+				m_drawMaterials.pop_back();
+				if (m_cullingView)
+				{
+					m_cullableDraws -=
+					    m_drawBounds.back().w >= 0.0f;
+					m_drawBounds.pop_back();
+					m_lodDraws -=
+					    m_drawLods.back().thresholds[0] > 0.0f;
+					m_drawLods.pop_back();
+				}
+				++i;
+				continue;
+			}
+
+			m_sortEntries[i].offset =
+			    m_flushCommands.Push(MultiDrawIndirect{
+			        head.shader, head.vao, firstDraw,
+			        static_cast<uint32_t>(end - i),
+			        head.indexType, instanced,
+			        head.constants, head.material.IsValid(),
+			        head.textureSet, head.state,
+			        head.materialConstants, head.indexBuffer,
+			        head.cluster.indexBuffer});
+			m_sortEntries[i].list = FlushList;
+			for (auto j = i + 1; j < end; ++j)
+			{
+				m_sortEntries[j].offset = MergedEntry;
+			}
+
+			i = end;
+		}
+	}
+
+	namespace
+	{
+		// Uploads a frame's worth of data into a stream
+		// buffer, orphaning last frame's storage so the
+		// upload doesn't wait on draws still reading it.
+		void UploadStream(GLenum target, uint32_t buffer,
+		                  size_t& capacity, const void* data,
+		                  size_t size)
+		{
+			glBindBuffer(target, buffer);
+			VEGAM_CHECK_GL_ERROR;
+			if (size > capacity)
+			{
+				capacity = size * 2;
+			}
+			glBufferData(target, capacity, nullptr,
+			             GL_STREAM_DRAW);
+			VEGAM_CHECK_GL_ERROR;
+			Graphics::GpuResources::Resize(
+			    Graphics::GpuResources::Type::Buffer, buffer,
+			    capacity);
+			glBufferSubData(target, 0, size, data);
+			VEGAM_CHECK_GL_ERROR;
+			glBindBuffer(target, 0);
+			VEGAM_CHECK_GL_ERROR;
+		}
+	} // namespace
+
+	void RenderManager::UploadInstances()
+	{
+		if (!m_instanceData.empty())
+		{
+			UploadStream(GL_ARRAY_BUFFER, m_instanceBuffer,
+			             m_instanceBufferSize,
+			             m_instanceData.data(),
+			             m_instanceData.size()
+			                 * sizeof(m_instanceData[0]));
+		}
+		if (m_drawDataBuffer != 0 && !m_drawData.empty())
+		{
+			UploadStream(GL_SHADER_STORAGE_BUFFER,
+			             m_drawDataBuffer, m_drawDataBufferSize,
+			             m_drawData.data(),
+			             m_drawData.size()
+			                 * sizeof(m_drawData[0]));
+			glBindBufferBase(
+			    GL_SHADER_STORAGE_BUFFER,
+			    Graphics::MaterialTable::DrawDataBinding,
+			    m_drawDataBuffer);
+			VEGAM_CHECK_GL_ERROR;
+		}
+
+		if (!m_indirectDraws.empty())
+		{
+			UploadStream(GL_DRAW_INDIRECT_BUFFER,
+			             m_indirectBuffer,
+			             m_indirectBufferSize,
+			             m_indirectDraws.data(),
+			             m_indirectDraws.size()
+			                 * sizeof(m_indirectDraws[0]));
+			Engine::Instance()
+			    .GetResourceManager()
+			    .GetMaterialTable()
+			    .UploadDrawMaterials(m_drawMaterials);
+		}
+	}
+
+	// The frame's constants go to the next segment of the
+	// ring. It grows when a frame outgrows a segment; the
+	// old buffer lives on until the GPU is done with it.
+	void RenderManager::UploadConstants()
+	{
+		m_constantRingOffset = 0;
+		if (m_constantData.empty())
+		{
+			return;
+		}
+
+		const auto size = m_constantData.size();
+		m_constantBytes += static_cast<uint32_t>(size);
+		if (!m_constantRing
+		    || m_constantRing->GetSegmentSize() < size)
+		{
+			m_constantRing =
+			    std::make_unique<Graphics::StreamBuffer>(
+			        AlignConstants(size * 2));
+		}
+
+		auto* segment = m_constantRing->BeginWrite();
+		std::memcpy(segment, m_constantData.data(), size);
+		m_constantRing->EndWrite();
+		m_constantRingOffset = static_cast<uint32_t>(
+		    m_constantRing->GetSegment()
+		    * m_constantRing->GetSegmentSize());
+	}
+
+	// LSD radix sort on the 64-bit keys, 8 bits per pass.
+	// Passes where every key shares the same digit are
+	// skipped, so keys that only use a few fields are
+	// cheap to sort.
+	// Ordered by key, ties by gathering order. Most draws
+	// are the same as last frame's, gathered the same way,
+	// so the entries are first laid out in last frame's
+	// order; only those then out of order are sorted and
+	// merged back in. With too many, e.g. after a camera cut
+	// under r.depthSort, the whole queue is radix sorted.
+	void RenderManager::SortEntries()
+	{
+		VEGAM_PROFILE_SCOPE("RenderManager::SortEntries");
+		if (m_sortEntries.size() >= 2
+		    && !(coherentSortCVar.Get() && SortCoherent()))
+		{
+			RadixSort();
+		}
+		m_sortOrder.resize(m_sortEntries.size());
+		for (size_t i = 0; i < m_sortEntries.size(); ++i)
+		{
+			m_sortOrder[i] = m_sortEntries[i].index;
+		}
+	}
+
+	bool RenderManager::SortCoherent()
+	{
+		if (m_sortOrder.empty())
+		{
+			return false;
+		}
+		const auto count = m_sortEntries.size();
+		const auto less = [](const SortEntry& a,
+		                     const SortEntry& b) {
+			return a.key < b.key
+			       || (a.key == b.key && a.index < b.index);
+		};
+
+		// Last frame's order, less the entries gone, then
+		// the new ones.
+		m_sortScratch.clear();
+		for (const auto index : m_sortOrder)
+		{
+			if (index < count)
+			{
+				m_sortScratch.push_back(m_sortEntries[index]);
+			}
+		}
+		for (auto i = m_sortOrder.size(); i < count; ++i)
+		{
+			m_sortScratch.push_back(m_sortEntries[i]);
+		}
+
+		// Keeps an ordered run in place. An entry below the
+		// run's end takes that end with it, as either may
+		// be the one that moved.
+		const auto maxStrays = count / MaxSortStrayShare;
+		m_sortStrays.clear();
+		size_t kept = 0;
+		for (const auto& entry : m_sortScratch)
+		{
+			if (kept == 0
+			    || !less(entry, m_sortEntries[kept - 1]))
+			{
+				m_sortEntries[kept++] = entry;
+				continue;
+			}
+			m_sortStrays.push_back(m_sortEntries[--kept]);
+			m_sortStrays.push_back(entry);
+			if (m_sortStrays.size() > maxStrays)
+			{
+				// Back to gathering order for the radix
+				// sort, which is stable.
+				for (const auto& scattered : m_sortScratch)
+				{
+					m_sortEntries[scattered.index] = scattered;
+				}
+				return false;
+			}
+		}
+
+		std::sort(m_sortStrays.begin(), m_sortStrays.end(),
+		          less);
+		m_sortScratch.resize(count);
+		std::merge(m_sortEntries.begin(),
+		           m_sortEntries.begin() + kept,
+		           m_sortStrays.begin(), m_sortStrays.end(),
+		           m_sortScratch.begin(), less);
+		m_sortEntries.swap(m_sortScratch);
+		return true;
+	}
+
+	void RenderManager::RadixSort()
+	{
+		const auto count = m_sortEntries.size();
+		m_sortScratch.resize(count);
+		auto* src = m_sortEntries.data();
+		auto* dst = m_sortScratch.data();
+
+		for (uint32_t shift = 0; shift < 64; shift += 8)
+		{
+			std::array<uint32_t, 256> histogram{};
+			for (size_t i = 0; i < count; ++i)
+			{
+				++histogram[(src[i].key >> shift) & 0xFF];
+			}
+
+			const auto firstDigit =
+			    (src[0].key >> shift) & 0xFF;
+			if (histogram[firstDigit] == count)
+			{
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (auto& bucket : histogram)
+			{
+				auto bucketCount = bucket;
+				bucket = offset;
+				offset += bucketCount;
+			}
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				dst[histogram[(src[i].key >> shift)
+				              & 0xFF]++] = src[i];
+			}
+
+			std::swap(src, dst);
+		}
+
+		if (src != m_sortEntries.data())
+		{
+			m_sortEntries.swap(m_sortScratch);
 		}
 	}
 } // namespace AthiVegam::Managers
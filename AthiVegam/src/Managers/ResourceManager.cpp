@@ -0,0 +1,1114 @@
+#include "AthiVegam/Managers/ResourceManager.h"
+
+#include "AthiVegam/Assets/Ktx2.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Graphics/GpuMemory.h"
+#include "AthiVegam/Graphics/GpuResources.h"
+#include "AthiVegam/Log.h"
+#include "external/imgui/imgui.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+
+namespace AthiVegam::Managers
+{
+	namespace
+	{
+		// Through the FileManager, so mounted directories
+		// and archives serve the file.
+		bool ReadFile(const std::string& path,
+		              std::string& contents)
+		{
+			return Engine::Instance().GetFileManager().ReadText(
+			    path, contents);
+		}
+
+		bool ReadFile(const std::string& path,
+		              std::vector<uint8_t>& contents)
+		{
+			return Engine::Instance().GetFileManager().Read(
+			    path, contents);
+		}
+
+		// Where a loose file lives on disk, for the watcher
+		// and mapped packs; the path itself if in no
+		// mounted directory.
+		std::string NativePath(const std::string& path)
+		{
+			auto native =
+			    Engine::Instance().GetFileManager().GetNativePath(
+			        path);
+			return native.empty() ? path : native;
+		}
+
+		// Splices in #include "file" like
+		// tools/cookshaders.py: relative to the including
+		// file, each file once.
+		bool AppendShaderFile(
+		    const std::filesystem::path& path,
+		    std::string& source,
+		    std::vector<std::filesystem::path>& included)
+		{
+			std::string contents;
+			if (!ReadFile(path.string(), contents))
+			{
+				return false;
+			}
+			std::istringstream lines(contents);
+			std::string line;
+			while (std::getline(lines, line))
+			{
+				const auto start =
+				    line.find_first_not_of(" \t");
+				if (start == std::string::npos
+				    || line.compare(start, 8, "#include") != 0)
+				{
+					source += line;
+					source += '\n';
+					continue;
+				}
+				const auto open = line.find('"', start);
+				const auto close = line.find('"', open + 1);
+				if (open == std::string::npos
+				    || close == std::string::npos)
+				{
+					VEGAM_ERROR("Bad #include in {}: {}",
+					            path.string(), line);
+					return false;
+				}
+				const auto target =
+				    (path.parent_path()
+				     / line.substr(open + 1, close - open - 1))
+				        .lexically_normal();
+				if (std::find(included.begin(), included.end(),
+				              target)
+				    != included.end())
+				{
+					continue;
+				}
+				included.push_back(target);
+				if (!AppendShaderFile(target, source, included))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool ReadShaderFile(const std::string& path,
+		                    std::string& source)
+		{
+			const auto file =
+			    std::filesystem::path(path).lexically_normal();
+			std::vector<std::filesystem::path> included{file};
+			return AppendShaderFile(file, source, included);
+		}
+	} // namespace
+
+	void ResourceManager::Initialize()
+	{
+		m_uploads.Initialize(MeshUploadStagingSize);
+		m_materialTable.Initialize();
+	}
+
+	void ResourceManager::Shutdown()
+	{
+		m_shaderWatcher.Stop();
+		m_shaderReloads.clear();
+		m_shaderFiles.clear();
+		m_shaderReloadCallback = nullptr;
+		// Replacements still loading are nobody's.
+		for (const auto& replacement : m_meshReplacements)
+		{
+			m_meshes.Destroy(replacement.replacement);
+		}
+		for (const auto& replacement : m_textureReplacements)
+		{
+			m_textures.Destroy(replacement.replacement);
+		}
+		m_meshReplacements.clear();
+		m_textureReplacements.clear();
+		m_uploads.Shutdown();
+		LogStats();
+
+		if (m_meshes.GetCount() > 0
+		    || m_shaders.GetCount() > 0
+		    || m_computeShaders.GetCount() > 0
+		    || m_textures.GetCount() > 0
+		    || m_materials.GetCount() > 0)
+		{
+			VEGAM_WARN("Releasing {} meshes, {} shaders, {} "
+			           "compute shaders, {} textures and {} "
+			           "materials still alive at shutdown",
+			           m_meshes.GetCount(),
+			           m_shaders.GetCount(),
+			           m_computeShaders.GetCount(),
+			           m_textures.GetCount(),
+			           m_materials.GetCount());
+		}
+
+		m_meshes.Clear();
+		m_shaders.Clear();
+		m_computeShaders.Clear();
+		m_textureUploads.clear();
+		m_textures.Clear();
+		m_materials.Clear();
+		m_materialTable.Shutdown();
+		m_pendingShaders.clear();
+		m_fallbackShader = {};
+		m_shaderVariants.clear();
+		m_sharedArenas.clear();
+		m_meshArenas.clear();
+	}
+
+	void ResourceManager::LogStats() const
+	{
+		const auto meshes = m_meshes.GetStats();
+		const auto shaders = m_shaders.GetStats();
+		VEGAM_INFO("Meshes: {} live, {} slots, {} created",
+		           meshes.live, meshes.capacity,
+		           meshes.allocations);
+		VEGAM_INFO("Shaders: {} live, {} slots, {} created",
+		           shaders.live, shaders.capacity,
+		           shaders.allocations);
+		const auto compute = m_computeShaders.GetStats();
+		VEGAM_INFO("Compute shaders: {} live, {} slots, {} "
+		           "created",
+		           compute.live, compute.capacity,
+		           compute.allocations);
+		const auto textures = m_textures.GetStats();
+		VEGAM_INFO("Textures: {} live, {} slots, {} created",
+		           textures.live, textures.capacity,
+		           textures.allocations);
+		const auto materials = m_materials.GetStats();
+		VEGAM_INFO("Materials: {} live, {} slots, {} created",
+		           materials.live, materials.capacity,
+		           materials.allocations);
+	}
+
+	void ResourceManager::DrawStats() const
+	{
+		if (!ImGui::Begin("Resources"))
+		{
+			ImGui::End();
+			return;
+		}
+
+		const auto row = [](const char* name,
+		                    const Core::PoolStats& stats) {
+			ImGui::Text("%-8s %6zu live %6zu slots %8zu created",
+			            name, stats.live, stats.capacity,
+			            stats.allocations);
+		};
+		row("Meshes", m_meshes.GetStats());
+		row("Shaders", m_shaders.GetStats());
+		row("Compute", m_computeShaders.GetStats());
+		row("Textures", m_textures.GetStats());
+		row("Materials", m_materials.GetStats());
+		ImGui::End();
+	}
+
+	Graphics::MeshHandle ResourceManager::CreateMesh(
+	    float* vertexArray, uint32_t vertexCount,
+	    uint32_t dimensions, std::source_location site)
+	{
+		return CreateMesh(
+		    Graphics::VertexLayout::Positions(dimensions),
+		    vertexArray, vertexCount, nullptr, 0, site);
+	}
+
+	Graphics::MeshHandle ResourceManager::CreateMesh(
+	    float* vertexArray, uint32_t vertexCount,
+	    uint32_t dimensions, uint32_t* elementArray,
+	    uint32_t elementCount, std::source_location site)
+	{
+		return CreateMesh(
+		    Graphics::VertexLayout::Positions(dimensions),
+		    vertexArray, vertexCount, elementArray,
+		    elementCount, site);
+	}
+
+	Graphics::MeshHandle ResourceManager::CreateMesh(
+	    const Graphics::VertexLayout& layout,
+	    const void* vertexData, uint32_t vertexCount,
+	    const uint32_t* elementArray, uint32_t elementCount,
+	    std::source_location site)
+	{
+		Graphics::GpuResources::SiteScope scope(site);
+		auto* arena =
+		    GetSharedArena(layout, vertexCount, elementCount);
+		if (!arena)
+		{
+			return CreateStandaloneMesh(layout, vertexData,
+			                            vertexCount,
+			                            elementArray,
+			                            elementCount, site);
+		}
+		return CreateMesh(*arena, vertexData, vertexCount,
+		                  elementArray, elementCount);
+	}
+
+	Graphics::MeshHandle ResourceManager::CreateMesh(
+	    Graphics::MeshArena& arena, const void* vertexData,
+	    uint32_t vertexCount, const uint32_t* elementArray,
+	    uint32_t elementCount)
+	{
+		std::lock_guard lock(m_meshesMutex);
+		return m_meshes.Create(arena, vertexData,
+		                       vertexCount, elementArray,
+		                       elementCount);
+	}
+
+	Graphics::MeshHandle ResourceManager::CreateOptimizedMesh(
+	    const Graphics::VertexLayout& layout,
+	    const void* vertexData, uint32_t vertexCount,
+	    const uint32_t* elementArray, uint32_t elementCount,
+	    const Graphics::MeshOptimizer::Options& options,
+	    std::source_location site)
+	{
+		const auto* bytes =
+		    static_cast<const uint8_t*>(vertexData);
+		std::vector<uint8_t> vertices(
+		    bytes, bytes
+		               + static_cast<size_t>(vertexCount)
+		                     * layout.GetStride());
+		std::vector<uint32_t> indices(
+		    elementArray, elementArray + elementCount);
+
+		Graphics::MeshOptimizer::Optimize(layout, vertices,
+		                                  indices, options);
+
+		const auto optimizedCount = static_cast<uint32_t>(
+		    vertices.size() / layout.GetStride());
+		VEGAM_TRACE("Optimized mesh: {} -> {} vertices",
+		            vertexCount, optimizedCount);
+		return CreateMesh(layout, vertices.data(),
+		                  optimizedCount, indices.data(),
+		                  static_cast<uint32_t>(indices.size()),
+		                  site);
+	}
+
+	Graphics::MeshHandle
+	ResourceManager::CreateStandaloneMesh(
+	    const Graphics::VertexLayout& layout,
+	    const void* vertexData, uint32_t vertexCount,
+	    const uint32_t* elementArray, uint32_t elementCount,
+	    std::source_location site)
+	{
+		Graphics::GpuResources::SiteScope scope(site);
+		std::lock_guard lock(m_meshesMutex);
+		if (elementCount == 0)
+		{
+			return m_meshes.Create(layout, vertexData,
+			                       vertexCount);
+		}
+		return m_meshes.Create(layout, vertexData,
+		                       vertexCount, elementArray,
+		                       elementCount);
+	}
+
+	Graphics::MeshHandle ResourceManager::CreateDynamicMesh(
+	    const Graphics::VertexLayout& layout,
+	    uint32_t maxVertexCount, uint32_t maxElementCount,
+	    std::source_location site)
+	{
+		Graphics::GpuResources::SiteScope scope(site);
+		std::lock_guard lock(m_meshesMutex);
+		return m_meshes.Create(layout, maxVertexCount,
+		                       maxElementCount);
+	}
+
+	Graphics::MeshHandle
+	ResourceManager::LoadMesh(const Assets::MeshPack& pack,
+	                          Assets::AssetId id,
+	                          std::source_location site)
+	{
+		Assets::MeshPack::MeshView view;
+		if (!pack.Find(id, view))
+		{
+			return {};
+		}
+		auto handle =
+		    CreateMesh(view.layout, view.vertices,
+		               view.vertexCount, view.indices,
+		               view.elementCount, site);
+		if (view.meshletCount > 0)
+		{
+			std::lock_guard lock(m_meshesMutex);
+			auto* mesh = m_meshes.Get(handle);
+			// Standalone meshes are drawn whole.
+			if (mesh && mesh->GetArena())
+			{
+				mesh->SetMeshlets(
+				    {view.meshlets, view.meshletCount});
+			}
+		}
+		return handle;
+	}
+
+	Graphics::MeshHandle ResourceManager::CreateMeshAsync(
+	    const Graphics::VertexLayout& layout,
+	    const void* vertexData, uint32_t vertexCount,
+	    const uint32_t* elementArray, uint32_t elementCount)
+	{
+		Graphics::MeshUploadQueue::Request request;
+		request.layout = layout;
+		request.vertexCount = vertexCount;
+		const auto* bytes =
+		    static_cast<const uint8_t*>(vertexData);
+		request.vertices.assign(
+		    bytes, bytes
+		               + static_cast<size_t>(vertexCount)
+		                     * layout.GetStride());
+		request.indices.assign(elementArray,
+		                       elementArray + elementCount);
+		request.mesh = CreateMeshPlaceholder(
+		    Graphics::ComputeBounds(layout, vertexData,
+		                            vertexCount));
+
+		auto handle = request.mesh;
+		QueueMeshUpload(std::move(request));
+		return handle;
+	}
+
+	Graphics::MeshHandle ResourceManager::CreateMeshPlaceholder(
+	    const Graphics::Aabb& bounds)
+	{
+		// The layout is taken from the request once the
+		// upload is placed.
+		std::lock_guard lock(m_meshesMutex);
+		return m_meshes.Create(Graphics::VertexLayout{},
+		                       bounds);
+	}
+
+	void ResourceManager::QueueMeshUpload(
+	    Graphics::MeshUploadQueue::Request&& request)
+	{
+		m_uploads.Push(std::move(request));
+		m_uploadsPending.store(true, std::memory_order_relaxed);
+	}
+
+	void ResourceManager::ProcessUploads(double budgetMs)
+	{
+		VEGAM_PROFILE_SCOPE("ResourceManager::ProcessUploads");
+		m_uploads.Process(*this, budgetMs);
+
+		std::erase_if(m_pendingShaders,
+		              [this](Graphics::ShaderHandle handle) {
+			              auto* shader = m_shaders.Get(handle);
+			              return !shader || shader->Poll();
+		              });
+		ReloadShaders();
+		ProcessTextureUploads();
+		ProcessReplacements();
+		EvictTextures();
+		{
+			std::scoped_lock lock(m_materialsMutex,
+			                      m_texturesMutex);
+			m_materialTable.Update(m_materials, m_textures);
+		}
+
+		bool texturesPending;
+		{
+			std::scoped_lock lock(m_meshesMutex,
+			                      m_texturesMutex);
+			texturesPending = !m_textureUploads.empty()
+			                  || !m_meshReplacements.empty()
+			                  || !m_textureReplacements.empty();
+		}
+		m_uploadsPending.store(
+		    m_uploads.GetPendingCount() > 0
+		        || !m_pendingShaders.empty()
+		        || !m_shaderReloads.empty() || texturesPending,
+		    std::memory_order_relaxed);
+	}
+
+	void ResourceManager::ProcessTextureUploads()
+	{
+		std::lock_guard lock(m_texturesMutex);
+		if (m_textureUploads.empty())
+		{
+			return;
+		}
+
+		// Smallest first: every streamed texture gets a
+		// coarse level before any gets its full one.
+		std::stable_sort(m_textureUploads.begin(),
+		                 m_textureUploads.end(),
+		                 [](const TextureUpload& a,
+		                    const TextureUpload& b) {
+			                 return a.data.size()
+			                        < b.data.size();
+		                 });
+		size_t bytes = 0;
+		size_t count = 0;
+		for (; count < m_textureUploads.size(); ++count)
+		{
+			auto& upload = m_textureUploads[count];
+			if (count > 0
+			    && bytes + upload.data.size()
+			           > TextureUploadBudget)
+			{
+				break;
+			}
+			bytes += upload.data.size();
+
+			// Destroyed while its data was read.
+			auto* texture = m_textures.Get(upload.texture);
+			if (!texture)
+			{
+				continue;
+			}
+			if (!texture->IsCreated()
+			    && !texture->Create(upload.desc))
+			{
+				continue;
+			}
+			if (upload.level < texture->GetDesc().levelCount
+			    && upload.data.size()
+			           == texture->GetLevelSize(upload.level))
+			{
+				texture->UploadLevel(upload.level,
+				                     upload.data.data());
+			}
+		}
+		m_textureUploads.erase(m_textureUploads.begin(),
+		                       m_textureUploads.begin() + count);
+	}
+
+	void ResourceManager::ReplaceMesh(
+	    Graphics::MeshHandle handle,
+	    Graphics::MeshHandle replacement)
+	{
+		std::lock_guard lock(m_meshesMutex);
+		m_meshReplacements.push_back({handle, replacement});
+		m_uploadsPending.store(true, std::memory_order_relaxed);
+	}
+
+	void ResourceManager::ReplaceTexture(
+	    Graphics::TextureHandle handle,
+	    Graphics::TextureHandle replacement)
+	{
+		std::lock_guard lock(m_texturesMutex);
+		m_textureReplacements.push_back({handle, replacement});
+		m_uploadsPending.store(true, std::memory_order_relaxed);
+	}
+
+	// Between frames on the GL thread, like shader reloads,
+	// so no draw sees a half-swapped asset.
+	void ResourceManager::ProcessReplacements()
+	{
+		std::lock_guard meshesLock(m_meshesMutex);
+		std::erase_if(
+		    m_meshReplacements,
+		    [this](const Replacement<Graphics::MeshHandle>& r) {
+			    auto* replacement = m_meshes.Get(r.replacement);
+			    if (replacement && !replacement->IsReady())
+			    {
+				    return false;
+			    }
+			    if (auto* mesh = m_meshes.Get(r.handle);
+			        mesh && replacement)
+			    {
+				    mesh->Swap(*replacement);
+			    }
+			    // Takes the old mesh with it.
+			    m_meshes.Destroy(r.replacement);
+			    return true;
+		    });
+
+		std::lock_guard texturesLock(m_texturesMutex);
+		std::erase_if(
+		    m_textureReplacements,
+		    [this](
+		        const Replacement<Graphics::TextureHandle>& r) {
+			    auto* replacement =
+			        m_textures.Get(r.replacement);
+			    if (replacement
+			        && (!replacement->IsReady()
+			            || replacement->GetResidentLevel() > 0))
+			    {
+				    return false;
+			    }
+			    if (auto* texture = m_textures.Get(r.handle);
+			        texture && replacement)
+			    {
+				    texture->Swap(*replacement);
+				    // Evicted levels would stream back in
+				    // from the stale archive.
+				    std::erase(m_streamedTextures, r.handle);
+			    }
+			    m_textures.Destroy(r.replacement);
+			    return true;
+		    });
+	}
+
+	Graphics::TextureHandle ResourceManager::CreateTexture(
+	    const Graphics::TextureDesc& desc,
+	    std::source_location site)
+	{
+		Graphics::GpuResources::SiteScope scope(site);
+		std::lock_guard lock(m_texturesMutex);
+		auto handle = m_textures.Create();
+		if (!m_textures.Get(handle)->Create(desc))
+		{
+			m_textures.Destroy(handle);
+			return {};
+		}
+		return handle;
+	}
+
+	Graphics::TextureHandle
+	ResourceManager::LoadTexture(const std::string& path,
+	                             std::source_location site)
+	{
+		std::vector<uint8_t> file;
+		Assets::Ktx2::Info info;
+		if (!ReadFile(path, file)
+		    || !Assets::Ktx2::Parse(file.data(), file.size(),
+		                            file.size(), info, path))
+		{
+			return {};
+		}
+
+		auto handle = CreateTexture(info.desc, site);
+		auto* texture = m_textures.Get(handle);
+		if (!texture)
+		{
+			return {};
+		}
+		for (auto level = info.desc.levelCount; level-- > 0;)
+		{
+			texture->UploadLevel(
+			    level, file.data() + info.levels[level].offset);
+		}
+		return handle;
+	}
+
+	Graphics::TextureHandle
+	ResourceManager::CreateTexturePlaceholder()
+	{
+		std::lock_guard lock(m_texturesMutex);
+		const auto handle = m_textures.Create();
+		m_streamedTextures.push_back(handle);
+		return handle;
+	}
+
+	void ResourceManager::QueueTextureUpload(
+	    TextureUpload&& upload)
+	{
+		{
+			std::lock_guard lock(m_texturesMutex);
+			m_textureUploads.push_back(std::move(upload));
+		}
+		m_uploadsPending.store(true, std::memory_order_relaxed);
+	}
+
+	// Least recently drawn first, one level each, until
+	// enough is freed.
+	void ResourceManager::EvictTextures()
+	{
+		auto overage = Graphics::GpuMemory::GetOverage();
+		if (overage == 0)
+		{
+			return;
+		}
+		VEGAM_PROFILE_SCOPE("ResourceManager::EvictTextures");
+		const auto frame = Graphics::GpuMemory::GetFrame();
+		std::lock_guard lock(m_texturesMutex);
+		std::erase_if(m_streamedTextures,
+		              [this](Graphics::TextureHandle handle) {
+			              return !m_textures.Get(handle);
+		              });
+
+		std::vector<Graphics::TextureHandle> candidates;
+		for (const auto handle : m_streamedTextures)
+		{
+			const auto* texture = m_textures.Get(handle);
+			if (texture->IsReady()
+			    && texture->GetStorageLevel() + 1
+			           < texture->GetDesc().levelCount
+			    && texture->GetLastUsedFrame()
+			               + TextureEvictionAge
+			           <= frame)
+			{
+				candidates.push_back(handle);
+			}
+		}
+		std::sort(candidates.begin(), candidates.end(),
+		          [this](Graphics::TextureHandle a,
+		                 Graphics::TextureHandle b) {
+			          return m_textures.Get(a)->GetLastUsedFrame()
+			                 < m_textures.Get(b)
+			                       ->GetLastUsedFrame();
+		          });
+
+		uint32_t evicted = 0;
+		for (const auto handle : candidates)
+		{
+			if (overage == 0 || evicted == MaxTextureEvictions)
+			{
+				break;
+			}
+			auto* texture = m_textures.Get(handle);
+			const auto size = texture->GetStorageSize();
+			const auto level = texture->GetStorageLevel() + 1;
+			// Without GL 4.3 none can be.
+			if (!texture->SetStorageLevel(level))
+			{
+				break;
+			}
+			overage -= std::min(
+			    overage, size - texture->GetStorageSize());
+			m_textureEvictions.push_back({handle, level});
+			++evicted;
+		}
+		VEGAM_PROFILE_EVENT("Texture eviction", "{} levels",
+		                    evicted);
+	}
+
+	std::vector<ResourceManager::TextureEviction>
+	ResourceManager::TakeTextureEvictions()
+	{
+		std::lock_guard lock(m_texturesMutex);
+		return std::exchange(m_textureEvictions, {});
+	}
+
+	void ResourceManager::DestroyTexture(
+	    Graphics::TextureHandle handle)
+	{
+		std::lock_guard lock(m_texturesMutex);
+		if (!m_textures.Destroy(handle))
+		{
+			VEGAM_WARN("Attempting to destroy an invalid "
+			           "texture handle: {}",
+			           handle.value);
+		}
+	}
+
+	Graphics::MaterialHandle ResourceManager::CreateMaterial(
+	    const Graphics::MaterialDesc& desc)
+	{
+		std::lock_guard lock(m_materialsMutex);
+		return m_materials.Create(desc);
+	}
+
+	void ResourceManager::UpdateMaterial(
+	    Graphics::MaterialHandle handle,
+	    const Graphics::MaterialDesc& desc)
+	{
+		std::lock_guard lock(m_materialsMutex);
+		auto* material = m_materials.Get(handle);
+		if (!material)
+		{
+			VEGAM_WARN("Attempting to update an invalid "
+			           "material handle: {}",
+			           handle.value);
+			return;
+		}
+		material->SetDesc(desc);
+	}
+
+	void ResourceManager::DestroyMaterial(
+	    Graphics::MaterialHandle handle)
+	{
+		std::lock_guard lock(m_materialsMutex);
+		if (!m_materials.Destroy(handle))
+		{
+			VEGAM_WARN("Attempting to destroy an invalid "
+			           "material handle: {}",
+			           handle.value);
+		}
+	}
+
+	Graphics::ShaderHandle
+	ResourceManager::CreateShaderFromFiles(
+	    const std::string& vertexPath,
+	    const std::string& fragmentPath,
+	    std::source_location site)
+	{
+		std::string vertex;
+		std::string fragment;
+		if (!ReadShaderSource(vertexPath, vertex)
+		    || !ReadShaderSource(fragmentPath, fragment))
+		{
+			return {};
+		}
+
+		auto handle = CreateShader(
+		    vertex, fragment,
+		    Graphics::Shader::CompileMode::Blocking, site);
+		m_shaderFiles.push_back(
+		    {handle, vertexPath, fragmentPath});
+		if (m_shaderWatcher.IsRunning())
+		{
+			m_shaderWatcher.Watch(NativePath(vertexPath));
+			m_shaderWatcher.Watch(NativePath(fragmentPath));
+		}
+		return handle;
+	}
+
+	bool ResourceManager::MountShaderPack(
+	    const std::string& path)
+	{
+		return m_shaderPack.Open(NativePath(path));
+	}
+
+	bool ResourceManager::ReadShaderSource(
+	    const std::string& path, std::string& source) const
+	{
+		std::string_view cooked;
+		if (m_shaderPack.Find(Assets::MakeAssetId(path), cooked))
+		{
+			source.assign(cooked);
+			return true;
+		}
+		return ReadShaderFile(path, source);
+	}
+
+	void ResourceManager::EnableShaderHotReload(
+	    uint32_t intervalMs)
+	{
+		if (m_shaderWatcher.IsRunning())
+		{
+			return;
+		}
+
+		for (const auto& files : m_shaderFiles)
+		{
+			m_shaderWatcher.Watch(NativePath(files.vertexPath));
+			m_shaderWatcher.Watch(
+			    NativePath(files.fragmentPath));
+		}
+		// Render-on-demand loops would otherwise sleep
+		// through the change.
+		m_shaderWatcher.Start(
+		    std::chrono::milliseconds(intervalMs),
+		    [] { Engine::Instance().RequestRedraw(); });
+		VEGAM_INFO("Shader hot reload enabled");
+	}
+
+	void ResourceManager::ReloadShaders()
+	{
+		if (!m_shaderWatcher.IsRunning())
+		{
+			return;
+		}
+
+		for (const auto& path : m_shaderWatcher.TakeChanges())
+		{
+			for (const auto& files : m_shaderFiles)
+			{
+				if (NativePath(files.vertexPath) != path
+				    && NativePath(files.fragmentPath) != path)
+				{
+					continue;
+				}
+
+				std::string vertex;
+				std::string fragment;
+				// Edits come from the files, never the
+				// shader pack.
+				if (!ReadShaderFile(files.vertexPath, vertex)
+				    || !ReadShaderFile(files.fragmentPath,
+				                       fragment))
+				{
+					continue;
+				}
+				VEGAM_INFO("Reloading shader {} + {}",
+				           files.vertexPath,
+				           files.fragmentPath);
+
+				// A newer edit supersedes a compile still
+				// in flight.
+				std::erase_if(m_shaderReloads,
+				              [&](const ShaderReload& reload) {
+					              return reload.handle
+					                     == files.handle;
+				              });
+				Graphics::GpuResources::SiteScope scope(
+				    std::source_location::current());
+				m_shaderReloads.push_back(
+				    {files.handle,
+				     std::make_unique<Graphics::Shader>(
+				         vertex, fragment,
+				         Graphics::Shader::CompileMode::Async)});
+			}
+		}
+
+		std::erase_if(m_shaderReloads, [this](
+		                                   ShaderReload& reload) {
+			if (!reload.shader->Poll())
+			{
+				return false;
+			}
+
+			auto* shader = m_shaders.Get(reload.handle);
+			if (!shader)
+			{
+				return true;
+			}
+			if (!reload.shader->IsReady())
+			{
+				VEGAM_ERROR("Shader reload failed, keeping "
+				            "the previous program");
+				return true;
+			}
+
+			// Between frames on the GL thread, so no draw
+			// sees a half-swapped shader. The old program
+			// goes with the replacement.
+			shader->Swap(*reload.shader);
+			VEGAM_INFO("Shader reloaded");
+			if (m_shaderReloadCallback)
+			{
+				m_shaderReloadCallback(reload.handle);
+			}
+			return true;
+		});
+	}
+
+	Graphics::ShaderHandle ResourceManager::CreateShader(
+	    const std::string& vertex, const std::string& fragment,
+	    Graphics::Shader::CompileMode mode,
+	    std::source_location site)
+	{
+		Graphics::GpuResources::SiteScope scope(site);
+		return m_shaders.Create(vertex, fragment, mode);
+	}
+
+	Graphics::ShaderHandle ResourceManager::CreateShaderAsync(
+	    const std::string& vertex, const std::string& fragment,
+	    std::source_location site)
+	{
+		Graphics::GpuResources::SiteScope scope(site);
+		auto handle = m_shaders.Create(
+		    vertex, fragment,
+		    Graphics::Shader::CompileMode::Async);
+		if (m_shaders.Get(handle)->IsPending())
+		{
+			m_pendingShaders.push_back(handle);
+			m_uploadsPending.store(true,
+			                       std::memory_order_relaxed);
+		}
+		return handle;
+	}
+
+	Graphics::ComputeShaderHandle
+	ResourceManager::CreateComputeShader(
+	    const std::string& source, std::source_location site)
+	{
+		Graphics::GpuResources::SiteScope scope(site);
+		return m_computeShaders.Create(source);
+	}
+
+	void ResourceManager::DestroyComputeShader(
+	    Graphics::ComputeShaderHandle handle)
+	{
+		if (!m_computeShaders.Destroy(handle))
+		{
+			VEGAM_WARN("Attempting to destroy an invalid "
+			           "compute shader handle: {}",
+			           handle.value);
+		}
+	}
+
+	Graphics::Shader* ResourceManager::GetDrawableShader(
+	    Graphics::ShaderHandle handle) const
+	{
+		auto* shader = m_shaders.Get(handle);
+		if (!shader || shader->IsReady())
+		{
+			return shader;
+		}
+		if (!shader->IsPending())
+		{
+			// Failed to link.
+			return nullptr;
+		}
+
+		auto* fallback = m_shaders.Get(m_fallbackShader);
+		return fallback && fallback->IsReady() ? fallback
+		                                       : nullptr;
+	}
+
+	Graphics::MeshArena* ResourceManager::GetSharedArena(
+	    const Graphics::VertexLayout& layout,
+	    uint32_t vertexCount, uint32_t elementCount)
+	{
+		// Meshes bigger than an arena keep their own buffers.
+		if (vertexCount > SharedArenaVertexCapacity
+		    || elementCount > SharedArenaIndexCapacity)
+		{
+			return nullptr;
+		}
+
+		const auto indexType =
+		    Graphics::SelectIndexType(vertexCount);
+		auto it = std::find_if(
+		    m_sharedArenas.begin(), m_sharedArenas.end(),
+		    [&](const Graphics::MeshArena* arena) {
+			    return arena->GetLayout() == layout
+			           && arena->GetIndexType() == indexType
+			           && arena->CanFit(vertexCount,
+			                            elementCount);
+		    });
+		if (it != m_sharedArenas.end())
+		{
+			return *it;
+		}
+
+		auto* arena = CreateMeshArena(
+		    layout, SharedArenaVertexCapacity,
+		    SharedArenaIndexCapacity, indexType);
+		m_sharedArenas.push_back(arena);
+		return arena;
+	}
+
+	Graphics::MeshArena* ResourceManager::CreateMeshArena(
+	    uint32_t dimensions, uint32_t vertexCapacity,
+	    uint32_t indexCapacity, Graphics::IndexType indexType,
+	    std::source_location site)
+	{
+		return CreateMeshArena(
+		    Graphics::VertexLayout::Positions(dimensions),
+		    vertexCapacity, indexCapacity, indexType, site);
+	}
+
+	Graphics::MeshArena* ResourceManager::CreateMeshArena(
+	    const Graphics::VertexLayout& layout,
+	    uint32_t vertexCapacity, uint32_t indexCapacity,
+	    Graphics::IndexType indexType,
+	    std::source_location site)
+	{
+		Graphics::GpuResources::SiteScope scope(site);
+
+		m_meshArenas.push_back(
+		    std::make_unique<Graphics::MeshArena>(
+		        layout, vertexCapacity, indexCapacity,
+		        indexType));
+		return m_meshArenas.back().get();
+	}
+
+	void ResourceManager::DestroyMesh(
+	    Graphics::MeshHandle handle)
+	{
+		std::lock_guard lock(m_meshesMutex);
+		if (!m_meshes.Destroy(handle))
+		{
+			VEGAM_WARN("Attempting to destroy an invalid "
+			           "mesh handle: {}",
+			           handle.value);
+		}
+	}
+
+	void ResourceManager::SetMeshLods(
+	    Graphics::MeshHandle handle,
+	    const Graphics::LodChain& lods)
+	{
+		VEGAM_ASSERT(lods.count < Graphics::LodChain::MaxLevels,
+		             "Too many levels of detail");
+		std::lock_guard lock(m_meshesMutex);
+		auto* mesh = m_meshes.Get(handle);
+		if (!mesh)
+		{
+			VEGAM_WARN("Setting levels of detail of an "
+			           "invalid mesh handle: {}",
+			           handle.value);
+			return;
+		}
+		for (uint32_t i = 0; i < lods.count; ++i)
+		{
+			auto* level = m_meshes.Get(lods.meshes[i]);
+			VEGAM_ASSERT(level, "Invalid level of detail");
+			VEGAM_ASSERT(i == 0
+			                 || lods.thresholds[i]
+			                        <= lods.thresholds[i - 1],
+			             "Level of detail thresholds must "
+			             "decrease");
+			if (level && level->GetArena() != mesh->GetArena())
+			{
+				VEGAM_WARN("Level {} of mesh {} is in another "
+				           "arena; GPU culling draws it at "
+				           "full detail",
+				           i + 1, handle.value);
+			}
+		}
+		VEGAM_ASSERT(
+		    lods.impostor == Graphics::LodChain::NoImpostor
+		        || lods.count == 0
+		        || lods.impostorThreshold
+		               <= lods.thresholds[lods.count - 1],
+		    "Impostor threshold must be the lowest");
+		mesh->SetLods(lods);
+	}
+
+	Graphics::ShaderVariants*
+	ResourceManager::CreateShaderVariants(
+	    std::string vertex, std::string fragment,
+	    std::vector<std::string> features)
+	{
+		m_shaderVariants.push_back(
+		    std::make_unique<Graphics::ShaderVariants>(
+		        std::move(vertex), std::move(fragment),
+		        std::move(features)));
+		return m_shaderVariants.back().get();
+	}
+
+	Graphics::ShaderHandle ResourceManager::GetShaderVariant(
+	    Graphics::ShaderVariants& variants, uint32_t key)
+	{
+		auto handle = variants.Find(key);
+		if (!handle.IsValid())
+		{
+			handle = CreateShaderAsync(
+			    variants.GetVertexSource(key),
+			    variants.GetFragmentSource(key));
+			variants.Add(key, handle);
+		}
+		return handle;
+	}
+
+	void ResourceManager::DestroyShader(
+	    Graphics::ShaderHandle handle)
+	{
+		std::erase_if(m_shaderReloads,
+		              [&](const ShaderReload& reload) {
+			              return reload.handle == handle;
+		              });
+		const auto files = std::find_if(
+		    m_shaderFiles.begin(), m_shaderFiles.end(),
+		    [&](const ShaderFiles& files) {
+			    return files.handle == handle;
+		    });
+		if (files != m_shaderFiles.end())
+		{
+			const auto removed = std::move(*files);
+			m_shaderFiles.erase(files);
+			// Files may be shared with other shaders.
+			for (const auto* path :
+			     {&removed.vertexPath, &removed.fragmentPath})
+			{
+				if (std::none_of(
+				        m_shaderFiles.begin(),
+				        m_shaderFiles.end(),
+				        [&](const ShaderFiles& other) {
+					        return other.vertexPath == *path
+					               || other.fragmentPath
+					                      == *path;
+				        }))
+				{
+					m_shaderWatcher.Unwatch(*path);
+				}
+			}
+		}
+		if (!m_shaders.Destroy(handle))
+		{
+			VEGAM_WARN("Attempting to destroy an invalid "
+			           "shader handle: {}",
+			           handle.value);
+		}
+	}
+} // namespace AthiVegam::Managers
@@ -0,0 +1,184 @@
+#include "AthiVegam/Math/Batch.h"
+
+#include "AthiVegam/Core/CpuFeatures.h"
+
+#if defined(AV_CPU_X86)
+#include <immintrin.h>
+#endif
+
+namespace AthiVegam::Math
+{
+	namespace
+	{
+		struct Columns
+		{
+			Simd::Float4 c0, c1, c2, c3;
+
+			explicit Columns(const Mat4& m)
+			    : c0(Load(m.columns[0]))
+			    , c1(Load(m.columns[1]))
+			    , c2(Load(m.columns[2]))
+			    , c3(Load(m.columns[3]))
+			{
+			}
+
+			// c0 * x + c1 * y + c2 * z + w
+			inline Simd::Float4 Apply(float x, float y,
+			                          float z,
+			                          Simd::Float4 w) const
+			{
+				auto r = Simd::MulAdd(c0, Simd::Splat(x), w);
+				r = Simd::MulAdd(c1, Simd::Splat(y), r);
+				return Simd::MulAdd(c2, Simd::Splat(z), r);
+			}
+			inline Simd::Float4 Apply(Simd::Float4 v) const
+			{
+				auto r = Simd::Mul(c0, Simd::SplatLane<0>(v));
+				r = Simd::MulAdd(c1, Simd::SplatLane<1>(v), r);
+				r = Simd::MulAdd(c2, Simd::SplatLane<2>(v), r);
+				return Simd::MulAdd(c3, Simd::SplatLane<3>(v),
+				                    r);
+			}
+		};
+
+		inline void StoreXyz(Vec3& out, Simd::Float4 v)
+		{
+			alignas(16) float lanes[4];
+			Simd::Store(lanes, v);
+			out = {lanes[0], lanes[1], lanes[2]};
+		}
+
+		using TransformFn = void (*)(const Mat4&, const float*,
+		                             float*, size_t);
+
+		// m applied to count four-float vectors.
+		void TransformBaseline(const Mat4& m, const float* in,
+		                       float* out, size_t count)
+		{
+			const Columns columns(m);
+			for (size_t i = 0; i < count; ++i)
+			{
+				const auto v = Simd::Load(in + i * 4);
+				Simd::Store(out + i * 4, columns.Apply(v));
+			}
+		}
+
+#if defined(AV_CPU_X86)
+		AV_TARGET_AVX2 void TransformAvx2(const Mat4& m,
+		                                  const float* in,
+		                                  float* out,
+		                                  size_t count)
+		{
+			// Two vectors at once, the matrix in both halves.
+			// No FMA, to round as the baseline does.
+			const auto* columns =
+			    reinterpret_cast<const __m128*>(m.Data());
+			const auto c0 = _mm256_broadcast_ps(columns);
+			const auto c1 = _mm256_broadcast_ps(columns + 1);
+			const auto c2 = _mm256_broadcast_ps(columns + 2);
+			const auto c3 = _mm256_broadcast_ps(columns + 3);
+			size_t i = 0;
+			for (; i + 2 <= count; i += 2)
+			{
+				const auto v = _mm256_loadu_ps(in + i * 4);
+				auto r =
+				    _mm256_mul_ps(c0, _mm256_permute_ps(v, 0x00));
+				r = _mm256_add_ps(
+				    _mm256_mul_ps(c1, _mm256_permute_ps(v, 0x55)),
+				    r);
+				r = _mm256_add_ps(
+				    _mm256_mul_ps(c2, _mm256_permute_ps(v, 0xAA)),
+				    r);
+				r = _mm256_add_ps(
+				    _mm256_mul_ps(c3, _mm256_permute_ps(v, 0xFF)),
+				    r);
+				_mm256_storeu_ps(out + i * 4, r);
+			}
+			if (i < count)
+			{
+				TransformBaseline(m, in + i * 4, out + i * 4,
+				                  count - i);
+			}
+		}
+#endif
+
+		TransformFn SelectTransform()
+		{
+			Core::Kernels<TransformFn> kernels;
+			kernels.baseline = TransformBaseline;
+#if defined(AV_CPU_X86)
+			kernels.avx2 = TransformAvx2;
+#endif
+			return Core::SelectKernel(kernels);
+		}
+
+		const TransformFn TransformKernel = SelectTransform();
+	} // namespace
+
+	void TransformPoints(const Mat4& m, const Vec3* points,
+	                     Vec3* out, size_t count)
+	{
+		const Columns columns(m);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const auto p = points[i];
+			StoreXyz(out[i], columns.Apply(p.x, p.y, p.z,
+			                               columns.c3));
+		}
+	}
+
+	void TransformVectors(const Mat4& m,
+	                      const Vec3* vectors, Vec3* out,
+	                      size_t count)
+	{
+		const Columns columns(m);
+		const auto zero = Simd::Splat(0.0f);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const auto v = vectors[i];
+			StoreXyz(out[i],
+			         columns.Apply(v.x, v.y, v.z, zero));
+		}
+	}
+
+	void Transform(const Mat4& m, const Vec4* vectors,
+	               Vec4* out, size_t count)
+	{
+		if (count > 0)
+		{
+			TransformKernel(m, &vectors->x, &out->x, count);
+		}
+	}
+
+	void Multiply(const Mat4& m, const Mat4* matrices,
+	              Mat4* out, size_t count)
+	{
+		// Each column is transformed alike.
+		if (count > 0)
+		{
+			TransformKernel(m, matrices->Data(), out->Data(),
+			                count * 4);
+		}
+	}
+
+	void Multiply(const Mat4* a, const Mat4* b, Mat4* out,
+	              size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			out[i] = a[i] * b[i];
+		}
+	}
+
+	void ComposeTrs(const Vec3* translations,
+	                const Quat* rotations,
+	                const Vec3* scales, Mat4* out,
+	                size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			out[i] = Mat4::Trs(translations[i],
+			                   rotations[i], scales[i]);
+		}
+	}
+} // namespace AthiVegam::Math
@@ -0,0 +1,204 @@
+#include "AthiVegam/Math/Matrix.h"
+
+#include <cmath>
+
+namespace AthiVegam::Math
+{
+	Mat4 Mat4::Translation(const Vec3& offset)
+	{
+		Mat4 result;
+		result.columns[3] = {offset.x, offset.y, offset.z,
+		                     1.0f};
+		return result;
+	}
+
+	Mat4 Mat4::Scale(const Vec3& scale)
+	{
+		Mat4 result;
+		result.columns[0].x = scale.x;
+		result.columns[1].y = scale.y;
+		result.columns[2].z = scale.z;
+		return result;
+	}
+
+	Mat4 Mat4::Rotation(const Quat& rotation)
+	{
+		return Trs({}, rotation, {1.0f, 1.0f, 1.0f});
+	}
+
+	Mat4 Mat4::Trs(const Vec3& translation,
+	               const Quat& rotation, const Vec3& scale)
+	{
+		const auto& q = rotation;
+		const auto xx = q.x * q.x, yy = q.y * q.y,
+		           zz = q.z * q.z;
+		const auto xy = q.x * q.y, xz = q.x * q.z,
+		           yz = q.y * q.z;
+		const auto wx = q.w * q.x, wy = q.w * q.y,
+		           wz = q.w * q.z;
+
+		const auto& s = scale;
+
+		Mat4 result;
+		result.columns[0] = {(1.0f - 2.0f * (yy + zz)) * s.x,
+		                     2.0f * (xy + wz) * s.x,
+		                     2.0f * (xz - wy) * s.x, 0.0f};
+		result.columns[1] = {2.0f * (xy - wz) * s.y,
+		                     (1.0f - 2.0f * (xx + zz)) * s.y,
+		                     2.0f * (yz + wx) * s.y, 0.0f};
+		result.columns[2] = {2.0f * (xz + wy) * s.z,
+		                     2.0f * (yz - wx) * s.z,
+		                     (1.0f - 2.0f * (xx + yy)) * s.z,
+		                     0.0f};
+		result.columns[3] = {translation.x, translation.y,
+		                     translation.z, 1.0f};
+		return result;
+	}
+
+	Mat4 Mat4::Perspective(float fovY, float aspect,
+	                       float nearZ, float farZ)
+	{
+		const auto focal = 1.0f / std::tan(0.5f * fovY);
+		const auto depth = 1.0f / (nearZ - farZ);
+		Mat4 result;
+		result.columns[0] = {focal / aspect, 0.0f, 0.0f,
+		                     0.0f};
+		result.columns[1] = {0.0f, focal, 0.0f, 0.0f};
+		result.columns[2] = {0.0f, 0.0f,
+		                     (farZ + nearZ) * depth, -1.0f};
+		result.columns[3] = {0.0f, 0.0f,
+		                     2.0f * farZ * nearZ * depth, 0.0f};
+		return result;
+	}
+
+	Mat4 Mat4::Orthographic(float left, float right,
+	                        float bottom, float top,
+	                        float nearZ, float farZ)
+	{
+		Mat4 result;
+		result.columns[0] = {2.0f / (right - left), 0.0f,
+		                     0.0f, 0.0f};
+		result.columns[1] = {0.0f, 2.0f / (top - bottom),
+		                     0.0f, 0.0f};
+		result.columns[2] = {0.0f, 0.0f,
+		                     2.0f / (nearZ - farZ), 0.0f};
+		result.columns[3] = {
+		    (left + right) / (left - right),
+		    (bottom + top) / (bottom - top),
+		    (nearZ + farZ) / (nearZ - farZ), 1.0f};
+		return result;
+	}
+
+	Mat4 Mat4::LookAt(const Vec3& eye, const Vec3& target,
+	                  const Vec3& up)
+	{
+		const auto forward = Normalize(target - eye);
+		const auto side = Normalize(Cross(forward, up));
+		const auto cameraUp = Cross(side, forward);
+
+		Mat4 result;
+		result.columns[0] = {side.x, cameraUp.x, -forward.x,
+		                     0.0f};
+		result.columns[1] = {side.y, cameraUp.y, -forward.y,
+		                     0.0f};
+		result.columns[2] = {side.z, cameraUp.z, -forward.z,
+		                     0.0f};
+		result.columns[3] = {-Dot(side, eye),
+		                     -Dot(cameraUp, eye),
+		                     Dot(forward, eye), 1.0f};
+		return result;
+	}
+
+	Mat4 Transpose(const Mat4& m)
+	{
+		Mat4 result;
+		const auto* in = m.Data();
+		auto* out = result.Data();
+		for (int column = 0; column < 4; ++column)
+		{
+			for (int row = 0; row < 4; ++row)
+			{
+				out[row * 4 + column] =
+				    in[column * 4 + row];
+			}
+		}
+		return result;
+	}
+
+	Mat4 Inverse(const Mat4& matrix)
+	{
+		// Cofactor expansion through the 2x2 minors of the
+		// top and bottom row pairs.
+		const auto* m = matrix.Data();
+		const auto a0 = m[0] * m[5] - m[4] * m[1];
+		const auto a1 = m[0] * m[9] - m[8] * m[1];
+		const auto a2 = m[0] * m[13] - m[12] * m[1];
+		const auto a3 = m[4] * m[9] - m[8] * m[5];
+		const auto a4 = m[4] * m[13] - m[12] * m[5];
+		const auto a5 = m[8] * m[13] - m[12] * m[9];
+		const auto b0 = m[2] * m[7] - m[6] * m[3];
+		const auto b1 = m[2] * m[11] - m[10] * m[3];
+		const auto b2 = m[2] * m[15] - m[14] * m[3];
+		const auto b3 = m[6] * m[11] - m[10] * m[7];
+		const auto b4 = m[6] * m[15] - m[14] * m[7];
+		const auto b5 = m[10] * m[15] - m[14] * m[11];
+
+		const auto determinant = a0 * b5 - a1 * b4
+		                         + a2 * b3 + a3 * b2
+		                         - a4 * b1 + a5 * b0;
+		if (determinant == 0.0f)
+		{
+			return {};
+		}
+		const auto s = 1.0f / determinant;
+
+		Mat4 result;
+		auto* r = result.Data();
+		r[0] = (m[5] * b5 - m[9] * b4 + m[13] * b3) * s;
+		r[1] = (-m[1] * b5 + m[9] * b2 - m[13] * b1) * s;
+		r[2] = (m[1] * b4 - m[5] * b2 + m[13] * b0) * s;
+		r[3] = (-m[1] * b3 + m[5] * b1 - m[9] * b0) * s;
+		r[4] = (-m[4] * b5 + m[8] * b4 - m[12] * b3) * s;
+		r[5] = (m[0] * b5 - m[8] * b2 + m[12] * b1) * s;
+		r[6] = (-m[0] * b4 + m[4] * b2 - m[12] * b0) * s;
+		r[7] = (m[0] * b3 - m[4] * b1 + m[8] * b0) * s;
+		r[8] = (m[7] * a5 - m[11] * a4 + m[15] * a3) * s;
+		r[9] = (-m[3] * a5 + m[11] * a2 - m[15] * a1) * s;
+		r[10] = (m[3] * a4 - m[7] * a2 + m[15] * a0) * s;
+		r[11] = (-m[3] * a3 + m[7] * a1 - m[11] * a0) * s;
+		r[12] = (-m[6] * a5 + m[10] * a4 - m[14] * a3) * s;
+		r[13] = (m[2] * a5 - m[10] * a2 + m[14] * a1) * s;
+		r[14] = (-m[2] * a4 + m[6] * a2 - m[14] * a0) * s;
+		r[15] = (m[2] * a3 - m[6] * a1 + m[10] * a0) * s;
+		return result;
+	}
+
+	Mat4 InverseAffine(const Mat4& m)
+	{
+		// The rows of the 3x3 inverse are the cross
+		// products of the other two columns over the
+		// determinant.
+		const auto c0 = m.columns[0].Xyz();
+		const auto c1 = m.columns[1].Xyz();
+		const auto c2 = m.columns[2].Xyz();
+		const auto r0 = Cross(c1, c2);
+		const auto determinant = Dot(c0, r0);
+		if (determinant == 0.0f)
+		{
+			return {};
+		}
+		const auto scale = 1.0f / determinant;
+		const auto x = r0 * scale;
+		const auto y = Cross(c2, c0) * scale;
+		const auto z = Cross(c0, c1) * scale;
+		const auto t = m.columns[3].Xyz();
+
+		Mat4 result;
+		result.columns[0] = {x.x, y.x, z.x, 0.0f};
+		result.columns[1] = {x.y, y.y, z.y, 0.0f};
+		result.columns[2] = {x.z, y.z, z.z, 0.0f};
+		result.columns[3] = {-Dot(x, t), -Dot(y, t),
+		                     -Dot(z, t), 1.0f};
+		return result;
+	}
+} // namespace AthiVegam::Math
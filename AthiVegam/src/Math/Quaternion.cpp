@@ -0,0 +1,44 @@
+#include "AthiVegam/Math/Quaternion.h"
+
+#include <cmath>
+
+namespace AthiVegam::Math
+{
+	Quat FromAxisAngle(const Vec3& axis, float angle)
+	{
+		const auto s = std::sin(0.5f * angle);
+		return {axis.x * s, axis.y * s, axis.z * s,
+		        std::cos(0.5f * angle)};
+	}
+
+	Quat Slerp(const Quat& a, const Quat& b, float t)
+	{
+		auto cosine = Dot(a, b);
+		auto to = b;
+		if (cosine < 0.0f)
+		{
+			cosine = -cosine;
+			to = {-b.x, -b.y, -b.z, -b.w};
+		}
+
+		// Nearly parallel: the sine below vanishes, and a
+		// normalized lerp is indistinguishable.
+		float from = 1.0f - t;
+		float into = t;
+		if (cosine < 0.9995f)
+		{
+			const auto angle = std::acos(cosine);
+			const auto sine = std::sin(angle);
+			from = std::sin((1.0f - t) * angle) / sine;
+			into = std::sin(t * angle) / sine;
+		}
+
+		const auto scaledTo =
+		    Simd::Mul(Simd::Load(&to.x), Simd::Splat(into));
+		Quat result;
+		Simd::Store(&result.x,
+		            Simd::MulAdd(Simd::Load(&a.x),
+		                         Simd::Splat(from), scaledTo));
+		return Normalize(result);
+	}
+} // namespace AthiVegam::Math
@@ -0,0 +1,550 @@
+#include "AthiVegam/Navigation/NavMesh.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <utility>
+
+namespace AthiVegam::Navigation
+{
+	namespace
+	{
+		inline int32_t FloorDiv(int32_t value, int32_t divisor)
+		{
+			const auto quotient = value / divisor;
+			return quotient * divisor > value ? quotient - 1
+			                                  : quotient;
+		}
+
+		inline int32_t ToCell(float coordinate, float cellSize)
+		{
+			return static_cast<int32_t>(
+			    std::floor(coordinate / cellSize));
+		}
+
+		// Calls visit(index, height) for every cell of the
+		// grid whose centre the triangle covers in xz.
+		template <typename Visit>
+		void Rasterize(const Math::Vec3& a, const Math::Vec3& b,
+		               const Math::Vec3& c, int32_t originX,
+		               int32_t originZ, int32_t width,
+		               float cellSize, Visit&& visit)
+		{
+			const auto area = (b.x - a.x) * (c.z - a.z)
+			                  - (b.z - a.z) * (c.x - a.x);
+			if (std::abs(area) < 1e-12f)
+			{
+				return;
+			}
+
+			const auto minX = std::max(
+			    ToCell(std::min({a.x, b.x, c.x}), cellSize),
+			    originX);
+			const auto maxX = std::min(
+			    ToCell(std::max({a.x, b.x, c.x}), cellSize),
+			    originX + width - 1);
+			const auto minZ = std::max(
+			    ToCell(std::min({a.z, b.z, c.z}), cellSize),
+			    originZ);
+			const auto maxZ = std::min(
+			    ToCell(std::max({a.z, b.z, c.z}), cellSize),
+			    originZ + width - 1);
+
+			// Shared edges cover the centres on them from
+			// both sides.
+			constexpr float Epsilon = -1e-5f;
+			for (auto z = minZ; z <= maxZ; ++z)
+			{
+				const auto pz = (static_cast<float>(z) + 0.5f)
+				                * cellSize;
+				for (auto x = minX; x <= maxX; ++x)
+				{
+					const auto px =
+					    (static_cast<float>(x) + 0.5f) * cellSize;
+					const auto u = ((b.x - px) * (c.z - pz)
+					                - (b.z - pz) * (c.x - px))
+					               / area;
+					const auto v = ((c.x - px) * (a.z - pz)
+					                - (c.z - pz) * (a.x - px))
+					               / area;
+					const auto w = 1.0f - u - v;
+					if (u < Epsilon || v < Epsilon || w < Epsilon)
+					{
+						continue;
+					}
+					visit((z - originZ) * width + (x - originX),
+					      u * a.y + v * b.y + w * c.y);
+				}
+			}
+		}
+	} // namespace
+
+	struct NavMesh::TileBuild
+	{
+		uint64_t key = 0;
+		uint32_t generation = 0;
+		int32_t tileX = 0;
+		int32_t tileZ = 0;
+		Settings settings;
+		std::vector<std::shared_ptr<const Geometry>> geometry;
+		std::shared_ptr<const TileData> result;
+	};
+
+	NavMesh::NavMesh() : NavMesh(Settings{}) {}
+
+	NavMesh::NavMesh(const Settings& settings)
+	    : m_settings(settings)
+	{
+		VEGAM_ASSERT(m_settings.cellSize > 0.0f
+		                 && m_settings.tileCells > 0,
+		             "Navigation cells must have a size");
+	}
+
+	NavMesh::~NavMesh()
+	{
+		Engine::Instance().GetJobManager().Wait(m_jobs);
+	}
+
+	NavMesh::GeometryId
+	NavMesh::AddGeometry(std::span<const Math::Vec3> vertices,
+	                     std::span<const uint32_t> indices)
+	{
+		VEGAM_ASSERT(indices.size() % 3 == 0,
+		             "Navigation geometry is a triangle list");
+		auto geometry = std::make_shared<Geometry>();
+		geometry->vertices.assign(vertices.begin(),
+		                          vertices.end());
+		geometry->indices.assign(indices.begin(), indices.end());
+		if (!vertices.empty())
+		{
+			geometry->min = geometry->max = vertices[0];
+		}
+		for (const auto& vertex : vertices)
+		{
+			geometry->min = Math::Min(geometry->min, vertex);
+			geometry->max = Math::Max(geometry->max, vertex);
+		}
+		for (const auto index : indices)
+		{
+			VEGAM_ASSERT(index < vertices.size(),
+			             "Navigation geometry index out of "
+			             "range");
+		}
+		Invalidate(*geometry);
+
+		GeometryId id;
+		if (!m_freeGeometry.empty())
+		{
+			id = m_freeGeometry.back();
+			m_freeGeometry.pop_back();
+			m_geometry[id] = std::move(geometry);
+		}
+		else
+		{
+			id = static_cast<GeometryId>(m_geometry.size());
+			m_geometry.push_back(std::move(geometry));
+		}
+		return id;
+	}
+
+	void NavMesh::RemoveGeometry(GeometryId geometry)
+	{
+		if (geometry >= m_geometry.size()
+		    || !m_geometry[geometry])
+		{
+			return;
+		}
+		Invalidate(*m_geometry[geometry]);
+		// Builds in flight keep their own reference.
+		m_geometry[geometry].reset();
+		m_freeGeometry.push_back(geometry);
+	}
+
+	void NavMesh::Update()
+	{
+		VEGAM_PROFILE_SCOPE("NavMesh::Update");
+		Install();
+		if (m_dirty == 0)
+		{
+			return;
+		}
+		for (auto& [key, tile] : m_tiles)
+		{
+			if (m_building >= m_settings.maxBuilds)
+			{
+				break;
+			}
+			if (tile.dirty && !tile.building)
+			{
+				StartBuild(key, tile);
+			}
+		}
+	}
+
+	void NavMesh::Build()
+	{
+		VEGAM_PROFILE_SCOPE("NavMesh::Build");
+		auto& jobs = Engine::Instance().GetJobManager();
+		while (IsBuilding())
+		{
+			Update();
+			jobs.Wait(m_jobs);
+		}
+	}
+
+	float NavMesh::GetHeight(Cell cell) const
+	{
+		const auto size =
+		    static_cast<int32_t>(m_settings.tileCells);
+		const auto tileX = FloorDiv(cell.x, size);
+		const auto tileZ = FloorDiv(cell.z, size);
+		const auto it = m_tiles.find(GetKey(tileX, tileZ));
+		if (it == m_tiles.end() || !it->second.data)
+		{
+			return NoHeight;
+		}
+		const auto x = cell.x - tileX * size;
+		const auto z = cell.z - tileZ * size;
+		return it->second.data->heights[static_cast<size_t>(
+		    z * size + x)];
+	}
+
+	bool NavMesh::CanStep(Cell from, Cell to) const
+	{
+		const auto a = GetHeight(from);
+		const auto b = GetHeight(to);
+		return a != NoHeight && b != NoHeight
+		       && std::abs(b - a) <= m_settings.maxClimb;
+	}
+
+	NavMesh::Cell
+	NavMesh::GetCell(const Math::Vec3& position) const
+	{
+		return {ToCell(position.x, m_settings.cellSize),
+		        ToCell(position.z, m_settings.cellSize)};
+	}
+
+	Math::Vec3 NavMesh::GetCenter(Cell cell) const
+	{
+		return {(static_cast<float>(cell.x) + 0.5f)
+		            * m_settings.cellSize,
+		        GetHeight(cell),
+		        (static_cast<float>(cell.z) + 0.5f)
+		            * m_settings.cellSize};
+	}
+
+	bool NavMesh::FindNearest(const Math::Vec3& position,
+	                          float radius, Cell& cell) const
+	{
+		const auto center = GetCell(position);
+		const auto reach = static_cast<int32_t>(
+		    std::ceil(radius / m_settings.cellSize));
+		auto best = radius * radius;
+		auto found = false;
+		for (auto z = center.z - reach; z <= center.z + reach;
+		     ++z)
+		{
+			for (auto x = center.x - reach;
+			     x <= center.x + reach; ++x)
+			{
+				if (!IsWalkable({x, z}))
+				{
+					continue;
+				}
+				const auto offset = GetCenter({x, z}) - position;
+				const auto distance = Math::Dot(offset, offset);
+				if (distance <= best)
+				{
+					best = distance;
+					cell = {x, z};
+					found = true;
+				}
+			}
+		}
+		return found;
+	}
+
+	uint64_t NavMesh::GetKey(int32_t x, int32_t z)
+	{
+		return static_cast<uint64_t>(static_cast<uint32_t>(x))
+		           << 32
+		       | static_cast<uint32_t>(z);
+	}
+
+	void NavMesh::Invalidate(const Geometry& geometry)
+	{
+		if (geometry.indices.empty())
+		{
+			return;
+		}
+		// Cells within the agent's radius of the geometry
+		// are eroded by its edges.
+		const auto margin =
+		    m_settings.agentRadius + m_settings.cellSize;
+		const auto tileSize =
+		    m_settings.cellSize
+		    * static_cast<float>(m_settings.tileCells);
+		const auto minX = static_cast<int32_t>(
+		    std::floor((geometry.min.x - margin) / tileSize));
+		const auto maxX = static_cast<int32_t>(
+		    std::floor((geometry.max.x + margin) / tileSize));
+		const auto minZ = static_cast<int32_t>(
+		    std::floor((geometry.min.z - margin) / tileSize));
+		const auto maxZ = static_cast<int32_t>(
+		    std::floor((geometry.max.z + margin) / tileSize));
+		for (auto z = minZ; z <= maxZ; ++z)
+		{
+			for (auto x = minX; x <= maxX; ++x)
+			{
+				auto& tile = m_tiles[GetKey(x, z)];
+				++tile.generation;
+				if (!tile.dirty)
+				{
+					tile.dirty = true;
+					++m_dirty;
+				}
+			}
+		}
+	}
+
+	void NavMesh::StartBuild(uint64_t key, Tile& tile)
+	{
+		tile.dirty = false;
+		tile.building = true;
+		--m_dirty;
+		++m_building;
+
+		auto build = std::make_shared<TileBuild>();
+		build->key = key;
+		build->generation = tile.generation;
+		build->tileX = static_cast<int32_t>(key >> 32);
+		build->tileZ = static_cast<int32_t>(key & 0xFFFFFFFF);
+		build->settings = m_settings;
+
+		// The geometry that reaches the tile's cells or
+		// their eroding margin.
+		const auto size = static_cast<float>(m_settings.tileCells)
+		                  * m_settings.cellSize;
+		const auto margin =
+		    m_settings.agentRadius + m_settings.cellSize;
+		const auto minX =
+		    static_cast<float>(build->tileX) * size - margin;
+		const auto minZ =
+		    static_cast<float>(build->tileZ) * size - margin;
+		const auto maxX = minX + size + 2.0f * margin;
+		const auto maxZ = minZ + size + 2.0f * margin;
+		for (const auto& geometry : m_geometry)
+		{
+			if (geometry && geometry->max.x >= minX
+			    && geometry->min.x <= maxX
+			    && geometry->max.z >= minZ
+			    && geometry->min.z <= maxZ)
+			{
+				build->geometry.push_back(geometry);
+			}
+		}
+
+		Engine::Instance().GetJobManager().Schedule(
+		    [this, build] {
+			    build->result = BuildTile(*build);
+			    std::lock_guard lock(m_mutex);
+			    m_built.push_back(build);
+		    },
+		    &m_jobs);
+	}
+
+	void NavMesh::Install()
+	{
+		std::vector<std::shared_ptr<TileBuild>> built;
+		{
+			std::lock_guard lock(m_mutex);
+			built.swap(m_built);
+		}
+		for (const auto& build : built)
+		{
+			auto it = m_tiles.find(build->key);
+			VEGAM_ASSERT(it != m_tiles.end(),
+			             "Navigation tile built twice");
+			auto& tile = it->second;
+			tile.building = false;
+			--m_building;
+			// Dirtied again since; the next build is the
+			// one to keep.
+			if (tile.generation != build->generation)
+			{
+				continue;
+			}
+			if (build->geometry.empty())
+			{
+				m_tiles.erase(it);
+			}
+			else
+			{
+				tile.data = build->result;
+			}
+			++m_version;
+		}
+	}
+
+	std::shared_ptr<const NavMesh::TileData>
+	NavMesh::BuildTile(const TileBuild& build)
+	{
+		VEGAM_PROFILE_SCOPE("NavMesh::BuildTile");
+		const auto& settings = build.settings;
+		const auto cellSize = settings.cellSize;
+		const auto size = static_cast<int32_t>(settings.tileCells);
+		const auto radius = settings.agentRadius / cellSize;
+		// Edges lie on the sides of their cells, half a
+		// cell from the centre.
+		const auto reach =
+		    static_cast<int32_t>(std::ceil(radius + 0.5f));
+		// Built with a border of neighbouring cells, so
+		// erosion sees edges across the tile's sides.
+		const auto border = reach + 1;
+		const auto width = size + 2 * border;
+		const auto originX = build.tileX * size - border;
+		const auto originZ = build.tileZ * size - border;
+		const auto cells = static_cast<size_t>(width) * width;
+
+		const auto minNormalY = std::cos(
+		    settings.maxSlopeDegrees * std::numbers::pi_v<float>
+		    / 180.0f);
+		const auto forEachTriangle = [&](auto&& visit) {
+			for (const auto& geometry : build.geometry)
+			{
+				const auto& vertices = geometry->vertices;
+				const auto& indices = geometry->indices;
+				for (size_t i = 0; i + 2 < indices.size(); i += 3)
+				{
+					visit(vertices[indices[i]],
+					      vertices[indices[i + 1]],
+					      vertices[indices[i + 2]]);
+				}
+			}
+		};
+
+		// The highest walkable surface over each cell.
+		std::vector<float> floors(cells, NoHeight);
+		forEachTriangle([&](const Math::Vec3& a,
+		                    const Math::Vec3& b,
+		                    const Math::Vec3& c) {
+			const auto normal = Math::Cross(b - a, c - a);
+			const auto length = Math::Length(normal);
+			if (length <= 0.0f
+			    || std::abs(normal.y) < minNormalY * length)
+			{
+				return;
+			}
+			Rasterize(a, b, c, originX, originZ, width, cellSize,
+			          [&](int32_t index, float height) {
+				          auto& floor = floors[index];
+				          floor = std::max(floor, height);
+			          });
+		});
+
+		// Steeper surfaces too low above it to stand under.
+		std::vector<uint8_t> blocked(cells, 0);
+		forEachTriangle([&](const Math::Vec3& a,
+		                    const Math::Vec3& b,
+		                    const Math::Vec3& c) {
+			Rasterize(a, b, c, originX, originZ, width, cellSize,
+			          [&](int32_t index, float height) {
+				          const auto floor = floors[index];
+				          const auto above = height - floor;
+				          if (floor != NoHeight
+				              && above > settings.maxClimb
+				              && above < settings.agentHeight)
+				          {
+					          blocked[index] = 1;
+				          }
+			          });
+		});
+		for (size_t i = 0; i < cells; ++i)
+		{
+			if (blocked[i])
+			{
+				floors[i] = NoHeight;
+			}
+		}
+
+		// Holes next to walkable cells, and both sides of
+		// a step too high, are edges; everything within
+		// the agent's radius of one is too close to stand
+		// on.
+		auto heights = floors;
+		const auto isEdge = [&](int32_t x, int32_t z) {
+			const auto height = floors[z * width + x];
+			constexpr int32_t Offsets[4][2] = {
+			    {1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+			for (const auto& offset : Offsets)
+			{
+				const auto nx = x + offset[0];
+				const auto nz = z + offset[1];
+				if (nx < 0 || nz < 0 || nx >= width
+				    || nz >= width)
+				{
+					continue;
+				}
+				const auto other = floors[nz * width + nx];
+				if (other != NoHeight
+				    && (height == NoHeight
+				        || std::abs(other - height)
+				               > settings.maxClimb))
+				{
+					return true;
+				}
+			}
+			return false;
+		};
+		for (int32_t z = 0; z < width; ++z)
+		{
+			for (int32_t x = 0; x < width; ++x)
+			{
+				if (!isEdge(x, z))
+				{
+					continue;
+				}
+				// A hole's side faces its neighbours; a
+				// step's lies between the cell and the one
+				// across it.
+				const auto hole =
+				    floors[z * width + x] == NoHeight;
+				const auto limit =
+				    hole ? radius + 0.5f
+				         : std::max(radius - 0.5f, 0.0f);
+				for (auto dz = -reach; dz <= reach; ++dz)
+				{
+					for (auto dx = -reach; dx <= reach; ++dx)
+					{
+						const auto ex = x + dx;
+						const auto ez = z + dz;
+						const auto distance =
+						    static_cast<float>(dx * dx + dz * dz);
+						if (ex < 0 || ez < 0 || ex >= width
+						    || ez >= width
+						    || distance > limit * limit)
+						{
+							continue;
+						}
+						heights[ez * width + ex] = NoHeight;
+					}
+				}
+			}
+		}
+
+		auto tile = std::make_shared<TileData>();
+		tile->heights.resize(static_cast<size_t>(size) * size);
+		for (int32_t z = 0; z < size; ++z)
+		{
+			const auto* row =
+			    heights.data() + (z + border) * width + border;
+			std::copy(row, row + size,
+			          tile->heights.begin() + z * size);
+		}
+		return tile;
+	}
+} // namespace AthiVegam::Navigation
@@ -0,0 +1,335 @@
+#include "AthiVegam/Navigation/PathService.h"
+
+#include "AthiVegam/Core/FlatHashMap.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numbers>
+#include <utility>
+
+namespace AthiVegam::Navigation
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+		using Cell = NavMesh::Cell;
+
+		constexpr uint32_t NoParent = ~0u;
+		constexpr float DiagonalCost =
+		    std::numbers::sqrt2_v<float>;
+
+		struct Node
+		{
+			Cell cell;
+			float cost;
+			uint32_t parent;
+			bool closed;
+		};
+
+		struct Open
+		{
+			float estimate;
+			uint32_t node;
+
+			bool operator>(const Open& other) const
+			{
+				return estimate > other.estimate;
+			}
+		};
+
+		// Kept by each worker from search to search.
+		struct Scratch
+		{
+			std::vector<Node> nodes;
+			std::vector<Open> open;
+			Core::FlatHashMap<uint64_t, uint32_t> indices;
+			std::vector<Cell> cells;
+		};
+
+		inline uint64_t GetKey(Cell cell)
+		{
+			return static_cast<uint64_t>(
+			           static_cast<uint32_t>(cell.x))
+			           << 32
+			       | static_cast<uint32_t>(cell.z);
+		}
+
+		// Octile distance, in cells.
+		inline float Heuristic(Cell from, Cell to)
+		{
+			const auto dx = static_cast<float>(
+			    std::abs(to.x - from.x));
+			const auto dz = static_cast<float>(
+			    std::abs(to.z - from.z));
+			return std::max(dx, dz)
+			       + (DiagonalCost - 1.0f) * std::min(dx, dz);
+		}
+
+		inline double Milliseconds(Clock::time_point start)
+		{
+			return std::chrono::duration<double, std::milli>(
+			           Clock::now() - start)
+			    .count();
+		}
+	} // namespace
+
+	PathService::PathService(const NavMesh& mesh)
+	    : PathService(mesh, Settings{})
+	{
+	}
+
+	PathService::PathService(const NavMesh& mesh,
+	                         const Settings& settings)
+	    : m_mesh(mesh), m_settings(settings)
+	{
+	}
+
+	PathService::RequestId
+	PathService::Request(const Math::Vec3& start,
+	                     const Math::Vec3& goal,
+	                     Callback callback)
+	{
+		const auto id = m_nextId++;
+		auto& query = m_queue.emplace_back();
+		query.id = id;
+		query.start = start;
+		query.goal = goal;
+		query.callback = std::move(callback);
+		return id;
+	}
+
+	void PathService::Cancel(RequestId request)
+	{
+		const auto it = std::find_if(
+		    m_queue.begin(), m_queue.end(),
+		    [request](const Query& query) {
+			    return query.id == request;
+		    });
+		if (it != m_queue.end())
+		{
+			m_queue.erase(it);
+		}
+	}
+
+	void PathService::Update()
+	{
+		VEGAM_PROFILE_SCOPE("PathService::Update");
+		const auto start = Clock::now();
+		m_stats = {};
+		if (m_queue.empty())
+		{
+			return;
+		}
+
+		m_batch.assign(std::make_move_iterator(m_queue.begin()),
+		               std::make_move_iterator(m_queue.end()));
+		m_queue.clear();
+		m_nextQuery.store(0, std::memory_order_relaxed);
+
+		// Every worker and this thread take queries until
+		// the batch or the budget runs out.
+		const auto deadline =
+		    start
+		    + std::chrono::duration_cast<Clock::duration>(
+		        std::chrono::duration<float, std::milli>(
+		            m_settings.budgetMs));
+		auto& jobs = Engine::Instance().GetJobManager();
+		const auto helpers = std::min<size_t>(
+		    jobs.GetWorkerCount(), m_batch.size() - 1);
+		Managers::JobCounter counter;
+		for (size_t i = 0; i < helpers; ++i)
+		{
+			jobs.Schedule(
+			    [this, deadline] { RunBatch(deadline); },
+			    &counter);
+		}
+		RunBatch(deadline);
+		jobs.Wait(counter);
+
+		// Unsearched queries keep their place at the front.
+		std::vector<Query> answered;
+		for (auto it = m_batch.rbegin(); it != m_batch.rend();
+		     ++it)
+		{
+			if (!it->searched)
+			{
+				m_queue.push_front(std::move(*it));
+			}
+		}
+		for (auto& query : m_batch)
+		{
+			if (query.searched)
+			{
+				m_stats.nodesExpanded += query.nodesExpanded;
+				answered.push_back(std::move(query));
+			}
+		}
+		m_batch.clear();
+		m_stats.searched = static_cast<uint32_t>(answered.size());
+		m_stats.queued = static_cast<uint32_t>(m_queue.size());
+		m_stats.updateMs = Milliseconds(start);
+
+		// Callbacks may request more paths.
+		for (const auto& query : answered)
+		{
+			query.callback(query.status, query.path);
+		}
+	}
+
+	void PathService::RunBatch(Clock::time_point deadline)
+	{
+		// At least one query each, so every Update() makes
+		// progress however small the budget.
+		do
+		{
+			const auto index = m_nextQuery.fetch_add(
+			    1, std::memory_order_relaxed);
+			if (index >= m_batch.size())
+			{
+				return;
+			}
+			Search(m_batch[index]);
+		} while (Clock::now() < deadline);
+	}
+
+	void PathService::Search(Query& query) const
+	{
+		VEGAM_PROFILE_SCOPE("PathService::Search");
+		query.searched = true;
+		Cell start;
+		Cell goal;
+		if (!m_mesh.FindNearest(query.start,
+		                        m_settings.snapRadius, start)
+		    || !m_mesh.FindNearest(query.goal,
+		                           m_settings.snapRadius, goal))
+		{
+			query.status = Status::NoPath;
+			return;
+		}
+
+		thread_local Scratch scratch;
+		auto& nodes = scratch.nodes;
+		auto& open = scratch.open;
+		auto& indices = scratch.indices;
+		nodes.clear();
+		open.clear();
+		indices.clear();
+
+		nodes.push_back({start, 0.0f, NoParent, false});
+		indices.try_emplace(GetKey(start), 0u);
+		open.push_back({Heuristic(start, goal), 0});
+		// Nearest the goal so far, for partial paths.
+		uint32_t best = 0;
+		auto bestDistance = Heuristic(start, goal);
+		uint32_t reached = NoParent;
+
+		while (!open.empty()
+		       && query.nodesExpanded < m_settings.maxNodes)
+		{
+			std::pop_heap(open.begin(), open.end(),
+			              std::greater<>());
+			const auto current = open.back().node;
+			open.pop_back();
+			if (nodes[current].closed)
+			{
+				continue;
+			}
+			nodes[current].closed = true;
+			++query.nodesExpanded;
+
+			const auto cell = nodes[current].cell;
+			if (cell == goal)
+			{
+				reached = current;
+				break;
+			}
+			const auto distance = Heuristic(cell, goal);
+			if (distance < bestDistance)
+			{
+				bestDistance = distance;
+				best = current;
+			}
+
+			for (int32_t dz = -1; dz <= 1; ++dz)
+			{
+				for (int32_t dx = -1; dx <= 1; ++dx)
+				{
+					const Cell next{cell.x + dx, cell.z + dz};
+					if ((dx == 0 && dz == 0)
+					    || !m_mesh.CanStep(cell, next))
+					{
+						continue;
+					}
+					const auto diagonal = dx != 0 && dz != 0;
+					// Never squeezing past a corner.
+					if (diagonal
+					    && (!m_mesh.CanStep(
+					            cell, {cell.x + dx, cell.z})
+					        || !m_mesh.CanStep(
+					            cell, {cell.x, cell.z + dz})))
+					{
+						continue;
+					}
+
+					const auto cost =
+					    nodes[current].cost
+					    + (diagonal ? DiagonalCost : 1.0f);
+					const auto [it, inserted] =
+					    indices.try_emplace(
+					        GetKey(next),
+					        static_cast<uint32_t>(nodes.size()));
+					const auto index = it->second;
+					if (inserted)
+					{
+						nodes.push_back(
+						    {next, cost, current, false});
+					}
+					else if (nodes[index].closed
+					         || cost >= nodes[index].cost)
+					{
+						continue;
+					}
+					else
+					{
+						nodes[index].cost = cost;
+						nodes[index].parent = current;
+					}
+					open.push_back(
+					    {cost + Heuristic(next, goal), index});
+					std::push_heap(open.begin(), open.end(),
+					               std::greater<>());
+				}
+			}
+		}
+
+		query.status =
+		    reached != NoParent ? Status::Found : Status::Partial;
+		auto& cells = scratch.cells;
+		cells.clear();
+		for (auto node = reached != NoParent ? reached : best;
+		     node != NoParent; node = nodes[node].parent)
+		{
+			cells.push_back(nodes[node].cell);
+		}
+		std::reverse(cells.begin(), cells.end());
+
+		// Only the corners, where the direction changes.
+		query.path.clear();
+		for (size_t i = 0; i < cells.size(); ++i)
+		{
+			if (i > 0 && i + 1 < cells.size()
+			    && cells[i].x - cells[i - 1].x
+			           == cells[i + 1].x - cells[i].x
+			    && cells[i].z - cells[i - 1].z
+			           == cells[i + 1].z - cells[i].z)
+			{
+				continue;
+			}
+			query.path.push_back(m_mesh.GetCenter(cells[i]));
+		}
+	}
+} // namespace AthiVegam::Navigation
@@ -0,0 +1,164 @@
+#include "AthiVegam/Net/BitStream.h"
+
+#include "AthiVegam/Log.h"
+
+#include <cstring>
+
+namespace AthiVegam::Net
+{
+	namespace
+	{
+		// Widths picked by WriteVarUint's 2-bit prefix.
+		constexpr uint32_t VarWidths[4] = {4, 8, 16, 32};
+	}
+
+	uint32_t BitsRequired(uint32_t range)
+	{
+		uint32_t bits = 0;
+		while (bits < 32 && (range >> bits) != 0)
+		{
+			++bits;
+		}
+		return bits;
+	}
+
+	BitWriter::BitWriter(uint8_t* data, size_t capacity)
+	    : m_data(data), m_capacity(capacity)
+	{
+	}
+
+	void BitWriter::WriteBits(uint32_t value, uint32_t bits)
+	{
+		VEGAM_ASSERT(bits <= 32, "At most 32 bits at a time");
+		if (bits == 0 || m_overflowed)
+		{
+			return;
+		}
+		if (m_bits + bits > m_capacity * 8)
+		{
+			m_overflowed = true;
+			return;
+		}
+
+		if (bits < 32)
+		{
+			value &= (1u << bits) - 1;
+		}
+		m_scratch |= static_cast<uint64_t>(value)
+		             << m_scratchBits;
+		m_scratchBits += bits;
+		m_bits += bits;
+		while (m_scratchBits >= 8)
+		{
+			m_data[m_bytes++] = static_cast<uint8_t>(m_scratch);
+			m_scratch >>= 8;
+			m_scratchBits -= 8;
+		}
+	}
+
+	void BitWriter::WriteVarUint(uint32_t value)
+	{
+		uint32_t width = 0;
+		while (width < 3 && (value >> VarWidths[width]) != 0)
+		{
+			++width;
+		}
+		WriteBits(width, 2);
+		WriteBits(value, VarWidths[width]);
+	}
+
+	void BitWriter::WriteBytes(const void* data, size_t size)
+	{
+		Align();
+		if (m_overflowed)
+		{
+			return;
+		}
+		if (m_bytes + size > m_capacity)
+		{
+			m_overflowed = true;
+			return;
+		}
+		if (size > 0)
+		{
+			std::memcpy(m_data + m_bytes, data, size);
+		}
+		m_bytes += size;
+		m_bits += size * 8;
+	}
+
+	void BitWriter::Align()
+	{
+		if (m_scratchBits != 0)
+		{
+			WriteBits(0, 8 - m_scratchBits);
+		}
+	}
+
+	size_t BitWriter::Finish()
+	{
+		Align();
+		return m_bytes;
+	}
+
+	BitReader::BitReader(const uint8_t* data, size_t size)
+	    : m_data(data), m_size(size)
+	{
+	}
+
+	uint32_t BitReader::ReadBits(uint32_t bits)
+	{
+		VEGAM_ASSERT(bits <= 32, "At most 32 bits at a time");
+		if (bits == 0 || m_overflowed)
+		{
+			return 0;
+		}
+		while (m_scratchBits < bits && m_bytes < m_size)
+		{
+			m_scratch |= static_cast<uint64_t>(m_data[m_bytes++])
+			             << m_scratchBits;
+			m_scratchBits += 8;
+		}
+		if (m_scratchBits < bits)
+		{
+			m_overflowed = true;
+			return 0;
+		}
+
+		const auto value = static_cast<uint32_t>(
+		    bits < 32 ? m_scratch & ((1ull << bits) - 1)
+		              : m_scratch);
+		m_scratch >>= bits;
+		m_scratchBits -= bits;
+		return value;
+	}
+
+	uint32_t BitReader::ReadVarUint()
+	{
+		return ReadBits(VarWidths[ReadBits(2)]);
+	}
+
+	bool BitReader::ReadBytes(void* data, size_t size)
+	{
+		Align();
+		if (m_overflowed || m_bytes + size > m_size)
+		{
+			m_overflowed = true;
+			return false;
+		}
+		if (size > 0)
+		{
+			std::memcpy(data, m_data + m_bytes, size);
+		}
+		m_bytes += size;
+		return true;
+	}
+
+	void BitReader::Align()
+	{
+		// Whole bytes are only pulled into the scratch as
+		// needed, so what is left there is padding.
+		m_scratch = 0;
+		m_scratchBits = 0;
+	}
+} // namespace AthiVegam::Net
@@ -0,0 +1,347 @@
+#include "AthiVegam/Net/Connection.h"
+
+#include "AthiVegam/Net/BitStream.h"
+#include "AthiVegam/Net/Sequence.h"
+
+#include <algorithm>
+
+namespace AthiVegam::Net
+{
+	namespace
+	{
+		// Protocol id, sequence, ack flag, ack and ack bits.
+		constexpr size_t HeaderBits = 32 + 16 + 1 + 16 + 32;
+		// Worst case before a message's bytes: more flag,
+		// channel, id, size and alignment.
+		constexpr size_t MessageBits = 1 + 1 + 16 + 34 + 7;
+		constexpr double RttSmoothing = 0.1;
+	} // namespace
+
+	Connection::Connection() : Connection(Settings{}) {}
+
+	Connection::Connection(const Settings& settings)
+	    : m_settings(settings)
+	{
+		Reset();
+	}
+
+	void Connection::Reset()
+	{
+		m_sequence = 0;
+		m_remoteSequence = 0;
+		m_receivedBits = 0;
+		m_receivedAny = false;
+		m_sentPackets.assign(PacketHistory, SentPacket{});
+		m_ackedPackets.clear();
+
+		m_sendQueue.assign(ReliableWindow, Message{});
+		m_sendNext = 0;
+		m_sendOldest = 0;
+		m_receiveQueue.assign(ReliableWindow, Message{});
+		m_receiveNext = 0;
+
+		m_unreliableSendCount = 0;
+		m_unreliableReceivedCount = 0;
+		m_unreliableRead = 0;
+
+		m_lastReceiveTime = 0.0;
+		m_rtt = 0.0;
+		m_bytesSent = 0;
+		m_bytesReceived = 0;
+	}
+
+	bool Connection::Send(Channel channel, const void* data,
+	                      size_t size)
+	{
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		if ((HeaderBits + MessageBits + 1) / 8 + 1 + size
+		    > m_settings.maxPacketSize)
+		{
+			return false;
+		}
+
+		if (channel == Channel::Unreliable)
+		{
+			if (m_unreliableSend.size() == m_unreliableSendCount)
+			{
+				m_unreliableSend.emplace_back();
+			}
+			m_unreliableSend[m_unreliableSendCount++].assign(
+			    bytes, bytes + size);
+			return true;
+		}
+
+		if (static_cast<uint16_t>(m_sendNext - m_sendOldest)
+		    >= ReliableWindow)
+		{
+			return false;
+		}
+		auto& message = m_sendQueue[m_sendNext % ReliableWindow];
+		message.id = m_sendNext++;
+		message.pending = true;
+		message.lastSent = -1.0e9;
+		message.data.assign(bytes, bytes + size);
+		return true;
+	}
+
+	bool Connection::Receive(Channel channel,
+	                         std::vector<uint8_t>& data)
+	{
+		if (channel == Channel::Unreliable)
+		{
+			if (m_unreliableRead == m_unreliableReceivedCount)
+			{
+				m_unreliableRead = 0;
+				m_unreliableReceivedCount = 0;
+				return false;
+			}
+			const auto& message =
+			    m_unreliableReceived[m_unreliableRead++];
+			data.assign(message.begin(), message.end());
+			return true;
+		}
+
+		auto& message =
+		    m_receiveQueue[m_receiveNext % ReliableWindow];
+		if (!message.pending || message.id != m_receiveNext)
+		{
+			return false;
+		}
+		data.assign(message.data.begin(), message.data.end());
+		message.pending = false;
+		++m_receiveNext;
+		return true;
+	}
+
+	size_t Connection::WritePacket(double time, uint8_t* buffer)
+	{
+		BitWriter writer(buffer, m_settings.maxPacketSize);
+		writer.WriteBits(m_settings.protocolId, 32);
+		writer.WriteBits(m_sequence, 16);
+		writer.WriteBool(m_receivedAny);
+		writer.WriteBits(m_remoteSequence, 16);
+		writer.WriteBits(m_receivedBits, 32);
+
+		// Leaves room for the end marker.
+		const auto capacity = m_settings.maxPacketSize * 8 - 1;
+		const auto fits = [&](size_t size) {
+			return writer.GetBitCount() + MessageBits + size * 8
+			       <= capacity;
+		};
+
+		auto& packet = m_sentPackets[m_sequence % PacketHistory];
+		packet.sequence = m_sequence;
+		packet.acked = false;
+		packet.time = time;
+		packet.messageCount = 0;
+
+		// Oldest first, so the window keeps moving.
+		const auto resendTime =
+		    std::max(m_settings.resendTime, m_rtt * 1.25);
+		for (auto id = m_sendOldest;
+		     id != m_sendNext
+		     && packet.messageCount < MaxPacketMessages;
+		     ++id)
+		{
+			auto& message = m_sendQueue[id % ReliableWindow];
+			if (!message.pending
+			    || time - message.lastSent < resendTime
+			    || !fits(message.data.size()))
+			{
+				continue;
+			}
+			writer.WriteBool(true);
+			writer.WriteBits(
+			    static_cast<uint32_t>(Channel::Reliable), 1);
+			writer.WriteBits(id, 16);
+			writer.WriteVarUint(
+			    static_cast<uint32_t>(message.data.size()));
+			writer.WriteBytes(message.data.data(),
+			                  message.data.size());
+			message.lastSent = time;
+			packet.messageIds[packet.messageCount++] = id;
+		}
+
+		for (size_t i = 0; i < m_unreliableSendCount; ++i)
+		{
+			const auto& message = m_unreliableSend[i];
+			if (!fits(message.size()))
+			{
+				continue;
+			}
+			writer.WriteBool(true);
+			writer.WriteBits(
+			    static_cast<uint32_t>(Channel::Unreliable), 1);
+			writer.WriteVarUint(
+			    static_cast<uint32_t>(message.size()));
+			writer.WriteBytes(message.data(), message.size());
+		}
+		m_unreliableSendCount = 0;
+
+		writer.WriteBool(false);
+		const auto size = writer.Finish();
+		++m_sequence;
+		m_bytesSent += size;
+		return size;
+	}
+
+	bool Connection::ReadPacket(double time, const uint8_t* data,
+	                            size_t size)
+	{
+		m_ackedPackets.clear();
+		if (size > m_settings.maxPacketSize)
+		{
+			return false;
+		}
+		BitReader reader(data, size);
+		if (reader.ReadBits(32) != m_settings.protocolId)
+		{
+			return false;
+		}
+		const auto sequence =
+		    static_cast<uint16_t>(reader.ReadBits(16));
+		const bool hasAcks = reader.ReadBool();
+		const auto ack =
+		    static_cast<uint16_t>(reader.ReadBits(16));
+		const auto ackBits = reader.ReadBits(32);
+		if (reader.HasOverflowed())
+		{
+			return false;
+		}
+
+		// Duplicates, and packets too old to acknowledge.
+		const auto age =
+		    static_cast<uint16_t>(m_remoteSequence - sequence);
+		if (m_receivedAny
+		    && !IsSequenceNewer(sequence, m_remoteSequence)
+		    && (age == 0 || age > 32
+		        || (m_receivedBits & 1u << (age - 1)) != 0))
+		{
+			return false;
+		}
+
+		std::vector<uint8_t> skipped;
+		while (reader.ReadBool())
+		{
+			const auto channel =
+			    static_cast<Channel>(reader.ReadBits(1));
+			std::vector<uint8_t>* target = &skipped;
+			Message* reliable = nullptr;
+			uint16_t id = 0;
+			if (channel == Channel::Reliable)
+			{
+				// Skipped past the window, or when already
+				// here.
+				id = static_cast<uint16_t>(reader.ReadBits(16));
+				auto& message =
+				    m_receiveQueue[id % ReliableWindow];
+				if (static_cast<uint16_t>(id - m_receiveNext)
+				        < ReliableWindow
+				    && !(message.pending && message.id == id))
+				{
+					reliable = &message;
+					target = &message.data;
+				}
+			}
+			else
+			{
+				if (m_unreliableReceived.size()
+				    == m_unreliableReceivedCount)
+				{
+					m_unreliableReceived.emplace_back();
+				}
+				target = &m_unreliableReceived
+				              [m_unreliableReceivedCount++];
+			}
+
+			const auto length = reader.ReadVarUint();
+			if (length > size)
+			{
+				return false;
+			}
+			target->resize(length);
+			if (!reader.ReadBytes(target->data(), length))
+			{
+				return false;
+			}
+			if (reliable != nullptr)
+			{
+				reliable->id = id;
+				reliable->pending = true;
+			}
+		}
+		if (reader.HasOverflowed())
+		{
+			return false;
+		}
+
+		if (!m_receivedAny)
+		{
+			m_receivedAny = true;
+			m_remoteSequence = sequence;
+		}
+		else if (IsSequenceNewer(sequence, m_remoteSequence))
+		{
+			const auto shift = static_cast<uint16_t>(
+			    sequence - m_remoteSequence);
+			m_receivedBits =
+			    shift < 32
+			        ? m_receivedBits << shift | 1u << (shift - 1)
+			    : shift == 32 ? 1u << 31
+			                  : 0;
+			m_remoteSequence = sequence;
+		}
+		else
+		{
+			m_receivedBits |= 1u << (age - 1);
+		}
+
+		if (hasAcks)
+		{
+			OnAcked(ack, time);
+			for (uint32_t n = 0; n < 32; ++n)
+			{
+				if ((ackBits & 1u << n) != 0)
+				{
+					OnAcked(
+					    static_cast<uint16_t>(ack - 1 - n), time);
+				}
+			}
+		}
+		m_lastReceiveTime = time;
+		m_bytesReceived += size;
+		return true;
+	}
+
+	void Connection::OnAcked(uint16_t sequence, double time)
+	{
+		auto& packet = m_sentPackets[sequence % PacketHistory];
+		if (packet.acked || packet.sequence != sequence)
+		{
+			return;
+		}
+		packet.acked = true;
+		m_ackedPackets.push_back(sequence);
+
+		const auto sample = time - packet.time;
+		m_rtt = m_rtt == 0.0
+		            ? sample
+		            : m_rtt + (sample - m_rtt) * RttSmoothing;
+
+		for (uint32_t i = 0; i < packet.messageCount; ++i)
+		{
+			const auto id = packet.messageIds[i];
+			auto& message = m_sendQueue[id % ReliableWindow];
+			if (message.pending && message.id == id)
+			{
+				message.pending = false;
+			}
+		}
+		while (m_sendOldest != m_sendNext
+		       && !m_sendQueue[m_sendOldest % ReliableWindow]
+		               .pending)
+		{
+			++m_sendOldest;
+		}
+	}
+} // namespace AthiVegam::Net
@@ -0,0 +1,195 @@
+#include "AthiVegam/Net/Host.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Log.h"
+
+namespace AthiVegam::Net
+{
+	Host::Host() : Host(Settings{}) {}
+
+	Host::Host(const Settings& settings) : m_settings(settings)
+	{
+		m_buffer.resize(m_settings.connection.maxPacketSize);
+	}
+
+	bool Host::Listen(uint16_t port)
+	{
+		Close();
+		m_listening = m_socket.Open(port);
+		if (m_listening)
+		{
+			VEGAM_INFO("Listening on UDP port {}",
+			           m_socket.GetPort());
+		}
+		return m_listening;
+	}
+
+	Host::PeerId Host::Connect(const Address& server,
+	                           double time)
+	{
+		Close();
+		if (!m_socket.Open())
+		{
+			return InvalidPeer;
+		}
+		m_time = time;
+		return AddPeer(server);
+	}
+
+	void Host::Disconnect(PeerId peer)
+	{
+		if (peer < m_peers.size() && m_peers[peer].active)
+		{
+			RemovePeer(peer, false);
+		}
+	}
+
+	void Host::Close()
+	{
+		m_socket.Close();
+		m_listening = false;
+		m_peers.clear();
+		m_peerIds.clear();
+		m_peerCount = 0;
+		m_events.clear();
+		m_eventRead = 0;
+	}
+
+	void Host::Update(double time)
+	{
+		VEGAM_PROFILE_SCOPE("Host::Update");
+		m_time = time;
+
+		Address from;
+		while (const auto size = m_socket.Receive(
+		           from, m_buffer.data(), m_buffer.size()))
+		{
+			auto peer = InvalidPeer;
+			if (const auto it = m_peerIds.find(from.GetKey());
+			    it != m_peerIds.end())
+			{
+				peer = it->second;
+			}
+			else if (m_listening
+			         && m_peerCount < m_settings.maxPeers)
+			{
+				peer = AddPeer(from);
+			}
+			if (peer == InvalidPeer)
+			{
+				continue;
+			}
+
+			auto& entry = m_peers[peer];
+			if (!entry.connection.ReadPacket(
+			        time, m_buffer.data(), size))
+			{
+				// Strangers get no slot for noise.
+				if (m_listening && !entry.connected)
+				{
+					RemovePeer(peer, false);
+				}
+				continue;
+			}
+			entry.lastReceive = time;
+			if (!entry.connected)
+			{
+				entry.connected = true;
+				m_events.push_back(
+				    {Event::Type::Connected, peer});
+			}
+		}
+
+		for (PeerId peer = 0; peer < m_peers.size(); ++peer)
+		{
+			const auto& entry = m_peers[peer];
+			if (entry.active
+			    && time - entry.lastReceive > m_settings.timeout)
+			{
+				RemovePeer(peer, true);
+			}
+		}
+	}
+
+	bool Host::PollEvent(Event& event)
+	{
+		if (m_eventRead == m_events.size())
+		{
+			m_events.clear();
+			m_eventRead = 0;
+			return false;
+		}
+		event = m_events[m_eventRead++];
+		return true;
+	}
+
+	bool Host::Send(PeerId peer, Channel channel,
+	                const void* data, size_t size)
+	{
+		return peer < m_peers.size() && m_peers[peer].active
+		       && m_peers[peer].connection.Send(channel, data,
+		                                        size);
+	}
+
+	bool Host::Receive(PeerId peer, Channel channel,
+	                   std::vector<uint8_t>& data)
+	{
+		return peer < m_peers.size() && m_peers[peer].active
+		       && m_peers[peer].connection.Receive(channel, data);
+	}
+
+	void Host::Flush(double time)
+	{
+		VEGAM_PROFILE_SCOPE("Host::Flush");
+		for (auto& peer : m_peers)
+		{
+			if (peer.active)
+			{
+				const auto size = peer.connection.WritePacket(
+				    time, m_buffer.data());
+				m_socket.Send(peer.address, m_buffer.data(),
+				              size);
+			}
+		}
+	}
+
+	Host::PeerId Host::AddPeer(const Address& address)
+	{
+		PeerId id = 0;
+		while (id < m_peers.size() && m_peers[id].active)
+		{
+			++id;
+		}
+		if (id == m_peers.size())
+		{
+			m_peers.push_back({address,
+			                   Connection(m_settings.connection)});
+		}
+
+		auto& peer = m_peers[id];
+		peer.address = address;
+		peer.connection.Reset();
+		peer.active = true;
+		peer.connected = false;
+		peer.lastReceive = m_time;
+		m_peerIds[address.GetKey()] = id;
+		++m_peerCount;
+		return id;
+	}
+
+	void Host::RemovePeer(PeerId peer, bool notify)
+	{
+		auto& entry = m_peers[peer];
+		if (notify)
+		{
+			VEGAM_INFO("Peer {} timed out",
+			           entry.address.ToString());
+			m_events.push_back(
+			    {Event::Type::Disconnected, peer});
+		}
+		m_peerIds.erase(entry.address.GetKey());
+		entry.active = false;
+		entry.connected = false;
+		--m_peerCount;
+	}
+} // namespace AthiVegam::Net
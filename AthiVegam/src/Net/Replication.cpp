@@ -0,0 +1,473 @@
+#include "AthiVegam/Net/Replication.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Net/BitStream.h"
+#include "AthiVegam/Net/Sequence.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace AthiVegam::Net
+{
+	namespace
+	{
+		constexpr uint32_t HistorySize =
+		    ReplicationServer::HistorySize;
+	}
+
+	uint32_t SnapshotSchema::AddFloat(float min, float max,
+	                                  float precision)
+	{
+		VEGAM_ASSERT(max > min && precision > 0.0f,
+		             "Empty float field range");
+		Field field;
+		field.min = min;
+		field.precision = precision;
+		field.maxValue = static_cast<uint32_t>(
+		    std::ceil((max - min) / precision));
+		field.bits = BitsRequired(field.maxValue);
+		m_fields.push_back(field);
+		return GetFieldCount() - 1;
+	}
+
+	uint32_t SnapshotSchema::AddInt(int32_t min, int32_t max)
+	{
+		VEGAM_ASSERT(max >= min, "Empty int field range");
+		Field field;
+		field.intMin = min;
+		field.maxValue = static_cast<uint32_t>(
+		    static_cast<int64_t>(max) - min);
+		field.bits = BitsRequired(field.maxValue);
+		m_fields.push_back(field);
+		return GetFieldCount() - 1;
+	}
+
+	uint32_t SnapshotSchema::Quantize(uint32_t field,
+	                                  float value) const
+	{
+		const auto& f = m_fields[field];
+		const auto steps =
+		    std::round((value - f.min) / f.precision);
+		return static_cast<uint32_t>(std::clamp(
+		    steps, 0.0f, static_cast<float>(f.maxValue)));
+	}
+
+	float SnapshotSchema::Dequantize(uint32_t field,
+	                                 uint32_t value) const
+	{
+		const auto& f = m_fields[field];
+		return f.min
+		       + static_cast<float>(std::min(value, f.maxValue))
+		             * f.precision;
+	}
+
+	uint32_t SnapshotSchema::QuantizeInt(uint32_t field,
+	                                     int32_t value) const
+	{
+		const auto& f = m_fields[field];
+		const auto offset = static_cast<int64_t>(value) - f.intMin;
+		return static_cast<uint32_t>(std::clamp<int64_t>(
+		    offset, 0, static_cast<int64_t>(f.maxValue)));
+	}
+
+	int32_t SnapshotSchema::DequantizeInt(uint32_t field,
+	                                      uint32_t value) const
+	{
+		const auto& f = m_fields[field];
+		return static_cast<int32_t>(
+		    static_cast<int64_t>(std::min(value, f.maxValue))
+		    + f.intMin);
+	}
+
+	const uint32_t* Snapshot::Find(uint32_t id,
+	                               uint32_t fieldCount) const
+	{
+		const auto it =
+		    std::lower_bound(ids.begin(), ids.end(), id);
+		if (it == ids.end() || *it != id)
+		{
+			return nullptr;
+		}
+		return values.data() + (it - ids.begin()) * fieldCount;
+	}
+
+	ReplicationServer::ReplicationServer(
+	    const SnapshotSchema& schema)
+	    : m_schema(schema), m_zeros(schema.GetFieldCount()),
+	      m_history(HistorySize), m_captured(HistorySize)
+	{
+	}
+
+	void ReplicationServer::SetEntity(uint32_t id,
+	                                  const uint32_t* values)
+	{
+		const auto fieldCount = m_schema.GetFieldCount();
+		const auto it =
+		    std::lower_bound(m_ids.begin(), m_ids.end(), id);
+		const auto offset = (it - m_ids.begin()) * fieldCount;
+		if (it == m_ids.end() || *it != id)
+		{
+			m_ids.insert(it, id);
+			m_values.insert(m_values.begin() + offset, values,
+			                values + fieldCount);
+			return;
+		}
+		std::copy_n(values, fieldCount, m_values.begin() + offset);
+	}
+
+	void ReplicationServer::RemoveEntity(uint32_t id)
+	{
+		const auto fieldCount = m_schema.GetFieldCount();
+		const auto it =
+		    std::lower_bound(m_ids.begin(), m_ids.end(), id);
+		if (it == m_ids.end() || *it != id)
+		{
+			return;
+		}
+		const auto offset = m_values.begin()
+		                    + (it - m_ids.begin()) * fieldCount;
+		m_values.erase(offset, offset + fieldCount);
+		m_ids.erase(it);
+	}
+
+	uint16_t ReplicationServer::Capture()
+	{
+		VEGAM_PROFILE_SCOPE("ReplicationServer::Capture");
+		if (m_hasSnapshot)
+		{
+			++m_sequence;
+		}
+		m_hasSnapshot = true;
+
+		const auto slot = m_sequence % HistorySize;
+		auto& snapshot = m_history[slot];
+		snapshot.sequence = m_sequence;
+		snapshot.ids.assign(m_ids.begin(), m_ids.end());
+		snapshot.values.assign(m_values.begin(), m_values.end());
+		m_captured[slot] = true;
+
+		m_encodings.clear();
+		m_encoded.clear();
+		return m_sequence;
+	}
+
+	ReplicationServer::ClientId ReplicationServer::AddClient()
+	{
+		ClientId id = 0;
+		while (id < m_clients.size() && m_clients[id].active)
+		{
+			++id;
+		}
+		if (id == m_clients.size())
+		{
+			m_clients.emplace_back();
+		}
+		m_clients[id] = {};
+		m_clients[id].active = true;
+		return id;
+	}
+
+	void ReplicationServer::RemoveClient(ClientId client)
+	{
+		m_clients[client].active = false;
+	}
+
+	void ReplicationServer::Acknowledge(ClientId client,
+	                                    uint16_t sequence)
+	{
+		auto& state = m_clients[client];
+		if (FindSnapshot(sequence) == nullptr
+		    || (state.hasBaseline
+		        && !IsSequenceNewer(sequence, state.baseline)))
+		{
+			return;
+		}
+		state.hasBaseline = true;
+		state.baseline = sequence;
+	}
+
+	size_t ReplicationServer::Write(ClientId client,
+	                                uint8_t* buffer,
+	                                size_t capacity)
+	{
+		if (!m_hasSnapshot || client >= m_clients.size()
+		    || !m_clients[client].active)
+		{
+			return 0;
+		}
+
+		auto& state = m_clients[client];
+		const Snapshot* baseline = nullptr;
+		if (state.hasBaseline)
+		{
+			baseline = FindSnapshot(state.baseline);
+			state.hasBaseline = baseline != nullptr;
+		}
+
+		for (const auto& encoding : m_encodings)
+		{
+			if (encoding.baseline == baseline)
+			{
+				if (encoding.size > capacity)
+				{
+					return 0;
+				}
+				std::memcpy(buffer,
+				            m_encoded.data() + encoding.offset,
+				            encoding.size);
+				return encoding.size;
+			}
+		}
+
+		VEGAM_PROFILE_SCOPE("ReplicationServer::Encode");
+		BitWriter writer(buffer, capacity);
+		Encode(baseline, m_history[m_sequence % HistorySize],
+		       writer);
+		const auto size = writer.Finish();
+		if (writer.HasOverflowed())
+		{
+			return 0;
+		}
+		m_encodings.push_back({baseline, m_encoded.size(), size});
+		m_encoded.insert(m_encoded.end(), buffer, buffer + size);
+		return size;
+	}
+
+	const Snapshot*
+	ReplicationServer::FindSnapshot(uint16_t sequence) const
+	{
+		const auto slot = sequence % HistorySize;
+		if (!m_hasSnapshot || !m_captured[slot]
+		    || m_history[slot].sequence != sequence
+		    || static_cast<uint16_t>(m_sequence - sequence)
+		           >= HistorySize)
+		{
+			return nullptr;
+		}
+		return &m_history[slot];
+	}
+
+	// Sequence, then the baseline's if any. Entities new or
+	// changed since the baseline follow in id order, each
+	// as the gap from the last id and a flag per field,
+	// with the value if it changed; new entities count from
+	// all zeros. Then the ids of entities removed since.
+	void ReplicationServer::Encode(const Snapshot* baseline,
+	                               const Snapshot& snapshot,
+	                               BitWriter& writer) const
+	{
+		const auto fieldCount = m_schema.GetFieldCount();
+		writer.WriteBits(snapshot.sequence, 16);
+		writer.WriteBool(baseline != nullptr);
+		if (baseline != nullptr)
+		{
+			writer.WriteBits(baseline->sequence, 16);
+		}
+
+		static const Snapshot empty;
+		const auto& base = baseline ? *baseline : empty;
+		size_t j = 0;
+		uint32_t next = 0;
+		for (size_t i = 0; i < snapshot.ids.size(); ++i)
+		{
+			const auto id = snapshot.ids[i];
+			const auto* values =
+			    snapshot.values.data() + i * fieldCount;
+			while (j < base.ids.size() && base.ids[j] < id)
+			{
+				++j;
+			}
+			const auto* old = m_zeros.data();
+			if (j < base.ids.size() && base.ids[j] == id)
+			{
+				old = base.values.data() + j * fieldCount;
+				if (std::equal(values, values + fieldCount, old))
+				{
+					continue;
+				}
+			}
+
+			writer.WriteBool(true);
+			writer.WriteVarUint(id - next);
+			next = id + 1;
+			for (uint32_t f = 0; f < fieldCount; ++f)
+			{
+				const bool changed = values[f] != old[f];
+				writer.WriteBool(changed);
+				if (changed)
+				{
+					writer.WriteBits(values[f],
+					                 m_schema.GetBits(f));
+				}
+			}
+		}
+		writer.WriteBool(false);
+
+		size_t i = 0;
+		next = 0;
+		for (const auto id : base.ids)
+		{
+			while (i < snapshot.ids.size() && snapshot.ids[i] < id)
+			{
+				++i;
+			}
+			if (i == snapshot.ids.size() || snapshot.ids[i] != id)
+			{
+				writer.WriteBool(true);
+				writer.WriteVarUint(id - next);
+				next = id + 1;
+			}
+		}
+		writer.WriteBool(false);
+	}
+
+	ReplicationClient::ReplicationClient(
+	    const SnapshotSchema& schema)
+	    : m_schema(schema), m_history(HistorySize),
+	      m_received(HistorySize)
+	{
+	}
+
+	bool ReplicationClient::Read(const uint8_t* data,
+	                             size_t size)
+	{
+		BitReader reader(data, size);
+		const auto sequence =
+		    static_cast<uint16_t>(reader.ReadBits(16));
+		const bool hasBaseline = reader.ReadBool();
+		const auto baselineSequence = static_cast<uint16_t>(
+		    hasBaseline ? reader.ReadBits(16) : 0);
+		if (reader.HasOverflowed()
+		    || (m_hasSnapshot
+		        && !IsSequenceNewer(sequence, m_sequence)))
+		{
+			return false;
+		}
+
+		static const Snapshot empty;
+		const Snapshot* baseline = &empty;
+		if (hasBaseline)
+		{
+			const auto slot = baselineSequence % HistorySize;
+			if (!m_received[slot]
+			    || m_history[slot].sequence != baselineSequence)
+			{
+				return false;
+			}
+			baseline = &m_history[slot];
+		}
+
+		const auto slot = sequence % HistorySize;
+		auto& snapshot = m_history[slot];
+		if (&snapshot == baseline)
+		{
+			return false;
+		}
+		m_received[slot] = false;
+		if (!Decode(*baseline, reader, snapshot))
+		{
+			return false;
+		}
+		snapshot.sequence = sequence;
+		m_received[slot] = true;
+		m_sequence = sequence;
+		m_hasSnapshot = true;
+		return true;
+	}
+
+	bool ReplicationClient::Decode(const Snapshot& baseline,
+	                               BitReader& reader,
+	                               Snapshot& snapshot)
+	{
+		const auto fieldCount = m_schema.GetFieldCount();
+		snapshot.ids.clear();
+		snapshot.values.clear();
+
+		size_t j = 0;
+		const auto copyBefore = [&](uint64_t id) {
+			for (; j < baseline.ids.size() && baseline.ids[j] < id;
+			     ++j)
+			{
+				snapshot.ids.push_back(baseline.ids[j]);
+				const auto* values =
+				    baseline.values.data() + j * fieldCount;
+				snapshot.values.insert(snapshot.values.end(),
+				                       values,
+				                       values + fieldCount);
+			}
+		};
+
+		uint64_t next = 0;
+		while (reader.ReadBool())
+		{
+			const auto id = next + reader.ReadVarUint();
+			if (id > UINT32_MAX || reader.HasOverflowed())
+			{
+				return false;
+			}
+			next = id + 1;
+			copyBefore(id);
+
+			const auto offset = snapshot.values.size();
+			snapshot.ids.push_back(static_cast<uint32_t>(id));
+			if (j < baseline.ids.size() && baseline.ids[j] == id)
+			{
+				const auto* values =
+				    baseline.values.data() + j++ * fieldCount;
+				snapshot.values.insert(snapshot.values.end(),
+				                       values,
+				                       values + fieldCount);
+			}
+			else
+			{
+				snapshot.values.resize(offset + fieldCount, 0);
+			}
+			for (uint32_t f = 0; f < fieldCount; ++f)
+			{
+				if (reader.ReadBool())
+				{
+					snapshot.values[offset + f] =
+					    reader.ReadBits(m_schema.GetBits(f));
+				}
+			}
+		}
+		copyBefore(UINT64_MAX);
+
+		// Removals come in id order too.
+		size_t kept = 0;
+		size_t i = 0;
+		next = 0;
+		const auto keepBefore = [&](uint64_t id) {
+			for (; i < snapshot.ids.size() && snapshot.ids[i] < id;
+			     ++i, ++kept)
+			{
+				if (kept == i)
+				{
+					continue;
+				}
+				snapshot.ids[kept] = snapshot.ids[i];
+				std::copy_n(snapshot.values.begin()
+				                + i * fieldCount,
+				            fieldCount,
+				            snapshot.values.begin()
+				                + kept * fieldCount);
+			}
+		};
+		while (reader.ReadBool())
+		{
+			const auto id = next + reader.ReadVarUint();
+			next = id + 1;
+			keepBefore(id);
+			if (i < snapshot.ids.size() && snapshot.ids[i] == id)
+			{
+				++i;
+			}
+		}
+		keepBefore(UINT64_MAX);
+		snapshot.ids.resize(kept);
+		snapshot.values.resize(kept * fieldCount);
+		return !reader.HasOverflowed();
+	}
+} // namespace AthiVegam::Net
@@ -0,0 +1,158 @@
+#include "AthiVegam/Net/Rollback.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+namespace AthiVegam::Net
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		inline double Milliseconds(Clock::time_point start)
+		{
+			return std::chrono::duration<double, std::milli>(
+			           Clock::now() - start)
+			    .count();
+		}
+	} // namespace
+
+	Rollback::Rollback(Ecs::Registry& registry,
+	                   const Settings& settings, Step step)
+	    : m_registry(registry),
+	      m_settings(settings),
+	      m_step(std::move(step)),
+	      m_states(settings.maxRollback + 1),
+	      m_frames(2 * (size_t{settings.maxRollback} + 1))
+	{
+		VEGAM_ASSERT(settings.players > 0
+		                 && settings.inputSize > 0,
+		             "Rollback needs players and inputs");
+	}
+
+	bool Rollback::SetInput(uint32_t player, uint64_t tick,
+	                        std::span<const uint8_t> input)
+	{
+		VEGAM_ASSERT(player < m_settings.players,
+		             "Player out of range");
+		VEGAM_ASSERT(input.size() == m_settings.inputSize,
+		             "Input of the wrong size");
+		if (tick + m_settings.maxRollback < m_tick
+		    || tick > m_tick + m_settings.maxRollback)
+		{
+			VEGAM_WARN("Input of player {} for tick {} is "
+			           "outside the rollback window at {}",
+			           player, tick, m_tick);
+			return false;
+		}
+
+		auto& frame = GetFrame(tick);
+		auto* dst = frame.inputs.data()
+		            + size_t{player} * m_settings.inputSize;
+		if (tick < m_tick
+		    && std::memcmp(dst, input.data(), input.size()) != 0)
+		{
+			m_mispredicted = std::min(m_mispredicted, tick);
+		}
+		std::memcpy(dst, input.data(), input.size());
+		frame.confirmed[player] = 1;
+		return true;
+	}
+
+	void Rollback::Advance()
+	{
+		VEGAM_PROFILE_SCOPE("Rollback::Advance");
+		m_stats.resimulatedTicks = 0;
+		m_stats.restoreMs = 0.0;
+		m_stats.resimulateMs = 0.0;
+		if (m_mispredicted < m_tick)
+		{
+			auto start = Clock::now();
+			if (m_states.Restore(m_registry, m_mispredicted))
+			{
+				m_stats.restoreMs = Milliseconds(start);
+				start = Clock::now();
+				for (auto tick = m_mispredicted; tick < m_tick;
+				     ++tick)
+				{
+					Simulate(tick);
+				}
+				m_stats.resimulateMs = Milliseconds(start);
+				m_stats.resimulatedTicks = static_cast<uint32_t>(
+				    m_tick - m_mispredicted);
+				++m_stats.rollbacks;
+			}
+			else
+			{
+				VEGAM_ERROR("Cannot roll back to tick {}",
+				            m_mispredicted);
+			}
+		}
+		m_mispredicted = Ecs::RollbackBuffer::NoTick;
+
+		Simulate(m_tick);
+		++m_tick;
+
+		while (m_confirmed < m_tick)
+		{
+			const auto& frame =
+			    m_frames[m_confirmed % m_frames.size()];
+			if (frame.tick != m_confirmed
+			    || std::find(frame.confirmed.begin(),
+			                 frame.confirmed.end(), 0)
+			           != frame.confirmed.end())
+			{
+				break;
+			}
+			++m_confirmed;
+		}
+	}
+
+	Rollback::Frame& Rollback::GetFrame(uint64_t tick)
+	{
+		auto& frame = m_frames[tick % m_frames.size()];
+		if (frame.tick != tick)
+		{
+			frame.tick = tick;
+			frame.inputs.assign(size_t{m_settings.players}
+			                        * m_settings.inputSize,
+			                    0);
+			frame.confirmed.assign(m_settings.players, 0);
+		}
+		return frame;
+	}
+
+	void Rollback::Simulate(uint64_t tick)
+	{
+		auto& frame = GetFrame(tick);
+		// Predicted inputs repeat the tick before's, itself
+		// perhaps predicted; the first tick's are zero.
+		const auto& previous =
+		    m_frames[(tick - 1) % m_frames.size()];
+		if (tick > 0 && previous.tick == tick - 1)
+		{
+			const auto size = m_settings.inputSize;
+			for (uint32_t player = 0;
+			     player < m_settings.players; ++player)
+			{
+				const auto offset = size_t{player} * size;
+				if (!frame.confirmed[player])
+				{
+					std::memcpy(frame.inputs.data() + offset,
+					            previous.inputs.data() + offset,
+					            size);
+				}
+			}
+		}
+
+		const auto start = Clock::now();
+		m_states.Save(m_registry, tick);
+		m_stats.saveMs = Milliseconds(start);
+		m_step(tick, frame.inputs);
+	}
+} // namespace AthiVegam::Net
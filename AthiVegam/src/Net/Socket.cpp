@@ -0,0 +1,226 @@
+#include "AthiVegam/Net/Socket.h"
+
+#include "AthiVegam/Log.h"
+
+#include <cstdlib>
+
+#ifdef AV_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif // AV_PLATFORM_WINDOWS
+
+namespace AthiVegam::Net
+{
+	namespace
+	{
+#ifdef AV_PLATFORM_WINDOWS
+		using Handle = SOCKET;
+		using Length = int;
+
+		// Winsock counts startups; each socket holds one.
+		inline void CloseHandle(Handle handle)
+		{
+			closesocket(handle);
+			WSACleanup();
+		}
+#else
+		using Handle = int;
+		using Length = socklen_t;
+
+		inline void CloseHandle(Handle handle)
+		{
+			close(handle);
+		}
+#endif // AV_PLATFORM_WINDOWS
+
+		inline sockaddr_in ToSockaddr(const Address& address)
+		{
+			sockaddr_in result{};
+			result.sin_family = AF_INET;
+			result.sin_addr.s_addr = htonl(address.host);
+			result.sin_port = htons(address.port);
+			return result;
+		}
+	} // namespace
+
+	bool Address::Parse(const std::string& text,
+	                    Address& address)
+	{
+		const auto colon = text.rfind(':');
+		if (colon == std::string::npos || colon == 0)
+		{
+			return false;
+		}
+		const auto name = text.substr(0, colon);
+		const auto port = std::strtoul(
+		    text.c_str() + colon + 1, nullptr, 10);
+		if (port == 0 || port > 0xFFFF)
+		{
+			return false;
+		}
+
+		addrinfo hints{};
+		hints.ai_family = AF_INET;
+		hints.ai_socktype = SOCK_DGRAM;
+		addrinfo* results = nullptr;
+		if (getaddrinfo(name.c_str(), nullptr, &hints, &results)
+		        != 0
+		    || results == nullptr)
+		{
+			VEGAM_WARN("Could not resolve {}", name);
+			return false;
+		}
+		const auto* resolved =
+		    reinterpret_cast<const sockaddr_in*>(
+		        results->ai_addr);
+		address.host = ntohl(resolved->sin_addr.s_addr);
+		address.port = static_cast<uint16_t>(port);
+		freeaddrinfo(results);
+		return true;
+	}
+
+	std::string Address::ToString() const
+	{
+		return std::to_string(host >> 24) + "."
+		       + std::to_string(host >> 16 & 0xFF) + "."
+		       + std::to_string(host >> 8 & 0xFF) + "."
+		       + std::to_string(host & 0xFF) + ":"
+		       + std::to_string(port);
+	}
+
+	UdpSocket::~UdpSocket() { Close(); }
+
+	bool UdpSocket::Open(uint16_t port)
+	{
+		Close();
+#ifdef AV_PLATFORM_WINDOWS
+		WSADATA data;
+		if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+		{
+			VEGAM_ERROR("WSAStartup failed");
+			return false;
+		}
+#endif // AV_PLATFORM_WINDOWS
+
+		auto handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (handle == static_cast<Handle>(Invalid))
+		{
+			VEGAM_ERROR("Could not create a UDP socket");
+#ifdef AV_PLATFORM_WINDOWS
+			WSACleanup();
+#endif // AV_PLATFORM_WINDOWS
+			return false;
+		}
+		m_socket = static_cast<uintptr_t>(handle);
+
+		sockaddr_in local{};
+		local.sin_family = AF_INET;
+		local.sin_addr.s_addr = htonl(INADDR_ANY);
+		local.sin_port = htons(port);
+		Length length = sizeof(local);
+#ifdef AV_PLATFORM_WINDOWS
+		u_long nonBlocking = 1;
+		const bool configured =
+		    ioctlsocket(handle, FIONBIO, &nonBlocking) == 0;
+#else
+		const bool configured =
+		    fcntl(handle, F_SETFL,
+		          fcntl(handle, F_GETFL, 0) | O_NONBLOCK)
+		    == 0;
+#endif // AV_PLATFORM_WINDOWS
+		if (!configured
+		    || bind(handle,
+		            reinterpret_cast<const sockaddr*>(&local),
+		            sizeof(local))
+		           != 0
+		    || getsockname(handle,
+		                   reinterpret_cast<sockaddr*>(&local),
+		                   &length)
+		           != 0)
+		{
+			VEGAM_ERROR("Could not bind a UDP socket to port {}",
+			            port);
+			Close();
+			return false;
+		}
+		m_port = ntohs(local.sin_port);
+		return true;
+	}
+
+	void UdpSocket::Close()
+	{
+		if (m_socket != Invalid)
+		{
+			CloseHandle(static_cast<Handle>(m_socket));
+			m_socket = Invalid;
+		}
+		m_port = 0;
+	}
+
+	bool UdpSocket::Send(const Address& to, const uint8_t* data,
+	                     size_t size)
+	{
+		if (!IsOpen())
+		{
+			return false;
+		}
+		const auto remote = ToSockaddr(to);
+		const auto sent = sendto(
+		    static_cast<Handle>(m_socket),
+		    reinterpret_cast<const char*>(data),
+		    static_cast<int>(size), 0,
+		    reinterpret_cast<const sockaddr*>(&remote),
+		    sizeof(remote));
+		return sent >= 0 && static_cast<size_t>(sent) == size;
+	}
+
+	size_t UdpSocket::Receive(Address& from, uint8_t* buffer,
+	                          size_t capacity)
+	{
+		if (!IsOpen())
+		{
+			return 0;
+		}
+		for (;;)
+		{
+			sockaddr_in remote{};
+			Length length = sizeof(remote);
+			const auto received = recvfrom(
+			    static_cast<Handle>(m_socket),
+			    reinterpret_cast<char*>(buffer),
+			    static_cast<int>(capacity), 0,
+			    reinterpret_cast<sockaddr*>(&remote), &length);
+			if (received > 0)
+			{
+				from.host = ntohl(remote.sin_addr.s_addr);
+				from.port = ntohs(remote.sin_port);
+				return static_cast<size_t>(received);
+			}
+			if (received == 0)
+			{
+				continue;
+			}
+#ifdef AV_PLATFORM_WINDOWS
+			// Oversized datagrams, and the reset reported
+			// after sending to a port nobody listens on.
+			const auto error = WSAGetLastError();
+			if (error == WSAEMSGSIZE || error == WSAECONNRESET)
+			{
+				continue;
+			}
+#endif // AV_PLATFORM_WINDOWS
+			// Nothing waiting, or a real error.
+			return 0;
+		}
+	}
+} // namespace AthiVegam::Net
@@ -0,0 +1,496 @@
+#include "AthiVegam/Physics/Collision.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace AthiVegam::Physics
+{
+	namespace
+	{
+		using Math::Vec3;
+
+		constexpr Vec3 UnitAxes[3] = {{1.0f, 0.0f, 0.0f},
+		                              {0.0f, 1.0f, 0.0f},
+		                              {0.0f, 0.0f, 1.0f}};
+		// A separating axis of the second box, or across two
+		// edges, is only taken over the best one so far if
+		// it is this much shallower, so nearly equal axes do
+		// not flip the manifold from step to step.
+		constexpr float FaceBias = 0.98f;
+		constexpr float EdgeBias = 0.95f;
+		constexpr float BiasSlop = 0.001f;
+
+		inline float Component(const Vec3& v, int axis)
+		{
+			return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+		}
+
+		struct Box
+		{
+			Vec3 center;
+			Vec3 axes[3];
+			float extents[3];
+		};
+
+		Box MakeBox(const Shape& shape)
+		{
+			Box box;
+			box.center = shape.position;
+			for (int i = 0; i < 3; ++i)
+			{
+				box.axes[i] = Math::Rotate(shape.orientation,
+				                           UnitAxes[i]);
+				box.extents[i] = Component(shape.extents, i);
+			}
+			return box;
+		}
+
+		// Half the box's extent along a unit axis.
+		inline float Project(const Box& box, const Vec3& axis)
+		{
+			return std::abs(Dot(box.axes[0], axis))
+			           * box.extents[0]
+			       + std::abs(Dot(box.axes[1], axis))
+			             * box.extents[1]
+			       + std::abs(Dot(box.axes[2], axis))
+			             * box.extents[2];
+		}
+
+		bool CollideSpheres(const Shape& a, const Shape& b,
+		                    ContactManifold& manifold)
+		{
+			const auto offset = b.position - a.position;
+			const auto radii = a.extents.x + b.extents.x;
+			const auto distanceSq = Dot(offset, offset);
+			if (distanceSq > radii * radii)
+			{
+				return false;
+			}
+			const auto distance = std::sqrt(distanceSq);
+			const auto depth = radii - distance;
+			manifold.normal = distance > 1e-6f
+			                      ? offset / distance
+			                      : Vec3{0.0f, 1.0f, 0.0f};
+			manifold.points[0] = {
+			    a.position
+			        + manifold.normal
+			              * (a.extents.x - depth * 0.5f),
+			    depth};
+			manifold.count = 1;
+			return true;
+		}
+
+		// The normal points from the sphere into the box.
+		bool CollideSphereBox(const Shape& sphere,
+		                      const Shape& box,
+		                      ContactManifold& manifold)
+		{
+			const auto local = Math::Rotate(
+			    Math::Conjugate(box.orientation),
+			    sphere.position - box.position);
+			const auto& extents = box.extents;
+			const Vec3 closest{
+			    std::clamp(local.x, -extents.x, extents.x),
+			    std::clamp(local.y, -extents.y, extents.y),
+			    std::clamp(local.z, -extents.z, extents.z)};
+			const auto radius = sphere.extents.x;
+
+			// Out of the box toward the sphere, in box space.
+			Vec3 normal;
+			Vec3 surface = closest;
+			float depth = 0.0f;
+			const auto delta = local - closest;
+			const auto distanceSq = Dot(delta, delta);
+			if (distanceSq > 1e-12f)
+			{
+				if (distanceSq > radius * radius)
+				{
+					return false;
+				}
+				const auto distance = std::sqrt(distanceSq);
+				normal = delta / distance;
+				depth = radius - distance;
+			}
+			else
+			{
+				// The centre is inside: out through the
+				// nearest face.
+				int axis = 0;
+				auto nearest = std::numeric_limits<float>::max();
+				for (int i = 0; i < 3; ++i)
+				{
+					const auto gap =
+					    Component(extents, i)
+					    - std::abs(Component(local, i));
+					if (gap < nearest)
+					{
+						nearest = gap;
+						axis = i;
+					}
+				}
+				normal = UnitAxes[axis]
+				         * (Component(local, axis) < 0.0f ? -1.0f
+				                                          : 1.0f);
+				depth = radius + nearest;
+				surface = local + normal * nearest;
+			}
+
+			manifold.normal =
+			    -Math::Rotate(box.orientation, normal);
+			manifold.points[0] = {
+			    box.position
+			        + Math::Rotate(box.orientation, surface)
+			        + manifold.normal * (depth * 0.5f),
+			    depth};
+			manifold.count = 1;
+			return true;
+		}
+
+		// Sutherland-Hodgman against the plane
+		// Dot(normal, x) <= offset.
+		uint32_t ClipPolygon(const Vec3* in, uint32_t count,
+		                     const Vec3& normal, float offset,
+		                     Vec3* out)
+		{
+			uint32_t outCount = 0;
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const auto& from = in[i];
+				const auto& to = in[(i + 1) % count];
+				const auto fromDistance =
+				    Dot(normal, from) - offset;
+				const auto toDistance = Dot(normal, to) - offset;
+				if (fromDistance <= 0.0f)
+				{
+					out[outCount++] = from;
+				}
+				if ((fromDistance <= 0.0f)
+				    != (toDistance <= 0.0f))
+				{
+					const auto t =
+					    fromDistance / (fromDistance - toDistance);
+					out[outCount++] = Math::Lerp(from, to, t);
+				}
+			}
+			return outCount;
+		}
+
+		// Keeps the deepest point and the three that span
+		// the largest area with it.
+		void ReducePoints(const ContactPoint* points,
+		                  uint32_t count, const Vec3& normal,
+		                  ContactManifold& manifold)
+		{
+			uint32_t first = 0;
+			for (uint32_t i = 1; i < count; ++i)
+			{
+				if (points[i].depth > points[first].depth)
+				{
+					first = i;
+				}
+			}
+			const auto& origin = points[first].position;
+
+			uint32_t second = first;
+			float farthest = -1.0f;
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const auto offset = points[i].position - origin;
+				if (Dot(offset, offset) > farthest)
+				{
+					farthest = Dot(offset, offset);
+					second = i;
+				}
+			}
+
+			// The farthest from the line through the first
+			// two, on either side of it.
+			const auto edge = points[second].position - origin;
+			uint32_t third = first;
+			uint32_t fourth = first;
+			float most = 0.0f;
+			float least = 0.0f;
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const auto side = Dot(
+				    Cross(edge, points[i].position - origin),
+				    normal);
+				if (side > most)
+				{
+					most = side;
+					third = i;
+				}
+				if (side < least)
+				{
+					least = side;
+					fourth = i;
+				}
+			}
+
+			manifold.count = 0;
+			for (const auto i : {first, second, third, fourth})
+			{
+				if (manifold.count == 0 || i != first)
+				{
+					manifold.points[manifold.count++] = points[i];
+				}
+			}
+		}
+
+		bool CollideBoxes(const Shape& shapeA,
+		                  const Shape& shapeB,
+		                  ContactManifold& manifold)
+		{
+			const auto a = MakeBox(shapeA);
+			const auto b = MakeBox(shapeB);
+			const auto offset = b.center - a.center;
+
+			// Separating axis test over both boxes' face
+			// normals and the 9 edge cross products. Axes
+			// 0-2 are a's faces, 3-5 b's and the rest edge
+			// pairs.
+			auto best = std::numeric_limits<float>::max();
+			int bestAxis = -1;
+			Vec3 normal;
+			const auto test = [&](Vec3 axis, int index,
+			                      float bias) {
+				const auto lengthSq = Dot(axis, axis);
+				if (lengthSq < 1e-6f)
+				{
+					// Parallel edges; the face axes cover it.
+					return true;
+				}
+				axis = axis / std::sqrt(lengthSq);
+				const auto distance = Dot(offset, axis);
+				const auto overlap = Project(a, axis)
+				                     + Project(b, axis)
+				                     - std::abs(distance);
+				if (overlap < 0.0f)
+				{
+					return false;
+				}
+				if (overlap < best * bias - BiasSlop
+				    || bestAxis < 0)
+				{
+					best = overlap;
+					bestAxis = index;
+					normal = distance < 0.0f ? -axis : axis;
+				}
+				return true;
+			};
+			for (int i = 0; i < 3; ++i)
+			{
+				if (!test(a.axes[i], i, 1.0f))
+				{
+					return false;
+				}
+			}
+			for (int i = 0; i < 3; ++i)
+			{
+				if (!test(b.axes[i], 3 + i, FaceBias))
+				{
+					return false;
+				}
+			}
+			for (int i = 0; i < 3; ++i)
+			{
+				for (int j = 0; j < 3; ++j)
+				{
+					if (!test(Cross(a.axes[i], b.axes[j]),
+					          6 + i * 3 + j, EdgeBias))
+					{
+						return false;
+					}
+				}
+			}
+			manifold.normal = normal;
+
+			if (bestAxis >= 6)
+			{
+				// Edge against edge: the closest points of
+				// the two edges facing each other.
+				const auto i = (bestAxis - 6) / 3;
+				const auto j = (bestAxis - 6) % 3;
+				auto pointA = a.center;
+				auto pointB = b.center;
+				for (int k = 0; k < 3; ++k)
+				{
+					if (k != i)
+					{
+						pointA += a.axes[k]
+						          * (Dot(a.axes[k], normal) > 0.0f
+						                 ? a.extents[k]
+						                 : -a.extents[k]);
+					}
+					if (k != j)
+					{
+						pointB += b.axes[k]
+						          * (Dot(b.axes[k], normal) > 0.0f
+						                 ? -b.extents[k]
+						                 : b.extents[k]);
+					}
+				}
+				const auto& directionA = a.axes[i];
+				const auto& directionB = b.axes[j];
+				const auto between = pointA - pointB;
+				const auto cosine = Dot(directionA, directionB);
+				const auto alongA = Dot(directionA, between);
+				const auto alongB = Dot(directionB, between);
+				const auto denominator =
+				    std::max(1.0f - cosine * cosine, 1e-6f);
+				const auto s = std::clamp(
+				    (cosine * alongB - alongA) / denominator,
+				    -a.extents[i], a.extents[i]);
+				const auto t = std::clamp(
+				    (alongB - cosine * alongA) / denominator,
+				    -b.extents[j], b.extents[j]);
+				manifold.points[0] = {
+				    (pointA + directionA * s + pointB
+				     + directionB * t)
+				        * 0.5f,
+				    best};
+				manifold.count = 1;
+				return true;
+			}
+
+			// Face contact: the incident box's face most
+			// opposed to the reference face, clipped to the
+			// reference face's sides.
+			const bool flip = bestAxis >= 3;
+			const auto& reference = flip ? b : a;
+			const auto& incident = flip ? a : b;
+			const auto face = bestAxis % 3;
+			const auto outward = flip ? -normal : normal;
+
+			int incidentFace = 0;
+			float most = -1.0f;
+			for (int k = 0; k < 3; ++k)
+			{
+				const auto alignment =
+				    std::abs(Dot(incident.axes[k], outward));
+				if (alignment > most)
+				{
+					most = alignment;
+					incidentFace = k;
+				}
+			}
+			const auto sign =
+			    Dot(incident.axes[incidentFace], outward) > 0.0f
+			        ? -1.0f
+			        : 1.0f;
+			const auto center =
+			    incident.center
+			    + incident.axes[incidentFace]
+			          * (sign * incident.extents[incidentFace]);
+			const auto u = (incidentFace + 1) % 3;
+			const auto v = (incidentFace + 2) % 3;
+			const auto edgeU =
+			    incident.axes[u] * incident.extents[u];
+			const auto edgeV =
+			    incident.axes[v] * incident.extents[v];
+
+			// 4 corners, clipped by 4 planes: at most 8.
+			Vec3 polygon[8] = {center + edgeU + edgeV,
+			                   center - edgeU + edgeV,
+			                   center - edgeU - edgeV,
+			                   center + edgeU - edgeV};
+			Vec3 clipped[8];
+			uint32_t count = 4;
+			for (const auto side :
+			     {(face + 1) % 3, (face + 2) % 3})
+			{
+				for (const auto direction : {1.0f, -1.0f})
+				{
+					const auto planeNormal =
+					    reference.axes[side] * direction;
+					const auto planeOffset =
+					    Dot(planeNormal, reference.center)
+					    + reference.extents[side];
+					count = ClipPolygon(polygon, count,
+					                    planeNormal, planeOffset,
+					                    clipped);
+					std::copy_n(clipped, count, polygon);
+				}
+			}
+
+			const auto faceCenter =
+			    reference.center
+			    + outward * reference.extents[face];
+			ContactPoint points[8];
+			uint32_t pointCount = 0;
+			for (uint32_t k = 0; k < count; ++k)
+			{
+				const auto separation =
+				    Dot(outward, polygon[k] - faceCenter);
+				if (separation <= 0.0f)
+				{
+					points[pointCount++] = {
+					    polygon[k] - outward * (separation * 0.5f),
+					    -separation};
+				}
+			}
+			if (pointCount == 0)
+			{
+				return false;
+			}
+			if (pointCount <= ContactManifold::MaxPoints)
+			{
+				std::copy_n(points, pointCount,
+				            manifold.points.begin());
+				manifold.count = pointCount;
+			}
+			else
+			{
+				ReducePoints(points, pointCount, outward,
+				             manifold);
+			}
+			return true;
+		}
+	} // namespace
+
+	Graphics::Aabb GetBounds(const Shape& shape)
+	{
+		Vec3 half = shape.extents;
+		if (shape.type == ShapeType::Sphere)
+		{
+			half = {shape.extents.x, shape.extents.x,
+			        shape.extents.x};
+		}
+		else
+		{
+			const auto box = MakeBox(shape);
+			half = {Project(box, UnitAxes[0]),
+			        Project(box, UnitAxes[1]),
+			        Project(box, UnitAxes[2])};
+		}
+		const auto& p = shape.position;
+		return {{p.x - half.x, p.y - half.y, p.z - half.z},
+		        {p.x + half.x, p.y + half.y, p.z + half.z}};
+	}
+
+	bool Collide(const Shape& a, const Shape& b,
+	             ContactManifold& manifold)
+	{
+		manifold.count = 0;
+		if (a.type == ShapeType::Sphere
+		    && b.type == ShapeType::Sphere)
+		{
+			return CollideSpheres(a, b, manifold);
+		}
+		if (a.type == ShapeType::Sphere)
+		{
+			return CollideSphereBox(a, b, manifold);
+		}
+		if (b.type == ShapeType::Sphere)
+		{
+			if (!CollideSphereBox(b, a, manifold))
+			{
+				return false;
+			}
+			manifold.normal = -manifold.normal;
+			return true;
+		}
+		return CollideBoxes(a, b, manifold);
+	}
+} // namespace AthiVegam::Physics
@@ -0,0 +1,889 @@
+#include "AthiVegam/Physics/PhysicsWorld.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Managers/JobManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace AthiVegam::Physics
+{
+	namespace
+	{
+		using Math::Vec3;
+
+		constexpr uint32_t NoIsland = 0xFFFFFFFF;
+		// Islands differ wildly in size, so they are dealt
+		// out in about this many jobs rather than by
+		// batchSize.
+		constexpr uint32_t IslandJobs = 256;
+		// Closing speed past which contacts bounce.
+		constexpr float RestitutionSpeed = 1.0f;
+		// Squared distance within which a new contact point
+		// takes over a cached one's impulses.
+		constexpr float MatchDistanceSq = 0.05f * 0.05f;
+
+		inline bool Overlaps(const Graphics::Aabb& a,
+		                     const Graphics::Aabb& b)
+		{
+			return a.min.x <= b.max.x && b.min.x <= a.max.x
+			       && a.min.y <= b.max.y && b.min.y <= a.max.y
+			       && a.min.z <= b.max.z && b.min.z <= a.max.z;
+		}
+
+		// A 3x3 matrix given by its rows times v.
+		inline Vec3 Transform(const Vec3 (&rows)[3],
+		                      const Vec3& v)
+		{
+			return {Math::Dot(rows[0], v), Math::Dot(rows[1], v),
+			        Math::Dot(rows[2], v)};
+		}
+
+		inline uint64_t GetPairKey(uint32_t a, uint32_t b)
+		{
+			return static_cast<uint64_t>(a) << 32 | b;
+		}
+	} // namespace
+
+	PhysicsWorld::PhysicsWorld() : PhysicsWorld(Settings{}) {}
+
+	PhysicsWorld::PhysicsWorld(const Settings& settings)
+	    : m_settings(settings)
+	{
+	}
+
+	template <typename F>
+	void PhysicsWorld::ForEach(uint32_t count,
+	                           uint32_t batchSize, F&& function)
+	{
+		if (m_jobs)
+		{
+			m_jobs->ParallelFor(count, batchSize, function);
+			return;
+		}
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			function(i);
+		}
+	}
+
+	PhysicsWorld::BodyId
+	PhysicsWorld::CreateBody(const BodyDesc& desc)
+	{
+		BodyId id;
+		if (!m_freeIds.empty())
+		{
+			id = m_freeIds.back();
+			m_freeIds.pop_back();
+		}
+		else
+		{
+			id = static_cast<BodyId>(m_bodies.size());
+			m_bodies.emplace_back();
+		}
+
+		auto& body = m_bodies[id];
+		body = {};
+		body.shape = {desc.shape, desc.extents, desc.position,
+		              Math::Normalize(desc.orientation)};
+		body.previousPosition = body.shape.position;
+		body.previousOrientation = body.shape.orientation;
+		body.friction = desc.friction;
+		body.restitution = desc.restitution;
+		SetMass(body, desc.mass);
+		if (body.IsDynamic())
+		{
+			body.linearVelocity = desc.linearVelocity;
+			body.angularVelocity = desc.angularVelocity;
+		}
+		body.awake = body.IsDynamic();
+		body.alive = true;
+		body.bounds = GetBounds(body.shape);
+		body.leaf = m_tree.Insert(body.bounds, id);
+		return id;
+	}
+
+	void PhysicsWorld::DestroyBody(BodyId id)
+	{
+		if (id >= m_bodies.size() || !m_bodies[id].alive)
+		{
+			VEGAM_WARN("Destroying unknown physics body {}", id);
+			return;
+		}
+		auto& body = m_bodies[id];
+		m_tree.Remove(body.leaf);
+		body.alive = false;
+		m_freeIds.push_back(id);
+		for (auto i = static_cast<uint32_t>(m_contacts.size());
+		     i-- > 0;)
+		{
+			if (m_contacts[i].a == id || m_contacts[i].b == id)
+			{
+				RemovePair(i);
+			}
+		}
+		// Whatever rested on it has to fall.
+		WakeOverlapping(body.bounds);
+	}
+
+	void PhysicsWorld::Clear()
+	{
+		m_bodies.clear();
+		m_freeIds.clear();
+		m_tree.Clear();
+		m_contacts.clear();
+		m_pairIndices.clear();
+		m_islandOffsets.clear();
+		m_contactOffsets.clear();
+		m_islandBodies.clear();
+		m_islandContacts.clear();
+		m_awakeBodies = 0;
+		m_contactCount = 0;
+	}
+
+	void PhysicsWorld::Step(float deltaTime,
+	                        Managers::JobManager& jobs)
+	{
+		m_jobs = &jobs;
+		Step(deltaTime);
+		m_jobs = nullptr;
+	}
+
+	void PhysicsWorld::Step(float deltaTime)
+	{
+		VEGAM_PROFILE_SCOPE("PhysicsWorld::Step");
+		if (deltaTime <= 0.0f)
+		{
+			return;
+		}
+
+		UpdateBroadphase();
+		UpdatePairs();
+
+		{
+			VEGAM_PROFILE_SCOPE("PhysicsWorld::Collide");
+			ForEach(static_cast<uint32_t>(m_contacts.size()),
+			        m_settings.batchSize, [this](uint32_t i) {
+				        CollidePair(m_contacts[i]);
+			        });
+		}
+
+		BuildIslands();
+
+		{
+			VEGAM_PROFILE_SCOPE("PhysicsWorld::Solve");
+			const auto islands = GetIslandCount();
+			ForEach(islands, std::max(islands / IslandJobs, 1u),
+			        [this, deltaTime](uint32_t island) {
+				        SolveIsland(island, deltaTime);
+			        });
+		}
+
+		m_awakeBodies = 0;
+		for (const auto id : m_islandBodies)
+		{
+			m_awakeBodies += m_bodies[id].awake ? 1 : 0;
+		}
+	}
+
+	void PhysicsWorld::SetTransform(BodyId id,
+	                                const Math::Vec3& position,
+	                                const Math::Quat& orientation)
+	{
+		auto& body = m_bodies[id];
+		const auto oldBounds = body.bounds;
+		body.shape.position = position;
+		body.shape.orientation = Math::Normalize(orientation);
+		body.previousPosition = position;
+		body.previousOrientation = body.shape.orientation;
+		body.bounds = GetBounds(body.shape);
+		m_tree.Move(body.leaf, body.bounds);
+		body.moved = true;
+		WakeOverlapping(oldBounds);
+		WakeOverlapping(body.bounds);
+	}
+
+	void PhysicsWorld::SetLinearVelocity(
+	    BodyId id, const Math::Vec3& velocity)
+	{
+		auto& body = m_bodies[id];
+		if (body.IsDynamic())
+		{
+			body.linearVelocity = velocity;
+			WakeUp(id);
+		}
+	}
+
+	void PhysicsWorld::SetAngularVelocity(
+	    BodyId id, const Math::Vec3& velocity)
+	{
+		auto& body = m_bodies[id];
+		if (body.IsDynamic())
+		{
+			body.angularVelocity = velocity;
+			WakeUp(id);
+		}
+	}
+
+	void PhysicsWorld::ApplyForce(BodyId id,
+	                              const Math::Vec3& force)
+	{
+		auto& body = m_bodies[id];
+		if (body.IsDynamic())
+		{
+			body.force += force;
+			WakeUp(id);
+		}
+	}
+
+	void PhysicsWorld::ApplyImpulse(BodyId id,
+	                                const Math::Vec3& impulse,
+	                                const Math::Vec3& point)
+	{
+		auto& body = m_bodies[id];
+		if (body.IsDynamic())
+		{
+			body.linearVelocity += impulse * body.inverseMass;
+			body.angularVelocity += ApplyInverseInertia(
+			    body,
+			    Math::Cross(point - body.shape.position, impulse));
+			WakeUp(id);
+		}
+	}
+
+	void PhysicsWorld::WakeUp(BodyId id)
+	{
+		auto& body = m_bodies[id];
+		if (body.IsDynamic())
+		{
+			body.awake = true;
+			body.restTime = 0.0f;
+		}
+	}
+
+	Math::Mat4
+	PhysicsWorld::GetInterpolatedTransform(BodyId id,
+	                                       float alpha) const
+	{
+		const auto& body = m_bodies[id];
+		return Math::Mat4::Trs(
+		    Math::Lerp(body.previousPosition,
+		               body.shape.position, alpha),
+		    Math::Slerp(body.previousOrientation,
+		                body.shape.orientation, alpha),
+		    {1.0f, 1.0f, 1.0f});
+	}
+
+	void PhysicsWorld::UpdateBroadphase()
+	{
+		VEGAM_PROFILE_SCOPE("PhysicsWorld::UpdateBroadphase");
+		for (auto& body : m_bodies)
+		{
+			if (body.alive)
+			{
+				body.previousPosition = body.shape.position;
+				body.previousOrientation =
+				    body.shape.orientation;
+			}
+		}
+
+		// Bodies within their fat box leave the tree, and
+		// their pairs, alone.
+		m_moved.clear();
+		for (BodyId id = 0; id < m_bodies.size(); ++id)
+		{
+			auto& body = m_bodies[id];
+			if (!body.alive)
+			{
+				continue;
+			}
+			if (body.IsActive())
+			{
+				body.bounds = GetBounds(body.shape);
+				body.moved |= m_tree.Move(body.leaf, body.bounds);
+			}
+			if (body.moved)
+			{
+				m_moved.push_back(id);
+			}
+		}
+	}
+	void PhysicsWorld::FindPairs(uint32_t batch)
+	{
+		auto& pairs = m_batchPairs[batch];
+		pairs.clear();
+		const auto batchSize = std::max(m_settings.batchSize, 1u);
+		const auto begin = batch * batchSize;
+		const auto end = std::min(
+		    begin + batchSize,
+		    static_cast<uint32_t>(m_moved.size()));
+		for (auto i = begin; i < end; ++i)
+		{
+			const auto id = m_moved[i];
+			const auto& body = m_bodies[id];
+			const auto& bounds = m_tree.GetFatBounds(body.leaf);
+			m_tree.Query(
+			    [&bounds](const Graphics::Aabb& box) {
+				    return Overlaps(bounds, box)
+				               ? Scene::Overlap::Partial
+				               : Scene::Overlap::Outside;
+			    },
+			    [&](uint32_t other) {
+				    const auto& found = m_bodies[other];
+				    // Pairs of moved bodies are found from
+				    // both sides; keep one. Static bodies
+				    // never collide with each other.
+				    if (other == id
+				        || (other < id && found.moved)
+				        || (!body.IsDynamic()
+				            && !found.IsDynamic()))
+				    {
+					    return;
+				    }
+				    pairs.push_back({std::min(id, other),
+				                     std::max(id, other)});
+			    });
+		}
+	}
+
+	void PhysicsWorld::UpdatePairs()
+	{
+		VEGAM_PROFILE_SCOPE("PhysicsWorld::UpdatePairs");
+		const auto batchSize = std::max(m_settings.batchSize, 1u);
+		const auto batches = static_cast<uint32_t>(
+		    (m_moved.size() + batchSize - 1) / batchSize);
+		if (m_batchPairs.size() < batches)
+		{
+			m_batchPairs.resize(batches);
+		}
+		ForEach(batches, 1,
+		        [this](uint32_t batch) { FindPairs(batch); });
+
+		for (uint32_t batch = 0; batch < batches; ++batch)
+		{
+			for (const auto& pair : m_batchPairs[batch])
+			{
+				const auto index =
+				    static_cast<uint32_t>(m_contacts.size());
+				if (m_pairIndices
+				        .try_emplace(GetPairKey(pair.a, pair.b),
+				                     index)
+				        .second)
+				{
+					auto& contact = m_contacts.emplace_back();
+					contact.a = pair.a;
+					contact.b = pair.b;
+				}
+			}
+		}
+
+		// Pairs whose fat boxes came apart.
+		for (auto i = static_cast<uint32_t>(m_contacts.size());
+		     i-- > 0;)
+		{
+			const auto& a = m_bodies[m_contacts[i].a];
+			const auto& b = m_bodies[m_contacts[i].b];
+			if ((a.moved || b.moved)
+			    && !Overlaps(m_tree.GetFatBounds(a.leaf),
+			                 m_tree.GetFatBounds(b.leaf)))
+			{
+				RemovePair(i);
+			}
+		}
+		for (const auto id : m_moved)
+		{
+			m_bodies[id].moved = false;
+		}
+	}
+
+	void PhysicsWorld::RemovePair(uint32_t index)
+	{
+		auto& contact = m_contacts[index];
+		m_pairIndices.erase(GetPairKey(contact.a, contact.b));
+		if (index + 1 != m_contacts.size())
+		{
+			contact = m_contacts.back();
+			m_pairIndices[GetPairKey(contact.a, contact.b)] =
+			    index;
+		}
+		m_contacts.pop_back();
+	}
+	void PhysicsWorld::CollidePair(Contact& contact) const
+	{
+		const auto& a = m_bodies[contact.a];
+		const auto& b = m_bodies[contact.b];
+		contact.active = a.IsActive() || b.IsActive();
+		if (!contact.active)
+		{
+			return;
+		}
+
+		ContactManifold manifold;
+		if (!Overlaps(a.bounds, b.bounds)
+		    || !Physics::Collide(a.shape, b.shape, manifold))
+		{
+			contact.manifold.count = 0;
+			return;
+		}
+		contact.friction = std::sqrt(a.friction * b.friction);
+		contact.restitution =
+		    std::max(a.restitution, b.restitution);
+
+		// Warm start from the impulses of the same points
+		// last step.
+		const auto inverse =
+		    Math::Conjugate(a.shape.orientation);
+		std::array<Point, ContactManifold::MaxPoints> points;
+		decltype(contact.anchors) anchors;
+		for (uint32_t k = 0; k < manifold.count; ++k)
+		{
+			anchors[k] = Math::Rotate(
+			    inverse,
+			    manifold.points[k].position - a.shape.position);
+			for (uint32_t c = 0; c < contact.manifold.count; ++c)
+			{
+				const auto offset =
+				    anchors[k] - contact.anchors[c];
+				if (Math::Dot(offset, offset) < MatchDistanceSq)
+				{
+					std::copy_n(contact.points[c].impulse, 3,
+					            points[k].impulse);
+					break;
+				}
+			}
+		}
+		contact.manifold = manifold;
+		contact.anchors = anchors;
+		contact.points = points;
+	}
+	void PhysicsWorld::BuildIslands()
+	{
+		VEGAM_PROFILE_SCOPE("PhysicsWorld::BuildIslands");
+		const auto bodyCount =
+		    static_cast<uint32_t>(m_bodies.size());
+		m_parents.resize(bodyCount);
+		std::iota(m_parents.begin(), m_parents.end(), 0u);
+
+		// Static bodies don't carry impulses from one body
+		// to another, so they join no island.
+		m_contactCount = 0;
+		for (const auto& contact : m_contacts)
+		{
+			if (!contact.IsTouching())
+			{
+				continue;
+			}
+			++m_contactCount;
+			if (m_bodies[contact.a].IsDynamic()
+			    && m_bodies[contact.b].IsDynamic())
+			{
+				m_parents[FindRoot(contact.a)] =
+				    FindRoot(contact.b);
+			}
+		}
+
+		// Only islands with an awake body are solved; the
+		// sleeping bodies in them wake up.
+		m_rootIslands.assign(bodyCount, NoIsland);
+		uint32_t islandCount = 0;
+		for (BodyId id = 0; id < bodyCount; ++id)
+		{
+			if (!m_bodies[id].alive || !m_bodies[id].IsActive())
+			{
+				continue;
+			}
+			auto& island = m_rootIslands[FindRoot(id)];
+			if (island == NoIsland)
+			{
+				island = islandCount++;
+			}
+		}
+
+		m_islandOffsets.assign(islandCount + 1, 0);
+		m_contactOffsets.assign(islandCount + 1, 0);
+		for (BodyId id = 0; id < bodyCount; ++id)
+		{
+			auto& body = m_bodies[id];
+			if (!body.alive || !body.IsDynamic())
+			{
+				continue;
+			}
+			const auto island = m_rootIslands[FindRoot(id)];
+			if (island != NoIsland)
+			{
+				if (!body.awake)
+				{
+					body.awake = true;
+					body.restTime = 0.0f;
+				}
+				++m_islandOffsets[island + 1];
+			}
+		}
+		const auto getIsland = [this](const Contact& contact) {
+			const auto body = m_bodies[contact.a].IsDynamic()
+			                      ? contact.a
+			                      : contact.b;
+			return m_rootIslands[FindRoot(body)];
+		};
+		for (const auto& contact : m_contacts)
+		{
+			if (contact.IsTouching())
+			{
+				++m_contactOffsets[getIsland(contact) + 1];
+			}
+		}
+		std::partial_sum(m_islandOffsets.begin(),
+		                 m_islandOffsets.end(),
+		                 m_islandOffsets.begin());
+		std::partial_sum(m_contactOffsets.begin(),
+		                 m_contactOffsets.end(),
+		                 m_contactOffsets.begin());
+
+		// Bucketed by island, using the offsets as cursors
+		// and shifting them back after.
+		m_islandBodies.resize(m_islandOffsets.back());
+		m_islandContacts.resize(m_contactOffsets.back());
+		for (BodyId id = 0; id < bodyCount; ++id)
+		{
+			const auto& body = m_bodies[id];
+			if (!body.alive || !body.IsDynamic())
+			{
+				continue;
+			}
+			const auto island = m_rootIslands[FindRoot(id)];
+			if (island != NoIsland)
+			{
+				m_islandBodies[m_islandOffsets[island]++] = id;
+			}
+		}
+		for (uint32_t i = 0; i < m_contacts.size(); ++i)
+		{
+			if (m_contacts[i].IsTouching())
+			{
+				auto& cursor =
+				    m_contactOffsets[getIsland(m_contacts[i])];
+				m_islandContacts[cursor++] = i;
+			}
+		}
+		for (auto i = islandCount; i > 0; --i)
+		{
+			m_islandOffsets[i] = m_islandOffsets[i - 1];
+			m_contactOffsets[i] = m_contactOffsets[i - 1];
+		}
+		if (islandCount > 0)
+		{
+			m_islandOffsets[0] = 0;
+			m_contactOffsets[0] = 0;
+		}
+	}
+
+	uint32_t PhysicsWorld::FindRoot(uint32_t body)
+	{
+		while (m_parents[body] != body)
+		{
+			// Path halving.
+			m_parents[body] = m_parents[m_parents[body]];
+			body = m_parents[body];
+		}
+		return body;
+	}
+
+	void PhysicsWorld::SolveIsland(uint32_t island,
+	                               float deltaTime)
+	{
+		const auto bodiesBegin =
+		    m_islandBodies.begin() + m_islandOffsets[island];
+		const auto bodiesEnd =
+		    m_islandBodies.begin() + m_islandOffsets[island + 1];
+		const auto contactsBegin =
+		    m_islandContacts.begin() + m_contactOffsets[island];
+		const auto contactsEnd =
+		    m_islandContacts.begin()
+		    + m_contactOffsets[island + 1];
+
+		const auto linearDamping =
+		    1.0f / (1.0f + deltaTime * m_settings.linearDamping);
+		const auto angularDamping =
+		    1.0f
+		    / (1.0f + deltaTime * m_settings.angularDamping);
+		for (auto it = bodiesBegin; it != bodiesEnd; ++it)
+		{
+			auto& body = m_bodies[*it];
+			UpdateInertia(body);
+			const auto acceleration =
+			    m_settings.gravity + body.force * body.inverseMass;
+			body.linearVelocity += acceleration * deltaTime;
+			body.linearVelocity *= linearDamping;
+			body.angularVelocity *= angularDamping;
+			body.force = {};
+		}
+
+		for (auto it = contactsBegin; it != contactsEnd; ++it)
+		{
+			PrepareContact(m_contacts[*it], deltaTime);
+		}
+		for (uint32_t i = 0; i < m_settings.velocityIterations;
+		     ++i)
+		{
+			for (auto it = contactsBegin; it != contactsEnd;
+			     ++it)
+			{
+				SolveContact(m_contacts[*it]);
+			}
+		}
+
+		const auto linearSleepSq = m_settings.sleepLinearSpeed
+		                           * m_settings.sleepLinearSpeed;
+		const auto angularSleepSq =
+		    m_settings.sleepAngularSpeed
+		    * m_settings.sleepAngularSpeed;
+		auto restTime = m_settings.sleepTime;
+		for (auto it = bodiesBegin; it != bodiesEnd; ++it)
+		{
+			auto& body = m_bodies[*it];
+			const auto& linear = body.linearVelocity;
+			const auto& angular = body.angularVelocity;
+			body.shape.position += linear * deltaTime;
+			auto& q = body.shape.orientation;
+			const auto spin =
+			    Math::Quat{angular.x, angular.y, angular.z, 0.0f}
+			    * q;
+			const auto half = 0.5f * deltaTime;
+			q = Math::Normalize(Math::Quat{
+			    q.x + spin.x * half, q.y + spin.y * half,
+			    q.z + spin.z * half, q.w + spin.w * half});
+
+			if (Math::Dot(linear, linear) < linearSleepSq
+			    && Math::Dot(angular, angular) < angularSleepSq)
+			{
+				body.restTime += deltaTime;
+			}
+			else
+			{
+				body.restTime = 0.0f;
+			}
+			restTime = std::min(restTime, body.restTime);
+		}
+
+		if (restTime >= m_settings.sleepTime)
+		{
+			for (auto it = bodiesBegin; it != bodiesEnd; ++it)
+			{
+				auto& body = m_bodies[*it];
+				body.awake = false;
+				body.linearVelocity = {};
+				body.angularVelocity = {};
+				// Awake bodies test against these.
+				body.bounds = GetBounds(body.shape);
+			}
+		}
+	}
+
+	void PhysicsWorld::PrepareContact(Contact& contact,
+	                                  float deltaTime)
+	{
+		auto& a = m_bodies[contact.a];
+		auto& b = m_bodies[contact.b];
+		auto& directions = contact.directions;
+		const auto& normal = contact.manifold.normal;
+		directions[0] = normal;
+		directions[1] = Math::Normalize(
+		    std::abs(normal.x) >= 0.57735f
+		        ? Vec3{normal.y, -normal.x, 0.0f}
+		        : Vec3{0.0f, normal.z, -normal.y});
+		directions[2] = Math::Cross(normal, directions[1]);
+
+		for (uint32_t k = 0; k < contact.manifold.count; ++k)
+		{
+			const auto& source = contact.manifold.points[k];
+			auto& point = contact.points[k];
+			const auto offsetA =
+			    source.position - a.shape.position;
+			const auto offsetB =
+			    source.position - b.shape.position;
+			for (int row = 0; row < 3; ++row)
+			{
+				auto& armA = point.armA[row];
+				auto& armB = point.armB[row];
+				armA = Math::Cross(offsetA, directions[row]);
+				armB = Math::Cross(offsetB, directions[row]);
+				point.spinA[row] =
+				    Transform(a.inverseInertiaRows, armA);
+				point.spinB[row] =
+				    Transform(b.inverseInertiaRows, armB);
+				point.mass[row] =
+				    1.0f
+				    / (a.inverseMass + b.inverseMass
+				       + Math::Dot(armA, point.spinA[row])
+				       + Math::Dot(armB, point.spinB[row]));
+			}
+
+			// Baumgarte stabilization past the slop, or the
+			// bounce, whichever separates faster.
+			point.bias =
+			    m_settings.baumgarte / deltaTime
+			    * std::max(source.depth - m_settings.slop, 0.0f);
+			const auto closing =
+			    GetSpeed(a, b, contact, point, 0);
+			if (closing < -RestitutionSpeed)
+			{
+				point.bias = std::max(
+				    point.bias, -contact.restitution * closing);
+			}
+
+			for (int row = 0; row < 3; ++row)
+			{
+				ApplyRowImpulse(a, b, contact, point, row,
+				                point.impulse[row]);
+			}
+		}
+	}
+
+	void PhysicsWorld::SolveContact(Contact& contact)
+	{
+		auto& a = m_bodies[contact.a];
+		auto& b = m_bodies[contact.b];
+		for (uint32_t k = 0; k < contact.manifold.count; ++k)
+		{
+			auto& point = contact.points[k];
+
+			// Friction first, bounded by the normal impulse
+			// so far.
+			const auto limit =
+			    contact.friction * point.impulse[0];
+			for (int row = 1; row < 3; ++row)
+			{
+				const auto speed =
+				    GetSpeed(a, b, contact, point, row);
+				const auto total =
+				    std::clamp(point.impulse[row]
+				                   - speed * point.mass[row],
+				               -limit, limit);
+				ApplyRowImpulse(a, b, contact, point, row,
+				                total - point.impulse[row]);
+				point.impulse[row] = total;
+			}
+
+			const auto speed = GetSpeed(a, b, contact, point, 0);
+			const auto total = std::max(
+			    point.impulse[0]
+			        + (point.bias - speed) * point.mass[0],
+			    0.0f);
+			ApplyRowImpulse(a, b, contact, point, 0,
+			                total - point.impulse[0]);
+			point.impulse[0] = total;
+		}
+	}
+
+
+	void PhysicsWorld::WakeOverlapping(
+	    const Graphics::Aabb& bounds)
+	{
+		m_tree.Query(
+		    [&bounds](const Graphics::Aabb& box) {
+			    return Overlaps(bounds, box)
+			               ? Scene::Overlap::Partial
+			               : Scene::Overlap::Outside;
+		    },
+		    [this](uint32_t id) { WakeUp(id); });
+	}
+
+	void PhysicsWorld::SetMass(Body& body, float mass)
+	{
+		if (mass <= 0.0f)
+		{
+			body.inverseMass = 0.0f;
+			body.inverseInertia = {};
+			std::fill_n(body.inverseInertiaRows, 3, Vec3{});
+			return;
+		}
+
+		const auto& e = body.shape.extents;
+		Vec3 inertia;
+		if (body.shape.type == ShapeType::Sphere)
+		{
+			const auto moment = 0.4f * mass * e.x * e.x;
+			inertia = {moment, moment, moment};
+		}
+		else
+		{
+			// m (a^2 + b^2) / 12 over the full sizes.
+			const auto third = mass / 3.0f;
+			inertia = {third * (e.y * e.y + e.z * e.z),
+			           third * (e.x * e.x + e.z * e.z),
+			           third * (e.x * e.x + e.y * e.y)};
+		}
+		body.inverseMass = 1.0f / mass;
+		body.inverseInertia = {1.0f / inertia.x,
+		                       1.0f / inertia.y,
+		                       1.0f / inertia.z};
+	}
+
+	Math::Vec3
+	PhysicsWorld::ApplyInverseInertia(const Body& body,
+	                                  const Math::Vec3& v)
+	{
+		// Into body space, where the tensor is diagonal,
+		// and back.
+		const auto& q = body.shape.orientation;
+		return Math::Rotate(
+		    q, body.inverseInertia
+		           * Math::Rotate(Math::Conjugate(q), v));
+	}
+
+	void PhysicsWorld::UpdateInertia(Body& body)
+	{
+		// R diag(I) R^T, summed over the body's axes.
+		const auto& q = body.shape.orientation;
+		const auto& inverse = body.inverseInertia;
+		const Vec3 axes[3] = {
+		    Math::Rotate(q, {1.0f, 0.0f, 0.0f}),
+		    Math::Rotate(q, {0.0f, 1.0f, 0.0f}),
+		    Math::Rotate(q, {0.0f, 0.0f, 1.0f})};
+		const float moments[3] = {inverse.x, inverse.y,
+		                          inverse.z};
+		for (auto& row : body.inverseInertiaRows)
+		{
+			row = {};
+		}
+		for (int k = 0; k < 3; ++k)
+		{
+			const auto scaled = axes[k] * moments[k];
+			body.inverseInertiaRows[0] += scaled * axes[k].x;
+			body.inverseInertiaRows[1] += scaled * axes[k].y;
+			body.inverseInertiaRows[2] += scaled * axes[k].z;
+		}
+	}
+
+	float PhysicsWorld::GetSpeed(const Body& a, const Body& b,
+	                             const Contact& contact,
+	                             const Point& point, int row)
+	{
+		return Math::Dot(b.linearVelocity - a.linearVelocity,
+		                 contact.directions[row])
+		       + Math::Dot(b.angularVelocity, point.armB[row])
+		       - Math::Dot(a.angularVelocity, point.armA[row]);
+	}
+
+	void PhysicsWorld::ApplyRowImpulse(Body& a, Body& b,
+	                                   const Contact& contact,
+	                                   const Point& point,
+	                                   int row, float impulse)
+	{
+		// Static bodies may be shared by islands solving
+		// on other threads, so they are never written.
+		const auto linear = contact.directions[row] * impulse;
+		if (a.IsDynamic())
+		{
+			a.linearVelocity -= linear * a.inverseMass;
+			a.angularVelocity -= point.spinA[row] * impulse;
+		}
+		if (b.IsDynamic())
+		{
+			b.linearVelocity += linear * b.inverseMass;
+			b.angularVelocity += point.spinB[row] * impulse;
+		}
+	}
+} // namespace AthiVegam::Physics
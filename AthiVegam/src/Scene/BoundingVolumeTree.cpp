@@ -0,0 +1,352 @@
+#include "AthiVegam/Scene/BoundingVolumeTree.h"
+
+#include "AthiVegam/Log.h"
+
+#include <cmath>
+
+namespace AthiVegam::Scene
+{
+	namespace
+	{
+		using Graphics::Aabb;
+
+		inline Aabb Union(const Aabb& a, const Aabb& b)
+		{
+			return {{std::min(a.min.x, b.min.x),
+			         std::min(a.min.y, b.min.y),
+			         std::min(a.min.z, b.min.z)},
+			        {std::max(a.max.x, b.max.x),
+			         std::max(a.max.y, b.max.y),
+			         std::max(a.max.z, b.max.z)}};
+		}
+
+		inline bool Contains(const Aabb& outer,
+		                     const Aabb& inner)
+		{
+			return outer.min.x <= inner.min.x
+			       && outer.min.y <= inner.min.y
+			       && outer.min.z <= inner.min.z
+			       && inner.max.x <= outer.max.x
+			       && inner.max.y <= outer.max.y
+			       && inner.max.z <= outer.max.z;
+		}
+
+		// Half the surface area, which is all the insertion
+		// cost compares.
+		inline float Area(const Aabb& box)
+		{
+			const auto x = box.max.x - box.min.x;
+			const auto y = box.max.y - box.min.y;
+			const auto z = box.max.z - box.min.z;
+			return x * y + y * z + z * x;
+		}
+
+		inline Aabb Enlarge(const Aabb& box, float margin)
+		{
+			return {{box.min.x - margin, box.min.y - margin,
+			         box.min.z - margin},
+			        {box.max.x + margin, box.max.y + margin,
+			         box.max.z + margin}};
+		}
+	} // namespace
+
+	BoundingVolumeTree::BoundingVolumeTree(float margin)
+	    : m_margin(margin)
+	{
+	}
+
+	uint32_t BoundingVolumeTree::AllocateNode()
+	{
+		if (m_freeList == NullNode)
+		{
+			m_nodes.emplace_back();
+			m_nodes.back().height = 0;
+			return static_cast<uint32_t>(m_nodes.size() - 1);
+		}
+		const auto node = m_freeList;
+		m_freeList = m_nodes[node].parent;
+		m_nodes[node] = Node{};
+		m_nodes[node].height = 0;
+		return node;
+	}
+
+	void BoundingVolumeTree::FreeNode(uint32_t node)
+	{
+		m_nodes[node].parent = m_freeList;
+		m_nodes[node].height = -1;
+		m_freeList = node;
+	}
+
+	BoundingVolumeTree::LeafId
+	BoundingVolumeTree::Insert(const Graphics::Aabb& bounds,
+	                           uint32_t userData)
+	{
+		VEGAM_ASSERT(std::isfinite(Area(bounds)),
+		             "Bounding volume tree leaves must be "
+		             "finite");
+		const auto leaf = AllocateNode();
+		m_nodes[leaf].bounds = Enlarge(bounds, m_margin);
+		m_nodes[leaf].userData = userData;
+		InsertLeaf(leaf);
+		++m_leafCount;
+		return leaf;
+	}
+
+	void BoundingVolumeTree::Remove(LeafId leaf)
+	{
+		VEGAM_ASSERT(leaf < m_nodes.size()
+		                 && m_nodes[leaf].IsLeaf()
+		                 && m_nodes[leaf].height == 0,
+		             "Removing a node that is not a leaf");
+		RemoveLeaf(leaf);
+		FreeNode(leaf);
+		--m_leafCount;
+	}
+
+	bool BoundingVolumeTree::Move(LeafId leaf,
+	                              const Graphics::Aabb& bounds)
+	{
+		if (Contains(m_nodes[leaf].bounds, bounds))
+		{
+			return false;
+		}
+		RemoveLeaf(leaf);
+		m_nodes[leaf].bounds = Enlarge(bounds, m_margin);
+		InsertLeaf(leaf);
+		return true;
+	}
+
+	void BoundingVolumeTree::Clear()
+	{
+		m_nodes.clear();
+		m_root = NullNode;
+		m_freeList = NullNode;
+		m_leafCount = 0;
+	}
+
+	int BoundingVolumeTree::GetHeight() const
+	{
+		return m_root == NullNode ? 0 : m_nodes[m_root].height;
+	}
+
+	// Descends towards the sibling whose enlargement costs
+	// least, stopping where pairing with the current node
+	// is cheaper than going further down.
+	void BoundingVolumeTree::InsertLeaf(uint32_t leaf)
+	{
+		if (m_root == NullNode)
+		{
+			m_root = leaf;
+			m_nodes[leaf].parent = NullNode;
+			return;
+		}
+
+		const auto leafBounds = m_nodes[leaf].bounds;
+		auto sibling = m_root;
+		while (!m_nodes[sibling].IsLeaf())
+		{
+			const auto& node = m_nodes[sibling];
+			const auto area = Area(node.bounds);
+			const auto combined =
+			    Area(Union(node.bounds, leafBounds));
+			// Pairing here makes a new parent; descending
+			// grows this node either way.
+			const auto pairCost = 2.0f * combined;
+			const auto inheritedCost =
+			    2.0f * (combined - area);
+
+			const auto childCost = [&](uint32_t child) {
+				const auto& bounds = m_nodes[child].bounds;
+				const auto grown =
+				    Area(Union(bounds, leafBounds));
+				return m_nodes[child].IsLeaf()
+				           ? grown + inheritedCost
+				           : grown - Area(bounds)
+				                 + inheritedCost;
+			};
+			const auto cost1 = childCost(node.child1);
+			const auto cost2 = childCost(node.child2);
+			if (pairCost < cost1 && pairCost < cost2)
+			{
+				break;
+			}
+			sibling = cost1 < cost2 ? node.child1 : node.child2;
+		}
+
+		const auto oldParent = m_nodes[sibling].parent;
+		const auto newParent = AllocateNode();
+		auto& parent = m_nodes[newParent];
+		parent.parent = oldParent;
+		parent.bounds =
+		    Union(leafBounds, m_nodes[sibling].bounds);
+		parent.height = m_nodes[sibling].height + 1;
+		parent.child1 = sibling;
+		parent.child2 = leaf;
+		m_nodes[sibling].parent = newParent;
+		m_nodes[leaf].parent = newParent;
+
+		if (oldParent == NullNode)
+		{
+			m_root = newParent;
+		}
+		else if (m_nodes[oldParent].child1 == sibling)
+		{
+			m_nodes[oldParent].child1 = newParent;
+		}
+		else
+		{
+			m_nodes[oldParent].child2 = newParent;
+		}
+		Refit(newParent);
+	}
+
+	void BoundingVolumeTree::RemoveLeaf(uint32_t leaf)
+	{
+		if (leaf == m_root)
+		{
+			m_root = NullNode;
+			return;
+		}
+
+		const auto parent = m_nodes[leaf].parent;
+		const auto grandParent = m_nodes[parent].parent;
+		const auto sibling = m_nodes[parent].child1 == leaf
+		                         ? m_nodes[parent].child2
+		                         : m_nodes[parent].child1;
+
+		// The sibling takes the parent's place.
+		m_nodes[sibling].parent = grandParent;
+		if (grandParent == NullNode)
+		{
+			m_root = sibling;
+		}
+		else if (m_nodes[grandParent].child1 == parent)
+		{
+			m_nodes[grandParent].child1 = sibling;
+		}
+		else
+		{
+			m_nodes[grandParent].child2 = sibling;
+		}
+		FreeNode(parent);
+		Refit(grandParent);
+	}
+
+	void BoundingVolumeTree::Refit(uint32_t node)
+	{
+		while (node != NullNode)
+		{
+			node = Balance(node);
+			auto& current = m_nodes[node];
+			const auto& child1 = m_nodes[current.child1];
+			const auto& child2 = m_nodes[current.child2];
+			current.bounds = Union(child1.bounds, child2.bounds);
+			current.height =
+			    1 + std::max(child1.height, child2.height);
+			node = current.parent;
+		}
+	}
+
+	// Rotates the taller grandchild up when a's children
+	// differ in height by more than one. Returns the node
+	// now in a's place.
+	uint32_t BoundingVolumeTree::Balance(uint32_t a)
+	{
+		auto& nodeA = m_nodes[a];
+		if (nodeA.IsLeaf() || nodeA.height < 2)
+		{
+			return a;
+		}
+
+		const auto b = nodeA.child1;
+		const auto c = nodeA.child2;
+		const auto balance =
+		    m_nodes[c].height - m_nodes[b].height;
+		if (balance >= -1 && balance <= 1)
+		{
+			return a;
+		}
+
+		// The taller child rises; its taller child stays
+		// under it, the other goes to a.
+		const auto up = balance > 1 ? c : b;
+		const auto down = balance > 1 ? b : c;
+		auto& nodeUp = m_nodes[up];
+		const auto f = nodeUp.child1;
+		const auto g = nodeUp.child2;
+
+		nodeUp.child1 = a;
+		nodeUp.parent = nodeA.parent;
+		nodeA.parent = up;
+		if (nodeUp.parent == NullNode)
+		{
+			m_root = up;
+		}
+		else if (m_nodes[nodeUp.parent].child1 == a)
+		{
+			m_nodes[nodeUp.parent].child1 = up;
+		}
+		else
+		{
+			m_nodes[nodeUp.parent].child2 = up;
+		}
+
+		const auto keep =
+		    m_nodes[f].height > m_nodes[g].height ? f : g;
+		const auto give = keep == f ? g : f;
+		nodeUp.child2 = keep;
+		if (balance > 1)
+		{
+			nodeA.child2 = give;
+		}
+		else
+		{
+			nodeA.child1 = give;
+		}
+		m_nodes[give].parent = a;
+
+		nodeA.bounds = Union(m_nodes[down].bounds,
+		                     m_nodes[give].bounds);
+		nodeA.height = 1 + std::max(m_nodes[down].height,
+		                            m_nodes[give].height);
+		nodeUp.bounds =
+		    Union(nodeA.bounds, m_nodes[keep].bounds);
+		nodeUp.height =
+		    1 + std::max(nodeA.height, m_nodes[keep].height);
+		return up;
+	}
+
+	float BoundingVolumeTree::RayEntry(
+	    const Graphics::Aabb& box,
+	    const Graphics::Float3& origin,
+	    const Graphics::Float3& inverseDirection,
+	    float maxDistance)
+	{
+		float near = 0.0f;
+		float far = maxDistance;
+		const float o[3] = {origin.x, origin.y, origin.z};
+		const float d[3] = {inverseDirection.x,
+		                    inverseDirection.y,
+		                    inverseDirection.z};
+		const float lo[3] = {box.min.x, box.min.y, box.min.z};
+		const float hi[3] = {box.max.x, box.max.y, box.max.z};
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			auto t0 = (lo[axis] - o[axis]) * d[axis];
+			auto t1 = (hi[axis] - o[axis]) * d[axis];
+			if (t0 > t1)
+			{
+				std::swap(t0, t1);
+			}
+			// NaN from a parallel ray on a slab plane keeps
+			// the current interval.
+			near = t0 > near ? t0 : near;
+			far = t1 < far ? t1 : far;
+			if (near > far)
+			{
+				return -1.0f;
+			}
+		}
+		return near;
+	}
+} // namespace AthiVegam::Scene
@@ -0,0 +1,295 @@
+#include "AthiVegam/Scene/StaticBatcher.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/Bounds.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Managers/ResourceManager.h"
+#include "AthiVegam/Math/Matrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <tuple>
+
+namespace AthiVegam::Scene
+{
+	namespace
+	{
+		using Graphics::VertexFormat;
+
+		const Graphics::VertexAttribute*
+		FindAttribute(const Graphics::VertexLayout& layout,
+		              uint32_t location)
+		{
+			for (uint32_t i = 0; i < layout.GetAttributeCount();
+			     ++i)
+			{
+				if (layout.GetAttribute(i).location == location)
+				{
+					return &layout.GetAttribute(i);
+				}
+			}
+			return nullptr;
+		}
+
+		inline float UnpackSnorm10(uint32_t bits)
+		{
+			// Sign-extends the 10-bit field.
+			const auto value =
+			    static_cast<int32_t>(bits << 22) >> 22;
+			return std::max(static_cast<float>(value) / 511.0f,
+			                -1.0f);
+		}
+
+		// Turns the direction at p by the normal matrix,
+		// keeping its format and any w.
+		void TransformDirection(const Math::Mat4& normalMatrix,
+		                        VertexFormat format, uint8_t* p)
+		{
+			Math::Vec3 direction;
+			uint32_t packed = 0;
+			if (format == VertexFormat::Int1010102Norm)
+			{
+				std::memcpy(&packed, p, sizeof(packed));
+				direction = {UnpackSnorm10(packed),
+				             UnpackSnorm10(packed >> 10),
+				             UnpackSnorm10(packed >> 20)};
+			}
+			else
+			{
+				std::memcpy(&direction, p, sizeof(direction));
+			}
+
+			direction = Math::Normalize(
+			    Math::TransformVector(normalMatrix, direction));
+
+			if (format == VertexFormat::Int1010102Norm)
+			{
+				packed = Graphics::PackInt1010102(
+				             direction.x, direction.y,
+				             direction.z)
+				         | (packed & 0xC0000000u);
+				std::memcpy(p, &packed, sizeof(packed));
+			}
+			else
+			{
+				std::memcpy(p, &direction, sizeof(direction));
+			}
+		}
+	} // namespace
+
+	StaticBatcher::StaticBatcher() = default;
+
+	StaticBatcher::StaticBatcher(const Options& options)
+	    : m_options(options)
+	{
+		VEGAM_ASSERT(m_options.cellSize > 0.0f
+		                 && m_options.maxChunkVertices > 0,
+		             "Invalid static batching options");
+	}
+
+	uint32_t StaticBatcher::FindGroup(
+	    const Graphics::VertexLayout& layout,
+	    Graphics::ShaderHandle shader,
+	    Graphics::MaterialHandle material)
+	{
+		for (uint32_t i = 0; i < m_groups.size(); ++i)
+		{
+			const auto& group = m_groups[i];
+			if (group.shader == shader
+			    && group.material == material
+			    && group.layout == layout)
+			{
+				return i;
+			}
+		}
+		m_groups.push_back({layout, shader, material});
+		return static_cast<uint32_t>(m_groups.size() - 1);
+	}
+
+	bool StaticBatcher::Add(
+	    const Graphics::VertexLayout& layout,
+	    const void* vertexData, uint32_t vertexCount,
+	    const uint32_t* elementArray, uint32_t elementCount,
+	    const Graphics::RenderCommands::InstanceTransform&
+	        transform,
+	    Graphics::ShaderHandle shader,
+	    Graphics::MaterialHandle material)
+	{
+		const auto* position = FindAttribute(layout, 0);
+		if (!position
+		    || (position->format != VertexFormat::Float3
+		        && position->format != VertexFormat::Float4)
+		    || !elementArray || elementCount % 3 != 0)
+		{
+			VEGAM_WARN("Static batching needs indexed "
+			           "triangles with float positions");
+			return false;
+		}
+		const auto* normal =
+		    m_options.normalLocation == NoAttribute
+		        ? nullptr
+		        : FindAttribute(layout,
+		                        m_options.normalLocation);
+		if (normal && normal->format != VertexFormat::Float3
+		    && normal->format != VertexFormat::Float4
+		    && normal->format != VertexFormat::Int1010102Norm)
+		{
+			VEGAM_WARN("Static batching can't turn normals "
+			           "of this format");
+			return false;
+		}
+
+		Piece piece;
+		piece.group = FindGroup(layout, shader, material);
+		piece.vertexCount = vertexCount;
+		const auto stride = layout.GetStride();
+		const auto* bytes =
+		    static_cast<const uint8_t*>(vertexData);
+		piece.vertices.assign(bytes,
+		                      bytes + size_t{vertexCount} * stride);
+		piece.indices.assign(elementArray,
+		                     elementArray + elementCount);
+
+		const auto matrix = Math::Mat4::Load(transform.m);
+		const auto normalMatrix =
+		    Math::Transpose(Math::InverseAffine(matrix));
+		for (uint32_t i = 0; i < vertexCount; ++i)
+		{
+			auto* vertex =
+			    piece.vertices.data() + size_t{i} * stride;
+			Math::Vec3 p;
+			std::memcpy(&p, vertex + position->offset,
+			            sizeof(p));
+			p = Math::TransformPoint(matrix, p);
+			std::memcpy(vertex + position->offset, &p,
+			            sizeof(p));
+			if (normal)
+			{
+				TransformDirection(normalMatrix, normal->format,
+				                   vertex + normal->offset);
+			}
+		}
+
+		// Mirroring turns front faces into back faces.
+		const auto& c = matrix.columns;
+		if (Math::Dot(c[0].Xyz(),
+		              Math::Cross(c[1].Xyz(), c[2].Xyz()))
+		    < 0.0f)
+		{
+			for (size_t i = 0; i < piece.indices.size(); i += 3)
+			{
+				std::swap(piece.indices[i + 1],
+				          piece.indices[i + 2]);
+			}
+		}
+
+		const auto center =
+		    Graphics::ComputeBounds(layout,
+		                            piece.vertices.data(),
+		                            vertexCount)
+		        .GetSphere()
+		        .center;
+		piece.cell[0] = static_cast<int32_t>(
+		    std::floor(center.x / m_options.cellSize));
+		piece.cell[1] = static_cast<int32_t>(
+		    std::floor(center.y / m_options.cellSize));
+		piece.cell[2] = static_cast<int32_t>(
+		    std::floor(center.z / m_options.cellSize));
+		m_pieces.push_back(std::move(piece));
+		return true;
+	}
+
+	std::vector<SceneObject>
+	StaticBatcher::Build(Managers::ResourceManager& resources)
+	{
+		VEGAM_PROFILE_SCOPE("StaticBatcher::Build");
+
+		// Pieces of a group and cell end up next to each
+		// other.
+		std::vector<uint32_t> order(m_pieces.size());
+		std::iota(order.begin(), order.end(), 0u);
+		std::sort(order.begin(), order.end(),
+		          [&](uint32_t a, uint32_t b) {
+			          const auto& pa = m_pieces[a];
+			          const auto& pb = m_pieces[b];
+			          return std::tie(pa.group, pa.cell[0],
+			                          pa.cell[1], pa.cell[2])
+			                 < std::tie(pb.group, pb.cell[0],
+			                            pb.cell[1], pb.cell[2]);
+		          });
+
+		std::vector<SceneObject> chunks;
+		std::vector<uint8_t> vertices;
+		std::vector<uint32_t> indices;
+		uint32_t vertexCount = 0;
+
+		const auto flush = [&](const Group& group) {
+			if (vertexCount == 0)
+			{
+				return;
+			}
+			SceneObject chunk;
+			chunk.shader = group.shader;
+			chunk.material = group.material;
+			chunk.bounds = Graphics::ComputeBounds(
+			    group.layout, vertices.data(), vertexCount);
+			chunk.mesh =
+			    m_options.optimize
+			        ? resources.CreateOptimizedMesh(
+			              group.layout, vertices.data(),
+			              vertexCount, indices.data(),
+			              static_cast<uint32_t>(indices.size()))
+			        : resources.CreateMesh(
+			              group.layout, vertices.data(),
+			              vertexCount, indices.data(),
+			              static_cast<uint32_t>(indices.size()));
+			chunks.push_back(chunk);
+			vertices.clear();
+			indices.clear();
+			vertexCount = 0;
+		};
+
+		const Piece* previous = nullptr;
+		for (const auto i : order)
+		{
+			const auto& piece = m_pieces[i];
+			if (previous
+			    && (piece.group != previous->group
+			        || !std::equal(piece.cell, piece.cell + 3,
+			                       previous->cell)
+			        || vertexCount + piece.vertexCount
+			               > m_options.maxChunkVertices))
+			{
+				flush(m_groups[previous->group]);
+			}
+			previous = &piece;
+
+			for (const auto index : piece.indices)
+			{
+				indices.push_back(vertexCount + index);
+			}
+			vertices.insert(vertices.end(),
+			                piece.vertices.begin(),
+			                piece.vertices.end());
+			vertexCount += piece.vertexCount;
+		}
+		if (previous)
+		{
+			flush(m_groups[previous->group]);
+		}
+
+		VEGAM_INFO("Static batching merged {} pieces into {} "
+		           "chunks",
+		           m_pieces.size(), chunks.size());
+		Clear();
+		return chunks;
+	}
+
+	void StaticBatcher::Clear()
+	{
+		m_groups.clear();
+		m_pieces.clear();
+	}
+} // namespace AthiVegam::Scene
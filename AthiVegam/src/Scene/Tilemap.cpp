@@ -0,0 +1,325 @@
+#include "AthiVegam/Scene/Tilemap.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/CommandList.h"
+#include "AthiVegam/Graphics/Culling.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Managers/ResourceManager.h"
+
+#include <algorithm>
+
+namespace AthiVegam::Scene
+{
+	namespace
+	{
+		// Position and texture coordinates.
+		constexpr uint32_t VertexFloats = 5;
+		constexpr uint32_t MaxChunkSize = 128;
+	} // namespace
+
+	Graphics::VertexLayout Tilemap::GetLayout()
+	{
+		Graphics::VertexLayout layout;
+		layout.Add(0, Graphics::VertexFormat::Float3)
+		    .Add(1, Graphics::VertexFormat::Float2);
+		return layout;
+	}
+
+	Tilemap::Tilemap() : Tilemap(Options{}) {}
+
+	Tilemap::Tilemap(const Options& options)
+	    : m_options(options)
+	{
+		VEGAM_ASSERT(options.chunkSize > 0
+		                 && options.chunkSize <= MaxChunkSize,
+		             "Tilemap chunks must be 1 to 128 tiles");
+		VEGAM_ASSERT(options.atlasColumns > 0
+		                 && options.atlasRows > 0
+		                 && options.tileSize > 0.0f,
+		             "Invalid tilemap options");
+		const auto size = options.chunkSize;
+		m_chunksX = (options.width + size - 1) / size;
+		m_chunksY = (options.height + size - 1) / size;
+		m_tiles.assign(size_t{options.width} * options.height,
+		               EmptyTile);
+		m_chunks.resize(size_t{m_chunksX} * m_chunksY);
+	}
+
+	Tilemap::~Tilemap()
+	{
+		VEGAM_ASSERT(std::none_of(m_chunks.begin(),
+		                          m_chunks.end(),
+		                          [](const Chunk& chunk) {
+			                          return chunk.mesh.IsValid()
+			                                 || chunk.pending
+			                                        .IsValid();
+		                          }),
+		             "Tilemap destroyed without Destroy()");
+	}
+
+	void Tilemap::SetShader(Graphics::ShaderHandle shader,
+	                        Graphics::MaterialHandle material)
+	{
+		m_shader = shader;
+		m_material = material;
+	}
+
+	void Tilemap::SetTransform(
+	    const Graphics::RenderCommands::InstanceTransform&
+	        transform)
+	{
+		m_transform = transform;
+		for (auto& chunk : m_chunks)
+		{
+			UpdateSphere(chunk);
+		}
+	}
+
+	void Tilemap::SetTile(uint32_t x, uint32_t y, Tile tile)
+	{
+		VEGAM_ASSERT(tile <= m_options.atlasColumns
+		                         * m_options.atlasRows,
+		             "Tile outside the atlas");
+		if (x >= m_options.width || y >= m_options.height)
+		{
+			return;
+		}
+		auto& current = m_tiles[size_t{y} * m_options.width + x];
+		if (current == tile)
+		{
+			return;
+		}
+		current = tile;
+		MarkDirty(x / m_options.chunkSize,
+		          y / m_options.chunkSize);
+	}
+
+	Tilemap::Tile Tilemap::GetTile(uint32_t x, uint32_t y) const
+	{
+		if (x >= m_options.width || y >= m_options.height)
+		{
+			return EmptyTile;
+		}
+		return m_tiles[size_t{y} * m_options.width + x];
+	}
+
+	void Tilemap::Fill(uint32_t x, uint32_t y, uint32_t width,
+	                   uint32_t height, Tile tile)
+	{
+		const auto endX = std::min<uint64_t>(
+		    uint64_t{x} + width, m_options.width);
+		const auto endY = std::min<uint64_t>(
+		    uint64_t{y} + height, m_options.height);
+		for (auto ty = y; ty < endY; ++ty)
+		{
+			for (auto tx = x; tx < endX; ++tx)
+			{
+				SetTile(tx, ty, tile);
+			}
+		}
+	}
+
+	void Tilemap::MarkDirty(uint32_t chunkX, uint32_t chunkY)
+	{
+		const auto index = chunkY * m_chunksX + chunkX;
+		auto& chunk = m_chunks[index];
+		if (!chunk.dirty)
+		{
+			chunk.dirty = true;
+			m_dirty.push_back(index);
+		}
+	}
+
+	uint32_t
+	Tilemap::Update(Managers::ResourceManager& resources,
+	                uint32_t maxChunks)
+	{
+		VEGAM_PROFILE_SCOPE("Tilemap::Update");
+
+		// Swap in the meshes that finished uploading.
+		size_t kept = 0;
+		for (const auto index : m_pending)
+		{
+			auto& chunk = m_chunks[index];
+			if (!chunk.pending.IsValid())
+			{
+				// Emptied since.
+				continue;
+			}
+			if (!resources.IsMeshReady(chunk.pending))
+			{
+				m_pending[kept++] = index;
+				continue;
+			}
+			if (chunk.mesh.IsValid())
+			{
+				resources.DestroyMesh(chunk.mesh);
+			}
+			chunk.mesh = chunk.pending;
+			chunk.bounds = chunk.pendingBounds;
+			chunk.pending = {};
+			UpdateSphere(chunk);
+		}
+		m_pending.resize(kept);
+
+		const auto count = static_cast<uint32_t>(
+		    std::min<size_t>(maxChunks, m_dirty.size()));
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const auto index = m_dirty[i];
+			auto& chunk = m_chunks[index];
+			chunk.dirty = false;
+			Rebuild(resources, chunk, index);
+		}
+		m_dirty.erase(m_dirty.begin(), m_dirty.begin() + count);
+		return count;
+	}
+
+	void Tilemap::Rebuild(Managers::ResourceManager& resources,
+	                      Chunk& chunk, uint32_t index)
+	{
+		const auto size = m_options.chunkSize;
+		const auto tileSize = m_options.tileSize;
+		const auto columns = m_options.atlasColumns;
+		const auto cellWidth = 1.0f / static_cast<float>(columns);
+		const auto cellHeight =
+		    1.0f / static_cast<float>(m_options.atlasRows);
+		const auto insetX = cellWidth * m_options.atlasInset;
+		const auto insetY = cellHeight * m_options.atlasInset;
+
+		const auto beginX = (index % m_chunksX) * size;
+		const auto beginY = (index / m_chunksX) * size;
+		const auto endX =
+		    std::min(beginX + size, m_options.width);
+		const auto endY =
+		    std::min(beginY + size, m_options.height);
+
+		m_vertices.clear();
+		m_indices.clear();
+		Graphics::Aabb bounds{{endX * tileSize, endY * tileSize,
+		                       0.0f},
+		                      {beginX * tileSize,
+		                       beginY * tileSize, 0.0f}};
+		uint32_t vertexCount = 0;
+		for (auto y = beginY; y < endY; ++y)
+		{
+			for (auto x = beginX; x < endX; ++x)
+			{
+				const auto tile =
+				    m_tiles[size_t{y} * m_options.width + x];
+				if (tile == EmptyTile)
+				{
+					continue;
+				}
+				const auto cell = tile - 1u;
+				const auto u0 = static_cast<float>(cell % columns)
+				                    * cellWidth
+				                + insetX;
+				const auto u1 = u0 + cellWidth - 2.0f * insetX;
+				// Atlas rows count down from the top.
+				const auto v1 =
+				    1.0f
+				    - static_cast<float>(cell / columns)
+				          * cellHeight
+				    - insetY;
+				const auto v0 = v1 - cellHeight + 2.0f * insetY;
+
+				const auto x0 = static_cast<float>(x) * tileSize;
+				const auto y0 = static_cast<float>(y) * tileSize;
+				const auto x1 = x0 + tileSize;
+				const auto y1 = y0 + tileSize;
+				const float quad[4 * VertexFloats] = {
+				    x0, y0, 0, u0, v0, x1, y0, 0, u1, v0,
+				    x0, y1, 0, u0, v1, x1, y1, 0, u1, v1};
+				m_vertices.insert(m_vertices.end(), quad,
+				                  quad + 4 * VertexFloats);
+				for (const auto corner : {0u, 1u, 2u, 2u, 1u, 3u})
+				{
+					m_indices.push_back(vertexCount + corner);
+				}
+				vertexCount += 4;
+
+				bounds.min.x = std::min(bounds.min.x, x0);
+				bounds.min.y = std::min(bounds.min.y, y0);
+				bounds.max.x = std::max(bounds.max.x, x1);
+				bounds.max.y = std::max(bounds.max.y, y1);
+			}
+		}
+
+		// A rebuild still uploading is overtaken.
+		const auto wasPending = chunk.pending.IsValid();
+		if (wasPending)
+		{
+			resources.DestroyMesh(chunk.pending);
+			chunk.pending = {};
+		}
+		if (vertexCount == 0)
+		{
+			if (chunk.mesh.IsValid())
+			{
+				resources.DestroyMesh(chunk.mesh);
+				chunk.mesh = {};
+			}
+			return;
+		}
+
+		chunk.pending = resources.CreateMeshAsync(
+		    GetLayout(), m_vertices.data(), vertexCount,
+		    m_indices.data(),
+		    static_cast<uint32_t>(m_indices.size()));
+		chunk.pendingBounds = bounds;
+		if (!wasPending)
+		{
+			m_pending.push_back(index);
+		}
+	}
+
+	void Tilemap::UpdateSphere(Chunk& chunk) const
+	{
+		chunk.sphere = Graphics::Transform(
+		    chunk.bounds.GetSphere(), m_transform.m);
+	}
+
+	void Tilemap::Submit(const Graphics::Frustum& frustum,
+	                     Graphics::CommandList& list) const
+	{
+		VEGAM_PROFILE_SCOPE("Tilemap::Submit");
+		// Every chunk shares the map's transform.
+		uint32_t instance = Graphics::RenderCommands::NoInstance;
+		for (const auto& chunk : m_chunks)
+		{
+			if (!chunk.mesh.IsValid()
+			    || !frustum.Intersects(chunk.sphere))
+			{
+				continue;
+			}
+			if (instance == Graphics::RenderCommands::NoInstance)
+			{
+				instance = list.PushInstances(&m_transform, 1);
+			}
+			list.Submit(Graphics::RenderCommands::RenderMesh{
+			    chunk.mesh, m_shader, instance, {}, m_material});
+		}
+	}
+
+	void Tilemap::Destroy(Managers::ResourceManager& resources)
+	{
+		m_dirty.clear();
+		m_pending.clear();
+		for (uint32_t i = 0; i < m_chunks.size(); ++i)
+		{
+			auto& chunk = m_chunks[i];
+			if (chunk.mesh.IsValid())
+			{
+				resources.DestroyMesh(chunk.mesh);
+			}
+			if (chunk.pending.IsValid())
+			{
+				resources.DestroyMesh(chunk.pending);
+			}
+			chunk = {};
+			chunk.dirty = true;
+			m_dirty.push_back(i);
+		}
+	}
+} // namespace AthiVegam::Scene
@@ -0,0 +1,345 @@
+#include "AthiVegam/Scene/TransformHierarchy.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Managers/JobManager.h"
+#include "AthiVegam/Math/Matrix.h"
+
+#include <algorithm>
+
+namespace AthiVegam::Scene
+{
+	namespace
+	{
+		inline Math::Mat4 Compose(const LocalTransform& local)
+		{
+			return Math::Mat4::Trs(local.position, local.rotation,
+			                       local.scale);
+		}
+	} // namespace
+
+	TransformHierarchy::NodeId
+	TransformHierarchy::Create(const LocalTransform& local,
+	                           NodeId parent)
+	{
+		VEGAM_ASSERT(parent == InvalidNode || IsAlive(parent),
+		             "Parenting to a destroyed transform");
+
+		NodeId id;
+		if (!m_freeIds.empty())
+		{
+			id = m_freeIds.back();
+			m_freeIds.pop_back();
+		}
+		else
+		{
+			id = static_cast<NodeId>(m_slots.size());
+			m_slots.emplace_back();
+		}
+
+		auto& slot = m_slots[id];
+		slot.parent = parent;
+		slot.index = static_cast<uint32_t>(m_nodes.size());
+		slot.alive = true;
+
+		m_nodes.push_back(id);
+		m_parents.push_back(NoParent);
+		m_locals.push_back(local);
+		m_worlds.emplace_back();
+		Compose(local).Store(m_worlds.back().m);
+		m_dirty.push_back(1);
+		m_changed.push_back(0);
+		m_anyDirty = true;
+		m_sorted = false;
+		return id;
+	}
+
+	void TransformHierarchy::Destroy(NodeId node)
+	{
+		VEGAM_ASSERT(IsAlive(node),
+		             "Destroying a destroyed transform");
+		m_slots[node].alive = false;
+		m_sorted = false;
+	}
+
+	void TransformHierarchy::Clear()
+	{
+		m_slots.clear();
+		m_freeIds.clear();
+		m_nodes.clear();
+		m_parents.clear();
+		m_locals.clear();
+		m_worlds.clear();
+		m_dirty.clear();
+		m_changed.clear();
+		m_levels.clear();
+		m_sorted = true;
+		m_anyDirty = false;
+		m_anyChanged = false;
+	}
+
+	void TransformHierarchy::SetParent(NodeId node,
+	                                   NodeId parent)
+	{
+		VEGAM_ASSERT(IsAlive(node),
+		             "Reparenting a destroyed transform");
+		VEGAM_ASSERT(parent == InvalidNode || IsAlive(parent),
+		             "Parenting to a destroyed transform");
+		for (auto ancestor = parent; ancestor != InvalidNode;
+		     ancestor = m_slots[ancestor].parent)
+		{
+			VEGAM_ASSERT(ancestor != node,
+			             "Parenting a transform to its own "
+			             "descendant");
+		}
+
+		auto& slot = m_slots[node];
+		if (slot.parent == parent)
+		{
+			return;
+		}
+		slot.parent = parent;
+		m_dirty[slot.index] = 1;
+		m_anyDirty = true;
+		m_sorted = false;
+	}
+
+	TransformHierarchy::NodeId
+	TransformHierarchy::GetParent(NodeId node) const
+	{
+		VEGAM_ASSERT(IsAlive(node),
+		             "Reading a destroyed transform");
+		return m_slots[node].parent;
+	}
+
+	bool TransformHierarchy::IsAlive(NodeId node) const
+	{
+		return node < m_slots.size() && m_slots[node].alive;
+	}
+
+	void
+	TransformHierarchy::SetLocal(NodeId node,
+	                             const LocalTransform& local)
+	{
+		VEGAM_ASSERT(IsAlive(node),
+		             "Moving a destroyed transform");
+		const auto index = m_slots[node].index;
+		m_locals[index] = local;
+		m_dirty[index] = 1;
+		m_anyDirty = true;
+	}
+
+	const LocalTransform&
+	TransformHierarchy::GetLocal(NodeId node) const
+	{
+		VEGAM_ASSERT(IsAlive(node),
+		             "Reading a destroyed transform");
+		return m_locals[m_slots[node].index];
+	}
+
+	const TransformHierarchy::Matrix&
+	TransformHierarchy::GetWorld(NodeId node) const
+	{
+		VEGAM_ASSERT(IsAlive(node),
+		             "Reading a destroyed transform");
+		return m_worlds[m_slots[node].index];
+	}
+
+	bool TransformHierarchy::HasChanged(NodeId node) const
+	{
+		VEGAM_ASSERT(IsAlive(node),
+		             "Reading a destroyed transform");
+		return m_changed[m_slots[node].index] != 0;
+	}
+
+	void TransformHierarchy::Update()
+	{
+		VEGAM_PROFILE_SCOPE("TransformHierarchy::Update");
+		if (!Prepare())
+		{
+			return;
+		}
+		for (uint32_t i = 0; i < m_nodes.size(); ++i)
+		{
+			UpdateNode(i);
+		}
+	}
+
+	void
+	TransformHierarchy::Update(Managers::JobManager& jobs)
+	{
+		VEGAM_PROFILE_SCOPE("TransformHierarchy::Update");
+		if (!Prepare())
+		{
+			return;
+		}
+		for (size_t level = 0; level + 1 < m_levels.size();
+		     ++level)
+		{
+			const auto begin = m_levels[level];
+			const auto count = m_levels[level + 1] - begin;
+			if (count < ParallelBatch)
+			{
+				for (auto i = begin; i < begin + count; ++i)
+				{
+					UpdateNode(i);
+				}
+				continue;
+			}
+			jobs.ParallelFor(count, ParallelBatch,
+			                 [this, begin](uint32_t i) {
+				                 UpdateNode(begin + i);
+			                 });
+		}
+	}
+
+	bool TransformHierarchy::Prepare()
+	{
+		if (!m_sorted)
+		{
+			Rebuild();
+		}
+		if (!m_anyDirty)
+		{
+			if (m_anyChanged)
+			{
+				std::fill(m_changed.begin(), m_changed.end(),
+				          uint8_t{0});
+				m_anyChanged = false;
+			}
+			return false;
+		}
+		m_anyDirty = false;
+		m_anyChanged = true;
+		return true;
+	}
+
+	void TransformHierarchy::UpdateNode(uint32_t index)
+	{
+		const auto parent = m_parents[index];
+		const bool changed =
+		    m_dirty[index]
+		    || (parent != NoParent && m_changed[parent]);
+		m_changed[index] = changed;
+		if (!changed)
+		{
+			return;
+		}
+
+		m_dirty[index] = 0;
+		const auto local = Compose(m_locals[index]);
+		if (parent == NoParent)
+		{
+			local.Store(m_worlds[index].m);
+		}
+		else
+		{
+			(Math::Mat4::Load(m_worlds[parent].m) * local)
+			    .Store(m_worlds[index].m);
+		}
+	}
+
+	void TransformHierarchy::Rebuild()
+	{
+		VEGAM_PROFILE_SCOPE("TransformHierarchy::Rebuild");
+
+		// Depth of every node, found by walking up to the
+		// first ancestor whose depth is known. Descendants
+		// of destroyed nodes are destroyed here.
+		constexpr int32_t Unknown = -1;
+		constexpr int32_t Dead = -2;
+		std::vector<int32_t> depths(m_slots.size(), Unknown);
+		std::vector<NodeId> path;
+		int32_t maxDepth = -1;
+		for (const auto id : m_nodes)
+		{
+			auto ancestor = id;
+			while (ancestor != InvalidNode
+			       && depths[ancestor] == Unknown
+			       && m_slots[ancestor].alive)
+			{
+				path.push_back(ancestor);
+				ancestor = m_slots[ancestor].parent;
+			}
+
+			int32_t depth = -1;
+			if (ancestor != InvalidNode)
+			{
+				depth = m_slots[ancestor].alive
+				            ? depths[ancestor]
+				            : Dead;
+			}
+			for (auto it = path.rbegin(); it != path.rend();
+			     ++it)
+			{
+				if (depth != Dead)
+				{
+					++depth;
+					maxDepth = std::max(maxDepth, depth);
+				}
+				depths[*it] = depth;
+			}
+			path.clear();
+			if (!m_slots[id].alive)
+			{
+				depths[id] = Dead;
+			}
+		}
+
+		// Stable counting sort by depth.
+		m_levels.assign(maxDepth + 2, 0);
+		for (const auto id : m_nodes)
+		{
+			if (depths[id] != Dead)
+			{
+				++m_levels[depths[id] + 1];
+			}
+		}
+		for (size_t level = 1; level < m_levels.size();
+		     ++level)
+		{
+			m_levels[level] += m_levels[level - 1];
+		}
+
+		const auto count = m_levels.back();
+		std::vector<NodeId> nodes(count);
+		std::vector<LocalTransform> locals(count);
+		std::vector<Matrix> worlds(count);
+		std::vector<uint8_t> dirty(count);
+		std::vector<uint32_t> next(m_levels.begin(),
+		                           m_levels.end() - 1);
+		for (uint32_t i = 0; i < m_nodes.size(); ++i)
+		{
+			const auto id = m_nodes[i];
+			if (depths[id] == Dead)
+			{
+				m_slots[id].alive = false;
+				m_freeIds.push_back(id);
+				continue;
+			}
+			const auto index = next[depths[id]]++;
+			nodes[index] = id;
+			locals[index] = m_locals[i];
+			worlds[index] = m_worlds[i];
+			dirty[index] = m_dirty[i];
+			m_slots[id].index = index;
+		}
+
+		m_parents.resize(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const auto parent = m_slots[nodes[i]].parent;
+			m_parents[i] = parent == InvalidNode
+			                   ? NoParent
+			                   : m_slots[parent].index;
+		}
+
+		m_nodes = std::move(nodes);
+		m_locals = std::move(locals);
+		m_worlds = std::move(worlds);
+		m_dirty = std::move(dirty);
+		m_changed.assign(count, 0);
+		m_anyChanged = false;
+		m_sorted = true;
+	}
+} // namespace AthiVegam::Scene
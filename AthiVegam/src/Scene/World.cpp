@@ -0,0 +1,442 @@
+#include "AthiVegam/Scene/World.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Graphics/CommandList.h"
+#include "AthiVegam/Graphics/Impostors.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace AthiVegam::Scene
+{
+	namespace
+	{
+		using Graphics::Aabb;
+
+		inline bool IsFinite(const Aabb& box)
+		{
+			return std::isfinite(box.max.x - box.min.x)
+			       && std::isfinite(box.max.y - box.min.y)
+			       && std::isfinite(box.max.z - box.min.z);
+		}
+
+		// Outside once the corner furthest along a plane's
+		// normal is behind it; inside when the nearest
+		// corner is in front of every plane.
+		Overlap TestFrustum(const Graphics::Frustum& frustum,
+		                    const Aabb& box)
+		{
+			auto overlap = Overlap::Inside;
+			for (const auto& plane : frustum.planes)
+			{
+				const auto furthest =
+				    plane.x * (plane.x > 0 ? box.max.x : box.min.x)
+				    + plane.y
+				          * (plane.y > 0 ? box.max.y : box.min.y)
+				    + plane.z
+				          * (plane.z > 0 ? box.max.z : box.min.z)
+				    + plane.w;
+				if (furthest < 0.0f)
+				{
+					return Overlap::Outside;
+				}
+				const auto nearest =
+				    plane.x * (plane.x > 0 ? box.min.x : box.max.x)
+				    + plane.y
+				          * (plane.y > 0 ? box.min.y : box.max.y)
+				    + plane.z
+				          * (plane.z > 0 ? box.min.z : box.max.z)
+				    + plane.w;
+				if (nearest < 0.0f)
+				{
+					overlap = Overlap::Partial;
+				}
+			}
+			return overlap;
+		}
+
+		Overlap TestSphere(const Graphics::Float3& center,
+		                   float radius, const Aabb& box)
+		{
+			const auto squared = [](float v) { return v * v; };
+			const auto nearest =
+			    squared(center.x
+			            - std::clamp(center.x, box.min.x,
+			                         box.max.x))
+			    + squared(center.y
+			              - std::clamp(center.y, box.min.y,
+			                           box.max.y))
+			    + squared(center.z
+			              - std::clamp(center.z, box.min.z,
+			                           box.max.z));
+			if (nearest > radius * radius)
+			{
+				return Overlap::Outside;
+			}
+			const auto farthest =
+			    squared(std::max(center.x - box.min.x,
+			                     box.max.x - center.x))
+			    + squared(std::max(center.y - box.min.y,
+			                       box.max.y - center.y))
+			    + squared(std::max(center.z - box.min.z,
+			                       box.max.z - center.z));
+			return farthest <= radius * radius
+			           ? Overlap::Inside
+			           : Overlap::Partial;
+		}
+	} // namespace
+
+	World::World(float margin)
+	    : m_tree(margin)
+	{
+	}
+
+	World::ObjectId World::Add(const SceneObject& object)
+	{
+		ObjectId id;
+		if (!m_freeIds.empty())
+		{
+			id = m_freeIds.back();
+			m_freeIds.pop_back();
+		}
+		else
+		{
+			id = static_cast<ObjectId>(m_objects.size());
+			m_objects.emplace_back();
+		}
+
+		auto& slot = m_objects[id];
+		slot.object = object;
+		slot.alive = true;
+		slot.lod = {};
+		slot.lodFrame = 0;
+		++m_count;
+		Place(id);
+		return id;
+	}
+
+	void World::Remove(ObjectId object)
+	{
+		VEGAM_ASSERT(object < m_objects.size()
+		                 && m_objects[object].alive,
+		             "Removing a removed scene object");
+		Unplace(object);
+		m_objects[object].alive = false;
+		m_freeIds.push_back(object);
+		--m_count;
+	}
+
+	void World::Clear()
+	{
+		m_objects.clear();
+		m_freeIds.clear();
+		m_unbounded.clear();
+		m_tree.Clear();
+		m_count = 0;
+	}
+
+	void World::SetTransform(
+	    ObjectId object,
+	    const Graphics::RenderCommands::InstanceTransform&
+	        transform)
+	{
+		auto& slot = m_objects[object];
+		VEGAM_ASSERT(slot.alive,
+		             "Moving a removed scene object");
+		const auto wasBounded =
+		    slot.leaf != BoundingVolumeTree::NullNode;
+		slot.object.transform = transform;
+		slot.worldBounds = Graphics::Transform(
+		    slot.object.bounds, transform.m);
+		if (wasBounded)
+		{
+			// Usually inside the leaf's margin.
+			m_tree.Move(slot.leaf, slot.worldBounds);
+		}
+	}
+
+	void World::SetBounds(ObjectId object,
+	                      const Graphics::Aabb& bounds)
+	{
+		VEGAM_ASSERT(m_objects[object].alive,
+		             "Resizing a removed scene object");
+		Unplace(object);
+		m_objects[object].object.bounds = bounds;
+		Place(object);
+	}
+
+	const SceneObject& World::Get(ObjectId object) const
+	{
+		return m_objects[object].object;
+	}
+
+	const Graphics::Aabb&
+	World::GetWorldBounds(ObjectId object) const
+	{
+		return m_objects[object].worldBounds;
+	}
+
+	void World::Place(ObjectId object)
+	{
+		auto& slot = m_objects[object];
+		slot.worldBounds = Graphics::Transform(
+		    slot.object.bounds, slot.object.transform.m);
+		if (IsFinite(slot.worldBounds))
+		{
+			slot.leaf = m_tree.Insert(slot.worldBounds, object);
+		}
+		else
+		{
+			slot.leaf = BoundingVolumeTree::NullNode;
+			m_unbounded.push_back(object);
+		}
+	}
+
+	void World::Unplace(ObjectId object)
+	{
+		auto& slot = m_objects[object];
+		if (slot.leaf != BoundingVolumeTree::NullNode)
+		{
+			m_tree.Remove(slot.leaf);
+			slot.leaf = BoundingVolumeTree::NullNode;
+			return;
+		}
+		const auto it = std::find(m_unbounded.begin(),
+		                          m_unbounded.end(), object);
+		if (it != m_unbounded.end())
+		{
+			*it = m_unbounded.back();
+			m_unbounded.pop_back();
+		}
+	}
+
+	// Leaves are tested by their exact world box below
+	// their fat one, so margins never add objects.
+	template <typename Visit>
+	void World::QueryFrustum(const Graphics::Frustum& frustum,
+	                         Visit&& visit) const
+	{
+		for (const auto object : m_unbounded)
+		{
+			visit(object);
+		}
+		m_tree.Query(
+		    [&](const Aabb& box) {
+			    return TestFrustum(frustum, box);
+		    },
+		    [&](uint32_t object) {
+			    if (TestFrustum(frustum,
+			                    m_objects[object].worldBounds)
+			        != Overlap::Outside)
+			    {
+				    visit(object);
+			    }
+		    });
+	}
+
+	void World::QueryFrustum(const Graphics::Frustum& frustum,
+	                         std::vector<ObjectId>& objects) const
+	{
+		VEGAM_PROFILE_SCOPE("World::QueryFrustum");
+		QueryFrustum(frustum, [&objects](ObjectId object) {
+			objects.push_back(object);
+		});
+	}
+
+	void World::QueryRadius(const Graphics::Float3& center,
+	                        float radius,
+	                        std::vector<ObjectId>& objects) const
+	{
+		objects.insert(objects.end(), m_unbounded.begin(),
+		               m_unbounded.end());
+		m_tree.Query(
+		    [&](const Aabb& box) {
+			    return TestSphere(center, radius, box);
+		    },
+		    [&](uint32_t object) {
+			    if (TestSphere(center, radius,
+			                   m_objects[object].worldBounds)
+			        != Overlap::Outside)
+			    {
+				    objects.push_back(object);
+			    }
+		    });
+	}
+
+	std::optional<RayHit>
+	World::Raycast(const Graphics::Float3& origin,
+	               const Graphics::Float3& direction,
+	               float maxDistance) const
+	{
+		const Graphics::Float3 inverse{1.0f / direction.x,
+		                               1.0f / direction.y,
+		                               1.0f / direction.z};
+		std::optional<RayHit> nearest;
+		m_tree.RayCast(
+		    origin, direction, maxDistance,
+		    [&](uint32_t object, float) {
+			    const auto distance =
+			        BoundingVolumeTree::RayEntry(
+			            m_objects[object].worldBounds, origin,
+			            inverse, maxDistance);
+			    if (distance >= 0.0f
+			        && (!nearest || distance < nearest->distance))
+			    {
+				    nearest = RayHit{object, distance};
+				    maxDistance = distance;
+			    }
+			    return maxDistance;
+		    });
+		return nearest;
+	}
+
+	void World::Submit(const Graphics::Frustum& frustum,
+	                   Graphics::CommandList& list) const
+	{
+		VEGAM_PROFILE_SCOPE("World::Submit");
+		QueryFrustum(frustum, [&](ObjectId id) {
+			const auto& object = m_objects[id].object;
+			const Graphics::RenderCommands::DrawData data{id};
+			const auto instance = list.PushInstances(
+			    &object.transform, &data, 1);
+			list.Submit(Graphics::RenderCommands::RenderMesh{
+			    object.mesh, object.shader, instance, {},
+			    object.material});
+		});
+	}
+
+	void World::Submit(const float viewProjection[16],
+	                   Graphics::CommandList& list,
+	                   const Graphics::LodSettings& settings)
+	{
+		VEGAM_PROFILE_SCOPE("World::Submit");
+		using Graphics::RenderCommands::NoInstance;
+		using Graphics::RenderCommands::RenderMesh;
+
+		const auto frustum =
+		    Graphics::Frustum::FromMatrix(viewProjection);
+		const auto projectionScale =
+		    Graphics::GetProjectionScale(viewProjection);
+		const auto frame = ++m_lodFrame;
+		// Shared by every object not fading, so their draws
+		// still batch.
+		Graphics::RenderCommands::Constants opaque;
+
+		m_impostorDraws.clear();
+		QueryFrustum(frustum, [&](ObjectId id) {
+			auto& slot = m_objects[id];
+			const auto& object = slot.object;
+			const auto& lods = object.lods;
+			auto instance = NoInstance;
+			// Impostor levels are gathered and drawn after
+			// the walk, an instanced draw per impostor.
+			const auto submit =
+			    [&](uint32_t level,
+			        Graphics::RenderCommands::Constants constants,
+			        float fade) {
+				    if (m_impostors && lods.IsImpostor(level))
+				    {
+					    auto transform = object.transform;
+					    transform.m[3] = fade;
+					    m_impostorDraws.push_back(
+					        {lods.impostor, transform});
+					    return;
+				    }
+				    if (instance == NoInstance)
+				    {
+					    const Graphics::RenderCommands::DrawData
+					        data{id};
+					    instance = list.PushInstances(
+					        &object.transform, &data, 1);
+				    }
+				    list.Submit(RenderMesh{
+				        lods.GetMesh(object.mesh, level),
+				        object.shader, instance, constants,
+				        object.material});
+			    };
+			if (lods.GetLastLevel() == 0)
+			{
+				submit(0, {}, 1.0f);
+				return;
+			}
+
+			const auto sphere = Graphics::Transform(
+			    object.bounds.GetSphere(), object.transform.m);
+			const auto size =
+			    std::isfinite(sphere.radius)
+			        ? Graphics::ProjectedSize(
+			              viewProjection, projectionScale, sphere)
+			        : std::numeric_limits<float>::max();
+			if (slot.lodFrame + 1 != frame)
+			{
+				// Out of view since; nothing to fade from.
+				slot.lod = {};
+				slot.lod.level = static_cast<uint8_t>(
+				    Graphics::SelectLod(lods,
+				                        size * settings.bias, 0,
+				                        0.0f));
+			}
+			slot.lodFrame = frame;
+			auto& lod = slot.lod;
+			Graphics::UpdateLod(lods, size, settings, lod);
+
+			Graphics::RenderCommands::Constants constants;
+			auto fade = 1.0f;
+			if (settings.fadeFrames > 0)
+			{
+				if (lod.IsFading())
+				{
+					constants = list.PushConstants(
+					    Graphics::LodFadeConstants{lod.fade});
+					fade = lod.fade;
+					submit(lod.previous,
+					       list.PushConstants(
+					           Graphics::LodFadeConstants{
+					               -lod.fade}),
+					       -lod.fade);
+				}
+				else
+				{
+					if (opaque.offset
+					    == Graphics::RenderCommands::NoConstants)
+					{
+						opaque = list.PushConstants(
+						    Graphics::LodFadeConstants{});
+					}
+					constants = opaque;
+				}
+			}
+			submit(lod.level, constants, fade);
+		});
+
+		if (m_impostorDraws.empty())
+		{
+			return;
+		}
+		std::stable_sort(m_impostorDraws.begin(),
+		                 m_impostorDraws.end(),
+		                 [](const ImpostorDraw& a,
+		                    const ImpostorDraw& b) {
+			                 return a.impostor < b.impostor;
+		                 });
+		for (size_t first = 0; first < m_impostorDraws.size();)
+		{
+			const auto impostor =
+			    m_impostorDraws[first].impostor;
+			m_impostorInstances.clear();
+			auto end = first;
+			for (; end < m_impostorDraws.size()
+			       && m_impostorDraws[end].impostor == impostor;
+			     ++end)
+			{
+				m_impostorInstances.push_back(
+				    m_impostorDraws[end].transform);
+			}
+			m_impostors->Draw(list, viewProjection, impostor,
+			                  m_impostorInstances);
+			first = end;
+		}
+	}
+} // namespace AthiVegam::Scene
@@ -0,0 +1,415 @@
+#include "AthiVegam/Scene/WorldPartition.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Ecs/SceneSnapshot.h"
+#include "AthiVegam/Graphics/GpuMemory.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Managers/AssetManager.h"
+#include "AthiVegam/Managers/FileManager.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace AthiVegam::Scene
+{
+	WorldPartition::WorldPartition()
+	    : WorldPartition(Settings{})
+	{
+	}
+
+	WorldPartition::WorldPartition(const Settings& settings)
+	    : m_settings(settings)
+	{
+		VEGAM_ASSERT(settings.cellSize > 0.0f
+		                 && settings.unloadRadius
+		                        >= settings.loadRadius,
+		             "Invalid world partition settings");
+	}
+
+	WorldPartition::~WorldPartition()
+	{
+		VEGAM_ASSERT(!m_token,
+		             "WorldPartition destroyed without "
+		             "Shutdown()");
+	}
+
+	void WorldPartition::Initialize(
+	    Managers::FileManager& files,
+	    Managers::AssetManager& assets,
+	    const Ecs::SceneSnapshot& snapshot,
+	    Navigation::NavMesh* navMesh, void* resolveContext)
+	{
+		m_files = &files;
+		m_assets = &assets;
+		m_snapshot = &snapshot;
+		m_navMesh = navMesh;
+		m_resolveContext = resolveContext;
+		m_token = std::make_shared<WorldPartition*>(this);
+	}
+
+	void WorldPartition::Shutdown()
+	{
+		for (auto& [key, cell] : m_cells)
+		{
+			Unload(cell);
+		}
+		m_cells.clear();
+		m_token.reset();
+	}
+
+	void WorldPartition::Update(const Math::Vec3& camera,
+	                            const Math::Vec3& velocity)
+	{
+		VEGAM_PROFILE_SCOPE("WorldPartition::Update");
+		VEGAM_ASSERT(m_token,
+		             "WorldPartition used before Initialize()!");
+
+		const auto predicted =
+		    camera + velocity * m_settings.lookaheadSeconds;
+		const auto distance = [&](CellCoord coord) {
+			return std::min(Distance(coord, camera),
+			                Distance(coord, predicted));
+		};
+
+		// Cells past the unload radius go, reads and all.
+		for (auto it = m_cells.begin(); it != m_cells.end();)
+		{
+			auto& cell = it->second;
+			cell.distance = distance(cell.coord);
+			if (cell.distance > m_settings.unloadRadius)
+			{
+				Unload(cell);
+				it = m_cells.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		// Over budget, loaded cells outside the load radius
+		// go farthest first; the GPU's overage only changes
+		// once a frame, so one cell a frame for it.
+		const auto overGpu = Graphics::GpuMemory::GetOverage() > 0;
+		auto gpuEvictions = overGpu ? 1u : 0u;
+		while (m_memoryUsed > m_settings.memoryBudget
+		       || gpuEvictions > 0)
+		{
+			Cell* farthest = nullptr;
+			for (auto& [key, cell] : m_cells)
+			{
+				if (cell.state == State::Loaded
+				    && cell.distance > m_settings.loadRadius
+				    && (!farthest
+				        || cell.distance > farthest->distance))
+				{
+					farthest = &cell;
+				}
+			}
+			if (!farthest)
+			{
+				break;
+			}
+			const auto key = Key(farthest->coord);
+			Unload(*farthest);
+			m_cells.erase(key);
+			gpuEvictions -= gpuEvictions > 0 ? 1 : 0;
+		}
+
+		// Cells read, nearest first.
+		for (uint32_t i = 0; i < m_settings.maxInstallsPerUpdate
+		                     && m_readyCount > 0;
+		     ++i)
+		{
+			Cell* nearest = nullptr;
+			for (auto& [key, cell] : m_cells)
+			{
+				if (cell.state == State::Ready
+				    && (!nearest
+				        || cell.distance < nearest->distance))
+				{
+					nearest = &cell;
+				}
+			}
+			Install(*nearest);
+		}
+
+		// Cells within the load radius of either position,
+		// found in the box around both.
+		const auto reach = m_settings.loadRadius;
+		const auto first = GetCellCoord(
+		    {std::min(camera.x, predicted.x) - reach, 0.0f,
+		     std::min(camera.z, predicted.z) - reach});
+		const auto last = GetCellCoord(
+		    {std::max(camera.x, predicted.x) + reach, 0.0f,
+		     std::max(camera.z, predicted.z) + reach});
+		m_candidates.clear();
+		for (auto z = first.z; z <= last.z; ++z)
+		{
+			for (auto x = first.x; x <= last.x; ++x)
+			{
+				const CellCoord coord{x, z};
+				if (m_cells.contains(Key(coord)))
+				{
+					continue;
+				}
+				const auto cellDistance = distance(coord);
+				if (cellDistance <= reach)
+				{
+					m_candidates.push_back({cellDistance, coord});
+				}
+			}
+		}
+		std::sort(m_candidates.begin(), m_candidates.end(),
+		          [](const Candidate& a, const Candidate& b) {
+			          return a.distance < b.distance;
+		          });
+
+		// Over a budget, only the camera's own cell loads.
+		const auto own = GetCellCoord(camera);
+		for (const auto& candidate : m_candidates)
+		{
+			const auto force = candidate.coord == own;
+			if ((m_reads >= m_settings.maxReads || overGpu)
+			    && !force)
+			{
+				break;
+			}
+			if (!StartRead(candidate.coord, candidate.distance,
+			               force))
+			{
+				break;
+			}
+		}
+	}
+
+	WorldPartition::CellCoord
+	WorldPartition::GetCellCoord(const Math::Vec3& position) const
+	{
+		return {static_cast<int32_t>(
+		            std::floor(position.x / m_settings.cellSize)),
+		        static_cast<int32_t>(
+		            std::floor(position.z / m_settings.cellSize))};
+	}
+
+	WorldPartition::LoadedCell*
+	WorldPartition::GetCell(CellCoord coord)
+	{
+		const auto it = m_cells.find(Key(coord));
+		return it != m_cells.end() ? it->second.loaded.get()
+		                           : nullptr;
+	}
+
+	void WorldPartition::Cook(const Package& package,
+	                          std::vector<uint8_t>& data)
+	{
+		Core::Serial::Save(package, data, SchemaVersion);
+	}
+
+	uint64_t WorldPartition::Key(CellCoord coord)
+	{
+		return (static_cast<uint64_t>(
+		            static_cast<uint32_t>(coord.x))
+		        << 32)
+		       | static_cast<uint32_t>(coord.z);
+	}
+
+	float WorldPartition::Distance(
+	    CellCoord coord, const Math::Vec3& position) const
+	{
+		// To the nearest point of the cell's square.
+		const auto size = m_settings.cellSize;
+		const auto x0 = static_cast<float>(coord.x) * size;
+		const auto z0 = static_cast<float>(coord.z) * size;
+		const auto dx = std::max(
+		    {x0 - position.x, position.x - (x0 + size), 0.0f});
+		const auto dz = std::max(
+		    {z0 - position.z, position.z - (z0 + size), 0.0f});
+		return std::sqrt(dx * dx + dz * dz);
+	}
+
+	bool WorldPartition::StartRead(CellCoord coord,
+	                               float distance, bool force)
+	{
+		const auto path = fmt::format(
+		    fmt::runtime(m_settings.pathFormat), coord.x,
+		    coord.z);
+		const auto size = m_files->GetSize(path);
+		auto& cell = m_cells[Key(coord)];
+		cell.coord = coord;
+		cell.distance = distance;
+		if (size == 0)
+		{
+			// Remembered, so the path isn't looked up every
+			// frame while the cell is in reach.
+			cell.state = State::Missing;
+			return true;
+		}
+		if (m_memoryUsed + size > m_settings.memoryBudget
+		    && !force)
+		{
+			m_cells.erase(Key(coord));
+			return false;
+		}
+
+		cell.state = State::Reading;
+		cell.generation = ++m_nextGeneration;
+		cell.data = std::make_shared<std::vector<uint8_t>>(
+		    static_cast<size_t>(size));
+		cell.bytes = static_cast<size_t>(size);
+		m_memoryUsed += cell.bytes;
+		++m_reads;
+
+		// The buffer stays with the callback, in case the
+		// cell is dropped before the read completes.
+		m_files->ReadAsync(
+		    path, 0, *cell.data,
+		    [token = std::weak_ptr(m_token), key = Key(coord),
+		     generation = cell.generation,
+		     data = cell.data](bool ok, size_t) {
+			    if (const auto self = token.lock())
+			    {
+				    (*self)->OnRead(key, generation, ok);
+			    }
+		    });
+		return true;
+	}
+
+	void WorldPartition::OnRead(uint64_t key,
+	                            uint32_t generation, bool ok)
+	{
+		const auto it = m_cells.find(key);
+		if (it == m_cells.end()
+		    || it->second.generation != generation
+		    || it->second.state != State::Reading)
+		{
+			return;
+		}
+
+		auto& cell = it->second;
+		--m_reads;
+		if (!ok)
+		{
+			VEGAM_WARN("Error reading world cell ({}, {})",
+			           cell.coord.x, cell.coord.z);
+			m_memoryUsed -= cell.bytes;
+			cell.bytes = 0;
+			cell.data.reset();
+			cell.state = State::Missing;
+			return;
+		}
+		cell.state = State::Ready;
+		++m_readyCount;
+	}
+
+	bool WorldPartition::Install(Cell& cell)
+	{
+		VEGAM_PROFILE_SCOPE("WorldPartition::Install");
+		--m_readyCount;
+		const auto data = std::move(cell.data);
+
+		Package package;
+		uint32_t schemaVersion = 0;
+		if (!Core::Serial::Load(data->data(), data->size(),
+		                        package, &schemaVersion)
+		    || schemaVersion != SchemaVersion
+		    || package.coord != cell.coord)
+		{
+			VEGAM_ERROR("Ignoring malformed world cell ({}, {})",
+			            cell.coord.x, cell.coord.z);
+			m_memoryUsed -= cell.bytes;
+			cell.bytes = 0;
+			cell.state = State::Missing;
+			return false;
+		}
+
+		// Assets first, so the snapshot's resolve functions
+		// find them requested.
+		auto loaded = std::make_unique<LoadedCell>();
+		loaded->coord = cell.coord;
+		const auto priority =
+		    Managers::AssetManager::StreamingPriority(
+		        cell.distance, false);
+		for (const auto id : package.meshes)
+		{
+			loaded->meshes.push_back(m_assets->RequestMesh(
+			    Assets::AssetId{id}, priority));
+		}
+		for (const auto id : package.textures)
+		{
+			loaded->textures.push_back(m_assets->RequestTexture(
+			    Assets::AssetId{id}, priority));
+		}
+		cell.meshIds = std::move(package.meshes);
+		cell.textureIds = std::move(package.textures);
+
+		if (!package.scene.empty()
+		    && !m_snapshot->Load(loaded->registry,
+		                         package.scene.data(),
+		                         package.scene.size(),
+		                         m_resolveContext))
+		{
+			VEGAM_ERROR("World cell ({}, {}) has a malformed "
+			            "scene",
+			            cell.coord.x, cell.coord.z);
+		}
+
+		// The NavMesh rebuilds the tiles it touches in the
+		// background.
+		if (m_navMesh && !package.navIndices.empty())
+		{
+			cell.navGeometry.push_back(m_navMesh->AddGeometry(
+			    package.navVertices, package.navIndices));
+		}
+
+		cell.loaded = std::move(loaded);
+		cell.state = State::Loaded;
+		++m_loadedCount;
+		if (m_loaded)
+		{
+			m_loaded(*cell.loaded);
+		}
+		return true;
+	}
+
+	void WorldPartition::Unload(Cell& cell)
+	{
+		switch (cell.state)
+		{
+		case State::Reading:
+			--m_reads;
+			break;
+		case State::Ready:
+			--m_readyCount;
+			break;
+		case State::Loaded:
+			if (m_unloading)
+			{
+				m_unloading(*cell.loaded);
+			}
+			for (const auto id : cell.meshIds)
+			{
+				m_assets->Release(Assets::AssetId{id});
+			}
+			for (const auto id : cell.textureIds)
+			{
+				m_assets->Release(Assets::AssetId{id});
+			}
+			if (m_navMesh)
+			{
+				for (const auto geometry : cell.navGeometry)
+				{
+					m_navMesh->RemoveGeometry(geometry);
+				}
+			}
+			cell.loaded.reset();
+			--m_loadedCount;
+			break;
+		case State::Missing:
+			break;
+		}
+		m_memoryUsed -= cell.bytes;
+		cell.bytes = 0;
+		cell.data.reset();
+	}
+} // namespace AthiVegam::Scene
@@ -0,0 +1,89 @@
+#include "AthiVegam/Script/Bindings.h"
+
+#include "AthiVegam/Log.h"
+
+namespace AthiVegam::Script
+{
+	void Bindings::Add(std::string_view name,
+	                   NativeFunction function, void* user)
+	{
+		VEGAM_ASSERT(function, "Natives need a function");
+		const auto id = Core::MakeStringId(name);
+		m_constants.erase(id);
+		const auto [it, inserted] = m_nativeIndices.try_emplace(
+		    id, static_cast<uint32_t>(m_natives.size()));
+		if (inserted)
+		{
+			m_natives.push_back(
+			    {std::string(name), function, user});
+		}
+		else
+		{
+			m_natives[it->second].function = function;
+			m_natives[it->second].user = user;
+		}
+		AddNamespaces(name);
+	}
+
+	void Bindings::AddConstant(std::string_view name,
+	                           double value)
+	{
+		const auto id = Core::MakeStringId(name);
+		if (const auto it = m_nativeIndices.find(id);
+		    it != m_nativeIndices.end())
+		{
+			// Unreachable by name from now on.
+			m_natives[it->second].function = nullptr;
+			m_nativeIndices.erase(id);
+		}
+		const auto [it, inserted] = m_constants.try_emplace(
+		    id, static_cast<uint32_t>(m_constantValues.size()));
+		if (inserted)
+		{
+			m_constantValues.push_back(value);
+		}
+		else
+		{
+			m_constantValues[it->second] = value;
+		}
+		AddNamespaces(name);
+	}
+
+	uint32_t Bindings::FindNative(std::string_view name) const
+	{
+		const auto it =
+		    m_nativeIndices.find(Core::MakeStringId(name));
+		return it != m_nativeIndices.end() ? it->second
+		                                   : NotFound;
+	}
+
+	bool Bindings::FindConstant(std::string_view name,
+	                            double& value) const
+	{
+		const auto it =
+		    m_constants.find(Core::MakeStringId(name));
+		if (it == m_constants.end())
+		{
+			return false;
+		}
+		value = m_constantValues[it->second];
+		return true;
+	}
+
+	bool Bindings::IsNamespace(std::string_view name) const
+	{
+		return m_namespaces.find(Core::MakeStringId(name))
+		       != m_namespaces.end();
+	}
+
+	void Bindings::AddNamespaces(std::string_view name)
+	{
+		for (auto dot = name.rfind('.');
+		     dot != std::string_view::npos && dot > 0;
+		     dot = name.rfind('.', dot - 1))
+		{
+			m_namespaces.try_emplace(
+			    Core::MakeStringId(name.substr(0, dot)), 0u);
+		}
+	}
+} // namespace AthiVegam::Script
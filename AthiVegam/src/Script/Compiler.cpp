@@ -0,0 +1,1588 @@
+#include "AthiVegam/Script/Program.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <utility>
+
+namespace AthiVegam::Script
+{
+	namespace
+	{
+		using Op = Program::Op;
+
+		enum class Kind : uint8_t
+		{
+			End,
+			Name,
+			Number,
+			String,
+			// Keywords.
+			And,
+			Break,
+			Do,
+			Else,
+			Elseif,
+			KeywordEnd,
+			False,
+			For,
+			Function,
+			If,
+			In,
+			Local,
+			Nil,
+			Not,
+			Or,
+			Return,
+			Then,
+			True,
+			While,
+			// Symbols.
+			Plus,
+			Minus,
+			Star,
+			Slash,
+			Percent,
+			Hash,
+			Equal,
+			NotEqual,
+			Less,
+			LessEqual,
+			Greater,
+			GreaterEqual,
+			Assign,
+			LeftParen,
+			RightParen,
+			LeftBrace,
+			RightBrace,
+			LeftBracket,
+			RightBracket,
+			Semicolon,
+			Comma,
+			Dot,
+			Colon,
+		};
+
+		struct Token
+		{
+			Kind kind = Kind::End;
+			// Names; the contents of strings.
+			std::string text;
+			double number = 0.0;
+			uint32_t line = 0;
+		};
+
+		constexpr std::array<std::pair<std::string_view, Kind>,
+		                     19>
+		    Keywords{{
+		        {"and", Kind::And},
+		        {"break", Kind::Break},
+		        {"do", Kind::Do},
+		        {"else", Kind::Else},
+		        {"elseif", Kind::Elseif},
+		        {"end", Kind::KeywordEnd},
+		        {"false", Kind::False},
+		        {"for", Kind::For},
+		        {"function", Kind::Function},
+		        {"if", Kind::If},
+		        {"in", Kind::In},
+		        {"local", Kind::Local},
+		        {"nil", Kind::Nil},
+		        {"not", Kind::Not},
+		        {"or", Kind::Or},
+		        {"return", Kind::Return},
+		        {"then", Kind::Then},
+		        {"true", Kind::True},
+		        {"while", Kind::While},
+		    }};
+
+		// Binary operators bind tighter the higher; all
+		// are left associative.
+		struct Binary
+		{
+			int priority;
+			Op op;
+		};
+
+		constexpr int UnaryPriority = 7;
+
+		inline bool IsDigit(char c)
+		{
+			return std::isdigit(static_cast<unsigned char>(c));
+		}
+		inline bool IsNameChar(char c)
+		{
+			return std::isalnum(static_cast<unsigned char>(c))
+			       || c == '_';
+		}
+
+		inline bool GetBinary(Kind kind, Binary& binary)
+		{
+			switch (kind)
+			{
+			case Kind::Or:
+				binary = {1, Op::JumpIfTrueKeep};
+				return true;
+			case Kind::And:
+				binary = {2, Op::JumpIfFalseKeep};
+				return true;
+			case Kind::Equal:
+				binary = {3, Op::Equal};
+				return true;
+			case Kind::NotEqual:
+				binary = {3, Op::NotEqual};
+				return true;
+			case Kind::Less:
+				binary = {3, Op::Less};
+				return true;
+			case Kind::LessEqual:
+				binary = {3, Op::LessEqual};
+				return true;
+			case Kind::Greater:
+				binary = {3, Op::Greater};
+				return true;
+			case Kind::GreaterEqual:
+				binary = {3, Op::GreaterEqual};
+				return true;
+			case Kind::Plus:
+				binary = {5, Op::Add};
+				return true;
+			case Kind::Minus:
+				binary = {5, Op::Subtract};
+				return true;
+			case Kind::Star:
+				binary = {6, Op::Multiply};
+				return true;
+			case Kind::Slash:
+				binary = {6, Op::Divide};
+				return true;
+			case Kind::Percent:
+				binary = {6, Op::Modulo};
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		// How an op changes the stack's depth.
+		inline int GetStackEffect(Op op, uint32_t operand)
+		{
+			switch (op)
+			{
+			case Op::Nil:
+			case Op::True:
+			case Op::False:
+			case Op::Number:
+			case Op::String:
+			case Op::Function:
+			case Op::GetLocal:
+			case Op::GetGlobal:
+			case Op::NewTable:
+			case Op::ForCheck:
+			case Op::Next:
+				return 1;
+			case Op::Negate:
+			case Op::Not:
+			case Op::Length:
+			case Op::Jump:
+			case Op::ForPrepare:
+			case Op::ForStep:
+				return 0;
+			case Op::SetIndex:
+				return -3;
+			case Op::InitIndex:
+				return -2;
+			case Op::Call:
+				return -static_cast<int>(operand);
+			case Op::CallNative:
+				return 1 - static_cast<int>(operand & 0xff);
+			default:
+				return -1;
+			}
+		}
+	} // namespace
+
+	// Parses and emits in one pass, straight from tokens
+	// to stack code.
+	class Compiler
+	{
+	  public:
+		Compiler(std::string_view source, std::string_view name,
+		         const Bindings& bindings, Program& program)
+		    : m_source(source), m_name(name),
+		      m_bindings(bindings), m_program(program)
+		{
+		}
+
+		bool Run(std::string& error)
+		{
+			m_program = {};
+			m_program.m_bindings = &m_bindings;
+			m_program.m_name = m_name;
+			if (Tokenize())
+			{
+				FunctionState main;
+				main.index = AddFunction();
+				m_function = &main;
+				if (Block() && Expect(Kind::End, "<eof>"))
+				{
+					FinishFunction(main, Program::NoName);
+				}
+			}
+			if (!m_error.empty())
+			{
+				error = std::move(m_error);
+				m_program = {};
+				return false;
+			}
+			return true;
+		}
+
+	  private:
+		struct Local
+		{
+			// Empty for the hidden slots of for loops.
+			std::string_view name;
+		};
+
+		struct Loop
+		{
+			std::vector<uint32_t> breaks;
+		};
+
+		struct FunctionState
+		{
+			FunctionState* parent = nullptr;
+			uint32_t index = 0;
+			uint32_t parameters = 0;
+			std::vector<uint32_t> code;
+			std::vector<uint32_t> lines;
+			// Slot i holds locals[i].
+			std::vector<Local> locals;
+			uint32_t maxSlots = 0;
+			int depth = 0;
+			int maxDepth = 0;
+			std::vector<Loop> loops;
+		};
+
+		// Where an expression's value is, until it is
+		// read or assigned.
+		struct Expr
+		{
+			enum class Kind : uint8_t
+			{
+				// On the stack.
+				Pushed,
+				Local,
+				Global,
+				// Table and key on the stack.
+				Indexed,
+				Native,
+			};
+
+			Kind kind = Kind::Pushed;
+			uint32_t index = 0;
+			bool call = false;
+		};
+
+		// Lexing.
+
+		bool Tokenize()
+		{
+			uint32_t line = 1;
+			size_t i = 0;
+			const auto peek = [&](size_t offset) {
+				return i + offset < m_source.size()
+				           ? m_source[i + offset]
+				           : '\0';
+			};
+			while (true)
+			{
+				if (!SkipSpace(i, line))
+				{
+					return false;
+				}
+
+				auto& token = m_tokens.emplace_back();
+				token.line = line;
+				if (i == m_source.size())
+				{
+					return true;
+				}
+
+				const auto c = m_source[i];
+				if (IsNameChar(c) && !IsDigit(c))
+				{
+					const auto start = i;
+					while (IsNameChar(peek(0)))
+					{
+						++i;
+					}
+					const auto word =
+					    m_source.substr(start, i - start);
+					token.kind = Kind::Name;
+					for (const auto& [keyword, kind] : Keywords)
+					{
+						if (word == keyword)
+						{
+							token.kind = kind;
+						}
+					}
+					token.text = word;
+				}
+				else if (IsDigit(c)
+				         || (c == '.' && IsDigit(peek(1))))
+				{
+					if (!LexNumber(i, token))
+					{
+						return false;
+					}
+				}
+				else if (c == '"' || c == '\'')
+				{
+					if (!LexString(i, line, token))
+					{
+						return false;
+					}
+				}
+				else
+				{
+					if (!LexSymbol(i, token))
+					{
+						return false;
+					}
+				}
+			}
+		}
+
+		// Whitespace and comments.
+		bool SkipSpace(size_t& i, uint32_t& line)
+		{
+			while (i < m_source.size())
+			{
+				const auto c = m_source[i];
+				if (c == '\n')
+				{
+					++line;
+					++i;
+				}
+				else if (c == ' ' || c == '\t' || c == '\r')
+				{
+					++i;
+				}
+				else if (m_source.substr(i, 4) == "--[[")
+				{
+					const auto close = m_source.find("]]", i);
+					if (close == std::string_view::npos)
+					{
+						return Fail(line, "Unfinished comment");
+					}
+					const auto begin = m_source.begin();
+					line += static_cast<uint32_t>(std::count(
+					    begin + i, begin + close, '\n'));
+					i = close + 2;
+				}
+				else if (m_source.substr(i, 2) == "--")
+				{
+					while (i < m_source.size()
+					       && m_source[i] != '\n')
+					{
+						++i;
+					}
+				}
+				else
+				{
+					break;
+				}
+			}
+			return true;
+		}
+
+		bool LexNumber(size_t& i, Token& token)
+		{
+			const auto* begin = m_source.data() + i;
+			const auto* end = m_source.data() + m_source.size();
+			token.kind = Kind::Number;
+			if (begin[0] == '0' && end - begin > 1
+			    && (begin[1] == 'x' || begin[1] == 'X'))
+			{
+				uint64_t value = 0;
+				const auto [next, result] =
+				    std::from_chars(begin + 2, end, value, 16);
+				if (result != std::errc() || next == begin + 2)
+				{
+					return Fail(token.line, "Malformed number");
+				}
+				token.number = static_cast<double>(value);
+				i += static_cast<size_t>(next - begin);
+			}
+			else
+			{
+				const auto [next, result] =
+				    std::from_chars(begin, end, token.number);
+				if (result != std::errc())
+				{
+					return Fail(token.line, "Malformed number");
+				}
+				i += static_cast<size_t>(next - begin);
+			}
+			if (i < m_source.size() && IsNameChar(m_source[i]))
+			{
+				return Fail(token.line, "Malformed number");
+			}
+			return true;
+		}
+
+		bool LexString(size_t& i, uint32_t& line, Token& token)
+		{
+			const auto quote = m_source[i++];
+			token.kind = Kind::String;
+			while (true)
+			{
+				if (i >= m_source.size() || m_source[i] == '\n')
+				{
+					return Fail(line, "Unfinished string");
+				}
+				auto c = m_source[i++];
+				if (c == quote)
+				{
+					return true;
+				}
+				if (c == '\\')
+				{
+					if (i >= m_source.size())
+					{
+						return Fail(line, "Unfinished string");
+					}
+					switch (m_source[i++])
+					{
+					case 'n':
+						c = '\n';
+						break;
+					case 't':
+						c = '\t';
+						break;
+					case 'r':
+						c = '\r';
+						break;
+					case '\\':
+						c = '\\';
+						break;
+					case '"':
+						c = '"';
+						break;
+					case '\'':
+						c = '\'';
+						break;
+					case '\n':
+						++line;
+						c = '\n';
+						break;
+					default:
+						return Fail(line, "Invalid escape");
+					}
+				}
+				token.text.push_back(c);
+			}
+		}
+
+		bool LexSymbol(size_t& i, Token& token)
+		{
+			const auto c = m_source[i];
+			const auto next =
+			    i + 1 < m_source.size() ? m_source[i + 1] : '\0';
+			auto length = 1;
+			switch (c)
+			{
+			case '+':
+				token.kind = Kind::Plus;
+				break;
+			case '-':
+				token.kind = Kind::Minus;
+				break;
+			case '*':
+				token.kind = Kind::Star;
+				break;
+			case '/':
+				token.kind = Kind::Slash;
+				break;
+			case '%':
+				token.kind = Kind::Percent;
+				break;
+			case '#':
+				token.kind = Kind::Hash;
+				break;
+			case '(':
+				token.kind = Kind::LeftParen;
+				break;
+			case ')':
+				token.kind = Kind::RightParen;
+				break;
+			case '{':
+				token.kind = Kind::LeftBrace;
+				break;
+			case '}':
+				token.kind = Kind::RightBrace;
+				break;
+			case '[':
+				token.kind = Kind::LeftBracket;
+				break;
+			case ']':
+				token.kind = Kind::RightBracket;
+				break;
+			case ';':
+				token.kind = Kind::Semicolon;
+				break;
+			case ',':
+				token.kind = Kind::Comma;
+				break;
+			case ':':
+				token.kind = Kind::Colon;
+				break;
+			case '.':
+				if (next == '.')
+				{
+					return Fail(token.line,
+					            "Strings cannot be concatenated");
+				}
+				token.kind = Kind::Dot;
+				break;
+			case '=':
+				token.kind =
+				    next == '=' ? Kind::Equal : Kind::Assign;
+				length = next == '=' ? 2 : 1;
+				break;
+			case '<':
+				token.kind =
+				    next == '=' ? Kind::LessEqual : Kind::Less;
+				length = next == '=' ? 2 : 1;
+				break;
+			case '>':
+				token.kind = next == '=' ? Kind::GreaterEqual
+				                         : Kind::Greater;
+				length = next == '=' ? 2 : 1;
+				break;
+			case '~':
+				if (next != '=')
+				{
+					return Fail(token.line, "Unexpected '~'");
+				}
+				token.kind = Kind::NotEqual;
+				length = 2;
+				break;
+			default:
+				return Fail(token.line,
+				            fmt::format("Unexpected '{}'", c));
+			}
+			i += length;
+			return true;
+		}
+
+		// Parsing.
+
+		inline const Token& Current() const
+		{
+			return m_tokens[m_position];
+		}
+		inline const Token& Peek(size_t offset = 1) const
+		{
+			return m_tokens[std::min(m_position + offset,
+			                         m_tokens.size() - 1)];
+		}
+		inline bool Check(Kind kind) const
+		{
+			return Current().kind == kind;
+		}
+		inline void Next()
+		{
+			if (m_position + 1 < m_tokens.size())
+			{
+				++m_position;
+			}
+		}
+		inline bool Accept(Kind kind)
+		{
+			if (!Check(kind))
+			{
+				return false;
+			}
+			Next();
+			return true;
+		}
+		bool Expect(Kind kind, std::string_view what)
+		{
+			if (!Accept(kind))
+			{
+				return Fail(fmt::format("'{}' expected", what));
+			}
+			return true;
+		}
+		bool ExpectName(std::string_view& name)
+		{
+			if (!Check(Kind::Name))
+			{
+				return Fail("Name expected");
+			}
+			name = Current().text;
+			Next();
+			return true;
+		}
+
+		bool Fail(uint32_t line, std::string_view message)
+		{
+			if (m_error.empty())
+			{
+				m_error = fmt::format("{}:{}: {}", m_name, line,
+				                      message);
+			}
+			return false;
+		}
+		bool Fail(std::string_view message)
+		{
+			return Fail(Current().line, message);
+		}
+
+		bool IsBlockEnd() const
+		{
+			switch (Current().kind)
+			{
+			case Kind::End:
+			case Kind::KeywordEnd:
+			case Kind::Else:
+			case Kind::Elseif:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		bool Block()
+		{
+			const auto scope = m_function->locals.size();
+			while (!IsBlockEnd())
+			{
+				if (!Statement())
+				{
+					return false;
+				}
+			}
+			m_function->locals.resize(scope);
+			return true;
+		}
+
+		bool Statement()
+		{
+			switch (Current().kind)
+			{
+			case Kind::Semicolon:
+				Next();
+				return true;
+			case Kind::If:
+				return IfStatement();
+			case Kind::While:
+				return WhileStatement();
+			case Kind::For:
+				return ForStatement();
+			case Kind::Do:
+				Next();
+				return Block() && Expect(Kind::KeywordEnd, "end");
+			case Kind::Function:
+				return FunctionStatement();
+			case Kind::Local:
+				Next();
+				return Accept(Kind::Function) ? LocalFunction()
+				                              : LocalStatement();
+			case Kind::Return:
+				return ReturnStatement();
+			case Kind::Break:
+				return BreakStatement();
+			default:
+				return ExpressionStatement();
+			}
+		}
+
+		bool IfStatement()
+		{
+			std::vector<uint32_t> exits;
+			do
+			{
+				// if or elseif.
+				Next();
+				if (!Expression() || !Expect(Kind::Then, "then"))
+				{
+					return false;
+				}
+				const auto skip = Emit(Op::JumpIfFalse);
+				if (!Block())
+				{
+					return false;
+				}
+				if (Check(Kind::Elseif) || Check(Kind::Else))
+				{
+					exits.push_back(Emit(Op::Jump));
+				}
+				Patch(skip);
+			} while (Check(Kind::Elseif));
+
+			if (Accept(Kind::Else) && !Block())
+			{
+				return false;
+			}
+			for (const auto exit : exits)
+			{
+				Patch(exit);
+			}
+			return Expect(Kind::KeywordEnd, "end");
+		}
+
+		bool WhileStatement()
+		{
+			Next();
+			const auto start = GetPc();
+			if (!Expression() || !Expect(Kind::Do, "do"))
+			{
+				return false;
+			}
+			const auto exit = Emit(Op::JumpIfFalse);
+			m_function->loops.emplace_back();
+			if (!Block() || !Expect(Kind::KeywordEnd, "end"))
+			{
+				return false;
+			}
+			Emit(Op::Jump, start);
+			Patch(exit);
+			return FinishLoop();
+		}
+
+		bool ForStatement()
+		{
+			Next();
+			std::string_view name;
+			if (!ExpectName(name))
+			{
+				return false;
+			}
+			const auto scope = m_function->locals.size();
+			const auto first = static_cast<uint32_t>(scope);
+
+			uint32_t exit = 0;
+			uint32_t start = 0;
+			Op step;
+			if (Accept(Kind::Assign))
+			{
+				// Index, limit and step, then the variable.
+				if (!Expression() || !Expect(Kind::Comma, ",")
+				    || !Expression())
+				{
+					return false;
+				}
+				if (Accept(Kind::Comma))
+				{
+					if (!Expression())
+					{
+						return false;
+					}
+				}
+				else
+				{
+					Emit(Op::Number, AddNumber(1.0));
+				}
+				if (!DeclareLocal({}) || !DeclareLocal({})
+				    || !DeclareLocal({}) || !DeclareLocal(name))
+				{
+					return false;
+				}
+				Emit(Op::SetLocal, first + 2);
+				Emit(Op::SetLocal, first + 1);
+				Emit(Op::SetLocal, first);
+				Emit(Op::ForPrepare, first);
+				start = GetPc();
+				Emit(Op::ForCheck, first);
+				step = Op::ForStep;
+			}
+			else
+			{
+				// The table and the key reached, hidden, then
+				// k and v.
+				std::string_view value;
+				if (Accept(Kind::Comma) && !ExpectName(value))
+				{
+					return false;
+				}
+				if (!Expect(Kind::In, "in"))
+				{
+					return false;
+				}
+				if (!Check(Kind::Name)
+				    || Current().text != "pairs")
+				{
+					return Fail("Only pairs() can be iterated");
+				}
+				Next();
+				if (!Expect(Kind::LeftParen, "(")
+				    || !Expression()
+				    || !Expect(Kind::RightParen, ")"))
+				{
+					return false;
+				}
+				if (!DeclareLocal({}) || !DeclareLocal({})
+				    || !DeclareLocal(name)
+				    || !DeclareLocal(value))
+				{
+					return false;
+				}
+				Emit(Op::SetLocal, first);
+				Emit(Op::Nil);
+				Emit(Op::SetLocal, first + 1);
+				start = GetPc();
+				Emit(Op::Next, first);
+				step = Op::Jump;
+			}
+
+			exit = Emit(Op::JumpIfFalse);
+			m_function->loops.emplace_back();
+			if (!Expect(Kind::Do, "do") || !Block()
+			    || !Expect(Kind::KeywordEnd, "end"))
+			{
+				return false;
+			}
+			if (step == Op::ForStep)
+			{
+				Emit(Op::ForStep, first);
+			}
+			Emit(Op::Jump, start);
+			Patch(exit);
+			m_function->locals.resize(scope);
+			return FinishLoop();
+		}
+
+		bool FinishLoop()
+		{
+			const auto& loop = m_function->loops.back();
+			for (const auto jump : loop.breaks)
+			{
+				Patch(jump);
+			}
+			m_function->loops.pop_back();
+			return true;
+		}
+
+		bool FunctionStatement()
+		{
+			Next();
+			const auto line = Current().line;
+			std::string_view part;
+			if (!ExpectName(part))
+			{
+				return false;
+			}
+			std::string name(part);
+			Expr target;
+			if (!Resolve(part, line, target))
+			{
+				return false;
+			}
+			while (Accept(Kind::Dot))
+			{
+				if (!Discharge(target) || !ExpectName(part))
+				{
+					return false;
+				}
+				Emit(Op::String, AddString(part));
+				target = {Expr::Kind::Indexed};
+				name += '.';
+				name += part;
+			}
+			if (Check(Kind::Colon))
+			{
+				return Fail("Methods are not supported");
+			}
+			return Body(name) && Store(target);
+		}
+
+		bool LocalFunction()
+		{
+			std::string_view name;
+			if (!ExpectName(name))
+			{
+				return false;
+			}
+			const auto slot =
+			    static_cast<uint32_t>(m_function->locals.size());
+			if (!DeclareLocal(name) || !Body(name))
+			{
+				return false;
+			}
+			Emit(Op::SetLocal, slot);
+			return true;
+		}
+
+		bool LocalStatement()
+		{
+			std::vector<std::string_view> names;
+			do
+			{
+				if (!ExpectName(names.emplace_back()))
+				{
+					return false;
+				}
+			} while (Accept(Kind::Comma));
+
+			size_t values = 0;
+			if (Accept(Kind::Assign))
+			{
+				do
+				{
+					if (!Expression())
+					{
+						return false;
+					}
+					++values;
+				} while (Accept(Kind::Comma));
+			}
+			if (values > names.size())
+			{
+				return Fail("More values than names");
+			}
+			for (; values < names.size(); ++values)
+			{
+				Emit(Op::Nil);
+			}
+
+			// Declared once the values are computed, so
+			// they see the names they may shadow.
+			const auto first =
+			    static_cast<uint32_t>(m_function->locals.size());
+			for (const auto name : names)
+			{
+				if (!DeclareLocal(name))
+				{
+					return false;
+				}
+			}
+			for (auto i = static_cast<uint32_t>(names.size());
+			     i-- > 0;)
+			{
+				Emit(Op::SetLocal, first + i);
+			}
+			return true;
+		}
+
+		bool ReturnStatement()
+		{
+			Next();
+			if (IsBlockEnd() || Check(Kind::Semicolon))
+			{
+				Emit(Op::Nil);
+			}
+			else if (!Expression())
+			{
+				return false;
+			}
+			Emit(Op::Return);
+			return true;
+		}
+
+		bool BreakStatement()
+		{
+			Next();
+			if (m_function->loops.empty())
+			{
+				return Fail("break outside a loop");
+			}
+			const auto jump = Emit(Op::Jump);
+			m_function->loops.back().breaks.push_back(jump);
+			return true;
+		}
+
+		bool ExpressionStatement()
+		{
+			Expr expr;
+			if (!Suffixed(expr))
+			{
+				return false;
+			}
+			if (Check(Kind::Comma))
+			{
+				return Fail("Multiple assignment is not "
+				            "supported");
+			}
+			if (Accept(Kind::Assign))
+			{
+				if (expr.kind == Expr::Kind::Pushed)
+				{
+					return Fail("Cannot assign to this");
+				}
+				return Expression() && Store(expr);
+			}
+			if (!expr.call)
+			{
+				return Fail("Syntax error");
+			}
+			Emit(Op::Pop);
+			return true;
+		}
+
+		// Parameters and block of a function, emitted into a
+		// function of its own; pushes it.
+		bool Body(std::string_view name)
+		{
+			FunctionState function;
+			function.parent = m_function;
+			function.index = AddFunction();
+			m_function = &function;
+
+			if (!Expect(Kind::LeftParen, "("))
+			{
+				return false;
+			}
+			if (!Check(Kind::RightParen))
+			{
+				do
+				{
+					std::string_view parameter;
+					if (Check(Kind::Dot))
+					{
+						return Fail("Varargs are not supported");
+					}
+					if (!ExpectName(parameter)
+					    || !DeclareLocal(parameter))
+					{
+						return false;
+					}
+					++function.parameters;
+				} while (Accept(Kind::Comma));
+			}
+			if (!Expect(Kind::RightParen, ")") || !Block()
+			    || !Expect(Kind::KeywordEnd, "end"))
+			{
+				return false;
+			}
+			FinishFunction(function, AddString(name));
+
+			m_function = function.parent;
+			Emit(Op::Function, function.index);
+			return true;
+		}
+
+		// Expressions.
+
+		bool Expression() { return SubExpression(0); }
+
+		bool SubExpression(int limit)
+		{
+			if (Check(Kind::Not) || Check(Kind::Minus)
+			    || Check(Kind::Hash))
+			{
+				const auto op = Check(Kind::Not)     ? Op::Not
+				                : Check(Kind::Minus) ? Op::Negate
+				                                     : Op::Length;
+				Next();
+				if (!SubExpression(UnaryPriority))
+				{
+					return false;
+				}
+				Emit(op);
+			}
+			else if (!Simple())
+			{
+				return false;
+			}
+
+			Binary binary;
+			while (GetBinary(Current().kind, binary)
+			       && binary.priority > limit)
+			{
+				Next();
+				if (binary.op == Op::JumpIfFalseKeep
+				    || binary.op == Op::JumpIfTrueKeep)
+				{
+					const auto jump = Emit(binary.op);
+					if (!SubExpression(binary.priority))
+					{
+						return false;
+					}
+					Patch(jump);
+				}
+				else
+				{
+					if (!SubExpression(binary.priority))
+					{
+						return false;
+					}
+					Emit(binary.op);
+				}
+			}
+			return true;
+		}
+
+		bool Simple()
+		{
+			const auto& token = Current();
+			switch (token.kind)
+			{
+			case Kind::Number:
+				Emit(Op::Number, AddNumber(token.number));
+				Next();
+				return true;
+			case Kind::String:
+				Emit(Op::String, AddString(token.text));
+				Next();
+				return true;
+			case Kind::Nil:
+				Emit(Op::Nil);
+				Next();
+				return true;
+			case Kind::True:
+				Emit(Op::True);
+				Next();
+				return true;
+			case Kind::False:
+				Emit(Op::False);
+				Next();
+				return true;
+			case Kind::Function:
+				Next();
+				return Body("anonymous");
+			case Kind::LeftBrace:
+				return Constructor();
+			default:
+			{
+				Expr expr;
+				return Suffixed(expr) && Discharge(expr);
+			}
+			}
+		}
+
+		bool Constructor()
+		{
+			Next();
+			Emit(Op::NewTable);
+			uint32_t index = 1;
+			while (!Check(Kind::RightBrace))
+			{
+				if (Accept(Kind::LeftBracket))
+				{
+					if (!Expression()
+					    || !Expect(Kind::RightBracket, "]")
+					    || !Expect(Kind::Assign, "=")
+					    || !Expression())
+					{
+						return false;
+					}
+					Emit(Op::InitIndex);
+				}
+				else if (Check(Kind::Name)
+				         && Peek().kind == Kind::Assign)
+				{
+					Emit(Op::String, AddString(Current().text));
+					Next();
+					Next();
+					if (!Expression())
+					{
+						return false;
+					}
+					Emit(Op::InitIndex);
+				}
+				else
+				{
+					if (!Expression())
+					{
+						return false;
+					}
+					Emit(Op::InitArray, index++);
+				}
+				if (!Accept(Kind::Comma)
+				    && !Accept(Kind::Semicolon))
+				{
+					break;
+				}
+			}
+			return Expect(Kind::RightBrace, "}");
+		}
+
+		bool Suffixed(Expr& expr)
+		{
+			const auto line = Current().line;
+			if (Accept(Kind::LeftParen))
+			{
+				if (!Expression()
+				    || !Expect(Kind::RightParen, ")"))
+				{
+					return false;
+				}
+				expr = {};
+			}
+			else if (Check(Kind::Name))
+			{
+				const std::string_view name = Current().text;
+				Next();
+				if (!Resolve(name, line, expr))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				return Fail("Unexpected symbol");
+			}
+
+			while (true)
+			{
+				if (Accept(Kind::Dot))
+				{
+					std::string_view field;
+					if (!Discharge(expr) || !ExpectName(field))
+					{
+						return false;
+					}
+					Emit(Op::String, AddString(field));
+					expr = {Expr::Kind::Indexed};
+				}
+				else if (Accept(Kind::LeftBracket))
+				{
+					if (!Discharge(expr) || !Expression()
+					    || !Expect(Kind::RightBracket, "]"))
+					{
+						return false;
+					}
+					expr = {Expr::Kind::Indexed};
+				}
+				else if (Check(Kind::LeftParen))
+				{
+					if (!Call(expr))
+					{
+						return false;
+					}
+				}
+				else if (Check(Kind::Colon))
+				{
+					return Fail("Methods are not supported");
+				}
+				else
+				{
+					break;
+				}
+			}
+			if (expr.kind == Expr::Kind::Native)
+			{
+				return Fail(fmt::format(
+				    "Native '{}' can only be called",
+				    m_bindings.GetNative(expr.index).name));
+			}
+			return true;
+		}
+
+		bool Call(Expr& expr)
+		{
+			const auto native = expr.kind == Expr::Kind::Native;
+			if (!native && !Discharge(expr))
+			{
+				return false;
+			}
+			Next();
+			uint32_t count = 0;
+			if (!Check(Kind::RightParen))
+			{
+				do
+				{
+					if (!Expression())
+					{
+						return false;
+					}
+					++count;
+				} while (Accept(Kind::Comma));
+			}
+			if (!Expect(Kind::RightParen, ")"))
+			{
+				return false;
+			}
+			if (count > 0xff)
+			{
+				return Fail("Too many arguments");
+			}
+			if (native)
+			{
+				Emit(Op::CallNative, expr.index << 8 | count);
+			}
+			else
+			{
+				Emit(Op::Call, count);
+			}
+			expr = {};
+			expr.call = true;
+			return true;
+		}
+
+		// A name to a local, a binding or a global; a
+		// namespace of the bindings takes the dotted name
+		// that follows it.
+		bool Resolve(std::string_view name, uint32_t line,
+		             Expr& expr)
+		{
+			const auto& locals = m_function->locals;
+			for (auto i = locals.size(); i-- > 0;)
+			{
+				if (locals[i].name == name)
+				{
+					expr = {Expr::Kind::Local,
+					        static_cast<uint32_t>(i)};
+					return true;
+				}
+			}
+			for (auto* outer = m_function->parent; outer;
+			     outer = outer->parent)
+			{
+				for (const auto& local : outer->locals)
+				{
+					if (local.name == name)
+					{
+						const auto message = fmt::format(
+						    "Cannot use local '{}' of an "
+						    "enclosing function",
+						    name);
+						return Fail(line, message);
+					}
+				}
+			}
+
+			std::string full(name);
+			while (m_bindings.IsNamespace(full))
+			{
+				if (!Check(Kind::Dot)
+				    || Peek().kind != Kind::Name)
+				{
+					return Fail(
+					    line, fmt::format("'{}' is a namespace",
+					                      full));
+				}
+				full += '.';
+				full += Peek().text;
+				Next();
+				Next();
+			}
+			double constant = 0.0;
+			if (const auto native = m_bindings.FindNative(full);
+			    native != Bindings::NotFound)
+			{
+				expr = {Expr::Kind::Native, native};
+				return true;
+			}
+			if (m_bindings.FindConstant(full, constant))
+			{
+				Emit(Op::Number, AddNumber(constant));
+				expr = {};
+				return true;
+			}
+			if (full != name)
+			{
+				return Fail(line, fmt::format("Unknown binding "
+				                              "'{}'",
+				                              full));
+			}
+
+			const auto id = Core::MakeStringId(name);
+			const auto [it, inserted] =
+			    m_program.m_globals.try_emplace(
+			        id, m_program.GetGlobalCount());
+			if (inserted)
+			{
+				m_program.m_globalNames.push_back(
+				    AddString(name));
+			}
+			expr = {Expr::Kind::Global, it->second};
+			return true;
+		}
+
+		// Pushes the expression's value.
+		bool Discharge(const Expr& expr)
+		{
+			switch (expr.kind)
+			{
+			case Expr::Kind::Pushed:
+				return true;
+			case Expr::Kind::Local:
+				Emit(Op::GetLocal, expr.index);
+				return true;
+			case Expr::Kind::Global:
+				Emit(Op::GetGlobal, expr.index);
+				return true;
+			case Expr::Kind::Indexed:
+				Emit(Op::GetIndex);
+				return true;
+			case Expr::Kind::Native:
+				break;
+			}
+			return Fail("Natives can only be called");
+		}
+
+		// Assigns the value pushed last.
+		bool Store(const Expr& expr)
+		{
+			switch (expr.kind)
+			{
+			case Expr::Kind::Local:
+				Emit(Op::SetLocal, expr.index);
+				return true;
+			case Expr::Kind::Global:
+				Emit(Op::SetGlobal, expr.index);
+				return true;
+			case Expr::Kind::Indexed:
+				Emit(Op::SetIndex);
+				return true;
+			default:
+				return Fail("Cannot assign to this");
+			}
+		}
+
+		// Emitting.
+
+		bool DeclareLocal(std::string_view name)
+		{
+			auto& function = *m_function;
+			if (function.locals.size() >= 250)
+			{
+				return Fail("Too many locals");
+			}
+			function.locals.push_back({name});
+			function.maxSlots = std::max(
+			    function.maxSlots,
+			    static_cast<uint32_t>(function.locals.size()));
+			return true;
+		}
+
+		inline uint32_t GetPc() const
+		{
+			return static_cast<uint32_t>(m_function->code.size());
+		}
+
+		// Returns where, for Patch().
+		uint32_t Emit(Op op, uint32_t operand = 0)
+		{
+			auto& function = *m_function;
+			if (operand > Program::MaxOperand)
+			{
+				Fail("Script too large");
+				operand = 0;
+			}
+			const auto pc = GetPc();
+			function.code.push_back(static_cast<uint32_t>(op)
+			                        | operand << 8);
+			function.lines.push_back(
+			    m_tokens[m_position > 0 ? m_position - 1 : 0]
+			        .line);
+			function.depth += GetStackEffect(op, operand);
+			function.maxDepth =
+			    std::max(function.maxDepth, function.depth);
+			return pc;
+		}
+
+		// Points a jump at the next instruction.
+		void Patch(uint32_t jump)
+		{
+			auto& word = m_function->code[jump];
+			word = (word & 0xff) | GetPc() << 8;
+		}
+
+		uint32_t AddFunction()
+		{
+			m_program.m_functions.emplace_back();
+			return m_program.GetFunctionCount() - 1;
+		}
+
+		void FinishFunction(FunctionState& function,
+		                    uint32_t name)
+		{
+			auto* current = m_function;
+			m_function = &function;
+			Emit(Op::Nil);
+			Emit(Op::Return);
+			m_function = current;
+
+			auto& info = m_program.m_functions[function.index];
+			info.entry =
+			    static_cast<uint32_t>(m_program.m_code.size());
+			info.parameters = function.parameters;
+			info.slots = function.maxSlots;
+			info.stack =
+			    static_cast<uint32_t>(function.maxDepth) + 1;
+			info.name = name;
+			m_program.m_code.insert(m_program.m_code.end(),
+			                        function.code.begin(),
+			                        function.code.end());
+			m_program.m_lines.insert(m_program.m_lines.end(),
+			                         function.lines.begin(),
+			                         function.lines.end());
+		}
+
+		uint32_t AddNumber(double number)
+		{
+			const auto bits = std::bit_cast<uint64_t>(number);
+			const auto count =
+			    static_cast<uint32_t>(m_program.m_numbers.size());
+			const auto [it, inserted] =
+			    m_numbers.try_emplace(bits, count);
+			if (inserted)
+			{
+				m_program.m_numbers.push_back(number);
+			}
+			return it->second;
+		}
+
+		uint32_t AddString(std::string_view string)
+		{
+			const auto [it, inserted] =
+			    m_program.m_stringIndices.try_emplace(
+			        Core::MakeStringId(string),
+			        static_cast<uint32_t>(
+			            m_program.m_strings.size()));
+			if (inserted)
+			{
+				m_program.m_strings.emplace_back(string);
+			}
+			return it->second;
+		}
+
+	  private:
+		std::string_view m_source;
+		std::string_view m_name;
+		const Bindings& m_bindings;
+		Program& m_program;
+		std::string m_error;
+
+		std::vector<Token> m_tokens;
+		size_t m_position = 0;
+		FunctionState* m_function = nullptr;
+		Core::FlatHashMap<uint64_t, uint32_t> m_numbers;
+	};
+
+	bool Program::Compile(std::string_view source,
+	                      std::string_view name,
+	                      const Bindings& bindings,
+	                      Program& program, std::string& error)
+	{
+		VEGAM_PROFILE_SCOPE("Script::Compile");
+		Compiler compiler(source, name, bindings, program);
+		return compiler.Run(error);
+	}
+
+	uint32_t Program::FindGlobal(std::string_view name) const
+	{
+		const auto it = m_globals.find(Core::MakeStringId(name));
+		return it != m_globals.end() ? it->second : NotFound;
+	}
+
+	uint32_t Program::FindString(std::string_view string) const
+	{
+		const auto it =
+		    m_stringIndices.find(Core::MakeStringId(string));
+		return it != m_stringIndices.end() ? it->second
+		                                   : NotFound;
+	}
+} // namespace AthiVegam::Script
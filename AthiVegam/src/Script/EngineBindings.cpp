@@ -0,0 +1,211 @@
+#include "AthiVegam/Script/EngineBindings.h"
+
+#include "AthiVegam/Graphics/DebugDraw.h"
+#include "AthiVegam/Input/Keyboard.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace AthiVegam::Script
+{
+	namespace
+	{
+		using Input::KeyCode;
+
+		struct KeyName
+		{
+			const char* name;
+			KeyCode key;
+		};
+
+		constexpr KeyName Keys[] = {
+		    {"Key.Space", KeyCode::AV_KEY_SPACE},
+		    {"Key.Return", KeyCode::AV_KEY_RETURN},
+		    {"Key.Escape", KeyCode::AV_KEY_ESCAPE},
+		    {"Key.Tab", KeyCode::AV_KEY_TAB},
+		    {"Key.Backspace", KeyCode::AV_KEY_BACKSPACE},
+		    {"Key.Left", KeyCode::AV_KEY_LEFT},
+		    {"Key.Right", KeyCode::AV_KEY_RIGHT},
+		    {"Key.Up", KeyCode::AV_KEY_UP},
+		    {"Key.Down", KeyCode::AV_KEY_DOWN},
+		    {"Key.LeftShift", KeyCode::AV_KEY_LSHIFT},
+		    {"Key.LeftCtrl", KeyCode::AV_KEY_LCTRL},
+		    {"Key.LeftAlt", KeyCode::AV_KEY_LALT},
+		};
+
+		// args has between min and max numbers, else the
+		// call fails.
+		bool CheckNumbers(State& state,
+		                  std::span<const Value> args, size_t min,
+		                  size_t max)
+		{
+			if (args.size() < min || args.size() > max
+			    || !std::all_of(args.begin(), args.end(),
+			                    [](const Value& value) {
+				                    return value.IsNumber();
+			                    }))
+			{
+				state.Error("Expected numbers");
+				return false;
+			}
+			return true;
+		}
+
+		inline float GetFloat(const Value& value)
+		{
+			return static_cast<float>(value.number);
+		}
+
+		bool GetKey(State& state, std::span<const Value> args,
+		            KeyCode& key)
+		{
+			if (!CheckNumbers(state, args, 1, 1)
+			    || args[0].number < 0.0
+			    || args[0].number >= Input::KeyCount)
+			{
+				state.Error("Expected a key");
+				return false;
+			}
+			key = static_cast<KeyCode>(args[0].number);
+			return true;
+		}
+
+		template <bool (*Test)(KeyCode)>
+		Value KeyNative(State& state, std::span<const Value> args,
+		                void*)
+		{
+			KeyCode key;
+			return GetKey(state, args, key)
+			           ? Value::FromBoolean(Test(key))
+			           : Value{};
+		}
+
+		// An optional r, g, b after count numbers.
+		Graphics::DebugDraw::Color
+		GetColor(std::span<const Value> args, size_t count)
+		{
+			if (args.size() < count + 3)
+			{
+				return Graphics::DebugDraw::White;
+			}
+			return {GetFloat(args[count]),
+			        GetFloat(args[count + 1]),
+			        GetFloat(args[count + 2]), 1.0f};
+		}
+
+		Value Line(State& state, std::span<const Value> args,
+		           void*)
+		{
+			if (CheckNumbers(state, args, 6, 9))
+			{
+				Graphics::DebugDraw::Line(
+				    {GetFloat(args[0]), GetFloat(args[1]),
+				     GetFloat(args[2])},
+				    {GetFloat(args[3]), GetFloat(args[4]),
+				     GetFloat(args[5])},
+				    GetColor(args, 6));
+			}
+			return {};
+		}
+
+		Value Sphere(State& state, std::span<const Value> args,
+		             void*)
+		{
+			if (CheckNumbers(state, args, 4, 7))
+			{
+				Graphics::DebugDraw::Sphere(
+				    {GetFloat(args[0]), GetFloat(args[1]),
+				     GetFloat(args[2])},
+				    GetFloat(args[3]), GetColor(args, 4));
+			}
+			return {};
+		}
+
+		inline double Sqrt(double x) { return std::sqrt(x); }
+		inline double Abs(double x) { return std::abs(x); }
+		inline double Floor(double x) { return std::floor(x); }
+		inline double Ceil(double x) { return std::ceil(x); }
+		inline double Sin(double x) { return std::sin(x); }
+		inline double Cos(double x) { return std::cos(x); }
+		inline double Min(double a, double b)
+		{
+			return std::min(a, b);
+		}
+		inline double Max(double a, double b)
+		{
+			return std::max(a, b);
+		}
+
+		template <double (*Function)(double)>
+		Value Unary(State& state, std::span<const Value> args,
+		            void*)
+		{
+			if (!CheckNumbers(state, args, 1, 1))
+			{
+				return {};
+			}
+			return Value::FromNumber(Function(args[0].number));
+		}
+
+		template <double (*Function)(double, double)>
+		Value Binary(State& state, std::span<const Value> args,
+		             void*)
+		{
+			return CheckNumbers(state, args, 2, 2)
+			           ? Value::FromNumber(Function(
+			                 args[0].number, args[1].number))
+			           : Value{};
+		}
+	} // namespace
+
+	void AddEngineBindings(Bindings& bindings)
+	{
+		bindings.Add("Input.Key",
+		             KeyNative<Input::Keyboard::Key>);
+		bindings.Add("Input.KeyDown",
+		             KeyNative<Input::Keyboard::KeyDown>);
+		bindings.Add("Input.KeyUp",
+		             KeyNative<Input::Keyboard::KeyUp>);
+
+		std::string name = "Key.";
+		for (int i = 0; i < 26; ++i)
+		{
+			name.resize(4);
+			name += static_cast<char>('A' + i);
+			bindings.AddConstant(
+			    name, static_cast<int>(KeyCode::AV_KEY_A) + i);
+		}
+		// SDL orders the digits 1 to 9, then 0.
+		for (int i = 0; i < 10; ++i)
+		{
+			name = "Key.Num";
+			name += static_cast<char>('0' + (i + 1) % 10);
+			bindings.AddConstant(
+			    name, static_cast<int>(KeyCode::AV_KEY_1) + i);
+		}
+		for (int i = 0; i < 12; ++i)
+		{
+			name = "Key.F" + std::to_string(i + 1);
+			bindings.AddConstant(
+			    name, static_cast<int>(KeyCode::AV_KEY_F1) + i);
+		}
+		for (const auto& key : Keys)
+		{
+			bindings.AddConstant(key.name,
+			                     static_cast<int>(key.key));
+		}
+
+		bindings.Add("Debug.Line", Line);
+		bindings.Add("Debug.Sphere", Sphere);
+
+		bindings.Add("Math.Sqrt", Unary<Sqrt>);
+		bindings.Add("Math.Abs", Unary<Abs>);
+		bindings.Add("Math.Floor", Unary<Floor>);
+		bindings.Add("Math.Ceil", Unary<Ceil>);
+		bindings.Add("Math.Sin", Unary<Sin>);
+		bindings.Add("Math.Cos", Unary<Cos>);
+		bindings.Add("Math.Min", Binary<Min>);
+		bindings.Add("Math.Max", Binary<Max>);
+	}
+} // namespace AthiVegam::Script
@@ -0,0 +1,929 @@
+#include "AthiVegam/Script/State.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+
+namespace AthiVegam::Script
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+		using Op = Program::Op;
+
+		// Units of collector work between looks at the
+		// clock: tables swept, or globals and entries
+		// marked.
+		constexpr uint32_t WorkPerCheck = 64;
+
+		inline double Milliseconds(Clock::time_point start)
+		{
+			return std::chrono::duration<double, std::milli>(
+			           Clock::now() - start)
+			    .count();
+		}
+
+		inline Value MakeValue(Type type, uint32_t index)
+		{
+			Value value;
+			value.type = type;
+			value.index = index;
+			return value;
+		}
+	} // namespace
+
+	const char* GetTypeName(Type type)
+	{
+		switch (type)
+		{
+		case Type::Nil:
+			return "nil";
+		case Type::Boolean:
+			return "boolean";
+		case Type::Number:
+			return "number";
+		case Type::String:
+			return "string";
+		case Type::Table:
+			return "table";
+		case Type::Function:
+			return "function";
+		case Type::Entity:
+			return "entity";
+		}
+		return "unknown";
+	}
+
+	State::State() : State(Settings{}) {}
+
+	State::State(const Settings& settings)
+	    : m_settings(settings), m_stack(settings.stackSize),
+	      m_frames(settings.maxCalls)
+	{
+	}
+
+	State::~State() { Reset(); }
+
+	void State::Reset()
+	{
+		VEGAM_ASSERT(m_frameCount == 0,
+		             "Script states cannot change during a call");
+		for (auto* list : {m_objects, m_newObjects})
+		{
+			while (list)
+			{
+				auto* next = list->next;
+				m_tables.Destroy(list);
+				list = next;
+			}
+		}
+		m_objects = nullptr;
+		m_newObjects = nullptr;
+		m_newTail = nullptr;
+		m_newCount = 0;
+		m_sweep = nullptr;
+		m_gray.clear();
+		m_phase = Phase::Idle;
+		m_live = 0;
+		m_stats.tables = 0;
+		m_globals.clear();
+		m_top = 0;
+	}
+
+	bool State::Load(std::shared_ptr<const Program> program)
+	{
+		VEGAM_PROFILE_SCOPE("Script::State::Load");
+		VEGAM_ASSERT(program && program->GetFunctionCount() > 0,
+		             "Scripts must be compiled before loading");
+		Reset();
+		m_program = std::move(program);
+		m_code = m_program->GetCode().data();
+		m_globals.assign(m_program->GetGlobalCount(), Value{});
+		m_threshold = m_settings.gcMinTables;
+		return Call(MakeValue(Type::Function, 0));
+	}
+
+	bool State::Call(std::string_view function,
+	                 std::span<const Value> args, Value* result)
+	{
+		VEGAM_ASSERT(m_program, "No script loaded");
+		const auto slot = m_program->FindGlobal(function);
+		if (slot == Program::NotFound
+		    || m_globals[slot].type != Type::Function)
+		{
+			m_error = fmt::format("{}: no function '{}'",
+			                      m_program->GetName(), function);
+			VEGAM_ERROR("{}", m_error);
+			return false;
+		}
+		return Call(m_globals[slot], args, result);
+	}
+
+	bool State::Call(const Value& function,
+	                 std::span<const Value> args, Value* result)
+	{
+		VEGAM_PROFILE_SCOPE("Script::State::Call");
+		VEGAM_ASSERT(m_program, "No script loaded");
+		VEGAM_ASSERT(m_frameCount == 0,
+		             "Script calls cannot nest");
+		const auto start = Clock::now();
+		++m_stats.calls;
+		m_failed = false;
+		m_steps = 0;
+
+		auto ok = false;
+		if (args.size() + 1 > m_stack.size())
+		{
+			Fail("Too many arguments");
+		}
+		else
+		{
+			m_stack[0] = function;
+			std::copy(args.begin(), args.end(),
+			          m_stack.begin() + 1);
+			m_top = static_cast<uint32_t>(args.size()) + 1;
+			ok = Enter(static_cast<uint32_t>(args.size()))
+			     && Execute();
+		}
+		if (ok && result)
+		{
+			*result = m_stack[m_top - 1];
+		}
+		m_top = 0;
+		m_frameCount = 0;
+		m_stats.callMs += Milliseconds(start);
+		if (!ok)
+		{
+			VEGAM_ERROR("{}", m_error);
+		}
+		return ok;
+	}
+
+	Value State::GetGlobal(std::string_view name) const
+	{
+		const auto slot = m_program->FindGlobal(name);
+		return slot != Program::NotFound ? m_globals[slot]
+		                                 : Value{};
+	}
+
+	bool State::SetGlobal(std::string_view name,
+	                      const Value& value)
+	{
+		const auto slot = m_program->FindGlobal(name);
+		if (slot == Program::NotFound)
+		{
+			return false;
+		}
+		if (m_phase == Phase::Mark)
+		{
+			Shade(value);
+		}
+		m_globals[slot] = value;
+		return true;
+	}
+
+	Value State::FindString(std::string_view string) const
+	{
+		const auto index = m_program->FindString(string);
+		return index != Program::NotFound
+		           ? MakeValue(Type::String, index)
+		           : Value{};
+	}
+
+	std::string_view State::GetString(const Value& value) const
+	{
+		return value.type == Type::String
+		           ? m_program->GetString(value.index)
+		           : std::string_view{};
+	}
+
+	Value State::NewTable()
+	{
+		Value value;
+		value.type = Type::Table;
+		value.table = Allocate();
+		return value;
+	}
+
+	Value State::Get(const Value& table, const Value& key) const
+	{
+		if (table.type != Type::Table)
+		{
+			return {};
+		}
+		const auto& entries = table.table->entries;
+		const auto it = entries.find(key);
+		return it != entries.end() ? it->second : Value{};
+	}
+
+	bool State::Set(const Value& table, const Value& key,
+	                const Value& value)
+	{
+		return table.type == Type::Table
+		       && RawSet(*table.table, key, value);
+	}
+
+	void State::Error(std::string_view message)
+	{
+		Fail(message);
+	}
+
+	void State::ResetStats()
+	{
+		const auto tables = m_stats.tables;
+		m_stats = {};
+		m_stats.tables = tables;
+	}
+
+	bool State::Fail(std::string_view message)
+	{
+		m_failed = true;
+		if (m_frameCount == 0)
+		{
+			m_error = fmt::format("{}: {}", m_program->GetName(),
+			                      message);
+			return false;
+		}
+		const auto& frame = m_frames[m_frameCount - 1];
+		const auto& function =
+		    m_program->GetFunction(frame.function);
+		const auto line = m_program->GetLine(
+		    function.entry + std::max(frame.pc, 1u) - 1);
+		m_error = fmt::format("{}:{}: {}", m_program->GetName(),
+		                      line, message);
+		return false;
+	}
+
+	bool State::Enter(uint32_t count)
+	{
+		const auto& callee = m_stack[m_top - count - 1];
+		if (callee.type != Type::Function)
+		{
+			return Fail(fmt::format("Attempt to call a {} value",
+			                        GetTypeName(callee.type)));
+		}
+		if (m_settings.maxSteps > 0
+		    && ++m_steps > m_settings.maxSteps)
+		{
+			return Fail("Step limit reached");
+		}
+		const auto& function =
+		    m_program->GetFunction(callee.index);
+		const auto base = m_top - count;
+		if (m_frameCount == m_settings.maxCalls
+		    || base + function.slots + function.stack
+		           > m_stack.size())
+		{
+			return Fail("Stack overflow");
+		}
+
+		// Missing arguments and the other locals start
+		// nil; extra arguments are dropped.
+		for (auto i = std::min(count, function.parameters);
+		     i < function.slots; ++i)
+		{
+			m_stack[base + i] = {};
+		}
+		m_top = base + function.slots;
+		m_frames[m_frameCount++] = {callee.index, 0, base};
+		return true;
+	}
+
+	bool State::Execute()
+	{
+		const auto depth = m_frameCount - 1;
+		const auto& program = *m_program;
+		auto* stack = m_stack.data();
+
+		Frame* frame = nullptr;
+		const uint32_t* code = nullptr;
+		Value* locals = nullptr;
+		const auto reload = [&] {
+			frame = &m_frames[m_frameCount - 1];
+			code = m_code
+			       + program.GetFunction(frame->function).entry;
+			locals = stack + frame->base;
+		};
+		reload();
+
+		const auto typeError = [this](std::string_view what,
+		                              const Value& value) {
+			return Fail(fmt::format("Attempt to {} a {} value",
+			                        what,
+			                        GetTypeName(value.type)));
+		};
+		const auto arithmetic = [&](auto op) {
+			auto& a = stack[m_top - 2];
+			const auto& b = stack[m_top - 1];
+			if (a.type != Type::Number || b.type != Type::Number)
+			{
+				return typeError("do arithmetic on",
+				                 a.type != Type::Number ? a : b);
+			}
+			a.number = op(a.number, b.number);
+			--m_top;
+			return true;
+		};
+		const auto compare = [&](auto op) {
+			auto& a = stack[m_top - 2];
+			const auto& b = stack[m_top - 1];
+			bool result;
+			if (a.type == Type::Number && b.type == Type::Number)
+			{
+				result = op(a.number, b.number);
+			}
+			else if (a.type == Type::String
+			         && b.type == Type::String)
+			{
+				result = op(program.GetString(a.index),
+				            program.GetString(b.index));
+			}
+			else
+			{
+				return Fail(fmt::format(
+				    "Attempt to compare {} with {}",
+				    GetTypeName(a.type), GetTypeName(b.type)));
+			}
+			a = Value::FromBoolean(result);
+			--m_top;
+			return true;
+		};
+		const auto step = [this] {
+			return m_settings.maxSteps == 0
+			       || ++m_steps <= m_settings.maxSteps
+			       || Fail("Step limit reached");
+		};
+
+		while (true)
+		{
+			const auto word = code[frame->pc++];
+			const auto operand = word >> 8;
+			switch (static_cast<Op>(word & 0xff))
+			{
+			case Op::Nil:
+				stack[m_top++] = {};
+				break;
+			case Op::True:
+				stack[m_top++] = Value::FromBoolean(true);
+				break;
+			case Op::False:
+				stack[m_top++] = Value::FromBoolean(false);
+				break;
+			case Op::Number:
+				stack[m_top++] =
+				    Value::FromNumber(program.GetNumber(operand));
+				break;
+			case Op::String:
+				stack[m_top++] = MakeValue(Type::String, operand);
+				break;
+			case Op::Function:
+				stack[m_top++] =
+				    MakeValue(Type::Function, operand);
+				break;
+			case Op::Pop:
+				--m_top;
+				break;
+			case Op::GetLocal:
+				stack[m_top++] = locals[operand];
+				break;
+			case Op::SetLocal:
+				locals[operand] = stack[--m_top];
+				break;
+			case Op::GetGlobal:
+				stack[m_top++] = m_globals[operand];
+				break;
+			case Op::SetGlobal:
+			{
+				const auto& value = stack[--m_top];
+				if (m_phase == Phase::Mark)
+				{
+					Shade(value);
+				}
+				m_globals[operand] = value;
+				break;
+			}
+			case Op::NewTable:
+				stack[m_top++] = NewTable();
+				break;
+			case Op::GetIndex:
+			{
+				auto& table = stack[m_top - 2];
+				if (table.type != Type::Table)
+				{
+					return typeError("index", table);
+				}
+				const auto& entries = table.table->entries;
+				const auto it = entries.find(stack[m_top - 1]);
+				table =
+				    it != entries.end() ? it->second : Value{};
+				--m_top;
+				break;
+			}
+			case Op::SetIndex:
+			{
+				const auto& table = stack[m_top - 3];
+				if (table.type != Type::Table)
+				{
+					return typeError("index", table);
+				}
+				if (!RawSet(*table.table, stack[m_top - 2],
+				            stack[m_top - 1]))
+				{
+					return false;
+				}
+				m_top -= 3;
+				break;
+			}
+			case Op::InitIndex:
+				if (!RawSet(*stack[m_top - 3].table,
+				            stack[m_top - 2], stack[m_top - 1]))
+				{
+					return false;
+				}
+				m_top -= 2;
+				break;
+			case Op::InitArray:
+				RawSet(*stack[m_top - 2].table,
+				       Value::FromNumber(operand),
+				       stack[m_top - 1]);
+				--m_top;
+				break;
+			case Op::Add:
+				if (!arithmetic(std::plus<>()))
+				{
+					return false;
+				}
+				break;
+			case Op::Subtract:
+				if (!arithmetic(std::minus<>()))
+				{
+					return false;
+				}
+				break;
+			case Op::Multiply:
+				if (!arithmetic(std::multiplies<>()))
+				{
+					return false;
+				}
+				break;
+			case Op::Divide:
+				if (!arithmetic(std::divides<>()))
+				{
+					return false;
+				}
+				break;
+			case Op::Modulo:
+				// Floored, as in Lua.
+				if (!arithmetic([](double a, double b) {
+					    return a - std::floor(a / b) * b;
+				    }))
+				{
+					return false;
+				}
+				break;
+			case Op::Negate:
+			{
+				auto& value = stack[m_top - 1];
+				if (value.type != Type::Number)
+				{
+					return typeError("negate", value);
+				}
+				value.number = -value.number;
+				break;
+			}
+			case Op::Not:
+				stack[m_top - 1] = Value::FromBoolean(
+				    !stack[m_top - 1].IsTrue());
+				break;
+			case Op::Length:
+			{
+				auto& value = stack[m_top - 1];
+				double length = 0.0;
+				if (value.type == Type::String)
+				{
+					length = static_cast<double>(
+					    program.GetString(value.index).size());
+				}
+				else if (value.type == Type::Table)
+				{
+					// The border of the array part: keys 1 to
+					// n are set.
+					const auto& entries = value.table->entries;
+					while (true)
+					{
+						const auto it = entries.find(
+						    Value::FromNumber(length + 1.0));
+						if (it == entries.end()
+						    || it->second.IsNil())
+						{
+							break;
+						}
+						length += 1.0;
+					}
+				}
+				else
+				{
+					return typeError("get the length of", value);
+				}
+				value = Value::FromNumber(length);
+				break;
+			}
+			case Op::Equal:
+			case Op::NotEqual:
+			{
+				const auto equal = RawEqual(stack[m_top - 2],
+				                            stack[m_top - 1]);
+				stack[m_top - 2] = Value::FromBoolean(
+				    equal == (static_cast<Op>(word & 0xff)
+				              == Op::Equal));
+				--m_top;
+				break;
+			}
+			case Op::Less:
+				if (!compare(std::less<>()))
+				{
+					return false;
+				}
+				break;
+			case Op::LessEqual:
+				if (!compare(std::less_equal<>()))
+				{
+					return false;
+				}
+				break;
+			case Op::Greater:
+				if (!compare(std::greater<>()))
+				{
+					return false;
+				}
+				break;
+			case Op::GreaterEqual:
+				if (!compare(std::greater_equal<>()))
+				{
+					return false;
+				}
+				break;
+			case Op::Jump:
+				// Backwards, a loop.
+				if (operand < frame->pc && !step())
+				{
+					return false;
+				}
+				frame->pc = operand;
+				break;
+			case Op::JumpIfFalse:
+				if (!stack[--m_top].IsTrue())
+				{
+					frame->pc = operand;
+				}
+				break;
+			case Op::JumpIfFalseKeep:
+				if (!stack[m_top - 1].IsTrue())
+				{
+					frame->pc = operand;
+				}
+				else
+				{
+					--m_top;
+				}
+				break;
+			case Op::JumpIfTrueKeep:
+				if (stack[m_top - 1].IsTrue())
+				{
+					frame->pc = operand;
+				}
+				else
+				{
+					--m_top;
+				}
+				break;
+			case Op::ForPrepare:
+				for (uint32_t i = 0; i < 3; ++i)
+				{
+					if (!locals[operand + i].IsNumber())
+					{
+						return Fail("'for' needs numbers");
+					}
+				}
+				if (locals[operand + 2].number == 0.0)
+				{
+					return Fail("'for' step is zero");
+				}
+				break;
+			case Op::ForCheck:
+			{
+				const auto index = locals[operand].number;
+				const auto limit = locals[operand + 1].number;
+				const auto go = locals[operand + 2].number > 0.0
+				                    ? index <= limit
+				                    : index >= limit;
+				if (go)
+				{
+					locals[operand + 3] = locals[operand];
+				}
+				stack[m_top++] = Value::FromBoolean(go);
+				break;
+			}
+			case Op::ForStep:
+				locals[operand].number +=
+				    locals[operand + 2].number;
+				break;
+			case Op::Next:
+			{
+				const auto& table = locals[operand];
+				if (table.type != Type::Table)
+				{
+					return typeError("iterate", table);
+				}
+				auto& key = locals[operand + 1];
+				const auto& entries = table.table->entries;
+				auto it = entries.begin();
+				if (!key.IsNil())
+				{
+					it = entries.find(key);
+					if (it == entries.end())
+					{
+						return Fail("Table key removed during "
+						            "pairs()");
+					}
+					++it;
+				}
+				// Fields set to nil wait for the collector.
+				while (it != entries.end() && it->second.IsNil())
+				{
+					++it;
+				}
+				const auto found = it != entries.end();
+				if (found)
+				{
+					key = it->first;
+					locals[operand + 2] = it->first;
+					locals[operand + 3] = it->second;
+				}
+				stack[m_top++] = Value::FromBoolean(found);
+				break;
+			}
+			case Op::Call:
+				if (!Enter(operand))
+				{
+					return false;
+				}
+				reload();
+				break;
+			case Op::CallNative:
+			{
+				const auto count = operand & 0xff;
+				const auto& native =
+				    program.GetBindings().GetNative(operand >> 8);
+				const auto result = native.function(
+				    *this, {stack + m_top - count, count},
+				    native.user);
+				m_top -= count;
+				stack[m_top++] = result;
+				if (m_failed)
+				{
+					return false;
+				}
+				break;
+			}
+			case Op::Return:
+			{
+				const auto result = stack[m_top - 1];
+				m_top = frame->base - 1;
+				stack[m_top++] = result;
+				if (--m_frameCount == depth)
+				{
+					return true;
+				}
+				reload();
+				break;
+			}
+			default:
+				return Fail("Bad instruction");
+			}
+		}
+	}
+
+	Table* State::Allocate()
+	{
+		auto* table = m_tables.Create();
+		// The sweep in progress must not see tables made
+		// since it started, which are white.
+		if (m_phase == Phase::Sweep)
+		{
+			table->next = m_newObjects;
+			if (!m_newObjects)
+			{
+				m_newTail = table;
+			}
+			m_newObjects = table;
+			++m_newCount;
+		}
+		else
+		{
+			table->next = m_objects;
+			m_objects = table;
+		}
+		++m_stats.tables;
+		return table;
+	}
+
+	bool State::RawSet(Table& table, const Value& key,
+	                   const Value& value)
+	{
+		if (key.IsNil())
+		{
+			return Fail("Table index is nil");
+		}
+		if (key.type == Type::Number && std::isnan(key.number))
+		{
+			return Fail("Table index is NaN");
+		}
+		if (value.IsNil())
+		{
+			// Kept, as nil, until the collector next marks
+			// the table, so pairs() can clear the fields it
+			// has visited.
+			const auto it = table.entries.find(key);
+			if (it != table.entries.end())
+			{
+				it->second = {};
+			}
+			return true;
+		}
+		Barrier(table, key);
+		Barrier(table, value);
+		table.entries.insert_or_assign(key, value);
+		return true;
+	}
+
+	uint32_t State::Step()
+	{
+		switch (m_phase)
+		{
+		case Phase::Idle:
+			m_phase = Phase::Mark;
+			m_markedGlobals = 0;
+			return 1;
+
+		case Phase::Mark:
+		{
+			if (m_markedGlobals < m_globals.size())
+			{
+				Shade(m_globals[m_markedGlobals++]);
+				return 1;
+			}
+			if (m_gray.empty())
+			{
+				m_phase = Phase::Sweep;
+				m_sweep = &m_objects;
+				m_live = 0;
+				return 1;
+			}
+			auto* table = m_gray.back();
+			m_gray.pop_back();
+			if (table->color == Table::Color::Black)
+			{
+				return 1;
+			}
+			table->color = Table::Color::Black;
+			auto& entries = table->entries;
+			const auto work =
+			    static_cast<uint32_t>(entries.size()) + 1;
+			for (const auto& [key, value] : entries)
+			{
+				if (value.IsNil())
+				{
+					m_dead.push_back(key);
+					continue;
+				}
+				Shade(key);
+				Shade(value);
+			}
+			for (const auto& key : m_dead)
+			{
+				entries.erase(key);
+			}
+			m_dead.clear();
+			return work;
+		}
+
+		case Phase::Sweep:
+			if (auto* table = *m_sweep)
+			{
+				if (table->color == Table::Color::White)
+				{
+					*m_sweep = table->next;
+					m_tables.Destroy(table);
+					--m_stats.tables;
+					++m_stats.freed;
+				}
+				else
+				{
+					table->color = Table::Color::White;
+					m_sweep = &table->next;
+					++m_live;
+				}
+				return 1;
+			}
+			if (m_newObjects)
+			{
+				m_newTail->next = m_objects;
+				m_objects = m_newObjects;
+				m_live += m_newCount;
+				m_newObjects = nullptr;
+				m_newTail = nullptr;
+				m_newCount = 0;
+			}
+			m_sweep = nullptr;
+			m_threshold = std::max(
+			    static_cast<uint32_t>(
+			        static_cast<float>(m_live)
+			        * m_settings.gcPause),
+			    m_settings.gcMinTables);
+			m_phase = Phase::Idle;
+			return 0;
+		}
+		return 0;
+	}
+
+	void State::CollectGarbage(float budgetMs)
+	{
+		VEGAM_ASSERT(m_frameCount == 0,
+		             "Collect between calls");
+		if (m_phase == Phase::Idle
+		    && m_stats.tables < m_threshold)
+		{
+			return;
+		}
+		VEGAM_PROFILE_SCOPE("Script::State::CollectGarbage");
+		const auto start = Clock::now();
+		const auto deadline =
+		    start
+		    + std::chrono::duration_cast<Clock::duration>(
+		        std::chrono::duration<float, std::milli>(
+		            budgetMs));
+		uint32_t work = 0;
+		while (true)
+		{
+			const auto done = Step();
+			if (done == 0)
+			{
+				break;
+			}
+			work += done;
+			if (work >= WorkPerCheck)
+			{
+				work = 0;
+				if (Clock::now() >= deadline)
+				{
+					break;
+				}
+			}
+		}
+		m_stats.gcMs += Milliseconds(start);
+	}
+
+	void State::CollectAll()
+	{
+		VEGAM_ASSERT(m_frameCount == 0,
+		             "Collect between calls");
+		VEGAM_PROFILE_SCOPE("Script::State::CollectAll");
+		const auto start = Clock::now();
+		if (m_phase == Phase::Idle)
+		{
+			Step();
+		}
+		while (Step() != 0)
+		{
+		}
+		m_stats.gcMs += Milliseconds(start);
+	}
+
+	uint32_t CallEach(std::span<State* const> states,
+	                  std::string_view function,
+	                  std::span<const Value> args,
+	                  float gcBudgetMs)
+	{
+		VEGAM_PROFILE_SCOPE("Script::CallEach");
+		std::atomic<uint32_t> failed{0};
+		Engine::Instance().GetJobManager().ParallelFor(
+		    static_cast<uint32_t>(states.size()), 1,
+		    [&](uint32_t i) {
+			    auto& state = *states[i];
+			    if (!state.Call(function, args))
+			    {
+				    failed.fetch_add(1,
+				                     std::memory_order_relaxed);
+			    }
+			    state.CollectGarbage(gcBudgetMs);
+		    });
+		return failed.load(std::memory_order_relaxed);
+	}
+} // namespace AthiVegam::Script
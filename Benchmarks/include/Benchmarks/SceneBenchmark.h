@@ -0,0 +1,78 @@
+#pragma once
+
+#include "AthiVegam/App.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Graphics/Shader.h"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Benchmarks
+{
+	// Scene size and run length, from the command line:
+	// --meshes=N --shaders=M --uniforms=K --frames=F
+	// --warmup=W --output=path
+	struct SceneSettings
+	{
+		uint32_t meshes = 1000;
+		uint32_t shaders = 8;
+		// Shader::Set() calls per frame.
+		uint32_t uniforms = 1000;
+		uint32_t frames = 600;
+		// Frames run before timing starts.
+		uint32_t warmupFrames = 60;
+		std::string output = "BenchmarkResults.json";
+
+		static SceneSettings
+		Parse(const std::vector<std::string>& arguments);
+	};
+
+	// Draws a scripted scene in a hidden window for a fixed
+	// number of frames, then writes frame-time statistics,
+	// every frame time and the time per frame in each
+	// profiler zone as JSON and quits.
+	class SceneBenchmark : public AthiVegam::App
+	{
+	  public:
+		SceneBenchmark() = default;
+		virtual ~SceneBenchmark() = default;
+
+		AthiVegam::EngineConfig
+		GetEngineConfig() const override;
+		void Initialize() override;
+		void Shutdown() override;
+		void Render(float alpha) override;
+
+	  private:
+		using Clock = std::chrono::steady_clock;
+
+		void BuildScene();
+		void WriteResults() const;
+
+	  private:
+		SceneSettings m_settings;
+		std::vector<AthiVegam::Graphics::MeshHandle> m_meshes;
+		std::vector<AthiVegam::Graphics::ShaderHandle>
+		    m_shaders;
+		std::vector<AthiVegam::Graphics::UniformHandle<
+		    AthiVegam::Graphics::Float3>>
+		    m_colors;
+
+		uint32_t m_frame = 0;
+		uint32_t m_nextUniform = 0;
+		Clock::time_point m_lastFrame;
+		std::vector<double> m_frameTimes;
+		uint64_t m_drawCalls = 0;
+		uint64_t m_stateChanges = 0;
+		uint64_t m_glCalls = 0;
+		// Milliseconds in each zone, summed over the
+		// timed frames.
+		std::map<std::string, double> m_zoneTimes;
+	};
+} // namespace Benchmarks
+
+extern std::unique_ptr<AthiVegam::App> CreateApp();
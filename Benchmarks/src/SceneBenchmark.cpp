@@ -0,0 +1,335 @@
+#include "Benchmarks/SceneBenchmark.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Main.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <string_view>
+
+using namespace AthiVegam;
+
+std::unique_ptr<App> CreateApp()
+{
+	return std::make_unique<Benchmarks::SceneBenchmark>();
+}
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr const char* VertexShader = R"(
+            #version 410 core
+            layout (location = 0) in vec2 position;
+            void main()
+            {
+                gl_Position = vec4(position, 0.0, 1.0);
+            }
+        )";
+		// The variant index keeps every program distinct.
+		constexpr const char* FragmentShader = R"(
+            out vec4 outColor;
+            uniform vec3 color = vec3(1.0);
+            void main()
+            {
+                outColor = vec4(color * (1.0 - VARIANT * 0.01),
+                                1.0);
+            }
+        )";
+
+		bool ParseFlag(std::string_view argument,
+		               std::string_view name,
+		               std::string_view& value)
+		{
+			if (!argument.starts_with(name)
+			    || argument.size() <= name.size()
+			    || argument[name.size()] != '=')
+			{
+				return false;
+			}
+			value = argument.substr(name.size() + 1);
+			return true;
+		}
+
+		void ParseCount(std::string_view value,
+		                uint32_t& count)
+		{
+			const auto [end, error] = std::from_chars(
+			    value.data(), value.data() + value.size(),
+			    count);
+			if (error != std::errc())
+			{
+				VEGAM_WARN("Ignoring bad count: {}", value);
+			}
+		}
+
+		// Nearest-rank percentile of sorted samples.
+		double Percentile(const std::vector<double>& sorted,
+		                  double percent)
+		{
+			const auto rank = static_cast<size_t>(std::lround(
+			    percent / 100.0 * (sorted.size() - 1)));
+			return sorted[rank];
+		}
+	} // namespace
+
+	SceneSettings SceneSettings::Parse(
+	    const std::vector<std::string>& arguments)
+	{
+		SceneSettings settings;
+		for (const std::string_view argument : arguments)
+		{
+			std::string_view value;
+			if (ParseFlag(argument, "--meshes", value))
+			{
+				ParseCount(value, settings.meshes);
+			}
+			else if (ParseFlag(argument, "--shaders", value))
+			{
+				ParseCount(value, settings.shaders);
+			}
+			else if (ParseFlag(argument, "--uniforms", value))
+			{
+				ParseCount(value, settings.uniforms);
+			}
+			else if (ParseFlag(argument, "--frames", value))
+			{
+				ParseCount(value, settings.frames);
+			}
+			else if (ParseFlag(argument, "--warmup", value))
+			{
+				ParseCount(value, settings.warmupFrames);
+			}
+			else if (ParseFlag(argument, "--output", value))
+			{
+				settings.output = value;
+			}
+		}
+		settings.shaders = std::max(settings.shaders, 1u);
+		settings.frames = std::max(settings.frames, 1u);
+		return settings;
+	}
+
+	EngineConfig SceneBenchmark::GetEngineConfig() const
+	{
+		EngineConfig config;
+		config.window.hidden = true;
+		config.window.vsync = VSync::Off;
+		config.showPerformanceHud = false;
+		config.shaderCacheDirectory.clear();
+		return config;
+	}
+
+	void SceneBenchmark::Initialize()
+	{
+		m_settings = SceneSettings::Parse(
+		    Engine::Instance().GetArguments());
+		VEGAM_INFO("Benchmark: {} meshes, {} shaders, {} "
+		           "uniform updates, {} frames",
+		           m_settings.meshes, m_settings.shaders,
+		           m_settings.uniforms, m_settings.frames);
+
+		BuildScene();
+		m_frameTimes.reserve(m_settings.frames);
+	}
+
+	void SceneBenchmark::BuildScene()
+	{
+		auto& resources =
+		    Engine::Instance().GetResourceManager();
+
+		// Quads on a square grid covering the viewport.
+		const auto columns = static_cast<uint32_t>(
+		    std::ceil(std::sqrt(m_settings.meshes)));
+		const float cell = 2.0f / std::max(columns, 1u);
+		const float size = cell * 0.8f;
+		uint32_t elements[]{0, 1, 3, 1, 2, 3};
+		for (uint32_t i = 0; i < m_settings.meshes; ++i)
+		{
+			const float x = -1.0f + (i % columns) * cell;
+			const float y = -1.0f + (i / columns) * cell;
+			float vertices[]{x + size, y + size, x + size,
+			                 y,        x,        y,
+			                 x,        y + size};
+			m_meshes.push_back(resources.CreateMesh(
+			    vertices, 4, 2, elements, 6));
+		}
+
+		for (uint32_t i = 0; i < m_settings.shaders; ++i)
+		{
+			const auto fragment = "#version 410 core\n"
+			                      "#define VARIANT "
+			                      + std::to_string(i) + "\n"
+			                      + FragmentShader;
+			m_shaders.push_back(resources.CreateShader(
+			    std::string(VertexShader), fragment));
+			auto* shader =
+			    resources.GetShader(m_shaders.back());
+			m_colors.push_back(
+			    shader->GetUniform<Graphics::Float3>("color"));
+		}
+	}
+
+	void SceneBenchmark::Shutdown()
+	{
+		WriteResults();
+
+		auto& resources =
+		    Engine::Instance().GetResourceManager();
+		for (auto shader : m_shaders)
+		{
+			resources.DestroyShader(shader);
+		}
+		for (auto mesh : m_meshes)
+		{
+			resources.DestroyMesh(mesh);
+		}
+	}
+
+	void SceneBenchmark::Render(float alpha)
+	{
+		auto& engine = Engine::Instance();
+		auto& renderManager = engine.GetRenderManager();
+
+		// Time from one Render() to the next covers the whole
+		// frame, swap included.
+		const auto now = Clock::now();
+		if (m_frame > m_settings.warmupFrames)
+		{
+			const std::chrono::duration<double, std::milli>
+			    elapsed = now - m_lastFrame;
+			m_frameTimes.push_back(elapsed.count());
+			const auto stats = renderManager.GetFrameStats();
+			m_drawCalls += stats.drawCalls;
+			m_stateChanges += stats.stateChanges;
+			m_glCalls += stats.glCalls;
+			for (const auto& thread :
+			     Core::Profiler::GetLastFrame())
+			{
+				for (const auto& zone : thread.zones)
+				{
+					m_zoneTimes[zone.name] +=
+					    Core::Profiler::TicksToMs(zone.end
+					                              - zone.start);
+				}
+			}
+		}
+		m_lastFrame = now;
+
+		if (m_frameTimes.size() >= m_settings.frames)
+		{
+			engine.Quit();
+			return;
+		}
+		++m_frame;
+
+		auto& resources = engine.GetResourceManager();
+		const float phase = static_cast<float>(m_frame % 256)
+		                    / 255.0f;
+		for (uint32_t i = 0; i < m_settings.uniforms; ++i)
+		{
+			const auto index =
+			    m_nextUniform++ % m_shaders.size();
+			resources.GetShader(m_shaders[index])
+			    ->Set(m_colors[index],
+			          {phase, 1.0f - phase, 0.5f});
+		}
+
+		for (uint32_t i = 0; i < m_meshes.size(); ++i)
+		{
+			renderManager.Submit(
+			    Graphics::RenderCommands::RenderMesh{
+			        m_meshes[i],
+			        m_shaders[i % m_shaders.size()]});
+		}
+		renderManager.Flush();
+	}
+
+	void SceneBenchmark::WriteResults() const
+	{
+		if (m_frameTimes.empty())
+		{
+			VEGAM_WARN("Benchmark recorded no frames");
+			return;
+		}
+
+		auto sorted = m_frameTimes;
+		std::sort(sorted.begin(), sorted.end());
+		const auto count = static_cast<double>(sorted.size());
+		const auto mean =
+		    std::accumulate(sorted.begin(), sorted.end(), 0.0)
+		    / count;
+
+		std::ofstream file(m_settings.output);
+		if (!file)
+		{
+			VEGAM_ERROR("Could not write benchmark results to "
+			            "{}",
+			            m_settings.output);
+			return;
+		}
+
+		file << "{\n"
+		     << "  \"scene\": {\"meshes\": "
+		     << m_settings.meshes
+		     << ", \"shaders\": " << m_settings.shaders
+		     << ", \"uniforms\": " << m_settings.uniforms
+		     << "},\n"
+		     << "  \"frames\": " << sorted.size() << ",\n"
+		     << "  \"frameTimeMs\": {\"mean\": " << mean
+		     << ", \"min\": " << sorted.front()
+		     << ", \"p50\": " << Percentile(sorted, 50)
+		     << ", \"p95\": " << Percentile(sorted, 95)
+		     << ", \"p99\": " << Percentile(sorted, 99)
+		     << ", \"max\": " << sorted.back() << "},\n"
+		     << "  \"drawCallsPerFrame\": "
+		     << m_drawCalls / count << ",\n"
+		     << "  \"stateChangesPerFrame\": "
+		     << m_stateChanges / count << ",\n"
+		     << "  \"glCallsPerFrame\": " << m_glCalls / count
+		     << ",\n"
+		     << "  \"budgetViolations\": "
+		     << Core::Profiler::GetBudgetViolations() << ",\n"
+		     << "  \"budgets\": [";
+		const auto budgets = Core::Profiler::GetBudgets();
+		for (size_t i = 0; i < budgets.size(); ++i)
+		{
+			const auto& budget = budgets[i];
+			file << (i > 0 ? ",\n    " : "\n    ")
+			     << "{\"zone\": \"" << budget.zone
+			     << "\", \"budgetMs\": " << budget.budgetMs
+			     << ", \"worstMs\": " << budget.worstMs
+			     << ", \"violations\": "
+			     << budget.totalViolations << "}";
+		}
+		file << (budgets.empty() ? "],\n" : "\n  ],\n")
+		     << "  \"zones\": [";
+		const char* separator = "\n    ";
+		for (const auto& [zone, milliseconds] : m_zoneTimes)
+		{
+			file << separator << "{\"name\": \"" << zone
+			     << "\", \"msPerFrame\": "
+			     << milliseconds / count << "}";
+			separator = ",\n    ";
+		}
+		file << (m_zoneTimes.empty() ? "],\n" : "\n  ],\n")
+		     << "  \"frameTimesMs\": [";
+		// In the order run.
+		for (size_t i = 0; i < m_frameTimes.size(); ++i)
+		{
+			file << (i > 0 ? (i % 10 == 0 ? ",\n    " : ", ")
+			               : "\n    ")
+			     << m_frameTimes[i];
+		}
+		file << "\n  ]\n}\n";
+
+		VEGAM_INFO("Benchmark: mean {:.3f} ms, p99 {:.3f} ms, "
+		           "written to {}",
+		           mean, Percentile(sorted, 99),
+		           m_settings.output);
+	}
+} // namespace Benchmarks
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace MicroBenchmarks
+{
+	// Passed to each benchmark function, which repeats the
+	// measured code while KeepRunning() returns true. Time
+	// is measured from the first KeepRunning() call to the
+	// last, minus any stretch between PauseTiming() and
+	// ResumeTiming().
+	class State
+	{
+	  public:
+		using Clock = std::chrono::steady_clock;
+
+		explicit State(uint64_t iterations)
+		    : m_iterations(iterations)
+		    , m_remaining(iterations)
+		{
+		}
+
+		inline bool KeepRunning()
+		{
+			if (!m_started)
+			{
+				m_started = true;
+				m_start = Clock::now();
+			}
+			if (m_remaining == 0)
+			{
+				PauseTiming();
+				return false;
+			}
+			--m_remaining;
+			return true;
+		}
+
+		inline void PauseTiming()
+		{
+			if (m_running)
+			{
+				m_elapsed += Clock::now() - m_start;
+				m_running = false;
+			}
+		}
+		inline void ResumeTiming()
+		{
+			m_start = Clock::now();
+			m_running = true;
+		}
+
+		// Work per iteration, when an iteration covers more
+		// than one item (e.g. a batch of submits).
+		inline void SetItemsPerIteration(uint64_t items)
+		{
+			m_itemsPerIteration = items;
+		}
+
+		inline uint64_t GetIterations() const
+		{
+			return m_iterations;
+		}
+		inline uint64_t GetItemsPerIteration() const
+		{
+			return m_itemsPerIteration;
+		}
+		inline double GetSeconds() const
+		{
+			return std::chrono::duration<double>(m_elapsed)
+			    .count();
+		}
+
+	  private:
+		uint64_t m_iterations;
+		uint64_t m_remaining;
+		uint64_t m_itemsPerIteration = 1;
+		Clock::time_point m_start;
+		Clock::duration m_elapsed{};
+		bool m_started = false;
+		bool m_running = true;
+	};
+
+	using Function = void (*)(State&);
+
+	// Adds a benchmark to the suite; see MICRO_BENCHMARK.
+	bool Register(const char* name, Function function);
+
+	// Keeps a value alive so the computation producing it
+	// is not optimized away.
+	void Consume(const void* value);
+	template <typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+		Consume(&value);
+	}
+
+	struct Options
+	{
+		// Only benchmarks whose name contains this run.
+		std::string filter;
+		// Each measurement runs at least this long.
+		double minSeconds = 0.25;
+		// Measurements per benchmark; the median is kept.
+		uint32_t repetitions = 3;
+		// Results are written here as JSON when non-empty.
+		std::string output;
+		// Results of an earlier run to compare against.
+		std::string baseline;
+		// Slowdown over the baseline, in percent, reported
+		// as a regression.
+		double regressionThreshold = 10.0;
+
+		static Options
+		Parse(const std::vector<std::string>& arguments);
+	};
+
+	// Runs the registered benchmarks and logs a table of
+	// results. Returns the number of regressions against
+	// the baseline.
+	uint32_t RunAll(const Options& options);
+} // namespace MicroBenchmarks
+
+#define MICRO_BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define MICRO_BENCHMARK_CONCAT(a, b)                       \
+	MICRO_BENCHMARK_CONCAT_IMPL(a, b)
+#define MICRO_BENCHMARK(function)                          \
+	static const bool MICRO_BENCHMARK_CONCAT(              \
+	    registered, __LINE__) =                            \
+	    ::MicroBenchmarks::Register(#function, function)
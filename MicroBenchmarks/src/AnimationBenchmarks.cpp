@@ -0,0 +1,93 @@
+#include "MicroBenchmarks/Benchmark.h"
+
+#include "AthiVegam/Animation/Clip.h"
+#include "AthiVegam/Animation/Pose.h"
+
+#include <cmath>
+#include <vector>
+
+namespace MicroBenchmarks
+{
+	namespace
+	{
+		using namespace AthiVegam;
+
+		constexpr uint32_t Bones = 64;
+		constexpr uint32_t Frames = 120;
+
+		Animation::RawClip MakeClip(float phase)
+		{
+			Animation::RawClip raw;
+			raw.frameCount = Frames;
+			raw.boneCount = Bones;
+			for (uint32_t frame = 0; frame < Frames; ++frame)
+			{
+				const auto t = static_cast<float>(frame) * 0.1f;
+				for (uint32_t bone = 0; bone < Bones; ++bone)
+				{
+					const auto angle =
+					    std::sin(t + phase + 0.1f * bone);
+					raw.frames.push_back(
+					    {{0.0f, 0.1f * angle, 0.0f},
+					     Math::FromAxisAngle({1.0f, 0.0f, 0.0f},
+					                         angle),
+					     {1.0f, 1.0f, 1.0f}});
+				}
+			}
+			return raw;
+		}
+
+		// A character's clip sampled at a new time.
+		void AnimationSampleClip(State& state)
+		{
+			const Animation::Clip clip(MakeClip(0.0f));
+			Animation::Pose pose(Bones);
+			auto time = 0.0f;
+			state.SetItemsPerIteration(Bones);
+			while (state.KeepRunning())
+			{
+				time = std::fmod(time + 0.016f,
+				                 clip.GetDuration());
+				clip.Sample(time, pose);
+				DoNotOptimize(
+				    pose.GetStream(Animation::Pose::RotationW)[0]);
+			}
+		}
+
+		void AnimationBlendPoses(State& state)
+		{
+			Animation::Pose a(Bones);
+			Animation::Pose b(Bones);
+			const auto rotation =
+			    Math::FromAxisAngle({0.0f, 1.0f, 0.0f}, 1.0f);
+			for (uint32_t bone = 0; bone < Bones; ++bone)
+			{
+				b.Set(bone, {{1.0f, 2.0f, 3.0f}, rotation});
+			}
+			Animation::Pose out(Bones);
+			state.SetItemsPerIteration(Bones);
+			while (state.KeepRunning())
+			{
+				Animation::Blend(a, b, 0.3f, out);
+				DoNotOptimize(
+				    out.GetStream(Animation::Pose::RotationW)[0]);
+			}
+		}
+
+		void AnimationPoseToMatrices(State& state)
+		{
+			Animation::Pose pose(Bones);
+			std::vector<Math::Mat4> out(Bones);
+			state.SetItemsPerIteration(Bones);
+			while (state.KeepRunning())
+			{
+				pose.ToMatrices(out);
+				DoNotOptimize(out[Bones - 1].columns[0].x);
+			}
+		}
+	} // namespace
+
+	MICRO_BENCHMARK(AnimationSampleClip);
+	MICRO_BENCHMARK(AnimationBlendPoses);
+	MICRO_BENCHMARK(AnimationPoseToMatrices);
+} // namespace MicroBenchmarks
@@ -0,0 +1,281 @@
+#include "MicroBenchmarks/Benchmark.h"
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+
+namespace MicroBenchmarks
+{
+	namespace
+	{
+		struct Entry
+		{
+			const char* name;
+			Function function;
+		};
+
+		struct Result
+		{
+			std::string name;
+			double nsPerItem;
+			uint64_t iterations;
+		};
+
+		// Function-local so registration from other
+		// translation units' static initializers is safe.
+		std::vector<Entry>& GetRegistry()
+		{
+			static std::vector<Entry> registry;
+			return registry;
+		}
+
+		volatile const void* consumed = nullptr;
+
+		bool ParseFlag(std::string_view argument,
+		               std::string_view name,
+		               std::string_view& value)
+		{
+			if (!argument.starts_with(name)
+			    || argument.size() <= name.size()
+			    || argument[name.size()] != '=')
+			{
+				return false;
+			}
+			value = argument.substr(name.size() + 1);
+			return true;
+		}
+
+		template <typename T>
+		void ParseNumber(std::string_view value, T& number)
+		{
+			const auto [end, error] = std::from_chars(
+			    value.data(), value.data() + value.size(),
+			    number);
+			if (error != std::errc())
+			{
+				VEGAM_WARN("Ignoring bad number: {}", value);
+			}
+		}
+
+		// Grows the iteration count until one run takes at
+		// least minSeconds, then returns its time per item.
+		Result Measure(const Entry& entry, double minSeconds)
+		{
+			uint64_t iterations = 1;
+			for (;;)
+			{
+				State state(iterations);
+				entry.function(state);
+				const auto seconds = state.GetSeconds();
+				if (seconds >= minSeconds
+				    || iterations >= (1ull << 40))
+				{
+					const auto items =
+					    static_cast<double>(iterations)
+					    * state.GetItemsPerIteration();
+					return {entry.name, seconds * 1e9 / items,
+					        iterations};
+				}
+
+				// Aim past the target, at most 10x per step.
+				const auto scale =
+				    seconds > 0.0
+				        ? std::min(minSeconds * 1.4 / seconds,
+				                   10.0)
+				        : 10.0;
+				iterations = std::max(
+				    iterations + 1,
+				    static_cast<uint64_t>(iterations * scale));
+			}
+		}
+
+		// Reads the "name" and "nsPerItem" pairs written by
+		// WriteResults().
+		std::unordered_map<std::string, double>
+		ReadBaseline(const std::string& path)
+		{
+			std::unordered_map<std::string, double> baseline;
+			std::ifstream file(path);
+			if (!file)
+			{
+				VEGAM_WARN("Could not read baseline {}", path);
+				return baseline;
+			}
+
+			constexpr std::string_view nameKey = "\"name\": \"";
+			constexpr std::string_view timeKey =
+			    "\"nsPerItem\": ";
+			std::string line;
+			while (std::getline(file, line))
+			{
+				const auto name = line.find(nameKey);
+				const auto time = line.find(timeKey);
+				if (name == std::string::npos
+				    || time == std::string::npos)
+				{
+					continue;
+				}
+				const auto begin = name + nameKey.size();
+				const auto end = line.find('"', begin);
+				double value = 0.0;
+				const auto* first =
+				    line.data() + time + timeKey.size();
+				std::from_chars(first,
+				                line.data() + line.size(),
+				                value);
+				baseline[line.substr(begin, end - begin)] =
+				    value;
+			}
+			return baseline;
+		}
+
+		void WriteResults(const std::string& path,
+		                  const std::vector<Result>& results)
+		{
+			std::ofstream file(path);
+			if (!file)
+			{
+				VEGAM_ERROR("Could not write results to {}",
+				            path);
+				return;
+			}
+
+			file << "{\n  \"benchmarks\": [\n";
+			for (size_t i = 0; i < results.size(); ++i)
+			{
+				const auto& result = results[i];
+				file << "    {\"name\": \"" << result.name
+				     << "\", \"nsPerItem\": "
+				     << result.nsPerItem
+				     << ", \"iterations\": "
+				     << result.iterations << "}"
+				     << (i + 1 < results.size() ? ",\n"
+				                                : "\n");
+			}
+			file << "  ]\n}\n";
+			VEGAM_INFO("Results written to {}", path);
+		}
+	} // namespace
+
+	bool Register(const char* name, Function function)
+	{
+		GetRegistry().push_back({name, function});
+		return true;
+	}
+
+	void Consume(const void* value) { consumed = value; }
+
+	Options
+	Options::Parse(const std::vector<std::string>& arguments)
+	{
+		Options options;
+		for (const std::string_view argument : arguments)
+		{
+			std::string_view value;
+			if (ParseFlag(argument, "--filter", value))
+			{
+				options.filter = value;
+			}
+			else if (ParseFlag(argument, "--min-time", value))
+			{
+				ParseNumber(value, options.minSeconds);
+			}
+			else if (ParseFlag(argument, "--repetitions",
+			                   value))
+			{
+				ParseNumber(value, options.repetitions);
+			}
+			else if (ParseFlag(argument, "--output", value))
+			{
+				options.output = value;
+			}
+			else if (ParseFlag(argument, "--baseline", value))
+			{
+				options.baseline = value;
+			}
+			else if (ParseFlag(argument, "--threshold", value))
+			{
+				ParseNumber(value,
+				            options.regressionThreshold);
+			}
+		}
+		options.repetitions = std::max(options.repetitions, 1u);
+		return options;
+	}
+
+	uint32_t RunAll(const Options& options)
+	{
+		const auto baseline =
+		    options.baseline.empty()
+		        ? std::unordered_map<std::string, double>()
+		        : ReadBaseline(options.baseline);
+
+		auto entries = GetRegistry();
+		std::sort(entries.begin(), entries.end(),
+		          [](const Entry& a, const Entry& b) {
+			          return std::string_view(a.name)
+			                 < std::string_view(b.name);
+		          });
+
+		std::vector<Result> results;
+		uint32_t regressions = 0;
+		for (const auto& entry : entries)
+		{
+			if (!options.filter.empty()
+			    && std::string_view(entry.name).find(
+			           options.filter)
+			           == std::string_view::npos)
+			{
+				continue;
+			}
+
+			std::vector<Result> runs;
+			for (uint32_t i = 0; i < options.repetitions; ++i)
+			{
+				runs.push_back(
+				    Measure(entry, options.minSeconds));
+			}
+			std::sort(runs.begin(), runs.end(),
+			          [](const Result& a, const Result& b) {
+				          return a.nsPerItem < b.nsPerItem;
+			          });
+			const auto& result = runs[runs.size() / 2];
+			results.push_back(result);
+
+			const auto it = baseline.find(result.name);
+			if (it == baseline.end() || it->second <= 0.0)
+			{
+				VEGAM_INFO("{:<40} {:>12.2f} ns", result.name,
+				           result.nsPerItem);
+				continue;
+			}
+
+			const auto change =
+			    (result.nsPerItem / it->second - 1.0) * 100.0;
+			if (change > options.regressionThreshold)
+			{
+				++regressions;
+				VEGAM_ERROR("{:<40} {:>12.2f} ns {:+7.1f}% "
+				            "REGRESSION",
+				            result.name, result.nsPerItem,
+				            change);
+			}
+			else
+			{
+				VEGAM_INFO("{:<40} {:>12.2f} ns {:+7.1f}%",
+				           result.name, result.nsPerItem,
+				           change);
+			}
+		}
+
+		if (!options.output.empty())
+		{
+			WriteResults(options.output, results);
+		}
+		return regressions;
+	}
+} // namespace MicroBenchmarks
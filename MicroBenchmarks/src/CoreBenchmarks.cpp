@@ -0,0 +1,78 @@
+#include "MicroBenchmarks/Benchmark.h"
+
+#include "AthiVegam/Input/Keyboard.h"
+#include "AthiVegam/Log.h"
+#include "spdlog/sinks/null_sink.h"
+
+#include <memory>
+#include <vector>
+
+namespace MicroBenchmarks
+{
+	namespace
+	{
+		// Swaps the engine logger's sinks for a null sink,
+		// so log calls run their formatting without writing
+		// anywhere, and restores them on destruction.
+		class NullLogSinks
+		{
+		  public:
+			NullLogSinks()
+			    : m_logger(
+			          AthiVegam::Managers::LogManager::Logger())
+			    , m_sinks(m_logger->sinks())
+			{
+				using spdlog::sinks::null_sink_mt;
+				m_logger->sinks() = {
+				    std::make_shared<null_sink_mt>()};
+			}
+			~NullLogSinks() { m_logger->sinks() = m_sinks; }
+
+			inline spdlog::logger& GetLogger()
+			{
+				return *m_logger;
+			}
+
+		  private:
+			std::shared_ptr<spdlog::logger> m_logger;
+			std::vector<spdlog::sink_ptr> m_sinks;
+		};
+
+		void KeyboardUpdate(State& state)
+		{
+			while (state.KeepRunning())
+			{
+				AthiVegam::Input::Keyboard::Update();
+			}
+		}
+
+		void LogEnabled(State& state)
+		{
+			NullLogSinks sinks;
+			int value = 42;
+			while (state.KeepRunning())
+			{
+				VEGAM_WARN("Benchmark message {}", value);
+			}
+		}
+
+		// A message below the logger's level: the cost of
+		// leaving log calls in hot code.
+		void LogFiltered(State& state)
+		{
+			NullLogSinks sinks;
+			const auto level = sinks.GetLogger().level();
+			sinks.GetLogger().set_level(spdlog::level::info);
+			int value = 42;
+			while (state.KeepRunning())
+			{
+				VEGAM_TRACE("Benchmark message {}", value);
+			}
+			sinks.GetLogger().set_level(level);
+		}
+	} // namespace
+
+	MICRO_BENCHMARK(KeyboardUpdate);
+	MICRO_BENCHMARK(LogEnabled);
+	MICRO_BENCHMARK(LogFiltered);
+} // namespace MicroBenchmarks
@@ -0,0 +1,120 @@
+#include "MicroBenchmarks/Benchmark.h"
+
+#include "AthiVegam/Ecs/Registry.h"
+#include "AthiVegam/Engine.h"
+
+#include <vector>
+
+namespace MicroBenchmarks
+{
+	namespace
+	{
+		using namespace AthiVegam;
+
+		constexpr uint32_t EntityCount = 100'000;
+
+		struct Position
+		{
+			float x = 0.0f, y = 0.0f, z = 0.0f;
+		};
+		struct Velocity
+		{
+			float x = 1.0f, y = 0.0f, z = 0.0f;
+		};
+		struct Health
+		{
+			float value = 100.0f;
+		};
+
+		// Half the entities also have Health, so the
+		// movement query spans two archetypes.
+		void Populate(Ecs::Registry& registry)
+		{
+			for (uint32_t i = 0; i < EntityCount; ++i)
+			{
+				const auto entity =
+				    registry.Create(Position{}, Velocity{});
+				if (i % 2 == 0)
+				{
+					registry.Add(entity, Health{});
+				}
+			}
+		}
+
+		void Integrate(Position& position,
+		               const Velocity& velocity)
+		{
+			constexpr float step = 1.0f / 60.0f;
+			position.x += velocity.x * step;
+			position.y += velocity.y * step;
+			position.z += velocity.z * step;
+		}
+
+		void EcsForEach(State& state)
+		{
+			Ecs::Registry registry;
+			Populate(registry);
+			state.SetItemsPerIteration(EntityCount);
+			while (state.KeepRunning())
+			{
+				registry.ForEach<Position, const Velocity>(
+				    Integrate);
+			}
+		}
+
+		void EcsParallelForEach(State& state)
+		{
+			Ecs::Registry registry;
+			Populate(registry);
+			auto& jobs = Engine::Instance().GetJobManager();
+			state.SetItemsPerIteration(EntityCount);
+			while (state.KeepRunning())
+			{
+				registry
+				    .ParallelForEach<Position, const Velocity>(
+				        jobs, Integrate);
+			}
+		}
+
+		// The same update through per-entity lookups, as
+		// ad-hoc objects holding handles would do it.
+		void EcsRandomAccess(State& state)
+		{
+			Ecs::Registry registry;
+			std::vector<Ecs::Entity> entities;
+			for (uint32_t i = 0; i < EntityCount; ++i)
+			{
+				entities.push_back(
+				    registry.Create(Position{}, Velocity{}));
+			}
+			state.SetItemsPerIteration(EntityCount);
+			while (state.KeepRunning())
+			{
+				for (const auto entity : entities)
+				{
+					Integrate(*registry.Get<Position>(entity),
+					          *registry.Get<Velocity>(entity));
+				}
+			}
+		}
+
+		// Adding and removing a component moves the entity
+		// between archetypes.
+		void EcsAddRemove(State& state)
+		{
+			Ecs::Registry registry;
+			const auto entity =
+			    registry.Create(Position{}, Velocity{});
+			while (state.KeepRunning())
+			{
+				registry.Add(entity, Health{});
+				registry.Remove<Health>(entity);
+			}
+		}
+	} // namespace
+
+	MICRO_BENCHMARK(EcsForEach);
+	MICRO_BENCHMARK(EcsParallelForEach);
+	MICRO_BENCHMARK(EcsRandomAccess);
+	MICRO_BENCHMARK(EcsAddRemove);
+} // namespace MicroBenchmarks
@@ -0,0 +1,45 @@
+#include "AthiVegam/App.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Main.h"
+#include "MicroBenchmarks/Benchmark.h"
+
+using namespace AthiVegam;
+
+namespace MicroBenchmarks
+{
+	// Runs the suite from the first frame, once the engine
+	// and its GL context are up, then quits.
+	class BenchmarkApp : public App
+	{
+	  public:
+		EngineConfig GetEngineConfig() const override
+		{
+			EngineConfig config;
+			config.window.hidden = true;
+			config.window.vsync = VSync::Off;
+			config.showPerformanceHud = false;
+			config.shaderCacheDirectory.clear();
+			return config;
+		}
+
+		void Render(float alpha) override
+		{
+			auto& engine = Engine::Instance();
+			const auto options =
+			    Options::Parse(engine.GetArguments());
+			const auto regressions = RunAll(options);
+			if (regressions > 0)
+			{
+				VEGAM_ERROR("{} benchmarks regressed",
+				            regressions);
+			}
+			engine.Quit();
+		}
+	};
+} // namespace MicroBenchmarks
+
+std::unique_ptr<App> CreateApp()
+{
+	return std::make_unique<MicroBenchmarks::BenchmarkApp>();
+}
@@ -0,0 +1,90 @@
+#include "MicroBenchmarks/Benchmark.h"
+
+#include "AthiVegam/Math/Batch.h"
+
+#include <random>
+#include <vector>
+
+namespace MicroBenchmarks
+{
+	namespace
+	{
+		using namespace AthiVegam;
+
+		constexpr uint32_t Count = 100'000;
+
+		Math::Mat4 MakeTransform()
+		{
+			return Math::Mat4::Trs(
+			    {1.0f, 2.0f, 3.0f},
+			    Math::FromAxisAngle({0.0f, 1.0f, 0.0f}, 0.5f),
+			    {2.0f, 2.0f, 2.0f});
+		}
+
+		void MathTransformPoints(State& state)
+		{
+			std::mt19937 random(42);
+			std::uniform_real_distribution<float> value(-1.0f,
+			                                            1.0f);
+			std::vector<Math::Vec3> points(Count);
+			for (auto& point : points)
+			{
+				point = {value(random), value(random),
+				         value(random)};
+			}
+			std::vector<Math::Vec3> out(Count);
+			const auto transform = MakeTransform();
+			state.SetItemsPerIteration(Count);
+			while (state.KeepRunning())
+			{
+				Math::TransformPoints(transform, points.data(),
+				                      out.data(), Count);
+				DoNotOptimize(out[Count - 1].x);
+			}
+		}
+
+		// A view-projection applied to every instance.
+		void MathMultiplyMatrices(State& state)
+		{
+			std::vector<Math::Mat4> instances(Count,
+			                                  MakeTransform());
+			std::vector<Math::Mat4> out(Count);
+			const auto viewProjection =
+			    Math::Mat4::Perspective(1.0f, 16.0f / 9.0f,
+			                            0.1f, 100.0f)
+			    * Math::Mat4::LookAt({0.0f, 0.0f, 5.0f}, {},
+			                         {0.0f, 1.0f, 0.0f});
+			state.SetItemsPerIteration(Count);
+			while (state.KeepRunning())
+			{
+				Math::Multiply(viewProjection, instances.data(),
+				               out.data(), Count);
+				DoNotOptimize(out[Count - 1].columns[3].w);
+			}
+		}
+
+		void MathComposeTrs(State& state)
+		{
+			std::vector<Math::Vec3> translations(
+			    Count, {1.0f, 2.0f, 3.0f});
+			std::vector<Math::Quat> rotations(
+			    Count,
+			    Math::FromAxisAngle({0.0f, 0.0f, 1.0f}, 0.3f));
+			std::vector<Math::Vec3> scales(Count,
+			                               {1.0f, 1.0f, 1.0f});
+			std::vector<Math::Mat4> out(Count);
+			state.SetItemsPerIteration(Count);
+			while (state.KeepRunning())
+			{
+				Math::ComposeTrs(translations.data(),
+				                 rotations.data(), scales.data(),
+				                 out.data(), Count);
+				DoNotOptimize(out[Count - 1].columns[0].x);
+			}
+		}
+	} // namespace
+
+	MICRO_BENCHMARK(MathTransformPoints);
+	MICRO_BENCHMARK(MathMultiplyMatrices);
+	MICRO_BENCHMARK(MathComposeTrs);
+} // namespace MicroBenchmarks
@@ -0,0 +1,289 @@
+#include "MicroBenchmarks/Benchmark.h"
+
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Graphics/ClusteredLighting.h"
+#include "AthiVegam/Graphics/CommandList.h"
+#include "AthiVegam/Graphics/SpriteBatch.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace MicroBenchmarks
+{
+	namespace
+	{
+		using namespace AthiVegam;
+
+		constexpr uint32_t SubmitBatch = 256;
+		constexpr uint32_t LightCount = 512;
+		constexpr uint32_t SpriteCount = 100000;
+
+		constexpr const char* VertexShader = R"(
+            #version 410 core
+            layout (location = 0) in vec2 position;
+            void main()
+            {
+                gl_Position = vec4(position, 0.0, 1.0);
+            }
+        )";
+		constexpr const char* FragmentShader = R"(
+            #version 410 core
+            out vec4 outColor;
+            uniform vec3 color = vec3(1.0);
+            void main()
+            {
+                outColor = vec4(color, 1.0);
+            }
+        )";
+
+		// A quad and a shader to draw it with, released when
+		// the benchmark function returns.
+		class Scene
+		{
+		  public:
+			Scene()
+			    : m_resources(
+			          Engine::Instance().GetResourceManager())
+			{
+				float vertices[]{0.1f,  0.1f,  0.1f, -0.1f,
+				                 -0.1f, -0.1f, -0.1f, 0.1f};
+				uint32_t elements[]{0, 1, 3, 1, 2, 3};
+				mesh = m_resources.CreateMesh(vertices, 4, 2,
+				                              elements, 6);
+				shader = m_resources.CreateShader(
+				    std::string(VertexShader),
+				    std::string(FragmentShader));
+			}
+			~Scene()
+			{
+				m_resources.DestroyShader(shader);
+				m_resources.DestroyMesh(mesh);
+			}
+
+			Graphics::MeshHandle mesh;
+			Graphics::ShaderHandle shader;
+
+		  private:
+			Managers::ResourceManager& m_resources;
+		};
+
+		void RenderManagerSubmit(State& state)
+		{
+			Scene scene;
+			auto& renderManager =
+			    Engine::Instance().GetRenderManager();
+			const Graphics::RenderCommands::RenderMesh command{
+			    scene.mesh, scene.shader};
+			state.SetItemsPerIteration(SubmitBatch);
+			while (state.KeepRunning())
+			{
+				for (uint32_t i = 0; i < SubmitBatch; ++i)
+				{
+					renderManager.Submit(command);
+				}
+				state.PauseTiming();
+				renderManager.Flush();
+				state.ResumeTiming();
+			}
+		}
+
+		void RenderManagerFlush(State& state)
+		{
+			Scene scene;
+			auto& renderManager =
+			    Engine::Instance().GetRenderManager();
+			const Graphics::RenderCommands::RenderMesh command{
+			    scene.mesh, scene.shader};
+			state.SetItemsPerIteration(SubmitBatch);
+			while (state.KeepRunning())
+			{
+				state.PauseTiming();
+				for (uint32_t i = 0; i < SubmitBatch; ++i)
+				{
+					renderManager.Submit(command);
+				}
+				state.ResumeTiming();
+				renderManager.Flush();
+			}
+		}
+
+		void ShaderGetUniformLiteral(State& state)
+		{
+			Scene scene;
+			auto* shader = Engine::Instance()
+			                   .GetResourceManager()
+			                   .GetShader(scene.shader);
+			while (state.KeepRunning())
+			{
+				DoNotOptimize(
+				    shader->GetUniform<Graphics::Float3>(
+				        "color"));
+			}
+		}
+
+		// Names only known at run time are hashed per call.
+		void ShaderGetUniformString(State& state)
+		{
+			Scene scene;
+			auto* shader = Engine::Instance()
+			                   .GetResourceManager()
+			                   .GetShader(scene.shader);
+			const std::string name = "color";
+			while (state.KeepRunning())
+			{
+				DoNotOptimize(
+				    shader->GetUniform<Graphics::Float3>(
+				        Graphics::UniformName::FromString(
+				            name)));
+			}
+		}
+
+		void MeshCreateDestroy(State& state)
+		{
+			auto& resources =
+			    Engine::Instance().GetResourceManager();
+			float vertices[]{0.1f,  0.1f,  0.1f, -0.1f,
+			                 -0.1f, -0.1f, -0.1f, 0.1f};
+			uint32_t elements[]{0, 1, 3, 1, 2, 3};
+			while (state.KeepRunning())
+			{
+				resources.DestroyMesh(resources.CreateMesh(
+				    vertices, 4, 2, elements, 6));
+			}
+		}
+
+		void StandaloneMeshCreateDestroy(State& state)
+		{
+			auto& resources =
+			    Engine::Instance().GetResourceManager();
+			const auto layout =
+			    Graphics::VertexLayout::Positions(2);
+			float vertices[]{0.1f,  0.1f,  0.1f, -0.1f,
+			                 -0.1f, -0.1f, -0.1f, 0.1f};
+			uint32_t elements[]{0, 1, 3, 1, 2, 3};
+			while (state.KeepRunning())
+			{
+				resources.DestroyMesh(
+				    resources.CreateStandaloneMesh(
+				        layout, vertices, 4, elements, 6));
+			}
+		}
+
+		// Lights scattered through a 60 degree view.
+		struct LightScene
+		{
+			LightScene()
+			{
+				const auto f = 1.0f / std::tan(0.5236f);
+				projection[0] = f * 9.0f / 16.0f;
+				projection[5] = f;
+				projection[10] = -1.0f;
+				projection[11] = -1.0f;
+				projection[14] = -0.2f;
+
+				std::mt19937 random(7);
+				std::uniform_real_distribution<float> unit(0.0f,
+				                                           1.0f);
+				lights.resize(LightCount);
+				for (auto& light : lights)
+				{
+					const auto depth = 1.0f + unit(random) * 99.0f;
+					light.position = {
+					    (unit(random) - 0.5f) * depth,
+					    (unit(random) - 0.5f) * depth * 0.6f,
+					    -depth};
+					light.radius = 1.0f + unit(random) * 7.0f;
+				}
+			}
+
+			float view[16]{1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+			               0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+			               0.0f, 0.0f, 0.0f, 1.0f};
+			float projection[16]{};
+			std::vector<Graphics::PointLight> lights;
+		};
+
+		void ClusteredLightingBuild(State& state)
+		{
+			LightScene scene;
+			Graphics::ClusteredLighting lighting;
+			state.SetItemsPerIteration(LightCount);
+			while (state.KeepRunning())
+			{
+				lighting.Build(scene.view, scene.projection,
+				               0.1f, 100.0f, 1920, 1080,
+				               scene.lights);
+				DoNotOptimize(lighting.GetLightIndices().data());
+			}
+		}
+
+		void ClusteredLightingBuildParallel(State& state)
+		{
+			LightScene scene;
+			Graphics::ClusteredLighting lighting;
+			auto& jobs = Engine::Instance().GetJobManager();
+			state.SetItemsPerIteration(LightCount);
+			while (state.KeepRunning())
+			{
+				lighting.Build(scene.view, scene.projection,
+				               0.1f, 100.0f, 1920, 1080,
+				               scene.lights, jobs);
+				DoNotOptimize(lighting.GetLightIndices().data());
+			}
+		}
+
+		// Sprites over 4 layers and 16 textures, sorted and
+		// recorded into a list of their own; the handles are
+		// never resolved.
+		void SpriteBatchRecord(State& state)
+		{
+			std::mt19937 random(7);
+			std::uniform_real_distribution<float> unit(0.0f,
+			                                           1.0f);
+			std::vector<Graphics::Sprite> sprites(SpriteCount);
+			for (auto& sprite : sprites)
+			{
+				sprite.x = unit(random) * 1920.0f;
+				sprite.y = unit(random) * 1080.0f;
+				sprite.width = 16.0f;
+				sprite.height = 16.0f;
+				sprite.rotation = unit(random) * 6.283f;
+				sprite.texture = Graphics::TextureHandle::Make(
+				    1 + static_cast<uint32_t>(random() % 16), 1);
+				sprite.layer =
+				    static_cast<int16_t>(random() % 4);
+			}
+			const float viewProjection[16]{
+			    2.0f / 1920.0f, 0.0f, 0.0f, 0.0f,
+			    0.0f, 2.0f / 1080.0f, 0.0f, 0.0f,
+			    0.0f, 0.0f, -1.0f, 0.0f,
+			    -1.0f, -1.0f, 0.0f, 1.0f};
+
+			Graphics::SpriteBatch batch;
+			Graphics::CommandList list;
+			state.SetItemsPerIteration(SpriteCount);
+			while (state.KeepRunning())
+			{
+				batch.Begin(viewProjection);
+				for (const auto& sprite : sprites)
+				{
+					batch.Draw(sprite);
+				}
+				batch.End(list);
+				DoNotOptimize(list.GetInstances().data());
+				list.Reset();
+			}
+		}
+	} // namespace
+
+	MICRO_BENCHMARK(RenderManagerSubmit);
+	MICRO_BENCHMARK(RenderManagerFlush);
+	MICRO_BENCHMARK(ShaderGetUniformLiteral);
+	MICRO_BENCHMARK(ShaderGetUniformString);
+	MICRO_BENCHMARK(MeshCreateDestroy);
+	MICRO_BENCHMARK(StandaloneMeshCreateDestroy);
+	MICRO_BENCHMARK(ClusteredLightingBuild);
+	MICRO_BENCHMARK(ClusteredLightingBuildParallel);
+	MICRO_BENCHMARK(SpriteBatchRecord);
+} // namespace MicroBenchmarks
@@ -0,0 +1,240 @@
+#include "MicroBenchmarks/Benchmark.h"
+
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Graphics/CommandList.h"
+#include "AthiVegam/Scene/TransformHierarchy.h"
+#include "AthiVegam/Scene/World.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace MicroBenchmarks
+{
+	namespace
+	{
+		using namespace AthiVegam;
+
+		constexpr uint32_t ObjectCount = 100'000;
+		constexpr float Extent = 500.0f;
+
+		// ObjectCount unit boxes scattered through a cube
+		// of side 2 * Extent.
+		class RandomWorld
+		{
+		  public:
+			RandomWorld()
+			{
+				std::mt19937 random(42);
+				std::uniform_real_distribution<float> position(
+				    -Extent, Extent);
+				for (uint32_t i = 0; i < ObjectCount; ++i)
+				{
+					Scene::SceneObject object;
+					object.bounds = {{-1.0f, -1.0f, -1.0f},
+					                 {1.0f, 1.0f, 1.0f}};
+					object.transform.m[12] = position(random);
+					object.transform.m[13] = position(random);
+					object.transform.m[14] = position(random);
+					ids.push_back(world.Add(object));
+				}
+			}
+
+			Scene::World world;
+			std::vector<Scene::World::ObjectId> ids;
+		};
+
+		// 60 degrees vertically at 16:9 from the origin,
+		// looking down -z to 300.
+		void MakeProjection(float projection[16])
+		{
+			constexpr float near = 0.1f;
+			constexpr float far = 300.0f;
+			const auto focal = 1.0f / std::tan(0.5236f);
+			const float matrix[16] = {
+			    focal * 9.0f / 16.0f, 0, 0, 0, 0, focal, 0, 0,
+			    0, 0, (far + near) / (near - far), -1, 0, 0,
+			    2.0f * far * near / (near - far), 0};
+			std::copy(matrix, matrix + 16, projection);
+		}
+
+		Graphics::Frustum MakeFrustum()
+		{
+			float projection[16];
+			MakeProjection(projection);
+			return Graphics::Frustum::FromMatrix(projection);
+		}
+
+		void WorldFrustumQuery(State& state)
+		{
+			RandomWorld scene;
+			const auto frustum = MakeFrustum();
+			std::vector<Scene::World::ObjectId> visible;
+			while (state.KeepRunning())
+			{
+				visible.clear();
+				scene.world.QueryFrustum(frustum, visible);
+				DoNotOptimize(visible.size());
+			}
+		}
+
+		// Every object with three coarser levels, picked
+		// and cross-faded per frame.
+		void WorldSubmitLod(State& state)
+		{
+			RandomWorld scene;
+			Graphics::LodChain lods;
+			lods.count = 3;
+			for (uint32_t i = 0; i < lods.count; ++i)
+			{
+				lods.meshes[i] =
+				    Graphics::MeshHandle::Make(i + 2, 1);
+			}
+			lods.thresholds = {0.05f, 0.02f, 0.01f};
+			for (const auto id : scene.ids)
+			{
+				auto object = scene.world.Get(id);
+				object.lods = lods;
+				scene.world.Remove(id);
+				scene.world.Add(object);
+			}
+
+			float projection[16];
+			MakeProjection(projection);
+			Graphics::LodSettings settings;
+			settings.fadeFrames = 8;
+			Graphics::CommandList list;
+			while (state.KeepRunning())
+			{
+				list.Reset();
+				scene.world.Submit(projection, list, settings);
+				DoNotOptimize(list.GetEntries().size());
+			}
+		}
+
+		void WorldRaycast(State& state)
+		{
+			RandomWorld scene;
+			while (state.KeepRunning())
+			{
+				DoNotOptimize(scene.world.Raycast(
+				    {0.0f, 0.0f, 0.0f}, {0.6f, 0.8f, 0.0f},
+				    2.0f * Extent));
+			}
+		}
+
+		// Every object drifts a little each frame, one in
+		// ten far enough to leave its leaf.
+		void WorldMove(State& state)
+		{
+			RandomWorld scene;
+			state.SetItemsPerIteration(ObjectCount);
+			float step = 0.01f;
+			while (state.KeepRunning())
+			{
+				for (uint32_t i = 0; i < ObjectCount; ++i)
+				{
+					auto transform =
+					    scene.world.Get(scene.ids[i]).transform;
+					transform.m[12] += i % 10 == 0 ? step * 100.0f
+					                                : step;
+					scene.world.SetTransform(scene.ids[i],
+					                         transform);
+				}
+				step = -step;
+			}
+		}
+
+		// ObjectCount nodes, one in a hundred a root and the
+		// rest children of a random earlier node.
+		class RandomHierarchy
+		{
+		  public:
+			using Hierarchy = Scene::TransformHierarchy;
+
+			RandomHierarchy()
+			{
+				std::mt19937 random(42);
+				Scene::LocalTransform local;
+				local.position = {1.0f, 0.0f, 0.0f};
+				for (uint32_t i = 0; i < ObjectCount; ++i)
+				{
+					auto parent = Hierarchy::InvalidNode;
+					if (i % 100 != 0)
+					{
+						parent = ids[random() % i];
+					}
+					ids.push_back(
+					    hierarchy.Create(local, parent));
+				}
+				hierarchy.Update();
+			}
+
+			// Moves one node in every stride, so those nodes
+			// and their subtrees need updating.
+			void Move(uint32_t stride, float offset)
+			{
+				Scene::LocalTransform local;
+				local.position = {1.0f, offset, 0.0f};
+				for (uint32_t i = 0; i < ObjectCount;
+				     i += stride)
+				{
+					hierarchy.SetLocal(ids[i], local);
+				}
+			}
+
+			Hierarchy hierarchy;
+			std::vector<Hierarchy::NodeId> ids;
+		};
+
+		// Every root moves, so every world matrix is
+		// recomputed.
+		void TransformUpdateAll(State& state)
+		{
+			RandomHierarchy scene;
+			state.SetItemsPerIteration(ObjectCount);
+			float offset = 0.0f;
+			while (state.KeepRunning())
+			{
+				scene.Move(100, offset += 0.01f);
+				scene.hierarchy.Update();
+			}
+		}
+
+		void TransformUpdateAllParallel(State& state)
+		{
+			RandomHierarchy scene;
+			auto& jobs = Engine::Instance().GetJobManager();
+			state.SetItemsPerIteration(ObjectCount);
+			float offset = 0.0f;
+			while (state.KeepRunning())
+			{
+				scene.Move(100, offset += 0.01f);
+				scene.hierarchy.Update(jobs);
+			}
+		}
+
+		// A few leaves and small subtrees move; the rest
+		// of the pass only reads flags.
+		void TransformUpdateFew(State& state)
+		{
+			RandomHierarchy scene;
+			state.SetItemsPerIteration(ObjectCount);
+			float offset = 0.0f;
+			while (state.KeepRunning())
+			{
+				scene.Move(997, offset += 0.01f);
+				scene.hierarchy.Update();
+			}
+		}
+	} // namespace
+
+	MICRO_BENCHMARK(WorldFrustumQuery);
+	MICRO_BENCHMARK(WorldSubmitLod);
+	MICRO_BENCHMARK(WorldRaycast);
+	MICRO_BENCHMARK(WorldMove);
+	MICRO_BENCHMARK(TransformUpdateAll);
+	MICRO_BENCHMARK(TransformUpdateAllParallel);
+	MICRO_BENCHMARK(TransformUpdateFew);
+} // namespace MicroBenchmarks
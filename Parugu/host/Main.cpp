@@ -0,0 +1,5 @@
+// The executable of premake5 --game-module builds: the
+// engine and Main.h, running the game from ParuguGame, the
+// shared library built from src/ (see GameModule).
+#define AV_GAME_MODULE "ParuguGame"
+#include "AthiVegam/Main.h"
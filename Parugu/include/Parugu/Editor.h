@@ -1,28 +1,65 @@
 #pragma once
 
 #include "AthiVegam/App.h"
+#include "AthiVegam/Core/SaveWriter.h"
 #include "AthiVegam/Engine.h"
-#include "AthiVegam/Graphics/Mesh.h"
-#include "AthiVegam/Graphics/Shader.h"
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Graphics/RetainedList.h"
+#include "AthiVegam/Graphics/SceneViewport.h"
+#include "AthiVegam/Scene/World.h"
+#include "Parugu/PerfCompare.h"
+#include "Parugu/Thumbnails.h"
+#include "Parugu/UndoStack.h"
 
 namespace Parugu
 {
 	class Editor : public AthiVegam::App
 	{
 	  public:
+		Editor();
 		virtual ~Editor();
+		AthiVegam::EngineConfig
+		GetEngineConfig() const override;
 		void Initialize() override;
 		void Shutdown() override;
-		void Update() override;
-		void Render() override;
+		void Update(float deltaTime) override;
+		void Render(float alpha) override;
 
 	  private:
-		std::shared_ptr<AthiVegam::Graphics::Mesh> m_mesh;
-		std::shared_ptr<AthiVegam::Graphics::Shader>
-		    m_shader;
+		void SetShaderUniforms();
+		void Drag(float dx, float dy);
+		// Queues a write of the objects' transforms if they
+		// changed since the last.
+		void Autosave();
+		void LoadAutosave();
+
+	  private:
+		AthiVegam::Graphics::MeshHandle m_mesh;
+		AthiVegam::Graphics::ShaderHandle m_shader;
+		// The scene's draws, built once.
+		AthiVegam::Graphics::RetainedList m_draws;
+		// Everything clickable, for picking.
+		AthiVegam::Scene::World m_world;
+		// Edits of m_world's objects; property 0 is the
+		// transform.
+		UndoStack m_undo;
+		AthiVegam::Scene::World::ObjectId m_dragged =
+		    AthiVegam::Scene::World::InvalidObject;
+		// Previews for the asset browser.
+		Thumbnails m_thumbnails;
+		// The scene, as a panel.
+		AthiVegam::Graphics::SceneViewport m_viewport;
+		// Reviews captures and benchmark results.
+		PerfCompare m_perfCompare;
+		// Autosaves, written in the background.
+		AthiVegam::Core::SaveWriter m_saves;
+		// Edits of m_world made, and as of the last
+		// autosave.
+		uint64_t m_edits = 0;
+		uint64_t m_savedEdits = 0;
+		float m_sinceAutosave = 0.0f;
 		float xOffset = 0.f;
 		float yOffset = 0.f;
-		float keySpeed = 0.001f;
 	};
 } // namespace Parugu
 
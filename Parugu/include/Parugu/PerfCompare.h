@@ -0,0 +1,111 @@
+#pragma once
+
+#include "AthiVegam/Managers/JobManager.h"
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Parugu
+{
+	// A panel comparing two performance captures, a
+	// baseline A and a candidate B, for reviewing changes:
+	// frame-time statistics and distributions, render
+	// counts, and the time per frame of each profiler zone,
+	// largest change first. Either may be a profiler
+	// capture (Chrome trace JSON) or the results of the
+	// scene benchmark. Traces time frames by their
+	// FrameZone scopes and carry no render counts.
+	//
+	// Files are read and parsed on a job worker. Main
+	// thread, while ImGui records a frame.
+	class PerfCompare
+	{
+	  public:
+		// Starts a frame in traces.
+		static constexpr const char* FrameZone =
+		    "Engine::Update";
+
+		PerfCompare() = default;
+		// Waits for the loads in flight.
+		~PerfCompare();
+
+		PerfCompare(const PerfCompare&) = delete;
+		PerfCompare& operator=(const PerfCompare&) = delete;
+
+		// slot 0 is A, 1 is B.
+		void Load(uint32_t slot, const std::string& path);
+		void Draw(const char* title);
+
+	  private:
+		struct Stats
+		{
+			double mean = 0.0;
+			double p50 = 0.0;
+			double p95 = 0.0;
+			double p99 = 0.0;
+			double max = 0.0;
+		};
+
+		struct Capture
+		{
+			std::string path;
+			// Empty once loaded.
+			std::string error;
+			uint32_t frames = 0;
+			// In milliseconds; empty for benchmark results
+			// from before they were written.
+			std::vector<double> frameTimes;
+			Stats frameStats;
+			// Per frame; negative when not captured.
+			double drawCalls = -1.0;
+			double stateChanges = -1.0;
+			double glCalls = -1.0;
+			// Milliseconds per frame.
+			std::map<std::string, double> zones;
+		};
+
+		struct ZoneDelta
+		{
+			std::string name;
+			// Negative for a zone missing from a capture.
+			double a;
+			double b;
+		};
+
+		// On a worker.
+		static std::shared_ptr<Capture>
+		Read(const std::string& path);
+
+		void Poll();
+		void Compare();
+		void DrawSummary();
+		void DrawDistribution();
+		void DrawZones();
+
+	  private:
+		AthiVegam::Managers::JobCounter m_jobs;
+		std::mutex m_mutex;
+		// Loaded by the workers, for Poll(), with the
+		// load each came from.
+		std::array<std::shared_ptr<Capture>, 2> m_loaded;
+		std::array<uint32_t, 2> m_loadedRequests{};
+		// Loads started; all but the latest are dropped.
+		std::array<uint32_t, 2> m_requests{};
+
+		std::array<std::shared_ptr<const Capture>, 2>
+		    m_captures;
+		std::array<bool, 2> m_loading{};
+		std::array<std::array<char, 260>, 2> m_paths{};
+
+		// Of both captures, kept until either changes.
+		std::vector<ZoneDelta> m_zones;
+		std::array<std::vector<float>, 2> m_histograms;
+		float m_histogramMaxMs = 0.0f;
+		float m_histogramPeak = 0.0f;
+	};
+} // namespace Parugu
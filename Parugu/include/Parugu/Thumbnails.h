@@ -0,0 +1,131 @@
+#pragma once
+
+#include "AthiVegam/Assets/AssetId.h"
+#include "AthiVegam/Graphics/Handle.h"
+#include "AthiVegam/Graphics/ThumbnailRenderer.h"
+#include "AthiVegam/Managers/JobManager.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Parugu
+{
+	// Previews of meshes and their materials for the asset
+	// browser. Get() returns a placeholder icon at once;
+	// the preview replaces it later, without ever stalling
+	// a frame:
+	//
+	// - a job worker hashes the asset's source file and
+	//   looks the hash up in the cache directory, reading
+	//   the stored preview if there is one;
+	// - otherwise the mesh is streamed in through the
+	//   AssetManager and Update() renders a few previews
+	//   per frame, within a time budget;
+	// - the pixels are read back a few frames later and a
+	//   job worker stores them in the cache.
+	//
+	// Cached previews are keyed by the source's content
+	// and the preview size, so they survive renames and
+	// are redone when the asset changes. Main thread; GL
+	// work is done in Update().
+	class Thumbnails
+	{
+	  public:
+		struct Settings
+		{
+			std::string cacheDirectory = "Parugu/.thumbnails";
+			// Texels per side.
+			uint32_t size = 128;
+			// Rendering stops for the frame once either is
+			// reached.
+			uint32_t rendersPerFrame = 2;
+			float budgetMs = 2.0f;
+		};
+
+		Thumbnails() = default;
+		~Thumbnails() = default;
+
+		Thumbnails(const Thumbnails&) = delete;
+		Thumbnails& operator=(const Thumbnails&) = delete;
+
+		bool Initialize(const Settings& settings);
+		// Waits for the jobs in flight; previews handed out
+		// are destroyed.
+		void Shutdown();
+
+		// The preview of a mesh asset, drawn with the
+		// material's first texture if it has one. source is
+		// the file the asset is cooked from, or the cooked
+		// file. Until the preview is ready, and if it
+		// fails, returns the placeholder.
+		AthiVegam::Graphics::TextureHandle
+		Get(const std::string& source,
+		    AthiVegam::Assets::AssetId mesh,
+		    AthiVegam::Graphics::MaterialHandle material = {});
+		bool IsReady(const std::string& source) const;
+		inline AthiVegam::Graphics::TextureHandle
+		GetPlaceholder() const
+		{
+			return m_placeholder;
+		}
+
+		// Once per frame, on the GL thread.
+		void Update();
+
+	  private:
+		enum class State : uint8_t
+		{
+			// On a job worker.
+			Hashing,
+			// Not cached; streaming the mesh in.
+			Loading,
+			ReadingBack,
+			Ready,
+			Failed
+		};
+
+		struct Entry
+		{
+			std::string source;
+			AthiVegam::Assets::AssetId mesh;
+			AthiVegam::Graphics::MaterialHandle material;
+			AthiVegam::Graphics::TextureHandle texture;
+			// Of the cached preview, once hashed.
+			std::string cachePath;
+			State state = State::Hashing;
+			AthiVegam::Graphics::MeshHandle meshHandle;
+			bool meshRequested = false;
+			// Read from the cache by the hashing job.
+			std::vector<uint8_t> pixels;
+		};
+
+		void Hash(const std::shared_ptr<Entry>& entry);
+		void Upload(Entry& entry, std::vector<uint8_t> pixels);
+		void Render(const std::shared_ptr<Entry>& entry);
+		void Finish(Entry& entry, State state);
+
+	  private:
+		Settings m_settings;
+		AthiVegam::Graphics::ThumbnailRenderer m_renderer;
+		AthiVegam::Graphics::TextureHandle m_placeholder;
+		AthiVegam::Managers::JobCounter m_jobs;
+
+		std::unordered_map<std::string, std::shared_ptr<Entry>>
+		    m_entries;
+		// Waiting for their mesh, in request order.
+		std::deque<std::shared_ptr<Entry>> m_pending;
+		// Rendered, by ticket.
+		std::unordered_map<uint64_t, std::shared_ptr<Entry>>
+		    m_readbacks;
+		uint64_t m_nextTicket = 0;
+
+		// Hashed by the job workers, for Update().
+		std::mutex m_mutex;
+		std::vector<std::shared_ptr<Entry>> m_hashed;
+	};
+} // namespace Parugu
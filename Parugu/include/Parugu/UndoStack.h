@@ -0,0 +1,194 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Parugu
+{
+	// The editor's undo history. Edits are grouped into
+	// transactions; each entry keeps, per property the
+	// transaction changed, only the bytes that differ
+	// before and after it rather than a copy of the scene.
+	//
+	// Transactions with the same non-zero coalesce key
+	// that follow each other closely, such as the
+	// per-frame commits of a gizmo drag, merge into one
+	// entry. Entries past the memory budget are written to
+	// a spill file, oldest first, and read back when undo
+	// reaches them.
+	//
+	// Properties are addressed by an object and a property
+	// id, and read and written as bytes through the
+	// callbacks; values may change in size.
+	class UndoStack
+	{
+	  public:
+		struct Properties
+		{
+			std::function<void(uint32_t object,
+			                   uint32_t property,
+			                   std::vector<uint8_t>& value)>
+			    read;
+			std::function<void(uint32_t object,
+			                   uint32_t property,
+			                   std::span<const uint8_t> value)>
+			    write;
+		};
+
+		struct Settings
+		{
+			// Of entries kept in memory; older ones spill.
+			size_t memoryBudget = 16 << 20;
+			// Older entries are dropped.
+			uint32_t maxEntries = 4096;
+			// Longest pause between coalesced commits.
+			uint32_t coalesceMs = 1000;
+			// Empty for one in the temp directory.
+			std::string spillPath;
+		};
+
+		explicit UndoStack(Properties properties);
+		UndoStack(Properties properties,
+		          const Settings& settings);
+		~UndoStack();
+
+		UndoStack(const UndoStack&) = delete;
+		UndoStack& operator=(const UndoStack&) = delete;
+
+		// Transactions nest; the outermost one names the
+		// entry and commits it.
+		void Begin(std::string_view name,
+		           uint64_t coalesceKey = 0);
+		// Before changing a property inside a transaction.
+		void Touch(uint32_t object, uint32_t property);
+		// Records what changed since the touches. Nothing
+		// is recorded if nothing did.
+		void Commit();
+		// Restores the touched properties and drops the
+		// transaction, however deeply nested.
+		void Cancel();
+		inline bool IsRecording() const { return m_depth > 0; }
+
+		// The next transaction starts a new entry even if
+		// it coalesces with the last, e.g. once a drag
+		// ends.
+		inline void EndCoalescing() { m_coalescing = false; }
+
+		bool Undo();
+		bool Redo();
+		inline bool CanUndo() const { return m_position > 0; }
+		inline bool CanRedo() const
+		{
+			return m_position < m_entries.size();
+		}
+		// Of the entry Undo() or Redo() would apply.
+		std::string_view GetUndoName() const;
+		std::string_view GetRedoName() const;
+
+		void Clear();
+
+		inline size_t GetCount() const
+		{
+			return m_entries.size();
+		}
+		// Of entries in memory, and in the spill file.
+		inline size_t GetMemoryUsage() const { return m_memory; }
+		inline uint64_t GetSpilledSize() const
+		{
+			return m_spillEnd;
+		}
+
+	  private:
+		// A property's differing bytes: beforeSize bytes at
+		// offset became afterSize bytes.
+		struct Change
+		{
+			uint32_t object;
+			uint32_t property;
+			uint32_t offset;
+			uint32_t beforeSize;
+			uint32_t afterSize;
+		};
+
+		struct Entry
+		{
+			std::string name;
+			uint64_t coalesceKey = 0;
+			std::chrono::steady_clock::time_point time;
+			std::vector<Change> changes;
+			// Each change's before bytes, then after bytes.
+			std::vector<uint8_t> data;
+			// Of changes and data, when in the spill file.
+			bool spilled = false;
+			uint32_t changeCount = 0;
+			uint64_t spillOffset = 0;
+			uint64_t dataSize = 0;
+
+			size_t GetMemory() const;
+		};
+
+		struct Touched
+		{
+			uint32_t object;
+			uint32_t property;
+			// Of the value before, in m_before.
+			uint32_t offset;
+			uint32_t size;
+		};
+
+		void AddChange(Entry& entry, uint32_t object,
+		               uint32_t property,
+		               std::span<const uint8_t> before,
+		               std::span<const uint8_t> after);
+		// Replaces the bytes a change wrote with the ones it
+		// replaced, or the other way around.
+		void Apply(const Entry& entry, bool undo);
+		bool Splice(std::vector<uint8_t>& value,
+		            const Change& change, const uint8_t* bytes,
+		            bool undo) const;
+		bool Coalesce(Entry& entry);
+		void Push(Entry entry);
+		void Truncate(size_t count);
+		void Trim();
+		bool Spill(Entry& entry);
+		bool Restore(Entry& entry);
+
+	  private:
+		Properties m_properties;
+		Settings m_settings;
+
+		std::deque<Entry> m_entries;
+		// Entries before it are done, from it on undone.
+		size_t m_position = 0;
+		size_t m_memory = 0;
+		bool m_coalescing = false;
+
+		// The open transaction.
+		uint32_t m_depth = 0;
+		std::string m_name;
+		uint64_t m_coalesceKey = 0;
+		std::vector<Touched> m_touched;
+		std::unordered_map<uint64_t, uint32_t> m_touchedIndex;
+		std::vector<uint8_t> m_before;
+
+		std::fstream m_spillFile;
+		std::string m_spillPath;
+		// Spilled entries are the oldest, so the file is
+		// one run from the start; rewound once none are.
+		uint64_t m_spillEnd = 0;
+		size_t m_spilledCount = 0;
+
+		// Scratch.
+		std::vector<uint8_t> m_value;
+		std::vector<uint8_t> m_other;
+	};
+} // namespace Parugu
@@ -0,0 +1,9 @@
+#version 410 core
+out vec4 outColor;
+in vec3 vpos;
+uniform vec3 color = vec3(0.0f);
+void main()
+{
+    //outColor = vec4(color, 1.0);
+    outColor = vec4(vpos, 1.0);
+}
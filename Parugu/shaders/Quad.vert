@@ -0,0 +1,9 @@
+#version 410 core
+layout (location = 0) in vec3 position;
+out vec3 vpos;
+uniform vec2 offset = vec2(0.5f);
+void main()
+{
+    vpos = position + vec3(offset, 0);
+    gl_Position = vec4(position, 1.0f);
+}
@@ -1,11 +1,18 @@
 #include "Parugu/Editor.h"
 
+#include "AthiVegam/Core/CVar.h"
+#include "AthiVegam/Core/Serialize.h"
 #include "AthiVegam/Log.h"
 #include "AthiVegam/Main.h"
 #include "Athivegam/Input/Controller.h"
 #include "Athivegam/Input/Keyboard.h"
 #include "Athivegam/Input/Mouse.h"
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
 using namespace AthiVegam;
 
 std::unique_ptr<App> CreateApp()
@@ -15,10 +22,71 @@ std::unique_ptr<App> CreateApp()
 
 namespace Parugu
 {
-	Editor::~Editor()
+	namespace
+	{
+		Core::CVar<float> keySpeedCVar("editor.keySpeed", 0.06f,
+		                               "Key movement per second");
+
+		Core::CVar<float> autosaveCVar(
+		    "editor.autosaveSeconds", 30.0f,
+		    "Seconds between autosaves; 0 disables them");
+
+		// Undo properties of the world's objects.
+		constexpr uint32_t TransformProperty = 0;
+
+		constexpr const char* AutosavePath = "autosave.sav";
+		constexpr uint32_t AutosaveVersion = 1;
+
+		// The editor never removes objects, so their ids
+		// run from 0 and index the transforms.
+		struct AutosaveData
+		{
+			std::vector<
+			    Graphics::RenderCommands::InstanceTransform>
+			    transforms;
+			VEGAM_SERIAL_FIELDS(&AutosaveData::transforms)
+		};
+	} // namespace
+
+	Editor::Editor()
+	    : m_undo({[this](uint32_t object, uint32_t property,
+	                     std::vector<uint8_t>& value) {
+		              VEGAM_ASSERT(property == TransformProperty,
+		                           "Unknown property");
+		              const auto& transform =
+		                  m_world.Get(object).transform;
+		              const auto* bytes =
+		                  reinterpret_cast<const uint8_t*>(
+		                      &transform);
+		              value.assign(bytes,
+		                           bytes + sizeof(transform));
+	              },
+	              [this](uint32_t object, uint32_t property,
+	                     std::span<const uint8_t> value) {
+		              Graphics::RenderCommands::InstanceTransform
+		                  transform;
+		              if (property != TransformProperty
+		                  || value.size() != sizeof(transform))
+		              {
+			              return;
+		              }
+		              std::memcpy(&transform, value.data(),
+		                          sizeof(transform));
+		              m_world.SetTransform(object, transform);
+		              m_viewport.Invalidate();
+		              ++m_edits;
+	              }})
+	{
+	}
+
+	Editor::~Editor() {}
+
+	EngineConfig Editor::GetEngineConfig() const
 	{
-		m_shader.reset();
-		m_mesh.reset();
+		EngineConfig config;
+		// Left open all day; only redraw on input.
+		config.renderOnDemand = true;
+		return config;
 	}
 
 	void Editor::Initialize()
@@ -32,51 +100,228 @@ namespace Parugu
 		// auto mesh =
 		// std::make_shared<Graphics::Mesh>(&verts[0], 3,
 		// 3);
-		m_mesh = std::make_shared<Graphics::Mesh>(
-		    &verts[0], 4, 3, &elements[0], 6);
-
-		// Test Shader
-		const char* vertShader = R"(
-                    #version 410 core
-                    layout (location = 0) in vec3 position;
-                    out vec3 vpos;
-                    uniform vec2 offset = vec2(0.5f);
-                    void main()
-                    {
-                        vpos = position + vec3(offset, 0);
-                        gl_Position = vec4(position, 1.0f);
-                    }
-                )";
-		const char* fragShader = R"(
-                    #version 410 core
-                    out vec4 outColor;
-                    in vec3 vpos;
-                    uniform vec3 color = vec3(0.0f);
-                    void main()
-                    {
-                        //outColor = vec4(color, 1.0);
-                        outColor = vec4(vpos, 1.0);
-                    }
-                )";
-		m_shader = std::make_shared<Graphics::Shader>(
-		    vertShader, fragShader);
-		m_shader->SetUniformFloat3("color", 1.f, 0.f, 0.f);
+		auto& resources =
+		    Engine::Instance().GetResourceManager();
+		m_mesh = resources.CreateMesh(&verts[0], 4, 3,
+		                              &elements[0], 6);
+		// The quad is drawn straight to clip space.
+		Scene::SceneObject quad;
+		quad.mesh = m_mesh;
+		quad.bounds = resources.GetMesh(m_mesh)->GetBounds();
+		m_world.Add(quad);
+		LoadAutosave();
+
+		// Test Shader, reloaded when the files are saved.
+		m_shader = resources.CreateShaderFromFiles(
+		    "shaders/Quad.vert", "shaders/Quad.frag");
+		SetShaderUniforms();
+		resources.SetShaderReloadCallback(
+		    [this](Graphics::ShaderHandle handle) {
+			    if (handle == m_shader)
+			    {
+				    SetShaderUniforms();
+				    m_viewport.Invalidate();
+			    }
+		    });
+
+		m_draws.Add(Graphics::RenderCommands::RenderMesh{
+		    m_mesh, m_shader});
+		Engine::Instance().GetRenderManager().AddRetainedList(
+		    m_draws);
+
+		m_thumbnails.Initialize({});
+		Engine::Instance().GetWindow().SetUiCallback([this] {
+			m_viewport.DrawWindow("Viewport");
+			m_perfCompare.Draw("Performance Comparison");
+		});
+	}
+
+	void Editor::SetShaderUniforms()
+	{
+		auto* shader =
+		    Engine::Instance().GetResourceManager().GetShader(
+		        m_shader);
+		if (!shader)
+		{
+			return;
+		}
+		const auto color =
+		    shader->GetUniform<Graphics::Float3>("color");
+		shader->Set(color, {1.f, 0.f, 0.f});
 	}
 
 	void Editor::Shutdown()
 	{
+		Engine::Instance().GetWindow().SetUiCallback(nullptr);
+		Autosave();
+		m_saves.Wait();
+		m_viewport.Destroy();
+		m_thumbnails.Shutdown();
+		auto& resources =
+		    Engine::Instance().GetResourceManager();
+		resources.SetShaderReloadCallback(nullptr);
+		Engine::Instance().GetRenderManager().RemoveRetainedList(
+		    m_draws);
+		m_draws.Clear();
+		resources.DestroyShader(m_shader);
+		resources.DestroyMesh(m_mesh);
+		m_undo.Clear();
+		m_world.Clear();
+
 		VEGAM_WARN("Editor Shutdown!");
 	}
 
-	void Editor::Update() {}
+	void Editor::Update(float deltaTime)
+	{
+		using Input::KeyCode;
+		using Input::Keyboard;
+		const bool control =
+		    Keyboard::Key(KeyCode::AV_KEY_LCTRL)
+		    || Keyboard::Key(KeyCode::AV_KEY_RCTRL);
+		const bool shift =
+		    Keyboard::Key(KeyCode::AV_KEY_LSHIFT)
+		    || Keyboard::Key(KeyCode::AV_KEY_RSHIFT);
+		if (control && !m_undo.IsRecording())
+		{
+			if (Keyboard::KeyDown(KeyCode::AV_KEY_Z) && !shift)
+			{
+				m_undo.Undo();
+			}
+			else if (Keyboard::KeyDown(KeyCode::AV_KEY_Y)
+			         || Keyboard::KeyDown(KeyCode::AV_KEY_Z))
+			{
+				m_undo.Redo();
+			}
+		}
+
+		m_sinceAutosave += deltaTime;
+		const auto autosaveSeconds = autosaveCVar.Get();
+		if (autosaveSeconds > 0.0f
+		    && m_sinceAutosave >= autosaveSeconds)
+		{
+			m_sinceAutosave = 0.0f;
+			Autosave();
+		}
+
+		// The scene is drawn in the viewport panel.
+		const auto width = m_viewport.GetImageWidth();
+		const auto height = m_viewport.GetImageHeight();
+
+		// Dragging the picked object moves it, as one undo
+		// entry however many frames the drag lasts.
+		const auto left = Input::MouseButton::AV_MOUSE_LEFT;
+		if (Input::Mouse::ButtonUp(left))
+		{
+			m_dragged = Scene::World::InvalidObject;
+			m_undo.EndCoalescing();
+		}
+		else if (m_dragged != Scene::World::InvalidObject
+		         && width > 0.0f && height > 0.0f
+		         && (Input::Mouse::DX() != 0
+		             || Input::Mouse::DY() != 0))
+		{
+			Drag(2.0f * Input::Mouse::DX() / width,
+			     -2.0f * Input::Mouse::DY() / height);
+		}
+
+		float u = 0.0f;
+		float v = 0.0f;
+		if (!Input::Mouse::ButtonDown(left)
+		    || !m_viewport.MapToImage(
+		        static_cast<float>(Input::Mouse::X()) + 0.5f,
+		        static_cast<float>(Input::Mouse::Y()) + 0.5f, u,
+		        v))
+		{
+			return;
+		}
+
+		// A ray through the clicked pixel, into the screen
+		// of the clip space the scene is drawn in.
+		const Graphics::Float3 origin{2.0f * u - 1.0f,
+		                              1.0f - 2.0f * v, -1.0f};
+		if (const auto hit =
+		        m_world.Raycast(origin, {0.0f, 0.0f, 1.0f}, 2.0f))
+		{
+			VEGAM_INFO("Picked object {}", hit->object);
+			m_dragged = hit->object;
+		}
+	}
+
+	void Editor::Drag(float dx, float dy)
+	{
+		m_undo.Begin("Move", m_dragged + 1ull);
+		m_undo.Touch(m_dragged, TransformProperty);
+		auto transform = m_world.Get(m_dragged).transform;
+		transform.m[12] += dx;
+		transform.m[13] += dy;
+		m_world.SetTransform(m_dragged, transform);
+		m_undo.Commit();
+		m_viewport.Invalidate();
+		++m_edits;
+	}
+
+	void Editor::Autosave()
+	{
+		if (m_edits == m_savedEdits)
+		{
+			return;
+		}
+		m_savedEdits = m_edits;
+
+		// Only the copy is taken here; serializing,
+		// compressing and writing run on a worker.
+		auto data = std::make_shared<AutosaveData>();
+		data->transforms.reserve(m_world.GetCount());
+		for (uint32_t i = 0; i < m_world.GetCount(); ++i)
+		{
+			data->transforms.push_back(
+			    m_world.Get(i).transform);
+		}
+		m_saves.Write(AutosavePath,
+		              [data](std::vector<uint8_t>& bytes) {
+			              Core::Serial::Save(*data, bytes,
+			                                 AutosaveVersion);
+		              });
+	}
+
+	void Editor::LoadAutosave()
+	{
+		std::vector<uint8_t> bytes;
+		if (!Core::SaveWriter::Read(AutosavePath, bytes))
+		{
+			return;
+		}
+		Core::Serial::View<AutosaveData> data;
+		uint32_t version = 0;
+		if (!Core::Serial::Open(bytes.data(), bytes.size(),
+		                        data, &version)
+		    || version != AutosaveVersion)
+		{
+			VEGAM_WARN("Ignoring autosave {}", AutosavePath);
+			return;
+		}
+		const auto transforms =
+		    data.Get<&AutosaveData::transforms>();
+		const auto count = std::min<size_t>(
+		    transforms.size(), m_world.GetCount());
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			m_world.SetTransform(i, transforms[i]);
+		}
+		VEGAM_INFO("Restored {} objects from {}", count,
+		           AutosavePath);
+	}
 
-	void Editor::Render()
+	void Editor::Render(float alpha)
 	{
-		auto rc = std::make_unique<
-		    Graphics::RenderCommands::RenderMesh>(m_mesh,
-		                                          m_shader);
-		Engine::Instance().GetRenderManager().Submit(
-		    std::move(rc));
-		Engine::Instance().GetRenderManager().Flush();
+		m_thumbnails.Update();
+		// Frames the viewport skips keep its last image.
+		if (m_viewport.BeginScene())
+		{
+			auto& renderer = Engine::Instance().GetRenderManager();
+			renderer.Clear();
+			renderer.Flush();
+			m_viewport.EndScene();
+		}
 	}
 } // namespace Parugu
@@ -0,0 +1,492 @@
+#include "Parugu/PerfCompare.h"
+
+#include "AthiVegam/Core/Json.h"
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Log.h"
+#include "external/imgui/imgui.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <utility>
+
+using namespace AthiVegam;
+
+namespace Parugu
+{
+	namespace
+	{
+		constexpr uint32_t HistogramBins = 48;
+		// Changes smaller than this are not colored.
+		constexpr double NoisePercent = 1.0;
+
+		const char* SlotNames[] = {"A", "B"};
+		const ImVec4 BetterColor{0.4f, 0.9f, 0.4f, 1.0f};
+		const ImVec4 WorseColor{1.0f, 0.45f, 0.4f, 1.0f};
+
+		// Nearest-rank percentile of sorted samples, as the
+		// benchmark computes it.
+		double Percentile(const std::vector<double>& sorted,
+		                  double percent)
+		{
+			const auto rank = static_cast<size_t>(std::lround(
+			    percent / 100.0 * (sorted.size() - 1)));
+			return sorted[rank];
+		}
+
+		// Negative when missing.
+		void DrawValue(double value)
+		{
+			ImGui::TableNextColumn();
+			if (value < 0.0)
+			{
+				ImGui::TextDisabled("-");
+			}
+			else
+			{
+				ImGui::Text("%.3f", value);
+			}
+		}
+
+		// Lower is better for everything compared.
+		void DrawDelta(double a, double b)
+		{
+			const auto delta = b - a;
+			const auto percent =
+			    a != 0.0 ? delta / a * 100.0 : 0.0;
+			ImGui::TableNextColumn();
+			const auto color =
+			    std::abs(percent) < NoisePercent
+			        ? ImGui::GetStyleColorVec4(ImGuiCol_Text)
+			    : delta < 0.0 ? BetterColor
+			                  : WorseColor;
+			ImGui::TextColored(color, "%+.3f", delta);
+			ImGui::TableNextColumn();
+			ImGui::TextColored(color, "%+.1f%%", percent);
+		}
+	} // namespace
+
+	PerfCompare::~PerfCompare()
+	{
+		Engine::Instance().GetJobManager().Wait(m_jobs);
+	}
+
+	void PerfCompare::Load(uint32_t slot, const std::string& path)
+	{
+		VEGAM_ASSERT(slot < 2, "Slot out of range");
+		const auto size =
+		    std::min(path.size(), m_paths[slot].size() - 1);
+		std::copy_n(path.begin(), size, m_paths[slot].begin());
+		m_paths[slot][size] = '\0';
+
+		const auto request = ++m_requests[slot];
+		m_loading[slot] = true;
+		auto shared = std::make_shared<std::string>(path);
+		Engine::Instance().GetJobManager().Schedule(
+		    [this, slot, request, shared] {
+			    auto capture = Read(*shared);
+			    {
+				    std::lock_guard lock(m_mutex);
+				    m_loaded[slot] = std::move(capture);
+				    m_loadedRequests[slot] = request;
+			    }
+			    Engine::Instance().RequestRedraw();
+		    },
+		    &m_jobs);
+	}
+
+	std::shared_ptr<PerfCompare::Capture>
+	PerfCompare::Read(const std::string& path)
+	{
+		VEGAM_PROFILE_SCOPE("PerfCompare::Read");
+		auto capture = std::make_shared<Capture>();
+		capture->path = path;
+
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			capture->error = "Cannot open the file";
+			return capture;
+		}
+		const std::string text(
+		    (std::istreambuf_iterator<char>(file)),
+		    std::istreambuf_iterator<char>());
+		Core::Json json;
+		if (!Core::Json::Parse(text, json, capture->error))
+		{
+			return capture;
+		}
+
+		if (const auto& events = json["traceEvents"];
+		    events.GetType() == Core::Json::Type::Array)
+		{
+			// Microseconds throughout.
+			std::vector<double> frameStarts;
+			for (const auto& event : events.GetChildren())
+			{
+				if (event["ph"].GetString() != "X")
+				{
+					continue;
+				}
+				const auto& name = event["name"].GetString();
+				capture->zones[name] +=
+				    event["dur"].GetNumber() / 1000.0;
+				if (name == FrameZone)
+				{
+					frameStarts.push_back(
+					    event["ts"].GetNumber());
+				}
+			}
+			std::sort(frameStarts.begin(), frameStarts.end());
+			for (size_t i = 1; i < frameStarts.size(); ++i)
+			{
+				capture->frameTimes.push_back(
+				    (frameStarts[i] - frameStarts[i - 1])
+				    / 1000.0);
+			}
+			capture->frames = std::max(
+			    static_cast<uint32_t>(frameStarts.size()), 1u);
+			for (auto& [name, milliseconds] : capture->zones)
+			{
+				milliseconds /= capture->frames;
+			}
+		}
+		else if (const auto& times = json["frameTimeMs"];
+		         times.GetType() == Core::Json::Type::Object)
+		{
+			capture->frames = static_cast<uint32_t>(
+			    json["frames"].GetNumber());
+			capture->frameStats = {
+			    times["mean"].GetNumber(),
+			    times["p50"].GetNumber(),
+			    times["p95"].GetNumber(),
+			    times["p99"].GetNumber(),
+			    times["max"].GetNumber()};
+			capture->drawCalls =
+			    json["drawCallsPerFrame"].GetNumber(-1.0);
+			capture->stateChanges =
+			    json["stateChangesPerFrame"].GetNumber(-1.0);
+			capture->glCalls =
+			    json["glCallsPerFrame"].GetNumber(-1.0);
+			for (const auto& zone : json["zones"].GetChildren())
+			{
+				capture->zones[zone["name"].GetString()] =
+				    zone["msPerFrame"].GetNumber();
+			}
+			for (const auto& time :
+			     json["frameTimesMs"].GetChildren())
+			{
+				capture->frameTimes.push_back(time.GetNumber());
+			}
+			return capture;
+		}
+		else
+		{
+			capture->error = "Neither a profiler capture nor "
+			                 "benchmark results";
+			return capture;
+		}
+
+		if (!capture->frameTimes.empty())
+		{
+			auto sorted = capture->frameTimes;
+			std::sort(sorted.begin(), sorted.end());
+			capture->frameStats = {
+			    std::accumulate(sorted.begin(), sorted.end(),
+			                    0.0)
+			        / static_cast<double>(sorted.size()),
+			    Percentile(sorted, 50), Percentile(sorted, 95),
+			    Percentile(sorted, 99), sorted.back()};
+		}
+		return capture;
+	}
+
+	void PerfCompare::Poll()
+	{
+		bool changed = false;
+		{
+			std::lock_guard lock(m_mutex);
+			for (uint32_t slot = 0; slot < 2; ++slot)
+			{
+				if (!m_loaded[slot])
+				{
+					continue;
+				}
+				if (m_loadedRequests[slot] == m_requests[slot])
+				{
+					if (!m_loaded[slot]->error.empty())
+					{
+						VEGAM_WARN("Cannot compare {}: {}",
+						           m_loaded[slot]->path,
+						           m_loaded[slot]->error);
+					}
+					m_captures[slot] = std::move(m_loaded[slot]);
+					m_loading[slot] = false;
+					changed = true;
+				}
+				m_loaded[slot].reset();
+			}
+		}
+		if (changed)
+		{
+			Compare();
+		}
+	}
+
+	void PerfCompare::Compare()
+	{
+		VEGAM_PROFILE_SCOPE("PerfCompare::Compare");
+		m_zones.clear();
+		m_histograms = {};
+		const auto& a = m_captures[0];
+		const auto& b = m_captures[1];
+		if (!a || !b || !a->error.empty() || !b->error.empty())
+		{
+			return;
+		}
+
+		for (const auto& [name, milliseconds] : a->zones)
+		{
+			const auto it = b->zones.find(name);
+			m_zones.push_back(
+			    {name, milliseconds,
+			     it != b->zones.end() ? it->second : -1.0});
+		}
+		for (const auto& [name, milliseconds] : b->zones)
+		{
+			if (!a->zones.contains(name))
+			{
+				m_zones.push_back({name, -1.0, milliseconds});
+			}
+		}
+		std::sort(m_zones.begin(), m_zones.end(),
+		          [](const ZoneDelta& l, const ZoneDelta& r) {
+			          return std::abs(std::max(l.b, 0.0)
+			                          - std::max(l.a, 0.0))
+			                 > std::abs(std::max(r.b, 0.0)
+			                            - std::max(r.a, 0.0));
+		          });
+
+		// Shared bins; frames past them land in the last.
+		m_histogramMaxMs = static_cast<float>(
+		    1.25 * std::max(a->frameStats.p99,
+		                    b->frameStats.p99));
+		m_histogramPeak = 0.0f;
+		for (uint32_t slot = 0; slot < 2; ++slot)
+		{
+			const auto& times = m_captures[slot]->frameTimes;
+			if (times.empty() || m_histogramMaxMs <= 0.0f)
+			{
+				continue;
+			}
+			auto& bins = m_histograms[slot];
+			bins.assign(HistogramBins, 0.0f);
+			const auto weight =
+			    1.0f / static_cast<float>(times.size());
+			for (const auto time : times)
+			{
+				const auto bin = std::min(
+				    static_cast<uint32_t>(
+				        std::max(time, 0.0) / m_histogramMaxMs
+				        * HistogramBins),
+				    HistogramBins - 1);
+				bins[bin] += weight;
+			}
+			m_histogramPeak = std::max(
+			    m_histogramPeak,
+			    *std::max_element(bins.begin(), bins.end()));
+		}
+	}
+
+	void PerfCompare::Draw(const char* title)
+	{
+		Poll();
+		ImGui::SetNextWindowSize(ImVec2(560.0f, 640.0f),
+		                         ImGuiCond_FirstUseEver);
+		if (!ImGui::Begin(title))
+		{
+			ImGui::End();
+			return;
+		}
+
+		for (uint32_t slot = 0; slot < 2; ++slot)
+		{
+			ImGui::PushID(static_cast<int>(slot));
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted(SlotNames[slot]);
+			ImGui::SameLine();
+			ImGui::SetNextItemWidth(-120.0f);
+			const bool entered = ImGui::InputTextWithHint(
+			    "##path", "Capture or benchmark JSON",
+			    m_paths[slot].data(), m_paths[slot].size(),
+			    ImGuiInputTextFlags_EnterReturnsTrue);
+			ImGui::SameLine();
+			if ((ImGui::Button("Load") || entered)
+			    && m_paths[slot][0] != '\0')
+			{
+				Load(slot, m_paths[slot].data());
+			}
+			ImGui::SameLine();
+			const auto& capture = m_captures[slot];
+			if (m_loading[slot])
+			{
+				ImGui::TextDisabled("Loading");
+			}
+			else if (capture && !capture->error.empty())
+			{
+				ImGui::TextColored(WorseColor, "Failed");
+				if (ImGui::IsItemHovered())
+				{
+					ImGui::SetTooltip("%s",
+					                  capture->error.c_str());
+				}
+			}
+			else if (capture)
+			{
+				ImGui::Text("%u frames", capture->frames);
+			}
+			ImGui::PopID();
+		}
+
+		const auto& a = m_captures[0];
+		const auto& b = m_captures[1];
+		if (a && b && a->error.empty() && b->error.empty())
+		{
+			DrawSummary();
+			DrawDistribution();
+			DrawZones();
+		}
+		ImGui::End();
+	}
+
+	void PerfCompare::DrawSummary()
+	{
+		if (!ImGui::CollapsingHeader(
+		        "Summary", ImGuiTreeNodeFlags_DefaultOpen)
+		    || !ImGui::BeginTable(
+		        "##summary", 5,
+		        ImGuiTableFlags_RowBg
+		            | ImGuiTableFlags_BordersInnerV))
+		{
+			return;
+		}
+		ImGui::TableSetupColumn("Per frame");
+		ImGui::TableSetupColumn("A");
+		ImGui::TableSetupColumn("B");
+		ImGui::TableSetupColumn("Delta");
+		ImGui::TableSetupColumn("%");
+		ImGui::TableHeadersRow();
+
+		const auto row = [](const char* name, double a,
+		                    double b) {
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(name);
+			DrawValue(a);
+			DrawValue(b);
+			// Not in both captures.
+			if (a >= 0.0 && b >= 0.0)
+			{
+				DrawDelta(a, b);
+			}
+		};
+		const auto& a = *m_captures[0];
+		const auto& b = *m_captures[1];
+		row("Mean ms", a.frameStats.mean, b.frameStats.mean);
+		row("p50 ms", a.frameStats.p50, b.frameStats.p50);
+		row("p95 ms", a.frameStats.p95, b.frameStats.p95);
+		row("p99 ms", a.frameStats.p99, b.frameStats.p99);
+		row("Max ms", a.frameStats.max, b.frameStats.max);
+		row("Draw calls", a.drawCalls, b.drawCalls);
+		row("State changes", a.stateChanges, b.stateChanges);
+		row("GL calls", a.glCalls, b.glCalls);
+		ImGui::EndTable();
+	}
+
+	void PerfCompare::DrawDistribution()
+	{
+		if (!ImGui::CollapsingHeader(
+		        "Frame times", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			return;
+		}
+		ImGui::TextDisabled("0 to %.2f ms, fraction of frames",
+		                    m_histogramMaxMs);
+		const auto width =
+		    (ImGui::GetContentRegionAvail().x
+		     - ImGui::GetStyle().ItemSpacing.x)
+		    / 2.0f;
+		for (uint32_t slot = 0; slot < 2; ++slot)
+		{
+			if (slot > 0)
+			{
+				ImGui::SameLine();
+			}
+			const auto& bins = m_histograms[slot];
+			if (bins.empty())
+			{
+				// Old benchmark results have no frame times.
+				ImGui::BeginGroup();
+				ImGui::TextDisabled("%s: no frame times",
+				                    SlotNames[slot]);
+				ImGui::Dummy(ImVec2(width, 0.0f));
+				ImGui::EndGroup();
+				continue;
+			}
+			ImGui::PushID(static_cast<int>(slot));
+			ImGui::PlotHistogram(
+			    "##frames", bins.data(),
+			    static_cast<int>(bins.size()), 0,
+			    SlotNames[slot], 0.0f, m_histogramPeak,
+			    ImVec2(width, 96.0f));
+			ImGui::PopID();
+		}
+	}
+
+	void PerfCompare::DrawZones()
+	{
+		if (!ImGui::CollapsingHeader(
+		        "Zones", ImGuiTreeNodeFlags_DefaultOpen)
+		    || !ImGui::BeginTable(
+		        "##zones", 5,
+		        ImGuiTableFlags_RowBg
+		            | ImGuiTableFlags_BordersInnerV
+		            | ImGuiTableFlags_ScrollY,
+		        ImVec2(0.0f, ImGui::GetContentRegionAvail().y)))
+		{
+			return;
+		}
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn(
+		    "Zone, ms per frame",
+		    ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("A");
+		ImGui::TableSetupColumn("B");
+		ImGui::TableSetupColumn("Delta");
+		ImGui::TableSetupColumn("%");
+		ImGui::TableHeadersRow();
+
+		ImGuiListClipper clipper;
+		clipper.Begin(static_cast<int>(m_zones.size()));
+		while (clipper.Step())
+		{
+			for (auto i = clipper.DisplayStart;
+			     i < clipper.DisplayEnd; ++i)
+			{
+				const auto& zone = m_zones[i];
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(zone.name.c_str());
+				DrawValue(zone.a);
+				DrawValue(zone.b);
+				DrawDelta(std::max(zone.a, 0.0),
+				          std::max(zone.b, 0.0));
+			}
+		}
+		ImGui::EndTable();
+	}
+} // namespace Parugu
@@ -0,0 +1,368 @@
+#include "Parugu/Thumbnails.h"
+
+#include "AthiVegam/Core/Profiler.h"
+#include "AthiVegam/Core/StringId.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Log.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <utility>
+
+using namespace AthiVegam;
+
+namespace Parugu
+{
+	namespace
+	{
+		// Behind everything the scene asks for.
+		constexpr float MeshPriority = 0.0f;
+
+		Graphics::TextureDesc PreviewDesc(uint32_t size)
+		{
+			Graphics::TextureDesc desc;
+			desc.width = size;
+			desc.height = size;
+			desc.wrap = Graphics::TextureWrap::Clamp;
+			return desc;
+		}
+
+		// A checkerboard of greys.
+		std::vector<uint8_t> PlaceholderPixels(uint32_t size)
+		{
+			std::vector<uint8_t> pixels(size_t{size} * size * 4);
+			const auto cell = std::max(size / 8, 1u);
+			for (uint32_t y = 0; y < size; ++y)
+			{
+				for (uint32_t x = 0; x < size; ++x)
+				{
+					const uint8_t grey =
+					    ((x / cell + y / cell) & 1) ? 96 : 64;
+					auto* texel =
+					    &pixels[(size_t{y} * size + x) * 4];
+					texel[0] = texel[1] = texel[2] = grey;
+					texel[3] = 255;
+				}
+			}
+			return pixels;
+		}
+
+		bool ReadFile(const std::string& path,
+		              std::vector<uint8_t>& data)
+		{
+			std::ifstream file(path, std::ios::binary);
+			if (!file)
+			{
+				return false;
+			}
+			data.assign(std::istreambuf_iterator<char>(file),
+			            std::istreambuf_iterator<char>());
+			return !file.bad();
+		}
+
+		struct CacheWrite
+		{
+			std::string path;
+			std::vector<uint8_t> pixels;
+		};
+	} // namespace
+
+	bool Thumbnails::Initialize(const Settings& settings)
+	{
+		m_settings = settings;
+		std::error_code error;
+		std::filesystem::create_directories(
+		    m_settings.cacheDirectory, error);
+		if (error)
+		{
+			VEGAM_WARN("Cannot create {}: {}; previews are not "
+			           "cached",
+			           m_settings.cacheDirectory,
+			           error.message());
+		}
+
+		if (!m_renderer.Initialize(
+		        static_cast<int>(m_settings.size)))
+		{
+			return false;
+		}
+		m_renderer.SetCallback([this](const uint8_t* pixels,
+		                              int width, int height,
+		                              uint64_t ticket) {
+			const auto it = m_readbacks.find(ticket);
+			if (it == m_readbacks.end())
+			{
+				return;
+			}
+			const auto entry = std::move(it->second);
+			m_readbacks.erase(it);
+
+			const auto size = size_t{static_cast<uint32_t>(width)}
+			                  * static_cast<uint32_t>(height) * 4;
+			auto write = std::make_shared<CacheWrite>();
+			write->path = entry->cachePath;
+			write->pixels.assign(pixels, pixels + size);
+			Upload(*entry, write->pixels);
+			Engine::Instance().GetJobManager().Schedule(
+			    [write] {
+				    // Written aside and renamed, so a crash
+				    // never leaves a partial preview.
+				    const auto temporary = write->path + ".tmp";
+				    {
+					    std::ofstream file(temporary,
+					                       std::ios::binary);
+					    file.write(reinterpret_cast<const char*>(
+					                   write->pixels.data()),
+					               static_cast<std::streamsize>(
+					                   write->pixels.size()));
+					    if (!file)
+					    {
+						    return;
+					    }
+				    }
+				    std::error_code renameError;
+				    std::filesystem::rename(temporary, write->path,
+				                            renameError);
+			    },
+			    &m_jobs);
+		});
+
+		auto& resources = Engine::Instance().GetResourceManager();
+		m_placeholder = resources.CreateTexturePlaceholder();
+		resources.QueueTextureUpload(
+		    {m_placeholder, PreviewDesc(m_settings.size), 0,
+		     PlaceholderPixels(m_settings.size)});
+		return true;
+	}
+
+	void Thumbnails::Shutdown()
+	{
+		auto& engine = Engine::Instance();
+		m_renderer.Shutdown();
+		engine.GetJobManager().Wait(m_jobs);
+
+		auto& assets = engine.GetAssetManager();
+		auto& resources = engine.GetResourceManager();
+		for (auto& [source, entry] : m_entries)
+		{
+			if (entry->meshRequested)
+			{
+				assets.Release(entry->mesh);
+			}
+			resources.DestroyTexture(entry->texture);
+		}
+		m_entries.clear();
+		m_pending.clear();
+		m_readbacks.clear();
+		m_hashed.clear();
+		if (m_placeholder.IsValid())
+		{
+			resources.DestroyTexture(m_placeholder);
+			m_placeholder = {};
+		}
+	}
+
+	Graphics::TextureHandle
+	Thumbnails::Get(const std::string& source,
+	                Assets::AssetId mesh,
+	                Graphics::MaterialHandle material)
+	{
+		auto& entry = m_entries[source];
+		if (!entry)
+		{
+			entry = std::make_shared<Entry>();
+			entry->source = source;
+			entry->mesh = mesh;
+			entry->material = material;
+			entry->texture = Engine::Instance()
+			                     .GetResourceManager()
+			                     .CreateTexturePlaceholder();
+			Hash(entry);
+		}
+		return IsReady(source) ? entry->texture : m_placeholder;
+	}
+
+	bool Thumbnails::IsReady(const std::string& source) const
+	{
+		const auto it = m_entries.find(source);
+		return it != m_entries.end()
+		       && it->second->state == State::Ready
+		       && Engine::Instance()
+		              .GetResourceManager()
+		              .IsTextureReady(it->second->texture);
+	}
+
+	void Thumbnails::Hash(const std::shared_ptr<Entry>& entry)
+	{
+		Engine::Instance().GetJobManager().Schedule(
+		    [this, entry] {
+			    VEGAM_PROFILE_SCOPE("Thumbnails::Hash");
+			    std::vector<uint8_t> data;
+			    if (ReadFile(entry->source, data))
+			    {
+				    const auto hash = static_cast<uint64_t>(
+				        Core::MakeStringId(std::string_view(
+				            reinterpret_cast<const char*>(
+				                data.data()),
+				            data.size())));
+				    entry->cachePath =
+				        (std::filesystem::path(
+				             m_settings.cacheDirectory)
+				         / fmt::format("{:016x}-{}.rgba", hash,
+				                       m_settings.size))
+				            .string();
+				    const auto size = size_t{m_settings.size}
+				                      * m_settings.size * 4;
+				    if (ReadFile(entry->cachePath, data)
+				        && data.size() == size)
+				    {
+					    entry->pixels = std::move(data);
+				    }
+			    }
+			    {
+				    std::lock_guard lock(m_mutex);
+				    m_hashed.push_back(entry);
+			    }
+			    Engine::Instance().RequestRedraw();
+		    },
+		    &m_jobs);
+	}
+
+	void Thumbnails::Upload(Entry& entry,
+	                        std::vector<uint8_t> pixels)
+	{
+		Engine::Instance().GetResourceManager().QueueTextureUpload(
+		    {entry.texture, PreviewDesc(m_settings.size), 0,
+		     std::move(pixels)});
+		Finish(entry, State::Ready);
+	}
+
+	void Thumbnails::Finish(Entry& entry, State state)
+	{
+		if (state == State::Failed)
+		{
+			VEGAM_WARN("No preview of {}", entry.source);
+		}
+		if (entry.meshRequested)
+		{
+			Engine::Instance().GetAssetManager().Release(
+			    entry.mesh);
+			entry.meshRequested = false;
+		}
+		entry.state = state;
+	}
+
+	void Thumbnails::Render(const std::shared_ptr<Entry>& entry)
+	{
+		auto& resources = Engine::Instance().GetResourceManager();
+		uint32_t albedo = 0;
+		if (const auto* material =
+		        resources.GetMaterial(entry->material))
+		{
+			const auto* texture = resources.GetTexture(
+			    material->GetDesc().textures[0]);
+			if (texture && texture->IsReady()
+			    && texture->GetDesc().type
+			           == Graphics::TextureType::Texture2D)
+			{
+				albedo = texture->GetId();
+			}
+		}
+
+		const auto ticket = m_nextTicket++;
+		const auto* mesh = resources.GetMesh(entry->meshHandle);
+		if (!mesh || !m_renderer.Render(*mesh, albedo, ticket))
+		{
+			Finish(*entry, State::Failed);
+			return;
+		}
+		m_readbacks.emplace(ticket, entry);
+		// The pixels no longer need the mesh.
+		Finish(*entry, State::ReadingBack);
+	}
+
+	void Thumbnails::Update()
+	{
+		VEGAM_PROFILE_SCOPE("Thumbnails::Update");
+		m_renderer.Poll();
+
+		std::vector<std::shared_ptr<Entry>> hashed;
+		{
+			std::lock_guard lock(m_mutex);
+			hashed.swap(m_hashed);
+		}
+		for (auto& entry : hashed)
+		{
+			if (entry->cachePath.empty())
+			{
+				Finish(*entry, State::Failed);
+			}
+			else if (!entry->pixels.empty())
+			{
+				Upload(*entry, std::move(entry->pixels));
+			}
+			else
+			{
+				entry->state = State::Loading;
+				m_pending.push_back(std::move(entry));
+			}
+		}
+
+		// Stream the waiting meshes in, and render those
+		// that are ready while the budget lasts.
+		auto& assets = Engine::Instance().GetAssetManager();
+		auto& resources = Engine::Instance().GetResourceManager();
+		const auto start = std::chrono::steady_clock::now();
+		const auto budget =
+		    std::chrono::duration<float, std::milli>(
+		        m_settings.budgetMs);
+		uint32_t rendered = 0;
+		for (size_t i = 0; i < m_pending.size();)
+		{
+			auto& entry = m_pending[i];
+			if (!entry->meshRequested)
+			{
+				entry->meshHandle =
+				    assets.RequestMesh(entry->mesh, MeshPriority);
+				entry->meshRequested = entry->meshHandle.IsValid();
+				if (!entry->meshRequested)
+				{
+					Finish(*entry, State::Failed);
+				}
+			}
+			else if (assets.GetState(entry->mesh)
+			         == Managers::AssetManager::State::Failed)
+			{
+				Finish(*entry, State::Failed);
+			}
+			else if (resources.IsMeshReady(entry->meshHandle)
+			         && rendered < m_settings.rendersPerFrame
+			         && std::chrono::steady_clock::now() - start
+			                < budget)
+			{
+				Render(entry);
+				++rendered;
+			}
+
+			if (entry->state == State::Loading)
+			{
+				++i;
+			}
+			else
+			{
+				m_pending.erase(m_pending.begin()
+				                + static_cast<ptrdiff_t>(i));
+			}
+		}
+
+		// Rendering on demand, frames keep coming until the
+		// previews asked for are done.
+		if (!m_pending.empty() || !m_readbacks.empty())
+		{
+			Engine::Instance().RequestRedraw();
+		}
+	}
+} // namespace Parugu
@@ -0,0 +1,522 @@
+#include "Parugu/UndoStack.h"
+
+#include "AthiVegam/Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+namespace Parugu
+{
+	namespace
+	{
+		inline uint64_t PropertyKey(uint32_t object,
+		                            uint32_t property)
+		{
+			return (uint64_t{object} << 32) | property;
+		}
+	} // namespace
+
+	size_t UndoStack::Entry::GetMemory() const
+	{
+		return name.size() + changes.size() * sizeof(Change)
+		       + data.size();
+	}
+
+	UndoStack::UndoStack(Properties properties)
+	    : UndoStack(std::move(properties), Settings{})
+	{
+	}
+
+	UndoStack::UndoStack(Properties properties,
+	                     const Settings& settings)
+	    : m_properties(std::move(properties)),
+	      m_settings(settings)
+	{
+		VEGAM_ASSERT(m_properties.read && m_properties.write,
+		             "Undo needs to read and write properties");
+		m_spillPath = m_settings.spillPath;
+		if (m_spillPath.empty())
+		{
+			std::error_code error;
+			m_spillPath =
+			    (std::filesystem::temp_directory_path(error)
+			     / fmt::format("Parugu-undo-{:x}",
+			                   reinterpret_cast<uintptr_t>(this)))
+			        .string();
+		}
+	}
+
+	UndoStack::~UndoStack()
+	{
+		if (m_spillFile.is_open())
+		{
+			m_spillFile.close();
+			std::error_code error;
+			std::filesystem::remove(m_spillPath, error);
+		}
+	}
+
+	void UndoStack::Begin(std::string_view name,
+	                      uint64_t coalesceKey)
+	{
+		if (m_depth++ > 0)
+		{
+			return;
+		}
+		m_name = name;
+		m_coalesceKey = coalesceKey;
+		m_touched.clear();
+		m_touchedIndex.clear();
+		m_before.clear();
+	}
+
+	void UndoStack::Touch(uint32_t object, uint32_t property)
+	{
+		VEGAM_ASSERT(m_depth > 0, "Touch outside a transaction");
+		const auto [it, added] = m_touchedIndex.emplace(
+		    PropertyKey(object, property),
+		    static_cast<uint32_t>(m_touched.size()));
+		if (!added)
+		{
+			return;
+		}
+		m_value.clear();
+		m_properties.read(object, property, m_value);
+		m_touched.push_back(
+		    {object, property,
+		     static_cast<uint32_t>(m_before.size()),
+		     static_cast<uint32_t>(m_value.size())});
+		m_before.insert(m_before.end(), m_value.begin(),
+		                m_value.end());
+	}
+
+	void UndoStack::Commit()
+	{
+		VEGAM_ASSERT(m_depth > 0, "Commit without Begin");
+		if (--m_depth > 0)
+		{
+			return;
+		}
+
+		Entry entry;
+		entry.name = std::move(m_name);
+		entry.coalesceKey = m_coalesceKey;
+		entry.time = std::chrono::steady_clock::now();
+		for (const auto& touched : m_touched)
+		{
+			m_value.clear();
+			m_properties.read(touched.object, touched.property,
+			                  m_value);
+			AddChange(entry, touched.object, touched.property,
+			          {m_before.data() + touched.offset,
+			           touched.size},
+			          m_value);
+		}
+		m_touched.clear();
+		m_touchedIndex.clear();
+		if (entry.changes.empty())
+		{
+			return;
+		}
+		if (!Coalesce(entry))
+		{
+			Push(std::move(entry));
+			m_coalescing = m_coalesceKey != 0;
+		}
+	}
+
+	void UndoStack::Cancel()
+	{
+		VEGAM_ASSERT(m_depth > 0, "Cancel without Begin");
+		m_depth = 0;
+		for (auto it = m_touched.rbegin(); it != m_touched.rend();
+		     ++it)
+		{
+			m_properties.write(
+			    it->object, it->property,
+			    {m_before.data() + it->offset, it->size});
+		}
+		m_touched.clear();
+		m_touchedIndex.clear();
+	}
+
+	void UndoStack::AddChange(Entry& entry, uint32_t object,
+	                          uint32_t property,
+	                          std::span<const uint8_t> before,
+	                          std::span<const uint8_t> after)
+	{
+		// Only the run between the common prefix and suffix.
+		const auto shorter = std::min(before.size(), after.size());
+		size_t prefix = 0;
+		while (prefix < shorter && before[prefix] == after[prefix])
+		{
+			++prefix;
+		}
+		if (prefix == shorter && before.size() == after.size())
+		{
+			return;
+		}
+		size_t suffix = 0;
+		while (suffix < shorter - prefix
+		       && before[before.size() - 1 - suffix]
+		              == after[after.size() - 1 - suffix])
+		{
+			++suffix;
+		}
+		const Change change{
+		    object, property, static_cast<uint32_t>(prefix),
+		    static_cast<uint32_t>(before.size() - prefix - suffix),
+		    static_cast<uint32_t>(after.size() - prefix - suffix)};
+		entry.changes.push_back(change);
+		entry.data.insert(entry.data.end(),
+		                  before.begin() + prefix,
+		                  before.end() - suffix);
+		entry.data.insert(entry.data.end(),
+		                  after.begin() + prefix,
+		                  after.end() - suffix);
+	}
+
+	bool UndoStack::Splice(std::vector<uint8_t>& value,
+	                       const Change& change,
+	                       const uint8_t* bytes, bool undo) const
+	{
+		// bytes points at the change's before bytes.
+		const auto from =
+		    undo ? change.afterSize : change.beforeSize;
+		const auto to = undo ? change.beforeSize : change.afterSize;
+		const auto* source =
+		    undo ? bytes : bytes + change.beforeSize;
+		if (value.size() < size_t{change.offset} + from)
+		{
+			return false;
+		}
+		const auto at = value.begin() + change.offset;
+		if (to > from)
+		{
+			value.insert(at + from, to - from, 0);
+		}
+		else
+		{
+			value.erase(at + to, at + from);
+		}
+		std::memcpy(value.data() + change.offset, source, to);
+		return true;
+	}
+
+	void UndoStack::Apply(const Entry& entry, bool undo)
+	{
+		// Offsets of each change's bytes.
+		std::vector<size_t> offsets(entry.changes.size());
+		size_t offset = 0;
+		for (size_t i = 0; i < entry.changes.size(); ++i)
+		{
+			offsets[i] = offset;
+			offset += entry.changes[i].beforeSize
+			          + entry.changes[i].afterSize;
+		}
+		for (size_t n = 0; n < entry.changes.size(); ++n)
+		{
+			const auto i =
+			    undo ? entry.changes.size() - 1 - n : n;
+			const auto& change = entry.changes[i];
+			m_value.clear();
+			m_properties.read(change.object, change.property,
+			                  m_value);
+			if (!Splice(m_value, change,
+			            entry.data.data() + offsets[i], undo))
+			{
+				VEGAM_ERROR("Undo: property {} of object {} no "
+				            "longer matches '{}'",
+				            change.property, change.object,
+				            entry.name);
+				continue;
+			}
+			m_properties.write(change.object, change.property,
+			                   m_value);
+		}
+	}
+
+	bool UndoStack::Coalesce(Entry& entry)
+	{
+		// Into the last entry, if it is on top of the stack
+		// and took the same kind of edit moments ago.
+		if (!m_coalescing || m_position == 0
+		    || m_position != m_entries.size())
+		{
+			return false;
+		}
+		auto& last = m_entries.back();
+		if (last.coalesceKey != entry.coalesceKey
+		    || last.spilled
+		    || entry.time - last.time
+		           > std::chrono::milliseconds(
+		               m_settings.coalesceMs))
+		{
+			return false;
+		}
+
+		// Each property either touched is now as after the
+		// new entry; its value before the last one is found
+		// by undoing both, newest first.
+		std::vector<uint64_t> properties;
+		for (const auto* source : {&entry, &last})
+		{
+			for (const auto& change : source->changes)
+			{
+				const auto key =
+				    PropertyKey(change.object, change.property);
+				if (std::find(properties.begin(),
+				              properties.end(), key)
+				    == properties.end())
+				{
+					properties.push_back(key);
+				}
+			}
+		}
+
+		Entry merged;
+		merged.name = last.name;
+		merged.coalesceKey = last.coalesceKey;
+		merged.time = entry.time;
+		for (const auto key : properties)
+		{
+			const auto object = static_cast<uint32_t>(key >> 32);
+			const auto property = static_cast<uint32_t>(key);
+			m_value.clear();
+			m_properties.read(object, property, m_value);
+			m_other = m_value;
+			for (const auto* source : {&entry, &last})
+			{
+				size_t offset = 0;
+				for (const auto& change : source->changes)
+				{
+					if (change.object == object
+					    && change.property == property)
+					{
+						Splice(m_other, change,
+						       source->data.data() + offset,
+						       true);
+					}
+					offset += change.beforeSize
+					          + change.afterSize;
+				}
+			}
+			AddChange(merged, object, property, m_other,
+			          m_value);
+		}
+
+		m_memory -= last.GetMemory();
+		if (merged.changes.empty())
+		{
+			// The edit came back to where it started; any
+			// more of it starts a new entry.
+			m_entries.pop_back();
+			--m_position;
+			m_coalescing = false;
+			return true;
+		}
+		last = std::move(merged);
+		m_memory += last.GetMemory();
+		Trim();
+		return true;
+	}
+
+	void UndoStack::Push(Entry entry)
+	{
+		Truncate(m_position);
+		m_memory += entry.GetMemory();
+		m_entries.push_back(std::move(entry));
+		m_position = m_entries.size();
+		Trim();
+	}
+
+	void UndoStack::Truncate(size_t count)
+	{
+		while (m_entries.size() > count)
+		{
+			m_memory -= m_entries.back().GetMemory();
+			m_entries.pop_back();
+		}
+		m_position = std::min(m_position, count);
+	}
+
+	void UndoStack::Trim()
+	{
+		while (m_entries.size() > m_settings.maxEntries
+		       && m_position > 0)
+		{
+			auto& oldest = m_entries.front();
+			m_memory -= oldest.GetMemory();
+			if (oldest.spilled && --m_spilledCount == 0)
+			{
+				m_spillEnd = 0;
+			}
+			m_entries.pop_front();
+			--m_position;
+		}
+
+		// Spill the oldest, keeping the top one in memory.
+		while (m_memory > m_settings.memoryBudget
+		       && m_spilledCount + 1 < m_position)
+		{
+			if (!Spill(m_entries[m_spilledCount]))
+			{
+				break;
+			}
+		}
+	}
+
+	bool UndoStack::Spill(Entry& entry)
+	{
+		if (!m_spillFile.is_open())
+		{
+			m_spillFile.open(m_spillPath,
+			                 std::ios::in | std::ios::out
+			                     | std::ios::binary
+			                     | std::ios::trunc);
+			if (!m_spillFile)
+			{
+				VEGAM_WARN("Cannot open {}; undo history is "
+				           "kept in memory",
+				           m_spillPath);
+				return false;
+			}
+		}
+
+		const auto changesSize =
+		    entry.changes.size() * sizeof(Change);
+		m_spillFile.seekp(static_cast<std::streamoff>(m_spillEnd));
+		m_spillFile.write(
+		    reinterpret_cast<const char*>(entry.changes.data()),
+		    static_cast<std::streamsize>(changesSize));
+		m_spillFile.write(
+		    reinterpret_cast<const char*>(entry.data.data()),
+		    static_cast<std::streamsize>(entry.data.size()));
+		if (!m_spillFile)
+		{
+			VEGAM_WARN("Error writing {}", m_spillPath);
+			m_spillFile.clear();
+			return false;
+		}
+
+		m_memory -= entry.GetMemory();
+		entry.spilled = true;
+		entry.changeCount =
+		    static_cast<uint32_t>(entry.changes.size());
+		entry.spillOffset = m_spillEnd;
+		entry.dataSize = entry.data.size();
+		m_spillEnd += changesSize + entry.data.size();
+		++m_spilledCount;
+		// Release the memory, not just the contents.
+		std::vector<Change>().swap(entry.changes);
+		std::vector<uint8_t>().swap(entry.data);
+		m_memory += entry.GetMemory();
+		return true;
+	}
+
+	bool UndoStack::Restore(Entry& entry)
+	{
+		if (!entry.spilled)
+		{
+			return true;
+		}
+		// Only ever the newest spilled entry.
+		entry.changes.resize(entry.changeCount);
+		entry.data.resize(entry.dataSize);
+		m_spillFile.seekg(
+		    static_cast<std::streamoff>(entry.spillOffset));
+		m_spillFile.read(
+		    reinterpret_cast<char*>(entry.changes.data()),
+		    static_cast<std::streamsize>(entry.changeCount
+		                                 * sizeof(Change)));
+		m_spillFile.read(
+		    reinterpret_cast<char*>(entry.data.data()),
+		    static_cast<std::streamsize>(entry.dataSize));
+		if (!m_spillFile)
+		{
+			VEGAM_ERROR("Error reading {}; '{}' cannot be undone",
+			            m_spillPath, entry.name);
+			m_spillFile.clear();
+			entry.changes.clear();
+			entry.data.clear();
+			return false;
+		}
+
+		m_memory -= entry.GetMemory();
+		entry.spilled = false;
+		m_spillEnd = entry.spillOffset;
+		--m_spilledCount;
+		m_memory += entry.GetMemory();
+		return true;
+	}
+
+	bool UndoStack::Undo()
+	{
+		VEGAM_ASSERT(m_depth == 0, "Undo during a transaction");
+		if (m_position == 0)
+		{
+			return false;
+		}
+		auto& entry = m_entries[m_position - 1];
+		if (!Restore(entry))
+		{
+			// Nothing older can be undone either.
+			for (size_t i = 0; i < m_position; ++i)
+			{
+				m_memory -= m_entries[i].GetMemory();
+			}
+			m_entries.erase(m_entries.begin(),
+			                m_entries.begin() + m_position);
+			m_position = 0;
+			m_spilledCount = 0;
+			m_spillEnd = 0;
+			return false;
+		}
+		Apply(entry, true);
+		--m_position;
+		m_coalescing = false;
+		return true;
+	}
+
+	bool UndoStack::Redo()
+	{
+		VEGAM_ASSERT(m_depth == 0, "Redo during a transaction");
+		if (m_position == m_entries.size())
+		{
+			return false;
+		}
+		// Entries above the position are never spilled.
+		Apply(m_entries[m_position], false);
+		++m_position;
+		m_coalescing = false;
+		Trim();
+		return true;
+	}
+
+	std::string_view UndoStack::GetUndoName() const
+	{
+		return m_position > 0 ? std::string_view(
+		                            m_entries[m_position - 1].name)
+		                      : std::string_view();
+	}
+
+	std::string_view UndoStack::GetRedoName() const
+	{
+		return m_position < m_entries.size()
+		           ? std::string_view(m_entries[m_position].name)
+		           : std::string_view();
+	}
+
+	void UndoStack::Clear()
+	{
+		VEGAM_ASSERT(m_depth == 0, "Clear during a transaction");
+		m_entries.clear();
+		m_position = 0;
+		m_memory = 0;
+		m_coalescing = false;
+		m_spilledCount = 0;
+		m_spillEnd = 0;
+	}
+} // namespace Parugu
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "AthiVegam/App.h"
+#include "AthiVegam/Engine.h"
+#include "AthiVegam/Graphics/FrameCapture.h"
+#include "AthiVegam/Graphics/Handle.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Replay
+{
+	// From the command line: --capture=path --loops=N
+	// --warmup=W --output=path
+	struct ReplaySettings
+	{
+		std::string capture = "RenderCapture.bin";
+		// Passes over the captured flushes.
+		uint32_t loops = 10;
+		// Flushes replayed before timing starts.
+		uint32_t warmupFrames = 60;
+		std::string output = "ReplayResults.json";
+
+		static ReplaySettings
+		Parse(const std::vector<std::string>& arguments);
+	};
+
+	// Replays a Graphics::FrameCapture in a hidden window:
+	// one captured flush per frame, looping, with the
+	// flush's CPU time and its GPU time from a timer
+	// query. Writes the statistics as JSON and quits.
+	class FrameReplay : public AthiVegam::App
+	{
+	  public:
+		FrameReplay() = default;
+		virtual ~FrameReplay() = default;
+
+		AthiVegam::EngineConfig
+		GetEngineConfig() const override;
+		void Initialize() override;
+		void Shutdown() override;
+		void Render(float alpha) override;
+
+	  private:
+		using Clock = std::chrono::steady_clock;
+		// Timer results are read this many frames late, so
+		// reading never stalls.
+		static constexpr uint32_t QueryCount = 4;
+
+		void CreateResources();
+		void Submit(const AthiVegam::Graphics::FrameCapture::
+		                CapturedFlush& flush);
+		void ReadGpuTime(uint32_t query);
+		void WriteResults() const;
+
+	  private:
+		ReplaySettings m_settings;
+		AthiVegam::Graphics::FrameCapture::Capture m_capture;
+		// Captured handle values to the replay's.
+		std::unordered_map<uint32_t,
+		                   AthiVegam::Graphics::MeshHandle>
+		    m_meshes;
+		std::unordered_map<uint32_t,
+		                   AthiVegam::Graphics::ShaderHandle>
+		    m_shaders;
+
+		std::array<uint32_t, QueryCount> m_queries{};
+		std::array<bool, QueryCount> m_queryTimed{};
+		uint32_t m_frame = 0;
+		uint32_t m_frames = 0;
+		std::vector<double> m_cpuTimes;
+		std::vector<double> m_gpuTimes;
+		uint64_t m_drawCalls = 0;
+	};
+} // namespace Replay
+
+extern std::unique_ptr<AthiVegam::App> CreateApp();
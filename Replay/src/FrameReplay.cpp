@@ -0,0 +1,381 @@
+#include "Replay/FrameReplay.h"
+
+#include "AthiVegam/Graphics/SortKey.h"
+#include "AthiVegam/Log.h"
+#include "AthiVegam/Main.h"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <string_view>
+
+using namespace AthiVegam;
+
+std::unique_ptr<App> CreateApp()
+{
+	return std::make_unique<Replay::FrameReplay>();
+}
+
+namespace Replay
+{
+	namespace
+	{
+		using namespace Graphics::FrameCapture;
+
+		bool ParseFlag(std::string_view argument,
+		               std::string_view name,
+		               std::string_view& value)
+		{
+			if (!argument.starts_with(name)
+			    || argument.size() <= name.size()
+			    || argument[name.size()] != '=')
+			{
+				return false;
+			}
+			value = argument.substr(name.size() + 1);
+			return true;
+		}
+
+		void ParseCount(std::string_view value,
+		                uint32_t& count)
+		{
+			const auto [end, error] = std::from_chars(
+			    value.data(), value.data() + value.size(),
+			    count);
+			if (error != std::errc())
+			{
+				VEGAM_WARN("Ignoring bad count: {}", value);
+			}
+		}
+
+		// Nearest-rank percentile of sorted samples.
+		double Percentile(const std::vector<double>& sorted,
+		                  double percent)
+		{
+			const auto rank = static_cast<size_t>(std::lround(
+			    percent / 100.0 * (sorted.size() - 1)));
+			return sorted[rank];
+		}
+
+		void WriteStats(std::ofstream& file,
+		                std::vector<double> samples)
+		{
+			if (samples.empty())
+			{
+				file << "null";
+				return;
+			}
+			std::sort(samples.begin(), samples.end());
+			const auto mean =
+			    std::accumulate(samples.begin(), samples.end(),
+			                    0.0)
+			    / static_cast<double>(samples.size());
+			file << "{\"mean\": " << mean
+			     << ", \"min\": " << samples.front()
+			     << ", \"p50\": " << Percentile(samples, 50)
+			     << ", \"p95\": " << Percentile(samples, 95)
+			     << ", \"p99\": " << Percentile(samples, 99)
+			     << ", \"max\": " << samples.back() << "}";
+		}
+	} // namespace
+
+	ReplaySettings ReplaySettings::Parse(
+	    const std::vector<std::string>& arguments)
+	{
+		ReplaySettings settings;
+		for (const std::string_view argument : arguments)
+		{
+			std::string_view value;
+			if (ParseFlag(argument, "--capture", value))
+			{
+				settings.capture = value;
+			}
+			else if (ParseFlag(argument, "--loops", value))
+			{
+				ParseCount(value, settings.loops);
+			}
+			else if (ParseFlag(argument, "--warmup", value))
+			{
+				ParseCount(value, settings.warmupFrames);
+			}
+			else if (ParseFlag(argument, "--output", value))
+			{
+				settings.output = value;
+			}
+		}
+		settings.loops = std::max(settings.loops, 1u);
+		return settings;
+	}
+
+	EngineConfig FrameReplay::GetEngineConfig() const
+	{
+		EngineConfig config;
+		config.window.hidden = true;
+		config.window.vsync = VSync::Off;
+		config.showPerformanceHud = false;
+		// Timer queries need the flush on this thread.
+		config.renderThread = false;
+		config.shaderCacheDirectory.clear();
+		config.pipelineLog.clear();
+		return config;
+	}
+
+	void FrameReplay::Initialize()
+	{
+		auto& engine = Engine::Instance();
+		m_settings = ReplaySettings::Parse(engine.GetArguments());
+		if (!Load(m_settings.capture, m_capture)
+		    || m_capture.flushes.empty())
+		{
+			VEGAM_ERROR("Nothing to replay in {}",
+			            m_settings.capture);
+			engine.Quit();
+			return;
+		}
+
+		CreateResources();
+		m_frames = m_settings.warmupFrames
+		           + m_settings.loops
+		                 * static_cast<uint32_t>(
+		                     m_capture.flushes.size());
+		m_cpuTimes.reserve(m_frames);
+		m_gpuTimes.reserve(m_frames);
+		glGenQueries(QueryCount, m_queries.data());
+		VEGAM_INFO("Replaying {} flushes of {}, {} times",
+		           m_capture.flushes.size(), m_settings.capture,
+		           m_settings.loops);
+	}
+
+	void FrameReplay::CreateResources()
+	{
+		auto& resources =
+		    Engine::Instance().GetResourceManager();
+		std::vector<uint32_t> indices;
+		for (const auto& mesh : m_capture.meshes)
+		{
+			// The resource manager takes 32-bit indices.
+			indices.resize(mesh.elementCount);
+			for (uint32_t i = 0; i < mesh.elementCount; ++i)
+			{
+				if (mesh.indexType == Graphics::IndexType::UInt16)
+				{
+					uint16_t index;
+					std::memcpy(&index, &mesh.indices[2 * i], 2);
+					indices[i] = index;
+				}
+				else
+				{
+					std::memcpy(&indices[i],
+					            &mesh.indices[4 * i], 4);
+				}
+			}
+			m_meshes[mesh.handle.value] = resources.CreateMesh(
+			    mesh.layout, mesh.vertices.data(),
+			    mesh.vertexCount,
+			    indices.empty() ? nullptr : indices.data(),
+			    mesh.elementCount);
+		}
+		for (const auto& shader : m_capture.shaders)
+		{
+			m_shaders[shader.handle.value] =
+			    resources.CreateShader(shader.vertex,
+			                           shader.fragment);
+		}
+	}
+
+	void FrameReplay::Shutdown()
+	{
+		if (!m_queries.empty() && m_queries[0] != 0)
+		{
+			glDeleteQueries(QueryCount, m_queries.data());
+		}
+		WriteResults();
+
+		auto& resources =
+		    Engine::Instance().GetResourceManager();
+		for (const auto& [_, shader] : m_shaders)
+		{
+			resources.DestroyShader(shader);
+		}
+		for (const auto& [_, mesh] : m_meshes)
+		{
+			resources.DestroyMesh(mesh);
+		}
+	}
+
+	// The captured lists become one, their instance and
+	// constant offsets rebased onto this frame's pushes.
+	void FrameReplay::Submit(const CapturedFlush& flush)
+	{
+		using namespace Graphics::RenderCommands;
+
+		auto& renderManager =
+		    Engine::Instance().GetRenderManager();
+		for (const auto& list : flush.lists)
+		{
+			uint32_t instanceBase = 0;
+			if (!list.instances.empty())
+			{
+				instanceBase = renderManager.PushInstances(
+				    list.instances.data(),
+				    static_cast<uint32_t>(list.instances.size()));
+			}
+			uint32_t constantBase = 0;
+			if (!list.constants.empty())
+			{
+				constantBase =
+				    renderManager
+				        .PushConstants(
+				            list.constants.data(),
+				            static_cast<uint32_t>(
+				                list.constants.size()))
+				        .offset;
+			}
+
+			for (const auto& draw : list.draws)
+			{
+				const auto mesh = m_meshes.find(draw.mesh.value);
+				const auto shader =
+				    m_shaders.find(draw.shader.value);
+				if (mesh == m_meshes.end()
+				    || shader == m_shaders.end())
+				{
+					continue;
+				}
+				// Secondary viewports aren't replayed.
+				const auto key =
+				    Graphics::SortKey::WithViewport(draw.key, 0);
+				auto constants = draw.constants;
+				if (constants.offset != NoConstants)
+				{
+					constants.offset += constantBase;
+				}
+				auto instance = draw.firstInstance;
+				if (instance != NoInstance)
+				{
+					instance += instanceBase;
+				}
+
+				if (draw.instanced)
+				{
+					RenderMeshInstanced command{};
+					command.mesh = mesh->second;
+					command.shader = shader->second;
+					command.firstInstance = instance;
+					command.instanceCount = draw.instanceCount;
+					command.constants = constants;
+					renderManager.Submit(command, key);
+				}
+				else
+				{
+					RenderMesh command;
+					command.mesh = mesh->second;
+					command.shader = shader->second;
+					command.instance = instance;
+					command.constants = constants;
+					renderManager.Submit(command, key);
+				}
+			}
+		}
+	}
+
+	void FrameReplay::ReadGpuTime(uint32_t query)
+	{
+		if (!m_queryTimed[query])
+		{
+			return;
+		}
+		m_queryTimed[query] = false;
+		GLint available = 0;
+		glGetQueryObjectiv(m_queries[query],
+		                   GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+		{
+			return;
+		}
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(m_queries[query], GL_QUERY_RESULT,
+		                      &nanoseconds);
+		m_gpuTimes.push_back(static_cast<double>(nanoseconds)
+		                     / 1e6);
+	}
+
+	void FrameReplay::Render(float alpha)
+	{
+		auto& engine = Engine::Instance();
+		if (m_capture.flushes.empty())
+		{
+			return;
+		}
+		if (m_frame >= m_frames)
+		{
+			engine.Quit();
+			return;
+		}
+
+		const auto timed = m_frame >= m_settings.warmupFrames;
+		const auto query = m_frame % QueryCount;
+		ReadGpuTime(query);
+		auto& renderManager = engine.GetRenderManager();
+		if (timed)
+		{
+			m_drawCalls += renderManager.GetFrameStats().drawCalls;
+		}
+
+		const auto start = Clock::now();
+		if (timed)
+		{
+			glBeginQuery(GL_TIME_ELAPSED, m_queries[query]);
+		}
+		Submit(m_capture.flushes[m_frame
+		                         % m_capture.flushes.size()]);
+		renderManager.Flush();
+		if (timed)
+		{
+			glEndQuery(GL_TIME_ELAPSED);
+			m_queryTimed[query] = true;
+			const std::chrono::duration<double, std::milli>
+			    elapsed = Clock::now() - start;
+			m_cpuTimes.push_back(elapsed.count());
+		}
+		++m_frame;
+	}
+
+	void FrameReplay::WriteResults() const
+	{
+		if (m_cpuTimes.empty())
+		{
+			VEGAM_WARN("Replay timed no frames");
+			return;
+		}
+
+		std::ofstream file(m_settings.output);
+		if (!file)
+		{
+			VEGAM_ERROR("Could not write replay results to {}",
+			            m_settings.output);
+			return;
+		}
+		const auto frames =
+		    static_cast<double>(m_cpuTimes.size());
+		file << "{\n"
+		     << "  \"capture\": \"" << m_settings.capture
+		     << "\",\n"
+		     << "  \"flushes\": " << m_capture.flushes.size()
+		     << ",\n"
+		     << "  \"frames\": " << m_cpuTimes.size() << ",\n"
+		     << "  \"cpuFlushMs\": ";
+		WriteStats(file, m_cpuTimes);
+		file << ",\n  \"gpuFlushMs\": ";
+		WriteStats(file, m_gpuTimes);
+		file << ",\n  \"drawCallsPerFrame\": "
+		     << m_drawCalls / frames << "\n"
+		     << "}\n";
+
+		VEGAM_INFO("Replay written to {}", m_settings.output);
+	}
+} // namespace Replay
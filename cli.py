@@ -2,6 +2,9 @@
 # cli run
 # cli gen
 # cli version
+# cli cook
+# cli pack
+# cli cookshaders
 # cli gen build run
 
 
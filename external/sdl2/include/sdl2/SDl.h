@@ -0,0 +1 @@
+SDL.h
\ No newline at end of file
@@ -1,3 +1,18 @@
+-- premake5 --game-module gmake2: Parugu's game code is
+-- built as ParuguGame, a shared library the Parugu
+-- executable loads and reloads when it is rebuilt (see
+-- AthiVegam/GameModule.h). Its engine symbols bind to the
+-- executable's, which only exports them on Linux and macOS.
+newoption
+{
+	trigger = "game-module",
+	description = "Build Parugu's game code as a reloadable shared library"
+}
+
+if _OPTIONS["game-module"] and os.target() == "windows" then
+	premake.error("--game-module needs Linux or macOS")
+end
+
 workspace "AthiVegam"
 	startproject "Parugu"
 	architecture "x64"
@@ -5,11 +20,22 @@ workspace "AthiVegam"
 	configurations
 	{
 		"Debug",
-		"Release"
+		"Release",
+		"Profile",
+		"Shipping",
+		"Server"
 	}
 
 	warnings "High"
 
+	-- Lockstep and rollback games need every build of the
+	-- simulation to round alike, so multiplies and adds are
+	-- never fused behind the code's back (see
+	-- EngineConfig::deterministic).
+	filter "toolset:gcc or toolset:clang"
+		buildoptions { "-ffp-contract=off" }
+	filter {}
+
 tdir = "Build/bin/%{cfg.buildcfg}/%{prj.name}"
 odir = "Build/bin_obj/%{cfg.buildcfg}/%{prj.name}"
 
@@ -127,6 +153,43 @@ project "AthiVegam"
 		optimize "on"
 		buildoptions "/MT"
 
+	-- Optimized, with logging, profiling and GL debug
+	-- output but no per-call glGetError.
+	filter "configurations:Profile"
+		defines
+		{
+			"AV_CONFIG_PROFILE"
+		}
+		runtime "Release"
+		symbols "on"
+		optimize "on"
+		buildoptions "/MT"
+
+	-- Release with instrumentation compiled out.
+	filter "configurations:Shipping"
+		defines
+		{
+			"AV_CONFIG_RELEASE",
+			"AV_CONFIG_SHIPPING"
+		}
+		runtime "Release"
+		symbols "off"
+		optimize "on"
+		buildoptions "/MT"
+
+	-- Release that runs as a dedicated server by default
+	-- (see EngineConfig::server).
+	filter "configurations:Server"
+		defines
+		{
+			"AV_CONFIG_RELEASE",
+			"AV_CONFIG_SERVER"
+		}
+		runtime "Release"
+		symbols "off"
+		optimize "on"
+		buildoptions "/MT"
+
 		
 project "Parugu"
 	location "Parugu"
@@ -139,12 +202,37 @@ project "Parugu"
 	targetdir(tdir)
 	objdir(odir)
 
-	files
-	{
-		"%{prj.name}/include/**.h",
-		"%{prj.name}/src/**.h",
-		"%{prj.name}/src/**.cpp"
-	}
+	if _OPTIONS["game-module"] then
+		-- The engine whole, exported for the module.
+		files
+		{
+			"%{prj.name}/host/**.cpp",
+			"%{prj.name}/shaders/**"
+		}
+		filter "system:linux"
+			linkoptions
+			{
+				"-rdynamic",
+				"-Wl,--whole-archive",
+				"../Build/bin/%{cfg.buildcfg}/AthiVegam/libAthiVegam.a",
+				"-Wl,--no-whole-archive"
+			}
+		filter "system:macosx"
+			linkoptions
+			{
+				"-Wl,-export_dynamic",
+				"-Wl,-force_load,../Build/bin/%{cfg.buildcfg}/AthiVegam/libAthiVegam.a"
+			}
+		filter {}
+	else
+		files
+		{
+			"%{prj.name}/include/**.h",
+			"%{prj.name}/src/**.h",
+			"%{prj.name}/src/**.cpp",
+			"%{prj.name}/shaders/**"
+		}
+	end
 
 	includedirs
 	{
@@ -227,4 +315,453 @@ project "Parugu"
 		runtime "Release"
 		symbols "off"
 		optimize "on"
-		buildoptions "/MT"
\ No newline at end of file
+		buildoptions "/MT"
+
+	-- Optimized, with logging, profiling and GL debug
+	-- output but no per-call glGetError.
+	filter "configurations:Profile"
+		defines
+		{
+			"AV_CONFIG_PROFILE"
+		}
+		runtime "Release"
+		symbols "on"
+		optimize "on"
+		buildoptions "/MT"
+
+	-- Release with instrumentation compiled out.
+	filter "configurations:Shipping"
+		defines
+		{
+			"AV_CONFIG_RELEASE",
+			"AV_CONFIG_SHIPPING"
+		}
+		runtime "Release"
+		symbols "off"
+		optimize "on"
+		buildoptions "/MT"
+
+	-- Release that runs as a dedicated server by default
+	-- (see EngineConfig::server).
+	filter "configurations:Server"
+		defines
+		{
+			"AV_CONFIG_RELEASE",
+			"AV_CONFIG_SERVER"
+		}
+		runtime "Release"
+		symbols "off"
+		optimize "on"
+		buildoptions "/MT"
+
+if _OPTIONS["game-module"] then
+-- Parugu's game code for --game-module builds; next to the
+-- executable, which finds it there.
+project "ParuguGame"
+	location "Parugu"
+	kind "SharedLib"
+	language "C++"
+	cppdialect "C++20"
+	staticruntime "on"
+	pic "On"
+	dependson "AthiVegam"
+	defines "AV_GAME_MODULE_LIBRARY"
+
+	targetdir("Build/bin/%{cfg.buildcfg}/Parugu")
+	objdir(odir)
+
+	files
+	{
+		"Parugu/include/**.h",
+		"Parugu/src/**.h",
+		"Parugu/src/**.cpp"
+	}
+
+	includedirs
+	{
+		"AthiVegam/include",
+		"Parugu/include",
+	}
+
+	sysincludedirs
+	{
+		"%{externals.spdlog}/include"
+	}
+
+	filter {"system:macosx", "configurations:*"}
+		defines "AV_PLATFORM_MAC"
+		-- Engine symbols come from the executable.
+		linkoptions "-undefined dynamic_lookup"
+
+	filter {"system:linux", "configurations:*"}
+		defines "AV_PLATFORM_LINUX"
+
+	filter "configurations:Debug"
+		defines "AV_CONFIG_DEBUG"
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		defines "AV_CONFIG_RELEASE"
+		runtime "Release"
+		optimize "on"
+
+	filter "configurations:Profile"
+		defines "AV_CONFIG_PROFILE"
+		runtime "Release"
+		symbols "on"
+		optimize "on"
+
+	filter "configurations:Shipping"
+		defines { "AV_CONFIG_RELEASE", "AV_CONFIG_SHIPPING" }
+		runtime "Release"
+		optimize "on"
+
+	filter "configurations:Server"
+		defines { "AV_CONFIG_RELEASE", "AV_CONFIG_SERVER" }
+		runtime "Release"
+		optimize "on"
+
+	filter {}
+end
+
+-- Headless scene benchmarks; results are written as JSON.
+project "Benchmarks"
+	location "Benchmarks"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++20"
+	staticruntime "on"
+	links "AthiVegam"
+
+	targetdir(tdir)
+	objdir(odir)
+
+	files
+	{
+		"%{prj.name}/include/**.h",
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp"
+	}
+
+	includedirs
+	{
+		"AthiVegam/include",
+		"%{prj.name}/include",
+	}
+
+	sysincludedirs
+	{
+		"%{externals.spdlog}/include"
+	}
+
+	filter {"system:windows", "configurations:*"}
+		systemversion "latest"
+		
+		defines
+		{
+			"AV_PLATFORM_WINDOWS"
+		}
+		
+	filter {"system:macosx", "configurations:*"}
+		xcodebuildsettings
+		{
+			["MACOSX_DEPLOYMENT_TARGET"] = "10.15",
+			["UseModernBuildSystem"] = "NO"
+		}
+		
+		defines
+		{
+			"AV_PLATFORM_MAC"
+		}
+		
+	filter {"system:linux", "configurations:*"}
+		defines
+		{
+			"AV_PLATFORM_LINUX" 
+		}
+	
+	filter "configurations:Debug"
+		defines
+		{
+			"AV_CONFIG_DEBUG"
+		}
+		runtime "Debug"
+		symbols "on"
+		buildoptions "/MTd"
+		
+	filter "configurations:Release"
+		defines
+		{
+			"AV_CONFIG_RELEASE"
+		}
+		runtime "Release"
+		symbols "off"
+		optimize "on"
+		buildoptions "/MT"
+
+	-- Optimized, with logging, profiling and GL debug
+	-- output but no per-call glGetError.
+	filter "configurations:Profile"
+		defines
+		{
+			"AV_CONFIG_PROFILE"
+		}
+		runtime "Release"
+		symbols "on"
+		optimize "on"
+		buildoptions "/MT"
+
+	-- Release with instrumentation compiled out.
+	filter "configurations:Shipping"
+		defines
+		{
+			"AV_CONFIG_RELEASE",
+			"AV_CONFIG_SHIPPING"
+		}
+		runtime "Release"
+		symbols "off"
+		optimize "on"
+		buildoptions "/MT"
+
+	-- Release that runs as a dedicated server by default
+	-- (see EngineConfig::server).
+	filter "configurations:Server"
+		defines
+		{
+			"AV_CONFIG_RELEASE",
+			"AV_CONFIG_SERVER"
+		}
+		runtime "Release"
+		symbols "off"
+		optimize "on"
+		buildoptions "/MT"
+
+
+-- Replays render captures (see Graphics::FrameCapture)
+-- with CPU and GPU timing; results are written as JSON.
+project "Replay"
+	location "Replay"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++20"
+	staticruntime "on"
+	links "AthiVegam"
+
+	targetdir(tdir)
+	objdir(odir)
+
+	files
+	{
+		"%{prj.name}/include/**.h",
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp"
+	}
+
+	includedirs
+	{
+		"AthiVegam/include",
+		"%{prj.name}/include",
+	}
+
+	sysincludedirs
+	{
+		"%{externals.spdlog}/include",
+		"%{externals.glad}/include"
+	}
+
+	filter {"system:windows", "configurations:*"}
+		systemversion "latest"
+		
+		defines
+		{
+			"AV_PLATFORM_WINDOWS"
+		}
+		
+	filter {"system:macosx", "configurations:*"}
+		xcodebuildsettings
+		{
+			["MACOSX_DEPLOYMENT_TARGET"] = "10.15",
+			["UseModernBuildSystem"] = "NO"
+		}
+		
+		defines
+		{
+			"AV_PLATFORM_MAC"
+		}
+		
+	filter {"system:linux", "configurations:*"}
+		defines
+		{
+			"AV_PLATFORM_LINUX" 
+		}
+	
+	filter "configurations:Debug"
+		defines
+		{
+			"AV_CONFIG_DEBUG"
+		}
+		runtime "Debug"
+		symbols "on"
+		buildoptions "/MTd"
+		
+	filter "configurations:Release"
+		defines
+		{
+			"AV_CONFIG_RELEASE"
+		}
+		runtime "Release"
+		symbols "off"
+		optimize "on"
+		buildoptions "/MT"
+
+	-- Optimized, with logging, profiling and GL debug
+	-- output but no per-call glGetError.
+	filter "configurations:Profile"
+		defines
+		{
+			"AV_CONFIG_PROFILE"
+		}
+		runtime "Release"
+		symbols "on"
+		optimize "on"
+		buildoptions "/MT"
+
+	-- Release with instrumentation compiled out.
+	filter "configurations:Shipping"
+		defines
+		{
+			"AV_CONFIG_RELEASE",
+			"AV_CONFIG_SHIPPING"
+		}
+		runtime "Release"
+		symbols "off"
+		optimize "on"
+		buildoptions "/MT"
+
+	-- Release that runs as a dedicated server by default
+	-- (see EngineConfig::server).
+	filter "configurations:Server"
+		defines
+		{
+			"AV_CONFIG_RELEASE",
+			"AV_CONFIG_SERVER"
+		}
+		runtime "Release"
+		symbols "off"
+		optimize "on"
+		buildoptions "/MT"
+
+
+-- Engine hot-path micro-benchmarks, compared against a
+-- baseline run with --baseline=<results.json>.
+project "MicroBenchmarks"
+	location "MicroBenchmarks"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++20"
+	staticruntime "on"
+	links "AthiVegam"
+
+	targetdir(tdir)
+	objdir(odir)
+
+	files
+	{
+		"%{prj.name}/include/**.h",
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp"
+	}
+
+	includedirs
+	{
+		"AthiVegam/include",
+		"%{prj.name}/include",
+	}
+
+	sysincludedirs
+	{
+		"%{externals.spdlog}/include"
+	}
+
+	filter {"system:windows", "configurations:*"}
+		systemversion "latest"
+		
+		defines
+		{
+			"AV_PLATFORM_WINDOWS"
+		}
+		
+	filter {"system:macosx", "configurations:*"}
+		xcodebuildsettings
+		{
+			["MACOSX_DEPLOYMENT_TARGET"] = "10.15",
+			["UseModernBuildSystem"] = "NO"
+		}
+		
+		defines
+		{
+			"AV_PLATFORM_MAC"
+		}
+		
+	filter {"system:linux", "configurations:*"}
+		defines
+		{
+			"AV_PLATFORM_LINUX" 
+		}
+	
+	filter "configurations:Debug"
+		defines
+		{
+			"AV_CONFIG_DEBUG"
+		}
+		runtime "Debug"
+		symbols "on"
+		buildoptions "/MTd"
+		
+	filter "configurations:Release"
+		defines
+		{
+			"AV_CONFIG_RELEASE"
+		}
+		runtime "Release"
+		symbols "off"
+		optimize "on"
+		buildoptions "/MT"
+
+	-- Optimized, with logging, profiling and GL debug
+	-- output but no per-call glGetError.
+	filter "configurations:Profile"
+		defines
+		{
+			"AV_CONFIG_PROFILE"
+		}
+		runtime "Release"
+		symbols "on"
+		optimize "on"
+		buildoptions "/MT"
+
+	-- Release with instrumentation compiled out.
+	filter "configurations:Shipping"
+		defines
+		{
+			"AV_CONFIG_RELEASE",
+			"AV_CONFIG_SHIPPING"
+		}
+		runtime "Release"
+		symbols "off"
+		optimize "on"
+		buildoptions "/MT"
+
+	-- Release that runs as a dedicated server by default
+	-- (see EngineConfig::server).
+	filter "configurations:Server"
+		defines
+		{
+			"AV_CONFIG_RELEASE",
+			"AV_CONFIG_SERVER"
+		}
+		runtime "Release"
+		symbols "off"
+		optimize "on"
+		buildoptions "/MT"
@@ -0,0 +1,329 @@
+# Cooks every asset below an asset root into what the
+# engine loads, incrementally and in parallel. pack.py
+# packs the results; cooking on its own warms the caches.
+#
+#   python3 cli.py cook
+#   python3 tools/cook.py [asset root]
+#   python3 tools/cook.py --one <source> <output>
+#
+# The root defaults to <project>/assets. The last form
+# cooks one asset into output, for hot reload (see
+# AssetManager::EnableHotReload()). Each asset is a
+# node in a dependency graph: its key hashes its cooker and
+# that cooker's version, its name (which picks settings,
+# such as _n for normal maps), its content and the keys of
+# the files its cooker reads besides it. Only assets whose
+# key is in no cache are cooked, one per process.
+#
+# Results are kept in a local cache, <project>/.cookcache,
+# and in a shared one when COOK_REMOTE_CACHE names a
+# directory (such as a network share the build machines
+# fill): results missing locally are copied from it, and
+# new ones are written to both. Content hashes are kept
+# with the size and modification time they were taken at,
+# so untouched sources are not read again.
+
+import concurrent.futures
+import hashlib
+import json
+import os
+import shutil
+import struct
+import sys
+import time
+
+import globals
+import cookmeshes
+import cooktextures
+
+# Archive entry types (see AthiVegam/Assets/Archive.h).
+RAW, MESH, TEXTURE, VIRTUAL_TEXTURE = 0, 1, 2, 3
+
+REMOTE_CACHE = "COOK_REMOTE_CACHE"
+MANIFEST = "manifest.json"
+
+
+class CookError(Exception):
+    pass
+
+
+class Cooker:
+    def __init__(self, name, version, kind, cook=None,
+                 dependencies=None, keepExtension=False):
+        self.name = name
+        self.version = version
+        # Of a path, its archive entry type.
+        self.kind = kind
+        # Of a path, the cooked bytes and a line describing
+        # them; None stores the file as it is.
+        self.cook = cook
+        # Of a path, the other files cooking it reads.
+        self.dependencies = dependencies or (lambda path: [])
+        self.keepExtension = keepExtension
+
+
+def cook_obj(path):
+    blob, vertexCount, indexCount, meshletCount = \
+        cookmeshes.cook_mesh(path)
+    return bytes(blob), \
+        "{} vertices, {} indices, {} meshlets".format(
+            vertexCount, indexCount, meshletCount)
+
+
+def texture_kind(path):
+    return VIRTUAL_TEXTURE if cooktextures.is_virtual(path) \
+        else TEXTURE
+
+
+COOKERS = {
+    ".obj": Cooker("mesh", cookmeshes.COOK_VERSION,
+                   lambda path: MESH, cook_obj),
+    ".png": Cooker("texture", cooktextures.COOK_VERSION,
+                   texture_kind, cooktextures.cook_texture),
+    ".ktx2": Cooker("ktx2", 1, lambda path: TEXTURE),
+}
+RAW_COOKER = Cooker("raw", 1, lambda path: RAW,
+                    keepExtension=True)
+
+
+def cooker_for(path):
+    extension = os.path.splitext(path)[1].lower()
+    return COOKERS.get(extension, RAW_COOKER)
+
+
+class Cache:
+    # Cooked results by key, local and optionally shared.
+
+    def __init__(self, local, remote=None):
+        self.local = local
+        self.remote = remote
+        os.makedirs(local, exist_ok=True)
+
+    @staticmethod
+    def path_in(root, key):
+        return os.path.join(root, key[:2], key)
+
+    @staticmethod
+    def write(path, data):
+        # Written aside and renamed, so readers in other
+        # processes never see a partial result.
+        os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
+        temporary = "{}.{}".format(path, os.getpid())
+        with open(temporary, "wb") as file:
+            file.write(data)
+        os.replace(temporary, path)
+
+    def has(self, key):
+        if os.path.isfile(self.path_in(self.local, key)):
+            return True
+        if not self.remote:
+            return False
+        shared = self.path_in(self.remote, key)
+        if not os.path.isfile(shared):
+            return False
+        local = self.path_in(self.local, key)
+        os.makedirs(os.path.dirname(local), exist_ok=True)
+        shutil.copyfile(shared, local + ".copy")
+        os.replace(local + ".copy", local)
+        return True
+
+    def get(self, key):
+        with open(self.path_in(self.local, key), "rb") as file:
+            return file.read()
+
+    def put(self, key, data):
+        self.write(self.path_in(self.local, key), data)
+        if self.remote:
+            try:
+                self.write(self.path_in(self.remote, key), data)
+            except OSError as error:
+                print("warning: cannot share {}: {}".format(
+                    key, error))
+
+
+class Hashes:
+    # Content hashes of sources, kept across runs with the
+    # size and modification time they were taken at.
+
+    def __init__(self, path):
+        self.path = path
+        self.entries = {}
+        self.changed = False
+        if os.path.isfile(path):
+            try:
+                with open(path) as file:
+                    self.entries = json.load(file)
+            except (OSError, ValueError):
+                self.entries = {}
+
+    def get(self, path):
+        status = os.stat(path)
+        stamp = [status.st_size, status.st_mtime_ns]
+        entry = self.entries.get(path)
+        if entry and entry[0] == stamp:
+            return entry[1]
+        hasher = hashlib.sha256()
+        with open(path, "rb") as file:
+            for block in iter(lambda: file.read(1 << 20), b""):
+                hasher.update(block)
+        digest = hasher.hexdigest()
+        self.entries[path] = [stamp, digest]
+        self.changed = True
+        return digest
+
+    def save(self):
+        if self.changed:
+            Cache.write(self.path, json.dumps(
+                self.entries).encode())
+
+
+def asset_keys(paths, hashes):
+    # Keys in dependency order: a file's key includes the
+    # keys of the files its cooker reads, so editing one
+    # re-cooks everything that reads it.
+    keys = {}
+    visiting = set()
+
+    def visit(path):
+        if path in keys:
+            return keys[path]
+        if path in visiting:
+            raise CookError("{} depends on itself".format(path))
+        visiting.add(path)
+        cooker = cooker_for(path)
+        hasher = hashlib.sha256()
+        hasher.update(cooker.name.encode())
+        hasher.update(struct.pack("<I", cooker.version))
+        hasher.update(os.path.basename(path).lower().encode())
+        try:
+            hasher.update(hashes.get(path).encode())
+        except OSError as error:
+            raise CookError("{}: {}".format(path, error))
+        for dependency in sorted(cooker.dependencies(path)):
+            hasher.update(visit(dependency).encode())
+        visiting.discard(path)
+        keys[path] = hasher.hexdigest()
+        return keys[path]
+
+    for path in paths:
+        visit(path)
+    return keys
+
+
+def cook_one(path):
+    # Runs in a worker process.
+    return cooker_for(path).cook(path)
+
+
+def default_cache():
+    return os.path.join(globals.PROJECT_NAME, ".cookcache")
+
+
+def collect(root):
+    paths = []
+    for directory, _, files in os.walk(root):
+        for name in sorted(files):
+            paths.append(os.path.join(directory, name))
+    return paths
+
+
+def asset_name(path, root):
+    relative = os.path.relpath(path, root).replace(os.sep, "/")
+    if cooker_for(path).keepExtension:
+        return relative
+    return os.path.splitext(relative)[0]
+
+
+def cook(root, cache=None):
+    # Returns (name, entry type, bytes) of every asset below
+    # root, cooking those no cache has.
+    start = time.time()
+    cache = Cache(cache or default_cache(),
+                  os.environ.get(REMOTE_CACHE))
+    hashes = Hashes(os.path.join(cache.local, MANIFEST))
+    paths = collect(root)
+    keys = asset_keys(paths, hashes)
+
+    stale = [path for path in paths
+             if cooker_for(path).cook
+             and not cache.has(keys[path])]
+    if stale:
+        with concurrent.futures.ProcessPoolExecutor() as pool:
+            futures = {pool.submit(cook_one, path): path
+                       for path in stale}
+            for future in concurrent.futures.as_completed(
+                    futures):
+                path = futures[future]
+                try:
+                    data, description = future.result()
+                except Exception as error:
+                    raise CookError("{}: {}".format(path, error))
+                cache.put(keys[path], data)
+                print("{}: {}".format(path, description))
+    hashes.save()
+
+    assets = []
+    for path in paths:
+        cooker = cooker_for(path)
+        if cooker.cook:
+            data = cache.get(keys[path])
+        else:
+            with open(path, "rb") as file:
+                data = file.read()
+        assets.append((asset_name(path, root),
+                       cooker.kind(path), data))
+    print("Cooked {} of {} assets in {:.1f} s".format(
+        len(stale), len(paths), time.time() - start))
+    return assets
+
+
+def cook_file(path, output, cache=None):
+    cache = Cache(cache or default_cache(),
+                  os.environ.get(REMOTE_CACHE))
+    hashes = Hashes(os.path.join(cache.local, MANIFEST))
+    cooker = cooker_for(path)
+    if cooker.cook:
+        key = asset_keys([path], hashes)[path]
+        if not cache.has(key):
+            try:
+                data, description = cooker.cook(path)
+            except Exception as error:
+                raise CookError("{}: {}".format(path, error))
+            cache.put(key, data)
+            print("{}: {}".format(path, description))
+        data = cache.get(key)
+    else:
+        with open(path, "rb") as file:
+            data = file.read()
+    hashes.save()
+    Cache.write(output, data)
+
+
+def main():
+    if len(sys.argv) > 1 and sys.argv[1] == "--one":
+        if len(sys.argv) < 4:
+            print("usage: cook.py --one <source> <output>")
+            return 1
+        try:
+            cook_file(sys.argv[2], sys.argv[3])
+        except (CookError, OSError) as error:
+            print("error:", error)
+            return 1
+        return 0
+
+    project = globals.PROJECT_NAME
+    root = sys.argv[1] if len(sys.argv) > 1 else \
+        os.path.join(project, "assets")
+    if not os.path.isdir(root):
+        print("No assets to cook in {}".format(root))
+        return 0
+    try:
+        cook(root)
+    except CookError as error:
+        print("error:", error)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
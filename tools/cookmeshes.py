@@ -0,0 +1,334 @@
+# Cooks Wavefront OBJ files into a mesh pack (see
+# AthiVegam/Assets/MeshPack.h) that the engine maps and
+# uploads without parsing. Every .obj below the asset root
+# is cooked; its asset name is its path below the root
+# without extension, e.g. "props/rock".
+#
+#   python3 tools/cookmeshes.py <asset root> <output.avmp>
+#
+# Vertices are position (Float3, location 0), then the
+# normal (Int1010102Norm, location 1) and texture
+# coordinates (Half2, location 2) when the file has them.
+#
+# Meshes of MIN_MESHLET_TRIANGLES or more are split into
+# meshlets (see AthiVegam/Graphics/Meshlet.h) that the GPU
+# culls one by one: their triangles are reordered so each
+# meshlet's are contiguous, grown from a seed through
+# neighbours that add the fewest new vertices.
+
+import math
+import os
+import struct
+import sys
+
+# Bump to re-cook every mesh.
+COOK_VERSION = 1
+
+MAGIC = 0x504D5641  # "AVMP"
+VERSION = 1
+ALIGNMENT = 16
+MAX_ATTRIBUTES = 8
+
+# Graphics::VertexFormat values and sizes.
+FLOAT3, HALF2, INT1010102_NORM = 2, 4, 12
+FORMAT_SIZES = {FLOAT3: 12, HALF2: 4, INT1010102_NORM: 4}
+
+PACK_HEADER = struct.Struct("<IIII")
+PACK_ENTRY = struct.Struct("<QQQ")
+MESH_HEADER_SIZE = 64
+
+# Graphics::Meshlet.
+MESHLET = struct.Struct("<4f4fII8x")
+MESHLET_MAX_VERTICES = 64
+MESHLET_MAX_TRIANGLES = 124
+# Smaller meshes are culled whole well enough.
+MIN_MESHLET_TRIANGLES = 4096
+# Normal cones wider than this (the cosine of their half
+# angle) are never culled.
+MIN_CONE_DOT = 0.1
+
+
+def asset_id(name):
+    # AthiVegam::Assets::MakeAssetId, 64-bit FNV-1a.
+    value = 14695981039346656037
+    for byte in name.encode("utf-8"):
+        value ^= byte
+        value = (value * 1099511628211) & 0xFFFFFFFFFFFFFFFF
+    return value
+
+
+def align(value):
+    return (value + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+
+def quantize_snorm(value, bits):
+    limit = (1 << (bits - 1)) - 1
+    value = round(max(-1.0, min(1.0, value)) * limit)
+    return value & ((1 << bits) - 1)
+
+
+def pack_1010102(x, y, z):
+    return (quantize_snorm(x, 10)
+            | quantize_snorm(y, 10) << 10
+            | quantize_snorm(z, 10) << 20)
+
+
+def load_obj(path):
+    positions, texcoords, normals = [], [], []
+    corners = []
+    with open(path) as file:
+        for line in file:
+            parts = line.split()
+            if not parts:
+                continue
+            if parts[0] == "v":
+                positions.append(tuple(map(float, parts[1:4])))
+            elif parts[0] == "vt":
+                texcoords.append(tuple(map(float, parts[1:3])))
+            elif parts[0] == "vn":
+                normals.append(tuple(map(float, parts[1:4])))
+            elif parts[0] == "f":
+                face = [parse_corner(corner, positions,
+                                     texcoords, normals)
+                        for corner in parts[1:]]
+                # Polygons as triangle fans.
+                for i in range(1, len(face) - 1):
+                    corners += [face[0], face[i], face[i + 1]]
+    return positions, texcoords, normals, corners
+
+
+def parse_corner(corner, positions, texcoords, normals):
+    # v, v/vt, v//vn or v/vt/vn; negative indices count
+    # back from the last element read so far.
+    fields = corner.split("/") + ["", ""]
+
+    def index(field, count):
+        if not field:
+            return -1
+        value = int(field)
+        return value - 1 if value > 0 else count + value
+
+    return (index(fields[0], len(positions)),
+            index(fields[1], len(texcoords)),
+            index(fields[2], len(normals)))
+
+
+def sub(a, b):
+    return (a[0] - b[0], a[1] - b[1], a[2] - b[2])
+
+
+def dot(a, b):
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]
+
+
+def cross(a, b):
+    return (a[1] * b[2] - a[2] * b[1],
+            a[2] * b[0] - a[0] * b[2],
+            a[0] * b[1] - a[1] * b[0])
+
+
+def normalize(a):
+    length = math.sqrt(dot(a, a))
+    return tuple(x / length for x in a) if length > 0 else None
+
+
+def cluster_triangles(indices, vertexCount):
+    # Returns lists of triangle numbers, one per meshlet.
+    triangleCount = len(indices) // 3
+    adjacency = [[] for _ in range(vertexCount)]
+    for t in range(triangleCount):
+        for v in indices[3 * t:3 * t + 3]:
+            adjacency[v].append(t)
+
+    used = [False] * triangleCount
+    meshlets = []
+    seed = 0
+    while True:
+        while seed < triangleCount and used[seed]:
+            seed += 1
+        if seed == triangleCount:
+            return meshlets
+
+        vertices = set()
+        triangles = []
+        candidates = {seed}
+        while candidates and len(triangles) < \
+                MESHLET_MAX_TRIANGLES:
+            best = min(candidates, key=lambda t: (
+                sum(v not in vertices
+                    for v in indices[3 * t:3 * t + 3]), t))
+            candidates.discard(best)
+            new = {v for v in indices[3 * best:3 * best + 3]
+                   if v not in vertices}
+            if len(vertices) + len(new) > MESHLET_MAX_VERTICES:
+                continue
+            used[best] = True
+            triangles.append(best)
+            vertices |= new
+            for v in new:
+                candidates.update(t for t in adjacency[v]
+                                  if not used[t])
+        meshlets.append(triangles)
+
+
+def meshlet_bounds(positions, indices):
+    points = [positions[v] for v in set(indices)]
+    lo = [min(p[i] for p in points) for i in range(3)]
+    hi = [max(p[i] for p in points) for i in range(3)]
+    center = tuple((lo[i] + hi[i]) * 0.5 for i in range(3))
+    radius = max(math.sqrt(dot(sub(p, center), sub(p, center)))
+                 for p in points)
+
+    normals = []
+    for t in range(0, len(indices), 3):
+        a, b, c = (positions[v] for v in indices[t:t + 3])
+        normal = normalize(cross(sub(b, a), sub(c, a)))
+        if normal:
+            normals.append(normal)
+    axis = normalize(tuple(sum(n[i] for n in normals)
+                           for i in range(3))) \
+        if normals else None
+    minDot = min(dot(axis, n) for n in normals) if axis else 0
+    if minDot <= MIN_CONE_DOT:
+        return center, radius, (0.0, 0.0, 0.0), 1.0
+    # The sine of the cone's half angle, widened by the
+    # sphere in the engine's test.
+    return center, radius, axis, math.sqrt(1 - minDot * minDot)
+
+
+def build_meshlets(positions, indices):
+    # Reorders indices meshlet by meshlet; returns the
+    # packed meshlets.
+    clusters = cluster_triangles(indices, len(positions))
+    reordered = []
+    data = bytearray()
+    for triangles in clusters:
+        first = len(reordered)
+        for t in triangles:
+            reordered += indices[3 * t:3 * t + 3]
+        center, radius, axis, cutoff = meshlet_bounds(
+            positions, reordered[first:])
+        data += MESHLET.pack(*center, radius, *axis, cutoff,
+                             first, len(reordered) - first)
+    indices[:] = reordered
+    return data, len(clusters)
+
+
+def cook_mesh(path):
+    positions, texcoords, normals, corners = load_obj(path)
+    hasUv = bool(texcoords) and all(c[1] >= 0 for c in corners)
+    hasNormal = bool(normals) and all(c[2] >= 0
+                                      for c in corners)
+
+    attributes = [(0, FLOAT3)]
+    if hasNormal:
+        attributes.append((1, INT1010102_NORM))
+    if hasUv:
+        attributes.append((2, HALF2))
+
+    # One vertex per distinct corner.
+    remap = {}
+    vertices = bytearray()
+    vertexPositions = []
+    indices = []
+    for corner in corners:
+        key = (corner[0], corner[1] if hasUv else -1,
+               corner[2] if hasNormal else -1)
+        if key not in remap:
+            remap[key] = len(remap)
+            vertexPositions.append(positions[key[0]])
+            vertices += struct.pack("<3f", *positions[key[0]])
+            if hasNormal:
+                vertices += struct.pack(
+                    "<I", pack_1010102(*normals[key[2]]))
+            if hasUv:
+                vertices += struct.pack("<2e",
+                                        *texcoords[key[1]])
+        indices.append(remap[key])
+
+    meshlets, meshletCount = bytearray(), 0
+    if len(indices) // 3 >= MIN_MESHLET_TRIANGLES:
+        meshlets, meshletCount = build_meshlets(
+            vertexPositions, indices)
+
+    stride = sum(FORMAT_SIZES[f] for _, f in attributes)
+    vertexOffset = MESH_HEADER_SIZE
+    indexOffset = align(vertexOffset + len(vertices))
+    meshletOffset = align(indexOffset + 4 * len(indices)) \
+        if meshletCount else 0
+
+    attributeData = bytearray()
+    offset = 0
+    for location, format in attributes:
+        attributeData += struct.pack("<BBH", location, format,
+                                     offset)
+        offset += FORMAT_SIZES[format]
+    attributeData += bytes(4 * (MAX_ATTRIBUTES
+                                - len(attributes)))
+
+    blob = bytearray(struct.pack("<IIII", len(remap),
+                                 len(indices), stride,
+                                 len(attributes)))
+    blob += attributeData
+    blob += struct.pack("<IIII", vertexOffset, indexOffset,
+                        meshletCount, meshletOffset)
+    blob += vertices
+    blob += bytes(indexOffset - len(blob))
+    blob += struct.pack("<{}I".format(len(indices)), *indices)
+    if meshletCount:
+        blob += bytes(meshletOffset - len(blob))
+        blob += meshlets
+    return blob, len(remap), len(indices), meshletCount
+
+
+def main():
+    if len(sys.argv) < 3:
+        print("usage: cookmeshes.py <asset root> <output>")
+        return 1
+
+    root, output = sys.argv[1], sys.argv[2]
+    meshes = []
+    for directory, _, files in os.walk(root):
+        for name in sorted(files):
+            if not name.lower().endswith(".obj"):
+                continue
+            path = os.path.join(directory, name)
+            assetName = os.path.splitext(
+                os.path.relpath(path, root))[0].replace(
+                    os.sep, "/")
+            blob, vertexCount, elementCount, meshletCount = \
+                cook_mesh(path)
+            print("{}: {} vertices, {} indices, {} meshlets"
+                  .format(assetName, vertexCount, elementCount,
+                          meshletCount))
+            meshes.append((asset_id(assetName), assetName,
+                           blob))
+
+    meshes.sort()
+    for a, b in zip(meshes, meshes[1:]):
+        if a[0] == b[0]:
+            print("Asset ids of {} and {} collide".format(
+                a[1], b[1]))
+            return 1
+
+    # Header and manifest, then the meshes, each aligned.
+    offset = align(PACK_HEADER.size
+                   + PACK_ENTRY.size * len(meshes))
+    data = bytearray(PACK_HEADER.pack(MAGIC, VERSION,
+                                      len(meshes), 0))
+    for id, _, blob in meshes:
+        data += PACK_ENTRY.pack(id, offset, len(blob))
+        offset = align(offset + len(blob))
+    for _, _, blob in meshes:
+        data += bytes(align(len(data)) - len(data))
+        data += blob
+
+    with open(output, "wb") as file:
+        file.write(data)
+    print("Wrote {} meshes, {} KB to {}".format(
+        len(meshes), len(data) // 1024, output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,193 @@
+# Cooks GLSL stages into a shader pack (see
+# AthiVegam/Assets/ShaderPack.h) that
+# ResourceManager::CreateShaderFromFiles() reads instead of
+# the files once mounted. Every .vert, .frag and .comp below
+# the shader root is cooked; its name is its path below the
+# project with '/' separators, e.g. "shaders/Quad.vert", as
+# the game passes it.
+#
+#   python3 cli.py cookshaders
+#   python3 tools/cookshaders.py [shader root] [output.avsp]
+#
+# The root defaults to <project>/shaders and the output to
+# <project>/shaders.avsp. Cooking:
+#  - resolves #include "file", relative to the including
+#    file, each file once;
+#  - strips comments and blank lines;
+#  - compiles every variant the source declares with
+#    "#pragma variants FEATURE ..." (each feature on or off,
+#    as ShaderVariants defines them) through
+#    glslangValidator when it is on the PATH, and fails on
+#    the first error. The pack keeps one source per stage;
+#    variants are still specialized at runtime.
+
+import itertools
+import os
+import re
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+
+import globals
+from cookmeshes import asset_id
+
+MAGIC = 0x50535641  # "AVSP"
+VERSION = 1
+ALIGNMENT = 16
+STAGES = (".vert", ".frag", ".comp")
+# Variants compiled per source at most; beyond that only
+# the base and each feature alone are.
+MAX_VARIANTS = 64
+
+HEADER = struct.Struct("<IIII")
+ENTRY = struct.Struct("<QQQ")
+
+INCLUDE = re.compile(r'^\s*#\s*include\s+"([^"]+)"')
+VARIANTS = re.compile(r"^\s*#\s*pragma\s+variants\b(.*)$")
+
+
+def align(value):
+    return (value + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+
+class CookError(Exception):
+    pass
+
+
+def preprocess(path, included, features):
+    lines = []
+    with open(path) as file:
+        for number, line in enumerate(file, 1):
+            match = INCLUDE.match(line)
+            if match:
+                target = os.path.normpath(os.path.join(
+                    os.path.dirname(path), match.group(1)))
+                if not os.path.isfile(target):
+                    raise CookError("{}:{}: cannot include {}"
+                                    .format(path, number,
+                                            match.group(1)))
+                if target not in included:
+                    included.add(target)
+                    lines += preprocess(target, included,
+                                        features)
+                continue
+            match = VARIANTS.match(line)
+            if match:
+                features += [f for f in match.group(1).split()
+                             if f not in features]
+                continue
+            lines.append(line.rstrip("\n"))
+    return lines
+
+
+def strip_comments(lines):
+    text = "\n".join(lines)
+    text = re.sub(r"/\*.*?\*/", " ", text, flags=re.S)
+    text = re.sub(r"//[^\n]*", "", text)
+    return "\n".join(line.rstrip() for line in text.split("\n")
+                     if line.strip()) + "\n"
+
+
+def specialize(source, defines):
+    # Like ShaderVariants: right after #version.
+    lines = source.split("\n")
+    insert = next((i + 1 for i, line in enumerate(lines)
+                   if line.lstrip().startswith("#version")), 0)
+    return "\n".join(lines[:insert]
+                     + ["#define {} 1".format(d) for d in defines]
+                     + lines[insert:])
+
+
+def variants(features):
+    combinations = itertools.chain.from_iterable(
+        itertools.combinations(features, count)
+        for count in range(len(features) + 1))
+    if 2 ** len(features) <= MAX_VARIANTS:
+        return list(combinations)
+    return [()] + [(feature,) for feature in features]
+
+
+def validate(validator, name, source, features):
+    extension = os.path.splitext(name)[1]
+    for defines in variants(features):
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "shader" + extension)
+            with open(path, "w") as file:
+                file.write(specialize(source, defines))
+            result = subprocess.run([validator, path],
+                                    capture_output=True,
+                                    text=True)
+        if result.returncode != 0:
+            raise CookError("{} [{}]:\n{}".format(
+                name, " ".join(defines) or "base",
+                result.stdout.strip() or result.stderr.strip()))
+
+
+def main():
+    project = globals.PROJECT_NAME
+    root = sys.argv[1] if len(sys.argv) > 1 else \
+        os.path.join(project, "shaders")
+    output = sys.argv[2] if len(sys.argv) > 2 else \
+        os.path.join(project, "shaders.avsp")
+    if not os.path.isdir(root):
+        print("No shaders to cook in {}".format(root))
+        return 0
+
+    validator = shutil.which("glslangValidator")
+    if not validator:
+        print("glslangValidator not found; shaders are not "
+              "validated")
+
+    base = os.path.dirname(os.path.abspath(root))
+    shaders = []
+    try:
+        for directory, _, files in os.walk(root):
+            for file in sorted(files):
+                if os.path.splitext(file)[1] not in STAGES:
+                    continue
+                path = os.path.join(directory, file)
+                name = os.path.relpath(os.path.abspath(path),
+                                       base).replace(os.sep, "/")
+                features = []
+                source = strip_comments(preprocess(
+                    path, {os.path.normpath(path)}, features))
+                if validator:
+                    validate(validator, name, source, features)
+                print("{}: {} bytes, {} features".format(
+                    name, len(source), len(features)))
+                shaders.append((asset_id(name), name,
+                                source.encode("utf-8")))
+    except CookError as error:
+        print("error:", error)
+        return 1
+
+    shaders.sort()
+    for a, b in zip(shaders, shaders[1:]):
+        if a[0] == b[0]:
+            print("Asset ids of {} and {} collide".format(
+                a[1], b[1]))
+            return 1
+
+    # Header and manifest, then each source terminated, so
+    # the engine can hand it to GL in place.
+    offset = align(HEADER.size + ENTRY.size * len(shaders))
+    data = bytearray(HEADER.pack(MAGIC, VERSION, len(shaders),
+                                 0))
+    for id, _, source in shaders:
+        data += ENTRY.pack(id, offset, len(source))
+        offset = align(offset + len(source) + 1)
+    for _, _, source in shaders:
+        data += bytes(align(len(data)) - len(data))
+        data += source + b"\0"
+
+    with open(output, "wb") as file:
+        file.write(data)
+    print("Wrote {} shaders, {} KB to {}".format(
+        len(shaders), len(data) // 1024, output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,522 @@
+# Cooks PNG images into KTX2 textures (see
+# AthiVegam/Assets/Ktx2.h) with a full mip chain, block
+# compressed, so the engine uploads them as they are.
+# cook.py cooks every .png below the asset root this way
+# and names it without its extension, like .ktx2 files.
+# By name and content:
+#  - files ending in _n or _normal are normal maps: their
+#    levels are renormalized and x and y stored as BC5;
+#  - grayscale images are data, such as masks, stored as
+#    BC4;
+#  - the rest are sRGB color, BC1 or, with any alpha below
+#    255, BC3; their levels are filtered in linear light;
+#  - files ending in _vt are virtual textures (see
+#    AthiVegam/Graphics/VirtualTexture.h): every level cut
+#    into bordered RGBA8 pages, one archive chunk each.
+# Levels are filtered from the previous one with a
+# [1 3 3 1] tent, sharper than a box without ringing. The
+# first row stored is the bottom one, as GL takes it.
+
+import os
+import struct
+import zlib
+
+# Bump to re-cook every texture.
+COOK_VERSION = 1
+
+PNG_SIGNATURE = b"\x89PNG\r\n\x1a\n"
+KTX2_IDENTIFIER = bytes([0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+                         0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A])
+KTX2_HEADER = struct.Struct("<12s13IQQ")
+KTX2_LEVEL = struct.Struct("<QQQ")
+
+COLOR, NORMAL, DATA = "color", "normal", "data"
+
+VIRTUAL_MAGIC = 0x54564156  # "AVVT"
+VIRTUAL_VERSION = 1
+PAGE_SIZE = 128
+PAGE_BORDER = 4
+PAGE_CONTENT = PAGE_SIZE - 2 * PAGE_BORDER
+# Archive chunk size; the header fills the first chunk.
+PAGE_BYTES = PAGE_SIZE * PAGE_SIZE * 4
+
+# VkFormat, bytes per 4x4 block and Khronos data format
+# color model of each output.
+BC1_SRGB = (134, 8, 128)
+BC3_SRGB = (138, 16, 130)
+BC4 = (139, 8, 131)
+BC5 = (141, 16, 132)
+
+# Khronos data format channel ids.
+CHANNEL_COLOR, CHANNEL_GREEN, CHANNEL_ALPHA = 0, 1, 15
+
+
+class CookError(Exception):
+    pass
+
+
+def srgb_to_linear(value):
+    value /= 255.0
+    if value <= 0.04045:
+        return value / 12.92
+    return ((value + 0.055) / 1.055) ** 2.4
+
+
+def linear_to_srgb(value):
+    value = min(max(value, 0.0), 1.0)
+    if value <= 0.0031308:
+        value *= 12.92
+    else:
+        value = 1.055 * value ** (1.0 / 2.4) - 0.055
+    return int(value * 255.0 + 0.5)
+
+
+SRGB_TO_LINEAR = [srgb_to_linear(i) for i in range(256)]
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def unfilter(row, previous, kind, bpp):
+    count = len(row)
+    if kind == 0:
+        return
+    if kind == 1:
+        for i in range(bpp, count):
+            row[i] = (row[i] + row[i - bpp]) & 255
+    elif kind == 2:
+        for i in range(count):
+            row[i] = (row[i] + previous[i]) & 255
+    elif kind == 3:
+        for i in range(count):
+            left = row[i - bpp] if i >= bpp else 0
+            row[i] = (row[i] + ((left + previous[i]) >> 1)) & 255
+    elif kind == 4:
+        for i in range(count):
+            left = row[i - bpp] if i >= bpp else 0
+            corner = previous[i - bpp] if i >= bpp else 0
+            row[i] = (row[i]
+                      + paeth(left, previous[i], corner)) & 255
+    else:
+        raise CookError("bad PNG filter {}".format(kind))
+
+
+def decode_png(data):
+    # 8-bit, non-interlaced PNGs of any color type. Returns
+    # the size, whether it is grayscale, and RGBA rows from
+    # the bottom one up.
+    if data[:8] != PNG_SIGNATURE:
+        raise CookError("not a PNG file")
+    position = 8
+    header = None
+    palette = b""
+    transparency = b""
+    compressed = bytearray()
+    while position + 8 <= len(data):
+        length, kind = struct.unpack(
+            ">I4s", data[position:position + 8])
+        body = data[position + 8:position + 8 + length]
+        position += length + 12
+        if kind == b"IHDR":
+            header = struct.unpack(">IIBBBBB", body)
+        elif kind == b"PLTE":
+            palette = body
+        elif kind == b"tRNS":
+            transparency = body
+        elif kind == b"IDAT":
+            compressed += body
+        elif kind == b"IEND":
+            break
+    if header is None:
+        raise CookError("PNG without a header")
+    width, height, depth, colorType, _, _, interlace = header
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(colorType)
+    if depth != 8 or interlace != 0 or channels is None:
+        raise CookError("only 8-bit, non-interlaced PNGs are "
+                        "cooked")
+
+    raw = zlib.decompress(bytes(compressed))
+    stride = width * channels
+    rows = []
+    previous = bytearray(stride)
+    for y in range(height):
+        start = y * (stride + 1)
+        row = bytearray(raw[start + 1:start + 1 + stride])
+        unfilter(row, previous, raw[start], channels)
+        rows.append(row)
+        previous = row
+
+    pixels = bytearray(width * height * 4)
+    for y, row in enumerate(reversed(rows)):
+        out = y * width * 4
+        for x in range(width):
+            if colorType == 3:
+                index = row[x]
+                rgb = palette[index * 3:index * 3 + 3]
+                alpha = transparency[index] \
+                    if index < len(transparency) else 255
+                texel = (rgb[0], rgb[1], rgb[2], alpha)
+            elif channels <= 2:
+                gray = row[x * channels]
+                alpha = row[x * 2 + 1] if channels == 2 else 255
+                texel = (gray, gray, gray, alpha)
+            else:
+                i = x * channels
+                texel = (row[i], row[i + 1], row[i + 2],
+                         row[i + 3] if channels == 4 else 255)
+            pixels[out:out + 4] = bytes(texel)
+            out += 4
+    return width, height, colorType in (0, 4), pixels
+
+
+def downsample(plane, width, height):
+    # Halves each axis with a [1 3 3 1] / 8 tent, clamped
+    # at the edges; odd sizes round down.
+    def filter_axis(source, count, lines, step, stride):
+        half = max(count // 2, 1)
+        if count == 1:
+            return list(source), half
+        result = [0.0] * (half * lines)
+        for line in range(lines):
+            base = line * stride
+            for i in range(half):
+                a = source[base + max(2 * i - 1, 0) * step]
+                b = source[base + 2 * i * step]
+                c = source[base + min(2 * i + 1, count - 1) * step]
+                d = source[base + min(2 * i + 2, count - 1) * step]
+                result[line * half + i] = \
+                    (a + 3.0 * (b + c) + d) * 0.125
+        return result, half
+
+    rows, newWidth = filter_axis(plane, width, height, 1, width)
+    # Columns of the narrowed rows, back to rows after.
+    columns, newHeight = filter_axis(rows, height, newWidth,
+                                     newWidth, 1)
+    result = [0.0] * (newWidth * newHeight)
+    for x in range(newWidth):
+        for y in range(newHeight):
+            result[y * newWidth + x] = columns[x * newHeight + y]
+    return result
+
+
+def to_planes(kind, pixels, count):
+    planes = [[0.0] * count for _ in range(4)]
+    for i in range(count):
+        r, g, b, a = pixels[i * 4:i * 4 + 4]
+        if kind == COLOR:
+            planes[0][i] = SRGB_TO_LINEAR[r]
+            planes[1][i] = SRGB_TO_LINEAR[g]
+            planes[2][i] = SRGB_TO_LINEAR[b]
+        elif kind == NORMAL:
+            planes[0][i] = r / 127.5 - 1.0
+            planes[1][i] = g / 127.5 - 1.0
+            planes[2][i] = b / 127.5 - 1.0
+        else:
+            planes[0][i] = r / 255.0
+            planes[1][i] = g / 255.0
+            planes[2][i] = b / 255.0
+        planes[3][i] = a / 255.0
+    return planes
+
+
+def to_pixels(kind, planes, count):
+    pixels = bytearray(count * 4)
+    for i in range(count):
+        x, y, z = planes[0][i], planes[1][i], planes[2][i]
+        if kind == COLOR:
+            rgb = (linear_to_srgb(x), linear_to_srgb(y),
+                   linear_to_srgb(z))
+        elif kind == NORMAL:
+            length = (x * x + y * y + z * z) ** 0.5 or 1.0
+            rgb = tuple(int(min(max((v / length + 1.0) * 127.5,
+                                    0.0), 255.0) + 0.5) & 255
+                        for v in (x, y, z))
+        else:
+            rgb = tuple(int(min(max(v, 0.0), 1.0) * 255.0 + 0.5)
+                        for v in (x, y, z))
+        alpha = int(min(max(planes[3][i], 0.0), 1.0) * 255.0
+                    + 0.5)
+        pixels[i * 4:i * 4 + 4] = bytes(rgb + (alpha,))
+    return pixels
+
+
+def block_texels(pixels, width, height, bx, by):
+    texels = []
+    for y in range(4):
+        row = min(by * 4 + y, height - 1) * width
+        for x in range(4):
+            i = (row + min(bx * 4 + x, width - 1)) * 4
+            texels.append(pixels[i:i + 4])
+    return texels
+
+
+def encode_565(color):
+    r, g, b = (min(max(int(c + 0.5), 0), 255) for c in color)
+    return (r * 31 + 127) // 255 << 11 \
+        | (g * 63 + 127) // 255 << 5 | (b * 31 + 127) // 255
+
+
+def decode_565(value):
+    r, g, b = value >> 11, value >> 5 & 63, value & 31
+    return ((r << 3) | (r >> 2), (g << 2) | (g >> 4),
+            (b << 3) | (b >> 2))
+
+
+def encode_color_block(texels):
+    # Endpoints at the extremes of the colors along their
+    # principal axis, then indices by projection.
+    colors = [tuple(texel[:3]) for texel in texels]
+    mean = [sum(c[k] for c in colors) / 16.0 for k in range(3)]
+    covariance = [0.0] * 6
+    for c in colors:
+        d = [c[k] - mean[k] for k in range(3)]
+        covariance[0] += d[0] * d[0]
+        covariance[1] += d[0] * d[1]
+        covariance[2] += d[0] * d[2]
+        covariance[3] += d[1] * d[1]
+        covariance[4] += d[1] * d[2]
+        covariance[5] += d[2] * d[2]
+    axis = [1.0, 1.0, 1.0]
+    for _ in range(4):
+        x, y, z = axis
+        axis = [covariance[0] * x + covariance[1] * y
+                + covariance[2] * z,
+                covariance[1] * x + covariance[3] * y
+                + covariance[4] * z,
+                covariance[2] * x + covariance[4] * y
+                + covariance[5] * z]
+        length = max(abs(v) for v in axis)
+        if length == 0.0:
+            axis = [0.0, 0.0, 0.0]
+            break
+        axis = [v / length for v in axis]
+    projections = [sum((c[k] - mean[k]) * axis[k]
+                       for k in range(3)) for c in colors]
+    low = colors[projections.index(min(projections))]
+    high = colors[projections.index(max(projections))]
+
+    c0, c1 = encode_565(high), encode_565(low)
+    if c0 < c1:
+        c0, c1 = c1, c0
+    if c0 == c1:
+        return struct.pack("<HHI", c0, c1, 0)
+    e0, e1 = decode_565(c0), decode_565(c1)
+    # Index of each step from e1 to e0 in four-color mode.
+    steps = (1, 3, 2, 0)
+    direction = [e0[k] - e1[k] for k in range(3)]
+    scale = 3.0 / sum(v * v for v in direction)
+    indices = 0
+    for i, c in enumerate(colors):
+        t = sum((c[k] - e1[k]) * direction[k]
+                for k in range(3)) * scale
+        step = min(max(int(t + 0.5), 0), 3)
+        indices |= steps[step] << (2 * i)
+    return struct.pack("<HHI", c0, c1, indices)
+
+
+def encode_alpha_block(values):
+    # Eight-value mode between the extremes.
+    high, low = max(values), min(values)
+    if high == low:
+        return struct.pack("<BB6x", high, low)
+    # Index of each step from a0 to a1.
+    steps = (0, 2, 3, 4, 5, 6, 7, 1)
+    scale = 7.0 / (high - low)
+    indices = 0
+    for i, value in enumerate(values):
+        step = min(max(int((high - value) * scale + 0.5), 0), 7)
+        indices |= steps[step] << (3 * i)
+    return struct.pack("<BB", high, low) \
+        + indices.to_bytes(6, "little")
+
+
+def compress(output, pixels, width, height):
+    blocks = bytearray()
+    for by in range((height + 3) // 4):
+        for bx in range((width + 3) // 4):
+            texels = block_texels(pixels, width, height, bx, by)
+            if output == BC1_SRGB:
+                blocks += encode_color_block(texels)
+            elif output == BC3_SRGB:
+                blocks += encode_alpha_block(
+                    [t[3] for t in texels])
+                blocks += encode_color_block(texels)
+            elif output == BC4:
+                blocks += encode_alpha_block(
+                    [t[0] for t in texels])
+            else:
+                blocks += encode_alpha_block(
+                    [t[0] for t in texels])
+                blocks += encode_alpha_block(
+                    [t[1] for t in texels])
+    return bytes(blocks)
+
+
+def data_format(output):
+    # A basic descriptor block, one 64-bit sample per
+    # channel group of the block.
+    vkFormat, blockSize, model = output
+    srgb = output in (BC1_SRGB, BC3_SRGB)
+    samples = {
+        BC1_SRGB: [(0, CHANNEL_COLOR)],
+        BC3_SRGB: [(0, CHANNEL_ALPHA), (64, CHANNEL_COLOR)],
+        BC4: [(0, CHANNEL_COLOR)],
+        BC5: [(0, CHANNEL_COLOR), (64, CHANNEL_GREEN)],
+    }[output]
+    blockBytes = 24 + 16 * len(samples)
+    block = struct.pack("<IIBBBB4B8B", 0, 2 | blockBytes << 16,
+                        model, 1, 2 if srgb else 1, 0,
+                        3, 3, 0, 0, blockSize, 0, 0, 0, 0, 0, 0,
+                        0)
+    for offset, channel in samples:
+        # Alpha is linear even in sRGB textures.
+        if srgb and channel == CHANNEL_ALPHA:
+            channel |= 0x10
+        block += struct.pack("<HBB4BII", offset, 63, channel,
+                             0, 0, 0, 0, 0, 0xFFFFFFFF)
+    return struct.pack("<I", 4 + len(block)) + block
+
+
+def write_ktx2(output, width, height, levels):
+    # Levels are stored smallest first, each aligned to the
+    # block size, and indexed from level 0.
+    dfd = data_format(output)
+    # The first row is the bottom one.
+    key = b"KTXorientation\0ru\0"
+    kvd = struct.pack("<I", len(key)) + key
+    kvd += bytes(-len(kvd) % 4)
+    indexEnd = KTX2_HEADER.size + KTX2_LEVEL.size * len(levels)
+    dfdOffset = indexEnd
+    kvdOffset = dfdOffset + len(dfd)
+    offset = kvdOffset + len(kvd)
+    blockSize = output[1]
+    offsets = [0] * len(levels)
+    body = bytearray()
+    for level in reversed(range(len(levels))):
+        padding = -(offset + len(body)) % blockSize
+        body += bytes(padding)
+        offsets[level] = offset + len(body)
+        body += levels[level]
+
+    data = bytearray(KTX2_HEADER.pack(
+        KTX2_IDENTIFIER, output[0], 1, width, height, 0, 0, 1,
+        len(levels), 0, dfdOffset, len(dfd), kvdOffset,
+        len(kvd), 0, 0))
+    for level, blocks in enumerate(levels):
+        data += KTX2_LEVEL.pack(offsets[level], len(blocks),
+                                len(blocks))
+    data += dfd + kvd + body
+    return bytes(data)
+
+
+def is_virtual(path):
+    stem = os.path.splitext(os.path.basename(path))[0].lower()
+    return stem.endswith("_vt")
+
+
+def texture_kind(path, grayscale):
+    stem = os.path.splitext(os.path.basename(path))[0].lower()
+    if stem.endswith("_n") or stem.endswith("_normal"):
+        return NORMAL
+    return DATA if grayscale else COLOR
+
+
+def cut_pages(pixels, width, height):
+    # Each page's content with a border of its
+    # neighbours', clamped at the edges.
+    pages = []
+    pagesX = (width + PAGE_CONTENT - 1) // PAGE_CONTENT
+    pagesY = (height + PAGE_CONTENT - 1) // PAGE_CONTENT
+    for py in range(pagesY):
+        for px in range(pagesX):
+            columns = [min(max(px * PAGE_CONTENT - PAGE_BORDER
+                               + x, 0), width - 1)
+                       for x in range(PAGE_SIZE)]
+            page = bytearray()
+            for y in range(PAGE_SIZE):
+                row = min(max(py * PAGE_CONTENT - PAGE_BORDER + y,
+                              0), height - 1) * width
+                for x in columns:
+                    i = (row + x) * 4
+                    page += pixels[i:i + 4]
+            pages.append(bytes(page))
+    return pagesX, pagesY, pages
+
+
+def cook_virtual(path, width, height, grayscale, pixels):
+    kind = DATA if grayscale else COLOR
+    levels = []
+    planes = None
+    levelWidth, levelHeight = width, height
+    while True:
+        levels.append(cut_pages(pixels, levelWidth,
+                                levelHeight))
+        if levelWidth <= PAGE_CONTENT \
+                and levelHeight <= PAGE_CONTENT:
+            break
+        if planes is None:
+            planes = to_planes(kind, pixels,
+                               levelWidth * levelHeight)
+        planes = [downsample(plane, levelWidth, levelHeight)
+                  for plane in planes]
+        levelWidth = max(levelWidth // 2, 1)
+        levelHeight = max(levelHeight // 2, 1)
+        pixels = to_pixels(kind, planes,
+                           levelWidth * levelHeight)
+
+    pageCount = sum(len(pages) for _, _, pages in levels)
+    data = bytearray(struct.pack(
+        "<8I", VIRTUAL_MAGIC, VIRTUAL_VERSION, width, height,
+        len(levels), pageCount, 0, 0))
+    firstPage = 0
+    for pagesX, pagesY, _ in levels:
+        data += struct.pack("<4I", pagesX, pagesY, firstPage, 0)
+        firstPage += pagesX * pagesY
+    data += bytes(PAGE_BYTES - len(data))
+    for _, _, pages in levels:
+        for page in pages:
+            data += page
+    return bytes(data), "{}x{} virtual, {} levels, {} pages" \
+        .format(width, height, len(levels), pageCount)
+
+
+def cook_texture(path):
+    # Returns the KTX2 file, or the pages of a virtual
+    # texture, and a line describing it.
+    with open(path, "rb") as file:
+        source = file.read()
+    width, height, grayscale, pixels = decode_png(source)
+    if is_virtual(path):
+        return cook_virtual(path, width, height, grayscale,
+                            pixels)
+    kind = texture_kind(path, grayscale)
+    if kind == NORMAL:
+        output = BC5
+    elif kind == DATA:
+        output = BC4
+    elif any(pixels[i] != 255
+             for i in range(3, len(pixels), 4)):
+        output = BC3_SRGB
+    else:
+        output = BC1_SRGB
+
+    levels = [compress(output, pixels, width, height)]
+    planes = to_planes(kind, pixels, width * height)
+    levelWidth, levelHeight = width, height
+    while levelWidth > 1 or levelHeight > 1:
+        planes = [downsample(plane, levelWidth, levelHeight)
+                  for plane in planes]
+        levelWidth = max(levelWidth // 2, 1)
+        levelHeight = max(levelHeight // 2, 1)
+        count = levelWidth * levelHeight
+        levels.append(compress(
+            output, to_pixels(kind, planes, count), levelWidth,
+            levelHeight))
+    ktx2 = write_ktx2(output, width, height, levels)
+    return ktx2, "{}x{} {}, {} levels".format(
+        width, height, kind, len(levels))
@@ -0,0 +1,134 @@
+# Decodes a binary log written with BinaryLogMode::File
+# (see AthiVegam/Core/BinaryLog.h) into text.
+#
+#   python3 tools/decodelog.py Log.avlog [output.txt]
+
+import datetime
+import re
+import struct
+import sys
+
+MAGIC = b"AVBLOG1\0"
+LEVELS = ["trace", "debug", "info", "warning", "error",
+          "critical", "off"]
+
+INT64, UINT64, DOUBLE, BOOL, STRING, POINTER = range(6)
+FIELD = re.compile(r"\{([^{}]*)\}")
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def done(self):
+        return self.offset >= len(self.data)
+
+    def read(self, fmt):
+        values = struct.unpack_from("<" + fmt, self.data,
+                                    self.offset)
+        self.offset += struct.calcsize("<" + fmt)
+        return values if len(values) > 1 else values[0]
+
+    def string(self):
+        length = self.read("H")
+        text = self.data[self.offset:self.offset + length]
+        self.offset += length
+        return text.decode("utf-8", "replace")
+
+
+def decode_args(payload):
+    reader = Reader(payload)
+    args = []
+    while not reader.done():
+        kind = reader.read("B")
+        if kind == INT64:
+            args.append(reader.read("q"))
+        elif kind == UINT64:
+            args.append(reader.read("Q"))
+        elif kind == DOUBLE:
+            args.append(reader.read("d"))
+        elif kind == BOOL:
+            args.append(reader.read("B") != 0)
+        elif kind == STRING:
+            args.append(reader.string())
+        elif kind == POINTER:
+            args.append(hex(reader.read("Q")))
+        else:
+            raise ValueError("Unknown argument type {}"
+                             .format(kind))
+    return args
+
+
+# fmt and Python share most of the replacement field
+# syntax; only the representation of bools differs.
+def format_message(fmt, args):
+    values = iter(args)
+
+    def replace(match):
+        spec = match.group(1)
+        value = next(values, "<missing>")
+        if isinstance(value, bool) and spec in ("", ":"):
+            return "true" if value else "false"
+        try:
+            return ("{" + spec + "}").format(value)
+        except (ValueError, IndexError):
+            return str(value)
+
+    text = fmt.replace("{{", "\0").replace("}}", "\1")
+    text = FIELD.sub(replace, text)
+    return text.replace("\0", "{").replace("\1", "}")
+
+
+def decode(data, out):
+    if not data.startswith(MAGIC):
+        raise ValueError("Not a binary log")
+
+    reader = Reader(data)
+    reader.offset = len(MAGIC)
+    sites = {}
+    while not reader.done():
+        tag = reader.read("c")
+        if tag == b"S":
+            site, level, line = reader.read("IBI")
+            file = reader.string()
+            fmt = reader.string()
+            sites[site] = (level, file, line, fmt)
+        elif tag == b"M":
+            site, thread, time, size = reader.read("IIQI")
+            payload = reader.data[reader.offset:
+                                  reader.offset + size]
+            reader.offset += size
+            level, file, line, fmt = sites[site]
+            stamp = datetime.datetime.fromtimestamp(time / 1e9)
+            out.write("[{}] [{}] [thread {}] {} ({}:{})\n".format(
+                stamp.strftime("%Y-%m-%d %H:%M:%S.%f")[:-3],
+                LEVELS[level], thread,
+                format_message(fmt, decode_args(payload)),
+                file, line))
+        elif tag == b"D":
+            thread, count = reader.read("II")
+            out.write("[thread {}] {} messages dropped\n"
+                      .format(thread, count))
+        else:
+            raise ValueError("Corrupt record at offset {}"
+                             .format(reader.offset - 1))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: decodelog.py <log> [output]")
+        return 1
+
+    with open(sys.argv[1], "rb") as file:
+        data = file.read()
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], "w") as out:
+            decode(data, out)
+    else:
+        decode(data, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
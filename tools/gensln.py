@@ -1,17 +1,21 @@
 import globals
-import subprocess, sys
+import os, subprocess, sys
 
 ret = 0
 
+# GAME_MODULE=1 builds the game as a reloadable module
+# (see premake5.lua).
+options = ["--game-module"] if os.environ.get("GAME_MODULE") else []
+
 if globals.IsWindows():
-    ret = subprocess.call(["cmd.exe", "/c", "premake\\premake5", "vs2022"])
+    ret = subprocess.call(["cmd.exe", "/c", "premake\\premake5", "vs2022"] + options)
 
 if globals.IsLinux():
-    ret = subprocess.call(["premake/premake5.linux", "gmake2"])
+    ret = subprocess.call(["premake/premake5.linux"] + options + ["gmake2"])
 
 if globals.IsMac():
-    ret = subprocess.call(["premake/premake5", "gmake2"])
+    ret = subprocess.call(["premake/premake5"] + options + ["gmake2"])
     if (ret == 0):
-        ret = subprocess.call(["premake/premake5", "xcode4"])
+        ret = subprocess.call(["premake/premake5"] + options + ["xcode4"])
 
 sys.exit(ret)
\ No newline at end of file
@@ -0,0 +1,181 @@
+# Packs every file below an asset root into one archive
+# (see AthiVegam/Assets/Archive.h). Assets are cooked first
+# (see cook.py): OBJ files into meshes and PNG images into
+# textures or virtual textures; they and KTX2 textures are
+# named without their extension, other files are stored as
+# they are, named with it. Each entry is cut into chunks
+# compressed on their own with LZ4.
+#
+#   python3 cli.py pack
+#   python3 tools/pack.py [asset root] [output.avar]
+#
+# The root defaults to <project>/assets and the output to
+# <project>/assets.avar. The lz4 module is used when it is
+# installed; the built-in compressor is slower but writes
+# the same format.
+
+import os
+import struct
+import sys
+
+import globals
+from cook import CookError, cook
+from cookmeshes import asset_id
+
+MAGIC = 0x52415641  # "AVAR"
+VERSION = 1
+ALIGNMENT = 4096
+CHUNK_SIZE = 64 << 10
+CHUNK_UNCOMPRESSED = 1 << 31
+
+HEADER = struct.Struct("<IIII")
+ENTRY = struct.Struct("<QQQQIIII")
+
+# LZ4 block format limits: the last 5 bytes are always
+# literals and no match starts in the last 12.
+MIN_MATCH = 4
+LAST_LITERALS = 5
+MATCH_LIMIT = 12
+MAX_OFFSET = 65535
+
+try:
+    import lz4.block
+
+    def lz4_compress(data):
+        return lz4.block.compress(data, store_size=False)
+except ImportError:
+    def lz4_compress(data):
+        return compress_greedy(data)
+
+
+def write_length(out, length):
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+
+def write_sequence(out, literals, offset, matchLength):
+    token = min(len(literals), 15) << 4
+    if offset:
+        token |= min(matchLength - MIN_MATCH, 15)
+    out.append(token)
+    if len(literals) >= 15:
+        write_length(out, len(literals) - 15)
+    out += literals
+    if offset:
+        out += struct.pack("<H", offset)
+        if matchLength - MIN_MATCH >= 15:
+            write_length(out, matchLength - MIN_MATCH - 15)
+
+
+def compress_greedy(data):
+    # Takes the most recent earlier occurrence of every
+    # 4-byte sequence; simple, and plenty for offline use.
+    out = bytearray()
+    last = {}
+    anchor = 0
+    i = 0
+    limit = len(data) - MATCH_LIMIT
+    while i < limit:
+        key = data[i:i + MIN_MATCH]
+        candidate = last.get(key)
+        last[key] = i
+        if candidate is None or i - candidate > MAX_OFFSET:
+            i += 1
+            continue
+
+        length = MIN_MATCH
+        maxLength = len(data) - LAST_LITERALS - i
+        while (length < maxLength
+               and data[candidate + length] == data[i + length]):
+            length += 1
+        write_sequence(out, data[anchor:i], i - candidate,
+                       length)
+        i += length
+        anchor = i
+    write_sequence(out, data[anchor:], 0, 0)
+    return bytes(out)
+
+
+def align(value):
+    return (value + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+
+def compress(data):
+    chunks = []
+    for start in range(0, len(data), CHUNK_SIZE):
+        chunk = data[start:start + CHUNK_SIZE]
+        packed = lz4_compress(chunk)
+        if len(packed) < len(chunk):
+            chunks.append((len(packed), packed))
+        else:
+            chunks.append((len(chunk) | CHUNK_UNCOMPRESSED,
+                           chunk))
+    return chunks
+
+
+def main():
+    project = globals.PROJECT_NAME
+    root = sys.argv[1] if len(sys.argv) > 1 else \
+        os.path.join(project, "assets")
+    output = sys.argv[2] if len(sys.argv) > 2 else \
+        os.path.join(project, "assets.avar")
+    if not os.path.isdir(root):
+        print("No assets to pack in {}".format(root))
+        return 0
+
+    try:
+        assets = cook(root)
+    except CookError as error:
+        print("error:", error)
+        return 1
+
+    entries = []
+    for name, kind, data in assets:
+        entries.append((asset_id(name), name, kind, data,
+                        compress(data)))
+    entries.sort(key=lambda entry: entry[0])
+    for a, b in zip(entries, entries[1:]):
+        if a[0] == b[0]:
+            print("Asset ids of {} and {} collide".format(
+                a[1], b[1]))
+            return 1
+
+    chunkCount = sum(len(entry[4]) for entry in entries)
+    offset = align(HEADER.size + ENTRY.size * len(entries)
+                   + 4 * chunkCount)
+    toc = bytearray(HEADER.pack(MAGIC, VERSION, len(entries),
+                                chunkCount))
+    sizes = bytearray()
+    firstChunk = 0
+    for id, _, kind, data, chunks in entries:
+        storedSize = sum(len(chunk) for _, chunk in chunks)
+        toc += ENTRY.pack(id, offset, storedSize, len(data),
+                          firstChunk, len(chunks), kind, 0)
+        for size, _ in chunks:
+            sizes += struct.pack("<I", size)
+        firstChunk += len(chunks)
+        offset = align(offset + storedSize)
+
+    stored = 0
+    total = 0
+    with open(output, "wb") as file:
+        file.write(toc + sizes)
+        for _, name, _, data, chunks in entries:
+            file.write(bytes(align(file.tell()) - file.tell()))
+            for _, chunk in chunks:
+                file.write(chunk)
+                stored += len(chunk)
+            total += len(data)
+            print("{}: {} KB".format(name, len(data) // 1024))
+        size = file.tell()
+
+    print("Packed {} assets, {} KB in {} KB ({} KB on disk) "
+          "to {}".format(len(entries), total // 1024,
+                         stored // 1024, size // 1024, output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())